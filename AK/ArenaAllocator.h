@@ -0,0 +1,182 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/Assertions.h>
+#include <AK/NonnullRefPtr.h>
+#include <AK/RefCounted.h>
+#include <AK/StdLibExtras.h>
+#include <AK/Types.h>
+#include <AK/kmalloc.h>
+
+namespace AK {
+
+// Hands out memory by bumping a pointer through big chunks, and frees all of it at once
+// when it goes away. This makes sense for lots of small objects that all die together,
+// like the nodes of a syntax tree.
+//
+// Objects created with create_object() keep the arena alive until they're gone, so it's fine
+// for them to outlive whoever created the arena. Their memory isn't reused when they die,
+// though; it's only given back together with everything else in the arena.
+//
+// Chunks start out small and double in size up to a limit, so that an arena that ends up
+// holding only a handful of objects doesn't waste much memory.
+class ArenaAllocator : public RefCounted<ArenaAllocator> {
+public:
+    static constexpr size_t default_chunk_size = 4 * KB;
+    static constexpr size_t max_chunk_size = 64 * KB;
+    // Enough to keep anything allocated behind it suitably aligned.
+    static constexpr size_t alignment = 2 * sizeof(void*);
+
+    static NonnullRefPtr<ArenaAllocator> create(size_t chunk_size = default_chunk_size)
+    {
+        return adopt(*new ArenaAllocator(chunk_size));
+    }
+
+    ~ArenaAllocator()
+    {
+        while (m_chunks) {
+            auto* next = m_chunks->next;
+            kfree(m_chunks);
+            m_chunks = next;
+        }
+    }
+
+    void* allocate(size_t size)
+    {
+        size = (size + alignment - 1) & ~(alignment - 1);
+        m_bytes_allocated += size;
+
+        // Big allocations get a chunk of their own, so that they don't waste whatever
+        // is left of the current one.
+        if (size > m_chunk_size / 4)
+            return add_chunk(size);
+
+        if (size > m_remaining) {
+            if (m_chunk_count && m_chunk_size < max_chunk_size)
+                m_chunk_size *= 2;
+            m_next = add_chunk(m_chunk_size);
+            m_remaining = m_chunk_size;
+        }
+        void* ptr = m_next;
+        m_next += size;
+        m_remaining -= size;
+        return ptr;
+    }
+
+    // Like adopt(*new T(...)), but T (which must derive from ArenaAllocated) lives in this arena.
+    template<typename T, typename... Args>
+    NonnullRefPtr<T> create_object(Args&&... args)
+    {
+        return adopt(*new (*this) T(forward<Args>(args)...));
+    }
+
+    size_t bytes_allocated() const { return m_bytes_allocated; }
+    size_t chunk_count() const { return m_chunk_count; }
+
+private:
+    struct Chunk {
+        Chunk* next;
+    };
+    static constexpr size_t chunk_header_size = (sizeof(Chunk) + alignment - 1) & ~(alignment - 1);
+
+    explicit ArenaAllocator(size_t chunk_size)
+        : m_chunk_size(chunk_size)
+    {
+    }
+
+    u8* add_chunk(size_t data_size)
+    {
+        auto* chunk = reinterpret_cast<Chunk*>(kmalloc(chunk_header_size + data_size));
+        ASSERT(chunk);
+        chunk->next = m_chunks;
+        m_chunks = chunk;
+        ++m_chunk_count;
+        return reinterpret_cast<u8*>(chunk) + chunk_header_size;
+    }
+
+    size_t m_chunk_size { default_chunk_size };
+    Chunk* m_chunks { nullptr };
+    u8* m_next { nullptr };
+    size_t m_remaining { 0 };
+    size_t m_bytes_allocated { 0 };
+    size_t m_chunk_count { 0 };
+};
+
+// Derive from this to make a class creatable with ArenaAllocator::create_object(), as well as
+// with plain new. Every object gets a small header that says which arena, if any, it belongs
+// to, so that delete does the right thing either way.
+class ArenaAllocated {
+public:
+    // Not inlined, so GCC doesn't see kmalloc() behind it and mistake our own operator delete for a mismatched one.
+    NEVER_INLINE void* operator new(size_t size)
+    {
+        auto* header = reinterpret_cast<Header*>(kmalloc(header_size + size));
+        ASSERT(header);
+        header->arena = nullptr;
+        return reinterpret_cast<u8*>(header) + header_size;
+    }
+
+    void* operator new(size_t size, ArenaAllocator& arena)
+    {
+        auto* header = reinterpret_cast<Header*>(arena.allocate(header_size + size));
+        header->arena = &arena;
+        arena.ref();
+        return reinterpret_cast<u8*>(header) + header_size;
+    }
+
+    void operator delete(void* ptr)
+    {
+        if (!ptr)
+            return;
+        auto* header = reinterpret_cast<Header*>(reinterpret_cast<u8*>(ptr) - header_size);
+        if (header->arena)
+            header->arena->unref();
+        else
+            kfree(header);
+    }
+
+    void operator delete(void* ptr, ArenaAllocator&)
+    {
+        operator delete(ptr);
+    }
+
+protected:
+    ArenaAllocated() { }
+
+private:
+    struct Header {
+        ArenaAllocator* arena;
+    };
+    static constexpr size_t header_size = ArenaAllocator::alignment;
+    static_assert(sizeof(Header) <= header_size);
+};
+
+}
+
+using AK::ArenaAllocated;
+using AK::ArenaAllocator;
@@ -97,9 +97,16 @@ public:
     }
     void set_range(size_t start, size_t len, bool value)
     {
-        for (size_t index = start; index < start + len; ++index) {
-            set(index, value);
+        size_t end = start + len;
+        for (; start < end && start % 8; ++start)
+            set(start, value);
+        size_t whole_bytes = (end - start) / 8;
+        if (whole_bytes) {
+            __builtin_memset(m_data + start / 8, value ? 0xff : 0x00, whole_bytes);
+            start += whole_bytes * 8;
         }
+        for (; start < end; ++start)
+            set(start, value);
     }
 
     u8* data() { return m_data; }
@@ -328,6 +328,18 @@ public:
         return *this;
     };
 
+    // Like read_raw(), but points into the buffer instead of copying out of it.
+    ReadonlyBytes read_raw_in_place(size_t size)
+    {
+        if (m_offset + size > m_buffer.size()) {
+            m_read_failure = true;
+            return {};
+        }
+        ReadonlyBytes bytes { m_buffer.data() + m_offset, size };
+        m_offset += size;
+        return bytes;
+    }
+
     u8 peek()
     {
         if (m_offset >= m_buffer.size()) {
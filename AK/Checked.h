@@ -235,7 +235,7 @@ public:
     }
 
     template<typename U, typename V>
-    static bool addition_would_overflow(U u, V v)
+    static constexpr bool addition_would_overflow(U u, V v)
     {
 #ifdef __clang__
         Checked checked;
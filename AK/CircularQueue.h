@@ -88,9 +88,12 @@ public:
     }
 
     const T& at(size_t index) const { return elements()[(m_head + index) % Capacity]; }
+    T& at(size_t index) { return elements()[(m_head + index) % Capacity]; }
 
     const T& first() const { return at(0); }
+    T& first() { return at(0); }
     const T& last() const { return at(size() - 1); }
+    T& last() { return at(size() - 1); }
 
     class ConstIterator {
     public:
@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) 2020, The SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/Forward.h>
+#include <AK/Types.h>
+
+namespace AK {
+
+// Enough for the longest output, "-0.0000012345678901234567", and the terminating null character.
+static constexpr size_t double_string_buffer_size = 32;
+
+// The shortest decimal significand * 10^exponent that reads back as the same double.
+struct ShortestDecimal {
+    u64 significand { 0 };
+    i32 exponent { 0 };
+};
+
+// Only for finite doubles greater than zero.
+ShortestDecimal shortest_decimal_from_double(double);
+
+// Writes the shortest string that reads back as the same double, laid out the way
+// ECMAScript's Number::toString does it ("0.001", "123", "1e+21", "NaN", ...).
+// Returns the length of the string, which is also null-terminated.
+size_t format_double(double, char* buffer);
+
+// Parses the longest prefix of the input that looks like [+-]digits[.digits][(e|E)[+-]digits]
+// and rounds it correctly to the nearest double. Returns an empty Optional if there are no digits.
+Optional<double> parse_double(const StringView&, size_t* consumed_length = nullptr);
+
+}
+
+using AK::double_string_buffer_size;
+using AK::format_double;
+using AK::parse_double;
+using AK::shortest_decimal_from_double;
+using AK::ShortestDecimal;
@@ -24,12 +24,14 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <AK/Atomic.h>
 #include <AK/FlyString.h>
 #include <AK/HashTable.h>
 #include <AK/Optional.h>
 #include <AK/String.h>
 #include <AK/StringUtils.h>
 #include <AK/StringView.h>
+#include <AK/kmalloc.h>
 
 namespace AK {
 
@@ -47,17 +49,82 @@ struct FlyStringImplTraits : public AK::Traits<StringImpl*> {
     }
 };
 
-static HashTable<StringImpl*, FlyStringImplTraits>& fly_impls()
+// The table of interned strings is split into shards by hash, each with its own lock,
+// so threads interning different strings rarely contend with each other.
+class FlyStringShard {
+public:
+    void lock()
+    {
+        while (m_locked.exchange(true, memory_order_acquire)) {
+            while (m_locked.load(memory_order_relaxed)) {
+#if ARCH(I386) || ARCH(X86_64)
+                __builtin_ia32_pause();
+#endif
+            }
+        }
+    }
+    void unlock() { m_locked.store(false, memory_order_release); }
+
+    // Returns a new reference to an interned string with these characters, if there is a live one.
+    template<typename Finder>
+    StringImpl* find_and_ref(unsigned hash, Finder finder)
+    {
+        auto it = m_table.find(hash, finder);
+        // A string whose last reference is being dropped is still in the table until its
+        // destructor gets the lock to remove it. It can't be handed out again.
+        if (it == m_table.end() || !(*it)->try_ref())
+            return nullptr;
+        return *it;
+    }
+
+    void add(StringImpl& impl) { m_table.set(&impl); }
+
+    void remove(StringImpl& impl)
+    {
+        // A dead string's entry may already have been taken over by a new string with the
+        // same characters, so only remove the entry if it's still this exact one.
+        auto it = m_table.find(impl.hash(), [&](auto* candidate) { return candidate == &impl; });
+        if (it != m_table.end())
+            m_table.remove(it);
+    }
+
+private:
+    Atomic<bool> m_locked { false };
+    HashTable<StringImpl*, FlyStringImplTraits> m_table;
+    // Keep each shard's lock on a cache line of its own.
+    u8 m_padding[64 - sizeof(HashTable<StringImpl*, FlyStringImplTraits>)];
+};
+
+static constexpr size_t fly_string_shard_count = 64;
+static Atomic<FlyStringShard*> s_fly_string_shards;
+
+static FlyStringShard& fly_string_shard(unsigned hash)
 {
-    static HashTable<StringImpl*, FlyStringImplTraits>* table;
-    if (!table)
-        table = new HashTable<StringImpl*, FlyStringImplTraits>;
-    return *table;
+    auto* shards = s_fly_string_shards.load(memory_order_acquire);
+    if (!shards) {
+        // Whichever thread gets here first wins. The shards are never freed, because
+        // strings can outlive everything else during process teardown.
+        auto* new_shards = static_cast<FlyStringShard*>(kmalloc(sizeof(FlyStringShard) * fly_string_shard_count));
+        for (size_t i = 0; i < fly_string_shard_count; ++i)
+            new (&new_shards[i]) FlyStringShard;
+        if (s_fly_string_shards.compare_exchange_strong(shards, new_shards, memory_order_acq_rel)) {
+            shards = new_shards;
+        } else {
+            for (size_t i = 0; i < fly_string_shard_count; ++i)
+                new_shards[i].~FlyStringShard();
+            kfree(new_shards);
+        }
+    }
+    // HashTable picks buckets with the low bits of the hash, so pick shards with the high ones.
+    return shards[hash >> 26];
 }
 
 void FlyString::did_destroy_impl(Badge<StringImpl>, StringImpl& impl)
 {
-    fly_impls().remove(&impl);
+    auto& shard = fly_string_shard(impl.hash());
+    shard.lock();
+    shard.remove(impl);
+    shard.unlock();
 }
 
 FlyString::FlyString(const String& string)
@@ -68,20 +135,40 @@ FlyString::FlyString(const String& string)
         m_impl = string.impl();
         return;
     }
-    auto it = fly_impls().find(const_cast<StringImpl*>(string.impl()));
-    if (it == fly_impls().end()) {
-        fly_impls().set(const_cast<StringImpl*>(string.impl()));
-        string.impl()->set_fly({}, true);
-        m_impl = string.impl();
-    } else {
-        ASSERT((*it)->is_fly());
-        m_impl = *it;
+    auto& impl = const_cast<StringImpl&>(*string.impl());
+    unsigned hash = impl.hash();
+    auto& shard = fly_string_shard(hash);
+    shard.lock();
+    auto* existing_impl = shard.find_and_ref(hash, [&](auto* candidate) { return FlyStringImplTraits::equals(candidate, &impl); });
+    if (!existing_impl) {
+        impl.set_fly({}, true);
+        shard.add(impl);
     }
+    shard.unlock();
+
+    if (existing_impl)
+        m_impl = adopt(*existing_impl);
+    else
+        m_impl = &impl;
 }
 
 FlyString::FlyString(const StringView& string)
-    : FlyString(static_cast<String>(string))
 {
+    if (string.is_null())
+        return;
+    // Most of the time the string is already there, so look for it before allocating a copy.
+    unsigned hash = string.hash();
+    auto& shard = fly_string_shard(hash);
+    shard.lock();
+    auto* existing_impl = shard.find_and_ref(hash, [&](auto* candidate) {
+        return candidate->length() == string.length() && !__builtin_memcmp(candidate->characters(), string.characters_without_null_termination(), string.length());
+    });
+    shard.unlock();
+    if (existing_impl) {
+        m_impl = adopt(*existing_impl);
+        return;
+    }
+    *this = FlyString(static_cast<String>(string));
 }
 
 FlyString::FlyString(const char* string)
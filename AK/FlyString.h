@@ -107,6 +107,7 @@ private:
 template<>
 struct Traits<FlyString> : public GenericTraits<FlyString> {
     static unsigned hash(const FlyString& s) { return s.hash(); }
+    static constexpr bool is_trivially_relocatable() { return true; }
 };
 
 }
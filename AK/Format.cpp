@@ -0,0 +1,234 @@
+/*
+ * Copyright (c) 2020, The SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <AK/Format.h>
+#include <AK/StringBuilder.h>
+#include <AK/kstdio.h>
+
+#ifndef KERNEL
+#    include <AK/DoubleConversion.h>
+#endif
+
+namespace AK {
+
+void FormatOutput::append_repeated(char ch, size_t count)
+{
+    char chunk[32];
+    for (auto& character : chunk)
+        character = ch;
+    while (count > 0) {
+        size_t chunk_length = min(count, sizeof(chunk));
+        append({ chunk, chunk_length });
+        count -= chunk_length;
+    }
+}
+
+static void write_padded(FormatOutput& output, const FormatSpec& spec, const StringView& prefix, const StringView& body, FormatSpec::Align default_align)
+{
+    size_t length = prefix.length() + body.length();
+    size_t padding = spec.width > length ? spec.width - length : 0;
+    auto align = spec.align == FormatSpec::Align::Default ? default_align : spec.align;
+
+    // Zero padding goes between the sign or base prefix and the digits, like printf's.
+    if (spec.zero_pad && spec.align == FormatSpec::Align::Default) {
+        output.append(prefix);
+        output.append_repeated('0', padding);
+        output.append(body);
+        return;
+    }
+
+    size_t left_padding = 0;
+    if (align == FormatSpec::Align::Right)
+        left_padding = padding;
+    else if (align == FormatSpec::Align::Center)
+        left_padding = padding / 2;
+    output.append_repeated(spec.fill, left_padding);
+    output.append(prefix);
+    output.append(body);
+    output.append_repeated(spec.fill, padding - left_padding);
+}
+
+void format_integer(FormatOutput& output, const FormatSpec& spec, u64 absolute_value, bool is_negative)
+{
+    if (spec.type == 'c') {
+        char ch = static_cast<char>(absolute_value);
+        write_padded(output, spec, {}, { &ch, 1 }, FormatSpec::Align::Left);
+        return;
+    }
+
+    unsigned base = 10;
+    const char* digits = "0123456789abcdef";
+    const char* base_prefix = "";
+    switch (spec.type) {
+    case 'b':
+        base = 2;
+        base_prefix = "0b";
+        break;
+    case 'o':
+        base = 8;
+        base_prefix = "0";
+        break;
+    case 'x':
+    case 'p':
+        base = 16;
+        base_prefix = "0x";
+        break;
+    case 'X':
+        base = 16;
+        base_prefix = "0X";
+        digits = "0123456789ABCDEF";
+        break;
+    }
+
+    // 64 binary digits at most.
+    char buffer[64];
+    size_t start = sizeof(buffer);
+    do {
+        buffer[--start] = digits[absolute_value % base];
+        absolute_value /= base;
+    } while (absolute_value);
+
+    char prefix[4];
+    size_t prefix_length = 0;
+    if (is_negative)
+        prefix[prefix_length++] = '-';
+    else if (spec.plus_sign)
+        prefix[prefix_length++] = '+';
+    if (spec.alternate_form || spec.type == 'p') {
+        for (const char* ch = base_prefix; *ch; ++ch)
+            prefix[prefix_length++] = *ch;
+    }
+
+    write_padded(output, spec, { prefix, prefix_length }, { buffer + start, sizeof(buffer) - start }, FormatSpec::Align::Right);
+}
+
+void format_string(FormatOutput& output, const FormatSpec& spec, const StringView& string)
+{
+    auto view = string;
+    if (spec.precision >= 0 && static_cast<size_t>(spec.precision) < view.length())
+        view = view.substring_view(0, spec.precision);
+    write_padded(output, spec, {}, view, FormatSpec::Align::Left);
+}
+
+#ifndef KERNEL
+void format_floating_point(FormatOutput& output, const FormatSpec& spec, double value)
+{
+    bool is_negative = value < 0 || (value == 0 && 1 / value < 0);
+    double absolute_value = is_negative ? -value : value;
+
+    char prefix[1];
+    size_t prefix_length = 0;
+    if (is_negative)
+        prefix[prefix_length++] = '-';
+    else if (spec.plus_sign)
+        prefix[prefix_length++] = '+';
+
+    int precision = spec.precision >= 0 ? spec.precision : (spec.type == 'f' ? 6 : -1);
+
+    // With a precision and a value that still fits a double's integer range after scaling,
+    // the digits come from one rounded integer. Anything else gets the shortest round-trip form.
+    static constexpr u64 powers_of_ten[] = { 1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000 };
+    if (precision >= 0 && precision < 10 && absolute_value < 9007199254740992.0 / powers_of_ten[precision]) {
+        double scaled = absolute_value * powers_of_ten[precision];
+        u64 rounded = static_cast<u64>(scaled);
+        double remainder = scaled - rounded;
+        if (remainder > 0.5 || (remainder == 0.5 && (rounded & 1)))
+            ++rounded;
+
+        char buffer[32];
+        size_t start = sizeof(buffer);
+        for (int i = 0; i < precision; ++i) {
+            buffer[--start] = '0' + rounded % 10;
+            rounded /= 10;
+        }
+        if (precision > 0)
+            buffer[--start] = '.';
+        do {
+            buffer[--start] = '0' + rounded % 10;
+            rounded /= 10;
+        } while (rounded);
+        write_padded(output, spec, { prefix, prefix_length }, { buffer + start, sizeof(buffer) - start }, FormatSpec::Align::Right);
+        return;
+    }
+
+    char buffer[double_string_buffer_size];
+    size_t length = format_double(absolute_value, buffer);
+    write_padded(output, spec, { prefix, prefix_length }, { buffer, length }, FormatSpec::Align::Right);
+}
+#endif
+
+void vformat(FormatOutput& output, const StringView& fmtstr, const TypeErasedParameter* parameters, size_t parameter_count)
+{
+    // The format string was validated when it was compiled, so this only has to find the fields.
+    size_t parameter_index = 0;
+    size_t literal_start = 0;
+    const char* characters = fmtstr.characters_without_null_termination();
+    size_t length = fmtstr.length();
+
+    for (size_t index = 0; index < length; ++index) {
+        char ch = characters[index];
+        if (ch != '{' && ch != '}')
+            continue;
+        output.append({ characters + literal_start, index - literal_start });
+        if (index + 1 < length && characters[index + 1] == ch) {
+            literal_start = ++index;
+            continue;
+        }
+
+        size_t end = index + 1;
+        while (end < length && characters[end] != '}')
+            ++end;
+        FormatSpec spec;
+        if (end > index + 1)
+            FormatSpec::parse(characters + index + 2, end - index - 2, spec);
+        ASSERT(parameter_index < parameter_count);
+        auto& parameter = parameters[parameter_index++];
+        parameter.format(output, spec, parameter.value);
+        index = end;
+        literal_start = end + 1;
+    }
+    output.append({ characters + literal_start, length - literal_start });
+}
+
+String vformat(const StringView& fmtstr, const TypeErasedParameter* parameters, size_t parameter_count)
+{
+    StringBuilder builder;
+    FormatOutput output(builder);
+    vformat(output, fmtstr, parameters, parameter_count);
+    return builder.to_string();
+}
+
+void vdbgln(const StringView& fmtstr, const TypeErasedParameter* parameters, size_t parameter_count)
+{
+    StringBuilder builder;
+    FormatOutput output(builder);
+    vformat(output, fmtstr, parameters, parameter_count);
+    builder.append('\n');
+    auto string = builder.string_view();
+    dbgputstr(string.characters_without_null_termination(), string.length());
+}
+
+}
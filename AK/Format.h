@@ -0,0 +1,338 @@
+/*
+ * Copyright (c) 2020, The SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/Concepts.h>
+#include <AK/FlyString.h>
+#include <AK/String.h>
+#include <AK/StringView.h>
+#include <AK/Types.h>
+
+// Type-safe string formatting with "{}" replacement fields:
+//
+//     builder.appendff("{} has {:#x} pages and {:>8} bytes", name, page_count, size);
+//
+// A field is "{}" or "{:spec}", where spec is [[fill]align][+][#][0][width][.precision][type].
+// align is one of '<', '^' and '>', and type is one of "bcdoxXpsf". "{{" and "}}" are literal braces.
+//
+// Format strings are checked at compile time, so a wrong number of fields or a malformed spec
+// is a build error instead of garbage at runtime. The arguments are passed on by type, without
+// varargs, and each type's Formatter knows how to write it.
+
+namespace AK {
+
+struct FormatSpec {
+    enum class Align : u8 {
+        Default,
+        Left,
+        Center,
+        Right,
+    };
+
+    char fill { ' ' };
+    Align align { Align::Default };
+    bool plus_sign { false };
+    bool alternate_form { false };
+    bool zero_pad { false };
+    size_t width { 0 };
+    int precision { -1 };
+    char type { 0 };
+
+    // Parses the part of a replacement field after the ':'. Returns false if it's malformed.
+    static constexpr bool parse(const char* characters, size_t length, FormatSpec& spec)
+    {
+        size_t index = 0;
+        auto is_align = [](char ch) { return ch == '<' || ch == '^' || ch == '>'; };
+        auto to_align = [](char ch) { return ch == '<' ? Align::Left : ch == '^' ? Align::Center : Align::Right; };
+        auto is_digit = [](char ch) { return ch >= '0' && ch <= '9'; };
+
+        if (length >= 2 && is_align(characters[1])) {
+            spec.fill = characters[0];
+            spec.align = to_align(characters[1]);
+            index = 2;
+        } else if (length >= 1 && is_align(characters[0])) {
+            spec.align = to_align(characters[0]);
+            index = 1;
+        }
+        if (index < length && characters[index] == '+') {
+            spec.plus_sign = true;
+            ++index;
+        }
+        if (index < length && characters[index] == '#') {
+            spec.alternate_form = true;
+            ++index;
+        }
+        if (index < length && characters[index] == '0') {
+            spec.zero_pad = true;
+            ++index;
+        }
+        for (; index < length && is_digit(characters[index]); ++index)
+            spec.width = spec.width * 10 + (characters[index] - '0');
+        if (index < length && characters[index] == '.') {
+            ++index;
+            if (index == length || !is_digit(characters[index]))
+                return false;
+            spec.precision = 0;
+            for (; index < length && is_digit(characters[index]); ++index)
+                spec.precision = spec.precision * 10 + (characters[index] - '0');
+        }
+        if (index < length) {
+            char type = characters[index++];
+            switch (type) {
+            case 'b':
+            case 'c':
+            case 'd':
+            case 'o':
+            case 'x':
+            case 'X':
+            case 'p':
+            case 's':
+            case 'f':
+                spec.type = type;
+                break;
+            default:
+                return false;
+            }
+        }
+        return index == length;
+    }
+};
+
+// Where formatted text goes. This lets StringBuilder, KBufferBuilder and anything else
+// with an append(const StringView&) share one non-template vformat().
+class FormatOutput {
+public:
+    template<typename Builder>
+    explicit FormatOutput(Builder& builder)
+        : m_builder(&builder)
+        , m_append([](void* builder, const StringView& string) { static_cast<Builder*>(builder)->append(string); })
+    {
+    }
+
+    void append(const StringView& string) { m_append(m_builder, string); }
+    void append_repeated(char, size_t count);
+
+private:
+    void* m_builder { nullptr };
+    void (*m_append)(void*, const StringView&) { nullptr };
+};
+
+void format_integer(FormatOutput&, const FormatSpec&, u64 absolute_value, bool is_negative);
+void format_string(FormatOutput&, const FormatSpec&, const StringView&);
+#ifndef KERNEL
+void format_floating_point(FormatOutput&, const FormatSpec&, double);
+#endif
+
+template<typename T, typename = void>
+struct Formatter;
+
+template<Concepts::Integral T>
+struct Formatter<T> {
+    static void format(FormatOutput& output, const FormatSpec& spec, T value)
+    {
+        if constexpr (IsSame<T, typename MakeUnsigned<T>::Type>::value) {
+            format_integer(output, spec, value, false);
+        } else {
+            // Negating in the unsigned type avoids overflowing on the smallest value.
+            u64 absolute_value = value < 0 ? 0 - static_cast<u64>(value) : static_cast<u64>(value);
+            format_integer(output, spec, absolute_value, value < 0);
+        }
+    }
+};
+
+template<>
+struct Formatter<char> {
+    static void format(FormatOutput& output, const FormatSpec& spec, char value)
+    {
+        if (spec.type && spec.type != 'c')
+            return format_integer(output, spec, static_cast<u8>(value), false);
+        format_string(output, spec, StringView(&value, 1));
+    }
+};
+
+template<>
+struct Formatter<bool> {
+    static void format(FormatOutput& output, const FormatSpec& spec, bool value)
+    {
+        if (spec.type && spec.type != 's')
+            return format_integer(output, spec, value, false);
+        format_string(output, spec, value ? "true" : "false");
+    }
+};
+
+template<>
+struct Formatter<StringView> {
+    static void format(FormatOutput& output, const FormatSpec& spec, const StringView& value) { format_string(output, spec, value); }
+};
+
+template<>
+struct Formatter<String> {
+    static void format(FormatOutput& output, const FormatSpec& spec, const String& value) { format_string(output, spec, value); }
+};
+
+template<>
+struct Formatter<FlyString> {
+    static void format(FormatOutput& output, const FormatSpec& spec, const FlyString& value) { format_string(output, spec, value); }
+};
+
+template<>
+struct Formatter<const char*> {
+    static void format(FormatOutput& output, const FormatSpec& spec, const char* value) { format_string(output, spec, value ? value : "(null)"); }
+};
+
+template<>
+struct Formatter<char*> : Formatter<const char*> {
+};
+
+template<size_t Size>
+struct Formatter<char[Size]> : Formatter<const char*> {
+};
+
+template<typename T>
+struct Formatter<T*> {
+    static void format(FormatOutput& output, const FormatSpec& spec, const T* value)
+    {
+        FormatSpec pointer_spec = spec;
+        pointer_spec.type = 'x';
+        pointer_spec.alternate_form = true;
+        pointer_spec.zero_pad = true;
+        pointer_spec.width = 2 + 2 * sizeof(FlatPtr);
+        format_integer(output, pointer_spec, reinterpret_cast<FlatPtr>(value), false);
+    }
+};
+
+#ifndef KERNEL
+template<Concepts::FloatingPoint T>
+struct Formatter<T> {
+    static void format(FormatOutput& output, const FormatSpec& spec, T value) { format_floating_point(output, spec, value); }
+};
+#endif
+
+struct TypeErasedParameter {
+    const void* value;
+    void (*format)(FormatOutput&, const FormatSpec&, const void*);
+};
+
+template<typename T>
+TypeErasedParameter make_type_erased_parameter(const T& value)
+{
+    return { &value, [](FormatOutput& output, const FormatSpec& spec, const void* value) {
+                Formatter<T>::format(output, spec, *static_cast<const T*>(value));
+            } };
+}
+
+void vformat(FormatOutput&, const StringView& fmtstr, const TypeErasedParameter*, size_t parameter_count);
+String vformat(const StringView& fmtstr, const TypeErasedParameter*, size_t parameter_count);
+void vdbgln(const StringView& fmtstr, const TypeErasedParameter*, size_t parameter_count);
+
+namespace Detail {
+
+// Never defined. Calling it from a consteval function is what turns a bad format string into a build error.
+void compiletime_format_error(const char*);
+
+consteval size_t count_and_check_replacement_fields(const char* characters, size_t length)
+{
+    size_t field_count = 0;
+    for (size_t index = 0; index < length; ++index) {
+        if (characters[index] == '}') {
+            if (index + 1 == length || characters[index + 1] != '}')
+                compiletime_format_error("Unmatched '}' in format string");
+            ++index;
+            continue;
+        }
+        if (characters[index] != '{')
+            continue;
+        if (index + 1 < length && characters[index + 1] == '{') {
+            ++index;
+            continue;
+        }
+        size_t end = index + 1;
+        while (end < length && characters[end] != '}')
+            ++end;
+        if (end == length)
+            compiletime_format_error("Unmatched '{' in format string");
+        if (end != index + 1) {
+            FormatSpec spec;
+            if (characters[index + 1] != ':' || !FormatSpec::parse(characters + index + 2, end - index - 2, spec))
+                compiletime_format_error("Malformed replacement field in format string");
+        }
+        ++field_count;
+        index = end;
+    }
+    return field_count;
+}
+
+}
+
+template<typename... Parameters>
+class CheckedFormatString {
+public:
+    template<size_t Size>
+    consteval CheckedFormatString(const char (&fmtstr)[Size])
+        : m_characters(fmtstr)
+        , m_length(Size - 1)
+    {
+        if (Detail::count_and_check_replacement_fields(fmtstr, Size - 1) != sizeof...(Parameters))
+            Detail::compiletime_format_error("Wrong number of arguments for format string");
+    }
+
+    StringView view() const { return { m_characters, m_length }; }
+
+private:
+    const char* m_characters { nullptr };
+    size_t m_length { 0 };
+};
+
+template<typename T>
+struct FormatParameterType {
+    using Type = T;
+};
+
+template<typename... Parameters>
+using CheckedFormatStringFor = CheckedFormatString<typename FormatParameterType<Parameters>::Type...>;
+
+template<typename... Parameters>
+String format(CheckedFormatStringFor<Parameters...>&& fmtstr, const Parameters&... parameters)
+{
+    TypeErasedParameter type_erased_parameters[] = { make_type_erased_parameter(parameters)..., {} };
+    return vformat(fmtstr.view(), type_erased_parameters, sizeof...(Parameters));
+}
+
+template<typename... Parameters>
+void dbgln(CheckedFormatStringFor<Parameters...>&& fmtstr, const Parameters&... parameters)
+{
+    TypeErasedParameter type_erased_parameters[] = { make_type_erased_parameter(parameters)..., {} };
+    vdbgln(fmtstr.view(), type_erased_parameters, sizeof...(Parameters));
+}
+
+}
+
+using AK::CheckedFormatStringFor;
+using AK::dbgln;
+using AK::FormatOutput;
+using AK::Formatter;
+using AK::FormatSpec;
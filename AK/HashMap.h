@@ -44,6 +44,7 @@ private:
     struct EntryTraits {
         static unsigned hash(const Entry& entry) { return KeyTraits::hash(entry.key); }
         static bool equals(const Entry& a, const Entry& b) { return KeyTraits::equals(a.key, b.key); }
+        static constexpr bool is_trivially_relocatable() { return Traits<K>::is_trivially_relocatable() && Traits<V>::is_trivially_relocatable(); }
     };
 
 public:
@@ -27,10 +27,11 @@
 #pragma once
 
 #include <AK/Assertions.h>
-#include <AK/SinglyLinkedList.h>
 #include <AK/StdLibExtras.h>
 #include <AK/TemporaryChange.h>
 #include <AK/Traits.h>
+#include <AK/Types.h>
+#include <AK/kmalloc.h>
 
 namespace AK {
 
@@ -42,21 +43,26 @@ enum class HashSetResult {
 template<typename T, typename>
 class HashTable;
 
-template<typename HashTableType, typename ElementType, typename BucketIteratorType>
+// Each bucket stores its element inline, along with the element's full hash.
+// Keeping the hash around means probing can reject most non-matching buckets
+// without calling into the traits, and rehashing never has to re-hash keys.
+template<typename T>
+struct HashTableBucket {
+    bool used;
+    unsigned hash;
+    alignas(T) u8 storage[sizeof(T)];
+
+    T* slot() { return reinterpret_cast<T*>(storage); }
+    const T* slot() const { return reinterpret_cast<const T*>(storage); }
+};
+
+template<typename HashTableType, typename ElementType, typename BucketType>
 class HashTableIterator {
 public:
-    bool operator!=(const HashTableIterator& other) const
-    {
-        if (m_is_end && other.m_is_end)
-            return false;
-        return &m_table != &other.m_table
-            || m_is_end != other.m_is_end
-            || m_bucket_index != other.m_bucket_index
-            || m_bucket_iterator != other.m_bucket_iterator;
-    }
-    bool operator==(const HashTableIterator& other) const { return !(*this != other); }
-    ElementType& operator*() { return *m_bucket_iterator; }
-    ElementType* operator->() { return m_bucket_iterator.operator->(); }
+    bool operator!=(const HashTableIterator& other) const { return m_bucket != other.m_bucket; }
+    bool operator==(const HashTableIterator& other) const { return m_bucket == other.m_bucket; }
+    ElementType& operator*() { return *m_bucket->slot(); }
+    ElementType* operator->() { return m_bucket->slot(); }
     HashTableIterator& operator++()
     {
         skip_to_next();
@@ -65,50 +71,45 @@ public:
 
     void skip_to_next()
     {
-        while (!m_is_end) {
-            if (m_bucket_iterator.is_end()) {
-                ++m_bucket_index;
-                if (m_bucket_index >= m_table.capacity()) {
-                    m_is_end = true;
-                    return;
-                }
-                m_bucket_iterator = m_table.bucket(m_bucket_index).begin();
-            } else {
-                ++m_bucket_iterator;
-            }
-            if (!m_bucket_iterator.is_end())
+        if (!m_bucket)
+            return;
+        do {
+            ++m_bucket;
+            if (m_bucket == m_end_bucket) {
+                m_bucket = nullptr;
                 return;
-        }
+            }
+        } while (!m_bucket->used);
     }
 
 private:
     friend HashTableType;
 
-    explicit HashTableIterator(HashTableType& table, bool is_end, BucketIteratorType bucket_iterator = {}, size_t bucket_index = 0)
-        : m_table(table)
-        , m_bucket_index(bucket_index)
-        , m_is_end(is_end)
-        , m_bucket_iterator(bucket_iterator)
+    explicit HashTableIterator(BucketType* bucket, BucketType* end_bucket)
+        : m_bucket(bucket)
+        , m_end_bucket(end_bucket)
     {
-        ASSERT(!table.m_clearing);
-        ASSERT(!table.m_rehashing);
-        if (!is_end && !m_table.is_empty() && m_bucket_iterator.is_end()) {
-            m_bucket_iterator = m_table.bucket(0).begin();
-            if (m_bucket_iterator.is_end())
-                skip_to_next();
-        }
     }
 
-    HashTableType& m_table;
-    size_t m_bucket_index { 0 };
-    bool m_is_end { false };
-    BucketIteratorType m_bucket_iterator;
+    BucketType* m_bucket { nullptr };
+    BucketType* m_end_bucket { nullptr };
 };
 
+// An open-addressing hash table with linear probing.
+// Elements live directly in one contiguous bucket array, so inserting doesn't
+// allocate unless the table has to grow. Removal uses backward-shift deletion,
+// which keeps probe sequences short without needing tombstones.
+// NOTE: Removing an element may move other elements around, so pointers and
+//       iterators into the table are only stable until the next set() or remove().
 template<typename T, typename TraitsForT>
 class HashTable {
 private:
-    using Bucket = SinglyLinkedList<T>;
+    using Bucket = HashTableBucket<T>;
+
+    static constexpr size_t minimum_capacity = 8;
+    // The table is kept at most 3/4 full, which guarantees every probe sequence terminates at an unused bucket.
+    static constexpr size_t load_factor_numerator = 3;
+    static constexpr size_t load_factor_denominator = 4;
 
 public:
     HashTable() {}
@@ -159,7 +160,9 @@ public:
     void ensure_capacity(size_t capacity)
     {
         ASSERT(capacity >= size());
-        rehash(capacity);
+        size_t needed_buckets = capacity_for_size(capacity);
+        if (needed_buckets > m_capacity)
+            rehash(needed_buckets);
     }
 
     HashSetResult set(const T&);
@@ -167,39 +170,43 @@ public:
     bool contains(const T&) const;
     void clear();
 
-    using Iterator = HashTableIterator<HashTable, T, typename Bucket::Iterator>;
+    using Iterator = HashTableIterator<HashTable, T, Bucket>;
     friend Iterator;
-    Iterator begin() { return Iterator(*this, is_empty()); }
-    Iterator end() { return Iterator(*this, true); }
+    Iterator begin()
+    {
+        ASSERT(!m_clearing);
+        ASSERT(!m_rehashing);
+        if (is_empty())
+            return end();
+        return Iterator(first_used_bucket(), m_buckets + m_capacity);
+    }
+    Iterator end() { return Iterator(nullptr, nullptr); }
 
-    using ConstIterator = HashTableIterator<const HashTable, const T, typename Bucket::ConstIterator>;
+    using ConstIterator = HashTableIterator<const HashTable, const T, const Bucket>;
     friend ConstIterator;
-    ConstIterator begin() const { return ConstIterator(*this, is_empty()); }
-    ConstIterator end() const { return ConstIterator(*this, true); }
+    ConstIterator begin() const
+    {
+        ASSERT(!m_clearing);
+        ASSERT(!m_rehashing);
+        if (is_empty())
+            return end();
+        return ConstIterator(first_used_bucket(), m_buckets + m_capacity);
+    }
+    ConstIterator end() const { return ConstIterator(nullptr, nullptr); }
 
     template<typename Finder>
     Iterator find(unsigned hash, Finder finder)
     {
-        if (is_empty())
-            return end();
-        size_t bucket_index;
-        auto& bucket = lookup_with_hash(hash, &bucket_index);
-        auto bucket_iterator = bucket.find(finder);
-        if (bucket_iterator != bucket.end())
-            return Iterator(*this, false, bucket_iterator, bucket_index);
+        if (auto* bucket = lookup_with_hash(hash, finder))
+            return Iterator(bucket, m_buckets + m_capacity);
         return end();
     }
 
     template<typename Finder>
     ConstIterator find(unsigned hash, Finder finder) const
     {
-        if (is_empty())
-            return end();
-        size_t bucket_index;
-        auto& bucket = lookup_with_hash(hash, &bucket_index);
-        auto bucket_iterator = bucket.find(finder);
-        if (bucket_iterator != bucket.end())
-            return ConstIterator(*this, false, bucket_iterator, bucket_index);
+        if (auto* bucket = const_cast<HashTable*>(this)->lookup_with_hash(hash, finder))
+            return ConstIterator(bucket, m_buckets + m_capacity);
         return end();
     }
 
@@ -226,29 +233,72 @@ public:
     void remove(Iterator);
 
 private:
-    Bucket& lookup(const T&, size_t* bucket_index = nullptr);
-    const Bucket& lookup(const T&, size_t* bucket_index = nullptr) const;
+    static size_t capacity_for_size(size_t size)
+    {
+        size_t capacity = minimum_capacity;
+        while (capacity * load_factor_numerator < size * load_factor_denominator)
+            capacity *= 2;
+        return capacity;
+    }
+
+    size_t bucket_mask() const { return m_capacity - 1; }
 
-    Bucket& lookup_with_hash(unsigned hash, size_t* bucket_index)
+    template<typename Finder>
+    Bucket* lookup_with_hash(unsigned hash, Finder finder)
     {
-        if (bucket_index)
-            *bucket_index = hash % m_capacity;
-        return m_buckets[hash % m_capacity];
+        if (is_empty())
+            return nullptr;
+        for (size_t i = hash & bucket_mask();; i = (i + 1) & bucket_mask()) {
+            auto& bucket = m_buckets[i];
+            if (!bucket.used)
+                return nullptr;
+            if (bucket.hash == hash && finder(*bucket.slot()))
+                return &bucket;
+        }
     }
 
-    const Bucket& lookup_with_hash(unsigned hash, size_t* bucket_index) const
+    Bucket& lookup_for_writing(unsigned hash, const T& value, bool& found)
     {
-        if (bucket_index)
-            *bucket_index = hash % m_capacity;
-        return m_buckets[hash % m_capacity];
+        for (size_t i = hash & bucket_mask();; i = (i + 1) & bucket_mask()) {
+            auto& bucket = m_buckets[i];
+            if (!bucket.used) {
+                found = false;
+                return bucket;
+            }
+            if (bucket.hash == hash && TraitsForT::equals(*bucket.slot(), value)) {
+                found = true;
+                return bucket;
+            }
+        }
     }
 
-    void rehash(size_t capacity);
-    void insert(const T&);
-    void insert(T&&);
+    Bucket& find_unused_bucket(unsigned hash)
+    {
+        for (size_t i = hash & bucket_mask();; i = (i + 1) & bucket_mask()) {
+            if (!m_buckets[i].used)
+                return m_buckets[i];
+        }
+    }
+
+    Bucket* first_used_bucket() const
+    {
+        for (size_t i = 0; i < m_capacity; ++i) {
+            if (m_buckets[i].used)
+                return &m_buckets[i];
+        }
+        ASSERT_NOT_REACHED();
+        return nullptr;
+    }
+
+    bool should_grow_for_insertion() const
+    {
+        return (m_size + 1) * load_factor_denominator > m_capacity * load_factor_numerator;
+    }
+
+    template<typename U>
+    HashSetResult set_impl(U&& value);
 
-    Bucket& bucket(size_t index) { return m_buckets[index]; }
-    const Bucket& bucket(size_t index) const { return m_buckets[index]; }
+    void rehash(size_t capacity);
 
     Bucket* m_buckets { nullptr };
 
@@ -259,67 +309,73 @@ private:
 };
 
 template<typename T, typename TraitsForT>
-HashSetResult HashTable<T, TraitsForT>::set(T&& value)
+template<typename U>
+HashSetResult HashTable<T, TraitsForT>::set_impl(U&& value)
 {
+    unsigned hash = TraitsForT::hash(value);
     if (!m_capacity)
-        rehash(1);
-    auto& bucket = lookup(value);
-    for (auto& e : bucket) {
-        if (TraitsForT::equals(e, value)) {
-            e = move(value);
-            return HashSetResult::ReplacedExistingEntry;
-        }
+        rehash(minimum_capacity);
+
+    bool found;
+    auto* bucket = &lookup_for_writing(hash, value, found);
+    if (found) {
+        *bucket->slot() = forward<U>(value);
+        return HashSetResult::ReplacedExistingEntry;
     }
-    if (size() >= capacity()) {
-        rehash(size() + 1);
-        insert(move(value));
-    } else {
-        bucket.append(move(value));
+
+    if (should_grow_for_insertion()) {
+        rehash(m_capacity * 2);
+        bucket = &find_unused_bucket(hash);
     }
+
+    new (bucket->slot()) T(forward<U>(value));
+    bucket->hash = hash;
+    bucket->used = true;
     m_size++;
     return HashSetResult::InsertedNewEntry;
 }
 
+template<typename T, typename TraitsForT>
+HashSetResult HashTable<T, TraitsForT>::set(T&& value)
+{
+    return set_impl(move(value));
+}
+
 template<typename T, typename TraitsForT>
 HashSetResult HashTable<T, TraitsForT>::set(const T& value)
 {
-    if (!m_capacity)
-        rehash(1);
-    auto& bucket = lookup(value);
-    for (auto& e : bucket) {
-        if (TraitsForT::equals(e, value)) {
-            e = value;
-            return HashSetResult::ReplacedExistingEntry;
-        }
-    }
-    if (size() >= capacity()) {
-        rehash(size() + 1);
-        insert(value);
-    } else {
-        bucket.append(value);
-    }
-    m_size++;
-    return HashSetResult::InsertedNewEntry;
+    return set_impl(value);
 }
 
 template<typename T, typename TraitsForT>
 void HashTable<T, TraitsForT>::rehash(size_t new_capacity)
 {
+    ASSERT(new_capacity && !(new_capacity & (new_capacity - 1)));
     TemporaryChange<bool> change(m_rehashing, true);
-    new_capacity *= 2;
-    auto* new_buckets = new Bucket[new_capacity];
     auto* old_buckets = m_buckets;
     size_t old_capacity = m_capacity;
-    m_buckets = new_buckets;
+
+    m_buckets = (Bucket*)kmalloc(new_capacity * sizeof(Bucket));
+    __builtin_memset(m_buckets, 0, new_capacity * sizeof(Bucket));
     m_capacity = new_capacity;
 
     for (size_t i = 0; i < old_capacity; ++i) {
-        for (auto& value : old_buckets[i]) {
-            insert(move(value));
+        auto& old_bucket = old_buckets[i];
+        if (!old_bucket.used)
+            continue;
+        auto& new_bucket = find_unused_bucket(old_bucket.hash);
+        if constexpr (TraitsForT::is_trivially_relocatable()) {
+            __builtin_memcpy(new_bucket.storage, old_bucket.storage, sizeof(T));
+        } else {
+            new (new_bucket.slot()) T(move(*old_bucket.slot()));
+            old_bucket.slot()->~T();
         }
+        new_bucket.hash = old_bucket.hash;
+        new_bucket.used = true;
     }
 
-    delete[] old_buckets;
+    if (old_buckets)
+        kfree(old_buckets);
 }
 
 template<typename T, typename TraitsForT>
@@ -327,64 +383,51 @@ void HashTable<T, TraitsForT>::clear()
 {
     TemporaryChange<bool> change(m_clearing, true);
     if (m_buckets) {
-        delete[] m_buckets;
+        for (size_t i = 0; i < m_capacity; ++i) {
+            if (m_buckets[i].used)
+                m_buckets[i].slot()->~T();
+        }
+        kfree(m_buckets);
         m_buckets = nullptr;
     }
     m_capacity = 0;
     m_size = 0;
 }
 
-template<typename T, typename TraitsForT>
-void HashTable<T, TraitsForT>::insert(T&& value)
-{
-    auto& bucket = lookup(value);
-    bucket.append(move(value));
-}
-
-template<typename T, typename TraitsForT>
-void HashTable<T, TraitsForT>::insert(const T& value)
-{
-    auto& bucket = lookup(value);
-    bucket.append(value);
-}
-
 template<typename T, typename TraitsForT>
 bool HashTable<T, TraitsForT>::contains(const T& value) const
 {
-    if (is_empty())
-        return false;
-    auto& bucket = lookup(value);
-    for (auto& e : bucket) {
-        if (TraitsForT::equals(e, value))
-            return true;
-    }
-    return false;
+    return find(value) != end();
 }
 
 template<typename T, typename TraitsForT>
 void HashTable<T, TraitsForT>::remove(Iterator it)
 {
     ASSERT(!is_empty());
-    m_buckets[it.m_bucket_index].remove(it.m_bucket_iterator);
-    --m_size;
-}
+    ASSERT(it.m_bucket);
 
-template<typename T, typename TraitsForT>
-auto HashTable<T, TraitsForT>::lookup(const T& value, size_t* bucket_index) -> Bucket&
-{
-    unsigned hash = TraitsForT::hash(value);
-    if (bucket_index)
-        *bucket_index = hash % m_capacity;
-    return m_buckets[hash % m_capacity];
-}
+    size_t hole = it.m_bucket - m_buckets;
+    m_buckets[hole].slot()->~T();
+    m_buckets[hole].used = false;
+    --m_size;
 
-template<typename T, typename TraitsForT>
-auto HashTable<T, TraitsForT>::lookup(const T& value, size_t* bucket_index) const -> const Bucket&
-{
-    unsigned hash = TraitsForT::hash(value);
-    if (bucket_index)
-        *bucket_index = hash % m_capacity;
-    return m_buckets[hash % m_capacity];
+    // Backward-shift deletion: pull later members of the probe sequence into the hole,
+    // as long as doing so doesn't move an element in front of its home bucket.
+    for (size_t i = (hole + 1) & bucket_mask(); m_buckets[i].used; i = (i + 1) & bucket_mask()) {
+        auto& bucket = m_buckets[i];
+        size_t home = bucket.hash & bucket_mask();
+        size_t distance_from_home = (i - home) & bucket_mask();
+        size_t distance_from_hole = (i - hole) & bucket_mask();
+        if (distance_from_home < distance_from_hole)
+            continue;
+        auto& hole_bucket = m_buckets[hole];
+        new (hole_bucket.slot()) T(move(*bucket.slot()));
+        hole_bucket.hash = bucket.hash;
+        hole_bucket.used = true;
+        bucket.slot()->~T();
+        bucket.used = false;
+        hole = i;
+    }
 }
 
 }
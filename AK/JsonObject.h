@@ -41,14 +41,14 @@ public:
     ~JsonObject() {}
 
     JsonObject(const JsonObject& other)
-        : m_order(other.m_order)
-        , m_members(other.m_members)
+        : m_members(other.m_members)
+        , m_index(other.m_index)
     {
     }
 
     JsonObject(JsonObject&& other)
-        : m_order(move(other.m_order))
-        , m_members(move(other.m_members))
+        : m_members(move(other.m_members))
+        , m_index(move(other.m_index))
     {
     }
 
@@ -56,7 +56,7 @@ public:
     {
         if (this != &other) {
             m_members = other.m_members;
-            m_order = other.m_order;
+            m_index = other.m_index;
         }
         return *this;
     }
@@ -65,7 +65,7 @@ public:
     {
         if (this != &other) {
             m_members = move(other.m_members);
-            m_order = move(other.m_order);
+            m_index = move(other.m_index);
         }
         return *this;
     }
@@ -87,31 +87,39 @@ public:
 
     const JsonValue* get_ptr(const String& key) const
     {
-        auto it = m_members.find(key);
-        if (it == m_members.end())
+        auto index = find_member(key);
+        if (!index.has_value())
             return nullptr;
-        return &(*it).value;
+        return &m_members[index.value()].value;
     }
 
     bool has(const String& key) const
     {
-        return m_members.contains(key);
+        return find_member(key).has_value();
     }
 
     void set(const String& key, JsonValue value)
     {
-        if (m_members.set(key, move(value)) == HashSetResult::ReplacedExistingEntry)
-            m_order.remove(m_order.find_first_index(key).value());
-        m_order.append(key);
+        // Setting an existing key moves it to the end, as if it had been removed and added again.
+        if (auto index = find_member(key); index.has_value()) {
+            m_members.remove(index.value());
+            if (!m_index.is_empty()) {
+                for (size_t i = index.value(); i < m_members.size(); ++i)
+                    m_index.set(m_members[i].key, i);
+            }
+        }
+        m_members.append({ key, move(value) });
+        if (!m_index.is_empty())
+            m_index.set(key, m_members.size() - 1);
+        else if (m_members.size() == index_threshold)
+            build_index();
     }
 
     template<typename Callback>
     void for_each_member(Callback callback) const
     {
-        for (size_t i = 0; i < m_order.size(); ++i) {
-            auto property = m_order[i];
-            callback(property, m_members.get(property).value());
-        }
+        for (auto& member : m_members)
+            callback(member.key, member.value);
     }
 
     template<typename Builder>
@@ -123,8 +131,34 @@ public:
     String to_string() const { return serialized<StringBuilder>(); }
 
 private:
-    Vector<String> m_order;
-    HashMap<String, JsonValue> m_members;
+    struct Member {
+        String key;
+        JsonValue value;
+    };
+
+    // Small objects are searched linearly. Past this many members, a hash index is kept as well.
+    static constexpr size_t index_threshold = 8;
+
+    Optional<size_t> find_member(const String& key) const
+    {
+        if (!m_index.is_empty())
+            return m_index.get(key);
+        for (size_t i = 0; i < m_members.size(); ++i) {
+            if (m_members[i].key == key)
+                return i;
+        }
+        return {};
+    }
+
+    void build_index()
+    {
+        m_index.ensure_capacity(m_members.size());
+        for (size_t i = 0; i < m_members.size(); ++i)
+            m_index.set(m_members[i].key, i);
+    }
+
+    Vector<Member> m_members;
+    HashMap<String, size_t> m_index;
 };
 
 template<typename Builder>
@@ -188,9 +222,16 @@ inline void JsonValue::serialize(Builder& builder) const
         builder.append(m_value.as_bool ? "true" : "false");
         break;
 #if !defined(KERNEL)
-    case Type::Double:
-        builder.appendf("%g", m_value.as_double);
-        break;
+    case Type::Double: {
+        // Like JSON.stringify(), write NaN and the infinities as null since JSON has no way to spell them.
+        if (!__builtin_isfinite(m_value.as_double)) {
+            builder.append("null");
+            break;
+        }
+        char buffer[double_string_buffer_size];
+        auto length = format_double(m_value.as_double, buffer);
+        builder.append(StringView(buffer, length));
+    } break;
 #endif
     case Type::Int32:
         builder.appendf("%d", as_i32());
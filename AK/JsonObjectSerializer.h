@@ -26,6 +26,7 @@
 
 #pragma once
 
+#include <AK/DoubleConversion.h>
 #include <AK/JsonArraySerializer.h>
 #include <AK/JsonValue.h>
 
@@ -121,11 +122,15 @@ public:
         m_builder.appendf("%llu", value);
     }
 
+#ifndef KERNEL
     void add(const StringView& key, double value)
     {
         begin_item(key);
-        m_builder.appendf("%f", value);
+        char buffer[double_string_buffer_size];
+        auto length = format_double(value, buffer);
+        m_builder.append(StringView(buffer, length));
     }
+#endif
 
     JsonArraySerializer<Builder> add_array(const StringView& key)
     {
@@ -27,14 +27,16 @@
 #pragma once
 
 #include <AK/JsonValue.h>
-#include <AK/GenericLexer.h>
+#include <AK/StringView.h>
 
 namespace AK {
 
-class JsonParser : private GenericLexer {
+// Builds a JsonValue tree out of the events of a JsonPullParser.
+// Code that only needs a few values out of a large document can use JsonPullParser directly.
+class JsonParser {
 public:
     explicit JsonParser(const StringView& input)
-        : GenericLexer(input)
+        : m_input(input)
     {
     }
     ~JsonParser()
@@ -44,18 +46,7 @@ public:
     Optional<JsonValue> parse();
 
 private:
-    Optional<JsonValue> parse_helper();
-
-    String consume_and_unescape_string();
-    Optional<JsonValue> parse_array();
-    Optional<JsonValue> parse_object();
-    Optional<JsonValue> parse_number();
-    Optional<JsonValue> parse_string();
-    Optional<JsonValue> parse_false();
-    Optional<JsonValue> parse_true();
-    Optional<JsonValue> parse_null();
-
-    String m_last_string_starting_with_character[256];
+    StringView m_input;
 };
 
 }
@@ -0,0 +1,309 @@
+/*
+ * Copyright (c) 2020, The SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <AK/DoubleConversion.h>
+#include <AK/JsonPullParser.h>
+#include <AK/NumericLimits.h>
+#include <AK/StringUtils.h>
+
+namespace AK {
+
+void JsonPullParser::skip_whitespace()
+{
+    while (m_index < m_input.length() && is_whitespace(m_input[m_index]))
+        ++m_index;
+}
+
+JsonPullParser::Event JsonPullParser::fail()
+{
+    m_state = State::Done;
+    return m_event = Event::Error;
+}
+
+JsonPullParser::Event JsonPullParser::next()
+{
+    skip_whitespace();
+    switch (m_state) {
+    case State::Value:
+        return parse_value();
+    case State::FirstKeyOrEnd:
+        if (peek() == '}')
+            return end_container('}');
+        return parse_key();
+    case State::FirstValueOrEnd:
+        if (peek() == ']')
+            return end_container(']');
+        return parse_value();
+    case State::AfterValue:
+        if (m_containers.is_empty()) {
+            if (!is_eof())
+                return fail();
+            m_state = State::Done;
+            return m_event = Event::End;
+        }
+        if (consume_specific(',')) {
+            skip_whitespace();
+            if (m_containers.last() == '}')
+                return parse_key();
+            return parse_value();
+        }
+        return end_container(m_containers.last());
+    case State::Done:
+        return m_event;
+    }
+    ASSERT_NOT_REACHED();
+}
+
+bool JsonPullParser::skip_value()
+{
+    if (m_event != Event::ObjectStart && m_event != Event::ArrayStart)
+        return m_event != Event::Error;
+    auto depth_after_value = depth() - 1;
+    while (depth() != depth_after_value) {
+        if (next() == Event::Error)
+            return false;
+    }
+    return true;
+}
+
+JsonValue JsonPullParser::value() const
+{
+    switch (m_event) {
+    case Event::String:
+        return JsonValue(String(m_string));
+    case Event::Number:
+    case Event::Bool:
+        return m_scalar;
+    default:
+        return JsonValue(JsonValue::Type::Null);
+    }
+}
+
+JsonPullParser::Event JsonPullParser::end_container(char closing)
+{
+    if (!consume_specific(closing))
+        return fail();
+    m_containers.take_last();
+    m_state = State::AfterValue;
+    return m_event = closing == '}' ? Event::ObjectEnd : Event::ArrayEnd;
+}
+
+JsonPullParser::Event JsonPullParser::parse_key()
+{
+    if (!parse_string())
+        return fail();
+    skip_whitespace();
+    if (!consume_specific(':'))
+        return fail();
+    m_state = State::Value;
+    return m_event = Event::Key;
+}
+
+JsonPullParser::Event JsonPullParser::parse_value()
+{
+    switch (peek()) {
+    case '{':
+        ignore();
+        m_containers.append('}');
+        m_state = State::FirstKeyOrEnd;
+        return m_event = Event::ObjectStart;
+    case '[':
+        ignore();
+        m_containers.append(']');
+        m_state = State::FirstValueOrEnd;
+        return m_event = Event::ArrayStart;
+    case '"':
+        if (!parse_string())
+            return fail();
+        m_state = State::AfterValue;
+        return m_event = Event::String;
+    case 't':
+    case 'f':
+        if (consume_specific("true"))
+            m_scalar = JsonValue(true);
+        else if (consume_specific("false"))
+            m_scalar = JsonValue(false);
+        else
+            return fail();
+        m_state = State::AfterValue;
+        return m_event = Event::Bool;
+    case 'n':
+        if (!consume_specific("null"))
+            return fail();
+        m_state = State::AfterValue;
+        return m_event = Event::Null;
+    case '-':
+    case '0':
+    case '1':
+    case '2':
+    case '3':
+    case '4':
+    case '5':
+    case '6':
+    case '7':
+    case '8':
+    case '9':
+        return parse_number();
+    default:
+        return fail();
+    }
+}
+
+bool JsonPullParser::parse_string()
+{
+    if (!consume_specific('"'))
+        return false;
+
+    // Most strings have no escapes, and can be handed out as a view into the input.
+    size_t start = m_index;
+    for (; m_index < m_input.length(); ++m_index) {
+        char ch = m_input[m_index];
+        if (ch == '"') {
+            m_string = m_input.substring_view(start, m_index - start);
+            ++m_index;
+            return true;
+        }
+        if (ch == '\\')
+            break;
+    }
+    if (is_eof())
+        return false;
+
+    m_string_buffer.clear();
+    m_string_buffer.append(m_input.substring_view(start, m_index - start));
+    for (;;) {
+        if (is_eof())
+            return false;
+        char ch = consume();
+        if (ch == '"')
+            break;
+        if (ch != '\\') {
+            m_string_buffer.append(ch);
+            continue;
+        }
+        if (is_eof())
+            return false;
+        char escaped_ch = consume();
+        switch (escaped_ch) {
+        case 'n':
+            m_string_buffer.append('\n');
+            break;
+        case 'r':
+            m_string_buffer.append('\r');
+            break;
+        case 't':
+            m_string_buffer.append('\t');
+            break;
+        case 'b':
+            m_string_buffer.append('\b');
+            break;
+        case 'f':
+            m_string_buffer.append('\f');
+            break;
+        case 'u': {
+            auto code_point = StringUtils::convert_to_uint_from_hex(consume(4));
+            if (code_point.has_value())
+                m_string_buffer.append_code_point(code_point.value());
+            else
+                m_string_buffer.append('?');
+        } break;
+        default:
+            m_string_buffer.append(escaped_ch);
+            break;
+        }
+    }
+    m_string = m_string_buffer.string_view();
+    return true;
+}
+
+JsonPullParser::Event JsonPullParser::parse_number()
+{
+    size_t start = m_index;
+    bool negative = consume_specific('-');
+    if (!is_digit(peek()))
+        return fail();
+
+    // Integers are accumulated straight into a u64. Anything that doesn't fit in 64 bits,
+    // or has a fraction or an exponent, is handed to parse_double() once we know where it ends.
+    u64 digits = 0;
+    bool is_integer = true;
+    while (is_digit(peek())) {
+        unsigned digit = consume() - '0';
+        if (digits > (NumericLimits<u64>::max() - digit) / 10)
+            is_integer = false;
+        else
+            digits = digits * 10 + digit;
+    }
+    if (peek() == '.') {
+        ignore();
+        if (!is_digit(peek()))
+            return fail();
+        is_integer = false;
+        while (is_digit(peek()))
+            ignore();
+    }
+    if (peek() == 'e' || peek() == 'E') {
+        ignore();
+        is_integer = false;
+        if (peek() == '+' || peek() == '-')
+            ignore();
+        if (!is_digit(peek()))
+            return fail();
+        while (is_digit(peek()))
+            ignore();
+    }
+
+    m_state = State::AfterValue;
+    if (is_integer) {
+        if (!negative) {
+            if (digits <= NumericLimits<u32>::max())
+                m_scalar = JsonValue((u32)digits);
+            else
+                m_scalar = JsonValue((u64)digits);
+            return m_event = Event::Number;
+        }
+        if (digits <= (u64)NumericLimits<i32>::max() + 1) {
+            m_scalar = JsonValue((i32)(0 - (i64)digits));
+            return m_event = Event::Number;
+        }
+        if (digits <= (u64)NumericLimits<i64>::max() + 1) {
+            m_scalar = JsonValue((i64)(0 - digits));
+            return m_event = Event::Number;
+        }
+    }
+
+#ifndef KERNEL
+    auto value = parse_double(m_input.substring_view(start, m_index - start));
+    ASSERT(value.has_value());
+    m_scalar = JsonValue(value.value());
+    return m_event = Event::Number;
+#else
+    (void)start;
+    return fail();
+#endif
+}
+
+}
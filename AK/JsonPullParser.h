@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2020, The SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/GenericLexer.h>
+#include <AK/JsonValue.h>
+#include <AK/StringBuilder.h>
+#include <AK/Vector.h>
+
+namespace AK {
+
+// Reads a JSON document one token at a time, without building a JsonValue tree.
+//
+//     JsonPullParser parser(input);
+//     for (auto event = parser.next(); event != JsonPullParser::Event::End; event = parser.next()) {
+//         if (event == JsonPullParser::Event::Error)
+//             return false;
+//         ...
+//     }
+//
+// The views returned by string() point either into the input or into a buffer
+// owned by the parser, and are only valid until the next call to next().
+class JsonPullParser : private GenericLexer {
+public:
+    enum class Event {
+        ObjectStart,
+        ObjectEnd,
+        ArrayStart,
+        ArrayEnd,
+        Key,
+        String,
+        Number,
+        Bool,
+        Null,
+        End,
+        Error,
+    };
+
+    explicit JsonPullParser(const StringView& input)
+        : GenericLexer(input)
+    {
+    }
+
+    Event next();
+
+    // Skips over the value the last event started, so the next event is whatever follows it.
+    // Returns false if the value is malformed.
+    bool skip_value();
+
+    // The key or string of the last Key or String event.
+    StringView string() const { return m_string; }
+
+    // The last String, Number, Bool or Null event as a JsonValue.
+    JsonValue value() const;
+
+    // The number of objects and arrays the parser is currently inside of.
+    size_t depth() const { return m_containers.size(); }
+
+private:
+    enum class State {
+        Value,
+        FirstKeyOrEnd,
+        FirstValueOrEnd,
+        AfterValue,
+        Done,
+    };
+
+    void skip_whitespace();
+    Event fail();
+    Event parse_value();
+    Event parse_key();
+    bool parse_string();
+    Event parse_number();
+    Event end_container(char closing);
+
+    Vector<char, 16> m_containers;
+    State m_state { State::Value };
+    Event m_event { Event::Error };
+    StringView m_string;
+    StringBuilder m_string_buffer;
+    JsonValue m_scalar;
+};
+
+}
+
+using AK::JsonPullParser;
@@ -117,6 +117,7 @@ public:
 
     unsigned to_uint(unsigned default_value = 0) const { return to_u32(default_value); }
     u32 to_u32(u32 default_value = 0) const { return to_number<u32>(default_value); }
+    u64 to_u64(u64 default_value = 0) const { return to_number<u64>(default_value); }
 
     bool to_bool(bool default_value = false) const
     {
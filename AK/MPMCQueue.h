@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/Assertions.h>
+#include <AK/Atomic.h>
+#include <AK/Optional.h>
+#include <AK/StdLibExtras.h>
+#include <AK/Types.h>
+
+namespace AK {
+
+// A bounded queue that any number of threads can enqueue to and dequeue from at the same
+// time, without locks (Dmitry Vyukov's design). Every slot carries a sequence number that
+// says whether it's ready to be written or read for a given lap around the ring, so
+// producers and consumers only ever contend on their own position counter.
+template<typename T, size_t Capacity>
+class MPMCQueue {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "MPMCQueue capacity must be a power of two");
+    static constexpr size_t cache_line_size = 64;
+    static constexpr size_t index_mask = Capacity - 1;
+
+public:
+    MPMCQueue()
+    {
+        for (size_t i = 0; i < Capacity; ++i)
+            m_cells[i].sequence.store(i, AK::memory_order_relaxed);
+    }
+
+    ~MPMCQueue()
+    {
+        while (try_dequeue().has_value())
+            ;
+    }
+
+    size_t capacity() const { return Capacity; }
+
+    // Only exact when no other thread is busy with the queue.
+    size_t size() const { return m_enqueue_position.load(AK::memory_order_acquire) - m_dequeue_position.load(AK::memory_order_acquire); }
+    bool is_empty() const { return size() == 0; }
+
+    // Returns false (and leaves value alone) if the queue is full.
+    bool try_enqueue(T&& value)
+    {
+        Cell* cell;
+        size_t position = m_enqueue_position.load(AK::memory_order_relaxed);
+        for (;;) {
+            cell = &m_cells[position & index_mask];
+            size_t sequence = cell->sequence.load(AK::memory_order_acquire);
+            auto difference = static_cast<ssize_t>(sequence - position);
+            if (difference == 0) {
+                if (m_enqueue_position.compare_exchange_strong(position, position + 1, AK::memory_order_relaxed))
+                    break;
+            } else if (difference < 0) {
+                // This slot still holds a value from the previous lap.
+                return false;
+            } else {
+                position = m_enqueue_position.load(AK::memory_order_relaxed);
+            }
+        }
+        new (cell->storage) T(move(value));
+        cell->sequence.store(position + 1, AK::memory_order_release);
+        return true;
+    }
+
+    bool try_enqueue(const T& value)
+    {
+        T copy(value);
+        return try_enqueue(move(copy));
+    }
+
+    Optional<T> try_dequeue()
+    {
+        Cell* cell;
+        size_t position = m_dequeue_position.load(AK::memory_order_relaxed);
+        for (;;) {
+            cell = &m_cells[position & index_mask];
+            size_t sequence = cell->sequence.load(AK::memory_order_acquire);
+            auto difference = static_cast<ssize_t>(sequence - (position + 1));
+            if (difference == 0) {
+                if (m_dequeue_position.compare_exchange_strong(position, position + 1, AK::memory_order_relaxed))
+                    break;
+            } else if (difference < 0) {
+                // Nothing has been written to this slot in this lap yet.
+                return {};
+            } else {
+                position = m_dequeue_position.load(AK::memory_order_relaxed);
+            }
+        }
+        auto& slot = *reinterpret_cast<T*>(cell->storage);
+        T value = move(slot);
+        slot.~T();
+        cell->sequence.store(position + Capacity, AK::memory_order_release);
+        return value;
+    }
+
+private:
+    struct Cell {
+        Atomic<size_t> sequence;
+        alignas(T) u8 storage[sizeof(T)];
+    };
+
+    alignas(cache_line_size) Atomic<size_t> m_enqueue_position { 0 };
+    alignas(cache_line_size) Atomic<size_t> m_dequeue_position { 0 };
+    alignas(cache_line_size) Cell m_cells[Capacity];
+};
+
+}
+
+using AK::MPMCQueue;
@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/QuickSort.h>
+#include <AK/StdLibExtras.h>
+#include <AK/Vector.h>
+
+namespace AK {
+
+/* A stable sort: elements that compare equal keep their relative order.
+ * It sorts short runs with insertion sort and merges them top-down, moving the
+ * left half of each merge into a scratch buffer, so it needs up to n / 2 extra
+ * elements of memory. Unlike quick_sort(), it needs to be able to move elements
+ * out of the collection, so it doesn't work on proxy objects.
+ */
+namespace Detail {
+
+static constexpr size_t merge_sort_run_size = 16;
+
+template<typename Collection, typename T, typename LessThan>
+void merge_adjacent(Collection& col, size_t begin, size_t middle, size_t end, Vector<T>& buffer, LessThan& less_than)
+{
+    // The two halves may well already be in order.
+    if (!less_than(col[middle], col[middle - 1]))
+        return;
+
+    buffer.clear_with_capacity();
+    for (size_t i = begin; i < middle; ++i)
+        buffer.append(move(col[i]));
+
+    size_t left = 0;
+    size_t right = middle;
+    size_t out = begin;
+    while (left < buffer.size() && right < end) {
+        // Only take from the right half when it is strictly less, to keep equal elements in order.
+        if (less_than(col[right], buffer[left]))
+            col[out++] = move(col[right++]);
+        else
+            col[out++] = move(buffer[left++]);
+    }
+    while (left < buffer.size())
+        col[out++] = move(buffer[left++]);
+}
+
+template<typename Collection, typename T, typename LessThan>
+void merge_sort_range(Collection& col, size_t begin, size_t end, Vector<T>& buffer, LessThan& less_than)
+{
+    if (end - begin <= merge_sort_run_size) {
+        insertion_sort(col, begin, end, less_than);
+        return;
+    }
+    size_t middle = begin + (end - begin) / 2;
+    merge_sort_range(col, begin, middle, buffer, less_than);
+    merge_sort_range(col, middle, end, buffer, less_than);
+    merge_adjacent(col, begin, middle, end, buffer, less_than);
+}
+
+}
+
+template<typename Collection, typename LessThan>
+void merge_sort(Collection& collection, size_t begin, size_t end, LessThan less_than)
+{
+    using ElementType = typename RemoveConst<typename RemoveReference<decltype(collection[0])>::Type>::Type;
+    if (end - begin <= 1)
+        return;
+    Vector<ElementType> buffer;
+    buffer.ensure_capacity((end - begin) / 2 + 1);
+    Detail::merge_sort_range(collection, begin, end, buffer, less_than);
+}
+
+template<typename Collection, typename LessThan>
+void merge_sort(Collection& collection, LessThan less_than)
+{
+    merge_sort(collection, 0, collection.size(), move(less_than));
+}
+
+template<typename Collection>
+void merge_sort(Collection& collection)
+{
+    merge_sort(collection, [](auto& a, auto& b) { return a < b; });
+}
+
+}
+
+using AK::merge_sort;
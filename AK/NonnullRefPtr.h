@@ -29,6 +29,7 @@
 #include <AK/Assertions.h>
 #include <AK/LogStream.h>
 #include <AK/StdLibExtras.h>
+#include <AK/Traits.h>
 #include <AK/Types.h>
 
 namespace AK {
@@ -254,6 +255,11 @@ inline void swap(NonnullRefPtr<T>& a, NonnullRefPtr<U>& b)
     a.swap(b);
 }
 
+template<typename T>
+struct Traits<NonnullRefPtr<T>> : public GenericTraits<NonnullRefPtr<T>> {
+    static constexpr bool is_trivially_relocatable() { return true; }
+};
+
 }
 
 using AK::adopt;
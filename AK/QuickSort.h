@@ -27,88 +27,252 @@
 #pragma once
 
 #include <AK/StdLibExtras.h>
+#include <AK/Types.h>
 
 namespace AK {
 
-/* This is a dual pivot quick sort. It is quite a bit faster than the single
- * pivot quick_sort below. The other quick_sort below should only be used when
- * you are stuck with simple iterators to a container and you don't have access
- * to the container itself.
+/* This is a pattern-defeating quicksort (Orson Peters' pdqsort, simplified).
+ * It uses a median of three (or Tukey's ninther for larger ranges) as the pivot,
+ * sorts small ranges with insertion sort, groups elements that are equal to the
+ * pivot in one pass when there are many duplicates, and falls back to heapsort
+ * after too many bad partitions, so that it stays O(n log n) even on adversarial
+ * input. It always recurses into the smaller half, so the stack stays O(log n).
+ *
+ * It touches the elements only through operator[], the less_than predicate and
+ * swap(), which lets it sort proxy objects like the ones qsort() uses.
+ * It is not stable; see merge_sort() for that.
  */
+namespace Detail {
+
+static constexpr size_t insertion_sort_threshold = 16;
+static constexpr size_t ninther_threshold = 128;
+static constexpr size_t partial_insertion_sort_limit = 8;
+
 template<typename Collection, typename LessThan>
-void dual_pivot_quick_sort(Collection& col, int start, int end, LessThan less_than)
+void insertion_sort(Collection& col, size_t begin, size_t end, LessThan& less_than)
 {
-    if (start >= end) {
-        return;
+    for (size_t i = begin + 1; i < end; ++i) {
+        for (size_t j = i; j > begin && less_than(col[j], col[j - 1]); --j)
+            swap(col[j], col[j - 1]);
     }
+}
 
-    int left_pointer, right_pointer;
-    if (!less_than(col[start], col[end])) {
-        swap(col[start], col[end]);
+// Like insertion_sort(), but gives up (and returns false) once it has had to move elements too far.
+template<typename Collection, typename LessThan>
+bool partial_insertion_sort(Collection& col, size_t begin, size_t end, LessThan& less_than)
+{
+    size_t moves = 0;
+    for (size_t i = begin + 1; i < end; ++i) {
+        for (size_t j = i; j > begin && less_than(col[j], col[j - 1]); --j) {
+            swap(col[j], col[j - 1]);
+            ++moves;
+        }
+        if (moves > partial_insertion_sort_limit)
+            return false;
     }
+    return true;
+}
 
-    int j = start + 1;
-    int k = start + 1;
-    int g = end - 1;
+template<typename Collection, typename LessThan>
+void sift_down(Collection& col, size_t begin, size_t size, size_t root, LessThan& less_than)
+{
+    for (;;) {
+        size_t child = 2 * root + 1;
+        if (child >= size)
+            return;
+        if (child + 1 < size && less_than(col[begin + child], col[begin + child + 1]))
+            ++child;
+        if (!less_than(col[begin + root], col[begin + child]))
+            return;
+        swap(col[begin + root], col[begin + child]);
+        root = child;
+    }
+}
 
-    auto left_pivot = col[start];
-    auto right_pivot = col[end];
+template<typename Collection, typename LessThan>
+void heap_sort(Collection& col, size_t begin, size_t end, LessThan& less_than)
+{
+    size_t size = end - begin;
+    for (size_t i = size / 2; i-- > 0;)
+        sift_down(col, begin, size, i, less_than);
+    for (size_t i = size - 1; i > 0; --i) {
+        swap(col[begin], col[begin + i]);
+        sift_down(col, begin, i, 0, less_than);
+    }
+}
 
-    while (k <= g) {
-        if (less_than(col[k], left_pivot)) {
-            swap(col[k], col[j]);
-            j++;
-        } else if (!less_than(col[k], right_pivot)) {
-            while (!less_than(col[g], right_pivot) && k < g) {
-                g--;
-            }
-            swap(col[k], col[g]);
-            g--;
-            if (less_than(col[k], left_pivot)) {
-                swap(col[k], col[j]);
-                j++;
-            }
-        }
-        k++;
+template<typename Collection, typename LessThan>
+void sort2(Collection& col, size_t a, size_t b, LessThan& less_than)
+{
+    if (less_than(col[b], col[a]))
+        swap(col[a], col[b]);
+}
+
+template<typename Collection, typename LessThan>
+void sort3(Collection& col, size_t a, size_t b, size_t c, LessThan& less_than)
+{
+    sort2(col, a, b, less_than);
+    sort2(col, b, c, less_than);
+    sort2(col, a, b, less_than);
+}
+
+// Partitions [begin, end) around the pivot in col[begin], and returns its final position. Elements less
+// than the pivot end up to its left, the rest to its right.
+template<typename Collection, typename LessThan>
+size_t partition_right(Collection& col, size_t begin, size_t end, LessThan& less_than, bool& already_partitioned)
+{
+    size_t first = begin + 1;
+    size_t last = end - 1;
+    while (first <= last && less_than(col[first], col[begin]))
+        ++first;
+    while (first <= last && !less_than(col[last], col[begin]))
+        --last;
+
+    already_partitioned = first > last;
+    while (first < last) {
+        swap(col[first], col[last]);
+        ++first;
+        --last;
+        while (first <= last && less_than(col[first], col[begin]))
+            ++first;
+        while (first <= last && !less_than(col[last], col[begin]))
+            --last;
+    }
+
+    size_t pivot = first - 1;
+    swap(col[begin], col[pivot]);
+    return pivot;
+}
+
+// Like partition_right(), but elements equal to the pivot end up to its left.
+template<typename Collection, typename LessThan>
+size_t partition_left(Collection& col, size_t begin, size_t end, LessThan& less_than)
+{
+    size_t first = begin + 1;
+    size_t last = end - 1;
+    while (first <= last && !less_than(col[begin], col[first]))
+        ++first;
+    while (first <= last && less_than(col[begin], col[last]))
+        --last;
+
+    while (first < last) {
+        swap(col[first], col[last]);
+        ++first;
+        --last;
+        while (first <= last && !less_than(col[begin], col[first]))
+            ++first;
+        while (first <= last && less_than(col[begin], col[last]))
+            --last;
     }
-    j--;
-    g++;
 
-    swap(col[start], col[j]);
-    swap(col[end], col[g]);
+    size_t pivot = first - 1;
+    swap(col[begin], col[pivot]);
+    return pivot;
+}
+
+template<typename Collection, typename LessThan>
+void pattern_defeating_quick_sort(Collection& col, size_t begin, size_t end, LessThan& less_than, size_t bad_partitions_allowed, bool leftmost)
+{
+    for (;;) {
+        size_t size = end - begin;
+        if (size < insertion_sort_threshold) {
+            insertion_sort(col, begin, end, less_than);
+            return;
+        }
+
+        // Move the pivot to col[begin].
+        size_t half = size / 2;
+        if (size > ninther_threshold) {
+            sort3(col, begin, begin + half, end - 1, less_than);
+            sort3(col, begin + 1, begin + half - 1, end - 2, less_than);
+            sort3(col, begin + 2, begin + half + 1, end - 3, less_than);
+            sort3(col, begin + half - 1, begin + half, begin + half + 1, less_than);
+            swap(col[begin], col[begin + half]);
+        } else {
+            sort3(col, begin + half, begin, end - 1, less_than);
+        }
+
+        // The element just before this range is not greater than anything in it. If it is equal to the
+        // pivot, so is everything that would go left of the pivot; put all of those in place at once.
+        if (!leftmost && !less_than(col[begin - 1], col[begin])) {
+            begin = partition_left(col, begin, end, less_than) + 1;
+            continue;
+        }
 
-    left_pointer = j;
-    right_pointer = g;
+        bool already_partitioned;
+        size_t pivot = partition_right(col, begin, end, less_than, already_partitioned);
 
-    dual_pivot_quick_sort(col, start, left_pointer - 1, less_than);
-    dual_pivot_quick_sort(col, left_pointer + 1, right_pointer - 1, less_than);
-    dual_pivot_quick_sort(col, right_pointer + 1, end, less_than);
+        size_t left_size = pivot - begin;
+        size_t right_size = end - (pivot + 1);
+        if (left_size < size / 8 || right_size < size / 8) {
+            if (--bad_partitions_allowed == 0) {
+                heap_sort(col, begin, end, less_than);
+                return;
+            }
+            // Shuffle a few elements around to break up whatever pattern led to this pivot.
+            if (left_size >= insertion_sort_threshold) {
+                swap(col[begin], col[begin + left_size / 4]);
+                swap(col[pivot - 1], col[pivot - left_size / 4]);
+            }
+            if (right_size >= insertion_sort_threshold) {
+                swap(col[pivot + 1], col[pivot + 1 + right_size / 4]);
+                swap(col[end - 1], col[end - right_size / 4]);
+            }
+        } else if (already_partitioned) {
+            // Nothing had to move, so the range may well be sorted already.
+            if (partial_insertion_sort(col, begin, pivot, less_than) && partial_insertion_sort(col, pivot + 1, end, less_than))
+                return;
+        }
+
+        if (left_size < right_size) {
+            pattern_defeating_quick_sort(col, begin, pivot, less_than, bad_partitions_allowed, leftmost);
+            begin = pivot + 1;
+            leftmost = false;
+        } else {
+            pattern_defeating_quick_sort(col, pivot + 1, end, less_than, bad_partitions_allowed, false);
+            end = pivot;
+        }
+    }
 }
 
-template<typename Iterator, typename LessThan>
-void quick_sort(Iterator start, Iterator end, LessThan less_than)
+template<typename Collection, typename LessThan>
+void sort_range(Collection& col, size_t begin, size_t end, LessThan& less_than)
 {
-    int size = end - start;
+    size_t size = end - begin;
     if (size <= 1)
         return;
+    size_t log2_size = 0;
+    while (size >>= 1)
+        ++log2_size;
+    pattern_defeating_quick_sort(col, begin, end, less_than, log2_size, true);
+}
 
-    int pivot_point = size / 2;
-    auto pivot = *(start + pivot_point);
+template<typename Iterator>
+class IteratorRange {
+public:
+    explicit IteratorRange(Iterator start)
+        : m_start(start)
+    {
+    }
+    decltype(auto) operator[](size_t index) { return *(m_start + index); }
 
-    if (pivot_point)
-        swap(*(start + pivot_point), *start);
+private:
+    Iterator m_start;
+};
 
-    int i = 1;
-    for (int j = 1; j < size; ++j) {
-        if (less_than(*(start + j), pivot)) {
-            swap(*(start + j), *(start + i));
-            ++i;
-        }
-    }
+}
+
+template<typename Collection, typename LessThan>
+void quick_sort(Collection& collection, size_t begin, size_t end, LessThan less_than)
+{
+    Detail::sort_range(collection, begin, end, less_than);
+}
 
-    swap(*start, *(start + i - 1));
-    quick_sort(start, start + i - 1, less_than);
-    quick_sort(start + i, end, less_than);
+template<typename Iterator, typename LessThan>
+void quick_sort(Iterator start, Iterator end, LessThan less_than)
+{
+    Detail::IteratorRange<Iterator> range { start };
+    Detail::sort_range(range, 0, end - start, less_than);
 }
 
 template<typename Iterator>
@@ -120,14 +284,13 @@ void quick_sort(Iterator start, Iterator end)
 template<typename Collection, typename LessThan>
 void quick_sort(Collection& collection, LessThan less_than)
 {
-    dual_pivot_quick_sort(collection, 0, collection.size() - 1, move(less_than));
+    Detail::sort_range(collection, 0, collection.size(), less_than);
 }
 
 template<typename Collection>
 void quick_sort(Collection& collection)
 {
-    dual_pivot_quick_sort(collection, 0, collection.size() - 1,
-        [](auto& a, auto& b) { return a < b; });
+    quick_sort(collection, [](auto& a, auto& b) { return a < b; });
 }
 
 }
@@ -72,6 +72,20 @@ public:
         ASSERT(!Checked<RefCountType>::addition_would_overflow(old_ref_count, 1));
     }
 
+    // Takes a reference unless the count has already dropped to zero and the object is on
+    // its way to being destroyed. This is for caches that hold raw pointers to objects
+    // that remove themselves when they die, and may be looked up from another thread.
+    [[nodiscard]] ALWAYS_INLINE bool try_ref() const
+    {
+        RefCountType expected = m_ref_count.load(memory_order_relaxed);
+        do {
+            if (expected == 0)
+                return false;
+            ASSERT(!Checked<RefCountType>::addition_would_overflow(expected, 1));
+        } while (!m_ref_count.compare_exchange_strong(expected, expected + 1, memory_order_acquire));
+        return true;
+    }
+
     ALWAYS_INLINE RefCountType ref_count() const
     {
         return m_ref_count;
@@ -280,6 +280,7 @@ struct Traits<RefPtr<T>> : public GenericTraits<RefPtr<T>> {
     using PeekType = const T*;
     static unsigned hash(const RefPtr<T>& p) { return ptr_hash(p.ptr()); }
     static bool equals(const RefPtr<T>& a, const RefPtr<T>& b) { return a.ptr() == b.ptr(); }
+    static constexpr bool is_trivially_relocatable() { return true; }
 };
 
 template<typename T, typename U>
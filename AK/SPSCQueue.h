@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/Assertions.h>
+#include <AK/Atomic.h>
+#include <AK/Optional.h>
+#include <AK/StdLibExtras.h>
+#include <AK/Types.h>
+
+namespace AK {
+
+// A bounded queue for handing values from exactly one producer thread to exactly one
+// consumer thread, without locks. try_enqueue() may only be called by the producer, and
+// try_dequeue() only by the consumer.
+//
+// Both sides keep a cached copy of the other side's index, so they only touch the other
+// side's cache line when the queue looks full (or empty).
+template<typename T, size_t Capacity>
+class SPSCQueue {
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "SPSCQueue capacity must be a power of two");
+    static constexpr size_t cache_line_size = 64;
+    static constexpr size_t index_mask = Capacity - 1;
+
+public:
+    SPSCQueue() { }
+    ~SPSCQueue()
+    {
+        while (try_dequeue().has_value())
+            ;
+    }
+
+    size_t capacity() const { return Capacity; }
+
+    // Only exact when called while neither side is busy with the queue.
+    size_t size() const { return m_tail.load(AK::memory_order_acquire) - m_head.load(AK::memory_order_acquire); }
+    bool is_empty() const { return size() == 0; }
+
+    // Returns false (and leaves value alone) if the queue is full.
+    bool try_enqueue(T&& value)
+    {
+        size_t tail = m_tail.load(AK::memory_order_relaxed);
+        if (tail - m_cached_head == Capacity) {
+            m_cached_head = m_head.load(AK::memory_order_acquire);
+            if (tail - m_cached_head == Capacity)
+                return false;
+        }
+        new (&elements()[tail & index_mask]) T(move(value));
+        m_tail.store(tail + 1, AK::memory_order_release);
+        return true;
+    }
+
+    bool try_enqueue(const T& value)
+    {
+        T copy(value);
+        return try_enqueue(move(copy));
+    }
+
+    Optional<T> try_dequeue()
+    {
+        size_t head = m_head.load(AK::memory_order_relaxed);
+        if (head == m_cached_tail) {
+            m_cached_tail = m_tail.load(AK::memory_order_acquire);
+            if (head == m_cached_tail)
+                return {};
+        }
+        auto& slot = elements()[head & index_mask];
+        T value = move(slot);
+        slot.~T();
+        m_head.store(head + 1, AK::memory_order_release);
+        return value;
+    }
+
+private:
+    T* elements() { return reinterpret_cast<T*>(m_storage); }
+
+    // Written by the consumer.
+    alignas(cache_line_size) Atomic<size_t> m_head { 0 };
+    size_t m_cached_tail { 0 };
+
+    // Written by the producer.
+    alignas(cache_line_size) Atomic<size_t> m_tail { 0 };
+    size_t m_cached_head { 0 };
+
+    alignas(cache_line_size) alignas(T) u8 m_storage[sizeof(T) * Capacity];
+};
+
+}
+
+using AK::SPSCQueue;
@@ -63,6 +63,13 @@ bool String::operator==(const String& other) const
     if (!other.m_impl)
         return false;
 
+    if (m_impl == other.m_impl)
+        return true;
+
+    // There's only ever one FlyString impl with any given contents.
+    if (m_impl->is_fly() && other.m_impl->is_fly())
+        return false;
+
     if (length() != other.length())
         return false;
 
@@ -262,6 +262,7 @@ private:
 template<>
 struct Traits<String> : public GenericTraits<String> {
     static unsigned hash(const String& s) { return s.impl() ? s.impl()->hash() : 0; }
+    static constexpr bool is_trivially_relocatable() { return true; }
 };
 
 struct CaseInsensitiveStringTraits : public AK::Traits<String> {
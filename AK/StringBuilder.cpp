@@ -40,6 +40,12 @@ inline void StringBuilder::will_append(size_t size)
         m_buffer.grow(max(static_cast<size_t>(16), m_buffer.size() * 2 + size));
 }
 
+void StringBuilder::ensure_capacity(size_t additional)
+{
+    if ((m_length + additional) > m_buffer.size())
+        m_buffer.grow(m_length + additional);
+}
+
 StringBuilder::StringBuilder(size_t initial_capacity)
 {
     m_buffer.grow((int)initial_capacity);
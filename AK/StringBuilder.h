@@ -27,6 +27,7 @@
 #pragma once
 
 #include <AK/ByteBuffer.h>
+#include <AK/Format.h>
 #include <AK/Forward.h>
 #include <stdarg.h>
 
@@ -47,6 +48,14 @@ public:
     void appendf(const char*, ...);
     void appendvf(const char*, va_list);
 
+    template<typename... Parameters>
+    void appendff(CheckedFormatStringFor<Parameters...>&& fmtstr, const Parameters&... parameters)
+    {
+        TypeErasedParameter type_erased_parameters[] = { make_type_erased_parameter(parameters)..., {} };
+        FormatOutput output(*this);
+        vformat(output, fmtstr.view(), type_erased_parameters, sizeof...(Parameters));
+    }
+
     String build() const;
     String to_string() const;
     ByteBuffer to_byte_buffer() const;
@@ -58,6 +67,9 @@ public:
     bool is_empty() const { return m_length == 0; }
     void trim(size_t count) { m_length -= count; }
 
+    // Makes room for appending this many more bytes without growing the buffer again.
+    void ensure_capacity(size_t additional);
+
     template<class SeparatorType, class CollectionType>
     void join(const SeparatorType& separator, const CollectionType& collection)
     {
@@ -49,6 +49,11 @@ void dump_all_stringimpls()
 
 namespace AK {
 
+static inline size_t allocation_size_for_stringimpl(size_t length)
+{
+    return sizeof(StringImpl) + (sizeof(char) * length) + sizeof(char);
+}
+
 static StringImpl* s_the_empty_stringimpl = nullptr;
 
 StringImpl& StringImpl::the_empty_stringimpl()
@@ -60,6 +65,25 @@ StringImpl& StringImpl::the_empty_stringimpl()
     return *s_the_empty_stringimpl;
 }
 
+// One-character strings are everywhere (separators, single-letter identifiers, the results
+// of indexing into a string), so we keep one shared StringImpl for each ASCII character.
+static StringImpl* s_single_character_stringimpls[128];
+
+StringImpl& StringImpl::the_single_character_stringimpl(char ch)
+{
+    ASSERT(ch && static_cast<u8>(ch) < 128);
+    auto*& impl = s_single_character_stringimpls[static_cast<u8>(ch)];
+    if (!impl) {
+        void* slot = kmalloc(allocation_size_for_stringimpl(1));
+        impl = new (slot) StringImpl(ConstructWithInlineBuffer, 1);
+        impl->m_inline_buffer[0] = ch;
+        impl->m_inline_buffer[1] = '\0';
+        // Like the empty string, these are never freed.
+        impl->ref();
+    }
+    return *impl;
+}
+
 StringImpl::StringImpl(ConstructWithInlineBufferTag, size_t length)
     : m_length(length)
 {
@@ -81,11 +105,6 @@ StringImpl::~StringImpl()
 #endif
 }
 
-static inline size_t allocation_size_for_stringimpl(size_t length)
-{
-    return sizeof(StringImpl) + (sizeof(char) * length) + sizeof(char);
-}
-
 NonnullRefPtr<StringImpl> StringImpl::create_uninitialized(size_t length, char*& buffer)
 {
     ASSERT(length);
@@ -118,6 +137,9 @@ RefPtr<StringImpl> StringImpl::create(const char* cstring, size_t length, Should
     if (!length)
         return the_empty_stringimpl();
 
+    if (length == 1 && static_cast<u8>(cstring[0]) < 128)
+        return the_single_character_stringimpl(cstring[0]);
+
     char* buffer;
     auto new_stringimpl = create_uninitialized(length, buffer);
     memcpy(buffer, cstring, length * sizeof(char));
@@ -200,7 +222,7 @@ void StringImpl::compute_hash() const
         m_hash = 0;
     else
         m_hash = string_hash(characters(), m_length);
-    m_has_hash = true;
+    atomic_store(&m_has_hash, true, memory_order_release);
 }
 
 }
@@ -55,6 +55,7 @@ public:
     }
 
     static StringImpl& the_empty_stringimpl();
+    static StringImpl& the_single_character_stringimpl(char);
 
     ~StringImpl();
 
@@ -71,7 +72,9 @@ public:
 
     unsigned hash() const
     {
-        if (!m_has_hash)
+        // Strings are shared between threads, which may race to compute the same hash.
+        // That's harmless, as long as nobody sees m_has_hash before m_hash.
+        if (!atomic_load(&m_has_hash, memory_order_acquire))
             compute_hash();
         return m_hash;
     }
@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <AK/TestSuite.h>
+
+#include <AK/ArenaAllocator.h>
+#include <AK/NonnullRefPtrVector.h>
+
+static int s_live_objects = 0;
+
+class Object
+    : public RefCounted<Object>
+    , public ArenaAllocated {
+public:
+    explicit Object(int value)
+        : m_value(value)
+    {
+        ++s_live_objects;
+    }
+    ~Object() { --s_live_objects; }
+
+    int value() const { return m_value; }
+
+private:
+    int m_value { 0 };
+};
+
+TEST_CASE(aligned_allocations)
+{
+    auto arena = ArenaAllocator::create();
+    for (size_t size = 1; size < 100; ++size) {
+        auto address = reinterpret_cast<FlatPtr>(arena->allocate(size));
+        EXPECT_EQ(address % ArenaAllocator::alignment, 0u);
+    }
+}
+
+TEST_CASE(big_allocations_get_their_own_chunk)
+{
+    auto arena = ArenaAllocator::create();
+    arena->allocate(8);
+    EXPECT_EQ(arena->chunk_count(), 1u);
+    arena->allocate(ArenaAllocator::default_chunk_size * 2);
+    EXPECT_EQ(arena->chunk_count(), 2u);
+    arena->allocate(8);
+    EXPECT_EQ(arena->chunk_count(), 2u);
+}
+
+TEST_CASE(objects_keep_the_arena_alive)
+{
+    NonnullRefPtrVector<Object> objects;
+    {
+        auto arena = ArenaAllocator::create();
+        for (int i = 0; i < 10000; ++i)
+            objects.append(arena->create_object<Object>(i));
+        EXPECT(arena->chunk_count() > 1);
+    }
+    EXPECT_EQ(s_live_objects, 10000);
+    for (int i = 0; i < 10000; ++i)
+        EXPECT_EQ(objects[i].value(), i);
+    objects.clear();
+    EXPECT_EQ(s_live_objects, 0);
+}
+
+TEST_CASE(heap_and_arena_objects_mix)
+{
+    auto arena = ArenaAllocator::create();
+    auto on_heap = adopt(*new Object(1));
+    auto in_arena = arena->create_object<Object>(2);
+    EXPECT_EQ(arena->ref_count(), 2u);
+    EXPECT_EQ(on_heap->value() + in_arena->value(), 3);
+}
+
+BENCHMARK_CASE(allocate_many_objects)
+{
+    for (int round = 0; round < 10; ++round) {
+        auto arena = ArenaAllocator::create();
+        NonnullRefPtrVector<Object> objects;
+        for (int i = 0; i < 100000; ++i)
+            objects.append(arena->create_object<Object>(i));
+    }
+}
+
+TEST_MAIN(ArenaAllocator)
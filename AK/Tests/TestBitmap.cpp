@@ -81,6 +81,20 @@ TEST_CASE(set_range)
     EXPECT_EQ(bitmap.get(51), false);
 }
 
+TEST_CASE(set_range_across_bytes)
+{
+    Bitmap bitmap(128, true);
+    bitmap.set_range(3, 100, false);
+    for (size_t i = 0; i < 128; ++i)
+        EXPECT_EQ(bitmap.get(i), i < 3 || i >= 103);
+
+    bitmap.set_range(16, 16, true);
+    EXPECT_EQ(bitmap.get(15), false);
+    EXPECT_EQ(bitmap.get(16), true);
+    EXPECT_EQ(bitmap.get(31), true);
+    EXPECT_EQ(bitmap.get(32), false);
+}
+
 TEST_CASE(find_first_fit)
 {
     {
@@ -74,4 +74,20 @@ TEST_CASE(complex_type_clear)
     EXPECT_EQ(strings.size(), 0u);
 }
 
+TEST_CASE(modify_in_place)
+{
+    CircularQueue<int, 3> ints;
+    ints.enqueue(1);
+    ints.enqueue(2);
+    ints.enqueue(3);
+    ints.enqueue(4);
+
+    ints.first() = 20;
+    ints.last() += 36;
+
+    EXPECT_EQ(ints.dequeue(), 20);
+    EXPECT_EQ(ints.dequeue(), 3);
+    EXPECT_EQ(ints.dequeue(), 40);
+}
+
 TEST_MAIN(CircularQueue)
@@ -0,0 +1,212 @@
+/*
+ * Copyright (c) 2020, The SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <AK/TestSuite.h>
+
+#include <AK/DoubleConversion.h>
+#include <AK/JsonArray.h>
+#include <AK/JsonObject.h>
+#include <AK/JsonValue.h>
+#include <AK/Optional.h>
+#include <AK/String.h>
+#include <AK/StringView.h>
+
+static String format(double value)
+{
+    char buffer[double_string_buffer_size];
+    auto length = format_double(value, buffer);
+    EXPECT_EQ(length, strlen(buffer));
+    return String(buffer, length);
+}
+
+static u64 bits_from_double(double value)
+{
+    u64 bits;
+    __builtin_memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+static double double_from_bits(u64 bits)
+{
+    double value;
+    __builtin_memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+// Parses the whole string, and returns the bits so that the comparisons are exact.
+static u64 parse_bits(const char* string)
+{
+    size_t consumed_length = 0;
+    auto value = parse_double(string, &consumed_length);
+    EXPECT(value.has_value());
+    EXPECT_EQ(consumed_length, strlen(string));
+    return bits_from_double(value.value_or(0));
+}
+
+TEST_CASE(format_like_number_to_string)
+{
+    EXPECT_EQ(format(0.0), "0");
+    EXPECT_EQ(format(-0.0), "0");
+    EXPECT_EQ(format(1.0), "1");
+    EXPECT_EQ(format(-1.5), "-1.5");
+    EXPECT_EQ(format(0.1), "0.1");
+    EXPECT_EQ(format(0.1 + 0.2), "0.30000000000000004");
+    EXPECT_EQ(format(123.456), "123.456");
+    EXPECT_EQ(format(1e20), "100000000000000000000");
+    EXPECT_EQ(format(1e21), "1e+21");
+    EXPECT_EQ(format(1.5e300), "1.5e+300");
+    EXPECT_EQ(format(0.000001), "0.000001");
+    EXPECT_EQ(format(0.0000001), "1e-7");
+    EXPECT_EQ(format(-0.0000012345678901234567), "-0.0000012345678901234567");
+    EXPECT_EQ(format(5e-324), "5e-324");
+    EXPECT_EQ(format(1.7976931348623157e308), "1.7976931348623157e+308");
+    EXPECT_EQ(format(2.2250738585072014e-308), "2.2250738585072014e-308");
+    EXPECT_EQ(format(9007199254740993.0), "9007199254740992");
+    EXPECT_EQ(format(__builtin_nan("")), "NaN");
+    EXPECT_EQ(format(__builtin_huge_val()), "Infinity");
+    EXPECT_EQ(format(-__builtin_huge_val()), "-Infinity");
+}
+
+TEST_CASE(shortest_decimal)
+{
+    auto decimal = shortest_decimal_from_double(0.3);
+    EXPECT_EQ(decimal.significand, 3u);
+    EXPECT_EQ(decimal.exponent, -1);
+
+    decimal = shortest_decimal_from_double(1e23);
+    EXPECT_EQ(decimal.significand, 1u);
+    EXPECT_EQ(decimal.exponent, 23);
+}
+
+TEST_CASE(parse_simple)
+{
+    EXPECT_EQ(parse_bits("0"), bits_from_double(0.0));
+    EXPECT_EQ(parse_bits("-0"), bits_from_double(-0.0));
+    EXPECT_EQ(parse_bits("1"), bits_from_double(1.0));
+    EXPECT_EQ(parse_bits("+1.5"), bits_from_double(1.5));
+    EXPECT_EQ(parse_bits("-1.5e3"), bits_from_double(-1500.0));
+    EXPECT_EQ(parse_bits(".5"), bits_from_double(0.5));
+    EXPECT_EQ(parse_bits("5."), bits_from_double(5.0));
+    EXPECT_EQ(parse_bits("0.1"), bits_from_double(0.1));
+    EXPECT_EQ(parse_bits("1E-7"), bits_from_double(1e-7));
+    EXPECT_EQ(parse_bits("00000.000001"), bits_from_double(0.000001));
+    EXPECT_EQ(parse_bits("123456789012345678901234567890"), bits_from_double(123456789012345678901234567890.0));
+}
+
+TEST_CASE(parse_stops_at_the_end_of_the_number)
+{
+    size_t consumed_length = 0;
+    EXPECT_EQ(parse_double("12.5px", &consumed_length).value(), 12.5);
+    EXPECT_EQ(consumed_length, 4u);
+    EXPECT_EQ(parse_double("1e", &consumed_length).value(), 1.0);
+    EXPECT_EQ(consumed_length, 1u);
+    EXPECT_EQ(parse_double("2e+x", &consumed_length).value(), 2.0);
+    EXPECT_EQ(consumed_length, 1u);
+    EXPECT(!parse_double("", &consumed_length).has_value());
+    EXPECT(!parse_double("-.e1", &consumed_length).has_value());
+    EXPECT(!parse_double("abc", &consumed_length).has_value());
+    EXPECT_EQ(consumed_length, 0u);
+}
+
+TEST_CASE(parse_rounds_correctly)
+{
+    // Halfway between 1 and the next double, and just either side of it.
+    EXPECT_EQ(parse_bits("1.00000000000000011102230246251565404236316680908203125"), 0x3ff0000000000000u);
+    EXPECT_EQ(parse_bits("1.00000000000000011102230246251565404236316680908203124"), 0x3ff0000000000000u);
+    EXPECT_EQ(parse_bits("1.00000000000000011102230246251565404236316680908203126"), 0x3ff0000000000001u);
+    EXPECT_EQ(parse_bits("9007199254740993"), 0x4340000000000000u);
+    EXPECT_EQ(parse_bits("9007199254740993.0000000000000000000000000000001"), 0x4340000000000001u);
+    EXPECT_EQ(parse_bits("1e23"), bits_from_double(1e23));
+    EXPECT_EQ(parse_bits("2.2250738585072011e-308"), 0x000fffffffffffffu);
+    EXPECT_EQ(parse_bits("2.2250738585072012e-308"), 0x0010000000000000u);
+}
+
+TEST_CASE(parse_extremes)
+{
+    EXPECT_EQ(parse_bits("5e-324"), 1u);
+    EXPECT_EQ(parse_bits("2.4703282292062327e-324"), 0u);
+    EXPECT_EQ(parse_bits("2.4703282292062328e-324"), 1u);
+    EXPECT_EQ(parse_bits("1e-400"), 0u);
+    EXPECT_EQ(parse_bits("1.7976931348623157e308"), 0x7fefffffffffffffu);
+    EXPECT_EQ(parse_bits("1.7976931348623159e308"), 0x7ff0000000000000u);
+    EXPECT_EQ(parse_bits("1e400"), 0x7ff0000000000000u);
+    EXPECT_EQ(parse_bits("-1e99999999999999999"), 0xfff0000000000000u);
+}
+
+TEST_CASE(round_trip)
+{
+    // A cheap xorshift, so that every run checks the same doubles.
+    u64 state = 0x2545f4914f6cdd1du;
+    for (int i = 0; i < 100000; ++i) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        double value = double_from_bits(state);
+        if (value != value || value - value != 0)
+            continue;
+        auto string = format(value);
+        auto parsed = parse_double(string);
+        EXPECT(parsed.has_value());
+        if (value == 0)
+            EXPECT_EQ(parsed.value(), 0.0);
+        else
+            EXPECT_EQ(bits_from_double(parsed.value()), state);
+    }
+}
+
+TEST_CASE(json_doubles)
+{
+    auto value = JsonValue::from_string("[0.1, -2.5e-3, 1e300]").value();
+    EXPECT_EQ(value.as_array().at(0).as_double(), 0.1);
+    EXPECT_EQ(value.as_array().at(1).as_double(), -2.5e-3);
+    EXPECT_EQ(value.to_string(), "[0.1,-0.0025,1e+300]");
+}
+
+BENCHMARK_CASE(format_doubles)
+{
+    u64 state = 0x2545f4914f6cdd1du;
+    char buffer[double_string_buffer_size];
+    size_t total_length = 0;
+    for (int i = 0; i < 1000000; ++i) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        // Keep the doubles in a realistic range.
+        total_length += format_double(double_from_bits((state & 0x800fffffffffffffu) | 0x3ff0000000000000u) * 1000, buffer);
+    }
+    EXPECT(total_length > 0);
+}
+
+BENCHMARK_CASE(parse_doubles)
+{
+    static const char* strings[] = { "0.1", "3.14159", "-2.5e-3", "123456.789", "1e300", "0.30000000000000004", "1.7976931348623157e308", "6.02214076e23" };
+    double sum = 0;
+    for (int i = 0; i < 1000000; ++i)
+        sum += parse_double(strings[i % (sizeof(strings) / sizeof(strings[0]))]).value();
+    EXPECT(sum != 0);
+}
+
+TEST_MAIN(DoubleConversion)
@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2020, The SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <AK/TestSuite.h>
+
+#include <AK/FlyString.h>
+#include <AK/String.h>
+#include <AK/StringView.h>
+#include <AK/Vector.h>
+#include <thread>
+
+TEST_CASE(equal_strings_share_an_impl)
+{
+    FlyString from_literal = "interned";
+    FlyString from_view = StringView("interned");
+    FlyString from_string = String("interned");
+    EXPECT_EQ(from_literal.impl(), from_view.impl());
+    EXPECT_EQ(from_literal.impl(), from_string.impl());
+    EXPECT(from_literal.impl() != FlyString("other").impl());
+    EXPECT(FlyString().is_null());
+}
+
+TEST_CASE(intern_again_after_release)
+{
+    {
+        FlyString first = String::format("transient-%d", 1);
+        EXPECT_EQ(first, "transient-1");
+    }
+    FlyString second = String::format("transient-%d", 1);
+    FlyString third = StringView("transient-1");
+    EXPECT_EQ(second.impl(), third.impl());
+}
+
+static constexpr size_t thread_count = 4;
+
+static Vector<String> make_strings(size_t count)
+{
+    Vector<String> strings;
+    for (size_t i = 0; i < count; ++i)
+        strings.append(String::format("string-%zu", i));
+    return strings;
+}
+
+TEST_CASE(threads_agree_on_impls)
+{
+    auto strings = make_strings(1000);
+    Vector<FlyString> results[thread_count];
+    std::thread threads[thread_count];
+    for (size_t t = 0; t < thread_count; ++t) {
+        threads[t] = std::thread([&, t] {
+            // Interning and dropping the same strings over and over makes threads race
+            // the destruction of one impl against the interning of its replacement.
+            for (int round = 0; round < 50; ++round) {
+                for (auto& string : strings)
+                    FlyString fly_string = StringView(string);
+            }
+            for (auto& string : strings)
+                results[t].append(StringView(string));
+        });
+    }
+    for (auto& thread : threads)
+        thread.join();
+
+    for (size_t i = 0; i < strings.size(); ++i) {
+        EXPECT_EQ(results[0][i], strings[i]);
+        for (size_t t = 1; t < thread_count; ++t)
+            EXPECT_EQ(results[t][i].impl(), results[0][i].impl());
+    }
+}
+
+BENCHMARK_CASE(intern_from_threads)
+{
+    auto strings = make_strings(4096);
+    Vector<FlyString> keep_alive;
+    for (auto& string : strings)
+        keep_alive.append(string);
+
+    std::thread threads[thread_count];
+    for (size_t t = 0; t < thread_count; ++t) {
+        threads[t] = std::thread([&, t] {
+            for (size_t i = 0; i < 1000000; ++i)
+                FlyString fly_string = StringView(strings[(i * 7 + t) % strings.size()]);
+        });
+    }
+    for (auto& thread : threads)
+        thread.join();
+}
+
+TEST_MAIN(FlyString)
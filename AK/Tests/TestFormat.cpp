@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) 2020, The SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <AK/TestSuite.h>
+
+#include <AK/FlyString.h>
+#include <AK/Format.h>
+#include <AK/String.h>
+#include <AK/StringBuilder.h>
+
+TEST_CASE(literals_and_escaped_braces)
+{
+    EXPECT_EQ(AK::format(""), "");
+    EXPECT_EQ(AK::format("hello"), "hello");
+    EXPECT_EQ(AK::format("{{}}"), "{}");
+    EXPECT_EQ(AK::format("{{{}}}", 1), "{1}");
+}
+
+TEST_CASE(integers)
+{
+    EXPECT_EQ(AK::format("{}", 0), "0");
+    EXPECT_EQ(AK::format("{} {} {}", 1, -2, 3u), "1 -2 3");
+    EXPECT_EQ(AK::format("{}", static_cast<i64>(-9223372036854775807ll - 1)), "-9223372036854775808");
+    EXPECT_EQ(AK::format("{}", static_cast<u64>(18446744073709551615ull)), "18446744073709551615");
+    EXPECT_EQ(AK::format("{:x} {:X} {:o} {:b}", 255, 255, 8, 5), "ff FF 10 101");
+    EXPECT_EQ(AK::format("{:#x} {:#b}", 255, 5), "0xff 0b101");
+    EXPECT_EQ(AK::format("{:+}", 5), "+5");
+    EXPECT_EQ(AK::format("{:c}", 65), "A");
+}
+
+TEST_CASE(width_and_alignment)
+{
+    EXPECT_EQ(AK::format("{:5}", 42), "   42");
+    EXPECT_EQ(AK::format("{:<5}|", 42), "42   |");
+    EXPECT_EQ(AK::format("{:^6}", 42), "  42  ");
+    EXPECT_EQ(AK::format("{:*>5}", 42), "***42");
+    EXPECT_EQ(AK::format("{:05}", -42), "-0042");
+    EXPECT_EQ(AK::format("{:#010x}", 0xbeef), "0x0000beef");
+    EXPECT_EQ(AK::format("{:5}|", "ab"), "ab   |");
+    EXPECT_EQ(AK::format("{:>5}", "ab"), "   ab");
+    EXPECT_EQ(AK::format("{:.2}", "abcdef"), "ab");
+    EXPECT_EQ(AK::format("{:3}", "abcdef"), "abcdef");
+}
+
+TEST_CASE(strings_and_characters)
+{
+    String string = "string";
+    FlyString fly_string = "fly";
+    StringView view = "view";
+    const char* null_string = nullptr;
+    EXPECT_EQ(AK::format("{} {} {} {}", string, fly_string, view, "literal"), "string fly view literal");
+    EXPECT_EQ(AK::format("{}", null_string), "(null)");
+    EXPECT_EQ(AK::format("{}{}", 'a', 'b'), "ab");
+    EXPECT_EQ(AK::format("{:d}", 'a'), "97");
+    EXPECT_EQ(AK::format("{} {}", true, false), "true false");
+}
+
+TEST_CASE(pointers)
+{
+    EXPECT_EQ(AK::format("{}", reinterpret_cast<int*>(0x1234)), sizeof(FlatPtr) == 8 ? "0x0000000000001234" : "0x00001234");
+}
+
+TEST_CASE(floating_point)
+{
+    EXPECT_EQ(AK::format("{}", 0.1), "0.1");
+    EXPECT_EQ(AK::format("{}", -1.5), "-1.5");
+    EXPECT_EQ(AK::format("{:.2}", 3.14159), "3.14");
+    EXPECT_EQ(AK::format("{:.0}", 2.5), "2");
+    EXPECT_EQ(AK::format("{:f}", 1.0), "1.000000");
+    EXPECT_EQ(AK::format("{:8.3}", -1.0), "  -1.000");
+}
+
+TEST_CASE(append_to_builder)
+{
+    StringBuilder builder;
+    builder.append("pid: ");
+    builder.appendff("{} name: {:>6} size: {:#x}", 42, "init", 4096u);
+    EXPECT_EQ(builder.to_string(), "pid: 42 name:   init size: 0x1000");
+}
+
+BENCHMARK_CASE(appendff)
+{
+    StringBuilder builder;
+    for (int i = 0; i < 1000000; ++i) {
+        builder.clear();
+        builder.appendff("{:>6} {:08x} {} {}", i, static_cast<u32>(i) * 2654435761u, "process", i & 1);
+    }
+    EXPECT(!builder.is_empty());
+}
+
+BENCHMARK_CASE(appendf)
+{
+    StringBuilder builder;
+    for (int i = 0; i < 1000000; ++i) {
+        builder.clear();
+        builder.appendf("%6d %08x %s %d", i, static_cast<u32>(i) * 2654435761u, "process", i & 1);
+    }
+    EXPECT(!builder.is_empty());
+}
+
+TEST_MAIN(Format)
@@ -0,0 +1,250 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <AK/TestSuite.h>
+
+#include <AK/HashTable.h>
+#include <AK/SinglyLinkedList.h>
+#include <AK/String.h>
+#include <AK/Vector.h>
+
+TEST_CASE(construct)
+{
+    typedef HashTable<int> IntTable;
+    EXPECT(IntTable().is_empty());
+    EXPECT_EQ(IntTable().size(), 0u);
+}
+
+TEST_CASE(populate)
+{
+    HashTable<String> strings;
+    strings.set("One");
+    strings.set("Two");
+    strings.set("Three");
+
+    EXPECT_EQ(strings.is_empty(), false);
+    EXPECT_EQ(strings.size(), 3u);
+}
+
+TEST_CASE(range_loop)
+{
+    HashTable<String> strings;
+    EXPECT_EQ(strings.set("One"), AK::HashSetResult::InsertedNewEntry);
+    EXPECT_EQ(strings.set("Two"), AK::HashSetResult::InsertedNewEntry);
+    EXPECT_EQ(strings.set("Three"), AK::HashSetResult::InsertedNewEntry);
+
+    int loop_counter = 0;
+    for (auto& it : strings) {
+        EXPECT_EQ(it.is_null(), false);
+        ++loop_counter;
+    }
+    EXPECT_EQ(loop_counter, 3);
+}
+
+TEST_CASE(table_remove)
+{
+    HashTable<String> strings;
+    EXPECT_EQ(strings.set("One"), AK::HashSetResult::InsertedNewEntry);
+    EXPECT_EQ(strings.set("Two"), AK::HashSetResult::InsertedNewEntry);
+    EXPECT_EQ(strings.set("Three"), AK::HashSetResult::InsertedNewEntry);
+
+    EXPECT(strings.remove("One"));
+    EXPECT_EQ(strings.size(), 2u);
+    EXPECT(strings.find("One") == strings.end());
+
+    EXPECT(strings.remove("Three"));
+    EXPECT_EQ(strings.size(), 1u);
+    EXPECT(strings.find("Three") == strings.end());
+    EXPECT(strings.find("Two") != strings.end());
+}
+
+TEST_CASE(replace_existing)
+{
+    HashTable<String> strings;
+    EXPECT_EQ(strings.set("One"), AK::HashSetResult::InsertedNewEntry);
+    EXPECT_EQ(strings.set("One"), AK::HashSetResult::ReplacedExistingEntry);
+    EXPECT_EQ(strings.size(), 1u);
+}
+
+struct CollidingTraits : public GenericTraits<int> {
+    static unsigned hash(int value) { return value % 3; }
+};
+
+TEST_CASE(remove_with_collisions)
+{
+    // Every key lands in one of three home buckets, so removals have to shift long probe sequences around.
+    HashTable<int, CollidingTraits> table;
+    for (int i = 0; i < 60; ++i)
+        table.set(i);
+    EXPECT_EQ(table.size(), 60u);
+
+    for (int i = 0; i < 60; i += 2)
+        EXPECT(table.remove(i));
+    EXPECT_EQ(table.size(), 30u);
+
+    for (int i = 0; i < 60; ++i)
+        EXPECT_EQ(table.contains(i), i % 2 == 1);
+
+    for (int i = 1; i < 60; i += 2)
+        EXPECT(table.remove(i));
+    EXPECT(table.is_empty());
+}
+
+TEST_CASE(many_strings)
+{
+    HashTable<String> strings;
+    for (int i = 0; i < 999; ++i)
+        EXPECT_EQ(strings.set(String::number(i)), AK::HashSetResult::InsertedNewEntry);
+    EXPECT_EQ(strings.size(), 999u);
+    for (int i = 0; i < 999; ++i)
+        EXPECT(strings.contains(String::number(i)));
+    for (int i = 0; i < 999; ++i)
+        EXPECT(strings.remove(String::number(i)));
+    EXPECT(strings.is_empty());
+}
+
+TEST_CASE(copy_and_move)
+{
+    HashTable<String> strings;
+    strings.set("One");
+    strings.set("Two");
+
+    auto copy = strings;
+    EXPECT_EQ(copy.size(), 2u);
+    EXPECT(copy.contains("One"));
+    EXPECT(copy.contains("Two"));
+
+    auto moved = move(strings);
+    EXPECT(strings.is_empty());
+    EXPECT_EQ(moved.size(), 2u);
+    EXPECT(moved.contains("One"));
+}
+
+TEST_CASE(ensure_capacity)
+{
+    HashTable<int> table;
+    table.ensure_capacity(100);
+    auto capacity = table.capacity();
+    EXPECT(capacity >= 100u);
+    for (int i = 0; i < 100; ++i)
+        table.set(i);
+    EXPECT_EQ(table.capacity(), capacity);
+}
+
+// The bucket-per-linked-list layout HashTable used to have, kept around as a baseline for the benchmarks below.
+template<typename T>
+class ChainedHashTable {
+public:
+    ChainedHashTable()
+    {
+        m_buckets.resize(8);
+    }
+
+    void set(const T& value)
+    {
+        auto& bucket = m_buckets[Traits<T>::hash(value) % m_buckets.size()];
+        for (auto& entry : bucket) {
+            if (entry == value)
+                return;
+        }
+        if (m_size >= m_buckets.size()) {
+            rehash(m_buckets.size() * 2);
+            m_buckets[Traits<T>::hash(value) % m_buckets.size()].append(value);
+        } else {
+            bucket.append(value);
+        }
+        ++m_size;
+    }
+
+    bool contains(const T& value) const
+    {
+        auto& bucket = m_buckets[Traits<T>::hash(value) % m_buckets.size()];
+        for (auto& entry : bucket) {
+            if (entry == value)
+                return true;
+        }
+        return false;
+    }
+
+    bool remove(const T& value)
+    {
+        auto& bucket = m_buckets[Traits<T>::hash(value) % m_buckets.size()];
+        auto it = bucket.find(value);
+        if (!(it != bucket.end()))
+            return false;
+        bucket.remove(it);
+        --m_size;
+        return true;
+    }
+
+    size_t size() const { return m_size; }
+
+private:
+    void rehash(size_t capacity)
+    {
+        Vector<SinglyLinkedList<T>> new_buckets;
+        new_buckets.resize(capacity);
+        for (auto& bucket : m_buckets) {
+            for (auto& value : bucket)
+                new_buckets[Traits<T>::hash(value) % capacity].append(move(value));
+        }
+        m_buckets = move(new_buckets);
+    }
+
+    Vector<SinglyLinkedList<T>> m_buckets;
+    size_t m_size { 0 };
+};
+
+static constexpr int benchmark_element_count = 200000;
+
+template<typename TableType>
+static void insert_lookup_remove(TableType& table)
+{
+    for (int i = 0; i < benchmark_element_count; ++i)
+        table.set(i);
+    EXPECT_EQ(table.size(), (size_t)benchmark_element_count);
+    for (int round = 0; round < 10; ++round) {
+        for (int i = 0; i < benchmark_element_count; ++i)
+            EXPECT(table.contains(i));
+    }
+    for (int i = 0; i < benchmark_element_count; ++i)
+        EXPECT(table.remove(i));
+    EXPECT_EQ(table.size(), 0u);
+}
+
+BENCHMARK_CASE(open_addressing_insert_lookup_remove)
+{
+    HashTable<int> table;
+    insert_lookup_remove(table);
+}
+
+BENCHMARK_CASE(chained_insert_lookup_remove)
+{
+    ChainedHashTable<int> table;
+    insert_lookup_remove(table);
+}
+
+TEST_MAIN(HashTable)
@@ -29,6 +29,7 @@
 #include <AK/HashMap.h>
 #include <AK/JsonArray.h>
 #include <AK/JsonObject.h>
+#include <AK/JsonPullParser.h>
 #include <AK/JsonValue.h>
 #include <AK/String.h>
 #include <AK/StringBuilder.h>
@@ -145,4 +146,86 @@ TEST_CASE(json_duplicate_keys)
     EXPECT_EQ(json.to_string(), "{\"test\":\"baz\"}");
 }
 
+TEST_CASE(json_duplicate_keys_in_large_object)
+{
+    JsonObject json;
+    for (int i = 0; i < 20; ++i)
+        json.set(String::number(i), i);
+    json.set("3", "three");
+    EXPECT_EQ(json.size(), 20);
+    EXPECT_EQ(json.get("3").as_string(), "three");
+    EXPECT_EQ(json.get("19").as_i32(), 19);
+    EXPECT(!json.has("20"));
+
+    String last_key;
+    json.for_each_member([&](auto& key, auto&) { last_key = key; });
+    EXPECT_EQ(last_key, "3");
+}
+
+TEST_CASE(json_numbers)
+{
+    auto json = JsonValue::from_string("[0, -0, 42, -42, 4294967295, 4294967296, -2147483648, -2147483649, 18446744073709551615, -9223372036854775808]").value();
+    auto& array = json.as_array();
+    EXPECT_EQ(array[0].type(), JsonValue::Type::UnsignedInt32);
+    EXPECT_EQ(array[1].type(), JsonValue::Type::Int32);
+    EXPECT_EQ(array[2].as_u32(), 42u);
+    EXPECT_EQ(array[3].as_i32(), -42);
+    EXPECT_EQ(array[4].as_u32(), 4294967295u);
+    EXPECT_EQ(array[5].as_u64(), 4294967296ull);
+    EXPECT_EQ(array[6].as_i32(), -2147483648);
+    EXPECT_EQ(array[7].as_i64(), -2147483649ll);
+    EXPECT_EQ(array[8].as_u64(), 18446744073709551615ull);
+    EXPECT_EQ(array[9].as_i64(), NumericLimits<i64>::min());
+}
+
+TEST_CASE(json_doubles)
+{
+    auto json = JsonValue::from_string("[1.5, -0.25, 1e3, 2.5E-2, -1.05, 100000000000000000000000]").value();
+    auto& array = json.as_array();
+    EXPECT_EQ(array[0].as_double(), 1.5);
+    EXPECT_EQ(array[1].as_double(), -0.25);
+    EXPECT_EQ(array[2].as_double(), 1000.0);
+    EXPECT_EQ(array[3].as_double(), 0.025);
+    EXPECT_EQ(array[4].as_double(), -1.05);
+    EXPECT_EQ(array[5].as_double(), 1e23);
+}
+
+TEST_CASE(json_malformed)
+{
+    EXPECT(!JsonValue::from_string("").has_value());
+    EXPECT(!JsonValue::from_string("[1,]").has_value());
+    EXPECT(!JsonValue::from_string("{\"a\":1,}").has_value());
+    EXPECT(!JsonValue::from_string("{\"a\" 1}").has_value());
+    EXPECT(!JsonValue::from_string("[1 2]").has_value());
+    EXPECT(!JsonValue::from_string("[1]]").has_value());
+    EXPECT(!JsonValue::from_string("\"abc").has_value());
+    EXPECT(!JsonValue::from_string("-").has_value());
+    EXPECT(!JsonValue::from_string("1.").has_value());
+}
+
+TEST_CASE(json_pull_parser)
+{
+    JsonPullParser parser("{\"name\": \"a\\tb\", \"skipped\": [1, {\"x\": []}], \"values\": [true, null, 7]}");
+    EXPECT(parser.next() == JsonPullParser::Event::ObjectStart);
+    EXPECT(parser.next() == JsonPullParser::Event::Key);
+    EXPECT_EQ(parser.string(), "name");
+    EXPECT(parser.next() == JsonPullParser::Event::String);
+    EXPECT_EQ(parser.string(), "a\tb");
+    EXPECT(parser.next() == JsonPullParser::Event::Key);
+    EXPECT(parser.next() == JsonPullParser::Event::ArrayStart);
+    EXPECT(parser.skip_value());
+    EXPECT_EQ(parser.depth(), size_t { 1 });
+    EXPECT(parser.next() == JsonPullParser::Event::Key);
+    EXPECT_EQ(parser.string(), "values");
+    EXPECT(parser.next() == JsonPullParser::Event::ArrayStart);
+    EXPECT(parser.next() == JsonPullParser::Event::Bool);
+    EXPECT_EQ(parser.value().as_bool(), true);
+    EXPECT(parser.next() == JsonPullParser::Event::Null);
+    EXPECT(parser.next() == JsonPullParser::Event::Number);
+    EXPECT_EQ(parser.value().as_u32(), 7u);
+    EXPECT(parser.next() == JsonPullParser::Event::ArrayEnd);
+    EXPECT(parser.next() == JsonPullParser::Event::ObjectEnd);
+    EXPECT(parser.next() == JsonPullParser::Event::End);
+}
+
 TEST_MAIN(JSON)
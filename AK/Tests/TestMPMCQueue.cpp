@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <AK/TestSuite.h>
+
+#include <AK/Atomic.h>
+#include <AK/MPMCQueue.h>
+#include <AK/String.h>
+#include <thread>
+
+TEST_CASE(construct)
+{
+    MPMCQueue<int, 4> queue;
+    EXPECT(queue.is_empty());
+    EXPECT_EQ(queue.size(), 0u);
+    EXPECT_EQ(queue.capacity(), 4u);
+    EXPECT(!queue.try_dequeue().has_value());
+}
+
+TEST_CASE(fill_and_drain)
+{
+    MPMCQueue<int, 4> queue;
+    for (int round = 0; round < 3; ++round) {
+        for (int i = 0; i < 4; ++i)
+            EXPECT(queue.try_enqueue(i));
+        EXPECT(!queue.try_enqueue(4));
+        EXPECT_EQ(queue.size(), 4u);
+        for (int i = 0; i < 4; ++i)
+            EXPECT_EQ(queue.try_dequeue().value(), i);
+        EXPECT(queue.is_empty());
+    }
+}
+
+TEST_CASE(complex_type)
+{
+    MPMCQueue<String, 8> queue;
+    EXPECT(queue.try_enqueue(String("Hello")));
+    EXPECT(queue.try_enqueue(String("World")));
+    EXPECT_EQ(queue.try_dequeue().value(), "Hello");
+    EXPECT_EQ(queue.try_dequeue().value(), "World");
+    // Leave one behind for the destructor.
+    EXPECT(queue.try_enqueue(String("Leftover")));
+}
+
+static constexpr size_t thread_count = 4;
+static constexpr size_t values_per_producer = 50000;
+
+static void transfer_between_threads(MPMCQueue<size_t, 1024>& queue)
+{
+    // Every producer sends the numbers 1 up to values_per_producer, so the consumers
+    // should see each of them exactly thread_count times.
+    Atomic<size_t> total { 0 };
+    Atomic<size_t> received { 0 };
+    std::thread producers[thread_count];
+    std::thread consumers[thread_count];
+    for (auto& producer : producers) {
+        producer = std::thread([&] {
+            for (size_t i = 1; i <= values_per_producer;) {
+                if (queue.try_enqueue(i))
+                    ++i;
+                else
+                    std::this_thread::yield();
+            }
+        });
+    }
+    for (auto& consumer : consumers) {
+        consumer = std::thread([&] {
+            size_t sum = 0;
+            while (received.load() < thread_count * values_per_producer) {
+                auto value = queue.try_dequeue();
+                if (!value.has_value()) {
+                    std::this_thread::yield();
+                    continue;
+                }
+                sum += value.value();
+                ++received;
+            }
+            total += sum;
+        });
+    }
+    for (auto& producer : producers)
+        producer.join();
+    for (auto& consumer : consumers)
+        consumer.join();
+
+    EXPECT_EQ(received.load(), thread_count * values_per_producer);
+    EXPECT_EQ(total.load(), thread_count * (values_per_producer * (values_per_producer + 1) / 2));
+    EXPECT(queue.is_empty());
+}
+
+TEST_CASE(threads_lose_nothing)
+{
+    MPMCQueue<size_t, 1024> queue;
+    transfer_between_threads(queue);
+}
+
+BENCHMARK_CASE(throughput)
+{
+    MPMCQueue<size_t, 1024> queue;
+    for (int i = 0; i < 3; ++i)
+        transfer_between_threads(queue);
+}
+
+TEST_MAIN(MPMCQueue)
@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <AK/TestSuite.h>
+
+#include <AK/MergeSort.h>
+#include <AK/QuickSort.h>
+#include <AK/Vector.h>
+
+static bool is_sorted(const Vector<int>& ints)
+{
+    for (size_t i = 1; i < ints.size(); ++i) {
+        if (ints[i] < ints[i - 1])
+            return false;
+    }
+    return true;
+}
+
+static Vector<Vector<int>> make_test_inputs()
+{
+    Vector<Vector<int>> inputs;
+    for (int size : { 0, 1, 2, 15, 16, 17, 127, 129, 1000, 5000 }) {
+        Vector<int> ascending, descending, equal, organ_pipe, sawtooth, random;
+        u32 state = 1;
+        for (int i = 0; i < size; ++i) {
+            ascending.append(i);
+            descending.append(size - i);
+            equal.append(42);
+            organ_pipe.append(i < size / 2 ? i : size - i);
+            sawtooth.append(i % 7);
+            state = state * 1103515245 + 12345;
+            random.append(state >> 16);
+        }
+        inputs.append(move(ascending));
+        inputs.append(move(descending));
+        inputs.append(move(equal));
+        inputs.append(move(organ_pipe));
+        inputs.append(move(sawtooth));
+        inputs.append(move(random));
+    }
+    return inputs;
+}
+
+TEST_CASE(quick_sort_patterns)
+{
+    for (auto& input : make_test_inputs()) {
+        auto ints = input;
+        quick_sort(ints);
+        EXPECT_EQ(ints.size(), input.size());
+        EXPECT(is_sorted(ints));
+    }
+}
+
+TEST_CASE(quick_sort_iterators)
+{
+    for (auto& input : make_test_inputs()) {
+        auto ints = input;
+        quick_sort(ints.begin(), ints.end());
+        EXPECT(is_sorted(ints));
+    }
+}
+
+TEST_CASE(quick_sort_adversarial_comparisons)
+{
+    // Count comparisons on an input that drives naive median-of-three quicksorts quadratic:
+    // the heapsort fallback must keep it at O(n log n).
+    const int size = 1 << 14;
+    Vector<int> ints;
+    for (int i = 0; i < size; ++i)
+        ints.append(i % 2 ? size / 2 + i / 2 : i / 2);
+    size_t comparisons = 0;
+    quick_sort(ints, [&](int a, int b) {
+        ++comparisons;
+        return a < b;
+    });
+    EXPECT(is_sorted(ints));
+    EXPECT(comparisons < 64u * size);
+}
+
+TEST_CASE(merge_sort_patterns)
+{
+    for (auto& input : make_test_inputs()) {
+        auto ints = input;
+        merge_sort(ints);
+        EXPECT_EQ(ints.size(), input.size());
+        EXPECT(is_sorted(ints));
+    }
+}
+
+TEST_CASE(merge_sort_is_stable)
+{
+    struct Item {
+        int key;
+        int order;
+    };
+    Vector<Item> items;
+    for (int i = 0; i < 3000; ++i)
+        items.append({ (i * 7919) % 13, i });
+    merge_sort(items, [](auto& a, auto& b) { return a.key < b.key; });
+    for (size_t i = 1; i < items.size(); ++i) {
+        EXPECT(items[i - 1].key <= items[i].key);
+        if (items[i - 1].key == items[i].key)
+            EXPECT(items[i - 1].order < items[i].order);
+    }
+}
+
+TEST_MAIN(QuickSort)
@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <AK/TestSuite.h>
+
+#include <AK/SPSCQueue.h>
+#include <AK/String.h>
+#include <thread>
+
+TEST_CASE(construct)
+{
+    SPSCQueue<int, 4> queue;
+    EXPECT(queue.is_empty());
+    EXPECT_EQ(queue.size(), 0u);
+    EXPECT_EQ(queue.capacity(), 4u);
+    EXPECT(!queue.try_dequeue().has_value());
+}
+
+TEST_CASE(fill_and_drain)
+{
+    SPSCQueue<int, 4> queue;
+    for (int round = 0; round < 3; ++round) {
+        for (int i = 0; i < 4; ++i)
+            EXPECT(queue.try_enqueue(i));
+        EXPECT(!queue.try_enqueue(4));
+        EXPECT_EQ(queue.size(), 4u);
+        for (int i = 0; i < 4; ++i)
+            EXPECT_EQ(queue.try_dequeue().value(), i);
+        EXPECT(queue.is_empty());
+    }
+}
+
+TEST_CASE(complex_type)
+{
+    SPSCQueue<String, 8> queue;
+    EXPECT(queue.try_enqueue(String("Hello")));
+    EXPECT(queue.try_enqueue(String("World")));
+    EXPECT_EQ(queue.try_dequeue().value(), "Hello");
+    EXPECT_EQ(queue.try_dequeue().value(), "World");
+    // Leave one behind for the destructor.
+    EXPECT(queue.try_enqueue(String("Leftover")));
+}
+
+static constexpr size_t transfer_count = 200000;
+
+static void transfer_between_threads(SPSCQueue<size_t, 256>& queue)
+{
+    std::thread producer([&] {
+        for (size_t i = 0; i < transfer_count;) {
+            if (queue.try_enqueue(i))
+                ++i;
+            else
+                std::this_thread::yield();
+        }
+    });
+
+    bool in_order = true;
+    for (size_t expected = 0; expected < transfer_count;) {
+        auto value = queue.try_dequeue();
+        if (!value.has_value()) {
+            std::this_thread::yield();
+            continue;
+        }
+        if (value.value() != expected)
+            in_order = false;
+        ++expected;
+    }
+    producer.join();
+    EXPECT(in_order);
+    EXPECT(queue.is_empty());
+}
+
+TEST_CASE(threads_in_order)
+{
+    SPSCQueue<size_t, 256> queue;
+    transfer_between_threads(queue);
+}
+
+BENCHMARK_CASE(throughput)
+{
+    SPSCQueue<size_t, 256> queue;
+    for (int i = 0; i < 5; ++i)
+        transfer_between_threads(queue);
+}
+
+TEST_MAIN(SPSCQueue)
@@ -111,6 +111,20 @@ TEST_CASE(copy_string)
     EXPECT_EQ(test_string.characters(), test_string_copy.characters());
 }
 
+TEST_CASE(single_character_strings_are_shared)
+{
+    String a = "x";
+    String b = String::format("%c", 'x');
+    EXPECT_EQ(a, b);
+    EXPECT_EQ(a.impl(), b.impl());
+    EXPECT_EQ(a.length(), 1u);
+    EXPECT_EQ(a.characters()[1], '\0');
+
+    String c = "\xe2";
+    EXPECT_EQ(c.length(), 1u);
+    EXPECT_EQ(c[0], '\xe2');
+}
+
 TEST_CASE(move_string)
 {
     String test_string = "ABCDEF";
@@ -161,6 +175,26 @@ TEST_CASE(flystring)
         EXPECT_EQ(a.impl(), b.impl());
         EXPECT_EQ(a.impl(), c.impl());
     }
+
+    {
+        String a = FlyString("foo").impl();
+        String b = FlyString("bar").impl();
+        String c = FlyString("foo").impl();
+        EXPECT(a != b);
+        EXPECT(a == c);
+        EXPECT(a == String("foo"));
+        EXPECT(String("bar") == b);
+    }
+
+    {
+        FlyString a("foo");
+        StringView view("foobar");
+        FlyString b = view.substring_view(0, 3);
+        FlyString c = view.substring_view(3, 3);
+        EXPECT_EQ(a.impl(), b.impl());
+        EXPECT(c == "bar");
+        EXPECT(FlyString(StringView()).is_null());
+    }
 }
 
 TEST_CASE(replace)
@@ -242,4 +276,15 @@ TEST_CASE(builder_zero_initial_capacity)
     EXPECT_EQ(built.length(), 0u);
 }
 
+TEST_CASE(builder_ensure_capacity)
+{
+    StringBuilder builder(0);
+    builder.append("abc");
+    builder.ensure_capacity(1000);
+    for (int i = 0; i < 1000; ++i)
+        builder.append('x');
+    EXPECT_EQ(builder.length(), 1003u);
+    EXPECT(builder.string_view().starts_with("abcxxx"));
+}
+
 TEST_MAIN(String)
@@ -29,6 +29,8 @@
 #include <AK/String.h>
 #include <AK/NonnullOwnPtrVector.h>
 #include <AK/OwnPtr.h>
+#include <AK/RefCounted.h>
+#include <AK/RefPtr.h>
 #include <AK/Vector.h>
 
 TEST_CASE(construct)
@@ -313,4 +315,42 @@ TEST_CASE(insert_trivial)
     EXPECT_EQ(ints[5], 40);
 }
 
+TEST_CASE(relocate_refcounted_elements)
+{
+    struct Object : public RefCounted<Object> {
+        explicit Object(int value)
+            : value(value)
+        {
+        }
+        int value { 0 };
+    };
+
+    static_assert(Traits<NonnullRefPtr<Object>>::is_trivially_relocatable());
+    static_assert(Traits<String>::is_trivially_relocatable());
+    static_assert(!Traits<Vector<int, 4>>::is_trivially_relocatable());
+
+    Vector<NonnullRefPtr<Object>, 2> objects;
+    auto first = adopt(*new Object(1));
+    for (int i = 0; i < 100; ++i)
+        objects.append(i ? adopt(*new Object(i + 1)) : first);
+    EXPECT_EQ(first->ref_count(), 2u);
+
+    objects.insert(0, adopt(*new Object(0)));
+    objects.remove(50);
+    objects.prepend(Vector<NonnullRefPtr<Object>, 2> { first });
+    EXPECT_EQ(objects.size(), 101u);
+    EXPECT_EQ(objects[0]->value, 1);
+    EXPECT_EQ(objects[1]->value, 0);
+    EXPECT_EQ(objects[2]->value, 1);
+    EXPECT_EQ(objects[50]->value, 49);
+    EXPECT_EQ(objects[51]->value, 51);
+    EXPECT_EQ(objects.last()->value, 100);
+    EXPECT_EQ(first->ref_count(), 3u);
+
+    auto moved = move(objects);
+    EXPECT(objects.is_empty());
+    moved.clear();
+    EXPECT_EQ(first->ref_count(), 1u);
+}
+
 TEST_MAIN(Vector)
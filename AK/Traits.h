@@ -35,6 +35,10 @@ template<typename T>
 struct GenericTraits {
     using PeekType = T;
     static constexpr bool is_trivial() { return false; }
+    // Whether an object can be moved to another address with memcpy, leaving the old bytes
+    // to be forgotten without running the destructor. Types that only own a pointer to their
+    // resources, like RefPtr and String, opt in even though their moves aren't trivial.
+    static constexpr bool is_trivially_relocatable() { return __is_trivially_copyable(T); }
     static bool equals(const T& a, const T& b) { return a == b; }
 };
 
@@ -105,6 +105,22 @@ public:
             new (&destination[i]) T(AK::move(source[i]));
     }
 
+    // Moves objects into uninitialized memory and ends the lifetime of the originals.
+    // The ranges may only overlap if destination comes before source.
+    static void relocate(T* destination, T* source, size_t count)
+    {
+        if (!count)
+            return;
+        if constexpr (Traits<T>::is_trivially_relocatable()) {
+            __builtin_memmove(static_cast<void*>(destination), source, count * sizeof(T));
+            return;
+        }
+        for (size_t i = 0; i < count; ++i) {
+            new (&destination[i]) T(AK::move(source[i]));
+            source[i].~T();
+        }
+    }
+
     static void copy(T* destination, const T* source, size_t count)
     {
         if (!count)
@@ -161,12 +177,8 @@ public:
         , m_outline_buffer(other.m_outline_buffer)
     {
         if constexpr (inline_capacity > 0) {
-            if (!m_outline_buffer) {
-                for (size_t i = 0; i < m_size; ++i) {
-                    new (&inline_buffer()[i]) T(move(other.inline_buffer()[i]));
-                    other.inline_buffer()[i].~T();
-                }
-            }
+            if (!m_outline_buffer)
+                TypedTransfer<T>::relocate(inline_buffer(), other.inline_buffer(), m_size);
         }
         other.m_outline_buffer = nullptr;
         other.m_size = 0;
@@ -200,12 +212,8 @@ public:
             m_capacity = other.m_capacity;
             m_outline_buffer = other.m_outline_buffer;
             if constexpr (inline_capacity > 0) {
-                if (!m_outline_buffer) {
-                    for (size_t i = 0; i < m_size; ++i) {
-                        new (&inline_buffer()[i]) T(move(other.inline_buffer()[i]));
-                        other.inline_buffer()[i].~T();
-                    }
-                }
+                if (!m_outline_buffer)
+                    TypedTransfer<T>::relocate(inline_buffer(), other.inline_buffer(), m_size);
             }
             other.m_outline_buffer = nullptr;
             other.m_size = 0;
@@ -326,16 +334,8 @@ public:
     {
         ASSERT(index < m_size);
 
-        if constexpr (Traits<T>::is_trivial()) {
-            TypedTransfer<T>::copy(slot(index), slot(index + 1), m_size - index - 1);
-        } else {
-            at(index).~T();
-            for (size_t i = index + 1; i < m_size; ++i) {
-                new (slot(i - 1)) T(move(at(i)));
-                at(i).~T();
-            }
-        }
-
+        at(index).~T();
+        TypedTransfer<T>::relocate(slot(index), slot(index + 1), m_size - index - 1);
         --m_size;
     }
 
@@ -346,8 +346,8 @@ public:
             return append(move(value));
         grow_capacity(size() + 1);
         ++m_size;
-        if constexpr (Traits<T>::is_trivial()) {
-            TypedTransfer<T>::move(slot(index + 1), slot(index), m_size - index - 1);
+        if constexpr (Traits<T>::is_trivially_relocatable()) {
+            __builtin_memmove(static_cast<void*>(slot(index + 1)), slot(index), (m_size - index - 1) * sizeof(T));
         } else {
             for (size_t i = size() - 1; i > index; --i) {
                 new (slot(i)) T(move(at(i - 1)));
@@ -497,9 +497,13 @@ public:
         auto other_size = other.size();
         grow_capacity(size() + other_size);
 
-        for (size_t i = size() + other_size - 1; i >= other.size(); --i) {
-            new (slot(i)) T(move(at(i - other_size)));
-            at(i - other_size).~T();
+        if constexpr (Traits<T>::is_trivially_relocatable()) {
+            __builtin_memmove(static_cast<void*>(slot(other_size)), slot(0), size() * sizeof(T));
+        } else {
+            for (size_t i = size() + other_size - 1; i >= other.size(); --i) {
+                new (slot(i)) T(move(at(i - other_size)));
+                at(i - other_size).~T();
+            }
         }
 
         Vector tmp = move(other);
@@ -530,14 +534,7 @@ public:
         size_t new_capacity = needed_capacity;
         auto* new_buffer = (T*)kmalloc(new_capacity * sizeof(T));
 
-        if constexpr (Traits<T>::is_trivial()) {
-            TypedTransfer<T>::copy(new_buffer, data(), m_size);
-        } else {
-            for (size_t i = 0; i < m_size; ++i) {
-                new (&new_buffer[i]) T(move(at(i)));
-                at(i).~T();
-            }
-        }
+        TypedTransfer<T>::relocate(new_buffer, data(), m_size);
         if (m_outline_buffer)
             kfree(m_outline_buffer);
         m_outline_buffer = new_buffer;
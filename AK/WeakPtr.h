@@ -27,6 +27,7 @@
 #pragma once
 
 #include <AK/LogStream.h>
+#include <AK/Traits.h>
 #include <AK/Weakable.h>
 
 namespace AK {
@@ -102,6 +103,11 @@ inline const LogStream& operator<<(const LogStream& stream, const WeakPtr<T>& va
     return stream << value.ptr();
 }
 
+template<typename T>
+struct Traits<WeakPtr<T>> : public GenericTraits<WeakPtr<T>> {
+    static constexpr bool is_trivially_relocatable() { return true; }
+};
+
 }
 
 using AK::WeakPtr;
@@ -66,7 +66,7 @@ int main(int argc, char** argv)
         return 1;
     }
 
-    if (pledge("stdio shared_buffer accept unix cpath rpath wpath fattr", nullptr) < 0) {
+    if (pledge("stdio shared_buffer accept unix recvfd cpath rpath wpath fattr", nullptr) < 0) {
         perror("pledge");
         return 1;
     }
@@ -84,7 +84,7 @@ int main(int argc, char** argv)
     Web::ResourceLoader::the();
 
     // FIXME: Once there is a standalone Download Manager, we can drop the "unix" pledge.
-    if (pledge("stdio shared_buffer accept unix cpath rpath wpath", nullptr) < 0) {
+    if (pledge("stdio shared_buffer accept unix recvfd cpath rpath wpath", nullptr) < 0) {
         perror("pledge");
         return 1;
     }
@@ -94,7 +94,7 @@ void MonitorWidget::paint_event(GUI::PaintEvent& event)
         } else if (m_desktop_wallpaper_mode == "tile") {
             screen_painter.draw_tiled_bitmap(screen_bitmap->rect(), *m_desktop_wallpaper_bitmap);
         } else if (m_desktop_wallpaper_mode == "scaled") {
-            screen_painter.draw_scaled_bitmap(screen_bitmap->rect(), *m_desktop_wallpaper_bitmap, m_desktop_wallpaper_bitmap->rect());
+            screen_painter.draw_scaled_bitmap(screen_bitmap->rect(), *m_desktop_wallpaper_bitmap, m_desktop_wallpaper_bitmap->rect(), 1.0f, Gfx::Painter::ScalingMode::Smooth);
         } else {
             ASSERT_NOT_REACHED();
         }
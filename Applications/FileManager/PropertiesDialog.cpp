@@ -33,6 +33,8 @@
 #include <LibGUI/FilePicker.h>
 #include <LibGUI/MessageBox.h>
 #include <LibGUI/TabWidget.h>
+#include <LibThread/ThreadPool.h>
+#include <LibThread/TreeWalk.h>
 #include <grp.h>
 #include <limits.h>
 #include <pwd.h>
@@ -127,13 +129,18 @@ PropertiesDialog::PropertiesDialog(const String& path, bool disable_rename, Wind
         }
     }
 
-    properties.append({ "Size:", String::format("%zu bytes", st.st_size) });
+    size_t size_index = properties.size();
+    properties.append({ "Size:", S_ISDIR(m_mode) ? "Calculating..." : String::format("%zu bytes", st.st_size) });
     properties.append({ "Owner:", String::format("%s (%lu)", owner_name.characters(), st.st_uid) });
     properties.append({ "Group:", String::format("%s (%lu)", group_name.characters(), st.st_gid) });
     properties.append({ "Created at:", GUI::FileSystemModel::timestamp_string(st.st_ctime) });
     properties.append({ "Last modified:", GUI::FileSystemModel::timestamp_string(st.st_mtime) });
 
-    make_property_value_pairs(properties, general_tab);
+    auto value_labels = make_property_value_pairs(properties, general_tab);
+    if (S_ISDIR(m_mode)) {
+        m_size_label = value_labels[size_index];
+        calculate_directory_size(path);
+    }
 
     make_divider(general_tab);
 
@@ -263,12 +270,14 @@ void PropertiesDialog::make_permission_checkboxes(GUI::Widget& parent, Permissio
     box_execute.set_enabled(can_edit_checkboxes);
 }
 
-void PropertiesDialog::make_property_value_pairs(const Vector<PropertyValuePair>& pairs, GUI::Widget& parent)
+Vector<NonnullRefPtr<GUI::Label>> PropertiesDialog::make_property_value_pairs(const Vector<PropertyValuePair>& pairs, GUI::Widget& parent)
 {
     int max_width = 0;
     Vector<NonnullRefPtr<GUI::Label>> property_labels;
+    Vector<NonnullRefPtr<GUI::Label>> value_labels;
 
     property_labels.ensure_capacity(pairs.size());
+    value_labels.ensure_capacity(pairs.size());
     for (auto pair : pairs) {
         auto& label_container = parent.add<GUI::Widget>();
         label_container.set_layout<GUI::HorizontalBoxLayout>();
@@ -280,7 +289,9 @@ void PropertiesDialog::make_property_value_pairs(const Vector<PropertyValuePair>
         label_property.set_text_alignment(Gfx::TextAlignment::CenterLeft);
         label_property.set_size_policy(GUI::SizePolicy::Fixed, GUI::SizePolicy::Fill);
 
-        label_container.add<GUI::Label>(pair.value).set_text_alignment(Gfx::TextAlignment::CenterLeft);
+        auto& label_value = label_container.add<GUI::Label>(pair.value);
+        label_value.set_text_alignment(Gfx::TextAlignment::CenterLeft);
+        value_labels.append(label_value);
 
         max_width = max(max_width, label_property.font().width(pair.property));
         property_labels.append(label_property);
@@ -288,6 +299,43 @@ void PropertiesDialog::make_property_value_pairs(const Vector<PropertyValuePair>
 
     for (auto label : property_labels)
         label->set_preferred_size({ max_width, 0 });
+    return value_labels;
+}
+
+void PropertiesDialog::calculate_directory_size(const String& path)
+{
+    struct DirectorySize {
+        u64 size { 0 };
+        size_t file_count { 0 };
+        size_t directory_count { 0 };
+    };
+
+    // This walks the whole tree, so do it on the thread pool and fill in the label once we know.
+    auto future = LibThread::ThreadPool::the().submit<DirectorySize>([path] {
+        DirectorySize total;
+        LibThread::TreeWalk walk(path);
+        walk.set_stat_entries(true);
+        walk.set_ordered_output(false);
+        walk.on_entry = [&](auto& entry) {
+            if (entry.depth == 0 || !entry.has_stat)
+                return IterationDecision::Continue;
+            total.size += entry.stat.st_size;
+            if (entry.type == DT_DIR)
+                ++total.directory_count;
+            else
+                ++total.file_count;
+            return IterationDecision::Continue;
+        };
+        walk.run();
+        return total;
+    });
+
+    auto weak_this = make_weak_ptr();
+    future->on_complete([this, weak_this](auto& total) {
+        if (weak_this.is_null())
+            return;
+        m_size_label->set_text(String::format("%llu bytes (%zu files, %zu folders)", total.size, total.file_count, total.directory_count));
+    });
 }
 
 GUI::Button& PropertiesDialog::make_button(String text, GUI::Widget& parent)
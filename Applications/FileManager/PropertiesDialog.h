@@ -77,16 +77,18 @@ private:
 
     GUI::Button& make_button(String, GUI::Widget& parent);
     void make_divider(GUI::Widget& parent);
-    void make_property_value_pairs(const Vector<PropertyValuePair>& pairs, GUI::Widget& parent);
+    Vector<NonnullRefPtr<GUI::Label>> make_property_value_pairs(const Vector<PropertyValuePair>& pairs, GUI::Widget& parent);
     void make_permission_checkboxes(GUI::Widget& parent, PermissionMasks, String label_string, mode_t mode);
     void permission_changed(mode_t mask, bool set);
     bool apply_changes();
     void update();
     String make_full_path(const String& name);
+    void calculate_directory_size(const String& path);
 
     RefPtr<GUI::Button> m_apply_button;
     RefPtr<GUI::TextBox> m_name_box;
     RefPtr<GUI::ImageWidget> m_icon;
+    RefPtr<GUI::Label> m_size_label;
     String m_name;
     String m_parent_path;
     String m_path;
@@ -56,7 +56,13 @@ BoxBlurFilter<N>::get_parameters(Gfx::Bitmap& bitmap, const Gfx::IntRect& rect)
 
     normalize(kernel);
 
-    return make<typename GenericConvolutionFilter<N>::Parameters>(bitmap, rect, kernel);
+    Vector<float> separable_kernel;
+    for (size_t i = 0; i < N; ++i)
+        separable_kernel.append(1.0f / N);
+
+    auto parameters = make<typename GenericConvolutionFilter<N>::Parameters>(bitmap, rect, kernel);
+    parameters->set_separable_kernel(move(separable_kernel));
+    return parameters;
 }
 
 }
@@ -26,6 +26,7 @@
 
 #pragma once
 
+#include <AK/Function.h>
 #include <LibGUI/Event.h>
 #include <LibGUI/Forward.h>
 #include <LibGfx/Forward.h>
@@ -59,6 +60,9 @@ public:
 
     virtual void apply(const Parameters&) = 0;
 
+    // Called from the thread that called apply() as the filter makes its way through the image, with the fraction that's done.
+    Function<void(float progress)> on_progress;
+
 protected:
     Filter();
 };
@@ -35,76 +35,284 @@
 #include <LibGUI/Painter.h>
 #include <LibGUI/TextBox.h>
 #include <LibGfx/Bitmap.h>
+#include <LibThread/ThreadPool.h>
+#include <string.h>
+
+#if ARCH(I386) || ARCH(X86_64)
+#    include <cpuid.h>
+#    include <emmintrin.h>
+#endif
 
 namespace PixelPaint {
 
-template<size_t N>
-GenericConvolutionFilter<N>::GenericConvolutionFilter()
+// Pixels are converted to four floats each, one row at a time, with the kernel_size - 1 pixels that the kernel
+// reaches past the sides of the rect as padding: wrapped around the image, or transparent black otherwise.
+// Every output row is then a weighted sum of shifted rows, which is what the SSE2 versions speed up.
+// They're picked at runtime. The kernel doesn't save AVX state, so there are no AVX versions.
+
+static bool has_sse2()
 {
+#if ARCH(I386) || ARCH(X86_64)
+    static bool s_has_sse2 = [] {
+        unsigned eax, ebx, ecx, edx;
+        return __get_cpuid(1, &eax, &ebx, &ecx, &edx) && (edx & bit_SSE2);
+    }();
+    return s_has_sse2;
+#else
+    return false;
+#endif
 }
 
-template<size_t N>
-GenericConvolutionFilter<N>::~GenericConvolutionFilter()
+static void accumulate_scalar(float* sums, const float* values, float weight, size_t count)
 {
+    for (size_t i = 0; i < count; ++i)
+        sums[i] += values[i] * weight;
 }
 
-template<size_t N>
-void GenericConvolutionFilter<N>::apply(const Filter::Parameters& parameters)
+#if ARCH(I386) || ARCH(X86_64)
+[[gnu::target("sse2")]] static void accumulate_sse2(float* sums, const float* values, float weight, size_t count)
 {
-    ASSERT(parameters.is_generic_convolution_filter());
+    const __m128 weights = _mm_set1_ps(weight);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+        _mm_storeu_ps(sums + i, _mm_add_ps(_mm_loadu_ps(sums + i), _mm_mul_ps(_mm_loadu_ps(values + i), weights)));
+    accumulate_scalar(sums + i, values + i, weight, count - i);
+}
+#endif
 
-    auto& gcf_params = static_cast<const GenericConvolutionFilter::Parameters&>(parameters);
+static void accumulate(float* sums, const float* values, float weight, size_t count)
+{
+#if ARCH(I386) || ARCH(X86_64)
+    if (has_sse2()) {
+        accumulate_sse2(sums, values, weight, count);
+        return;
+    }
+#endif
+    accumulate_scalar(sums, values, weight, count);
+}
 
-    auto& source = gcf_params.bitmap();
-    const auto& source_rect = gcf_params.rect();
-    auto target = Gfx::Bitmap::create(source.format(), parameters.rect().size());
-
-    // FIXME: Help! I am naive!
-    for (auto i_ = 0; i_ < source_rect.width(); ++i_) {
-        auto i = i_ + source_rect.x();
-        for (auto j_ = 0; j_ < source_rect.height(); ++j_) {
-            auto j = j_ + source_rect.y();
-            FloatVector3 value(0, 0, 0);
-            for (auto k = 0; k < 4; ++k) {
-                auto ki = i + k - 2;
-                if (ki < 0 || ki >= source.size().width()) {
-                    if (gcf_params.should_wrap())
-                        ki = (ki + source.size().width()) % source.size().width();
-                    else
-                        continue;
-                }
+struct ConvolutionContext {
+    const Gfx::Bitmap& source;
+    Gfx::Bitmap& target;
+    Gfx::IntRect rect;
+    int kernel_size;
+    bool should_wrap;
 
-                for (auto l = 0; l < 4; ++l) {
-                    auto lj = j + l - 2;
-                    if (lj < 0 || lj >= source.size().height()) {
-                        if (gcf_params.should_wrap())
-                            lj = (lj + source.size().height()) % source.size().height();
-                        else
-                            continue;
-                    }
+    size_t row_size() const { return rect.width() * 4; }
+    size_t padded_row_size() const { return (rect.width() + kernel_size - 1) * 4; }
+};
 
-                    auto pixel = source.get_pixel(ki, lj);
-                    FloatVector3 pixel_value(pixel.red(), pixel.green(), pixel.blue());
+// Returns false for rows above or below an image that doesn't wrap, which don't contribute anything.
+static bool load_padded_row(const ConvolutionContext& context, int y, float* row)
+{
+    auto& source = context.source;
+    if (y < 0 || y >= source.height()) {
+        if (!context.should_wrap)
+            return false;
+        y = (y % source.height() + source.height()) % source.height();
+    }
 
-                    value = value + pixel_value * gcf_params.kernel().elements()[k][l];
+    auto* scanline = source.scanline(y);
+    int first_x = context.rect.x() - context.kernel_size / 2;
+    int padded_width = context.rect.width() + context.kernel_size - 1;
+    for (int i = 0; i < padded_width; ++i) {
+        int x = first_x + i;
+        Gfx::RGBA32 pixel = 0;
+        if (x >= 0 && x < source.width())
+            pixel = scanline[x];
+        else if (context.should_wrap)
+            pixel = scanline[(x % source.width() + source.width()) % source.width()];
+        for (int channel = 0; channel < 4; ++channel)
+            row[i * 4 + channel] = (pixel >> (channel * 8)) & 0xff;
+    }
+    return true;
+}
+
+// The alpha channel is left as it was. Color channels that end up outside 0-255 wrap around.
+static void store_row(const ConvolutionContext& context, int y, const float* sums, float scale)
+{
+    auto* source = context.source.scanline(y) + context.rect.x();
+    auto* target = context.target.scanline(y) + context.rect.x();
+    for (int x = 0; x < context.rect.width(); ++x) {
+        Gfx::RGBA32 pixel = source[x] & 0xff000000;
+        for (int channel = 0; channel < 3; ++channel)
+            pixel |= (Gfx::RGBA32)(u8)(i32)(sums[x * 4 + channel] * scale) << (channel * 8);
+        target[x] = pixel;
+    }
+}
+
+// The kernel_size rows around the current output row are kept in a ring, so every row is only prepared once per band.
+static int ring_slot(int y, int kernel_size)
+{
+    return (y % kernel_size + kernel_size) % kernel_size;
+}
+
+// kernel[k * kernel_size + l] is the weight of the pixel k columns and l rows from the top left of the kernel.
+static void convolve_band(const ConvolutionContext& context, const float* kernel, int begin, int end)
+{
+    int kernel_size = context.kernel_size;
+    int radius = kernel_size / 2;
+    size_t padded_row_size = context.padded_row_size();
+    Vector<float> rows;
+    rows.resize(kernel_size * padded_row_size);
+    Vector<bool> row_is_present;
+    for (int i = 0; i < kernel_size; ++i)
+        row_is_present.append(false);
+    Vector<float> sums;
+    sums.resize(context.row_size());
+
+    auto load_row = [&](int y) {
+        int slot = ring_slot(y, kernel_size);
+        row_is_present[slot] = load_padded_row(context, y, rows.data() + slot * padded_row_size);
+    };
+
+    for (int y = begin - radius; y < begin - radius + kernel_size - 1; ++y)
+        load_row(y);
+    for (int y = begin; y < end; ++y) {
+        load_row(y - radius + kernel_size - 1);
+        memset(sums.data(), 0, sums.size() * sizeof(float));
+        for (int l = 0; l < kernel_size; ++l) {
+            int slot = ring_slot(y - radius + l, kernel_size);
+            if (!row_is_present[slot])
+                continue;
+            for (int k = 0; k < kernel_size; ++k)
+                accumulate(sums.data(), rows.data() + slot * padded_row_size + k * 4, kernel[k * kernel_size + l], sums.size());
+        }
+        store_row(context, y, sums.data(), 1);
+    }
+}
+
+// Box blurs have the same weight everywhere, so they keep running sums as the kernel slides along rows and down columns.
+// Those are sums of whole numbers, which floats hold exactly, so nothing drifts.
+static void convolve_band_separable(const ConvolutionContext& context, const Vector<float>& kernel, int begin, int end)
+{
+    int kernel_size = context.kernel_size;
+    int radius = kernel_size / 2;
+    bool is_box = true;
+    for (auto weight : kernel) {
+        if (weight != kernel[0])
+            is_box = false;
+    }
+
+    size_t row_size = context.row_size();
+    Vector<float> padded_row;
+    padded_row.resize(context.padded_row_size());
+    Vector<float> rows;
+    rows.resize(kernel_size * row_size);
+    Vector<bool> row_is_present;
+    for (int i = 0; i < kernel_size; ++i)
+        row_is_present.append(false);
+    Vector<float> sums;
+    sums.resize(row_size);
+    memset(sums.data(), 0, sums.size() * sizeof(float));
+
+    // Horizontal pass for row y. Box blurs leave the row unscaled.
+    auto load_row = [&](int y) {
+        int slot = ring_slot(y, kernel_size);
+        auto* row = rows.data() + slot * row_size;
+        if (is_box && row_is_present[slot])
+            accumulate(sums.data(), row, -1, row_size);
+        row_is_present[slot] = load_padded_row(context, y, padded_row.data());
+        if (!row_is_present[slot])
+            return;
+
+        if (is_box) {
+            for (int channel = 0; channel < 4; ++channel) {
+                float sum = 0;
+                for (int k = 0; k < kernel_size; ++k)
+                    sum += padded_row[k * 4 + channel];
+                row[channel] = sum;
+                for (int x = 1; x < context.rect.width(); ++x) {
+                    sum += padded_row[(x + kernel_size - 1) * 4 + channel] - padded_row[(x - 1) * 4 + channel];
+                    row[x * 4 + channel] = sum;
                 }
             }
+            accumulate(sums.data(), row, 1, row_size);
+            return;
+        }
+
+        memset(row, 0, row_size * sizeof(float));
+        for (int k = 0; k < kernel_size; ++k)
+            accumulate(row, padded_row.data() + k * 4, kernel[k], row_size);
+    };
 
-            // The float->u8 overflow is intentional.
-            target->set_pixel(i_, j_, Color(value.x(), value.y(), value.z(), source.get_pixel(i, j).alpha()));
+    for (int y = begin - radius; y < begin - radius + kernel_size - 1; ++y)
+        load_row(y);
+    for (int y = begin; y < end; ++y) {
+        load_row(y - radius + kernel_size - 1);
+        if (is_box) {
+            store_row(context, y, sums.data(), kernel[0] * kernel[0]);
+            continue;
         }
+        memset(sums.data(), 0, sums.size() * sizeof(float));
+        for (int l = 0; l < kernel_size; ++l) {
+            int slot = ring_slot(y - radius + l, kernel_size);
+            if (row_is_present[slot])
+                accumulate(sums.data(), rows.data() + slot * row_size, kernel[l], row_size);
+        }
+        store_row(context, y, sums.data(), 1);
     }
+}
 
-    // FIXME: Substitute for some sort of faster "blit" method.
-    for (auto i_ = 0; i_ < source_rect.width(); ++i_) {
-        auto i = i_ + source_rect.x();
-        for (auto j_ = 0; j_ < source_rect.height(); ++j_) {
-            auto j = j_ + source_rect.y();
-            source.set_pixel(i, j, target->get_pixel(i_, j_));
-        }
+// The rect is cut into bands of rows that are convolved on the thread pool. They're handed out a batch at a time,
+// so progress can be reported from the calling thread in between.
+template<typename Callback>
+static void for_each_band(const Gfx::IntRect& rect, const Function<void(float)>& on_progress, Callback callback)
+{
+    constexpr int band_height = 32;
+    auto& pool = LibThread::ThreadPool::the();
+    int band_count = (rect.height() + band_height - 1) / band_height;
+    int bands_per_batch = max<int>(1, pool.thread_count() * 4);
+    for (int first_band = 0; first_band < band_count; first_band += bands_per_batch) {
+        int end_band = min(first_band + bands_per_batch, band_count);
+        pool.parallel_for(first_band, end_band, 1, [&](size_t band) {
+            int begin = rect.y() + band * band_height;
+            callback(begin, min(begin + band_height, rect.y() + rect.height()));
+        });
+        if (on_progress)
+            on_progress((float)end_band / band_count);
     }
 }
 
+template<size_t N>
+GenericConvolutionFilter<N>::GenericConvolutionFilter()
+{
+}
+
+template<size_t N>
+GenericConvolutionFilter<N>::~GenericConvolutionFilter()
+{
+}
+
+template<size_t N>
+void GenericConvolutionFilter<N>::apply(const Filter::Parameters& parameters)
+{
+    ASSERT(parameters.is_generic_convolution_filter());
+
+    auto& gcf_params = static_cast<const GenericConvolutionFilter::Parameters&>(parameters);
+
+    auto& target = gcf_params.bitmap();
+    auto rect = gcf_params.rect().intersected(target.rect());
+    if (rect.is_empty())
+        return;
+
+    // Every output pixel is computed from the original pixels, so convolve from a copy.
+    auto source = Gfx::Bitmap::create(target.format(), target.size());
+    if (!source)
+        return;
+    for (int y = 0; y < target.height(); ++y)
+        memcpy(source->scanline(y), target.scanline(y), target.width() * sizeof(Gfx::RGBA32));
+
+    ConvolutionContext context { *source, target, rect, N, gcf_params.should_wrap() };
+    auto& separable_kernel = gcf_params.separable_kernel();
+    for_each_band(rect, on_progress, [&](int begin, int end) {
+        if (!separable_kernel.is_empty())
+            convolve_band_separable(context, separable_kernel, begin, end);
+        else
+            convolve_band(context, &gcf_params.kernel().elements()[0][0], begin, end);
+    });
+}
+
 template<size_t N>
 OwnPtr<typename GenericConvolutionFilter<N>::Parameters>
 GenericConvolutionFilter<N>::get_parameters(Gfx::Bitmap& bitmap, const Gfx::IntRect& rect, GUI::Window* parent_window)
@@ -27,6 +27,7 @@
 #pragma once
 
 #include "Filter.h"
+#include <AK/Vector.h>
 #include <LibGUI/Dialog.h>
 #include <LibGfx/Matrix.h>
 #include <LibGfx/Matrix4x4.h>
@@ -66,9 +67,19 @@ public:
         Gfx::Matrix<N, float>& kernel() { return m_kernel; }
         bool should_wrap() const { return m_should_wrap; }
 
+        // For kernels that are the outer product of a one-dimensional kernel with itself, like the blurs.
+        // Those are applied as a horizontal pass followed by a vertical one, which is much cheaper.
+        const Vector<float>& separable_kernel() const { return m_separable_kernel; }
+        void set_separable_kernel(Vector<float> kernel)
+        {
+            ASSERT(kernel.size() == N);
+            m_separable_kernel = move(kernel);
+        }
+
     private:
         virtual bool is_generic_convolution_filter() const override { return true; }
         Gfx::Matrix<N, float> m_kernel;
+        Vector<float> m_separable_kernel;
         bool m_should_wrap { false };
     };
 
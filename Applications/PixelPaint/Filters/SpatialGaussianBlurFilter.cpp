@@ -49,13 +49,26 @@ SpatialGaussianBlurFilter<N, _T>::get_parameters(Gfx::Bitmap& bitmap, const Gfx:
     for (auto x = -(ssize_t)N / 2; x <= (ssize_t)N / 2; x++) {
         for (auto y = -(ssize_t)N / 2; y <= (ssize_t)N / 2; y++) {
             auto r = sqrt(x * x + y * y);
-            kernel.elements()[x + 2][y + 2] = (exp(-(r * r) / s)) / (M_PI * s);
+            kernel.elements()[x + N / 2][y + N / 2] = (exp(-(r * r) / s)) / (M_PI * s);
         }
     }
 
     normalize(kernel);
 
-    return make<typename GenericConvolutionFilter<N>::Parameters>(bitmap, rect, kernel);
+    // exp(-(x * x + y * y) / s) is exp(-(x * x) / s) * exp(-(y * y) / s), so the normalized kernel
+    // is also the outer product of this one with itself.
+    Vector<float> separable_kernel;
+    auto sum = 0.0f;
+    for (auto x = -(ssize_t)N / 2; x <= (ssize_t)N / 2; x++) {
+        separable_kernel.append(exp(-(x * x) / s));
+        sum += separable_kernel.last();
+    }
+    for (auto& weight : separable_kernel)
+        weight /= sum;
+
+    auto parameters = make<typename GenericConvolutionFilter<N>::Parameters>(bitmap, rect, kernel);
+    parameters->set_separable_kernel(move(separable_kernel));
+    return parameters;
 }
 
 }
@@ -53,6 +53,17 @@
 #include <LibGfx/Matrix4x4.h>
 #include <stdio.h>
 
+// Filters run on the UI thread, so the progress goes in the title bar, which the window server draws for us.
+static void apply_filter(PixelPaint::Filter& filter, const PixelPaint::Filter::Parameters& parameters, GUI::Window& window)
+{
+    auto title = window.title();
+    filter.on_progress = [&](float progress) {
+        window.set_title(String::format("%s - %d%%", title.characters(), (int)(progress * 100)));
+    };
+    filter.apply(parameters);
+    window.set_title(title);
+}
+
 int main(int argc, char** argv)
 {
     if (pledge("stdio thread shared_buffer accept rpath unix wpath cpath fattr", nullptr) < 0) {
@@ -208,14 +219,14 @@ int main(int argc, char** argv)
         if (auto* layer = image_editor.active_layer()) {
             PixelPaint::LaplacianFilter filter;
             if (auto parameters = filter.get_parameters(layer->bitmap(), layer->rect(), false))
-                filter.apply(*parameters);
+                apply_filter(filter, *parameters, *window);
         }
     }));
     edge_detect_submenu.add_action(GUI::Action::create("Laplacian (diagonal)", [&](auto&) {
         if (auto* layer = image_editor.active_layer()) {
             PixelPaint::LaplacianFilter filter;
             if (auto parameters = filter.get_parameters(layer->bitmap(), layer->rect(), true))
-                filter.apply(*parameters);
+                apply_filter(filter, *parameters, *window);
         }
     }));
     auto& blur_submenu = spatial_filters_menu.add_submenu("Blur and Sharpen");
@@ -223,35 +234,35 @@ int main(int argc, char** argv)
         if (auto* layer = image_editor.active_layer()) {
             PixelPaint::SpatialGaussianBlurFilter<3> filter;
             if (auto parameters = filter.get_parameters(layer->bitmap(), layer->rect()))
-                filter.apply(*parameters);
+                apply_filter(filter, *parameters, *window);
         }
     }));
     blur_submenu.add_action(GUI::Action::create("Gaussian Blur (5x5)", [&](auto&) {
         if (auto* layer = image_editor.active_layer()) {
             PixelPaint::SpatialGaussianBlurFilter<5> filter;
             if (auto parameters = filter.get_parameters(layer->bitmap(), layer->rect()))
-                filter.apply(*parameters);
+                apply_filter(filter, *parameters, *window);
         }
     }));
     blur_submenu.add_action(GUI::Action::create("Box Blur (3x3)", [&](auto&) {
         if (auto* layer = image_editor.active_layer()) {
             PixelPaint::BoxBlurFilter<3> filter;
             if (auto parameters = filter.get_parameters(layer->bitmap(), layer->rect()))
-                filter.apply(*parameters);
+                apply_filter(filter, *parameters, *window);
         }
     }));
     blur_submenu.add_action(GUI::Action::create("Box Blur (5x5)", [&](auto&) {
         if (auto* layer = image_editor.active_layer()) {
             PixelPaint::BoxBlurFilter<5> filter;
             if (auto parameters = filter.get_parameters(layer->bitmap(), layer->rect()))
-                filter.apply(*parameters);
+                apply_filter(filter, *parameters, *window);
         }
     }));
     blur_submenu.add_action(GUI::Action::create("Sharpen", [&](auto&) {
         if (auto* layer = image_editor.active_layer()) {
             PixelPaint::SharpenFilter filter;
             if (auto parameters = filter.get_parameters(layer->bitmap(), layer->rect()))
-                filter.apply(*parameters);
+                apply_filter(filter, *parameters, *window);
         }
     }));
 
@@ -260,7 +271,7 @@ int main(int argc, char** argv)
         if (auto* layer = image_editor.active_layer()) {
             PixelPaint::GenericConvolutionFilter<5> filter;
             if (auto parameters = filter.get_parameters(layer->bitmap(), layer->rect(), window))
-                filter.apply(*parameters);
+                apply_filter(filter, *parameters, *window);
         }
     }));
 
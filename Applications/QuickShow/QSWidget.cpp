@@ -189,7 +189,7 @@ void QSWidget::paint_event(GUI::PaintEvent& event)
     painter.fill_rect_with_checkerboard(frame_inner_rect(), { 8, 8 }, palette().base().darkened(0.9), palette().base());
 
     if (!m_bitmap.is_null())
-        painter.draw_scaled_bitmap(m_bitmap_rect, *m_bitmap, m_bitmap->rect());
+        painter.draw_scaled_bitmap(m_bitmap_rect, *m_bitmap, m_bitmap->rect(), 1.0f, Gfx::Painter::ScalingMode::Smooth);
 }
 
 void QSWidget::mousedown_event(GUI::MouseEvent& event)
@@ -134,6 +134,14 @@ String ProcessModel::column_name(int column) const
         return "IPv4 In";
     case Column::IPv4SocketWriteBytes:
         return "IPv4 Out";
+    case Column::RunnableTime:
+        return "S:Runnable";
+    case Column::BlockedTime:
+        return "S:Blocked";
+    case Column::QueuedTime:
+        return "S:Queued";
+    case Column::InvoluntarySwitches:
+        return "S:Preempted";
     case Column::UnixSocketReadBytes:
         return "Unix In";
     case Column::UnixSocketWriteBytes:
@@ -156,6 +164,11 @@ static String pretty_byte_size(size_t size)
     return String::format("%uK", size / 1024);
 }
 
+static String pretty_cycle_count(u64 cycles)
+{
+    return String::format("%lluM", cycles / 1000000);
+}
+
 GUI::Variant ProcessModel::data(const GUI::ModelIndex& index, Role role) const
 {
     ASSERT(is_valid(index));
@@ -194,6 +207,10 @@ GUI::Variant ProcessModel::data(const GUI::ModelIndex& index, Role role) const
         case Column::UnixSocketWriteBytes:
         case Column::IPv4SocketReadBytes:
         case Column::IPv4SocketWriteBytes:
+        case Column::RunnableTime:
+        case Column::BlockedTime:
+        case Column::QueuedTime:
+        case Column::InvoluntarySwitches:
             return Gfx::TextAlignment::CenterRight;
         default:
             ASSERT_NOT_REACHED();
@@ -255,6 +272,14 @@ GUI::Variant ProcessModel::data(const GUI::ModelIndex& index, Role role) const
             return thread.current_state.ipv4_socket_read_bytes;
         case Column::IPv4SocketWriteBytes:
             return thread.current_state.ipv4_socket_write_bytes;
+        case Column::RunnableTime:
+            return (i64)thread.current_state.runnable_cycles;
+        case Column::BlockedTime:
+            return (i64)thread.current_state.blocked_cycles;
+        case Column::QueuedTime:
+            return (i64)thread.current_state.queued_cycles;
+        case Column::InvoluntarySwitches:
+            return thread.current_state.involuntary_switches;
         case Column::UnixSocketReadBytes:
             return thread.current_state.unix_socket_read_bytes;
         case Column::UnixSocketWriteBytes:
@@ -332,6 +357,14 @@ GUI::Variant ProcessModel::data(const GUI::ModelIndex& index, Role role) const
             return thread.current_state.ipv4_socket_read_bytes;
         case Column::IPv4SocketWriteBytes:
             return thread.current_state.ipv4_socket_write_bytes;
+        case Column::RunnableTime:
+            return pretty_cycle_count(thread.current_state.runnable_cycles);
+        case Column::BlockedTime:
+            return pretty_cycle_count(thread.current_state.blocked_cycles);
+        case Column::QueuedTime:
+            return pretty_cycle_count(thread.current_state.queued_cycles);
+        case Column::InvoluntarySwitches:
+            return thread.current_state.involuntary_switches;
         case Column::UnixSocketReadBytes:
             return thread.current_state.unix_socket_read_bytes;
         case Column::UnixSocketWriteBytes:
@@ -375,6 +408,10 @@ void ProcessModel::update()
             state.unix_socket_write_bytes = thread.unix_socket_write_bytes;
             state.ipv4_socket_read_bytes = thread.ipv4_socket_read_bytes;
             state.ipv4_socket_write_bytes = thread.ipv4_socket_write_bytes;
+            state.runnable_cycles = thread.runnable_cycles;
+            state.blocked_cycles = thread.blocked_cycles;
+            state.queued_cycles = thread.queued_cycles;
+            state.involuntary_switches = thread.involuntary_switches;
             state.file_read_bytes = thread.file_read_bytes;
             state.file_write_bytes = thread.file_write_bytes;
             state.amount_virtual = it.value.amount_virtual;
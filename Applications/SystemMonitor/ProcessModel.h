@@ -78,6 +78,10 @@ public:
         UnixSocketWriteBytes,
         IPv4SocketReadBytes,
         IPv4SocketWriteBytes,
+        RunnableTime,
+        BlockedTime,
+        QueuedTime,
+        InvoluntarySwitches,
         __Count
     };
 
@@ -138,6 +142,10 @@ private:
         unsigned unix_socket_write_bytes;
         unsigned ipv4_socket_read_bytes;
         unsigned ipv4_socket_write_bytes;
+        u64 runnable_cycles;
+        u64 blocked_cycles;
+        u64 queued_cycles;
+        unsigned involuntary_switches;
         unsigned file_read_bytes;
         unsigned file_write_bytes;
         float cpu_percent;
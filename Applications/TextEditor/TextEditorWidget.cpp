@@ -543,7 +543,8 @@ void TextEditorWidget::open_sesame(const String& path)
         return;
     }
 
-    m_editor->set_text(file->read_all());
+    if (!m_editor->set_text_from_file(path))
+        m_editor->set_text(file->read_all());
     m_document_dirty = false;
     m_document_opening = true;
 
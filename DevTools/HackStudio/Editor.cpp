@@ -26,6 +26,7 @@
 
 #include "Editor.h"
 #include "EditorWrapper.h"
+#include "HackStudio.h"
 #include <AK/ByteBuffer.h>
 #include <AK/LexicalPath.h>
 #include <LibCore/DirIterator.h>
@@ -282,6 +283,12 @@ void Editor::mousedown_event(GUI::MouseEvent& event)
 
     for (auto& span : document().spans()) {
         if (span.range.contains(text_position)) {
+            if (highlighter->is_identifier(span.data)) {
+                auto adjusted_range = span.range;
+                adjusted_range.end().set_column(adjusted_range.end().column() + 1);
+                navigate_to_definition_if_available(document().text_in_range(adjusted_range));
+                return;
+            }
             if (!highlighter->is_navigatable(span.data)) {
                 GUI::TextEditor::mousedown_event(event);
                 return;
@@ -371,6 +378,27 @@ void Editor::navigate_to_include_if_available(String path)
     on_open(it->value);
 }
 
+void Editor::navigate_to_definition_if_available(const String& name)
+{
+    auto symbols = g_project->symbol_index().find(name);
+    if (symbols.is_empty()) {
+#ifdef EDITOR_DEBUG
+        dbg() << "no definition of " << name << " found.";
+#endif
+        return;
+    }
+
+    // Symbols come with definitions first; prefer one in the file we're looking at.
+    auto* symbol = symbols.first();
+    for (auto* candidate : symbols) {
+        if (candidate->is_definition && candidate->file == wrapper().filename_label().text()) {
+            symbol = candidate;
+            break;
+        }
+    }
+    open_file_at(symbol->file, { symbol->line, symbol->column });
+}
+
 void Editor::set_execution_position(size_t line_number)
 {
     m_execution_position = line_number;
@@ -33,6 +33,7 @@
 
 GUI::TextEditor& current_editor();
 void open_file(const String&);
+void open_file_at(const String&, const GUI::TextPosition&);
 
 extern RefPtr<EditorWrapper> g_current_editor_wrapper;
 extern Function<void(String)> g_open_file;
@@ -30,15 +30,25 @@
 #include <LibGUI/BoxLayout.h>
 #include <LibGUI/TableView.h>
 #include <LibGUI/TextBox.h>
+#include <LibGUI/TextPosition.h>
 #include <LibGUI/Window.h>
 
 static RefPtr<Gfx::Bitmap> s_file_icon;
 static RefPtr<Gfx::Bitmap> s_cplusplus_icon;
 static RefPtr<Gfx::Bitmap> s_header_icon;
 
+static const size_t max_symbol_suggestions = 50;
+
+struct LocatorSuggestion {
+    String name;
+    String file;
+    // Only symbols have a position.
+    Optional<GUI::TextPosition> position;
+};
+
 class LocatorSuggestionModel final : public GUI::Model {
 public:
-    explicit LocatorSuggestionModel(Vector<String>&& suggestions)
+    explicit LocatorSuggestionModel(Vector<LocatorSuggestion>&& suggestions)
         : m_suggestions(move(suggestions))
     {
     }
@@ -46,6 +56,7 @@ public:
     enum Column {
         Icon,
         Name,
+        Location,
         __Column_Count,
     };
     virtual int row_count(const GUI::ModelIndex& = GUI::ModelIndex()) const override { return m_suggestions.size(); }
@@ -55,11 +66,16 @@ public:
         auto& suggestion = m_suggestions.at(index.row());
         if (role == Role::Display) {
             if (index.column() == Column::Name)
-                return suggestion;
+                return suggestion.name;
+            if (index.column() == Column::Location) {
+                if (!suggestion.position.has_value())
+                    return "";
+                return String::format("%s:%zu", suggestion.file.characters(), suggestion.position.value().line() + 1);
+            }
             if (index.column() == Column::Icon) {
-                if (suggestion.ends_with(".cpp"))
+                if (suggestion.file.ends_with(".cpp"))
                     return *s_cplusplus_icon;
-                if (suggestion.ends_with(".h"))
+                if (suggestion.file.ends_with(".h"))
                     return *s_header_icon;
                 return *s_file_icon;
             }
@@ -68,8 +84,10 @@ public:
     }
     virtual void update() override {};
 
+    const LocatorSuggestion& suggestion(const GUI::ModelIndex& index) const { return m_suggestions.at(index.row()); }
+
 private:
-    Vector<String> m_suggestions;
+    Vector<LocatorSuggestion> m_suggestions;
 };
 
 Locator::Locator()
@@ -141,9 +159,11 @@ Locator::~Locator()
 
 void Locator::open_suggestion(const GUI::ModelIndex& index)
 {
-    auto filename_index = m_suggestion_view->model()->index(index.row(), LocatorSuggestionModel::Column::Name);
-    auto filename = m_suggestion_view->model()->data(filename_index, GUI::Model::Role::Display).to_string();
-    open_file(filename);
+    auto& suggestion = static_cast<LocatorSuggestionModel&>(*m_suggestion_view->model()).suggestion(index);
+    if (suggestion.position.has_value())
+        open_file_at(suggestion.file, suggestion.position.value());
+    else
+        open_file(suggestion.file);
     close();
 }
 
@@ -164,14 +184,16 @@ void Locator::close()
 void Locator::update_suggestions()
 {
     auto typed_text = m_textbox->text();
-    Vector<String> suggestions;
+    Vector<LocatorSuggestion> suggestions;
     g_project->for_each_text_file([&](auto& file) {
         if (file.name().contains(typed_text))
-            suggestions.append(file.name());
+            suggestions.append({ file.name(), file.name(), {} });
     });
+    for (auto* symbol : g_project->symbol_index().fuzzy_find(typed_text, max_symbol_suggestions))
+        suggestions.append({ symbol->qualified_name(), symbol->file, GUI::TextPosition { symbol->line, symbol->column } });
     dbg() << "I have " << suggestions.size() << " suggestion(s):";
     for (auto& s : suggestions) {
-        dbg() << "    " << s;
+        dbg() << "    " << s.name;
     }
 
     bool has_suggestions = !suggestions.is_empty();
@@ -181,6 +181,9 @@ Project::Project(const String& path, Vector<String>&& filenames)
         m_files.append(ProjectFile::construct_with_name(filename));
     }
 
+    m_symbol_index = make<SymbolIndex>(String::format("%s.symbols", m_path.characters()));
+    m_symbol_index->set_files(filenames);
+
     m_model = adopt(*new ProjectModel(*this));
 
     rebuild_tree();
@@ -248,6 +251,7 @@ OwnPtr<Project> Project::load_from_file(const String& path)
 bool Project::add_file(const String& filename)
 {
     m_files.append(ProjectFile::construct_with_name(filename));
+    m_symbol_index->add_file(filename);
     rebuild_tree();
     m_model->update();
     return save();
@@ -258,6 +262,7 @@ bool Project::remove_file(const String& filename)
     if (!get_file(filename))
         return false;
     m_files.remove_first_matching([filename](auto& file) { return file->name() == filename; });
+    m_symbol_index->remove_file(filename);
     rebuild_tree();
     m_model->update();
     return save();
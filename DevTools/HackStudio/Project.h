@@ -27,6 +27,7 @@
 #pragma once
 
 #include "ProjectFile.h"
+#include "SymbolIndex.h"
 #include <AK/Noncopyable.h>
 #include <AK/NonnullRefPtrVector.h>
 #include <AK/OwnPtr.h>
@@ -55,6 +56,7 @@ public:
 
     ProjectType type() const { return m_type; }
     GUI::Model& model() { return *m_model; }
+    SymbolIndex& symbol_index() { return *m_symbol_index; }
     String default_file() const;
     String name() const { return m_name; }
     String path() const { return m_path; }
@@ -81,6 +83,7 @@ private:
     RefPtr<GUI::Model> m_model;
     NonnullRefPtrVector<ProjectFile> m_files;
     RefPtr<ProjectTreeNode> m_root_node;
+    OwnPtr<SymbolIndex> m_symbol_index;
 
     GUI::Icon m_directory_icon;
     GUI::Icon m_file_icon;
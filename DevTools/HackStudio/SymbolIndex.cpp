@@ -0,0 +1,944 @@
+/*
+ * Copyright (c) 2020, The SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "SymbolIndex.h"
+#include <AK/MappedFile.h>
+#include <AK/QuickSort.h>
+#include <AK/StringBuilder.h>
+#include <LibCore/File.h>
+#include <LibCore/Notifier.h>
+#include <LibCore/Timer.h>
+#include <LibGUI/CppLexer.h>
+#include <LibThread/ThreadPool.h>
+#include <ctype.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// #define SYMBOL_INDEX_DEBUG
+
+static const char* index_file_header = "HackStudio symbol index 1";
+
+// Saving is put off for a bit, so that a burst of changes is written out only once.
+static const int save_delay_ms = 2000;
+
+using TokenType = GUI::CppToken::Type;
+
+struct Token {
+    TokenType type;
+    StringView text;
+    size_t line;
+    size_t column;
+};
+
+static Vector<Token> significant_tokens(const StringView& source)
+{
+    Vector<size_t> line_offsets;
+    line_offsets.append(0);
+    for (size_t i = 0; i < source.length(); ++i) {
+        if (source[i] == '\n')
+            line_offsets.append(i + 1);
+    }
+
+    Vector<Token> tokens;
+    GUI::CppLexer lexer(source);
+    lexer.lex([&](auto& token) {
+        switch (token.m_type) {
+        case TokenType::Whitespace:
+        case TokenType::Comment:
+        case TokenType::PreprocessorStatement:
+        case TokenType::IncludeStatement:
+        case TokenType::IncludePath:
+            return IterationDecision::Continue;
+        default:
+            break;
+        }
+        // The end position is that of the token's last character.
+        size_t start = line_offsets[token.m_start.line] + token.m_start.column;
+        size_t end = min(line_offsets[token.m_end.line] + token.m_end.column + 1, source.length());
+        if (start < end)
+            tokens.append({ token.m_type, source.substring_view(start, end - start), token.m_start.line, token.m_start.column });
+        return IterationDecision::Continue;
+    });
+    return tokens;
+}
+
+// Finds the declarations and definitions of namespaces, types and functions.
+// This doesn't try to understand C++, it only keeps track of which namespace or class
+// it's in and skips over anything in between braces that isn't one of those.
+class Parser {
+public:
+    Parser(const String& file, Vector<Token>&& tokens)
+        : m_file(file)
+        , m_tokens(move(tokens))
+    {
+    }
+
+    Vector<SymbolIndex::Symbol> parse();
+
+private:
+    struct Scope {
+        String name;
+        // Functions with this name are constructors.
+        StringView class_name;
+    };
+
+    bool at(size_t index, TokenType type) const { return index < m_tokens.size() && m_tokens[index].type == type; }
+    bool at(size_t index, const StringView& text) const { return index < m_tokens.size() && m_tokens[index].text == text; }
+    bool at_name(size_t index) const { return at(index, TokenType::Identifier) || at(index, TokenType::KnownType); }
+
+    size_t skip_balanced(size_t index) const;
+    size_t skip_template_arguments(size_t index) const;
+    size_t skip_until(size_t index, TokenType) const;
+    size_t skip_initializer(size_t index) const;
+
+    size_t parse_keyword(size_t index);
+    size_t parse_namespace(size_t index);
+    size_t parse_type(size_t index);
+    size_t parse_function(size_t index);
+
+    String current_scope() const;
+    void add(const Token&, const String& name, const String& scope, SymbolIndex::Kind, bool is_definition);
+
+    const String& m_file;
+    Vector<Token> m_tokens;
+    Vector<Scope> m_scopes;
+    Vector<SymbolIndex::Symbol> m_symbols;
+};
+
+static String join_scope(const StringView& outer, const StringView& inner)
+{
+    if (outer.is_empty())
+        return inner;
+    if (inner.is_empty())
+        return outer;
+    StringBuilder builder;
+    builder.append(outer);
+    builder.append("::");
+    builder.append(inner);
+    return builder.to_string();
+}
+
+String Parser::current_scope() const
+{
+    String scope = "";
+    for (auto& it : m_scopes)
+        scope = join_scope(scope, it.name);
+    return scope;
+}
+
+void Parser::add(const Token& token, const String& name, const String& scope, SymbolIndex::Kind kind, bool is_definition)
+{
+    m_symbols.append({ name, scope, kind, is_definition, m_file, token.line, token.column });
+}
+
+// Returns the index after the bracket that closes the one at index.
+size_t Parser::skip_balanced(size_t index) const
+{
+    auto open = m_tokens[index].type;
+    auto close = open == TokenType::LeftCurly ? TokenType::RightCurly : open == TokenType::LeftParen ? TokenType::RightParen : TokenType::RightBracket;
+    size_t depth = 0;
+    for (; index < m_tokens.size(); ++index) {
+        if (m_tokens[index].type == open) {
+            ++depth;
+        } else if (m_tokens[index].type == close) {
+            if (--depth == 0)
+                return index + 1;
+        }
+    }
+    return index;
+}
+
+size_t Parser::skip_template_arguments(size_t index) const
+{
+    int depth = 0;
+    while (index < m_tokens.size()) {
+        switch (m_tokens[index].type) {
+        case TokenType::Less:
+            ++depth;
+            break;
+        case TokenType::Greater:
+            --depth;
+            break;
+        case TokenType::GreaterGreater:
+            depth -= 2;
+            break;
+        case TokenType::LeftParen:
+        case TokenType::LeftBracket:
+            index = skip_balanced(index);
+            continue;
+        case TokenType::LeftCurly:
+        case TokenType::RightCurly:
+        case TokenType::Semicolon:
+            return index;
+        default:
+            break;
+        }
+        ++index;
+        if (depth <= 0)
+            return index;
+    }
+    return index;
+}
+
+size_t Parser::skip_until(size_t index, TokenType type) const
+{
+    while (index < m_tokens.size() && !at(index, type)) {
+        if (at(index, TokenType::LeftCurly) || at(index, TokenType::LeftParen) || at(index, TokenType::LeftBracket))
+            index = skip_balanced(index);
+        else
+            ++index;
+    }
+    return index;
+}
+
+size_t Parser::skip_initializer(size_t index) const
+{
+    while (index < m_tokens.size()) {
+        switch (m_tokens[index].type) {
+        case TokenType::Semicolon:
+        case TokenType::Comma:
+        case TokenType::RightCurly:
+            return index;
+        case TokenType::LeftCurly:
+        case TokenType::LeftParen:
+        case TokenType::LeftBracket:
+            index = skip_balanced(index);
+            break;
+        default:
+            ++index;
+            break;
+        }
+    }
+    return index;
+}
+
+Vector<SymbolIndex::Symbol> Parser::parse()
+{
+    size_t index = 0;
+    while (index < m_tokens.size()) {
+        switch (m_tokens[index].type) {
+        case TokenType::LeftCurly:
+        case TokenType::LeftParen:
+        case TokenType::LeftBracket:
+            index = skip_balanced(index);
+            continue;
+        case TokenType::RightCurly:
+            if (!m_scopes.is_empty())
+                m_scopes.take_last();
+            break;
+        case TokenType::Equals:
+            index = skip_initializer(index + 1);
+            continue;
+        case TokenType::Keyword:
+            index = parse_keyword(index);
+            continue;
+        case TokenType::Identifier:
+        case TokenType::KnownType:
+            if (at(index + 1, TokenType::LeftParen)) {
+                index = parse_function(index);
+                continue;
+            }
+            break;
+        default:
+            break;
+        }
+        ++index;
+    }
+    return move(m_symbols);
+}
+
+size_t Parser::parse_keyword(size_t index)
+{
+    auto keyword = m_tokens[index].text;
+    if (keyword == "template") {
+        if (at(index + 1, TokenType::Less))
+            return skip_template_arguments(index + 1);
+        return index + 1;
+    }
+    if (keyword == "namespace")
+        return parse_namespace(index);
+    if (keyword == "class" || keyword == "struct" || keyword == "union" || keyword == "enum")
+        return parse_type(index);
+    if (keyword == "using" || keyword == "typedef")
+        return skip_until(index, TokenType::Semicolon);
+    if (keyword == "friend" && (at(index + 1, "class") || at(index + 1, "struct")))
+        return skip_until(index, TokenType::Semicolon);
+    if (keyword == "operator") {
+        // Skip ahead to the parameters, so that `operator=` isn't taken for an initializer.
+        size_t next = index + 1;
+        if (at(next, TokenType::LeftParen))
+            next += 2;
+        while (next < m_tokens.size() && !at(next, TokenType::LeftParen) && !at(next, TokenType::Semicolon) && !at(next, TokenType::LeftCurly))
+            ++next;
+        return next;
+    }
+    if (keyword == "extern") {
+        // extern "C" { ... }
+        size_t next = index + 1;
+        while (at(next, TokenType::DoubleQuotedString))
+            ++next;
+        if (next > index + 1 && at(next, TokenType::LeftCurly)) {
+            m_scopes.append(Scope {});
+            return next + 1;
+        }
+    }
+    return index + 1;
+}
+
+size_t Parser::parse_namespace(size_t index)
+{
+    size_t next = index + 1;
+    Vector<const Token*> names;
+    while (at(next, TokenType::Identifier)) {
+        names.append(&m_tokens[next++]);
+        if (!at(next, TokenType::ColonColon))
+            break;
+        ++next;
+    }
+
+    if (at(next, TokenType::Equals))
+        return skip_until(next, TokenType::Semicolon);
+    if (!at(next, TokenType::LeftCurly))
+        return next;
+
+    // `namespace A::B {` is closed by a single brace, so it gets a single scope.
+    auto scope = current_scope();
+    String name = "";
+    for (auto* token : names) {
+        add(*token, token->text, join_scope(scope, name), SymbolIndex::Kind::Namespace, true);
+        name = join_scope(name, token->text);
+    }
+    m_scopes.append({ name, {} });
+    return next + 1;
+}
+
+size_t Parser::parse_type(size_t index)
+{
+    auto keyword = m_tokens[index].text;
+    auto kind = keyword == "class" ? SymbolIndex::Kind::Class : keyword == "struct" ? SymbolIndex::Kind::Struct : keyword == "union" ? SymbolIndex::Kind::Union : SymbolIndex::Kind::Enum;
+
+    size_t next = index + 1;
+    if (kind == SymbolIndex::Kind::Enum && (at(next, "class") || at(next, "struct")))
+        ++next;
+    while (at(next, TokenType::LeftBracket))
+        next = skip_balanced(next);
+
+    if (at(next, TokenType::LeftCurly)) {
+        if (kind == SymbolIndex::Kind::Enum)
+            return skip_balanced(next);
+        m_scopes.append(Scope {});
+        return next + 1;
+    }
+    if (!at_name(next))
+        return next;
+
+    String qualifiers = "";
+    size_t name_index = next++;
+    while (at(next, TokenType::ColonColon) && at_name(next + 1)) {
+        qualifiers = join_scope(qualifiers, m_tokens[name_index].text);
+        name_index = next + 1;
+        next += 2;
+    }
+    if (at(next, TokenType::Less))
+        next = skip_template_arguments(next);
+    if (at(next, "final"))
+        ++next;
+    if (at(next, TokenType::Colon)) {
+        // Base classes, or the underlying type of an enum.
+        while (next < m_tokens.size() && !at(next, TokenType::LeftCurly) && !at(next, TokenType::Semicolon)) {
+            if (at(next, TokenType::Less))
+                next = skip_template_arguments(next);
+            else
+                ++next;
+        }
+    }
+
+    auto& name = m_tokens[name_index];
+    auto scope = join_scope(current_scope(), qualifiers);
+    if (at(next, TokenType::Semicolon)) {
+        add(name, name.text, scope, kind, false);
+        return next + 1;
+    }
+    // Something like `struct stat st;`, which isn't about the type itself.
+    if (!at(next, TokenType::LeftCurly))
+        return name_index + 1;
+
+    add(name, name.text, scope, kind, true);
+    if (kind == SymbolIndex::Kind::Enum)
+        return skip_balanced(next);
+    m_scopes.append({ join_scope(qualifiers, name.text), name.text });
+    return next + 1;
+}
+
+static bool is_function_qualifier(const StringView& text)
+{
+    return text == "const" || text == "volatile" || text == "override" || text == "final" || text == "noexcept" || text == "throw" || text == "__attribute__";
+}
+
+size_t Parser::parse_function(size_t index)
+{
+    auto& name = m_tokens[index];
+    size_t after_parameters = skip_balanced(index + 1);
+
+    // Walk back over `~` and `Class::` to find where the declarator starts.
+    size_t start = index;
+    bool is_destructor = false;
+    if (start > 0 && at(start - 1, TokenType::Tilde)) {
+        is_destructor = true;
+        --start;
+    }
+    String qualifiers = "";
+    StringView innermost_qualifier;
+    while (start >= 2 && at(start - 1, TokenType::ColonColon) && at_name(start - 2)) {
+        if (innermost_qualifier.is_null())
+            innermost_qualifier = m_tokens[start - 2].text;
+        qualifiers = join_scope(m_tokens[start - 2].text, qualifiers);
+        start -= 2;
+    }
+
+    // Without a return type in front, this has to be a constructor or it's probably a macro.
+    bool has_return_type = false;
+    if (start > 0) {
+        auto& previous = m_tokens[start - 1];
+        switch (previous.type) {
+        case TokenType::Identifier:
+        case TokenType::KnownType:
+        case TokenType::Greater:
+        case TokenType::GreaterGreater:
+        case TokenType::Asterisk:
+        case TokenType::And:
+        case TokenType::AndAnd:
+            has_return_type = true;
+            break;
+        case TokenType::Keyword:
+            has_return_type = previous.text != "operator" && previous.text != "new" && previous.text != "return";
+            break;
+        default:
+            break;
+        }
+    }
+    bool is_constructor = is_destructor;
+    if (!innermost_qualifier.is_null())
+        is_constructor |= innermost_qualifier == name.text;
+    else if (!m_scopes.is_empty() && !m_scopes.last().class_name.is_null())
+        is_constructor |= m_scopes.last().class_name == name.text;
+    if (!has_return_type && !is_constructor)
+        return after_parameters;
+
+    // `Foo foo(1);` is a variable.
+    if (at(index + 2, TokenType::Integer) || at(index + 2, TokenType::Float) || at(index + 2, TokenType::DoubleQuotedString) || at(index + 2, TokenType::SingleQuotedString))
+        return after_parameters;
+
+    size_t next = after_parameters;
+    for (;;) {
+        if ((at(next, TokenType::Keyword) || at(next, TokenType::Identifier)) && is_function_qualifier(m_tokens[next].text)) {
+            ++next;
+            if (at(next, TokenType::LeftParen))
+                next = skip_balanced(next);
+            continue;
+        }
+        if (at(next, TokenType::And) || at(next, TokenType::AndAnd)) {
+            ++next;
+            continue;
+        }
+        if (at(next, TokenType::LeftBracket)) {
+            next = skip_balanced(next);
+            continue;
+        }
+        if (at(next, TokenType::Arrow)) {
+            // A trailing return type.
+            ++next;
+            while (next < m_tokens.size() && !at(next, TokenType::LeftCurly) && !at(next, TokenType::Semicolon) && !at(next, TokenType::Equals)) {
+                if (at(next, TokenType::LeftParen))
+                    next = skip_balanced(next);
+                else if (at(next, TokenType::Less))
+                    next = skip_template_arguments(next);
+                else
+                    ++next;
+            }
+            continue;
+        }
+        break;
+    }
+
+    auto& token = is_destructor ? m_tokens[index - 1] : name;
+    auto function_name = is_destructor ? String::format("~%s", String(name.text).characters()) : String(name.text);
+    auto scope = join_scope(current_scope(), qualifiers);
+
+    if (at(next, TokenType::LeftCurly)) {
+        add(token, function_name, scope, SymbolIndex::Kind::Function, true);
+        return skip_balanced(next);
+    }
+    if (at(next, TokenType::Colon)) {
+        // A constructor's member initializers, followed by its body.
+        ++next;
+        while (next < m_tokens.size()) {
+            if (at(next, TokenType::LeftParen)) {
+                next = skip_balanced(next);
+                continue;
+            }
+            if (at(next, TokenType::LeftCurly)) {
+                if (at_name(next - 1) || at(next - 1, TokenType::Greater)) {
+                    next = skip_balanced(next);
+                    continue;
+                }
+                add(token, function_name, scope, SymbolIndex::Kind::Function, true);
+                return skip_balanced(next);
+            }
+            if (at(next, TokenType::Semicolon) || at(next, TokenType::RightCurly))
+                return next;
+            ++next;
+        }
+        return next;
+    }
+    if (at(next, TokenType::Semicolon)) {
+        add(token, function_name, scope, SymbolIndex::Kind::Function, false);
+        return next + 1;
+    }
+    if (at(next, TokenType::Equals) && (at(next + 1, TokenType::Integer) || at(next + 1, "default") || at(next + 1, "delete")) && at(next + 2, TokenType::Semicolon)) {
+        add(token, function_name, scope, SymbolIndex::Kind::Function, false);
+        return next + 3;
+    }
+    return after_parameters;
+}
+
+struct ParseResult {
+    time_t modification_time { 0 };
+    Vector<SymbolIndex::Symbol> symbols;
+};
+
+static String to_lowercase(const StringView& string)
+{
+    StringBuilder builder(string.length());
+    for (char ch : string)
+        builder.append(tolower(ch));
+    return builder.to_string();
+}
+
+template<typename Callback>
+static void for_each_trigram(const StringView& lowercase_name, Callback callback)
+{
+    for (size_t i = 0; i + 3 <= lowercase_name.length(); ++i)
+        callback((u8)lowercase_name[i] << 16 | (u8)lowercase_name[i + 1] << 8 | (u8)lowercase_name[i + 2]);
+}
+
+String SymbolIndex::Symbol::qualified_name() const
+{
+    return join_scope(scope, name);
+}
+
+Vector<SymbolIndex::Symbol> SymbolIndex::parse(const String& file, const StringView& source)
+{
+    return Parser(file, significant_tokens(source)).parse();
+}
+
+SymbolIndex::SymbolIndex(const String& index_path)
+    : m_index_path(index_path)
+{
+    m_save_timer = Core::Timer::create_single_shot(save_delay_ms, [this] {
+        if (!save())
+            fprintf(stderr, "SymbolIndex: Failed to save %s\n", m_index_path.characters());
+    });
+    m_save_timer->stop();
+
+    if (!load())
+        dbg() << "SymbolIndex: No usable index at " << m_index_path << ", starting from scratch";
+}
+
+SymbolIndex::~SymbolIndex()
+{
+    if (m_save_timer->is_active())
+        save();
+    for (auto& it : m_files) {
+        if (it.value->watch_fd >= 0)
+            close(it.value->watch_fd);
+    }
+}
+
+SymbolIndex::File& SymbolIndex::ensure_file(const String& path)
+{
+    auto it = m_files.find(path);
+    if (it != m_files.end())
+        return *it->value;
+    auto file = make<File>();
+    auto& file_ref = *file;
+    m_files.set(path, move(file));
+    return file_ref;
+}
+
+void SymbolIndex::set_files(const Vector<String>& paths)
+{
+    HashTable<String> wanted;
+    for (auto& path : paths) {
+        if (path.ends_with(".cpp") || path.ends_with(".h"))
+            wanted.set(path);
+    }
+
+    Vector<String> unwanted;
+    for (auto& it : m_files) {
+        if (!wanted.contains(it.key))
+            unwanted.append(it.key);
+    }
+    for (auto& path : unwanted)
+        remove_file(path);
+
+    for (auto& path : wanted)
+        add_file(path);
+}
+
+void SymbolIndex::add_file(const String& path)
+{
+    if (!path.ends_with(".cpp") && !path.ends_with(".h"))
+        return;
+
+    auto& file = ensure_file(path);
+    if (file.watch_fd < 0)
+        watch(path, file);
+
+    struct stat st;
+    if (stat(path.characters(), &st) < 0)
+        return;
+    if (st.st_mtime != file.modification_time)
+        parse_in_background(path);
+}
+
+void SymbolIndex::remove_file(const String& path)
+{
+    auto it = m_files.find(path);
+    if (it == m_files.end())
+        return;
+    auto& file = *it->value;
+    for (auto& symbol : file.symbols)
+        remove_name(symbol);
+    if (file.watch_fd >= 0)
+        close(file.watch_fd);
+    if (file.is_being_parsed)
+        --m_pending_parse_count;
+    m_files.remove(it);
+    schedule_save();
+    if (on_update)
+        on_update();
+}
+
+void SymbolIndex::watch(const String& path, File& file)
+{
+    file.watch_fd = watch_file(path.characters(), path.length());
+    if (file.watch_fd < 0) {
+        perror("watch_file");
+        return;
+    }
+    fcntl(file.watch_fd, F_SETFD, FD_CLOEXEC);
+    file.notifier = Core::Notifier::construct(file.watch_fd, Core::Notifier::Event::Read);
+    file.notifier->on_ready_to_read = [this, path, watch_fd = file.watch_fd] {
+        // Take all pending events in one go; a burst of saves only needs one reparse.
+        char buffer[4096];
+        read(watch_fd, buffer, sizeof(buffer));
+        parse_in_background(path);
+    };
+}
+
+void SymbolIndex::parse_in_background(const String& path)
+{
+    auto& file = ensure_file(path);
+    if (file.is_being_parsed) {
+        file.needs_parse_again = true;
+        return;
+    }
+    file.is_being_parsed = true;
+    ++m_pending_parse_count;
+
+    auto future = LibThread::ThreadPool::the().submit<ParseResult>([path] {
+        ParseResult result;
+        struct stat st;
+        if (stat(path.characters(), &st) < 0)
+            return result;
+        result.modification_time = st.st_mtime;
+        MappedFile mapped_file(path);
+        if (!mapped_file.is_valid())
+            return result;
+        result.symbols = parse(path, { (const char*)mapped_file.data(), mapped_file.size() });
+        return result;
+    });
+    auto weak_this = make_weak_ptr();
+    future->on_complete([this, weak_this, path](auto& result) {
+        // The project may have been closed in the meantime.
+        if (weak_this.is_null())
+            return;
+        did_parse(path, result.modification_time, move(result.symbols));
+    });
+}
+
+void SymbolIndex::did_parse(const String& path, time_t modification_time, Vector<Symbol>&& symbols)
+{
+    auto it = m_files.find(path);
+    if (it == m_files.end())
+        return;
+    auto& file = *it->value;
+    // The file was removed and added again while it was being parsed.
+    if (!file.is_being_parsed)
+        return;
+    file.is_being_parsed = false;
+    --m_pending_parse_count;
+
+#ifdef SYMBOL_INDEX_DEBUG
+    dbg() << "SymbolIndex: " << path << " has " << symbols.size() << " symbol(s)";
+#endif
+    file.modification_time = modification_time;
+    set_symbols(file, move(symbols));
+
+    if (file.needs_parse_again) {
+        file.needs_parse_again = false;
+        parse_in_background(path);
+    }
+    schedule_save();
+    if (on_update)
+        on_update();
+}
+
+void SymbolIndex::set_symbols(File& file, Vector<Symbol>&& symbols)
+{
+    for (auto& symbol : file.symbols)
+        remove_name(symbol);
+    file.symbols = move(symbols);
+    for (auto& symbol : file.symbols)
+        add_name(symbol);
+}
+
+void SymbolIndex::add_name(const Symbol& symbol)
+{
+    auto it = m_name_ids.find(symbol.name);
+    if (it != m_name_ids.end()) {
+        m_names[it->value].symbols.append(&symbol);
+        return;
+    }
+
+    u32 id = m_names.size();
+    auto lowercase_name = to_lowercase(symbol.name);
+    for_each_trigram(lowercase_name, [&](u32 trigram) {
+        auto& ids = m_name_ids_by_trigram.ensure(trigram);
+        if (ids.is_empty() || ids.last() != id)
+            ids.append(id);
+    });
+    m_names.append({ move(lowercase_name), { &symbol } });
+    m_name_ids.set(symbol.name, id);
+}
+
+void SymbolIndex::remove_name(const Symbol& symbol)
+{
+    auto id = m_name_ids.get(symbol.name);
+    if (!id.has_value())
+        return;
+    m_names[id.value()].symbols.remove_first_matching([&](auto* it) { return it == &symbol; });
+}
+
+static Vector<const SymbolIndex::Symbol*> definitions_first(const Vector<const SymbolIndex::Symbol*>& symbols)
+{
+    Vector<const SymbolIndex::Symbol*> sorted;
+    for (auto* symbol : symbols) {
+        if (symbol->is_definition)
+            sorted.append(symbol);
+    }
+    for (auto* symbol : symbols) {
+        if (!symbol->is_definition)
+            sorted.append(symbol);
+    }
+    return sorted;
+}
+
+Vector<const SymbolIndex::Symbol*> SymbolIndex::find(const StringView& name) const
+{
+    auto id = m_name_ids.get(name);
+    if (!id.has_value())
+        return {};
+    return definitions_first(m_names[id.value()].symbols);
+}
+
+Vector<const SymbolIndex::Symbol*> SymbolIndex::fuzzy_find(const StringView& query, size_t max_results) const
+{
+    auto lowercase_query = to_lowercase(query);
+    if (lowercase_query.is_empty())
+        return {};
+
+    struct Match {
+        u32 name_id;
+        u32 hits;
+        u8 quality;
+    };
+    Vector<Match> matches;
+
+    auto quality_of = [&](const String& lowercase_name) -> u8 {
+        if (lowercase_name == lowercase_query)
+            return 3;
+        if (lowercase_name.starts_with(lowercase_query))
+            return 2;
+        if (lowercase_name.contains(lowercase_query))
+            return 1;
+        return 0;
+    };
+
+    if (lowercase_query.length() < 3) {
+        // Too short for trigrams, but then there aren't many names that are this close.
+        for (u32 id = 0; id < m_names.size(); ++id) {
+            auto& name = m_names[id];
+            if (name.symbols.is_empty())
+                continue;
+            auto quality = quality_of(name.lowercase_name);
+            if (quality)
+                matches.append({ id, 0, quality });
+        }
+    } else {
+        // Count how many of the query's trigrams each name has, and keep the ones that have most of them.
+        Vector<u32> query_trigrams;
+        for_each_trigram(lowercase_query, [&](u32 trigram) {
+            if (!query_trigrams.contains_slow(trigram))
+                query_trigrams.append(trigram);
+        });
+        Vector<u16> hits;
+        hits.resize(m_names.size());
+        for (auto& hit : hits)
+            hit = 0;
+        for (auto trigram : query_trigrams) {
+            auto it = m_name_ids_by_trigram.find(trigram);
+            if (it == m_name_ids_by_trigram.end())
+                continue;
+            for (auto id : it->value)
+                ++hits[id];
+        }
+        size_t required_hits = query_trigrams.size() - query_trigrams.size() / 4;
+        for (u32 id = 0; id < m_names.size(); ++id) {
+            if (hits[id] < required_hits || m_names[id].symbols.is_empty())
+                continue;
+            matches.append({ id, hits[id], quality_of(m_names[id].lowercase_name) });
+        }
+    }
+
+    quick_sort(matches, [&](auto& a, auto& b) {
+        if (a.quality != b.quality)
+            return a.quality > b.quality;
+        if (a.hits != b.hits)
+            return a.hits > b.hits;
+        auto& a_name = m_names[a.name_id].lowercase_name;
+        auto& b_name = m_names[b.name_id].lowercase_name;
+        if (a_name.length() != b_name.length())
+            return a_name.length() < b_name.length();
+        return a_name < b_name;
+    });
+
+    Vector<const Symbol*> results;
+    for (auto& match : matches) {
+        auto symbols = definitions_first(m_names[match.name_id].symbols);
+        // Declarations only show up for names that aren't defined anywhere in the project.
+        bool has_definition = symbols.first()->is_definition;
+        for (auto* symbol : symbols) {
+            if (results.size() >= max_results)
+                return results;
+            if (has_definition && !symbol->is_definition)
+                break;
+            results.append(symbol);
+        }
+    }
+    return results;
+}
+
+void SymbolIndex::schedule_save()
+{
+    m_save_timer->restart();
+}
+
+static const char* kind_names[] = { "namespace", "class", "struct", "union", "enum", "function" };
+
+bool SymbolIndex::load()
+{
+    auto file = Core::File::construct(m_index_path);
+    if (!file->open(Core::File::ReadOnly))
+        return false;
+    if (String::copy(file->read_line(1024), Chomp) != index_file_header)
+        return false;
+
+    HashMap<String, ParseResult> files;
+    ParseResult* current = nullptr;
+    String current_path;
+    for (;;) {
+        auto line = file->read_line(4096);
+        if (line.is_null())
+            break;
+        auto parts = String::copy(line, Chomp).split('\t', true);
+        if (parts.size() == 3 && parts[0] == "F") {
+            auto modification_time = parts[1].to_uint();
+            if (!modification_time.has_value())
+                return false;
+            current_path = parts[2];
+            files.set(current_path, { (time_t)modification_time.value(), {} });
+            current = &files.find(current_path)->value;
+            continue;
+        }
+        if (parts.size() != 7 || parts[0] != "S" || !current)
+            return false;
+
+        Optional<Kind> kind;
+        for (size_t i = 0; i < sizeof(kind_names) / sizeof(kind_names[0]); ++i) {
+            if (parts[1] == kind_names[i])
+                kind = (Kind)i;
+        }
+        auto line_number = parts[3].to_uint();
+        auto column = parts[4].to_uint();
+        if (!kind.has_value() || !line_number.has_value() || !column.has_value())
+            return false;
+        current->symbols.append({ parts[5], parts[6], kind.value(), parts[2] == "1", current_path, line_number.value(), column.value() });
+    }
+
+    for (auto& it : files) {
+        auto& file = ensure_file(it.key);
+        file.modification_time = it.value.modification_time;
+        set_symbols(file, move(it.value.symbols));
+    }
+    return true;
+}
+
+bool SymbolIndex::save() const
+{
+    auto file = Core::File::construct(m_index_path);
+    if (!file->open(Core::File::WriteOnly))
+        return false;
+
+    file->printf("%s\n", index_file_header);
+    for (auto& it : m_files) {
+        // A file that hasn't been parsed yet gets parsed again next time.
+        file->printf("F\t%u\t%s\n", (unsigned)it.value->modification_time, it.key.characters());
+        for (auto& symbol : it.value->symbols) {
+            file->printf("S\t%s\t%d\t%zu\t%zu\t%s\t%s\n",
+                kind_names[(u8)symbol.kind],
+                symbol.is_definition,
+                symbol.line,
+                symbol.column,
+                symbol.name.characters(),
+                symbol.scope.characters());
+        }
+    }
+    return file->close();
+}
@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) 2020, The SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/Function.h>
+#include <AK/HashMap.h>
+#include <AK/NonnullOwnPtr.h>
+#include <AK/String.h>
+#include <AK/Vector.h>
+#include <AK/Weakable.h>
+#include <LibCore/Forward.h>
+#include <sys/types.h>
+
+// Keeps track of where the classes, namespaces and functions in a project are declared
+// and defined. Files are parsed on the thread pool, watched for changes, and the index
+// is saved next to the project so it doesn't have to be rebuilt from scratch next time.
+// All of the API is meant to be used from the main thread.
+class SymbolIndex : public Weakable<SymbolIndex> {
+    AK_MAKE_NONCOPYABLE(SymbolIndex);
+    AK_MAKE_NONMOVABLE(SymbolIndex);
+
+public:
+    enum class Kind : u8 {
+        Namespace,
+        Class,
+        Struct,
+        Union,
+        Enum,
+        Function,
+    };
+
+    struct Symbol {
+        String name;
+        // The enclosing namespaces and classes, e.g. "GUI::TextEditor".
+        String scope;
+        Kind kind { Kind::Function };
+        bool is_definition { false };
+        String file;
+        size_t line { 0 };
+        size_t column { 0 };
+
+        String qualified_name() const;
+    };
+
+    explicit SymbolIndex(const String& index_path);
+    ~SymbolIndex();
+
+    // Indexes these files (and forgets any others), parsing the ones that have changed since the index was saved.
+    void set_files(const Vector<String>&);
+    void add_file(const String&);
+    void remove_file(const String&);
+
+    // Definitions come before declarations.
+    Vector<const Symbol*> find(const StringView& name) const;
+
+    // Symbols whose names look like the query, best matches first.
+    Vector<const Symbol*> fuzzy_find(const StringView& query, size_t max_results) const;
+
+    bool is_indexing() const { return m_pending_parse_count; }
+
+    // Called whenever the symbols of a file have changed.
+    Function<void()> on_update;
+
+    static Vector<Symbol> parse(const String& file, const StringView& source);
+
+private:
+    struct File {
+        time_t modification_time { 0 };
+        Vector<Symbol> symbols;
+        int watch_fd { -1 };
+        RefPtr<Core::Notifier> notifier;
+        bool is_being_parsed { false };
+        bool needs_parse_again { false };
+    };
+
+    struct Name {
+        String lowercase_name;
+        Vector<const Symbol*> symbols;
+    };
+
+    File& ensure_file(const String&);
+    void watch(const String&, File&);
+    void parse_in_background(const String&);
+    void did_parse(const String&, time_t modification_time, Vector<Symbol>&&);
+    void set_symbols(File&, Vector<Symbol>&&);
+    void add_name(const Symbol&);
+    void remove_name(const Symbol&);
+    void schedule_save();
+
+    bool load();
+    bool save() const;
+
+    String m_index_path;
+    HashMap<String, NonnullOwnPtr<File>> m_files;
+
+    // Names get an id the first time they're seen, and keep it even when the last symbol
+    // with that name goes away, so the trigram lists only ever grow at the end.
+    Vector<Name> m_names;
+    HashMap<String, u32> m_name_ids;
+    HashMap<u32, Vector<u32>> m_name_ids_by_trigram;
+
+    size_t m_pending_parse_count { 0 };
+    RefPtr<Core::Timer> m_save_timer;
+};
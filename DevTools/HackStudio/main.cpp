@@ -772,6 +772,12 @@ void open_file(const String& filename)
     current_editor().set_focus(true);
 }
 
+void open_file_at(const String& filename, const GUI::TextPosition& position)
+{
+    open_file(filename);
+    current_editor().set_cursor(position);
+}
+
 bool make_is_available()
 {
     pid_t pid;
@@ -42,6 +42,7 @@ struct Parameter {
 struct Message {
     String name;
     bool is_synchronous { false };
+    bool is_mergeable { false };
     Vector<Parameter> inputs;
     Vector<Parameter> outputs;
 
@@ -145,6 +146,11 @@ int main(int argc, char** argv)
                 }
             }
             parameter.type = extract_while([](char ch) { return !isspace(ch); });
+            if (parameter.attributes.contains_slow("View")) {
+                // Decoded without a copy, pointing into the buffer the message was received in.
+                ASSERT(parameter.type == "String");
+                parameter.type = "StringView";
+            }
             consume_whitespace();
             parameter.name = extract_while([](char ch) { return !isspace(ch) && ch != ',' && ch != ')'; });
             consume_whitespace();
@@ -175,6 +181,23 @@ int main(int argc, char** argv)
     auto parse_message = [&] {
         Message message;
         consume_whitespace();
+        if (peek() == '[') {
+            consume_one();
+            for (;;) {
+                consume_whitespace();
+                auto attribute = extract_while([](char ch) { return ch != ']' && ch != ',' && !isspace(ch); });
+                if (attribute == "Mergeable") {
+                    message.is_mergeable = true;
+                } else {
+                    warn() << "Unknown message attribute '" << attribute << "'";
+                    ASSERT_NOT_REACHED();
+                }
+                consume_whitespace();
+                if (consume_one() == ']')
+                    break;
+            }
+            consume_whitespace();
+        }
         Vector<char> buffer;
         while (!isspace(peek()) && peek() != '(')
             buffer.append(consume_one());
@@ -196,6 +219,14 @@ int main(int argc, char** argv)
 
         consume_whitespace();
 
+        // Merging a request would leave its sender waiting for a response that never comes.
+        ASSERT(!message.is_mergeable || !message.is_synchronous);
+        // A merged message is kept around after posting, by which time what its views point to may be gone.
+        if (message.is_mergeable) {
+            for (auto& parameter : message.inputs)
+                ASSERT(!parameter.attributes.contains_slow("View"));
+        }
+
         if (message.is_synchronous) {
             consume_specific('(');
             parse_parameters(message.outputs);
@@ -306,7 +337,7 @@ int main(int argc, char** argv)
             return builder.to_string();
         };
 
-        auto do_message = [&](const String& name, const Vector<Parameter>& parameters, const String& response_type = {}) {
+        auto do_message = [&](const String& name, const Vector<Parameter>& parameters, const String& response_type = {}, bool is_mergeable = false) {
             out() << "class " << name << " final : public IPC::Message {";
             out() << "public:";
             if (!response_type.is_null())
@@ -352,10 +383,35 @@ int main(int argc, char** argv)
             out() << "        stream << endpoint_magic();";
             out() << "        stream << (int)MessageID::" << name << ";";
             for (auto& parameter : parameters) {
-                out() << "        stream << m_" << parameter.name << ";";
+                if (parameter.type == "StringView")
+                    out() << "        stream.encode_string(m_" << parameter.name << ");";
+                else
+                    out() << "        stream << m_" << parameter.name << ";";
             }
             out() << "        return buffer;";
             out() << "    }";
+            if (is_mergeable) {
+                // Vectors are appended to, and everything else has to be equal.
+                out() << "    virtual bool is_mergeable() const override { return true; }";
+                out() << "    virtual OwnPtr<IPC::Message> clone() const override { return make<" << name << ">(*this); }";
+                out() << "    virtual bool merge(const IPC::Message& other) override";
+                out() << "    {";
+                out() << "        if (other.endpoint_magic() != endpoint_magic() || other.message_id() != message_id())";
+                out() << "            return false;";
+                out() << "        auto& message = static_cast<const " << name << "&>(other);";
+                for (auto& parameter : parameters) {
+                    if (parameter.type.starts_with("Vector<"))
+                        continue;
+                    out() << "        if (m_" << parameter.name << " != message.m_" << parameter.name << ")";
+                    out() << "            return false;";
+                }
+                for (auto& parameter : parameters) {
+                    if (parameter.type.starts_with("Vector<"))
+                        out() << "        m_" << parameter.name << ".append(message.m_" << parameter.name << ".data(), message.m_" << parameter.name << ".size());";
+                }
+                out() << "        return true;";
+                out() << "    }";
+            }
             for (auto& parameter : parameters) {
                 out() << "    const " << parameter.type << "& " << parameter.name << "() const { return m_" << parameter.name << "; }";
             }
@@ -372,7 +428,7 @@ int main(int argc, char** argv)
                 response_name = message.response_name();
                 do_message(response_name, message.outputs);
             }
-            do_message(message.name, message.inputs, response_name);
+            do_message(message.name, message.inputs, response_name, message.is_mergeable);
         }
         out() << "} // namespace " << endpoint.name;
         out() << "} // namespace Messages";
@@ -69,6 +69,11 @@ int main(int argc, char** argv)
         return 1;
     }
 
+    if (unveil("/proc/all_binary", "r") < 0) {
+        perror("unveil");
+        return 1;
+    }
+
     if (unveil("/etc/passwd", "r") < 0) {
         perror("unveil");
         return 1;
@@ -33,6 +33,8 @@
 #include <AK/RefPtr.h>
 #include <LibCore/File.h>
 #include <LibELF/Loader.h>
+#include <LibThread/Lock.h>
+#include <LibThread/ThreadPool.h>
 #include <stdio.h>
 
 static void sort_profile_nodes(Vector<NonnullRefPtr<ProfileNode>>& nodes)
@@ -45,24 +47,173 @@ static void sort_profile_nodes(Vector<NonnullRefPtr<ProfileNode>>& nodes)
         child->sort_children();
 }
 
-Profile::Profile(String executable_path, Vector<Event> events)
-    : m_executable_path(move(executable_path))
-    , m_events(move(events))
+// Symbolicates addresses in one ELF image, and remembers every address it has looked up.
+// The loading threads share it, each with a cache of its own in front of it.
+class LibrarySymbolicator {
+public:
+    explicit LibrarySymbolicator(const String& path)
+        : m_file(path)
+    {
+        if (m_file.is_valid())
+            m_elf_loader = ELF::Loader::create(static_cast<const u8*>(m_file.data()), m_file.size());
+    }
+
+    bool is_valid() const { return m_elf_loader; }
+
+    Profile::Frame symbolicate(u32 address)
+    {
+        LOCKER(m_lock);
+        auto it = m_cache.find(address);
+        if (it != m_cache.end())
+            return it->value;
+
+        Profile::Frame frame { "??", address, 0 };
+        if (m_elf_loader)
+            frame.symbol = m_elf_loader->symbolicate(address, &frame.offset);
+        m_cache.set(address, frame);
+        return frame;
+    }
+
+private:
+    MappedFile m_file;
+    RefPtr<ELF::Loader> m_elf_loader;
+    LibThread::Lock m_lock;
+    HashMap<u32, Profile::Frame> m_cache;
+};
+
+// Turns the perfcore events into Profile::Events in batches on the thread pool, and hands
+// the batches to the profile in order as they finish.
+class ProfileLoader : public RefCounted<ProfileLoader> {
+public:
+    ProfileLoader(Profile& profile, JsonValue&& json, const String& executable_path)
+        : m_profile(&profile)
+        , m_json(move(json))
+        , m_executable(executable_path)
+        , m_kernel("/boot/Kernel")
+    {
+    }
+
+    bool has_executable() const { return m_executable.is_valid(); }
+    void detach() { m_profile = nullptr; }
+
+    const JsonArray& perf_events() const { return m_json.as_object().get_ptr("events")->as_array(); }
+
+    void start()
+    {
+        // A few dozen batches keep all the threads busy without updating the tree too often.
+        size_t event_count = perf_events().size();
+        size_t batch_size = max((size_t)512, (event_count + 63) / 64);
+        size_t batch_count = (event_count + batch_size - 1) / batch_size;
+        m_batches.resize(batch_count);
+
+        for (size_t i = 0; i < batch_count; ++i) {
+            size_t begin = i * batch_size;
+            size_t end = min(begin + batch_size, event_count);
+            NonnullRefPtr<ProfileLoader> protector(*this);
+            auto future = LibThread::ThreadPool::the().submit<Vector<Profile::Event>>([this, protector, begin, end] {
+                return process_events(begin, end);
+            });
+            future->on_complete([this, protector, i](auto& events) {
+                did_process_batch(i, move(events));
+            });
+        }
+    }
+
+private:
+    Vector<Profile::Event> process_events(size_t begin, size_t end);
+    void did_process_batch(size_t index, Vector<Profile::Event>&&);
+
+    Profile* m_profile { nullptr };
+    JsonValue m_json;
+    LibrarySymbolicator m_executable;
+    LibrarySymbolicator m_kernel;
+
+    Vector<Optional<Vector<Profile::Event>>> m_batches;
+    size_t m_next_batch_to_append { 0 };
+};
+
+Vector<Profile::Event> ProfileLoader::process_events(size_t begin, size_t end)
 {
-    m_first_timestamp = m_events.first().timestamp;
-    m_last_timestamp = m_events.last().timestamp;
+    auto& perf_events = this->perf_events();
+    Vector<Profile::Event> events;
+    events.ensure_capacity(end - begin);
 
-    m_model = ProfileModel::create(*this);
+    // Stacks share most of their frames, so most addresses are found here without taking the lock.
+    HashMap<u32, Profile::Frame> frame_cache;
 
-    for (auto& event : m_events) {
-        m_deepest_stack_depth = max((u32)event.frames.size(), m_deepest_stack_depth);
+    for (size_t i = begin; i < end; ++i) {
+        auto& perf_event = perf_events.at(i).as_object();
+
+        Profile::Event event;
+
+        event.timestamp = perf_event.get("timestamp").to_number<u64>();
+        event.type = perf_event.get("type").to_string();
+
+        if (event.type == "malloc") {
+            event.ptr = perf_event.get("ptr").to_number<FlatPtr>();
+            event.size = perf_event.get("size").to_number<size_t>();
+        } else if (event.type == "free") {
+            event.ptr = perf_event.get("ptr").to_number<FlatPtr>();
+        } else if (perf_event.has("event")) {
+            event.sample_event = perf_event.get("event").to_string();
+        }
+
+        auto* stack_value = perf_event.get_ptr("stack");
+        if (!stack_value || !stack_value->is_array())
+            continue;
+        auto& stack_array = stack_value->as_array();
+        event.frames.ensure_capacity(stack_array.size());
+        for (ssize_t j = stack_array.size() - 1; j >= 0; --j) {
+            auto ptr = stack_array.at(j).to_number<u32>();
+            auto it = frame_cache.find(ptr);
+            if (it != frame_cache.end()) {
+                event.frames.append(it->value);
+                continue;
+            }
+            auto frame = ptr >= 0xc0000000 ? m_kernel.symbolicate(ptr) : m_executable.symbolicate(ptr);
+            frame_cache.set(ptr, frame);
+            event.frames.append(move(frame));
+        }
+
+        if (event.frames.size() < 2)
+            continue;
+
+        FlatPtr innermost_frame_address = event.frames.at(1).address;
+        event.in_kernel = innermost_frame_address >= 0xc0000000;
+
+        events.append(move(event));
     }
+    return events;
+}
 
-    rebuild_tree();
+void ProfileLoader::did_process_batch(size_t index, Vector<Profile::Event>&& events)
+{
+    if (!m_profile)
+        return;
+
+    // The tree counts malloc events by whether they're freed later on, so batches go in in order.
+    m_batches[index] = move(events);
+    while (m_next_batch_to_append < m_batches.size() && m_batches[m_next_batch_to_append].has_value()) {
+        auto batch = m_batches[m_next_batch_to_append].release_value();
+        ++m_next_batch_to_append;
+        m_profile->append_events(move(batch));
+    }
+    if (m_next_batch_to_append == m_batches.size())
+        m_profile->did_finish_loading();
+}
+
+Profile::Profile(String executable_path, u64 first_timestamp, u64 last_timestamp)
+    : m_executable_path(move(executable_path))
+    , m_first_timestamp(first_timestamp)
+    , m_last_timestamp(last_timestamp)
+{
+    m_model = ProfileModel::create(*this);
 }
 
 Profile::~Profile()
 {
+    if (m_loader)
+        m_loader->detach();
 }
 
 GUI::Model& Profile::model()
@@ -70,31 +221,79 @@ GUI::Model& Profile::model()
     return *m_model;
 }
 
-void Profile::rebuild_tree()
+bool Profile::is_in_timestamp_filter_range(const Event& event) const
+{
+    if (!has_timestamp_filter_range())
+        return true;
+    return event.timestamp >= m_timestamp_filter_range_start && event.timestamp <= m_timestamp_filter_range_end;
+}
+
+ProfileNode& Profile::find_or_create_root(const String& symbol, u32 address, u32 offset, u64 timestamp)
+{
+    for (size_t i = 0; i < m_roots.size(); ++i) {
+        auto& root = m_roots[i];
+        if (root->symbol() == symbol) {
+            return root;
+        }
+    }
+    auto new_root = ProfileNode::create(symbol, address, offset, timestamp);
+    m_roots.append(new_root);
+    return new_root;
+}
+
+void Profile::add_event_to_tree(const Event& event)
 {
-    u32 filtered_event_count = 0;
-    Vector<NonnullRefPtr<ProfileNode>> roots;
-
-    auto find_or_create_root = [&roots](const String& symbol, u32 address, u32 offset, u64 timestamp) -> ProfileNode& {
-        for (size_t i = 0; i < roots.size(); ++i) {
-            auto& root = roots[i];
-            if (root->symbol() == symbol) {
-                return root;
+    ProfileNode* node = nullptr;
+
+    auto for_each_frame = [&]<typename Callback>(Callback callback)
+    {
+        if (!m_inverted) {
+            for (size_t i = 0; i < event.frames.size(); ++i) {
+                if (callback(event.frames.at(i), i == event.frames.size() - 1) == IterationDecision::Break)
+                    break;
+            }
+        } else {
+            for (ssize_t i = event.frames.size() - 1; i >= 0; --i) {
+                if (callback(event.frames.at(i), static_cast<size_t>(i) == event.frames.size() - 1) == IterationDecision::Break)
+                    break;
             }
         }
-        auto new_root = ProfileNode::create(symbol, address, offset, timestamp);
-        roots.append(new_root);
-        return new_root;
     };
 
+    for_each_frame([&](const Frame& frame, bool is_innermost_frame) {
+        auto& symbol = frame.symbol;
+        auto& address = frame.address;
+        auto& offset = frame.offset;
+
+        if (symbol.is_empty())
+            return IterationDecision::Break;
+
+        if (!node)
+            node = &find_or_create_root(symbol, address, offset, event.timestamp);
+        else
+            node = &node->find_or_create_child(symbol, address, offset, event.timestamp);
+
+        node->increment_event_count();
+        if (is_innermost_frame) {
+            node->add_event_address(address);
+            node->increment_self_count();
+        }
+        return IterationDecision::Continue;
+    });
+
+    ++m_filtered_event_count;
+}
+
+void Profile::rebuild_tree()
+{
+    m_roots.clear();
+    m_filtered_event_count = 0;
+
     HashTable<FlatPtr> live_allocations;
 
     for (auto& event : m_events) {
-        if (has_timestamp_filter_range()) {
-            auto timestamp = event.timestamp;
-            if (timestamp < m_timestamp_filter_range_start || timestamp > m_timestamp_filter_range_end)
-                continue;
-        }
+        if (!is_in_timestamp_filter_range(event))
+            continue;
 
         if (event.type == "malloc")
             live_allocations.set(event.ptr);
@@ -103,11 +302,8 @@ void Profile::rebuild_tree()
     }
 
     for (auto& event : m_events) {
-        if (has_timestamp_filter_range()) {
-            auto timestamp = event.timestamp;
-            if (timestamp < m_timestamp_filter_range_start || timestamp > m_timestamp_filter_range_end)
-                continue;
-        }
+        if (!is_in_timestamp_filter_range(event))
+            continue;
 
         if (event.type == "malloc" && !live_allocations.contains(event.ptr))
             continue;
@@ -115,52 +311,44 @@ void Profile::rebuild_tree()
         if (event.type == "free")
             continue;
 
-        ProfileNode* node = nullptr;
-
-        auto for_each_frame = [&]<typename Callback>(Callback callback)
-        {
-            if (!m_inverted) {
-                for (size_t i = 0; i < event.frames.size(); ++i) {
-                    if (callback(event.frames.at(i), i == event.frames.size() - 1) == IterationDecision::Break)
-                        break;
-                }
-            } else {
-                for (ssize_t i = event.frames.size() - 1; i >= 0; --i) {
-                    if (callback(event.frames.at(i), static_cast<size_t>(i) == event.frames.size() - 1) == IterationDecision::Break)
-                        break;
-                }
-            }
-        };
-
-        for_each_frame([&](const Frame& frame, bool is_innermost_frame) {
-            auto& symbol = frame.symbol;
-            auto& address = frame.address;
-            auto& offset = frame.offset;
+        add_event_to_tree(event);
+    }
 
-            if (symbol.is_empty())
-                return IterationDecision::Break;
+    sort_profile_nodes(m_roots);
+    m_model->update();
+}
 
-            if (!node)
-                node = &find_or_create_root(symbol, address, offset, event.timestamp);
-            else
-                node = &node->find_or_create_child(symbol, address, offset, event.timestamp);
+void Profile::append_events(Vector<Event>&& events)
+{
+    m_events.ensure_capacity(m_events.size() + events.size());
+    for (auto& event : events) {
+        m_deepest_stack_depth = max((u32)event.frames.size(), m_deepest_stack_depth);
+        if (m_sample_event.is_null() && !event.sample_event.is_null())
+            m_sample_event = event.sample_event;
 
-            node->increment_event_count();
-            if (is_innermost_frame) {
-                node->add_event_address(address);
-                node->increment_self_count();
-            }
-            return IterationDecision::Continue;
-        });
+        // Whether a malloc is freed later on isn't known yet, so they're all counted for now.
+        // The tree is rebuilt once everything has been loaded if that turns out to be wrong.
+        if (event.type == "free")
+            m_has_free_events = true;
+        else if (is_in_timestamp_filter_range(event))
+            add_event_to_tree(event);
 
-        ++filtered_event_count;
+        m_events.append(move(event));
     }
 
-    sort_profile_nodes(roots);
-
-    m_filtered_event_count = filtered_event_count;
-    m_roots = move(roots);
+    sort_profile_nodes(m_roots);
     m_model->update();
+    if (on_events_loaded)
+        on_events_loaded();
+}
+
+void Profile::did_finish_loading()
+{
+    m_loader = nullptr;
+    if (m_has_free_events)
+        rebuild_tree();
+    if (on_events_loaded)
+        on_events_loaded();
 }
 
 OwnPtr<Profile> Profile::load_from_perfcore_file(const StringView& path)
@@ -181,74 +369,27 @@ OwnPtr<Profile> Profile::load_from_perfcore_file(const StringView& path)
     auto& object = json.value().as_object();
     auto executable_path = object.get("executable").to_string();
 
-    MappedFile elf_file(executable_path);
-    if (!elf_file.is_valid()) {
-        fprintf(stderr, "Unable to open executable '%s' for symbolication.\n", executable_path.characters());
-        return nullptr;
-    }
-
-    auto elf_loader = ELF::Loader::create(static_cast<const u8*>(elf_file.data()), elf_file.size());
-
-    MappedFile kernel_elf_file("/boot/Kernel");
-    RefPtr<ELF::Loader> kernel_elf_loader;
-    if (kernel_elf_file.is_valid())
-        kernel_elf_loader = ELF::Loader::create(static_cast<const u8*>(kernel_elf_file.data()), kernel_elf_file.size());
-
-    auto events_value = object.get("events");
-    if (!events_value.is_array())
+    auto* events_value = object.get_ptr("events");
+    if (!events_value || !events_value->is_array())
         return nullptr;
 
-    auto& perf_events = events_value.as_array();
+    auto& perf_events = events_value->as_array();
     if (perf_events.is_empty())
         return nullptr;
 
-    Vector<Event> events;
-
-    for (auto& perf_event_value : perf_events.values()) {
-        auto& perf_event = perf_event_value.as_object();
-
-        Event event;
+    auto first_timestamp = perf_events.at(0).as_object().get("timestamp").to_number<u64>();
+    auto last_timestamp = perf_events.at(perf_events.size() - 1).as_object().get("timestamp").to_number<u64>();
 
-        event.timestamp = perf_event.get("timestamp").to_number<u64>();
-        event.type = perf_event.get("type").to_string();
-
-        if (event.type == "malloc") {
-            event.ptr = perf_event.get("ptr").to_number<FlatPtr>();
-            event.size = perf_event.get("size").to_number<size_t>();
-        } else if (event.type == "free") {
-            event.ptr = perf_event.get("ptr").to_number<FlatPtr>();
-        }
-
-        auto stack_array = perf_event.get("stack").as_array();
-        for (ssize_t i = stack_array.values().size() - 1; i >= 0; --i) {
-            auto& frame = stack_array.at(i);
-            auto ptr = frame.to_number<u32>();
-            u32 offset = 0;
-            String symbol;
-
-            if (ptr >= 0xc0000000) {
-                if (kernel_elf_loader) {
-                    symbol = kernel_elf_loader->symbolicate(ptr, &offset);
-                } else {
-                    symbol = "??";
-                }
-            } else {
-                symbol = elf_loader->symbolicate(ptr, &offset);
-            }
-
-            event.frames.append({ symbol, ptr, offset });
-        }
-
-        if (event.frames.size() < 2)
-            continue;
-
-        FlatPtr innermost_frame_address = event.frames.at(1).address;
-        event.in_kernel = innermost_frame_address >= 0xc0000000;
-
-        events.append(move(event));
+    auto profile = NonnullOwnPtr<Profile>(NonnullOwnPtr<Profile>::Adopt, *new Profile(executable_path, first_timestamp, last_timestamp));
+    auto loader = adopt(*new ProfileLoader(*profile, json.release_value(), executable_path));
+    if (!loader->has_executable()) {
+        fprintf(stderr, "Unable to open executable '%s' for symbolication.\n", executable_path.characters());
+        return nullptr;
     }
 
-    return NonnullOwnPtr<Profile>(NonnullOwnPtr<Profile>::Adopt, *new Profile(executable_path, move(events)));
+    profile->m_loader = loader;
+    loader->start();
+    return profile;
 }
 
 void ProfileNode::sort_children()
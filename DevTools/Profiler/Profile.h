@@ -26,6 +26,7 @@
 
 #pragma once
 
+#include <AK/Function.h>
 #include <AK/JsonArray.h>
 #include <AK/JsonObject.h>
 #include <AK/JsonValue.h>
@@ -36,6 +37,7 @@
 
 class ProfileModel;
 class DisassemblyModel;
+class ProfileLoader;
 
 class ProfileNode : public RefCounted<ProfileNode> {
 public:
@@ -117,9 +119,16 @@ private:
 
 class Profile {
 public:
+    // Returns as soon as the file has been parsed. The events are symbolicated on the
+    // thread pool and added to the profile (and its call tree) as they come in.
     static OwnPtr<Profile> load_from_perfcore_file(const StringView& path);
     ~Profile();
 
+    bool is_loading() const { return !m_loader.is_null(); }
+
+    // Called on the main thread whenever another batch of events has been added.
+    Function<void()> on_events_loaded;
+
     GUI::Model& model();
     GUI::Model* disassembly_model();
 
@@ -136,6 +145,8 @@ public:
     struct Event {
         u64 timestamp { 0 };
         String type;
+        // The hardware event a sample was taken on, empty for timer samples.
+        String sample_event;
         FlatPtr ptr { 0 };
         size_t size { 0 };
         bool in_kernel { false };
@@ -162,13 +173,23 @@ public:
     void set_show_percentages(bool);
 
     const String& executable_path() const { return m_executable_path; }
+    const String& sample_event() const { return m_sample_event; }
 
 private:
-    Profile(String executable_path, Vector<Event>);
+    friend class ProfileLoader;
+
+    Profile(String executable_path, u64 first_timestamp, u64 last_timestamp);
+
+    void append_events(Vector<Event>&&);
+    void did_finish_loading();
 
+    bool is_in_timestamp_filter_range(const Event&) const;
+    ProfileNode& find_or_create_root(const String& symbol, u32 address, u32 offset, u64 timestamp);
+    void add_event_to_tree(const Event&);
     void rebuild_tree();
 
     String m_executable_path;
+    String m_sample_event;
 
     RefPtr<ProfileModel> m_model;
     RefPtr<DisassemblyModel> m_disassembly_model;
@@ -181,6 +202,8 @@ private:
     u64 m_last_timestamp { 0 };
 
     Vector<Event> m_events;
+    RefPtr<ProfileLoader> m_loader;
+    bool m_has_free_events { false };
 
     bool m_has_timestamp_filter_range { false };
     u64 m_timestamp_filter_range_start { 0 };
@@ -26,6 +26,7 @@
 
 #include "Profile.h"
 #include "ProfileTimelineWidget.h"
+#include <AK/StringBuilder.h>
 #include <LibCore/ArgsParser.h>
 #include <LibCore/ElapsedTimer.h>
 #include <LibCore/EventLoop.h>
@@ -79,7 +80,16 @@ int main(int argc, char** argv)
     }
 
     auto window = GUI::Window::construct();
-    window->set_title("Profiler");
+    auto update_window_title = [&] {
+        StringBuilder builder;
+        builder.append("Profiler");
+        if (!profile->sample_event().is_null())
+            builder.appendf(" (sampled on %s)", profile->sample_event().characters());
+        if (profile->is_loading())
+            builder.append(" - Loading...");
+        window->set_title(builder.to_string());
+    };
+    update_window_title();
     window->set_rect(100, 100, 800, 600);
     window->set_icon(app_icon.bitmap_for_size(16));
 
@@ -87,7 +97,7 @@ int main(int argc, char** argv)
     main_widget.set_fill_with_background_color(true);
     main_widget.set_layout<GUI::VerticalBoxLayout>();
 
-    main_widget.add<ProfileTimelineWidget>(*profile);
+    auto& timeline_widget = main_widget.add<ProfileTimelineWidget>(*profile);
 
     auto& bottom_splitter = main_widget.add<GUI::VerticalSplitter>();
 
@@ -95,6 +105,11 @@ int main(int argc, char** argv)
     tree_view.set_headers_visible(true);
     tree_view.set_model(profile->model());
 
+    profile->on_events_loaded = [&] {
+        update_window_title();
+        timeline_widget.update();
+    };
+
     auto& disassembly_view = bottom_splitter.add<GUI::TableView>();
 
     tree_view.on_selection = [&](auto& index) {
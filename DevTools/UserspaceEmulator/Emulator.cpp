@@ -180,20 +180,42 @@ int Emulator::exec()
     bool trace = false;
 
     while (!m_shutdown) {
-        m_cpu.save_base_eip();
+        auto& block = basic_block_at(m_cpu.eip());
 
-        auto insn = X86::Instruction::from_stream(m_cpu, true, true);
+        for (size_t i = 0; !m_shutdown; ++i) {
+            m_cpu.save_base_eip();
 
-        if (trace)
-            out() << (const void*)m_cpu.base_eip() << "  \033[33;1m" << insn.to_string(m_cpu.base_eip(), &symbol_provider) << "\033[0m";
+            if (i == block.instructions.size()) {
+                if (i == max_basic_block_length)
+                    break;
+                decode_next_instruction(block);
+            } else {
+                m_cpu.skip_decoded_instruction(block.instructions[i].length);
+            }
 
-        (m_cpu.*insn.handler())(insn);
+            auto& decoded = block.instructions[i];
+            u32 next_eip = m_cpu.eip();
 
-        if (trace)
-            m_cpu.dump();
+            if (trace)
+                out() << (const void*)m_cpu.base_eip() << "  \033[33;1m" << decoded.insn.to_string(m_cpu.base_eip(), &symbol_provider) << "\033[0m";
 
-        if (m_pending_signals)
-            dispatch_one_pending_signal();
+            (m_cpu.*decoded.handler)(decoded.insn);
+
+            if (trace)
+                m_cpu.dump();
+
+            if (m_pending_signals)
+                dispatch_one_pending_signal();
+
+            // The block may have just been overwritten, so it's only safe to drop it here.
+            if (m_mmu.decoded_code_is_stale()) {
+                discard_decoded_code();
+                break;
+            }
+
+            if (m_cpu.eip() != next_eip)
+                break;
+        }
     }
 
     if (auto* tracer = malloc_tracer())
@@ -202,6 +224,35 @@ int Emulator::exec()
     return m_exit_status;
 }
 
+Emulator::BasicBlock& Emulator::basic_block_at(u32 eip)
+{
+    auto it = m_basic_blocks.find(eip);
+    if (it != m_basic_blocks.end())
+        return *it->value;
+    auto block = make<BasicBlock>();
+    auto& block_ref = *block;
+    m_basic_blocks.set(eip, move(block));
+    return block_ref;
+}
+
+const Emulator::DecodedInstruction& Emulator::decode_next_instruction(BasicBlock& block)
+{
+    auto* region = m_mmu.find_region({ m_cpu.cs(), m_cpu.eip() });
+    ASSERT(region);
+    region->set_has_decoded_code(true);
+
+    auto insn = X86::Instruction::from_stream(m_cpu, true, true);
+    auto handler = insn.handler();
+    block.instructions.append({ move(insn), handler, m_cpu.eip() - m_cpu.base_eip() });
+    return block.instructions.last();
+}
+
+void Emulator::discard_decoded_code()
+{
+    m_basic_blocks.clear();
+    m_mmu.did_discard_decoded_code();
+}
+
 bool Emulator::is_in_malloc_or_free() const
 {
     return (m_cpu.base_eip() >= m_malloc_symbol_start && m_cpu.base_eip() < m_malloc_symbol_end) || (m_cpu.base_eip() >= m_free_symbol_start && m_cpu.base_eip() < m_free_symbol_end);
@@ -999,11 +1050,7 @@ int Emulator::virt$stat(FlatPtr params_addr)
 
     auto path = String::copy(mmu().copy_buffer_from_vm((FlatPtr)params.path.characters, params.path.length));
     struct stat host_statbuf;
-    int rc;
-    if (params.follow_symlinks)
-        rc = stat(path.characters(), &host_statbuf);
-    else
-        rc = lstat(path.characters(), &host_statbuf);
+    int rc = fstatat(params.dirfd, path.characters(), &host_statbuf, params.follow_symlinks ? 0 : AT_SYMLINK_NOFOLLOW);
     if (rc < 0)
         return -errno;
     mmu().copy_to_vm((FlatPtr)params.statbuf, &host_statbuf, sizeof(host_statbuf));
@@ -29,6 +29,7 @@
 #include "MallocTracer.h"
 #include "SoftCPU.h"
 #include "SoftMMU.h"
+#include <AK/HashMap.h>
 #include <AK/Types.h>
 #include <LibDebug/DebugInfo.h>
 #include <LibELF/Loader.h>
@@ -150,6 +151,27 @@ private:
 
     void dispatch_one_pending_signal();
 
+    // Instructions are decoded once and kept in blocks keyed by the EIP they start at. A block
+    // follows the fall-through path and is extended lazily, so only code that actually runs gets
+    // decoded. Blocks are thrown away when SoftMMU reports a write to memory they were decoded from.
+    struct DecodedInstruction {
+        X86::Instruction insn;
+        X86::InstructionHandler handler { nullptr };
+        u32 length { 0 };
+    };
+
+    struct BasicBlock {
+        Vector<DecodedInstruction> instructions;
+    };
+
+    static constexpr size_t max_basic_block_length = 64;
+
+    BasicBlock& basic_block_at(u32 eip);
+    const DecodedInstruction& decode_next_instruction(BasicBlock&);
+    void discard_decoded_code();
+
+    HashMap<u32, NonnullOwnPtr<BasicBlock>> m_basic_blocks;
+
     bool m_shutdown { false };
     int m_exit_status { 0 };
 
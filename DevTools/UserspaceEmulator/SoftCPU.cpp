@@ -1282,7 +1282,15 @@ void SoftCPU::CMPXCHG_RM8_reg8(const X86::Instruction& insn)
     }
 }
 
-void SoftCPU::CPUID(const X86::Instruction&) { TODO_INSN(); }
+void SoftCPU::CPUID(const X86::Instruction&)
+{
+    // We don't emulate any instruction set extensions, so don't advertise any.
+    // Leaf 0 says that leaf 1 is the highest one, and leaf 1 has no feature bits set.
+    set_eax(shadow_wrap_as_initialized<u32>(eax().value() == 0 ? 1 : 0));
+    set_ebx(shadow_wrap_as_initialized<u32>(0));
+    set_ecx(shadow_wrap_as_initialized<u32>(0));
+    set_edx(shadow_wrap_as_initialized<u32>(0));
+}
 
 void SoftCPU::CWD(const X86::Instruction&)
 {
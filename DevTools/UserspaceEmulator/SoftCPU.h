@@ -59,6 +59,14 @@ public:
     u32 base_eip() const { return m_base_eip; }
     void save_base_eip() { m_base_eip = m_eip; }
 
+    // Steps over an instruction that has already been decoded, as if it had been read from the stream.
+    void skip_decoded_instruction(u32 length)
+    {
+        m_eip += length;
+        if (m_cached_code_ptr)
+            m_cached_code_ptr += length;
+    }
+
     u32 eip() const { return m_eip; }
     void set_eip(u32 eip)
     {
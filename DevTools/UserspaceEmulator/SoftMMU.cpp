@@ -35,19 +35,95 @@ SoftMMU::Region* SoftMMU::find_region(X86::LogicalAddress address)
     if (address.selector() == 0x28)
         return m_tls_region.ptr();
 
+    u32 offset = address.offset();
+    u32 page = page_number(offset);
+    auto& tlb_entry = m_tlb[page % tlb_entry_count];
+    if (tlb_entry.region && tlb_entry.page == page && tlb_entry.region->contains(offset))
+        return tlb_entry.region;
+
+    auto* region = page_map_lookup(page);
+    if (!region)
+        return nullptr;
+    if (!region->contains(offset)) {
+        region = find_region_slow(offset);
+        if (!region)
+            return nullptr;
+    }
+
+    tlb_entry = { page, region };
+    return region;
+}
+
+SoftMMU::Region* SoftMMU::find_region_slow(u32 address)
+{
     for (auto& region : m_regions) {
-        if (region.contains(address.offset()))
+        if (region.contains(address))
             return &region;
     }
     return nullptr;
 }
 
+SoftMMU::Region*& SoftMMU::page_map_entry(u32 page)
+{
+    auto& page_table = m_page_directory[page / page_table_entry_count];
+    if (!page_table)
+        page_table = make<PageTable>();
+    return page_table->regions[page % page_table_entry_count];
+}
+
+SoftMMU::Region* SoftMMU::page_map_lookup(u32 page) const
+{
+    auto& page_table = m_page_directory[page / page_table_entry_count];
+    if (!page_table)
+        return nullptr;
+    return page_table->regions[page % page_table_entry_count];
+}
+
+void SoftMMU::map_region_pages(Region& region)
+{
+    if (!region.size())
+        return;
+    for (u32 page = page_number(region.base()); page <= page_number(region.end() - 1); ++page) {
+        auto& entry = page_map_entry(page);
+        if (!entry)
+            entry = &region;
+    }
+}
+
+void SoftMMU::unmap_region_pages(Region& region)
+{
+    if (!region.size())
+        return;
+    for (u32 page = page_number(region.base()); page <= page_number(region.end() - 1); ++page) {
+        auto& entry = page_map_entry(page);
+        if (entry != &region)
+            continue;
+        // Hand the page over to any other region that shares it.
+        entry = nullptr;
+        u32 page_base = page * page_size;
+        for (auto& other : m_regions) {
+            if (&other != &region && other.base() < page_base + page_size && other.end() > page_base) {
+                entry = &other;
+                break;
+            }
+        }
+    }
+}
+
+void SoftMMU::invalidate_tlb()
+{
+    for (auto& entry : m_tlb)
+        entry = {};
+}
+
 void SoftMMU::add_region(NonnullOwnPtr<Region> region)
 {
     ASSERT(!find_region({ 0x20, region->base() }));
     // FIXME: More sanity checks pls
     if (region->is_shared_buffer())
         m_shbuf_regions.set(static_cast<SharedBufferRegion*>(region.ptr())->shbuf_id(), region.ptr());
+    map_region_pages(*region);
+    invalidate_tlb();
     m_regions.append(move(region));
 }
 
@@ -55,6 +131,10 @@ void SoftMMU::remove_region(Region& region)
 {
     if (region.is_shared_buffer())
         m_shbuf_regions.remove(static_cast<SharedBufferRegion&>(region).shbuf_id());
+    if (region.has_decoded_code())
+        m_decoded_code_is_stale = true;
+    unmap_region_pages(region);
+    invalidate_tlb();
     m_regions.remove_first_matching([&](auto& entry) { return entry.ptr() == &region; });
 }
 
@@ -105,6 +185,8 @@ void SoftMMU::write8(X86::LogicalAddress address, ValueWithShadow<u8> value)
         TODO();
     }
 
+    if (region->has_decoded_code())
+        m_decoded_code_is_stale = true;
     region->write8(address.offset() - region->base(), value);
 }
 
@@ -116,6 +198,8 @@ void SoftMMU::write16(X86::LogicalAddress address, ValueWithShadow<u16> value)
         TODO();
     }
 
+    if (region->has_decoded_code())
+        m_decoded_code_is_stale = true;
     region->write16(address.offset() - region->base(), value);
 }
 
@@ -127,6 +211,8 @@ void SoftMMU::write32(X86::LogicalAddress address, ValueWithShadow<u32> value)
         TODO();
     }
 
+    if (region->has_decoded_code())
+        m_decoded_code_is_stale = true;
     region->write32(address.offset() - region->base(), value);
 }
 
@@ -151,6 +237,15 @@ ByteBuffer SoftMMU::copy_buffer_from_vm(const FlatPtr source, size_t size)
     return buffer;
 }
 
+void SoftMMU::did_discard_decoded_code()
+{
+    m_decoded_code_is_stale = false;
+    for_each_region([](auto& region) {
+        region.set_has_decoded_code(false);
+        return IterationDecision::Continue;
+    });
+}
+
 SharedBufferRegion* SoftMMU::shbuf_region(int shbuf_id)
 {
     return (SharedBufferRegion*)m_shbuf_regions.get(shbuf_id).value_or(nullptr);
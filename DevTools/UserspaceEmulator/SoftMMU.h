@@ -67,6 +67,10 @@ public:
         bool is_text() const { return m_text; }
         void set_text(bool b) { m_text = b; }
 
+        // Set while the emulator holds decoded instructions from this region.
+        bool has_decoded_code() const { return m_has_decoded_code; }
+        void set_has_decoded_code(bool b) { m_has_decoded_code = b; }
+
     protected:
         Region(u32 base, u32 size)
             : m_base(base)
@@ -80,6 +84,7 @@ public:
 
         bool m_stack { false };
         bool m_text { false };
+        bool m_has_decoded_code { false };
     };
 
     ValueWithShadow<u8> read8(X86::LogicalAddress);
@@ -103,6 +108,10 @@ public:
 
     SharedBufferRegion* shbuf_region(int shbuf_id);
 
+    // True once memory holding decoded instructions has been written to or unmapped.
+    bool decoded_code_is_stale() const { return m_decoded_code_is_stale; }
+    void did_discard_decoded_code();
+
     template<typename Callback>
     void for_each_region(Callback callback)
     {
@@ -117,9 +126,39 @@ public:
     }
 
 private:
+    // Regions are also indexed by page number through a two-level page map, like the x86 page tables.
+    // A page that's touched by more than one region points at just one of them; lookups that miss
+    // that region fall back to scanning m_regions, so an empty slot always means "unmapped".
+    static constexpr u32 page_size = 4096;
+    static constexpr u32 page_table_entry_count = 1024;
+    static constexpr size_t tlb_entry_count = 16;
+
+    struct PageTable {
+        Region* regions[page_table_entry_count] {};
+    };
+
+    struct TLBEntry {
+        u32 page { 0 };
+        Region* region { nullptr };
+    };
+
+    static u32 page_number(u32 address) { return address / page_size; }
+
+    Region* find_region_slow(u32 address);
+    Region*& page_map_entry(u32 page);
+    Region* page_map_lookup(u32 page) const;
+    void map_region_pages(Region&);
+    void unmap_region_pages(Region&);
+    void invalidate_tlb();
+
     OwnPtr<Region> m_tls_region;
     NonnullOwnPtrVector<Region> m_regions;
     HashMap<int, Region*> m_shbuf_regions;
+
+    OwnPtr<PageTable> m_page_directory[page_table_entry_count];
+    TLBEntry m_tlb[tlb_entry_count];
+
+    bool m_decoded_code_is_stale { false };
 };
 
 }
@@ -0,0 +1,56 @@
+/*
+ * Copyright (c) 2020, The SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/Types.h>
+
+// A read() from a watch_file() descriptor returns as many whole events as fit in the buffer, one after the
+// other. Each one is followed by its name_length bytes of child name, without a terminator, and padding up
+// to the next multiple of alignof(InodeWatcherEvent). If not even the first event fits, read() fails with EINVAL.
+struct InodeWatcherEvent {
+    enum class Type : u32 {
+        Invalid = 0,
+        Modified,
+        ChildAdded,
+        ChildRemoved,
+        // The reader fell behind and later events were dropped. Whatever is being watched should be looked at from scratch.
+        Overflow,
+    };
+
+    Type type { Type::Invalid };
+    // How many identical events in a row were folded into this one.
+    u32 count { 0 };
+    u32 name_length { 0 };
+
+    const char* name() const { return reinterpret_cast<const char*>(this + 1); }
+    const InodeWatcherEvent* next() const { return reinterpret_cast<const InodeWatcherEvent*>(reinterpret_cast<const u8*>(this) + size_with_name(name_length)); }
+
+    static constexpr size_t size_with_name(size_t name_length)
+    {
+        return (sizeof(InodeWatcherEvent) + name_length + alignof(InodeWatcherEvent) - 1) & ~(alignof(InodeWatcherEvent) - 1);
+    }
+};
@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/Types.h>
+
+// /proc/all_binary has the same information as /proc/all, as fixed-size records: a header, then
+// every process record, each followed by the records of its threads. Readers should step through
+// the records by the sizes in the header, which only grow, and ignore any fields past the ones they know.
+
+#define PROCESS_STATISTICS_MAGIC 0x70737461 // "psta"
+#define PROCESS_STATISTICS_VERSION 1
+
+#define ENUMERATE_PLEDGE_PROMISES         \
+    __ENUMERATE_PLEDGE_PROMISE(stdio)     \
+    __ENUMERATE_PLEDGE_PROMISE(rpath)     \
+    __ENUMERATE_PLEDGE_PROMISE(wpath)     \
+    __ENUMERATE_PLEDGE_PROMISE(cpath)     \
+    __ENUMERATE_PLEDGE_PROMISE(dpath)     \
+    __ENUMERATE_PLEDGE_PROMISE(inet)      \
+    __ENUMERATE_PLEDGE_PROMISE(id)        \
+    __ENUMERATE_PLEDGE_PROMISE(proc)      \
+    __ENUMERATE_PLEDGE_PROMISE(exec)      \
+    __ENUMERATE_PLEDGE_PROMISE(unix)      \
+    __ENUMERATE_PLEDGE_PROMISE(recvfd)    \
+    __ENUMERATE_PLEDGE_PROMISE(sendfd)    \
+    __ENUMERATE_PLEDGE_PROMISE(fattr)     \
+    __ENUMERATE_PLEDGE_PROMISE(tty)       \
+    __ENUMERATE_PLEDGE_PROMISE(chown)     \
+    __ENUMERATE_PLEDGE_PROMISE(chroot)    \
+    __ENUMERATE_PLEDGE_PROMISE(thread)    \
+    __ENUMERATE_PLEDGE_PROMISE(video)     \
+    __ENUMERATE_PLEDGE_PROMISE(accept)    \
+    __ENUMERATE_PLEDGE_PROMISE(settime)   \
+    __ENUMERATE_PLEDGE_PROMISE(sigaction) \
+    __ENUMERATE_PLEDGE_PROMISE(setkeymap) \
+    __ENUMERATE_PLEDGE_PROMISE(shared_buffer)
+
+struct ProcessStatisticsHeader {
+    u32 magic;
+    u32 version;
+    u32 header_size;
+    u32 process_record_size;
+    u32 thread_record_size;
+    u32 process_count;
+    u32 thread_count;
+};
+
+enum ProcessStatisticsVeil : u8 {
+    ProcessStatisticsVeilNone,
+    ProcessStatisticsVeilDropped,
+    ProcessStatisticsVeilLocked,
+};
+
+struct ProcessStatisticsRecord {
+    i32 pid;
+    u32 pgid;
+    u32 pgp;
+    u32 sid;
+    u32 uid;
+    u32 gid;
+    i32 ppid;
+    u32 nfds;
+    i32 icon_id;
+    // Bit n is set for the n-th promise in ENUMERATE_PLEDGE_PROMISES.
+    u32 pledge;
+    u32 amount_virtual;
+    u32 amount_resident;
+    u32 amount_shared;
+    u32 amount_dirty_private;
+    u32 amount_clean_inode;
+    u32 amount_purgeable_volatile;
+    u32 amount_purgeable_nonvolatile;
+    u32 thread_count;
+    u8 veil;
+    // Names are null-terminated, and cut short if they don't fit.
+    char name[63];
+    char tty[32];
+    u32 amount_private;
+};
+
+struct ThreadStatisticsRecord {
+    i32 tid;
+    u32 times_scheduled;
+    u32 ticks;
+    u32 cpu;
+    u32 times_migrated;
+    u32 priority;
+    u32 effective_priority;
+    u32 syscall_count;
+    u32 inode_faults;
+    u32 zero_faults;
+    u32 cow_faults;
+    u32 file_read_bytes;
+    u32 file_write_bytes;
+    u32 unix_socket_read_bytes;
+    u32 unix_socket_write_bytes;
+    u32 ipv4_socket_read_bytes;
+    u32 ipv4_socket_write_bytes;
+    char state[16];
+    char name[64];
+    // Time spent runnable but not running, blocked, and waiting in a WaitQueue, in TSC cycles.
+    u64 runnable_cycles;
+    u64 blocked_cycles;
+    u64 queued_cycles;
+    u32 involuntary_switches;
+};
@@ -37,11 +37,14 @@ constexpr int syscall_vector = 0x82;
 
 extern "C" {
 struct pollfd;
+struct event_set_event;
+struct io_ring_header;
 struct timeval;
 struct timespec;
 struct sockaddr;
 struct siginfo;
 struct stat;
+struct iovec;
 typedef u32 socklen_t;
 }
 
@@ -196,7 +199,21 @@ namespace Kernel {
     S(recvfd)                 \
     S(sysconf)                \
     S(set_process_name)       \
-    S(disown)
+    S(disown)                 \
+    S(readv)                  \
+    S(preadv)                 \
+    S(pwritev)                \
+    S(event_set_create)       \
+    S(event_set_ctl)          \
+    S(event_set_wait)         \
+    S(sendfile)               \
+    S(io_ring_create)         \
+    S(io_ring_enter)          \
+    S(anon_create)            \
+    S(shbuf_reclaim)          \
+    S(map_time_page)          \
+    S(fsync)                  \
+    S(fdatasync)
 
 namespace Syscall {
 
@@ -434,6 +451,7 @@ struct SC_waitid_params {
 };
 
 struct SC_stat_params {
+    int dirfd;
     StringArgument path;
     Userspace<struct stat*> statbuf;
     bool follow_symlinks;
@@ -446,6 +464,49 @@ struct SC_ptrace_params {
     int data;
 };
 
+struct SC_preadv_params {
+    int fd;
+    const struct iovec* iov;
+    int iov_count;
+    ssize_t offset;
+};
+
+struct SC_pwritev_params {
+    int fd;
+    const struct iovec* iov;
+    int iov_count;
+    ssize_t offset;
+};
+
+struct SC_sendfile_params {
+    int out_fd;
+    int in_fd;
+    ssize_t* offset;
+    size_t count;
+};
+
+struct SC_event_set_ctl_params {
+    int set_fd;
+    int op;
+    int fd;
+    unsigned events;
+    void* data;
+};
+
+struct SC_io_ring_create_params {
+    unsigned entries;
+    size_t buffers_size;
+    int flags;
+    struct io_ring_header** ring;
+};
+
+struct SC_event_set_wait_params {
+    int set_fd;
+    struct event_set_event* events;
+    int max_events;
+    const struct timespec* timeout;
+};
+
 struct SC_ptrace_peek_params {
     Userspace<const u32*> address;
     Userspace<u32*> out_data;
@@ -0,0 +1,53 @@
+/*
+ * Copyright (c) 2020, The SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/Types.h>
+
+// A page the kernel keeps up to date with the current time, and maps read-only into any
+// process that asks for it with map_time_page(), so the clocks can be read without a syscall.
+//
+// The kernel increments the sequence number before and after each update, so it's odd while
+// an update is in progress. Readers have to try again if it was odd, or if it changed while
+// they were reading.
+
+#define TIME_PAGE_TSC_IS_USABLE (1 << 0)
+
+struct TimePage {
+    volatile u32 sequence;
+    u32 flags;
+
+    // Both clocks as of the last update, and the time stamp counter at that moment.
+    u64 monotonic_nanoseconds;
+    u64 realtime_nanoseconds;
+    u64 tsc;
+
+    // If TIME_PAGE_TSC_IS_USABLE is set, the time stamp counter ticks at a constant rate on all
+    // processors, and ((rdtsc - tsc) * tsc_multiplier) >> tsc_shift nanoseconds have passed since.
+    u32 tsc_multiplier;
+    u32 tsc_shift;
+};
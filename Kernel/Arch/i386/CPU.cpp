@@ -40,11 +40,13 @@
 #include <Kernel/Interrupts/SpuriousInterruptHandler.h>
 #include <Kernel/Interrupts/UnhandledInterruptHandler.h>
 #include <Kernel/KSyms.h>
+#include <Kernel/PerformanceCounters.h>
 #include <Kernel/Process.h>
 #include <Kernel/SpinLock.h>
 #include <Kernel/Thread.h>
 #include <Kernel/VM/MemoryManager.h>
 #include <Kernel/VM/PageDirectory.h>
+#include <Kernel/WorkQueue.h>
 #include <LibC/mallocdefs.h>
 
 //#define PAGE_FAULT_DEBUG
@@ -672,6 +674,7 @@ void handle_interrupt(TrapFrame* trap)
     ASSERT(regs.isr_number >= IRQ_VECTOR_BASE && regs.isr_number <= (IRQ_VECTOR_BASE + GENERIC_INTERRUPT_HANDLERS_COUNT));
     u8 irq = (u8)(regs.isr_number - 0x50);
     ASSERT(s_interrupt_handler[irq]);
+    s_interrupt_handler[irq]->increment_invoking_counter();
     s_interrupt_handler[irq]->handle_interrupt(regs);
     s_interrupt_handler[irq]->eoi();
 }
@@ -721,6 +724,12 @@ u32 read_cr3()
 
 void write_cr3(u32 cr3)
 {
+    // Let TLB shootdowns know which address space this processor is using.
+    // This has to be globally visible before the first page walk in the new
+    // address space: either smp_flush_tlb() sees us here and sends the IPI, or
+    // the walk sees the updated page tables. Pairs with the fence there.
+    Processor::current().set_loaded_cr3(cr3);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
     asm volatile("movl %%eax, %%cr3" ::"a"(cr3)
                  : "memory");
 }
@@ -810,6 +819,14 @@ void Processor::cpu_detect()
         set_feature(CPUFeature::SYSCALL);
     }
 
+    CPUID max_extended_leaf(0x80000000);
+    if (max_extended_leaf.eax() >= 0x80000007) {
+        CPUID advanced_power_management(0x80000007);
+        // The time stamp counter is "invariant": it runs at a constant rate in all power states.
+        if (advanced_power_management.edx() & (1 << 8))
+            set_feature(CPUFeature::CONSTANT_TSC);
+    }
+
     CPUID extended_features(0x7);
     if (extended_features.ebx() & (1 << 20))
         set_feature(CPUFeature::SMAP);
@@ -916,6 +933,8 @@ String Processor::features_string() const
                     return "sep";
                 case CPUFeature::SYSCALL:
                     return "syscall";
+                case CPUFeature::CONSTANT_TSC:
+                    return "constant_tsc";
                 // no default statement here intentionally so that we get
                 // a warning if a new feature is forgotten to be added here
             }
@@ -948,13 +967,22 @@ void Processor::early_initialize(u32 cpu)
     m_scheduler_initialized = false;
 
     m_message_queue = nullptr;
+    m_deferred_work_head = nullptr;
+    m_deferred_work_tail = nullptr;
     m_idle_thread = nullptr;
     m_current_thread = nullptr;
     m_scheduler_data = nullptr;
     m_mm_data = nullptr;
+    m_timer_queue = nullptr;
     m_info = nullptr;
 
     m_halt_requested = false;
+
+    m_loaded_cr3 = 0;
+    m_tlb_flush_batch_depth = 0;
+    m_tlb_flush_batch_cr3 = 0;
+    m_tlb_flush_batch_page_count = 0;
+
     if (cpu == 0) {
         s_smp_enabled = false;
         atomic_store(&g_total_processors, 1u, AK::MemoryOrder::memory_order_release);
@@ -1097,6 +1125,8 @@ extern "C" void enter_thread_context(Thread* from_thread, Thread* to_thread)
     auto& to_tss = to_thread->tss();
     asm volatile("fxsave %0"
         : "=m"(from_thread->fpu_state()));
+    if (from_thread->performance_counter().is_enabled())
+        PerformanceCounters::save(from_thread->performance_counter());
 
     from_tss.fs = get_fs();
     from_tss.gs = get_gs();
@@ -1114,6 +1144,8 @@ extern "C" void enter_thread_context(Thread* from_thread, Thread* to_thread)
 
     asm volatile("fxrstor %0"
         ::"m"(to_thread->fpu_state()));
+    if (to_thread->performance_counter().is_enabled())
+        PerformanceCounters::load(to_thread->performance_counter());
 
     // TODO: debug registers
     // TODO: ioperm?
@@ -1427,10 +1459,45 @@ void Processor::exit_trap(TrapFrame& trap)
 
     smp_process_pending_messages();
 
+    // Only run deferred work if we're returning to a context that could have taken the
+    // interrupt in the first place, rather than, say, from a page fault with interrupts off.
+    if (!m_in_irq && !m_in_critical && m_deferred_work_head && (trap.regs->eflags & 0x200))
+        deferred_work_execute_pending();
+
     if (!m_in_irq && !m_in_critical)
         check_invoke_scheduler();
 }
 
+void Processor::deferred_work_queue(DeferredWork& work)
+{
+    ASSERT_INTERRUPTS_DISABLED();
+    ASSERT(!work.m_next);
+    if (m_deferred_work_tail)
+        m_deferred_work_tail->m_next = &work;
+    else
+        m_deferred_work_head = &work;
+    m_deferred_work_tail = &work;
+}
+
+void Processor::deferred_work_execute_pending()
+{
+    ASSERT_INTERRUPTS_DISABLED();
+    // Stay in a critical section so we can't be preempted and moved to another processor
+    // halfway through. Interrupts coming in meanwhile just append to the list, and their own
+    // exit_trap() leaves it to us.
+    m_in_critical++;
+    while (auto* work = m_deferred_work_head) {
+        m_deferred_work_head = work->m_next;
+        if (!m_deferred_work_head)
+            m_deferred_work_tail = nullptr;
+        work->m_next = nullptr;
+        sti();
+        work->run();
+        cli();
+    }
+    m_in_critical--;
+}
+
 void Processor::check_invoke_scheduler()
 {
     ASSERT(!m_in_irq);
@@ -1454,14 +1521,70 @@ void Processor::flush_tlb_local(VirtualAddress vaddr, size_t page_count)
     }
 }
 
-void Processor::flush_tlb(VirtualAddress vaddr, size_t page_count)
+void Processor::flush_tlb(u32 cr3, VirtualAddress vaddr, size_t page_count)
 {
     flush_tlb_local(vaddr, page_count);
-    if (s_smp_enabled)
-        smp_broadcast_flush_tlb(vaddr, page_count);
+    if (!s_smp_enabled)
+        return;
+
+    ScopedCritical critical;
+    auto& proc = Processor::current();
+    if (proc.m_tlb_flush_batch_depth > 0 && proc.add_to_tlb_flush_batch(cr3, vaddr, page_count))
+        return;
+    smp_flush_tlb(cr3, vaddr, page_count);
+}
+
+void Processor::begin_tlb_flush_batch()
+{
+    ASSERT(in_critical());
+    m_tlb_flush_batch_depth++;
+}
+
+void Processor::end_tlb_flush_batch()
+{
+    ASSERT(m_tlb_flush_batch_depth > 0);
+    if (--m_tlb_flush_batch_depth > 0)
+        return;
+
+    auto cr3 = exchange(m_tlb_flush_batch_cr3, 0);
+    if (cr3)
+        smp_flush_tlb(cr3, m_tlb_flush_batch_start, m_tlb_flush_batch_page_count);
+}
+
+bool Processor::add_to_tlb_flush_batch(u32 cr3, VirtualAddress vaddr, size_t page_count)
+{
+    // Past this many pages it's cheaper to drop all of the address space's entries
+    static constexpr size_t max_batched_page_count = 32;
+
+    // Only batch changes to a single address space. The kernel's mappings
+    // are shared by all of them, so these are flushed right away.
+    if (!cr3)
+        return false;
+    if (!m_tlb_flush_batch_cr3) {
+        m_tlb_flush_batch_cr3 = cr3;
+        m_tlb_flush_batch_start = vaddr;
+        m_tlb_flush_batch_page_count = page_count;
+        return true;
+    }
+    if (m_tlb_flush_batch_cr3 != cr3)
+        return false;
+    if (m_tlb_flush_batch_start.is_null())
+        return true;
+
+    auto start = min(m_tlb_flush_batch_start.get(), vaddr.get());
+    auto end = max(m_tlb_flush_batch_start.get() + m_tlb_flush_batch_page_count * PAGE_SIZE, vaddr.get() + page_count * PAGE_SIZE);
+    if ((end - start) / PAGE_SIZE > max_batched_page_count) {
+        m_tlb_flush_batch_start = {};
+        m_tlb_flush_batch_page_count = 0;
+    } else {
+        m_tlb_flush_batch_start = VirtualAddress(start);
+        m_tlb_flush_batch_page_count = (end - start) / PAGE_SIZE;
+    }
+    return true;
 }
 
 static volatile ProcessorMessage* s_message_pool;
+static volatile u32 s_ipi_counts[ProcessorMessage::__Count]; // atomic
 
 void Processor::smp_return_to_pool(ProcessorMessage& msg)
 {
@@ -1575,8 +1698,16 @@ bool Processor::smp_process_pending_messages()
                     msg->callback_with_data.handler(msg->callback_with_data.data);
                     break;
                 case ProcessorMessage::FlushTlb:
-                    flush_tlb_local(VirtualAddress(msg->flush_tlb.ptr), msg->flush_tlb.page_count);
+                    // If we have switched address spaces since, loading cr3 already dropped the stale entries
+                    if (msg->flush_tlb.cr3 && msg->flush_tlb.cr3 != loaded_cr3())
+                        break;
+                    if (!msg->flush_tlb.ptr)
+                        flush_entire_tlb_local();
+                    else
+                        flush_tlb_local(VirtualAddress(msg->flush_tlb.ptr), msg->flush_tlb.page_count);
                     break;
+                case ProcessorMessage::__Count:
+                    ASSERT_NOT_REACHED();
             }
 
             bool is_async = msg->async; // Need to cache this value *before* dropping the ref count!
@@ -1626,6 +1757,7 @@ void Processor::smp_broadcast_message(ProcessorMessage& msg, bool async)
 #endif
     atomic_store(&msg.refs, count() - 1, AK::MemoryOrder::memory_order_release);
     ASSERT(msg.refs > 0);
+    atomic_fetch_add(&s_ipi_counts[msg.type], count() - 1, AK::MemoryOrder::memory_order_relaxed);
     for_each(
         [&](Processor& proc) -> IterationDecision
         {
@@ -1652,6 +1784,57 @@ void Processor::smp_broadcast_message(ProcessorMessage& msg, bool async)
     }
 }
 
+void Processor::smp_multicast_message(u32 cpu_mask, ProcessorMessage& msg, bool async)
+{
+    auto& cur_proc = Processor::current();
+    ASSERT(!(cpu_mask & (1u << cur_proc.id())));
+    msg.async = async;
+#ifdef SMP_DEBUG
+    dbg() << "SMP[" << cur_proc.id() << "]: Send message " << VirtualAddress(&msg) << " to cpus: " << String::format("%x", cpu_mask);
+#endif
+    u32 target_count = __builtin_popcount(cpu_mask);
+    ASSERT(target_count > 0);
+    atomic_store(&msg.refs, target_count, AK::MemoryOrder::memory_order_release);
+    atomic_fetch_add(&s_ipi_counts[msg.type], target_count, AK::MemoryOrder::memory_order_relaxed);
+    for_each(
+        [&](Processor& proc) -> IterationDecision
+        {
+            if (cpu_mask & (1u << proc.id()))
+                proc.smp_queue_message(msg);
+            return IterationDecision::Continue;
+        });
+
+    APIC::the().multicast_ipi(cpu_mask);
+
+    if (!async) {
+        // If synchronous then we must cleanup and return the message back
+        // to the pool. Otherwise, the last target processor will return it.
+        // Keep processing our own messages while waiting, a target
+        // processor may be waiting on us in the same way.
+        while (atomic_load(&msg.refs, AK::MemoryOrder::memory_order_consume) != 0) {
+            cur_proc.smp_process_pending_messages();
+        }
+
+        smp_cleanup_message(msg);
+        smp_return_to_pool(msg);
+    }
+}
+
+void Processor::smp_unicast_message(u32 cpu, ProcessorMessage& msg, bool async)
+{
+    smp_multicast_message(1u << cpu, msg, async);
+}
+
+void Processor::smp_unicast(u32 cpu, void (*callback)(void*), void* data, void (*free_data)(void*), bool async)
+{
+    auto& msg = smp_get_from_pool();
+    msg.type = ProcessorMessage::CallbackWithData;
+    msg.callback_with_data.handler = callback;
+    msg.callback_with_data.data = data;
+    msg.callback_with_data.free = free_data;
+    smp_unicast_message(cpu, msg, async);
+}
+
 void Processor::smp_broadcast(void (*callback)(void*), void* data, void (*free_data)(void*), bool async)
 {
     auto& msg = smp_get_from_pool();
@@ -1670,13 +1853,40 @@ void Processor::smp_broadcast(void (*callback)(), bool async)
     smp_broadcast_message(msg, async);
 }
 
-void Processor::smp_broadcast_flush_tlb(VirtualAddress vaddr, size_t page_count)
+void Processor::smp_flush_tlb(u32 cr3, VirtualAddress vaddr, size_t page_count)
 {
+    // Only processors that currently run in this address space can have
+    // stale entries, the others dropped them when they switched away.
+    auto& cur_proc = Processor::current();
+    u32 cpu_mask = 0;
+    // The page table stores must be visible before we look at which address
+    // space each processor has loaded, see write_cr3().
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    for_each(
+        [&](Processor& proc) -> IterationDecision
+        {
+            if (&proc != &cur_proc && (!cr3 || proc.loaded_cr3() == cr3))
+                cpu_mask |= 1u << proc.id();
+            return IterationDecision::Continue;
+        });
+    if (!cpu_mask)
+        return;
+
     auto& msg = smp_get_from_pool();
     msg.type = ProcessorMessage::FlushTlb;
     msg.flush_tlb.ptr = vaddr.as_ptr();
     msg.flush_tlb.page_count = page_count;
-    smp_broadcast_message(msg, false);
+    msg.flush_tlb.cr3 = cr3;
+    if (!cr3)
+        smp_broadcast_message(msg, false);
+    else
+        smp_multicast_message(cpu_mask, msg, false);
+}
+
+u32 Processor::smp_ipi_count(ProcessorMessage::Type type)
+{
+    ASSERT(type < ProcessorMessage::__Count);
+    return atomic_load(&s_ipi_counts[type], AK::MemoryOrder::memory_order_relaxed);
 }
 
 void Processor::smp_broadcast_halt()
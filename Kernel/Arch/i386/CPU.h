@@ -36,6 +36,10 @@
 #define PAGE_SIZE 4096
 #define GENERIC_INTERRUPT_HANDLERS_COUNT (256 - IRQ_VECTOR_BASE)
 #define PAGE_MASK ((FlatPtr)0xfffff000u)
+// With PAE, a page directory entry with the Huge bit set maps 2 MiB directly.
+#define LARGE_PAGE_SIZE 0x200000
+#define LARGE_PAGE_MASK ((FlatPtr)0xffe00000u)
+#define PAGES_PER_LARGE_PAGE (LARGE_PAGE_SIZE / PAGE_SIZE)
 
 namespace Kernel {
 
@@ -140,6 +144,14 @@ public:
         m_raw |= value & 0xfffff000;
     }
 
+    // Only meaningful when is_huge() is set.
+    u32 large_page_base() const { return m_raw & LARGE_PAGE_MASK; }
+    void set_large_page_base(u32 value)
+    {
+        m_raw &= 0x8000000000000fffULL;
+        m_raw |= value & LARGE_PAGE_MASK;
+    }
+
     void clear() { m_raw = 0; }
 
     u64 raw() const { return m_raw; }
@@ -209,6 +221,7 @@ public:
         UserSupervisor = 1 << 2,
         WriteThrough = 1 << 3,
         CacheDisabled = 1 << 4,
+        Accessed = 1 << 5,
         Global = 1 << 8,
         NoExecute = 0x8000000000000000ULL,
     };
@@ -228,6 +241,10 @@ public:
     bool is_cache_disabled() const { return raw() & CacheDisabled; }
     void set_cache_disabled(bool b) { set_bit(CacheDisabled, b); }
 
+    // Set by the CPU whenever the page is accessed through this entry.
+    bool is_accessed() const { return raw() & Accessed; }
+    void set_accessed(bool b) { set_bit(Accessed, b); }
+
     bool is_global() const { return raw() & Global; }
     void set_global(bool b) { set_bit(Global, b); }
 
@@ -601,9 +618,11 @@ enum class CPUFeature : u32 {
     TSC = (1 << 8),
     UMIP = (1 << 9),
     SEP = (1 << 10),
-    SYSCALL = (1 << 11)
+    SYSCALL = (1 << 11),
+    CONSTANT_TSC = (1 << 12)
 };
 
+class DeferredWork;
 class Thread;
 struct TrapFrame;
 
@@ -626,12 +645,14 @@ class ProcessorInfo;
 class SchedulerPerProcessorData;
 struct MemoryManagerData;
 struct ProcessorMessageEntry;
+class TimerQueue;
 
 struct ProcessorMessage {
     enum Type {
         FlushTlb,
         Callback,
-        CallbackWithData
+        CallbackWithData,
+        __Count
     };
     Type type;
     volatile u32 refs; // atomic
@@ -646,8 +667,9 @@ struct ProcessorMessage {
             void (*free)(void*);
         } callback_with_data;
         struct {
-            u8* ptr;
+            u8* ptr; // nullptr flushes all non-global entries
             size_t page_count;
+            u32 cr3; // 0 for mappings shared by all page directories
         } flush_tlb;
     };
 
@@ -685,15 +707,27 @@ class Processor {
     ProcessorInfo* m_info;
     MemoryManagerData* m_mm_data;
     SchedulerPerProcessorData* m_scheduler_data;
+    TimerQueue* m_timer_queue;
     Thread* m_current_thread;
     Thread* m_idle_thread;
 
     volatile ProcessorMessageEntry* m_message_queue; // atomic, LIFO
 
+    // Only touched by this processor, with interrupts disabled.
+    DeferredWork* m_deferred_work_head;
+    DeferredWork* m_deferred_work_tail;
+
     bool m_invoke_scheduler_async;
     bool m_scheduler_initialized;
     bool m_halt_requested;
 
+    volatile u32 m_loaded_cr3; // atomic
+
+    u32 m_tlb_flush_batch_depth;
+    u32 m_tlb_flush_batch_cr3;
+    VirtualAddress m_tlb_flush_batch_start;
+    size_t m_tlb_flush_batch_page_count;
+
     void gdt_init();
     void write_raw_gdt_entry(u16 selector, u32 low, u32 high);
     void write_gdt_entry(u16 selector, Descriptor& descriptor);
@@ -704,6 +738,10 @@ class Processor {
     static void smp_cleanup_message(ProcessorMessage& msg);
     bool smp_queue_message(ProcessorMessage& msg);
     static void smp_broadcast_message(ProcessorMessage& msg, bool async);
+    static void smp_multicast_message(u32 cpu_mask, ProcessorMessage& msg, bool async);
+    static void smp_unicast_message(u32 cpu, ProcessorMessage& msg, bool async);
+    static void smp_flush_tlb(u32 cr3, VirtualAddress vaddr, size_t page_count);
+    bool add_to_tlb_flush_batch(u32 cr3, VirtualAddress vaddr, size_t page_count);
     static void smp_broadcast_halt();
 
     void cpu_detect();
@@ -738,7 +776,20 @@ public:
     }
 
     static void flush_tlb_local(VirtualAddress vaddr, size_t page_count);
-    static void flush_tlb(VirtualAddress vaddr, size_t page_count);
+    static void flush_tlb(u32 cr3, VirtualAddress vaddr, size_t page_count);
+
+    ALWAYS_INLINE void set_loaded_cr3(u32 cr3)
+    {
+        AK::atomic_store(&m_loaded_cr3, cr3);
+    }
+
+    ALWAYS_INLINE u32 loaded_cr3() const
+    {
+        return AK::atomic_load(&m_loaded_cr3);
+    }
+
+    void begin_tlb_flush_batch();
+    void end_tlb_flush_batch();
 
     Descriptor& get_gdt_entry(u16 selector);
     void flush_gdt();
@@ -792,6 +843,16 @@ public:
         return *m_mm_data;
     }
 
+    ALWAYS_INLINE void set_timer_queue(TimerQueue& timer_queue)
+    {
+        m_timer_queue = &timer_queue;
+    }
+
+    ALWAYS_INLINE TimerQueue* timer_queue() const
+    {
+        return m_timer_queue;
+    }
+
     ALWAYS_INLINE Thread* idle_thread() const
     {
         return m_idle_thread;
@@ -903,7 +964,24 @@ public:
     }
     static void smp_broadcast(void (*callback)(), bool async);
     static void smp_broadcast(void (*callback)(void*), void* data, void (*free_data)(void*), bool async);
-    static void smp_broadcast_flush_tlb(VirtualAddress vaddr, size_t page_count);
+    static u32 smp_ipi_count(ProcessorMessage::Type);
+
+    template<typename Callback>
+    static void smp_unicast(u32 cpu, Callback callback, bool async)
+    {
+        auto* data = new Callback(move(callback));
+        smp_unicast(
+            cpu,
+            [](void* data) {
+                (*reinterpret_cast<Callback*>(data))();
+            },
+            data,
+            [](void* data) {
+                delete reinterpret_cast<Callback*>(data);
+            },
+            async);
+    }
+    static void smp_unicast(u32 cpu, void (*callback)(void*), void* data, void (*free_data)(void*), bool async);
 
     ALWAYS_INLINE bool has_feature(CPUFeature f) const
     {
@@ -913,6 +991,10 @@ public:
     void check_invoke_scheduler();
     void invoke_scheduler_async() { m_invoke_scheduler_async = true; }
 
+    // Must be called with interrupts disabled. See DeferredWork::schedule_on_this_processor().
+    void deferred_work_queue(DeferredWork&);
+    void deferred_work_execute_pending();
+
     void enter_trap(TrapFrame& trap, bool raise_irq);
 
     void exit_trap(TrapFrame& trap);
@@ -983,6 +1065,27 @@ private:
     bool m_valid { false };
 };
 
+// Defers the TLB shootdowns of the enclosed page table changes to other
+// processors, so that they get a single IPI at the end instead of one per change.
+class ScopedTLBFlushBatch {
+    AK_MAKE_NONCOPYABLE(ScopedTLBFlushBatch);
+
+public:
+    ScopedTLBFlushBatch()
+    {
+        Processor::current().begin_tlb_flush_batch();
+    }
+
+    ~ScopedTLBFlushBatch()
+    {
+        Processor::current().end_tlb_flush_batch();
+    }
+
+private:
+    // The batch is per processor, so we must not be moved to another one in the meantime
+    ScopedCritical m_critical;
+};
+
 struct TrapFrame {
     u32 prev_irq_level;
     RegisterState* regs; // must be last
@@ -0,0 +1,201 @@
+/*
+ * Copyright (c) 2020, The SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+//#define AHCI_DEBUG
+
+#include <Kernel/Devices/AHCIController.h>
+#include <Kernel/Devices/AHCIDiskDevice.h>
+#include <Kernel/VM/MemoryManager.h>
+
+namespace Kernel {
+
+// Generic host control registers
+#define AHCI_CAP 0x00
+#define AHCI_GHC 0x04
+#define AHCI_IS 0x08
+#define AHCI_PI 0x0c
+
+#define AHCI_CAP_NCS_SHIFT 8
+#define AHCI_CAP_NCS_MASK 0x1f
+#define AHCI_CAP_SNCQ (1u << 30)
+
+#define AHCI_GHC_IE (1u << 1)
+#define AHCI_GHC_AE (1u << 31)
+
+#define AHCI_PORT_REGISTERS_OFFSET 0x100
+#define AHCI_PORT_REGISTERS_SIZE 0x80
+#define AHCI_PORT_SSTS 0x28
+#define AHCI_PORT_SIG 0x24
+
+#define AHCI_SSTS_DET_MASK 0xf
+#define AHCI_SSTS_DET_PRESENT 3
+#define AHCI_SIG_ATA 0x00000101
+
+// Mass storage controller, SATA, AHCI 1.0
+#define PCI_CLASS_MASS_STORAGE 0x01
+#define PCI_SUBCLASS_SATA 0x06
+#define PCI_PROG_IF_AHCI 0x01
+
+static NonnullRefPtrVector<AHCIDiskDevice>* s_devices;
+
+void AHCIController::detect()
+{
+    if (!s_devices)
+        s_devices = new NonnullRefPtrVector<AHCIDiskDevice>;
+
+    PCI::enumerate([&](const PCI::Address& address, PCI::ID) {
+        if (address.is_null())
+            return;
+        if (PCI::get_class(address) != PCI_CLASS_MASS_STORAGE || PCI::get_subclass(address) != PCI_SUBCLASS_SATA || PCI::get_programming_interface(address) != PCI_PROG_IF_AHCI)
+            return;
+        auto* controller = new AHCIController(address);
+        if (!controller->initialize()) {
+            klog() << "AHCIController: Couldn't initialize controller @ " << address;
+            delete controller;
+            return;
+        }
+    });
+}
+
+RefPtr<AHCIDiskDevice> AHCIController::device(size_t index)
+{
+    if (!s_devices || index >= s_devices->size())
+        return nullptr;
+    return s_devices->at(index);
+}
+
+AHCIController::AHCIController(PCI::Address address)
+    : PCI::Device(address, PCI::get_interrupt_line(address))
+{
+}
+
+AHCIController::~AHCIController()
+{
+}
+
+u32 AHCIController::read_register(size_t offset) const
+{
+    return *(volatile u32*)m_registers->vaddr().offset(offset).as_ptr();
+}
+
+void AHCIController::write_register(size_t offset, u32 value)
+{
+    *(volatile u32*)m_registers->vaddr().offset(offset).as_ptr() = value;
+}
+
+volatile u32* AHCIController::port_registers(u8 port) const
+{
+    return (volatile u32*)m_registers->vaddr().offset(AHCI_PORT_REGISTERS_OFFSET + port * AHCI_PORT_REGISTERS_SIZE).as_ptr();
+}
+
+bool AHCIController::initialize()
+{
+    klog() << "AHCIController: Found @ " << pci_address();
+
+    u32 bar = PCI::get_BAR5(pci_address());
+    if (bar & 1)
+        return false;
+    PhysicalAddress registers_address(bar & ~0xf);
+    size_t registers_size = PCI::get_BAR_space_size(pci_address(), 5);
+    PCI::enable_memory_space(pci_address());
+    PCI::enable_bus_mastering(pci_address());
+    // The registers are at least 8 KiB aligned, so they start on a page.
+    m_registers = MM.allocate_kernel_region(registers_address, PAGE_ROUND_UP(registers_size), "AHCI", Region::Access::Read | Region::Access::Write, false, false);
+    if (!m_registers)
+        return false;
+
+    write_register(AHCI_GHC, read_register(AHCI_GHC) | AHCI_GHC_AE);
+
+    u32 capabilities = read_register(AHCI_CAP);
+    m_command_slot_count = ((capabilities >> AHCI_CAP_NCS_SHIFT) & AHCI_CAP_NCS_MASK) + 1;
+    m_supports_ncq = capabilities & AHCI_CAP_SNCQ;
+    u32 ports_implemented = read_register(AHCI_PI);
+    klog() << "AHCIController: " << m_command_slot_count << " command slots per port" << (m_supports_ncq ? ", NCQ" : "") << ", ports implemented: " << String::format("%08x", ports_implemented);
+
+    for (u8 port = 0; port < 32; ++port) {
+        if (!(ports_implemented & (1u << port)))
+            continue;
+        auto* registers = port_registers(port);
+        u32 status = registers[AHCI_PORT_SSTS / 4];
+        u32 signature = registers[AHCI_PORT_SIG / 4];
+#ifdef AHCI_DEBUG
+        klog() << "AHCIController: Port " << port << " status " << String::format("%x", status) << ", signature " << String::format("%08x", signature);
+#endif
+        if ((status & AHCI_SSTS_DET_MASK) != AHCI_SSTS_DET_PRESENT || signature != AHCI_SIG_ATA)
+            continue;
+        auto disk = AHCIDiskDevice::create(*this, port, s_devices->size());
+        if (!disk)
+            continue;
+        m_ports[port] = disk;
+        s_devices->append(disk.release_nonnull());
+    }
+
+    write_register(AHCI_IS, 0xffffffff);
+    write_register(AHCI_GHC, read_register(AHCI_GHC) | AHCI_GHC_IE);
+    setup_msi();
+    if (!m_msi_handler)
+        enable_irq();
+    return true;
+}
+
+void AHCIController::setup_msi()
+{
+    m_msi = PCI::MSICapability::try_create(pci_address());
+    if (!m_msi)
+        return;
+    m_msi_handler = MSIHandler::try_create(purpose(), [this] {
+        handle_interrupts();
+    });
+    if (!m_msi_handler) {
+        m_msi = nullptr;
+        return;
+    }
+    m_msi_handler->set_message_writer([this](u32 address, u16 data) {
+        m_msi->set_message(address, data);
+    });
+    m_msi->enable();
+    klog() << "AHCIController: Using MSI";
+}
+
+void AHCIController::handle_irq(const RegisterState&)
+{
+    handle_interrupts();
+}
+
+void AHCIController::handle_interrupts()
+{
+    u32 pending_ports = read_register(AHCI_IS);
+    if (!pending_ports)
+        return;
+    for (u8 port = 0; port < 32; ++port) {
+        if ((pending_ports & (1u << port)) && m_ports[port])
+            m_ports[port]->handle_port_interrupt();
+    }
+    // The ports have cleared their own status by now, so this won't lose anything that came in meanwhile.
+    write_register(AHCI_IS, pending_ports);
+}
+
+}
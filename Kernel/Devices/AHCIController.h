@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2020, The SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+//
+// Advanced Host Controller Interface (AHCI) driver
+//
+// An AHCI controller has up to 32 SATA ports, each taking up to 32 commands
+// at once through its command list. Disks that support native command
+// queuing (NCQ) may work on all of them at the same time, in whatever order
+// suits them.
+//
+// More information about AHCI can be found here:
+//      https://www.intel.com/content/dam/www/public/us/en/documents/technical-specifications/serial-ata-ahci-spec-rev1-3-1.pdf
+//
+
+#pragma once
+
+#include <AK/NonnullRefPtrVector.h>
+#include <AK/OwnPtr.h>
+#include <Kernel/Interrupts/MSIHandler.h>
+#include <Kernel/PCI/Access.h>
+#include <Kernel/PCI/Device.h>
+#include <Kernel/PCI/MSICapability.h>
+#include <Kernel/VM/Region.h>
+
+namespace Kernel {
+
+class AHCIDiskDevice;
+
+class AHCIController final : public PCI::Device {
+public:
+    static void detect();
+    // The disks of all controllers in PCI enumeration and port order, so that /dev/sda is the first one.
+    static RefPtr<AHCIDiskDevice> device(size_t index);
+
+    virtual ~AHCIController() override;
+
+    virtual const char* purpose() const override { return "AHCIController"; }
+
+    volatile u32* port_registers(u8 port) const;
+    size_t command_slot_count() const { return m_command_slot_count; }
+    bool supports_ncq() const { return m_supports_ncq; }
+
+private:
+    explicit AHCIController(PCI::Address);
+
+    bool initialize();
+    void setup_msi();
+    void handle_interrupts();
+
+    // ^IRQHandler
+    virtual void handle_irq(const RegisterState&) override;
+
+    u32 read_register(size_t offset) const;
+    void write_register(size_t offset, u32 value);
+
+    OwnPtr<Region> m_registers;
+    OwnPtr<PCI::MSICapability> m_msi;
+    OwnPtr<MSIHandler> m_msi_handler;
+    size_t m_command_slot_count { 0 };
+    bool m_supports_ncq { false };
+    RefPtr<AHCIDiskDevice> m_ports[32];
+};
+
+}
@@ -0,0 +1,524 @@
+/*
+ * Copyright (c) 2020, The SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+//#define AHCI_DEBUG
+
+#include <AK/Memory.h>
+#include <AK/StringView.h>
+#include <Kernel/Devices/AHCIController.h>
+#include <Kernel/Devices/AHCIDiskDevice.h>
+#include <Kernel/FileSystem/FileDescription.h>
+#include <Kernel/IO.h>
+#include <Kernel/Thread.h>
+#include <Kernel/VM/MemoryManager.h>
+
+namespace Kernel {
+
+// Port registers
+#define AHCI_PxCLB 0x00
+#define AHCI_PxCLBU 0x04
+#define AHCI_PxFB 0x08
+#define AHCI_PxFBU 0x0c
+#define AHCI_PxIS 0x10
+#define AHCI_PxIE 0x14
+#define AHCI_PxCMD 0x18
+#define AHCI_PxTFD 0x20
+#define AHCI_PxSERR 0x30
+#define AHCI_PxSACT 0x34
+#define AHCI_PxCI 0x38
+
+#define AHCI_PxCMD_ST (1u << 0)
+#define AHCI_PxCMD_FRE (1u << 4)
+#define AHCI_PxCMD_FR (1u << 14)
+#define AHCI_PxCMD_CR (1u << 15)
+
+// Device to host register FIS, PIO setup FIS, DMA setup FIS and set device bits FIS received, descriptor processed
+#define AHCI_PxIS_COMPLETIONS ((1u << 0) | (1u << 1) | (1u << 2) | (1u << 3) | (1u << 5))
+// Interface fatal error, host bus data error, host bus fatal error and task file error
+#define AHCI_PxIS_ERRORS ((1u << 27) | (1u << 28) | (1u << 29) | (1u << 30))
+
+#define ATA_SR_BSY 0x80
+#define ATA_SR_DRQ 0x08
+
+#define ATA_CMD_READ_DMA_EXT 0x25
+#define ATA_CMD_WRITE_DMA_EXT 0x35
+#define ATA_CMD_READ_FPDMA_QUEUED 0x60
+#define ATA_CMD_WRITE_FPDMA_QUEUED 0x61
+#define ATA_CMD_IDENTIFY 0xec
+
+#define FIS_TYPE_REGISTER_HOST_TO_DEVICE 0x27
+
+static constexpr unsigned ahci_disk_major = 8;
+static constexpr size_t sector_size = 512;
+
+// A merged request from the BlockIOTask goes out as a single command. Larger transfers take several, one after the other.
+static constexpr u16 max_sectors_per_command = BlockDevice::max_merged_request_size / sector_size;
+// Enough entries for a buffer that isn't page aligned, even if none of its pages are next to each other.
+static constexpr size_t max_prdt_entries = 48;
+
+static constexpr size_t command_header_size = 32;
+static constexpr size_t received_fis_offset = 32 * command_header_size;
+static constexpr size_t prdt_offset = 0x80;
+static constexpr size_t command_table_size = prdt_offset + max_prdt_entries * 16;
+static_assert(command_table_size % 128 == 0);
+
+RefPtr<AHCIDiskDevice> AHCIDiskDevice::create(AHCIController& controller, u8 port, unsigned minor)
+{
+    auto disk = adopt(*new AHCIDiskDevice(controller, port, minor));
+    if (!disk->initialize()) {
+        klog() << "AHCIDiskDevice: Couldn't initialize the disk on port " << port;
+        return nullptr;
+    }
+    return disk;
+}
+
+AHCIDiskDevice::AHCIDiskDevice(AHCIController& controller, u8 port, unsigned minor)
+    : BlockDevice(ahci_disk_major, minor, sector_size)
+    , m_controller(controller)
+    , m_port(port)
+{
+}
+
+AHCIDiskDevice::~AHCIDiskDevice()
+{
+}
+
+u32 AHCIDiskDevice::read_port_register(size_t offset) const
+{
+    return m_controller.port_registers(m_port)[offset / 4];
+}
+
+void AHCIDiskDevice::write_port_register(size_t offset, u32 value)
+{
+    m_controller.port_registers(m_port)[offset / 4] = value;
+}
+
+u8* AHCIDiskDevice::command_table(u8 slot) const
+{
+    return m_command_table_region->vaddr().offset(slot * command_table_size).as_ptr();
+}
+
+bool AHCIDiskDevice::initialize()
+{
+    m_command_list_region = MM.allocate_contiguous_kernel_region(PAGE_SIZE, "AHCI Command List", Region::Access::Read | Region::Access::Write);
+    m_command_table_region = MM.allocate_contiguous_kernel_region(PAGE_ROUND_UP(32 * command_table_size), "AHCI Command Tables", Region::Access::Read | Region::Access::Write);
+    m_bounce_region = MM.allocate_contiguous_kernel_region(max_sectors_per_command * sector_size, "AHCI Bounce Buffer", Region::Access::Read | Region::Access::Write);
+    if (!m_command_list_region || !m_command_table_region || !m_bounce_region)
+        return false;
+    memset(m_command_list_region->vaddr().as_ptr(), 0, PAGE_SIZE);
+    memset(command_table(0), 0, 32 * command_table_size);
+
+    stop_port();
+    auto command_list_address = m_command_list_region->physical_page(0)->paddr();
+    write_port_register(AHCI_PxCLB, command_list_address.get());
+    write_port_register(AHCI_PxCLBU, 0);
+    write_port_register(AHCI_PxFB, command_list_address.offset(received_fis_offset).get());
+    write_port_register(AHCI_PxFBU, 0);
+    write_port_register(AHCI_PxSERR, 0xffffffff);
+    write_port_register(AHCI_PxIS, 0xffffffff);
+    if (!start_port())
+        return false;
+    if (!identify())
+        return false;
+
+    write_port_register(AHCI_PxIS, 0xffffffff);
+    write_port_register(AHCI_PxIE, AHCI_PxIS_COMPLETIONS | AHCI_PxIS_ERRORS);
+    return true;
+}
+
+void AHCIDiskDevice::stop_port()
+{
+    write_port_register(AHCI_PxCMD, read_port_register(AHCI_PxCMD) & ~AHCI_PxCMD_ST);
+    for (size_t i = 0; i < 500 && (read_port_register(AHCI_PxCMD) & AHCI_PxCMD_CR); ++i)
+        IO::delay(1000);
+    write_port_register(AHCI_PxCMD, read_port_register(AHCI_PxCMD) & ~AHCI_PxCMD_FRE);
+    for (size_t i = 0; i < 500 && (read_port_register(AHCI_PxCMD) & AHCI_PxCMD_FR); ++i)
+        IO::delay(1000);
+}
+
+bool AHCIDiskDevice::start_port()
+{
+    write_port_register(AHCI_PxCMD, read_port_register(AHCI_PxCMD) | AHCI_PxCMD_FRE);
+    for (size_t i = 0; read_port_register(AHCI_PxTFD) & (ATA_SR_BSY | ATA_SR_DRQ); ++i) {
+        if (i == 1000)
+            return false;
+        IO::delay(1000);
+    }
+    write_port_register(AHCI_PxCMD, read_port_register(AHCI_PxCMD) | AHCI_PxCMD_ST);
+    return true;
+}
+
+bool AHCIDiskDevice::identify()
+{
+    // Interrupts aren't enabled for the port yet, so this one is polled.
+    u8* data = m_bounce_region->vaddr().as_ptr();
+    size_t entry_count = build_prdt(0, data, 512, true);
+    ASSERT(entry_count);
+    write_command(0, ATA_CMD_IDENTIFY, 0, 0, entry_count, false);
+    write_port_register(AHCI_PxCI, 1);
+    for (size_t i = 0; read_port_register(AHCI_PxCI) & 1; ++i) {
+        if (i == 1000 || (read_port_register(AHCI_PxIS) & AHCI_PxIS_ERRORS)) {
+            klog() << "AHCIDiskDevice: IDENTIFY failed on port " << m_port << ", status " << String::format("%x", read_port_register(AHCI_PxTFD));
+            return false;
+        }
+        IO::delay(1000);
+    }
+
+    auto* words = (const u16*)data;
+    bool supports_lba48 = words[83] & (1 << 10);
+    if (supports_lba48)
+        m_sector_count = (u64)words[100] | ((u64)words[101] << 16) | ((u64)words[102] << 32) | ((u64)words[103] << 48);
+    else
+        m_sector_count = (u32)words[60] | ((u32)words[61] << 16);
+
+    // The disk may queue fewer commands than the controller can hold for it.
+    bool supports_ncq = words[76] & (1 << 8);
+    m_uses_ncq = supports_ncq && m_controller.supports_ncq();
+    if (m_uses_ncq)
+        m_queue_depth = min((size_t)(words[75] & 0x1f) + 1, m_controller.command_slot_count());
+
+    char model[40];
+    for (size_t i = 0; i < 20; ++i) {
+        model[i * 2] = words[27 + i] >> 8;
+        model[i * 2 + 1] = words[27 + i] & 0xff;
+    }
+    size_t model_length = 40;
+    while (model_length && model[model_length - 1] == ' ')
+        --model_length;
+    klog() << "AHCIDiskDevice: Port " << m_port << ": " << StringView(model, model_length) << ", " << m_sector_count << " sectors" << (m_uses_ncq ? ", NCQ depth " : ", no NCQ") << (m_uses_ncq ? String::number(m_queue_depth) : String());
+    return true;
+}
+
+size_t AHCIDiskDevice::build_prdt(u8 slot, u8* buffer, size_t length, bool device_writes_memory)
+{
+    auto* prdt = (volatile u32*)(command_table(slot) + prdt_offset);
+    size_t entry_count = 0;
+    u32 entry_end = 0;
+    u32 entry_size = 0;
+    auto vaddr = VirtualAddress(buffer);
+    while (length) {
+        size_t chunk = min(length, PAGE_SIZE - (vaddr.get() & ~PAGE_MASK));
+        auto paddr = MM.physical_address_for_dma(vaddr, device_writes_memory, m_slot_pinned_pages[slot]);
+        if (!paddr.has_value()) {
+            m_slot_pinned_pages[slot].clear();
+            return 0;
+        }
+        // Pages that are next to each other in physical memory too can share an entry, up to the 4 MiB it can describe.
+        if (entry_count && paddr.value().get() == entry_end && entry_size + chunk <= 4 * MB) {
+            entry_size += chunk;
+        } else {
+            if (entry_count == max_prdt_entries) {
+                m_slot_pinned_pages[slot].clear();
+                return 0;
+            }
+            ++entry_count;
+            entry_size = chunk;
+            prdt[(entry_count - 1) * 4] = paddr.value().get();
+            prdt[(entry_count - 1) * 4 + 1] = 0;
+            prdt[(entry_count - 1) * 4 + 2] = 0;
+        }
+        prdt[(entry_count - 1) * 4 + 3] = entry_size - 1;
+        entry_end = paddr.value().get() + chunk;
+        vaddr = vaddr.offset(chunk);
+        length -= chunk;
+    }
+    return entry_count;
+}
+
+void AHCIDiskDevice::write_command(u8 slot, u8 command, u64 lba, u16 count, size_t prdt_entry_count, bool is_write)
+{
+    auto* header = (volatile u32*)(m_command_list_region->vaddr().as_ptr() + slot * command_header_size);
+    // The FIS is 5 dwords long.
+    header[0] = 5 | (is_write ? (1 << 6) : 0) | (prdt_entry_count << 16);
+    header[1] = 0;
+    header[2] = m_command_table_region->physical_page(0)->paddr().offset(slot * command_table_size).get();
+    header[3] = 0;
+
+    u8* fis = command_table(slot);
+    memset(fis, 0, prdt_offset);
+    fis[0] = FIS_TYPE_REGISTER_HOST_TO_DEVICE;
+    fis[1] = 0x80;
+    fis[2] = command;
+    fis[4] = lba & 0xff;
+    fis[5] = (lba >> 8) & 0xff;
+    fis[6] = (lba >> 16) & 0xff;
+    fis[8] = (lba >> 24) & 0xff;
+    fis[9] = (lba >> 32) & 0xff;
+    fis[10] = (lba >> 40) & 0xff;
+    if (command == ATA_CMD_IDENTIFY)
+        return;
+    fis[7] = 0x40;
+    if (command == ATA_CMD_READ_FPDMA_QUEUED || command == ATA_CMD_WRITE_FPDMA_QUEUED) {
+        // Queued commands carry the count in the features registers, and their tag in the count register.
+        fis[3] = count & 0xff;
+        fis[11] = count >> 8;
+        fis[12] = slot << 3;
+    } else {
+        fis[12] = count & 0xff;
+        fis[13] = count >> 8;
+    }
+}
+
+Optional<u8> AHCIDiskDevice::find_free_slot() const
+{
+    for (u8 slot = 0; slot < m_queue_depth; ++slot) {
+        if (!(m_issued_slots & (1u << slot)))
+            return slot;
+    }
+    return {};
+}
+
+bool AHCIDiskDevice::issue(u8 slot)
+{
+    ASSERT(m_slot_lock.is_locked());
+    auto& transfer = m_slot_transfers[slot];
+    u16 count = min(transfer.remaining_count, max_sectors_per_command);
+    size_t length = count * sector_size;
+
+    size_t entry_count = build_prdt(slot, transfer.buffer, length, !transfer.is_write);
+    if (!entry_count) {
+        if (m_bounce_slot.has_value())
+            return false;
+        m_bounce_slot = slot;
+        u8* bounce_buffer = m_bounce_region->vaddr().as_ptr();
+        if (transfer.is_write)
+            memcpy(bounce_buffer, transfer.buffer, length);
+        entry_count = build_prdt(slot, bounce_buffer, length, true);
+        ASSERT(entry_count);
+    }
+
+#ifdef AHCI_DEBUG
+    dbg() << "AHCIDiskDevice: " << (transfer.is_write ? "Writing " : "Reading ") << count << " sectors @ " << transfer.lba << " in slot " << slot;
+#endif
+
+    m_slot_chunk_count[slot] = count;
+    u8 command;
+    if (m_uses_ncq)
+        command = transfer.is_write ? ATA_CMD_WRITE_FPDMA_QUEUED : ATA_CMD_READ_FPDMA_QUEUED;
+    else
+        command = transfer.is_write ? ATA_CMD_WRITE_DMA_EXT : ATA_CMD_READ_DMA_EXT;
+    write_command(slot, command, transfer.lba, count, entry_count, transfer.is_write);
+
+    m_issued_slots |= 1u << slot;
+    if (m_uses_ncq)
+        write_port_register(AHCI_PxSACT, 1u << slot);
+    write_port_register(AHCI_PxCI, 1u << slot);
+    return true;
+}
+
+void AHCIDiskDevice::issue_waiting_transfers()
+{
+    ASSERT(m_slot_lock.is_locked());
+    while (!m_waiting_transfers.is_empty()) {
+        auto slot = find_free_slot();
+        if (!slot.has_value())
+            return;
+        m_slot_transfers[slot.value()] = m_waiting_transfers.take_first();
+        if (!issue(slot.value())) {
+            // It needs the bounce buffer, which is taken. Keep it first in line for when that's free again.
+            m_waiting_transfers.prepend(move(m_slot_transfers[slot.value()]));
+            return;
+        }
+    }
+}
+
+void AHCIDiskDevice::finish_slot(u8 slot, bool success, Vector<Completion, 32>& completions)
+{
+    m_issued_slots &= ~(1u << slot);
+    m_slot_pinned_pages[slot].clear();
+    auto& transfer = m_slot_transfers[slot];
+    size_t length = m_slot_chunk_count[slot] * sector_size;
+    if (m_bounce_slot.has_value() && m_bounce_slot.value() == slot) {
+        if (success && !transfer.is_write)
+            memcpy(transfer.buffer, m_bounce_region->vaddr().as_ptr(), length);
+        m_bounce_slot = {};
+    }
+
+    if (success && m_slot_chunk_count[slot] < transfer.remaining_count) {
+        transfer.remaining_count -= m_slot_chunk_count[slot];
+        transfer.lba += m_slot_chunk_count[slot];
+        transfer.buffer += length;
+        if (!issue(slot))
+            m_waiting_transfers.prepend(move(transfer));
+        return;
+    }
+
+    completions.append({ move(transfer.on_complete), success });
+    transfer = {};
+}
+
+void AHCIDiskDevice::fail_all_slots(Vector<Completion, 32>& completions)
+{
+    // FIXME: With NCQ, the log page for queued errors would tell us which command failed,
+    //        so the others wouldn't have to be failed along with it.
+    stop_port();
+    write_port_register(AHCI_PxSERR, 0xffffffff);
+    write_port_register(AHCI_PxIS, 0xffffffff);
+    for (u8 slot = 0; slot < 32; ++slot) {
+        if (m_issued_slots & (1u << slot))
+            finish_slot(slot, false, completions);
+    }
+    if (!start_port())
+        klog() << "AHCIDiskDevice: Port " << m_port << " didn't come back after an error";
+}
+
+void AHCIDiskDevice::handle_port_interrupt()
+{
+    Vector<Completion, 32> completions;
+    {
+        ScopedSpinLock lock(m_slot_lock);
+        u32 status = read_port_register(AHCI_PxIS);
+        write_port_register(AHCI_PxIS, status);
+        if (status & AHCI_PxIS_ERRORS) {
+            klog() << "AHCIDiskDevice: Error on port " << m_port << ", interrupt status " << String::format("%08x", status) << ", task file " << String::format("%x", read_port_register(AHCI_PxTFD));
+            fail_all_slots(completions);
+        } else {
+            // Queued commands leave the command issue register as soon as they've been sent, and are only done once they're gone from the active register too.
+            u32 finished_slots = m_issued_slots & ~(read_port_register(AHCI_PxCI) | read_port_register(AHCI_PxSACT));
+            for (u8 slot = 0; slot < 32; ++slot) {
+                if (finished_slots & (1u << slot))
+                    finish_slot(slot, true, completions);
+            }
+        }
+        issue_waiting_transfers();
+    }
+    for (auto& completion : completions)
+        completion.on_complete(completion.success);
+}
+
+void AHCIDiskDevice::start_transfer(BlockDeviceRequest::Type type, unsigned index, u16 count, u8* buffer, Function<void(bool success)> on_complete)
+{
+    // The transfer may be continued from the interrupt handler, where only kernel memory is there to be used.
+    ASSERT(!is_user_address(VirtualAddress(buffer)));
+    if (!count || index + count > m_sector_count) {
+        on_complete(!count);
+        return;
+    }
+
+    ScopedSpinLock lock(m_slot_lock);
+    m_waiting_transfers.append({ type == BlockDeviceRequest::Type::Write, index, count, buffer, move(on_complete) });
+    issue_waiting_transfers();
+}
+
+bool AHCIDiskDevice::transfer_and_wait(BlockDeviceRequest::Type type, unsigned index, u16 count, u8* buffer)
+{
+    LOCKER(m_sync_lock);
+    m_sync_done.store(false);
+    start_transfer(type, index, count, buffer, [this](bool success) {
+        m_sync_success = success;
+        m_sync_done.store(true);
+        m_sync_wait_queue.wake_all();
+    });
+    // A wakeup that comes before we're on the wait queue is remembered by it, so this can't miss the interrupt.
+    while (!m_sync_done.load())
+        Thread::current()->wait_on(m_sync_wait_queue, "AHCIDiskDevice");
+    return m_sync_success;
+}
+
+bool AHCIDiskDevice::read_blocks(unsigned index, u16 count, u8* out)
+{
+    return transfer_and_wait(BlockDeviceRequest::Type::Read, index, count, out);
+}
+
+bool AHCIDiskDevice::write_blocks(unsigned index, u16 count, const u8* data)
+{
+    return transfer_and_wait(BlockDeviceRequest::Type::Write, index, count, const_cast<u8*>(data));
+}
+
+KResultOr<size_t> AHCIDiskDevice::read(FileDescription&, size_t offset, u8* outbuf, size_t len)
+{
+    unsigned index = offset / block_size();
+    size_t whole_blocks = len / block_size();
+    ssize_t remaining = len % block_size();
+
+    // Larger requests get a short read, and the caller comes back for the rest.
+    size_t max_blocks_per_request = max_merged_request_size / block_size();
+    if (whole_blocks >= max_blocks_per_request) {
+        whole_blocks = max_blocks_per_request;
+        remaining = 0;
+    }
+
+    if (whole_blocks > 0) {
+        if (!submit_request_and_wait(BlockDeviceRequest::Type::Read, index, whole_blocks, outbuf))
+            return KResult(-EIO);
+    }
+
+    off_t pos = whole_blocks * block_size();
+
+    if (remaining > 0) {
+        auto buf = ByteBuffer::create_uninitialized(block_size());
+        if (!submit_request_and_wait(BlockDeviceRequest::Type::Read, index + whole_blocks, 1, buf.data()))
+            return pos;
+        memcpy(&outbuf[pos], buf.data(), remaining);
+    }
+
+    return pos + remaining;
+}
+
+bool AHCIDiskDevice::can_read(const FileDescription&, size_t offset) const
+{
+    return offset < m_sector_count * block_size();
+}
+
+KResultOr<size_t> AHCIDiskDevice::write(FileDescription&, size_t offset, const u8* inbuf, size_t len)
+{
+    unsigned index = offset / block_size();
+    size_t whole_blocks = len / block_size();
+    ssize_t remaining = len % block_size();
+
+    // Larger requests get a short write, and the caller comes back for the rest.
+    size_t max_blocks_per_request = max_merged_request_size / block_size();
+    if (whole_blocks >= max_blocks_per_request) {
+        whole_blocks = max_blocks_per_request;
+        remaining = 0;
+    }
+
+    if (whole_blocks > 0) {
+        if (!submit_request_and_wait(BlockDeviceRequest::Type::Write, index, whole_blocks, const_cast<u8*>(inbuf)))
+            return KResult(-EIO);
+    }
+
+    off_t pos = whole_blocks * block_size();
+
+    // A partial block has to be read, modified and written back whole.
+    if (remaining > 0) {
+        auto buf = ByteBuffer::create_zeroed(block_size());
+        if (!submit_request_and_wait(BlockDeviceRequest::Type::Read, index + whole_blocks, 1, buf.data()))
+            return pos;
+        memcpy(buf.data(), &inbuf[pos], remaining);
+        if (!submit_request_and_wait(BlockDeviceRequest::Type::Write, index + whole_blocks, 1, buf.data()))
+            return pos;
+    }
+
+    return pos + remaining;
+}
+
+bool AHCIDiskDevice::can_write(const FileDescription&, size_t offset) const
+{
+    return offset < m_sector_count * block_size();
+}
+
+}
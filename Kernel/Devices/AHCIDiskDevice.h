@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) 2020, The SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+//
+// A SATA disk on a port of an AHCI controller
+//
+
+#pragma once
+
+#include <AK/Atomic.h>
+#include <AK/Function.h>
+#include <AK/NonnullRefPtrVector.h>
+#include <AK/OwnPtr.h>
+#include <AK/Vector.h>
+#include <Kernel/Devices/BlockDevice.h>
+#include <Kernel/Lock.h>
+#include <Kernel/SpinLock.h>
+#include <Kernel/VM/PhysicalPage.h>
+#include <Kernel/VM/Region.h>
+#include <Kernel/WaitQueue.h>
+
+namespace Kernel {
+
+class AHCIController;
+
+class AHCIDiskDevice final : public BlockDevice {
+public:
+    static RefPtr<AHCIDiskDevice> create(AHCIController&, u8 port, unsigned minor);
+    virtual ~AHCIDiskDevice() override;
+
+    // Called by the controller when this port has raised an interrupt.
+    void handle_port_interrupt();
+
+    // ^BlockDevice
+    virtual bool read_blocks(unsigned index, u16 count, u8*) override;
+    virtual bool write_blocks(unsigned index, u16 count, const u8*) override;
+    virtual size_t max_transfers_in_flight() const override { return m_uses_ncq ? m_queue_depth : 1; }
+    virtual void start_transfer(BlockDeviceRequest::Type, unsigned index, u16 count, u8* buffer, Function<void(bool success)> on_complete) override;
+    virtual KResultOr<size_t> read(FileDescription&, size_t, u8*, size_t) override;
+    virtual bool can_read(const FileDescription&, size_t) const override;
+    virtual KResultOr<size_t> write(FileDescription&, size_t, const u8*, size_t) override;
+    virtual bool can_write(const FileDescription&, size_t) const override;
+
+private:
+    AHCIDiskDevice(AHCIController&, u8 port, unsigned minor);
+
+    // ^Device
+    virtual const char* class_name() const override { return "AHCIDiskDevice"; }
+
+    struct Transfer {
+        bool is_write { false };
+        u64 lba { 0 };
+        u16 remaining_count { 0 };
+        u8* buffer { nullptr };
+        Function<void(bool success)> on_complete;
+    };
+
+    struct Completion {
+        Function<void(bool success)> on_complete;
+        bool success { false };
+    };
+
+    bool initialize();
+    bool identify();
+    void stop_port();
+    bool start_port();
+
+    u32 read_port_register(size_t offset) const;
+    void write_port_register(size_t offset, u32 value);
+
+    Optional<u8> find_free_slot() const;
+    u8* command_table(u8 slot) const;
+    bool issue(u8 slot);
+    void issue_waiting_transfers();
+    size_t build_prdt(u8 slot, u8* buffer, size_t length, bool device_writes_memory);
+    void write_command(u8 slot, u8 command, u64 lba, u16 count, size_t prdt_entry_count, bool is_write);
+    void finish_slot(u8 slot, bool success, Vector<Completion, 32>&);
+    void fail_all_slots(Vector<Completion, 32>&);
+
+    bool transfer_and_wait(BlockDeviceRequest::Type, unsigned index, u16 count, u8* buffer);
+
+    AHCIController& m_controller;
+    u8 m_port { 0 };
+
+    // The command list and received FIS area share a page, and each slot has a command table with its PRDT in another region.
+    OwnPtr<Region> m_command_list_region;
+    OwnPtr<Region> m_command_table_region;
+    // For buffers that can't be handed to the controller directly. Only one slot can use it at a time.
+    OwnPtr<Region> m_bounce_region;
+
+    u64 m_sector_count { 0 };
+    bool m_uses_ncq { false };
+    size_t m_queue_depth { 1 };
+
+    SpinLock<u8> m_slot_lock;
+    u32 m_issued_slots { 0 };
+    Transfer m_slot_transfers[32];
+    u16 m_slot_chunk_count[32] {};
+    // Any userspace pages a slot's PRDT points at, kept alive until the slot finishes.
+    NonnullRefPtrVector<PhysicalPage> m_slot_pinned_pages[32];
+    Optional<u8> m_bounce_slot;
+    Vector<Transfer, 32> m_waiting_transfers;
+
+    // read_blocks() and write_blocks() take turns, and wait for their transfer to come back on this.
+    Lock m_sync_lock { "AHCIDiskDevice" };
+    WaitQueue m_sync_wait_queue;
+    Atomic<bool> m_sync_done { false };
+    bool m_sync_success { false };
+};
+
+}
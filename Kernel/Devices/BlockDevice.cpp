@@ -24,10 +24,33 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <AK/RefCounted.h>
 #include <Kernel/Devices/BlockDevice.h>
+#include <Kernel/Tasks/BlockIOTask.h>
+#include <Kernel/Thread.h>
+#include <Kernel/VM/MemoryManager.h>
+#include <Kernel/WaitQueue.h>
+
+//#define BLOCK_DEVICE_REQUEST_DEBUG
 
 namespace Kernel {
 
+static Lock* s_devices_with_pending_requests_lock;
+static Vector<RefPtr<BlockDevice>>* s_devices_with_pending_requests;
+
+struct InFlightBlockTransfer {
+    NonnullRefPtr<BlockDevice> device;
+    Vector<NonnullOwnPtr<BlockDeviceRequest>> batch;
+    unsigned block_index { 0 };
+    OwnPtr<KBuffer> merge_buffer;
+    bool success { false };
+    InFlightBlockTransfer* next_completed { nullptr };
+};
+
+// Transfers the devices have finished, from whatever context, waiting for the BlockIOTask to wrap them up.
+static SpinLock<u8> s_completed_transfers_lock;
+static InFlightBlockTransfer* s_completed_transfers;
+
 BlockDevice::~BlockDevice()
 {
 }
@@ -62,4 +85,350 @@ bool BlockDevice::write_raw(u32 offset, unsigned length, const u8* in)
     return write_blocks(first_block, end_block - first_block, in);
 }
 
+void BlockDevice::submit_request(NonnullOwnPtr<BlockDeviceRequest> request)
+{
+    ASSERT(request->block_count() > 0);
+    {
+        LOCKER(m_request_queue_lock);
+        request->m_sequence_number = m_next_sequence_number++;
+        request->m_dispatch_deadline = m_dispatch_count + max_dispatches_before_deadline;
+
+        // Keep the queue sorted by block index. Requests for the same block stay in submission order.
+        size_t insertion_index = m_pending_requests.size();
+        while (insertion_index > 0 && m_pending_requests[insertion_index - 1]->block_index() > request->block_index())
+            --insertion_index;
+        m_pending_requests.insert(insertion_index, move(request));
+
+        if (m_is_scheduled_for_dispatch)
+            return;
+        m_is_scheduled_for_dispatch = true;
+    }
+
+    if (!BlockIOTask::is_running()) {
+        // Nobody to hand the request to yet, so carry it out right here.
+        while (dispatch_next_request())
+            ;
+        return;
+    }
+
+    schedule_for_dispatch();
+}
+
+void BlockDevice::schedule_for_dispatch()
+{
+    if (!s_devices_with_pending_requests_lock) {
+        s_devices_with_pending_requests_lock = new Lock("BlockDevicesWithPendingRequests");
+        s_devices_with_pending_requests = new Vector<RefPtr<BlockDevice>>;
+    }
+    {
+        LOCKER(*s_devices_with_pending_requests_lock);
+        s_devices_with_pending_requests->append(this);
+    }
+    BlockIOTask::wake();
+}
+
+void BlockDevice::start_transfer(BlockDeviceRequest::Type, unsigned, u16, u8*, Function<void(bool)>)
+{
+    ASSERT_NOT_REACHED();
+}
+
+struct BlockDeviceRequestWaiter : public RefCounted<BlockDeviceRequestWaiter> {
+    WaitQueue wait_queue;
+    Atomic<bool> done { false };
+    bool success { false };
+};
+
+bool BlockDevice::submit_request_and_wait(BlockDeviceRequest::Type type, unsigned index, u16 count, u8* buffer)
+{
+    // Kernel buffers are handed to the BlockIOTask as they are. It runs in a different address space though,
+    // so userspace buffers have to go through a bounce buffer, one merge-sized chunk at a time.
+    if (!is_user_address(VirtualAddress(buffer)))
+        return submit_kernel_request_and_wait(type, index, count, buffer);
+
+    ASSERT(block_size() <= max_merged_request_size);
+    u16 blocks_per_chunk = max_merged_request_size / block_size();
+    auto bounce_buffer = take_bounce_buffer();
+    bool success = true;
+    for (u16 done = 0; success && done < count;) {
+        u16 chunk_count = min<u16>(count - done, blocks_per_chunk);
+        u8* chunk = buffer + done * block_size();
+        size_t chunk_size = chunk_count * block_size();
+        if (type == BlockDeviceRequest::Type::Write)
+            copy_from_user(bounce_buffer->data(), chunk, chunk_size);
+        success = submit_kernel_request_and_wait(type, index + done, chunk_count, bounce_buffer->data());
+        if (success && type == BlockDeviceRequest::Type::Read)
+            copy_to_user(chunk, bounce_buffer->data(), chunk_size);
+        done += chunk_count;
+    }
+    return_bounce_buffer(move(bounce_buffer));
+    return success;
+}
+
+bool BlockDevice::submit_kernel_request_and_wait(BlockDeviceRequest::Type type, unsigned index, u16 count, u8* buffer)
+{
+    auto waiter = adopt(*new BlockDeviceRequestWaiter);
+    submit_request(make<BlockDeviceRequest>(type, index, count, buffer, [waiter, &state = *waiter](bool success) {
+        state.success = success;
+        state.done.store(true);
+        state.wait_queue.wake_all();
+    }));
+
+    while (!waiter->done.load())
+        Thread::current()->wait_on(waiter->wait_queue, "BlockDevice");
+    return waiter->success;
+}
+
+NonnullOwnPtr<KBuffer> BlockDevice::take_bounce_buffer()
+{
+    {
+        LOCKER(m_bounce_buffer_lock);
+        if (!m_spare_bounce_buffers.is_empty())
+            return m_spare_bounce_buffers.take_last();
+    }
+    return make<KBuffer>(KBuffer::create_with_size(max_merged_request_size, Region::Access::Read | Region::Access::Write, "BlockDevice bounce"));
+}
+
+void BlockDevice::return_bounce_buffer(NonnullOwnPtr<KBuffer> bounce_buffer)
+{
+    LOCKER(m_bounce_buffer_lock);
+    m_spare_bounce_buffers.append(move(bounce_buffer));
+}
+
+void BlockDevice::dispatch_all_pending_requests()
+{
+    for (;;) {
+        finish_completed_transfers();
+        if (!s_devices_with_pending_requests_lock)
+            return;
+
+        Vector<RefPtr<BlockDevice>> devices;
+        {
+            LOCKER(*s_devices_with_pending_requests_lock);
+            if (s_devices_with_pending_requests->is_empty())
+                return;
+            devices = move(*s_devices_with_pending_requests);
+            s_devices_with_pending_requests->clear();
+        }
+        // Take turns between devices so that one busy disk can't hold up the others.
+        for (;;) {
+            bool any_dispatched = false;
+            for (auto& device : devices) {
+                if (device && device->dispatch_next_request())
+                    any_dispatched = true;
+                else
+                    device = nullptr;
+            }
+            if (!any_dispatched)
+                break;
+        }
+    }
+}
+
+Optional<size_t> BlockDevice::find_earlier_conflicting_request(size_t index) const
+{
+    auto& request = *m_pending_requests[index];
+    Optional<size_t> conflict;
+    for (size_t i = 0; i < m_pending_requests.size(); ++i) {
+        auto& other = *m_pending_requests[i];
+        if (other.m_sequence_number >= request.m_sequence_number || !other.overlaps(request))
+            continue;
+        if (other.type() == BlockDeviceRequest::Type::Read && request.type() == BlockDeviceRequest::Type::Read)
+            continue;
+        if (!conflict.has_value() || other.m_sequence_number < m_pending_requests[conflict.value()]->m_sequence_number)
+            conflict = i;
+    }
+    return conflict;
+}
+
+size_t BlockDevice::pick_next_request() const
+{
+    ASSERT(m_request_queue_lock.is_locked());
+    ASSERT(!m_pending_requests.is_empty());
+
+    // Requests that have waited too long go first, oldest first.
+    Optional<size_t> expired;
+    for (size_t i = 0; i < m_pending_requests.size(); ++i) {
+        auto& request = *m_pending_requests[i];
+        if ((i32)(m_dispatch_count - request.m_dispatch_deadline) < 0)
+            continue;
+        if (!expired.has_value() || request.m_sequence_number < m_pending_requests[expired.value()]->m_sequence_number)
+            expired = i;
+    }
+
+    size_t index = 0;
+    if (expired.has_value()) {
+        index = expired.value();
+    } else {
+        // C-LOOK: keep sweeping upwards from where the head is, then jump back to the lowest request.
+        for (size_t i = 0; i < m_pending_requests.size(); ++i) {
+            if (m_pending_requests[i]->block_index() >= m_head_position) {
+                index = i;
+                break;
+            }
+        }
+    }
+
+    // Never let a request overtake an earlier one that touches the same blocks, unless both are reads.
+    for (;;) {
+        auto conflict = find_earlier_conflicting_request(index);
+        if (!conflict.has_value())
+            break;
+        index = conflict.value();
+    }
+    return index;
+}
+
+void BlockDevice::finish_completed_transfers()
+{
+    InFlightBlockTransfer* completed;
+    {
+        ScopedSpinLock lock(s_completed_transfers_lock);
+        completed = s_completed_transfers;
+        s_completed_transfers = nullptr;
+    }
+    while (completed) {
+        auto* transfer = completed;
+        completed = transfer->next_completed;
+        auto device = transfer->device;
+        device->finish_transfer(adopt_own(*transfer));
+    }
+}
+
+void BlockDevice::finish_transfer(NonnullOwnPtr<InFlightBlockTransfer> transfer)
+{
+    if (transfer->merge_buffer) {
+        LOCKER(m_dispatch_lock);
+        bool is_write = transfer->batch.first()->type() == BlockDeviceRequest::Type::Write;
+        if (!is_write && transfer->success) {
+            u8* data = transfer->merge_buffer->data();
+            for (auto& request : transfer->batch)
+                memcpy(request->buffer(), data + (request->block_index() - transfer->block_index) * block_size(), request->block_count() * block_size());
+        }
+        m_spare_merge_buffers.append(transfer->merge_buffer.release_nonnull());
+    }
+
+    for (auto& request : transfer->batch)
+        request->complete(transfer->success);
+
+    bool has_pending_requests;
+    {
+        LOCKER(m_request_queue_lock);
+        ASSERT(m_transfers_in_flight);
+        --m_transfers_in_flight;
+        has_pending_requests = !m_pending_requests.is_empty();
+    }
+    // We may have been passed over for being too busy, so make sure the rest of the queue gets its turn.
+    if (has_pending_requests)
+        schedule_for_dispatch();
+}
+
+bool BlockDevice::dispatch_next_request()
+{
+    // Without the BlockIOTask to wrap them up, transfers have to be carried out one at a time.
+    bool asynchronous = max_transfers_in_flight() > 1 && BlockIOTask::is_running();
+
+    LOCKER(m_dispatch_lock);
+
+    Vector<NonnullOwnPtr<BlockDeviceRequest>> batch;
+    {
+        LOCKER(m_request_queue_lock);
+        if (m_pending_requests.is_empty()) {
+            m_is_scheduled_for_dispatch = false;
+            return false;
+        }
+
+        // The device has as much as it can take already. Finishing one of those transfers schedules us again.
+        if (asynchronous && m_transfers_in_flight >= max_transfers_in_flight())
+            return false;
+
+        size_t index = pick_next_request();
+        size_t max_blocks = min(max_merged_request_size / block_size(), (size_t)0xffff);
+        auto type = m_pending_requests[index]->type();
+        unsigned end_block_index = m_pending_requests[index]->end_block_index();
+        size_t block_count = m_pending_requests[index]->block_count();
+        batch.append(m_pending_requests.take(index));
+
+        // Merge in any requests of the same kind that pick up where this one ends.
+        while (index < m_pending_requests.size()) {
+            auto& next = *m_pending_requests[index];
+            if (next.block_index() > end_block_index)
+                break;
+            if (next.block_index() != end_block_index || next.type() != type || block_count + next.block_count() > max_blocks || find_earlier_conflicting_request(index).has_value()) {
+                ++index;
+                continue;
+            }
+            end_block_index = next.end_block_index();
+            block_count += next.block_count();
+            batch.append(m_pending_requests.take(index));
+        }
+
+        m_head_position = end_block_index;
+        ++m_dispatch_count;
+        if (asynchronous)
+            ++m_transfers_in_flight;
+    }
+
+    auto& first = *batch.first();
+    unsigned block_index = first.block_index();
+    u16 block_count = batch.last()->end_block_index() - block_index;
+    bool is_write = first.type() == BlockDeviceRequest::Type::Write;
+
+#ifdef BLOCK_DEVICE_REQUEST_DEBUG
+    dbg() << "BlockDevice: dispatching " << (is_write ? "write" : "read") << " of " << block_count << " block(s) at " << block_index << " merged from " << batch.size() << " request(s)";
+#endif
+
+    if (asynchronous) {
+        auto transfer = make<InFlightBlockTransfer>(InFlightBlockTransfer { *this, {}, block_index, nullptr, false, nullptr });
+        u8* data = first.buffer();
+        if (batch.size() > 1) {
+            if (!m_spare_merge_buffers.is_empty())
+                transfer->merge_buffer = m_spare_merge_buffers.take_last();
+            else
+                transfer->merge_buffer = make<KBuffer>(KBuffer::create_with_size(max_merged_request_size, Region::Access::Read | Region::Access::Write, "BlockDevice merge"));
+            data = transfer->merge_buffer->data();
+            if (is_write) {
+                for (auto& request : batch)
+                    memcpy(data + (request->block_index() - block_index) * block_size(), request->buffer(), request->block_count() * block_size());
+            }
+        }
+        auto type = first.type();
+        transfer->batch = move(batch);
+        auto* transfer_ptr = transfer.leak_ptr();
+        start_transfer(type, block_index, block_count, data, [transfer_ptr](bool success) {
+            transfer_ptr->success = success;
+            {
+                ScopedSpinLock lock(s_completed_transfers_lock);
+                transfer_ptr->next_completed = s_completed_transfers;
+                s_completed_transfers = transfer_ptr;
+            }
+            BlockIOTask::wake();
+        });
+        return true;
+    }
+
+    bool success;
+    if (batch.size() == 1) {
+        success = is_write ? write_blocks(block_index, block_count, first.buffer()) : read_blocks(block_index, block_count, first.buffer());
+    } else {
+        if (!m_merge_buffer)
+            m_merge_buffer = make<KBuffer>(KBuffer::create_with_size(max_merged_request_size, Region::Access::Read | Region::Access::Write, "BlockDevice merge"));
+        u8* data = m_merge_buffer->data();
+        if (is_write) {
+            for (auto& request : batch)
+                memcpy(data + (request->block_index() - block_index) * block_size(), request->buffer(), request->block_count() * block_size());
+            success = write_blocks(block_index, block_count, data);
+        } else {
+            success = read_blocks(block_index, block_count, data);
+            if (success) {
+                for (auto& request : batch)
+                    memcpy(request->buffer(), data + (request->block_index() - block_index) * block_size(), request->block_count() * block_size());
+            }
+        }
+    }
+
+    for (auto& request : batch)
+        request->complete(success);
+    return true;
+}
+
 }
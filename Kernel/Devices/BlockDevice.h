@@ -26,10 +26,66 @@
 
 #pragma once
 
+#include <AK/Function.h>
+#include <AK/NonnullOwnPtr.h>
+#include <AK/OwnPtr.h>
+#include <AK/Vector.h>
 #include <Kernel/Devices/Device.h>
+#include <Kernel/KBuffer.h>
+#include <Kernel/Lock.h>
 
 namespace Kernel {
 
+class BlockDeviceRequest {
+    AK_MAKE_NONCOPYABLE(BlockDeviceRequest);
+    AK_MAKE_NONMOVABLE(BlockDeviceRequest);
+
+public:
+    enum class Type {
+        Read,
+        Write,
+    };
+
+    BlockDeviceRequest(Type type, unsigned block_index, u16 block_count, u8* buffer, Function<void(bool success)> completion)
+        : m_type(type)
+        , m_block_index(block_index)
+        , m_block_count(block_count)
+        , m_buffer(buffer)
+        , m_completion(move(completion))
+    {
+    }
+
+    Type type() const { return m_type; }
+    unsigned block_index() const { return m_block_index; }
+    unsigned end_block_index() const { return m_block_index + m_block_count; }
+    u16 block_count() const { return m_block_count; }
+    u8* buffer() { return m_buffer; }
+
+    bool overlaps(const BlockDeviceRequest& other) const
+    {
+        return m_block_index < other.end_block_index() && other.block_index() < end_block_index();
+    }
+
+    void complete(bool success)
+    {
+        if (m_completion)
+            m_completion(success);
+    }
+
+private:
+    friend class BlockDevice;
+
+    Type m_type;
+    unsigned m_block_index { 0 };
+    u16 m_block_count { 0 };
+    u8* m_buffer { nullptr };
+    Function<void(bool success)> m_completion;
+    u32 m_sequence_number { 0 };
+    u32 m_dispatch_deadline { 0 };
+};
+
+struct InFlightBlockTransfer;
+
 class BlockDevice : public Device {
 public:
     virtual ~BlockDevice() override;
@@ -45,6 +101,23 @@ public:
     virtual bool read_blocks(unsigned index, u16 count, u8*) = 0;
     virtual bool write_blocks(unsigned index, u16 count, const u8*) = 0;
 
+    // Devices that can keep several transfers going at once (like AHCI disks with native command queuing) override
+    // these, so the BlockIOTask can hand them more work without waiting for what it gave them before.
+    // start_transfer() mustn't block, and on_complete may be called from an interrupt handler.
+    virtual size_t max_transfers_in_flight() const { return 1; }
+    virtual void start_transfer(BlockDeviceRequest::Type, unsigned index, u16 count, u8* buffer, Function<void(bool success)> on_complete);
+
+    // Requests are queued and carried out by the BlockIOTask, which sorts them by block index
+    // and merges adjacent ones. The completion is called from that task, so it mustn't block.
+    void submit_request(NonnullOwnPtr<BlockDeviceRequest>);
+    bool submit_request_and_wait(BlockDeviceRequest::Type, unsigned index, u16 count, u8* buffer);
+
+    static void dispatch_all_pending_requests();
+
+    // A request may be passed over this many times by the elevator before it's dispatched regardless of position.
+    static constexpr u32 max_dispatches_before_deadline = 32;
+    static constexpr size_t max_merged_request_size = 128 * KB;
+
 protected:
     BlockDevice(unsigned major, unsigned minor, size_t block_size = PAGE_SIZE)
         : Device(major, minor)
@@ -55,7 +128,36 @@ protected:
 private:
     virtual bool is_block_device() const final { return true; }
 
+    bool submit_kernel_request_and_wait(BlockDeviceRequest::Type, unsigned index, u16 count, u8* buffer);
+    NonnullOwnPtr<KBuffer> take_bounce_buffer();
+    void return_bounce_buffer(NonnullOwnPtr<KBuffer>);
+
+    bool dispatch_next_request();
+    static void finish_completed_transfers();
+    void finish_transfer(NonnullOwnPtr<InFlightBlockTransfer>);
+    void schedule_for_dispatch();
+    size_t pick_next_request() const;
+    Optional<size_t> find_earlier_conflicting_request(size_t) const;
+
     size_t m_block_size { 0 };
+
+    Lock m_request_queue_lock { "BlockDeviceRequestQueue" };
+    Vector<NonnullOwnPtr<BlockDeviceRequest>> m_pending_requests;
+    bool m_is_scheduled_for_dispatch { false };
+    u32 m_next_sequence_number { 0 };
+    u32 m_dispatch_count { 0 };
+    unsigned m_head_position { 0 };
+
+    size_t m_transfers_in_flight { 0 };
+
+    Lock m_dispatch_lock { "BlockDeviceDispatch" };
+    OwnPtr<KBuffer> m_merge_buffer;
+    // Merge buffers of finished asynchronous transfers, kept for the next ones.
+    Vector<NonnullOwnPtr<KBuffer>> m_spare_merge_buffers;
+
+    Lock m_bounce_buffer_lock { "BlockDeviceBounce" };
+    // Bounce buffers for userspace transfers, kept for the next ones.
+    Vector<NonnullOwnPtr<KBuffer>> m_spare_bounce_buffers;
 };
 
 }
@@ -110,6 +110,11 @@ bool DiskPartition::write_blocks(unsigned index, u16 count, const u8* data)
     return m_device->write_blocks(m_block_offset + index, count, data);
 }
 
+void DiskPartition::start_transfer(BlockDeviceRequest::Type type, unsigned index, u16 count, u8* buffer, Function<void(bool success)> on_complete)
+{
+    m_device->start_transfer(type, m_block_offset + index, count, buffer, move(on_complete));
+}
+
 const char* DiskPartition::class_name() const
 {
     return "DiskPartition";
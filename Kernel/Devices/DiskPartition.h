@@ -38,6 +38,8 @@ public:
 
     virtual bool read_blocks(unsigned index, u16 count, u8*) override;
     virtual bool write_blocks(unsigned index, u16 count, const u8*) override;
+    virtual size_t max_transfers_in_flight() const override { return m_device->max_transfers_in_flight(); }
+    virtual void start_transfer(BlockDeviceRequest::Type, unsigned index, u16 count, u8* buffer, Function<void(bool success)> on_complete) override;
 
     // ^BlockDevice
     virtual KResultOr<size_t> read(FileDescription&, size_t, u8*, size_t) override;
@@ -279,58 +279,80 @@ void KeyboardDevice::key_state_changed(u8 scan_code, bool pressed)
 
 void KeyboardDevice::handle_irq(const RegisterState&)
 {
+    // Only drain the controller here. Everything else, including switching virtual consoles,
+    // happens in process_scancodes() once we're out of the interrupt handler.
     for (;;) {
         u8 status = IO::in8(I8042_STATUS);
         if (!(((status & I8042_WHICH_BUFFER) == I8042_KEYBOARD_BUFFER) && (status & I8042_BUFFER_FULL)))
-            return;
+            break;
         u8 raw = IO::in8(I8042_BUFFER);
-        u8 ch = raw & 0x7f;
-        bool pressed = !(raw & 0x80);
-
         m_entropy_source.add_random_event(raw);
+        m_scancodes.enqueue(raw);
+    }
+    if (!m_scancodes.is_empty())
+        m_scancode_work.schedule_on_this_processor();
+}
 
-        if (raw == 0xe0) {
-            m_has_e0_prefix = true;
-            return;
+void KeyboardDevice::process_scancodes()
+{
+    for (;;) {
+        u8 raw;
+        {
+            InterruptDisabler disabler;
+            if (m_scancodes.is_empty())
+                return;
+            raw = m_scancodes.dequeue();
         }
+        process_scancode(raw);
+    }
+}
+
+void KeyboardDevice::process_scancode(u8 raw)
+{
+    u8 ch = raw & 0x7f;
+    bool pressed = !(raw & 0x80);
+
+    if (raw == 0xe0) {
+        m_has_e0_prefix = true;
+        return;
+    }
 
 #ifdef KEYBOARD_DEBUG
-        dbg() << "Keyboard::handle_irq: " << String::format("%b", ch) << " " << (pressed ? "down" : "up");
+    dbg() << "Keyboard::process_scancode: " << String::format("%b", ch) << " " << (pressed ? "down" : "up");
 #endif
-        switch (ch) {
-        case 0x38:
-            if (m_has_e0_prefix)
-                update_modifier(Mod_AltGr, pressed);
-            else
-                update_modifier(Mod_Alt, pressed);
-            break;
-        case 0x1d:
-            update_modifier(Mod_Ctrl, pressed);
-            break;
-        case 0x5b:
-            update_modifier(Mod_Logo, pressed);
-            break;
-        case 0x2a:
-        case 0x36:
-            update_modifier(Mod_Shift, pressed);
-            break;
-        }
-        switch (ch) {
-        case I8042_ACK:
-            break;
-        default:
-            if (m_modifiers & Mod_Alt) {
-                switch (ch) {
-                case 0x02 ... 0x07: // 1 to 6
-                    VirtualConsole::switch_to(ch - 0x02);
-                    break;
-                default:
-                    key_state_changed(ch, pressed);
-                    break;
-                }
-            } else {
+    switch (ch) {
+    case 0x38:
+        if (m_has_e0_prefix)
+            update_modifier(Mod_AltGr, pressed);
+        else
+            update_modifier(Mod_Alt, pressed);
+        break;
+    case 0x1d:
+        update_modifier(Mod_Ctrl, pressed);
+        break;
+    case 0x5b:
+        update_modifier(Mod_Logo, pressed);
+        break;
+    case 0x2a:
+    case 0x36:
+        update_modifier(Mod_Shift, pressed);
+        break;
+    }
+    switch (ch) {
+    case I8042_ACK:
+        break;
+    default:
+        if (m_modifiers & Mod_Alt) {
+            switch (ch) {
+            case 0x02 ... 0x07: // 1 to 6
+                VirtualConsole::switch_to(ch - 0x02);
+                break;
+            default:
                 key_state_changed(ch, pressed);
+                break;
             }
+        } else {
+            key_state_changed(ch, pressed);
         }
     }
 }
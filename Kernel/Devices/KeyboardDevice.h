@@ -33,6 +33,7 @@
 #include <Kernel/Interrupts/IRQHandler.h>
 #include <Kernel/API/KeyCode.h>
 #include <Kernel/Random.h>
+#include <Kernel/WorkQueue.h>
 #include <LibKeyboard/CharacterMap.h>
 
 namespace Kernel {
@@ -70,6 +71,8 @@ private:
     // ^CharacterDevice
     virtual const char* class_name() const override { return "KeyboardDevice"; }
 
+    void process_scancodes();
+    void process_scancode(u8 raw);
     void key_state_changed(u8 raw, bool pressed);
     void update_modifier(u8 modifier, bool state)
     {
@@ -81,6 +84,9 @@ private:
 
     KeyboardClient* m_client { nullptr };
     CircularQueue<Event, 16> m_queue;
+    // Filled by the IRQ handler, drained by m_scancode_work.
+    CircularQueue<u8, 32> m_scancodes;
+    DeferredWork m_scancode_work { [this] { process_scancodes(); } };
     u8 m_modifiers { 0 };
     bool m_caps_lock_on { false };
     bool m_num_lock_on { false };
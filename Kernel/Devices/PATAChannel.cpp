@@ -165,11 +165,71 @@ void PATAChannel::initialize(bool force_pio)
     // Let's try to set up DMA transfers.
     PCI::enable_bus_mastering(pci_address());
     m_prdt_page = MM.allocate_supervisor_physical_page();
-    prdt().end_of_table = 0x8000;
-    m_dma_buffer_page = MM.allocate_supervisor_physical_page();
+    m_dma_buffer_pages = MM.allocate_contiguous_supervisor_physical_pages(max_sectors_per_request * 512);
     klog() << "PATAChannel: Bus master IDE: " << m_bus_master_base;
 }
 
+bool PATAChannel::append_to_prdt(size_t& entry_count, PhysicalAddress paddr, size_t length)
+{
+    // A single region can't be larger than 64 KiB, and it can't cross a 64 KiB boundary.
+    // A size of 0 means 64 KiB.
+    auto region_size = [](const PhysicalRegionDescriptor& region) -> size_t { return region.size ? region.size : 0x10000; };
+    while (length) {
+        size_t chunk = min(length, 0x10000 - (paddr.get() & 0xffff));
+        if (entry_count) {
+            auto& last = prdt()[entry_count - 1];
+            size_t last_size = region_size(last);
+            if (last.offset.get() + last_size == paddr.get() && (last.offset.get() & ~0xffff) == ((paddr.get() + chunk - 1) & ~0xffff)) {
+                last.size = (u16)(last_size + chunk);
+                paddr = paddr.offset(chunk);
+                length -= chunk;
+                continue;
+            }
+        }
+        if (entry_count == max_prdt_entries)
+            return false;
+        auto& region = prdt()[entry_count++];
+        region.offset = paddr;
+        region.size = (u16)chunk;
+        region.end_of_table = 0;
+        paddr = paddr.offset(chunk);
+        length -= chunk;
+    }
+    return true;
+}
+
+bool PATAChannel::build_prdt_for_buffer(const u8* buffer, size_t length, bool device_writes_memory)
+{
+    // The bus master can only transfer to and from word-aligned memory.
+    if ((FlatPtr)buffer & 1)
+        return false;
+
+    size_t entry_count = 0;
+    auto vaddr = VirtualAddress(buffer);
+    m_dma_pinned_pages.clear();
+    while (length) {
+        size_t chunk = min(length, PAGE_SIZE - (vaddr.get() & ~PAGE_MASK));
+        auto paddr = MM.physical_address_for_dma(vaddr, device_writes_memory, m_dma_pinned_pages);
+        if (!paddr.has_value() || !append_to_prdt(entry_count, paddr.value(), chunk)) {
+            m_dma_pinned_pages.clear();
+            return false;
+        }
+        vaddr = vaddr.offset(chunk);
+        length -= chunk;
+    }
+    prdt()[entry_count - 1].end_of_table = 0x8000;
+    return true;
+}
+
+void PATAChannel::build_prdt_for_bounce_buffer(size_t length)
+{
+    ASSERT(length <= max_sectors_per_request * 512);
+    size_t entry_count = 0;
+    bool success = append_to_prdt(entry_count, m_dma_buffer_pages.first().paddr(), length);
+    ASSERT(success);
+    prdt()[entry_count - 1].end_of_table = 0x8000;
+}
+
 static void print_ide_status(u8 status)
 {
     klog() << "PATAChannel: print_ide_status: DRQ=" << ((status & ATA_SR_DRQ) != 0) << " BSY=" << ((status & ATA_SR_BSY) != 0) << " DRDY=" << ((status & ATA_SR_DRDY) != 0) << " DSC=" << ((status & ATA_SR_DSC) != 0) << " DF=" << ((status & ATA_SR_DF) != 0) << " CORR=" << ((status & ATA_SR_CORR) != 0) << " IDX=" << ((status & ATA_SR_IDX) != 0) << " ERR=" << ((status & ATA_SR_ERR) != 0);
@@ -281,10 +341,10 @@ bool PATAChannel::ata_read_sectors_with_dma(u32 lba, u16 count, u8* outbuf, bool
     dbg() << "PATAChannel::ata_read_sectors_with_dma (" << lba << " x" << count << ") -> " << outbuf;
 #endif
 
-    prdt().offset = m_dma_buffer_page->paddr();
-    prdt().size = 512 * count;
-
-    ASSERT(prdt().size <= PAGE_SIZE);
+    ASSERT(count && count <= max_sectors_per_request);
+    bool use_bounce_buffer = !build_prdt_for_buffer(outbuf, 512 * count, true);
+    if (use_bounce_buffer)
+        build_prdt_for_bounce_buffer(512 * count);
 
     // Stop bus master
     m_bus_master_base.out<u8>(0);
@@ -307,12 +367,13 @@ bool PATAChannel::ata_read_sectors_with_dma(u32 lba, u16 count, u8* outbuf, bool
 
     m_io_base.offset(ATA_REG_FEATURES).out<u16>(0);
 
-    m_io_base.offset(ATA_REG_SECCOUNT0).out<u8>(0);
+    // For 48-bit commands, the high bytes of the sector count and LBA are written first.
+    m_io_base.offset(ATA_REG_SECCOUNT0).out<u8>(count >> 8);
     m_io_base.offset(ATA_REG_LBA0).out<u8>(0);
     m_io_base.offset(ATA_REG_LBA1).out<u8>(0);
     m_io_base.offset(ATA_REG_LBA2).out<u8>(0);
 
-    m_io_base.offset(ATA_REG_SECCOUNT0).out<u8>(count);
+    m_io_base.offset(ATA_REG_SECCOUNT0).out<u8>(count & 0xff);
     m_io_base.offset(ATA_REG_LBA0).out<u8>((lba & 0x000000ff) >> 0);
     m_io_base.offset(ATA_REG_LBA1).out<u8>((lba & 0x0000ff00) >> 8);
     m_io_base.offset(ATA_REG_LBA2).out<u8>((lba & 0x00ff0000) >> 16);
@@ -331,11 +392,13 @@ bool PATAChannel::ata_read_sectors_with_dma(u32 lba, u16 count, u8* outbuf, bool
     m_bus_master_base.out<u8>(0x9);
 
     wait_for_irq();
+    m_dma_pinned_pages.clear();
 
     if (m_device_error)
         return false;
 
-    memcpy(outbuf, m_dma_buffer_page->paddr().offset(0xc0000000).as_ptr(), 512 * count);
+    if (use_bounce_buffer)
+        memcpy(outbuf, bounce_buffer(), 512 * count);
 
     // I read somewhere that this may trigger a cache flush so let's do it.
     m_bus_master_base.offset(2).out<u8>(m_bus_master_base.offset(2).in<u8>() | 0x6);
@@ -349,12 +412,11 @@ bool PATAChannel::ata_write_sectors_with_dma(u32 lba, u16 count, const u8* inbuf
     dbg() << "PATAChannel::ata_write_sectors_with_dma (" << lba << " x" << count << ") <- " << inbuf;
 #endif
 
-    prdt().offset = m_dma_buffer_page->paddr();
-    prdt().size = 512 * count;
-
-    memcpy(m_dma_buffer_page->paddr().offset(0xc0000000).as_ptr(), inbuf, 512 * count);
-
-    ASSERT(prdt().size <= PAGE_SIZE);
+    ASSERT(count && count <= max_sectors_per_request);
+    if (!build_prdt_for_buffer(inbuf, 512 * count, false)) {
+        build_prdt_for_bounce_buffer(512 * count);
+        memcpy(bounce_buffer(), inbuf, 512 * count);
+    }
 
     // Stop bus master
     m_bus_master_base.out<u8>(0);
@@ -374,12 +436,13 @@ bool PATAChannel::ata_write_sectors_with_dma(u32 lba, u16 count, const u8* inbuf
 
     m_io_base.offset(ATA_REG_FEATURES).out<u16>(0);
 
-    m_io_base.offset(ATA_REG_SECCOUNT0).out<u8>(0);
+    // For 48-bit commands, the high bytes of the sector count and LBA are written first.
+    m_io_base.offset(ATA_REG_SECCOUNT0).out<u8>(count >> 8);
     m_io_base.offset(ATA_REG_LBA0).out<u8>(0);
     m_io_base.offset(ATA_REG_LBA1).out<u8>(0);
     m_io_base.offset(ATA_REG_LBA2).out<u8>(0);
 
-    m_io_base.offset(ATA_REG_SECCOUNT0).out<u8>(count);
+    m_io_base.offset(ATA_REG_SECCOUNT0).out<u8>(count & 0xff);
     m_io_base.offset(ATA_REG_LBA0).out<u8>((lba & 0x000000ff) >> 0);
     m_io_base.offset(ATA_REG_LBA1).out<u8>((lba & 0x0000ff00) >> 8);
     m_io_base.offset(ATA_REG_LBA2).out<u8>((lba & 0x00ff0000) >> 16);
@@ -397,6 +460,7 @@ bool PATAChannel::ata_write_sectors_with_dma(u32 lba, u16 count, const u8* inbuf
     // Start bus master
     m_bus_master_base.out<u8>(0x1);
     wait_for_irq();
+    m_dma_pinned_pages.clear();
 
     if (m_device_error)
         return false;
@@ -37,6 +37,7 @@
 
 #pragma once
 
+#include <AK/NonnullRefPtrVector.h>
 #include <AK/OwnPtr.h>
 #include <AK/RefPtr.h>
 #include <Kernel/IO.h>
@@ -66,6 +67,9 @@ public:
         Secondary
     };
 
+    // One ATA command can move at most this many sectors; PATADiskDevice splits larger requests.
+    static constexpr size_t max_sectors_per_request = 256;
+
 public:
     static OwnPtr<PATAChannel> create(ChannelType type, bool force_pio);
     PATAChannel(PCI::Address address, ChannelType type, bool force_pio);
@@ -91,6 +95,11 @@ private:
 
     inline void prepare_for_irq();
 
+    bool build_prdt_for_buffer(const u8* buffer, size_t length, bool device_writes_memory);
+    void build_prdt_for_bounce_buffer(size_t length);
+    bool append_to_prdt(size_t& entry_count, PhysicalAddress, size_t length);
+    u8* bounce_buffer() { return m_dma_buffer_pages.first().paddr().offset(0xc0000000).as_ptr(); }
+
     // Data members
     u8 m_channel_number { 0 }; // Channel number. 0 = master, 1 = slave
     IOAddress m_io_base;
@@ -99,9 +108,14 @@ private:
 
     WaitQueue m_irq_queue;
 
-    PhysicalRegionDescriptor& prdt() { return *reinterpret_cast<PhysicalRegionDescriptor*>(m_prdt_page->paddr().offset(0xc0000000).as_ptr()); }
+    static constexpr size_t max_prdt_entries = PAGE_SIZE / sizeof(PhysicalRegionDescriptor);
+    PhysicalRegionDescriptor* prdt() { return reinterpret_cast<PhysicalRegionDescriptor*>(m_prdt_page->paddr().offset(0xc0000000).as_ptr()); }
     RefPtr<PhysicalPage> m_prdt_page;
-    RefPtr<PhysicalPage> m_dma_buffer_page;
+    // Used when a request buffer can't be handed to the bus master directly (e.g it's not word-aligned,
+    // or some of its pages aren't mapped yet).
+    NonnullRefPtrVector<PhysicalPage> m_dma_buffer_pages;
+    // The userspace pages the PRDT currently points at, kept alive until the transfer is done.
+    NonnullRefPtrVector<PhysicalPage> m_dma_pinned_pages;
     IOAddress m_bus_master_base;
     Lockable<bool> m_dma_enabled;
     EntropySource m_entropy_source;
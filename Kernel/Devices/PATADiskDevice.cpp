@@ -83,15 +83,13 @@ void PATADiskDevice::set_drive_geometry(u16 cyls, u16 heads, u16 spt)
 KResultOr<size_t> PATADiskDevice::read(FileDescription&, size_t offset, u8* outbuf, size_t len)
 {
     unsigned index = offset / block_size();
-    u16 whole_blocks = len / block_size();
+    size_t whole_blocks = len / block_size();
     ssize_t remaining = len % block_size();
 
-    unsigned blocks_per_page = PAGE_SIZE / block_size();
-
-    // PATAChannel will chuck a wobbly if we try to read more than PAGE_SIZE
-    // at a time, because it uses a single page for its DMA buffer.
-    if (whole_blocks >= blocks_per_page) {
-        whole_blocks = blocks_per_page;
+    // A single ATA command can only transfer so many sectors, so larger requests
+    // get a short read and the caller comes back for the rest.
+    if (whole_blocks >= PATAChannel::max_sectors_per_request) {
+        whole_blocks = PATAChannel::max_sectors_per_request;
         remaining = 0;
     }
 
@@ -100,7 +98,7 @@ KResultOr<size_t> PATADiskDevice::read(FileDescription&, size_t offset, u8* outb
 #endif
 
     if (whole_blocks > 0) {
-        if (!read_blocks(index, whole_blocks, outbuf))
+        if (!submit_request_and_wait(BlockDeviceRequest::Type::Read, index, whole_blocks, outbuf))
             return -1;
     }
 
@@ -108,7 +106,7 @@ KResultOr<size_t> PATADiskDevice::read(FileDescription&, size_t offset, u8* outb
 
     if (remaining > 0) {
         auto buf = ByteBuffer::create_uninitialized(block_size());
-        if (!read_blocks(index + whole_blocks, 1, buf.data()))
+        if (!submit_request_and_wait(BlockDeviceRequest::Type::Read, index + whole_blocks, 1, buf.data()))
             return pos;
         memcpy(&outbuf[pos], buf.data(), remaining);
     }
@@ -124,15 +122,13 @@ bool PATADiskDevice::can_read(const FileDescription&, size_t offset) const
 KResultOr<size_t> PATADiskDevice::write(FileDescription&, size_t offset, const u8* inbuf, size_t len)
 {
     unsigned index = offset / block_size();
-    u16 whole_blocks = len / block_size();
+    size_t whole_blocks = len / block_size();
     ssize_t remaining = len % block_size();
 
-    unsigned blocks_per_page = PAGE_SIZE / block_size();
-
-    // PATAChannel will chuck a wobbly if we try to write more than PAGE_SIZE
-    // at a time, because it uses a single page for its DMA buffer.
-    if (whole_blocks >= blocks_per_page) {
-        whole_blocks = blocks_per_page;
+    // A single ATA command can only transfer so many sectors, so larger requests
+    // get a short write and the caller comes back for the rest.
+    if (whole_blocks >= PATAChannel::max_sectors_per_request) {
+        whole_blocks = PATAChannel::max_sectors_per_request;
         remaining = 0;
     }
 
@@ -141,7 +137,7 @@ KResultOr<size_t> PATADiskDevice::write(FileDescription&, size_t offset, const u
 #endif
 
     if (whole_blocks > 0) {
-        if (!write_blocks(index, whole_blocks, inbuf))
+        if (!submit_request_and_wait(BlockDeviceRequest::Type::Write, index, whole_blocks, const_cast<u8*>(inbuf)))
             return -1;
     }
 
@@ -152,10 +148,10 @@ KResultOr<size_t> PATADiskDevice::write(FileDescription&, size_t offset, const u
     // then write the whole block back to the disk.
     if (remaining > 0) {
         auto buf = ByteBuffer::create_zeroed(block_size());
-        if (!read_blocks(index + whole_blocks, 1, buf.data()))
+        if (!submit_request_and_wait(BlockDeviceRequest::Type::Read, index + whole_blocks, 1, buf.data()))
             return pos;
         memcpy(buf.data(), &inbuf[pos], remaining);
-        if (!write_blocks(index + whole_blocks, 1, buf.data()))
+        if (!submit_request_and_wait(BlockDeviceRequest::Type::Write, index + whole_blocks, 1, buf.data()))
             return pos;
     }
 
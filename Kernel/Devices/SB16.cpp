@@ -47,6 +47,10 @@ const u16 DSP_WRITE = 0x22C;
 const u16 DSP_STATUS = 0x22E;
 const u16 DSP_R_ACK = 0x22F;
 
+// One page, played as two halves of 512 stereo frames (~11.6 ms at 44.1 kHz each).
+const size_t DMA_BUFFER_SIZE = PAGE_SIZE;
+const size_t DMA_HALF_SIZE = DMA_BUFFER_SIZE / 2;
+
 /* Write a value to the DSP write register */
 void SB16::dsp_write(u8 value)
 {
@@ -181,7 +185,7 @@ void SB16::dma_start(uint32_t length)
 {
     const auto addr = m_dma_region->physical_page(0)->paddr().get();
     const u8 channel = 5; // 16-bit samples use DMA channel 5 (on the master DMA controller)
-    const u8 mode = 0x48;
+    const u8 mode = 0x58; // Single transfer, auto-initialize, memory to device
 
     // Disable the DMA channel
     IO::out8(0xd4, 4 + (channel % 4));
@@ -210,57 +214,49 @@ void SB16::dma_start(uint32_t length)
 
 void SB16::handle_irq(const RegisterState&)
 {
-    // Stop sound output ready for the next block.
-    dsp_write(0xd5);
-
     IO::in8(DSP_STATUS); // 8 bit interrupt
     if (m_major_version >= 4)
         IO::in8(DSP_R_ACK); // 16 bit interrupt
 
-    m_irq_queue.wake_all();
-}
+    // The half that just finished is free again, and the card has already moved on to the other one.
+    m_queued_bytes -= min(m_queued_bytes, DMA_HALF_SIZE);
+    if (m_queued_bytes == 0) {
+        // Nothing left to play, so stop before the card goes around the buffer again.
+        dsp_write(0xd5);
+        m_playing = false;
+        m_write_offset = 0;
+    } else if (m_queued_bytes < DMA_HALF_SIZE) {
+        // The half that is playing now was only partly written. Play silence after what's there
+        // rather than whatever was left over from last time around.
+        size_t padding = DMA_HALF_SIZE - m_queued_bytes;
+        memset(m_dma_region->vaddr().offset(m_write_offset).as_ptr(), 0, padding);
+        m_write_offset = (m_write_offset + padding) % DMA_BUFFER_SIZE;
+        m_queued_bytes = DMA_HALF_SIZE;
+    }
 
-void SB16::wait_for_irq()
-{
-    Thread::current()->wait_on(m_irq_queue, "SB16");
-    disable_irq();
+    m_irq_queue.wake_all();
 }
 
-KResultOr<size_t> SB16::write(FileDescription&, size_t, const u8* data, size_t length)
+void SB16::start_playback()
 {
-    if (!m_dma_region) {
-        auto page = MM.allocate_supervisor_physical_page();
-        auto vmobject = AnonymousVMObject::create_with_physical_page(*page);
-        m_dma_region = MM.allocate_kernel_region_with_vmobject(*vmobject, PAGE_SIZE, "SB16 DMA buffer", Region::Access::Write);
-    }
-
-#ifdef SB16_DEBUG
-    klog() << "SB16: Writing buffer of " << length << " bytes";
-#endif
-    ASSERT(length <= PAGE_SIZE);
-    const int BLOCK_SIZE = 32 * 1024;
-    if (length > BLOCK_SIZE) {
-        return -ENOSPC;
-    }
+    ASSERT(!m_playing);
 
     u8 mode = (u8)SampleFormat::Signed | (u8)SampleFormat::Stereo;
 
     const int sample_rate = 44100;
     set_sample_rate(sample_rate);
-    memcpy(m_dma_region->vaddr().as_ptr(), data, length);
-    dma_start(length);
+    dma_start(DMA_BUFFER_SIZE);
 
-    // 16-bit single-cycle output.
-    // FIXME: Implement auto-initialized output.
-    u8 command = 0xb0;
+    // 16-bit auto-initialized output. The block length is one half of the buffer,
+    // so the card interrupts each time it crosses from one half into the other.
+    u8 command = 0xb6;
 
-    u16 sample_count = length / sizeof(i16);
+    u16 sample_count = DMA_HALF_SIZE / sizeof(i16);
     if (mode & (u8)SampleFormat::Stereo)
         sample_count /= 2;
 
     sample_count -= 1;
 
-    cli();
     enable_irq();
 
     dsp_write(command);
@@ -268,8 +264,50 @@ KResultOr<size_t> SB16::write(FileDescription&, size_t, const u8* data, size_t l
     dsp_write((u8)sample_count);
     dsp_write((u8)(sample_count >> 8));
 
-    wait_for_irq();
-    return length;
+    m_playing = true;
+}
+
+bool SB16::can_write(const FileDescription&, size_t) const
+{
+    return m_queued_bytes < DMA_BUFFER_SIZE;
+}
+
+KResultOr<size_t> SB16::write(FileDescription&, size_t, const u8* data, size_t length)
+{
+    if (!m_dma_region) {
+        auto page = MM.allocate_supervisor_physical_page();
+        auto vmobject = AnonymousVMObject::create_with_physical_page(*page);
+        m_dma_region = MM.allocate_kernel_region_with_vmobject(*vmobject, PAGE_SIZE, "SB16 DMA buffer", Region::Access::Write);
+    }
+
+#ifdef SB16_DEBUG
+    klog() << "SB16: Writing buffer of " << length << " bytes";
+#endif
+
+    size_t nwritten = 0;
+    while (nwritten < length) {
+        InterruptDisabler disabler;
+        if (m_queued_bytes == DMA_BUFFER_SIZE) {
+            if (Thread::current()->wait_on(m_irq_queue, "SB16").was_interrupted())
+                break;
+            continue;
+        }
+
+        size_t chunk_size = min(length - nwritten, DMA_BUFFER_SIZE - m_queued_bytes);
+        chunk_size = min(chunk_size, DMA_BUFFER_SIZE - m_write_offset);
+        memcpy(m_dma_region->vaddr().offset(m_write_offset).as_ptr(), data + nwritten, chunk_size);
+        m_write_offset = (m_write_offset + chunk_size) % DMA_BUFFER_SIZE;
+        m_queued_bytes += chunk_size;
+        nwritten += chunk_size;
+
+        // Start once there's a whole half to play. From then on, each interrupt makes room for more.
+        if (!m_playing && m_queued_bytes >= DMA_HALF_SIZE)
+            start_playback();
+    }
+
+    if (nwritten == 0 && length != 0)
+        return KResult(-EINTR);
+    return nwritten;
 }
 
 }
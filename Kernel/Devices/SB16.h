@@ -48,7 +48,7 @@ public:
     virtual bool can_read(const FileDescription&, size_t) const override;
     virtual KResultOr<size_t> read(FileDescription&, size_t, u8*, size_t) override;
     virtual KResultOr<size_t> write(FileDescription&, size_t, const u8*, size_t) override;
-    virtual bool can_write(const FileDescription&, size_t) const override { return true; }
+    virtual bool can_write(const FileDescription&, size_t) const override;
 
     virtual const char* purpose() const override { return class_name(); }
 
@@ -60,8 +60,8 @@ private:
     virtual const char* class_name() const override { return "SB16"; }
 
     void initialize();
-    void wait_for_irq();
     void dma_start(uint32_t length);
+    void start_playback();
     void set_sample_rate(uint16_t hz);
     void dsp_write(u8 value);
     u8 dsp_read();
@@ -72,6 +72,12 @@ private:
     OwnPtr<Region> m_dma_region;
     int m_major_version { 0 };
 
+    // The DMA buffer is played over and over in two halves, with an interrupt after each one.
+    // Writers fill the half that isn't playing. Both of these are only touched with interrupts disabled.
+    size_t m_write_offset { 0 };
+    size_t m_queued_bytes { 0 };
+    bool m_playing { false };
+
     WaitQueue m_irq_queue;
 };
 }
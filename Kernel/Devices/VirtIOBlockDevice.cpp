@@ -0,0 +1,282 @@
+/*
+ * Copyright (c) 2020, The SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+//#define VIRTIO_BLOCK_DEBUG
+
+#include <AK/Memory.h>
+#include <Kernel/Devices/VirtIOBlockDevice.h>
+#include <Kernel/FileSystem/FileDescription.h>
+#include <Kernel/VM/MemoryManager.h>
+
+namespace Kernel {
+
+// Feature bits
+#define VIRTIO_BLK_F_SIZE_MAX 1
+#define VIRTIO_BLK_F_SEG_MAX 2
+#define VIRTIO_BLK_F_RO 5
+
+// Device configuration
+#define VIRTIO_BLK_CONFIG_CAPACITY 0
+#define VIRTIO_BLK_CONFIG_SIZE_MAX 8
+#define VIRTIO_BLK_CONFIG_SEG_MAX 12
+
+// Request types and status
+#define VIRTIO_BLK_T_IN 0
+#define VIRTIO_BLK_T_OUT 1
+#define VIRTIO_BLK_S_OK 0
+
+// The sector size of the protocol, whatever the underlying disk uses.
+static constexpr size_t virtio_sector_size = 512;
+static constexpr unsigned virtio_block_major = 6;
+
+static NonnullRefPtrVector<VirtIOBlockDevice>* s_devices;
+
+void VirtIOBlockDevice::detect()
+{
+    static const PCI::ID legacy_block_device_id = { VirtIODevice::pci_vendor_id, 0x1001 };
+
+    if (!s_devices)
+        s_devices = new NonnullRefPtrVector<VirtIOBlockDevice>;
+
+    PCI::enumerate([&](const PCI::Address& address, PCI::ID id) {
+        if (address.is_null())
+            return;
+        if (id != legacy_block_device_id)
+            return;
+        auto device = adopt(*new VirtIOBlockDevice(address, s_devices->size()));
+        if (!device->initialize()) {
+            device->fail_initialization();
+            return;
+        }
+        s_devices->append(move(device));
+    });
+}
+
+RefPtr<VirtIOBlockDevice> VirtIOBlockDevice::device(size_t index)
+{
+    if (!s_devices || index >= s_devices->size())
+        return nullptr;
+    return s_devices->at(index);
+}
+
+VirtIOBlockDevice::VirtIOBlockDevice(PCI::Address address, unsigned minor)
+    : BlockDevice(virtio_block_major, minor, virtio_sector_size)
+    , VirtIODevice(address)
+{
+}
+
+VirtIOBlockDevice::~VirtIOBlockDevice()
+{
+}
+
+bool VirtIOBlockDevice::initialize()
+{
+    klog() << "VirtIOBlockDevice: Found @ " << pci_address();
+
+    negotiate_features((1 << VIRTIO_BLK_F_SIZE_MAX) | (1 << VIRTIO_BLK_F_SEG_MAX) | (1 << VIRTIO_BLK_F_RO));
+    if (!setup_queues(1))
+        return false;
+
+    m_capacity_in_blocks = config_read32(VIRTIO_BLK_CONFIG_CAPACITY) | ((u64)config_read32(VIRTIO_BLK_CONFIG_CAPACITY + 4) << 32);
+    m_read_only = has_feature(VIRTIO_BLK_F_RO);
+
+    // Whole merged requests from the BlockIOTask should fit in one transfer, as long as the device can take that many segments.
+    m_max_transfer_size = max_merged_request_size;
+    m_max_segment_size = m_max_transfer_size;
+    if (has_feature(VIRTIO_BLK_F_SIZE_MAX)) {
+        if (auto size_max = config_read32(VIRTIO_BLK_CONFIG_SIZE_MAX); size_max >= virtio_sector_size)
+            m_max_segment_size = min(m_max_segment_size, (size_t)size_max);
+    }
+    // A request takes a descriptor for its header and one for its status besides the data segments.
+    size_t max_segments = queue(0).size() - 2;
+    if (has_feature(VIRTIO_BLK_F_SEG_MAX)) {
+        if (auto seg_max = config_read32(VIRTIO_BLK_CONFIG_SEG_MAX); seg_max)
+            max_segments = min(max_segments, (size_t)seg_max);
+    }
+    m_max_transfer_size = min(m_max_transfer_size, max_segments * m_max_segment_size);
+    m_max_transfer_size -= m_max_transfer_size % virtio_sector_size;
+    if (!m_max_transfer_size)
+        return false;
+
+    m_request_region = MM.allocate_contiguous_kernel_region(PAGE_SIZE, "VirtIOBlockDevice Request", Region::Access::Read | Region::Access::Write);
+    m_data_region = MM.allocate_contiguous_kernel_region(PAGE_ROUND_UP(m_max_transfer_size), "VirtIOBlockDevice Data", Region::Access::Read | Region::Access::Write);
+    if (!m_request_region || !m_data_region)
+        return false;
+
+    finish_initialization();
+
+    klog() << "VirtIOBlockDevice: " << m_capacity_in_blocks << " sectors" << (m_read_only ? ", read-only" : "") << ", up to " << m_max_transfer_size << " bytes per request";
+    return true;
+}
+
+void VirtIOBlockDevice::handle_queue_interrupt(u16)
+{
+    m_wait_queue.wake_all();
+}
+
+bool VirtIOBlockDevice::transfer(u32 request_type, unsigned index, u16 count, u8* buffer)
+{
+    LOCKER(m_lock);
+    if (index + count > m_capacity_in_blocks)
+        return false;
+
+    auto& header = *(RequestHeader*)m_request_region->vaddr().as_ptr();
+    auto& status = *(volatile u8*)m_request_region->vaddr().offset(sizeof(RequestHeader)).as_ptr();
+    auto request_address = m_request_region->physical_page(0)->paddr();
+    auto data_address = m_data_region->physical_page(0)->paddr();
+    bool is_read = request_type == VIRTIO_BLK_T_IN;
+
+    while (count) {
+        size_t chunk_blocks = min((size_t)count, m_max_transfer_size / virtio_sector_size);
+        size_t chunk_size = chunk_blocks * virtio_sector_size;
+#ifdef VIRTIO_BLOCK_DEBUG
+        klog() << "VirtIOBlockDevice: " << (is_read ? "Reading " : "Writing ") << chunk_blocks << " sectors @ " << index;
+#endif
+        if (!is_read)
+            memcpy(m_data_region->vaddr().as_ptr(), buffer, chunk_size);
+
+        header.type = request_type;
+        header.reserved = 0;
+        header.sector = index;
+        status = 0xff;
+
+        Vector<VirtIOQueue::Buffer, 8> buffers;
+        buffers.append({ request_address, sizeof(RequestHeader), false });
+        for (size_t offset = 0; offset < chunk_size; offset += m_max_segment_size)
+            buffers.append({ data_address.offset(offset), (u32)min(m_max_segment_size, chunk_size - offset), is_read });
+        buffers.append({ request_address.offset(sizeof(RequestHeader)), 1, true });
+
+        bool did_enqueue = queue(0).enqueue(buffers.data(), buffers.size(), 0);
+        ASSERT(did_enqueue);
+        publish_queue(0);
+        // A wakeup that comes before we're on the wait queue is remembered by it, so this can't miss the interrupt.
+        while (!queue(0).has_completions())
+            Thread::current()->wait_on(m_wait_queue, "VirtIOBlockDevice");
+        (void)queue(0).take_completion();
+
+        if (u8 request_status = status; request_status != VIRTIO_BLK_S_OK) {
+            klog() << "VirtIOBlockDevice: Request for " << chunk_blocks << " sectors @ " << index << " failed with status " << request_status;
+            return false;
+        }
+        if (is_read)
+            memcpy(buffer, m_data_region->vaddr().as_ptr(), chunk_size);
+
+        buffer += chunk_size;
+        index += chunk_blocks;
+        count -= chunk_blocks;
+    }
+    return true;
+}
+
+bool VirtIOBlockDevice::read_blocks(unsigned index, u16 count, u8* out)
+{
+    return transfer(VIRTIO_BLK_T_IN, index, count, out);
+}
+
+bool VirtIOBlockDevice::write_blocks(unsigned index, u16 count, const u8* data)
+{
+    if (m_read_only)
+        return false;
+    return transfer(VIRTIO_BLK_T_OUT, index, count, const_cast<u8*>(data));
+}
+
+KResultOr<size_t> VirtIOBlockDevice::read(FileDescription&, size_t offset, u8* outbuf, size_t len)
+{
+    unsigned index = offset / block_size();
+    size_t whole_blocks = len / block_size();
+    ssize_t remaining = len % block_size();
+
+    // Larger requests get a short read, and the caller comes back for the rest.
+    size_t max_blocks_per_request = max_merged_request_size / block_size();
+    if (whole_blocks >= max_blocks_per_request) {
+        whole_blocks = max_blocks_per_request;
+        remaining = 0;
+    }
+
+    if (whole_blocks > 0) {
+        if (!submit_request_and_wait(BlockDeviceRequest::Type::Read, index, whole_blocks, outbuf))
+            return KResult(-EIO);
+    }
+
+    off_t pos = whole_blocks * block_size();
+
+    if (remaining > 0) {
+        auto buf = ByteBuffer::create_uninitialized(block_size());
+        if (!submit_request_and_wait(BlockDeviceRequest::Type::Read, index + whole_blocks, 1, buf.data()))
+            return pos;
+        memcpy(&outbuf[pos], buf.data(), remaining);
+    }
+
+    return pos + remaining;
+}
+
+bool VirtIOBlockDevice::can_read(const FileDescription&, size_t offset) const
+{
+    return offset < m_capacity_in_blocks * block_size();
+}
+
+KResultOr<size_t> VirtIOBlockDevice::write(FileDescription&, size_t offset, const u8* inbuf, size_t len)
+{
+    if (m_read_only)
+        return KResult(-EROFS);
+
+    unsigned index = offset / block_size();
+    size_t whole_blocks = len / block_size();
+    ssize_t remaining = len % block_size();
+
+    // Larger requests get a short write, and the caller comes back for the rest.
+    size_t max_blocks_per_request = max_merged_request_size / block_size();
+    if (whole_blocks >= max_blocks_per_request) {
+        whole_blocks = max_blocks_per_request;
+        remaining = 0;
+    }
+
+    if (whole_blocks > 0) {
+        if (!submit_request_and_wait(BlockDeviceRequest::Type::Write, index, whole_blocks, const_cast<u8*>(inbuf)))
+            return KResult(-EIO);
+    }
+
+    off_t pos = whole_blocks * block_size();
+
+    // A partial block has to be read, modified and written back whole.
+    if (remaining > 0) {
+        auto buf = ByteBuffer::create_zeroed(block_size());
+        if (!submit_request_and_wait(BlockDeviceRequest::Type::Read, index + whole_blocks, 1, buf.data()))
+            return pos;
+        memcpy(buf.data(), &inbuf[pos], remaining);
+        if (!submit_request_and_wait(BlockDeviceRequest::Type::Write, index + whole_blocks, 1, buf.data()))
+            return pos;
+    }
+
+    return pos + remaining;
+}
+
+bool VirtIOBlockDevice::can_write(const FileDescription&, size_t offset) const
+{
+    return !m_read_only && offset < m_capacity_in_blocks * block_size();
+}
+
+}
@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2020, The SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/NonnullRefPtrVector.h>
+#include <Kernel/Devices/BlockDevice.h>
+#include <Kernel/Lock.h>
+#include <Kernel/VirtIO/VirtIODevice.h>
+#include <Kernel/WaitQueue.h>
+
+namespace Kernel {
+
+// A paravirtual disk, which takes whole requests over a single virtqueue
+// instead of having the hypervisor emulate IDE registers one port access at a time.
+class VirtIOBlockDevice final : public BlockDevice
+    , public VirtIODevice {
+public:
+    static void detect();
+    // The disks in PCI enumeration order, so that /dev/vda is the first one.
+    static RefPtr<VirtIOBlockDevice> device(size_t index);
+
+    virtual ~VirtIOBlockDevice() override;
+
+    // ^BlockDevice
+    virtual bool read_blocks(unsigned index, u16 count, u8*) override;
+    virtual bool write_blocks(unsigned index, u16 count, const u8*) override;
+    virtual KResultOr<size_t> read(FileDescription&, size_t, u8*, size_t) override;
+    virtual bool can_read(const FileDescription&, size_t) const override;
+    virtual KResultOr<size_t> write(FileDescription&, size_t, const u8*, size_t) override;
+    virtual bool can_write(const FileDescription&, size_t) const override;
+
+    virtual const char* purpose() const override { return class_name(); }
+
+private:
+    VirtIOBlockDevice(PCI::Address, unsigned minor);
+
+    // ^Device
+    virtual const char* class_name() const override { return "VirtIOBlockDevice"; }
+
+    // ^VirtIODevice
+    virtual void handle_queue_interrupt(u16 queue_index) override;
+
+    bool initialize();
+    bool transfer(u32 request_type, unsigned index, u16 count, u8* buffer);
+
+    struct [[gnu::packed]] RequestHeader
+    {
+        u32 type;
+        u32 reserved;
+        u64 sector;
+    };
+
+    // Requests go through these, as the buffers we're handed needn't be physically contiguous.
+    OwnPtr<Region> m_request_region;
+    OwnPtr<Region> m_data_region;
+    size_t m_max_transfer_size { 0 };
+    size_t m_max_segment_size { 0 };
+
+    u64 m_capacity_in_blocks { 0 };
+    bool m_read_only { false };
+
+    Lock m_lock { "VirtIOBlockDevice" };
+    WaitQueue m_wait_queue;
+};
+
+}
@@ -49,6 +49,33 @@ DoubleBuffer::DoubleBuffer(size_t capacity)
     m_space_for_writing = capacity;
 }
 
+KResult DoubleBuffer::set_capacity(size_t new_capacity)
+{
+    ASSERT(new_capacity);
+    LOCKER(m_lock);
+    size_t unread_in_read_buffer = m_read_buffer->size - m_read_buffer_index;
+    size_t unread = unread_in_read_buffer + m_write_buffer->size;
+    if (unread > new_capacity)
+        return KResult(-EBUSY);
+
+    auto new_storage = KBuffer::create_with_size(new_capacity * 2, Region::Access::Read | Region::Access::Write, "DoubleBuffer");
+    u8* new_write_data = new_storage.data();
+    memcpy(new_write_data, m_read_buffer->data + m_read_buffer_index, unread_in_read_buffer);
+    memcpy(new_write_data + unread_in_read_buffer, m_write_buffer->data, m_write_buffer->size);
+
+    m_write_buffer = &m_buffer1;
+    m_read_buffer = &m_buffer2;
+    m_buffer1.data = new_write_data;
+    m_buffer1.size = unread;
+    m_buffer2.data = new_write_data + new_capacity;
+    m_buffer2.size = 0;
+    m_read_buffer_index = 0;
+    m_storage = move(new_storage);
+    m_capacity = new_capacity;
+    compute_lockfree_metadata();
+    return KSuccess;
+}
+
 void DoubleBuffer::flip()
 {
     ASSERT(m_read_buffer_index == m_read_buffer->size);
@@ -72,6 +99,45 @@ size_t DoubleBuffer::write(const u8* data, size_t size)
     return bytes_to_write;
 }
 
+size_t DoubleBuffer::writev(const iovec* iov, int iov_count)
+{
+    LOCKER(m_lock);
+    size_t total_written = 0;
+    for (int i = 0; i < iov_count && m_space_for_writing; ++i) {
+        size_t bytes_to_write = min(iov[i].iov_len, m_space_for_writing);
+        u8* write_ptr = m_write_buffer->data + m_write_buffer->size;
+        m_write_buffer->size += bytes_to_write;
+        compute_lockfree_metadata();
+        memcpy(write_ptr, iov[i].iov_base, bytes_to_write);
+        total_written += bytes_to_write;
+    }
+    return total_written;
+}
+
+size_t DoubleBuffer::readv(const iovec* iov, int iov_count)
+{
+    LOCKER(m_lock);
+    size_t total_read = 0;
+    for (int i = 0; i < iov_count; ++i) {
+        u8* data = (u8*)iov[i].iov_base;
+        size_t size = iov[i].iov_len;
+        while (size) {
+            if (m_read_buffer_index >= m_read_buffer->size && m_write_buffer->size != 0)
+                flip();
+            if (m_read_buffer_index >= m_read_buffer->size)
+                return total_read;
+            size_t nread = min(m_read_buffer->size - m_read_buffer_index, size);
+            memcpy(data, m_read_buffer->data + m_read_buffer_index, nread);
+            m_read_buffer_index += nread;
+            compute_lockfree_metadata();
+            data += nread;
+            size -= nread;
+            total_read += nread;
+        }
+    }
+    return total_read;
+}
+
 size_t DoubleBuffer::read(u8* data, size_t size)
 {
     if (!size)
@@ -28,7 +28,9 @@
 
 #include <AK/Types.h>
 #include <Kernel/KBuffer.h>
+#include <Kernel/KResult.h>
 #include <Kernel/Lock.h>
+#include <Kernel/UnixTypes.h>
 
 namespace Kernel {
 
@@ -38,11 +40,18 @@ public:
 
     size_t write(const u8*, size_t);
     size_t read(u8*, size_t);
+    // Like write() and read(), but gather/scatter the whole iovec array under one lock so it can't be interleaved with other writers.
+    size_t writev(const iovec*, int iov_count);
+    size_t readv(const iovec*, int iov_count);
 
     bool is_empty() const { return m_empty; }
 
     size_t space_for_writing() const { return m_space_for_writing; }
 
+    size_t capacity() const { return m_capacity; }
+    // Moves the unread data over to new storage of the given capacity. Fails with EBUSY if it wouldn't fit.
+    KResult set_capacity(size_t);
+
 private:
     void flip();
     void compute_lockfree_metadata();
@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <Kernel/FileSystem/AnonymousFile.h>
+#include <Kernel/Process.h>
+#include <Kernel/VM/MemoryManager.h>
+#include <Kernel/VM/PhysicalPage.h>
+#include <Kernel/VM/Region.h>
+
+namespace Kernel {
+
+AnonymousFile::AnonymousFile(NonnullRefPtr<AnonymousVMObject>&& vmobject)
+    : m_vmobject(move(vmobject))
+{
+}
+
+AnonymousFile::~AnonymousFile()
+{
+}
+
+KResultOr<Region*> AnonymousFile::mmap(Process& process, FileDescription&, VirtualAddress preferred_vaddr, size_t offset, size_t size, int prot, bool shared)
+{
+    LOCKER(m_lock);
+    if (offset != 0)
+        return KResult(-EINVAL);
+    if (size > m_vmobject->size())
+        return KResult(-EINVAL);
+
+    NonnullRefPtr<VMObject> vmobject = m_vmobject;
+    // A private mapping gets its own copy-on-write view of the current contents.
+    if (!shared)
+        vmobject = m_vmobject->clone();
+    auto* region = process.allocate_region_with_vmobject(preferred_vaddr, size, move(vmobject), 0, "AnonymousFile", prot);
+    if (!region)
+        return KResult(-ENOMEM);
+    region->set_shared(shared);
+    return region;
+}
+
+KResult AnonymousFile::truncate(u64 length)
+{
+    LOCKER(m_lock);
+    if (length == 0 || length > 1 * GB)
+        return KResult(-EINVAL);
+    size_t new_size = PAGE_ROUND_UP(length);
+    if (new_size == m_vmobject->size())
+        return KSuccess;
+
+    // Existing mappings would keep pointing at the old pages, so only resize while nobody has it mapped.
+    if (m_vmobject->ref_count() > 1)
+        return KResult(-EBUSY);
+
+    auto new_vmobject = AnonymousVMObject::create_with_size(new_size);
+    size_t pages_to_keep = min(m_vmobject->page_count(), new_vmobject->page_count());
+    for (size_t i = 0; i < pages_to_keep; ++i)
+        new_vmobject->physical_pages()[i] = m_vmobject->physical_pages()[i];
+    m_vmobject = move(new_vmobject);
+    return KSuccess;
+}
+
+}
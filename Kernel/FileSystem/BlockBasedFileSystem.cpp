@@ -24,31 +24,74 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <AK/HashMap.h>
+#include <AK/InlineLinkedList.h>
+#include <AK/QuickSort.h>
+#include <Kernel/CommandLine.h>
 #include <Kernel/FileSystem/BlockBasedFileSystem.h>
 #include <Kernel/Process.h>
+#include <Kernel/Tasks/WriteBackTask.h>
+#include <Kernel/VM/MemoryManager.h>
 
 //#define BBFS_DEBUG
 
 namespace Kernel {
 
-struct CacheEntry {
+struct CacheEntry : public InlineLinkedListNode<CacheEntry> {
     time_t timestamp { 0 };
+    time_t dirtied_at { 0 };
     u32 block_index { 0 };
     u8* data { nullptr };
     bool has_data { false };
     bool is_dirty { false };
+    // Set while a copy of the entry is being written to the device without the shard lock held.
+    // Such an entry must stay cached, or someone could read the old contents back from the device.
+    bool is_being_written_back { false };
+
+    // For InlineLinkedListNode.
+    CacheEntry* m_next { nullptr };
+    CacheEntry* m_prev { nullptr };
+};
+
+// The cache is split into shards by block index, each with its own lock, hash index and LRU lists.
+// Threads touching unrelated blocks thus don't serialize on a single cache lock.
+struct DiskCacheShard {
+    Lock lock { "DiskCacheShard" };
+    HashMap<u32, CacheEntry*> entries_by_block_index;
+    // Most recently used entries are kept at the head of each list.
+    InlineLinkedList<CacheEntry> clean_list;
+    InlineLinkedList<CacheEntry> dirty_list;
+    size_t dirty_count { 0 };
+    BlockBasedFS::CacheStatistics statistics;
 };
 
 class DiskCache {
 public:
+    static constexpr size_t shard_count = 8;
+    // Runs of this many consecutive blocks map to the same shard, so that write-back can coalesce them.
+    static constexpr size_t blocks_per_shard_cluster = 32;
+    static constexpr size_t max_write_back_run = blocks_per_shard_cluster;
+    static constexpr size_t max_read_ahead_run = blocks_per_shard_cluster;
+
     explicit DiskCache(BlockBasedFS& fs)
         : m_fs(fs)
+        , m_entry_count(compute_entry_count(fs.block_size()))
         , m_cached_block_data(KBuffer::create_with_size(m_entry_count * m_fs.block_size()))
         , m_entries(KBuffer::create_with_size(m_entry_count * sizeof(CacheEntry)))
+        , m_write_back_buffer(KBuffer::create_with_size(max_write_back_run * m_fs.block_size()))
+        , m_read_ahead_buffer(KBuffer::create_with_size(max_read_ahead_run * m_fs.block_size()))
     {
         for (size_t i = 0; i < m_entry_count; ++i) {
-            entries()[i].data = m_cached_block_data.data() + i * m_fs.block_size();
+            auto* entry = new (&entries()[i]) CacheEntry;
+            entry->data = m_cached_block_data.data() + i * m_fs.block_size();
+            auto& shard = m_shards[i % shard_count];
+            shard.clean_list.append(entry);
         }
+        for (auto& shard : m_shards)
+            shard.entries_by_block_index.ensure_capacity(m_entry_count / shard_count);
+#ifdef BBFS_DEBUG
+        klog() << "DiskCache: " << m_entry_count << " entries of " << m_fs.block_size() << " bytes";
+#endif
     }
 
     ~DiskCache() { }
@@ -56,56 +99,274 @@ public:
     bool is_dirty() const { return m_dirty; }
     void set_dirty(bool b) { m_dirty = b; }
 
-    CacheEntry& get(u32 block_index) const
+    DiskCacheShard& shard_for(u32 block_index) { return m_shards[(block_index / blocks_per_shard_cluster) % shard_count]; }
+    size_t entries_per_shard() const { return m_entry_count / shard_count; }
+
+    // Returns nullptr if every entry in the shard is dirty or being written back. In that case the
+    // WriteBackTask is woken up, and the caller has to drop the shard lock and make_room() before trying again.
+    // NOTE: The caller must hold shard_for(block_index).lock for as long as it uses the returned entry.
+    CacheEntry* get(u32 block_index)
     {
+        auto& shard = shard_for(block_index);
+        ASSERT(shard.lock.is_locked());
         auto now = kgettimeofday().tv_sec;
 
-        CacheEntry* oldest_clean_entry = nullptr;
-        for (size_t i = 0; i < m_entry_count; ++i) {
-            auto& entry = const_cast<CacheEntry&>(entries()[i]);
-            if (entry.block_index == block_index) {
-                entry.timestamp = now;
-                return entry;
-            }
-            if (!entry.is_dirty) {
-                if (!oldest_clean_entry)
-                    oldest_clean_entry = &entry;
-                else if (entry.timestamp < oldest_clean_entry->timestamp)
-                    oldest_clean_entry = &entry;
-            }
+        if (auto* entry = find(shard, block_index)) {
+            ++shard.statistics.hits;
+            entry->timestamp = now;
+            auto& list = entry->is_dirty ? shard.dirty_list : shard.clean_list;
+            list.remove(entry);
+            list.prepend(entry);
+            return entry;
         }
-        if (!oldest_clean_entry) {
-            // Not a single clean entry! Flush writes and try again.
-            // NOTE: We want to make sure we only call FileBackedFS flush here,
-            //       not some FileBackedFS subclass flush!
-            m_fs.flush_writes_impl();
-            return get(block_index);
+
+        // Replace the least recently used clean entry.
+        auto* new_entry = shard.clean_list.tail();
+        while (new_entry && new_entry->is_being_written_back)
+            new_entry = new_entry->prev();
+        if (!new_entry) {
+            WriteBackTask::wake();
+            return nullptr;
         }
 
-        // Replace the oldest clean entry.
-        auto& new_entry = *oldest_clean_entry;
-        new_entry.timestamp = now;
-        new_entry.block_index = block_index;
-        new_entry.has_data = false;
-        new_entry.is_dirty = false;
+        ++shard.statistics.misses;
+        shard.clean_list.remove(new_entry);
+        if (find(shard, new_entry->block_index) == new_entry) {
+            if (new_entry->has_data)
+                ++shard.statistics.evictions;
+            shard.entries_by_block_index.remove(new_entry->block_index);
+        }
+        new_entry->timestamp = now;
+        new_entry->block_index = block_index;
+        new_entry->has_data = false;
+        new_entry->is_dirty = false;
+        shard.clean_list.prepend(new_entry);
+        shard.entries_by_block_index.set(block_index, new_entry);
         return new_entry;
     }
 
-    const CacheEntry* entries() const { return (const CacheEntry*)m_entries.data(); }
-    CacheEntry* entries() { return (CacheEntry*)m_entries.data(); }
+    // Writes back enough of the shard's least recently used dirty entries for get() to find a clean one again.
+    // NOTE: The caller must not hold shard.lock.
+    void make_room(DiskCacheShard& shard)
+    {
+        // Any write-back in progress holds this, so once we have it, nothing in the shard is stuck being written.
+        LOCKER(m_write_back_lock);
+        write_back(shard, 0, entries_per_shard() * WriteBackTask::background_dirty_percentage / 100 / 2);
+    }
+
+    // NOTE: The caller must hold shard_for(block_index).lock.
+    CacheEntry* find(DiskCacheShard& shard, u32 block_index)
+    {
+        auto it = shard.entries_by_block_index.find(block_index);
+        if (it == shard.entries_by_block_index.end())
+            return nullptr;
+        return it->value;
+    }
+
+    void mark_dirty(CacheEntry& entry)
+    {
+        if (entry.is_dirty)
+            return;
+        auto& shard = shard_for(entry.block_index);
+        shard.clean_list.remove(&entry);
+        shard.dirty_list.prepend(&entry);
+        entry.is_dirty = true;
+        entry.dirtied_at = kgettimeofday().tv_sec;
+        ++shard.dirty_count;
+        m_dirty = true;
+
+        if (shard.dirty_count * 100 > entries_per_shard() * WriteBackTask::background_dirty_percentage)
+            WriteBackTask::wake();
+    }
+
+    void mark_clean(CacheEntry& entry)
+    {
+        if (!entry.is_dirty)
+            return;
+        auto& shard = shard_for(entry.block_index);
+        shard.dirty_list.remove(&entry);
+        shard.clean_list.prepend(&entry);
+        entry.is_dirty = false;
+        --shard.dirty_count;
+    }
+
+    // Writes back every dirty entry in the shard that was dirtied at or before expire_before,
+    // plus as many of the least recently used ones as it takes to get down to max_dirty entries.
+    // NOTE: The caller must not hold shard.lock.
+    size_t write_back(DiskCacheShard& shard, time_t expire_before, size_t max_dirty)
+    {
+        Vector<u32, 64> block_indices;
+        {
+            LOCKER(shard.lock);
+            size_t excess = shard.dirty_count > max_dirty ? shard.dirty_count - max_dirty : 0;
+            for (auto* entry = shard.dirty_list.tail(); entry; entry = entry->prev()) {
+                if (excess) {
+                    --excess;
+                    block_indices.append(entry->block_index);
+                } else if (entry->dirtied_at <= expire_before) {
+                    block_indices.append(entry->block_index);
+                }
+            }
+        }
+        return write_entries(shard, block_indices);
+    }
+
+    // Writes back the dirty entries among the given (distinct) blocks, e.g. the ones belonging to a single inode.
+    // NOTE: The caller must not hold any shard lock.
+    size_t write_back_blocks(const Vector<u32>& block_indices)
+    {
+        if (!m_dirty)
+            return 0;
+        size_t count = 0;
+        for (auto& shard : m_shards) {
+            Vector<u32, 64> shard_block_indices;
+            for (auto block_index : block_indices) {
+                if (&shard_for(block_index) == &shard)
+                    shard_block_indices.append(block_index);
+            }
+            count += write_entries(shard, shard_block_indices);
+        }
+        return count;
+    }
+
+    // Writes the dirty entries among the given (distinct) blocks of the shard to the device and marks them clean.
+    // Runs of consecutive blocks are written with a single request. Each run is copied out under the shard lock,
+    // but written to the device without it, so that users of the shard don't have to wait for the disk.
+    // NOTE: The caller must not hold shard.lock.
+    size_t write_entries(DiskCacheShard& shard, Vector<u32, 64>& block_indices)
+    {
+        if (block_indices.is_empty())
+            return 0;
+
+        quick_sort(block_indices);
+
+        LOCKER(m_write_back_lock);
+        size_t count = 0;
+        for (size_t i = 0; i < block_indices.size();) {
+            CacheEntry* run[max_write_back_run];
+            size_t run_length = 0;
+            {
+                LOCKER(shard.lock);
+                for (; i < block_indices.size() && run_length < max_write_back_run; ++i) {
+                    auto* entry = find(shard, block_indices[i]);
+                    if (!entry || !entry->is_dirty) {
+                        if (run_length)
+                            break;
+                        continue;
+                    }
+                    if (run_length && entry->block_index != run[0]->block_index + run_length)
+                        break;
+                    memcpy(m_write_back_buffer.data() + run_length * m_fs.block_size(), entry->data, m_fs.block_size());
+                    // If the entry is written to again in the meantime, it simply becomes dirty again.
+                    mark_clean(*entry);
+                    entry->is_being_written_back = true;
+                    run[run_length++] = entry;
+                }
+            }
+            if (!run_length)
+                continue;
+
+            // Entries that are being written back can't be evicted, so the run's block indices stay put.
+            m_fs.write_cache_blocks(run[0]->block_index, run_length, m_write_back_buffer.data());
+
+            LOCKER(shard.lock);
+            for (size_t j = 0; j < run_length; ++j)
+                run[j]->is_being_written_back = false;
+            count += run_length;
+        }
+        return count;
+    }
+
+    // NOTE: The caller must not hold shard.lock.
+    size_t flush_shard(DiskCacheShard& shard)
+    {
+        return write_back(shard, kgettimeofday().tv_sec, 0);
+    }
 
     template<typename Callback>
-    void for_each_entry(Callback callback)
+    void for_each_shard(Callback callback)
     {
-        for (size_t i = 0; i < m_entry_count; ++i)
-            callback(entries()[i]);
+        for (auto& shard : m_shards)
+            callback(shard);
+    }
+
+    // Fills any entries in [index, index + count) that aren't cached yet. All blocks must be in the same shard.
+    // NOTE: The caller must hold shard_for(index).lock.
+    void read_ahead(u32 index, size_t count)
+    {
+        ASSERT(count <= max_read_ahead_run);
+        auto& shard = shard_for(index);
+        ASSERT(shard.lock.is_locked());
+        ASSERT(&shard_for(index + count - 1) == &shard);
+
+        for (size_t i = 0; i < count;) {
+            auto* entry = find(shard, index + i);
+            if (entry && entry->has_data) {
+                ++i;
+                continue;
+            }
+            size_t run_length = 1;
+            while (i + run_length < count) {
+                auto* next = find(shard, index + i + run_length);
+                if (next && next->has_data)
+                    break;
+                ++run_length;
+            }
+
+            LOCKER(m_read_ahead_lock);
+            if (!m_fs.read_cache_blocks(index + i, run_length, m_read_ahead_buffer.data()))
+                return;
+            for (size_t j = 0; j < run_length; ++j) {
+                // Read-ahead is only a hint, so it gives up rather than wait for room in the shard.
+                auto* new_entry = get(index + i + j);
+                if (!new_entry)
+                    return;
+                if (new_entry->has_data)
+                    continue;
+                memcpy(new_entry->data, m_read_ahead_buffer.data() + j * m_fs.block_size(), m_fs.block_size());
+                new_entry->has_data = true;
+            }
+            ++shard.statistics.read_aheads;
+            i += run_length;
+        }
+    }
+
+    BlockBasedFS::CacheStatistics statistics() const
+    {
+        BlockBasedFS::CacheStatistics total;
+        for (auto& shard : m_shards) {
+            total.hits += shard.statistics.hits;
+            total.misses += shard.statistics.misses;
+            total.evictions += shard.statistics.evictions;
+            total.read_aheads += shard.statistics.read_aheads;
+        }
+        total.entry_count = m_entry_count;
+        return total;
     }
 
 private:
+    CacheEntry* entries() { return (CacheEntry*)m_entries.data(); }
+
+    static size_t compute_entry_count(size_t block_size)
+    {
+        if (auto blocks = kernel_command_line().lookup("disk_cache_blocks"); blocks.has_value()) {
+            if (auto count = blocks.value().to_uint(); count.has_value() && count.value() >= shard_count)
+                return count.value();
+        }
+        // By default, let each filesystem cache use up to 1/32 of physical memory.
+        size_t budget = (size_t)MM.user_physical_pages() * PAGE_SIZE / 32;
+        return clamp(budget / block_size, (size_t)1024, (size_t)65536);
+    }
+
     BlockBasedFS& m_fs;
-    size_t m_entry_count { 10000 };
+    size_t m_entry_count { 0 };
     KBuffer m_cached_block_data;
     KBuffer m_entries;
+    Lock m_write_back_lock { "DiskCacheWriteBack" };
+    KBuffer m_write_back_buffer;
+    Lock m_read_ahead_lock { "DiskCacheReadAhead" };
+    KBuffer m_read_ahead_buffer;
+    DiskCacheShard m_shards[shard_count];
     bool m_dirty { false };
 };
 
@@ -124,31 +385,35 @@ bool BlockBasedFS::write_block(unsigned index, const u8* data, size_t count, siz
     ASSERT(m_logical_block_size);
     ASSERT(offset + count <= block_size());
 #ifdef BBFS_DEBUG
-    klog() << "BlockBasedFileSystem::write_block " << index << ", size=" << data.size();
+    klog() << "BlockBasedFileSystem::write_block " << index << ", size=" << count;
 #endif
 
     if (!allow_cache) {
         flush_specific_block_if_needed(index);
         u32 base_offset = static_cast<u32>(index) * static_cast<u32>(block_size()) + offset;
-        file_description().seek(base_offset, SEEK_SET);
-        auto nwritten = file_description().write(data, count);
+        auto nwritten = file().write(file_description(), base_offset, data, count);
         if (nwritten.is_error())
             return false;
         ASSERT(nwritten.value() == count);
         return true;
     }
 
-    auto& entry = cache().get(index);
-    if (count < block_size()) {
-        // Fill the cache first.
-        read_block(index, nullptr, block_size());
+    auto& shard = cache().shard_for(index);
+    for (;;) {
+        {
+            LOCKER(shard.lock);
+            if (auto* entry = cache().get(index)) {
+                // Fill the cache first.
+                if (count < block_size() && !entry->has_data && !read_cache_entry(*entry))
+                    return false;
+                memcpy(entry->data + offset, data, count);
+                entry->has_data = true;
+                cache().mark_dirty(*entry);
+                return true;
+            }
+        }
+        cache().make_room(shard);
     }
-    memcpy(entry.data + offset, data, count);
-    entry.is_dirty = true;
-    entry.has_data = true;
-
-    cache().set_dirty(true);
-    return true;
 }
 
 bool BlockBasedFS::raw_read(unsigned index, u8* buffer)
@@ -211,27 +476,27 @@ bool BlockBasedFS::read_block(unsigned index, u8* buffer, size_t count, size_t o
     if (!allow_cache) {
         const_cast<BlockBasedFS*>(this)->flush_specific_block_if_needed(index);
         u32 base_offset = static_cast<u32>(index) * static_cast<u32>(block_size()) + static_cast<u32>(offset);
-        file_description().seek(base_offset, SEEK_SET);
-        auto nread = file_description().read(buffer, count);
+        auto nread = file_description().file().read(file_description(), base_offset, buffer, count);
         if (nread.is_error())
             return false;
         ASSERT(nread.value() == count);
         return true;
     }
 
-    auto& entry = cache().get(index);
-    if (!entry.has_data) {
-        u32 base_offset = static_cast<u32>(index) * static_cast<u32>(block_size());
-        file_description().seek(base_offset, SEEK_SET);
-        auto nread = file_description().read(entry.data, block_size());
-        if (nread.is_error())
-            return false;
-        ASSERT(nread.value() == block_size());
-        entry.has_data = true;
+    auto& shard = cache().shard_for(index);
+    for (;;) {
+        {
+            LOCKER(shard.lock);
+            if (auto* entry = cache().get(index)) {
+                if (!entry->has_data && !read_cache_entry(*entry))
+                    return false;
+                if (buffer)
+                    memcpy(buffer, entry->data + offset, count);
+                return true;
+            }
+        }
+        cache().make_room(shard);
     }
-    if (buffer)
-        memcpy(buffer, entry.data + offset, count);
-    return true;
 }
 
 bool BlockBasedFS::read_blocks(unsigned index, unsigned count, u8* buffer, bool allow_cache) const
@@ -252,20 +517,81 @@ bool BlockBasedFS::read_blocks(unsigned index, unsigned count, u8* buffer, bool
     return true;
 }
 
+void BlockBasedFS::read_ahead_blocks(unsigned index, unsigned count) const
+{
+    ASSERT(m_logical_block_size);
+    while (count) {
+        // Split the range at shard cluster boundaries, since each piece is filled under its shard's lock.
+        unsigned cluster_end = (index / DiskCache::blocks_per_shard_cluster + 1) * DiskCache::blocks_per_shard_cluster;
+        unsigned run_length = min(count, cluster_end - index);
+        {
+            LOCKER(cache().shard_for(index).lock);
+            cache().read_ahead(index, run_length);
+        }
+        index += run_length;
+        count -= run_length;
+    }
+}
+
+bool BlockBasedFS::read_cache_blocks(unsigned index, size_t count, u8* buffer) const
+{
+    u32 base_offset = static_cast<u32>(index) * static_cast<u32>(block_size());
+    size_t remaining = count * block_size();
+    // NOTE: The device may read fewer bytes than requested if the run is larger than what it can do in one go.
+    while (remaining) {
+        auto nread = file_description().file().read(file_description(), base_offset, buffer, remaining);
+        if (nread.is_error() || !nread.value())
+            return false;
+        base_offset += nread.value();
+        buffer += nread.value();
+        remaining -= nread.value();
+    }
+    return true;
+}
+
+bool BlockBasedFS::read_cache_entry(CacheEntry& entry) const
+{
+    if (!read_cache_blocks(entry.block_index, 1, entry.data))
+        return false;
+    entry.has_data = true;
+    return true;
+}
+
+void BlockBasedFS::write_cache_blocks(unsigned index, size_t count, const u8* data)
+{
+    u32 base_offset = static_cast<u32>(index) * static_cast<u32>(block_size());
+    size_t remaining = count * block_size();
+    // NOTE: The device may write fewer bytes than requested if the run is larger than what it can do in one go.
+    while (remaining) {
+        auto nwritten = file().write(file_description(), base_offset, data, remaining);
+        // FIXME: Should this error path be surfaced somehow?
+        if (nwritten.is_error() || !nwritten.value())
+            return;
+        base_offset += nwritten.value();
+        data += nwritten.value();
+        remaining -= nwritten.value();
+    }
+}
+
 void BlockBasedFS::flush_specific_block_if_needed(unsigned index)
 {
-    LOCKER(m_lock);
     if (!cache().is_dirty())
         return;
-    cache().for_each_entry([&](CacheEntry& entry) {
-        if (entry.is_dirty && entry.block_index == index) {
-            u32 base_offset = static_cast<u32>(entry.block_index) * static_cast<u32>(block_size());
-            file_description().seek(base_offset, SEEK_SET);
-            // FIXME: Should this error path be surfaced somehow?
-            (void)file_description().write(entry.data, block_size());
-            entry.is_dirty = false;
-        }
-    });
+    Vector<u32, 64> block_indices;
+    block_indices.append(index);
+    cache().write_entries(cache().shard_for(index), block_indices);
+}
+
+void BlockBasedFS::flush_blocks(const Vector<unsigned>& indices)
+{
+    if (!m_cache || indices.is_empty())
+        return;
+    auto count = m_cache->write_back_blocks(indices);
+#ifdef BBFS_DEBUG
+    dbg() << class_name() << ": Flushed " << count << " of " << indices.size() << " blocks";
+#else
+    (void)count;
+#endif
 }
 
 void BlockBasedFS::flush_writes_impl()
@@ -273,18 +599,12 @@ void BlockBasedFS::flush_writes_impl()
     LOCKER(m_lock);
     if (!cache().is_dirty())
         return;
-    u32 count = 0;
-    cache().for_each_entry([&](CacheEntry& entry) {
-        if (!entry.is_dirty)
-            return;
-        u32 base_offset = static_cast<u32>(entry.block_index) * static_cast<u32>(block_size());
-        file_description().seek(base_offset, SEEK_SET);
-        // FIXME: Should this error path be surfaced somehow?
-        (void)file_description().write(entry.data, block_size());
-        ++count;
-        entry.is_dirty = false;
-    });
+    // Anything that's dirtied while we're flushing sets this again.
     cache().set_dirty(false);
+    size_t count = 0;
+    cache().for_each_shard([&](DiskCacheShard& shard) {
+        count += cache().flush_shard(shard);
+    });
     dbg() << class_name() << ": Flushed " << count << " blocks to disk";
 }
 
@@ -293,6 +613,29 @@ void BlockBasedFS::flush_writes()
     flush_writes_impl();
 }
 
+void BlockBasedFS::write_back_dirty_blocks()
+{
+    if (!m_cache || !m_cache->is_dirty())
+        return;
+    auto expire_before = kgettimeofday().tv_sec - WriteBackTask::dirty_expire_seconds;
+    size_t max_dirty = m_cache->entries_per_shard() * WriteBackTask::background_dirty_percentage / 100 / 2;
+    size_t count = 0;
+    m_cache->for_each_shard([&](DiskCacheShard& shard) {
+        count += m_cache->write_back(shard, expire_before, max_dirty);
+    });
+#ifdef BBFS_DEBUG
+    if (count)
+        dbg() << class_name() << ": Wrote back " << count << " blocks";
+#endif
+}
+
+BlockBasedFS::CacheStatistics BlockBasedFS::cache_statistics() const
+{
+    if (!m_cache)
+        return {};
+    return m_cache->statistics();
+}
+
 DiskCache& BlockBasedFS::cache() const
 {
     if (!m_cache)
@@ -30,21 +30,40 @@
 
 namespace Kernel {
 
+struct CacheEntry;
+
 class BlockBasedFS : public FileBackedFS {
 public:
+    struct CacheStatistics {
+        u64 hits { 0 };
+        u64 misses { 0 };
+        u64 evictions { 0 };
+        u64 read_aheads { 0 };
+        size_t entry_count { 0 };
+    };
+
     virtual ~BlockBasedFS() override;
 
     size_t logical_block_size() const { return m_logical_block_size; };
 
     virtual void flush_writes() override;
+    virtual void write_back_dirty_blocks() override;
     void flush_writes_impl();
 
+    // Writes back whichever of the given (distinct) blocks are dirty in the cache, leaving all other dirty blocks alone.
+    void flush_blocks(const Vector<unsigned>& indices);
+
+    CacheStatistics cache_statistics() const;
+
 protected:
     explicit BlockBasedFS(FileDescription&);
 
     bool read_block(unsigned index, u8* buffer, size_t count, size_t offset = 0, bool allow_cache = true) const;
     bool read_blocks(unsigned index, unsigned count, u8* buffer, bool allow_cache = true) const;
 
+    // Pulls the given blocks into the cache ahead of use, reading each run of uncached blocks with a single request.
+    void read_ahead_blocks(unsigned index, unsigned count) const;
+
     bool raw_read(unsigned index, u8* buffer);
     bool raw_write(unsigned index, const u8* buffer);
 
@@ -57,8 +76,15 @@ protected:
     size_t m_logical_block_size { 512 };
 
 private:
+    friend class DiskCache;
+
+    virtual bool is_block_based() const override { return true; }
+
     DiskCache& cache() const;
     void flush_specific_block_if_needed(unsigned index);
+    bool read_cache_entry(CacheEntry&) const;
+    void write_cache_blocks(unsigned index, size_t count, const u8* data);
+    bool read_cache_blocks(unsigned index, size_t count, u8* buffer) const;
 
     mutable OwnPtr<DiskCache> m_cache;
 };
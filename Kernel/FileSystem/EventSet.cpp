@@ -0,0 +1,149 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <Kernel/FileSystem/EventSet.h>
+#include <Kernel/FileSystem/FileDescription.h>
+
+namespace Kernel {
+
+NonnullRefPtr<EventSet> EventSet::create()
+{
+    return adopt(*new EventSet);
+}
+
+EventSet::EventSet()
+{
+}
+
+EventSet::~EventSet()
+{
+}
+
+EventSet::Registration* EventSet::find_registration(int fd)
+{
+    for (auto& registration : m_registrations) {
+        if (registration.fd == fd)
+            return &registration;
+    }
+    return nullptr;
+}
+
+KResult EventSet::add(int fd, FileDescription& description, u32 events, void* data)
+{
+    ScopedSpinLock lock(m_lock);
+    if (auto* registration = find_registration(fd)) {
+        // The fd may have been closed and reused since it was registered.
+        if (registration->description.ptr() == &description)
+            return KResult(-EEXIST);
+        *registration = { fd, description.make_weak_ptr(), events, data, 0, description.transfer_count() };
+        return KSuccess;
+    }
+    m_registrations.append({ fd, description.make_weak_ptr(), events, data, 0, description.transfer_count() });
+    return KSuccess;
+}
+
+KResult EventSet::modify(int fd, FileDescription& description, u32 events, void* data)
+{
+    ScopedSpinLock lock(m_lock);
+    auto* registration = find_registration(fd);
+    if (!registration || registration->description.ptr() != &description)
+        return KResult(-ENOENT);
+    registration->events = events;
+    registration->data = data;
+    registration->reported_events = 0;
+    return KSuccess;
+}
+
+KResult EventSet::remove(int fd)
+{
+    ScopedSpinLock lock(m_lock);
+    for (size_t i = 0; i < m_registrations.size(); ++i) {
+        if (m_registrations[i].fd == fd) {
+            m_registrations.remove(i);
+            return KSuccess;
+        }
+    }
+    return KResult(-ENOENT);
+}
+
+u32 EventSet::pending_events(Registration& registration) const
+{
+    auto* description = registration.description.ptr();
+    if (!description)
+        return 0;
+
+    u32 ready_events = 0;
+    if ((registration.events & EVENT_SET_IN) && description->can_read())
+        ready_events |= EVENT_SET_IN;
+    if ((registration.events & EVENT_SET_OUT) && description->can_write())
+        ready_events |= EVENT_SET_OUT;
+
+    if (!(registration.events & EVENT_SET_EDGE_TRIGGERED))
+        return ready_events;
+
+    if (registration.seen_transfer_count != description->transfer_count()) {
+        registration.seen_transfer_count = description->transfer_count();
+        registration.reported_events = 0;
+    }
+    registration.reported_events &= ready_events;
+    return ready_events & ~registration.reported_events;
+}
+
+bool EventSet::has_ready_events() const
+{
+    ScopedSpinLock lock(m_lock);
+    for (auto& registration : m_registrations) {
+        if (pending_events(registration))
+            return true;
+    }
+    return false;
+}
+
+size_t EventSet::collect_ready_events(event_set_event* events, size_t max_events)
+{
+    ScopedSpinLock lock(m_lock);
+    m_registrations.remove_all_matching([](auto& registration) {
+        return !registration.description;
+    });
+
+    size_t count = 0;
+    size_t registration_count = m_registrations.size();
+    // Start where the last collection left off so that a short buffer doesn't starve the registrations at the end.
+    size_t scanned = 0;
+    for (; scanned < registration_count && count < max_events; ++scanned) {
+        auto& registration = m_registrations[(m_next_scan_index + scanned) % registration_count];
+        u32 pending = pending_events(registration);
+        if (!pending)
+            continue;
+        registration.reported_events |= pending;
+        events[count++] = { pending, registration.data };
+    }
+    if (registration_count)
+        m_next_scan_index = (m_next_scan_index + scanned) % registration_count;
+    return count;
+}
+
+}
@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/Vector.h>
+#include <AK/WeakPtr.h>
+#include <Kernel/FileSystem/File.h>
+#include <Kernel/SpinLock.h>
+#include <Kernel/UnixTypes.h>
+
+namespace Kernel {
+
+// A persistent set of file descriptors to wait on, so that waiters don't have to hand the kernel
+// their whole interest list on every call the way select() and poll() do.
+class EventSet final : public File {
+public:
+    static NonnullRefPtr<EventSet> create();
+    virtual ~EventSet() override;
+
+    KResult add(int fd, FileDescription&, u32 events, void* data);
+    KResult modify(int fd, FileDescription&, u32 events, void* data);
+    KResult remove(int fd);
+
+    bool has_ready_events() const;
+    size_t collect_ready_events(event_set_event*, size_t max_events);
+
+    virtual bool can_read(const FileDescription&, size_t) const override { return has_ready_events(); }
+    virtual bool can_write(const FileDescription&, size_t) const override { return false; }
+    virtual KResultOr<size_t> read(FileDescription&, size_t, u8*, size_t) override { return KResult(-EINVAL); }
+    virtual KResultOr<size_t> write(FileDescription&, size_t, const u8*, size_t) override { return KResult(-EINVAL); }
+    virtual String absolute_path(const FileDescription&) const override { return "EventSet"; }
+    virtual const char* class_name() const override { return "EventSet"; }
+    virtual bool is_event_set() const override { return true; }
+
+private:
+    EventSet();
+
+    struct Registration {
+        int fd { -1 };
+        WeakPtr<FileDescription> description;
+        u32 events { 0 };
+        void* data { nullptr };
+
+        // Edge-triggered registrations only report an event once until it is re-armed,
+        // either by being seen not ready or by I/O through the description.
+        u32 reported_events { 0 };
+        u32 seen_transfer_count { 0 };
+    };
+
+    Registration* find_registration(int fd);
+    u32 pending_events(Registration&) const;
+
+    mutable SpinLock<u8> m_lock;
+    mutable Vector<Registration> m_registrations;
+    size_t m_next_scan_index { 0 };
+};
+
+}
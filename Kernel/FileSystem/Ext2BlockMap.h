@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/Types.h>
+#include <AK/Vector.h>
+
+namespace Kernel {
+
+// Maps an inode's logical blocks to disk blocks as a sorted list of extents (runs of consecutive disk blocks),
+// so that even very large files take little memory and any block can be found with a binary search.
+class Ext2BlockMap {
+public:
+    using BlockIndex = u32;
+
+    struct Extent {
+        size_t logical_start { 0 };
+        size_t length { 0 };
+        // The disk block backing logical_start. Zero for a hole in a sparse file.
+        BlockIndex first_block { 0 };
+
+        size_t logical_end() const { return logical_start + length; }
+        BlockIndex block_at(size_t logical_index) const { return first_block ? first_block + (logical_index - logical_start) : 0; }
+    };
+
+    static Ext2BlockMap from_block_list(const Vector<BlockIndex>& blocks)
+    {
+        Ext2BlockMap map;
+        for (auto block : blocks)
+            map.append(block);
+        return map;
+    }
+
+    bool is_empty() const { return m_block_count == 0; }
+    size_t size() const { return m_block_count; }
+    const Vector<Extent>& extents() const { return m_extents; }
+
+    const Extent& extent_containing(size_t logical_index) const
+    {
+        ASSERT(logical_index < m_block_count);
+        size_t low = 0;
+        size_t high = m_extents.size();
+        while (high - low > 1) {
+            size_t middle = low + (high - low) / 2;
+            if (m_extents[middle].logical_start <= logical_index)
+                low = middle;
+            else
+                high = middle;
+        }
+        return m_extents[low];
+    }
+
+    BlockIndex operator[](size_t logical_index) const { return extent_containing(logical_index).block_at(logical_index); }
+
+    BlockIndex last() const { return m_extents.last().block_at(m_block_count - 1); }
+
+    void append(BlockIndex block)
+    {
+        if (!m_extents.is_empty()) {
+            auto& extent = m_extents.last();
+            bool extends_hole = !extent.first_block && !block;
+            bool extends_run = extent.first_block && block == extent.first_block + extent.length;
+            if (extends_hole || extends_run) {
+                ++extent.length;
+                ++m_block_count;
+                return;
+            }
+        }
+        m_extents.append({ m_block_count, 1, block });
+        ++m_block_count;
+    }
+
+    void append(const Vector<BlockIndex>& blocks)
+    {
+        for (auto block : blocks)
+            append(block);
+    }
+
+    BlockIndex take_last()
+    {
+        auto block = last();
+        auto& extent = m_extents.last();
+        if (!--extent.length)
+            m_extents.take_last();
+        --m_block_count;
+        return block;
+    }
+
+    void clear()
+    {
+        m_extents.clear();
+        m_block_count = 0;
+    }
+
+private:
+    Vector<Extent> m_extents;
+    size_t m_block_count { 0 };
+};
+
+}
@@ -27,6 +27,7 @@
 #include <AK/Bitmap.h>
 #include <AK/BufferStream.h>
 #include <AK/HashMap.h>
+#include <AK/QuickSort.h>
 #include <AK/StdLibExtras.h>
 #include <AK/StringView.h>
 #include <Kernel/Devices/BlockDevice.h>
@@ -64,6 +65,28 @@ static u8 to_ext2_file_type(mode_t mode)
     return EXT2_FT_UNKNOWN;
 }
 
+u8 Ext2FS::internal_file_type_to_directory_entry_type(const DirectoryEntry& entry) const
+{
+    switch (entry.file_type) {
+    case EXT2_FT_REG_FILE:
+        return DT_REG;
+    case EXT2_FT_DIR:
+        return DT_DIR;
+    case EXT2_FT_CHRDEV:
+        return DT_CHR;
+    case EXT2_FT_BLKDEV:
+        return DT_BLK;
+    case EXT2_FT_FIFO:
+        return DT_FIFO;
+    case EXT2_FT_SOCK:
+        return DT_SOCK;
+    case EXT2_FT_SYMLINK:
+        return DT_LNK;
+    default:
+        return DT_UNKNOWN;
+    }
+}
+
 NonnullRefPtr<Ext2FS> Ext2FS::create(FileDescription& file_description)
 {
     return adopt(*new Ext2FS(file_description));
@@ -214,7 +237,7 @@ Ext2FS::BlockListShape Ext2FS::compute_block_list_shape(unsigned blocks)
     return {};
 }
 
-bool Ext2FS::write_block_list_for_inode(InodeIndex inode_index, ext2_inode& e2inode, const Vector<BlockIndex>& blocks)
+bool Ext2FS::write_block_list_for_inode(InodeIndex inode_index, ext2_inode& e2inode, const Ext2BlockMap& blocks, Vector<BlockIndex>* written_meta_blocks)
 {
     LOCKER(m_lock);
 
@@ -287,6 +310,8 @@ bool Ext2FS::write_block_list_for_inode(InodeIndex inode_index, ext2_inode& e2in
         stream.fill_to_end(0);
         bool success = write_block(e2inode.i_block[EXT2_IND_BLOCK], block_contents.data(), block_size());
         ASSERT(success);
+        if (written_meta_blocks)
+            written_meta_blocks->append(e2inode.i_block[EXT2_IND_BLOCK]);
     }
 
     if (!remaining_blocks)
@@ -327,12 +352,22 @@ bool Ext2FS::write_block_list_for_inode(InodeIndex inode_index, ext2_inode& e2in
         }
         auto* dind_block_as_pointers = (unsigned*)dind_block_contents.data();
 
+        // Indirect blocks that only map blocks below both the old and new end haven't changed.
+        size_t unchanged_block_count = min(old_block_count, blocks.size());
+
         ASSERT(indirect_block_count <= entries_per_block);
         for (unsigned i = 0; i < indirect_block_count; ++i) {
             bool ind_block_dirty = false;
 
             BlockIndex indirect_block_index = dind_block_as_pointers[i];
 
+            unsigned entries_in_block = min(new_shape.doubly_indirect_blocks - (i * entries_per_block), entries_per_block);
+            if (indirect_block_index && output_block_index + entries_per_block <= unchanged_block_count) {
+                output_block_index += entries_in_block;
+                remaining_blocks -= entries_in_block;
+                continue;
+            }
+
             bool ind_block_new = !indirect_block_index;
             if (ind_block_new) {
                 indirect_block_index = new_meta_blocks.take_last();
@@ -372,6 +407,8 @@ bool Ext2FS::write_block_list_for_inode(InodeIndex inode_index, ext2_inode& e2in
             if (ind_block_dirty) {
                 bool success = write_block(indirect_block_index, ind_block_contents.data(), block_size());
                 ASSERT(success);
+                if (written_meta_blocks)
+                    written_meta_blocks->append(indirect_block_index);
             }
         }
         for (unsigned i = indirect_block_count; i < entries_per_block; ++i) {
@@ -384,6 +421,8 @@ bool Ext2FS::write_block_list_for_inode(InodeIndex inode_index, ext2_inode& e2in
         if (dind_block_dirty) {
             bool success = write_block(e2inode.i_block[EXT2_DIND_BLOCK], dind_block_contents.data(), block_size());
             ASSERT(success);
+            if (written_meta_blocks)
+                written_meta_blocks->append(e2inode.i_block[EXT2_DIND_BLOCK]);
         }
     }
 
@@ -501,6 +540,11 @@ void Ext2FS::free_inode(Ext2FSInode& inode)
     inode.m_raw_inode.i_dtime = now.tv_sec;
     write_ext2_inode(inode.index(), inode.m_raw_inode);
 
+    {
+        LOCKER(inode.m_lock);
+        inode.discard_reserved_blocks();
+    }
+
     auto block_list = block_list_for_inode(inode.m_raw_inode, true);
 
     for (auto block_index : block_list) {
@@ -550,22 +594,84 @@ void Ext2FS::flush_writes()
 
     BlockBasedFS::flush_writes();
 
-    // Uncache Inodes that are only kept alive by the index-to-inode lookup cache.
-    // We don't uncache Inodes that are being watched by at least one InodeWatcher.
+    // Everything is on disk now, so there is nothing left for fsync() to write back.
+    for (auto& it : m_inode_cache) {
+        if (!it.value)
+            continue;
+        it.value->m_dirty_blocks.clear();
+        it.value->m_dirty_blocks_overflowed = false;
+    }
+    evict_unused_inodes();
+}
 
-    // FIXME: It would be better to keep a capped number of Inodes around.
-    //        The problem is that they are quite heavy objects, and use a lot of heap memory
-    //        for their (child name lookup) and (block list) caches.
-    Vector<InodeIndex> unused_inodes;
+void Ext2FS::evict_unused_inodes() const
+{
+    ASSERT(m_lock.is_locked());
+    if (m_inode_cache.size() <= max_cached_inodes)
+        return;
+
+    // Only Inodes that are kept alive by the cache alone can go. We also keep the ones that are
+    // being watched, and the ones with changes that only they know about: metadata that hasn't been
+    // flushed yet, or blocks that fsync() would have to write back.
+    struct Candidate {
+        InodeIndex index;
+        u64 last_use;
+    };
+    Vector<Candidate> candidates;
     for (auto& it : m_inode_cache) {
-        if (it.value->ref_count() != 1)
+        auto& inode = it.value;
+        if (!inode) {
+            // Remembering that an inode doesn't exist is the cheapest thing to forget.
+            candidates.append({ it.key, 0 });
             continue;
-        if (it.value->has_watchers())
+        }
+        if (inode->ref_count() != 1 || inode->has_watchers() || inode->is_metadata_dirty())
+            continue;
+        if (!inode->m_dirty_blocks.is_empty() || inode->m_dirty_blocks_overflowed)
+            continue;
+        candidates.append({ it.key, inode->m_last_use });
+    }
+    quick_sort(candidates, [](auto& a, auto& b) { return a.last_use < b.last_use; });
+
+    // Go well below the limit, so that the next few misses don't have to do this again.
+    size_t target_count = max_cached_inodes / 4 * 3;
+    size_t evict_count = min(m_inode_cache.size() - target_count, candidates.size());
+    for (size_t i = 0; i < evict_count; ++i)
+        m_inode_cache.remove(candidates[i].index);
+#ifdef EXT2_DEBUG
+    dbg() << "Ext2FS: Evicted " << evict_count << " inodes, " << m_inode_cache.size() << " left in cache";
+#endif
+}
+
+void Ext2FS::read_ahead_inodes(const Vector<InodeIdentifier>& inodes) const
+{
+    LOCKER(m_lock);
+    Vector<BlockIndex> blocks;
+    for (auto& inode : inodes) {
+        if (inode.fsid() != fsid() || m_inode_cache.contains(inode.index()))
             continue;
-        unused_inodes.append(it.key);
+        unsigned block_index;
+        unsigned offset;
+        if (!find_block_containing_inode(inode.index(), block_index, offset))
+            continue;
+        if (blocks.is_empty() || blocks.last() != block_index)
+            blocks.append(block_index);
+    }
+    if (blocks.is_empty())
+        return;
+    quick_sort(blocks);
+
+    // Read the inode table blocks in ascending runs. Blocks that are already cached are skipped by read_ahead_blocks().
+    for (size_t i = 0; i < blocks.size();) {
+        auto first_block = blocks[i];
+        auto last_block = first_block;
+        ++i;
+        while (i < blocks.size() && blocks[i] <= last_block + 1 + max_inode_table_read_ahead_gap) {
+            last_block = blocks[i];
+            ++i;
+        }
+        read_ahead_blocks(first_block, last_block - first_block + 1);
     }
-    for (auto index : unused_inodes)
-        uncache_inode(index);
 }
 
 Ext2FSInode::Ext2FSInode(Ext2FS& fs, unsigned index)
@@ -630,10 +736,15 @@ RefPtr<Inode> Ext2FS::get_inode(InodeIdentifier inode) const
 
     {
         auto it = m_inode_cache.find(inode.index());
-        if (it != m_inode_cache.end())
+        if (it != m_inode_cache.end()) {
+            if (auto& cached_inode = (*it).value)
+                cached_inode->m_last_use = ++m_inode_cache_use_counter;
             return (*it).value;
+        }
     }
 
+    evict_unused_inodes();
+
     if (!get_inode_allocation_state(inode.index())) {
         m_inode_cache.set(inode.index(), nullptr);
         return nullptr;
@@ -646,6 +757,7 @@ RefPtr<Inode> Ext2FS::get_inode(InodeIdentifier inode) const
 
     auto new_inode = adopt(*new Ext2FSInode(const_cast<Ext2FS&>(*this), inode.index()));
     read_block(block_index, reinterpret_cast<u8*>(&new_inode->m_raw_inode), sizeof(ext2_inode), offset);
+    new_inode->m_last_use = ++m_inode_cache_use_counter;
     m_inode_cache.set(inode.index(), new_inode);
     return new_inode;
 }
@@ -668,10 +780,8 @@ ssize_t Ext2FSInode::read_bytes(off_t offset, ssize_t count, u8* buffer, FileDes
 
     Locker fs_locker(fs().m_lock);
 
-    if (m_block_list.is_empty())
-        m_block_list = fs().block_list_for_inode(m_raw_inode);
-
-    if (m_block_list.is_empty()) {
+    auto& block_map = this->block_map();
+    if (block_map.is_empty()) {
         klog() << "ext2fs: read_bytes: empty block list for inode " << index();
         return -EIO;
     }
@@ -682,8 +792,8 @@ ssize_t Ext2FSInode::read_bytes(off_t offset, ssize_t count, u8* buffer, FileDes
 
     size_t first_block_logical_index = offset / block_size;
     size_t last_block_logical_index = (offset + count) / block_size;
-    if (last_block_logical_index >= m_block_list.size())
-        last_block_logical_index = m_block_list.size() - 1;
+    if (last_block_logical_index >= block_map.size())
+        last_block_logical_index = block_map.size() - 1;
 
     int offset_into_first_block = offset % block_size;
 
@@ -696,7 +806,7 @@ ssize_t Ext2FSInode::read_bytes(off_t offset, ssize_t count, u8* buffer, FileDes
 #endif
 
     for (size_t bi = first_block_logical_index; remaining_count && bi <= last_block_logical_index; ++bi) {
-        auto block_index = m_block_list[bi];
+        auto block_index = block_map[bi];
         ASSERT(block_index);
         size_t offset_into_block = (bi == first_block_logical_index) ? offset_into_first_block : 0;
         size_t num_bytes_to_copy = min(block_size - offset_into_block, remaining_count);
@@ -710,9 +820,79 @@ ssize_t Ext2FSInode::read_bytes(off_t offset, ssize_t count, u8* buffer, FileDes
         out += num_bytes_to_copy;
     }
 
+    if (allow_cache && description)
+        read_ahead(description->read_ahead_state(), offset, nread);
+
     return nread;
 }
 
+void Ext2FSInode::read_ahead(FileDescription::ReadAheadState& state, off_t offset, size_t nread) const
+{
+    ASSERT(m_lock.is_locked());
+    using ReadAheadState = FileDescription::ReadAheadState;
+
+    // Any read that doesn't pick up where the previous one left off resets the window.
+    if (offset != state.expected_offset) {
+        state.expected_offset = offset + nread;
+        state.prefetched_until = 0;
+        state.window = 0;
+        return;
+    }
+    state.expected_offset = offset + nread;
+    state.window = state.window ? min(state.window * 2, ReadAheadState::max_window) : ReadAheadState::min_window;
+
+    // Start the next batch once the reader is halfway through the previous one, so it rarely has to wait.
+    off_t read_end = offset + nread;
+    if (state.prefetched_until > read_end + (off_t)state.window / 2)
+        return;
+
+    const size_t block_size = fs().block_size();
+    size_t first_block = max(read_end, state.prefetched_until) / block_size;
+    size_t end_block = min(ceil_div((size_t)read_end + state.window, block_size), m_block_map.size());
+    if (first_block >= end_block)
+        return;
+    state.prefetched_until = (off_t)end_block * block_size;
+
+    // Prefetch each physically contiguous run of the file's blocks in one go.
+    for (size_t bi = first_block; bi < end_block;) {
+        auto& extent = m_block_map.extent_containing(bi);
+        size_t run_length = min(extent.logical_end(), end_block) - bi;
+        if (extent.first_block)
+            fs().read_ahead_blocks(extent.block_at(bi), run_length);
+        bi += run_length;
+    }
+}
+
+void Ext2FSInode::discard_reserved_blocks()
+{
+    ASSERT(m_lock.is_locked());
+    for (auto block_index : m_reserved_blocks)
+        fs().set_block_allocation_state(block_index, false);
+    m_reserved_blocks.clear();
+}
+
+void Ext2FSInode::note_dirty_block(Ext2BlockMap::BlockIndex block_index)
+{
+    // NOTE: The dirty block tracking is guarded by the filesystem lock, since Ext2FS::flush_writes() resets it.
+    LOCKER(fs().m_lock);
+    if (m_dirty_blocks_overflowed)
+        return;
+    if (m_dirty_blocks.size() >= max_tracked_dirty_blocks) {
+        m_dirty_blocks.clear();
+        m_dirty_blocks_overflowed = true;
+        return;
+    }
+    m_dirty_blocks.set(block_index);
+}
+
+const Ext2BlockMap& Ext2FSInode::block_map() const
+{
+    ASSERT(m_lock.is_locked());
+    if (m_block_map.is_empty())
+        m_block_map = Ext2BlockMap::from_block_list(fs().block_list_for_inode(m_raw_inode));
+    return m_block_map;
+}
+
 KResult Ext2FSInode::resize(u64 new_size)
 {
     u64 old_size = size();
@@ -734,15 +914,39 @@ KResult Ext2FSInode::resize(u64 new_size)
             return KResult(-ENOSPC);
     }
 
-    auto block_list = fs().block_list_for_inode(m_raw_inode);
+    auto block_list = block_map();
     if (blocks_needed_after > blocks_needed_before) {
-        auto new_blocks = fs().allocate_blocks(fs().group_index_from_inode(index()), blocks_needed_after - blocks_needed_before);
-        block_list.append(move(new_blocks));
+        size_t additional_blocks_needed = blocks_needed_after - blocks_needed_before;
+
+        // Blocks reserved by an earlier append continue the file, so use those first.
+        while (additional_blocks_needed && !m_reserved_blocks.is_empty()) {
+            block_list.append(m_reserved_blocks.take_first());
+            --additional_blocks_needed;
+        }
+
+        if (additional_blocks_needed) {
+            // A file that keeps growing is likely to grow some more, so reserve room right after the new end.
+            size_t blocks_to_reserve = 0;
+            if (is_regular_file(m_raw_inode.i_mode) && !block_list.is_empty())
+                blocks_to_reserve = clamp(additional_blocks_needed, min_reserved_blocks, max_reserved_blocks);
+            if (additional_blocks_needed + blocks_to_reserve > fs().super_block().s_free_blocks_count)
+                blocks_to_reserve = 0;
+
+            Ext2FS::BlockIndex goal = block_list.is_empty() || !block_list.last() ? 0 : block_list.last() + 1;
+            auto new_blocks = fs().allocate_blocks(fs().group_index_from_inode(index()), additional_blocks_needed + blocks_to_reserve, goal);
+            for (size_t i = 0; i < new_blocks.size(); ++i) {
+                if (i < additional_blocks_needed)
+                    block_list.append(new_blocks[i]);
+                else
+                    m_reserved_blocks.append(new_blocks[i]);
+            }
+        }
     } else if (blocks_needed_after < blocks_needed_before) {
+        discard_reserved_blocks();
 #ifdef EXT2_DEBUG
         dbg() << "Ext2FS: Shrinking inode " << identifier() << ". Old block list is " << block_list.size() << " entries:";
-        for (auto block_index : block_list) {
-            dbg() << "    # " << block_index;
+        for (auto& extent : block_list.extents()) {
+            dbg() << "    # " << extent.first_block << " x" << extent.length;
         }
 #endif
         while (block_list.size() != blocks_needed_after) {
@@ -752,14 +956,18 @@ KResult Ext2FSInode::resize(u64 new_size)
         }
     }
 
-    bool success = fs().write_block_list_for_inode(index(), m_raw_inode, block_list);
+    Vector<Ext2FS::BlockIndex> written_meta_blocks;
+    bool success = fs().write_block_list_for_inode(index(), m_raw_inode, block_list, &written_meta_blocks);
     if (!success)
         return KResult(-EIO);
+    for (auto block_index : written_meta_blocks)
+        note_dirty_block(block_index);
 
     m_raw_inode.i_size = new_size;
     set_metadata_dirty(true);
+    m_size_or_block_list_dirty = true;
 
-    m_block_list = move(block_list);
+    m_block_map = move(block_list);
     return KSuccess;
 }
 
@@ -785,6 +993,7 @@ ssize_t Ext2FSInode::write_bytes(off_t offset, ssize_t count, const u8* data, Fi
             if ((size_t)(offset + count) > (size_t)m_raw_inode.i_size)
                 m_raw_inode.i_size = offset + count;
             set_metadata_dirty(true);
+            m_size_or_block_list_dirty = true;
             return count;
         }
     }
@@ -799,18 +1008,16 @@ ssize_t Ext2FSInode::write_bytes(off_t offset, ssize_t count, const u8* data, Fi
     if (resize_result.is_error())
         return resize_result;
 
-    if (m_block_list.is_empty())
-        m_block_list = fs().block_list_for_inode(m_raw_inode);
-
-    if (m_block_list.is_empty()) {
+    auto& block_map = this->block_map();
+    if (block_map.is_empty()) {
         dbg() << "Ext2FSInode::write_bytes(): empty block list for inode " << index();
         return -EIO;
     }
 
     size_t first_block_logical_index = offset / block_size;
     size_t last_block_logical_index = (offset + count) / block_size;
-    if (last_block_logical_index >= m_block_list.size())
-        last_block_logical_index = m_block_list.size() - 1;
+    if (last_block_logical_index >= block_map.size())
+        last_block_logical_index = block_map.size() - 1;
 
     size_t offset_into_first_block = offset % block_size;
 
@@ -826,21 +1033,24 @@ ssize_t Ext2FSInode::write_bytes(off_t offset, ssize_t count, const u8* data, Fi
         size_t offset_into_block = (bi == first_block_logical_index) ? offset_into_first_block : 0;
         size_t num_bytes_to_copy = min(block_size - offset_into_block, remaining_count);
 #ifdef EXT2_DEBUG
-        dbg() << "Ext2FS: Writing block " << m_block_list[bi] << " (offset_into_block: " << offset_into_block << ")";
+        dbg() << "Ext2FS: Writing block " << block_map[bi] << " (offset_into_block: " << offset_into_block << ")";
 #endif
-        bool success = fs().write_block(m_block_list[bi], in, num_bytes_to_copy, offset_into_block, allow_cache);
+        bool success = fs().write_block(block_map[bi], in, num_bytes_to_copy, offset_into_block, allow_cache);
         if (!success) {
-            dbg() << "Ext2FS: write_block(" << m_block_list[bi] << ") failed (bi: " << bi << ")";
+            dbg() << "Ext2FS: write_block(" << block_map[bi] << ") failed (bi: " << bi << ")";
             ASSERT_NOT_REACHED();
             return -EIO;
         }
+        // Uncached writes have already gone straight to the device.
+        if (allow_cache)
+            note_dirty_block(block_map[bi]);
         remaining_count -= num_bytes_to_copy;
         nwritten += num_bytes_to_copy;
         in += num_bytes_to_copy;
     }
 
 #ifdef EXT2_DEBUG
-    dbg() << "Ext2FS: After write, i_size=" << m_raw_inode.i_size << ", i_blocks=" << m_raw_inode.i_blocks << " (" << m_block_list.size() << " blocks in list)";
+    dbg() << "Ext2FS: After write, i_size=" << m_raw_inode.i_size << ", i_blocks=" << m_raw_inode.i_blocks << " (" << block_map.size() << " blocks in list)";
 #endif
 
     if (old_size != new_size)
@@ -1060,71 +1270,122 @@ bool Ext2FS::write_ext2_inode(unsigned inode, const ext2_inode& e2inode)
     return write_block(block_index, reinterpret_cast<const u8*>(&e2inode), inode_size(), offset);
 }
 
-Vector<Ext2FS::BlockIndex> Ext2FS::allocate_blocks(GroupIndex preferred_group_index, size_t count)
+Ext2FS::GroupIndex Ext2FS::group_with_most_free_blocks() const
+{
+    GroupIndex best_group_index = 0;
+    unsigned best_free_count = 0;
+    for (GroupIndex group_index = 1; group_index <= m_block_group_count; ++group_index) {
+        auto free_count = group_descriptor(group_index).bg_free_blocks_count;
+        if (free_count > best_free_count) {
+            best_group_index = group_index;
+            best_free_count = free_count;
+        }
+    }
+    return best_group_index;
+}
+
+size_t Ext2FS::blocks_in_group(GroupIndex group_index) const
+{
+    BlockIndex first_block_in_group = (group_index - 1) * blocks_per_group() + first_block_index();
+    return min(blocks_per_group(), super_block().s_blocks_count - first_block_in_group);
+}
+
+// Picks where in a group's block bitmap to allocate up to wanted blocks, preferring (in this order) to continue
+// right at goal, a single run that fits the whole request at or after goal, one anywhere, and finally the longest run.
+static Optional<size_t> find_free_run(const Bitmap& bitmap, size_t goal, size_t wanted, size_t& found_length)
+{
+    found_length = 0;
+    while (goal + found_length < bitmap.size() && found_length < wanted && !bitmap.get(goal + found_length))
+        ++found_length;
+    if (found_length)
+        return goal;
+
+    for (size_t from : { goal, (size_t)0 }) {
+        size_t start = from;
+        auto length = bitmap.find_next_range_of_unset_bits(start, wanted, wanted);
+        if (length.has_value()) {
+            found_length = length.value();
+            return start;
+        }
+    }
+
+    return bitmap.find_longest_range_of_unset_bits(wanted, found_length);
+}
+
+Vector<Ext2FS::BlockIndex> Ext2FS::allocate_blocks(GroupIndex preferred_group_index, size_t count, BlockIndex goal)
 {
     LOCKER(m_lock);
 #ifdef EXT2_DEBUG
-    dbg() << "Ext2FS: allocate_blocks(preferred group: " << preferred_group_index << ", count: " << count << ")";
+    dbg() << "Ext2FS: allocate_blocks(preferred group: " << preferred_group_index << ", count: " << count << ", goal: " << goal << ")";
 #endif
     if (count == 0)
         return {};
 
     Vector<BlockIndex> blocks;
-#ifdef EXT2_DEBUG
-    dbg() << "Ext2FS: allocate_blocks:";
-#endif
     blocks.ensure_capacity(count);
 
-    GroupIndex group_index = preferred_group_index;
-
-    if (!group_descriptor(preferred_group_index).bg_free_blocks_count) {
-        group_index = 1;
-    }
+    if (goal >= super_block().s_blocks_count)
+        goal = 0;
+    GroupIndex group_index = goal ? group_index_from_block_index(goal) : preferred_group_index;
 
     while (blocks.size() < count) {
-
-        bool found_a_group = false;
-        if (group_descriptor(group_index).bg_free_blocks_count) {
-            found_a_group = true;
-        } else {
-            if (group_index == preferred_group_index)
-                group_index = 1;
-            for (; group_index < m_block_group_count; ++group_index) {
-                if (group_descriptor(group_index).bg_free_blocks_count) {
-                    found_a_group = true;
-                    break;
-                }
-            }
+        if (!group_descriptor(group_index).bg_free_blocks_count) {
+            // Spill over into whichever group has the most room, so the rest of the request stays as contiguous as possible.
+            group_index = group_with_most_free_blocks();
+            ASSERT(group_index);
+            goal = 0;
         }
 
-        ASSERT(found_a_group);
         auto& bgd = group_descriptor(group_index);
         auto& cached_bitmap = get_bitmap_block(bgd.bg_block_bitmap);
+        auto block_bitmap = Bitmap::wrap(cached_bitmap.buffer.data(), blocks_in_group(group_index));
+        BlockIndex first_block_in_group = (group_index - 1) * blocks_per_group() + first_block_index();
 
-        int blocks_in_group = min(blocks_per_group(), super_block().s_blocks_count);
-        auto block_bitmap = Bitmap::wrap(cached_bitmap.buffer.data(), blocks_in_group);
+        size_t goal_in_group = 0;
+        if (goal >= first_block_in_group && goal < first_block_in_group + block_bitmap.size())
+            goal_in_group = goal - first_block_in_group;
+
+        size_t run_length = 0;
+        auto run_start = find_free_run(block_bitmap, goal_in_group, count - blocks.size(), run_length);
+        ASSERT(run_start.has_value());
+        ASSERT(run_length);
 
-        BlockIndex first_block_in_group = (group_index - 1) * blocks_per_group() + first_block_index();
-        size_t free_region_size = 0;
-        auto first_unset_bit_index = block_bitmap.find_longest_range_of_unset_bits(count - blocks.size(), free_region_size);
-        ASSERT(first_unset_bit_index.has_value());
-#ifdef EXT2_DEBUG
-        dbg() << "Ext2FS: allocating free region of size: " << free_region_size << "[" << group_index << "]";
-#endif
-        for (size_t i = 0; i < free_region_size; ++i) {
-            BlockIndex block_index = (first_unset_bit_index.value() + i) + first_block_in_group;
-            set_block_allocation_state(block_index, true);
-            blocks.unchecked_append(block_index);
 #ifdef EXT2_DEBUG
-            dbg() << "  allocated > " << block_index;
+        dbg() << "Ext2FS: allocating free region of size: " << run_length << "[" << group_index << "]";
 #endif
-        }
+        BlockIndex first_block = first_block_in_group + run_start.value();
+        set_block_range_allocation_state(first_block, run_length, true);
+        for (size_t i = 0; i < run_length; ++i)
+            blocks.unchecked_append(first_block + i);
+        goal = first_block + run_length;
     }
 
     ASSERT(blocks.size() == count);
     return blocks;
 }
 
+unsigned Ext2FS::free_extent_count() const
+{
+    LOCKER(m_lock);
+    unsigned count = 0;
+    for (GroupIndex group_index = 1; group_index <= m_block_group_count; ++group_index) {
+        auto& bgd = group_descriptor(group_index);
+        if (!bgd.bg_free_blocks_count)
+            continue;
+        auto& cached_bitmap = const_cast<Ext2FS&>(*this).get_bitmap_block(bgd.bg_block_bitmap);
+        auto block_bitmap = Bitmap::wrap(cached_bitmap.buffer.data(), blocks_in_group(group_index));
+        size_t start = 0;
+        for (;;) {
+            auto length = block_bitmap.find_next_range_of_unset_bits(start);
+            if (!length.has_value())
+                break;
+            ++count;
+            start += length.value();
+        }
+    }
+    return count;
+}
+
 unsigned Ext2FS::find_a_free_inode(GroupIndex preferred_group, off_t expected_size)
 {
     ASSERT(expected_size >= 0);
@@ -1292,50 +1553,56 @@ Ext2FS::CachedBitmap& Ext2FS::get_bitmap_block(BlockIndex bitmap_block_index)
 
 bool Ext2FS::set_block_allocation_state(BlockIndex block_index, bool new_state)
 {
-    ASSERT(block_index != 0);
+    return set_block_range_allocation_state(block_index, 1, new_state);
+}
+
+bool Ext2FS::set_block_range_allocation_state(BlockIndex first_block_index, size_t count, bool new_state)
+{
+    ASSERT(first_block_index != 0);
+    ASSERT(count);
     LOCKER(m_lock);
 #ifdef EXT2_DEBUG
-    dbg() << "Ext2FS: set_block_allocation_state(block=" << block_index << ", state=" << String::format("%u", new_state) << ")";
+    dbg() << "Ext2FS: set_block_range_allocation_state(block=" << first_block_index << ", count=" << count << ", state=" << String::format("%u", new_state) << ")";
 #endif
 
-    GroupIndex group_index = group_index_from_block_index(block_index);
+    GroupIndex group_index = group_index_from_block_index(first_block_index);
+    ASSERT(group_index_from_block_index(first_block_index + count - 1) == group_index);
     auto& bgd = group_descriptor(group_index);
-    BlockIndex index_in_group = (block_index - first_block_index()) - ((group_index - 1) * blocks_per_group());
-    unsigned bit_index = index_in_group % blocks_per_group();
+    BlockIndex index_in_group = (first_block_index - this->first_block_index()) - ((group_index - 1) * blocks_per_group());
+    unsigned first_bit_index = index_in_group % blocks_per_group();
 
     auto& cached_bitmap = get_bitmap_block(bgd.bg_block_bitmap);
+    auto bitmap = cached_bitmap.bitmap(blocks_per_group());
 
-    bool current_state = cached_bitmap.bitmap(blocks_per_group()).get(bit_index);
-#ifdef EXT2_DEBUG
-    dbg() << "Ext2FS: block " << block_index << " state: " << String::format("%u", current_state) << " -> " << String::format("%u", new_state) << " (in bitmap block " << bgd.bg_block_bitmap << ")";
-#endif
-
-    if (current_state == new_state) {
-        ASSERT_NOT_REACHED();
-        return true;
+    for (size_t i = 0; i < count; ++i) {
+        if (bitmap.get(first_bit_index + i) == new_state) {
+            dbg() << "Ext2FS: block " << (first_block_index + i) << " is already " << (new_state ? "allocated" : "free") << " (in bitmap block " << bgd.bg_block_bitmap << ")";
+            ASSERT_NOT_REACHED();
+            return true;
+        }
     }
 
-    cached_bitmap.bitmap(blocks_per_group()).set(bit_index, new_state);
+    bitmap.set_range(first_bit_index, count, new_state);
     cached_bitmap.dirty = true;
 
     // Update superblock
 #ifdef EXT2_DEBUG
-    dbg() << "Ext2FS: superblock free block count " << m_super_block.s_free_blocks_count << " -> " << (m_super_block.s_free_blocks_count - 1);
+    dbg() << "Ext2FS: superblock free block count " << m_super_block.s_free_blocks_count << (new_state ? " - " : " + ") << count;
 #endif
     if (new_state)
-        --m_super_block.s_free_blocks_count;
+        m_super_block.s_free_blocks_count -= count;
     else
-        ++m_super_block.s_free_blocks_count;
+        m_super_block.s_free_blocks_count += count;
     m_super_block_dirty = true;
 
     // Update BGD
     auto& mutable_bgd = const_cast<ext2_group_desc&>(bgd);
     if (new_state)
-        --mutable_bgd.bg_free_blocks_count;
+        mutable_bgd.bg_free_blocks_count -= count;
     else
-        ++mutable_bgd.bg_free_blocks_count;
+        mutable_bgd.bg_free_blocks_count += count;
 #ifdef EXT2_DEBUG
-    dbg() << "Ext2FS: group " << group_index << " free block count " << bgd.bg_free_blocks_count << " -> " << (bgd.bg_free_blocks_count - 1);
+    dbg() << "Ext2FS: group " << group_index << " free block count is now " << bgd.bg_free_blocks_count;
 #endif
 
     m_block_group_descriptors_dirty = true;
@@ -1447,7 +1714,8 @@ KResultOr<NonnullRefPtr<Inode>> Ext2FS::create_inode(InodeIdentifier parent_id,
     else if (is_block_device(mode))
         e2inode.i_block[1] = dev;
 
-    success = write_block_list_for_inode(inode_id, e2inode, blocks);
+    auto block_map = Ext2BlockMap::from_block_list(blocks);
+    success = write_block_list_for_inode(inode_id, e2inode, block_map);
     ASSERT(success);
 
 #ifdef EXT2_DEBUG
@@ -1462,7 +1730,7 @@ KResultOr<NonnullRefPtr<Inode>> Ext2FS::create_inode(InodeIdentifier parent_id,
 
     auto inode = get_inode({ fsid(), inode_id });
     // If we've already computed a block list, no sense in throwing it away.
-    static_cast<Ext2FSInode&>(*inode).m_block_list = move(blocks);
+    static_cast<Ext2FSInode&>(*inode).m_block_map = move(block_map);
 
     auto result = parent_inode->add_child(*inode, name, mode);
     ASSERT(result.is_success());
@@ -1502,7 +1770,13 @@ RefPtr<Inode> Ext2FSInode::lookup(StringView name)
 
 void Ext2FSInode::one_ref_left()
 {
-    // FIXME: I would like to not live forever, but uncached Ext2FS is fucking painful right now.
+    // Nobody has the file open anymore, so it's done growing for now.
+    if (!m_reserved_blocks.is_empty()) {
+        LOCKER(m_lock);
+        discard_reserved_blocks();
+    }
+
+    // We stay in the inode cache until it needs the room. See Ext2FS::evict_unused_inodes().
 }
 
 int Ext2FSInode::set_atime(time_t t)
@@ -1600,10 +1874,46 @@ KResult Ext2FSInode::truncate(u64 size)
     LOCKER(m_lock);
     if (static_cast<u64>(m_raw_inode.i_size) == size)
         return KSuccess;
+    size_t old_size = m_raw_inode.i_size;
     auto result = resize(size);
     if (result.is_error())
         return result;
     set_metadata_dirty(true);
+    inode_size_changed(old_size, size);
+    return KSuccess;
+}
+
+KResult Ext2FSInode::fsync(bool data_only)
+{
+    LOCKER(m_lock);
+
+    // fdatasync() only needs the inode itself if the data can't be read back without it.
+    bool include_inode = !data_only || m_size_or_block_list_dirty;
+    if (include_inode && is_metadata_dirty())
+        flush_metadata();
+
+    Vector<unsigned> blocks;
+    {
+        LOCKER(fs().m_lock);
+        if (m_dirty_blocks_overflowed) {
+            blocks = fs().block_list_for_inode(m_raw_inode, true);
+        } else {
+            blocks.ensure_capacity(m_dirty_blocks.size() + 1);
+            for (auto block_index : m_dirty_blocks)
+                blocks.append(block_index);
+        }
+        m_dirty_blocks.clear();
+        m_dirty_blocks_overflowed = false;
+    }
+    if (include_inode) {
+        unsigned inode_block_index;
+        unsigned offset;
+        if (fs().find_block_containing_inode(index(), inode_block_index, offset))
+            blocks.append(inode_block_index);
+        m_size_or_block_list_dirty = false;
+    }
+
+    fs().flush_blocks(blocks);
     return KSuccess;
 }
 
@@ -1636,7 +1946,7 @@ KResult Ext2FS::prepare_to_unmount() const
     LOCKER(m_lock);
 
     for (auto& it : m_inode_cache) {
-        if (it.value->ref_count() > 1)
+        if (it.value && it.value->ref_count() > 1)
             return KResult(-EBUSY);
     }
 
@@ -28,7 +28,10 @@
 
 #include <AK/Bitmap.h>
 #include <AK/HashMap.h>
+#include <AK/HashTable.h>
 #include <Kernel/FileSystem/BlockBasedFileSystem.h>
+#include <Kernel/FileSystem/Ext2BlockMap.h>
+#include <Kernel/FileSystem/FileDescription.h>
 #include <Kernel/FileSystem/Inode.h>
 #include <Kernel/FileSystem/ext2_fs.h>
 #include <Kernel/KBuffer.h>
@@ -58,6 +61,7 @@ public:
 private:
     // ^Inode
     virtual ssize_t read_bytes(off_t, ssize_t, u8* buffer, FileDescription*) const override;
+    void read_ahead(FileDescription::ReadAheadState&, off_t offset, size_t nread) const;
     virtual InodeMetadata metadata() const override;
     virtual KResult traverse_as_directory(Function<bool(const FS::DirectoryEntry&)>) const override;
     virtual RefPtr<Inode> lookup(StringView name) override;
@@ -75,16 +79,32 @@ private:
     virtual KResult chmod(mode_t) override;
     virtual KResult chown(uid_t, gid_t) override;
     virtual KResult truncate(u64) override;
+    virtual KResult fsync(bool data_only) override;
 
     bool write_directory(const Vector<FS::DirectoryEntry>&);
     void populate_lookup_cache() const;
     KResult resize(u64);
+    const Ext2BlockMap& block_map() const;
+    void discard_reserved_blocks();
+    void note_dirty_block(Ext2BlockMap::BlockIndex);
+
+    // How many blocks to reserve past the end of a file that is being appended to.
+    static constexpr size_t min_reserved_blocks = 8;
+    static constexpr size_t max_reserved_blocks = 64;
+
+    // Past this many dirty blocks, fsync() just writes back the whole file instead of remembering each one.
+    static constexpr size_t max_tracked_dirty_blocks = 1024;
 
     Ext2FS& fs();
     const Ext2FS& fs() const;
     Ext2FSInode(Ext2FS&, unsigned index);
 
-    mutable Vector<unsigned> m_block_list;
+    mutable Ext2BlockMap m_block_map;
+    Vector<Ext2BlockMap::BlockIndex> m_reserved_blocks;
+    HashTable<Ext2BlockMap::BlockIndex> m_dirty_blocks;
+    bool m_dirty_blocks_overflowed { false };
+    bool m_size_or_block_list_dirty { false };
+    u64 m_last_use { 0 };
     mutable HashMap<String, unsigned> m_lookup_cache;
     ext2_inode m_raw_inode;
 };
@@ -102,10 +122,15 @@ public:
     virtual unsigned free_block_count() const override;
     virtual unsigned total_inode_count() const override;
     virtual unsigned free_inode_count() const override;
+    virtual unsigned free_extent_count() const override;
 
     virtual KResult prepare_to_unmount() const override;
 
     virtual bool supports_watchers() const override { return true; }
+    virtual bool supports_lookup_cache() const override { return true; }
+
+    virtual u8 internal_file_type_to_directory_entry_type(const DirectoryEntry& entry) const override;
+    virtual void read_ahead_inodes(const Vector<InodeIdentifier>&) const override;
 
 private:
     typedef unsigned BlockIndex;
@@ -137,19 +162,23 @@ private:
 
     BlockIndex first_block_index() const;
     InodeIndex find_a_free_inode(GroupIndex preferred_group, off_t expected_size);
-    Vector<BlockIndex> allocate_blocks(GroupIndex preferred_group_index, size_t count);
+    Vector<BlockIndex> allocate_blocks(GroupIndex preferred_group_index, size_t count, BlockIndex goal = 0);
+    GroupIndex group_with_most_free_blocks() const;
+    size_t blocks_in_group(GroupIndex) const;
     GroupIndex group_index_from_inode(InodeIndex) const;
     GroupIndex group_index_from_block_index(BlockIndex) const;
 
     Vector<BlockIndex> block_list_for_inode_impl(const ext2_inode&, bool include_block_list_blocks = false) const;
     Vector<BlockIndex> block_list_for_inode(const ext2_inode&, bool include_block_list_blocks = false) const;
-    bool write_block_list_for_inode(InodeIndex, ext2_inode&, const Vector<BlockIndex>&);
+    bool write_block_list_for_inode(InodeIndex, ext2_inode&, const Ext2BlockMap&, Vector<BlockIndex>* written_meta_blocks = nullptr);
 
     bool get_inode_allocation_state(InodeIndex) const;
     bool set_inode_allocation_state(InodeIndex, bool);
     bool set_block_allocation_state(BlockIndex, bool);
+    bool set_block_range_allocation_state(BlockIndex first_block_index, size_t count, bool);
 
     void uncache_inode(InodeIndex);
+    void evict_unused_inodes() const;
     void free_inode(Ext2FSInode&);
 
     struct BlockListShape {
@@ -167,7 +196,13 @@ private:
     mutable ext2_super_block m_super_block;
     mutable Optional<KBuffer> m_cached_group_descriptor_table;
 
+    // Once the inode cache holds this many entries, the least recently used ones that nobody else references are dropped.
+    static constexpr size_t max_cached_inodes = 2048;
+    // Inode table blocks this far apart are still read in one go when reading ahead inodes.
+    static constexpr size_t max_inode_table_read_ahead_gap = 2;
+
     mutable HashMap<InodeIndex, RefPtr<Ext2FSInode>> m_inode_cache;
+    mutable u64 m_inode_cache_use_counter { 0 };
 
     bool m_super_block_dirty { false };
     bool m_block_group_descriptors_dirty { false };
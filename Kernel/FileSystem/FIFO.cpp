@@ -32,6 +32,7 @@
 #include <Kernel/Lock.h>
 #include <Kernel/Process.h>
 #include <Kernel/Thread.h>
+#include <Kernel/VM/MemoryManager.h>
 
 //#define FIFO_DEBUG
 
@@ -142,7 +143,18 @@ bool FIFO::can_read(const FileDescription&, size_t) const
 
 bool FIFO::can_write(const FileDescription&, size_t) const
 {
-    return m_buffer.space_for_writing() || !m_readers;
+    return m_buffer.space_for_writing() >= min(write_low_water_mark, m_buffer.capacity()) || !m_readers;
+}
+
+KResultOr<size_t> FIFO::set_capacity(size_t capacity)
+{
+    if (capacity > max_capacity)
+        return KResult(-EPERM);
+    capacity = max<size_t>(PAGE_ROUND_UP(capacity), PAGE_SIZE);
+    auto result = m_buffer.set_capacity(capacity);
+    if (result.is_error())
+        return result;
+    return capacity;
 }
 
 KResultOr<size_t> FIFO::read(FileDescription&, size_t, u8* buffer, size_t size)
@@ -161,6 +173,22 @@ KResultOr<size_t> FIFO::write(FileDescription&, size_t, const u8* buffer, size_t
     return m_buffer.write(buffer, size);
 }
 
+KResultOr<size_t> FIFO::readv(FileDescription&, size_t, const iovec* iov, int iov_count)
+{
+    if (!m_writers && m_buffer.is_empty())
+        return 0;
+    return m_buffer.readv(iov, iov_count);
+}
+
+KResultOr<size_t> FIFO::writev(FileDescription&, size_t, const iovec* iov, int iov_count)
+{
+    if (!m_readers) {
+        Thread::current()->send_signal(SIGPIPE, Process::current());
+        return -EPIPE;
+    }
+    return m_buffer.writev(iov, iov_count);
+}
+
 String FIFO::absolute_path(const FileDescription&) const
 {
     return String::format("fifo:%u", m_fifo_id);
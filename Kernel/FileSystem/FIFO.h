@@ -44,6 +44,11 @@ public:
         Writer
     };
 
+    static constexpr size_t max_capacity = 1 * MB;
+    // Writers that are waiting for space only get woken up once at least this much is available, so they
+    // don't trickle data into the buffer a few bytes at a time while the reader is slow to catch up.
+    static constexpr size_t write_low_water_mark = PAGE_SIZE;
+
     static NonnullRefPtr<FIFO> create(uid_t);
     virtual ~FIFO() override;
 
@@ -55,10 +60,16 @@ public:
     void attach(Direction);
     void detach(Direction);
 
+    size_t capacity() const { return m_buffer.capacity(); }
+    // Returns the new capacity, which is rounded up to a whole number of pages.
+    KResultOr<size_t> set_capacity(size_t);
+
 private:
     // ^File
     virtual KResultOr<size_t> write(FileDescription&, size_t, const u8*, size_t) override;
     virtual KResultOr<size_t> read(FileDescription&, size_t, u8*, size_t) override;
+    virtual KResultOr<size_t> writev(FileDescription&, size_t, const iovec*, int iov_count) override;
+    virtual KResultOr<size_t> readv(FileDescription&, size_t, const iovec*, int iov_count) override;
     virtual bool can_read(const FileDescription&, size_t) const override;
     virtual bool can_write(const FileDescription&, size_t) const override;
     virtual String absolute_path(const FileDescription&) const override;
@@ -51,6 +51,40 @@ KResult File::close()
     return KSuccess;
 }
 
+KResultOr<size_t> File::readv(FileDescription& description, size_t offset, const iovec* iov, int iov_count)
+{
+    size_t total_nread = 0;
+    for (int i = 0; i < iov_count; ++i) {
+        auto nread_or_error = read(description, offset + total_nread, (u8*)iov[i].iov_base, iov[i].iov_len);
+        if (nread_or_error.is_error()) {
+            if (total_nread)
+                return total_nread;
+            return nread_or_error.error();
+        }
+        total_nread += nread_or_error.value();
+        if (nread_or_error.value() < iov[i].iov_len)
+            break;
+    }
+    return total_nread;
+}
+
+KResultOr<size_t> File::writev(FileDescription& description, size_t offset, const iovec* iov, int iov_count)
+{
+    size_t total_nwritten = 0;
+    for (int i = 0; i < iov_count; ++i) {
+        auto nwritten_or_error = write(description, offset + total_nwritten, (const u8*)iov[i].iov_base, iov[i].iov_len);
+        if (nwritten_or_error.is_error()) {
+            if (total_nwritten)
+                return total_nwritten;
+            return nwritten_or_error.error();
+        }
+        total_nwritten += nwritten_or_error.value();
+        if (nwritten_or_error.value() < iov[i].iov_len)
+            break;
+    }
+    return total_nwritten;
+}
+
 int File::ioctl(FileDescription&, unsigned, FlatPtr)
 {
     return -ENOTTY;
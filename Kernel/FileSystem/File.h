@@ -76,6 +76,10 @@ public:
 
     virtual KResultOr<size_t> read(FileDescription&, size_t, u8*, size_t) = 0;
     virtual KResultOr<size_t> write(FileDescription&, size_t, const u8*, size_t) = 0;
+    // Scatter/gather versions of read() and write(). The default implementations go through the buffers one at a time,
+    // files that can move a whole message at once (pipes, local sockets) should override them.
+    virtual KResultOr<size_t> readv(FileDescription&, size_t, const iovec*, int iov_count);
+    virtual KResultOr<size_t> writev(FileDescription&, size_t, const iovec*, int iov_count);
     virtual int ioctl(FileDescription&, unsigned request, FlatPtr arg);
     virtual KResultOr<Region*> mmap(Process&, FileDescription&, VirtualAddress preferred_vaddr, size_t offset, size_t size, int prot, bool shared);
 
@@ -97,6 +101,8 @@ public:
     virtual bool is_block_device() const { return false; }
     virtual bool is_character_device() const { return false; }
     virtual bool is_socket() const { return false; }
+    virtual bool is_event_set() const { return false; }
+    virtual bool is_io_ring() const { return false; }
 
 protected:
     File();
@@ -133,6 +133,7 @@ KResultOr<size_t> FileDescription::read(u8* buffer, size_t count)
     if (new_offset.has_overflow())
         return -EOVERFLOW;
     SmapDisabler disabler;
+    ++m_transfer_count;
     auto nread_or_error = m_file->read(*this, offset(), buffer, count);
     if (!nread_or_error.is_error() && m_file->is_seekable())
         m_current_offset += nread_or_error.value();
@@ -147,12 +148,69 @@ KResultOr<size_t> FileDescription::write(const u8* data, size_t size)
     if (new_offset.has_overflow())
         return -EOVERFLOW;
     SmapDisabler disabler;
+    ++m_transfer_count;
     auto nwritten_or_error = m_file->write(*this, offset(), data, size);
     if (!nwritten_or_error.is_error() && m_file->is_seekable())
         m_current_offset += nwritten_or_error.value();
     return nwritten_or_error;
 }
 
+KResultOr<size_t> FileDescription::readv(const iovec* iov, int iov_count, size_t total_length)
+{
+    LOCKER(m_lock);
+    Checked<size_t> new_offset = m_current_offset;
+    new_offset += total_length;
+    if (new_offset.has_overflow())
+        return -EOVERFLOW;
+    SmapDisabler disabler;
+    ++m_transfer_count;
+    auto nread_or_error = m_file->readv(*this, offset(), iov, iov_count);
+    if (!nread_or_error.is_error() && m_file->is_seekable())
+        m_current_offset += nread_or_error.value();
+    return nread_or_error;
+}
+
+KResultOr<size_t> FileDescription::writev(const iovec* iov, int iov_count, size_t total_length)
+{
+    LOCKER(m_lock);
+    Checked<size_t> new_offset = m_current_offset;
+    new_offset += total_length;
+    if (new_offset.has_overflow())
+        return -EOVERFLOW;
+    SmapDisabler disabler;
+    ++m_transfer_count;
+    auto nwritten_or_error = m_file->writev(*this, offset(), iov, iov_count);
+    if (!nwritten_or_error.is_error() && m_file->is_seekable())
+        m_current_offset += nwritten_or_error.value();
+    return nwritten_or_error;
+}
+
+KResultOr<size_t> FileDescription::preadv(const iovec* iov, int iov_count, size_t total_length, off_t offset)
+{
+    ASSERT(offset >= 0);
+    LOCKER(m_lock);
+    Checked<size_t> end_offset = offset;
+    end_offset += total_length;
+    if (end_offset.has_overflow())
+        return -EOVERFLOW;
+    SmapDisabler disabler;
+    ++m_transfer_count;
+    return m_file->readv(*this, offset, iov, iov_count);
+}
+
+KResultOr<size_t> FileDescription::pwritev(const iovec* iov, int iov_count, size_t total_length, off_t offset)
+{
+    ASSERT(offset >= 0);
+    LOCKER(m_lock);
+    Checked<size_t> end_offset = offset;
+    end_offset += total_length;
+    if (end_offset.has_overflow())
+        return -EOVERFLOW;
+    SmapDisabler disabler;
+    ++m_transfer_count;
+    return m_file->writev(*this, offset, iov, iov_count);
+}
+
 bool FileDescription::can_write() const
 {
     return m_file->can_write(*this, offset());
@@ -173,7 +231,7 @@ KResultOr<KBuffer> FileDescription::read_entire_file()
 
 ssize_t FileDescription::get_dir_entries(u8* buffer, ssize_t size)
 {
-    LOCKER(m_lock, Lock::Mode::Shared);
+    LOCKER(m_lock);
     if (!is_directory())
         return -ENOTDIR;
 
@@ -184,27 +242,45 @@ ssize_t FileDescription::get_dir_entries(u8* buffer, ssize_t size)
     if (size < 0)
         return -EINVAL;
 
-    size_t size_to_allocate = max(static_cast<size_t>(PAGE_SIZE), static_cast<size_t>(metadata.size));
-
-    auto temp_buffer = ByteBuffer::create_uninitialized(size_to_allocate);
+    // Entries are handed out in batches of as many as fit into the caller's buffer, and the offset
+    // of a directory counts the entries that were handed out so far. Once they all have been,
+    // this returns 0.
+    static const size_t max_batch_size = 64 * KB;
+    auto temp_buffer = ByteBuffer::create_uninitialized(min(static_cast<size_t>(size), max_batch_size));
     BufferStream stream(temp_buffer);
-    KResult result = VFS::the().traverse_directory_inode(*m_inode, [&stream](auto& entry) {
+    auto& fs = m_inode->fs();
+    off_t index = 0;
+    off_t entries_copied = 0;
+    bool buffer_full = false;
+    Vector<InodeIdentifier> copied_inodes;
+    KResult result = VFS::the().traverse_directory_inode(*m_inode, [&](auto& entry) {
+        if (buffer_full)
+            return false;
+        if (index++ < m_current_offset)
+            return true;
+        size_t entry_size = sizeof(u32) + sizeof(u8) + sizeof(u32) + entry.name_length;
+        if (static_cast<size_t>(stream.offset()) + entry_size > temp_buffer.size()) {
+            buffer_full = true;
+            return false;
+        }
         stream << (u32)entry.inode.index();
-        stream << (u8)entry.file_type;
+        stream << fs.internal_file_type_to_directory_entry_type(entry);
         stream << (u32)entry.name_length;
         stream << entry.name;
+        ++entries_copied;
+        copied_inodes.append(entry.inode);
         return true;
     });
 
     if (result.is_error())
         return result;
 
-    stream.snip();
-
-    if (static_cast<size_t>(size) < temp_buffer.size())
+    if (buffer_full && entries_copied == 0)
         return -EINVAL;
 
-    copy_to_user(buffer, temp_buffer.data(), temp_buffer.size());
+    m_current_offset += entries_copied;
+    copy_to_user(buffer, temp_buffer.data(), stream.offset());
+    fs.read_ahead_inodes(copied_inodes);
     return stream.offset();
 }
 
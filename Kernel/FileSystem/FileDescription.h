@@ -29,6 +29,7 @@
 #include <AK/Badge.h>
 #include <AK/ByteBuffer.h>
 #include <AK/RefCounted.h>
+#include <AK/Weakable.h>
 #include <Kernel/FileSystem/FIFO.h>
 #include <Kernel/FileSystem/Inode.h>
 #include <Kernel/FileSystem/InodeMetadata.h>
@@ -38,7 +39,9 @@
 
 namespace Kernel {
 
-class FileDescription : public RefCounted<FileDescription> {
+class FileDescription
+    : public RefCounted<FileDescription>
+    , public Weakable<FileDescription> {
     MAKE_SLAB_ALLOCATED(FileDescription)
 public:
     static NonnullRefPtr<FileDescription> create(Custody&);
@@ -62,6 +65,11 @@ public:
     off_t seek(off_t, int whence);
     KResultOr<size_t> read(u8*, size_t);
     KResultOr<size_t> write(const u8* data, size_t);
+    KResultOr<size_t> readv(const iovec*, int iov_count, size_t total_length);
+    KResultOr<size_t> writev(const iovec*, int iov_count, size_t total_length);
+    // Positional variants: these access the file at the given offset and leave the description's offset alone.
+    KResultOr<size_t> preadv(const iovec*, int iov_count, size_t total_length, off_t);
+    KResultOr<size_t> pwritev(const iovec*, int iov_count, size_t total_length, off_t);
     KResult fstat(stat&);
 
     KResult chmod(mode_t);
@@ -122,12 +130,31 @@ public:
 
     Optional<KBuffer>& generator_cache() { return m_generator_cache; }
 
+    // For ProcFS files that report events (e.g /proc/memory_pressure): the event sequence number as of the last read.
+    u32 seen_event_sequence() const { return m_seen_event_sequence; }
+    void set_seen_event_sequence(u32 sequence) { m_seen_event_sequence = sequence; }
+
+    // Bumped by every read or write through this description; edge-triggered event sets use it to re-arm.
+    u32 transfer_count() const { return m_transfer_count; }
+    void did_transfer() { ++m_transfer_count; }
+
     void set_original_inode(Badge<VFS>, NonnullRefPtr<Inode>&& inode) { m_inode = move(inode); }
 
     KResult truncate(u64);
 
     off_t offset() const { return m_current_offset; }
 
+    // Tracks sequential reads through this description so the file system can prefetch ahead of them.
+    struct ReadAheadState {
+        static constexpr size_t min_window = 16 * KB;
+        static constexpr size_t max_window = 128 * KB;
+
+        off_t expected_offset { 0 };
+        off_t prefetched_until { 0 };
+        size_t window { 0 };
+    };
+    ReadAheadState& read_ahead_state() { return m_read_ahead_state; }
+
     KResult chown(uid_t, gid_t);
 
 private:
@@ -142,6 +169,10 @@ private:
     off_t m_current_offset { 0 };
 
     Optional<KBuffer> m_generator_cache;
+    u32 m_seen_event_sequence { 0 };
+    u32 m_transfer_count { 0 };
+
+    ReadAheadState m_read_ahead_state;
 
     u32 m_file_flags { 0 };
 
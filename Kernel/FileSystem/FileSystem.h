@@ -52,12 +52,15 @@ public:
     unsigned fsid() const { return m_fsid; }
     static FS* from_fsid(u32);
     static void sync();
+    static void write_back();
     static void lock_all();
 
     virtual bool initialize() = 0;
     virtual const char* class_name() const = 0;
     virtual NonnullRefPtr<Inode> root_inode() const = 0;
     virtual bool supports_watchers() const { return false; }
+    // Filesystems that call did_add_child()/did_remove_child() for every directory change can let the VFS cache lookups.
+    virtual bool supports_lookup_cache() const { return false; }
 
     bool is_readonly() const { return m_readonly; }
 
@@ -65,6 +68,8 @@ public:
     virtual unsigned free_block_count() const { return 0; }
     virtual unsigned total_inode_count() const { return 0; }
     virtual unsigned free_inode_count() const { return 0; }
+    // The number of separate runs of free blocks. Together with free_block_count(), this tells how fragmented the free space is.
+    virtual unsigned free_extent_count() const { return 0; }
 
     virtual KResult prepare_to_unmount() const { return KSuccess; }
 
@@ -78,11 +83,21 @@ public:
         u8 file_type { 0 };
     };
 
+    // Directory entries carry the file type in whatever encoding the file system uses on disk;
+    // this turns it into a DT_* value for userspace. DT_UNKNOWN if the file system doesn't know.
+    virtual u8 internal_file_type_to_directory_entry_type(const DirectoryEntry&) const { return DT_UNKNOWN; }
+
+    // Called with the entries of a directory that were just handed out to userspace, which is likely
+    // to look at each of them next (think `ls -l`). A file system may use this to read them in ahead of time.
+    virtual void read_ahead_inodes(const Vector<InodeIdentifier>&) const { }
+
     virtual void flush_writes() { }
+    virtual void write_back_dirty_blocks() { }
 
     size_t block_size() const { return m_block_size; }
 
     virtual bool is_file_backed() const { return false; }
+    virtual bool is_block_based() const { return false; }
 
 protected:
     FS();
@@ -0,0 +1,270 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <AK/StdLibExtras.h>
+#include <Kernel/FileSystem/FileDescription.h>
+#include <Kernel/FileSystem/FileSystem.h>
+#include <Kernel/FileSystem/IORing.h>
+#include <Kernel/Net/Socket.h>
+#include <Kernel/Process.h>
+#include <Kernel/Tasks/IORingTask.h>
+#include <Kernel/VM/MemoryManager.h>
+
+namespace Kernel {
+
+static ssize_t to_result(KResultOr<size_t>&& result)
+{
+    if (result.is_error())
+        return result.error();
+    return result.value();
+}
+
+KResultOr<NonnullRefPtr<IORing>> IORing::create(unsigned entries, size_t buffers_size)
+{
+    if (!entries || entries > max_entries || buffers_size > max_buffers_size)
+        return KResult(-EINVAL);
+
+    // Both rings get a power-of-two size so that indices can wrap with a mask. The completion ring
+    // is twice as large so that a full submission ring never has to wait for completions to be reaped.
+    unsigned submission_entries = 1;
+    while (submission_entries < entries)
+        submission_entries <<= 1;
+
+    io_ring_header layout {};
+    layout.submission_entries = submission_entries;
+    layout.completion_entries = submission_entries * 2;
+    layout.submissions_offset = round_up_to_power_of_two(sizeof(io_ring_header), 64);
+    layout.completions_offset = round_up_to_power_of_two(layout.submissions_offset + layout.submission_entries * sizeof(io_ring_submission), 64);
+    layout.buffers_offset = PAGE_ROUND_UP(layout.completions_offset + layout.completion_entries * sizeof(io_ring_completion));
+    layout.buffers_size = buffers_size;
+
+    auto region = MM.allocate_kernel_region(PAGE_ROUND_UP(layout.buffers_offset + buffers_size), "IORing", Region::Access::Read | Region::Access::Write, false, true);
+    if (!region)
+        return KResult(-ENOMEM);
+    return adopt(*new IORing(region.release_nonnull(), layout));
+}
+
+IORing::IORing(NonnullOwnPtr<Region>&& region, const io_ring_header& layout)
+    : m_region(move(region))
+    , m_layout(layout)
+{
+    header() = m_layout;
+}
+
+IORing::~IORing()
+{
+}
+
+unsigned IORing::pending_completions() const
+{
+    u32 head = AK::atomic_load(&const_cast<io_ring_header&>(header()).completion_head, AK::memory_order_acquire);
+    return min(m_completion_tail - head, m_layout.completion_entries);
+}
+
+void IORing::post_completion(void* user_data, ssize_t result)
+{
+    ScopedSpinLock lock(m_completion_lock);
+    auto& completion = completions()[m_completion_tail & (m_layout.completion_entries - 1)];
+    completion.user_data = user_data;
+    completion.result = result;
+    ++m_completion_tail;
+    AK::atomic_store(&header().completion_tail, m_completion_tail, AK::memory_order_release);
+}
+
+ssize_t IORing::validate(Process& process, const io_ring_submission& submission, RefPtr<FileDescription>& description)
+{
+    switch (submission.opcode) {
+    case IO_RING_OP_READ:
+    case IO_RING_OP_WRITE:
+    case IO_RING_OP_ACCEPT:
+    case IO_RING_OP_RECV:
+    case IO_RING_OP_SEND:
+    case IO_RING_OP_FSYNC:
+        break;
+    default:
+        return -EINVAL;
+    }
+
+    description = process.file_description(submission.fd);
+    if (!description)
+        return -EBADF;
+
+    bool reads = submission.opcode == IO_RING_OP_READ || submission.opcode == IO_RING_OP_RECV;
+    bool writes = submission.opcode == IO_RING_OP_WRITE || submission.opcode == IO_RING_OP_SEND;
+    if (reads || writes) {
+        if (submission.buffer_offset > m_layout.buffers_size || submission.length > m_layout.buffers_size - submission.buffer_offset)
+            return -EFAULT;
+    }
+    if (reads && !description->is_readable())
+        return -EBADF;
+    if (writes && !description->is_writable())
+        return -EBADF;
+
+    switch (submission.opcode) {
+    case IO_RING_OP_READ:
+    case IO_RING_OP_WRITE:
+        if (submission.offset < -1)
+            return -EINVAL;
+        if (submission.offset >= 0 && !description->file().is_seekable())
+            return -ESPIPE;
+        if (description->is_directory())
+            return -EISDIR;
+        break;
+    case IO_RING_OP_ACCEPT:
+    case IO_RING_OP_RECV:
+    case IO_RING_OP_SEND:
+        if (!description->is_socket())
+            return -ENOTSOCK;
+        break;
+    case IO_RING_OP_FSYNC:
+        if (!description->inode())
+            return -EINVAL;
+        break;
+    }
+    return 0;
+}
+
+unsigned IORing::submit(Process& process)
+{
+    LOCKER(m_submission_lock);
+    auto& header = this->header();
+    u32 tail = AK::atomic_load(&header.submission_tail, AK::memory_order_acquire);
+    unsigned submitted = 0;
+    while (m_submission_head != tail) {
+        // Only take on work that is guaranteed a slot in the completion ring.
+        if (m_in_flight.load() + pending_completions() >= m_layout.completion_entries)
+            break;
+
+        // Copy the entry out first, since userspace can change it under our feet.
+        io_ring_submission submission = submissions()[m_submission_head & (m_layout.submission_entries - 1)];
+        ++m_submission_head;
+        ++submitted;
+
+        if (submission.opcode == IO_RING_OP_NOP) {
+            post_completion(submission.user_data, 0);
+            continue;
+        }
+
+        RefPtr<FileDescription> description;
+        if (ssize_t error = validate(process, submission, description)) {
+            post_completion(submission.user_data, error);
+            continue;
+        }
+
+        ++m_in_flight;
+        IORingTask::enqueue(make<Request>(Request { *this, process, move(description), submission }));
+    }
+    AK::atomic_store(&header.submission_head, m_submission_head, AK::memory_order_release);
+    return submitted;
+}
+
+bool IORing::is_ready(const Request& request) const
+{
+    auto& description = *request.description;
+    switch (request.submission.opcode) {
+    case IO_RING_OP_READ:
+    case IO_RING_OP_RECV:
+        return description.can_read();
+    case IO_RING_OP_WRITE:
+    case IO_RING_OP_SEND:
+        return description.can_write();
+    case IO_RING_OP_ACCEPT:
+        return description.socket()->can_accept();
+    default:
+        return true;
+    }
+}
+
+ssize_t IORing::perform(Request& request)
+{
+    auto& submission = request.submission;
+    auto& description = *request.description;
+    u8* data = buffers() + submission.buffer_offset;
+
+    switch (submission.opcode) {
+    case IO_RING_OP_READ: {
+        if (submission.offset < 0)
+            return to_result(description.read(data, submission.length));
+        iovec vec { data, submission.length };
+        return to_result(description.preadv(&vec, 1, submission.length, submission.offset));
+    }
+    case IO_RING_OP_WRITE: {
+        if (submission.offset < 0) {
+            if (description.should_append())
+                description.seek(0, SEEK_END);
+            return to_result(description.write(data, submission.length));
+        }
+        iovec vec { data, submission.length };
+        return to_result(description.pwritev(&vec, 1, submission.length, submission.offset));
+    }
+    case IO_RING_OP_RECV: {
+        auto& socket = *description.socket();
+        if (socket.is_shut_down_for_reading())
+            return 0;
+        description.did_transfer();
+        return to_result(socket.recvfrom(description, data, submission.length, submission.flags, nullptr, nullptr));
+    }
+    case IO_RING_OP_SEND: {
+        auto& socket = *description.socket();
+        if (socket.is_shut_down_for_writing())
+            return -EPIPE;
+        description.did_transfer();
+        return to_result(socket.sendto(description, data, submission.length, submission.flags, nullptr, 0));
+    }
+    case IO_RING_OP_ACCEPT: {
+        auto& socket = *description.socket();
+        // Someone else may have taken the pending connection since we checked.
+        auto accepted_socket = socket.can_accept() ? socket.accept() : nullptr;
+        if (!accepted_socket)
+            return -EAGAIN;
+        auto accepted_description = FileDescription::create(*accepted_socket);
+        accepted_description->set_readable(true);
+        accepted_description->set_writable(true);
+        accepted_description->set_blocking(description.is_blocking());
+        int fd = request.process->install_file_description(move(accepted_description));
+        if (fd < 0)
+            return fd;
+        accepted_socket->set_setup_state(Socket::SetupState::Completed);
+        return fd;
+    }
+    case IO_RING_OP_FSYNC: {
+        auto& inode = *description.inode();
+        inode.flush_metadata();
+        inode.fs().flush_writes();
+        return 0;
+    }
+    default:
+        ASSERT_NOT_REACHED();
+    }
+}
+
+void IORing::execute(Request& request)
+{
+    post_completion(request.submission.user_data, perform(request));
+    --m_in_flight;
+}
+
+}
@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/Atomic.h>
+#include <AK/NonnullOwnPtr.h>
+#include <Kernel/FileSystem/File.h>
+#include <Kernel/Lock.h>
+#include <Kernel/SpinLock.h>
+#include <Kernel/UnixTypes.h>
+#include <Kernel/VM/Region.h>
+
+namespace Kernel {
+
+// A submission/completion ring shared with userspace. Userspace queues operations on its fds,
+// IORingTask carries them out, and the results are posted back to the ring without a syscall.
+// Data is read into and written from a buffer area inside the ring itself, so the kernel never
+// has to reach into the submitting process's address space from another thread.
+class IORing final : public File {
+public:
+    static constexpr unsigned max_entries = 4096;
+    static constexpr size_t max_buffers_size = 16 * MB;
+
+    struct Request {
+        NonnullRefPtr<IORing> ring;
+        NonnullRefPtr<Process> process;
+        RefPtr<FileDescription> description;
+        io_ring_submission submission;
+        bool in_progress { false };
+        // Requests on the same description run in submission order.
+        bool waits_for_earlier_request { false };
+    };
+
+    static KResultOr<NonnullRefPtr<IORing>> create(unsigned entries, size_t buffers_size);
+    virtual ~IORing() override;
+
+    VMObject& vmobject() { return m_region->vmobject(); }
+    size_t size() const { return m_region->size(); }
+
+    // Takes the submissions queued since the last call and hands them to IORingTask.
+    unsigned submit(Process&);
+    unsigned pending_completions() const;
+
+    bool is_ready(const Request&) const;
+    void execute(Request&);
+
+    virtual bool can_read(const FileDescription&, size_t) const override { return pending_completions(); }
+    virtual bool can_write(const FileDescription&, size_t) const override { return false; }
+    virtual KResultOr<size_t> read(FileDescription&, size_t, u8*, size_t) override { return KResult(-EINVAL); }
+    virtual KResultOr<size_t> write(FileDescription&, size_t, const u8*, size_t) override { return KResult(-EINVAL); }
+    virtual String absolute_path(const FileDescription&) const override { return "IORing"; }
+    virtual const char* class_name() const override { return "IORing"; }
+    virtual bool is_io_ring() const override { return true; }
+
+private:
+    IORing(NonnullOwnPtr<Region>&&, const io_ring_header&);
+
+    // Userspace can scribble over the whole ring, so only the indices it owns are ever read back from it.
+    io_ring_header& header() { return *reinterpret_cast<io_ring_header*>(m_region->vaddr().as_ptr()); }
+    const io_ring_header& header() const { return *reinterpret_cast<const io_ring_header*>(m_region->vaddr().as_ptr()); }
+    io_ring_submission* submissions() { return reinterpret_cast<io_ring_submission*>(m_region->vaddr().offset(m_layout.submissions_offset).as_ptr()); }
+    io_ring_completion* completions() { return reinterpret_cast<io_ring_completion*>(m_region->vaddr().offset(m_layout.completions_offset).as_ptr()); }
+    u8* buffers() { return m_region->vaddr().offset(m_layout.buffers_offset).as_ptr(); }
+
+    ssize_t validate(Process&, const io_ring_submission&, RefPtr<FileDescription>&);
+    ssize_t perform(Request&);
+    void post_completion(void* user_data, ssize_t result);
+
+    NonnullOwnPtr<Region> m_region;
+    const io_ring_header m_layout;
+    Lock m_submission_lock { "IORing" };
+    u32 m_submission_head { 0 };
+    u32 m_completion_tail { 0 };
+    SpinLock<u8> m_completion_lock;
+    // Requests that have been taken off the submission ring but not completed yet.
+    Atomic<u32> m_in_flight { 0 };
+};
+
+}
@@ -33,6 +33,7 @@
 #include <Kernel/FileSystem/VirtualFileSystem.h>
 #include <Kernel/KBufferBuilder.h>
 #include <Kernel/Net/LocalSocket.h>
+#include <Kernel/VM/MemoryManager.h>
 #include <Kernel/VM/SharedInodeVMObject.h>
 
 namespace Kernel {
@@ -66,6 +67,23 @@ void Inode::sync()
     }
 }
 
+size_t Inode::release_all_page_caches()
+{
+    NonnullRefPtrVector<Inode, 32> inodes;
+    {
+        ScopedSpinLock all_inodes_lock(s_all_inodes_lock);
+        for (auto& inode : all_with_lock()) {
+            if (inode.page_cache_page_count())
+                inodes.append(inode);
+        }
+    }
+
+    size_t count = 0;
+    for (auto& inode : inodes)
+        count += inode.release_page_cache();
+    return count;
+}
+
 KResultOr<KBuffer> Inode::read_entire(FileDescription* descriptor) const
 {
     KBufferBuilder builder;
@@ -127,16 +145,156 @@ void Inode::will_be_destroyed()
 
 void Inode::inode_contents_changed(off_t offset, ssize_t size, const u8* data)
 {
+    if (size > 0)
+        invalidate_cached_pages(offset / PAGE_SIZE, PAGE_ROUND_UP(offset + size) / PAGE_SIZE);
     if (m_shared_vmobject)
         m_shared_vmobject->inode_contents_changed({}, offset, size, data);
 }
 
 void Inode::inode_size_changed(size_t old_size, size_t new_size)
 {
+    // The page straddling the new end may have stale bytes past it, so drop that one too.
+    size_t first_stale_page_index = min(old_size, new_size) / PAGE_SIZE;
+    invalidate_cached_pages(first_stale_page_index, PAGE_ROUND_UP(max(old_size, new_size)) / PAGE_SIZE);
     if (m_shared_vmobject)
         m_shared_vmobject->inode_size_changed({}, old_size, new_size);
 }
 
+bool Inode::is_page_cacheable() const
+{
+    return fs().is_block_based() && metadata().is_regular_file();
+}
+
+RefPtr<PhysicalPage> Inode::cached_page_if_present(size_t page_index)
+{
+    ASSERT(is_page_cacheable());
+    LOCKER(m_page_cache_lock);
+    auto it = m_page_cache.find(page_index);
+    if (it == m_page_cache.end())
+        return nullptr;
+    return it->value;
+}
+
+RefPtr<PhysicalPage> Inode::cached_page(size_t page_index, FileDescription* description)
+{
+    ASSERT(is_page_cacheable());
+    u32 generation;
+    {
+        LOCKER(m_page_cache_lock);
+        auto it = m_page_cache.find(page_index);
+        if (it != m_page_cache.end())
+            return it->value;
+        generation = m_page_cache_generation;
+    }
+
+    // Don't hold the page cache lock while reading, since writers hold the inode lock while invalidating.
+    u8 page_buffer[PAGE_SIZE];
+    auto nread = read_bytes(page_index * PAGE_SIZE, PAGE_SIZE, page_buffer, description);
+    if (nread < 0)
+        return nullptr;
+    if (nread < PAGE_SIZE) {
+        // If we read less than a page, zero out the rest to avoid leaking uninitialized data.
+        memset(page_buffer + nread, 0, PAGE_SIZE - nread);
+    }
+
+    auto page = MM.allocate_user_physical_page(MemoryManager::ShouldZeroFill::No);
+    if (page.is_null())
+        return nullptr;
+    {
+        InterruptDisabler disabler;
+        u8* dest_ptr = MM.quickmap_page(*page);
+        memcpy(dest_ptr, page_buffer, PAGE_SIZE);
+        MM.unquickmap_page();
+    }
+
+    LOCKER(m_page_cache_lock);
+    auto it = m_page_cache.find(page_index);
+    if (it != m_page_cache.end())
+        return it->value;
+    // If someone wrote to this inode while we were reading, what we have may already be stale.
+    // It's still good for the caller, who started before that write completed, but don't keep it.
+    if (generation == m_page_cache_generation)
+        m_page_cache.set(page_index, *page);
+    return page;
+}
+
+ssize_t Inode::read_bytes_through_page_cache(off_t offset, ssize_t count, u8* buffer, FileDescription* description)
+{
+    if (!is_page_cacheable())
+        return read_bytes(offset, count, buffer, description);
+
+    ASSERT(offset >= 0);
+    size_t file_size = size();
+    if (static_cast<size_t>(offset) >= file_size || count <= 0)
+        return 0;
+    size_t remaining = min(static_cast<size_t>(count), file_size - offset);
+
+    ssize_t nread = 0;
+    while (remaining) {
+        size_t page_index = offset / PAGE_SIZE;
+        size_t offset_in_page = offset % PAGE_SIZE;
+        size_t bytes_to_copy = min(remaining, PAGE_SIZE - offset_in_page);
+
+        auto page = cached_page(page_index, description);
+        if (!page) {
+            // We're probably out of physical pages, so just read the rest directly.
+            auto result = read_bytes(offset, remaining, buffer + nread, description);
+            if (result < 0)
+                return nread ? nread : result;
+            return nread + result;
+        }
+
+        // The quickmap slot can't be held across a fault on the destination buffer, so bounce through the stack.
+        u8 page_buffer[PAGE_SIZE];
+        {
+            InterruptDisabler disabler;
+            u8* page_ptr = MM.quickmap_page(*page);
+            memcpy(page_buffer, page_ptr + offset_in_page, bytes_to_copy);
+            MM.unquickmap_page();
+        }
+        memcpy(buffer + nread, page_buffer, bytes_to_copy);
+
+        offset += bytes_to_copy;
+        nread += bytes_to_copy;
+        remaining -= bytes_to_copy;
+    }
+    return nread;
+}
+
+void Inode::invalidate_cached_pages(size_t first_page_index, size_t end_page_index)
+{
+    LOCKER(m_page_cache_lock);
+    ++m_page_cache_generation;
+    if (m_page_cache.is_empty())
+        return;
+    if (end_page_index - first_page_index > m_page_cache.size()) {
+        Vector<u32> stale_page_indices;
+        for (auto& it : m_page_cache) {
+            if (it.key >= first_page_index && it.key < end_page_index)
+                stale_page_indices.append(it.key);
+        }
+        for (auto page_index : stale_page_indices)
+            m_page_cache.remove(page_index);
+        return;
+    }
+    for (size_t page_index = first_page_index; page_index < end_page_index; ++page_index)
+        m_page_cache.remove(page_index);
+}
+
+size_t Inode::page_cache_page_count() const
+{
+    LOCKER(m_page_cache_lock);
+    return m_page_cache.size();
+}
+
+size_t Inode::release_page_cache()
+{
+    LOCKER(m_page_cache_lock);
+    size_t count = m_page_cache.size();
+    m_page_cache.clear();
+    return count;
+}
+
 int Inode::set_atime(time_t)
 {
     return -ENOTIMPL;
@@ -229,6 +387,9 @@ void Inode::set_metadata_dirty(bool metadata_dirty)
 
 void Inode::did_add_child(const String& name)
 {
+    if (fs().supports_lookup_cache())
+        VFS::the().did_change_directory_entry({}, *this, name);
+
     LOCKER(m_lock);
     for (auto& watcher : m_watchers) {
         watcher->notify_child_added({}, name);
@@ -237,6 +398,9 @@ void Inode::did_add_child(const String& name)
 
 void Inode::did_remove_child(const String& name)
 {
+    if (fs().supports_lookup_cache())
+        VFS::the().did_change_directory_entry({}, *this, name);
+
     LOCKER(m_lock);
     for (auto& watcher : m_watchers) {
         watcher->notify_child_removed({}, name);
@@ -27,6 +27,7 @@
 #pragma once
 
 #include <AK/Function.h>
+#include <AK/HashMap.h>
 #include <AK/HashTable.h>
 #include <AK/InlineLinkedList.h>
 #include <AK/RefCounted.h>
@@ -39,6 +40,7 @@
 #include <Kernel/Forward.h>
 #include <Kernel/KResult.h>
 #include <Kernel/Lock.h>
+#include <Kernel/VM/PhysicalPage.h>
 
 namespace Kernel {
 
@@ -70,6 +72,9 @@ public:
     KResultOr<KBuffer> read_entire(FileDescription* = nullptr) const;
 
     virtual ssize_t read_bytes(off_t, ssize_t, u8* buffer, FileDescription*) const = 0;
+    // Lets select() wait on inodes that produce data over time. Most inodes always have something to read.
+    virtual bool can_read(const FileDescription&) const { return true; }
+    ssize_t read_bytes_through_page_cache(off_t, ssize_t, u8* buffer, FileDescription*);
     virtual KResult traverse_as_directory(Function<bool(const FS::DirectoryEntry&)>) const = 0;
     virtual RefPtr<Inode> lookup(StringView name) = 0;
     virtual ssize_t write_bytes(off_t, ssize_t, const u8* data, FileDescription*) = 0;
@@ -80,6 +85,8 @@ public:
     virtual KResult chmod(mode_t) = 0;
     virtual KResult chown(uid_t, gid_t) = 0;
     virtual KResult truncate(u64) { return KSuccess; }
+    // Writes this inode's dirty data (and unless data_only, its metadata) out to the backing device.
+    virtual KResult fsync(bool /* data_only */) { return KSuccess; }
     virtual KResultOr<NonnullRefPtr<Custody>> resolve_as_link(Custody& base, RefPtr<Custody>* out_parent = nullptr, int options = 0, int symlink_recursion_level = 0) const;
 
     LocalSocket* socket() { return m_socket.ptr(); }
@@ -105,6 +112,20 @@ public:
     SharedInodeVMObject* shared_vmobject() { return m_shared_vmobject.ptr(); }
     const SharedInodeVMObject* shared_vmobject() const { return m_shared_vmobject.ptr(); }
 
+    // Regular files on disk-backed file systems keep clean pages of their contents in a page cache.
+    // read() and page faults in shared mappings of this inode both use the same physical pages.
+    bool is_page_cacheable() const;
+    RefPtr<PhysicalPage> cached_page(size_t page_index, FileDescription* = nullptr);
+    // Like cached_page(), but never reads anything in.
+    RefPtr<PhysicalPage> cached_page_if_present(size_t page_index);
+    size_t page_cache_page_count() const;
+    size_t release_page_cache();
+    static size_t release_all_page_caches();
+
+    // Inodes that keep their contents in physical pages hand those to shared mappings instead of a copy.
+    virtual bool is_backed_by_physical_pages() const { return false; }
+    virtual RefPtr<PhysicalPage> backing_page(size_t) { return nullptr; }
+
     static InlineLinkedList<Inode>& all_with_lock();
     static void sync();
 
@@ -125,6 +146,7 @@ protected:
     void inode_contents_changed(off_t, ssize_t, const u8*);
     void inode_size_changed(size_t old_size, size_t new_size);
     KResult prepare_to_write_data();
+    void invalidate_cached_pages(size_t first_page_index, size_t end_page_index);
 
     void did_add_child(const String& name);
     void did_remove_child(const String& name);
@@ -139,6 +161,10 @@ private:
     HashTable<InodeWatcher*> m_watchers;
     bool m_metadata_dirty { false };
     RefPtr<FIFO> m_fifo;
+
+    mutable Lock m_page_cache_lock { "InodePageCache" };
+    HashMap<u32, NonnullRefPtr<PhysicalPage>> m_page_cache;
+    u32 m_page_cache_generation { 0 };
 };
 
 }
@@ -46,7 +46,7 @@ InodeFile::~InodeFile()
 
 KResultOr<size_t> InodeFile::read(FileDescription& description, size_t offset, u8* buffer, size_t count)
 {
-    ssize_t nread = m_inode->read_bytes(offset, count, buffer, &description);
+    ssize_t nread = m_inode->read_bytes_through_page_cache(offset, count, buffer, &description);
     if (nread > 0)
         Thread::current()->did_file_read(nread);
     if (nread < 0)
@@ -70,7 +70,10 @@ KResultOr<Region*> InodeFile::mmap(Process& process, FileDescription& descriptio
 {
     // FIXME: If PROT_EXEC, check that the underlying file system isn't mounted noexec.
     RefPtr<InodeVMObject> vmobject;
-    if (shared)
+    // Read-only private mappings (like program text) can never diverge from the file, so they use
+    // the inode's system-wide shared VMObject instead of each reading their own copy of the pages.
+    // If one is later made writable, sys$mprotect() gives it a private VMObject first.
+    if (shared || !(prot & PROT_WRITE))
         vmobject = SharedInodeVMObject::create_with_inode(inode());
     else
         vmobject = PrivateInodeVMObject::create_with_inode(inode());
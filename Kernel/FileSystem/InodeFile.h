@@ -44,7 +44,7 @@ public:
     const Inode& inode() const { return *m_inode; }
     Inode& inode() { return *m_inode; }
 
-    virtual bool can_read(const FileDescription&, size_t) const override { return true; }
+    virtual bool can_read(const FileDescription& description, size_t) const override { return m_inode->can_read(description); }
     virtual bool can_write(const FileDescription&, size_t) const override { return true; }
 
     virtual KResultOr<size_t> read(FileDescription&, size_t, u8*, size_t) override;
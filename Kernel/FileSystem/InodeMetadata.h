@@ -51,6 +51,9 @@ inline bool is_sticky(mode_t mode) { return mode & S_ISVTX; }
 inline bool is_setuid(mode_t mode) { return mode & S_ISUID; }
 inline bool is_setgid(mode_t mode) { return mode & S_ISGID; }
 
+// The DT_* values are the file type bits of the mode, shifted down.
+inline u8 to_directory_entry_type(mode_t mode) { return (mode & S_IFMT) >> 12; }
+
 struct InodeMetadata {
     bool is_valid() const { return inode.is_valid(); }
 
@@ -49,7 +49,7 @@ InodeWatcher::~InodeWatcher()
 
 bool InodeWatcher::can_read(const FileDescription&, size_t) const
 {
-    return !m_queue.is_empty() || !m_inode;
+    return !m_queue.is_empty() || m_dropped_event_count || !m_inode;
 }
 
 bool InodeWatcher::can_write(const FileDescription&, size_t) const
@@ -60,16 +60,42 @@ bool InodeWatcher::can_write(const FileDescription&, size_t) const
 KResultOr<size_t> InodeWatcher::read(FileDescription&, size_t, u8* buffer, size_t buffer_size)
 {
     LOCKER(m_lock);
-    ASSERT(!m_queue.is_empty() || !m_inode);
+    ASSERT(!m_queue.is_empty() || m_dropped_event_count || !m_inode);
 
     if (!m_inode)
         return 0;
 
-    // FIXME: What should we do if the output buffer is too small?
-    ASSERT(buffer_size >= (int)sizeof(Event));
-    auto event = m_queue.dequeue();
-    memcpy(buffer, &event, sizeof(event));
-    return sizeof(event);
+    // Hand out as many events as fit, so a burst of changes doesn't cost the reader a wakeup each.
+    size_t nwritten = 0;
+    auto write_event = [&](const Event& event) {
+        size_t size = InodeWatcherEvent::size_with_name(event.name.length());
+        if (nwritten + size > buffer_size)
+            return false;
+        InodeWatcherEvent header;
+        header.type = event.type;
+        header.count = event.count;
+        header.name_length = event.name.length();
+        memcpy(buffer + nwritten, &header, sizeof(header));
+        if (!event.name.is_empty())
+            memcpy(buffer + nwritten + sizeof(header), event.name.characters(), event.name.length());
+        memset(buffer + nwritten + sizeof(header) + event.name.length(), 0, size - sizeof(header) - event.name.length());
+        nwritten += size;
+        return true;
+    };
+
+    while (!m_queue.is_empty()) {
+        if (!write_event(m_queue.first()))
+            break;
+        m_queue.dequeue();
+    }
+    if (m_queue.is_empty() && m_dropped_event_count) {
+        if (write_event({ Event::Type::Overflow, m_dropped_event_count, {} }))
+            m_dropped_event_count = 0;
+    }
+
+    if (!nwritten)
+        return KResult(-EINVAL);
+    return nwritten;
 }
 
 KResultOr<size_t> InodeWatcher::write(FileDescription&, size_t, const u8*, size_t)
@@ -84,22 +110,39 @@ String InodeWatcher::absolute_path(const FileDescription&) const
     return String::format("InodeWatcher:%s", m_inode->identifier().to_string().characters());
 }
 
-void InodeWatcher::notify_inode_event(Badge<Inode>, Event::Type event_type)
+void InodeWatcher::enqueue(Event::Type type, const String& name)
 {
     LOCKER(m_lock);
-    m_queue.enqueue({ event_type, {} });
+    // Fold repeats of the newest event into it; a burst of writes to one file only needs to be reported once.
+    if (!m_queue.is_empty() && !m_dropped_event_count) {
+        auto& last = m_queue.last();
+        if (last.type == type && last.name == name) {
+            ++last.count;
+            return;
+        }
+    }
+    // Once the queue is full, stop queueing and only count what we missed, rather than silently
+    // overwriting the oldest events or letting the queue grow without bound.
+    if (m_dropped_event_count || m_queue.size() == m_queue.capacity()) {
+        ++m_dropped_event_count;
+        return;
+    }
+    m_queue.enqueue({ type, 1, name });
+}
+
+void InodeWatcher::notify_inode_event(Badge<Inode>, Event::Type event_type)
+{
+    enqueue(event_type, {});
 }
 
 void InodeWatcher::notify_child_added(Badge<Inode>, const String& child_name)
 {
-    LOCKER(m_lock);
-    m_queue.enqueue({ Event::Type::ChildAdded, child_name });
+    enqueue(Event::Type::ChildAdded, child_name);
 }
 
 void InodeWatcher::notify_child_removed(Badge<Inode>, const String& child_name)
 {
-    LOCKER(m_lock);
-    m_queue.enqueue({ Event::Type::ChildRemoved, child_name });
+    enqueue(Event::Type::ChildRemoved, child_name);
 }
 
 }
@@ -29,6 +29,7 @@
 #include <AK/Badge.h>
 #include <AK/CircularQueue.h>
 #include <AK/WeakPtr.h>
+#include <Kernel/API/InodeWatcherEvent.h>
 #include <Kernel/FileSystem/File.h>
 #include <Kernel/Lock.h>
 
@@ -42,15 +43,11 @@ public:
     virtual ~InodeWatcher() override;
 
     struct Event {
-        enum class Type {
-            Invalid = 0,
-            Modified,
-            ChildAdded,
-            ChildRemoved,
-        };
+        using Type = InodeWatcherEvent::Type;
 
         Type type { Type::Invalid };
-        String string;
+        u32 count { 1 };
+        String name;
     };
 
     virtual bool can_read(const FileDescription&, size_t) const override;
@@ -67,9 +64,13 @@ public:
 private:
     explicit InodeWatcher(Inode&);
 
+    void enqueue(Event::Type, const String& name);
+
     Lock m_lock;
     WeakPtr<Inode> m_inode;
     CircularQueue<Event, 32> m_queue;
+    // How many events didn't fit in the queue. The reader gets an Overflow event after the queued ones.
+    u32 m_dropped_event_count { 0 };
 };
 
 }
@@ -26,9 +26,26 @@
 
 #include <Kernel/FileSystem/Plan9FileSystem.h>
 #include <Kernel/Process.h>
+#include <Kernel/Time/TimeManagement.h>
 
 namespace Kernel {
 
+// How many reads or writes of one file we keep in flight at the same time.
+static constexpr size_t max_outstanding_requests = 8;
+static constexpr size_t readahead_size = 128 * KB;
+static constexpr u64 cache_expiry_ns = 1'000'000'000;
+static constexpr size_t max_cached_lookups_per_directory = 64;
+
+static u64 cache_expiry_from_now()
+{
+    return TimeManagement::the().nanoseconds_since_boot() + cache_expiry_ns;
+}
+
+static bool has_expired(u64 expiry)
+{
+    return TimeManagement::the().nanoseconds_since_boot() >= expiry;
+}
+
 NonnullRefPtr<Plan9FS> Plan9FS::create(FileDescription& file_description)
 {
     return adopt(*new Plan9FS(file_description));
@@ -214,6 +231,23 @@ private:
     bool m_have_been_built { false };
 };
 
+struct Plan9FS::PendingRequest {
+    PendingRequest(Plan9FS& fs, Message::Type type)
+        : message(fs, type)
+        , tag(message.tag())
+        , request_type(type)
+        , completion { fs, message, result, false }
+    {
+    }
+
+    Message message;
+    u16 tag;
+    Message::Type request_type;
+    KResult result { KSuccess };
+    ReceiveCompletion completion;
+    size_t size { 0 };
+};
+
 bool Plan9FS::initialize()
 {
     Message version_message { *this, Message::Type::Tversion };
@@ -412,7 +446,24 @@ const KBuffer& Plan9FS::Message::build()
     return m_built.buffer;
 }
 
-KResult Plan9FS::post_message(Message& message)
+KResult Plan9FS::post_message(Message& message, ReceiveCompletion* completion)
+{
+    auto tag = message.tag();
+    if (completion) {
+        // Whoever is reading could see the reply as soon as it's sent, so we have to be expecting it by then.
+        LOCKER(m_lock);
+        m_completions.set(tag, completion);
+    }
+
+    auto result = send_message(message);
+    if (result.is_error() && completion) {
+        LOCKER(m_lock);
+        m_completions.remove(tag);
+    }
+    return result;
+}
+
+KResult Plan9FS::send_message(Message& message)
 {
     auto& buffer = message.build();
     const u8* data = buffer.data();
@@ -513,31 +564,23 @@ bool Plan9FS::Blocker::should_unblock(Thread&)
     return false;
 }
 
-KResult Plan9FS::wait_for_specific_message(u16 tag, Message& out_message)
+KResult Plan9FS::wait_for_completion(ReceiveCompletion& completion, u16 tag)
 {
-    KResult result = KSuccess;
-    ReceiveCompletion completion { *this, out_message, result, false };
-
-    {
-        LOCKER(m_lock);
-        m_completions.set(tag, &completion);
-    }
-
     // Block until either:
     // * Someone else reads the message we're waiting for, and hands it to us;
     // * Or we become the one to read and dispatch messages.
     if (Thread::current()->block<Plan9FS::Blocker>(nullptr, completion).was_interrupted()) {
-        LOCKER(m_lock);
-        m_completions.remove(tag);
+        abandon_completion(completion, tag);
         return KResult(-EINTR);
     }
 
     // See for which reason we woke up.
     if (completion.completed) {
         // Somebody else completed it for us; nothing further to do.
-        return result;
+        return completion.result;
     }
 
+    KResult result = KSuccess;
     while (!completion.completed && result.is_success()) {
         result = read_and_dispatch_one_message();
     }
@@ -556,7 +599,17 @@ KResult Plan9FS::wait_for_specific_message(u16 tag, Message& out_message)
     // Wake up someone else, if anyone is interested...
     m_someone_is_reading = false;
     // ...and return.
-    return result;
+    return completion.result;
+}
+
+void Plan9FS::abandon_completion(ReceiveCompletion& completion, u16 tag)
+{
+    LOCKER(m_lock);
+    if (completion.completed)
+        return;
+    m_completions.remove(tag);
+    // The reply is still on its way, so don't complain about it when it arrives.
+    m_tags_to_ignore.set(tag);
 }
 
 KResult Plan9FS::post_message_and_explicitly_ignore_reply(Message& message)
@@ -576,28 +629,16 @@ KResult Plan9FS::post_message_and_explicitly_ignore_reply(Message& message)
     return result;
 }
 
-KResult Plan9FS::post_message_and_wait_for_a_reply(Message& message, bool auto_convert_error_reply_to_error)
+static KResult convert_reply_to_result(Plan9FS::Message& message, Plan9FS::Message::Type request_type)
 {
-    auto request_type = message.type();
-    auto tag = message.tag();
-    auto result = post_message(message);
-    if (result.is_error())
-        return result;
-    result = wait_for_specific_message(tag, message);
-    if (result.is_error())
-        return result;
-
-    if (!auto_convert_error_reply_to_error)
-        return KSuccess;
-
     auto reply_type = message.type();
 
-    if (reply_type == Message::Type::Rlerror) {
+    if (reply_type == Plan9FS::Message::Type::Rlerror) {
         // Contains a numerical Linux errno; hopefully our errno numbers match.
         u32 error_code;
         message >> error_code;
         return KResult(-error_code);
-    } else if (reply_type == Message::Type::Rerror) {
+    } else if (reply_type == Plan9FS::Message::Type::Rerror) {
         // Contains an error message. We could attempt to parse it, but for now
         // we simply return -EIO instead. In 9P200.u, it can also contain a
         // numerical errno in an unspecified encoding; we ignore those too.
@@ -616,6 +657,43 @@ KResult Plan9FS::post_message_and_wait_for_a_reply(Message& message, bool auto_c
     }
 }
 
+KResult Plan9FS::post_message_and_wait_for_a_reply(Message& message, bool auto_convert_error_reply_to_error)
+{
+    auto request_type = message.type();
+    auto tag = message.tag();
+    KResult result = KSuccess;
+    ReceiveCompletion completion { *this, message, result, false };
+    auto post_result = post_message(message, &completion);
+    if (post_result.is_error())
+        return post_result;
+    auto wait_result = wait_for_completion(completion, tag);
+    if (wait_result.is_error())
+        return wait_result;
+
+    if (!auto_convert_error_reply_to_error)
+        return KSuccess;
+
+    return convert_reply_to_result(message, request_type);
+}
+
+KResult Plan9FS::post_request(PendingRequest& request)
+{
+    return post_message(request.message, &request.completion);
+}
+
+KResult Plan9FS::wait_for_reply(PendingRequest& request)
+{
+    auto result = wait_for_completion(request.completion, request.tag);
+    if (result.is_error())
+        return result;
+    return convert_reply_to_result(request.message, request.request_type);
+}
+
+void Plan9FS::abandon_request(PendingRequest& request)
+{
+    abandon_completion(request.completion, request.tag);
+}
+
 ssize_t Plan9FS::adjust_buffer_size(ssize_t size) const
 {
     ssize_t max_size = m_max_message_size - Message::max_header_size;
@@ -683,35 +761,122 @@ ssize_t Plan9FSInode::read_bytes(off_t offset, ssize_t size, u8* buffer, FileDes
     if (result.is_error())
         return result;
 
-    size = fs().adjust_buffer_size(size);
-
-    Plan9FS::Message message { fs(), Plan9FS::Message::Type::Treadlink };
-    StringView data;
-
-    // Try readlink first.
-    bool readlink_succeded = false;
-    if (fs().m_remote_protocol_version >= Plan9FS::ProtocolVersion::v9P2000L && offset == 0) {
+    if (fs().m_remote_protocol_version >= Plan9FS::ProtocolVersion::v9P2000L && offset == 0 && metadata().is_symlink()) {
+        Plan9FS::Message message { fs(), Plan9FS::Message::Type::Treadlink };
         message << fid();
         result = fs().post_message_and_wait_for_a_reply(message);
-        if (result.is_success()) {
-            readlink_succeded = true;
-            message >> data;
-        }
-    }
-
-    if (!readlink_succeded) {
-        message = Plan9FS::Message { fs(), Plan9FS::Message::Type::Tread };
-        message << fid() << (u64)offset << (u32)size;
-        result = fs().post_message_and_wait_for_a_reply(message);
         if (result.is_error())
             return result.error();
-        data = message.read_data();
+        StringView data;
+        message >> data;
+        // Guard against the server returning more data than requested.
+        size_t nread = min(data.length(), (size_t)size);
+        memcpy(buffer, data.characters_without_null_termination(), nread);
+        return nread;
     }
 
-    // Guard against the server returning more data than requested.
-    size_t nread = min(data.length(), (size_t)size);
-    memcpy(buffer, data.characters_without_null_termination(), nread);
+    size_t nread = read_from_readahead(offset, size, buffer);
+    if (nread == (size_t)size)
+        return nread;
+    {
+        LOCKER(m_lock);
+        if (nread && m_readahead_reached_end)
+            return nread;
+    }
+    offset += nread;
+    size_t remaining = size - nread;
 
+    if (remaining >= readahead_size) {
+        auto nread_or_error = read_from_server(offset, remaining, buffer + nread);
+        if (nread_or_error.is_error())
+            return nread ? nread : nread_or_error.error();
+        return nread + nread_or_error.value();
+    }
+
+    // A small read is probably one of many in a row, so fetch more than was asked for while we're at it.
+    auto readahead = KBuffer::create_with_size(readahead_size);
+    auto fetched_or_error = read_from_server(offset, readahead_size, readahead.data());
+    if (fetched_or_error.is_error())
+        return nread ? nread : fetched_or_error.error();
+    size_t fetched = fetched_or_error.value();
+    size_t bytes_to_copy = min(fetched, remaining);
+    memcpy(buffer + nread, readahead.data(), bytes_to_copy);
+
+    LOCKER(m_lock);
+    readahead.set_size(fetched);
+    m_readahead_data = move(readahead);
+    m_readahead_offset = offset;
+    m_readahead_reached_end = fetched < readahead_size;
+    m_readahead_expiry = cache_expiry_from_now();
+    return nread + bytes_to_copy;
+}
+
+size_t Plan9FSInode::read_from_readahead(u64 offset, size_t size, u8* buffer) const
+{
+    LOCKER(m_lock);
+    if (!m_readahead_data.has_value())
+        return 0;
+    if (has_expired(m_readahead_expiry)) {
+        m_readahead_data.clear();
+        return 0;
+    }
+    auto& data = m_readahead_data.value();
+    if (offset < m_readahead_offset || offset >= m_readahead_offset + data.size())
+        return 0;
+    size_t offset_in_data = offset - m_readahead_offset;
+    size_t bytes_to_copy = min(size, data.size() - offset_in_data);
+    memcpy(buffer, data.data() + offset_in_data, bytes_to_copy);
+    return bytes_to_copy;
+}
+
+KResultOr<size_t> Plan9FSInode::read_from_server(u64 offset, size_t size, u8* buffer) const
+{
+    size_t max_chunk_size = fs().adjust_buffer_size(size);
+    size_t nread = 0;
+
+    while (nread < size) {
+        // Put a batch of reads on the wire before waiting for the first reply.
+        Vector<NonnullOwnPtr<Plan9FS::PendingRequest>, max_outstanding_requests> requests;
+        KResult result = KSuccess;
+        size_t requested = nread;
+        while (requests.size() < max_outstanding_requests && requested < size) {
+            auto request = make<Plan9FS::PendingRequest>(fs(), Plan9FS::Message::Type::Tread);
+            request->size = min(max_chunk_size, size - requested);
+            request->message << fid() << (u64)(offset + requested) << (u32)request->size;
+            result = fs().post_request(*request);
+            if (result.is_error())
+                break;
+            requested += request->size;
+            requests.append(move(request));
+        }
+
+        bool done = requests.size() == 0;
+        for (auto& request : requests) {
+            if (done) {
+                fs().abandon_request(*request);
+                continue;
+            }
+            result = fs().wait_for_reply(*request);
+            if (result.is_error()) {
+                done = true;
+                continue;
+            }
+            auto data = request->message.read_data();
+            // Guard against the server returning more data than requested.
+            size_t chunk_nread = min(data.length(), request->size);
+            memcpy(buffer + nread, data.characters_without_null_termination(), chunk_nread);
+            nread += chunk_nread;
+            // A short read means we've hit the end of the file.
+            if (chunk_nread < request->size)
+                done = true;
+        }
+
+        if (done || result.is_error()) {
+            if (!nread && result.is_error())
+                return result;
+            break;
+        }
+    }
     return nread;
 }
 
@@ -721,22 +886,71 @@ ssize_t Plan9FSInode::write_bytes(off_t offset, ssize_t size, const u8* data, Fi
     if (result.is_error())
         return result;
 
-    size = fs().adjust_buffer_size(size);
+    invalidate_cached_data();
 
-    Plan9FS::Message message { fs(), Plan9FS::Message::Type::Twrite };
-    message << fid() << (u64)offset;
-    message.append_data({ data, (size_t)size });
-    result = fs().post_message_and_wait_for_a_reply(message);
-    if (result.is_error())
-        return result.error();
+    size_t max_chunk_size = fs().adjust_buffer_size(size);
+    size_t nwritten = 0;
 
-    u32 nwritten;
-    message >> nwritten;
+    while (nwritten < (size_t)size) {
+        Vector<NonnullOwnPtr<Plan9FS::PendingRequest>, max_outstanding_requests> requests;
+        size_t requested = nwritten;
+        while (requests.size() < max_outstanding_requests && requested < (size_t)size) {
+            auto request = make<Plan9FS::PendingRequest>(fs(), Plan9FS::Message::Type::Twrite);
+            request->size = min(max_chunk_size, (size_t)size - requested);
+            request->message << fid() << (u64)(offset + requested);
+            request->message.append_data({ data + requested, request->size });
+            result = fs().post_request(*request);
+            if (result.is_error())
+                break;
+            requested += request->size;
+            requests.append(move(request));
+        }
+
+        bool done = requests.size() == 0;
+        for (auto& request : requests) {
+            if (done) {
+                fs().abandon_request(*request);
+                continue;
+            }
+            result = fs().wait_for_reply(*request);
+            if (result.is_error()) {
+                done = true;
+                continue;
+            }
+            u32 chunk_nwritten;
+            request->message >> chunk_nwritten;
+            nwritten += min((size_t)chunk_nwritten, request->size);
+            if (chunk_nwritten < request->size)
+                done = true;
+        }
+
+        if (done || result.is_error()) {
+            if (!nwritten && result.is_error())
+                return result;
+            break;
+        }
+    }
+
+    // Our cached copies could have been refilled while the writes were in flight.
+    invalidate_cached_data();
     return nwritten;
 }
 
+void Plan9FSInode::invalidate_cached_data()
+{
+    LOCKER(m_lock);
+    m_cached_metadata.clear();
+    m_readahead_data.clear();
+}
+
 InodeMetadata Plan9FSInode::metadata() const
 {
+    {
+        LOCKER(m_lock);
+        if (m_cached_metadata.has_value() && !has_expired(m_cached_metadata_expiry))
+            return m_cached_metadata.value();
+    }
+
     InodeMetadata metadata;
     metadata.inode = identifier();
 
@@ -787,6 +1001,9 @@ InodeMetadata Plan9FSInode::metadata() const
         metadata.block_count = blocks;
     }
 
+    LOCKER(m_lock);
+    m_cached_metadata = metadata;
+    m_cached_metadata_expiry = cache_expiry_from_now();
     return metadata;
 }
 
@@ -884,6 +1101,16 @@ KResult Plan9FSInode::traverse_as_directory(Function<bool(const FS::DirectoryEnt
 
 RefPtr<Inode> Plan9FSInode::lookup(StringView name)
 {
+    {
+        LOCKER(m_lock);
+        auto it = m_lookup_cache.find(name);
+        if (it != m_lookup_cache.end()) {
+            if (!has_expired(it->value.expiry))
+                return it->value.inode;
+            m_lookup_cache.remove(it);
+        }
+    }
+
     u32 newfid = fs().allocate_fid();
     Plan9FS::Message message { fs(), Plan9FS::Message::Type::Twalk };
     message << fid() << newfid << (u16)1 << name;
@@ -892,7 +1119,25 @@ RefPtr<Inode> Plan9FSInode::lookup(StringView name)
     if (result.is_error())
         return nullptr;
 
-    return Plan9FSInode::create(fs(), newfid);
+    auto inode = Plan9FSInode::create(fs(), newfid);
+
+    // Dropping an inode clunks its fid, which is a message too, so do that after unlocking.
+    Vector<RefPtr<Plan9FSInode>> expired_inodes;
+    LOCKER(m_lock);
+    if (m_lookup_cache.size() >= max_cached_lookups_per_directory) {
+        Vector<String> expired_names;
+        for (auto& it : m_lookup_cache) {
+            if (!has_expired(it.value.expiry))
+                continue;
+            expired_names.append(it.key);
+            expired_inodes.append(move(it.value.inode));
+        }
+        for (auto& expired_name : expired_names)
+            m_lookup_cache.remove(expired_name);
+    }
+    if (m_lookup_cache.size() < max_cached_lookups_per_directory)
+        m_lookup_cache.set(name, { inode, cache_expiry_from_now() });
+    return inode;
 }
 
 KResultOr<NonnullRefPtr<Inode>> Plan9FSInode::create_child(const String&, mode_t, dev_t, uid_t, gid_t)
@@ -927,6 +1172,7 @@ KResult Plan9FSInode::chown(uid_t, gid_t)
 
 KResult Plan9FSInode::truncate(u64 new_size)
 {
+    invalidate_cached_data();
     if (fs().m_remote_protocol_version >= Plan9FS::ProtocolVersion::v9P2000L) {
         Plan9FS::Message message { fs(), Plan9FS::Message::Type::Tsetattr };
         SetAttrMask valid = SetAttrMask::Size;
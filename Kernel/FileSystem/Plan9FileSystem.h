@@ -27,6 +27,8 @@
 #pragma once
 
 #include <AK/Atomic.h>
+#include <AK/HashMap.h>
+#include <AK/Optional.h>
 #include <Kernel/FileSystem/FileBackedFileSystem.h>
 #include <Kernel/FileSystem/Inode.h>
 #include <Kernel/KBufferBuilder.h>
@@ -75,12 +77,16 @@ private:
         Atomic<bool> completed;
     };
 
+    struct PendingRequest;
+
     class Blocker final : public Thread::Blocker {
     public:
         Blocker(ReceiveCompletion& completion)
             : m_completion(completion)
         {
         }
+        // Waiting for the server to reply is waiting to read from it.
+        virtual Type type() const override { return Type::Read; }
         virtual bool should_unblock(Thread&) override;
         virtual const char* state_string() const override { return "Waiting"; }
 
@@ -90,13 +96,20 @@ private:
 
     virtual const char* class_name() const override { return "Plan9FS"; }
 
-    KResult post_message(Message&);
+    KResult post_message(Message&, ReceiveCompletion* = nullptr);
+    KResult send_message(Message&);
     KResult do_read(u8* buffer, size_t);
     KResult read_and_dispatch_one_message();
-    KResult wait_for_specific_message(u16 tag, Message& out_message);
+    KResult wait_for_completion(ReceiveCompletion&, u16 tag);
+    void abandon_completion(ReceiveCompletion&, u16 tag);
     KResult post_message_and_wait_for_a_reply(Message&, bool auto_convert_error_reply_to_error = true);
     KResult post_message_and_explicitly_ignore_reply(Message&);
 
+    // Several of these can be in flight at once, and their replies are collected in order.
+    KResult post_request(PendingRequest&);
+    KResult wait_for_reply(PendingRequest&);
+    void abandon_request(PendingRequest&);
+
     ProtocolVersion parse_protocol_version(const StringView&) const;
     ssize_t adjust_buffer_size(ssize_t size) const;
 
@@ -105,7 +118,8 @@ private:
     Atomic<u32> m_next_fid { 1 };
 
     ProtocolVersion m_remote_protocol_version { ProtocolVersion::v9P2000 };
-    size_t m_max_message_size { 4 * KB };
+    // This is what we ask for; the server may settle on less.
+    size_t m_max_message_size { 512 * KB };
 
     Lock m_send_lock { "Plan9FS send" };
     Atomic<bool> m_someone_is_reading { false };
@@ -177,6 +191,26 @@ private:
     int m_open_mode { 0 };
     KResult ensure_open_for_mode(int mode);
 
+    KResultOr<size_t> read_from_server(u64 offset, size_t size, u8* buffer) const;
+    size_t read_from_readahead(u64 offset, size_t size, u8* buffer) const;
+    void invalidate_cached_data();
+
+    // The server may change files behind our back, so none of these are kept for long.
+    mutable Optional<InodeMetadata> m_cached_metadata;
+    mutable u64 m_cached_metadata_expiry { 0 };
+
+    // Data past the end of the last short read, so that sequential reads don't each wait for a round trip.
+    mutable Optional<KBuffer> m_readahead_data;
+    mutable u64 m_readahead_offset { 0 };
+    mutable bool m_readahead_reached_end { false };
+    mutable u64 m_readahead_expiry { 0 };
+
+    struct CachedLookup {
+        RefPtr<Plan9FSInode> inode;
+        u64 expiry { 0 };
+    };
+    HashMap<String, CachedLookup> m_lookup_cache;
+
     Plan9FS& fs() { return reinterpret_cast<Plan9FS&>(Inode::fs()); }
     Plan9FS& fs() const
     {
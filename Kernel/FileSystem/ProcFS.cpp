@@ -28,12 +28,14 @@
 #include <AK/JsonObject.h>
 #include <AK/JsonObjectSerializer.h>
 #include <AK/JsonValue.h>
+#include <AK/QuickSort.h>
 #include <Kernel/Arch/i386/CPU.h>
 #include <Kernel/Arch/i386/ProcessorInfo.h>
 #include <Kernel/CommandLine.h>
 #include <Kernel/Console.h>
 #include <Kernel/Devices/BlockDevice.h>
 #include <Kernel/Devices/KeyboardDevice.h>
+#include <Kernel/FileSystem/BlockBasedFileSystem.h>
 #include <Kernel/FileSystem/Custody.h>
 #include <Kernel/FileSystem/FileBackedFileSystem.h>
 #include <Kernel/FileSystem/FileDescription.h>
@@ -51,11 +53,13 @@
 #include <Kernel/Net/TCPSocket.h>
 #include <Kernel/Net/UDPSocket.h>
 #include <Kernel/PCI/Access.h>
+#include <Kernel/PerformanceCounters.h>
 #include <Kernel/Process.h>
 #include <Kernel/Profiling.h>
 #include <Kernel/Scheduler.h>
 #include <Kernel/StdLib.h>
 #include <Kernel/TTY/TTY.h>
+#include <Kernel/VM/InodeVMObject.h>
 #include <Kernel/VM/MemoryManager.h>
 #include <Kernel/VM/PurgeableVMObject.h>
 #include <LibC/errno_numbers.h>
@@ -83,11 +87,13 @@ enum ProcFileType {
     FI_Root_mounts,
     FI_Root_df,
     FI_Root_all,
+    FI_Root_all_binary,
     FI_Root_memstat,
     FI_Root_cpuinfo,
     FI_Root_inodes,
     FI_Root_dmesg,
     FI_Root_interrupts,
+    FI_Root_irq_affinity,
     FI_Root_keymap,
     FI_Root_pci,
     FI_Root_devices,
@@ -95,6 +101,13 @@ enum ProcFileType {
     FI_Root_cmdline,
     FI_Root_modules,
     FI_Root_profile,
+    FI_Root_profile_stream,
+    FI_Root_syscalls,
+    FI_Root_locks,
+    FI_Root_lockstat,
+    FI_Root_runqueues,
+    FI_Root_ipis,
+    FI_Root_memory_pressure,
     FI_Root_self, // symlink
     FI_Root_sys,  // directory
     FI_Root_net,  // directory
@@ -116,6 +129,8 @@ enum ProcFileType {
     FI_PID_stacks, // directory
     FI_PID_fds,
     FI_PID_unveil,
+    FI_PID_syscalls,
+    FI_PID_schedstat,
     FI_PID_exe,  // symlink
     FI_PID_cwd,  // symlink
     FI_PID_root, // symlink
@@ -308,6 +323,68 @@ static Optional<KBuffer> procfs$pid_fd_entry(InodeIdentifier identifier)
     return description->absolute_path().to_byte_buffer();
 }
 
+static void serialize_syscall_latency(JsonArraySerializer<KBufferBuilder>& array, u32 function, const SyscallLatency& latency)
+{
+    auto object = array.add_object();
+    object.add("name", Syscall::to_string((Syscall::Function)function));
+    object.add("call_count", latency.call_count);
+    object.add("total_ns", latency.total_nanoseconds);
+    auto histogram_array = object.add_array("histogram");
+    for (size_t i = 0; i < SyscallLatency::histogram_bucket_count; ++i)
+        histogram_array.add(latency.histogram[i]);
+    histogram_array.finish();
+}
+
+static Optional<KBuffer> procfs$pid_syscalls(InodeIdentifier identifier)
+{
+    auto process = Process::from_pid(to_pid(identifier));
+    if (!process)
+        return {};
+    KBufferBuilder builder;
+    JsonArraySerializer array { builder };
+    for (u32 function = 0; function < Syscall::Function::__Count; ++function) {
+        if (auto* latency = process->syscall_statistics().get(function))
+            serialize_syscall_latency(array, function, *latency);
+    }
+    array.finish();
+    return builder.build();
+}
+
+// Where each thread's time went while it wasn't running. Times are in TSC cycles.
+static Optional<KBuffer> procfs$pid_schedstat(InodeIdentifier identifier)
+{
+    auto process = Process::from_pid(to_pid(identifier));
+    if (!process)
+        return {};
+
+    struct ThreadEntry {
+        ThreadID tid;
+        u32 times_scheduled;
+        Thread::SchedulerStatistics statistics;
+    };
+    Vector<ThreadEntry> threads;
+    process->for_each_thread([&](const Thread& thread) {
+        threads.append({ thread.tid(), thread.times_scheduled(), thread.scheduler_statistics() });
+        return IterationDecision::Continue;
+    });
+
+    KBufferBuilder builder;
+    JsonArraySerializer array { builder };
+    for (auto& thread : threads) {
+        auto thread_object = array.add_object();
+        thread_object.add("tid", thread.tid.value());
+        thread_object.add("times_scheduled", thread.times_scheduled);
+        thread_object.add("involuntary_switches", thread.statistics.involuntary_switches);
+        thread_object.add("runnable_cycles", thread.statistics.runnable_cycles);
+        thread_object.add("queued_cycles", thread.statistics.queued_cycles);
+        auto blocked_object = thread_object.add_object("blocked_cycles");
+        for (size_t i = 0; i < (size_t)Thread::Blocker::Type::__Count; ++i)
+            blocked_object.add(Thread::Blocker::type_name((Thread::Blocker::Type)i), thread.statistics.blocked_cycles[i]);
+    }
+    array.finish();
+    return builder.build();
+}
+
 static Optional<KBuffer> procfs$pid_vm(InodeIdentifier identifier)
 {
     auto process = Process::from_pid(to_pid(identifier));
@@ -388,14 +465,46 @@ static Optional<KBuffer> procfs$interrupts(InodeIdentifier)
         obj.add("purpose", handler.purpose());
         obj.add("interrupt_line", handler.interrupt_number());
         obj.add("controller", handler.controller());
-        obj.add("cpu_handler", 0); // FIXME: Determine the responsible CPU for each interrupt handler.
+        obj.add("cpu_handler", handler.target_processor());
         obj.add("device_sharing", (unsigned)handler.sharing_devices_count());
         obj.add("call_count", (unsigned)handler.get_invoking_count());
+        auto per_cpu_array = obj.add_array("per_cpu_call_counts");
+        for (u32 processor = 0; processor < min(Processor::count(), GenericInterruptHandler::max_processors); ++processor)
+            per_cpu_array.add((unsigned)handler.get_invoking_count_on_processor(processor));
     });
     array.finish();
     return builder.build();
 }
 
+static Optional<KBuffer> procfs$irq_affinity(InodeIdentifier)
+{
+    KBufferBuilder builder;
+    InterruptManagement::the().enumerate_interrupt_handlers([&builder](GenericInterruptHandler& handler) {
+        builder.appendff("{} {}\n", handler.interrupt_number(), handler.target_processor());
+    });
+    return builder.build();
+}
+
+static ssize_t write_irq_affinity(InodeIdentifier, const ByteBuffer& data)
+{
+    // Takes "<interrupt line> <cpu>", and has that processor handle the interrupt from now on.
+    StringView line(data.data(), data.size());
+    if (line.ends_with("\n"))
+        line = line.substring_view(0, line.length() - 1);
+    auto parts = line.split_view(' ');
+    if (parts.size() != 2)
+        return data.size();
+    auto interrupt_number = parts[0].to_uint();
+    auto processor = parts[1].to_uint();
+    if (!interrupt_number.has_value() || !processor.has_value())
+        return data.size();
+    InterruptManagement::the().enumerate_interrupt_handlers([&](GenericInterruptHandler& handler) {
+        if (handler.interrupt_number() == interrupt_number.value())
+            handler.set_target_processor(processor.value());
+    });
+    return data.size();
+}
+
 static Optional<KBuffer> procfs$keymap(InodeIdentifier)
 {
     KBufferBuilder builder;
@@ -429,7 +538,7 @@ static Optional<KBuffer> procfs$devices(InodeIdentifier)
 static Optional<KBuffer> procfs$uptime(InodeIdentifier)
 {
     KBufferBuilder builder;
-    builder.appendf("%u\n", (g_uptime / 1000));
+    builder.appendff("{}\n", g_uptime / 1000);
     return builder.build();
 }
 
@@ -461,9 +570,29 @@ static Optional<KBuffer> procfs$modules(InodeIdentifier)
     return builder.build();
 }
 
+static void serialize_profile_sample(JsonArraySerializer<KBufferBuilder>& array, const Profiling::Sample& sample, bool mask_kernel_addresses)
+{
+    auto object = array.add_object();
+    object.add("type", "sample");
+    object.add("pid", sample.pid.value());
+    object.add("tid", sample.tid.value());
+    object.add("timestamp", sample.timestamp);
+    if (sample.event_type)
+        object.add("event", PerformanceCounters::event_name(sample.event_type));
+    auto frames_array = object.add_array("stack");
+    for (size_t i = 0; i < Profiling::max_stack_frame_count; ++i) {
+        if (sample.frames[i] == 0)
+            break;
+        u32 address = (u32)sample.frames[i];
+        if (mask_kernel_addresses && !is_user_address(VirtualAddress(address)))
+            address = 0xdeadc0de;
+        frames_array.add(address);
+    }
+    frames_array.finish();
+}
+
 static Optional<KBuffer> procfs$profile(InodeIdentifier)
 {
-    InterruptDisabler disabler;
     KBufferBuilder builder;
 
     JsonObjectSerializer object(builder);
@@ -473,26 +602,34 @@ static Optional<KBuffer> procfs$profile(InodeIdentifier)
     auto array = object.add_array("events");
     bool mask_kernel_addresses = !Process::current()->is_superuser();
     Profiling::for_each_sample([&](auto& sample) {
-        auto object = array.add_object();
-        object.add("type", "sample");
-        object.add("tid", sample.tid.value());
-        object.add("timestamp", sample.timestamp);
-        auto frames_array = object.add_array("stack");
-        for (size_t i = 0; i < Profiling::max_stack_frame_count; ++i) {
-            if (sample.frames[i] == 0)
-                break;
-            u32 address = (u32)sample.frames[i];
-            if (mask_kernel_addresses && !is_user_address(VirtualAddress(address)))
-                address = 0xdeadc0de;
-            frames_array.add(address);
-        }
-        frames_array.finish();
+        serialize_profile_sample(array, sample, mask_kernel_addresses);
     });
     array.finish();
     object.finish();
     return builder.build();
 }
 
+// Like profile, but every pass only has the samples taken since the previous one, so a reader
+// that keeps reading this can capture for as long as it likes.
+static Optional<KBuffer> procfs$profile_stream(InodeIdentifier)
+{
+    KBufferBuilder builder;
+
+    JsonObjectSerializer object(builder);
+    object.add("pid", Profiling::pid().value());
+    object.add("executable", Profiling::executable_path());
+
+    auto array = object.add_array("events");
+    bool mask_kernel_addresses = !Process::current()->is_superuser();
+    auto lost_samples = Profiling::consume_samples([&](auto& sample) {
+        serialize_profile_sample(array, sample, mask_kernel_addresses);
+    });
+    array.finish();
+    object.add("lost_samples", (u64)lost_samples);
+    object.finish();
+    return builder.build();
+}
+
 static Optional<KBuffer> procfs$net_adapters(InodeIdentifier)
 {
     KBufferBuilder builder;
@@ -512,6 +649,9 @@ static Optional<KBuffer> procfs$net_adapters(InodeIdentifier)
         obj.add("bytes_in", adapter.bytes_in());
         obj.add("packets_out", adapter.packets_out());
         obj.add("bytes_out", adapter.bytes_out());
+        obj.add("receive_interrupts", adapter.receive_interrupts());
+        if (adapter.receive_interrupts())
+            obj.add("packets_per_interrupt", adapter.packets_in() / adapter.receive_interrupts());
         obj.add("link_up", adapter.link_up());
         obj.add("mtu", adapter.mtu());
     });
@@ -550,6 +690,12 @@ static Optional<KBuffer> procfs$net_tcp(InodeIdentifier)
         obj.add("bytes_in", socket.bytes_in());
         obj.add("packets_out", socket.packets_out());
         obj.add("bytes_out", socket.bytes_out());
+        obj.add("congestion_window", socket.congestion_window());
+        obj.add("slow_start_threshold", socket.slow_start_threshold());
+        obj.add("smoothed_rtt_ms", socket.smoothed_rtt_ms());
+        obj.add("retransmission_timeout_ms", socket.retransmission_timeout_ms());
+        obj.add("retransmits", socket.retransmits());
+        obj.add("fast_retransmits", socket.fast_retransmits());
     });
     array.finish();
     return builder.build();
@@ -583,6 +729,18 @@ static Optional<KBuffer> procfs$net_local(InodeIdentifier)
         obj.add("acceptor_pid", socket.acceptor_pid());
         obj.add("acceptor_uid", socket.acceptor_uid());
         obj.add("acceptor_gid", socket.acceptor_gid());
+        auto for_client = socket.statistics_for_client();
+        obj.add("bytes_to_client", for_client.bytes);
+        obj.add("blocked_reads_client", for_client.blocked_reads);
+        obj.add("reader_wakeups_client", for_client.reader_wakeups);
+        obj.add("buffer_growths_client", for_client.buffer_growths);
+        obj.add("buffer_capacity_client", for_client.buffer_capacity);
+        auto for_server = socket.statistics_for_server();
+        obj.add("bytes_to_server", for_server.bytes);
+        obj.add("blocked_reads_server", for_server.blocked_reads);
+        obj.add("reader_wakeups_server", for_server.reader_wakeups);
+        obj.add("buffer_growths_server", for_server.buffer_growths);
+        obj.add("buffer_capacity_server", for_server.buffer_capacity);
     });
     array.finish();
     return builder.build();
@@ -594,16 +752,16 @@ static Optional<KBuffer> procfs$pid_vmobjects(InodeIdentifier identifier)
     if (!process)
         return {};
     KBufferBuilder builder;
-    builder.appendf("BEGIN       END         SIZE        NAME\n");
+    builder.append("BEGIN       END         SIZE        NAME\n");
     {
         ScopedSpinLock lock(process->get_lock());
         for (auto& region : process->regions()) {
-            builder.appendf("%x -- %x    %x    %s\n",
+            builder.appendff("{:x} -- {:x}    {:x}    {}\n",
                 region.vaddr().get(),
                 region.vaddr().offset(region.size() - 1).get(),
                 region.size(),
-                region.name().characters());
-            builder.appendf("VMO: %s @ %x(%u)\n",
+                region.name());
+            builder.appendff("VMO: {} @ {}({})\n",
                 region.vmobject().is_anonymous() ? "anonymous" : "file-backed",
                 &region.vmobject(),
                 region.vmobject().ref_count());
@@ -612,12 +770,12 @@ static Optional<KBuffer> procfs$pid_vmobjects(InodeIdentifier identifier)
                 bool should_cow = false;
                 if (i >= region.first_page_index() && i <= region.last_page_index())
                     should_cow = region.should_cow(i - region.first_page_index());
-                builder.appendf("P%x%s(%u) ",
+                builder.appendff("P{:x}{}({}) ",
                     physical_page ? physical_page->paddr().get() : 0,
                     should_cow ? "!" : "",
                     physical_page ? physical_page->ref_count() : 0);
             }
-            builder.appendf("\n");
+            builder.append('\n');
         }
     }
     return builder.build();
@@ -654,7 +812,7 @@ static Optional<KBuffer> procfs$tid_stack(InodeIdentifier identifier)
     if (!thread)
         return {};
     KBufferBuilder builder;
-    builder.appendf("Thread %d (%s):\n", thread->tid().value(), thread->name().characters());
+    builder.appendff("Thread {} ({}):\n", thread->tid().value(), thread->name());
     builder.append(thread->backtrace());
     return builder.build();
 }
@@ -699,16 +857,16 @@ Optional<KBuffer> procfs$mm(InodeIdentifier)
     u32 vmobject_count = 0;
     MemoryManager::for_each_vmobject([&](auto& vmobject) {
         ++vmobject_count;
-        builder.appendf("VMObject: %p %s(%u): p:%4u\n",
+        builder.appendff("VMObject: {} {}({}): p:{:4}\n",
             &vmobject,
             vmobject.is_anonymous() ? "anon" : "file",
             vmobject.ref_count(),
             vmobject.page_count());
         return IterationDecision::Continue;
     });
-    builder.appendf("VMO count: %u\n", vmobject_count);
-    builder.appendf("Free physical pages: %u\n", MM.user_physical_pages() - MM.user_physical_pages_used());
-    builder.appendf("Free supervisor physical pages: %u\n", MM.super_physical_pages() - MM.super_physical_pages_used());
+    builder.appendff("VMO count: {}\n", vmobject_count);
+    builder.appendff("Free physical pages: {}\n", MM.user_physical_pages() - MM.user_physical_pages_used());
+    builder.appendff("Free supervisor physical pages: {}\n", MM.super_physical_pages() - MM.super_physical_pages_used());
     return builder.build();
 }
 
@@ -727,11 +885,11 @@ static Optional<KBuffer> procfs$mounts(InodeIdentifier)
     KBufferBuilder builder;
     VFS::the().for_each_mount([&builder](auto& mount) {
         auto& fs = mount.guest_fs();
-        builder.appendf("%s @ ", fs.class_name());
+        builder.appendff("{} @ ", fs.class_name());
         if (mount.host() == nullptr)
-            builder.appendf("/");
+            builder.append('/');
         else {
-            builder.appendf("%u:%u", mount.host()->fsid(), mount.host()->index());
+            builder.appendff("{}:{}", mount.host()->fsid(), mount.host()->index());
             builder.append(' ');
             builder.append(mount.absolute_path());
         }
@@ -751,6 +909,7 @@ static Optional<KBuffer> procfs$df(InodeIdentifier)
         fs_object.add("class_name", fs.class_name());
         fs_object.add("total_block_count", fs.total_block_count());
         fs_object.add("free_block_count", fs.free_block_count());
+        fs_object.add("free_extent_count", fs.free_extent_count());
         fs_object.add("total_inode_count", fs.total_inode_count());
         fs_object.add("free_inode_count", fs.free_inode_count());
         fs_object.add("mount_point", mount.absolute_path());
@@ -762,11 +921,149 @@ static Optional<KBuffer> procfs$df(InodeIdentifier)
             fs_object.add("source", static_cast<const FileBackedFS&>(fs).file_description().absolute_path());
         else
             fs_object.add("source", "none");
+
+        if (fs.is_block_based()) {
+            auto cache_statistics = static_cast<const BlockBasedFS&>(fs).cache_statistics();
+            fs_object.add("cache_size", cache_statistics.entry_count);
+            fs_object.add("cache_hits", cache_statistics.hits);
+            fs_object.add("cache_misses", cache_statistics.misses);
+            fs_object.add("cache_evictions", cache_statistics.evictions);
+            fs_object.add("cache_read_aheads", cache_statistics.read_aheads);
+        }
+    });
+    array.finish();
+    return builder.build();
+}
+
+static Optional<KBuffer> procfs$locks(InodeIdentifier)
+{
+    struct Entry {
+        const char* name;
+        u32 acquisitions;
+        u32 contentions;
+    };
+    // Locks are keyed by the address of their name, so the same name may show up more than once.
+    Vector<Entry> entries;
+    Lock::for_each_statistics([&](const LockStatistics& statistics) {
+        u32 acquisitions = Lock::acquisitions_for(statistics);
+        u32 contentions = statistics.contentions.load(AK::memory_order_relaxed);
+        for (auto& entry : entries) {
+            if (!strcmp(entry.name, statistics.name)) {
+                entry.acquisitions += acquisitions;
+                entry.contentions += contentions;
+                return;
+            }
+        }
+        entries.append({ statistics.name, acquisitions, contentions });
+    });
+
+    KBufferBuilder builder;
+    JsonArraySerializer array { builder };
+    for (auto& entry : entries) {
+        auto obj = array.add_object();
+        obj.add("name", entry.name);
+        obj.add("acquisitions", entry.acquisitions);
+        obj.add("contentions", entry.contentions);
+    }
+    array.finish();
+    return builder.build();
+}
+
+// Only has anything in it when the kernel is built with LOCK_STATISTICS.
+static Optional<KBuffer> procfs$lockstat(InodeIdentifier)
+{
+    KBufferBuilder builder;
+    JsonArraySerializer array { builder };
+#ifdef LOCK_STATISTICS
+    struct Entry {
+        const LockContention::Site* site;
+        u32 acquisitions;
+        u32 contentions;
+        u64 total_wait_cycles;
+        u64 max_hold_cycles;
+    };
+    Vector<Entry> entries;
+    LockContention::for_each_site([&](const LockContention::Site& site) {
+        Entry entry { &site, site.acquisitions.load(AK::memory_order_relaxed), site.contentions.load(AK::memory_order_relaxed), 0, 0 };
+        LockContention::read_cycles(site, entry.total_wait_cycles, entry.max_hold_cycles);
+        entries.append(entry);
+    });
+    // The most contended sites come first.
+    quick_sort(entries, [](auto& a, auto& b) {
+        return a.total_wait_cycles > b.total_wait_cycles;
     });
+    for (auto& entry : entries) {
+        auto obj = array.add_object();
+        obj.add("kind", entry.site->kind);
+        obj.add("site", AK::format("{}:{}", entry.site->file, entry.site->line));
+        obj.add("acquisitions", entry.acquisitions);
+        obj.add("contentions", entry.contentions);
+        obj.add("total_wait_cycles", entry.total_wait_cycles);
+        obj.add("max_hold_cycles", entry.max_hold_cycles);
+    }
+#endif
+    array.finish();
+    return builder.build();
+}
+
+static Optional<KBuffer> procfs$runqueues(InodeIdentifier)
+{
+    KBufferBuilder builder;
+    JsonArraySerializer array { builder };
+    Processor::for_each(
+        [&](Processor& proc) -> IterationDecision {
+            if (proc.id() >= SchedulerData::max_processors)
+                return IterationDecision::Break;
+            auto& queue = g_scheduler_data->m_ready_queues[proc.id()];
+            u32 thread_count;
+            u32 migrations;
+            {
+                ScopedSpinLock lock(queue.m_lock);
+                thread_count = queue.m_thread_count;
+                migrations = queue.m_migrations;
+            }
+            auto obj = array.add_object();
+            obj.add("processor", proc.id());
+            obj.add("runnable", thread_count);
+            obj.add("migrations", migrations);
+            obj.add("active", queue.m_is_active);
+            return IterationDecision::Continue;
+        });
+    array.finish();
+    return builder.build();
+}
+
+static Optional<KBuffer> procfs$ipis(InodeIdentifier)
+{
+    static const char* cause_names[] = { "tlb_shootdown", "callback", "callback_with_data" };
+    static_assert(sizeof(cause_names) / sizeof(cause_names[0]) == ProcessorMessage::__Count);
+
+    KBufferBuilder builder;
+    JsonArraySerializer array { builder };
+    for (u32 type = 0; type < ProcessorMessage::__Count; ++type) {
+        auto obj = array.add_object();
+        obj.add("cause", cause_names[type]);
+        obj.add("count", Processor::smp_ipi_count((ProcessorMessage::Type)type));
+    }
     array.finish();
     return builder.build();
 }
 
+static Optional<KBuffer> procfs$memory_pressure(InodeIdentifier)
+{
+    KBufferBuilder builder;
+    JsonObjectSerializer<KBufferBuilder> json { builder };
+    json.add("level", MemoryManager::to_string(MM.memory_pressure()));
+    json.add("sequence", MM.memory_pressure_sequence());
+    json.add("free_pages", MM.free_user_physical_pages());
+    json.add("critical_watermark", MM.critical_watermark());
+    json.add("low_watermark", MM.low_watermark());
+    json.add("high_watermark", MM.high_watermark());
+    json.add("pages_reclaimed", MM.pages_reclaimed());
+    json.finish();
+    return builder.build();
+}
+
 static Optional<KBuffer> procfs$cpuinfo(InodeIdentifier)
 {
     KBufferBuilder builder;
@@ -804,12 +1101,45 @@ Optional<KBuffer> procfs$memstat(InodeIdentifier)
     json.add("user_physical_available", MM.user_physical_pages() - MM.user_physical_pages_used());
     json.add("super_physical_allocated", MM.super_physical_pages_used());
     json.add("super_physical_available", MM.super_physical_pages() - MM.super_physical_pages_used());
-    json.add("kmalloc_call_count", g_kmalloc_call_count);
-    json.add("kfree_call_count", g_kfree_call_count);
-    slab_alloc_stats([&json](size_t slab_size, size_t num_allocated, size_t num_free) {
-        auto prefix = String::format("slab_%zu", slab_size);
-        json.add(String::format("%s_num_allocated", prefix.characters()), num_allocated);
-        json.add(String::format("%s_num_free", prefix.characters()), num_free);
+    json.add("user_physical_zeroed", MM.zeroed_user_physical_pages());
+    json.add("large_page_mappings", MM.large_page_mappings());
+    json.add("large_page_demotions", MM.large_page_demotions());
+    size_t active_file_pages = 0;
+    size_t inactive_file_pages = 0;
+    MemoryManager::for_each_vmobject_of_type<InodeVMObject>([&](auto& vmobject) {
+        active_file_pages += vmobject.active_page_count();
+        inactive_file_pages += vmobject.inactive_page_count();
+        return IterationDecision::Continue;
+    });
+    json.add("active_file_pages", active_file_pages);
+    json.add("inactive_file_pages", inactive_file_pages);
+    auto& zero_fault_statistics = MM.zero_fault_statistics();
+    json.add("zero_faults_shared_zero_page", zero_fault_statistics.shared_zero_page_reads.load());
+    json.add("zero_faults_zeroed_pool", zero_fault_statistics.zeroed_pool_hits.load());
+    json.add("zero_faults_inline_zero_fill", zero_fault_statistics.inline_zero_fills.load());
+    size_t kmalloc_call_count = g_kmalloc_call_count;
+    size_t kfree_call_count = g_kfree_call_count;
+    size_t kmalloc_cached = 0;
+    Processor::for_each(
+        [&](Processor& proc) -> IterationDecision {
+            KmallocCacheStatistics statistics;
+            if (!kmalloc_cache_statistics(proc.id(), statistics))
+                return IterationDecision::Break;
+            json.add(AK::format("kmalloc_cpu{}_cache_hits", proc.id()), statistics.hits);
+            json.add(AK::format("kmalloc_cpu{}_cache_misses", proc.id()), statistics.misses);
+            kmalloc_call_count += statistics.hits;
+            kfree_call_count += statistics.frees;
+            kmalloc_cached += statistics.cached_bytes;
+            return IterationDecision::Continue;
+        });
+    json.add("kmalloc_cached", kmalloc_cached);
+    json.add("kmalloc_call_count", kmalloc_call_count);
+    json.add("kfree_call_count", kfree_call_count);
+    slab_alloc_stats([&json](auto& statistics) {
+        json.add(AK::format("slab_{}_slab_size", statistics.name), statistics.slab_size);
+        json.add(AK::format("slab_{}_num_allocated", statistics.name), statistics.num_allocated);
+        json.add(AK::format("slab_{}_num_free", statistics.name), statistics.num_free);
+        json.add(AK::format("slab_{}_num_blocks", statistics.name), statistics.num_blocks);
     });
     json.finish();
     return builder.build();
@@ -820,7 +1150,7 @@ static Optional<KBuffer> procfs$all(InodeIdentifier)
     KBufferBuilder builder;
     JsonArraySerializer array { builder };
 
-    // Keep this in sync with CProcessStatistics.
+    // Keep this in sync with CProcessStatistics, and with procfs$all_binary.
     auto build_process = [&](const Process& process) {
         auto process_object = array.add_object();
 
@@ -861,6 +1191,7 @@ static Optional<KBuffer> procfs$all(InodeIdentifier)
         process_object.add("amount_dirty_private", process.amount_dirty_private());
         process_object.add("amount_clean_inode", process.amount_clean_inode());
         process_object.add("amount_shared", process.amount_shared());
+        process_object.add("amount_private", process.amount_private());
         process_object.add("amount_purgeable_volatile", process.amount_purgeable_volatile());
         process_object.add("amount_purgeable_nonvolatile", process.amount_purgeable_nonvolatile());
         process_object.add("icon_id", process.icon_id());
@@ -873,6 +1204,7 @@ static Optional<KBuffer> procfs$all(InodeIdentifier)
             thread_object.add("ticks", thread.ticks());
             thread_object.add("state", thread.state_string());
             thread_object.add("cpu", thread.cpu());
+            thread_object.add("times_migrated", thread.times_migrated());
             thread_object.add("priority", thread.priority());
             thread_object.add("effective_priority", thread.effective_priority());
             thread_object.add("syscall_count", thread.syscall_count());
@@ -885,15 +1217,147 @@ static Optional<KBuffer> procfs$all(InodeIdentifier)
             thread_object.add("unix_socket_write_bytes", thread.unix_socket_write_bytes());
             thread_object.add("ipv4_socket_read_bytes", thread.ipv4_socket_read_bytes());
             thread_object.add("ipv4_socket_write_bytes", thread.ipv4_socket_write_bytes());
+            auto scheduler_statistics = thread.scheduler_statistics();
+            thread_object.add("runnable_cycles", scheduler_statistics.runnable_cycles);
+            thread_object.add("blocked_cycles", scheduler_statistics.total_blocked_cycles());
+            thread_object.add("queued_cycles", scheduler_statistics.queued_cycles);
+            thread_object.add("involuntary_switches", scheduler_statistics.involuntary_switches);
+            return IterationDecision::Continue;
+        });
+    };
+
+    ScopedSpinLock lock(g_scheduler_lock);
+    auto processes = Process::all_processes();
+    build_process(*Scheduler::colonel());
+    for (auto& process : processes)
+        build_process(process);
+    array.finish();
+    return builder.build();
+}
+
+static void copy_to_record_field(char* field, size_t field_size, const StringView& string)
+{
+    size_t length = min(string.length(), field_size - 1);
+    memcpy(field, string.characters_without_null_termination(), length);
+    memset(field + length, 0, field_size - length);
+}
+
+// The same as /proc/all, but without any formatting, so pollers like top can afford to read it often.
+static Optional<KBuffer> procfs$all_binary(InodeIdentifier)
+{
+    KBufferBuilder builder;
+
+    auto count_threads = [](const Process& process) {
+        u32 count = 0;
+        process.for_each_thread([&](const Thread&) {
+            ++count;
+            return IterationDecision::Continue;
+        });
+        return count;
+    };
+
+    auto build_process = [&](const Process& process) {
+        ProcessStatisticsRecord record;
+        memset(&record, 0, sizeof(record));
+        record.pid = process.pid().value();
+        record.pgid = process.tty() ? process.tty()->pgid().value() : 0;
+        record.pgp = process.pgid().value();
+        record.sid = process.sid().value();
+        record.uid = process.uid();
+        record.gid = process.gid();
+        record.ppid = process.ppid().value();
+        record.nfds = process.number_of_open_file_descriptors();
+        record.icon_id = process.icon_id();
+#define __ENUMERATE_PLEDGE_PROMISE(promise)    \
+    if (process.has_promised(Pledge::promise)) \
+        record.pledge |= 1u << (u32)Pledge::promise;
+        ENUMERATE_PLEDGE_PROMISES
+#undef __ENUMERATE_PLEDGE_PROMISE
+        record.amount_virtual = process.amount_virtual();
+        record.amount_resident = process.amount_resident();
+        record.amount_shared = process.amount_shared();
+        record.amount_private = process.amount_private();
+        record.amount_dirty_private = process.amount_dirty_private();
+        record.amount_clean_inode = process.amount_clean_inode();
+        record.amount_purgeable_volatile = process.amount_purgeable_volatile();
+        record.amount_purgeable_nonvolatile = process.amount_purgeable_nonvolatile();
+        record.thread_count = count_threads(process);
+        switch (process.veil_state()) {
+        case VeilState::None:
+            record.veil = ProcessStatisticsVeilNone;
+            break;
+        case VeilState::Dropped:
+            record.veil = ProcessStatisticsVeilDropped;
+            break;
+        case VeilState::Locked:
+            record.veil = ProcessStatisticsVeilLocked;
+            break;
+        }
+        copy_to_record_field(record.name, sizeof(record.name), process.name());
+        copy_to_record_field(record.tty, sizeof(record.tty), process.tty() ? process.tty()->tty_name() : "notty");
+        builder.append((const char*)&record, sizeof(record));
+
+        process.for_each_thread([&](const Thread& thread) {
+            ThreadStatisticsRecord thread_record;
+            memset(&thread_record, 0, sizeof(thread_record));
+            thread_record.tid = thread.tid().value();
+            thread_record.times_scheduled = thread.times_scheduled();
+            thread_record.ticks = thread.ticks();
+            thread_record.cpu = thread.cpu();
+            thread_record.times_migrated = thread.times_migrated();
+            thread_record.priority = thread.priority();
+            thread_record.effective_priority = thread.effective_priority();
+            thread_record.syscall_count = thread.syscall_count();
+            thread_record.inode_faults = thread.inode_faults();
+            thread_record.zero_faults = thread.zero_faults();
+            thread_record.cow_faults = thread.cow_faults();
+            thread_record.file_read_bytes = thread.file_read_bytes();
+            thread_record.file_write_bytes = thread.file_write_bytes();
+            thread_record.unix_socket_read_bytes = thread.unix_socket_read_bytes();
+            thread_record.unix_socket_write_bytes = thread.unix_socket_write_bytes();
+            thread_record.ipv4_socket_read_bytes = thread.ipv4_socket_read_bytes();
+            thread_record.ipv4_socket_write_bytes = thread.ipv4_socket_write_bytes();
+            auto scheduler_statistics = thread.scheduler_statistics();
+            thread_record.runnable_cycles = scheduler_statistics.runnable_cycles;
+            thread_record.blocked_cycles = scheduler_statistics.total_blocked_cycles();
+            thread_record.queued_cycles = scheduler_statistics.queued_cycles;
+            thread_record.involuntary_switches = scheduler_statistics.involuntary_switches;
+            copy_to_record_field(thread_record.state, sizeof(thread_record.state), thread.state_string());
+            copy_to_record_field(thread_record.name, sizeof(thread_record.name), thread.name());
+            builder.append((const char*)&thread_record, sizeof(thread_record));
             return IterationDecision::Continue;
         });
     };
 
     ScopedSpinLock lock(g_scheduler_lock);
     auto processes = Process::all_processes();
+
+    // The thread counts can't change while we hold the scheduler lock, so the header can go first.
+    ProcessStatisticsHeader header;
+    header.magic = PROCESS_STATISTICS_MAGIC;
+    header.version = PROCESS_STATISTICS_VERSION;
+    header.header_size = sizeof(ProcessStatisticsHeader);
+    header.process_record_size = sizeof(ProcessStatisticsRecord);
+    header.thread_record_size = sizeof(ThreadStatisticsRecord);
+    header.process_count = 1 + processes.size();
+    header.thread_count = count_threads(*Scheduler::colonel());
+    for (auto& process : processes)
+        header.thread_count += count_threads(process);
+    builder.append((const char*)&header, sizeof(header));
+
     build_process(*Scheduler::colonel());
     for (auto& process : processes)
         build_process(process);
+    return builder.build();
+}
+
+static Optional<KBuffer> procfs$syscalls(InodeIdentifier)
+{
+    KBufferBuilder builder;
+    JsonArraySerializer array { builder };
+    SyscallStatistics::for_each_system_wide([&](u32 function, auto& latency) {
+        serialize_syscall_latency(array, function, latency);
+    });
     array.finish();
     return builder.build();
 }
@@ -903,7 +1367,7 @@ static Optional<KBuffer> procfs$inodes(InodeIdentifier)
     KBufferBuilder builder;
     InterruptDisabler disabler;
     for (auto& inode : Inode::all_with_lock()) {
-        builder.appendf("Inode{K%x} %02u:%08u (%u)\n", &inode, inode.fsid(), inode.index(), inode.ref_count());
+        builder.appendff("Inode{{K{}}} {:02}:{:08} ({})\n", &inode, inode.fsid(), inode.index(), inode.ref_count());
     }
     return builder.build();
 }
@@ -1149,6 +1613,9 @@ InodeMetadata ProcFSInode::metadata() const
     case FI_PID_stacks:
         metadata.mode = S_IFDIR | S_IRUSR | S_IXUSR;
         break;
+    case FI_Root_irq_affinity:
+        metadata.mode = S_IFREG | S_IRUSR | S_IWUSR;
+        break;
     default:
         metadata.mode = S_IFREG | S_IRUSR | S_IRGRP | S_IROTH;
         break;
@@ -1168,6 +1635,14 @@ InodeMetadata ProcFSInode::metadata() const
     return metadata;
 }
 
+bool ProcFSInode::can_read(const FileDescription& description) const
+{
+    // /proc/memory_pressure only becomes readable when the memory pressure level has changed since it was last read.
+    if (to_proc_file_type(identifier()) == FI_Root_memory_pressure)
+        return description.seen_event_sequence() != MM.memory_pressure_sequence();
+    return true;
+}
+
 ssize_t ProcFSInode::read_bytes(off_t offset, ssize_t count, u8* buffer, FileDescription* description) const
 {
 #ifdef PROCFS_DEBUG
@@ -1215,8 +1690,12 @@ ssize_t ProcFSInode::read_bytes(off_t offset, ssize_t count, u8* buffer, FileDes
     if (!description) {
         generated_data = (*read_callback)(identifier());
     } else {
-        if (!description->generator_cache().has_value())
+        if (!description->generator_cache().has_value()) {
+            // Note the sequence before generating, so a change that races with us makes the file readable again.
+            if (to_proc_file_type(identifier()) == FI_Root_memory_pressure)
+                description->set_seen_event_sequence(MM.memory_pressure_sequence());
             description->generator_cache() = (*read_callback)(identifier());
+        }
         generated_data = description->generator_cache();
     }
 
@@ -1653,19 +2132,28 @@ ProcFS::ProcFS()
     m_entries[FI_Root_mounts] = { "mounts", FI_Root_mounts, false, procfs$mounts };
     m_entries[FI_Root_df] = { "df", FI_Root_df, false, procfs$df };
     m_entries[FI_Root_all] = { "all", FI_Root_all, false, procfs$all };
+    m_entries[FI_Root_all_binary] = { "all_binary", FI_Root_all_binary, false, procfs$all_binary };
     m_entries[FI_Root_memstat] = { "memstat", FI_Root_memstat, false, procfs$memstat };
     m_entries[FI_Root_cpuinfo] = { "cpuinfo", FI_Root_cpuinfo, false, procfs$cpuinfo };
     m_entries[FI_Root_inodes] = { "inodes", FI_Root_inodes, true, procfs$inodes };
     m_entries[FI_Root_dmesg] = { "dmesg", FI_Root_dmesg, true, procfs$dmesg };
+    m_entries[FI_Root_locks] = { "locks", FI_Root_locks, true, procfs$locks };
+    m_entries[FI_Root_lockstat] = { "lockstat", FI_Root_lockstat, true, procfs$lockstat };
+    m_entries[FI_Root_runqueues] = { "runqueues", FI_Root_runqueues, false, procfs$runqueues };
+    m_entries[FI_Root_ipis] = { "ipis", FI_Root_ipis, false, procfs$ipis };
+    m_entries[FI_Root_memory_pressure] = { "memory_pressure", FI_Root_memory_pressure, false, procfs$memory_pressure };
     m_entries[FI_Root_self] = { "self", FI_Root_self, false, procfs$self };
     m_entries[FI_Root_pci] = { "pci", FI_Root_pci, false, procfs$pci };
     m_entries[FI_Root_interrupts] = { "interrupts", FI_Root_interrupts, false, procfs$interrupts };
+    m_entries[FI_Root_irq_affinity] = { "irq_affinity", FI_Root_irq_affinity, true, procfs$irq_affinity, write_irq_affinity };
     m_entries[FI_Root_keymap] = { "keymap", FI_Root_keymap, false, procfs$keymap };
     m_entries[FI_Root_devices] = { "devices", FI_Root_devices, false, procfs$devices };
     m_entries[FI_Root_uptime] = { "uptime", FI_Root_uptime, false, procfs$uptime };
     m_entries[FI_Root_cmdline] = { "cmdline", FI_Root_cmdline, true, procfs$cmdline };
     m_entries[FI_Root_modules] = { "modules", FI_Root_modules, true, procfs$modules };
     m_entries[FI_Root_profile] = { "profile", FI_Root_profile, false, procfs$profile };
+    m_entries[FI_Root_profile_stream] = { "profile_stream", FI_Root_profile_stream, false, procfs$profile_stream };
+    m_entries[FI_Root_syscalls] = { "syscalls", FI_Root_syscalls, false, procfs$syscalls };
     m_entries[FI_Root_sys] = { "sys", FI_Root_sys, true };
     m_entries[FI_Root_net] = { "net", FI_Root_net, false };
 
@@ -1682,6 +2170,8 @@ ProcFS::ProcFS()
     m_entries[FI_PID_exe] = { "exe", FI_PID_exe, false, procfs$pid_exe };
     m_entries[FI_PID_cwd] = { "cwd", FI_PID_cwd, false, procfs$pid_cwd };
     m_entries[FI_PID_unveil] = { "unveil", FI_PID_unveil, false, procfs$pid_unveil };
+    m_entries[FI_PID_syscalls] = { "syscalls", FI_PID_syscalls, false, procfs$pid_syscalls };
+    m_entries[FI_PID_schedstat] = { "schedstat", FI_PID_schedstat, false, procfs$pid_schedstat };
     m_entries[FI_PID_root] = { "root", FI_PID_root, false, procfs$pid_root };
     m_entries[FI_PID_fd] = { "fd", FI_PID_fd, false };
 }
@@ -27,6 +27,7 @@
 #include <Kernel/FileSystem/TmpFS.h>
 #include <Kernel/Process.h>
 #include <Kernel/Thread.h>
+#include <Kernel/VM/MemoryManager.h>
 
 namespace Kernel {
 
@@ -131,14 +132,19 @@ KResult TmpFSInode::traverse_as_directory(Function<bool(const FS::DirectoryEntry
     if (!is_directory())
         return KResult(-ENOTDIR);
 
-    callback({ ".", identifier(), 0 });
-    callback({ "..", m_parent, 0 });
+    callback({ ".", identifier(), DT_DIR });
+    callback({ "..", m_parent, DT_DIR });
 
     for (auto& it : m_children)
         callback(it.value.entry);
     return KSuccess;
 }
 
+static size_t page_count_for_size(size_t size)
+{
+    return PAGE_ROUND_UP(size) / PAGE_SIZE;
+}
+
 ssize_t TmpFSInode::read_bytes(off_t offset, ssize_t size, u8* buffer, FileDescription*) const
 {
     LOCKER(m_lock, Lock::Mode::Shared);
@@ -146,17 +152,38 @@ ssize_t TmpFSInode::read_bytes(off_t offset, ssize_t size, u8* buffer, FileDescr
     ASSERT(size >= 0);
     ASSERT(offset >= 0);
 
-    if (!m_content.has_value())
-        return 0;
-
     if (offset >= m_metadata.size)
         return 0;
 
     if (static_cast<off_t>(size) > m_metadata.size - offset)
         size = m_metadata.size - offset;
 
-    memcpy(buffer, m_content.value().data() + offset, size);
-    return size;
+    ssize_t nread = 0;
+    while (nread < size) {
+        size_t page_index = offset / PAGE_SIZE;
+        size_t offset_in_page = offset % PAGE_SIZE;
+        size_t bytes_to_copy = min(static_cast<size_t>(size - nread), PAGE_SIZE - offset_in_page);
+
+        auto page = m_pages[page_index];
+        if (!page) {
+            // Nothing was ever written to this page, so it reads as zeroes.
+            memset(buffer + nread, 0, bytes_to_copy);
+        } else {
+            // The quickmap slot can't be held across a fault on the destination buffer, so bounce through the stack.
+            u8 page_buffer[PAGE_SIZE];
+            {
+                InterruptDisabler disabler;
+                u8* page_ptr = MM.quickmap_page(*page);
+                memcpy(page_buffer, page_ptr + offset_in_page, bytes_to_copy);
+                MM.unquickmap_page();
+            }
+            memcpy(buffer + nread, page_buffer, bytes_to_copy);
+        }
+
+        offset += bytes_to_copy;
+        nread += bytes_to_copy;
+    }
+    return nread;
 }
 
 ssize_t TmpFSInode::write_bytes(off_t offset, ssize_t size, const u8* buffer, FileDescription*)
@@ -170,37 +197,86 @@ ssize_t TmpFSInode::write_bytes(off_t offset, ssize_t size, const u8* buffer, Fi
         return result;
 
     off_t old_size = m_metadata.size;
-    off_t new_size = m_metadata.size;
-    if ((offset + size) > new_size)
-        new_size = offset + size;
+    if (offset + size > old_size) {
+        auto needed_page_count = page_count_for_size(offset + size);
+        // Grow the page list geometrically, so that appending doesn't copy it on every write.
+        if (needed_page_count > m_pages.capacity())
+            m_pages.ensure_capacity(max(needed_page_count, m_pages.capacity() * 2));
+        m_pages.resize(needed_page_count);
+        if (offset > old_size)
+            zero_past_end_of_file(old_size);
+    }
 
-    if (new_size > old_size) {
-        if (m_content.has_value() && m_content.value().capacity() >= (size_t)new_size) {
-            m_content.value().set_size(new_size);
-        } else {
-            // Grow the content buffer 2x the new sizeto accomodate repeating write() calls.
-            // Note that we're not actually committing physical memory to the buffer
-            // until it's needed. We only grow VM here.
-
-            // FIXME: Fix this so that no memcpy() is necessary, and we can just grow the
-            //        KBuffer and it will add physical pages as needed while keeping the
-            //        existing ones.
-            auto tmp = KBuffer::create_with_size(new_size * 2);
-            tmp.set_size(new_size);
-            if (m_content.has_value())
-                memcpy(tmp.data(), m_content.value().data(), old_size);
-            m_content = move(tmp);
+    ssize_t nwritten = 0;
+    while (nwritten < size) {
+        size_t page_index = (offset + nwritten) / PAGE_SIZE;
+        size_t offset_in_page = (offset + nwritten) % PAGE_SIZE;
+        size_t bytes_to_copy = min(static_cast<size_t>(size - nwritten), PAGE_SIZE - offset_in_page);
+
+        auto& page = m_pages[page_index];
+        if (!page) {
+            page = MM.allocate_user_physical_page(MemoryManager::ShouldZeroFill::Yes);
+            if (!page)
+                break;
+        }
+
+        // The source buffer may fault, so don't touch it while the quickmap slot is held.
+        u8 page_buffer[PAGE_SIZE];
+        memcpy(page_buffer, buffer + nwritten, bytes_to_copy);
+        {
+            InterruptDisabler disabler;
+            u8* page_ptr = MM.quickmap_page(*page);
+            memcpy(page_ptr + offset_in_page, page_buffer, bytes_to_copy);
+            MM.unquickmap_page();
         }
+
+        nwritten += bytes_to_copy;
+    }
+
+    off_t new_size = max(old_size, offset + nwritten);
+    // Drop the slots we made room for but couldn't fill.
+    m_pages.resize(page_count_for_size(new_size), true);
+
+    if (new_size > old_size) {
         m_metadata.size = new_size;
         set_metadata_dirty(true);
         set_metadata_dirty(false);
         inode_size_changed(old_size, new_size);
     }
 
-    memcpy(m_content.value().data() + offset, buffer, size);
-    inode_contents_changed(offset, size, buffer);
+    // Shared mappings use our pages directly, so they already see the new data.
 
-    return size;
+    if (!nwritten && size)
+        return -ENOSPC;
+    return nwritten;
+}
+
+void TmpFSInode::zero_past_end_of_file(size_t size)
+{
+    // Shared mappings can write into the last page past the end of the file.
+    // Clear that before the file grows over it, so those bytes don't become part of it.
+    size_t offset_in_page = size % PAGE_SIZE;
+    if (!offset_in_page || !m_pages[size / PAGE_SIZE])
+        return;
+    InterruptDisabler disabler;
+    u8* page_ptr = MM.quickmap_page(*m_pages[size / PAGE_SIZE]);
+    memset(page_ptr + offset_in_page, 0, PAGE_SIZE - offset_in_page);
+    MM.unquickmap_page();
+}
+
+RefPtr<PhysicalPage> TmpFSInode::backing_page(size_t page_index)
+{
+    LOCKER(m_lock);
+    ASSERT(is_backed_by_physical_pages());
+
+    // Only a racing truncate() gets us here, and there's nothing of the file to share.
+    if (page_index >= m_pages.size())
+        return MM.allocate_user_physical_page(MemoryManager::ShouldZeroFill::Yes);
+
+    auto& page = m_pages[page_index];
+    if (!page)
+        page = MM.allocate_user_physical_page(MemoryManager::ShouldZeroFill::Yes);
+    return page;
 }
 
 RefPtr<Inode> TmpFSInode::lookup(StringView name)
@@ -287,14 +363,14 @@ KResultOr<NonnullRefPtr<Inode>> TmpFSInode::create_child(const String& name, mod
     return child;
 }
 
-KResult TmpFSInode::add_child(Inode& child, const StringView& name, mode_t)
+KResult TmpFSInode::add_child(Inode& child, const StringView& name, mode_t mode)
 {
     LOCKER(m_lock);
     ASSERT(is_directory());
     ASSERT(child.fsid() == fsid());
 
     String owned_name = name;
-    FS::DirectoryEntry entry = { owned_name.characters(), owned_name.length(), child.identifier(), 0 };
+    FS::DirectoryEntry entry = { owned_name.characters(), owned_name.length(), child.identifier(), to_directory_entry_type(mode) };
 
     m_children.set(owned_name, { entry, static_cast<TmpFSInode&>(child) });
     did_add_child(name);
@@ -322,30 +398,17 @@ KResult TmpFSInode::truncate(u64 size)
     LOCKER(m_lock);
     ASSERT(!is_directory());
 
-    if (size == 0)
-        m_content.clear();
-    else if (!m_content.has_value()) {
-        m_content = KBuffer::create_with_size(size);
-    } else if (static_cast<size_t>(size) < m_content.value().capacity()) {
-        size_t prev_size = m_metadata.size;
-        m_content.value().set_size(size);
-        if (prev_size < static_cast<size_t>(size))
-            memset(m_content.value().data() + prev_size, 0, size - prev_size);
-    } else {
-        size_t prev_size = m_metadata.size;
-        KBuffer tmp = KBuffer::create_with_size(size);
-        memcpy(tmp.data(), m_content.value().data(), prev_size);
-        m_content = move(tmp);
-    }
-
     size_t old_size = m_metadata.size;
+    if (size > old_size)
+        zero_past_end_of_file(old_size);
+    m_pages.resize(page_count_for_size(size));
+
     m_metadata.size = size;
     notify_watchers();
 
     if (old_size != (size_t)size) {
         inode_size_changed(old_size, size);
-        if (m_content.has_value())
-            inode_contents_changed(0, size, m_content.value().data());
+        inode_contents_changed(0, size, nullptr);
     }
 
     return KSuccess;
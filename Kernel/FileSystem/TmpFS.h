@@ -27,10 +27,10 @@
 #pragma once
 
 #include <AK/HashMap.h>
-#include <AK/Optional.h>
+#include <AK/Vector.h>
 #include <Kernel/FileSystem/FileSystem.h>
 #include <Kernel/FileSystem/Inode.h>
-#include <Kernel/KBuffer.h>
+#include <Kernel/VM/PhysicalPage.h>
 
 namespace Kernel {
 
@@ -47,9 +47,13 @@ public:
     virtual const char* class_name() const override { return "TmpFS"; }
 
     virtual bool supports_watchers() const override { return true; }
+    virtual bool supports_lookup_cache() const override { return true; }
 
     virtual NonnullRefPtr<Inode> root_inode() const override;
 
+    // TmpFS puts DT_* values into its directory entries directly.
+    virtual u8 internal_file_type_to_directory_entry_type(const DirectoryEntry& entry) const override { return entry.file_type; }
+
 private:
     TmpFS();
 
@@ -91,6 +95,8 @@ public:
     virtual int set_ctime(time_t) override;
     virtual int set_mtime(time_t) override;
     virtual void one_ref_left() override;
+    virtual bool is_backed_by_physical_pages() const override { return m_metadata.is_regular_file(); }
+    virtual RefPtr<PhysicalPage> backing_page(size_t page_index) override;
 
 private:
     TmpFSInode(TmpFS& fs, InodeMetadata metadata, InodeIdentifier parent);
@@ -98,11 +104,13 @@ private:
     static NonnullRefPtr<TmpFSInode> create_root(TmpFS&);
 
     void notify_watchers();
+    void zero_past_end_of_file(size_t size);
 
     InodeMetadata m_metadata;
     InodeIdentifier m_parent;
 
-    Optional<KBuffer> m_content;
+    // File contents, one page at a time. Pages that were never written to are left null.
+    Vector<RefPtr<PhysicalPage>> m_pages;
     struct Child {
         FS::DirectoryEntry entry;
         NonnullRefPtr<TmpFSInode> inode;
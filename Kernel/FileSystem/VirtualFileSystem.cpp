@@ -43,6 +43,7 @@ namespace Kernel {
 static VFS* s_the;
 static constexpr int symlink_recursion_limit { 5 }; // FIXME: increase?
 static constexpr int root_mount_flags = MS_NODEV | MS_NOSUID | MS_RDONLY;
+static constexpr size_t lookup_cache_capacity { 1024 };
 
 VFS& VFS::the()
 {
@@ -113,6 +114,8 @@ KResult VFS::unmount(Inode& guest_inode)
     for (size_t i = 0; i < m_mounts.size(); ++i) {
         auto& mount = m_mounts.at(i);
         if (&mount.guest() == &guest_inode) {
+            // Cached lookups keep inodes alive, which would keep the filesystem busy.
+            purge_lookup_cache(mount.guest_fs().fsid());
             auto result = mount.guest_fs().prepare_to_unmount();
             if (result.is_error()) {
                 dbg() << "VFS: Failed to unmount!";
@@ -208,8 +211,7 @@ KResult VFS::traverse_directory_inode(Inode& dir_inode, Function<bool(const FS::
             ASSERT(mount->host());
             resolved_inode = mount->host()->identifier();
         }
-        callback(FS::DirectoryEntry(entry.name, entry.name_length, resolved_inode, entry.file_type));
-        return true;
+        return callback(FS::DirectoryEntry(entry.name, entry.name_length, resolved_inode, entry.file_type));
     });
 }
 
@@ -890,6 +892,67 @@ KResultOr<NonnullRefPtr<Custody>> VFS::resolve_path(StringView path, Custody& ba
     return custody;
 }
 
+RefPtr<Inode> VFS::lookup_child(Inode& directory, const StringView& name)
+{
+    if (!directory.fs().supports_lookup_cache())
+        return directory.lookup(name);
+
+    auto directory_id = directory.identifier();
+    auto hash = LookupCacheKeyTraits::hash_of(directory_id, name);
+    u32 generation;
+    {
+        LOCKER(m_lookup_cache_lock);
+        auto it = m_lookup_cache.find(hash, [&](auto& entry) { return entry.key.directory == directory_id && entry.key.name == name; });
+        if (it != m_lookup_cache.end())
+            return (*it).value;
+        generation = m_lookup_cache_generation;
+    }
+
+    auto child = directory.lookup(name);
+
+    RefPtr<Inode> evicted_child;
+    LOCKER(m_lookup_cache_lock);
+    // If the directory changed while we were looking, our answer may already be stale.
+    if (generation != m_lookup_cache_generation)
+        return child;
+    if (m_lookup_cache.size() >= lookup_cache_capacity) {
+        auto it = m_lookup_cache.begin();
+        evicted_child = move((*it).value);
+        m_lookup_cache.remove(it);
+    }
+    m_lookup_cache.set({ directory_id, name }, child);
+    return child;
+}
+
+void VFS::did_change_directory_entry(Badge<Inode>, const Inode& directory, const StringView& name)
+{
+    RefPtr<Inode> removed_child;
+    LOCKER(m_lookup_cache_lock);
+    ++m_lookup_cache_generation;
+    auto directory_id = directory.identifier();
+    auto it = m_lookup_cache.find(LookupCacheKeyTraits::hash_of(directory_id, name), [&](auto& entry) { return entry.key.directory == directory_id && entry.key.name == name; });
+    if (it == m_lookup_cache.end())
+        return;
+    removed_child = move((*it).value);
+    m_lookup_cache.remove(it);
+}
+
+void VFS::purge_lookup_cache(u32 fsid)
+{
+    Vector<RefPtr<Inode>> removed_children;
+    LOCKER(m_lookup_cache_lock);
+    ++m_lookup_cache_generation;
+    Vector<LookupCacheKey> keys_to_remove;
+    for (auto& it : m_lookup_cache) {
+        if (it.key.directory.fsid() != fsid)
+            continue;
+        keys_to_remove.append(it.key);
+        removed_children.append(move(it.value));
+    }
+    for (auto& key : keys_to_remove)
+        m_lookup_cache.remove(key);
+}
+
 KResultOr<NonnullRefPtr<Custody>> VFS::resolve_path_without_veil(StringView path, Custody& base, RefPtr<Custody>* out_parent, int options, int symlink_recursion_level)
 {
     if (symlink_recursion_level >= symlink_recursion_limit)
@@ -926,7 +989,7 @@ KResultOr<NonnullRefPtr<Custody>> VFS::resolve_path_without_veil(StringView path
         }
 
         // Okay, let's look up this part.
-        auto child_inode = parent.inode().lookup(part);
+        auto child_inode = lookup_child(parent.inode(), part);
         if (!child_inode) {
             if (out_parent) {
                 // ENOENT with a non-null parent custody signals to caller that
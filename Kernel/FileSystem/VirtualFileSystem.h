@@ -33,6 +33,7 @@
 #include <AK/OwnPtr.h>
 #include <AK/RefPtr.h>
 #include <AK/String.h>
+#include <AK/StringView.h>
 #include <Kernel/FileSystem/FileSystem.h>
 #include <Kernel/FileSystem/InodeIdentifier.h>
 #include <Kernel/FileSystem/InodeMetadata.h>
@@ -118,6 +119,8 @@ public:
     KResultOr<NonnullRefPtr<Custody>> resolve_path(StringView path, Custody& base, RefPtr<Custody>* out_parent = nullptr, int options = 0, int symlink_recursion_level = 0);
     KResultOr<NonnullRefPtr<Custody>> resolve_path_without_veil(StringView path, Custody& base, RefPtr<Custody>* out_parent = nullptr, int options = 0, int symlink_recursion_level = 0);
 
+    void did_change_directory_entry(Badge<Inode>, const Inode& directory, const StringView& name);
+
 private:
     friend class FileDescription;
 
@@ -133,8 +136,26 @@ private:
     Mount* find_mount_for_guest(Inode&);
     Mount* find_mount_for_guest(InodeIdentifier);
 
+    RefPtr<Inode> lookup_child(Inode& directory, const StringView& name);
+    void purge_lookup_cache(u32 fsid);
+
     Lock m_lock { "VFSLock" };
 
+    // Remembers the outcome of recent directory lookups, including names that were not found.
+    // Only filesystems that report every change to their directories take part in this.
+    struct LookupCacheKey {
+        InodeIdentifier directory;
+        String name;
+    };
+    struct LookupCacheKeyTraits : public GenericTraits<LookupCacheKey> {
+        static unsigned hash(const LookupCacheKey& key) { return hash_of(key.directory, key.name); }
+        static bool equals(const LookupCacheKey& a, const LookupCacheKey& b) { return a.directory == b.directory && a.name == b.name; }
+        static unsigned hash_of(InodeIdentifier directory, const StringView& name) { return pair_int_hash(pair_int_hash(directory.fsid(), directory.index()), name.hash()); }
+    };
+    Lock m_lookup_cache_lock { "VFSLookupCache" };
+    HashMap<LookupCacheKey, RefPtr<Inode>, LookupCacheKeyTraits> m_lookup_cache;
+    u32 m_lookup_cache_generation { 0 };
+
     RefPtr<Inode> m_root_inode;
     Vector<Mount, 16> m_mounts;
     RefPtr<Custody> m_root_custody;
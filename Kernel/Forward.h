@@ -31,14 +31,17 @@ namespace Kernel {
 class BlockDevice;
 class CharacterDevice;
 class Custody;
+class DeferredWork;
 class Device;
 class DiskCache;
 class DoubleBuffer;
+class EventSet;
 class File;
 class FileDescription;
 class IPv4Socket;
 class Inode;
 class InodeIdentifier;
+class InodeVMObject;
 class SharedInodeVMObject;
 class InodeWatcher;
 class KBuffer;
@@ -72,6 +75,7 @@ class UDPSocket;
 class VFS;
 class VMObject;
 class WaitQueue;
+class WorkQueue;
 
 template<typename T>
 class KResultOr;
@@ -26,47 +26,50 @@
 
 #include <AK/Assertions.h>
 #include <AK/Memory.h>
+#include <AK/StringView.h>
 #include <Kernel/Heap/SlabAllocator.h>
 #include <Kernel/Heap/kmalloc.h>
 #include <Kernel/SpinLock.h>
+#include <Kernel/VM/MemoryManager.h>
 #include <Kernel/VM/Region.h>
 
 #define SANITIZE_SLABS
 
 namespace Kernel {
 
-template<size_t templated_slab_size>
 class SlabAllocator {
 public:
     SlabAllocator() {}
 
-    void init(size_t size)
+    void init(const char* name, size_t slab_size, size_t initial_size)
     {
-        m_base = kmalloc_eternal(size);
-        m_end = (u8*)m_base + size;
-        FreeSlab* slabs = (FreeSlab*)m_base;
-        size_t slab_count = size / templated_slab_size;
-        for (size_t i = 1; i < slab_count; ++i) {
-            slabs[i].next = &slabs[i - 1];
-        }
-        slabs[0].next = nullptr;
-        m_freelist = &slabs[slab_count - 1];
+        ASSERT(slab_size >= sizeof(FreeSlab));
+        m_name = name;
+        m_blocks = nullptr;
+        m_freelist = nullptr;
         m_num_allocated.store(0, AK::MemoryOrder::memory_order_release);
-        m_num_free.store(slab_count, AK::MemoryOrder::memory_order_release);
+        m_num_free.store(0, AK::MemoryOrder::memory_order_release);
+        m_num_blocks.store(0, AK::MemoryOrder::memory_order_release);
+        // This publishes the allocator, see is_initialized()
+        AK::atomic_store(&m_slab_size, slab_size, AK::MemoryOrder::memory_order_release);
+        if (initial_size) {
+            ScopedSpinLock lock(m_lock);
+            add_block(new Block { nullptr, nullptr, (u8*)kmalloc_eternal(initial_size), initial_size, 0 });
+        }
     }
 
-    constexpr size_t slab_size() const { return templated_slab_size; }
+    const char* name() const { return m_name; }
+    size_t slab_size() const { return m_slab_size; }
 
-    void* alloc()
+    void* alloc(size_t size)
     {
-        ScopedSpinLock lock(m_lock);
-        if (!m_freelist)
+        ASSERT(is_initialized());
+        ASSERT(size <= slab_size());
+        void* ptr = pop_free_slab();
+        if (!ptr && grow())
+            ptr = pop_free_slab();
+        if (!ptr)
             return kmalloc(slab_size());
-        ASSERT(m_freelist);
-        void* ptr = m_freelist;
-        m_freelist = m_freelist->next;
-        m_num_allocated.fetch_add(1, AK::MemoryOrder::memory_order_acq_rel);
-        m_num_free.fetch_sub(1, AK::MemoryOrder::memory_order_acq_rel);
 #ifdef SANITIZE_SLABS
         memset(ptr, SLAB_ALLOC_SCRUB_BYTE, slab_size());
 #endif
@@ -75,47 +78,187 @@ public:
 
     void dealloc(void* ptr)
     {
-        ScopedSpinLock lock(m_lock);
         ASSERT(ptr);
-        if (ptr < m_base || ptr >= m_end) {
+        ScopedSpinLock lock(m_lock);
+        auto* block = block_containing(ptr);
+        if (!block) {
             kfree(ptr);
             return;
         }
         ((FreeSlab*)ptr)->next = m_freelist;
 #ifdef SANITIZE_SLABS
-        if (slab_size() > sizeof(FreeSlab*))
-            memset(((FreeSlab*)ptr)->padding, SLAB_DEALLOC_SCRUB_BYTE, sizeof(FreeSlab::padding));
+        memset((u8*)ptr + sizeof(FreeSlab), SLAB_DEALLOC_SCRUB_BYTE, slab_size() - sizeof(FreeSlab));
 #endif
         m_freelist = (FreeSlab*)ptr;
+        --block->num_allocated;
         m_num_allocated.fetch_sub(1, AK::MemoryOrder::memory_order_acq_rel);
         m_num_free.fetch_add(1, AK::MemoryOrder::memory_order_acq_rel);
     }
 
+    // Hands the memory of all empty blocks that we grew back to the system.
+    size_t release_empty_blocks()
+    {
+        Block* released = nullptr;
+        {
+            ScopedSpinLock lock(m_lock);
+            Block* previous = nullptr;
+            for (auto* block = m_blocks; block;) {
+                auto* next = block->next;
+                if (block->region && !block->num_allocated) {
+                    if (previous)
+                        previous->next = next;
+                    else
+                        m_blocks = next;
+                    forget_free_slabs_in(*block);
+                    block->next = released;
+                    released = block;
+                    m_num_blocks.fetch_sub(1, AK::MemoryOrder::memory_order_acq_rel);
+                } else {
+                    previous = block;
+                }
+                block = next;
+            }
+        }
+
+        // Destroying the regions allocates and frees slabs of their own, so do it without our lock.
+        size_t released_bytes = 0;
+        while (released) {
+            auto* next = released->next;
+            released_bytes += released->size;
+            delete released;
+            released = next;
+        }
+        return released_bytes;
+    }
+
+    bool is_initialized() const { return AK::atomic_load(&m_slab_size, AK::MemoryOrder::memory_order_acquire); }
     size_t num_allocated() const { return m_num_allocated.load(AK::MemoryOrder::memory_order_consume); }
     size_t num_free() const { return m_num_free.load(AK::MemoryOrder::memory_order_consume); }
+    size_t num_blocks() const { return m_num_blocks.load(AK::MemoryOrder::memory_order_consume); }
 
 private:
+    // How much we grow by at a time, from freshly allocated physical pages.
+    static constexpr size_t block_size = 64 * KB;
+
     struct FreeSlab {
         FreeSlab* next { nullptr };
-        char padding[templated_slab_size - sizeof(FreeSlab*)];
     };
 
+    struct Block {
+        Block* next { nullptr };
+        OwnPtr<Region> region; // null for the block carved out at boot, which we never give back
+        u8* base { nullptr };
+        size_t size { 0 };
+        size_t num_allocated { 0 };
+
+        bool contains(void* ptr) const { return ptr >= base && ptr < base + size; }
+    };
+
+    void* pop_free_slab()
+    {
+        ScopedSpinLock lock(m_lock);
+        if (!m_freelist)
+            return nullptr;
+        void* ptr = m_freelist;
+        m_freelist = m_freelist->next;
+        auto* block = block_containing(ptr);
+        ASSERT(block);
+        ++block->num_allocated;
+        m_num_allocated.fetch_add(1, AK::MemoryOrder::memory_order_acq_rel);
+        m_num_free.fetch_sub(1, AK::MemoryOrder::memory_order_acq_rel);
+        return ptr;
+    }
+
+    bool grow()
+    {
+        // Growing needs the memory manager, which in turn allocates slabs. Whenever that
+        // could recurse into ourselves or the memory manager, fall back to kmalloc instead.
+        if (!MemoryManager::is_initialized() || s_mm_lock.own_lock() || Processor::current().in_irq())
+            return false;
+        {
+            ScopedSpinLock lock(m_lock);
+            if (m_is_growing)
+                return false;
+            m_is_growing = true;
+        }
+
+        auto region = MM.allocate_kernel_region(block_size, "Slab block", Region::Access::Read | Region::Access::Write, false, true);
+        Block* block = nullptr;
+        if (region) {
+            block = new Block;
+            block->base = region->vaddr().as_ptr();
+            block->size = region->size();
+            block->region = move(region);
+        }
+
+        ScopedSpinLock lock(m_lock);
+        m_is_growing = false;
+        if (!block)
+            return false;
+        add_block(block);
+        return true;
+    }
+
+    void add_block(Block* block)
+    {
+        ASSERT(m_lock.is_locked());
+        size_t slab_count = block->size / slab_size();
+        for (size_t i = 0; i < slab_count; ++i) {
+            auto* slab = (FreeSlab*)(block->base + i * slab_size());
+            slab->next = m_freelist;
+            m_freelist = slab;
+        }
+        block->next = m_blocks;
+        m_blocks = block;
+        m_num_free.fetch_add(slab_count, AK::MemoryOrder::memory_order_acq_rel);
+        if (block->region)
+            m_num_blocks.fetch_add(1, AK::MemoryOrder::memory_order_acq_rel);
+    }
+
+    void forget_free_slabs_in(const Block& block)
+    {
+        ASSERT(m_lock.is_locked());
+        size_t forgotten = 0;
+        FreeSlab** link = &m_freelist;
+        while (*link) {
+            if (block.contains(*link)) {
+                *link = (*link)->next;
+                ++forgotten;
+            } else {
+                link = &(*link)->next;
+            }
+        }
+        m_num_free.fetch_sub(forgotten, AK::MemoryOrder::memory_order_acq_rel);
+    }
+
+    Block* block_containing(void* ptr) const
+    {
+        for (auto* block = m_blocks; block; block = block->next) {
+            if (block->contains(ptr))
+                return block;
+        }
+        return nullptr;
+    }
+
+    const char* m_name { nullptr };
+    volatile size_t m_slab_size { 0 }; // atomic
+    Block* m_blocks { nullptr };
     FreeSlab* m_freelist { nullptr };
+    bool m_is_growing { false };
     Atomic<size_t> m_num_allocated;
     Atomic<size_t> m_num_free;
-    void* m_base { nullptr };
-    void* m_end { nullptr };
+    Atomic<size_t> m_num_blocks;
     SpinLock<u32> m_lock;
-
-    static_assert(sizeof(FreeSlab) == templated_slab_size);
 };
 
-static SlabAllocator<16> s_slab_allocator_16;
-static SlabAllocator<32> s_slab_allocator_32;
-static SlabAllocator<64> s_slab_allocator_64;
-static SlabAllocator<128> s_slab_allocator_128;
+static SlabAllocator s_slab_allocator_16;
+static SlabAllocator s_slab_allocator_32;
+static SlabAllocator s_slab_allocator_64;
+static SlabAllocator s_slab_allocator_128;
+static SlabAllocator s_slab_allocator_256;
+static SlabAllocator s_slab_allocator_512;
 
-static_assert(sizeof(Region) <= s_slab_allocator_64.slab_size());
+static SlabAllocator s_slab_caches[(size_t)SlabCache::__Count];
 
 template<typename Callback>
 void for_each_allocator(Callback callback)
@@ -124,46 +267,105 @@ void for_each_allocator(Callback callback)
     callback(s_slab_allocator_32);
     callback(s_slab_allocator_64);
     callback(s_slab_allocator_128);
+    callback(s_slab_allocator_256);
+    callback(s_slab_allocator_512);
+    for (auto& cache : s_slab_caches) {
+        if (cache.is_initialized())
+            callback(cache);
+    }
+}
+
+static const char* name_of(SlabCache cache)
+{
+    switch (cache) {
+    case SlabCache::Thread:
+        return "Thread";
+    case SlabCache::Region:
+        return "Region";
+    case SlabCache::PhysicalPage:
+        return "PhysicalPage";
+    case SlabCache::TCPOutgoingPacket:
+        return "TCPOutgoingPacket";
+    default:
+        ASSERT_NOT_REACHED();
+    }
 }
 
 void slab_alloc_init()
 {
-    s_slab_allocator_16.init(128 * KB);
-    s_slab_allocator_32.init(128 * KB);
-    s_slab_allocator_64.init(512 * KB);
-    s_slab_allocator_128.init(512 * KB);
+    s_slab_allocator_16.init("16", 16, 128 * KB);
+    s_slab_allocator_32.init("32", 32, 128 * KB);
+    s_slab_allocator_64.init("64", 64, 512 * KB);
+    s_slab_allocator_128.init("128", 128, 512 * KB);
+    s_slab_allocator_256.init("256", 256, 0);
+    s_slab_allocator_512.init("512", 512, 0);
 }
 
-void* slab_alloc(size_t slab_size)
+static SlabAllocator& allocator_for(size_t slab_size)
 {
     if (slab_size <= 16)
-        return s_slab_allocator_16.alloc();
+        return s_slab_allocator_16;
     if (slab_size <= 32)
-        return s_slab_allocator_32.alloc();
+        return s_slab_allocator_32;
     if (slab_size <= 64)
-        return s_slab_allocator_64.alloc();
+        return s_slab_allocator_64;
     if (slab_size <= 128)
-        return s_slab_allocator_128.alloc();
+        return s_slab_allocator_128;
+    if (slab_size <= 256)
+        return s_slab_allocator_256;
+    if (slab_size <= 512)
+        return s_slab_allocator_512;
     ASSERT_NOT_REACHED();
 }
 
+static SpinLock<u8> s_slab_caches_lock;
+
+static SlabAllocator& allocator_for(SlabCache cache, size_t object_size)
+{
+    auto& allocator = s_slab_caches[(size_t)cache];
+    if (!allocator.is_initialized()) {
+        // A cache learns its object size on first use.
+        ScopedSpinLock lock(s_slab_caches_lock);
+        if (!allocator.is_initialized())
+            allocator.init(name_of(cache), round_up_to_power_of_two(object_size, sizeof(void*)), 0);
+    }
+    ASSERT(object_size <= allocator.slab_size());
+    return allocator;
+}
+
+void* slab_alloc(size_t slab_size)
+{
+    return allocator_for(slab_size).alloc(slab_size);
+}
+
 void slab_dealloc(void* ptr, size_t slab_size)
 {
-    if (slab_size <= 16)
-        return s_slab_allocator_16.dealloc(ptr);
-    if (slab_size <= 32)
-        return s_slab_allocator_32.dealloc(ptr);
-    if (slab_size <= 64)
-        return s_slab_allocator_64.dealloc(ptr);
-    if (slab_size <= 128)
-        return s_slab_allocator_128.dealloc(ptr);
-    ASSERT_NOT_REACHED();
+    allocator_for(slab_size).dealloc(ptr);
+}
+
+void* slab_alloc(SlabCache cache, size_t object_size)
+{
+    return allocator_for(cache, object_size).alloc(object_size);
+}
+
+void slab_dealloc(SlabCache cache, void* ptr, size_t object_size)
+{
+    allocator_for(cache, object_size).dealloc(ptr);
+}
+
+size_t slab_release_empty_blocks()
+{
+    size_t released_bytes = 0;
+    for_each_allocator([&](auto& allocator) {
+        released_bytes += allocator.release_empty_blocks();
+    });
+    return released_bytes;
 }
 
-void slab_alloc_stats(Function<void(size_t slab_size, size_t allocated, size_t free)> callback)
+void slab_alloc_stats(Function<void(const SlabAllocatorStatistics&)> callback)
 {
     for_each_allocator([&](auto& allocator) {
-        callback(allocator.slab_size(), allocator.num_allocated(), allocator.num_free());
+        callback({ allocator.name(), allocator.slab_size(), allocator.num_allocated(), allocator.num_free(), allocator.num_blocks() });
     });
 }
 
@@ -34,10 +34,32 @@ namespace Kernel {
 #define SLAB_ALLOC_SCRUB_BYTE 0xab
 #define SLAB_DEALLOC_SCRUB_BYTE 0xbc
 
+// Caches of their own for the kernel objects we allocate the most of.
+enum class SlabCache {
+    Thread,
+    Region,
+    PhysicalPage,
+    TCPOutgoingPacket,
+    __Count
+};
+
+struct SlabAllocatorStatistics {
+    const char* name;
+    size_t slab_size;
+    size_t num_allocated;
+    size_t num_free;
+    size_t num_blocks; // grown on demand, not counting what was set aside at boot
+};
+
 void* slab_alloc(size_t slab_size);
 void slab_dealloc(void*, size_t slab_size);
+void* slab_alloc(SlabCache, size_t object_size);
+void slab_dealloc(SlabCache, void*, size_t object_size);
 void slab_alloc_init();
-void slab_alloc_stats(Function<void(size_t slab_size, size_t allocated, size_t free)>);
+void slab_alloc_stats(Function<void(const SlabAllocatorStatistics&)>);
+
+// Gives the memory of empty slab blocks back, returns how many bytes that freed up.
+size_t slab_release_empty_blocks();
 
 #define MAKE_SLAB_ALLOCATED(type)                                        \
 public:                                                                  \
@@ -46,4 +68,11 @@ public:                                                                  \
                                                                          \
 private:
 
+#define MAKE_SLAB_CACHED(type, cache)                                                         \
+public:                                                                                       \
+    void* operator new(size_t) { return slab_alloc(SlabCache::cache, sizeof(type)); }         \
+    void operator delete(void* ptr) { slab_dealloc(SlabCache::cache, ptr, sizeof(type)); }    \
+                                                                                              \
+private:
+
 }
@@ -69,9 +69,51 @@ static u8* s_end_of_eternal_range;
 
 static RecursiveSpinLock s_lock; // needs to be recursive because of dump_backtrace()
 
+// Recently freed small allocations are kept in per-processor magazines, so that
+// most kmalloc() and kfree() calls neither take s_lock nor search the bitmap.
+// Magazines are refilled from and drained to the heap in batches of half their size.
+#define CACHE_MAX_PROCESSORS 32
+#define CACHE_SIZE_CLASS_COUNT 4 // 1, 2, 4 and 8 chunks
+#define MAGAZINE_SIZE 32
+
+struct KmallocMagazine {
+    size_t count;
+    void* slots[MAGAZINE_SIZE];
+};
+
+struct KmallocCache {
+    KmallocMagazine magazines[CACHE_SIZE_CLASS_COUNT];
+    size_t hits;
+    size_t misses;
+    size_t frees;
+};
+
+static KmallocCache s_caches[CACHE_MAX_PROCESSORS];
+
+static inline size_t size_class_for(size_t chunks)
+{
+    for (size_t size_class = 0; size_class < CACHE_SIZE_CLASS_COUNT; ++size_class) {
+        if (chunks <= (1u << size_class))
+            return size_class;
+    }
+    return CACHE_SIZE_CLASS_COUNT;
+}
+
+static inline KmallocCache* cache_for_this_processor()
+{
+    ASSERT(!Processor::is_initialized() || Processor::current().in_critical());
+    if (!Processor::is_initialized())
+        return nullptr;
+    auto cpu = Processor::current().id();
+    if (cpu >= CACHE_MAX_PROCESSORS)
+        return nullptr;
+    return &s_caches[cpu];
+}
+
 void kmalloc_init()
 {
     memset(&alloc_map, 0, sizeof(alloc_map));
+    memset(&s_caches, 0, sizeof(s_caches));
     memset((void*)BASE_PHYSICAL, 0, POOL_SIZE);
     s_lock.initialize();
 
@@ -132,8 +174,52 @@ inline void* kmalloc_allocate(size_t first_chunk, size_t chunks_needed)
     return ptr;
 }
 
+static inline void kfree_impl(void* ptr);
+
+static void drain_magazine(KmallocMagazine& magazine, size_t count)
+{
+    ASSERT(s_lock.is_locked());
+    ASSERT(count <= magazine.count);
+    // Give back the ones that have been sitting in the magazine the longest
+    for (size_t i = 0; i < count; ++i)
+        kfree_impl(magazine.slots[i]);
+    magazine.count -= count;
+    memmove(magazine.slots, magazine.slots + count, magazine.count * sizeof(void*));
+}
+
+static void refill_magazine(KmallocMagazine& magazine, size_t chunks)
+{
+    ASSERT(s_lock.is_locked());
+    Bitmap bitmap_wrapper = Bitmap::wrap(alloc_map, POOL_SIZE / CHUNK_SIZE);
+    while (magazine.count < MAGAZINE_SIZE / 2) {
+        auto first_chunk = bitmap_wrapper.find_first_fit(chunks);
+        if (!first_chunk.has_value())
+            break;
+        magazine.slots[magazine.count++] = kmalloc_allocate(first_chunk.value(), chunks);
+    }
+}
+
 void* kmalloc_impl(size_t size)
 {
+    // We need space for the AllocationHeader at the head of the block.
+    size_t real_size = size + sizeof(AllocationHeader);
+    size_t size_class = size_class_for((real_size + CHUNK_SIZE - 1) / CHUNK_SIZE);
+
+    if (size_class < CACHE_SIZE_CLASS_COUNT && !g_dump_kmalloc_stacks && Processor::is_initialized()) {
+        ScopedCritical critical;
+        if (auto* cache = cache_for_this_processor()) {
+            auto& magazine = cache->magazines[size_class];
+            if (magazine.count) {
+                ++cache->hits;
+                u8* ptr = (u8*)magazine.slots[--magazine.count];
+#ifdef SANITIZE_KMALLOC
+                memset(ptr, KMALLOC_SCRUB_BYTE, ((1u << size_class) * CHUNK_SIZE) - sizeof(AllocationHeader));
+#endif
+                return ptr;
+            }
+        }
+    }
+
     ScopedSpinLock lock(s_lock);
     ++g_kmalloc_call_count;
 
@@ -142,9 +228,6 @@ void* kmalloc_impl(size_t size)
         Kernel::dump_backtrace();
     }
 
-    // We need space for the AllocationHeader at the head of the block.
-    size_t real_size = size + sizeof(AllocationHeader);
-
     if (g_kmalloc_bytes_free < real_size) {
         Kernel::dump_backtrace();
         klog() << "kmalloc(): PANIC! Out of memory\nsum_free=" << g_kmalloc_bytes_free << ", real_size=" << real_size;
@@ -153,6 +236,14 @@ void* kmalloc_impl(size_t size)
 
     size_t chunks_needed = (real_size + CHUNK_SIZE - 1) / CHUNK_SIZE;
 
+    // Cached allocations are of exactly their size class, so they can go back into any magazine of it.
+    auto* cache = cache_for_this_processor();
+    if (size_class < CACHE_SIZE_CLASS_COUNT) {
+        chunks_needed = 1u << size_class;
+        if (cache)
+            ++cache->misses;
+    }
+
     Bitmap bitmap_wrapper = Bitmap::wrap(alloc_map, POOL_SIZE / CHUNK_SIZE);
     Optional<size_t> first_chunk;
 
@@ -164,19 +255,27 @@ void* kmalloc_impl(size_t size)
         first_chunk = bitmap_wrapper.find_best_fit(chunks_needed);
     }
 
+    if (!first_chunk.has_value() && cache) {
+        // Our magazines may be holding on to just what we need
+        for (auto& magazine : cache->magazines)
+            drain_magazine(magazine, magazine.count);
+        first_chunk = bitmap_wrapper.find_first_fit(chunks_needed);
+    }
+
     if (!first_chunk.has_value()) {
         klog() << "kmalloc(): PANIC! Out of memory (no suitable block for size " << size << ")";
         Kernel::dump_backtrace();
         Processor::halt();
     }
 
-    return kmalloc_allocate(first_chunk.value(), chunks_needed);
+    auto* ptr = kmalloc_allocate(first_chunk.value(), chunks_needed);
+    if (size_class < CACHE_SIZE_CLASS_COUNT && cache)
+        refill_magazine(cache->magazines[size_class], chunks_needed);
+    return ptr;
 }
 
 static inline void kfree_impl(void* ptr)
 {
-    ++g_kfree_call_count;
-
     auto* a = (AllocationHeader*)((((u8*)ptr) - sizeof(AllocationHeader)));
     FlatPtr start = ((FlatPtr)a - (FlatPtr)BASE_PHYSICAL) / CHUNK_SIZE;
 
@@ -191,15 +290,60 @@ static inline void kfree_impl(void* ptr)
 #endif
 }
 
+static bool kfree_to_cache(void* ptr)
+{
+    auto* a = (AllocationHeader*)((((u8*)ptr) - sizeof(AllocationHeader)));
+    size_t size_class = size_class_for(a->allocation_size_in_chunks);
+    if (size_class >= CACHE_SIZE_CLASS_COUNT || a->allocation_size_in_chunks != (1u << size_class))
+        return false;
+    if (!Processor::is_initialized())
+        return false;
+
+    ScopedCritical critical;
+    auto* cache = cache_for_this_processor();
+    if (!cache)
+        return false;
+
+    auto& magazine = cache->magazines[size_class];
+    if (magazine.count == MAGAZINE_SIZE) {
+        ScopedSpinLock lock(s_lock);
+        drain_magazine(magazine, MAGAZINE_SIZE / 2);
+    }
+#ifdef SANITIZE_KMALLOC
+    memset(ptr, KFREE_SCRUB_BYTE, (a->allocation_size_in_chunks * CHUNK_SIZE) - sizeof(AllocationHeader));
+#endif
+    magazine.slots[magazine.count++] = ptr;
+    ++cache->frees;
+    return true;
+}
+
 void kfree(void* ptr)
 {
     if (!ptr)
         return;
 
+    if (kfree_to_cache(ptr))
+        return;
+
     ScopedSpinLock lock(s_lock);
+    ++g_kfree_call_count;
     kfree_impl(ptr);
 }
 
+bool kmalloc_cache_statistics(u32 cpu, KmallocCacheStatistics& statistics)
+{
+    if (cpu >= CACHE_MAX_PROCESSORS)
+        return false;
+    auto& cache = s_caches[cpu];
+    statistics.hits = cache.hits;
+    statistics.misses = cache.misses;
+    statistics.frees = cache.frees;
+    statistics.cached_bytes = 0;
+    for (size_t size_class = 0; size_class < CACHE_SIZE_CLASS_COUNT; ++size_class)
+        statistics.cached_bytes += cache.magazines[size_class].count * (1u << size_class) * CHUNK_SIZE;
+    return true;
+}
+
 void* krealloc(void* ptr, size_t new_size)
 {
     if (!ptr)
@@ -215,6 +359,7 @@ void* krealloc(void* ptr, size_t new_size)
 
     auto* new_ptr = kmalloc(new_size);
     memcpy(new_ptr, ptr, min(old_size, new_size));
+    ++g_kfree_call_count;
     kfree_impl(ptr);
     return new_ptr;
 }
@@ -49,6 +49,15 @@ extern size_t g_kmalloc_call_count;
 extern size_t g_kfree_call_count;
 extern bool g_dump_kmalloc_stacks;
 
+struct KmallocCacheStatistics {
+    size_t hits;   // kmalloc() calls served from the magazines
+    size_t misses; // cacheable kmalloc() calls that had to go to the heap
+    size_t frees;  // kfree() calls that went into the magazines
+    size_t cached_bytes;
+};
+
+bool kmalloc_cache_statistics(u32 cpu, KmallocCacheStatistics&);
+
 inline void* operator new(size_t, void* p) { return p; }
 inline void* operator new[](size_t, void* p) { return p; }
 
@@ -34,7 +34,11 @@
 #include <Kernel/IO.h>
 #include <Kernel/Interrupts/APIC.h>
 #include <Kernel/Interrupts/SpuriousInterruptHandler.h>
+#include <Kernel/PerformanceCounters.h>
 #include <Kernel/Thread.h>
+#include <Kernel/Time/HPET.h>
+#include <Kernel/Time/PIT.h>
+#include <Kernel/TimerQueue.h>
 #include <Kernel/VM/MemoryManager.h>
 #include <Kernel/VM/PageDirectory.h>
 #include <Kernel/VM/TypedMapping.h>
@@ -42,6 +46,8 @@
 //#define APIC_DEBUG
 //#define APIC_SMP_DEBUG
 
+#define IRQ_APIC_PERFORMANCE_COUNTER (0xfb - IRQ_VECTOR_BASE)
+#define IRQ_APIC_TIMER (0xfc - IRQ_VECTOR_BASE)
 #define IRQ_APIC_IPI (0xfd - IRQ_VECTOR_BASE)
 #define IRQ_APIC_ERR (0xfe - IRQ_VECTOR_BASE)
 #define IRQ_APIC_SPURIOUS (0xff - IRQ_VECTOR_BASE)
@@ -65,6 +71,11 @@
 #define APIC_REG_LVT_LINT0 0x350
 #define APIC_REG_LVT_LINT1 0x360
 #define APIC_REG_LVT_ERR 0x370
+#define APIC_REG_TIMER_INITIAL_COUNT 0x380
+#define APIC_REG_TIMER_CURRENT_COUNT 0x390
+#define APIC_REG_TIMER_CONFIGURATION 0x3e0
+
+#define APIC_TIMER_DIVIDE_BY_16 0x3
 
 namespace Kernel {
 
@@ -100,6 +111,66 @@ public:
 private:
 };
 
+class APICTimerInterruptHandler final : public GenericInterruptHandler {
+public:
+    explicit APICTimerInterruptHandler(u8 interrupt_vector)
+        : GenericInterruptHandler(interrupt_vector, true)
+    {
+    }
+    virtual ~APICTimerInterruptHandler()
+    {
+    }
+
+    static void initialize(u8 interrupt_number)
+    {
+        new APICTimerInterruptHandler(interrupt_number);
+    }
+
+    virtual void handle_interrupt(const RegisterState&) override;
+
+    virtual bool eoi() override;
+
+    virtual HandlerType type() const override { return HandlerType::IRQHandler; }
+    virtual const char* purpose() const override { return "Local Timer Handler"; }
+    virtual const char* controller() const override { ASSERT_NOT_REACHED(); }
+
+    virtual size_t sharing_devices_count() const override { return 0; }
+    virtual bool is_shared_handler() const override { return false; }
+    virtual bool is_sharing_with_others() const override { return false; }
+
+private:
+};
+
+class APICPerformanceCounterInterruptHandler final : public GenericInterruptHandler {
+public:
+    explicit APICPerformanceCounterInterruptHandler(u8 interrupt_vector)
+        : GenericInterruptHandler(interrupt_vector, true)
+    {
+    }
+    virtual ~APICPerformanceCounterInterruptHandler()
+    {
+    }
+
+    static void initialize(u8 interrupt_number)
+    {
+        new APICPerformanceCounterInterruptHandler(interrupt_number);
+    }
+
+    virtual void handle_interrupt(const RegisterState&) override;
+
+    virtual bool eoi() override;
+
+    virtual HandlerType type() const override { return HandlerType::IRQHandler; }
+    virtual const char* purpose() const override { return "Performance Counter Handler"; }
+    virtual const char* controller() const override { ASSERT_NOT_REACHED(); }
+
+    virtual size_t sharing_devices_count() const override { return 0; }
+    virtual bool is_shared_handler() const override { return false; }
+    virtual bool is_sharing_with_others() const override { return false; }
+
+private:
+};
+
 class APICErrInterruptHandler final : public GenericInterruptHandler {
 public:
     explicit APICErrInterruptHandler(u8 interrupt_vector)
@@ -198,7 +269,7 @@ void APIC::write_icr(const ICRReg& icr)
 
 #define APIC_LVT_MASKED (1 << 16)
 #define APIC_LVT_TRIGGER_LEVEL (1 << 14)
-#define APIC_LVT(iv, dm) ((iv & 0xff) | ((dm & 0x7) << 8))
+#define APIC_LVT(iv, dm) (((iv) & 0xff) | (((dm) & 0x7) << 8))
 
 extern "C" void apic_ap_start(void);
 extern "C" u16 apic_ap_start_size;
@@ -437,6 +508,8 @@ void APIC::enable(u32 cpu)
 
         // register IPI interrupt vector
         APICIPIInterruptHandler::initialize(IRQ_APIC_IPI);
+
+        APICPerformanceCounterInterruptHandler::initialize(IRQ_APIC_PERFORMANCE_COUNTER);
     }
 
     // set spurious interrupt vector
@@ -445,13 +518,90 @@ void APIC::enable(u32 cpu)
     // local destination mode (flat mode)
     write_register(APIC_REG_DF, 0xf0000000);
 
-    write_register(APIC_REG_LVT_TIMER, APIC_LVT(0, 0) | APIC_LVT_MASKED);
+    // The BSP calibrates its timer later on, the APs come up after that
+    if (has_timer())
+        enable_timer();
+    else
+        write_register(APIC_REG_LVT_TIMER, APIC_LVT(0, 0) | APIC_LVT_MASKED);
     write_register(APIC_REG_LVT_THERMAL, APIC_LVT(0, 0) | APIC_LVT_MASKED);
-    write_register(APIC_REG_LVT_PERFORMANCE_COUNTER, APIC_LVT(0, 0) | APIC_LVT_MASKED);
+    // Counters only raise overflow interrupts when a sampling perf_event programs them to
+    write_register(APIC_REG_LVT_PERFORMANCE_COUNTER, APIC_LVT(IRQ_APIC_PERFORMANCE_COUNTER + IRQ_VECTOR_BASE, 0));
     write_register(APIC_REG_LVT_LINT0, APIC_LVT(0, 7) | APIC_LVT_MASKED);
     write_register(APIC_REG_LVT_LINT1, APIC_LVT(0, 0) | APIC_LVT_TRIGGER_LEVEL);
 
     write_register(APIC_REG_TPR, 0);
+
+    if (cpu == 0)
+        m_is_enabled = true;
+}
+
+static void wait_10ms_with_pit()
+{
+    // Count down channel 2 once with the speaker disconnected, its output goes high when done
+    IO::out8(0x61, (IO::in8(0x61) & ~0x02) | 0x01);
+    IO::out8(PIT_CTL, TIMER2_SELECT | WRITE_WORD | MODE_COUNTDOWN);
+    u16 count = BASE_FREQUENCY / 100;
+    IO::out8(TIMER2_CTL, count & 0xff);
+    IO::out8(TIMER2_CTL, count >> 8);
+    while (!(IO::in8(0x61) & 0x20))
+        ;
+}
+
+void APIC::calibrate_timer()
+{
+    ASSERT(Processor::current().id() == 0);
+    if (!m_is_enabled)
+        return;
+
+    InterruptDisabler disabler;
+    write_register(APIC_REG_TIMER_CONFIGURATION, APIC_TIMER_DIVIDE_BY_16);
+    write_register(APIC_REG_LVT_TIMER, APIC_LVT(IRQ_APIC_TIMER + IRQ_VECTOR_BASE, 0) | APIC_LVT_MASKED);
+    write_register(APIC_REG_TIMER_INITIAL_COUNT, 0xffffffff);
+    if (HPET::initialized()) {
+        u64 start = HPET::the().nanoseconds_since_reset();
+        while (HPET::the().nanoseconds_since_reset() - start < 10'000'000)
+            ;
+    } else {
+        wait_10ms_with_pit();
+    }
+    u32 elapsed = 0xffffffff - read_register(APIC_REG_TIMER_CURRENT_COUNT);
+    write_register(APIC_REG_TIMER_INITIAL_COUNT, 0);
+
+    m_timer_frequency = elapsed * 100;
+    klog() << "APIC: Timer frequency " << m_timer_frequency << " Hz";
+    if (!has_timer())
+        return;
+
+    APICTimerInterruptHandler::initialize(IRQ_APIC_TIMER);
+    enable_timer();
+}
+
+void APIC::unmask_performance_counter_interrupt()
+{
+    write_register(APIC_REG_LVT_PERFORMANCE_COUNTER, APIC_LVT(IRQ_APIC_PERFORMANCE_COUNTER + IRQ_VECTOR_BASE, 0));
+}
+
+void APIC::enable_timer()
+{
+    // Unmasked and one-shot, it stays quiet until set_timer_deadline_in() arms it
+    write_register(APIC_REG_TIMER_CONFIGURATION, APIC_TIMER_DIVIDE_BY_16);
+    write_register(APIC_REG_TIMER_INITIAL_COUNT, 0);
+    write_register(APIC_REG_LVT_TIMER, APIC_LVT(IRQ_APIC_TIMER + IRQ_VECTOR_BASE, 0));
+}
+
+void APIC::set_timer_deadline_in(u64 nanoseconds)
+{
+    ASSERT(has_timer());
+    // A count of 0 would stop the timer, so an overdue deadline fires right away instead
+    nanoseconds = min(nanoseconds, (u64)1'000'000'000);
+    u64 count = nanoseconds * m_timer_frequency / 1'000'000'000;
+    write_register(APIC_REG_TIMER_INITIAL_COUNT, (u32)max(count, (u64)1));
+}
+
+void APIC::stop_timer()
+{
+    ASSERT(has_timer());
+    write_register(APIC_REG_TIMER_INITIAL_COUNT, 0);
 }
 
 Thread* APIC::get_idle_thread(u32 cpu) const
@@ -514,6 +664,18 @@ void APIC::send_ipi(u32 cpu)
     write_icr(ICRReg(IRQ_APIC_IPI + IRQ_VECTOR_BASE, ICRReg::Fixed, ICRReg::Logical, ICRReg::Assert, ICRReg::TriggerMode::Edge, ICRReg::NoShorthand, 1u << cpu));
 }
 
+void APIC::multicast_ipi(u32 cpu_mask)
+{
+#ifdef APIC_SMP_DEBUG
+    klog() << "SMP: Multicast IPI from cpu #" << Processor::current().id() << " to cpus " << String::format("%x", cpu_mask);
+#endif
+    ASSERT(!(cpu_mask & (1u << Processor::current().id())));
+    ASSERT(cpu_mask < (1u << 8));
+    wait_for_pending_icr();
+    // In flat mode each processor's logical id is one bit, so one IPI can address several of them
+    write_icr(ICRReg(IRQ_APIC_IPI + IRQ_VECTOR_BASE, ICRReg::Fixed, ICRReg::Logical, ICRReg::Assert, ICRReg::TriggerMode::Edge, ICRReg::NoShorthand, cpu_mask));
+}
+
 void APICIPIInterruptHandler::handle_interrupt(const RegisterState&)
 {
 #ifdef APIC_SMP_DEBUG
@@ -530,6 +692,29 @@ bool APICIPIInterruptHandler::eoi()
     return true;
 }
 
+void APICTimerInterruptHandler::handle_interrupt(const RegisterState&)
+{
+    TimerQueue::fire();
+}
+
+bool APICTimerInterruptHandler::eoi()
+{
+    APIC::the().eoi();
+    return true;
+}
+
+void APICPerformanceCounterInterruptHandler::handle_interrupt(const RegisterState& regs)
+{
+    PerformanceCounters::handle_overflow_interrupt(regs);
+    APIC::the().unmask_performance_counter_interrupt();
+}
+
+bool APICPerformanceCounterInterruptHandler::eoi()
+{
+    APIC::the().eoi();
+    return true;
+}
+
 void APICErrInterruptHandler::handle_interrupt(const RegisterState&)
 {
     klog() << "APIC: SMP error on cpu #" << Processor::current().id();
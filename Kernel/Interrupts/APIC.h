@@ -48,10 +48,20 @@ public:
     void init_finished(u32 cpu);
     void broadcast_ipi();
     void send_ipi(u32 cpu);
+    void multicast_ipi(u32 cpu_mask);
     static u8 spurious_interrupt_vector();
     Thread* get_idle_thread(u32 cpu) const;
     u32 enabled_processor_count() const { return m_processor_enabled_cnt; }
 
+    void calibrate_timer();
+    bool has_timer() const { return m_timer_frequency != 0; }
+    void set_timer_deadline_in(u64 nanoseconds);
+    void stop_timer();
+
+    bool is_enabled() const { return m_is_enabled; }
+    // The APIC masks the counter's LVT entry whenever it delivers an overflow interrupt
+    void unmask_performance_counter_interrupt();
+
 private:
     class ICRReg {
         u32 m_low { 0 };
@@ -102,6 +112,8 @@ private:
     AK::Atomic<u8> m_apic_ap_continue{0};
     u32 m_processor_cnt{0};
     u32 m_processor_enabled_cnt{0};
+    u32 m_timer_frequency { 0 };
+    bool m_is_enabled { false };
     
     static PhysicalAddress get_base();
     static void set_base(const PhysicalAddress& base);
@@ -112,6 +124,7 @@ private:
     void wait_for_pending_icr();
     void write_icr(const ICRReg& icr);
     void do_boot_aps();
+    void enable_timer();
 };
 
 }
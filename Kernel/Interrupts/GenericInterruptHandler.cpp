@@ -65,5 +65,25 @@ void GenericInterruptHandler::change_interrupt_number(u8 number)
 void GenericInterruptHandler::increment_invoking_counter()
 {
     m_invoking_count++;
+    u32 processor = Processor::current().id();
+    if (processor < max_processors)
+        m_invoking_count_per_processor[processor]++;
+}
+
+bool GenericInterruptHandler::set_target_processor(u32 processor)
+{
+    if (processor >= Processor::count() || processor >= max_processors)
+        return false;
+    if (!route_to_processor(processor))
+        return false;
+    m_target_processor = processor;
+    return true;
+}
+
+bool GenericInterruptHandler::route_to_processor(u32 processor)
+{
+    if (m_disable_remap || (type() != HandlerType::IRQHandler && type() != HandlerType::SharedIRQHandler))
+        return false;
+    return InterruptManagement::the().get_responsible_irq_controller(interrupt_number())->route_to_processor(*this, processor);
 }
 }
@@ -50,7 +50,15 @@ public:
 
     bool is_enabled() const { return m_enabled; }
 
+    // Interrupts are delivered in flat logical destination mode, which can't tell apart more processors than this. See APIC::enable().
+    static constexpr u32 max_processors = 8;
+
     size_t get_invoking_count() const { return m_invoking_count; }
+    size_t get_invoking_count_on_processor(u32 processor) const { return processor < max_processors ? m_invoking_count_per_processor[processor] : 0; }
+
+    u32 target_processor() const { return m_target_processor; }
+    // Returns false if the interrupt can't be moved there, like when it comes from the PIC, which only delivers to the boot processor.
+    bool set_target_processor(u32 processor);
 
     virtual size_t sharing_devices_count() const = 0;
     virtual bool is_shared_handler() const = 0;
@@ -67,8 +75,13 @@ protected:
     void change_interrupt_number(u8 number);
     explicit GenericInterruptHandler(u8 interrupt_number, bool disable_remap = false);
 
+    // Handlers that don't come through an IRQ controller have to point their source at the processor themselves.
+    virtual bool route_to_processor(u32 processor);
+
 private:
     size_t m_invoking_count { 0 };
+    size_t m_invoking_count_per_processor[max_processors] {};
+    u32 m_target_processor { 0 };
     bool m_enabled { false };
     u8 m_interrupt_number { 0 };
     bool m_disable_remap { false };
@@ -291,6 +291,22 @@ void IOAPIC::enable(const GenericInterruptHandler& handler)
     unmask_redirection_entry(found_index.value());
 }
 
+bool IOAPIC::route_to_processor(const GenericInterruptHandler& handler, u32 processor)
+{
+    InterruptDisabler disabler;
+    ASSERT(!is_hard_disabled());
+    auto found_index = find_redirection_entry_by_vector(handler.interrupt_number());
+    if (!found_index.has_value())
+        return false;
+    int index = found_index.value();
+    // Each local APIC gets one bit of the logical destination, see APIC::enable().
+    u32 redirection_entry = read_register((index << 1) + IOAPIC_REDIRECTION_ENTRY_OFFSET);
+    write_register((index << 1) + IOAPIC_REDIRECTION_ENTRY_OFFSET, redirection_entry | (1 << 16));
+    write_register((index << 1) + IOAPIC_REDIRECTION_ENTRY_OFFSET + 1, (1u << processor) << 24);
+    write_register((index << 1) + IOAPIC_REDIRECTION_ENTRY_OFFSET, redirection_entry | (1 << 11));
+    return true;
+}
+
 void IOAPIC::eoi(const GenericInterruptHandler& handler) const
 {
     InterruptDisabler disabler;
@@ -65,6 +65,7 @@ public:
     virtual void hard_disable() override;
     virtual void eoi(const GenericInterruptHandler&) const override;
     virtual void spurious_eoi(const GenericInterruptHandler&) const override;
+    virtual bool route_to_processor(const GenericInterruptHandler&, u32 processor) override;
     virtual bool is_vector_enabled(u8 number) const override;
     virtual bool is_enabled() const override;
     virtual u16 get_isr() const override;
@@ -49,6 +49,7 @@ public:
     bool is_hard_disabled() const { return m_hard_disabled; }
     virtual void eoi(const GenericInterruptHandler&) const = 0;
     virtual void spurious_eoi(const GenericInterruptHandler&) const = 0;
+    virtual bool route_to_processor(const GenericInterruptHandler&, u32) { return false; }
     virtual size_t interrupt_vectors_count() const = 0;
     virtual u32 gsi_base() const = 0;
     virtual u16 get_isr() const = 0;
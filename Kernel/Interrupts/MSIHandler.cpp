@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2020, The SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <Kernel/Interrupts/APIC.h>
+#include <Kernel/Interrupts/MSIHandler.h>
+
+namespace Kernel {
+
+// The IOAPIC's redirection entries map to interrupt numbers below this one, and the local APIC's own
+// interrupts start at IRQ_APIC_PERFORMANCE_COUNTER, so the range in between is free for MSI.
+static constexpr u8 first_msi_interrupt_number = 0x40;
+static constexpr u8 end_msi_interrupt_number = 0xfb - IRQ_VECTOR_BASE;
+
+// Logical destination mode, with the redirection hint set so the destination is taken as a logical one.
+static constexpr u32 msi_address_base = 0xfee00000 | (1 << 3) | (1 << 2);
+
+static u32 s_next_target_processor;
+
+OwnPtr<MSIHandler> MSIHandler::try_create(const char* purpose, Function<void()> callback)
+{
+    if (!APIC::initialized())
+        return nullptr;
+    InterruptDisabler disabler;
+    for (u8 interrupt_number = first_msi_interrupt_number; interrupt_number < end_msi_interrupt_number; ++interrupt_number) {
+        if (GenericInterruptHandler::from(interrupt_number).type() != HandlerType::UnhandledInterruptHandler)
+            continue;
+        auto handler = adopt_own(*new MSIHandler(interrupt_number, purpose, move(callback)));
+        // Spread the handlers over the processors, so they don't all pile up on the boot processor.
+        u32 processor_count = min(Processor::count(), max_processors);
+        if (processor_count > 1)
+            handler->set_target_processor(s_next_target_processor++ % processor_count);
+        return handler;
+    }
+    return nullptr;
+}
+
+MSIHandler::MSIHandler(u8 interrupt_number, const char* purpose, Function<void()> callback)
+    : GenericInterruptHandler(interrupt_number, true)
+    , m_purpose(purpose)
+    , m_callback(move(callback))
+{
+}
+
+MSIHandler::~MSIHandler()
+{
+}
+
+void MSIHandler::handle_interrupt(const RegisterState&)
+{
+    m_callback();
+}
+
+void MSIHandler::set_message_writer(Function<void(u32 address, u16 data)> message_writer)
+{
+    m_message_writer = move(message_writer);
+    route_to_processor(target_processor());
+}
+
+bool MSIHandler::route_to_processor(u32 processor)
+{
+    // Each local APIC gets one bit of the logical destination, see APIC::enable().
+    // Fixed delivery mode, edge triggered.
+    if (m_message_writer)
+        m_message_writer(msi_address_base | ((1u << processor) << 12), vector());
+    return true;
+}
+
+bool MSIHandler::eoi()
+{
+    APIC::the().eoi();
+    return true;
+}
+
+}
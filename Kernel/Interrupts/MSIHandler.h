@@ -26,34 +26,47 @@
 
 #pragma once
 
+#include <AK/Function.h>
+#include <AK/OwnPtr.h>
 #include <AK/Types.h>
 #include <Kernel/Arch/i386/CPU.h>
 #include <Kernel/Interrupts/GenericInterruptHandler.h>
-#include <Kernel/PCI/Definitions.h>
 
 namespace Kernel {
 
+// Message signalled interrupts are written straight to the local APIC by the device, so each handler
+// owns an interrupt vector of its own instead of sharing an IRQ line routed through the IOAPIC.
 class MSIHandler final : public GenericInterruptHandler {
 public:
+    // Returns null if there's no APIC to deliver messages to, or every vector set aside for MSI is taken.
+    static OwnPtr<MSIHandler> try_create(const char* purpose, Function<void()> callback);
     virtual ~MSIHandler();
 
-    virtual void handle_interrupt(RegisterState&) override {}
+    u8 vector() const { return interrupt_number() + IRQ_VECTOR_BASE; }
 
-    void enable_irq();
-    void disable_irq();
+    // Tells the handler how to point its device at it, with the message address and data to write.
+    // It's called right away, and again whenever the interrupt is moved to another processor.
+    void set_message_writer(Function<void(u32 address, u16 data)>);
 
+    virtual void handle_interrupt(const RegisterState&) override;
     virtual bool eoi() override;
 
+    virtual HandlerType type() const override { return HandlerType::IRQHandler; }
+    virtual const char* purpose() const override { return m_purpose; }
+    virtual const char* controller() const override { return "MSI"; }
+
     virtual size_t sharing_devices_count() const override { return 0; }
     virtual bool is_shared_handler() const override { return false; }
-    virtual bool is_sharing_with_others() const override { return m_shared_with_others; }
-
-protected:
-    void change_irq_number(u8 irq);
-    explicit MSIHandler(PCI::Address);
+    virtual bool is_sharing_with_others() const override { return false; }
 
 private:
-    bool m_shared_with_others;
-    bool m_enabled;
+    MSIHandler(u8 interrupt_number, const char* purpose, Function<void()> callback);
+
+    virtual bool route_to_processor(u32 processor) override;
+
+    const char* m_purpose { nullptr };
+    Function<void()> m_callback;
+    Function<void(u32 address, u16 data)> m_message_writer;
 };
+
 }
@@ -111,6 +111,7 @@ public:
     void set_size(size_t size) { m_impl->set_size(size); }
 
     const KBufferImpl& impl() const { return m_impl; }
+    KBufferImpl& impl() { return m_impl; }
 
     KBuffer(const ByteBuffer& buffer, u8 access = Region::Access::Read | Region::Access::Write, const char* name = "KBuffer")
         : m_impl(KBufferImpl::copy(buffer.data(), buffer.size(), access, name))
@@ -26,6 +26,7 @@
 
 #pragma once
 
+#include <AK/Format.h>
 #include <AK/String.h>
 #include <Kernel/KBuffer.h>
 #include <stdarg.h>
@@ -45,6 +46,14 @@ public:
     void appendf(const char*, ...);
     void appendvf(const char*, va_list);
 
+    template<typename... Parameters>
+    void appendff(CheckedFormatStringFor<Parameters...>&& fmtstr, const Parameters&... parameters)
+    {
+        AK::TypeErasedParameter type_erased_parameters[] = { AK::make_type_erased_parameter(parameters)..., {} };
+        FormatOutput output(*this);
+        AK::vformat(output, fmtstr.view(), type_erased_parameters, sizeof...(Parameters));
+    }
+
     KBuffer build();
 
 private:
@@ -24,6 +24,7 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <AK/HashFunctions.h>
 #include <AK/TemporaryChange.h>
 #include <Kernel/KSyms.h>
 #include <Kernel/Lock.h>
@@ -42,7 +43,86 @@ static bool modes_conflict(Lock::Mode mode1, Lock::Mode mode2)
     return true;
 }
 
-void Lock::lock(Mode mode)
+LockStatistics Lock::s_lock_statistics[max_lock_statistics];
+Atomic<u32> Lock::s_acquisitions[max_processors][max_lock_statistics];
+
+LockStatistics& Lock::statistics_for_name(const char* name)
+{
+    if (!name)
+        name = "(unnamed)";
+    // Lock names are almost always string literals, so keying on the pointer is good enough.
+    // Duplicates of the same name from different translation units get folded together by readers.
+    size_t start = ptr_hash((FlatPtr)name) % max_lock_statistics;
+    for (size_t i = 0; i < max_lock_statistics; ++i) {
+        auto& statistics = s_lock_statistics[(start + i) % max_lock_statistics];
+        const char* expected = nullptr;
+        if (statistics.name == name || AK::atomic_compare_exchange_strong(&statistics.name, expected, name) || expected == name)
+            return statistics;
+    }
+    // The table is full, so lump everyone else into the last slot we looked at.
+    return s_lock_statistics[(start + max_lock_statistics - 1) % max_lock_statistics];
+}
+
+LockStatistics& Lock::statistics()
+{
+    if (!m_statistics)
+        m_statistics = &statistics_for_name(m_name);
+    return *m_statistics;
+}
+
+u32 Lock::acquisitions_for(const LockStatistics& statistics)
+{
+    size_t index = &statistics - s_lock_statistics;
+    u32 acquisitions = 0;
+    for (u32 processor = 0; processor < max_processors; ++processor)
+        acquisitions += s_acquisitions[processor][index].load(AK::memory_order_relaxed);
+    return acquisitions;
+}
+
+// The guard is only ever held for a handful of instructions, so spin on it for
+// a while before giving up the CPU to whoever holds it.
+void Lock::acquire_guard()
+{
+    static constexpr int spins_before_yielding = 100;
+    for (;;) {
+        for (int i = 0; i < spins_before_yielding; ++i) {
+            bool expected = false;
+            if (m_lock.compare_exchange_strong(expected, true, AK::memory_order_acq_rel))
+                return;
+            Processor::wait_check();
+        }
+
+        // The assumption is that if we call this from a critical section
+        // that we DO want to temporarily leave it
+        u32 prev_flags;
+        u32 prev_crit = Processor::current().clear_critical(prev_flags, !Processor::current().in_irq());
+
+        Scheduler::yield();
+
+        // Note, we may now be on a different CPU!
+        Processor::current().restore_critical(prev_crit, prev_flags);
+    }
+}
+
+// NOTE: The caller must hold the guard, and the lock must have just become unlocked.
+void Lock::wake_waiters_and_release_guard()
+{
+    ASSERT(m_lock.load());
+    ASSERT(m_mode == Mode::Unlocked);
+    if (m_exclusive_waiters) {
+        m_exclusive_handoff_pending = true;
+        m_exclusive_queue.wake_one(&m_lock);
+        return;
+    }
+    if (m_shared_waiters) {
+        m_lock.store(false, AK::memory_order_release);
+        m_shared_queue.wake_all();
+        return;
+    }
+    m_lock.store(false, AK::memory_order_release);
+}
+
+void Lock::lock(Mode mode, [[maybe_unused]] const char* file, [[maybe_unused]] u32 line)
 {
     ASSERT(mode != Mode::Unlocked);
     if (!are_interrupts_enabled()) {
@@ -51,35 +131,68 @@ void Lock::lock(Mode mode)
         Processor::halt();
     }
     auto current_thread = Thread::current();
+    auto& statistics = this->statistics();
+    // We may be moved to another processor in the meantime, which only costs a cache miss.
+    u32 processor = Processor::current().id();
+    if (processor < max_processors)
+        s_acquisitions[processor][&statistics - s_lock_statistics].fetch_add(1, AK::memory_order_relaxed);
+
+    bool has_waited = false;
+    bool is_waiting = false;
+#ifdef LOCK_STATISTICS
+    u64 started_at = read_tsc();
+#endif
     for (;;) {
-        bool expected = false;
-        if (m_lock.compare_exchange_strong(expected, true, AK::memory_order_acq_rel)) {
-            do {
-                // FIXME: Do not add new readers if writers are queued.
-                bool modes_dont_conflict = !modes_conflict(m_mode, mode);
-                bool already_hold_exclusive_lock = m_mode == Mode::Exclusive && m_holder == current_thread;
-                if (modes_dont_conflict || already_hold_exclusive_lock) {
-                    // We got the lock!
-                    if (!already_hold_exclusive_lock)
-                        m_mode = mode;
-                    m_holder = current_thread;
-                    m_times_locked++;
-                    m_lock.store(false, AK::memory_order_release);
-                    return;
+        acquire_guard();
+        if (is_waiting) {
+            --(mode == Mode::Exclusive ? m_exclusive_waiters : m_shared_waiters);
+            is_waiting = false;
+        }
+        for (;;) {
+            // FIXME: Do not add new readers if writers are queued.
+            bool modes_dont_conflict = !modes_conflict(m_mode, mode);
+            bool already_hold_exclusive_lock = m_mode == Mode::Exclusive && m_holder == current_thread;
+            // Only a thread that was woken up may take a lock that's being handed off to an exclusive waiter.
+            if (m_mode == Mode::Unlocked && m_exclusive_handoff_pending) {
+                if (has_waited && mode == Mode::Exclusive)
+                    m_exclusive_handoff_pending = false;
+                else
+                    modes_dont_conflict = false;
+            }
+            if (modes_dont_conflict || already_hold_exclusive_lock) {
+                // We got the lock!
+                if (!already_hold_exclusive_lock)
+                    m_mode = mode;
+                m_holder = current_thread;
+                m_times_locked++;
+#ifdef LOCK_STATISTICS
+                auto& site = LockContention::site_for("Lock", file, line);
+                u64 now = read_tsc();
+                if (mode == Mode::Exclusive && m_times_locked == 1) {
+                    m_site = &site;
+                    m_acquired_at = now;
                 }
-             } while (current_thread->wait_on(m_queue, m_name, nullptr, &m_lock, m_holder) == Thread::BlockResult::NotBlocked);
-        } else if (Processor::current().in_critical()) {
-            // If we're in a critical section and trying to lock, no context
-            // switch will happen, so yield.
-            // The assumption is that if we call this from a critical section
-            // that we DO want to temporarily leave it
-            u32 prev_flags;
-            u32 prev_crit = Processor::current().clear_critical(prev_flags, !Processor::current().in_irq());
-
-            Scheduler::yield();
-
-            // Note, we may now be on a different CPU!
-            Processor::current().restore_critical(prev_crit, prev_flags);
+#endif
+                m_lock.store(false, AK::memory_order_release);
+                if (has_waited)
+                    statistics.contentions.fetch_add(1, AK::memory_order_relaxed);
+#ifdef LOCK_STATISTICS
+                LockContention::did_acquire(site, has_waited, now - started_at);
+#endif
+                return;
+            }
+
+            auto& queue = mode == Mode::Exclusive ? m_exclusive_queue : m_shared_queue;
+            auto& waiters = mode == Mode::Exclusive ? m_exclusive_waiters : m_shared_waiters;
+            ++waiters;
+            if (current_thread->wait_on(queue, m_name, nullptr, &m_lock, m_holder) != Thread::BlockResult::NotBlocked) {
+                // We slept and the guard was released for us; take it again and have another look.
+                has_waited = true;
+                is_waiting = true;
+                break;
+            }
+            // A wakeup was already pending on the queue, and we still hold the guard.
+            --waiters;
         }
     }
 }
@@ -87,37 +200,29 @@ void Lock::lock(Mode mode)
 void Lock::unlock()
 {
     auto current_thread = Thread::current();
-    for (;;) {
-        bool expected = false;
-        if (m_lock.compare_exchange_strong(expected, true, AK::memory_order_acq_rel)) {
-            ASSERT(m_times_locked);
-            --m_times_locked;
-
-            ASSERT(m_mode != Mode::Unlocked);
-            if (m_mode == Mode::Exclusive)
-                ASSERT(m_holder == current_thread);
-            if (m_holder == current_thread && (m_mode == Mode::Shared || m_times_locked == 0))
-                m_holder = nullptr;
-
-            if (m_times_locked > 0) {
-                m_lock.store(false, AK::memory_order_release);
-                return;
-            }
-            m_mode = Mode::Unlocked;
-            m_queue.wake_one(&m_lock);
-            return;
-        }
-        // I don't know *who* is using "m_lock", so just yield.
-        // The assumption is that if we call this from a critical section
-        // that we DO want to temporarily leave it
-        u32 prev_flags;
-        u32 prev_crit = Processor::current().clear_critical(prev_flags, false);
+    acquire_guard();
 
-        Scheduler::yield();
+    ASSERT(m_times_locked);
+    --m_times_locked;
 
-        // Note, we may now be on a different CPU!
-        Processor::current().restore_critical(prev_crit, prev_flags);
+    ASSERT(m_mode != Mode::Unlocked);
+    if (m_mode == Mode::Exclusive)
+        ASSERT(m_holder == current_thread);
+    if (m_holder == current_thread && (m_mode == Mode::Shared || m_times_locked == 0))
+        m_holder = nullptr;
+
+    if (m_times_locked > 0) {
+        m_lock.store(false, AK::memory_order_release);
+        return;
+    }
+#ifdef LOCK_STATISTICS
+    if (m_mode == Mode::Exclusive && m_site) {
+        LockContention::did_release(*m_site, read_tsc() - m_acquired_at);
+        m_site = nullptr;
     }
+#endif
+    m_mode = Mode::Unlocked;
+    wake_waiters_and_release_guard();
 }
 
 bool Lock::force_unlock_if_locked()
@@ -127,10 +232,11 @@ bool Lock::force_unlock_if_locked()
     if (m_holder != Thread::current())
         return false;
     ASSERT(m_times_locked == 1);
+    acquire_guard();
     m_holder = nullptr;
     m_mode = Mode::Unlocked;
     m_times_locked = 0;
-    m_queue.wake_one();
+    wake_waiters_and_release_guard();
     return true;
 }
 
@@ -138,7 +244,8 @@ void Lock::clear_waiters()
 {
     ASSERT(m_mode != Mode::Shared);
     ScopedCritical critical;
-    m_queue.clear();
+    m_shared_queue.clear();
+    m_exclusive_queue.clear();
 }
 
 }
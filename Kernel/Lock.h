@@ -31,10 +31,17 @@
 #include <AK/Types.h>
 #include <Kernel/Arch/i386/CPU.h>
 #include <Kernel/Forward.h>
+#include <Kernel/LockContention.h>
 #include <Kernel/WaitQueue.h>
 
 namespace Kernel {
 
+struct LockStatistics {
+    const char* name { nullptr };
+    // Acquisitions that had to sleep before they got the lock. All of them are counted by Lock::acquisitions_for().
+    Atomic<u32> contentions { 0 };
+};
+
 class Lock {
 public:
     Lock(const char* name = nullptr)
@@ -49,7 +56,8 @@ public:
         Exclusive
     };
 
-    void lock(Mode = Mode::Exclusive);
+    // The call site only matters with LOCK_STATISTICS
+    void lock(Mode = Mode::Exclusive, const char* file = __builtin_FILE(), u32 line = __builtin_LINE());
     void unlock();
     bool force_unlock_if_locked();
     bool is_locked() const { return m_holder; }
@@ -57,10 +65,48 @@ public:
 
     const char* name() const { return m_name; }
 
+    // Calls callback for the statistics of every lock name that has been taken so far.
+    template<typename Callback>
+    static void for_each_statistics(Callback callback)
+    {
+        for (size_t i = 0; i < max_lock_statistics; ++i) {
+            auto& statistics = s_lock_statistics[i];
+            if (statistics.name)
+                callback(statistics);
+        }
+    }
+
+    static u32 acquisitions_for(const LockStatistics&);
+
 private:
+    static constexpr size_t max_lock_statistics = 512;
+    static LockStatistics s_lock_statistics[max_lock_statistics];
+
+    // Every acquisition is counted, so each processor counts into a row of its own rather than
+    // all of them bouncing the same cache line around. Contentions are rare enough not to bother.
+    static constexpr u32 max_processors = 32;
+    static Atomic<u32> s_acquisitions[max_processors][max_lock_statistics];
+    static LockStatistics& statistics_for_name(const char*);
+
+    LockStatistics& statistics();
+    void acquire_guard();
+    void wake_waiters_and_release_guard();
+
     Atomic<bool> m_lock { false };
     const char* m_name { nullptr };
-    WaitQueue m_queue;
+    LockStatistics* m_statistics { nullptr };
+
+    // Threads sleep on the queue for the mode they asked for, so that unlock() can wake
+    // either one writer or every reader at once.
+    WaitQueue m_shared_queue;
+    WaitQueue m_exclusive_queue;
+    u32 m_shared_waiters { 0 };
+    u32 m_exclusive_waiters { 0 };
+
+    // Set when unlock() has woken an exclusive waiter; until one of the woken threads
+    // takes the lock, newcomers queue up behind it instead of barging in.
+    bool m_exclusive_handoff_pending { false };
+
     Mode m_mode { Mode::Unlocked };
 
     // When locked exclusively, only the thread already holding the lock can
@@ -73,18 +119,24 @@ private:
     // When locked exclusively, this is always the one thread that holds the
     // lock.
     Thread* m_holder { nullptr };
+
+#ifdef LOCK_STATISTICS
+    // Only exclusive holds are timed; shared ones overlap.
+    LockContention::Site* m_site { nullptr };
+    u64 m_acquired_at { 0 };
+#endif
 };
 
 class Locker {
 public:
-    ALWAYS_INLINE explicit Locker(Lock& l, Lock::Mode mode = Lock::Mode::Exclusive)
+    ALWAYS_INLINE explicit Locker(Lock& l, Lock::Mode mode = Lock::Mode::Exclusive, const char* file = __builtin_FILE(), u32 line = __builtin_LINE())
         : m_lock(l)
     {
-        m_lock.lock(mode);
+        m_lock.lock(mode, file, line);
     }
     ALWAYS_INLINE ~Locker() { unlock(); }
     ALWAYS_INLINE void unlock() { m_lock.unlock(); }
-    ALWAYS_INLINE void lock(Lock::Mode mode = Lock::Mode::Exclusive) { m_lock.lock(mode); }
+    ALWAYS_INLINE void lock(Lock::Mode mode = Lock::Mode::Exclusive, const char* file = __builtin_FILE(), u32 line = __builtin_LINE()) { m_lock.lock(mode, file, line); }
 
 private:
     Lock& m_lock;
@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <AK/HashFunctions.h>
+#include <Kernel/Arch/i386/CPU.h>
+#include <Kernel/LockContention.h>
+
+#ifdef LOCK_STATISTICS
+
+namespace Kernel {
+namespace LockContention {
+
+enum SiteState : u32 {
+    Unused,
+    Claimed,
+    Ready,
+};
+
+static Site s_sites[max_site_count];
+
+Site* sites()
+{
+    return s_sites;
+}
+
+Site& site_for(const char* kind, const char* file, u32 line)
+{
+    // File names come from __builtin_FILE(), so keying on their address is good enough.
+    size_t start = pair_int_hash(ptr_hash((FlatPtr)file), line) % max_site_count;
+    for (size_t i = 0; i < max_site_count; ++i) {
+        auto& site = s_sites[(start + i) % max_site_count];
+        u32 state = site.state.load(AK::memory_order_acquire);
+        if (state == Unused) {
+            u32 expected = Unused;
+            if (site.state.compare_exchange_strong(expected, Claimed, AK::memory_order_acq_rel)) {
+                site.kind = kind;
+                site.file = file;
+                site.line = line;
+                site.state.store(Ready, AK::memory_order_release);
+                return site;
+            }
+            state = expected;
+        }
+        // Someone else is filling this slot in, and it may well be for the same site.
+        while (state == Claimed) {
+            Processor::wait_check();
+            state = site.state.load(AK::memory_order_acquire);
+        }
+        if (site.file == file && site.line == line && site.kind == kind)
+            return site;
+    }
+    // The table is full, so lump everyone else into the last slot we looked at.
+    return s_sites[(start + max_site_count - 1) % max_site_count];
+}
+
+static void lock_guard(const Site& const_site)
+{
+    auto& site = const_cast<Site&>(const_site);
+    bool expected = false;
+    while (!site.guard.compare_exchange_strong(expected, true, AK::memory_order_acquire)) {
+        Processor::wait_check();
+        expected = false;
+    }
+}
+
+static void unlock_guard(const Site& const_site)
+{
+    auto& site = const_cast<Site&>(const_site);
+    site.guard.store(false, AK::memory_order_release);
+}
+
+void did_acquire(Site& site, bool contended, u64 wait_cycles)
+{
+    site.acquisitions.fetch_add(1, AK::memory_order_relaxed);
+    if (!contended)
+        return;
+    site.contentions.fetch_add(1, AK::memory_order_relaxed);
+    lock_guard(site);
+    site.total_wait_cycles += wait_cycles;
+    unlock_guard(site);
+}
+
+void did_release(Site& site, u64 hold_cycles)
+{
+    // Racy, but it only lets us skip the guard when there's clearly nothing to do.
+    if (hold_cycles <= site.max_hold_cycles)
+        return;
+    lock_guard(site);
+    if (hold_cycles > site.max_hold_cycles)
+        site.max_hold_cycles = hold_cycles;
+    unlock_guard(site);
+}
+
+void read_cycles(const Site& site, u64& total_wait_cycles, u64& max_hold_cycles)
+{
+    lock_guard(site);
+    total_wait_cycles = site.total_wait_cycles;
+    max_hold_cycles = site.max_hold_cycles;
+    unlock_guard(site);
+}
+
+}
+}
+
+#endif
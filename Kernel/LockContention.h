@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/Atomic.h>
+#include <AK/Types.h>
+
+// Uncomment to account every SpinLock, RecursiveSpinLock and Lock acquisition to the
+// place in the code it came from, and report them in /proc/lockstat.
+//#define LOCK_STATISTICS
+
+namespace Kernel {
+namespace LockContention {
+
+// Times are in TSC cycles, since that's all we can afford to read while spinning.
+struct Site {
+    Atomic<u32> state { 0 };
+    const char* kind { nullptr };
+    const char* file { nullptr };
+    u32 line { 0 };
+
+    Atomic<u32> acquisitions { 0 };
+    Atomic<u32> contentions { 0 };
+    // The 64-bit numbers can't be updated atomically, so they have a guard of their own.
+    Atomic<bool> guard { false };
+    u64 total_wait_cycles { 0 };
+    u64 max_hold_cycles { 0 };
+};
+
+constexpr size_t max_site_count = 1024;
+
+// Neither of these take any locks, so they can be called from inside the lock implementations.
+Site& site_for(const char* kind, const char* file, u32 line);
+void did_acquire(Site&, bool contended, u64 wait_cycles);
+void did_release(Site&, u64 hold_cycles);
+void read_cycles(const Site&, u64& total_wait_cycles, u64& max_hold_cycles);
+
+Site* sites();
+
+template<typename Callback>
+void for_each_site(Callback callback)
+{
+    auto* all_sites = sites();
+    for (size_t i = 0; i < max_site_count; ++i) {
+        if (all_sites[i].state.load(AK::memory_order_acquire) == 2)
+            callback(const_cast<const Site&>(all_sites[i]));
+    }
+}
+
+}
+}
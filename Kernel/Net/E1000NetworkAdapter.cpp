@@ -24,6 +24,7 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <Kernel/CommandLine.h>
 #include <Kernel/Net/E1000NetworkAdapter.h>
 #include <Kernel/Thread.h>
 #include <Kernel/IO.h>
@@ -57,6 +58,7 @@ namespace Kernel {
 #define REG_RADV 0x282C             // RX Int. Absolute Delay Timer
 #define REG_RSRPD 0x2C00            // RX Small Packet Detect Interrupt
 #define REG_TIPG 0x0410             // Transmit Inter Packet Gap
+#define REG_RXCSUM 0x5000           // RX Checksum Control
 #define ECTRL_SLU 0x40              //set link up
 #define RCTL_EN (1 << 1)            // Receiver Enable
 #define RCTL_SBP (1 << 2)           // Store Bad Packets
@@ -98,6 +100,27 @@ namespace Kernel {
 #define CMD_RPS (1 << 4)  // Report Packet Sent
 #define CMD_VLE (1 << 6)  // VLAN Packet Enable
 #define CMD_IDE (1 << 7)  // Interrupt Delay Enable
+#define CMD_DEXT (1 << 5) // Extended descriptor (context or data)
+
+// Extended TX descriptors
+
+#define DTYP_CONTEXT (0 << 4)   // Descriptor type, in the bits that are CSO in a legacy descriptor
+#define DTYP_DATA (1 << 4)
+#define POPTS_TXSM (1 << 1)     // Insert TCP/UDP checksum, in the byte that is CSS in a legacy descriptor
+
+// RXCSUM Register
+
+#define RXCSUM_IPOFL (1 << 8) // IP checksum offload
+#define RXCSUM_TUOFL (1 << 9) // TCP/UDP checksum offload
+
+// RX descriptor status and errors
+
+#define RSTA_DD (1 << 0)    // Descriptor Done
+#define RSTA_IXSM (1 << 2)  // Ignore checksum indication
+#define RSTA_TCPCS (1 << 5) // TCP/UDP checksum calculated
+#define RSTA_IPCS (1 << 6)  // IP checksum calculated
+#define RERR_TCPE (1 << 5)  // TCP/UDP checksum error
+#define RERR_IPE (1 << 6)   // IP checksum error
 
 // TCTL Register
 
@@ -156,7 +179,6 @@ void E1000NetworkAdapter::detect()
 E1000NetworkAdapter::E1000NetworkAdapter(PCI::Address address, u8 irq)
     : PCI::Device(address, irq)
     , m_io_base(PCI::get_BAR1(pci_address()) & ~1)
-    , m_rx_descriptors_region(MM.allocate_contiguous_kernel_region(PAGE_ROUND_UP(sizeof(e1000_rx_desc) * number_of_rx_descriptors + 16), "E1000 RX", Region::Access::Read | Region::Access::Write))
     , m_tx_descriptors_region(MM.allocate_contiguous_kernel_region(PAGE_ROUND_UP(sizeof(e1000_tx_desc) * number_of_tx_descriptors + 16), "E1000 TX", Region::Access::Read | Region::Access::Write))
 {
     set_interface_name("e1k");
@@ -184,12 +206,17 @@ E1000NetworkAdapter::E1000NetworkAdapter(PCI::Address address, u8 irq)
     out32(REG_CTRL, flags | ECTRL_SLU);
 
     out16(REG_INTERRUPT_RATE, 6000); // Interrupt rate of 1.536 milliseconds
+    // Hold back the receive interrupt until the link has been quiet for 32 microseconds,
+    // but never for more than 128 microseconds after the first frame came in.
+    out32(REG_RDTR, 32);
+    out32(REG_RADV, 128);
 
     initialize_rx_descriptors();
     initialize_tx_descriptors();
+    set_transmit_checksum_offload(true);
 
-    out32(REG_INTERRUPT_MASK_SET, 0x1f6dc);
-    out32(REG_INTERRUPT_MASK_SET, INTERRUPT_LSC | INTERRUPT_RXT0);
+    out32(REG_INTERRUPT_MASK_CLEAR, 0xffffffff);
+    out32(REG_INTERRUPT_MASK_SET, INTERRUPT_TXDW | INTERRUPT_LSC | INTERRUPT_RXT0 | INTERRUPT_RXO);
     in32(REG_INTERRUPT_CAUSE_READ);
 
     enable_irq();
@@ -201,26 +228,30 @@ E1000NetworkAdapter::~E1000NetworkAdapter()
 
 void E1000NetworkAdapter::handle_irq(const RegisterState&)
 {
-    out32(REG_INTERRUPT_MASK_CLEAR, 0xffffffff);
-
     u32 status = in32(REG_INTERRUPT_CAUSE_READ);
 
     m_entropy_source.add_random_event(status);
 
-    if (status & 4) {
+    if (status & INTERRUPT_LSC) {
         u32 flags = in32(REG_CTRL);
         out32(REG_CTRL, flags | ECTRL_SLU);
     }
-    if (status & 0x80) {
-        receive();
-    }
-    if (status & 0x10) {
-        // Threshold OK?
+    if (status & (INTERRUPT_RXT0 | INTERRUPT_RXO)) {
+        // Leave the receive interrupts off until NetworkTask has emptied the RX ring.
+        out32(REG_INTERRUPT_MASK_CLEAR, INTERRUPT_RXT0 | INTERRUPT_RXO);
+        schedule_receive_poll();
     }
 
     m_wait_queue.wake_all();
+}
 
-    out32(REG_INTERRUPT_MASK_SET, INTERRUPT_LSC | INTERRUPT_RXT0 | INTERRUPT_RXO);
+size_t E1000NetworkAdapter::rx_descriptor_count_from_command_line()
+{
+    if (auto descriptors = kernel_command_line().lookup("e1000_rx_descriptors"); descriptors.has_value()) {
+        if (auto count = descriptors.value().to_uint(); count.has_value())
+            return clamp<size_t>(round_up_to_power_of_two(count.value(), 8), 8, max_number_of_rx_descriptors);
+    }
+    return default_number_of_rx_descriptors;
 }
 
 void E1000NetworkAdapter::detect_eeprom()
@@ -279,23 +310,26 @@ bool E1000NetworkAdapter::link_up()
 
 void E1000NetworkAdapter::initialize_rx_descriptors()
 {
-    auto* rx_descriptors = (e1000_tx_desc*)m_rx_descriptors_region->vaddr().as_ptr();
-    for (size_t i = 0; i < number_of_rx_descriptors; ++i) {
+    m_number_of_rx_descriptors = rx_descriptor_count_from_command_line();
+    klog() << "E1000: Using " << m_number_of_rx_descriptors << " RX descriptors";
+    m_rx_descriptors_region = MM.allocate_contiguous_kernel_region(PAGE_ROUND_UP(sizeof(e1000_rx_desc) * m_number_of_rx_descriptors + 16), "E1000 RX", Region::Access::Read | Region::Access::Write);
+    ASSERT(m_rx_descriptors_region);
+    auto* rx_descriptors = (e1000_rx_desc*)m_rx_descriptors_region->vaddr().as_ptr();
+    for (size_t i = 0; i < m_number_of_rx_descriptors; ++i) {
         auto& descriptor = rx_descriptors[i];
-        auto region = MM.allocate_contiguous_kernel_region(8192, "E1000 RX buffer", Region::Access::Read | Region::Access::Write);
-        ASSERT(region);
-        m_rx_buffers_regions.append(region.release_nonnull());
-        descriptor.addr = m_rx_buffers_regions[i].physical_page(0)->paddr().get();
+        m_rx_buffers.append(take_packet_buffer());
+        descriptor.addr = m_rx_buffers[i].impl().region().physical_page(0)->paddr().get();
         descriptor.status = 0;
     }
 
     out32(REG_RXDESCLO, m_rx_descriptors_region->physical_page(0)->paddr().get());
     out32(REG_RXDESCHI, 0);
-    out32(REG_RXDESCLEN, number_of_rx_descriptors * sizeof(e1000_rx_desc));
+    out32(REG_RXDESCLEN, m_number_of_rx_descriptors * sizeof(e1000_rx_desc));
     out32(REG_RXDESCHEAD, 0);
-    out32(REG_RXDESCTAIL, number_of_rx_descriptors - 1);
+    out32(REG_RXDESCTAIL, m_number_of_rx_descriptors - 1);
 
-    out32(REG_RCTRL, RCTL_EN | RCTL_SBP | RCTL_UPE | RCTL_MPE | RCTL_LBM_NONE | RTCL_RDMTS_HALF | RCTL_BAM | RCTL_SECRC | RCTL_BSIZE_8192);
+    out32(REG_RXCSUM, RXCSUM_IPOFL | RXCSUM_TUOFL);
+    out32(REG_RCTRL, RCTL_EN | RCTL_SBP | RCTL_UPE | RCTL_MPE | RCTL_LBM_NONE | RTCL_RDMTS_HALF | RCTL_BAM | RCTL_SECRC | RCTL_BSIZE_4096);
 }
 
 void E1000NetworkAdapter::initialize_tx_descriptors()
@@ -390,20 +424,66 @@ u32 E1000NetworkAdapter::in32(u16 address)
 }
 
 void E1000NetworkAdapter::send_raw(ReadonlyBytes payload)
+{
+    transmit(payload, false);
+}
+
+void E1000NetworkAdapter::send_raw_with_checksum(Bytes frame, size_t checksum_start, size_t checksum_offset)
+{
+    if (checksum_start > 0xff || checksum_offset > 0xff) {
+        NetworkAdapter::send_raw_with_checksum(frame, checksum_start, checksum_offset);
+        return;
+    }
+    if (!m_has_tx_checksum_context || m_tx_checksum_start != checksum_start || m_tx_checksum_offset != checksum_offset) {
+        m_has_tx_checksum_context = true;
+        m_tx_checksum_start = checksum_start;
+        m_tx_checksum_offset = checksum_offset;
+        m_tx_checksum_context_pending = true;
+    }
+    transmit(frame, true);
+}
+
+void E1000NetworkAdapter::transmit(ReadonlyBytes payload, bool insert_checksum)
 {
     disable_irq();
     size_t tx_current = in32(REG_TXDESCTAIL) % number_of_tx_descriptors;
 #ifdef E1000_DEBUG
-    klog() << "E1000: Sending packet (" << length << " bytes)";
+    klog() << "E1000: Sending packet (" << payload.size() << " bytes)";
 #endif
     auto* tx_descriptors = (e1000_tx_desc*)m_tx_descriptors_region->vaddr().as_ptr();
+    if (insert_checksum && m_tx_checksum_context_pending) {
+        // The hardware remembers the checksum context, so it only has to be sent when it changes.
+        auto& context = *(e1000_tx_context_desc*)&tx_descriptors[tx_current];
+        context.ipcss = 0;
+        context.ipcso = 0;
+        context.ipcse = 0;
+        context.tucss = m_tx_checksum_start;
+        context.tucso = m_tx_checksum_offset;
+        context.tucse = 0;
+        context.command_and_length = (CMD_DEXT << 24) | (DTYP_CONTEXT << 16);
+        context.status = 0;
+        context.header_length = 0;
+        context.mss = 0;
+        m_tx_checksum_context_pending = false;
+        tx_current = (tx_current + 1) % number_of_tx_descriptors;
+    }
     auto& descriptor = tx_descriptors[tx_current];
     ASSERT(payload.size() <= 8192);
     auto* vptr = (void*)m_tx_buffers_regions[tx_current].vaddr().as_ptr();
     memcpy(vptr, payload.data(), payload.size());
+    // A context descriptor may have been written over this slot before.
+    descriptor.addr = m_tx_buffers_regions[tx_current].physical_page(0)->paddr().get();
     descriptor.length = payload.size();
     descriptor.status = 0;
-    descriptor.cmd = CMD_EOP | CMD_IFCS | CMD_RS;
+    if (insert_checksum) {
+        descriptor.cso = DTYP_DATA;
+        descriptor.css = POPTS_TXSM;
+        descriptor.cmd = CMD_EOP | CMD_IFCS | CMD_RS | CMD_DEXT;
+    } else {
+        descriptor.cso = 0;
+        descriptor.css = 0;
+        descriptor.cmd = CMD_EOP | CMD_IFCS | CMD_RS;
+    }
 #ifdef E1000_DEBUG
     klog() << "E1000: Using tx descriptor " << tx_current << " (head is at " << in32(REG_TXDESCHEAD) << ")";
 #endif
@@ -423,27 +503,54 @@ void E1000NetworkAdapter::send_raw(ReadonlyBytes payload)
 #endif
 }
 
-void E1000NetworkAdapter::receive()
+bool E1000NetworkAdapter::has_bad_checksum(const e1000_rx_desc& descriptor)
+{
+    if (descriptor.status & RSTA_IXSM)
+        return false;
+    if ((descriptor.status & RSTA_IPCS) && (descriptor.errors & RERR_IPE))
+        return true;
+    return (descriptor.status & RSTA_TCPCS) && (descriptor.errors & RERR_TCPE);
+}
+
+bool E1000NetworkAdapter::poll_receive(size_t budget)
 {
-    auto* rx_descriptors = (e1000_tx_desc*)m_rx_descriptors_region->vaddr().as_ptr();
+    auto* rx_descriptors = (e1000_rx_desc*)m_rx_descriptors_region->vaddr().as_ptr();
     u32 rx_current;
-    for (;;) {
-        rx_current = in32(REG_RXDESCTAIL) % number_of_rx_descriptors;
-        if (rx_current == (in32(REG_RXDESCHEAD) % number_of_rx_descriptors))
-            return;
-        rx_current = (rx_current + 1) % number_of_rx_descriptors;
-        if (!(rx_descriptors[rx_current].status & 1))
+    for (size_t received = 0;; ++received) {
+        if (received == budget)
+            return true;
+        rx_current = in32(REG_RXDESCTAIL) % m_number_of_rx_descriptors;
+        if (rx_current == (in32(REG_RXDESCHEAD) % m_number_of_rx_descriptors))
+            break;
+        rx_current = (rx_current + 1) % m_number_of_rx_descriptors;
+        auto& descriptor = rx_descriptors[rx_current];
+        if (!(descriptor.status & RSTA_DD))
             break;
-        auto* buffer = m_rx_buffers_regions[rx_current].vaddr().as_ptr();
-        u16 length = rx_descriptors[rx_current].length;
-        ASSERT(length <= 8192);
+        u16 length = descriptor.length;
+        ASSERT(length <= packet_buffer_size());
+        if (has_bad_checksum(descriptor)) {
+            // The frame was damaged on the way, so it's dropped here and the buffer stays in the ring.
 #ifdef E1000_DEBUG
-        klog() << "E1000: Received 1 packet @ " << buffer << " (" << length << ") bytes!";
+            klog() << "E1000: Dropping packet with bad checksum (status " << String::format("%b", descriptor.status) << ", errors " << String::format("%b", descriptor.errors) << ")";
 #endif
-        did_receive({ buffer, length });
-        rx_descriptors[rx_current].status = 0;
+            descriptor.status = 0;
+            out32(REG_RXDESCTAIL, rx_current);
+            continue;
+        }
+#ifdef E1000_DEBUG
+        klog() << "E1000: Received 1 packet @ " << m_rx_buffers[rx_current].data() << " (" << length << ") bytes!";
+#endif
+        // Hand the filled buffer up the stack and give the descriptor a fresh one.
+        auto buffer = take_packet_buffer();
+        swap(buffer, m_rx_buffers[rx_current]);
+        rx_descriptors[rx_current].addr = m_rx_buffers[rx_current].impl().region().physical_page(0)->paddr().get();
+        did_receive(PacketBuffer(buffer, length));
+        descriptor.status = 0;
         out32(REG_RXDESCTAIL, rx_current);
     }
+    // Frames that arrived after we looked have already latched an interrupt cause, so they fire as soon as this is unmasked.
+    out32(REG_INTERRUPT_MASK_SET, INTERRUPT_RXT0 | INTERRUPT_RXO);
+    return false;
 }
 
 }
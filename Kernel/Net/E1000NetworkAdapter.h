@@ -46,6 +46,7 @@ public:
     virtual ~E1000NetworkAdapter() override;
 
     virtual void send_raw(ReadonlyBytes) override;
+    virtual void send_raw_with_checksum(Bytes, size_t checksum_start, size_t checksum_offset) override;
     virtual bool link_up() override;
 
     virtual const char* purpose() const override { return class_name(); }
@@ -53,6 +54,7 @@ public:
 private:
     virtual void handle_irq(const RegisterState&) override;
     virtual const char* class_name() const override { return "E1000NetworkAdapter"; }
+    virtual bool poll_receive(size_t budget) override;
 
     struct [[gnu::packed]] e1000_rx_desc
     {
@@ -75,6 +77,26 @@ private:
         volatile uint16_t special { 0 };
     };
 
+    // Written into a TX descriptor slot ahead of checksum offloaded data descriptors.
+    struct [[gnu::packed]] e1000_tx_context_desc
+    {
+        volatile uint8_t ipcss { 0 };
+        volatile uint8_t ipcso { 0 };
+        volatile uint16_t ipcse { 0 };
+        volatile uint8_t tucss { 0 };
+        volatile uint8_t tucso { 0 };
+        volatile uint16_t tucse { 0 };
+        volatile uint32_t command_and_length { 0 };
+        volatile uint8_t status { 0 };
+        volatile uint8_t header_length { 0 };
+        volatile uint16_t mss { 0 };
+    };
+
+    static_assert(sizeof(e1000_tx_context_desc) == sizeof(e1000_tx_desc));
+
+    void transmit(ReadonlyBytes, bool insert_checksum);
+    static bool has_bad_checksum(const e1000_rx_desc&);
+
     void detect_eeprom();
     u32 read_eeprom(u8 address);
     void read_mac_address();
@@ -92,13 +114,14 @@ private:
     u16 in16(u16 address);
     u32 in32(u16 address);
 
-    void receive();
+    static size_t rx_descriptor_count_from_command_line();
 
     IOAddress m_io_base;
     VirtualAddress m_mmio_base;
     OwnPtr<Region> m_rx_descriptors_region;
     OwnPtr<Region> m_tx_descriptors_region;
-    NonnullOwnPtrVector<Region> m_rx_buffers_regions;
+    // The adapter DMAs straight into pooled packet buffers, which are passed on as they are and replaced with fresh ones.
+    Vector<KBuffer> m_rx_buffers;
     NonnullOwnPtrVector<Region> m_tx_buffers_regions;
     OwnPtr<Region> m_mmio_region;
     u8 m_interrupt_line { 0 };
@@ -106,8 +129,17 @@ private:
     bool m_use_mmio { false };
     EntropySource m_entropy_source;
 
-    static const size_t number_of_rx_descriptors = 32;
+    // The checksum context last handed to the hardware.
+    bool m_has_tx_checksum_context { false };
+    bool m_tx_checksum_context_pending { false };
+    u8 m_tx_checksum_start { 0 };
+    u8 m_tx_checksum_offset { 0 };
+
+    // The RX ring can be resized with the "e1000_rx_descriptors" boot argument. The hardware wants it in multiples of 8.
+    static const size_t default_number_of_rx_descriptors = 256;
+    static const size_t max_number_of_rx_descriptors = 4096;
     static const size_t number_of_tx_descriptors = 8;
+    size_t m_number_of_rx_descriptors { default_number_of_rx_descriptors };
 
     WaitQueue m_wait_queue;
 };
@@ -31,6 +31,7 @@
 #include <AK/NetworkOrdered.h>
 #include <AK/String.h>
 #include <AK/Types.h>
+#include <Kernel/Net/InternetChecksum.h>
 
 namespace Kernel {
 
@@ -128,17 +129,7 @@ const LogStream& operator<<(const LogStream& stream, const IPv4Packet& packet);
 
 inline NetworkOrdered<u16> internet_checksum(const void* ptr, size_t count)
 {
-    u32 checksum = 0;
-    auto* w = (const u16*)ptr;
-    while (count > 1) {
-        checksum += convert_between_host_and_network(*w++);
-        if (checksum & 0x80000000)
-            checksum = (checksum & 0xffff) | (checksum >> 16);
-        count -= 2;
-    }
-    while (checksum >> 16)
-        checksum = (checksum & 0xffff) + (checksum >> 16);
-    return ~checksum & 0xffff;
+    return internet_checksum_finish(internet_checksum_add(ptr, count));
 }
 
 }
@@ -37,6 +37,7 @@
 #include <Kernel/Net/UDP.h>
 #include <Kernel/Net/UDPSocket.h>
 #include <Kernel/Process.h>
+#include <Kernel/Random.h>
 #include <Kernel/UnixTypes.h>
 #include <LibC/errno_numbers.h>
 #include <LibC/sys/ioctl_numbers.h>
@@ -71,9 +72,6 @@ IPv4Socket::IPv4Socket(int type, int protocol)
     dbg() << "IPv4Socket{" << this << "} created with type=" << type << ", protocol=" << protocol;
 #endif
     m_buffer_mode = type == SOCK_STREAM ? BufferMode::Bytes : BufferMode::Packets;
-    if (m_buffer_mode == BufferMode::Bytes) {
-        m_scratch_buffer = KBuffer::create_with_size(65536);
-    }
     LOCKER(all_sockets().lock());
     all_sockets().resource().set(this);
 }
@@ -193,7 +191,19 @@ int IPv4Socket::allocate_local_port_if_needed()
     return port;
 }
 
-KResultOr<size_t> IPv4Socket::sendto(FileDescription&, const void* data, size_t data_length, int flags, const sockaddr* addr, socklen_t addr_length)
+static u32 s_ephemeral_port_secret;
+static u16 s_ephemeral_port_offsets[256];
+
+u16 IPv4Socket::ephemeral_port_search_start(u32 destination_hash)
+{
+    if (!s_ephemeral_port_secret)
+        s_ephemeral_port_secret = get_good_random<u32>() | 1;
+    u32 hash = pair_int_hash(destination_hash, s_ephemeral_port_secret);
+    auto& offset = s_ephemeral_port_offsets[(hash >> 24) & 0xff];
+    return first_ephemeral_port + (hash + offset++) % ephemeral_port_count;
+}
+
+KResultOr<size_t> IPv4Socket::sendto(FileDescription& description, const void* data, size_t data_length, int flags, const sockaddr* addr, socklen_t addr_length)
 {
     (void)flags;
     if (addr && addr_length != sizeof(sockaddr_in))
@@ -230,6 +240,13 @@ KResultOr<size_t> IPv4Socket::sendto(FileDescription&, const void* data, size_t
         return data_length;
     }
 
+    if (buffer_mode() == BufferMode::Bytes && is_connected() && !can_write(description, data_length)) {
+        if (!description.is_blocking())
+            return KResult(-EAGAIN);
+        if (Thread::current()->block<Thread::WriteBlocker>(nullptr, description).was_interrupted())
+            return KResult(-EINTR);
+    }
+
     auto nsent_or_error = protocol_send(data, data_length);
     if (!nsent_or_error.is_error())
         Thread::current()->did_ipv4_socket_write(nsent_or_error.value());
@@ -264,6 +281,8 @@ KResultOr<size_t> IPv4Socket::receive_byte_buffered(FileDescription& description
         Thread::current()->did_ipv4_socket_read((size_t)nreceived);
 
     m_can_read = !m_receive_buffer.is_empty();
+    if (nreceived > 0)
+        protocol_did_read();
     return nreceived;
 }
 
@@ -315,7 +334,6 @@ KResultOr<size_t> IPv4Socket::receive_packet_buffered(FileDescription& descripti
 #endif
     }
     ASSERT(packet.data.has_value());
-    auto& ipv4_packet = *(const IPv4Packet*)(packet.data.value().data());
 
     if (addr) {
 #ifdef IPV4_SOCKET_DEBUG
@@ -329,13 +347,18 @@ KResultOr<size_t> IPv4Socket::receive_packet_buffered(FileDescription& descripti
         *addr_length = sizeof(sockaddr_in);
     }
 
-    if (type() == SOCK_RAW) {
-        ASSERT(buffer_length >= ipv4_packet.payload_size());
-        memcpy(buffer, ipv4_packet.payload(), ipv4_packet.payload_size());
-        return ipv4_packet.payload_size();
-    }
+    (void)flags;
+    // Whatever doesn't fit in the caller's buffer is lost, like on other systems.
+    auto payload = protocol_payload(packet.data.value().bytes());
+    size_t nreceived = min(payload.size(), buffer_length);
+    memcpy(buffer, payload.data(), nreceived);
+    return nreceived;
+}
 
-    return protocol_receive(packet.data.value(), buffer, buffer_length, flags);
+ReadonlyBytes IPv4Socket::protocol_payload(ReadonlyBytes packet) const
+{
+    auto& ipv4_packet = *(const IPv4Packet*)(packet.data());
+    return { (const u8*)ipv4_packet.payload(), ipv4_packet.payload_size() };
 }
 
 KResultOr<size_t> IPv4Socket::recvfrom(FileDescription& description, void* buffer, size_t buffer_length, int flags, sockaddr* addr, socklen_t* addr_length)
@@ -358,7 +381,7 @@ KResultOr<size_t> IPv4Socket::recvfrom(FileDescription& description, void* buffe
     return nreceived;
 }
 
-bool IPv4Socket::did_receive(const IPv4Address& source_address, u16 source_port, KBuffer&& packet)
+bool IPv4Socket::did_receive(const IPv4Address& source_address, u16 source_port, const PacketBuffer& packet)
 {
     LOCKER(lock());
 
@@ -374,17 +397,15 @@ bool IPv4Socket::did_receive(const IPv4Address& source_address, u16 source_port,
             ASSERT(m_can_read);
             return false;
         }
-        auto nreceived_or_error = protocol_receive(packet, m_scratch_buffer.value().data(), m_scratch_buffer.value().size(), 0);
-        if (nreceived_or_error.is_error())
-            return false;
-        m_receive_buffer.write(m_scratch_buffer.value().data(), nreceived_or_error.value());
+        auto payload = protocol_payload(packet.bytes());
+        m_receive_buffer.write(payload.data(), payload.size());
         m_can_read = !m_receive_buffer.is_empty();
     } else {
         if (m_receive_queue.size() > 2000) {
             dbg() << "IPv4Socket(" << this << "): did_receive refusing packet since queue is full.";
             return false;
         }
-        m_receive_queue.append({ source_address, source_port, move(packet) });
+        m_receive_queue.append({ source_address, source_port, packet });
         m_can_read = true;
     }
     m_bytes_received += packet_size;
@@ -29,10 +29,10 @@
 #include <AK/HashMap.h>
 #include <AK/SinglyLinkedListWithCount.h>
 #include <Kernel/DoubleBuffer.h>
-#include <Kernel/KBuffer.h>
 #include <Kernel/Lock.h>
 #include <Kernel/Net/IPv4.h>
 #include <Kernel/Net/IPv4SocketTuple.h>
+#include <Kernel/Net/PacketBuffer.h>
 #include <Kernel/Net/Socket.h>
 
 namespace Kernel {
@@ -65,7 +65,7 @@ public:
 
     virtual int ioctl(FileDescription&, unsigned request, FlatPtr arg) override;
 
-    bool did_receive(const IPv4Address& peer_address, u16 peer_port, KBuffer&&);
+    bool did_receive(const IPv4Address& peer_address, u16 peer_port, const PacketBuffer&);
 
     const IPv4Address& local_address() const { return m_local_address; }
     u16 local_port() const { return m_local_port; }
@@ -94,19 +94,33 @@ protected:
 
     int allocate_local_port_if_needed();
 
+    static constexpr u16 first_ephemeral_port = 32768;
+    static constexpr u16 last_ephemeral_port = 60999;
+    static constexpr u16 ephemeral_port_count = last_ephemeral_port - first_ephemeral_port + 1;
+
+    // Picks where to start looking for a free ephemeral port (RFC 6056, algorithm 3).
+    // Consecutive connections to the same destination get consecutive offsets, so the first candidate is nearly always free.
+    static u16 ephemeral_port_search_start(u32 destination_hash);
+
     virtual KResult protocol_bind() { return KSuccess; }
     virtual KResult protocol_listen() { return KSuccess; }
-    virtual KResultOr<size_t> protocol_receive(const KBuffer&, void*, size_t, int) { return -ENOTIMPL; }
+    // Returns the part of a received IPv4 packet that is handed to userspace.
+    virtual ReadonlyBytes protocol_payload(ReadonlyBytes ipv4_packet) const;
     virtual KResultOr<size_t> protocol_send(const void*, size_t) { return -ENOTIMPL; }
     virtual KResult protocol_connect(FileDescription&, ShouldBlock) { return KSuccess; }
     virtual int protocol_allocate_local_port() { return 0; }
     virtual bool protocol_is_disconnected() const { return false; }
+    // Called after userspace has consumed data from the receive buffer of a byte-buffered socket.
+    virtual void protocol_did_read() { }
 
     virtual void shut_down_for_reading() override;
 
     void set_local_address(IPv4Address address) { m_local_address = address; }
     void set_peer_address(IPv4Address address) { m_peer_address = address; }
 
+    size_t receive_buffer_space() const { return m_receive_buffer.space_for_writing(); }
+    KResult set_receive_buffer_capacity(size_t capacity) { return m_receive_buffer.set_capacity(capacity); }
+
 private:
     virtual bool is_ipv4() const override { return true; }
 
@@ -119,7 +133,7 @@ private:
     struct ReceivedPacket {
         IPv4Address peer_address;
         u16 peer_port;
-        Optional<KBuffer> data;
+        Optional<PacketBuffer> data;
     };
 
     SinglyLinkedListWithCount<ReceivedPacket> m_receive_queue;
@@ -136,8 +150,6 @@ private:
     bool m_can_read { false };
 
     BufferMode m_buffer_mode { BufferMode::Packets };
-
-    Optional<KBuffer> m_scratch_buffer;
 };
 
 }
@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <Kernel/Net/InternetChecksum.h>
+
+namespace Kernel {
+
+static inline u32 fold(u64 sum)
+{
+    sum = (sum & 0xffffffff) + (sum >> 32);
+    sum = (sum & 0xffffffff) + (sum >> 32);
+    u32 folded = (u32)sum;
+    folded = (folded & 0xffff) + (folded >> 16);
+    return (folded & 0xffff) + (folded >> 16);
+}
+
+u32 internet_checksum_add(const void* data, size_t size, u32 initial_sum)
+{
+    // 2^16 is 1 modulo 0xffff, so adding up 32-bit words gives the same result as adding up their 16-bit halves.
+    u64 sum = initial_sum;
+    auto* words = (const u32*)data;
+    for (; size >= 4 * sizeof(u32); size -= 4 * sizeof(u32), words += 4)
+        sum += (u64)words[0] + words[1] + words[2] + words[3];
+    for (; size >= sizeof(u32); size -= sizeof(u32))
+        sum += *words++;
+    auto* bytes = (const u8*)words;
+    if (size >= sizeof(u16)) {
+        sum += *(const u16*)bytes;
+        bytes += sizeof(u16);
+        size -= sizeof(u16);
+    }
+    if (size)
+        sum += *bytes;
+    return fold(sum);
+}
+
+u32 internet_checksum_add_and_copy(void* destination, const void* source, size_t size, u32 initial_sum)
+{
+    u64 sum = initial_sum;
+    auto* in = (const u32*)source;
+    auto* out = (u32*)destination;
+    for (; size >= 4 * sizeof(u32); size -= 4 * sizeof(u32), in += 4, out += 4) {
+        u32 a = in[0];
+        u32 b = in[1];
+        u32 c = in[2];
+        u32 d = in[3];
+        out[0] = a;
+        out[1] = b;
+        out[2] = c;
+        out[3] = d;
+        sum += (u64)a + b + c + d;
+    }
+    for (; size >= sizeof(u32); size -= sizeof(u32)) {
+        u32 word = *in++;
+        *out++ = word;
+        sum += word;
+    }
+    auto* in_bytes = (const u8*)in;
+    auto* out_bytes = (u8*)out;
+    if (size >= sizeof(u16)) {
+        u16 half = *(const u16*)in_bytes;
+        *(u16*)out_bytes = half;
+        sum += half;
+        in_bytes += sizeof(u16);
+        out_bytes += sizeof(u16);
+        size -= sizeof(u16);
+    }
+    if (size) {
+        *out_bytes = *in_bytes;
+        sum += *in_bytes;
+    }
+    return fold(sum);
+}
+
+}
@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/NetworkOrdered.h>
+#include <AK/Types.h>
+
+namespace Kernel {
+
+// One's complement sums as used by the IPv4, ICMP, TCP and UDP checksums (RFC 1071).
+//
+// A sum is kept folded to 16 bits, in memory byte order, so the data can be read a whole
+// machine word at a time. Sums of separate pieces can simply be added together, as long as
+// every piece except the last one has an even length.
+u32 internet_checksum_add(const void*, size_t, u32 sum = 0);
+
+// Like internet_checksum_add(), but also copies the data, so it's only read once.
+u32 internet_checksum_add_and_copy(void* destination, const void* source, size_t, u32 sum = 0);
+
+// The folded sum, e.g. for seeding a checksum field that hardware will complete.
+inline NetworkOrdered<u16> internet_checksum_fold(u32 sum)
+{
+    while (sum >> 16)
+        sum = (sum & 0xffff) + (sum >> 16);
+    return convert_between_host_and_network((u16)sum);
+}
+
+// The checksum to store in a header.
+inline NetworkOrdered<u16> internet_checksum_finish(u32 sum)
+{
+    return ~(u16)internet_checksum_fold(sum);
+}
+
+}
@@ -30,6 +30,7 @@
 #include <Kernel/Net/LocalSocket.h>
 #include <Kernel/Process.h>
 #include <Kernel/StdLib.h>
+#include <Kernel/Time/TimeManagement.h>
 #include <Kernel/UnixTypes.h>
 #include <LibC/errno_numbers.h>
 
@@ -234,9 +235,9 @@ bool LocalSocket::can_read(const FileDescription& description, size_t) const
     if (role == Role::Listener)
         return can_accept();
     if (role == Role::Accepted)
-        return !has_attached_peer(description) || !m_for_server.is_empty();
+        return !has_attached_peer(description) || !m_for_server.buffer.is_empty();
     if (role == Role::Connected)
-        return !has_attached_peer(description) || !m_for_client.is_empty();
+        return !has_attached_peer(description) || !m_for_client.buffer.is_empty();
     return false;
 }
 
@@ -252,25 +253,106 @@ bool LocalSocket::has_attached_peer(const FileDescription& description) const
 
 bool LocalSocket::can_write(const FileDescription& description, size_t) const
 {
+    // A full buffer that can still grow doesn't make the writer wait; sendv() will grow it instead.
+    auto can_write_to = [](const Channel& channel) {
+        return channel.buffer.space_for_writing() || channel.buffer.capacity() < max_buffer_capacity;
+    };
     auto role = this->role(description);
     if (role == Role::Accepted)
-        return !has_attached_peer(description) || m_for_client.space_for_writing();
+        return !has_attached_peer(description) || can_write_to(m_for_client);
     if (role == Role::Connected)
-        return !has_attached_peer(description) || m_for_server.space_for_writing();
+        return !has_attached_peer(description) || can_write_to(m_for_server);
     return false;
 }
 
 KResultOr<size_t> LocalSocket::sendto(FileDescription& description, const void* data, size_t data_size, int, const sockaddr*, socklen_t)
+{
+    iovec iov { const_cast<void*>(data), data_size };
+    return sendv(description, &iov, 1);
+}
+
+KResultOr<size_t> LocalSocket::sendv(FileDescription& description, const iovec* iov, int iov_count)
 {
     if (!has_attached_peer(description))
         return KResult(-EPIPE);
-    ssize_t nwritten = send_buffer_for(description).write((const u8*)data, data_size);
-    if (nwritten > 0)
+    auto& channel = send_channel_for(description);
+    size_t size = 0;
+    for (int i = 0; i < iov_count; ++i)
+        size += iov[i].iov_len;
+    grow_buffer_if_needed(channel, size);
+    // Gather the whole message into the peer's buffer in one go, so e.g an IPC header and its payload stay together.
+    ssize_t nwritten = channel.buffer.writev(iov, iov_count);
+    if (nwritten > 0) {
         Thread::current()->did_unix_socket_write(nwritten);
+        did_write(channel, nwritten);
+    }
     return nwritten;
 }
 
-DoubleBuffer& LocalSocket::receive_buffer_for(FileDescription& description)
+void LocalSocket::grow_buffer_if_needed(Channel& channel, size_t size)
+{
+    auto& buffer = channel.buffer;
+    if (size <= buffer.space_for_writing() || buffer.capacity() >= max_buffer_capacity)
+        return;
+    size_t new_capacity = buffer.capacity();
+    while (new_capacity < buffer.capacity() + size && new_capacity < max_buffer_capacity)
+        new_capacity *= 2;
+    new_capacity = min(new_capacity, max_buffer_capacity);
+    if (buffer.set_capacity(new_capacity).is_error())
+        return;
+    ScopedSpinLock lock(m_channel_lock);
+    channel.last_grown_at = TimeManagement::the().nanoseconds_since_boot();
+    ++channel.statistics.buffer_growths;
+#ifdef DEBUG_LOCAL_SOCKET
+    dbg() << "LocalSocket{" << this << "} grew buffer to " << new_capacity;
+#endif
+}
+
+void LocalSocket::shrink_buffer_if_idle(Channel& channel)
+{
+    auto& buffer = channel.buffer;
+    if (!buffer.is_empty() || buffer.capacity() <= default_buffer_capacity)
+        return;
+    {
+        ScopedSpinLock lock(m_channel_lock);
+        if (TimeManagement::the().nanoseconds_since_boot() - channel.last_grown_at < buffer_shrink_delay_ns)
+            return;
+    }
+    // This fails harmlessly if the writer got more data in since we checked.
+    (void)buffer.set_capacity(default_buffer_capacity);
+}
+
+void LocalSocket::did_write(Channel& channel, size_t nwritten)
+{
+    ScopedSpinLock lock(m_channel_lock);
+    channel.statistics.bytes += nwritten;
+    // Hand the data to a blocked reader right away, rather than having it wait until the scheduler polls it.
+    if (channel.blocked_reader && channel.blocked_reader->unblock_if_ready())
+        ++channel.statistics.reader_wakeups;
+}
+
+KResult LocalSocket::block_until_readable(FileDescription& description, Channel& channel)
+{
+    auto* current_thread = Thread::current();
+    {
+        ScopedSpinLock lock(m_channel_lock);
+        // If several threads read from the same socket, only the first one gets woken up directly.
+        if (!channel.blocked_reader)
+            channel.blocked_reader = current_thread;
+        ++channel.statistics.blocked_reads;
+    }
+    auto result = current_thread->block<Thread::ReadBlocker>(nullptr, description);
+    {
+        ScopedSpinLock lock(m_channel_lock);
+        if (channel.blocked_reader == current_thread)
+            channel.blocked_reader = nullptr;
+    }
+    if (result.was_interrupted())
+        return KResult(-EINTR);
+    return KSuccess;
+}
+
+LocalSocket::Channel& LocalSocket::receive_channel_for(FileDescription& description)
 {
     auto role = this->role(description);
     if (role == Role::Accepted)
@@ -280,7 +362,7 @@ DoubleBuffer& LocalSocket::receive_buffer_for(FileDescription& description)
     ASSERT_NOT_REACHED();
 }
 
-DoubleBuffer& LocalSocket::send_buffer_for(FileDescription& description)
+LocalSocket::Channel& LocalSocket::send_channel_for(FileDescription& description)
 {
     auto role = this->role(description);
     if (role == Role::Connected)
@@ -290,9 +372,24 @@ DoubleBuffer& LocalSocket::send_buffer_for(FileDescription& description)
     ASSERT_NOT_REACHED();
 }
 
+LocalSocket::ChannelStatistics LocalSocket::statistics_for(const Channel& channel) const
+{
+    ScopedSpinLock lock(m_channel_lock);
+    auto statistics = channel.statistics;
+    statistics.buffer_capacity = channel.buffer.capacity();
+    return statistics;
+}
+
 KResultOr<size_t> LocalSocket::recvfrom(FileDescription& description, void* buffer, size_t buffer_size, int, sockaddr*, socklen_t*)
 {
-    auto& buffer_for_me = receive_buffer_for(description);
+    iovec iov { buffer, buffer_size };
+    return recvv(description, &iov, 1);
+}
+
+KResultOr<size_t> LocalSocket::recvv(FileDescription& description, const iovec* iov, int iov_count)
+{
+    auto& channel = receive_channel_for(description);
+    auto& buffer_for_me = channel.buffer;
     if (!description.is_blocking()) {
         if (buffer_for_me.is_empty()) {
             if (!has_attached_peer(description))
@@ -300,15 +397,17 @@ KResultOr<size_t> LocalSocket::recvfrom(FileDescription& description, void* buff
             return KResult(-EAGAIN);
         }
     } else if (!can_read(description, 0)) {
-        if (Thread::current()->block<Thread::ReadBlocker>(nullptr, description).was_interrupted())
-            return KResult(-EINTR);
+        auto result = block_until_readable(description, channel);
+        if (result.is_error())
+            return result;
     }
     if (!has_attached_peer(description) && buffer_for_me.is_empty())
         return 0;
     ASSERT(!buffer_for_me.is_empty());
-    int nread = buffer_for_me.read((u8*)buffer, buffer_size);
+    int nread = buffer_for_me.readv(iov, iov_count);
     if (nread > 0)
         Thread::current()->did_unix_socket_read(nread);
+    shrink_buffer_if_idle(channel);
     return nread;
 }
 
@@ -29,6 +29,7 @@
 #include <AK/InlineLinkedList.h>
 #include <Kernel/DoubleBuffer.h>
 #include <Kernel/Net/Socket.h>
+#include <Kernel/SpinLock.h>
 
 namespace Kernel {
 
@@ -47,6 +48,25 @@ public:
 
     static void for_each(Function<void(const LocalSocket&)>);
 
+    // Each direction starts out with a buffer of default_buffer_capacity. A writer that finds it full
+    // while the reader hasn't caught up yet doubles it, up to max_buffer_capacity. Once the reader has
+    // drained a grown buffer and it hasn't needed to grow for a while, it goes back to the default.
+    static constexpr size_t default_buffer_capacity = 64 * KB;
+    static constexpr size_t max_buffer_capacity = 1 * MB;
+    static constexpr u64 buffer_shrink_delay_ns = 1'000'000'000;
+
+    struct ChannelStatistics {
+        u64 bytes { 0 };
+        // Reads that found nothing to read and had to block.
+        u32 blocked_reads { 0 };
+        // Times a writer woke up the blocked reader itself, rather than leaving that for the scheduler.
+        u32 reader_wakeups { 0 };
+        u32 buffer_growths { 0 };
+        size_t buffer_capacity { 0 };
+    };
+    ChannelStatistics statistics_for_client() const { return statistics_for(m_for_client); }
+    ChannelStatistics statistics_for_server() const { return statistics_for(m_for_server); }
+
     StringView socket_path() const;
     String absolute_path(const FileDescription& description) const override;
 
@@ -62,6 +82,8 @@ public:
     virtual bool can_write(const FileDescription&, size_t) const override;
     virtual KResultOr<size_t> sendto(FileDescription&, const void*, size_t, int, const sockaddr*, socklen_t) override;
     virtual KResultOr<size_t> recvfrom(FileDescription&, void*, size_t, int flags, sockaddr*, socklen_t*) override;
+    virtual KResultOr<size_t> sendv(FileDescription&, const iovec*, int iov_count) override;
+    virtual KResultOr<size_t> recvv(FileDescription&, const iovec*, int iov_count) override;
     virtual KResult getsockopt(FileDescription&, int level, int option, Userspace<void*>, Userspace<socklen_t*>) override;
     virtual KResult chown(FileDescription&, uid_t, gid_t) override;
     virtual KResult chmod(FileDescription&, mode_t) override;
@@ -72,8 +94,23 @@ private:
     virtual bool is_local() const override { return true; }
     bool has_attached_peer(const FileDescription&) const;
     static Lockable<InlineLinkedList<LocalSocket>>& all_sockets();
-    DoubleBuffer& receive_buffer_for(FileDescription&);
-    DoubleBuffer& send_buffer_for(FileDescription&);
+
+    // Everything that flows in one direction: towards the client, or towards the server.
+    struct Channel {
+        DoubleBuffer buffer { default_buffer_capacity };
+        // The thread blocked in a read on this channel, if any. Guarded by m_channel_lock.
+        Thread* blocked_reader { nullptr };
+        u64 last_grown_at { 0 };
+        ChannelStatistics statistics;
+    };
+
+    Channel& receive_channel_for(FileDescription&);
+    Channel& send_channel_for(FileDescription&);
+    ChannelStatistics statistics_for(const Channel&) const;
+    KResult block_until_readable(FileDescription&, Channel&);
+    void grow_buffer_if_needed(Channel&, size_t size);
+    void shrink_buffer_if_idle(Channel&);
+    void did_write(Channel&, size_t nwritten);
     NonnullRefPtrVector<FileDescription>& sendfd_queue_for(const FileDescription&);
     NonnullRefPtrVector<FileDescription>& recvfd_queue_for(const FileDescription&);
 
@@ -102,8 +139,9 @@ private:
     bool m_accept_side_fd_open { false };
     sockaddr_un m_address { 0, { 0 } };
 
-    DoubleBuffer m_for_client;
-    DoubleBuffer m_for_server;
+    Channel m_for_client;
+    Channel m_for_server;
+    mutable SpinLock<u8> m_channel_lock;
 
     NonnullRefPtrVector<FileDescription> m_fds_for_client;
     NonnullRefPtrVector<FileDescription> m_fds_for_server;
@@ -24,8 +24,11 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <Kernel/Net/EthernetFrameHeader.h>
 #include <Kernel/Net/LoopbackAdapter.h>
 
+//#define LOOPBACK_DEBUG
+
 namespace Kernel {
 
 LoopbackAdapter& LoopbackAdapter::the()
@@ -41,6 +44,9 @@ LoopbackAdapter::LoopbackAdapter()
     set_interface_name("loop");
     set_mtu(65536);
     set_mac_address({ 19, 85, 2, 9, 0x55, 0xaa });
+    set_packet_buffer_size(sizeof(EthernetFrameHeader) + mtu());
+    // Frames never leave the machine, so there's nothing to checksum for.
+    set_transmit_checksum_offload(true);
 }
 
 LoopbackAdapter::~LoopbackAdapter()
@@ -49,7 +55,9 @@ LoopbackAdapter::~LoopbackAdapter()
 
 void LoopbackAdapter::send_raw(ReadonlyBytes payload)
 {
+#ifdef LOOPBACK_DEBUG
     dbg() << "LoopbackAdapter: Sending " << payload.size() << " byte(s) to myself.";
+#endif
     did_receive(payload);
 }
 
@@ -39,6 +39,7 @@ public:
 
     virtual void send_raw(ReadonlyBytes) override;
     virtual const char* class_name() const override { return "LoopbackAdapter"; }
+    virtual bool is_loopback() const override { return true; }
 
 private:
     LoopbackAdapter();
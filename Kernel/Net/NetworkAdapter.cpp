@@ -32,6 +32,8 @@
 #include <Kernel/Net/EthernetFrameHeader.h>
 #include <Kernel/Net/LoopbackAdapter.h>
 #include <Kernel/Net/NetworkAdapter.h>
+#include <Kernel/Net/UDP.h>
+#include <Kernel/Net/UDPSocket.h>
 #include <Kernel/Random.h>
 #include <Kernel/StdLib.h>
 
@@ -100,14 +102,20 @@ void NetworkAdapter::send(const MACAddress& destination, const ARPPacket& packet
     send_raw({ (const u8*)eth, size_in_bytes });
 }
 
-void NetworkAdapter::send_ipv4(const MACAddress& destination_mac, const IPv4Address& destination_ipv4, IPv4Protocol protocol, ReadonlyBytes payload, u8 ttl)
+void NetworkAdapter::send_ipv4(const MACAddress& destination_mac, const IPv4Address& destination_ipv4, IPv4Protocol protocol, ReadonlyBytes payload, u8 ttl, Optional<size_t> offloaded_checksum_offset)
 {
     size_t ipv4_packet_size = sizeof(IPv4Packet) + payload.size();
     if (ipv4_packet_size > mtu()) {
+        ASSERT(!offloaded_checksum_offset.has_value());
         send_ipv4_fragmented(destination_mac, destination_ipv4, protocol, payload, ttl);
         return;
     }
 
+    if (is_loopback()) {
+        send_ipv4_to_self(destination_ipv4, protocol, payload, ttl);
+        return;
+    }
+
     size_t ethernet_frame_size = sizeof(EthernetFrameHeader) + sizeof(IPv4Packet) + payload.size();
     auto buffer = ByteBuffer::create_zeroed(ethernet_frame_size);
     auto& eth = *(EthernetFrameHeader*)buffer.data();
@@ -127,9 +135,64 @@ void NetworkAdapter::send_ipv4(const MACAddress& destination_mac, const IPv4Addr
     m_packets_out++;
     m_bytes_out += ethernet_frame_size;
     memcpy(ipv4.payload(), payload.data(), payload.size());
+    if (offloaded_checksum_offset.has_value()) {
+        size_t checksum_start = sizeof(EthernetFrameHeader) + sizeof(IPv4Packet);
+        send_raw_with_checksum(buffer.span(), checksum_start, checksum_start + offloaded_checksum_offset.value());
+        return;
+    }
     send_raw({ (const u8*)&eth, ethernet_frame_size });
 }
 
+void NetworkAdapter::send_ipv4_to_self(const IPv4Address& destination_ipv4, IPv4Protocol protocol, ReadonlyBytes payload, u8 ttl)
+{
+    // The frame can't be corrupted on its way back to us, so nothing is checksummed, and it's built
+    // straight into a receive buffer instead of being copied into one by did_receive().
+    size_t ethernet_frame_size = sizeof(EthernetFrameHeader) + sizeof(IPv4Packet) + payload.size();
+    auto storage = take_packet_buffer();
+    ASSERT(ethernet_frame_size <= storage.capacity());
+    memset(storage.data(), 0, sizeof(EthernetFrameHeader) + sizeof(IPv4Packet));
+    auto& eth = *(EthernetFrameHeader*)storage.data();
+    eth.set_source(mac_address());
+    eth.set_destination(mac_address());
+    eth.set_ether_type(EtherType::IPv4);
+    auto& ipv4 = *(IPv4Packet*)eth.payload();
+    ipv4.set_version(4);
+    ipv4.set_internet_header_length(5);
+    ipv4.set_source(ipv4_address());
+    ipv4.set_destination(destination_ipv4);
+    ipv4.set_protocol((u8)protocol);
+    ipv4.set_length(sizeof(IPv4Packet) + payload.size());
+    ipv4.set_ident(1);
+    ipv4.set_ttl(ttl);
+    memcpy(ipv4.payload(), payload.data(), payload.size());
+    m_packets_out++;
+    m_bytes_out += ethernet_frame_size;
+
+    PacketBuffer packet(storage, ethernet_frame_size);
+    if (protocol != IPv4Protocol::UDP || payload.size() < sizeof(UDPPacket)) {
+        did_receive(move(packet));
+        return;
+    }
+
+    // A datagram needs no further processing on the way in, so it goes straight to the receiving socket, skipping NetworkTask.
+    auto& udp_packet = *(const UDPPacket*)ipv4.payload();
+    m_packets_in++;
+    m_bytes_in += ethernet_frame_size;
+    auto socket = UDPSocket::from_port(udp_packet.destination_port());
+    if (!socket)
+        return;
+    packet.pull(sizeof(EthernetFrameHeader));
+    socket->did_receive(ipv4.source(), udp_packet.source_port(), packet);
+}
+
+void NetworkAdapter::send_raw_with_checksum(Bytes frame, size_t checksum_start, size_t checksum_offset)
+{
+    ASSERT(checksum_offset + sizeof(u16) <= frame.size());
+    auto& checksum = *(NetworkOrdered<u16>*)(frame.data() + checksum_offset);
+    checksum = internet_checksum_finish(internet_checksum_add(frame.data() + checksum_start, frame.size() - checksum_start));
+    send_raw(frame);
+}
+
 void NetworkAdapter::send_ipv4_fragmented(const MACAddress& destination_mac, const IPv4Address& destination_ipv4, IPv4Protocol protocol, ReadonlyBytes payload, u8 ttl)
 {
     // packets must be split on the 64-bit boundary
@@ -168,47 +231,68 @@ void NetworkAdapter::send_ipv4_fragmented(const MACAddress& destination_mac, con
     }
 }
 
-void NetworkAdapter::did_receive(ReadonlyBytes payload)
+KBuffer NetworkAdapter::take_packet_buffer()
 {
     InterruptDisabler disabler;
-    m_packets_in++;
-    m_bytes_in += payload.size();
-
-    Optional<KBuffer> buffer;
-
-    if (m_unused_packet_buffers.is_empty()) {
-        buffer = KBuffer::copy(payload.data(), payload.size());
-    } else {
-        buffer = m_unused_packet_buffers.take_first();
-        --m_unused_packet_buffers_count;
-        if (payload.size() <= buffer.value().size()) {
-            memcpy(buffer.value().data(), payload.data(), payload.size());
-            buffer.value().set_size(payload.size());
-        } else {
-            buffer = KBuffer::copy(payload.data(), payload.size());
+    // A pooled buffer that nobody but the pool refers to anymore is free to be reused.
+    for (size_t i = 0; i < m_packet_buffer_pool.size(); ++i) {
+        size_t index = (m_next_pooled_packet_buffer + i) % m_packet_buffer_pool.size();
+        if (m_packet_buffer_pool[index].impl().ref_count() == 1) {
+            m_next_pooled_packet_buffer = (index + 1) % m_packet_buffer_pool.size();
+            return m_packet_buffer_pool[index];
         }
     }
+    auto buffer = KBuffer::create_with_size(m_packet_buffer_size, Region::Access::Read | Region::Access::Write, "Packet buffer");
+    buffer.impl().region().commit();
+    if (m_packet_buffer_pool.size() < max_pooled_packet_buffer_bytes / m_packet_buffer_size)
+        m_packet_buffer_pool.append(buffer);
+    return buffer;
+}
+
+void NetworkAdapter::did_receive(ReadonlyBytes payload)
+{
+    if (payload.size() > m_packet_buffer_size) {
+        did_receive(PacketBuffer(KBuffer::copy(payload.data(), payload.size()), payload.size()));
+        return;
+    }
+    auto buffer = take_packet_buffer();
+    memcpy(buffer.data(), payload.data(), payload.size());
+    did_receive(PacketBuffer(buffer, payload.size()));
+}
 
-    m_packet_queue.append(buffer.value());
+void NetworkAdapter::did_receive(PacketBuffer&& packet)
+{
+    InterruptDisabler disabler;
+    m_packets_in++;
+    m_bytes_in += packet.size();
+
+    m_packet_queue.append(move(packet));
 
     if (on_receive)
         on_receive();
 }
 
-size_t NetworkAdapter::dequeue_packet(u8* buffer, size_t buffer_size)
+void NetworkAdapter::schedule_receive_poll()
+{
+    m_receive_interrupts++;
+    m_receive_poll_scheduled = true;
+    if (on_receive_poll_scheduled)
+        on_receive_poll_scheduled();
+}
+
+void NetworkAdapter::run_receive_poll()
+{
+    m_receive_poll_scheduled = false;
+    if (poll_receive(receive_poll_budget))
+        m_receive_poll_scheduled = true;
+}
+
+Optional<PacketBuffer> NetworkAdapter::dequeue_packet()
 {
     InterruptDisabler disabler;
     if (m_packet_queue.is_empty())
-        return 0;
-    auto packet = m_packet_queue.take_first();
-    size_t packet_size = packet.size();
-    ASSERT(packet_size <= buffer_size);
-    memcpy(buffer, packet.data(), packet_size);
-    if (m_unused_packet_buffers_count < 100) {
-        m_unused_packet_buffers.append(packet);
-        ++m_unused_packet_buffers_count;
-    }
-    return packet_size;
+        return {};
+    return m_packet_queue.take_first();
 }
 
 void NetworkAdapter::set_ipv4_address(const IPv4Address& address)
@@ -29,6 +29,7 @@
 #include <AK/ByteBuffer.h>
 #include <AK/Function.h>
 #include <AK/MACAddress.h>
+#include <AK/Optional.h>
 #include <AK/SinglyLinkedList.h>
 #include <AK/Types.h>
 #include <AK/WeakPtr.h>
@@ -37,6 +38,7 @@
 #include <Kernel/Net/ARP.h>
 #include <Kernel/Net/ICMP.h>
 #include <Kernel/Net/IPv4.h>
+#include <Kernel/Net/PacketBuffer.h>
 
 namespace Kernel {
 
@@ -57,19 +59,26 @@ public:
     IPv4Address ipv4_netmask() const { return m_ipv4_netmask; }
     IPv4Address ipv4_gateway() const { return m_ipv4_gateway; }
     virtual bool link_up() { return false; }
+    virtual bool is_loopback() const { return false; }
 
     void set_ipv4_address(const IPv4Address&);
     void set_ipv4_netmask(const IPv4Address&);
     void set_ipv4_gateway(const IPv4Address&);
 
     void send(const MACAddress&, const ARPPacket&);
-    void send_ipv4(const MACAddress&, const IPv4Address&, IPv4Protocol, ReadonlyBytes payload, u8 ttl);
+    // With a checksum offset, the checksum field at that offset into the payload only holds the pseudo-header sum, and
+    // the adapter completes it. Only adapters with transmit checksum offload take this, and the packet must fit the MTU.
+    void send_ipv4(const MACAddress&, const IPv4Address&, IPv4Protocol, ReadonlyBytes payload, u8 ttl, Optional<size_t> offloaded_checksum_offset = {});
     void send_ipv4_fragmented(const MACAddress&, const IPv4Address&, IPv4Protocol, ReadonlyBytes payload, u8 ttl);
+    // Fast path for loopback adapters: no checksums, and no Ethernet round trip for UDP.
+    void send_ipv4_to_self(const IPv4Address&, IPv4Protocol, ReadonlyBytes payload, u8 ttl);
 
-    size_t dequeue_packet(u8* buffer, size_t buffer_size);
+    Optional<PacketBuffer> dequeue_packet();
 
     bool has_queued_packets() const { return !m_packet_queue.is_empty(); }
 
+    bool has_transmit_checksum_offload() const { return m_transmit_checksum_offload; }
+
     u32 mtu() const { return m_mtu; }
     void set_mtu(u32 mtu) { m_mtu = mtu; }
 
@@ -77,30 +86,59 @@ public:
     u32 bytes_in() const { return m_bytes_in; }
     u32 packets_out() const { return m_packets_out; }
     u32 bytes_out() const { return m_bytes_out; }
+    u32 receive_interrupts() const { return m_receive_interrupts; }
+
+    // Adapters that support it stop interrupting for every frame, and instead have NetworkTask
+    // drain their receive ring in batches of up to this many frames until it's empty.
+    static constexpr size_t receive_poll_budget = 64;
+    bool is_receive_poll_scheduled() const { return m_receive_poll_scheduled; }
+    void run_receive_poll();
 
     Function<void()> on_receive;
+    Function<void()> on_receive_poll_scheduled;
 
 protected:
     NetworkAdapter();
     void set_interface_name(const StringView& basename);
     void set_mac_address(const MACAddress& mac_address) { m_mac_address = mac_address; }
     virtual void send_raw(ReadonlyBytes) = 0;
+    // Sends a frame after storing the checksum of everything from checksum_start to its end at checksum_offset.
+    // Adapters that set_transmit_checksum_offload() have the hardware do this; the fallback does it in software.
+    virtual void send_raw_with_checksum(Bytes frame, size_t checksum_start, size_t checksum_offset);
+    void set_transmit_checksum_offload(bool enabled) { m_transmit_checksum_offload = enabled; }
     void did_receive(ReadonlyBytes);
+    void did_receive(PacketBuffer&&);
+
+    // Received packets are kept in buffers from a pool, so that adapters can DMA straight
+    // into them. A buffer goes back to the pool once the last PacketBuffer referring to it is gone.
+    // Buffers are a page unless the adapter asks for larger ones to fit its MTU.
+    static constexpr size_t max_pooled_packet_buffer_bytes = 1024 * PAGE_SIZE;
+    size_t packet_buffer_size() const { return m_packet_buffer_size; }
+    void set_packet_buffer_size(size_t size) { m_packet_buffer_size = PAGE_ROUND_UP(size); }
+    KBuffer take_packet_buffer();
+    // Called from the IRQ handler, with the adapter's receive interrupts masked until poll_receive() has emptied the ring.
+    void schedule_receive_poll();
+    // Returns true if the budget ran out before the ring was empty.
+    virtual bool poll_receive(size_t) { return false; }
 
 private:
     MACAddress m_mac_address;
     IPv4Address m_ipv4_address;
     IPv4Address m_ipv4_netmask;
     IPv4Address m_ipv4_gateway;
-    SinglyLinkedList<KBuffer> m_packet_queue;
-    SinglyLinkedList<KBuffer> m_unused_packet_buffers;
-    size_t m_unused_packet_buffers_count { 0 };
+    SinglyLinkedList<PacketBuffer> m_packet_queue;
+    Vector<KBuffer> m_packet_buffer_pool;
+    size_t m_next_pooled_packet_buffer { 0 };
     String m_name;
     u32 m_packets_in { 0 };
     u32 m_bytes_in { 0 };
     u32 m_packets_out { 0 };
     u32 m_bytes_out { 0 };
+    u32 m_receive_interrupts { 0 };
+    bool m_receive_poll_scheduled { false };
+    bool m_transmit_checksum_offload { false };
     u32 m_mtu { 1500 };
+    size_t m_packet_buffer_size { PAGE_SIZE };
 };
 
 }
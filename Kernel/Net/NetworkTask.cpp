@@ -24,6 +24,9 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <AK/Atomic.h>
+#include <AK/SinglyLinkedList.h>
+#include <AK/Time.h>
 #include <Kernel/Lock.h>
 #include <Kernel/Net/ARP.h>
 #include <Kernel/Net/EtherType.h>
@@ -39,6 +42,7 @@
 #include <Kernel/Net/UDP.h>
 #include <Kernel/Net/UDPSocket.h>
 #include <Kernel/Process.h>
+#include <Kernel/SpinLock.h>
 
 //#define NETWORK_TASK_DEBUG
 //#define ETHERNET_DEBUG
@@ -52,12 +56,27 @@
 namespace Kernel {
 
 static void handle_arp(const EthernetFrameHeader&, size_t frame_size);
-static void handle_ipv4(const EthernetFrameHeader&, size_t frame_size);
-static void handle_icmp(const EthernetFrameHeader&, const IPv4Packet&);
-static void handle_udp(const IPv4Packet&);
-static void handle_tcp(const IPv4Packet&);
+static void handle_ipv4(const EthernetFrameHeader&, const PacketBuffer& frame);
+static void handle_icmp(const EthernetFrameHeader&, const IPv4Packet&, const PacketBuffer&);
+static void handle_udp(const IPv4Packet&, const PacketBuffer&);
+static void handle_tcp(const IPv4Packet&, const PacketBuffer&);
+
+struct NetworkWorker {
+    NetworkAdapter* adapter { nullptr };
+    WaitQueue wait_queue;
+    SpinLock<u8> steered_packets_lock;
+    SinglyLinkedList<PacketBuffer> steered_packets;
+};
+
+static NetworkWorker* s_workers;
+static size_t s_worker_count;
+static Atomic<u32> s_next_worker_index;
+
+static void handle_frame(const PacketBuffer&);
 
 [[noreturn]] static void NetworkTask_main();
+[[noreturn]] static void NetworkTask_worker();
+[[noreturn]] static void run_worker(NetworkWorker&);
 
 void NetworkTask::spawn()
 {
@@ -65,13 +84,36 @@ void NetworkTask::spawn()
     Process::create_kernel_process(thread, "NetworkTask", NetworkTask_main);
 }
 
+size_t NetworkTask::worker_for(const IPv4SocketTuple& tuple)
+{
+    ASSERT(s_worker_count);
+    return Traits<IPv4SocketTuple>::hash(tuple) % s_worker_count;
+}
+
+// Frames for a TCP or UDP flow are always handled by the same worker, whichever adapter they arrived on.
+// Everything else is handled by the worker that received it.
+static Optional<size_t> steering_target(const PacketBuffer& frame)
+{
+    if (frame.size() < sizeof(EthernetFrameHeader) + sizeof(IPv4Packet) + 2 * sizeof(u16))
+        return {};
+    auto& eth = *(const EthernetFrameHeader*)frame.data();
+    if (eth.ether_type() != EtherType::IPv4)
+        return {};
+    auto& packet = *static_cast<const IPv4Packet*>(eth.payload());
+    if (packet.is_a_fragment())
+        return {};
+    if (packet.protocol() != (u8)IPv4Protocol::TCP && packet.protocol() != (u8)IPv4Protocol::UDP)
+        return {};
+    // TCP and UDP both start with the source and destination ports.
+    auto* ports = (const NetworkOrdered<u16>*)packet.payload();
+    return NetworkTask::worker_for(IPv4SocketTuple(packet.destination(), ports[1], packet.source(), ports[0]));
+}
+
 void NetworkTask_main()
 {
-    WaitQueue packet_wait_queue;
     u8 octet = 15;
-    int pending_packets = 0;
     NetworkAdapter::for_each([&](auto& adapter) {
-        if (String(adapter.class_name()) == "LoopbackAdapter") {
+        if (adapter.is_loopback()) {
             adapter.set_ipv4_address({ 127, 0, 0, 1 });
             adapter.set_ipv4_netmask({ 255, 0, 0, 0 });
             adapter.set_ipv4_gateway({ 0, 0, 0, 0 });
@@ -82,83 +124,137 @@ void NetworkTask_main()
         }
 
         klog() << "NetworkTask: " << adapter.class_name() << " network adapter found: hw=" << adapter.mac_address().to_string().characters() << " address=" << adapter.ipv4_address().to_string().characters() << " netmask=" << adapter.ipv4_netmask().to_string().characters() << " gateway=" << adapter.ipv4_gateway().to_string().characters();
+        ++s_worker_count;
+    });
 
-        adapter.on_receive = [&]() {
-            pending_packets++;
-            packet_wait_queue.wake_all();
+    // One worker per adapter. Each one drains its own adapter, and hands frames for flows owned by another worker over to it.
+    ASSERT(s_worker_count);
+    s_workers = new NetworkWorker[s_worker_count];
+    size_t index = 0;
+    NetworkAdapter::for_each([&](auto& adapter) {
+        auto& worker = s_workers[index++];
+        worker.adapter = &adapter;
+        adapter.on_receive = [&worker]() {
+            worker.wait_queue.wake_all();
+        };
+        adapter.on_receive_poll_scheduled = [&worker]() {
+            worker.wait_queue.wake_all();
         };
     });
 
-    auto dequeue_packet = [&pending_packets](u8* buffer, size_t buffer_size) -> size_t {
-        if (pending_packets == 0)
-            return 0;
-        size_t packet_size = 0;
-        NetworkAdapter::for_each([&](auto& adapter) {
-            if (packet_size || !adapter.has_queued_packets())
-                return;
-            packet_size = adapter.dequeue_packet(buffer, buffer_size);
-            pending_packets--;
-#ifdef NETWORK_TASK_DEBUG
-            klog() << "NetworkTask: Dequeued packet from " << adapter.name().characters() << " (" << packet_size << " bytes)";
-#endif
-        });
-        return packet_size;
-    };
+    s_next_worker_index = 1;
+    for (size_t i = 1; i < s_worker_count; ++i)
+        Process::current()->create_kernel_thread(NetworkTask_worker, THREAD_PRIORITY_NORMAL, String::format("NetworkTask #%zu", i), THREAD_AFFINITY_DEFAULT, false);
 
-    size_t buffer_size = 64 * KB;
-    auto buffer_region = MM.allocate_kernel_region(buffer_size, "Kernel Packet Buffer", Region::Access::Read | Region::Access::Write, false, true);
-    auto buffer = (u8*)buffer_region->vaddr().get();
+    klog() << "NetworkTask: Enter main loop with " << s_worker_count << " workers.";
+    run_worker(s_workers[0]);
+}
+
+void NetworkTask_worker()
+{
+    auto index = s_next_worker_index.fetch_add(1);
+    ASSERT(index < s_worker_count);
+    run_worker(s_workers[index]);
+}
 
-    klog() << "NetworkTask: Enter main loop.";
+static Optional<PacketBuffer> take_steered_packet(NetworkWorker& worker)
+{
+    ScopedSpinLock lock(worker.steered_packets_lock);
+    if (worker.steered_packets.is_empty())
+        return {};
+    return worker.steered_packets.take_first();
+}
+
+void run_worker(NetworkWorker& worker)
+{
+    auto& adapter = *worker.adapter;
+    size_t worker_index = &worker - s_workers;
+    timeval last_tcp_timer_run = kgettimeofday();
     for (;;) {
-        size_t packet_size = dequeue_packet(buffer, buffer_size);
-        if (!packet_size) {
-            Thread::current()->wait_on(packet_wait_queue, "NetworkTask");
-            continue;
+        if (adapter.is_receive_poll_scheduled())
+            adapter.run_receive_poll();
+        auto now = kgettimeofday();
+        timeval since_tcp_timer_run;
+        timeval_sub(now, last_tcp_timer_run, since_tcp_timer_run);
+        if (since_tcp_timer_run.tv_sec || since_tcp_timer_run.tv_usec >= (suseconds_t)TCPSocket::timer_interval_ms * 1000) {
+            last_tcp_timer_run = now;
+            TCPSocket::run_timers(worker_index);
+        }
+
+        auto packet = take_steered_packet(worker);
+        if (!packet.has_value()) {
+            packet = adapter.dequeue_packet();
+            if (packet.has_value()) {
+#ifdef NETWORK_TASK_DEBUG
+                klog() << "NetworkTask: Dequeued packet from " << adapter.name().characters() << " (" << packet.value().size() << " bytes)";
+#endif
+                auto target = steering_target(packet.value());
+                if (target.has_value() && target.value() != worker_index) {
+                    auto& target_worker = s_workers[target.value()];
+                    {
+                        ScopedSpinLock lock(target_worker.steered_packets_lock);
+                        target_worker.steered_packets.append(packet.release_value());
+                    }
+                    target_worker.wait_queue.wake_all();
+                    continue;
+                }
+            }
         }
-        if (packet_size < sizeof(EthernetFrameHeader)) {
-            klog() << "NetworkTask: Packet is too small to be an Ethernet packet! (" << packet_size << ")";
+        if (!packet.has_value()) {
+            timeval timeout { 0, (suseconds_t)TCPSocket::timer_interval_ms * 1000 };
+            Thread::current()->wait_on(worker.wait_queue, "NetworkTask", &timeout);
             continue;
         }
-        auto& eth = *(const EthernetFrameHeader*)buffer;
+        handle_frame(packet.value());
+    }
+}
+
+void handle_frame(const PacketBuffer& frame)
+{
+    auto* buffer = frame.data();
+    size_t packet_size = frame.size();
+    if (packet_size < sizeof(EthernetFrameHeader)) {
+        klog() << "NetworkTask: Packet is too small to be an Ethernet packet! (" << packet_size << ")";
+        return;
+    }
+    auto& eth = *(const EthernetFrameHeader*)buffer;
 #ifdef ETHERNET_DEBUG
-        klog() << "NetworkTask: From " << eth.source().to_string().characters() << " to " << eth.destination().to_string().characters() << ", ether_type=" << String::format("%w", eth.ether_type()) << ", packet_length=" << packet_size;
+    klog() << "NetworkTask: From " << eth.source().to_string().characters() << " to " << eth.destination().to_string().characters() << ", ether_type=" << String::format("%w", eth.ether_type()) << ", packet_length=" << packet_size;
 #endif
 
 #ifdef ETHERNET_VERY_DEBUG
-        for (size_t i = 0; i < packet_size; i++) {
-            klog() << String::format("%b", buffer[i]);
-
-            switch (i % 16) {
-            case 7:
-                klog() << "  ";
-                break;
-            case 15:
-                klog() << "";
-                break;
-            default:
-                klog() << " ";
-                break;
-            }
-        }
-
-        klog() << "";
-#endif
+    for (size_t i = 0; i < packet_size; i++) {
+        klog() << String::format("%b", buffer[i]);
 
-        switch (eth.ether_type()) {
-        case EtherType::ARP:
-            handle_arp(eth, packet_size);
-            break;
-        case EtherType::IPv4:
-            handle_ipv4(eth, packet_size);
+        switch (i % 16) {
+        case 7:
+            klog() << "  ";
             break;
-        case EtherType::IPv6:
-            // ignore
+        case 15:
+            klog() << "";
             break;
         default:
-            klog() << "NetworkTask: Unknown ethernet type 0x" << String::format("%x", eth.ether_type());
+            klog() << " ";
+            break;
         }
     }
+
+    klog() << "";
+#endif
+
+    switch (eth.ether_type()) {
+    case EtherType::ARP:
+        handle_arp(eth, packet_size);
+        break;
+    case EtherType::IPv4:
+        handle_ipv4(eth, frame);
+        break;
+    case EtherType::IPv6:
+        // ignore
+        break;
+    default:
+        klog() << "NetworkTask: Unknown ethernet type 0x" << String::format("%x", eth.ether_type());
+    }
 }
 
 void handle_arp(const EthernetFrameHeader& eth, size_t frame_size)
@@ -213,8 +309,9 @@ void handle_arp(const EthernetFrameHeader& eth, size_t frame_size)
     }
 }
 
-void handle_ipv4(const EthernetFrameHeader& eth, size_t frame_size)
+void handle_ipv4(const EthernetFrameHeader& eth, const PacketBuffer& frame)
 {
+    size_t frame_size = frame.size();
     constexpr size_t minimum_ipv4_frame_size = sizeof(EthernetFrameHeader) + sizeof(IPv4Packet);
     if (frame_size < minimum_ipv4_frame_size) {
         klog() << "handle_ipv4: Frame too small (" << frame_size << ", need " << minimum_ipv4_frame_size << ")";
@@ -237,20 +334,25 @@ void handle_ipv4(const EthernetFrameHeader& eth, size_t frame_size)
     klog() << "handle_ipv4: source=" << packet.source().to_string().characters() << ", target=" << packet.destination().to_string().characters();
 #endif
 
+    // Sockets keep this window into the frame instead of a copy of the packet.
+    PacketBuffer packet_buffer = frame;
+    packet_buffer.pull(sizeof(EthernetFrameHeader));
+    packet_buffer.trim(sizeof(IPv4Packet) + packet.payload_size());
+
     switch ((IPv4Protocol)packet.protocol()) {
     case IPv4Protocol::ICMP:
-        return handle_icmp(eth, packet);
+        return handle_icmp(eth, packet, packet_buffer);
     case IPv4Protocol::UDP:
-        return handle_udp(packet);
+        return handle_udp(packet, packet_buffer);
     case IPv4Protocol::TCP:
-        return handle_tcp(packet);
+        return handle_tcp(packet, packet_buffer);
     default:
         klog() << "handle_ipv4: Unhandled protocol " << packet.protocol();
         break;
     }
 }
 
-void handle_icmp(const EthernetFrameHeader& eth, const IPv4Packet& ipv4_packet)
+void handle_icmp(const EthernetFrameHeader& eth, const IPv4Packet& ipv4_packet, const PacketBuffer& packet_buffer)
 {
     auto& icmp_header = *static_cast<const ICMPHeader*>(ipv4_packet.payload());
 #ifdef ICMP_DEBUG
@@ -263,7 +365,7 @@ void handle_icmp(const EthernetFrameHeader& eth, const IPv4Packet& ipv4_packet)
             LOCKER(socket->lock());
             if (socket->protocol() != (unsigned)IPv4Protocol::ICMP)
                 continue;
-            socket->did_receive(ipv4_packet.source(), 0, KBuffer::copy(&ipv4_packet, sizeof(IPv4Packet) + ipv4_packet.payload_size()));
+            socket->did_receive(ipv4_packet.source(), 0, packet_buffer);
         }
     }
 
@@ -289,7 +391,7 @@ void handle_icmp(const EthernetFrameHeader& eth, const IPv4Packet& ipv4_packet)
     }
 }
 
-void handle_udp(const IPv4Packet& ipv4_packet)
+void handle_udp(const IPv4Packet& ipv4_packet, const PacketBuffer& packet_buffer)
 {
     if (ipv4_packet.payload_size() < sizeof(UDPPacket)) {
         klog() << "handle_udp: Packet too small (" << ipv4_packet.payload_size() << ", need " << sizeof(UDPPacket) << ")";
@@ -315,10 +417,10 @@ void handle_udp(const IPv4Packet& ipv4_packet)
 
     ASSERT(socket->type() == SOCK_DGRAM);
     ASSERT(socket->local_port() == udp_packet.destination_port());
-    socket->did_receive(ipv4_packet.source(), udp_packet.source_port(), KBuffer::copy(&ipv4_packet, sizeof(IPv4Packet) + ipv4_packet.payload_size()));
+    socket->did_receive(ipv4_packet.source(), udp_packet.source_port(), packet_buffer);
 }
 
-void handle_tcp(const IPv4Packet& ipv4_packet)
+void handle_tcp(const IPv4Packet& ipv4_packet, const PacketBuffer& packet_buffer)
 {
     if (ipv4_packet.payload_size() < sizeof(TCPPacket)) {
         klog() << "handle_tcp: IPv4 payload is too small to be a TCP packet (" << ipv4_packet.payload_size() << ", need " << sizeof(TCPPacket) << ")";
@@ -398,6 +500,7 @@ void handle_tcp(const IPv4Packet& ipv4_packet)
 #ifdef TCP_DEBUG
             klog() << "handle_tcp: created new client socket with tuple " << client->tuple().to_string().characters();
 #endif
+            client->receive_syn_options(tcp_packet);
             client->set_sequence_number(1000);
             client->set_ack_number(tcp_packet.sequence_number() + payload_size + 1);
             client->send_tcp_packet(TCPFlags::SYN | TCPFlags::ACK);
@@ -546,10 +649,18 @@ void handle_tcp(const IPv4Packet& ipv4_packet)
             return;
         }
     case TCPSocket::State::Established:
-        if (tcp_packet.has_fin()) {
-            if (payload_size != 0)
-                socket->did_receive(ipv4_packet.source(), tcp_packet.source_port(), KBuffer::copy(&ipv4_packet, sizeof(IPv4Packet) + ipv4_packet.payload_size()));
+        if ((payload_size || tcp_packet.has_fin()) && tcp_packet.sequence_number() != socket->ack_number()) {
+            // Out of order or duplicate data. The immediate duplicate ACK lets the peer fast retransmit what we are missing.
+            socket->send_tcp_packet(TCPFlags::ACK);
+            return;
+        }
 
+        if (payload_size && !socket->did_receive(ipv4_packet.source(), tcp_packet.source_port(), packet_buffer)) {
+            // No room for this segment, so don't acknowledge it; the peer will send it again.
+            return;
+        }
+
+        if (tcp_packet.has_fin()) {
             socket->set_ack_number(tcp_packet.sequence_number() + payload_size + 1);
             socket->send_tcp_packet(TCPFlags::ACK);
             socket->set_state(TCPSocket::State::CloseWait);
@@ -563,10 +674,8 @@ void handle_tcp(const IPv4Packet& ipv4_packet)
         klog() << "Got packet with ack_no=" << tcp_packet.ack_number() << ", seq_no=" << tcp_packet.sequence_number() << ", payload_size=" << payload_size << ", acking it with new ack_no=" << socket->ack_number() << ", seq_no=" << socket->sequence_number();
 #endif
 
-        if (payload_size) {
-            if (socket->did_receive(ipv4_packet.source(), tcp_packet.source_port(), KBuffer::copy(&ipv4_packet, sizeof(IPv4Packet) + ipv4_packet.payload_size())))
-                socket->send_tcp_packet(TCPFlags::ACK);
-        }
+        if (payload_size)
+            socket->schedule_delayed_ack();
     }
 }
 
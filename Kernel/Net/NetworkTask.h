@@ -26,9 +26,14 @@
 
 #pragma once
 
+#include <Kernel/Net/IPv4SocketTuple.h>
+
 namespace Kernel {
 class NetworkTask {
 public:
     static void spawn();
+
+    // The worker that handles all packets and timers for this connection.
+    static size_t worker_for(const IPv4SocketTuple&);
 };
 }
@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/Span.h>
+#include <Kernel/KBuffer.h>
+
+namespace Kernel {
+
+// A received packet, as a window into the buffer the adapter received it into. Copying a
+// PacketBuffer shares the underlying storage, so a frame can be handed from the adapter through
+// the protocol layers into a socket's receive queue without being copied along the way.
+class PacketBuffer {
+public:
+    PacketBuffer(const KBuffer& storage, size_t size)
+        : m_storage(storage)
+        , m_size(size)
+    {
+        ASSERT(size <= m_storage.capacity());
+    }
+
+    const u8* data() const { return m_storage.data() + m_offset; }
+    size_t size() const { return m_size; }
+    ReadonlyBytes bytes() const { return { data(), size() }; }
+
+    // Drops the first `count` bytes, e.g. a header that has already been dealt with.
+    void pull(size_t count)
+    {
+        ASSERT(count <= m_size);
+        m_offset += count;
+        m_size -= count;
+    }
+
+    // Drops everything past the first `size` bytes, e.g. the padding at the end of a short frame.
+    void trim(size_t size)
+    {
+        ASSERT(size <= m_size);
+        m_size = size;
+    }
+
+private:
+    KBuffer m_storage;
+    size_t m_offset { 0 };
+    size_t m_size { 0 };
+};
+
+}
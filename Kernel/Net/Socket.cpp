@@ -131,6 +131,14 @@ KResult Socket::setsockopt(int level, int option, Userspace<const void*> user_va
     case SO_KEEPALIVE:
         // FIXME: Obviously, this is not a real keepalive.
         return KSuccess;
+    case SO_REUSEPORT: {
+        if (user_value_size != sizeof(int))
+            return KResult(-EINVAL);
+        int value;
+        copy_from_user(&value, static_ptr_cast<const int*>(user_value));
+        m_reuse_port = value != 0;
+        return KSuccess;
+    }
     default:
         dbg() << "setsockopt(" << option << ") at SOL_SOCKET not implemented.";
         return KResult(-ENOPROTOOPT);
@@ -169,6 +177,15 @@ KResult Socket::getsockopt(FileDescription&, int level, int option, Userspace<vo
         copy_to_user(value_size, &size);
         return KSuccess;
     }
+    case SO_REUSEPORT: {
+        if (size < sizeof(int))
+            return KResult(-EINVAL);
+        int reuse_port = m_reuse_port;
+        copy_to_user(static_ptr_cast<int*>(value), &reuse_port);
+        size = sizeof(int);
+        copy_to_user(value_size, &size);
+        return KSuccess;
+    }
     case SO_BINDTODEVICE:
         if (size < IFNAMSIZ)
             return KResult(-EINVAL);
@@ -205,6 +222,57 @@ KResultOr<size_t> Socket::write(FileDescription& description, size_t, const u8*
     return sendto(description, data, size, 0, nullptr, 0);
 }
 
+KResultOr<size_t> Socket::readv(FileDescription& description, size_t, const iovec* iov, int iov_count)
+{
+    if (is_shut_down_for_reading())
+        return 0;
+    return recvv(description, iov, iov_count);
+}
+
+KResultOr<size_t> Socket::writev(FileDescription& description, size_t, const iovec* iov, int iov_count)
+{
+    if (is_shut_down_for_writing())
+        return -EPIPE;
+    return sendv(description, iov, iov_count);
+}
+
+KResultOr<size_t> Socket::sendv(FileDescription& description, const iovec* iov, int iov_count)
+{
+    size_t total_nsent = 0;
+    for (int i = 0; i < iov_count; ++i) {
+        auto nsent_or_error = sendto(description, iov[i].iov_base, iov[i].iov_len, 0, nullptr, 0);
+        if (nsent_or_error.is_error()) {
+            if (total_nsent)
+                return total_nsent;
+            return nsent_or_error.error();
+        }
+        total_nsent += nsent_or_error.value();
+        if (nsent_or_error.value() < iov[i].iov_len)
+            break;
+    }
+    return total_nsent;
+}
+
+KResultOr<size_t> Socket::recvv(FileDescription& description, const iovec* iov, int iov_count)
+{
+    size_t total_nreceived = 0;
+    for (int i = 0; i < iov_count; ++i) {
+        // Only the first buffer is allowed to block, after that we return whatever has arrived.
+        if (total_nreceived && !can_read(description, 0))
+            break;
+        auto nreceived_or_error = recvfrom(description, iov[i].iov_base, iov[i].iov_len, 0, nullptr, nullptr);
+        if (nreceived_or_error.is_error()) {
+            if (total_nreceived)
+                return total_nreceived;
+            return nreceived_or_error.error();
+        }
+        total_nreceived += nreceived_or_error.value();
+        if (nreceived_or_error.value() < iov[i].iov_len)
+            break;
+    }
+    return total_nreceived;
+}
+
 KResult Socket::shutdown(int how)
 {
     if (type() == SOCK_STREAM && !is_connected())
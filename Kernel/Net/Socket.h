@@ -109,6 +109,9 @@ public:
     virtual void detach(FileDescription&) = 0;
     virtual KResultOr<size_t> sendto(FileDescription&, const void*, size_t, int flags, const sockaddr*, socklen_t) = 0;
     virtual KResultOr<size_t> recvfrom(FileDescription&, void*, size_t, int flags, sockaddr*, socklen_t*) = 0;
+    // Vectored sendto()/recvfrom() for connected sockets. By default these go through the buffers one at a time.
+    virtual KResultOr<size_t> sendv(FileDescription&, const iovec*, int iov_count);
+    virtual KResultOr<size_t> recvv(FileDescription&, const iovec*, int iov_count);
 
     virtual KResult setsockopt(int level, int option, Userspace<const void*>, socklen_t);
     virtual KResult getsockopt(FileDescription&, int level, int option, Userspace<void*>, Userspace<socklen_t*>);
@@ -126,6 +129,8 @@ public:
     // ^File
     virtual KResultOr<size_t> read(FileDescription&, size_t, u8*, size_t) override final;
     virtual KResultOr<size_t> write(FileDescription&, size_t, const u8*, size_t) override final;
+    virtual KResultOr<size_t> readv(FileDescription&, size_t, const iovec*, int iov_count) override final;
+    virtual KResultOr<size_t> writev(FileDescription&, size_t, const iovec*, int iov_count) override final;
     virtual String absolute_path(const FileDescription&) const override = 0;
 
     bool has_receive_timeout() const { return m_receive_timeout.tv_sec || m_receive_timeout.tv_usec; }
@@ -134,6 +139,8 @@ public:
     bool has_send_timeout() const { return m_send_timeout.tv_sec || m_send_timeout.tv_usec; }
     const timeval& send_timeout() const { return m_send_timeout; }
 
+    bool reuse_port() const { return m_reuse_port; }
+
 protected:
     Socket(int domain, int type, int protocol);
 
@@ -166,6 +173,7 @@ private:
     bool m_connected { false };
     bool m_shut_down_for_reading { false };
     bool m_shut_down_for_writing { false };
+    bool m_reuse_port { false };
 
     RefPtr<NetworkAdapter> m_bound_interface { nullptr };
 
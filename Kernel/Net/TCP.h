@@ -41,12 +41,24 @@ struct TCPFlags {
     };
 };
 
+struct TCPOption {
+    enum : u8 {
+        End = 0,
+        NOP = 1,
+        MSS = 2,
+        WindowScale = 3,
+        Timestamp = 8,
+    };
+};
+
 class [[gnu::packed]] TCPPacket
 {
 public:
     TCPPacket() {}
     ~TCPPacket() {}
 
+    static constexpr size_t checksum_offset = 16;
+
     size_t header_size() const { return data_offset() * sizeof(u32); }
 
     u16 source_port() const { return m_source_port; }
@@ -81,6 +93,10 @@ public:
     u16 urgent() const { return m_urgent; }
     void set_urgent(u16 urgent) { m_urgent = urgent; }
 
+    size_t options_size() const { return header_size() - sizeof(TCPPacket); }
+    const u8* options() const { return ((const u8*)this) + sizeof(TCPPacket); }
+    u8* options() { return ((u8*)this) + sizeof(TCPPacket); }
+
     const void* payload() const { return ((const u8*)this) + header_size(); }
     void* payload() { return ((u8*)this) + header_size(); }
 
@@ -24,10 +24,13 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <AK/NonnullRefPtrVector.h>
+#include <AK/Optional.h>
 #include <AK/Time.h>
 #include <Kernel/Devices/RandomDevice.h>
 #include <Kernel/FileSystem/FileDescription.h>
 #include <Kernel/Net/NetworkAdapter.h>
+#include <Kernel/Net/NetworkTask.h>
 #include <Kernel/Net/Routing.h>
 #include <Kernel/Net/TCP.h>
 #include <Kernel/Net/TCPSocket.h>
@@ -38,11 +41,100 @@
 
 namespace Kernel {
 
+struct [[gnu::packed]] TCPTimestampOption
+{
+    u8 kind;
+    u8 length;
+    NetworkOrdered<u32> value;
+    NetworkOrdered<u32> echo_reply;
+};
+
+static_assert(sizeof(TCPTimestampOption) == 10);
+
+struct TCPOptions {
+    Optional<u16> mss;
+    Optional<u8> window_shift;
+    bool has_timestamp { false };
+    u32 timestamp_value { 0 };
+    u32 timestamp_echo_reply { 0 };
+};
+
+static TCPOptions parse_tcp_options(const TCPPacket& packet)
+{
+    TCPOptions options;
+    if (packet.header_size() < sizeof(TCPPacket))
+        return options;
+    const u8* option = packet.options();
+    size_t remaining = packet.options_size();
+    while (remaining) {
+        u8 kind = option[0];
+        if (kind == TCPOption::End)
+            break;
+        if (kind == TCPOption::NOP) {
+            ++option;
+            --remaining;
+            continue;
+        }
+        if (remaining < 2 || option[1] < 2 || option[1] > remaining)
+            break;
+        u8 length = option[1];
+        switch (kind) {
+        case TCPOption::MSS:
+            if (length == 4)
+                options.mss = (option[2] << 8) | option[3];
+            break;
+        case TCPOption::WindowScale:
+            if (length == 3)
+                options.window_shift = min<u8>(option[2], 14);
+            break;
+        case TCPOption::Timestamp:
+            if (length == sizeof(TCPTimestampOption)) {
+                auto& timestamp = *(const TCPTimestampOption*)option;
+                options.has_timestamp = true;
+                options.timestamp_value = timestamp.value;
+                options.timestamp_echo_reply = timestamp.echo_reply;
+            }
+            break;
+        }
+        option += length;
+        remaining -= length;
+    }
+    return options;
+}
+
+static inline bool sequence_before(u32 a, u32 b)
+{
+    return (i32)(a - b) < 0;
+}
+
+static inline bool sequence_before_or_equal(u32 a, u32 b)
+{
+    return (i32)(a - b) <= 0;
+}
+
+static inline bool time_reached(u32 now, u32 deadline)
+{
+    return (i32)(now - deadline) >= 0;
+}
+
+static u32 now_ms()
+{
+    auto now = kgettimeofday();
+    return now.tv_sec * 1000 + now.tv_usec / 1000;
+}
+
 void TCPSocket::for_each(Function<void(const TCPSocket&)> callback)
 {
-    LOCKER(sockets_by_tuple().lock(), Lock::Mode::Shared);
-    for (auto& it : sockets_by_tuple().resource())
-        callback(*it.value);
+    sockets_by_tuple().for_each_stripe([&](auto& stripe) {
+        LOCKER(stripe.lock(), Lock::Mode::Shared);
+        for (auto& it : stripe.resource())
+            callback(*it.value);
+    });
+    LOCKER(listening_sockets().lock(), Lock::Mode::Shared);
+    for (auto& it : listening_sockets().resource()) {
+        for (auto* socket : it.value)
+            callback(*socket);
+    }
 }
 
 void TCPSocket::set_state(State new_state)
@@ -70,33 +162,44 @@ Lockable<HashMap<IPv4SocketTuple, RefPtr<TCPSocket>>>& TCPSocket::closing_socket
     return *s_map;
 }
 
-Lockable<HashMap<IPv4SocketTuple, TCPSocket*>>& TCPSocket::sockets_by_tuple()
+SocketTable<IPv4SocketTuple, TCPSocket*>& TCPSocket::sockets_by_tuple()
 {
-    static Lockable<HashMap<IPv4SocketTuple, TCPSocket*>>* s_map;
+    static SocketTable<IPv4SocketTuple, TCPSocket*>* s_table;
+    if (!s_table)
+        s_table = new SocketTable<IPv4SocketTuple, TCPSocket*>;
+    return *s_table;
+}
+
+Lockable<HashMap<IPv4SocketTuple, Vector<TCPSocket*>>>& TCPSocket::listening_sockets()
+{
+    static Lockable<HashMap<IPv4SocketTuple, Vector<TCPSocket*>>>* s_map;
     if (!s_map)
-        s_map = new Lockable<HashMap<IPv4SocketTuple, TCPSocket*>>;
+        s_map = new Lockable<HashMap<IPv4SocketTuple, Vector<TCPSocket*>>>;
     return *s_map;
 }
 
 RefPtr<TCPSocket> TCPSocket::from_tuple(const IPv4SocketTuple& tuple)
 {
-    LOCKER(sockets_by_tuple().lock(), Lock::Mode::Shared);
-
-    auto exact_match = sockets_by_tuple().resource().get(tuple);
-    if (exact_match.has_value())
-        return { *exact_match.value() };
-
-    auto address_tuple = IPv4SocketTuple(tuple.local_address(), tuple.local_port(), IPv4Address(), 0);
-    auto address_match = sockets_by_tuple().resource().get(address_tuple);
-    if (address_match.has_value())
-        return { *address_match.value() };
+    {
+        auto& stripe = sockets_by_tuple().stripe_for(tuple);
+        LOCKER(stripe.lock(), Lock::Mode::Shared);
+        auto exact_match = stripe.resource().get(tuple);
+        if (exact_match.has_value())
+            return { *exact_match.value() };
+    }
 
-    auto wildcard_tuple = IPv4SocketTuple(IPv4Address(), tuple.local_port(), IPv4Address(), 0);
-    auto wildcard_match = sockets_by_tuple().resource().get(wildcard_tuple);
-    if (wildcard_match.has_value())
-        return { *wildcard_match.value() };
+    LOCKER(listening_sockets().lock(), Lock::Mode::Shared);
+    auto& listeners = listening_sockets().resource();
+    auto it = listeners.find(IPv4SocketTuple(tuple.local_address(), tuple.local_port(), IPv4Address(), 0));
+    if (it == listeners.end())
+        it = listeners.find(IPv4SocketTuple(IPv4Address(), tuple.local_port(), IPv4Address(), 0));
+    if (it == listeners.end())
+        return {};
 
-    return {};
+    // With SO_REUSEPORT there can be several listeners, and each connection sticks to one of them.
+    auto& group = (*it).value;
+    ASSERT(!group.is_empty());
+    return { *group[Traits<IPv4SocketTuple>::hash(tuple) % group.size()] };
 }
 
 RefPtr<TCPSocket> TCPSocket::from_endpoints(const IPv4Address& local_address, u16 local_port, const IPv4Address& peer_address, u16 peer_port)
@@ -108,8 +211,11 @@ RefPtr<TCPSocket> TCPSocket::create_client(const IPv4Address& new_local_address,
 {
     auto tuple = IPv4SocketTuple(new_local_address, new_local_port, new_peer_address, new_peer_port);
 
-    LOCKER(sockets_by_tuple().lock());
-    if (sockets_by_tuple().resource().contains(tuple))
+    // Connections to one listener can be set up by several NetworkTask workers at once.
+    Locker socket_locker(lock());
+    auto& stripe = sockets_by_tuple().stripe_for(tuple);
+    Locker stripe_locker(stripe.lock());
+    if (stripe.resource().contains(tuple))
         return {};
 
     auto client = TCPSocket::create(protocol());
@@ -123,9 +229,9 @@ RefPtr<TCPSocket> TCPSocket::create_client(const IPv4Address& new_local_address,
     client->set_originator(*this);
 
     m_pending_release_for_accept.set(tuple, client);
-    sockets_by_tuple().resource().set(tuple, client);
+    stripe.resource().set(tuple, client);
 
-    return from_tuple(tuple);
+    return client;
 }
 
 void TCPSocket::release_to_originator()
@@ -136,6 +242,7 @@ void TCPSocket::release_to_originator()
 
 void TCPSocket::release_for_accept(RefPtr<TCPSocket> socket)
 {
+    LOCKER(lock());
     ASSERT(m_pending_release_for_accept.contains(socket->tuple()));
     m_pending_release_for_accept.remove(socket->tuple());
     // FIXME: Should we observe this error somehow?
@@ -145,12 +252,29 @@ void TCPSocket::release_for_accept(RefPtr<TCPSocket> socket)
 TCPSocket::TCPSocket(int protocol)
     : IPv4Socket(SOCK_STREAM, protocol)
 {
+    // Window scaling lets us keep more than 64 KiB in flight towards us.
+    (void)set_receive_buffer_capacity(receive_buffer_size);
 }
 
 TCPSocket::~TCPSocket()
 {
-    LOCKER(sockets_by_tuple().lock());
-    sockets_by_tuple().resource().remove(tuple());
+    if (m_is_listening) {
+        LOCKER(listening_sockets().lock());
+        auto it = listening_sockets().resource().find(tuple());
+        ASSERT(it != listening_sockets().resource().end());
+        (*it).value.remove_first_matching([this](auto* socket) { return socket == this; });
+        if ((*it).value.is_empty())
+            listening_sockets().resource().remove(it);
+    } else {
+        auto& stripe = sockets_by_tuple().stripe_for(tuple());
+        LOCKER(stripe.lock());
+        auto it = stripe.resource().find(tuple());
+        if (it != stripe.resource().end() && (*it).value == this)
+            stripe.resource().remove(it);
+    }
+
+    while (auto* packet = m_not_acked.remove_head())
+        delete packet;
 
 #ifdef TCP_SOCKET_DEBUG
     dbg() << "~TCPSocket in state " << to_string(state());
@@ -162,133 +286,442 @@ NonnullRefPtr<TCPSocket> TCPSocket::create(int protocol)
     return adopt(*new TCPSocket(protocol));
 }
 
-KResultOr<size_t> TCPSocket::protocol_receive(const KBuffer& packet_buffer, void* buffer, size_t buffer_size, int flags)
+ReadonlyBytes TCPSocket::protocol_payload(ReadonlyBytes packet) const
 {
-    (void)flags;
-    auto& ipv4_packet = *(const IPv4Packet*)(packet_buffer.data());
+    auto& ipv4_packet = *(const IPv4Packet*)(packet.data());
     auto& tcp_packet = *static_cast<const TCPPacket*>(ipv4_packet.payload());
-    size_t payload_size = packet_buffer.size() - sizeof(IPv4Packet) - tcp_packet.header_size();
+    size_t payload_size = packet.size() - sizeof(IPv4Packet) - tcp_packet.header_size();
 #ifdef TCP_SOCKET_DEBUG
-    klog() << "payload_size " << payload_size << ", will it fit in " << buffer_size << "?";
+    klog() << "payload_size " << payload_size;
 #endif
-    ASSERT(buffer_size >= payload_size);
-    memcpy(buffer, tcp_packet.payload(), payload_size);
-    return payload_size;
+    return { (const u8*)tcp_packet.payload(), payload_size };
 }
 
 KResultOr<size_t> TCPSocket::protocol_send(const void* data, size_t data_length)
 {
-    send_tcp_packet(TCPFlags::PUSH | TCPFlags::ACK, data, data_length);
-    return data_length;
+    LOCKER(m_not_acked_lock);
+    size_t nwritten = m_send_buffer.write((const u8*)data, data_length);
+    if (!nwritten)
+        return KResult(-EAGAIN);
+    m_unsent_bytes += nwritten;
+    send_outgoing_packets();
+    return nwritten;
+}
+
+bool TCPSocket::can_write(const FileDescription& description, size_t size) const
+{
+    return IPv4Socket::can_write(description, size) && m_send_buffer.space_for_writing();
+}
+
+u16 TCPSocket::advertised_window()
+{
+    size_t space = receive_buffer_space();
+    if (m_window_scaling)
+        space >>= receive_window_shift;
+    m_last_advertised_window = min<size_t>(space, 0xffff);
+    return m_last_advertised_window;
 }
 
 void TCPSocket::send_tcp_packet(u16 flags, const void* payload, size_t payload_size)
 {
-    auto buffer = ByteBuffer::create_zeroed(sizeof(TCPPacket) + payload_size);
+    LOCKER(m_not_acked_lock);
+
+    u8 options[20];
+    size_t options_size = 0;
+    size_t timestamp_offset = 0;
+    auto append_timestamp_option = [&] {
+        options[options_size++] = TCPOption::NOP;
+        options[options_size++] = TCPOption::NOP;
+        timestamp_offset = sizeof(TCPPacket) + options_size;
+        options[options_size++] = TCPOption::Timestamp;
+        options[options_size++] = sizeof(TCPTimestampOption);
+        memset(&options[options_size], 0, sizeof(TCPTimestampOption) - 2);
+        options_size += sizeof(TCPTimestampOption) - 2;
+    };
+
+    if (flags & TCPFlags::SYN) {
+        u16 mss = local_mss();
+        options[options_size++] = TCPOption::MSS;
+        options[options_size++] = 4;
+        options[options_size++] = mss >> 8;
+        options[options_size++] = mss & 0xff;
+        // A SYN offers every option we support; a SYN|ACK only echoes the ones the peer offered.
+        bool is_initial_syn = !(flags & TCPFlags::ACK);
+        if (is_initial_syn || m_window_scaling) {
+            options[options_size++] = TCPOption::NOP;
+            options[options_size++] = TCPOption::WindowScale;
+            options[options_size++] = 3;
+            options[options_size++] = receive_window_shift;
+        }
+        if (is_initial_syn || m_timestamps)
+            append_timestamp_option();
+    } else if (m_timestamps && !(flags & TCPFlags::RST)) {
+        append_timestamp_option();
+    }
+    ASSERT(options_size <= sizeof(options));
+    ASSERT(options_size % sizeof(u32) == 0);
+
+    auto buffer = ByteBuffer::create_zeroed(sizeof(TCPPacket) + options_size + payload_size);
     auto& tcp_packet = *(TCPPacket*)(buffer.data());
     ASSERT(local_port());
     tcp_packet.set_source_port(local_port());
     tcp_packet.set_destination_port(peer_port());
-    tcp_packet.set_window_size(1024);
+    // The window in a SYN is never scaled.
+    tcp_packet.set_window_size(min<size_t>(receive_buffer_space(), 0xffff));
     tcp_packet.set_sequence_number(m_sequence_number);
-    tcp_packet.set_data_offset(sizeof(TCPPacket) / sizeof(u32));
+    tcp_packet.set_data_offset((sizeof(TCPPacket) + options_size) / sizeof(u32));
     tcp_packet.set_flags(flags);
+    memcpy(tcp_packet.options(), options, options_size);
+    // The payload's part of the checksum is worked out while copying it, and kept for retransmissions.
+    u32 payload_checksum = internet_checksum_add_and_copy(tcp_packet.payload(), payload, payload_size);
 
-    if (flags & TCPFlags::ACK)
-        tcp_packet.set_ack_number(m_ack_number);
-
-    if (flags & TCPFlags::SYN) {
-        ++m_sequence_number;
-    } else {
-        m_sequence_number += payload_size;
+    if (flags & TCPFlags::ACK) {
+        m_segments_awaiting_ack = 0;
+        m_delayed_ack_deadline_ms = 0;
     }
 
-    memcpy(tcp_packet.payload(), payload, payload_size);
-    tcp_packet.set_checksum(compute_tcp_checksum(local_address(), peer_address(), tcp_packet, payload_size));
+    u32 sequence_number = m_sequence_number;
+    m_sequence_number += payload_size;
+    if (flags & (TCPFlags::SYN | TCPFlags::FIN))
+        ++m_sequence_number;
 
-    if (tcp_packet.has_syn() || payload_size > 0) {
-        LOCKER(m_not_acked_lock);
-        m_not_acked.append({ m_sequence_number, move(buffer) });
-        send_outgoing_packets();
+    if (m_sequence_number != sequence_number) {
+        if (m_not_acked.is_empty())
+            m_retransmission_timer_start_ms = now_ms();
+        auto* packet = new OutgoingPacket(sequence_number, m_sequence_number, move(buffer), timestamp_offset, payload_checksum);
+        m_not_acked.append(packet);
+        packet->tx_counter++;
+        packet->tx_time_ms = now_ms();
+        send_segment(packet->buffer, packet->timestamp_offset, packet->payload_checksum);
         return;
     }
 
+    send_segment(buffer, timestamp_offset, payload_checksum);
+}
+
+void TCPSocket::send_segment(ByteBuffer& buffer, size_t timestamp_offset, u32 payload_checksum)
+{
     auto routing_decision = route_to(peer_address(), local_address(), bound_interface());
     ASSERT(!routing_decision.is_zero());
 
+    // Segments sitting in the retransmission queue are refreshed so that they carry our current view of the connection.
+    auto& tcp_packet = *(TCPPacket*)(buffer.data());
+    if (tcp_packet.has_ack())
+        tcp_packet.set_ack_number(m_ack_number);
+    if (!tcp_packet.has_syn())
+        tcp_packet.set_window_size(advertised_window());
+    if (timestamp_offset) {
+        auto& option = *(TCPTimestampOption*)(buffer.data() + timestamp_offset);
+        option.value = now_ms();
+        option.echo_reply = m_peer_timestamp;
+    }
+    tcp_packet.set_checksum(0);
+    u32 checksum = compute_pseudo_header_checksum(local_address(), peer_address(), buffer.size());
+    Optional<size_t> offloaded_checksum_offset;
+    if (routing_decision.adapter->has_transmit_checksum_offload() && sizeof(IPv4Packet) + buffer.size() <= routing_decision.adapter->mtu()) {
+        tcp_packet.set_checksum(internet_checksum_fold(checksum));
+        offloaded_checksum_offset = TCPPacket::checksum_offset;
+    } else {
+        checksum = internet_checksum_add(&tcp_packet, tcp_packet.header_size(), checksum);
+        tcp_packet.set_checksum(internet_checksum_finish(checksum + payload_checksum));
+    }
+
+#ifdef TCP_SOCKET_DEBUG
+    klog() << "sending tcp packet from " << local_address().to_string().characters() << ":" << local_port() << " to " << peer_address().to_string().characters() << ":" << peer_port() << " with (" << (tcp_packet.has_syn() ? "SYN " : "") << (tcp_packet.has_ack() ? "ACK " : "") << (tcp_packet.has_fin() ? "FIN " : "") << (tcp_packet.has_rst() ? "RST " : "") << ") seq_no=" << tcp_packet.sequence_number() << ", ack_no=" << tcp_packet.ack_number() << ", size=" << buffer.size();
+#endif
+
     routing_decision.adapter->send_ipv4(
         routing_decision.next_hop, peer_address(), IPv4Protocol::TCP,
-        buffer.span(), ttl());
+        buffer.span(), ttl(), offloaded_checksum_offset);
 
     m_packets_out++;
     m_bytes_out += buffer.size();
 }
 
+void TCPSocket::retransmit(OutgoingPacket& packet)
+{
+    packet.tx_counter++;
+    packet.tx_time_ms = now_ms();
+    m_retransmits++;
+    send_segment(packet.buffer, packet.timestamp_offset, packet.payload_checksum);
+}
+
 void TCPSocket::send_outgoing_packets()
 {
-    auto routing_decision = route_to(peer_address(), local_address(), bound_interface());
-    ASSERT(!routing_decision.is_zero());
+    LOCKER(m_not_acked_lock);
 
-    auto now = kgettimeofday();
+    while (m_unsent_bytes) {
+        u32 window = min(m_congestion_window, m_peer_window);
+        u32 in_flight = bytes_in_flight();
+        if (in_flight >= window)
+            break;
+        size_t segment_size = min<size_t>(min<size_t>(m_mss, window - in_flight), m_unsent_bytes);
+        if (segment_size < m_mss && in_flight) {
+            // Wait for the window to open further instead of sending a sliver of it.
+            if (segment_size < m_unsent_bytes)
+                break;
+            // Nagle's algorithm: only one small segment may be outstanding.
+            if (!m_no_delay)
+                break;
+        }
 
-    LOCKER(m_not_acked_lock, Lock::Mode::Shared);
-    for (auto& packet : m_not_acked) {
-        timeval diff;
-        timeval_sub(packet.tx_time, now, diff);
-        if (diff.tv_sec == 0 && diff.tv_usec <= 500000)
-            continue;
-        packet.tx_time = now;
-        packet.tx_counter++;
+        auto payload = ByteBuffer::create_uninitialized(segment_size);
+        size_t nread = 0;
+        while (nread < segment_size) {
+            size_t n = m_send_buffer.read(payload.data() + nread, segment_size - nread);
+            ASSERT(n);
+            nread += n;
+        }
+        m_unsent_bytes -= segment_size;
+        send_tcp_packet(TCPFlags::PUSH | TCPFlags::ACK, payload.data(), segment_size);
+    }
 
-#ifdef TCP_SOCKET_DEBUG
-        auto& tcp_packet = *(TCPPacket*)(packet.buffer.data());
-        klog() << "sending tcp packet from " << local_address().to_string().characters() << ":" << local_port() << " to " << peer_address().to_string().characters() << ":" << peer_port() << " with (" << (tcp_packet.has_syn() ? "SYN " : "") << (tcp_packet.has_ack() ? "ACK " : "") << (tcp_packet.has_fin() ? "FIN " : "") << (tcp_packet.has_rst() ? "RST " : "") << ") seq_no=" << tcp_packet.sequence_number() << ", ack_no=" << tcp_packet.ack_number() << ", tx_counter=" << packet.tx_counter;
-#endif
-        routing_decision.adapter->send_ipv4(
-            routing_decision.next_hop, peer_address(), IPv4Protocol::TCP,
-            packet.buffer.span(), ttl());
+    if (m_fin_pending && !m_unsent_bytes) {
+        m_fin_pending = false;
+        send_tcp_packet(TCPFlags::FIN | TCPFlags::ACK);
+    }
+}
 
-        m_packets_out++;
-        m_bytes_out += packet.buffer.size();
+void TCPSocket::queue_fin()
+{
+    LOCKER(m_not_acked_lock);
+    m_fin_pending = true;
+    send_outgoing_packets();
+}
+
+void TCPSocket::schedule_delayed_ack()
+{
+    LOCKER(m_not_acked_lock);
+    if (++m_segments_awaiting_ack >= 2) {
+        send_tcp_packet(TCPFlags::ACK);
+        return;
     }
+    m_delayed_ack_deadline_ms = now_ms() + delayed_ack_timeout_ms;
 }
 
-void TCPSocket::receive_tcp_packet(const TCPPacket& packet, u16 size)
+void TCPSocket::protocol_did_read()
+{
+    // Let the peer know about a window that has opened up considerably since we last advertised it.
+    LOCKER(m_not_acked_lock);
+    if (state() != State::Established)
+        return;
+    size_t space = receive_buffer_space();
+    size_t last_advertised_space = m_window_scaling ? (size_t)m_last_advertised_window << receive_window_shift : m_last_advertised_window;
+    if (space >= last_advertised_space + 2 * m_mss)
+        send_tcp_packet(TCPFlags::ACK);
+}
+
+u16 TCPSocket::local_mss() const
 {
-    if (packet.has_ack()) {
-        u32 ack_number = packet.ack_number();
+    auto routing_decision = route_to(peer_address(), local_address(), bound_interface());
+    if (routing_decision.is_zero())
+        return default_mss;
+    return min<u32>(routing_decision.adapter->mtu(), 0xffff) - sizeof(IPv4Packet) - sizeof(TCPPacket);
+}
+
+void TCPSocket::receive_syn_options(const TCPPacket& packet)
+{
+    LOCKER(m_not_acked_lock);
+    auto options = parse_tcp_options(packet);
+
+    // For a SYN|ACK this is the peer echoing what we offered, for a SYN it is what the peer offers us. Either way, an option is in use only if it is present here.
+    m_window_scaling = options.window_shift.has_value();
+    m_peer_window_shift = options.window_shift.value_or(0);
+    m_timestamps = options.has_timestamp;
+    if (m_timestamps)
+        m_peer_timestamp = options.timestamp_value;
+
+    m_mss = min(options.mss.value_or(default_mss), local_mss());
+    // The MSS doesn't account for options, and every segment will carry a timestamp.
+    if (m_timestamps)
+        m_mss -= 2 + sizeof(TCPTimestampOption);
+    m_peer_window = packet.window_size();
+    // RFC 6928 initial window.
+    m_congestion_window = 10 * m_mss;
+}
+
+void TCPSocket::update_peer_window(const TCPPacket& packet)
+{
+    if (packet.has_syn())
+        m_peer_window = packet.window_size();
+    else
+        m_peer_window = (u32)packet.window_size() << m_peer_window_shift;
+}
+
+void TCPSocket::update_retransmission_timeout(u32 rtt_sample_ms)
+{
+    // RFC 6298, section 2.
+    if (!m_have_rtt_sample) {
+        m_smoothed_rtt_ms = rtt_sample_ms;
+        m_rtt_variance_ms = rtt_sample_ms / 2;
+        m_have_rtt_sample = true;
+    } else {
+        u32 delta = m_smoothed_rtt_ms > rtt_sample_ms ? m_smoothed_rtt_ms - rtt_sample_ms : rtt_sample_ms - m_smoothed_rtt_ms;
+        m_rtt_variance_ms = (3 * m_rtt_variance_ms + delta) / 4;
+        m_smoothed_rtt_ms = (7 * m_smoothed_rtt_ms + rtt_sample_ms) / 8;
+    }
+    u32 timeout = m_smoothed_rtt_ms + max(timer_interval_ms, 4 * m_rtt_variance_ms);
+    m_retransmission_timeout_ms = min(max(timeout, minimum_retransmission_timeout_ms), maximum_retransmission_timeout_ms);
+}
+
+void TCPSocket::process_ack(const TCPPacket& packet, size_t payload_size, u32 echoed_timestamp, bool window_changed)
+{
+    u32 ack_number = packet.ack_number();
 
 #ifdef TCP_SOCKET_DEBUG
-        dbg() << "TCPSocket: receive_tcp_packet: " << ack_number;
+    dbg() << "TCPSocket: process_ack: " << ack_number;
 #endif
 
+    if (sequence_before(m_sequence_number, ack_number))
+        return;
+
+    if (sequence_before(m_send_unacknowledged, ack_number)) {
+        u32 acked = ack_number - m_send_unacknowledged;
+        m_send_unacknowledged = ack_number;
+        m_duplicate_acks = 0;
+
+        auto now = now_ms();
+        Optional<u32> rtt_sample;
         int removed = 0;
-        LOCKER(m_not_acked_lock);
         while (!m_not_acked.is_empty()) {
-            auto& packet = m_not_acked.first();
+            auto& packet = *m_not_acked.head();
+            if (!sequence_before_or_equal(packet.ack_number, ack_number))
+                break;
+            // Karn's algorithm: never sample the round trip time of a retransmitted segment.
+            if (packet.tx_counter == 1)
+                rtt_sample = now - packet.tx_time_ms;
+            delete m_not_acked.remove_head();
+            removed++;
+        }
+        if (echoed_timestamp)
+            rtt_sample = now - echoed_timestamp;
+        if (rtt_sample.has_value())
+            update_retransmission_timeout(rtt_sample.value());
+        m_retransmission_timer_start_ms = now;
 
 #ifdef TCP_SOCKET_DEBUG
-            dbg() << "TCPSocket: iterate: " << packet.ack_number;
+        dbg() << "TCPSocket: process_ack acknowledged " << removed << " packets";
 #endif
 
-            if (packet.ack_number <= ack_number) {
-                m_not_acked.take_first();
-                removed++;
-            } else {
-                break;
-            }
+        if (sequence_before(ack_number, m_recovery_point)) {
+            // A partial ACK during recovery means the segment after it was lost as well.
+            if (!m_not_acked.is_empty())
+                retransmit(*m_not_acked.head());
+            if (m_in_fast_recovery)
+                m_congestion_window = (m_congestion_window > acked ? m_congestion_window - acked : 0) + m_mss;
+        } else if (m_in_fast_recovery) {
+            m_in_fast_recovery = false;
+            m_congestion_window = m_slow_start_threshold;
+        } else if (m_congestion_window < m_slow_start_threshold) {
+            m_congestion_window += min(acked, (u32)m_mss);
+        } else {
+            m_congestion_window += max(1u, (u32)m_mss * m_mss / m_congestion_window);
         }
+        m_congestion_window = min(m_congestion_window, maximum_congestion_window);
+        return;
+    }
 
-#ifdef TCP_SOCKET_DEBUG
-        dbg() << "TCPSocket: receive_tcp_packet acknowledged " << removed << " packets";
-#endif
+    if (ack_number != m_send_unacknowledged || payload_size || window_changed || packet.has_syn() || packet.has_fin() || m_not_acked.is_empty())
+        return;
+
+    ++m_duplicate_acks;
+    if (m_duplicate_acks == 3 && !m_in_fast_recovery) {
+        // Fast retransmit and fast recovery (RFC 6582).
+        m_slow_start_threshold = max(bytes_in_flight() / 2, 2u * m_mss);
+        m_congestion_window = m_slow_start_threshold + 3 * m_mss;
+        m_recovery_point = m_sequence_number;
+        m_in_fast_recovery = true;
+        m_fast_retransmits++;
+        retransmit(*m_not_acked.head());
+    } else if (m_duplicate_acks > 3 && m_in_fast_recovery) {
+        m_congestion_window += m_mss;
+    }
+}
+
+void TCPSocket::enter_loss_recovery()
+{
+    // RFC 5681, section 3.1: collapse the window and start over from slow start.
+    m_slow_start_threshold = max(bytes_in_flight() / 2, 2u * m_mss);
+    m_congestion_window = m_mss;
+    m_in_fast_recovery = false;
+    m_duplicate_acks = 0;
+    m_recovery_point = m_sequence_number;
+    // RFC 6298, section 5.5: back off the timer.
+    m_retransmission_timeout_ms = min(m_retransmission_timeout_ms * 2, maximum_retransmission_timeout_ms);
+    retransmit(*m_not_acked.head());
+}
+
+void TCPSocket::on_timer(u32 now)
+{
+    LOCKER(m_not_acked_lock);
+    if (state() == State::Closed || state() == State::Listen || state() == State::TimeWait)
+        return;
+
+    if (m_segments_awaiting_ack && time_reached(now, m_delayed_ack_deadline_ms))
+        send_tcp_packet(TCPFlags::ACK);
+
+    if (!time_reached(now, m_retransmission_timer_start_ms + m_retransmission_timeout_ms))
+        return;
+    m_retransmission_timer_start_ms = now;
+
+    if (!m_not_acked.is_empty()) {
+        enter_loss_recovery();
+        return;
+    }
+
+    if (m_unsent_bytes && !m_peer_window) {
+        // Zero window probe: pretend the peer has room for a single byte. Its ACK will tell us the real window.
+        m_peer_window = 1;
+        send_outgoing_packets();
+    }
+}
+
+void TCPSocket::run_timers(size_t worker_index)
+{
+    NonnullRefPtrVector<TCPSocket> sockets;
+    sockets_by_tuple().for_each_stripe([&](auto& stripe) {
+        LOCKER(stripe.lock(), Lock::Mode::Shared);
+        for (auto& it : stripe.resource()) {
+            if (NetworkTask::worker_for(it.key) == worker_index)
+                sockets.append(*it.value);
+        }
+    });
+
+    auto now = now_ms();
+    for (auto& socket : sockets)
+        socket.on_timer(now);
+}
+
+void TCPSocket::receive_tcp_packet(const TCPPacket& packet, u16 size)
+{
+    if (packet.has_syn() && state() != State::Listen)
+        receive_syn_options(packet);
+
+    {
+        LOCKER(m_not_acked_lock);
+        auto options = parse_tcp_options(packet);
+        u32 echoed_timestamp = 0;
+        if (m_timestamps && options.has_timestamp) {
+            if (sequence_before_or_equal(m_peer_timestamp, options.timestamp_value))
+                m_peer_timestamp = options.timestamp_value;
+            echoed_timestamp = options.timestamp_echo_reply;
+        }
+
+        if (packet.has_ack()) {
+            u32 old_peer_window = m_peer_window;
+            update_peer_window(packet);
+            process_ack(packet, size - packet.header_size(), echoed_timestamp, m_peer_window != old_peer_window);
+        }
+
+        if (m_unsent_bytes || m_fin_pending)
+            send_outgoing_packets();
     }
 
     m_packets_in++;
     m_bytes_in += packet.header_size() + size;
 }
 
-NetworkOrdered<u16> TCPSocket::compute_tcp_checksum(const IPv4Address& source, const IPv4Address& destination, const TCPPacket& packet, u16 payload_size)
+u32 TCPSocket::compute_pseudo_header_checksum(const IPv4Address& source, const IPv4Address& destination, u16 tcp_length)
 {
     struct [[gnu::packed]] PseudoHeader
     {
@@ -296,38 +729,59 @@ NetworkOrdered<u16> TCPSocket::compute_tcp_checksum(const IPv4Address& source, c
         IPv4Address destination;
         u8 zero;
         u8 protocol;
-        NetworkOrdered<u16> payload_size;
+        NetworkOrdered<u16> tcp_length;
     };
 
-    PseudoHeader pseudo_header { source, destination, 0, (u8)IPv4Protocol::TCP, sizeof(TCPPacket) + payload_size };
+    PseudoHeader pseudo_header { source, destination, 0, (u8)IPv4Protocol::TCP, tcp_length };
+    return internet_checksum_add(&pseudo_header, sizeof(pseudo_header));
+}
 
-    u32 checksum = 0;
-    auto* w = (const NetworkOrdered<u16>*)&pseudo_header;
-    for (size_t i = 0; i < sizeof(pseudo_header) / sizeof(u16); ++i) {
-        checksum += w[i];
-        if (checksum > 0xffff)
-            checksum = (checksum >> 16) + (checksum & 0xffff);
+KResult TCPSocket::setsockopt(int level, int option, Userspace<const void*> user_value, socklen_t user_value_size)
+{
+    if (level != IPPROTO_TCP)
+        return IPv4Socket::setsockopt(level, option, user_value, user_value_size);
+
+    switch (option) {
+    case TCP_NODELAY: {
+        if (user_value_size < sizeof(int))
+            return KResult(-EINVAL);
+        int value;
+        if (!Process::current()->validate_read_and_copy_typed(&value, static_ptr_cast<const int*>(user_value)))
+            return KResult(-EFAULT);
+        LOCKER(m_not_acked_lock);
+        m_no_delay = value;
+        // Anything Nagle's algorithm was holding back can go out now.
+        if (m_no_delay)
+            send_outgoing_packets();
+        return KSuccess;
     }
-    w = (const NetworkOrdered<u16>*)&packet;
-    for (size_t i = 0; i < sizeof(packet) / sizeof(u16); ++i) {
-        checksum += w[i];
-        if (checksum > 0xffff)
-            checksum = (checksum >> 16) + (checksum & 0xffff);
+    default:
+        return KResult(-ENOPROTOOPT);
     }
-    ASSERT(packet.data_offset() * 4 == sizeof(TCPPacket));
-    w = (const NetworkOrdered<u16>*)packet.payload();
-    for (size_t i = 0; i < payload_size / sizeof(u16); ++i) {
-        checksum += w[i];
-        if (checksum > 0xffff)
-            checksum = (checksum >> 16) + (checksum & 0xffff);
+}
+
+KResult TCPSocket::getsockopt(FileDescription& description, int level, int option, Userspace<void*> value, Userspace<socklen_t*> value_size)
+{
+    if (level != IPPROTO_TCP)
+        return IPv4Socket::getsockopt(description, level, option, value, value_size);
+
+    socklen_t size;
+    if (!Process::current()->validate_read_and_copy_typed(&size, value_size))
+        return KResult(-EFAULT);
+
+    switch (option) {
+    case TCP_NODELAY: {
+        if (size < sizeof(int))
+            return KResult(-EINVAL);
+        int no_delay = m_no_delay;
+        copy_to_user(static_ptr_cast<int*>(value), &no_delay);
+        size = sizeof(int);
+        copy_to_user(value_size, &size);
+        return KSuccess;
     }
-    if (payload_size & 1) {
-        u16 expanded_byte = ((const u8*)packet.payload())[payload_size - 1] << 8;
-        checksum += expanded_byte;
-        if (checksum > 0xffff)
-            checksum = (checksum >> 16) + (checksum & 0xffff);
+    default:
+        return KResult(-ENOPROTOOPT);
     }
-    return ~(checksum & 0xffff);
 }
 
 KResult TCPSocket::protocol_bind()
@@ -343,10 +797,27 @@ KResult TCPSocket::protocol_bind()
 
 KResult TCPSocket::protocol_listen()
 {
-    LOCKER(sockets_by_tuple().lock());
-    if (sockets_by_tuple().resource().contains(tuple()))
-        return KResult(-EADDRINUSE);
-    sockets_by_tuple().resource().set(tuple(), this);
+    {
+        // listen() without bind() gets an ephemeral port, which registers us as a connected socket.
+        auto& stripe = sockets_by_tuple().stripe_for(tuple());
+        LOCKER(stripe.lock());
+        auto it = stripe.resource().find(tuple());
+        if (it != stripe.resource().end() && (*it).value == this)
+            stripe.resource().remove(it);
+    }
+
+    LOCKER(listening_sockets().lock());
+    auto it = listening_sockets().resource().find(tuple());
+    if (it == listening_sockets().resource().end()) {
+        listening_sockets().resource().set(tuple(), { this });
+    } else {
+        // Several sockets can listen on the same address if they all asked for it, and belong to the same user.
+        auto& group = (*it).value;
+        if (!reuse_port() || !group.first()->reuse_port() || group.first()->origin_uid() != origin_uid())
+            return KResult(-EADDRINUSE);
+        group.append(this);
+    }
+    m_is_listening = true;
     set_direction(Direction::Passive);
     set_state(State::Listen);
     set_setup_state(SetupState::Completed);
@@ -363,7 +834,7 @@ KResult TCPSocket::protocol_connect(FileDescription& description, ShouldBlock sh
 
     allocate_local_port_if_needed();
 
-    m_sequence_number = get_good_random<u32>();
+    set_sequence_number(get_good_random<u32>());
     m_ack_number = 0;
 
     set_setup_state(SetupState::InProgress);
@@ -388,19 +859,17 @@ KResult TCPSocket::protocol_connect(FileDescription& description, ShouldBlock sh
 
 int TCPSocket::protocol_allocate_local_port()
 {
-    static const u16 first_ephemeral_port = 32768;
-    static const u16 last_ephemeral_port = 60999;
-    static const u16 ephemeral_port_range_size = last_ephemeral_port - first_ephemeral_port;
-    u16 first_scan_port = first_ephemeral_port + get_good_random<u16>() % ephemeral_port_range_size;
+    auto destination_hash = pair_int_hash(pair_int_hash(local_address().to_u32(), peer_address().to_u32()), peer_port());
+    u16 first_scan_port = ephemeral_port_search_start(destination_hash);
 
-    LOCKER(sockets_by_tuple().lock());
     for (u16 port = first_scan_port;;) {
         IPv4SocketTuple proposed_tuple(local_address(), port, peer_address(), peer_port());
 
-        auto it = sockets_by_tuple().resource().find(proposed_tuple);
-        if (it == sockets_by_tuple().resource().end()) {
+        auto& stripe = sockets_by_tuple().stripe_for(proposed_tuple);
+        LOCKER(stripe.lock());
+        if (!stripe.resource().contains(proposed_tuple)) {
             set_local_port(port);
-            sockets_by_tuple().resource().set(proposed_tuple, this);
+            stripe.resource().set(proposed_tuple, this);
             return port;
         }
         ++port;
@@ -434,7 +903,7 @@ void TCPSocket::shut_down_for_writing()
 #ifdef TCP_SOCKET_DEBUG
         dbg() << " Sending FIN/ACK from Established and moving into FinWait1";
 #endif
-        send_tcp_packet(TCPFlags::FIN | TCPFlags::ACK);
+        queue_fin();
         set_state(State::FinWait1);
     } else {
         dbg() << " Shutting down TCPSocket for writing but not moving to FinWait1 since state is " << to_string(state());
@@ -448,7 +917,7 @@ KResult TCPSocket::close()
 #ifdef TCP_SOCKET_DEBUG
         dbg() << " Sending FIN from CloseWait and moving into LastAck";
 #endif
-        send_tcp_packet(TCPFlags::FIN | TCPFlags::ACK);
+        queue_fin();
         set_state(State::LastAck);
     }
 
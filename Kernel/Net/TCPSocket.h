@@ -28,9 +28,12 @@
 
 #include <AK/Function.h>
 #include <AK/HashMap.h>
-#include <AK/SinglyLinkedList.h>
+#include <AK/InlineLinkedList.h>
 #include <AK/WeakPtr.h>
+#include <Kernel/DoubleBuffer.h>
+#include <Kernel/Heap/SlabAllocator.h>
 #include <Kernel/Net/IPv4Socket.h>
+#include <Kernel/Net/SocketTable.h>
 
 namespace Kernel {
 
@@ -41,6 +44,19 @@ public:
     static NonnullRefPtr<TCPSocket> create(int protocol);
     virtual ~TCPSocket() override;
 
+    static constexpr size_t send_buffer_size = 256 * KB;
+    static constexpr size_t receive_buffer_size = 256 * KB;
+    // Our advertised windows are scaled by this much once the peer agrees to window scaling (RFC 7323).
+    static constexpr u8 receive_window_shift = 3;
+    static constexpr u16 default_mss = 536;
+    static constexpr u32 maximum_congestion_window = 2 * send_buffer_size;
+    // How often NetworkTask calls run_timers() to drive retransmissions and delayed ACKs.
+    static constexpr u32 timer_interval_ms = 50;
+    static constexpr u32 delayed_ack_timeout_ms = 100;
+    static constexpr u32 initial_retransmission_timeout_ms = 1000;
+    static constexpr u32 minimum_retransmission_timeout_ms = 200;
+    static constexpr u32 maximum_retransmission_timeout_ms = 60000;
+
     enum class Direction {
         Unspecified,
         Outgoing,
@@ -141,19 +157,38 @@ public:
     void set_error(Error error) { m_error = error; }
 
     void set_ack_number(u32 n) { m_ack_number = n; }
-    void set_sequence_number(u32 n) { m_sequence_number = n; }
+    void set_sequence_number(u32 n)
+    {
+        m_sequence_number = n;
+        m_send_unacknowledged = n;
+    }
     u32 ack_number() const { return m_ack_number; }
     u32 sequence_number() const { return m_sequence_number; }
     u32 packets_in() const { return m_packets_in; }
     u32 bytes_in() const { return m_bytes_in; }
     u32 packets_out() const { return m_packets_out; }
     u32 bytes_out() const { return m_bytes_out; }
+    u32 congestion_window() const { return m_congestion_window; }
+    u32 slow_start_threshold() const { return m_slow_start_threshold; }
+    u32 smoothed_rtt_ms() const { return m_smoothed_rtt_ms; }
+    u32 retransmission_timeout_ms() const { return m_retransmission_timeout_ms; }
+    u32 retransmits() const { return m_retransmits; }
+    u32 fast_retransmits() const { return m_fast_retransmits; }
 
     void send_tcp_packet(u16 flags, const void* = nullptr, size_t = 0);
     void send_outgoing_packets();
     void receive_tcp_packet(const TCPPacket&, u16 size);
+    void receive_syn_options(const TCPPacket&);
+
+    // Acknowledges in-order data, either immediately (every second segment) or when the delayed ACK timer fires.
+    void schedule_delayed_ack();
 
-    static Lockable<HashMap<IPv4SocketTuple, TCPSocket*>>& sockets_by_tuple();
+    // Called periodically by each NetworkTask worker, for the sockets it owns.
+    static void run_timers(size_t worker_index);
+
+    // Connected sockets are keyed by their full tuple, listening sockets by (local address, local port) only.
+    static SocketTable<IPv4SocketTuple, TCPSocket*>& sockets_by_tuple();
+    static Lockable<HashMap<IPv4SocketTuple, Vector<TCPSocket*>>>& listening_sockets();
     static RefPtr<TCPSocket> from_tuple(const IPv4SocketTuple& tuple);
     static RefPtr<TCPSocket> from_endpoints(const IPv4Address& local_address, u16 local_port, const IPv4Address& peer_address, u16 peer_port);
 
@@ -166,6 +201,9 @@ public:
     void release_for_accept(RefPtr<TCPSocket>);
 
     virtual KResult close() override;
+    virtual bool can_write(const FileDescription&, size_t) const override;
+    virtual KResult setsockopt(int level, int option, Userspace<const void*>, socklen_t) override;
+    virtual KResult getsockopt(FileDescription&, int level, int option, Userspace<void*>, Userspace<socklen_t*>) override;
 
 protected:
     void set_direction(Direction direction) { m_direction = direction; }
@@ -174,11 +212,22 @@ private:
     explicit TCPSocket(int protocol);
     virtual const char* class_name() const override { return "TCPSocket"; }
 
-    static NetworkOrdered<u16> compute_tcp_checksum(const IPv4Address& source, const IPv4Address& destination, const TCPPacket&, u16 payload_size);
+    static u32 compute_pseudo_header_checksum(const IPv4Address& source, const IPv4Address& destination, u16 tcp_length);
 
     virtual void shut_down_for_writing() override;
+    virtual void protocol_did_read() override;
+
+    void on_timer(u32 now_ms);
+    void update_peer_window(const TCPPacket&);
+    void process_ack(const TCPPacket&, size_t payload_size, u32 echoed_timestamp, bool window_changed);
+    void update_retransmission_timeout(u32 rtt_sample_ms);
+    void enter_loss_recovery();
+    void queue_fin();
+    u32 bytes_in_flight() const { return m_sequence_number - m_send_unacknowledged; }
+    u16 advertised_window();
+    u16 local_mss() const;
 
-    virtual KResultOr<size_t> protocol_receive(const KBuffer&, void* buffer, size_t buffer_size, int flags) override;
+    virtual ReadonlyBytes protocol_payload(ReadonlyBytes ipv4_packet) const override;
     virtual KResultOr<size_t> protocol_send(const void*, size_t) override;
     virtual KResult protocol_connect(FileDescription&, ShouldBlock) override;
     virtual int protocol_allocate_local_port() override;
@@ -199,15 +248,74 @@ private:
     u32 m_packets_out { 0 };
     u32 m_bytes_out { 0 };
 
-    struct OutgoingPacket {
+    // Send state. m_sequence_number is the next sequence number to be sent (SND.NXT).
+    u32 m_send_unacknowledged { 0 };
+    u32 m_peer_window { default_mss };
+    u16 m_mss { default_mss };
+    u8 m_peer_window_shift { 0 };
+    bool m_window_scaling { false };
+    bool m_timestamps { false };
+    bool m_no_delay { false };
+    bool m_is_listening { false };
+    bool m_fin_pending { false };
+    u32 m_peer_timestamp { 0 };
+
+    // NewReno congestion control (RFC 5681, RFC 6582).
+    u32 m_congestion_window { 10 * default_mss };
+    u32 m_slow_start_threshold { 0xffffffff };
+    u32 m_duplicate_acks { 0 };
+    bool m_in_fast_recovery { false };
+    u32 m_recovery_point { 0 };
+
+    // Retransmission timer (RFC 6298).
+    bool m_have_rtt_sample { false };
+    u32 m_smoothed_rtt_ms { 0 };
+    u32 m_rtt_variance_ms { 0 };
+    u32 m_retransmission_timeout_ms { initial_retransmission_timeout_ms };
+    u32 m_retransmission_timer_start_ms { 0 };
+    u32 m_retransmits { 0 };
+    u32 m_fast_retransmits { 0 };
+
+    u32 m_segments_awaiting_ack { 0 };
+    u32 m_delayed_ack_deadline_ms { 0 };
+    u16 m_last_advertised_window { 0 };
+
+    DoubleBuffer m_send_buffer { send_buffer_size };
+    size_t m_unsent_bytes { 0 };
+
+    struct OutgoingPacket : public InlineLinkedListNode<OutgoingPacket> {
+        MAKE_SLAB_CACHED(OutgoingPacket, TCPOutgoingPacket)
+
+    public:
+        OutgoingPacket(u32 sequence_number, u32 ack_number, ByteBuffer&& buffer, size_t timestamp_offset, u32 payload_checksum)
+            : sequence_number(sequence_number)
+            , ack_number(ack_number)
+            , buffer(move(buffer))
+            , timestamp_offset(timestamp_offset)
+            , payload_checksum(payload_checksum)
+        {
+        }
+
+        u32 sequence_number { 0 };
+        // The acknowledgment number that covers this whole segment.
         u32 ack_number { 0 };
         ByteBuffer buffer;
+        // Offset of the timestamp option within the segment, or 0 if there is none.
+        size_t timestamp_offset { 0 };
+        // Partial internet checksum of the payload, which never changes.
+        u32 payload_checksum { 0 };
         int tx_counter { 0 };
-        timeval tx_time { 0, 0 };
+        u32 tx_time_ms { 0 };
+
+        OutgoingPacket* m_next { nullptr };
+        OutgoingPacket* m_prev { nullptr };
     };
 
+    void send_segment(ByteBuffer&, size_t timestamp_offset, u32 payload_checksum);
+    void retransmit(OutgoingPacket&);
+
     Lock m_not_acked_lock { "TCPSocket unacked packets" };
-    SinglyLinkedList<OutgoingPacket> m_not_acked;
+    InlineLinkedList<OutgoingPacket> m_not_acked;
 };
 
 }
@@ -30,32 +30,34 @@
 #include <Kernel/Net/UDP.h>
 #include <Kernel/Net/UDPSocket.h>
 #include <Kernel/Process.h>
-#include <Kernel/Random.h>
 
 namespace Kernel {
 
 void UDPSocket::for_each(Function<void(const UDPSocket&)> callback)
 {
-    LOCKER(sockets_by_port().lock(), Lock::Mode::Shared);
-    for (auto it : sockets_by_port().resource())
-        callback(*it.value);
+    sockets_by_port().for_each_stripe([&](auto& stripe) {
+        LOCKER(stripe.lock(), Lock::Mode::Shared);
+        for (auto it : stripe.resource())
+            callback(*it.value);
+    });
 }
 
-Lockable<HashMap<u16, UDPSocket*>>& UDPSocket::sockets_by_port()
+SocketTable<u16, UDPSocket*>& UDPSocket::sockets_by_port()
 {
-    static Lockable<HashMap<u16, UDPSocket*>>* s_map;
-    if (!s_map)
-        s_map = new Lockable<HashMap<u16, UDPSocket*>>;
-    return *s_map;
+    static SocketTable<u16, UDPSocket*>* s_table;
+    if (!s_table)
+        s_table = new SocketTable<u16, UDPSocket*>;
+    return *s_table;
 }
 
 SocketHandle<UDPSocket> UDPSocket::from_port(u16 port)
 {
     RefPtr<UDPSocket> socket;
     {
-        LOCKER(sockets_by_port().lock(), Lock::Mode::Shared);
-        auto it = sockets_by_port().resource().find(port);
-        if (it == sockets_by_port().resource().end())
+        auto& stripe = sockets_by_port().stripe_for(port);
+        LOCKER(stripe.lock(), Lock::Mode::Shared);
+        auto it = stripe.resource().find(port);
+        if (it == stripe.resource().end())
             return {};
         socket = (*it).value;
         ASSERT(socket);
@@ -70,8 +72,11 @@ UDPSocket::UDPSocket(int protocol)
 
 UDPSocket::~UDPSocket()
 {
-    LOCKER(sockets_by_port().lock());
-    sockets_by_port().resource().remove(local_port());
+    auto& stripe = sockets_by_port().stripe_for(local_port());
+    LOCKER(stripe.lock());
+    auto it = stripe.resource().find(local_port());
+    if (it != stripe.resource().end() && (*it).value == this)
+        stripe.resource().remove(it);
 }
 
 NonnullRefPtr<UDPSocket> UDPSocket::create(int protocol)
@@ -79,15 +84,12 @@ NonnullRefPtr<UDPSocket> UDPSocket::create(int protocol)
     return adopt(*new UDPSocket(protocol));
 }
 
-KResultOr<size_t> UDPSocket::protocol_receive(const KBuffer& packet_buffer, void* buffer, size_t buffer_size, int flags)
+ReadonlyBytes UDPSocket::protocol_payload(ReadonlyBytes packet) const
 {
-    (void)flags;
-    auto& ipv4_packet = *(const IPv4Packet*)(packet_buffer.data());
+    auto& ipv4_packet = *(const IPv4Packet*)(packet.data());
     auto& udp_packet = *static_cast<const UDPPacket*>(ipv4_packet.payload());
     ASSERT(udp_packet.length() >= sizeof(UDPPacket)); // FIXME: This should be rejected earlier.
-    ASSERT(buffer_size >= (udp_packet.length() - sizeof(UDPPacket)));
-    memcpy(buffer, udp_packet.payload(), udp_packet.length() - sizeof(UDPPacket));
-    return udp_packet.length() - sizeof(UDPPacket);
+    return { (const u8*)udp_packet.payload(), udp_packet.length() - sizeof(UDPPacket) };
 }
 
 KResultOr<size_t> UDPSocket::protocol_send(const void* data, size_t data_length)
@@ -115,17 +117,15 @@ KResult UDPSocket::protocol_connect(FileDescription&, ShouldBlock)
 
 int UDPSocket::protocol_allocate_local_port()
 {
-    static const u16 first_ephemeral_port = 32768;
-    static const u16 last_ephemeral_port = 60999;
-    static const u16 ephemeral_port_range_size = last_ephemeral_port - first_ephemeral_port;
-    u16 first_scan_port = first_ephemeral_port + get_good_random<u16>() % ephemeral_port_range_size;
+    // UDP sockets are demultiplexed by local port alone, so the peer doesn't help spread allocations out.
+    u16 first_scan_port = ephemeral_port_search_start(0);
 
-    LOCKER(sockets_by_port().lock());
     for (u16 port = first_scan_port;;) {
-        auto it = sockets_by_port().resource().find(port);
-        if (it == sockets_by_port().resource().end()) {
+        auto& stripe = sockets_by_port().stripe_for(port);
+        LOCKER(stripe.lock());
+        if (!stripe.resource().contains(port)) {
             set_local_port(port);
-            sockets_by_port().resource().set(port, this);
+            stripe.resource().set(port, this);
             return port;
         }
         ++port;
@@ -139,10 +139,11 @@ int UDPSocket::protocol_allocate_local_port()
 
 KResult UDPSocket::protocol_bind()
 {
-    LOCKER(sockets_by_port().lock());
-    if (sockets_by_port().resource().contains(local_port()))
+    auto& stripe = sockets_by_port().stripe_for(local_port());
+    LOCKER(stripe.lock());
+    if (stripe.resource().contains(local_port()))
         return KResult(-EADDRINUSE);
-    sockets_by_port().resource().set(local_port(), this);
+    stripe.resource().set(local_port(), this);
     return KSuccess;
 }
 
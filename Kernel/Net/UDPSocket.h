@@ -27,6 +27,7 @@
 #pragma once
 
 #include <Kernel/Net/IPv4Socket.h>
+#include <Kernel/Net/SocketTable.h>
 
 namespace Kernel {
 
@@ -41,9 +42,9 @@ public:
 private:
     explicit UDPSocket(int protocol);
     virtual const char* class_name() const override { return "UDPSocket"; }
-    static Lockable<HashMap<u16, UDPSocket*>>& sockets_by_port();
+    static SocketTable<u16, UDPSocket*>& sockets_by_port();
 
-    virtual KResultOr<size_t> protocol_receive(const KBuffer&, void* buffer, size_t buffer_size, int flags) override;
+    virtual ReadonlyBytes protocol_payload(ReadonlyBytes ipv4_packet) const override;
     virtual KResultOr<size_t> protocol_send(const void*, size_t) override;
     virtual KResult protocol_connect(FileDescription&, ShouldBlock) override;
     virtual int protocol_allocate_local_port() override;
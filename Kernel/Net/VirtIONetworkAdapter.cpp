@@ -0,0 +1,352 @@
+/*
+ * Copyright (c) 2020, The SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+//#define VIRTIO_NET_DEBUG
+
+#include <AK/Memory.h>
+#include <Kernel/Net/VirtIONetworkAdapter.h>
+#include <Kernel/VM/MemoryManager.h>
+
+namespace Kernel {
+
+// Feature bits
+#define VIRTIO_NET_F_CSUM 0
+#define VIRTIO_NET_F_MAC 5
+#define VIRTIO_NET_F_STATUS 16
+#define VIRTIO_NET_F_CTRL_VQ 17
+#define VIRTIO_NET_F_MQ 22
+
+// Device configuration
+#define VIRTIO_NET_CONFIG_MAC 0
+#define VIRTIO_NET_CONFIG_STATUS 6
+#define VIRTIO_NET_CONFIG_MAX_VIRTQUEUE_PAIRS 8
+#define VIRTIO_NET_S_LINK_UP 1
+
+#define VIRTIO_NET_HDR_F_NEEDS_CSUM 1
+
+// Control queue commands
+#define VIRTIO_NET_CTRL_MQ 4
+#define VIRTIO_NET_CTRL_MQ_VQ_PAIRS_SET 0
+#define VIRTIO_NET_OK 0
+
+void VirtIONetworkAdapter::detect()
+{
+    static const PCI::ID legacy_network_device_id = { VirtIODevice::pci_vendor_id, 0x1000 };
+
+    PCI::enumerate([&](const PCI::Address& address, PCI::ID id) {
+        if (address.is_null())
+            return;
+        if (id != legacy_network_device_id)
+            return;
+        auto adapter = adopt(*new VirtIONetworkAdapter(address));
+        if (!adapter->initialize()) {
+            adapter->fail_initialization();
+            return;
+        }
+        (void)adapter.leak_ref();
+    });
+}
+
+VirtIONetworkAdapter::VirtIONetworkAdapter(PCI::Address address)
+    : VirtIODevice(address)
+{
+    set_interface_name("virtio");
+}
+
+VirtIONetworkAdapter::~VirtIONetworkAdapter()
+{
+}
+
+bool VirtIONetworkAdapter::initialize()
+{
+    klog() << "VirtIONetworkAdapter: Found @ " << pci_address();
+
+    u32 single_queue_features = (1 << VIRTIO_NET_F_CSUM) | (1 << VIRTIO_NET_F_MAC) | (1 << VIRTIO_NET_F_STATUS);
+    negotiate_features(single_queue_features | (1 << VIRTIO_NET_F_CTRL_VQ) | (1 << VIRTIO_NET_F_MQ));
+
+    // The control queue comes after all of the device's queue pairs, so we can only use it when we're willing to set them all up.
+    u16 device_queue_pairs = 1;
+    if (has_feature(VIRTIO_NET_F_MQ) && has_feature(VIRTIO_NET_F_CTRL_VQ))
+        device_queue_pairs = config_read16(VIRTIO_NET_CONFIG_MAX_VIRTQUEUE_PAIRS);
+    bool use_multiqueue = device_queue_pairs > 1 && device_queue_pairs <= max_queue_pairs;
+    if (!use_multiqueue) {
+        negotiate_features(single_queue_features);
+        device_queue_pairs = 1;
+    }
+
+    if (!setup_queues(device_queue_pairs * 2 + (use_multiqueue ? 1 : 0)))
+        return false;
+
+    if (has_feature(VIRTIO_NET_F_MAC)) {
+        u8 mac[6];
+        for (u16 i = 0; i < 6; ++i)
+            mac[i] = config_read8(VIRTIO_NET_CONFIG_MAC + i);
+        set_mac_address(mac);
+    } else {
+        u8 mac[6];
+        get_good_random_bytes(mac, sizeof(mac));
+        // A locally administered unicast address.
+        mac[0] = (mac[0] & ~1) | 2;
+        set_mac_address(mac);
+    }
+    const auto& mac = mac_address();
+    klog() << "VirtIONetworkAdapter: MAC address: " << String::format("%b", mac[0]) << ":" << String::format("%b", mac[1]) << ":" << String::format("%b", mac[2]) << ":" << String::format("%b", mac[3]) << ":" << String::format("%b", mac[4]) << ":" << String::format("%b", mac[5]);
+
+    finish_initialization();
+
+    // The device only uses the first pair until told otherwise.
+    u16 queue_pairs = 1;
+    if (use_multiqueue) {
+        queue(queue_count() - 1).set_interrupts_enabled(false);
+        if (set_queue_pair_count(device_queue_pairs))
+            queue_pairs = device_queue_pairs;
+        else
+            klog() << "VirtIONetworkAdapter: Couldn't enable " << device_queue_pairs << " queue pairs";
+    }
+
+    for (u16 pair = 0; pair < queue_pairs; ++pair) {
+        auto receive_queue = make<ReceiveQueue>();
+        receive_queue->queue_index = pair * 2;
+        if (!setup_receive_queue(*receive_queue))
+            return false;
+        m_receive_queues.append(move(receive_queue));
+
+        auto transmit_queue = make<TransmitQueue>();
+        transmit_queue->queue_index = pair * 2 + 1;
+        if (!setup_transmit_queue(*transmit_queue))
+            return false;
+        m_transmit_queues.append(move(transmit_queue));
+    }
+
+    set_transmit_checksum_offload(has_feature(VIRTIO_NET_F_CSUM));
+    klog() << "VirtIONetworkAdapter: Using " << queue_pairs << " queue pair(s)" << (has_feature(VIRTIO_NET_F_CSUM) ? ", transmit checksum offload" : "");
+    return true;
+}
+
+bool VirtIONetworkAdapter::set_queue_pair_count(u16 queue_pairs)
+{
+    auto region = MM.allocate_contiguous_kernel_region(PAGE_SIZE, "VirtIONetworkAdapter Control", Region::Access::Read | Region::Access::Write);
+    if (!region)
+        return false;
+    auto* command = region->vaddr().as_ptr();
+    command[0] = VIRTIO_NET_CTRL_MQ;
+    command[1] = VIRTIO_NET_CTRL_MQ_VQ_PAIRS_SET;
+    *(u16*)(command + 2) = queue_pairs;
+    auto& ack = *(volatile u8*)(command + 4);
+    ack = 0xff;
+
+    auto address = region->physical_page(0)->paddr();
+    VirtIOQueue::Buffer buffers[] = {
+        { address, 2, false },
+        { address.offset(2), 2, false },
+        { address.offset(4), 1, true },
+    };
+    u16 control_queue = queue_count() - 1;
+    if (!queue(control_queue).enqueue(buffers, 3, 0))
+        return false;
+    publish_queue(control_queue);
+
+    // This only happens once while starting up, so just poll for the answer.
+    for (size_t i = 0; !queue(control_queue).has_completions(); ++i) {
+        if (i == 100000)
+            return false;
+        IO::delay(10);
+    }
+    (void)queue(control_queue).take_completion();
+    return ack == VIRTIO_NET_OK;
+}
+
+bool VirtIONetworkAdapter::setup_receive_queue(ReceiveQueue& receive_queue)
+{
+    auto& virtqueue = queue(receive_queue.queue_index);
+    // Every buffer takes two descriptors, one for the header and one for the frame.
+    size_t slot_count = min((size_t)virtqueue.size() / 2, max_receive_slots);
+    receive_queue.headers_region = MM.allocate_contiguous_kernel_region(PAGE_ROUND_UP(slot_count * header_slot_size), "VirtIONetworkAdapter RX", Region::Access::Read | Region::Access::Write);
+    if (!receive_queue.headers_region)
+        return false;
+    receive_queue.buffers.ensure_capacity(slot_count);
+    for (size_t slot = 0; slot < slot_count; ++slot) {
+        receive_queue.buffers.append(take_packet_buffer());
+        post_receive_buffer(receive_queue, slot);
+    }
+    publish_queue(receive_queue.queue_index);
+    return true;
+}
+
+bool VirtIONetworkAdapter::setup_transmit_queue(TransmitQueue& transmit_queue)
+{
+    auto& virtqueue = queue(transmit_queue.queue_index);
+    size_t slot_count = min((size_t)virtqueue.size() / 2, max_transmit_slots);
+    transmit_queue.slots_region = MM.allocate_contiguous_kernel_region(PAGE_ROUND_UP(slot_count * transmit_slot_size), "VirtIONetworkAdapter TX", Region::Access::Read | Region::Access::Write);
+    if (!transmit_queue.slots_region)
+        return false;
+    transmit_queue.free_slots.ensure_capacity(slot_count);
+    for (size_t slot = 0; slot < slot_count; ++slot)
+        transmit_queue.free_slots.append(slot);
+    // Used slots are reclaimed by the next send, so interrupts are only wanted while someone waits for one.
+    virtqueue.set_interrupts_enabled(false);
+    return true;
+}
+
+void VirtIONetworkAdapter::post_receive_buffer(ReceiveQueue& receive_queue, u16 slot)
+{
+    VirtIOQueue::Buffer buffers[] = {
+        { receive_queue.headers_region->physical_page(0)->paddr().offset(slot * header_slot_size), sizeof(PacketHeader), true },
+        { receive_queue.buffers[slot].impl().region().physical_page(0)->paddr(), (u32)packet_buffer_size(), true },
+    };
+    bool did_enqueue = queue(receive_queue.queue_index).enqueue(buffers, 2, slot);
+    ASSERT(did_enqueue);
+}
+
+void VirtIONetworkAdapter::handle_queue_interrupt(u16 queue_index)
+{
+    m_entropy_source.add_random_event(queue_index);
+
+    if (queue_index >= m_receive_queues.size() * 2)
+        return;
+
+    if (queue_index % 2 == 0) {
+        // Leave the receive interrupts off until NetworkTask has emptied the ring.
+        queue(queue_index).set_interrupts_enabled(false);
+        schedule_receive_poll();
+        return;
+    }
+
+    auto& transmit_queue = m_transmit_queues[queue_index / 2];
+    ScopedSpinLock lock(transmit_queue.lock);
+    queue(queue_index).set_interrupts_enabled(false);
+    transmit_queue.wait_queue.wake_all();
+}
+
+bool VirtIONetworkAdapter::poll_receive(size_t budget)
+{
+    size_t received = 0;
+    for (auto& receive_queue : m_receive_queues) {
+        auto& virtqueue = queue(receive_queue.queue_index);
+        bool did_take_buffers = false;
+        while (received < budget) {
+            auto completion = virtqueue.take_completion();
+            if (!completion.has_value())
+                break;
+            u16 slot = completion.value().token;
+            size_t length = completion.value().length;
+            ASSERT(length >= sizeof(PacketHeader) && length - sizeof(PacketHeader) <= packet_buffer_size());
+            length -= sizeof(PacketHeader);
+#ifdef VIRTIO_NET_DEBUG
+            klog() << "VirtIONetworkAdapter: Received " << length << " bytes on queue " << receive_queue.queue_index;
+#endif
+            // Hand the filled buffer up the stack and give the slot a fresh one.
+            auto buffer = take_packet_buffer();
+            swap(buffer, receive_queue.buffers[slot]);
+            post_receive_buffer(receive_queue, slot);
+            did_take_buffers = true;
+            ++received;
+            did_receive(PacketBuffer(buffer, length));
+        }
+        if (did_take_buffers)
+            publish_queue(receive_queue.queue_index);
+    }
+    if (received == budget)
+        return true;
+
+    // Frames that arrived after we looked wouldn't interrupt, so they're caught by the next poll.
+    bool has_more = false;
+    for (auto& receive_queue : m_receive_queues) {
+        auto& virtqueue = queue(receive_queue.queue_index);
+        virtqueue.set_interrupts_enabled(true);
+        if (virtqueue.has_completions())
+            has_more = true;
+    }
+    return has_more;
+}
+
+void VirtIONetworkAdapter::send_raw(ReadonlyBytes frame)
+{
+    PacketHeader header {};
+    transmit(frame, header);
+}
+
+void VirtIONetworkAdapter::send_raw_with_checksum(Bytes frame, size_t checksum_start, size_t checksum_offset)
+{
+    if (!has_feature(VIRTIO_NET_F_CSUM) || checksum_offset > 0xffff) {
+        NetworkAdapter::send_raw_with_checksum(frame, checksum_start, checksum_offset);
+        return;
+    }
+    PacketHeader header {};
+    header.flags = VIRTIO_NET_HDR_F_NEEDS_CSUM;
+    header.checksum_start = checksum_start;
+    // The device wants this relative to where the checksummed data starts.
+    header.checksum_offset = checksum_offset - checksum_start;
+    transmit(frame, header);
+}
+
+void VirtIONetworkAdapter::transmit(ReadonlyBytes frame, const PacketHeader& header)
+{
+    ASSERT(frame.size() <= transmit_slot_size - header_slot_size);
+    auto& transmit_queue = m_transmit_queues[Processor::current().id() % m_transmit_queues.size()];
+    auto& virtqueue = queue(transmit_queue.queue_index);
+#ifdef VIRTIO_NET_DEBUG
+    klog() << "VirtIONetworkAdapter: Sending " << frame.size() << " bytes on queue " << transmit_queue.queue_index;
+#endif
+    for (;;) {
+        {
+            ScopedSpinLock lock(transmit_queue.lock);
+            for (auto completion = virtqueue.take_completion(); completion.has_value(); completion = virtqueue.take_completion())
+                transmit_queue.free_slots.append(completion.value().token);
+
+            if (!transmit_queue.free_slots.is_empty()) {
+                u16 slot = transmit_queue.free_slots.take_last();
+                auto* slot_data = transmit_queue.slots_region->vaddr().offset(slot * transmit_slot_size).as_ptr();
+                memcpy(slot_data, &header, sizeof(PacketHeader));
+                memcpy(slot_data + header_slot_size, frame.data(), frame.size());
+
+                auto slot_address = transmit_queue.slots_region->physical_page(0)->paddr().offset(slot * transmit_slot_size);
+                VirtIOQueue::Buffer buffers[] = {
+                    { slot_address, sizeof(PacketHeader), false },
+                    { slot_address.offset(header_slot_size), (u32)frame.size(), false },
+                };
+                bool did_enqueue = virtqueue.enqueue(buffers, 2, slot);
+                ASSERT(did_enqueue);
+                publish_queue(transmit_queue.queue_index);
+                return;
+            }
+
+            virtqueue.set_interrupts_enabled(true);
+            if (virtqueue.has_completions())
+                continue;
+        }
+        Thread::current()->wait_on(transmit_queue.wait_queue, "VirtIONetworkAdapter");
+    }
+}
+
+bool VirtIONetworkAdapter::link_up()
+{
+    if (!has_feature(VIRTIO_NET_F_STATUS))
+        return true;
+    return config_read16(VIRTIO_NET_CONFIG_STATUS) & VIRTIO_NET_S_LINK_UP;
+}
+
+}
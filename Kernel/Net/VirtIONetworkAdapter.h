@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2020, The SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/NonnullOwnPtrVector.h>
+#include <AK/OwnPtr.h>
+#include <Kernel/Net/NetworkAdapter.h>
+#include <Kernel/Random.h>
+#include <Kernel/SpinLock.h>
+#include <Kernel/VirtIO/VirtIODevice.h>
+#include <Kernel/WaitQueue.h>
+
+namespace Kernel {
+
+// A paravirtual network adapter. Every queue pair has its own receive and transmit virtqueue
+// and interrupt vectors, and senders pick a transmit queue by the processor they run on.
+class VirtIONetworkAdapter final : public NetworkAdapter
+    , public VirtIODevice {
+public:
+    static void detect();
+
+    virtual ~VirtIONetworkAdapter() override;
+
+    virtual void send_raw(ReadonlyBytes) override;
+    virtual void send_raw_with_checksum(Bytes, size_t checksum_start, size_t checksum_offset) override;
+    virtual bool link_up() override;
+
+    virtual const char* purpose() const override { return class_name(); }
+
+private:
+    explicit VirtIONetworkAdapter(PCI::Address);
+
+    virtual const char* class_name() const override { return "VirtIONetworkAdapter"; }
+    virtual bool poll_receive(size_t budget) override;
+
+    // ^VirtIODevice
+    virtual void handle_queue_interrupt(u16 queue_index) override;
+
+    // The legacy header, which goes in front of every frame in both directions.
+    struct [[gnu::packed]] PacketHeader
+    {
+        u8 flags;
+        u8 gso_type;
+        u16 header_length;
+        u16 gso_size;
+        u16 checksum_start;
+        u16 checksum_offset;
+    };
+
+    struct ReceiveQueue {
+        u16 queue_index { 0 };
+        // Received headers land here, while the frames go straight into pooled packet buffers.
+        OwnPtr<Region> headers_region;
+        Vector<KBuffer> buffers;
+    };
+
+    struct TransmitQueue {
+        u16 queue_index { 0 };
+        SpinLock<u8> lock;
+        // Frames are copied in here behind their header, one slot each.
+        OwnPtr<Region> slots_region;
+        Vector<u16> free_slots;
+        WaitQueue wait_queue;
+    };
+
+    bool initialize();
+    bool setup_receive_queue(ReceiveQueue&);
+    bool setup_transmit_queue(TransmitQueue&);
+    bool set_queue_pair_count(u16);
+    void post_receive_buffer(ReceiveQueue&, u16 slot);
+    void transmit(ReadonlyBytes, const PacketHeader&);
+
+    static constexpr u16 max_queue_pairs = 8;
+    static constexpr size_t max_receive_slots = 128;
+    static constexpr size_t max_transmit_slots = 64;
+    static constexpr size_t transmit_slot_size = 2048;
+    static constexpr size_t header_slot_size = 16;
+
+    NonnullOwnPtrVector<ReceiveQueue> m_receive_queues;
+    NonnullOwnPtrVector<TransmitQueue> m_transmit_queues;
+    EntropySource m_entropy_source;
+};
+
+}
@@ -193,6 +193,11 @@ u8 get_class(Address address)
     return read8(address, PCI_CLASS);
 }
 
+u8 get_programming_interface(Address address)
+{
+    return read8(address, PCI_PROG_IF);
+}
+
 u16 get_subsystem_id(Address address)
 {
     return read16(address, PCI_SUBSYSTEM_ID);
@@ -211,6 +216,11 @@ void enable_bus_mastering(Address address)
     write16(address, PCI_COMMAND, value);
 }
 
+void enable_memory_space(Address address)
+{
+    write16(address, PCI_COMMAND, read16(address, PCI_COMMAND) | (1 << 1));
+}
+
 void disable_bus_mastering(Address address)
 {
     auto value = read16(address, PCI_COMMAND);
@@ -219,6 +229,12 @@ void disable_bus_mastering(Address address)
     write16(address, PCI_COMMAND, value);
 }
 
+u32 get_BAR(Address address, u8 bar_number)
+{
+    ASSERT(bar_number < 6);
+    return read32(address, PCI_BAR0 + (bar_number << 2));
+}
+
 size_t get_BAR_space_size(Address address, u8 bar_number)
 {
     // See PCI Spec 2.3, Page 222
@@ -233,5 +249,19 @@ size_t get_BAR_space_size(Address address, u8 bar_number)
     return space_size;
 }
 
+Optional<u8> find_capability(Address address, u8 capability_id)
+{
+    if (!(read16(address, PCI_STATUS) & PCI_STATUS_CAPABILITIES_LIST))
+        return {};
+    // The low two bits of each pointer are reserved. The list is bounded, in case a broken device loops it.
+    u8 offset = read8(address, PCI_CAPABILITIES_POINTER) & ~3;
+    for (size_t i = 0; offset && i < 48; ++i) {
+        if (read8(address, offset) == capability_id)
+            return offset;
+        offset = read8(address, offset + 1) & ~3;
+    }
+    return {};
+}
+
 }
 }
@@ -28,6 +28,7 @@
 
 #include <AK/Function.h>
 #include <AK/LogStream.h>
+#include <AK/Optional.h>
 #include <AK/Types.h>
 
 namespace Kernel {
@@ -64,6 +65,9 @@ namespace Kernel {
 #define PCI_MAX_DEVICES_PER_BUS 32
 #define PCI_MAX_BUSES 256
 #define PCI_MAX_FUNCTIONS_PER_DEVICE 8
+#define PCI_STATUS_CAPABILITIES_LIST (1 << 4)
+#define PCI_CAPABILITY_MSI 0x05
+#define PCI_CAPABILITY_MSIX 0x11
 
 //#define PCI_DEBUG 1
 
@@ -203,17 +207,24 @@ u32 get_BAR5(Address);
 u8 get_revision_id(Address);
 u8 get_subclass(Address);
 u8 get_class(Address);
+u8 get_programming_interface(Address);
 u16 get_subsystem_id(Address);
 u16 get_subsystem_vendor_id(Address);
+u32 get_BAR(Address, u8 bar_number);
 size_t get_BAR_space_size(Address, u8);
+// Returns the configuration space offset of the capability with this ID, if the function has it.
+Optional<u8> find_capability(Address, u8 capability_id);
 void enable_bus_mastering(Address);
 void disable_bus_mastering(Address);
+void enable_memory_space(Address);
 
 class Access;
 class MMIOAccess;
 class IOAccess;
 class MMIOSegment;
 class Device;
+class MSICapability;
+class MSIXTable;
 
 }
 
@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2020, The SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <Kernel/PCI/Access.h>
+#include <Kernel/PCI/MSICapability.h>
+
+namespace Kernel {
+namespace PCI {
+
+// Offsets into the MSI capability structure. The data comes after the upper half of the address if there is one.
+static constexpr u8 msi_message_control = 0x02;
+static constexpr u8 msi_message_address_low = 0x04;
+static constexpr u8 msi_message_address_high = 0x08;
+static constexpr u8 msi_message_data_32bit = 0x08;
+static constexpr u8 msi_message_data_64bit = 0x0c;
+
+static constexpr u16 msi_control_enable = 1 << 0;
+static constexpr u16 msi_control_multiple_message_enable_mask = 0x7 << 4;
+static constexpr u16 msi_control_64bit = 1 << 7;
+
+OwnPtr<MSICapability> MSICapability::try_create(Address address)
+{
+    auto capability_offset = find_capability(address, PCI_CAPABILITY_MSI);
+    if (!capability_offset.has_value())
+        return nullptr;
+    u16 control = Access::the().read16_field(address, capability_offset.value() + msi_message_control);
+    return adopt_own(*new MSICapability(address, capability_offset.value(), control & msi_control_64bit));
+}
+
+MSICapability::MSICapability(Address address, u8 capability_offset, bool is_64bit)
+    : m_address(address)
+    , m_capability_offset(capability_offset)
+    , m_is_64bit(is_64bit)
+{
+}
+
+MSICapability::~MSICapability()
+{
+    disable();
+}
+
+void MSICapability::set_message(u32 message_address, u16 message_data)
+{
+    auto& access = Access::the();
+    access.write32_field(m_address, m_capability_offset + msi_message_address_low, message_address);
+    if (m_is_64bit) {
+        access.write32_field(m_address, m_capability_offset + msi_message_address_high, 0);
+        access.write16_field(m_address, m_capability_offset + msi_message_data_64bit, message_data);
+    } else {
+        access.write16_field(m_address, m_capability_offset + msi_message_data_32bit, message_data);
+    }
+}
+
+void MSICapability::enable()
+{
+    auto& access = Access::the();
+    u16 control = access.read16_field(m_address, m_capability_offset + msi_message_control);
+    access.write16_field(m_address, m_capability_offset + msi_message_control, (control | msi_control_enable) & ~msi_control_multiple_message_enable_mask);
+    disable_interrupt_line(m_address);
+    m_enabled = true;
+}
+
+void MSICapability::disable()
+{
+    if (!m_enabled)
+        return;
+    auto& access = Access::the();
+    u16 control = access.read16_field(m_address, m_capability_offset + msi_message_control);
+    access.write16_field(m_address, m_capability_offset + msi_message_control, control & ~msi_control_enable);
+    enable_interrupt_line(m_address);
+    m_enabled = false;
+}
+
+}
+}
@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2020, The SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/OwnPtr.h>
+#include <AK/Types.h>
+#include <Kernel/PCI/Definitions.h>
+
+namespace Kernel {
+
+// The MSI capability of a PCI function, for functions that can send a message instead of raising
+// their interrupt line but don't have an MSI-X table. Only a single message is used.
+class PCI::MSICapability {
+public:
+    // Returns null if the function has no MSI capability.
+    static OwnPtr<MSICapability> try_create(Address);
+    ~MSICapability();
+
+    // Sets the message the function writes, as given by its MSIHandler.
+    void set_message(u32 message_address, u16 message_data);
+
+    // While MSI is enabled, the function doesn't raise its legacy interrupt line.
+    void enable();
+    void disable();
+    bool is_enabled() const { return m_enabled; }
+
+private:
+    MSICapability(Address, u8 capability_offset, bool is_64bit);
+
+    Address m_address;
+    u8 m_capability_offset { 0 };
+    bool m_is_64bit { false };
+    bool m_enabled { false };
+};
+
+}
@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) 2020, The SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <AK/StringView.h>
+#include <Kernel/PCI/Access.h>
+#include <Kernel/PCI/MSIXTable.h>
+#include <Kernel/VM/MemoryManager.h>
+
+namespace Kernel {
+namespace PCI {
+
+// Offsets into the MSI-X capability structure.
+static constexpr u8 msix_message_control = 0x02;
+static constexpr u8 msix_table_offset_and_bir = 0x04;
+
+static constexpr u16 msix_control_table_size_mask = 0x7ff;
+static constexpr u16 msix_control_function_mask = 1 << 14;
+static constexpr u16 msix_control_enable = 1 << 15;
+
+// Each table entry is four dwords: message address low and high, message data, and vector control.
+static constexpr size_t msix_entry_address_low = 0;
+static constexpr size_t msix_entry_address_high = 1;
+static constexpr size_t msix_entry_data = 2;
+static constexpr size_t msix_entry_vector_control = 3;
+static constexpr u32 msix_vector_control_masked = 1;
+
+OwnPtr<MSIXTable> MSIXTable::try_create(Address address)
+{
+    auto capability_offset = find_capability(address, PCI_CAPABILITY_MSIX);
+    if (!capability_offset.has_value())
+        return nullptr;
+    auto& access = Access::the();
+    u8 offset = capability_offset.value();
+    size_t entry_count = (access.read16_field(address, offset + msix_message_control) & msix_control_table_size_mask) + 1;
+    u32 table_offset_and_bir = access.read32_field(address, offset + msix_table_offset_and_bir);
+    u8 bar_number = table_offset_and_bir & 7;
+    if (bar_number > 5)
+        return nullptr;
+    u32 bar = get_BAR(address, bar_number);
+    if (bar & 1) {
+        // The table always lives in memory space.
+        return nullptr;
+    }
+    // The device only decodes accesses to the table while memory space is enabled.
+    access.write16_field(address, PCI_COMMAND, access.read16_field(address, PCI_COMMAND) | (1 << 1));
+    PhysicalAddress table_address((bar & ~0xf) + (table_offset_and_bir & ~7));
+    size_t table_offset_in_region = table_address.offset_in_page();
+    auto region = MM.allocate_kernel_region(table_address.page_base(), PAGE_ROUND_UP(table_offset_in_region + entry_count * 16), "MSI-X Table", Region::Access::Read | Region::Access::Write, false, false);
+    if (!region)
+        return nullptr;
+    return adopt_own(*new MSIXTable(address, offset, entry_count, region.release_nonnull(), table_offset_in_region));
+}
+
+MSIXTable::MSIXTable(Address address, u8 capability_offset, size_t entry_count, NonnullOwnPtr<Region> region, size_t table_offset_in_region)
+    : m_address(address)
+    , m_capability_offset(capability_offset)
+    , m_entry_count(entry_count)
+    , m_region(move(region))
+    , m_table_offset_in_region(table_offset_in_region)
+{
+    for (size_t i = 0; i < m_entry_count; ++i)
+        mask_entry(i);
+}
+
+MSIXTable::~MSIXTable()
+{
+    disable();
+}
+
+void MSIXTable::set_entry(size_t index, u32 message_address, u16 message_data)
+{
+    ASSERT(index < m_entry_count);
+    auto* table_entry = entry(index);
+    table_entry[msix_entry_vector_control] = msix_vector_control_masked;
+    table_entry[msix_entry_address_low] = message_address;
+    table_entry[msix_entry_address_high] = 0;
+    table_entry[msix_entry_data] = message_data;
+    table_entry[msix_entry_vector_control] = 0;
+}
+
+void MSIXTable::mask_entry(size_t index)
+{
+    ASSERT(index < m_entry_count);
+    entry(index)[msix_entry_vector_control] = msix_vector_control_masked;
+}
+
+void MSIXTable::enable()
+{
+    auto& access = Access::the();
+    u16 control = access.read16_field(m_address, m_capability_offset + msix_message_control);
+    access.write16_field(m_address, m_capability_offset + msix_message_control, (control | msix_control_enable) & ~msix_control_function_mask);
+    disable_interrupt_line(m_address);
+    m_enabled = true;
+}
+
+void MSIXTable::disable()
+{
+    if (!m_enabled)
+        return;
+    auto& access = Access::the();
+    u16 control = access.read16_field(m_address, m_capability_offset + msix_message_control);
+    access.write16_field(m_address, m_capability_offset + msix_message_control, control & ~msix_control_enable);
+    enable_interrupt_line(m_address);
+    m_enabled = false;
+}
+
+}
+}
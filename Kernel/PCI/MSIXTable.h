@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2020, The SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/OwnPtr.h>
+#include <AK/Types.h>
+#include <Kernel/PCI/Definitions.h>
+#include <Kernel/VM/Region.h>
+
+namespace Kernel {
+
+// The MSI-X table of a PCI function, mapped from whichever BAR the function keeps it in.
+// Each entry tells the device which message to write to signal that interrupt.
+class PCI::MSIXTable {
+public:
+    // Returns null if the function has no MSI-X capability.
+    static OwnPtr<MSIXTable> try_create(Address);
+    ~MSIXTable();
+
+    size_t entry_count() const { return m_entry_count; }
+
+    // Sets the message the entry writes, as given by its MSIHandler, and unmasks it.
+    void set_entry(size_t index, u32 message_address, u16 message_data);
+    void mask_entry(size_t index);
+
+    // While MSI-X is enabled, the function doesn't raise its legacy interrupt line.
+    void enable();
+    void disable();
+    bool is_enabled() const { return m_enabled; }
+
+private:
+    MSIXTable(Address, u8 capability_offset, size_t entry_count, NonnullOwnPtr<Region>, size_t table_offset_in_region);
+
+    volatile u32* entry(size_t index) { return (volatile u32*)(m_region->vaddr().offset(m_table_offset_in_region).as_ptr()) + index * 4; }
+
+    Address m_address;
+    u8 m_capability_offset { 0 };
+    size_t m_entry_count { 0 };
+    NonnullOwnPtr<Region> m_region;
+    size_t m_table_offset_in_region { 0 };
+    bool m_enabled { false };
+};
+
+}
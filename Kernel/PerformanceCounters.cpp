@@ -0,0 +1,186 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <Kernel/Arch/i386/CPU.h>
+#include <Kernel/Interrupts/APIC.h>
+#include <Kernel/PerformanceCounters.h>
+#include <Kernel/Process.h>
+#include <Kernel/Profiling.h>
+#include <Kernel/Thread.h>
+#include <Kernel/UnixTypes.h>
+
+//#define PERFORMANCE_COUNTERS_DEBUG
+
+#define IA32_PMC0 0xc1
+#define IA32_PERFEVTSEL0 0x186
+#define IA32_PERF_GLOBAL_STATUS 0x38e
+#define IA32_PERF_GLOBAL_CTRL 0x38f
+#define IA32_PERF_GLOBAL_OVF_CTRL 0x390
+
+#define PERFEVTSEL_USR (1 << 16)
+#define PERFEVTSEL_OS (1 << 17)
+#define PERFEVTSEL_INT (1 << 20)
+#define PERFEVTSEL_EN (1 << 22)
+
+namespace Kernel {
+namespace PerformanceCounters {
+
+struct ArchitecturalEvent {
+    int type;
+    const char* name;
+    u8 event_select;
+    u8 unit_mask;
+    // Bit in CPUID.0AH:EBX that is set when the processor does *not* have the event
+    u8 unavailable_bit;
+};
+
+static const ArchitecturalEvent s_events[] = {
+    { PERF_EVENT_CYCLES, "cycles", 0x3c, 0x00, 0 },
+    { PERF_EVENT_INSTRUCTIONS, "instructions", 0xc0, 0x00, 1 },
+    { PERF_EVENT_CACHE_MISSES, "cache-misses", 0x2e, 0x41, 4 },
+    { PERF_EVENT_BRANCH_MISSES, "branch-misses", 0xc5, 0x00, 6 },
+};
+
+static bool s_detected;
+static u8 s_version;
+static u64 s_counter_mask;
+static u32 s_unavailable_events;
+
+static const ArchitecturalEvent* find_event(int event_type)
+{
+    for (auto& event : s_events) {
+        if (event.type == event_type)
+            return &event;
+    }
+    return nullptr;
+}
+
+static void detect()
+{
+    if (s_detected)
+        return;
+    s_detected = true;
+    if (!MSR::have() || CPUID(0).eax() < 0xa)
+        return;
+    CPUID leaf(0xa);
+    u8 version = leaf.eax() & 0xff;
+    u8 counter_count = (leaf.eax() >> 8) & 0xff;
+    u8 counter_width = (leaf.eax() >> 16) & 0xff;
+    u8 event_vector_length = (leaf.eax() >> 24) & 0xff;
+    if (version == 0 || counter_count == 0 || counter_width < 32 || counter_width > 63)
+        return;
+    s_unavailable_events = leaf.ebx();
+    // Events past the end of the bit vector aren't there either
+    if (event_vector_length < 32)
+        s_unavailable_events |= ~((1u << event_vector_length) - 1);
+    s_counter_mask = (1ull << counter_width) - 1;
+    s_version = version;
+    klog() << "PerformanceCounters: Architectural PMU version " << version << ", " << counter_count << " counters of " << counter_width << " bits";
+}
+
+bool is_hardware_event(int event_type)
+{
+    return find_event(event_type) != nullptr;
+}
+
+bool is_supported(int event_type)
+{
+    detect();
+    auto* event = find_event(event_type);
+    return event && s_version && !(s_unavailable_events & (1u << event->unavailable_bit));
+}
+
+bool can_sample()
+{
+    return APIC::initialized() && APIC::the().is_enabled();
+}
+
+const char* event_name(int event_type)
+{
+    auto* event = find_event(event_type);
+    return event ? event->name : nullptr;
+}
+
+void load(PerformanceCounter& counter)
+{
+    auto* event = find_event(counter.event_type);
+    ASSERT(event);
+    u32 event_select = event->event_select | (event->unit_mask << 8) | PERFEVTSEL_USR | PERFEVTSEL_OS | PERFEVTSEL_EN;
+    if (counter.sample_period) {
+        // Start just short of the overflow, so the counter interrupts once events_until_sample events have happened.
+        // The processor sign-extends the low 32 bits we write, which is why sample periods stay below 2^31.
+        counter.start_value = (s_counter_mask + 1 - counter.events_until_sample) & s_counter_mask;
+        event_select |= PERFEVTSEL_INT;
+    } else {
+        counter.start_value = 0;
+    }
+    MSR(IA32_PMC0).set((u32)counter.start_value, 0);
+    if (s_version >= 2)
+        MSR(IA32_PERF_GLOBAL_CTRL).set(1, 0);
+    MSR(IA32_PERFEVTSEL0).set(event_select, 0);
+}
+
+void save(PerformanceCounter& counter)
+{
+    MSR(IA32_PERFEVTSEL0).set(0, 0);
+    u32 low, high;
+    MSR(IA32_PMC0).get(low, high);
+    u64 delta = ((((u64)high << 32) | low) - counter.start_value) & s_counter_mask;
+    counter.count += delta;
+    if (!counter.sample_period)
+        return;
+    if (delta >= counter.events_until_sample)
+        counter.events_until_sample = counter.sample_period;
+    else
+        counter.events_until_sample -= (u32)delta;
+}
+
+void handle_overflow_interrupt(const RegisterState& regs)
+{
+    if (s_version >= 2) {
+        u32 status, status_high;
+        MSR(IA32_PERF_GLOBAL_STATUS).get(status, status_high);
+        MSR(IA32_PERF_GLOBAL_OVF_CTRL).set(status, status_high);
+    }
+
+    auto* thread = Processor::current().current_thread();
+    if (!thread)
+        return;
+    auto& counter = thread->performance_counter();
+    if (!counter.is_enabled() || !counter.sample_period)
+        return;
+
+    save(counter);
+#ifdef PERFORMANCE_COUNTERS_DEBUG
+    dbg() << "PerformanceCounters: " << event_name(counter.event_type) << " overflow in " << *thread << " at " << (void*)regs.eip;
+#endif
+    if (Profiling::is_sampling(thread->process()))
+        Profiling::record_sample(*thread, regs, counter.event_type);
+    load(counter);
+}
+
+}
+}
@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/Types.h>
+
+namespace Kernel {
+
+struct RegisterState;
+
+// A thread's hardware performance counter, programmed into the first general-purpose counter of the
+// CPU's architectural PMU (CPUID leaf 0xa). It only counts while its thread is running: the context
+// switch saves and restores it along with the FPU state.
+struct PerformanceCounter {
+    int event_type { 0 };
+    u64 count { 0 };
+    // With a sample period, the counter interrupts after that many events, and the thread is profiled there.
+    u32 sample_period { 0 };
+    u32 events_until_sample { 0 };
+    u64 start_value { 0 };
+
+    bool is_enabled() const { return event_type != 0; }
+};
+
+namespace PerformanceCounters {
+
+bool is_hardware_event(int event_type);
+bool is_supported(int event_type);
+// Sampling needs the local APIC to deliver counter overflow interrupts.
+bool can_sample();
+const char* event_name(int event_type);
+
+// Called with interrupts disabled, on the processor the counter's thread is running on.
+void load(PerformanceCounter&);
+void save(PerformanceCounter&);
+
+void handle_overflow_interrupt(const RegisterState&);
+
+}
+
+}
@@ -156,6 +156,7 @@ Region& Process::allocate_split_region(const Region& source_region, const Range&
     auto& region = add_region(Region::create_user_accessible(range, source_region.vmobject(), offset_in_vmobject, source_region.name(), source_region.access()));
     region.set_mmap(source_region.is_mmap());
     region.set_stack(source_region.is_stack());
+    region.set_access_pattern(source_region.access_pattern());
     size_t page_offset_in_source_region = (offset_in_vmobject - source_region.offset_in_vmobject()) / PAGE_SIZE;
     for (size_t i = 0; i < region.page_count(); ++i) {
         if (source_region.should_cow(page_offset_in_source_region + i))
@@ -207,7 +208,8 @@ Region* Process::allocate_region_with_vmobject(const Range& range, NonnullRefPtr
 
 Region* Process::allocate_region_with_vmobject(VirtualAddress vaddr, size_t size, NonnullRefPtr<VMObject> vmobject, size_t offset_in_vmobject, const String& name, int prot)
 {
-    auto range = allocate_range(vaddr, size);
+    // Big mappings (framebuffers, shared buffers) get a 2 MiB aligned range so they can be mapped with large pages.
+    auto range = allocate_range(vaddr, size, size >= LARGE_PAGE_SIZE ? LARGE_PAGE_SIZE : PAGE_SIZE);
     if (!range.is_valid())
         return nullptr;
     return allocate_region_with_vmobject(range, move(vmobject), offset_in_vmobject, name, prot);
@@ -385,6 +387,7 @@ Process::Process(Thread*& first_thread, const String& name, uid_t uid, gid_t gid
 Process::~Process()
 {
     ASSERT(thread_count() == 0);
+    SyscallStatistics::did_exit(m_syscall_statistics);
 }
 
 void Process::dump_regions()
@@ -533,6 +536,18 @@ int Process::number_of_open_file_descriptors() const
     return count;
 }
 
+int Process::install_file_description(NonnullRefPtr<FileDescription>&& description, u32 fd_flags)
+{
+    LOCKER(big_lock());
+    if (is_dead())
+        return -ESRCH;
+    int fd = alloc_fd();
+    if (fd < 0)
+        return fd;
+    m_fds[fd].set(move(description), fd_flags);
+    return fd;
+}
+
 int Process::alloc_fd(int first_candidate_fd)
 {
     for (int i = first_candidate_fd; i < (int)m_max_open_file_descriptors; ++i) {
@@ -615,6 +630,20 @@ Custody& Process::current_directory()
     return *m_cwd;
 }
 
+KResultOr<NonnullRefPtr<Custody>> Process::custody_for_dirfd(int dirfd)
+{
+    if (dirfd == AT_FDCWD)
+        return NonnullRefPtr<Custody>(current_directory());
+    auto base_description = file_description(dirfd);
+    if (!base_description)
+        return KResult(-EBADF);
+    if (!base_description->is_directory())
+        return KResult(-ENOTDIR);
+    if (!base_description->custody())
+        return KResult(-EINVAL);
+    return NonnullRefPtr<Custody>(*base_description->custody());
+}
+
 KResultOr<String> Process::get_syscall_path_argument(const char* user_path, size_t path_length) const
 {
     if (path_length == 0)
@@ -742,9 +771,6 @@ size_t Process::amount_resident() const
 size_t Process::amount_shared() const
 {
     // FIXME: This will double count if multiple regions use the same physical page.
-    // FIXME: It doesn't work at the moment, since it relies on PhysicalPage ref counts,
-    //        and each PhysicalPage is only reffed by its VMObject. This needs to be refactored
-    //        so that every Region contributes +1 ref to each of its PhysicalPages.
     size_t amount = 0;
     ScopedSpinLock lock(m_lock);
     for (auto& region : m_regions) {
@@ -753,6 +779,17 @@ size_t Process::amount_shared() const
     return amount;
 }
 
+size_t Process::amount_private() const
+{
+    // Resident memory that no other region maps.
+    size_t amount = 0;
+    ScopedSpinLock lock(m_lock);
+    for (auto& region : m_regions) {
+        amount += region.amount_resident() - region.amount_shared();
+    }
+    return amount;
+}
+
 size_t Process::amount_purgeable_volatile() const
 {
     size_t amount = 0;
@@ -36,11 +36,13 @@
 #include <AK/Userspace.h>
 #include <AK/WeakPtr.h>
 #include <AK/Weakable.h>
+#include <Kernel/API/ProcessStatistics.h>
 #include <Kernel/API/Syscall.h>
 #include <Kernel/FileSystem/InodeMetadata.h>
 #include <Kernel/Forward.h>
 #include <Kernel/Lock.h>
 #include <Kernel/StdLib.h>
+#include <Kernel/SyscallStatistics.h>
 #include <Kernel/Thread.h>
 #include <Kernel/UnixTypes.h>
 #include <Kernel/VM/RangeAllocator.h>
@@ -58,31 +60,6 @@ void kgettimeofday(timeval&);
 
 extern VirtualAddress g_return_to_ring3_from_signal_trampoline;
 
-#define ENUMERATE_PLEDGE_PROMISES         \
-    __ENUMERATE_PLEDGE_PROMISE(stdio)     \
-    __ENUMERATE_PLEDGE_PROMISE(rpath)     \
-    __ENUMERATE_PLEDGE_PROMISE(wpath)     \
-    __ENUMERATE_PLEDGE_PROMISE(cpath)     \
-    __ENUMERATE_PLEDGE_PROMISE(dpath)     \
-    __ENUMERATE_PLEDGE_PROMISE(inet)      \
-    __ENUMERATE_PLEDGE_PROMISE(id)        \
-    __ENUMERATE_PLEDGE_PROMISE(proc)      \
-    __ENUMERATE_PLEDGE_PROMISE(exec)      \
-    __ENUMERATE_PLEDGE_PROMISE(unix)      \
-    __ENUMERATE_PLEDGE_PROMISE(recvfd)    \
-    __ENUMERATE_PLEDGE_PROMISE(sendfd)    \
-    __ENUMERATE_PLEDGE_PROMISE(fattr)     \
-    __ENUMERATE_PLEDGE_PROMISE(tty)       \
-    __ENUMERATE_PLEDGE_PROMISE(chown)     \
-    __ENUMERATE_PLEDGE_PROMISE(chroot)    \
-    __ENUMERATE_PLEDGE_PROMISE(thread)    \
-    __ENUMERATE_PLEDGE_PROMISE(video)     \
-    __ENUMERATE_PLEDGE_PROMISE(accept)    \
-    __ENUMERATE_PLEDGE_PROMISE(settime)   \
-    __ENUMERATE_PLEDGE_PROMISE(sigaction) \
-    __ENUMERATE_PLEDGE_PROMISE(setkeymap) \
-    __ENUMERATE_PLEDGE_PROMISE(shared_buffer)
-
 enum class Pledge : u32 {
 #define __ENUMERATE_PLEDGE_PROMISE(x) x,
     ENUMERATE_PLEDGE_PROMISES
@@ -178,6 +155,8 @@ public:
 
     RefPtr<FileDescription> file_description(int fd) const;
     int fd_flags(int fd) const;
+    // For handing a new description to a process from outside of its own syscalls.
+    int install_file_description(NonnullRefPtr<FileDescription>&&, u32 fd_flags = 0);
 
     template<typename Callback>
     static void for_each(Callback);
@@ -195,6 +174,8 @@ public:
 
     int sys$yield();
     int sys$sync();
+    int sys$fsync(int fd);
+    int sys$fdatasync(int fd);
     int sys$beep();
     int sys$get_process_name(Userspace<char*> buffer, size_t buffer_size);
     int sys$set_process_name(Userspace<const char*> user_name, size_t user_name_length);
@@ -224,6 +205,13 @@ public:
     ssize_t sys$read(int fd, Userspace<u8*>, ssize_t);
     ssize_t sys$write(int fd, const u8*, ssize_t);
     ssize_t sys$writev(int fd, const struct iovec* iov, int iov_count);
+    ssize_t sys$readv(int fd, const struct iovec* iov, int iov_count);
+    ssize_t sys$preadv(const Syscall::SC_preadv_params*);
+    ssize_t sys$pwritev(const Syscall::SC_pwritev_params*);
+    ssize_t sys$sendfile(const Syscall::SC_sendfile_params*);
+    int sys$io_ring_create(const Syscall::SC_io_ring_create_params*);
+    int sys$io_ring_enter(int ring_fd, unsigned min_complete);
+    int sys$anon_create(size_t size, int options);
     int sys$fstat(int fd, Userspace<stat*>);
     int sys$stat(Userspace<const Syscall::SC_stat_params*>);
     int sys$lseek(int fd, off_t, int whence);
@@ -240,6 +228,9 @@ public:
     int sys$purge(int mode);
     int sys$select(const Syscall::SC_select_params*);
     int sys$poll(Userspace<const Syscall::SC_poll_params*>);
+    int sys$event_set_create(int flags);
+    int sys$event_set_ctl(Userspace<const Syscall::SC_event_set_ctl_params*>);
+    int sys$event_set_wait(Userspace<const Syscall::SC_event_set_wait_params*>);
     ssize_t sys$get_dir_entries(int fd, void*, ssize_t);
     int sys$getcwd(Userspace<char*>, ssize_t);
     int sys$chdir(Userspace<const char*>, size_t);
@@ -250,6 +241,7 @@ public:
     int sys$clock_gettime(clockid_t, Userspace<timespec*>);
     int sys$clock_settime(clockid_t, Userspace<const timespec*>);
     int sys$clock_nanosleep(Userspace<const Syscall::SC_clock_nanosleep_params*>);
+    void* sys$map_time_page();
     int sys$gethostname(Userspace<char*>, ssize_t);
     int sys$sethostname(Userspace<const char*>, ssize_t);
     int sys$uname(Userspace<utsname*>);
@@ -319,6 +311,7 @@ public:
     int sys$shbuf_release(int shbuf_id);
     int sys$shbuf_seal(int shbuf_id);
     int sys$shbuf_set_volatile(int shbuf_id, bool);
+    void* sys$shbuf_reclaim(int shbuf_id, Userspace<size_t*> size);
     int sys$halt();
     int sys$reboot();
     int sys$set_process_icon(int icon_id);
@@ -474,6 +467,8 @@ public:
     [[nodiscard]] String validate_and_copy_string_from_user(const Syscall::StringArgument&) const;
 
     Custody& current_directory();
+    // The directory that paths given to an *at() syscall are relative to.
+    KResultOr<NonnullRefPtr<Custody>> custody_for_dirfd(int dirfd);
     Custody* executable()
     {
         return m_executable.ptr();
@@ -490,6 +485,7 @@ public:
     size_t amount_virtual() const;
     size_t amount_resident() const;
     size_t amount_shared() const;
+    size_t amount_private() const;
     size_t amount_purgeable_volatile() const;
     size_t amount_purgeable_nonvolatile() const;
 
@@ -538,6 +534,9 @@ public:
         return m_priority_boost;
     }
 
+    SyscallStatistics& syscall_statistics() { return m_syscall_statistics; }
+    const SyscallStatistics& syscall_statistics() const { return m_syscall_statistics; }
+
     Custody& root_directory();
     Custody& root_directory_relative_to_global_root();
     void set_root_directory(const Custody&);
@@ -588,7 +587,10 @@ private:
     void kill_all_threads();
 
     int do_exec(NonnullRefPtr<FileDescription> main_program_description, Vector<String> arguments, Vector<String> environment, RefPtr<FileDescription> interpreter_description, Thread*& new_main_thread, u32& prev_flags);
-    ssize_t do_write(FileDescription&, const u8*, int data_size);
+    ssize_t do_write(FileDescription&, Vector<iovec, 32>&, size_t total_length, Optional<off_t> offset = {});
+    ssize_t do_read(FileDescription&, Vector<iovec, 32>&, size_t total_length, Optional<off_t> offset = {});
+    // Copies an iovec array in from userspace and validates the buffers. Returns the total length, or a negative errno.
+    ssize_t copy_iovecs_from_user(Vector<iovec, 32>&, const iovec*, int iov_count, bool buffers_will_be_written);
 
     KResultOr<NonnullRefPtr<FileDescription>> find_elf_interpreter_for_executable(const String& path, char (&first_page)[PAGE_SIZE], int nread, size_t file_size);
     Vector<AuxiliaryValue> generate_auxiliary_vector() const;
@@ -708,6 +710,7 @@ private:
     HashMap<u32, OwnPtr<WaitQueue>> m_futex_queues;
 
     OwnPtr<PerformanceEventBuffer> m_perf_event_buffer;
+    SyscallStatistics m_syscall_statistics;
 
     // This member is used in the implementation of ptrace's PT_TRACEME flag.
     // If it is set to true, the process will stop at the next execve syscall
@@ -815,7 +818,7 @@ inline const LogStream& operator<<(const LogStream& stream, const Process& proce
 
 inline u32 Thread::effective_priority() const
 {
-    return m_priority + m_process->priority_boost() + m_priority_boost + m_extra_priority;
+    return m_priority + m_process->priority_boost() + m_priority_boost;
 }
 
 #define REQUIRE_NO_PROMISES                        \
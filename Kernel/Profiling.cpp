@@ -30,6 +30,8 @@
 #include <Kernel/KBuffer.h>
 #include <Kernel/KSyms.h>
 #include <Kernel/Process.h>
+#include <Kernel/SpinLock.h>
+#include <Kernel/Thread.h>
 #include <Kernel/Profiling.h>
 #include <LibELF/Loader.h>
 
@@ -37,10 +39,24 @@ namespace Kernel {
 
 namespace Profiling {
 
+// Each processor only ever writes to its own ring, from its timer interrupt, so the writer needs no locks.
+// Readers copy a sample out and then check that the writer hasn't lapped them in the meantime.
+struct SampleRing {
+    Sample* samples { nullptr };
+    u32 capacity { 0 };
+    volatile u32 written { 0 };
+    u32 first { 0 };
+    u32 consumed { 0 };
+};
+
+static constexpr size_t max_ring_count = 32;
+
 static KBufferImpl* s_profiling_buffer;
-static size_t s_slot_count;
-static size_t s_next_slot_index;
+static SampleRing s_rings[max_ring_count];
+static size_t s_ring_count;
+static SpinLock<u8> s_reader_lock;
 static ProcessID s_pid { -1 };
+static bool s_system_wide;
 
 String& executable_path()
 {
@@ -55,53 +71,176 @@ ProcessID pid()
     return s_pid;
 }
 
-void start(Process& process)
+bool is_system_wide()
+{
+    return s_system_wide;
+}
+
+bool is_sampling(const Process& process)
+{
+    return s_system_wide || process.is_profiling();
+}
+
+static void forget_samples()
 {
-    if (process.executable())
-        executable_path() = process.executable()->absolute_path().impl();
+    ScopedSpinLock lock(s_reader_lock);
+    for (size_t i = 0; i < s_ring_count; ++i) {
+        auto& ring = s_rings[i];
+        ring.first = ring.written;
+        ring.consumed = ring.first;
+    }
+}
+
+void start(Process* process)
+{
+    if (process && process->executable())
+        executable_path() = process->executable()->absolute_path().impl();
     else
         executable_path() = {};
-    s_pid = process.pid();
+    s_pid = process ? process->pid() : ProcessID(-1);
 
     if (!s_profiling_buffer) {
         s_profiling_buffer = RefPtr<KBufferImpl>(KBuffer::create_with_size(8 * MB).impl()).leak_ref();
         s_profiling_buffer->region().commit();
-        s_slot_count = s_profiling_buffer->size() / sizeof(Sample);
+        s_ring_count = min(Processor::processor_count(), max_ring_count);
+        u32 slots_per_ring = s_profiling_buffer->size() / sizeof(Sample) / s_ring_count;
+        for (size_t i = 0; i < s_ring_count; ++i) {
+            s_rings[i].samples = (Sample*)s_profiling_buffer->data() + i * slots_per_ring;
+            s_rings[i].capacity = slots_per_ring;
+        }
     }
 
-    s_next_slot_index = 0;
+    forget_samples();
+    s_system_wide = !process;
 }
 
-static Sample& sample_slot(size_t index)
+void stop()
 {
-    return ((Sample*)s_profiling_buffer->data())[index];
+    s_system_wide = false;
 }
 
-Sample& next_sample_slot()
+void did_exec(const String& new_executable_path)
 {
-    auto& slot = sample_slot(s_next_slot_index++);
-    if (s_next_slot_index >= s_slot_count)
-        s_next_slot_index = 0;
-    return slot;
+    if (s_system_wide)
+        return;
+    executable_path() = new_executable_path;
+    forget_samples();
 }
 
-void stop()
+void record_sample(Thread& thread, const RegisterState& regs, int event_type)
 {
-    // FIXME: This probably shouldn't be empty.
+    auto cpu = Processor::current().id();
+    if (cpu >= s_ring_count)
+        return;
+    auto& ring = s_rings[cpu];
+    u32 index = ring.written;
+    auto& sample = ring.samples[index % ring.capacity];
+    sample.pid = thread.process().pid();
+    sample.tid = thread.tid();
+    sample.timestamp = g_uptime;
+    sample.event_type = event_type;
+
+    SmapDisabler disabler;
+    size_t frame_count = thread.raw_backtrace(regs.ebp, regs.eip, sample.frames, max_stack_frame_count);
+    if (!(regs.cs & 3) && !thread.process().is_ring0()) {
+        // The frame pointer chain runs on into userspace from the syscall or fault entry, but without the
+        // instruction userspace was at. Cut it there, and walk the user stack from the registers it entered with.
+        for (size_t i = 0; i < frame_count; ++i) {
+            if (is_user_address(VirtualAddress(sample.frames[i]))) {
+                frame_count = i;
+                break;
+            }
+        }
+        auto& user_regs = thread.get_register_dump_from_stack();
+        if ((user_regs.cs & 3) && frame_count < max_stack_frame_count)
+            frame_count += thread.raw_backtrace(user_regs.ebp, user_regs.eip, sample.frames + frame_count, max_stack_frame_count - frame_count);
+    }
+    if (frame_count < max_stack_frame_count)
+        sample.frames[frame_count] = 0;
+
+    // Publish the sample only once it's complete.
+    asm volatile("" ::: "memory");
+    ring.written = index + 1;
 }
 
-void did_exec(const String& new_executable_path)
+// Copies out the sample at index, or returns false if the writer has already overwritten it.
+static bool read_sample(const SampleRing& ring, u32 index, Sample& sample)
 {
-    executable_path() = new_executable_path;
-    s_next_slot_index = 0;
+    if (ring.written - index >= ring.capacity)
+        return false;
+    sample = ring.samples[index % ring.capacity];
+    asm volatile("" ::: "memory");
+    return ring.written - index < ring.capacity;
+}
+
+static u32 oldest_available(const SampleRing& ring, u32 index)
+{
+    u32 written = ring.written;
+    // The oldest slot may be the one the writer is filling in right now.
+    if (written - index >= ring.capacity)
+        return written - ring.capacity + 1;
+    return index;
+}
+
+// Walks the rings from the given cursors, merging them by timestamp.
+template<typename Callback>
+static void merge_rings(u32 (&cursors)[max_ring_count], u32 (&ends)[max_ring_count], Callback& callback)
+{
+    Vector<Sample> heads;
+    heads.resize(s_ring_count);
+    bool has_head[max_ring_count] {};
+    auto advance = [&](size_t i) {
+        has_head[i] = false;
+        while (cursors[i] != ends[i]) {
+            u32 index = cursors[i]++;
+            if (read_sample(s_rings[i], index, heads[i])) {
+                has_head[i] = true;
+                return;
+            }
+        }
+    };
+    for (size_t i = 0; i < s_ring_count; ++i)
+        advance(i);
+    for (;;) {
+        Optional<size_t> next;
+        for (size_t i = 0; i < s_ring_count; ++i) {
+            if (has_head[i] && (!next.has_value() || heads[i].timestamp < heads[next.value()].timestamp))
+                next = i;
+        }
+        if (!next.has_value())
+            return;
+        callback(heads[next.value()]);
+        advance(next.value());
+    }
+}
+
+void for_each_sample(Function<void(const Sample&)> callback)
+{
+    ScopedSpinLock lock(s_reader_lock);
+    u32 cursors[max_ring_count];
+    u32 ends[max_ring_count];
+    for (size_t i = 0; i < s_ring_count; ++i) {
+        cursors[i] = oldest_available(s_rings[i], s_rings[i].first);
+        ends[i] = s_rings[i].written;
+    }
+    merge_rings(cursors, ends, callback);
 }
 
-void for_each_sample(Function<void(Sample&)> callback)
+size_t consume_samples(Function<void(const Sample&)> callback)
 {
-    for (size_t i = 0; i < s_next_slot_index; ++i) {
-        auto& sample = sample_slot(i);
-        callback(sample);
+    ScopedSpinLock lock(s_reader_lock);
+    u32 cursors[max_ring_count];
+    u32 ends[max_ring_count];
+    size_t lost_samples = 0;
+    for (size_t i = 0; i < s_ring_count; ++i) {
+        auto& ring = s_rings[i];
+        cursors[i] = oldest_available(ring, ring.consumed);
+        lost_samples += cursors[i] - ring.consumed;
+        ends[i] = ring.written;
+        ring.consumed = ends[i];
     }
+    merge_rings(cursors, ends, callback);
+    return lost_samples;
 }
 
 }
@@ -33,26 +33,41 @@
 namespace Kernel {
 
 class Process;
+class Thread;
+struct RegisterState;
 
 namespace Profiling {
 
 constexpr size_t max_stack_frame_count = 50;
 
 struct Sample {
-    ProcessID pid;
-    ThreadID tid;
-    u64 timestamp;
-    u32 frames[max_stack_frame_count];
+    ProcessID pid { 0 };
+    ThreadID tid { 0 };
+    u64 timestamp { 0 };
+    // The hardware counter whose overflow took the sample, or 0 for the timer.
+    int event_type { 0 };
+    // The kernel frames (if the thread was interrupted in the kernel) followed by the user frames, zero-terminated unless full.
+    FlatPtr frames[max_stack_frame_count];
 };
 
 extern ProcessID pid();
 extern String& executable_path();
 
-Sample& next_sample_slot();
-void start(Process&);
+// Profiles one process, or with nullptr, every process on the system.
+void start(Process*);
 void stop();
+bool is_system_wide();
+bool is_sampling(const Process&);
 void did_exec(const String& new_executable_path);
-void for_each_sample(Function<void(Sample&)>);
+
+// Called from the timer or performance counter interrupt. Each processor has its own sample ring, so this takes no locks.
+void record_sample(Thread&, const RegisterState&, int event_type = 0);
+
+// Calls back with every sample still in the rings, in timestamp order.
+void for_each_sample(Function<void(const Sample&)>);
+// Calls back with the samples recorded since the last call, and forgets them. Returns how many samples were
+// overwritten before anyone got to consume them.
+size_t consume_samples(Function<void(const Sample&)>);
 
 }
 
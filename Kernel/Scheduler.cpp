@@ -24,10 +24,10 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
-#include <AK/QuickSort.h>
 #include <AK/ScopeGuard.h>
 #include <AK/TemporaryChange.h>
 #include <AK/Time.h>
+#include <Kernel/FileSystem/EventSet.h>
 #include <Kernel/FileSystem/FileDescription.h>
 #include <Kernel/Net/Socket.h>
 #include <Kernel/Process.h>
@@ -51,6 +51,8 @@ public:
     SchedulerPerProcessorData() = default;
 
     bool m_in_scheduler { true };
+    // Set while the scheduler runs on its own accord rather than for a thread that yields.
+    bool m_is_preempting { false };
 };
 
 SchedulerData* g_scheduler_data;
@@ -198,7 +200,7 @@ Thread::SleepBlocker::SleepBlocker(u64 wakeup_time)
 
 bool Thread::SleepBlocker::should_unblock(Thread&)
 {
-    return m_wakeup_time <= g_uptime;
+    return m_wakeup_time <= TimeManagement::the().nanoseconds_since_boot();
 }
 
 Thread::SelectBlocker::SelectBlocker(const FDVector& read_fds, const FDVector& write_fds, const FDVector& except_fds)
@@ -227,6 +229,16 @@ bool Thread::SelectBlocker::should_unblock(Thread& thread)
     return false;
 }
 
+Thread::EventSetBlocker::EventSetBlocker(EventSet& event_set)
+    : m_event_set(event_set)
+{
+}
+
+bool Thread::EventSetBlocker::should_unblock(Thread&)
+{
+    return m_event_set.has_ready_events();
+}
+
 Thread::WaitBlocker::WaitBlocker(int wait_options, ProcessID& waitee_pid)
     : m_wait_options(wait_options)
     , m_waitee_pid(waitee_pid)
@@ -339,6 +351,187 @@ void Scheduler::start()
     ASSERT_NOT_REACHED();
 }
 
+static bool can_run_on(const Thread& thread, u32 cpu)
+{
+    if ((thread.affinity() & (1u << cpu)) == 0)
+        return false;
+    // While a process is exec()ing, only the thread doing the exec may run.
+    auto exec_tid = thread.process().exec_tid();
+    return !exec_tid || exec_tid == thread.tid();
+}
+
+static Thread* first_runnable_thread_in(ThreadReadyQueue& queue, u32 cpu)
+{
+    ASSERT(queue.m_lock.is_locked());
+    for (u32 levels = queue.m_nonempty_levels; levels;) {
+        u32 level = 31 - __builtin_clz(levels);
+        for (auto& thread : queue.m_threads[level]) {
+            if (can_run_on(thread, cpu))
+                return &thread;
+        }
+        levels &= ~(1u << level);
+    }
+    return nullptr;
+}
+
+// Look for work at the other processors, starting with the one that has the most of it.
+// The stolen thread is left in its queue until it's switched to, so this needs
+// g_scheduler_lock to keep anyone else from taking it in the meantime.
+static Thread* steal_runnable_thread_for(u32 cpu)
+{
+    ASSERT(g_scheduler_lock.own_lock());
+    Thread* stolen_thread = nullptr;
+    u32 victim_thread_count = 0;
+    for (u32 i = 0; i < SchedulerData::max_processors; ++i) {
+        auto& queue = g_scheduler_data->m_ready_queues[i];
+        if (i == cpu || queue.m_thread_count <= victim_thread_count)
+            continue;
+        ScopedSpinLock queue_lock(queue.m_lock);
+        if (auto* thread = first_runnable_thread_in(queue, cpu)) {
+            stolen_thread = thread;
+            victim_thread_count = queue.m_thread_count;
+        }
+    }
+    return stolen_thread;
+}
+
+// Every so many picks that leave lower priority threads waiting, the one that
+// has waited longest at the lowest level gets to jump to the front, so that a
+// busy high priority thread can't starve everyone else forever.
+static void age_ready_queue(ThreadReadyQueue& queue, u32 cpu, u32 picked_level)
+{
+    static constexpr u32 picks_before_aging = 8;
+    ASSERT(queue.m_lock.is_locked());
+    if (queue.is_empty() || queue.lowest_level() >= picked_level) {
+        queue.m_picks_since_aging = 0;
+        return;
+    }
+    if (++queue.m_picks_since_aging < picks_before_aging)
+        return;
+    queue.m_picks_since_aging = 0;
+    auto& starved_thread = *queue.m_threads[queue.lowest_level()].first();
+    queue.dequeue(starved_thread);
+    queue.enqueue(starved_thread, cpu, ThreadReadyQueue::level_count - 1);
+}
+
+// NOTE: This peeks at another processor's queue without its lock. It's only a hint
+//       for placing a thread, and a stale answer merely places it less well.
+static bool is_idle(u32 cpu)
+{
+    auto& processor = Processor::by_id(cpu);
+    return processor.current_thread() == processor.idle_thread() && g_scheduler_data->m_ready_queues[cpu].is_empty();
+}
+
+static u32 ready_queue_cpu_for(const Thread& thread)
+{
+    // Only processors that take scheduler ticks can be relied on to get around to a queued thread.
+    u32 processor_count = min((u32)Processor::processor_count(), SchedulerData::max_processors);
+    auto is_eligible = [&](u32 cpu) {
+        return cpu < processor_count && (thread.affinity() & (1u << cpu)) && g_scheduler_data->m_ready_queues[cpu].m_is_active;
+    };
+
+    // Go back to where the thread last ran while its caches may still be warm, unless
+    // that processor is busy and another one is sitting idle.
+    auto last_cpu = thread.times_scheduled() ? thread.cpu() : Processor::current().id();
+    if (is_eligible(last_cpu) && is_idle(last_cpu))
+        return last_cpu;
+    for (u32 cpu = 0; cpu < processor_count; ++cpu) {
+        if (cpu != last_cpu && is_eligible(cpu) && is_idle(cpu))
+            return cpu;
+    }
+    if (is_eligible(last_cpu))
+        return last_cpu;
+
+    Optional<u32> first_allowed_cpu;
+    for (u32 cpu = 0; cpu < processor_count; ++cpu) {
+        if (is_eligible(cpu))
+            return cpu;
+        if (!first_allowed_cpu.has_value() && (thread.affinity() & (1u << cpu)))
+            first_allowed_cpu = cpu;
+    }
+    return first_allowed_cpu.value_or(Processor::current().id());
+}
+
+// Moving a thread costs it its warm caches, so the balancer only steps in once the
+// queues are clearly uneven, and then moves the threads that would have waited longest.
+static constexpr u64 ticks_between_load_balancing = 100;
+static constexpr u32 load_imbalance_threshold = 2;
+static u64 s_next_load_balance_at;
+
+static Thread* movable_thread_in(ThreadReadyQueue& queue, u32 cpu)
+{
+    ASSERT(queue.m_lock.is_locked());
+    for (u32 levels = queue.m_nonempty_levels; levels;) {
+        u32 level = __builtin_ctz(levels);
+        Thread* movable_thread = nullptr;
+        for (auto& thread : queue.m_threads[level]) {
+            if (can_run_on(thread, cpu))
+                movable_thread = &thread;
+        }
+        if (movable_thread)
+            return movable_thread;
+        levels &= ~(1u << level);
+    }
+    return nullptr;
+}
+
+static void balance_ready_queues()
+{
+    ASSERT(g_scheduler_lock.own_lock());
+    u32 processor_count = min((u32)Processor::processor_count(), SchedulerData::max_processors);
+    for (;;) {
+        Optional<u32> busiest_cpu;
+        Optional<u32> idlest_cpu;
+        for (u32 cpu = 0; cpu < processor_count; ++cpu) {
+            auto& queue = g_scheduler_data->m_ready_queues[cpu];
+            if (!queue.m_is_active)
+                continue;
+            if (!busiest_cpu.has_value() || queue.m_thread_count > g_scheduler_data->m_ready_queues[busiest_cpu.value()].m_thread_count)
+                busiest_cpu = cpu;
+            if (!idlest_cpu.has_value() || queue.m_thread_count < g_scheduler_data->m_ready_queues[idlest_cpu.value()].m_thread_count)
+                idlest_cpu = cpu;
+        }
+        if (!busiest_cpu.has_value() || busiest_cpu.value() == idlest_cpu.value())
+            return;
+
+        auto& busiest_queue = g_scheduler_data->m_ready_queues[busiest_cpu.value()];
+        auto& idlest_queue = g_scheduler_data->m_ready_queues[idlest_cpu.value()];
+
+        // Queue locks are always taken in processor order, so two balancers can't deadlock.
+        auto& first_queue = busiest_cpu.value() < idlest_cpu.value() ? busiest_queue : idlest_queue;
+        auto& second_queue = busiest_cpu.value() < idlest_cpu.value() ? idlest_queue : busiest_queue;
+        ScopedSpinLock first_lock(first_queue.m_lock);
+        ScopedSpinLock second_lock(second_queue.m_lock);
+        if (busiest_queue.m_thread_count <= idlest_queue.m_thread_count + load_imbalance_threshold)
+            return;
+
+        auto* thread = movable_thread_in(busiest_queue, idlest_cpu.value());
+        if (!thread)
+            return;
+        auto level = thread->ready_queue_level();
+        busiest_queue.dequeue(*thread);
+        idlest_queue.enqueue(*thread, idlest_cpu.value(), level);
+        ++idlest_queue.m_migrations;
+    }
+}
+
+void Scheduler::enqueue_runnable_thread(Thread& thread)
+{
+    auto cpu = ready_queue_cpu_for(thread);
+    auto& queue = g_scheduler_data->m_ready_queues[cpu];
+    ScopedSpinLock lock(queue.m_lock);
+    queue.enqueue(thread, cpu, ThreadReadyQueue::level_for(thread));
+}
+
+void Scheduler::dequeue_runnable_thread(Thread& thread)
+{
+    // Only migration moves a queued thread, and that can't happen while we hold g_scheduler_lock.
+    ASSERT(g_scheduler_lock.own_lock());
+    auto& queue = g_scheduler_data->m_ready_queues[thread.ready_queue_cpu()];
+    ScopedSpinLock lock(queue.m_lock);
+    queue.dequeue(thread);
+}
+
 bool Scheduler::pick_next()
 {
     ASSERT_INTERRUPTS_DISABLED();
@@ -443,32 +636,40 @@ bool Scheduler::pick_next()
     });
 #endif
 
-    Vector<Thread*, 128> sorted_runnables;
-    for_each_runnable([&sorted_runnables](auto& thread) {
-        if ((thread.affinity() & (1u << Processor::current().id())) != 0)
-            sorted_runnables.append(&thread);
-        return IterationDecision::Continue;
-    });
-    quick_sort(sorted_runnables, [](auto& a, auto& b) { return a->effective_priority() >= b->effective_priority(); });
-
-    Thread* thread_to_schedule = nullptr;
+    if (g_uptime >= s_next_load_balance_at) {
+        s_next_load_balance_at = g_uptime + ticks_between_load_balancing;
+        balance_ready_queues();
+    }
 
-    for (auto* thread : sorted_runnables) {
-        if (thread->process().exec_tid() && thread->process().exec_tid() != thread->tid())
-            continue;
+    auto cpu = Processor::current().id();
+    auto& ready_queue = g_scheduler_data->m_ready_queues[cpu];
+    Thread* thread_to_schedule;
+    {
+        ScopedSpinLock queue_lock(ready_queue.m_lock);
+        thread_to_schedule = first_runnable_thread_in(ready_queue, cpu);
+    }
+    if (!thread_to_schedule)
+        thread_to_schedule = steal_runnable_thread_for(cpu);
 
-        ASSERT(thread->state() == Thread::Runnable || thread->state() == Thread::Running);
+    // The current thread isn't queued while it's running, so it keeps the
+    // processor unless something at least as important is waiting.
+    if (current_thread->state() == Thread::Running && current_thread != Processor::current().idle_thread() && can_run_on(*current_thread, cpu)) {
+        if (!thread_to_schedule || ThreadReadyQueue::level_for(*current_thread) > thread_to_schedule->ready_queue_level())
+            thread_to_schedule = current_thread;
+    }
 
-        if (!thread_to_schedule) {
-            thread->m_extra_priority = 0;
-            thread_to_schedule = thread;
+    if (thread_to_schedule) {
+        ScopedSpinLock queue_lock(ready_queue.m_lock);
+        if (thread_to_schedule == current_thread) {
+            age_ready_queue(ready_queue, cpu, ThreadReadyQueue::level_for(*current_thread));
         } else {
-            thread->m_extra_priority++;
+            if (thread_to_schedule->ready_queue_cpu() != cpu)
+                ++ready_queue.m_migrations;
+            age_ready_queue(ready_queue, cpu, thread_to_schedule->ready_queue_level());
         }
-    }
-
-    if (!thread_to_schedule)
+    } else {
         thread_to_schedule = Processor::current().idle_thread();
+    }
 
 #ifdef SCHEDULER_DEBUG
     dbg() << "Scheduler[" << Processor::current().id() << "]: Switch to " << *thread_to_schedule << " @ " << String::format("%04x:%08x", thread_to_schedule->tss().cs, thread_to_schedule->tss().eip);
@@ -551,6 +752,8 @@ bool Scheduler::donate_to(Thread* beneficiary, const char* reason)
 
 bool Scheduler::context_switch(Thread* thread)
 {
+    if (thread->times_scheduled() && thread->cpu() != Processor::current().id())
+        thread->did_migrate();
     thread->set_ticks_left(time_slice_for(*thread));
     thread->did_schedule();
 
@@ -558,18 +761,29 @@ bool Scheduler::context_switch(Thread* thread)
     if (from_thread == thread)
         return false;
 
+    auto& proc = Processor::current();
+    bool is_preempting = proc.get_scheduler_data().m_is_preempting;
+    proc.get_scheduler_data().m_is_preempting = false;
+
     if (from_thread) {
         // If the last process hasn't blocked (still marked as running),
         // mark it as runnable for the next round.
-        if (from_thread->state() == Thread::Running)
+        if (from_thread->state() == Thread::Running) {
             from_thread->set_state(Thread::Runnable);
+            if (is_preempting && from_thread != proc.idle_thread())
+                from_thread->did_involuntary_switch();
+        }
 
 #ifdef LOG_EVERY_CONTEXT_SWITCH
         dbg() << "Scheduler[" << Processor::current().id() << "]: " << *from_thread << " -> " << *thread << " [" << thread->priority() << "] " << String::format("%w", thread->tss().cs) << ":" << String::format("%x", thread->tss().eip);
 #endif
     }
 
-    auto& proc = Processor::current();
+    // The system timer may have been told to sleep through a few ticks while we were idle,
+    // but now there's a time slice to keep track of again.
+    if (from_thread == proc.idle_thread() && proc.id() == 0)
+        TimeManagement::the().program_next_system_timer_interrupt(false);
+
     if (!thread->is_initialized()) {
         proc.init_context(*thread, false);
         thread->set_initialized(true);
@@ -691,25 +905,30 @@ void Scheduler::timer_tick(const RegisterState& regs)
     if (!current_thread)
         return;
 
-    ++g_uptime;
+    g_scheduler_data->m_ready_queues[Processor::current().id()].m_is_active = true;
+
+    // A one-shot system timer may interrupt early for a timer that's due in
+    // between ticks, or late after letting an idle processor sleep through some.
+    bool is_one_shot = TimeManagement::the().is_system_timer_one_shot();
+    u64 elapsed_ticks = is_one_shot ? TimeManagement::the().catch_up_system_ticks() : 1;
+    g_uptime += elapsed_ticks;
 
     g_timeofday = TimeManagement::now_as_timeval();
 
-    if (current_thread->process().is_profiling()) {
-        SmapDisabler disabler;
-        auto backtrace = current_thread->raw_backtrace(regs.ebp, regs.eip);
-        auto& sample = Profiling::next_sample_slot();
-        sample.pid = current_thread->process().pid();
-        sample.tid = current_thread->tid();
-        sample.timestamp = g_uptime;
-        for (size_t i = 0; i < min(backtrace.size(), Profiling::max_stack_frame_count); ++i) {
-            sample.frames[i] = backtrace[i];
-        }
-    }
+    // Threads that sample on a hardware counter's overflow don't also get timer samples
+    if (elapsed_ticks && Profiling::is_sampling(current_thread->process()) && !current_thread->performance_counter().sample_period)
+        Profiling::record_sample(*current_thread, regs);
 
-    TimerQueue::the().fire();
+    TimerQueue::fire();
 
-    if (current_thread->tick())
+    if (is_one_shot) {
+        // NOTE: This peeks at the ready queue without the scheduler lock; at worst we idle one tick too long or too short.
+        bool is_idle = current_thread == Processor::current().idle_thread() && g_scheduler_data->m_ready_queues[Processor::current().id()].is_empty();
+        TimeManagement::the().program_next_system_timer_interrupt(is_idle);
+    }
+
+    // An early interrupt is for a timer, which most likely woke someone up.
+    if (elapsed_ticks && current_thread->tick())
         return;
 
     ASSERT_INTERRUPTS_DISABLED();
@@ -726,8 +945,12 @@ void Scheduler::invoke_async()
     // Since this function is called when leaving critical sections (such
     // as a SpinLock), we need to check if we're not already doing this
     // to prevent recursion
-    if (!proc.get_scheduler_data().m_in_scheduler)
+    if (!proc.get_scheduler_data().m_in_scheduler) {
+        // Whoever is running didn't ask to be switched out, see context_switch().
+        proc.get_scheduler_data().m_is_preempting = true;
         pick_next();
+        Processor::current().get_scheduler_data().m_is_preempting = false;
+    }
 }
 
 void Scheduler::notify_finalizer()
@@ -70,6 +70,8 @@ public:
     static void idle_loop();
     static void invoke_async();
     static void notify_finalizer();
+    static void enqueue_runnable_thread(Thread&);
+    static void dequeue_runnable_thread(Thread&);
 
     template<typename Callback>
     static inline IterationDecision for_each_runnable(Callback);
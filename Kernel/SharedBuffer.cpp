@@ -146,6 +146,27 @@ void SharedBuffer::deref_for_process(Process& process)
     ASSERT_NOT_REACHED();
 }
 
+void* SharedBuffer::reclaim_for_process(Process& process)
+{
+    LOCKER(shared_buffers().lock());
+    // Only a buffer that nobody else has mapped (or can, after sealing or sharing globally) can be handed out again.
+    if (m_global || !m_writable || m_total_refs != 1)
+        return nullptr;
+    WeakPtr<Region> region;
+    for (auto& ref : m_refs) {
+        if (ref.pid == process.pid() && ref.count == 1)
+            region = ref.region;
+    }
+    if (!region)
+        return nullptr;
+
+    // Whoever it was shared with didn't map it, so as far as they're concerned it's gone.
+    m_refs.remove_all_matching([&](auto& ref) { return ref.pid != process.pid(); });
+    m_vmobject->set_volatile(true);
+    sanity_check("reclaim_for_process");
+    return region->vaddr().as_ptr();
+}
+
 void SharedBuffer::disown(ProcessID pid)
 {
     LOCKER(shared_buffers().lock());
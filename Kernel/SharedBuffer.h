@@ -69,6 +69,7 @@ public:
     void share_with(ProcessID peer_pid);
     void share_globally() { m_global = true; }
     void deref_for_process(Process& process);
+    void* reclaim_for_process(Process& process);
     void disown(ProcessID pid);
     size_t size() const { return m_vmobject->size(); }
     void destroy_if_unused();
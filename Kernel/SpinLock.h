@@ -30,6 +30,7 @@
 #include <AK/Types.h>
 #include <Kernel/Arch/i386/CPU.h>
 #include <Kernel/Forward.h>
+#include <Kernel/LockContention.h>
 
 namespace Kernel {
 
@@ -41,21 +42,39 @@ class SpinLock {
 public:
     SpinLock() = default;
 
-    ALWAYS_INLINE u32 lock()
+    // The call site only matters with LOCK_STATISTICS
+    ALWAYS_INLINE u32 lock([[maybe_unused]] const char* file = __builtin_FILE(), [[maybe_unused]] u32 line = __builtin_LINE())
     {
         u32 prev_flags;
         Processor::current().enter_critical(prev_flags);
+#ifdef LOCK_STATISTICS
+        u64 started_at = read_tsc();
+        bool contended = false;
+#endif
         BaseType expected;
-        do {
+        for (;;) {
             Processor::wait_check();
             expected = 0;
-        } while (!m_lock.compare_exchange_strong(expected, 1, AK::memory_order_acq_rel));
+            if (m_lock.compare_exchange_strong(expected, 1, AK::memory_order_acq_rel))
+                break;
+#ifdef LOCK_STATISTICS
+            contended = true;
+#endif
+        }
+#ifdef LOCK_STATISTICS
+        m_site = &LockContention::site_for("SpinLock", file, line);
+        m_acquired_at = read_tsc();
+        LockContention::did_acquire(*m_site, contended, m_acquired_at - started_at);
+#endif
         return prev_flags;
     }
 
     ALWAYS_INLINE void unlock(u32 prev_flags)
     {
         ASSERT(is_locked());
+#ifdef LOCK_STATISTICS
+        LockContention::did_release(*m_site, read_tsc() - m_acquired_at);
+#endif
         m_lock.store(0, AK::memory_order_release);
         Processor::current().leave_critical(prev_flags);
     }
@@ -72,6 +91,10 @@ public:
 
 private:
     AK::Atomic<BaseType> m_lock { 0 };
+#ifdef LOCK_STATISTICS
+    LockContention::Site* m_site { nullptr };
+    u64 m_acquired_at { 0 };
+#endif
 };
 
 class RecursiveSpinLock {
@@ -81,19 +104,34 @@ class RecursiveSpinLock {
 public:
     RecursiveSpinLock() = default;
 
-    ALWAYS_INLINE u32 lock()
+    ALWAYS_INLINE u32 lock([[maybe_unused]] const char* file = __builtin_FILE(), [[maybe_unused]] u32 line = __builtin_LINE())
     {
         auto& proc = Processor::current();
         FlatPtr cpu = FlatPtr(&proc);
         u32 prev_flags;
         proc.enter_critical(prev_flags);
+#ifdef LOCK_STATISTICS
+        u64 started_at = read_tsc();
+        bool contended = false;
+#endif
         FlatPtr expected = 0;
         while (!m_lock.compare_exchange_strong(expected, cpu, AK::memory_order_acq_rel)) {
             if (expected == cpu)
                 break;
             Processor::wait_check();
             expected = 0;
+#ifdef LOCK_STATISTICS
+            contended = true;
+#endif
         }
+#ifdef LOCK_STATISTICS
+        // Only the outermost acquisition counts, the others can't contend.
+        if (m_recursions == 0) {
+            m_site = &LockContention::site_for("RecursiveSpinLock", file, line);
+            m_acquired_at = read_tsc();
+            LockContention::did_acquire(*m_site, contended, m_acquired_at - started_at);
+        }
+#endif
         m_recursions++;
         return prev_flags;
     }
@@ -102,8 +140,12 @@ public:
     {
         ASSERT(m_recursions > 0);
         ASSERT(m_lock.load(AK::memory_order_consume) == FlatPtr(&Processor::current()));
-        if (--m_recursions == 0)
+        if (--m_recursions == 0) {
+#ifdef LOCK_STATISTICS
+            LockContention::did_release(*m_site, read_tsc() - m_acquired_at);
+#endif
             m_lock.store(0, AK::memory_order_release);
+        }
         Processor::current().leave_critical(prev_flags);
     }
 
@@ -125,6 +167,10 @@ public:
 private:
     AK::Atomic<FlatPtr> m_lock { 0 };
     u32 m_recursions { 0 };
+#ifdef LOCK_STATISTICS
+    LockContention::Site* m_site { nullptr };
+    u64 m_acquired_at { 0 };
+#endif
 };
 
 template<typename LockType>
@@ -135,11 +181,11 @@ public:
     ScopedSpinLock() = delete;
     ScopedSpinLock& operator=(ScopedSpinLock&&) = delete;
 
-    ScopedSpinLock(LockType& lock)
+    ScopedSpinLock(LockType& lock, const char* file = __builtin_FILE(), u32 line = __builtin_LINE())
         : m_lock(&lock)
     {
         ASSERT(m_lock);
-        m_prev_flags = m_lock->lock();
+        m_prev_flags = m_lock->lock(file, line);
         m_have_lock = true;
     }
 
@@ -160,11 +206,11 @@ public:
         }
     }
 
-    ALWAYS_INLINE void lock()
+    ALWAYS_INLINE void lock(const char* file = __builtin_FILE(), u32 line = __builtin_LINE())
     {
         ASSERT(m_lock);
         ASSERT(!m_have_lock);
-        m_prev_flags = m_lock->lock();
+        m_prev_flags = m_lock->lock(file, line);
         m_have_lock = true;
     }
 
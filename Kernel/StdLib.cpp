@@ -89,21 +89,25 @@ void* memcpy(void* dest_ptr, const void* src_ptr, size_t n)
 {
     size_t dest = (size_t)dest_ptr;
     size_t src = (size_t)src_ptr;
-    // FIXME: Support starting at an unaligned address.
-    if (!(dest & 0x3) && !(src & 0x3) && n >= 12) {
+    if (n >= 12) {
+        // Copy a few bytes to align the destination, then do the bulk a dword at a time.
+        // Unaligned loads from the source are cheap compared to unaligned stores.
+        size_t head = -dest & 0x3;
+        n -= head;
+        asm volatile(
+            "rep movsb\n"
+            : "+S"(src), "+D"(dest), "+c"(head)::"memory");
         size_t size_ts = n / sizeof(size_t);
         asm volatile(
             "rep movsl\n"
-            : "=S"(src), "=D"(dest)
-            : "S"(src), "D"(dest), "c"(size_ts)
-            : "memory");
-        n -= size_ts * sizeof(size_t);
+            : "+S"(src), "+D"(dest), "+c"(size_ts)::"memory");
+        n %= sizeof(size_t);
         if (n == 0)
             return dest_ptr;
     }
     asm volatile(
-        "rep movsb\n" ::"S"(src), "D"(dest), "c"(n)
-        : "memory");
+        "rep movsb\n"
+        : "+S"(src), "+D"(dest), "+c"(n)::"memory");
     return dest_ptr;
 }
 
@@ -173,25 +177,31 @@ void memset_user(void* dest_ptr, int c, size_t n)
 void* memset(void* dest_ptr, int c, size_t n)
 {
     size_t dest = (size_t)dest_ptr;
-    // FIXME: Support starting at an unaligned address.
-    if (!(dest & 0x3) && n >= 12) {
+    if (n >= 12) {
+        size_t head = -dest & 0x3;
+        n -= head;
+        asm volatile(
+            "rep stosb\n"
+            : "+D"(dest), "+c"(head)
+            : "a"(c)
+            : "memory");
         size_t size_ts = n / sizeof(size_t);
         size_t expanded_c = (u8)c;
         expanded_c |= expanded_c << 8;
         expanded_c |= expanded_c << 16;
         asm volatile(
             "rep stosl\n"
-            : "=D"(dest)
-            : "D"(dest), "c"(size_ts), "a"(expanded_c)
+            : "+D"(dest), "+c"(size_ts)
+            : "a"(expanded_c)
             : "memory");
-        n -= size_ts * sizeof(size_t);
+        n %= sizeof(size_t);
         if (n == 0)
             return dest_ptr;
     }
     asm volatile(
         "rep stosb\n"
-        : "=D"(dest), "=c"(n)
-        : "0"(dest), "1"(n), "a"(c)
+        : "+D"(dest), "+c"(n)
+        : "a"(c)
         : "memory");
     return dest_ptr;
 }
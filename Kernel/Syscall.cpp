@@ -29,6 +29,7 @@
 #include <Kernel/Random.h>
 #include <Kernel/API/Syscall.h>
 #include <Kernel/ThreadTracer.h>
+#include <Kernel/Time/TimeManagement.h>
 #include <Kernel/VM/MemoryManager.h>
 
 namespace Kernel {
@@ -164,7 +165,10 @@ void syscall_handler(TrapFrame* trap)
     u32 arg1 = regs.edx;
     u32 arg2 = regs.ecx;
     u32 arg3 = regs.ebx;
+    u64 entered_at = TimeManagement::the().nanoseconds_since_boot();
     regs.eax = (u32)Syscall::handle(regs, function, arg1, arg2, arg3);
+    if (function < Syscall::Function::__Count)
+        process.syscall_statistics().record(function, TimeManagement::the().nanoseconds_since_boot() - entered_at);
 
     if (current_thread->tracer() && current_thread->tracer()->is_tracing_syscalls()) {
         current_thread->tracer()->set_trace_syscalls(false);
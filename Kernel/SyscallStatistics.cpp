@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <Kernel/Process.h>
+#include <Kernel/SpinLock.h>
+#include <Kernel/SyscallStatistics.h>
+
+namespace Kernel {
+
+static SpinLock<u8> s_exited_lock;
+static SyscallLatency* s_exited;
+
+void SyscallLatency::record(u64 nanoseconds)
+{
+    ++call_count;
+    total_nanoseconds += nanoseconds;
+    size_t bucket = nanoseconds ? 63 - __builtin_clzll(nanoseconds) : 0;
+    ++histogram[min(bucket, histogram_bucket_count - 1)];
+}
+
+void SyscallLatency::add(const SyscallLatency& other)
+{
+    call_count += other.call_count;
+    total_nanoseconds += other.total_nanoseconds;
+    for (size_t i = 0; i < histogram_bucket_count; ++i)
+        histogram[i] += other.histogram[i];
+}
+
+void SyscallStatistics::record(u32 function, u64 nanoseconds)
+{
+    ASSERT(function < Syscall::Function::__Count);
+    auto& latency = m_latencies[function];
+    if (!latency)
+        latency = make<SyscallLatency>();
+    latency->record(nanoseconds);
+}
+
+void SyscallStatistics::did_exit(const SyscallStatistics& statistics)
+{
+    ScopedSpinLock lock(s_exited_lock);
+    if (!s_exited)
+        s_exited = new SyscallLatency[Syscall::Function::__Count];
+    for (u32 function = 0; function < Syscall::Function::__Count; ++function) {
+        if (auto* latency = statistics.get(function))
+            s_exited[function].add(*latency);
+    }
+}
+
+void SyscallStatistics::for_each_system_wide(Function<void(u32, const SyscallLatency&)> callback)
+{
+    auto processes = Process::all_processes();
+    for (u32 function = 0; function < Syscall::Function::__Count; ++function) {
+        SyscallLatency total;
+        {
+            ScopedSpinLock lock(s_exited_lock);
+            if (s_exited)
+                total = s_exited[function];
+        }
+        for (auto& process : processes) {
+            if (auto* latency = process.syscall_statistics().get(function))
+                total.add(*latency);
+        }
+        if (total.call_count)
+            callback(function, total);
+    }
+}
+
+}
@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/Function.h>
+#include <AK/OwnPtr.h>
+#include <AK/Types.h>
+#include <Kernel/API/Syscall.h>
+
+namespace Kernel {
+
+struct SyscallLatency {
+    // Bucket n counts the calls that took [2^n, 2^(n+1)) nanoseconds, the last one everything longer.
+    static constexpr size_t histogram_bucket_count = 32;
+
+    u32 call_count { 0 };
+    u64 total_nanoseconds { 0 };
+    u32 histogram[histogram_bucket_count] {};
+
+    void record(u64 nanoseconds);
+    void add(const SyscallLatency&);
+};
+
+// Per-process counts and latencies of each syscall. Only the threads of the process update them,
+// with its big lock held. Readers don't lock, and may see a call that's only half accounted for.
+class SyscallStatistics {
+public:
+    void record(u32 function, u64 nanoseconds);
+    const SyscallLatency* get(u32 function) const { return m_latencies[function]; }
+
+    // The system-wide numbers: every live process plus the ones that have exited.
+    static void did_exit(const SyscallStatistics&);
+    static void for_each_system_wide(Function<void(u32 function, const SyscallLatency&)>);
+
+private:
+    // Most programs only make a handful of different syscalls, so the numbers are allocated on first use.
+    OwnPtr<SyscallLatency> m_latencies[Syscall::Function::__Count];
+};
+
+}
@@ -32,9 +32,9 @@ namespace Kernel {
 int Process::sys$beep()
 {
     PCSpeaker::tone_on(440);
-    u64 wakeup_time = Thread::current()->sleep(100);
+    u64 nanoseconds_left = Thread::current()->sleep_for(100'000'000);
     PCSpeaker::tone_off();
-    if (wakeup_time > g_uptime)
+    if (nanoseconds_left)
         return -EINTR;
     return 0;
 }
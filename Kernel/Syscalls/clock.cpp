@@ -26,6 +26,7 @@
 
 #include <Kernel/Process.h>
 #include <Kernel/Time/TimeManagement.h>
+#include <Kernel/VM/Region.h>
 
 namespace Kernel {
 
@@ -38,10 +39,12 @@ int Process::sys$clock_gettime(clockid_t clock_id, Userspace<timespec*> user_ts)
     timespec ts = {};
 
     switch (clock_id) {
-    case CLOCK_MONOTONIC:
-        ts.tv_sec = TimeManagement::the().seconds_since_boot();
-        ts.tv_nsec = TimeManagement::the().ticks_this_second() * 1000000;
+    case CLOCK_MONOTONIC: {
+        auto nanoseconds = TimeManagement::the().nanoseconds_since_boot();
+        ts.tv_sec = nanoseconds / 1'000'000'000;
+        ts.tv_nsec = nanoseconds % 1'000'000'000;
         break;
+    }
     case CLOCK_REALTIME:
         ts.tv_sec = TimeManagement::the().epoch_time();
         ts.tv_nsec = TimeManagement::the().ticks_this_second() * 1000000;
@@ -94,42 +97,50 @@ int Process::sys$clock_nanosleep(Userspace<const Syscall::SC_clock_nanosleep_par
 
     bool is_absolute = params.flags & TIMER_ABSTIME;
 
+    if (requested_sleep.tv_sec < 0 || requested_sleep.tv_nsec < 0 || requested_sleep.tv_nsec >= 1'000'000'000)
+        return -EINVAL;
+    u64 requested_nanoseconds = (u64)requested_sleep.tv_sec * 1'000'000'000 + requested_sleep.tv_nsec;
+
+    u64 nanoseconds_left;
     switch (params.clock_id) {
-    case CLOCK_MONOTONIC: {
-        u64 wakeup_time;
+    case CLOCK_MONOTONIC:
+        if (is_absolute)
+            nanoseconds_left = Thread::current()->sleep_until(requested_nanoseconds);
+        else
+            nanoseconds_left = Thread::current()->sleep_for(requested_nanoseconds);
+        break;
+    case CLOCK_REALTIME:
         if (is_absolute) {
-            u64 time_to_wake = (requested_sleep.tv_sec * 1000 + requested_sleep.tv_nsec / 1000000);
-            wakeup_time = Thread::current()->sleep_until(time_to_wake);
-        } else {
-            u64 ticks_to_sleep = requested_sleep.tv_sec * TimeManagement::the().ticks_per_second();
-            ticks_to_sleep += requested_sleep.tv_nsec * TimeManagement::the().ticks_per_second() / 1000000000;
-            if (!ticks_to_sleep)
+            // Translate the wall clock deadline onto the monotonic clock; moving the wall clock afterwards won't affect it.
+            u64 now = (u64)TimeManagement::the().epoch_time() * 1'000'000'000 + (u64)TimeManagement::the().ticks_this_second() * 1'000'000;
+            if (requested_nanoseconds <= now)
                 return 0;
-            wakeup_time = Thread::current()->sleep(ticks_to_sleep);
-        }
-        if (wakeup_time > g_uptime) {
-            u64 ticks_left = wakeup_time - g_uptime;
-            if (!is_absolute && params.remaining_sleep) {
-                if (!validate_write_typed(params.remaining_sleep)) {
-                    // This can happen because the lock is dropped while
-                    // sleeping, thus giving other threads the opportunity
-                    // to make the region unwritable.
-                    return -EFAULT;
-                }
-
-                timespec remaining_sleep = {};
-                remaining_sleep.tv_sec = ticks_left / TimeManagement::the().ticks_per_second();
-                ticks_left -= remaining_sleep.tv_sec * TimeManagement::the().ticks_per_second();
-                remaining_sleep.tv_nsec = ticks_left * 1000000000 / TimeManagement::the().ticks_per_second();
-                copy_to_user(params.remaining_sleep, &remaining_sleep);
-            }
-            return -EINTR;
+            nanoseconds_left = Thread::current()->sleep_for(requested_nanoseconds - now);
+        } else {
+            nanoseconds_left = Thread::current()->sleep_for(requested_nanoseconds);
         }
-        return 0;
-    }
+        break;
     default:
         return -EINVAL;
     }
+
+    if (!nanoseconds_left)
+        return 0;
+
+    if (!is_absolute && params.remaining_sleep) {
+        if (!validate_write_typed(params.remaining_sleep)) {
+            // This can happen because the lock is dropped while
+            // sleeping, thus giving other threads the opportunity
+            // to make the region unwritable.
+            return -EFAULT;
+        }
+
+        timespec remaining_sleep = {};
+        remaining_sleep.tv_sec = nanoseconds_left / 1'000'000'000;
+        remaining_sleep.tv_nsec = nanoseconds_left % 1'000'000'000;
+        copy_to_user(params.remaining_sleep, &remaining_sleep);
+    }
+    return -EINTR;
 }
 
 int Process::sys$gettimeofday(Userspace<timeval*> user_tv)
@@ -142,4 +153,15 @@ int Process::sys$gettimeofday(Userspace<timeval*> user_tv)
     return 0;
 }
 
+void* Process::sys$map_time_page()
+{
+    REQUIRE_PROMISE(stdio);
+    auto* region = allocate_region_with_vmobject(VirtualAddress(), PAGE_SIZE, TimeManagement::the().time_page_vmobject(), 0, "Time page", PROT_READ);
+    if (!region)
+        return (void*)-ENOMEM;
+    // Every process that maps it sees the same page, and so should its children.
+    region->set_shared(true);
+    return region->vaddr().as_ptr();
+}
+
 }
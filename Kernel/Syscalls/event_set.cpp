@@ -0,0 +1,137 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <AK/Time.h>
+#include <Kernel/FileSystem/EventSet.h>
+#include <Kernel/FileSystem/FileDescription.h>
+#include <Kernel/Process.h>
+
+namespace Kernel {
+
+static constexpr int max_events_per_wait = 256;
+
+int Process::sys$event_set_create(int flags)
+{
+    REQUIRE_PROMISE(stdio);
+    if ((flags & O_CLOEXEC) != flags)
+        return -EINVAL;
+
+    int fd = alloc_fd();
+    if (fd < 0)
+        return fd;
+
+    u32 fd_flags = (flags & O_CLOEXEC) ? FD_CLOEXEC : 0;
+    m_fds[fd].set(FileDescription::create(*EventSet::create()), fd_flags);
+    m_fds[fd].description()->set_readable(true);
+    return fd;
+}
+
+int Process::sys$event_set_ctl(Userspace<const Syscall::SC_event_set_ctl_params*> user_params)
+{
+    REQUIRE_PROMISE(stdio);
+    Syscall::SC_event_set_ctl_params params;
+    if (!validate_read_and_copy_typed(&params, user_params))
+        return -EFAULT;
+
+    if (params.events & ~(EVENT_SET_IN | EVENT_SET_OUT | EVENT_SET_EDGE_TRIGGERED))
+        return -EINVAL;
+
+    auto set_description = file_description(params.set_fd);
+    if (!set_description)
+        return -EBADF;
+    if (!set_description->file().is_event_set())
+        return -EINVAL;
+    auto& event_set = static_cast<EventSet&>(set_description->file());
+
+    if (params.op == EVENT_SET_CTL_REMOVE)
+        return event_set.remove(params.fd);
+
+    auto description = file_description(params.fd);
+    if (!description)
+        return -EBADF;
+    // Nesting event sets would have them evaluate each other from inside their locks.
+    if (description->file().is_event_set())
+        return -EINVAL;
+
+    switch (params.op) {
+    case EVENT_SET_CTL_ADD:
+        return event_set.add(params.fd, *description, params.events, params.data);
+    case EVENT_SET_CTL_MODIFY:
+        return event_set.modify(params.fd, *description, params.events, params.data);
+    default:
+        return -EINVAL;
+    }
+}
+
+int Process::sys$event_set_wait(Userspace<const Syscall::SC_event_set_wait_params*> user_params)
+{
+    REQUIRE_PROMISE(stdio);
+    Syscall::SC_event_set_wait_params params;
+    if (!validate_read_and_copy_typed(&params, user_params))
+        return -EFAULT;
+
+    if (params.max_events <= 0)
+        return -EINVAL;
+    if (!validate_write_typed(params.events, params.max_events))
+        return -EFAULT;
+
+    timespec timeout = {};
+    if (params.timeout && !validate_read_and_copy_typed(&timeout, params.timeout))
+        return -EFAULT;
+
+    auto set_description = file_description(params.set_fd);
+    if (!set_description)
+        return -EBADF;
+    if (!set_description->file().is_event_set())
+        return -EINVAL;
+    NonnullRefPtr<EventSet> event_set = static_cast<EventSet&>(set_description->file());
+
+    timespec actual_timeout;
+    bool has_timeout = false;
+    if (params.timeout && (timeout.tv_sec || timeout.tv_nsec)) {
+        timespec ts_since_boot;
+        timeval_to_timespec(Scheduler::time_since_boot(), ts_since_boot);
+        timespec_add(ts_since_boot, timeout, actual_timeout);
+        has_timeout = true;
+    }
+
+    if (!params.timeout || has_timeout) {
+        if (Thread::current()->block<Thread::EventSetBlocker>(has_timeout ? &actual_timeout : nullptr, *event_set).was_interrupted())
+            return -EINTR;
+    }
+
+    Vector<event_set_event, 32> ready_events;
+    ready_events.resize(min(params.max_events, max_events_per_wait));
+    size_t count = event_set->collect_ready_events(ready_events.data(), ready_events.size());
+
+    // We may have blocked, so the buffer has to be validated again.
+    if (!validate_write_typed(params.events, count))
+        return -EFAULT;
+    copy_to_user(params.events, ready_events.data(), count * sizeof(event_set_event));
+    return count;
+}
+
+}
@@ -63,6 +63,18 @@ int Process::sys$fcntl(int fd, int cmd, u32 arg)
         break;
     case F_ISTTY:
         return description->is_tty();
+    case F_GETPIPE_SZ:
+        if (!description->is_fifo())
+            return -EINVAL;
+        return description->fifo()->capacity();
+    case F_SETPIPE_SZ: {
+        if (!description->is_fifo())
+            return -EINVAL;
+        auto capacity_or_error = description->fifo()->set_capacity(arg);
+        if (capacity_or_error.is_error())
+            return capacity_or_error.error();
+        return capacity_or_error.value();
+    }
     default:
         return -EINVAL;
     }
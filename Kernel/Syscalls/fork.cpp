@@ -78,15 +78,21 @@ pid_t Process::sys$fork(RegisterState& regs)
 #endif
 
     ScopedSpinLock lock(m_lock);
-    for (auto& region : m_regions) {
+    {
+        // Marking all of our regions CoW should only cost our other processors a single shootdown.
+        ScopedTLBFlushBatch flush_batch;
+        for (auto& region : m_regions) {
 #ifdef FORK_DEBUG
-        dbg() << "fork: cloning Region{" << &region << "} '" << region.name() << "' @ " << region.vaddr();
+            dbg() << "fork: cloning Region{" << &region << "} '" << region.name() << "' @ " << region.vaddr();
 #endif
-        auto& child_region = child->add_region(region.clone());
-        child_region.map(child->page_directory());
+            // Most children exec right away, so they'd never touch most of what we'd map for
+            // them. Let the child fault its pages in instead of building its page tables here.
+            auto& child_region = child->add_region(region.clone());
+            child_region.map_lazily(child->page_directory());
 
-        if (&region == m_master_tls_region)
-            child->m_master_tls_region = child_region.make_weak_ptr();
+            if (&region == m_master_tls_region)
+                child->m_master_tls_region = child_region.make_weak_ptr();
+        }
     }
 
     {
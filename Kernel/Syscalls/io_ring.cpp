@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <Kernel/FileSystem/FileDescription.h>
+#include <Kernel/FileSystem/IORing.h>
+#include <Kernel/Process.h>
+
+namespace Kernel {
+
+int Process::sys$io_ring_create(const Syscall::SC_io_ring_create_params* user_params)
+{
+    REQUIRE_PROMISE(stdio);
+    Syscall::SC_io_ring_create_params params;
+    if (!validate_read_and_copy_typed(&params, user_params))
+        return -EFAULT;
+    if ((params.flags & O_CLOEXEC) != params.flags)
+        return -EINVAL;
+    if (!validate_write_typed(params.ring))
+        return -EFAULT;
+
+    auto ring_or_error = IORing::create(params.entries, params.buffers_size);
+    if (ring_or_error.is_error())
+        return ring_or_error.error();
+    auto ring = ring_or_error.release_value();
+
+    int fd = alloc_fd();
+    if (fd < 0)
+        return fd;
+
+    auto* region = allocate_region_with_vmobject(VirtualAddress(), ring->size(), ring->vmobject(), 0, "IORing", PROT_READ | PROT_WRITE);
+    if (!region)
+        return -ENOMEM;
+    region->set_shared(true);
+
+    auto* ring_address = reinterpret_cast<io_ring_header*>(region->vaddr().as_ptr());
+    copy_to_user(params.ring, &ring_address);
+
+    u32 fd_flags = (params.flags & O_CLOEXEC) ? FD_CLOEXEC : 0;
+    m_fds[fd].set(FileDescription::create(*ring), fd_flags);
+    m_fds[fd].description()->set_readable(true);
+    return fd;
+}
+
+int Process::sys$io_ring_enter(int ring_fd, unsigned min_complete)
+{
+    REQUIRE_PROMISE(stdio);
+    auto description = file_description(ring_fd);
+    if (!description)
+        return -EBADF;
+    if (!description->file().is_io_ring())
+        return -EINVAL;
+    auto& ring = static_cast<IORing&>(description->file());
+
+    unsigned submitted = ring.submit(*this);
+    if (min_complete) {
+        auto result = Thread::current()->block_until("IORing", [&ring, min_complete] {
+            return ring.pending_completions() >= min_complete;
+        });
+        if (result.was_interrupted())
+            return -EINTR;
+    }
+    return submitted;
+}
+
+}
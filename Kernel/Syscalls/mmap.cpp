@@ -27,6 +27,7 @@
 #include <Kernel/FileSystem/FileDescription.h>
 #include <Kernel/Process.h>
 #include <Kernel/VM/PageDirectory.h>
+#include <Kernel/VM/PrivateInodeVMObject.h>
 #include <Kernel/VM/PurgeableVMObject.h>
 #include <Kernel/VM/Region.h>
 #include <Kernel/VM/SharedInodeVMObject.h>
@@ -53,6 +54,16 @@ static bool validate_mmap_prot(int prot, bool map_stack)
     return true;
 }
 
+// Private read-only file mappings share the inode's VMObject with everyone else mapping that file.
+// Before one of them becomes writable, give it a private VMObject so writes stay in this process.
+static void ensure_private_vmobject_for_write(Region& region, int prot)
+{
+    if (!(prot & PROT_WRITE) || region.is_shared() || !region.vmobject().is_shared_inode())
+        return;
+    auto& inode = static_cast<InodeVMObject&>(region.vmobject()).inode();
+    region.set_vmobject(PrivateInodeVMObject::create_with_inode(inode));
+}
+
 static bool validate_inode_mmap_prot(const Process& process, int prot, const Inode& inode, bool map_shared)
 {
     auto metadata = inode.metadata();
@@ -118,6 +129,7 @@ void* Process::sys$mmap(Userspace<const Syscall::SC_mmap_params*> user_params)
     bool map_private = flags & MAP_PRIVATE;
     bool map_stack = flags & MAP_STACK;
     bool map_fixed = flags & MAP_FIXED;
+    bool map_populate = flags & MAP_POPULATE;
 
     if (map_shared && map_private)
         return (void*)-EINVAL;
@@ -188,6 +200,9 @@ void* Process::sys$mmap(Userspace<const Syscall::SC_mmap_params*> user_params)
         region->set_stack(true);
     if (!name.is_null())
         region->set_name(name);
+    // Like on other systems, failing to populate the mapping doesn't fail the mmap().
+    if (map_populate)
+        region->prefault(0, region->page_count());
     return region->vaddr().as_ptr();
 }
 
@@ -214,6 +229,7 @@ int Process::sys$mprotect(void* addr, size_t size, int prot)
             && !validate_inode_mmap_prot(*this, prot, static_cast<const InodeVMObject&>(whole_region->vmobject()).inode(), whole_region->is_shared())) {
             return -EACCES;
         }
+        ensure_private_vmobject_for_write(*whole_region, prot);
         whole_region->set_readable(prot & PROT_READ);
         whole_region->set_writable(prot & PROT_WRITE);
         whole_region->set_executable(prot & PROT_EXEC);
@@ -234,12 +250,16 @@ int Process::sys$mprotect(void* addr, size_t size, int prot)
             return -EACCES;
         }
 
+        // Carving up the region touches the same pages several times, only shoot them down once.
+        ScopedTLBFlushBatch flush_batch;
+
         // This vector is the region(s) adjacent to our range.
         // We need to allocate a new region for the range we wanted to change permission bits on.
         auto adjacent_regions = split_region_around_range(*old_region, range_to_mprotect);
 
         size_t new_range_offset_in_vmobject = old_region->offset_in_vmobject() + (range_to_mprotect.base().get() - old_region->range().base().get());
         auto& new_region = allocate_split_region(*old_region, range_to_mprotect, new_range_offset_in_vmobject);
+        ensure_private_vmobject_for_write(new_region, prot);
         new_region.set_readable(prot & PROT_READ);
         new_region.set_writable(prot & PROT_WRITE);
         new_region.set_executable(prot & PROT_EXEC);
@@ -261,6 +281,38 @@ int Process::sys$mprotect(void* addr, size_t size, int prot)
     return -EINVAL;
 }
 
+static int madvise_access(Region& region, const Range& range, int advice)
+{
+    size_t page_index = region.page_index_from_address(range.base());
+    size_t page_count = PAGE_ROUND_UP(range.size()) / PAGE_SIZE;
+    switch (advice) {
+    case MADV_NORMAL:
+        region.set_access_pattern(Region::AccessPattern::Normal);
+        return 0;
+    case MADV_RANDOM:
+        region.set_access_pattern(Region::AccessPattern::Random);
+        return 0;
+    case MADV_SEQUENTIAL:
+        region.set_access_pattern(Region::AccessPattern::Sequential);
+        return 0;
+    case MADV_WILLNEED:
+        if (!region.prefault(page_index, page_count))
+            return -ENOMEM;
+        return 0;
+    case MADV_FREE:
+        // We don't have anything smarter than throwing the pages away right now.
+        if (!region.vmobject().is_anonymous() || region.is_shared())
+            return -EINVAL;
+        region.discard(page_index, page_count);
+        return 0;
+    case MADV_DONTNEED:
+        region.discard(page_index, page_count);
+        return 0;
+    default:
+        return -EINVAL;
+    }
+}
+
 int Process::sys$madvise(void* address, size_t size, int advice)
 {
     REQUIRE_PROMISE(stdio);
@@ -271,6 +323,19 @@ int Process::sys$madvise(void* address, size_t size, int advice)
     if (!is_user_range(VirtualAddress(address), size))
         return -EFAULT;
 
+    if (!(advice & (MADV_SET_VOLATILE | MADV_SET_NONVOLATILE | MADV_GET_VOLATILE))) {
+        // Access pattern advice can apply to any part of a region.
+        if ((FlatPtr)address & ~PAGE_MASK)
+            return -EINVAL;
+        Range range { VirtualAddress(address), PAGE_ROUND_UP(size) };
+        auto* region = find_region_containing(range);
+        if (!region)
+            return -ENOMEM;
+        if (!region->is_mmap())
+            return -EPERM;
+        return madvise_access(*region, range, advice);
+    }
+
     auto* region = find_region_from_range({ VirtualAddress(address), size });
     if (!region)
         return -EINVAL;
@@ -396,6 +461,9 @@ int Process::sys$munmap(void* addr, size_t size)
         if (!old_region->is_mmap())
             return -EPERM;
 
+        // Carving up the region touches the same pages several times, only shoot them down once.
+        ScopedTLBFlushBatch flush_batch;
+
         auto new_regions = split_region_around_range(*old_region, range_to_unmap);
 
         // We manually unmap the old region here, specifying that we *don't* want the VM deallocated.
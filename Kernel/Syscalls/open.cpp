@@ -68,21 +68,11 @@ int Process::sys$open(Userspace<const Syscall::SC_open_params*> user_params)
     if (fd < 0)
         return fd;
 
-    RefPtr<Custody> base;
-    if (dirfd == AT_FDCWD) {
-        base = current_directory();
-    } else {
-        auto base_description = file_description(dirfd);
-        if (!base_description)
-            return -EBADF;
-        if (!base_description->is_directory())
-            return -ENOTDIR;
-        if (!base_description->custody())
-            return -EINVAL;
-        base = base_description->custody();
-    }
-
-    auto result = VFS::the().open(path.value(), options, mode & ~umask(), *base);
+    auto base = custody_for_dirfd(dirfd);
+    if (base.is_error())
+        return base.error();
+
+    auto result = VFS::the().open(path.value(), options, mode & ~umask(), *base.value());
     if (result.is_error())
         return result.error();
     auto description = result.value();
@@ -24,13 +24,61 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <Kernel/PerformanceCounters.h>
 #include <Kernel/PerformanceEventBuffer.h>
 #include <Kernel/Process.h>
 
 namespace Kernel {
 
+static int program_performance_counter(int type, FlatPtr sample_period)
+{
+    if (!PerformanceCounters::is_supported(type))
+        return -ENOTSUP;
+    if (sample_period >= 0x80000000)
+        return -EINVAL;
+    if (sample_period && !PerformanceCounters::can_sample())
+        return -ENOTSUP;
+
+    auto& counter = Thread::current()->performance_counter();
+    InterruptDisabler disabler;
+    if (counter.is_enabled())
+        PerformanceCounters::save(counter);
+    counter.event_type = type;
+    counter.count = 0;
+    counter.sample_period = sample_period;
+    counter.events_until_sample = sample_period;
+    PerformanceCounters::load(counter);
+    return 0;
+}
+
 int Process::sys$perf_event(int type, FlatPtr arg1, FlatPtr arg2)
 {
+    if (PerformanceCounters::is_hardware_event(type))
+        return program_performance_counter(type, arg1);
+
+    if (type == PERF_EVENT_READ_COUNTER || type == PERF_EVENT_DISABLE_COUNTER) {
+        auto& counter = Thread::current()->performance_counter();
+        if (!counter.is_enabled())
+            return -ENOENT;
+        u64 count;
+        {
+            InterruptDisabler disabler;
+            PerformanceCounters::save(counter);
+            count = counter.count;
+            if (type == PERF_EVENT_READ_COUNTER)
+                PerformanceCounters::load(counter);
+            else
+                counter = {};
+        }
+        if (type == PERF_EVENT_READ_COUNTER) {
+            u64* user_count = (u64*)arg1;
+            if (!validate_write_typed(user_count))
+                return -EFAULT;
+            copy_to_user(user_count, &count);
+        }
+        return 0;
+    }
+
     if (!m_perf_event_buffer)
         m_perf_event_buffer = make<PerformanceEventBuffer>();
     return m_perf_event_buffer->append(type, arg1, arg2);
@@ -32,6 +32,13 @@ namespace Kernel {
 int Process::sys$profiling_enable(pid_t pid)
 {
     REQUIRE_NO_PROMISES;
+    if (pid == -1) {
+        // Sample every process on the system.
+        if (!is_superuser())
+            return -EPERM;
+        Profiling::start(nullptr);
+        return 0;
+    }
     ScopedSpinLock lock(g_processes_lock);
     auto process = Process::from_pid(pid);
     if (!process)
@@ -40,13 +47,19 @@ int Process::sys$profiling_enable(pid_t pid)
         return -ESRCH;
     if (!is_superuser() && process->uid() != m_uid)
         return -EPERM;
-    Profiling::start(*process);
+    Profiling::start(process.ptr());
     process->set_profiling(true);
     return 0;
 }
 
 int Process::sys$profiling_disable(pid_t pid)
 {
+    if (pid == -1) {
+        if (!is_superuser())
+            return -EPERM;
+        Profiling::stop();
+        return 0;
+    }
     ScopedSpinLock lock(g_processes_lock);
     auto process = Process::from_pid(pid);
     if (!process)
@@ -89,9 +89,9 @@ KResult Process::poke_user_data(Userspace<u32*> address, u32 data)
     Range range = { VirtualAddress(address), sizeof(u32) };
     auto* region = find_region_containing(range);
     ASSERT(region != nullptr);
-    if (region->is_shared()) {
-        // If the region is shared, we change its vmobject to a PrivateInodeVMObject
-        // to prevent the write operation from changing any shared inode data
+    if (region->is_shared() || region->vmobject().is_shared_inode()) {
+        // If the region is shared (or a read-only private mapping of a file), we change its vmobject
+        // to a PrivateInodeVMObject to prevent the write operation from changing any shared inode data
         ASSERT(region->vmobject().is_shared_inode());
         region->set_vmobject(PrivateInodeVMObject::create_with_inode(static_cast<SharedInodeVMObject&>(region->vmobject()).inode()));
         region->set_shared(false);
@@ -62,4 +62,72 @@ ssize_t Process::sys$read(int fd, Userspace<u8*> buffer, ssize_t size)
     return result.value();
 }
 
+ssize_t Process::do_read(FileDescription& description, Vector<iovec, 32>& vecs, size_t total_length, Optional<off_t> offset)
+{
+    if (description.is_directory())
+        return -EISDIR;
+    if (description.is_blocking()) {
+        if (!description.can_read()) {
+            if (Thread::current()->block<Thread::ReadBlocker>(nullptr, description).was_interrupted())
+                return -EINTR;
+            if (!description.can_read())
+                return -EAGAIN;
+        }
+    }
+    auto result = offset.has_value()
+        ? description.preadv(vecs.data(), vecs.size(), total_length, offset.value())
+        : description.readv(vecs.data(), vecs.size(), total_length);
+    if (result.is_error())
+        return result.error();
+    return result.value();
+}
+
+ssize_t Process::sys$readv(int fd, const struct iovec* iov, int iov_count)
+{
+    REQUIRE_PROMISE(stdio);
+    Vector<iovec, 32> vecs;
+    ssize_t total_length = copy_iovecs_from_user(vecs, iov, iov_count, true);
+    if (total_length < 0)
+        return total_length;
+
+    auto description = file_description(fd);
+    if (!description)
+        return -EBADF;
+    if (!description->is_readable())
+        return -EBADF;
+
+    if (total_length == 0)
+        return 0;
+
+    return do_read(*description, vecs, total_length);
+}
+
+ssize_t Process::sys$preadv(const Syscall::SC_preadv_params* user_params)
+{
+    REQUIRE_PROMISE(stdio);
+    Syscall::SC_preadv_params params;
+    if (!validate_read_and_copy_typed(&params, user_params))
+        return -EFAULT;
+    if (params.offset < 0)
+        return -EINVAL;
+
+    Vector<iovec, 32> vecs;
+    ssize_t total_length = copy_iovecs_from_user(vecs, params.iov, params.iov_count, true);
+    if (total_length < 0)
+        return total_length;
+
+    auto description = file_description(params.fd);
+    if (!description)
+        return -EBADF;
+    if (!description->is_readable())
+        return -EBADF;
+    if (!description->file().is_seekable())
+        return -ESPIPE;
+
+    if (total_length == 0)
+        return 0;
+
+    return do_read(*description, vecs, total_length, params.offset);
+}
+
 }
@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <AK/NumericLimits.h>
+#include <Kernel/FileSystem/FileDescription.h>
+#include <Kernel/KBuffer.h>
+#include <Kernel/Process.h>
+
+namespace Kernel {
+
+static constexpr size_t sendfile_chunk_size = 64 * KB;
+
+ssize_t Process::sys$sendfile(const Syscall::SC_sendfile_params* user_params)
+{
+    REQUIRE_PROMISE(stdio);
+    Syscall::SC_sendfile_params params;
+    if (!validate_read_and_copy_typed(&params, user_params))
+        return -EFAULT;
+    if (params.count > (size_t)NumericLimits<i32>::max())
+        return -EINVAL;
+
+    auto in_description = file_description(params.in_fd);
+    if (!in_description)
+        return -EBADF;
+    if (!in_description->is_readable())
+        return -EBADF;
+    auto out_description = file_description(params.out_fd);
+    if (!out_description)
+        return -EBADF;
+    if (!out_description->is_writable())
+        return -EBADF;
+
+    // We read at an explicit offset so bytes that don't make it out can simply be read again,
+    // which is only possible for seekable sources.
+    if (!in_description->file().is_seekable())
+        return -EINVAL;
+
+    off_t start_offset = in_description->offset();
+    if (params.offset) {
+        if (!validate_read_and_copy_typed(&start_offset, params.offset))
+            return -EFAULT;
+        if (start_offset < 0)
+            return -EINVAL;
+    }
+
+    if (params.count == 0)
+        return 0;
+
+    auto buffer = KBuffer::create_with_size(min(params.count, sendfile_chunk_size), Region::Access::Read | Region::Access::Write, "sendfile");
+    size_t total_sent = 0;
+    ssize_t error = 0;
+    while (total_sent < params.count) {
+        size_t chunk_size = min(params.count - total_sent, buffer.size());
+        Vector<iovec, 32> read_vecs;
+        read_vecs.append({ buffer.data(), chunk_size });
+        ssize_t nread = do_read(*in_description, read_vecs, chunk_size, start_offset + total_sent);
+        if (nread <= 0) {
+            error = nread;
+            break;
+        }
+
+        Vector<iovec, 32> write_vecs;
+        write_vecs.append({ buffer.data(), (size_t)nread });
+        ssize_t nwritten = do_write(*out_description, write_vecs, nread);
+        if (nwritten <= 0) {
+            error = nwritten;
+            break;
+        }
+        total_sent += nwritten;
+        if (nwritten < nread)
+            break;
+    }
+
+    if (params.offset) {
+        off_t end_offset = start_offset + total_sent;
+        if (!validate_write_typed(params.offset))
+            return -EFAULT;
+        copy_to_user(params.offset, &end_offset);
+    } else {
+        in_description->seek(start_offset + total_sent, SEEK_SET);
+    }
+
+    if (total_sent == 0 && error < 0)
+        return error;
+    return total_sent;
+}
+
+}
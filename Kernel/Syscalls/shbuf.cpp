@@ -142,6 +142,29 @@ void* Process::sys$shbuf_get(int shbuf_id, Userspace<size_t*> user_size)
     return shared_buffer.ref_for_process_and_get_address(*this);
 }
 
+void* Process::sys$shbuf_reclaim(int shbuf_id, Userspace<size_t*> user_size)
+{
+    REQUIRE_PROMISE(shared_buffer);
+    if (!validate_write_typed(user_size))
+        return (void*)-EFAULT;
+    LOCKER(shared_buffers().lock());
+    auto it = shared_buffers().resource().find(shbuf_id);
+    if (it == shared_buffers().resource().end())
+        return (void*)-EINVAL;
+    auto& shared_buffer = *(*it).value;
+    if (!shared_buffer.is_shared_with(m_pid))
+        return (void*)-EPERM;
+    auto* address = shared_buffer.reclaim_for_process(*this);
+    if (!address)
+        return (void*)-EBUSY;
+#ifdef SHARED_BUFFER_DEBUG
+    klog() << "Reclaimed shared buffer " << shbuf_id;
+#endif
+    size_t size = shared_buffer.size();
+    copy_to_user(user_size, &size);
+    return address;
+}
+
 int Process::sys$shbuf_seal(int shbuf_id)
 {
     REQUIRE_PROMISE(shared_buffer);
@@ -34,8 +34,7 @@ int Process::sys$usleep(useconds_t usec)
     REQUIRE_PROMISE(stdio);
     if (!usec)
         return 0;
-    u64 wakeup_time = Thread::current()->sleep(usec * TimeManagement::the().ticks_per_second() / 1000000);
-    if (wakeup_time > g_uptime)
+    if (Thread::current()->sleep_for((u64)usec * 1000))
         return -EINTR;
     return 0;
 }
@@ -45,12 +44,8 @@ int Process::sys$sleep(unsigned seconds)
     REQUIRE_PROMISE(stdio);
     if (!seconds)
         return 0;
-    u64 wakeup_time = Thread::current()->sleep(seconds * TimeManagement::the().ticks_per_second());
-    if (wakeup_time > g_uptime) {
-        u32 ticks_left_until_original_wakeup_time = wakeup_time - g_uptime;
-        return ticks_left_until_original_wakeup_time / TimeManagement::the().ticks_per_second();
-    }
-    return 0;
+    u64 nanoseconds_left = Thread::current()->sleep_for((u64)seconds * 1'000'000'000);
+    return nanoseconds_left / 1'000'000'000;
 }
 
 }
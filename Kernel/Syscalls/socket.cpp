@@ -212,6 +212,7 @@ ssize_t Process::sys$sendto(const Syscall::SC_sendto_params* user_params)
     if (socket.is_shut_down_for_writing())
         return -EPIPE;
     SmapDisabler disabler;
+    description->did_transfer();
     auto result = socket.sendto(*description, params.data.data, params.data.size, flags, addr, addr_length);
     if (result.is_error())
         return result.error();
@@ -255,6 +256,7 @@ ssize_t Process::sys$recvfrom(const Syscall::SC_recvfrom_params* user_params)
     if (flags & MSG_DONTWAIT)
         description->set_blocking(false);
 
+    description->did_transfer();
     auto result = socket.recvfrom(*description, params.buffer.data, params.buffer.size, flags, addr, addr_length);
     if (flags & MSG_DONTWAIT)
         description->set_blocking(original_blocking);
@@ -24,6 +24,7 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <Kernel/FileSystem/FileDescription.h>
 #include <Kernel/FileSystem/VirtualFileSystem.h>
 #include <Kernel/Process.h>
 
@@ -36,4 +37,27 @@ int Process::sys$sync()
     return 0;
 }
 
+static int fsync_impl(Process& process, int fd, bool data_only)
+{
+    auto description = process.file_description(fd);
+    if (!description)
+        return -EBADF;
+    auto* inode = description->inode();
+    if (!inode)
+        return -EINVAL;
+    return inode->fsync(data_only);
+}
+
+int Process::sys$fsync(int fd)
+{
+    REQUIRE_PROMISE(stdio);
+    return fsync_impl(*this, fd, false);
+}
+
+int Process::sys$fdatasync(int fd)
+{
+    REQUIRE_PROMISE(stdio);
+    return fsync_impl(*this, fd, true);
+}
+
 }
@@ -30,9 +30,8 @@
 
 namespace Kernel {
 
-ssize_t Process::sys$writev(int fd, const struct iovec* iov, int iov_count)
+ssize_t Process::copy_iovecs_from_user(Vector<iovec, 32>& vecs, const iovec* iov, int iov_count, bool buffers_will_be_written)
 {
-    REQUIRE_PROMISE(stdio);
     if (iov_count < 0)
         return -EINVAL;
 
@@ -40,16 +39,40 @@ ssize_t Process::sys$writev(int fd, const struct iovec* iov, int iov_count)
         return -EFAULT;
 
     u64 total_length = 0;
-    Vector<iovec, 32> vecs;
     vecs.resize(iov_count);
     copy_from_user(vecs.data(), iov, iov_count * sizeof(iovec));
     for (auto& vec : vecs) {
-        if (!validate_read(vec.iov_base, vec.iov_len))
+        if (buffers_will_be_written ? !validate_write(vec.iov_base, vec.iov_len) : !validate_read(vec.iov_base, vec.iov_len))
             return -EFAULT;
         total_length += vec.iov_len;
         if (total_length > NumericLimits<i32>::max())
             return -EINVAL;
     }
+    return total_length;
+}
+
+// Drops the first `count` bytes from the front of an iovec array, e.g after a short write.
+static void advance_iovecs(Vector<iovec, 32>& vecs, size_t& first_vec, size_t count)
+{
+    while (count && first_vec < vecs.size()) {
+        auto& vec = vecs[first_vec];
+        if (count < vec.iov_len) {
+            vec.iov_base = (u8*)vec.iov_base + count;
+            vec.iov_len -= count;
+            return;
+        }
+        count -= vec.iov_len;
+        ++first_vec;
+    }
+}
+
+ssize_t Process::sys$writev(int fd, const struct iovec* iov, int iov_count)
+{
+    REQUIRE_PROMISE(stdio);
+    Vector<iovec, 32> vecs;
+    ssize_t total_length = copy_iovecs_from_user(vecs, iov, iov_count, false);
+    if (total_length < 0)
+        return total_length;
 
     auto description = file_description(fd);
     if (!description)
@@ -58,32 +81,53 @@ ssize_t Process::sys$writev(int fd, const struct iovec* iov, int iov_count)
     if (!description->is_writable())
         return -EBADF;
 
-    int nwritten = 0;
-    for (auto& vec : vecs) {
-        int rc = do_write(*description, (const u8*)vec.iov_base, vec.iov_len);
-        if (rc < 0) {
-            if (nwritten == 0)
-                return rc;
-            return nwritten;
-        }
-        nwritten += rc;
-    }
+    if (total_length == 0)
+        return 0;
 
-    return nwritten;
+    return do_write(*description, vecs, total_length);
 }
 
-ssize_t Process::do_write(FileDescription& description, const u8* data, int data_size)
+ssize_t Process::sys$pwritev(const Syscall::SC_pwritev_params* user_params)
 {
-    ssize_t total_nwritten = 0;
+    REQUIRE_PROMISE(stdio);
+    Syscall::SC_pwritev_params params;
+    if (!validate_read_and_copy_typed(&params, user_params))
+        return -EFAULT;
+    if (params.offset < 0)
+        return -EINVAL;
+
+    Vector<iovec, 32> vecs;
+    ssize_t total_length = copy_iovecs_from_user(vecs, params.iov, params.iov_count, false);
+    if (total_length < 0)
+        return total_length;
+
+    auto description = file_description(params.fd);
+    if (!description)
+        return -EBADF;
+    if (!description->is_writable())
+        return -EBADF;
+    if (!description->file().is_seekable())
+        return -ESPIPE;
+
+    if (total_length == 0)
+        return 0;
+
+    return do_write(*description, vecs, total_length, params.offset);
+}
+
+ssize_t Process::do_write(FileDescription& description, Vector<iovec, 32>& vecs, size_t total_length, Optional<off_t> offset)
+{
+    size_t total_nwritten = 0;
     if (!description.is_blocking()) {
         if (!description.can_write())
             return -EAGAIN;
     }
 
-    if (description.should_append())
+    if (!offset.has_value() && description.should_append())
         description.seek(0, SEEK_END);
 
-    while (total_nwritten < data_size) {
+    size_t first_vec = 0;
+    while (total_nwritten < total_length) {
         if (!description.can_write()) {
             if (!description.is_blocking()) {
                 // Short write: We can no longer write to this non-blocking description.
@@ -95,7 +139,12 @@ ssize_t Process::do_write(FileDescription& description, const u8* data, int data
                     return -EINTR;
             }
         }
-        auto nwritten_or_error = description.write(data + total_nwritten, data_size - total_nwritten);
+        const iovec* remaining_vecs = vecs.data() + first_vec;
+        int remaining_vec_count = vecs.size() - first_vec;
+        size_t remaining_length = total_length - total_nwritten;
+        auto nwritten_or_error = offset.has_value()
+            ? description.pwritev(remaining_vecs, remaining_vec_count, remaining_length, offset.value() + total_nwritten)
+            : description.writev(remaining_vecs, remaining_vec_count, remaining_length);
         if (nwritten_or_error.is_error()) {
             if (total_nwritten)
                 return total_nwritten;
@@ -104,6 +153,7 @@ ssize_t Process::do_write(FileDescription& description, const u8* data, int data
         if (nwritten_or_error.value() == 0)
             break;
         total_nwritten += nwritten_or_error.value();
+        advance_iovecs(vecs, first_vec, nwritten_or_error.value());
     }
     return total_nwritten;
 }
@@ -126,7 +176,9 @@ ssize_t Process::sys$write(int fd, const u8* data, ssize_t size)
     if (!description->is_writable())
         return -EBADF;
 
-    return do_write(*description, data, size);
+    Vector<iovec, 32> vecs;
+    vecs.append({ const_cast<u8*>(data), (size_t)size });
+    return do_write(*description, vecs, size);
 }
 
 }
@@ -244,8 +244,7 @@ void VirtualConsole::on_key_pressed(KeyboardDevice::Event event)
 ssize_t VirtualConsole::on_tty_write(const u8* data, ssize_t size)
 {
     ScopedSpinLock lock(s_lock);
-    for (ssize_t i = 0; i < size; ++i)
-        m_terminal.on_input(data[i]);
+    m_terminal.on_input({ data, (size_t)size });
     if (m_active)
         flush_dirty_lines();
     return size;
@@ -286,9 +285,11 @@ void VirtualConsole::flush_dirty_lines()
         auto& line = m_terminal.visible_line(visual_row);
         if (!line.is_dirty() && !m_terminal.m_need_full_flush)
             continue;
-        for (size_t column = 0; column < line.length(); ++column) {
+        size_t start_column = m_terminal.m_need_full_flush ? 0 : line.dirty_start_column();
+        size_t end_column = m_terminal.m_need_full_flush ? line.length() : line.dirty_end_column();
+        for (size_t column = start_column; column < end_column; ++column) {
             u32 code_point = line.code_point(column);
-            auto attribute = line.attributes()[column];
+            auto& attribute = line.attribute_at(column);
             u16 vga_index = (visual_row * 160) + (column * 2);
             m_current_vga_window[vga_index] = code_point < 128 ? code_point : '?';
             m_current_vga_window[vga_index + 1] = attribute_to_vga(attribute);
@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <Kernel/Devices/BlockDevice.h>
+#include <Kernel/Process.h>
+#include <Kernel/Tasks/BlockIOTask.h>
+#include <Kernel/WaitQueue.h>
+
+namespace Kernel {
+
+static WaitQueue* s_block_io_wait_queue;
+
+void BlockIOTask::spawn()
+{
+    s_block_io_wait_queue = new WaitQueue;
+    Thread* block_io_thread = nullptr;
+    Process::create_kernel_process(block_io_thread, "BlockIOTask", [] {
+        dbg() << "BlockIOTask is running";
+        for (;;) {
+            Thread::current()->wait_on(*s_block_io_wait_queue, "BlockIOTask");
+            BlockDevice::dispatch_all_pending_requests();
+        }
+    });
+}
+
+void BlockIOTask::wake()
+{
+    if (s_block_io_wait_queue)
+        s_block_io_wait_queue->wake_one();
+}
+
+bool BlockIOTask::is_running()
+{
+    return s_block_io_wait_queue;
+}
+
+}
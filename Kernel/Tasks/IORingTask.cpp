@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <AK/NonnullOwnPtrVector.h>
+#include <Kernel/FileSystem/FileDescription.h>
+#include <Kernel/Process.h>
+#include <Kernel/SpinLock.h>
+#include <Kernel/Tasks/IORingTask.h>
+#include <Kernel/Thread.h>
+
+namespace Kernel {
+
+static SpinLock<u8> s_lock;
+static NonnullOwnPtrVector<IORing::Request>* s_requests;
+
+static IORing::Request* find_runnable_request()
+{
+    ASSERT(s_lock.is_locked());
+    for (auto& request : *s_requests) {
+        if (request.in_progress || request.waits_for_earlier_request)
+            continue;
+        if (request.process->is_dead() || request.ring->is_ready(request))
+            return &request;
+    }
+    return nullptr;
+}
+
+static void finish_request(IORing::Request& finished_request)
+{
+    OwnPtr<IORing::Request> request;
+    {
+        ScopedSpinLock lock(s_lock);
+        size_t index = 0;
+        for (; index < s_requests->size(); ++index) {
+            if (&s_requests->at(index) == &finished_request)
+                break;
+        }
+        ASSERT(index < s_requests->size());
+        request = s_requests->take(index);
+        for (size_t i = index; i < s_requests->size(); ++i) {
+            auto& next_request = s_requests->at(i);
+            if (next_request.description == request->description) {
+                next_request.waits_for_earlier_request = false;
+                break;
+            }
+        }
+    }
+    // Dropping the last reference to a ring or description can take locks, so do it outside ours.
+    request = nullptr;
+}
+
+static void worker_main()
+{
+    // Operations like writing to a pipe without a reader want to deliver a signal to the current
+    // thread, which isn't something a kernel thread can take.
+    Thread::current()->set_signal_mask(0xffffffff);
+    for (;;) {
+        IORing::Request* request = nullptr;
+        auto result = Thread::current()->block_until("IORingTask", [] {
+            ScopedSpinLock lock(s_lock);
+            return find_runnable_request() != nullptr;
+        });
+        if (result.was_interrupted())
+            continue;
+        {
+            ScopedSpinLock lock(s_lock);
+            request = find_runnable_request();
+            if (!request)
+                continue;
+            request->in_progress = true;
+        }
+        // Nobody will ever look at the completion, but the request still has to leave the queue.
+        if (!request->process->is_dead())
+            request->ring->execute(*request);
+        finish_request(*request);
+    }
+}
+
+void IORingTask::spawn()
+{
+    s_requests = new NonnullOwnPtrVector<IORing::Request>;
+    Thread* first_thread = nullptr;
+    auto process = Process::create_kernel_process(first_thread, "IORingTask", worker_main);
+    for (unsigned i = 1; i < worker_count; ++i)
+        process->create_kernel_thread(worker_main, THREAD_PRIORITY_NORMAL, "IORingTask", THREAD_AFFINITY_DEFAULT, false);
+}
+
+void IORingTask::enqueue(NonnullOwnPtr<IORing::Request>&& request)
+{
+    ScopedSpinLock lock(s_lock);
+    for (auto& queued_request : *s_requests) {
+        if (queued_request.description == request->description) {
+            request->waits_for_earlier_request = true;
+            break;
+        }
+    }
+    s_requests->append(move(request));
+}
+
+}
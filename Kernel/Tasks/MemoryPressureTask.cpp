@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <Kernel/Process.h>
+#include <Kernel/Tasks/MemoryPressureTask.h>
+#include <Kernel/VM/MemoryManager.h>
+#include <Kernel/WaitQueue.h>
+
+namespace Kernel {
+
+static WaitQueue* s_memory_pressure_wait_queue;
+
+void MemoryPressureTask::spawn()
+{
+    s_memory_pressure_wait_queue = new WaitQueue;
+    Thread* memory_pressure_thread = nullptr;
+    Process::create_kernel_process(memory_pressure_thread, "MemoryPressureTask", [] {
+        dbg() << "MemoryPressureTask is running";
+        for (;;) {
+            timeval timeout { 0, interval_milliseconds * 1000 };
+            Thread::current()->wait_on(*s_memory_pressure_wait_queue, "MemoryPressureTask", &timeout);
+            if (MM.memory_pressure() == MemoryManager::MemoryPressure::None)
+                continue;
+            auto purged_page_count = MM.reclaim_volatile_pages();
+            if (purged_page_count)
+                klog() << "MemoryPressureTask: Purged " << purged_page_count << " volatile pages, memory pressure is now " << MemoryManager::to_string(MM.memory_pressure());
+            // Clean file pages can be read back in, but that costs I/O, so they go after volatile memory.
+            if (MM.memory_pressure() == MemoryManager::MemoryPressure::None)
+                continue;
+            auto reclaimed_page_count = MM.reclaim_clean_inode_pages();
+            if (reclaimed_page_count)
+                klog() << "MemoryPressureTask: Reclaimed " << reclaimed_page_count << " clean file pages, memory pressure is now " << MemoryManager::to_string(MM.memory_pressure());
+        }
+    });
+    // Reclaiming has to keep up with whoever is allocating.
+    memory_pressure_thread->set_priority(THREAD_PRIORITY_HIGH);
+}
+
+void MemoryPressureTask::wake()
+{
+    if (s_memory_pressure_wait_queue)
+        s_memory_pressure_wait_queue->wake_one();
+}
+
+}
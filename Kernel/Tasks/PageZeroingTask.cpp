@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <Kernel/Process.h>
+#include <Kernel/Tasks/PageZeroingTask.h>
+#include <Kernel/VM/MemoryManager.h>
+#include <Kernel/WaitQueue.h>
+
+namespace Kernel {
+
+static WaitQueue* s_page_zeroing_wait_queue;
+
+void PageZeroingTask::spawn()
+{
+    s_page_zeroing_wait_queue = new WaitQueue;
+    Thread* page_zeroing_thread = nullptr;
+    Process::create_kernel_process(page_zeroing_thread, "PageZeroingTask", [] {
+        dbg() << "PageZeroingTask is running";
+        for (;;) {
+            MM.refill_zeroed_user_physical_pages();
+            timeval timeout { 0, interval_milliseconds * 1000 };
+            Thread::current()->wait_on(*s_page_zeroing_wait_queue, "PageZeroingTask", &timeout);
+        }
+    });
+    // Zeroing pages ahead of time is only worth doing when there's nothing better to run.
+    page_zeroing_thread->set_priority(THREAD_PRIORITY_LOW);
+}
+
+void PageZeroingTask::wake()
+{
+    if (s_page_zeroing_wait_queue)
+        s_page_zeroing_wait_queue->wake_one();
+}
+
+}
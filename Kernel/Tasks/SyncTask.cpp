@@ -24,6 +24,7 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <Kernel/CommandLine.h>
 #include <Kernel/FileSystem/VirtualFileSystem.h>
 #include <Kernel/Process.h>
 #include <Kernel/Tasks/SyncTask.h>
@@ -31,14 +32,29 @@
 
 namespace Kernel {
 
+static unsigned s_sync_interval_seconds;
+
+static unsigned sync_interval_seconds_from_command_line()
+{
+    // A longer interval means fewer metadata writes, but more of it is lost on a crash.
+    if (auto interval = kernel_command_line().lookup("sync_interval"); interval.has_value()) {
+        if (auto seconds = interval.value().to_uint(); seconds.has_value() && seconds.value() > 0)
+            return seconds.value();
+    }
+    return 1;
+}
+
 void SyncTask::spawn()
 {
     Thread* syncd_thread = nullptr;
+    s_sync_interval_seconds = sync_interval_seconds_from_command_line();
     Process::create_kernel_process(syncd_thread, "SyncTask", [] {
-        dbg() << "SyncTask is running";
+        dbg() << "SyncTask is running, syncing every " << s_sync_interval_seconds << "s";
         for (;;) {
+            // NOTE: Dirty data blocks are written back by WriteBackTask as they age,
+            //       so this only needs to push out metadata (and whatever is left) periodically.
             VFS::the().sync();
-            Thread::current()->sleep(1 * TimeManagement::the().ticks_per_second());
+            Thread::current()->sleep_for((u64)s_sync_interval_seconds * 1'000'000'000);
         }
     });
 }
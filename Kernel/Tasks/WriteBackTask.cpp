@@ -0,0 +1,56 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <Kernel/FileSystem/FileSystem.h>
+#include <Kernel/Process.h>
+#include <Kernel/Tasks/WriteBackTask.h>
+#include <Kernel/WaitQueue.h>
+
+namespace Kernel {
+
+static WaitQueue* s_write_back_wait_queue;
+
+void WriteBackTask::spawn()
+{
+    s_write_back_wait_queue = new WaitQueue;
+    Thread* write_back_thread = nullptr;
+    Process::create_kernel_process(write_back_thread, "WriteBackTask", [] {
+        dbg() << "WriteBackTask is running";
+        for (;;) {
+            timeval timeout { 0, interval_milliseconds * 1000 };
+            Thread::current()->wait_on(*s_write_back_wait_queue, "WriteBackTask", &timeout);
+            FS::write_back();
+        }
+    });
+}
+
+void WriteBackTask::wake()
+{
+    if (s_write_back_wait_queue)
+        s_write_back_wait_queue->wake_one();
+}
+
+}
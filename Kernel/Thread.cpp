@@ -124,6 +124,15 @@ void Thread::unblock()
     set_state(Thread::Runnable);
 }
 
+bool Thread::unblock_if_ready()
+{
+    ScopedSpinLock lock(m_lock);
+    if (!is_blocked() || !m_blocker->should_unblock(*this))
+        return false;
+    unblock();
+    return true;
+}
+
 void Thread::set_should_die()
 {
     if (m_should_die) {
@@ -193,24 +202,28 @@ void Thread::relock_process(bool did_unlock)
         process().big_lock().lock();
 }
 
-u64 Thread::sleep(u64 ticks)
+u64 Thread::sleep_for(u64 nanoseconds)
 {
-    ASSERT(state() == Thread::Running);
-    u64 wakeup_time = g_uptime + ticks;
-    auto ret = Thread::current()->block<Thread::SleepBlocker>(nullptr, wakeup_time);
-    if (wakeup_time > g_uptime) {
-        ASSERT(ret.was_interrupted());
-    }
-    return wakeup_time;
+    return sleep_until(TimeManagement::the().nanoseconds_since_boot() + nanoseconds);
 }
 
 u64 Thread::sleep_until(u64 wakeup_time)
 {
     ASSERT(state() == Thread::Running);
+    // Rather than waiting for the scheduler to notice on its next tick, have the
+    // timer queue wake us up right on time.
+    auto timer_id = TimerQueue::add_timer_at(wakeup_time, [this] {
+        unblock_if_ready();
+    });
     auto ret = Thread::current()->block<Thread::SleepBlocker>(nullptr, wakeup_time);
-    if (wakeup_time > g_uptime)
+    TimerQueue::cancel_timer(timer_id);
+
+    auto now = TimeManagement::the().nanoseconds_since_boot();
+    if (wakeup_time > now) {
         ASSERT(ret.was_interrupted());
-    return wakeup_time;
+        return wakeup_time - now;
+    }
+    return 0;
 }
 
 const char* Thread::state_string() const
@@ -685,6 +698,8 @@ void Thread::set_state(State new_state)
     if (new_state == Blocked) {
         // we should always have a Blocker while blocked
         ASSERT(m_blocker != nullptr);
+        // unblock() drops the blocker before leaving this state, so remember what it was.
+        m_blocked_on = m_blocker->type();
     }
 
     if (new_state == Stopped) {
@@ -692,6 +707,11 @@ void Thread::set_state(State new_state)
     }
 
     auto previous_state = m_state;
+    auto now = read_tsc();
+    // NOTE: The TSCs of different processors may be slightly apart, so don't let time go backwards.
+    if (now > m_state_changed_at && m_state_changed_at)
+        account_state_time(m_scheduler_statistics, previous_state, now - m_state_changed_at);
+    m_state_changed_at = now;
     m_state = new_state;
 #ifdef THREAD_DEBUG
     dbg() << "Set Thread " << *this << " state to " << state_string();
@@ -712,6 +732,63 @@ void Thread::set_state(State new_state)
     }
 }
 
+void Thread::account_state_time(SchedulerStatistics& statistics, State state, u64 cycles) const
+{
+    ASSERT(g_scheduler_lock.own_lock());
+    switch (state) {
+    case Runnable:
+        statistics.runnable_cycles += cycles;
+        break;
+    case Blocked:
+        statistics.blocked_cycles[(size_t)m_blocked_on] += cycles;
+        break;
+    case Queued:
+        statistics.queued_cycles += cycles;
+        break;
+    default:
+        break;
+    }
+}
+
+Thread::SchedulerStatistics Thread::scheduler_statistics() const
+{
+    ScopedSpinLock lock(g_scheduler_lock);
+    auto statistics = m_scheduler_statistics;
+    auto now = read_tsc();
+    if (now > m_state_changed_at && m_state_changed_at)
+        account_state_time(statistics, m_state, now - m_state_changed_at);
+    return statistics;
+}
+
+const char* Thread::Blocker::type_name(Type type)
+{
+    switch (type) {
+    case Type::Join:
+        return "join";
+    case Type::Accept:
+        return "accept";
+    case Type::Connect:
+        return "connect";
+    case Type::Write:
+        return "write";
+    case Type::Read:
+        return "read";
+    case Type::Condition:
+        return "condition";
+    case Type::Sleep:
+        return "sleep";
+    case Type::Select:
+        return "select";
+    case Type::Wait:
+        return "wait";
+    case Type::Signal:
+        return "signal";
+    case Type::__Count:
+        break;
+    }
+    ASSERT_NOT_REACHED();
+}
+
 void Thread::update_state_for_thread(Thread::State previous_state)
 {
     ASSERT_INTERRUPTS_DISABLED();
@@ -720,6 +797,11 @@ void Thread::update_state_for_thread(Thread::State previous_state)
     auto& previous_list = g_scheduler_data->thread_list_for_state(previous_state);
     auto& list = g_scheduler_data->thread_list_for_state(state());
 
+    if (previous_state == Runnable)
+        Scheduler::dequeue_runnable_thread(*this);
+    else if (state() == Runnable)
+        Scheduler::enqueue_runnable_thread(*this);
+
     if (&previous_list != &list) {
         previous_list.remove(*this);
     }
@@ -810,18 +892,25 @@ String Thread::backtrace_impl()
 
 Vector<FlatPtr> Thread::raw_backtrace(FlatPtr ebp, FlatPtr eip) const
 {
+    FlatPtr frames[Profiling::max_stack_frame_count];
+    size_t frame_count = raw_backtrace(ebp, eip, frames, Profiling::max_stack_frame_count);
+    Vector<FlatPtr> backtrace;
+    backtrace.append(frames, frame_count);
+    return backtrace;
+}
+
+size_t Thread::raw_backtrace(FlatPtr ebp, FlatPtr eip, FlatPtr* frames, size_t max_frame_count) const
+{
+    if (!max_frame_count)
+        return 0;
     InterruptDisabler disabler;
     auto& process = const_cast<Process&>(this->process());
     ProcessPagingScope paging_scope(process);
-    Vector<FlatPtr, Profiling::max_stack_frame_count> backtrace;
-    backtrace.append(eip);
-    for (FlatPtr* stack_ptr = (FlatPtr*)ebp; process.validate_read_from_kernel(VirtualAddress(stack_ptr), sizeof(FlatPtr) * 2) && MM.can_read_without_faulting(process, VirtualAddress(stack_ptr), sizeof(FlatPtr) * 2); stack_ptr = (FlatPtr*)*stack_ptr) {
-        FlatPtr retaddr = stack_ptr[1];
-        backtrace.append(retaddr);
-        if (backtrace.size() == Profiling::max_stack_frame_count)
-            break;
-    }
-    return backtrace;
+    size_t frame_count = 0;
+    frames[frame_count++] = eip;
+    for (FlatPtr* stack_ptr = (FlatPtr*)ebp; frame_count < max_frame_count && process.validate_read_from_kernel(VirtualAddress(stack_ptr), sizeof(FlatPtr) * 2) && MM.can_read_without_faulting(process, VirtualAddress(stack_ptr), sizeof(FlatPtr) * 2); stack_ptr = (FlatPtr*)*stack_ptr)
+        frames[frame_count++] = stack_ptr[1];
+    return frame_count;
 }
 
 void Thread::make_thread_specific_region(Badge<Process>)
@@ -876,7 +965,7 @@ Thread::BlockResult Thread::wait_on(WaitQueue& queue, const char* reason, timeva
             m_wait_reason = reason;
 
             if (timeout) {
-                timer_id = TimerQueue::the().add_timer(*timeout, [&]() {
+                timer_id = TimerQueue::add_timer(*timeout, [&]() {
                     wake_from_queue();
                 });
             }
@@ -926,7 +1015,7 @@ Thread::BlockResult Thread::wait_on(WaitQueue& queue, const char* reason, timeva
 
         // Make sure we cancel the timer if woke normally.
         if (timeout && !result.was_interrupted())
-            TimerQueue::the().cancel_timer(timer_id);
+            TimerQueue::cancel_timer(timer_id);
     }
 
     // The API contract guarantees we return with interrupts enabled,
@@ -34,7 +34,9 @@
 #include <AK/Vector.h>
 #include <Kernel/Arch/i386/CPU.h>
 #include <Kernel/Forward.h>
+#include <Kernel/Heap/SlabAllocator.h>
 #include <Kernel/KResult.h>
+#include <Kernel/PerformanceCounters.h>
 #include <Kernel/Scheduler.h>
 #include <Kernel/ThreadTracer.h>
 #include <Kernel/UnixTypes.h>
@@ -69,6 +71,7 @@ struct ThreadSpecificData {
 class Thread {
     AK_MAKE_NONCOPYABLE(Thread);
     AK_MAKE_NONMOVABLE(Thread);
+    MAKE_SLAB_CACHED(Thread, Thread)
 
     friend class Process;
     friend class Scheduler;
@@ -104,6 +107,8 @@ public:
 
     String backtrace();
     Vector<FlatPtr> raw_backtrace(FlatPtr ebp, FlatPtr eip) const;
+    // Like raw_backtrace(), but without allocating, so it can be used from an interrupt handler. Returns the number of frames stored.
+    size_t raw_backtrace(FlatPtr ebp, FlatPtr eip, FlatPtr* frames, size_t max_frame_count) const;
 
     const String& name() const { return m_name; }
     void set_name(const StringView& s) { m_name = s; }
@@ -125,7 +130,24 @@ public:
 
     class Blocker {
     public:
+        // What a thread is blocked on, for accounting the time spent blocked. See SchedulerStatistics.
+        enum class Type {
+            Join,
+            Accept,
+            Connect,
+            Write,
+            Read,
+            Condition,
+            Sleep,
+            Select,
+            Wait,
+            Signal,
+            __Count,
+        };
+        static const char* type_name(Type);
+
         virtual ~Blocker() { }
+        virtual Type type() const = 0;
         virtual bool should_unblock(Thread&) = 0;
         virtual const char* state_string() const = 0;
         virtual bool is_reason_signal() const { return false; }
@@ -144,6 +166,7 @@ public:
     class JoinBlocker final : public Blocker {
     public:
         explicit JoinBlocker(Thread& joinee, void*& joinee_exit_value);
+        virtual Type type() const override { return Type::Join; }
         virtual bool should_unblock(Thread&) override;
         virtual const char* state_string() const override { return "Joining"; }
         void set_joinee_exit_value(void* value) { m_joinee_exit_value = value; }
@@ -167,6 +190,7 @@ public:
     class AcceptBlocker final : public FileDescriptionBlocker {
     public:
         explicit AcceptBlocker(const FileDescription&);
+        virtual Type type() const override { return Type::Accept; }
         virtual bool should_unblock(Thread&) override;
         virtual const char* state_string() const override { return "Accepting"; }
     };
@@ -174,6 +198,7 @@ public:
     class ConnectBlocker final : public FileDescriptionBlocker {
     public:
         explicit ConnectBlocker(const FileDescription&);
+        virtual Type type() const override { return Type::Connect; }
         virtual bool should_unblock(Thread&) override;
         virtual const char* state_string() const override { return "Connecting"; }
     };
@@ -181,6 +206,7 @@ public:
     class WriteBlocker final : public FileDescriptionBlocker {
     public:
         explicit WriteBlocker(const FileDescription&);
+        virtual Type type() const override { return Type::Write; }
         virtual bool should_unblock(Thread&) override;
         virtual const char* state_string() const override { return "Writing"; }
         virtual timespec* override_timeout(timespec*) override;
@@ -192,6 +218,7 @@ public:
     class ReadBlocker final : public FileDescriptionBlocker {
     public:
         explicit ReadBlocker(const FileDescription&);
+        virtual Type type() const override { return Type::Read; }
         virtual bool should_unblock(Thread&) override;
         virtual const char* state_string() const override { return "Reading"; }
         virtual timespec* override_timeout(timespec*) override;
@@ -203,6 +230,7 @@ public:
     class ConditionBlocker final : public Blocker {
     public:
         ConditionBlocker(const char* state_string, Function<bool()>&& condition);
+        virtual Type type() const override { return Type::Condition; }
         virtual bool should_unblock(Thread&) override;
         virtual const char* state_string() const override { return m_state_string; }
 
@@ -213,7 +241,9 @@ public:
 
     class SleepBlocker final : public Blocker {
     public:
+        // wakeup_time is in nanoseconds since boot.
         explicit SleepBlocker(u64 wakeup_time);
+        virtual Type type() const override { return Type::Sleep; }
         virtual bool should_unblock(Thread&) override;
         virtual const char* state_string() const override { return "Sleeping"; }
 
@@ -225,6 +255,7 @@ public:
     public:
         typedef Vector<int, FD_SETSIZE> FDVector;
         SelectBlocker(const FDVector& read_fds, const FDVector& write_fds, const FDVector& except_fds);
+        virtual Type type() const override { return Type::Select; }
         virtual bool should_unblock(Thread&) override;
         virtual const char* state_string() const override { return "Selecting"; }
 
@@ -234,9 +265,21 @@ public:
         const FDVector& m_select_exceptional_fds;
     };
 
+    class EventSetBlocker final : public Blocker {
+    public:
+        explicit EventSetBlocker(EventSet&);
+        virtual Type type() const override { return Type::Select; }
+        virtual bool should_unblock(Thread&) override;
+        virtual const char* state_string() const override { return "Selecting"; }
+
+    private:
+        EventSet& m_event_set;
+    };
+
     class WaitBlocker final : public Blocker {
     public:
         WaitBlocker(int wait_options, ProcessID& waitee_pid);
+        virtual Type type() const override { return Type::Wait; }
         virtual bool should_unblock(Thread&) override;
         virtual const char* state_string() const override { return "Waiting"; }
 
@@ -252,6 +295,7 @@ public:
         };
 
         SemiPermanentBlocker(Reason reason);
+        virtual Type type() const override { return Type::Signal; }
         virtual bool should_unblock(Thread&) override;
         virtual const char* state_string() const override
         {
@@ -270,6 +314,31 @@ public:
     void did_schedule() { ++m_times_scheduled; }
     u32 times_scheduled() const { return m_times_scheduled; }
 
+    // Where a thread's time went while it wasn't running, in TSC cycles.
+    struct SchedulerStatistics {
+        // Runnable, but waiting for a processor.
+        u64 runnable_cycles { 0 };
+        // Blocked, by the type of Blocker.
+        u64 blocked_cycles[(size_t)Blocker::Type::__Count] {};
+        // In a WaitQueue, which is where Lock, futex and the like make threads wait.
+        u64 queued_cycles { 0 };
+        // How often the thread was switched out while it could have kept running.
+        u32 involuntary_switches { 0 };
+
+        u64 total_blocked_cycles() const
+        {
+            u64 total = 0;
+            for (auto cycles : blocked_cycles)
+                total += cycles;
+            return total;
+        }
+    };
+    // Includes the time spent in the current state so far.
+    SchedulerStatistics scheduler_statistics() const;
+    void did_involuntary_switch() { ++m_scheduler_statistics.involuntary_switches; }
+    void did_migrate() { ++m_times_migrated; }
+    u32 times_migrated() const { return m_times_migrated; }
+
     bool is_stopped() const { return m_state == Stopped; }
     bool is_blocked() const { return m_state == Blocked; }
     bool has_blocker() const
@@ -282,6 +351,8 @@ public:
     u32 cpu() const { return m_cpu.load(AK::MemoryOrder::memory_order_consume); }
     void set_cpu(u32 cpu) { m_cpu.store(cpu, AK::MemoryOrder::memory_order_release); }
     u32 affinity() const { return m_cpu_affinity; }
+    u32 ready_queue_cpu() const { return m_ready_queue_cpu; }
+    u32 ready_queue_level() const { return m_ready_queue_level; }
     void set_affinity(u32 affinity) { m_cpu_affinity = affinity; }
 
     u32 stack_ptr() const { return m_tss.esp; }
@@ -297,8 +368,9 @@ public:
     VirtualAddress thread_specific_data() const { return m_thread_specific_data; }
     size_t thread_specific_region_size() const { return m_thread_specific_region_size; }
 
-    u64 sleep(u64 ticks);
-    u64 sleep_until(u64 wakeup_time);
+    // Both return how many nanoseconds were left when the sleep got interrupted, or 0.
+    u64 sleep_for(u64 nanoseconds);
+    u64 sleep_until(u64 nanoseconds_since_boot);
 
     class BlockResult {
     public:
@@ -388,6 +460,9 @@ public:
     void wake_from_queue();
 
     void unblock();
+    // Unblocks the thread right away if whatever it's blocked on is now satisfied,
+    // instead of leaving that for the scheduler to notice. Returns whether it did.
+    bool unblock_if_ready();
 
     // Tell this thread to unblock if needed,
     // gracefully unwind the stack and die.
@@ -416,12 +491,14 @@ public:
     ShouldUnblockThread dispatch_one_pending_signal();
     ShouldUnblockThread dispatch_signal(u8 signal);
     bool has_unmasked_pending_signals() const { return m_pending_signals & ~m_signal_mask; }
+    void set_signal_mask(u32 mask) { m_signal_mask = mask; }
     void terminate_due_to_signal(u8 signal);
     bool should_ignore_signal(u8 signal) const;
     bool has_signal_handler(u8 signal) const;
     bool has_pending_signal(u8 signal) const { return m_pending_signals & (1 << (signal - 1)); }
 
     FPUState& fpu_state() { return *m_fpu_state; }
+    PerformanceCounter& performance_counter() { return m_performance_counter; }
 
     void set_default_signal_dispositions();
     void push_value_on_stack(FlatPtr);
@@ -521,15 +598,18 @@ public:
 
 private:
     IntrusiveListNode m_runnable_list_node;
+    IntrusiveListNode m_ready_queue_node;
     IntrusiveListNode m_wait_queue_node;
 
 private:
     friend class SchedulerData;
+    friend struct ThreadReadyQueue;
     friend class WaitQueue;
     bool unlock_process_if_locked();
     void relock_process(bool did_unlock);
     String backtrace_impl();
     void reset_fpu_state();
+    void account_state_time(SchedulerStatistics&, State, u64 cycles) const;
 
     mutable RecursiveSpinLock m_lock;
     NonnullRefPtr<Process> m_process;
@@ -540,6 +620,11 @@ private:
     u32 m_ticks { 0 };
     u32 m_ticks_left { 0 };
     u32 m_times_scheduled { 0 };
+    u32 m_times_migrated { 0 };
+    SchedulerStatistics m_scheduler_statistics;
+    // When m_state last changed, per read_tsc(). Protected by g_scheduler_lock.
+    u64 m_state_changed_at { 0 };
+    Blocker::Type m_blocked_on { Blocker::Type::Condition };
     u32 m_pending_signals { 0 };
     u32 m_signal_mask { 0 };
     u32 m_kernel_stack_base { 0 };
@@ -573,12 +658,16 @@ private:
     unsigned m_ipv4_socket_write_bytes { 0 };
 
     FPUState* m_fpu_state { nullptr };
+    PerformanceCounter m_performance_counter;
     State m_state { Invalid };
     String m_name;
     u32 m_priority { THREAD_PRIORITY_NORMAL };
-    u32 m_extra_priority { 0 };
     u32 m_priority_boost { 0 };
 
+    // Which processor's ready queue this thread sits in while Runnable, and at what level.
+    u32 m_ready_queue_cpu { 0 };
+    u32 m_ready_queue_level { 0 };
+
     u8 m_stop_signal { 0 };
     State m_stop_state { Invalid };
 
@@ -633,11 +722,80 @@ inline IterationDecision Thread::for_each_in_state(State state, Callback callbac
 
 const LogStream& operator<<(const LogStream&, const Thread&);
 
+// The Runnable threads waiting for one processor, bucketed by effective priority so
+// that finding the next thread to run doesn't depend on how many of them there are.
+// Everything in here is protected by m_lock. Moving a thread to another processor's
+// queue additionally needs g_scheduler_lock, so that a thread's ready_queue_cpu()
+// stays put for anyone holding that.
+struct ThreadReadyQueue {
+    static constexpr u32 level_count = 32;
+    typedef IntrusiveList<Thread, &Thread::m_ready_queue_node> ThreadList;
+
+    static u32 level_for(const Thread& thread)
+    {
+        return min(thread.effective_priority(), level_count * 4 - 1) / 4;
+    }
+
+    bool is_empty() const { return !m_nonempty_levels; }
+    u32 highest_level() const
+    {
+        ASSERT(!is_empty());
+        return 31 - __builtin_clz(m_nonempty_levels);
+    }
+    u32 lowest_level() const
+    {
+        ASSERT(!is_empty());
+        return __builtin_ctz(m_nonempty_levels);
+    }
+
+    void enqueue(Thread& thread, u32 cpu, u32 level)
+    {
+        ASSERT(m_lock.is_locked());
+        ASSERT(!thread.m_ready_queue_node.is_in_list());
+        ASSERT(level < level_count);
+        thread.m_ready_queue_cpu = cpu;
+        thread.m_ready_queue_level = level;
+        m_threads[level].append(thread);
+        m_nonempty_levels |= 1u << level;
+        ++m_thread_count;
+    }
+
+    void dequeue(Thread& thread)
+    {
+        ASSERT(m_lock.is_locked());
+        ASSERT(thread.m_ready_queue_node.is_in_list());
+        auto& list = m_threads[thread.m_ready_queue_level];
+        list.remove(thread);
+        if (list.is_empty())
+            m_nonempty_levels &= ~(1u << thread.m_ready_queue_level);
+        ASSERT(m_thread_count);
+        --m_thread_count;
+    }
+
+    mutable SpinLock<u8> m_lock;
+    ThreadList m_threads[level_count];
+    u32 m_nonempty_levels { 0 };
+    u32 m_thread_count { 0 };
+
+    // Picks made while threads at a lower level were left waiting, see Scheduler::pick_next().
+    u32 m_picks_since_aging { 0 };
+
+    // Threads this processor took from another processor's queue.
+    u32 m_migrations { 0 };
+
+    // Set once the processor takes scheduler ticks, so that it can be relied on to drain its queue.
+    bool m_is_active { false };
+};
+
 struct SchedulerData {
     typedef IntrusiveList<Thread, &Thread::m_runnable_list_node> ThreadList;
 
+    // Processor affinity is a 32-bit mask, so there can't be more processors than this.
+    static constexpr u32 max_processors = 32;
+
     ThreadList m_runnable_threads;
     ThreadList m_nonrunnable_threads;
+    ThreadReadyQueue m_ready_queues[max_processors];
 
     bool has_thread(Thread& thread) const
     {
@@ -233,7 +233,33 @@ void HPET::enable(const HPETComparator& comparator)
 
 u64 HPET::main_counter_value() const
 {
-    return registers().main_counter_value.reg;
+    // The counter keeps running while we read its two halves, so make sure the high half didn't change under us.
+    auto* halves = (const volatile u32*)&registers().main_counter_value.reg;
+    for (;;) {
+        u32 high = halves[1];
+        u32 low = halves[0];
+        if (halves[1] == high)
+            return ((u64)high << 32) | low;
+    }
+}
+
+u64 HPET::nanoseconds_since_reset()
+{
+    u64 ticks;
+    {
+        ScopedSpinLock lock(m_main_counter_lock);
+        u64 value = main_counter_value();
+        if (counter_is_64_bit_capable) {
+            ticks = value;
+        } else {
+            // A 32-bit counter wraps around within minutes, but as long as someone looks at it
+            // more often than that (the scheduler tick does) we can count the wraparounds.
+            m_main_counter_extended_value += (u32)value - m_main_counter_last_low_value;
+            m_main_counter_last_low_value = (u32)value;
+            ticks = m_main_counter_extended_value;
+        }
+    }
+    return (ticks / m_frequency) * 1'000'000'000 + (ticks % m_frequency) * 1'000'000'000 / m_frequency;
 }
 
 u64 HPET::frequency() const
@@ -329,6 +355,9 @@ HPET::HPET(PhysicalAddress acpi_hpet)
 
     global_disable();
 
+    counter_is_64_bit_capable = registers().raw_capabilites.reg & (u32)HPETFlags::Attributes::Counter64BitCapable;
+    legacy_replacement_route_capable = registers().raw_capabilites.reg & (u32)HPETFlags::Attributes::LegacyReplacementRouteCapable;
+
     m_frequency = NANOSECOND_PERIOD_TO_HERTZ(calculate_ticks_in_nanoseconds());
     klog() << "HPET: frequency " << m_frequency << " Hz (" << MEGAHERTZ_TO_HERTZ(m_frequency) << " MHz)";
     ASSERT(capabilities_register->main_counter_tick_period <= ABSOLUTE_MAXIMUM_COUNTER_TICK_PERIOD);
@@ -32,6 +32,7 @@
 #include <AK/Types.h>
 #include <AK/Vector.h>
 #include <Kernel/PhysicalAddress.h>
+#include <Kernel/SpinLock.h>
 #include <Kernel/VM/Region.h>
 
 namespace Kernel {
@@ -49,6 +50,9 @@ public:
     u64 main_counter_value() const;
     u64 frequency() const;
 
+    // Nanoseconds since the main counter was reset at boot, extended past wraparounds of a 32-bit counter.
+    u64 nanoseconds_since_reset();
+
     const NonnullRefPtrVector<HPETComparator>& comparators() const { return m_comparators; }
     void disable(const HPETComparator&);
     void enable(const HPETComparator&);
@@ -83,6 +87,10 @@ private:
     OwnPtr<Region> m_hpet_mmio_region;
 
     u64 m_main_counter_clock_period { 0 };
+
+    SpinLock<u8> m_main_counter_lock;
+    u32 m_main_counter_last_low_value { 0 };
+    u64 m_main_counter_extended_value { 0 };
     u16 m_vendor_id;
     u16 m_minimum_tick;
     u64 m_frequency;
@@ -60,9 +60,22 @@ void HPETComparator::set_non_periodic()
 
 void HPETComparator::handle_irq(const RegisterState& regs)
 {
-    HardwareTimer::handle_irq(regs);
+    // Arm the next countdown first, so that the callback gets a chance to move it.
     if (!is_periodic())
         set_new_countdown();
+    HardwareTimer::handle_irq(regs);
+}
+
+void HPETComparator::set_next_interrupt_in(u64 nanoseconds)
+{
+    ASSERT_INTERRUPTS_DISABLED();
+    ASSERT(!is_periodic());
+    auto hpet_frequency = HPET::the().frequency();
+    // If the main counter passes the comparator before we're done writing it, we won't hear from
+    // this timer again until the counter wraps around, so never aim closer than 10 microseconds.
+    u64 minimum_countdown = max(hpet_frequency / 100'000, (u64)1);
+    u64 countdown = min(nanoseconds, (u64)1'000'000'000) * hpet_frequency / 1'000'000'000;
+    HPET::the().set_non_periodic_comparator_value(*this, max(countdown, minimum_countdown));
 }
 
 void HPETComparator::set_new_countdown()
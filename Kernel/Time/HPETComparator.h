@@ -50,6 +50,9 @@ public:
     virtual void set_periodic() override;
     virtual void set_non_periodic() override;
 
+    virtual bool is_one_shot_capable() const override { return !is_periodic(); }
+    virtual void set_next_interrupt_in(u64 nanoseconds) override;
+
     virtual void reset_to_default_ticks_per_second() override;
     virtual bool try_to_set_frequency(size_t frequency) override;
     virtual bool is_capable_of_frequency(size_t frequency) const override;
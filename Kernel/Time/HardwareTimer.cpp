@@ -55,4 +55,9 @@ void HardwareTimer::set_callback(Function<void(const RegisterState&)> callback)
     enable_irq();
 }
 
+void HardwareTimer::set_next_interrupt_in(u64)
+{
+    ASSERT_NOT_REACHED();
+}
+
 }
@@ -57,6 +57,10 @@ public:
     virtual void set_periodic() = 0;
     virtual void set_non_periodic() = 0;
 
+    // A one-shot timer can be told when to interrupt next, rather than just how often.
+    virtual bool is_one_shot_capable() const { return false; }
+    virtual void set_next_interrupt_in(u64 nanoseconds);
+
     virtual void reset_to_default_ticks_per_second() = 0;
     virtual bool try_to_set_frequency(size_t frequency) = 0;
     virtual bool is_capable_of_frequency(size_t frequency) const = 0;
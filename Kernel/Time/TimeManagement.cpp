@@ -24,6 +24,7 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <AK/StringView.h>
 #include <Kernel/ACPI/Parser.h>
 #include <Kernel/CommandLine.h>
 #include <Kernel/Scheduler.h>
@@ -33,6 +34,8 @@
 #include <Kernel/Time/PIT.h>
 #include <Kernel/Time/RTC.h>
 #include <Kernel/Time/TimeManagement.h>
+#include <Kernel/TimerQueue.h>
+#include <Kernel/VM/AnonymousVMObject.h>
 #include <Kernel/VM/MemoryManager.h>
 
 //#define TIME_DEBUG
@@ -56,6 +59,7 @@ void TimeManagement::set_epoch_time(time_t value)
 {
     InterruptDisabler disabler;
     m_epoch_time = value;
+    update_time_page();
 }
 
 time_t TimeManagement::epoch_time() const
@@ -92,6 +96,12 @@ time_t TimeManagement::boot_time() const
 
 TimeManagement::TimeManagement(bool probe_non_legacy_hardware_timers)
 {
+    auto time_page = MM.allocate_user_physical_page(MemoryManager::ShouldZeroFill::Yes);
+    ASSERT(time_page);
+    auto time_page_vmobject = AnonymousVMObject::create_with_physical_page(*time_page);
+    m_time_page_region = MM.allocate_kernel_region_with_vmobject(*time_page_vmobject, PAGE_SIZE, "Time page", Region::Access::Read | Region::Access::Write);
+    ASSERT(m_time_page_region);
+
     if (ACPI::is_enabled()) {
         if (!ACPI::Parser::the()->x86_specific_flags().cmos_rtc_not_present) {
             RTC::initialize();
@@ -120,6 +130,71 @@ timeval TimeManagement::now_as_timeval()
     return { s_time_management->epoch_time(), (suseconds_t)s_time_management->ticks_this_second() * (suseconds_t)1000 };
 }
 
+VMObject& TimeManagement::time_page_vmobject()
+{
+    return m_time_page_region->vmobject();
+}
+
+void TimeManagement::update_time_page()
+{
+    // The time keeper can tick before the constructor is done.
+    if (!m_time_page_region || !m_time_keeper_timer)
+        return;
+    auto& page = *reinterpret_cast<TimePage*>(m_time_page_region->vaddr().as_ptr());
+    ScopedSpinLock lock(m_time_page_lock);
+
+    u64 tsc = Processor::current().has_feature(CPUFeature::TSC) ? read_tsc() : 0;
+    u64 monotonic_nanoseconds = nanoseconds_since_boot();
+    u64 realtime_nanoseconds = (u64)m_epoch_time * 1'000'000'000 + (u64)m_ticks_this_second * 1'000'000'000 / m_time_keeper_timer->ticks_per_second();
+
+    // Readers retry while the sequence number is odd, so they never see half an update.
+    page.sequence = page.sequence + 1;
+    memory_barrier();
+    page.monotonic_nanoseconds = monotonic_nanoseconds;
+    page.realtime_nanoseconds = realtime_nanoseconds;
+    page.tsc = tsc;
+    if (tsc && !(page.flags & TIME_PAGE_TSC_IS_USABLE))
+        calibrate_tsc(page, tsc, monotonic_nanoseconds);
+    memory_barrier();
+    page.sequence = page.sequence + 1;
+}
+
+void TimeManagement::calibrate_tsc(TimePage& page, u64 tsc, u64 monotonic_nanoseconds)
+{
+    // Extrapolating from the time stamp counter only works if it ticks at the same rate all the time.
+    if (!Processor::current().has_feature(CPUFeature::CONSTANT_TSC))
+        return;
+
+    if (!m_tsc_calibration_start) {
+        m_tsc_calibration_start = tsc;
+        m_tsc_calibration_start_nanoseconds = monotonic_nanoseconds;
+        return;
+    }
+
+    // Measure for long enough that the resolution of the time keeper doesn't matter much.
+    u64 elapsed_nanoseconds = monotonic_nanoseconds - m_tsc_calibration_start_nanoseconds;
+    if (elapsed_nanoseconds < 2'000'000'000)
+        return;
+    u64 elapsed_ticks = tsc - m_tsc_calibration_start;
+    if (elapsed_nanoseconds > 0xffffffff || !elapsed_ticks) {
+        // Something stalled us for way too long, or the counter doesn't move. Start over.
+        m_tsc_calibration_start = 0;
+        return;
+    }
+
+    // Keep as many bits of precision as fit into a 32-bit multiplier.
+    u32 shift = 31;
+    u64 multiplier = (elapsed_nanoseconds << shift) / elapsed_ticks;
+    while (multiplier > 0xffffffff) {
+        multiplier >>= 1;
+        --shift;
+    }
+    page.tsc_multiplier = (u32)multiplier;
+    page.tsc_shift = shift;
+    page.flags |= TIME_PAGE_TSC_IS_USABLE;
+    klog() << "Time: Calibrated TSC at " << (elapsed_ticks * 1000 / elapsed_nanoseconds) << " MHz";
+}
+
 Vector<HardwareTimer*> TimeManagement::scan_and_initialize_periodic_timers()
 {
     bool should_enable = is_hpet_periodic_mode_allowed();
@@ -156,6 +231,66 @@ bool TimeManagement::is_hpet_periodic_mode_allowed()
     ASSERT_NOT_REACHED();
 }
 
+bool TimeManagement::is_tickless_mode_allowed()
+{
+    auto tickless_mode = kernel_command_line().lookup("tickless").value_or("on");
+    if (tickless_mode == "on")
+        return true;
+    if (tickless_mode == "off")
+        return false;
+    ASSERT_NOT_REACHED();
+}
+
+u64 TimeManagement::nanoseconds_since_boot() const
+{
+    if (m_system_timer->timer_type() == HardwareTimerType::HighPrecisionEventTimer)
+        return HPET::the().nanoseconds_since_reset();
+    return (u64)m_seconds_since_boot * 1'000'000'000 + (u64)m_ticks_this_second * 1'000'000'000 / m_time_keeper_timer->ticks_per_second();
+}
+
+bool TimeManagement::is_system_timer_one_shot() const
+{
+    return m_system_timer_is_one_shot;
+}
+
+u64 TimeManagement::catch_up_system_ticks()
+{
+    ASSERT_INTERRUPTS_DISABLED();
+    ASSERT(is_system_timer_one_shot());
+    ScopedSpinLock lock(m_system_timer_lock);
+    u64 now = nanoseconds_since_boot();
+    if (now < m_next_system_tick_at)
+        return 0;
+    u64 tick_length = 1'000'000'000 / m_system_timer->ticks_per_second();
+    u64 elapsed_ticks = (now - m_next_system_tick_at) / tick_length + 1;
+    m_next_system_tick_at += elapsed_ticks * tick_length;
+    return elapsed_ticks;
+}
+
+void TimeManagement::program_next_system_timer_interrupt(bool is_idle)
+{
+    // Blockers are still polled by the scheduler, so even an idle processor can't stop
+    // ticking altogether; it just sleeps through this many ticks at a time.
+    static constexpr u64 max_idle_ticks = 10;
+
+    if (!is_system_timer_one_shot())
+        return;
+    // The timer interrupt and processors arming a timer may get here at the same time.
+    ScopedSpinLock lock(m_system_timer_lock);
+    u64 tick_length = 1'000'000'000 / m_system_timer->ticks_per_second();
+    u64 next_interrupt_at = m_next_system_tick_at;
+    if (is_idle)
+        next_interrupt_at += (max_idle_ticks - 1) * tick_length;
+    // Unless the local APIC timer takes care of them, the system timer has to fire our timers.
+    if (!TimerQueue::is_driven_by_local_timer()) {
+        auto next_timer_due = TimerQueue::next_timer_due();
+        if (next_timer_due && next_timer_due < next_interrupt_at)
+            next_interrupt_at = next_timer_due;
+    }
+    u64 now = nanoseconds_since_boot();
+    m_system_timer->set_next_interrupt_in(next_interrupt_at > now ? next_interrupt_at - now : 0);
+}
+
 bool TimeManagement::probe_and_set_non_legacy_hardware_timers()
 {
     if (!ACPI::is_enabled())
@@ -192,9 +327,16 @@ bool TimeManagement::probe_and_set_non_legacy_hardware_timers()
         }
     }
 
+    if (is_tickless_mode_allowed() && m_system_timer->is_periodic())
+        m_system_timer->set_non_periodic();
+
     m_system_timer->set_callback(Scheduler::timer_tick);
     dbg() << "Reset timers";
     m_system_timer->try_to_set_frequency(m_system_timer->calculate_nearest_possible_frequency(1024));
+    if (is_tickless_mode_allowed() && m_system_timer->is_one_shot_capable()) {
+        m_next_system_tick_at = HPET::the().nanoseconds_since_reset() + 1'000'000'000 / m_system_timer->ticks_per_second();
+        m_system_timer_is_one_shot = true;
+    }
     m_time_keeper_timer->set_callback(TimeManagement::update_time);
     m_time_keeper_timer->try_to_set_frequency(OPTIMAL_TICKS_PER_SECOND_RATE);
 
@@ -233,6 +375,7 @@ void TimeManagement::increment_time_since_boot(const RegisterState&)
         ++m_epoch_time;
         m_ticks_this_second = 0;
     }
+    update_time_page();
 }
 
 }
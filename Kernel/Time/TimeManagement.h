@@ -28,8 +28,11 @@
 
 #include <AK/FixedArray.h>
 #include <AK/NonnullRefPtrVector.h>
+#include <AK/OwnPtr.h>
 #include <AK/RefPtr.h>
 #include <AK/Types.h>
+#include <Kernel/API/TimePage.h>
+#include <Kernel/SpinLock.h>
 #include <Kernel/UnixTypes.h>
 
 namespace Kernel {
@@ -37,6 +40,8 @@ namespace Kernel {
 #define OPTIMAL_TICKS_PER_SECOND_RATE 1000
 
 class HardwareTimer;
+class Region;
+class VMObject;
 
 class TimeManagement {
     AK_MAKE_ETERNAL;
@@ -59,9 +64,22 @@ public:
     void increment_time_since_boot(const RegisterState&);
 
     static bool is_hpet_periodic_mode_allowed();
+    static bool is_tickless_mode_allowed();
+
+    // A monotonic clock with the best resolution the timer hardware allows.
+    u64 nanoseconds_since_boot() const;
+
+    // With a one-shot system timer, the scheduler tick doesn't have to come at a fixed rate:
+    // it can come early for a timer that's due in between, or be put off while idle.
+    bool is_system_timer_one_shot() const;
+    u64 catch_up_system_ticks();
+    void program_next_system_timer_interrupt(bool is_idle);
 
     static timeval now_as_timeval();
 
+    // The page behind map_time_page(), see Kernel/API/TimePage.h.
+    VMObject& time_page_vmobject();
+
 private:
     explicit TimeManagement(bool probe_non_legacy_hardware_timers);
     bool probe_and_set_legacy_hardware_timers();
@@ -70,11 +88,24 @@ private:
     Vector<HardwareTimer*> scan_for_non_periodic_timers();
     NonnullRefPtrVector<HardwareTimer> m_hardware_timers;
 
+    void update_time_page();
+    void calibrate_tsc(TimePage&, u64 tsc, u64 monotonic_nanoseconds);
+
+    bool m_system_timer_is_one_shot { false };
+    // Protects m_next_system_tick_at and the programming of the one-shot system timer.
+    SpinLock<u8> m_system_timer_lock;
+    u64 m_next_system_tick_at { 0 };
+
     u32 m_ticks_this_second { 0 };
     u32 m_seconds_since_boot { 0 };
     time_t m_epoch_time { 0 };
     RefPtr<HardwareTimer> m_system_timer;
     RefPtr<HardwareTimer> m_time_keeper_timer;
+
+    OwnPtr<Region> m_time_page_region;
+    SpinLock<u8> m_time_page_lock;
+    u64 m_tsc_calibration_start { 0 };
+    u64 m_tsc_calibration_start_nanoseconds { 0 };
 };
 
 }
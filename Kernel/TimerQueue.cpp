@@ -27,36 +27,95 @@
 #include <AK/Function.h>
 #include <AK/NonnullOwnPtr.h>
 #include <AK/OwnPtr.h>
+#include <Kernel/Interrupts/APIC.h>
 #include <Kernel/Scheduler.h>
 #include <Kernel/Time/TimeManagement.h>
 #include <Kernel/TimerQueue.h>
 
 namespace Kernel {
 
-static TimerQueue* s_the;
+TimerQueue& TimerQueue::for_this_processor()
+{
+    ASSERT_INTERRUPTS_DISABLED();
+    auto& processor = Processor::current();
+    if (!processor.timer_queue())
+        processor.set_timer_queue(*new TimerQueue(processor.id()));
+    return *processor.timer_queue();
+}
 
-TimerQueue& TimerQueue::the()
+TimerQueue::TimerQueue(u32 cpu)
+    : m_cpu(cpu)
 {
-    if (!s_the)
-        s_the = new TimerQueue;
-    return *s_the;
 }
 
-TimerQueue::TimerQueue()
+bool TimerQueue::is_driven_by_local_timer()
 {
-    m_ticks_per_second = TimeManagement::the().ticks_per_second();
+    return APIC::initialized() && APIC::the().has_timer();
 }
 
 TimerId TimerQueue::add_timer(NonnullOwnPtr<Timer>&& timer)
 {
-    u64 timer_expiration = timer->expires;
-    ASSERT(timer_expiration >= g_uptime);
+    InterruptDisabler disabler;
+    return for_this_processor().add(move(timer));
+}
 
-    timer->id = ++m_timer_id_count;
+TimerId TimerQueue::add_timer(timeval& deadline, Function<void()>&& callback)
+{
+    u64 timeout = (u64)deadline.tv_sec * 1'000'000'000 + (u64)deadline.tv_usec * 1000;
+    return add_timer_at(TimeManagement::the().nanoseconds_since_boot() + timeout, move(callback));
+}
+
+TimerId TimerQueue::add_timer_at(u64 deadline, Function<void()>&& callback)
+{
+    NonnullOwnPtr timer = make<Timer>();
+    timer->expires = deadline;
+    timer->callback = move(callback);
+    return add_timer(move(timer));
+}
+
+bool TimerQueue::cancel_timer(TimerId id)
+{
+    InterruptDisabler disabler;
+    u32 owner = owner_of(id);
+    if (owner == Processor::current().id())
+        return for_this_processor().cancel(id);
+
+    // Only the owning processor may touch its queue. Once it has handled our
+    // message, the timer is gone and its callback is not running either.
+    bool did_cancel = false;
+    Processor::smp_unicast(
+        owner, [id, &did_cancel] {
+            did_cancel = Processor::current().timer_queue()->cancel(id);
+        },
+        false);
+    return did_cancel;
+}
+
+void TimerQueue::fire()
+{
+    ASSERT_INTERRUPTS_DISABLED();
+    // Don't allocate a queue from an interrupt handler, a processor that never armed a timer has nothing to fire.
+    if (auto* queue = Processor::current().timer_queue())
+        queue->fire_due_timers();
+}
+
+u64 TimerQueue::next_timer_due()
+{
+    InterruptDisabler disabler;
+    auto* queue = Processor::current().timer_queue();
+    return queue ? queue->m_next_timer_due : 0;
+}
+
+TimerId TimerQueue::add(NonnullOwnPtr<Timer>&& timer)
+{
+    u64 timer_expiration = timer->expires;
+    bool next_timer_changed = false;
+    TimerId id = timer->id = ((u64)m_cpu << 56) | ++m_timer_id_count;
 
     if (m_timer_queue.is_empty()) {
         m_timer_queue.append(move(timer));
         m_next_timer_due = timer_expiration;
+        next_timer_changed = true;
     } else {
         auto following_timer = m_timer_queue.find([&timer_expiration](auto& other) { return other->expires > timer_expiration; });
 
@@ -66,24 +125,22 @@ TimerId TimerQueue::add_timer(NonnullOwnPtr<Timer>&& timer)
             auto next_timer_needs_update = following_timer.is_begin();
             m_timer_queue.insert_before(following_timer, move(timer));
 
-            if (next_timer_needs_update)
+            if (next_timer_needs_update) {
                 m_next_timer_due = timer_expiration;
+                next_timer_changed = true;
+            }
         }
     }
 
-    return m_timer_id_count;
-}
+    if (next_timer_changed)
+        arm_local_timer();
 
-TimerId TimerQueue::add_timer(timeval& deadline, Function<void()>&& callback)
-{
-    NonnullOwnPtr timer = make<Timer>();
-    timer->expires = g_uptime + seconds_to_ticks(deadline.tv_sec) + microseconds_to_ticks(deadline.tv_usec);
-    timer->callback = move(callback);
-    return add_timer(move(timer));
+    return id;
 }
 
-bool TimerQueue::cancel_timer(TimerId id)
+bool TimerQueue::cancel(TimerId id)
 {
+    ASSERT_INTERRUPTS_DISABLED();
     auto it = m_timer_queue.find([id](auto& timer) { return timer->id == id; });
     if (it.is_end())
         return false;
@@ -97,19 +154,18 @@ bool TimerQueue::cancel_timer(TimerId id)
     return true;
 }
 
-void TimerQueue::fire()
+void TimerQueue::fire_due_timers()
 {
-    if (m_timer_queue.is_empty())
-        return;
-
-    ASSERT(m_next_timer_due == m_timer_queue.first()->expires);
-
-    while (!m_timer_queue.is_empty() && g_uptime > m_timer_queue.first()->expires) {
+    ASSERT_INTERRUPTS_DISABLED();
+    auto now = TimeManagement::the().nanoseconds_since_boot();
+    while (!m_timer_queue.is_empty() && m_timer_queue.first()->expires <= now) {
+        ASSERT(m_next_timer_due == m_timer_queue.first()->expires);
         auto timer = m_timer_queue.take_first();
+        update_next_timer_due();
+        // The callback may well add or cancel timers of its own, so it must run after the timer left the queue.
         timer->callback();
     }
-
-    update_next_timer_due();
+    arm_local_timer();
 }
 
 void TimerQueue::update_next_timer_due()
@@ -120,4 +176,24 @@ void TimerQueue::update_next_timer_due()
         m_next_timer_due = m_timer_queue.first()->expires;
 }
 
+void TimerQueue::arm_local_timer()
+{
+    ASSERT(Processor::current().id() == m_cpu);
+    if (!is_driven_by_local_timer()) {
+        // Without a local APIC timer there are no other processors either.
+        ASSERT(m_cpu == 0);
+        // Make sure the system timer doesn't sleep past the new deadline.
+        if (m_next_timer_due)
+            TimeManagement::the().program_next_system_timer_interrupt(false);
+        return;
+    }
+
+    if (!m_next_timer_due) {
+        APIC::the().stop_timer();
+        return;
+    }
+    u64 now = TimeManagement::the().nanoseconds_since_boot();
+    APIC::the().set_timer_deadline_in(m_next_timer_due > now ? m_next_timer_due - now : 0);
+}
+
 }
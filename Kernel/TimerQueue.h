@@ -38,6 +38,7 @@ typedef u64 TimerId;
 
 struct Timer {
     TimerId id;
+    // In nanoseconds since boot, see TimeManagement::nanoseconds_since_boot().
     u64 expires;
     Function<void()> callback;
     bool operator<(const Timer& rhs) const
@@ -54,26 +55,40 @@ struct Timer {
     }
 };
 
+// Every processor keeps its own queue of timers, which only that processor
+// ever touches (with interrupts disabled), so no lock is needed. Timers fire
+// on the processor that armed them, driven by its local APIC timer if there
+// is one. Cancelling a timer that belongs to another processor is done by
+// sending that processor a message.
 class TimerQueue {
 public:
-    static TimerQueue& the();
+    static TimerId add_timer(NonnullOwnPtr<Timer>&&);
+    static TimerId add_timer(timeval& timeout, Function<void()>&& callback);
+    static TimerId add_timer_at(u64 deadline, Function<void()>&& callback);
+    static bool cancel_timer(TimerId id);
+    static void fire();
 
-    TimerId add_timer(NonnullOwnPtr<Timer>&&);
-    TimerId add_timer(timeval& timeout, Function<void()>&& callback);
-    bool cancel_timer(TimerId id);
-    void fire();
+    // When the earliest timer of this processor expires, or 0 if there are none.
+    static u64 next_timer_due();
+
+    // Whether the timers fire from the local APIC timer rather than the system timer.
+    static bool is_driven_by_local_timer();
 
 private:
-    TimerQueue();
+    explicit TimerQueue(u32 cpu);
 
-    void update_next_timer_due();
+    static TimerQueue& for_this_processor();
+    static u32 owner_of(TimerId id) { return id >> 56; }
 
-    u64 microseconds_to_ticks(u64 micro_seconds) { return micro_seconds * (m_ticks_per_second / 1'000'000); }
-    u64 seconds_to_ticks(u64 seconds) { return seconds * m_ticks_per_second; }
+    TimerId add(NonnullOwnPtr<Timer>&&);
+    bool cancel(TimerId id);
+    void fire_due_timers();
+    void update_next_timer_due();
+    void arm_local_timer();
 
+    u32 m_cpu { 0 };
     u64 m_next_timer_due { 0 };
     u64 m_timer_id_count { 0 };
-    u64 m_ticks_per_second { 0 };
     SinglyLinkedList<NonnullOwnPtr<Timer>> m_timer_queue;
 };
 
@@ -65,6 +65,15 @@ enum {
 #define PERF_EVENT_MALLOC 1
 #define PERF_EVENT_FREE 2
 
+// Hardware counters for the calling thread. arg1 is the sample period, or 0 to only count.
+#define PERF_EVENT_CYCLES 3
+#define PERF_EVENT_INSTRUCTIONS 4
+#define PERF_EVENT_CACHE_MISSES 5
+#define PERF_EVENT_BRANCH_MISSES 6
+// arg1 points to a u64 that receives the count of the calling thread's counter.
+#define PERF_EVENT_READ_COUNTER 7
+#define PERF_EVENT_DISABLE_COUNTER 8
+
 #define WNOHANG 1
 #define WUNTRACED 2
 #define WSTOPPED WUNTRACED
@@ -91,12 +100,19 @@ enum {
 #define MAP_ANON MAP_ANONYMOUS
 #define MAP_STACK 0x40
 #define MAP_PURGEABLE 0x80
+#define MAP_POPULATE 0x100
 
 #define PROT_READ 0x1
 #define PROT_WRITE 0x2
 #define PROT_EXEC 0x4
 #define PROT_NONE 0x0
 
+#define MADV_NORMAL 0x0
+#define MADV_RANDOM 0x1
+#define MADV_SEQUENTIAL 0x2
+#define MADV_WILLNEED 0x3
+#define MADV_DONTNEED 0x4
+#define MADV_FREE 0x8
 #define MADV_SET_VOLATILE 0x100
 #define MADV_SET_NONVOLATILE 0x200
 #define MADV_GET_VOLATILE 0x400
@@ -109,6 +125,8 @@ enum {
 #define F_GETFL 3
 #define F_SETFL 4
 #define F_ISTTY 5
+#define F_SETPIPE_SZ 8
+#define F_GETPIPE_SZ 9
 
 #define FD_CLOEXEC 1
 
@@ -437,6 +455,55 @@ struct pollfd {
     short revents;
 };
 
+#define EVENT_SET_IN (1u << 0)
+#define EVENT_SET_OUT (1u << 3)
+#define EVENT_SET_EDGE_TRIGGERED (1u << 31)
+
+#define EVENT_SET_CTL_ADD 1
+#define EVENT_SET_CTL_MODIFY 2
+#define EVENT_SET_CTL_REMOVE 3
+
+struct event_set_event {
+    unsigned events;
+    void* data;
+};
+
+#define IO_RING_OP_NOP 0
+#define IO_RING_OP_READ 1
+#define IO_RING_OP_WRITE 2
+#define IO_RING_OP_ACCEPT 3
+#define IO_RING_OP_RECV 4
+#define IO_RING_OP_SEND 5
+#define IO_RING_OP_FSYNC 6
+
+struct io_ring_header {
+    unsigned submission_head;
+    unsigned submission_tail;
+    unsigned completion_head;
+    unsigned completion_tail;
+    unsigned submission_entries;
+    unsigned completion_entries;
+    unsigned submissions_offset;
+    unsigned completions_offset;
+    unsigned buffers_offset;
+    unsigned buffers_size;
+};
+
+struct io_ring_submission {
+    unsigned opcode;
+    int fd;
+    size_t buffer_offset;
+    size_t length;
+    ssize_t offset;
+    int flags;
+    void* user_data;
+};
+
+struct io_ring_completion {
+    void* user_data;
+    ssize_t result;
+};
+
 #define AF_MASK 0xff
 #define AF_UNSPEC 0
 #define AF_LOCAL 1
@@ -467,6 +534,7 @@ struct pollfd {
 #define SO_REUSEADDR 6
 #define SO_BINDTODEVICE 7
 #define SO_KEEPALIVE 9
+#define SO_REUSEPORT 10
 
 #define IPPROTO_IP 0
 #define IPPROTO_ICMP 1
@@ -475,6 +543,8 @@ struct pollfd {
 
 #define IP_TTL 2
 
+#define TCP_NODELAY 1
+
 struct ucred {
     pid_t pid;
     uid_t uid;
@@ -602,6 +672,15 @@ struct rtentry {
 
 #define AT_FDCWD -100
 
+#define DT_UNKNOWN 0
+#define DT_FIFO 1
+#define DT_CHR 2
+#define DT_DIR 4
+#define DT_BLK 6
+#define DT_REG 8
+#define DT_LNK 10
+#define DT_SOCK 12
+
 #define PURGE_ALL_VOLATILE 0x1
 #define PURGE_ALL_CLEAN_INODE 0x2
 
@@ -35,6 +35,7 @@ InodeVMObject::InodeVMObject(Inode& inode, size_t size)
     : VMObject(size)
     , m_inode(inode)
     , m_dirty_pages(page_count(), false)
+    , m_active_pages(page_count(), false)
 {
 }
 
@@ -42,9 +43,12 @@ InodeVMObject::InodeVMObject(const InodeVMObject& other)
     : VMObject(other)
     , m_inode(other.m_inode)
     , m_dirty_pages(page_count(), false)
+    , m_active_pages(page_count(), false)
 {
-    for (size_t i = 0; i < page_count(); ++i)
+    for (size_t i = 0; i < page_count(); ++i) {
         m_dirty_pages.set(i, other.m_dirty_pages.get(i));
+        m_active_pages.set(i, other.m_active_pages.get(i));
+    }
 }
 
 InodeVMObject::~InodeVMObject()
@@ -62,6 +66,26 @@ size_t InodeVMObject::amount_clean() const
     return count * PAGE_SIZE;
 }
 
+size_t InodeVMObject::active_page_count() const
+{
+    size_t count = 0;
+    for (size_t i = 0; i < page_count(); ++i) {
+        if (!m_dirty_pages.get(i) && m_physical_pages[i] && m_active_pages.get(i))
+            ++count;
+    }
+    return count;
+}
+
+size_t InodeVMObject::inactive_page_count() const
+{
+    size_t count = 0;
+    for (size_t i = 0; i < page_count(); ++i) {
+        if (!m_dirty_pages.get(i) && m_physical_pages[i] && !m_active_pages.get(i))
+            ++count;
+    }
+    return count;
+}
+
 size_t InodeVMObject::amount_dirty() const
 {
     size_t count = 0;
@@ -82,6 +106,7 @@ void InodeVMObject::inode_size_changed(Badge<Inode>, size_t old_size, size_t new
     m_physical_pages.resize(new_page_count);
 
     m_dirty_pages.grow(new_page_count, false);
+    m_active_pages.grow(new_page_count, false);
 
     // FIXME: Consolidate with inode_contents_changed() so we only do a single walk.
     for_each_region([](auto& region) {
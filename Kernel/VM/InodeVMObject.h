@@ -47,6 +47,18 @@ public:
 
     int release_all_clean_pages();
 
+    // A page that's been mapped writable may no longer match the file, so it can't just be
+    // dropped and read back in later.
+    bool is_page_dirty(size_t page_index) const { return m_dirty_pages.get(page_index); }
+    void set_page_dirty(size_t page_index, bool dirty) { m_dirty_pages.set(page_index, dirty); }
+
+    // Clean resident pages are either active or inactive. The MemoryPressureTask promotes pages that
+    // were accessed since its last scan, demotes the ones that weren't, and reclaims inactive ones.
+    bool is_page_active(size_t page_index) const { return m_active_pages.get(page_index); }
+    void set_page_active(size_t page_index, bool active) { m_active_pages.set(page_index, active); }
+    size_t active_page_count() const;
+    size_t inactive_page_count() const;
+
     u32 writable_mappings() const;
     u32 executable_mappings() const;
 
@@ -64,6 +76,7 @@ protected:
 
     NonnullRefPtr<Inode> m_inode;
     Bitmap m_dirty_pages;
+    Bitmap m_active_pages;
 };
 
 }
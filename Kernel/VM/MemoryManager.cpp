@@ -26,14 +26,20 @@
 
 #include <AK/Assertions.h>
 #include <AK/Memory.h>
+#include <AK/QuickSort.h>
 #include <AK/StringView.h>
 #include <Kernel/Arch/i386/CPU.h>
 #include <Kernel/CMOS.h>
+#include <Kernel/CommandLine.h>
 #include <Kernel/FileSystem/Inode.h>
+#include <Kernel/Heap/SlabAllocator.h>
 #include <Kernel/Multiboot.h>
 #include <Kernel/Process.h>
+#include <Kernel/Tasks/MemoryPressureTask.h>
+#include <Kernel/Tasks/PageZeroingTask.h>
 #include <Kernel/VM/AnonymousVMObject.h>
 #include <Kernel/VM/ContiguousVMObject.h>
+#include <Kernel/VM/InodeVMObject.h>
 #include <Kernel/VM/MemoryManager.h>
 #include <Kernel/VM/PageDirectory.h>
 #include <Kernel/VM/PhysicalRegion.h>
@@ -58,6 +64,11 @@ MemoryManager& MM
     return *s_the;
 }
 
+bool MemoryManager::is_initialized()
+{
+    return s_the != nullptr;
+}
+
 MemoryManager::MemoryManager()
 {
     ScopedSpinLock lock(s_mm_lock);
@@ -161,9 +172,20 @@ void MemoryManager::parse_memory_map()
 
     ASSERT(m_super_physical_pages > 0);
     ASSERT(m_user_physical_pages > 0);
+
+    m_low_watermark = max(m_user_physical_pages / 32, 128u);
+    if (auto low_watermark = kernel_command_line().lookup("low_watermark"); low_watermark.has_value()) {
+        if (auto pages = low_watermark.value().to_uint(); pages.has_value() && pages.value() >= 4 && pages.value() < m_user_physical_pages / 4)
+            m_low_watermark = pages.value();
+        else
+            klog() << "MM: Ignoring bad low_watermark=" << low_watermark.value();
+    }
+    m_critical_watermark = m_low_watermark / 4;
+    m_high_watermark = m_low_watermark * 2;
+    klog() << "MM: Memory pressure watermarks: critical=" << m_critical_watermark << ", low=" << m_low_watermark << ", high=" << m_high_watermark << " pages";
 }
 
-const PageTableEntry* MemoryManager::pte(const PageDirectory& page_directory, VirtualAddress vaddr)
+PageTableEntry* MemoryManager::pte(PageDirectory& page_directory, VirtualAddress vaddr)
 {
     ASSERT_INTERRUPTS_DISABLED();
     ASSERT(s_mm_lock.own_lock());
@@ -171,9 +193,9 @@ const PageTableEntry* MemoryManager::pte(const PageDirectory& page_directory, Vi
     u32 page_directory_index = (vaddr.get() >> 21) & 0x1ff;
     u32 page_table_index = (vaddr.get() >> 12) & 0x1ff;
 
-    auto* pd = quickmap_pd(const_cast<PageDirectory&>(page_directory), page_directory_table_index);
+    auto* pd = quickmap_pd(page_directory, page_directory_table_index);
     const PageDirectoryEntry& pde = pd[page_directory_index];
-    if (!pde.is_present())
+    if (!pde.is_present() || pde.is_huge())
         return nullptr;
 
     return &quickmap_pt(PhysicalAddress((FlatPtr)pde.page_table_base()))[page_table_index];
@@ -189,6 +211,10 @@ PageTableEntry& MemoryManager::ensure_pte(PageDirectory& page_directory, Virtual
 
     auto* pd = quickmap_pd(page_directory, page_directory_table_index);
     PageDirectoryEntry& pde = pd[page_directory_index];
+    if (pde.is_huge()) {
+        demote_large_page(page_directory, vaddr);
+        ASSERT(!pde.is_huge());
+    }
     if (!pde.is_present()) {
 #ifdef MM_DEBUG
         dbg() << "MM: PDE " << page_directory_index << " not present (requested for " << vaddr << "), allocating";
@@ -202,12 +228,105 @@ PageTableEntry& MemoryManager::ensure_pte(PageDirectory& page_directory, Virtual
         pde.set_present(true);
         pde.set_writable(true);
         pde.set_global(&page_directory == m_kernel_page_directory.ptr());
-        page_directory.m_physical_pages.set(page_directory_index, move(page_table));
+        page_directory.m_physical_pages.set(vaddr.get() & LARGE_PAGE_MASK, move(page_table));
     }
 
     return quickmap_pt(PhysicalAddress((FlatPtr)pde.page_table_base()))[page_table_index];
 }
 
+const PageDirectoryEntry* MemoryManager::pde(const PageDirectory& page_directory, VirtualAddress vaddr)
+{
+    ASSERT_INTERRUPTS_DISABLED();
+    ASSERT(s_mm_lock.own_lock());
+    u32 page_directory_table_index = (vaddr.get() >> 30) & 0x3;
+    u32 page_directory_index = (vaddr.get() >> 21) & 0x1ff;
+
+    auto* pd = quickmap_pd(const_cast<PageDirectory&>(page_directory), page_directory_table_index);
+    return &pd[page_directory_index];
+}
+
+PageDirectoryEntry* MemoryManager::ensure_large_pde(PageDirectory& page_directory, VirtualAddress vaddr)
+{
+    ASSERT_INTERRUPTS_DISABLED();
+    ASSERT(s_mm_lock.own_lock());
+    ASSERT(!(vaddr.get() & ~LARGE_PAGE_MASK));
+    u32 page_directory_table_index = (vaddr.get() >> 30) & 0x3;
+    u32 page_directory_index = (vaddr.get() >> 21) & 0x1ff;
+
+    auto* pd = quickmap_pd(page_directory, page_directory_table_index);
+    PageDirectoryEntry& pde = pd[page_directory_index];
+    if (pde.is_present() && !pde.is_huge()) {
+        // The caller owns this whole 2 MiB range, so nobody else has anything mapped through this page table.
+        // Page tables we didn't allocate ourselves (i.e the ones set up by boot.S) have to stay though.
+        if (!page_directory.m_physical_pages.contains(vaddr.get()))
+            return nullptr;
+        page_directory.m_physical_pages.remove(vaddr.get());
+        pde.clear();
+    }
+    return &pde;
+}
+
+bool MemoryManager::unmap_large_page(PageDirectory& page_directory, VirtualAddress vaddr)
+{
+    ASSERT_INTERRUPTS_DISABLED();
+    ASSERT(s_mm_lock.own_lock());
+    u32 page_directory_table_index = (vaddr.get() >> 30) & 0x3;
+    u32 page_directory_index = (vaddr.get() >> 21) & 0x1ff;
+
+    auto* pd = quickmap_pd(page_directory, page_directory_table_index);
+    PageDirectoryEntry& pde = pd[page_directory_index];
+    if (!pde.is_huge())
+        return false;
+    pde.clear();
+    return true;
+}
+
+void MemoryManager::demote_large_page(PageDirectory& page_directory, VirtualAddress vaddr)
+{
+    ASSERT_INTERRUPTS_DISABLED();
+    ASSERT(s_mm_lock.own_lock());
+    u32 page_directory_table_index = (vaddr.get() >> 30) & 0x3;
+    u32 page_directory_index = (vaddr.get() >> 21) & 0x1ff;
+    VirtualAddress large_page_vaddr(vaddr.get() & LARGE_PAGE_MASK);
+
+    // Every PTE gets filled in below, so there's no point zeroing the page table first.
+    auto page_table = allocate_user_physical_page(ShouldZeroFill::No);
+    ASSERT(page_table);
+
+    // NOTE: Allocating may have purged pages and moved the quickmapped page directory, so look it up again.
+    auto* pd = quickmap_pd(page_directory, page_directory_table_index);
+    PageDirectoryEntry& pde = pd[page_directory_index];
+    ASSERT(pde.is_huge());
+#ifdef MM_DEBUG
+    dbg() << "MM: Demoting large page at " << large_page_vaddr << " => P" << String::format("%08x", pde.large_page_base());
+#endif
+
+    auto* pt = quickmap_pt(page_table->paddr());
+    for (size_t i = 0; i < PAGES_PER_LARGE_PAGE; ++i) {
+        auto& pte = pt[i];
+        pte.clear();
+        pte.set_physical_page_base(pde.large_page_base() + i * PAGE_SIZE);
+        pte.set_present(true);
+        pte.set_writable(pde.is_writable());
+        pte.set_user_allowed(pde.is_user_allowed());
+        pte.set_write_through(pde.is_write_through());
+        pte.set_cache_disabled(pde.is_cache_disabled());
+        pte.set_global(pde.is_global());
+        pte.set_execute_disabled(pde.is_execute_disabled());
+    }
+
+    pde.clear();
+    pde.set_page_table_base(page_table->paddr().get());
+    pde.set_user_allowed(true);
+    pde.set_present(true);
+    pde.set_writable(true);
+    pde.set_global(&page_directory == m_kernel_page_directory.ptr());
+    page_directory.m_physical_pages.set(large_page_vaddr.get(), move(page_table));
+    ++m_large_page_demotions;
+
+    flush_tlb(&page_directory, large_page_vaddr, PAGES_PER_LARGE_PAGE);
+}
+
 void MemoryManager::initialize(u32 cpu)
 {
     auto mm_data = new MemoryManagerData;
@@ -230,6 +349,44 @@ Region* MemoryManager::kernel_region_from_vaddr(VirtualAddress vaddr)
     return nullptr;
 }
 
+Optional<PhysicalAddress> MemoryManager::physical_address_for_dma(VirtualAddress vaddr, bool device_writes_memory, NonnullRefPtrVector<PhysicalPage>& pinned_pages)
+{
+    ScopedSpinLock lock(s_mm_lock);
+    if (is_user_address(vaddr)) {
+        // The process can unmap or fault in a different page at any time, so the page stays referenced until the
+        // transfer is done. Unmapping it then only orphans the page instead of handing it to someone else under the device.
+        auto* region = user_region_from_vaddr(*Process::current(), vaddr);
+        if (!region)
+            return {};
+        auto page_index = region->page_index_from_address(vaddr);
+        auto page = region->physical_page_slot(page_index);
+        if (!page || page->is_shared_zero_page())
+            return {};
+        if (device_writes_memory && (!region->is_writable() || region->should_cow(page_index)))
+            return {};
+        auto* pte = this->pte(Process::current()->page_directory(), vaddr);
+        if (!pte || !pte->is_present() || (FlatPtr)pte->physical_page_base() != page->paddr().get())
+            return {};
+        pinned_pages.append(page.release_nonnull());
+        return pinned_pages.last().paddr().offset(vaddr.get() & ~PAGE_MASK);
+    }
+
+    // Kernel buffers belong to the caller for the duration of the transfer.
+    auto& page_directory = kernel_page_directory();
+    auto* pde = this->pde(page_directory, vaddr);
+    if (pde->is_huge()) {
+        if (device_writes_memory && !pde->is_writable())
+            return {};
+        return PhysicalAddress(pde->large_page_base()).offset(vaddr.get() & ~LARGE_PAGE_MASK);
+    }
+    auto* pte = this->pte(page_directory, vaddr);
+    if (!pte || !pte->is_present())
+        return {};
+    if (device_writes_memory && !pte->is_writable())
+        return {};
+    return PhysicalAddress((FlatPtr)pte->physical_page_base()).offset(vaddr.get() & ~PAGE_MASK);
+}
+
 Region* MemoryManager::user_region_from_vaddr(Process& process, VirtualAddress vaddr)
 {
     ScopedSpinLock lock(s_mm_lock);
@@ -328,7 +485,9 @@ OwnPtr<Region> MemoryManager::allocate_kernel_region(PhysicalAddress paddr, size
 {
     ASSERT(!(size % PAGE_SIZE));
     ScopedSpinLock lock(s_mm_lock);
-    auto range = kernel_page_directory().range_allocator().allocate_anywhere(size);
+    // Line up the virtual range with the physical one so that Region::map() can use large pages.
+    size_t alignment = (size >= LARGE_PAGE_SIZE && !(paddr.get() & ~LARGE_PAGE_MASK)) ? LARGE_PAGE_SIZE : PAGE_SIZE;
+    auto range = kernel_page_directory().range_allocator().allocate_anywhere(size, alignment);
     if (!range.is_valid())
         return nullptr;
     auto vmobject = AnonymousVMObject::create_for_physical_range(paddr, size);
@@ -389,6 +548,7 @@ void MemoryManager::deallocate_user_physical_page(PhysicalPage&& page)
 
         region.return_page(move(page));
         --m_user_physical_pages_used;
+        update_memory_pressure();
 
         return;
     }
@@ -414,6 +574,13 @@ RefPtr<PhysicalPage> MemoryManager::allocate_user_physical_page(ShouldZeroFill s
     ScopedSpinLock lock(s_mm_lock);
     auto page = find_free_user_physical_page();
 
+    if (!page && !m_zeroed_user_physical_pages.is_empty()) {
+        // Pages in the pre-zeroed pool are already accounted as used, so hand one of them out as-is.
+        page = m_zeroed_user_physical_pages.take_last();
+        update_memory_pressure();
+        return page;
+    }
+
     if (!page) {
         // We didn't have a single free physical page. Let's try to free something up!
         // First, we look for a purgeable VMObject in the volatile state.
@@ -428,8 +595,13 @@ RefPtr<PhysicalPage> MemoryManager::allocate_user_physical_page(ShouldZeroFill s
             return IterationDecision::Continue;
         });
 
+        // Then we see if the slab allocators are sitting on any empty blocks.
+        if (!page && slab_release_empty_blocks())
+            page = find_free_user_physical_page();
+
         if (!page) {
             klog() << "MM: no user physical pages available";
+            update_memory_pressure();
             return {};
         }
     }
@@ -445,9 +617,217 @@ RefPtr<PhysicalPage> MemoryManager::allocate_user_physical_page(ShouldZeroFill s
     }
 
     ++m_user_physical_pages_used;
+    update_memory_pressure();
     return page;
 }
 
+const char* MemoryManager::to_string(MemoryPressure pressure)
+{
+    switch (pressure) {
+    case MemoryPressure::None:
+        return "none";
+    case MemoryPressure::Low:
+        return "low";
+    case MemoryPressure::Critical:
+        return "critical";
+    }
+    ASSERT_NOT_REACHED();
+}
+
+void MemoryManager::update_memory_pressure()
+{
+    ASSERT(s_mm_lock.own_lock());
+    auto free_pages = free_user_physical_pages();
+    auto pressure = m_memory_pressure;
+    if (free_pages < m_critical_watermark)
+        pressure = MemoryPressure::Critical;
+    else if (free_pages < m_low_watermark)
+        pressure = MemoryPressure::Low;
+    else if (free_pages >= m_high_watermark)
+        pressure = MemoryPressure::None;
+    else if (pressure == MemoryPressure::Critical)
+        pressure = MemoryPressure::Low;
+
+    if (pressure == m_memory_pressure)
+        return;
+    m_memory_pressure = pressure;
+    ++m_memory_pressure_sequence;
+    if (pressure != MemoryPressure::None)
+        MemoryPressureTask::wake();
+}
+
+size_t MemoryManager::reclaim_volatile_pages()
+{
+    Vector<NonnullRefPtr<PurgeableVMObject>> candidates;
+    {
+        ScopedSpinLock lock(s_mm_lock);
+        if (free_user_physical_pages() >= m_high_watermark)
+            return 0;
+        for_each_vmobject_of_type<PurgeableVMObject>([&](auto& vmobject) {
+            if (vmobject.is_volatile())
+                candidates.append(vmobject);
+            return IterationDecision::Continue;
+        });
+    }
+
+    quick_sort(candidates, [](auto& a, auto& b) {
+        return a->volatile_since() < b->volatile_since();
+    });
+
+    size_t purged_page_count = 0;
+    for (auto& vmobject : candidates) {
+        purged_page_count += vmobject->purge();
+        ScopedSpinLock lock(s_mm_lock);
+        if (free_user_physical_pages() >= m_high_watermark)
+            break;
+    }
+
+    ScopedSpinLock lock(s_mm_lock);
+    m_pages_reclaimed += purged_page_count;
+    update_memory_pressure();
+    return purged_page_count;
+}
+
+size_t MemoryManager::age_and_reclaim_clean_pages(InodeVMObject& vmobject)
+{
+    // Page faults on this VMObject take the paging lock too, so nothing is paged in behind our back.
+    LOCKER(vmobject.m_paging_lock);
+    ScopedSpinLock lock(s_mm_lock);
+
+    Vector<Region*, 8> regions;
+    bool is_mapped_by_kernel = false;
+    vmobject.for_each_region([&](auto& region) {
+        if (!region.is_user_accessible())
+            is_mapped_by_kernel = true;
+        regions.append(&region);
+    });
+    // The kernel doesn't expect to fault on its own mappings.
+    if (is_mapped_by_kernel)
+        return 0;
+
+    size_t reclaimed_page_count = 0;
+    for (size_t page_index = 0; page_index < vmobject.page_count(); ++page_index) {
+        auto& page_slot = vmobject.m_physical_pages[page_index];
+        if (!page_slot || vmobject.is_page_dirty(page_index))
+            continue;
+
+        bool was_accessed = false;
+        bool is_mapped_large = false;
+        for (auto* region : regions) {
+            if (!region->m_page_directory || page_index < region->first_page_index() || page_index > region->last_page_index())
+                continue;
+            auto vaddr = region->vaddr_from_page_index(page_index - region->first_page_index());
+            auto* pte = this->pte(*region->m_page_directory, vaddr);
+            if (!pte) {
+                auto* pde = this->pde(*region->m_page_directory, vaddr);
+                if (pde->is_present() && pde->is_huge())
+                    is_mapped_large = true;
+                continue;
+            }
+            if (pte->is_present() && pte->is_accessed()) {
+                pte->set_accessed(false);
+                flush_tlb(region->m_page_directory, vaddr);
+                was_accessed = true;
+            }
+        }
+        // We can't tell whether pages in a 2 MiB mapping are in use, and dropping one would mean splitting the mapping.
+        if (is_mapped_large)
+            continue;
+
+        if (was_accessed) {
+            vmobject.set_page_active(page_index, true);
+            continue;
+        }
+        if (vmobject.is_page_active(page_index)) {
+            vmobject.set_page_active(page_index, false);
+            continue;
+        }
+        if (free_user_physical_pages() >= m_high_watermark)
+            continue;
+
+        for (auto* region : regions) {
+            if (!region->m_page_directory || page_index < region->first_page_index() || page_index > region->last_page_index())
+                continue;
+            auto vaddr = region->vaddr_from_page_index(page_index - region->first_page_index());
+            if (auto* pte = this->pte(*region->m_page_directory, vaddr)) {
+                pte->clear();
+                flush_tlb(region->m_page_directory, vaddr);
+            }
+        }
+        // Someone else (e.g the inode's page cache) may still hold on to the page, in which case it doesn't free anything.
+        if (page_slot->ref_count() == 1)
+            ++reclaimed_page_count;
+        page_slot = nullptr;
+    }
+    return reclaimed_page_count;
+}
+
+size_t MemoryManager::reclaim_clean_inode_pages()
+{
+    Vector<NonnullRefPtr<InodeVMObject>> candidates;
+    {
+        ScopedSpinLock lock(s_mm_lock);
+        if (free_user_physical_pages() >= m_high_watermark)
+            return 0;
+        for_each_vmobject_of_type<InodeVMObject>([&](auto& vmobject) {
+            if (vmobject.amount_clean())
+                candidates.append(vmobject);
+            return IterationDecision::Continue;
+        });
+    }
+
+    // Every VMObject gets scanned even once we're above the high watermark again, so all pages age at the same pace.
+    size_t reclaimed_page_count = 0;
+    for (auto& vmobject : candidates)
+        reclaimed_page_count += age_and_reclaim_clean_pages(vmobject);
+
+    ScopedSpinLock lock(s_mm_lock);
+    m_pages_reclaimed += reclaimed_page_count;
+    update_memory_pressure();
+    return reclaimed_page_count;
+}
+
+RefPtr<PhysicalPage> MemoryManager::take_zeroed_user_physical_page()
+{
+    RefPtr<PhysicalPage> page;
+    bool should_wake_zeroing_task;
+    {
+        ScopedSpinLock lock(s_mm_lock);
+        if (!m_zeroed_user_physical_pages.is_empty()) {
+            page = m_zeroed_user_physical_pages.take_last();
+            update_memory_pressure();
+        }
+        should_wake_zeroing_task = m_zeroed_user_physical_pages.size() < PageZeroingTask::low_water_mark;
+    }
+    if (should_wake_zeroing_task)
+        PageZeroingTask::wake();
+    return page;
+}
+
+size_t MemoryManager::refill_zeroed_user_physical_pages()
+{
+    size_t added = 0;
+    for (;;) {
+        {
+            ScopedSpinLock lock(s_mm_lock);
+            if (m_zeroed_user_physical_pages.size() >= PageZeroingTask::pool_size)
+                break;
+            // Don't hoard pages once memory is getting tight, everyone else needs them more than we do.
+            if (m_user_physical_pages - m_user_physical_pages_used < PageZeroingTask::minimum_free_pages)
+                break;
+        }
+        // Zero one page at a time so page faults on other processors don't wait for the whole batch.
+        auto page = allocate_user_physical_page(ShouldZeroFill::Yes);
+        if (!page)
+            break;
+        ScopedSpinLock lock(s_mm_lock);
+        m_zeroed_user_physical_pages.append(page.release_nonnull());
+        update_memory_pressure();
+        ++added;
+    }
+    return added;
+}
+
 void MemoryManager::deallocate_supervisor_physical_page(PhysicalPage&& page)
 {
     ASSERT(s_mm_lock.is_locked());
@@ -543,12 +923,14 @@ void MemoryManager::flush_tlb_local(VirtualAddress vaddr, size_t page_count)
     Processor::flush_tlb_local(vaddr, page_count);
 }
 
-void MemoryManager::flush_tlb(VirtualAddress vaddr, size_t page_count)
+void MemoryManager::flush_tlb(const PageDirectory* page_directory, VirtualAddress vaddr, size_t page_count)
 {
 #ifdef MM_DEBUG
     dbg() << "MM: Flush " << page_count << " pages at " << vaddr;
 #endif
-    Processor::flush_tlb(vaddr, page_count);
+    // Kernel mappings are shared by every page directory, so these have to be flushed everywhere
+    bool is_kernel_mapping = !page_directory || page_directory == m_kernel_page_directory.ptr();
+    Processor::flush_tlb(is_kernel_mapping ? 0 : page_directory->cr3(), vaddr, page_count);
 }
 
 extern "C" PageTableEntry boot_pd3_pt1023[1024];
@@ -687,7 +1069,10 @@ bool MemoryManager::can_read_without_faulting(const Process& process, VirtualAdd
     // FIXME: Use the size argument!
     UNUSED_PARAM(size);
     ScopedSpinLock lock(s_mm_lock);
-    auto* pte = const_cast<MemoryManager*>(this)->pte(process.page_directory(), vaddr);
+    auto* pde = const_cast<MemoryManager*>(this)->pde(process.page_directory(), vaddr);
+    if (pde->is_huge())
+        return true;
+    auto* pte = const_cast<MemoryManager*>(this)->pte(const_cast<PageDirectory&>(process.page_directory()), vaddr);
     if (!pte)
         return false;
     return pte->is_present();
@@ -76,16 +76,19 @@ extern RecursiveSpinLock s_mm_lock;
 
 class MemoryManager {
     AK_MAKE_ETERNAL
+    friend class Inode;
     friend class PageDirectory;
     friend class PhysicalPage;
     friend class PhysicalRegion;
     friend class Region;
+    friend class TmpFSInode;
     friend class VMObject;
     friend Optional<KBuffer> procfs$mm(InodeIdentifier);
     friend Optional<KBuffer> procfs$memstat(InodeIdentifier);
 
 public:
     static MemoryManager& the();
+    static bool is_initialized();
 
     static void initialize(u32 cpu);
     
@@ -106,12 +109,21 @@ public:
 
     bool can_read_without_faulting(const Process&, VirtualAddress, size_t) const;
 
+    // Returns the physical address currently backing vaddr, if the page is mapped in and safe to hand to a bus master.
+    // When the device is going to write into memory, the page also has to be mapped writable (i.e it mustn't be shared copy-on-write).
+    // Userspace pages are added to pinned_pages, which the caller has to hold on to until the device is done with them.
+    Optional<PhysicalAddress> physical_address_for_dma(VirtualAddress, bool device_writes_memory, NonnullRefPtrVector<PhysicalPage>& pinned_pages);
+
     enum class ShouldZeroFill {
         No,
         Yes
     };
 
     RefPtr<PhysicalPage> allocate_user_physical_page(ShouldZeroFill = ShouldZeroFill::Yes);
+    // Hands out a page from the pre-zeroed pool, or null if the pool has run dry.
+    RefPtr<PhysicalPage> take_zeroed_user_physical_page();
+    // Called by PageZeroingTask to top the pre-zeroed pool back up. Returns the number of pages added.
+    size_t refill_zeroed_user_physical_pages();
     RefPtr<PhysicalPage> allocate_supervisor_physical_page();
     NonnullRefPtrVector<PhysicalPage> allocate_contiguous_supervisor_physical_pages(size_t size);
     void deallocate_user_physical_page(PhysicalPage&&);
@@ -129,6 +141,39 @@ public:
     unsigned user_physical_pages_used() const { return m_user_physical_pages_used; }
     unsigned super_physical_pages() const { return m_super_physical_pages; }
     unsigned super_physical_pages_used() const { return m_super_physical_pages_used; }
+    unsigned zeroed_user_physical_pages() const { return m_zeroed_user_physical_pages.size(); }
+    enum class MemoryPressure {
+        None,
+        Low,
+        Critical,
+    };
+    static const char* to_string(MemoryPressure);
+
+    MemoryPressure memory_pressure() const { return m_memory_pressure; }
+    // Bumped every time memory_pressure() changes, so waiters can tell whether they've seen the latest state.
+    u32 memory_pressure_sequence() const { return m_memory_pressure_sequence; }
+    unsigned free_user_physical_pages() const { return m_user_physical_pages - m_user_physical_pages_used + m_zeroed_user_physical_pages.size(); }
+    unsigned critical_watermark() const { return m_critical_watermark; }
+    unsigned low_watermark() const { return m_low_watermark; }
+    unsigned high_watermark() const { return m_high_watermark; }
+    unsigned pages_reclaimed() const { return m_pages_reclaimed; }
+
+    // Purges volatile PurgeableVMObjects, least recently made volatile first, until we're back above the high watermark.
+    size_t reclaim_volatile_pages();
+    // Scans the clean pages of file mappings once, promoting the ones that were accessed since the last scan
+    // to the active list and demoting the others. Inactive pages that stayed untouched are dropped, until we're
+    // back above the high watermark; they're read back from the inode if they're ever faulted on again.
+    size_t reclaim_clean_inode_pages();
+
+    unsigned large_page_mappings() const { return m_large_page_mappings; }
+    unsigned large_page_demotions() const { return m_large_page_demotions; }
+
+    struct ZeroFaultStatistics {
+        Atomic<u32> shared_zero_page_reads { 0 };
+        Atomic<u32> zeroed_pool_hits { 0 };
+        Atomic<u32> inline_zero_fills { 0 };
+    };
+    const ZeroFaultStatistics& zero_fault_statistics() const { return m_zero_fault_statistics; }
 
     template<typename Callback>
     static void for_each_vmobject(Callback callback)
@@ -175,11 +220,14 @@ private:
     void register_region(Region&);
     void unregister_region(Region&);
 
+    void update_memory_pressure();
+    size_t age_and_reclaim_clean_pages(InodeVMObject&);
+
     void detect_cpu_features();
     void protect_kernel_image();
     void parse_memory_map();
     static void flush_tlb_local(VirtualAddress, size_t page_count = 1);
-    static void flush_tlb(VirtualAddress, size_t page_count = 1);
+    void flush_tlb(const PageDirectory*, VirtualAddress, size_t page_count = 1);
 
     static Region* user_region_from_vaddr(Process&, VirtualAddress);
     static Region* kernel_region_from_vaddr(VirtualAddress);
@@ -193,9 +241,17 @@ private:
     PageDirectoryEntry* quickmap_pd(PageDirectory&, size_t pdpt_index);
     PageTableEntry* quickmap_pt(PhysicalAddress);
 
-    const PageTableEntry* pte(const PageDirectory&, VirtualAddress);
+    // Doesn't allocate a page table if there isn't one, unlike ensure_pte().
+    PageTableEntry* pte(PageDirectory&, VirtualAddress);
     PageTableEntry& ensure_pte(PageDirectory&, VirtualAddress);
 
+    const PageDirectoryEntry* pde(const PageDirectory&, VirtualAddress);
+    // Returns the PDE to use for a 2 MiB mapping at vaddr (dropping any page table there), or null if that's not possible.
+    PageDirectoryEntry* ensure_large_pde(PageDirectory&, VirtualAddress);
+    bool unmap_large_page(PageDirectory&, VirtualAddress);
+    // Splits a 2 MiB mapping into 4 KiB PTEs so that part of it can be remapped.
+    void demote_large_page(PageDirectory&, VirtualAddress);
+
     RefPtr<PageDirectory> m_kernel_page_directory;
     RefPtr<PhysicalPage> m_low_page_table;
 
@@ -206,6 +262,21 @@ private:
     unsigned m_super_physical_pages { 0 };
     unsigned m_super_physical_pages_used { 0 };
 
+    // Pages in here are already zero-filled and counted as used.
+    NonnullRefPtrVector<PhysicalPage> m_zeroed_user_physical_pages;
+    ZeroFaultStatistics m_zero_fault_statistics;
+
+    // Free user physical page counts at which we consider memory to be tight.
+    unsigned m_critical_watermark { 0 };
+    unsigned m_low_watermark { 0 };
+    unsigned m_high_watermark { 0 };
+    MemoryPressure m_memory_pressure { MemoryPressure::None };
+    u32 m_memory_pressure_sequence { 0 };
+    unsigned m_pages_reclaimed { 0 };
+
+    unsigned m_large_page_mappings { 0 };
+    unsigned m_large_page_demotions { 0 };
+
     NonnullRefPtrVector<PhysicalRegion> m_user_physical_regions;
     NonnullRefPtrVector<PhysicalRegion> m_super_physical_regions;
 
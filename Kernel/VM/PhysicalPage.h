@@ -39,7 +39,7 @@ class PhysicalPage {
     friend class PageDirectory;
     friend class VMObject;
 
-    MAKE_SLAB_ALLOCATED(PhysicalPage)
+    MAKE_SLAB_CACHED(PhysicalPage, PhysicalPage)
 public:
     PhysicalAddress paddr() const { return m_paddr; }
 
@@ -30,6 +30,8 @@
 
 namespace Kernel {
 
+static Atomic<u32> s_volatile_sequence;
+
 NonnullRefPtr<PurgeableVMObject> PurgeableVMObject::create_with_size(size_t size)
 {
     return adopt(*new PurgeableVMObject(size));
@@ -54,6 +56,13 @@ NonnullRefPtr<VMObject> PurgeableVMObject::clone()
     return adopt(*new PurgeableVMObject(*this));
 }
 
+void PurgeableVMObject::set_volatile(bool is_volatile)
+{
+    if (is_volatile && !m_volatile)
+        m_volatile_since = ++s_volatile_sequence;
+    m_volatile = is_volatile;
+}
+
 int PurgeableVMObject::purge()
 {
     LOCKER(m_paging_lock);
@@ -44,7 +44,10 @@ public:
     void set_was_purged(bool b) { m_was_purged = b; }
 
     bool is_volatile() const { return m_volatile; }
-    void set_volatile(bool b) { m_volatile = b; }
+    void set_volatile(bool);
+
+    // Increases every time any PurgeableVMObject is made volatile, so the oldest volatile objects can be purged first.
+    u32 volatile_since() const { return m_volatile_since; }
 
 private:
     explicit PurgeableVMObject(size_t);
@@ -62,6 +65,7 @@ private:
 
     bool m_was_purged { false };
     bool m_volatile { false };
+    u32 m_volatile_since { 0 };
 };
 
 }
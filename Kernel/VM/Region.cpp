@@ -77,6 +77,7 @@ NonnullOwnPtr<Region> Region::clone()
         auto zeroed_region = Region::create_user_accessible(m_range, AnonymousVMObject::create_with_size(size()), 0, m_name, m_access);
         zeroed_region->set_mmap(m_mmap);
         zeroed_region->set_inherit_mode(m_inherit_mode);
+        zeroed_region->set_access_pattern(m_access_pattern);
         return zeroed_region;
     }
 
@@ -91,10 +92,20 @@ NonnullOwnPtr<Region> Region::clone()
         // Create a new region backed by the same VMObject.
         auto region = Region::create_user_accessible(m_range, m_vmobject, m_offset_in_vmobject, m_name, m_access);
         region->set_mmap(m_mmap);
+        region->set_access_pattern(m_access_pattern);
         region->set_shared(m_shared);
         return region;
     }
 
+    if (vmobject().is_shared_inode()) {
+        // A private read-only mapping of the inode's shared VMObject, there's nothing to CoW.
+        ASSERT(!is_writable());
+        auto region = Region::create_user_accessible(m_range, m_vmobject, m_offset_in_vmobject, m_name, m_access);
+        region->set_mmap(m_mmap);
+        region->set_access_pattern(m_access_pattern);
+        return region;
+    }
+
     if (vmobject().is_inode())
         ASSERT(vmobject().is_private_inode());
 
@@ -113,6 +124,7 @@ NonnullOwnPtr<Region> Region::clone()
         clone_region->set_stack(true);
     }
     clone_region->set_mmap(m_mmap);
+    clone_region->set_access_pattern(m_access_pattern);
     return clone_region;
 }
 
@@ -126,11 +138,11 @@ bool Region::commit()
         if (!commit(i)) {
             // Flush what we did commit
             if (i > 0)
-                MM.flush_tlb(vaddr(), i + 1);
+                MM.flush_tlb(m_page_directory, vaddr(), i + 1);
             return false;
         }
     }
-    MM.flush_tlb(vaddr(), page_count());
+    MM.flush_tlb(m_page_directory, vaddr(), page_count());
     return true;
 }
 
@@ -185,7 +197,11 @@ size_t Region::amount_shared() const
     size_t bytes = 0;
     for (size_t i = 0; i < page_count(); ++i) {
         auto* page = physical_page(i);
-        if (page && page->ref_count() > 1 && !page->is_shared_zero_page())
+        if (!page || page->is_shared_zero_page())
+            continue;
+        // Pages are only reffed by their VMObjects, so a page mapped by several regions through the
+        // same VMObject (like the text of a program that's running more than once) has a single ref.
+        if (page->ref_count() > 1 || m_vmobject->ref_count() > 1)
             bytes += PAGE_SIZE;
     }
     return bytes;
@@ -243,6 +259,8 @@ void Region::map_individual_page_impl(size_t page_index)
             pte.set_writable(false);
         else
             pte.set_writable(is_writable());
+        if (pte.is_writable() && vmobject().is_inode())
+            static_cast<InodeVMObject&>(vmobject()).set_page_dirty(first_page_index() + page_index, true);
         if (Processor::current().has_feature(CPUFeature::NX))
             pte.set_execute_disabled(!is_executable());
         pte.set_user_allowed(is_user_accessible());
@@ -252,6 +270,53 @@ void Region::map_individual_page_impl(size_t page_index)
     }
 }
 
+bool Region::map_large_page_impl(size_t page_index)
+{
+    auto page_vaddr = vaddr_from_page_index(page_index);
+    if (page_vaddr.get() & ~LARGE_PAGE_MASK)
+        return false;
+    if (page_index + PAGES_PER_LARGE_PAGE > page_count())
+        return false;
+    if (!is_readable() && !is_writable())
+        return false;
+
+    // A 2 MiB mapping is only possible if the backing pages are physically contiguous, suitably aligned,
+    // and we'd give all of them the same protection anyway.
+    auto* first_page = physical_page(page_index);
+    if (!first_page || (first_page->paddr().get() & ~LARGE_PAGE_MASK))
+        return false;
+    bool cow = should_cow(page_index);
+    for (size_t i = 1; i < PAGES_PER_LARGE_PAGE; ++i) {
+        auto* page = physical_page(page_index + i);
+        if (!page || page->paddr() != first_page->paddr().offset(i * PAGE_SIZE))
+            return false;
+        if (should_cow(page_index + i) != cow)
+            return false;
+    }
+
+    auto* pde = MM.ensure_large_pde(*m_page_directory, page_vaddr);
+    if (!pde)
+        return false;
+    pde->clear();
+    pde->set_large_page_base(first_page->paddr().get());
+    pde->set_huge(true);
+    pde->set_cache_disabled(!m_cacheable);
+    pde->set_present(true);
+    pde->set_writable(!cow && is_writable());
+    if (pde->is_writable() && vmobject().is_inode()) {
+        for (size_t i = 0; i < PAGES_PER_LARGE_PAGE; ++i)
+            static_cast<InodeVMObject&>(vmobject()).set_page_dirty(first_page_index() + page_index + i, true);
+    }
+    if (Processor::current().has_feature(CPUFeature::NX))
+        pde->set_execute_disabled(!is_executable());
+    pde->set_user_allowed(is_user_accessible());
+    ++MM.m_large_page_mappings;
+#ifdef MM_DEBUG
+    dbg() << "MM: >> region map (PD=" << m_page_directory->cr3() << ", large PDE=" << (void*)pde->raw() << ") " << name() << " " << page_vaddr << " => " << first_page->paddr();
+#endif
+    return true;
+}
+
 void Region::remap_page(size_t page_index, bool with_flush)
 {
     ASSERT(m_page_directory);
@@ -259,23 +324,29 @@ void Region::remap_page(size_t page_index, bool with_flush)
     ASSERT(physical_page(page_index));
     map_individual_page_impl(page_index);
     if (with_flush)
-        MM.flush_tlb(vaddr_from_page_index(page_index));
+        MM.flush_tlb(m_page_directory, vaddr_from_page_index(page_index));
 }
 
 void Region::unmap(ShouldDeallocateVirtualMemoryRange deallocate_range)
 {
     ScopedSpinLock lock(s_mm_lock);
     ASSERT(m_page_directory);
-    for (size_t i = 0; i < page_count(); ++i) {
+    for (size_t i = 0; i < page_count();) {
         auto vaddr = vaddr_from_page_index(i);
-        auto& pte = MM.ensure_pte(*m_page_directory, vaddr);
-        pte.clear();
+        if (!(vaddr.get() & ~LARGE_PAGE_MASK) && i + PAGES_PER_LARGE_PAGE <= page_count() && MM.unmap_large_page(*m_page_directory, vaddr)) {
+            i += PAGES_PER_LARGE_PAGE;
+            continue;
+        }
+        // Regions that were mapped lazily may not have a page table here at all.
+        if (auto* pte = MM.pte(*m_page_directory, vaddr))
+            pte->clear();
 #ifdef MM_DEBUG
         auto* page = physical_page(i);
         dbg() << "MM: >> Unmapped " << vaddr << " => P" << String::format("%p", page ? page->paddr().get() : 0) << " <<";
 #endif
+        ++i;
     }
-    MM.flush_tlb(vaddr(), page_count());
+    MM.flush_tlb(m_page_directory, vaddr(), page_count());
     if (deallocate_range == ShouldDeallocateVirtualMemoryRange::Yes) {
         if (m_page_directory->range_allocator().contains(range()))
             m_page_directory->range_allocator().deallocate(range());
@@ -299,9 +370,21 @@ void Region::map(PageDirectory& page_directory)
 #ifdef MM_DEBUG
     dbg() << "MM: Region::map() will map VMO pages " << first_page_index() << " - " << last_page_index() << " (VMO page count: " << vmobject().page_count() << ")";
 #endif
-    for (size_t page_index = 0; page_index < page_count(); ++page_index)
+    for (size_t page_index = 0; page_index < page_count();) {
+        if (map_large_page_impl(page_index)) {
+            page_index += PAGES_PER_LARGE_PAGE;
+            continue;
+        }
         map_individual_page_impl(page_index);
-    MM.flush_tlb(vaddr(), page_count());
+        ++page_index;
+    }
+    MM.flush_tlb(m_page_directory, vaddr(), page_count());
+}
+
+void Region::map_lazily(PageDirectory& page_directory)
+{
+    ScopedSpinLock lock(s_mm_lock);
+    set_page_directory(page_directory);
 }
 
 void Region::remap()
@@ -322,6 +405,14 @@ PageFaultResponse Region::handle_fault(const PageFault& fault)
             dbg() << "NP(non-writable) write fault in Region{" << this << "}[" << page_index_in_region << "] at " << fault.vaddr();
             return PageFaultResponse::ShouldCrash;
         }
+        if (!vmobject().is_inode() && physical_page(page_index_in_region)) {
+            // The page is there, it just hasn't been mapped yet; see map_lazily().
+#ifdef PAGE_FAULT_DEBUG
+            dbg() << "NP(lazy) fault in Region{" << this << "}[" << page_index_in_region << "]";
+#endif
+            remap_page(page_index_in_region);
+            return PageFaultResponse::Continue;
+        }
         if (vmobject().is_inode()) {
 #ifdef PAGE_FAULT_DEBUG
             dbg() << "NP(inode) fault in Region{" << this << "}[" << page_index_in_region << "]";
@@ -330,6 +421,7 @@ PageFaultResponse Region::handle_fault(const PageFault& fault)
         }
 #ifdef MAP_SHARED_ZERO_PAGE_LAZILY
         if (fault.is_read()) {
+            ++MM.m_zero_fault_statistics.shared_zero_page_reads;
             physical_page_slot(page_index_in_region) = MM.shared_zero_page();
             remap_page(page_index_in_region);
             return PageFaultResponse::Continue;
@@ -380,7 +472,13 @@ PageFaultResponse Region::handle_zero_fault(size_t page_index_in_region)
     if (current_thread != nullptr)
         current_thread->did_zero_fault();
 
-    auto page = MM.allocate_user_physical_page(MemoryManager::ShouldZeroFill::Yes);
+    auto page = MM.take_zeroed_user_physical_page();
+    if (!page.is_null()) {
+        ++MM.m_zero_fault_statistics.zeroed_pool_hits;
+    } else {
+        ++MM.m_zero_fault_statistics.inline_zero_fills;
+        page = MM.allocate_user_physical_page(MemoryManager::ShouldZeroFill::Yes);
+    }
     if (page.is_null()) {
         klog() << "MM: handle_zero_fault was unable to allocate a physical page";
         return PageFaultResponse::OutOfMemory;
@@ -442,18 +540,16 @@ PageFaultResponse Region::handle_inode_fault(size_t page_index_in_region)
     LOCKER(vmobject().m_paging_lock);
     cli();
 
-    auto& inode_vmobject = static_cast<InodeVMObject&>(vmobject());
-    auto& vmobject_physical_page_entry = inode_vmobject.physical_pages()[first_page_index() + page_index_in_region];
-
 #ifdef PAGE_FAULT_DEBUG
     dbg() << "Inode fault in " << name() << " page index: " << page_index_in_region;
 #endif
 
-    if (!vmobject_physical_page_entry.is_null()) {
+    if (!physical_page_slot(page_index_in_region).is_null()) {
 #ifdef PAGE_FAULT_DEBUG
         dbg() << ("MM: page_in_from_inode() but page already present. Fine with me!");
 #endif
         remap_page(page_index_in_region);
+        fault_around(page_index_in_region);
         return PageFaultResponse::Continue;
     }
 
@@ -461,15 +557,56 @@ PageFaultResponse Region::handle_inode_fault(size_t page_index_in_region)
     if (current_thread)
         current_thread->did_inode_fault();
 
+    auto response = page_in_from_inode(page_index_in_region);
+    if (response != PageFaultResponse::Continue)
+        return response;
+    remap_page(page_index_in_region);
+    fault_around(page_index_in_region);
+    return PageFaultResponse::Continue;
+}
+
+PageFaultResponse Region::page_in_from_inode(size_t page_index_in_region)
+{
+    ASSERT_INTERRUPTS_DISABLED();
+    ASSERT(vmobject().m_paging_lock.is_locked());
+
+    auto& inode_vmobject = static_cast<InodeVMObject&>(vmobject());
+    auto& vmobject_physical_page_entry = physical_page_slot(page_index_in_region);
+    auto& inode = inode_vmobject.inode();
+    if (inode_vmobject.is_shared_inode() && inode.is_backed_by_physical_pages()) {
+        // Writes through the mapping land in the file itself, so there's nothing to write back.
+        sti();
+        auto page = inode.backing_page(first_page_index() + page_index_in_region);
+        cli();
+        if (page.is_null()) {
+            klog() << "MM: handle_inode_fault was unable to get a page from the inode";
+            return PageFaultResponse::OutOfMemory;
+        }
+        vmobject_physical_page_entry = move(page);
+        return PageFaultResponse::Continue;
+    }
+    if (inode_vmobject.is_shared_inode() && inode.is_page_cacheable()) {
+        // Shared mappings use the inode's page cache pages directly, so read() and mmap() see the same memory.
+        sti();
+        auto page = inode.cached_page(first_page_index() + page_index_in_region);
+        cli();
+        if (page.is_null()) {
+            klog() << "MM: handle_inode_fault was unable to get a page from the page cache";
+            return PageFaultResponse::OutOfMemory;
+        }
+        vmobject_physical_page_entry = move(page);
+        return PageFaultResponse::Continue;
+    }
+
 #ifdef MM_DEBUG
     dbg() << "MM: page_in_from_inode ready to read from inode";
 #endif
     sti();
     u8 page_buffer[PAGE_SIZE];
-    auto& inode = inode_vmobject.inode();
     auto nread = inode.read_bytes((first_page_index() + page_index_in_region) * PAGE_SIZE, PAGE_SIZE, page_buffer, nullptr);
     if (nread < 0) {
         klog() << "MM: handle_inode_fault had error (" << nread << ") while reading!";
+        cli();
         return PageFaultResponse::ShouldCrash;
     }
     if (nread < PAGE_SIZE) {
@@ -486,9 +623,107 @@ PageFaultResponse Region::handle_inode_fault(size_t page_index_in_region)
     u8* dest_ptr = MM.quickmap_page(*vmobject_physical_page_entry);
     memcpy(dest_ptr, page_buffer, PAGE_SIZE);
     MM.unquickmap_page();
-
-    remap_page(page_index_in_region);
     return PageFaultResponse::Continue;
 }
 
+void Region::fault_around(size_t page_index_in_region)
+{
+    ASSERT_INTERRUPTS_DISABLED();
+    if (m_access_pattern == AccessPattern::Random)
+        return;
+
+    auto& inode_vmobject = static_cast<InodeVMObject&>(vmobject());
+    auto& inode = inode_vmobject.inode();
+
+    if (m_access_pattern == AccessPattern::Sequential) {
+        // Read ahead, but not past the end of the file.
+        size_t file_page_count = PAGE_ROUND_UP(inode.size()) / PAGE_SIZE;
+        for (size_t i = page_index_in_region + 1; i < min(page_count(), page_index_in_region + 1 + read_ahead_page_count); ++i) {
+            if (first_page_index() + i >= file_page_count)
+                break;
+            if (physical_page_slot(i).is_null() && page_in_from_inode(i) != PageFaultResponse::Continue)
+                break;
+            remap_page(i, false);
+        }
+        return;
+    }
+
+    // Only map what's already in memory: this is supposed to save page faults, not cause I/O.
+    bool can_use_page_cache = inode_vmobject.is_shared_inode() && !inode.is_backed_by_physical_pages() && inode.is_page_cacheable();
+    size_t first_page_index_around = page_index_in_region & ~(fault_around_page_count - 1);
+    for (size_t i = first_page_index_around; i < min(page_count(), first_page_index_around + fault_around_page_count); ++i) {
+        if (i == page_index_in_region)
+            continue;
+        auto& page_slot = physical_page_slot(i);
+        if (page_slot.is_null()) {
+            if (!can_use_page_cache)
+                continue;
+            sti();
+            auto page = inode.cached_page_if_present(first_page_index() + i);
+            cli();
+            if (page.is_null())
+                continue;
+            page_slot = move(page);
+        }
+        remap_page(i, false);
+    }
+}
+
+bool Region::prefault(size_t page_index, size_t page_count)
+{
+    ASSERT(page_index + page_count <= this->page_count());
+    InterruptDisabler disabler;
+    for (size_t i = page_index; i < page_index + page_count; ++i) {
+        if (vmobject().is_inode()) {
+            if (handle_inode_fault(i) != PageFaultResponse::Continue)
+                return false;
+            continue;
+        }
+        if (!vmobject().is_anonymous())
+            return true;
+        auto* page = physical_page(i);
+        if (page && !page->is_shared_zero_page()) {
+            remap_page(i);
+            continue;
+        }
+        // Reading from the shared zero page doesn't need anything else.
+        if (!is_writable())
+            continue;
+        if (handle_zero_fault(i) != PageFaultResponse::Continue)
+            return false;
+    }
+    return true;
+}
+
+void Region::discard(size_t page_index, size_t page_count)
+{
+    ASSERT(page_index + page_count <= this->page_count());
+    LOCKER(vmobject().m_paging_lock);
+    ScopedSpinLock lock(s_mm_lock);
+    for (size_t i = page_index; i < page_index + page_count; ++i) {
+        auto& page_slot = physical_page_slot(i);
+        if (!m_shared && vmobject().is_anonymous() && !page_slot.is_null()) {
+            page_slot = MM.shared_zero_page();
+        } else if (vmobject().is_private_inode()) {
+            page_slot = nullptr;
+            static_cast<InodeVMObject&>(vmobject()).set_page_dirty(first_page_index() + i, false);
+        }
+        // Shared memory stays around for everyone else, we just stop mapping it here.
+        if (!m_page_directory)
+            continue;
+        auto vaddr = vaddr_from_page_index(i);
+        auto* pte = MM.pte(*m_page_directory, vaddr);
+        if (!pte) {
+            auto* pde = MM.pde(*m_page_directory, vaddr);
+            if (!pde->is_present() || !pde->is_huge())
+                continue;
+            // Split up the 2 MiB mapping first, the rest of it stays.
+            pte = &MM.ensure_pte(*m_page_directory, vaddr);
+        }
+        pte->clear();
+    }
+    if (m_page_directory)
+        MM.flush_tlb(m_page_directory, vaddr_from_page_index(page_index), page_count);
+}
+
 }
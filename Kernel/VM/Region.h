@@ -50,7 +50,7 @@ class Region final
     , public Weakable<Region> {
     friend class MemoryManager;
 
-    MAKE_SLAB_ALLOCATED(Region)
+    MAKE_SLAB_CACHED(Region, Region)
 public:
     enum Access {
         Read = 1,
@@ -63,6 +63,18 @@ public:
         ZeroedOnFork,
     };
 
+    // What madvise() told us about how the region is going to be accessed, for file page faults.
+    enum class AccessPattern {
+        Normal,
+        Random,
+        Sequential,
+    };
+
+    // On a file page fault, we also map the pages around it that are already in memory.
+    static constexpr size_t fault_around_page_count = 16;
+    // With AccessPattern::Sequential, we read this many pages ahead of the faulting one instead.
+    static constexpr size_t read_ahead_page_count = 32;
+
     static NonnullOwnPtr<Region> create_user_accessible(const Range&, NonnullRefPtr<VMObject>, size_t offset_in_vmobject, const StringView& name, u8 access, bool cacheable = true);
     static NonnullOwnPtr<Region> create_kernel_only(const Range&, NonnullRefPtr<VMObject>, size_t offset_in_vmobject, const StringView& name, u8 access, bool cacheable = true);
 
@@ -172,6 +184,9 @@ public:
 
     void set_page_directory(PageDirectory&);
     void map(PageDirectory&);
+    // Attaches the region without filling in any page tables, they get filled in from page faults
+    // as the pages are touched. Only for user regions.
+    void map_lazily(PageDirectory&);
     enum class ShouldDeallocateVirtualMemoryRange {
         No,
         Yes,
@@ -189,6 +204,16 @@ public:
 
     void set_inherit_mode(InheritMode inherit_mode) { m_inherit_mode = inherit_mode; }
 
+    AccessPattern access_pattern() const { return m_access_pattern; }
+    void set_access_pattern(AccessPattern access_pattern) { m_access_pattern = access_pattern; }
+
+    // Pages in everything in [page_index, page_index + page_count) right away, as if it had all been touched.
+    // Returns false if we ran out of memory or couldn't read from the inode.
+    bool prefault(size_t page_index, size_t page_count);
+    // Unmaps [page_index, page_index + page_count) and drops the pages behind it where that's possible. Private
+    // memory reads back as zeroes afterwards, private file mappings go back to the contents of the file.
+    void discard(size_t page_index, size_t page_count);
+
 private:
     Bitmap& ensure_cow_map() const;
 
@@ -206,8 +231,11 @@ private:
     PageFaultResponse handle_cow_fault(size_t page_index);
     PageFaultResponse handle_inode_fault(size_t page_index);
     PageFaultResponse handle_zero_fault(size_t page_index);
+    PageFaultResponse page_in_from_inode(size_t page_index);
+    void fault_around(size_t page_index);
 
     void map_individual_page_impl(size_t page_index);
+    bool map_large_page_impl(size_t page_index);
 
     RefPtr<PageDirectory> m_page_directory;
     Range m_range;
@@ -216,6 +244,7 @@ private:
     String m_name;
     u8 m_access { 0 };
     InheritMode m_inherit_mode : 3 { InheritMode::Default };
+    AccessPattern m_access_pattern : 2 { AccessPattern::Normal };
     bool m_shared : 1 { false };
     bool m_user_accessible : 1 { false };
     bool m_cacheable : 1 { false };
@@ -0,0 +1,214 @@
+/*
+ * Copyright (c) 2020, The SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+//#define VIRTIO_DEBUG
+
+#include <Kernel/VirtIO/VirtIODevice.h>
+
+namespace Kernel {
+
+// Registers of the legacy interface.
+static constexpr u16 REG_DEVICE_FEATURES = 0x00;
+static constexpr u16 REG_GUEST_FEATURES = 0x04;
+static constexpr u16 REG_QUEUE_ADDRESS = 0x08;
+static constexpr u16 REG_QUEUE_SIZE = 0x0c;
+static constexpr u16 REG_QUEUE_SELECT = 0x0e;
+static constexpr u16 REG_QUEUE_NOTIFY = 0x10;
+static constexpr u16 REG_DEVICE_STATUS = 0x12;
+static constexpr u16 REG_ISR_STATUS = 0x13;
+// These two only exist while MSI-X is enabled, and push the device configuration down behind them.
+static constexpr u16 REG_CONFIG_VECTOR = 0x14;
+static constexpr u16 REG_QUEUE_VECTOR = 0x16;
+
+static constexpr u16 DEVICE_CONFIG_OFFSET = 0x14;
+static constexpr u16 DEVICE_CONFIG_OFFSET_WITH_MSIX = 0x18;
+
+static constexpr u8 STATUS_ACKNOWLEDGE = 1;
+static constexpr u8 STATUS_DRIVER = 2;
+static constexpr u8 STATUS_DRIVER_OK = 4;
+static constexpr u8 STATUS_FAILED = 0x80;
+
+static constexpr u8 ISR_QUEUE_INTERRUPT = 1;
+
+static constexpr u16 NO_VECTOR = 0xffff;
+
+VirtIODevice::VirtIODevice(PCI::Address address)
+    : PCI::Device(address)
+    , m_io_base(PCI::get_BAR0(address) & ~1)
+{
+    enable_bus_mastering(pci_address());
+}
+
+VirtIODevice::~VirtIODevice()
+{
+    set_status(0);
+    if (m_msix_table)
+        m_msix_table->disable();
+}
+
+void VirtIODevice::set_status(u8 status)
+{
+    m_status = status;
+    m_io_base.offset(REG_DEVICE_STATUS).out(status);
+}
+
+void VirtIODevice::negotiate_features(u32 supported_features)
+{
+    // Writing a zero status resets the device.
+    set_status(0);
+    set_status(STATUS_ACKNOWLEDGE);
+    set_status(m_status | STATUS_DRIVER);
+
+    u32 device_features = m_io_base.offset(REG_DEVICE_FEATURES).in<u32>();
+    m_accepted_features = device_features & supported_features;
+#ifdef VIRTIO_DEBUG
+    klog() << purpose() << ": Device features " << String::format("%x", device_features) << ", accepted " << String::format("%x", m_accepted_features);
+#endif
+    m_io_base.offset(REG_GUEST_FEATURES).out(m_accepted_features);
+}
+
+bool VirtIODevice::setup_queues(u16 count)
+{
+    ASSERT(m_queues.is_empty());
+    for (u16 i = 0; i < count; ++i) {
+        m_io_base.offset(REG_QUEUE_SELECT).out(i);
+        u16 size = m_io_base.offset(REG_QUEUE_SIZE).in<u16>();
+        if (!size) {
+            klog() << purpose() << ": Queue " << i << " is not available";
+            return false;
+        }
+        auto queue = VirtIOQueue::try_create(i, size);
+        if (!queue) {
+            klog() << purpose() << ": Couldn't allocate queue " << i << " with " << size << " entries";
+            return false;
+        }
+        m_io_base.offset(REG_QUEUE_ADDRESS).out<u32>(queue->physical_address().get() / PAGE_SIZE);
+        m_queues.append(queue.release_nonnull());
+    }
+
+    if (setup_msix(count)) {
+        klog() << purpose() << ": Using MSI-X with " << m_msi_handlers.size() << " vector(s)";
+    } else {
+        klog() << purpose() << ": Using interrupt line " << interrupt_number();
+        enable_irq();
+    }
+    return true;
+}
+
+bool VirtIODevice::setup_msix(u16 count)
+{
+    m_msix_table = PCI::MSIXTable::try_create(pci_address());
+    if (!m_msix_table)
+        return false;
+
+    auto give_up = [&] {
+        m_msix_table->disable();
+        m_msix_table = nullptr;
+        m_msi_handlers.clear();
+        return false;
+    };
+
+    // Each queue gets its own vector if the table has room for them, otherwise they all share one.
+    bool shared = m_msix_table->entry_count() < count;
+    u16 vector_count = shared ? 1 : count;
+    for (u16 i = 0; i < vector_count; ++i) {
+        auto handler = MSIHandler::try_create(purpose(), [this, i, shared] {
+            if (!shared) {
+                handle_queue_interrupt(i);
+                return;
+            }
+            for (u16 queue_index = 0; queue_index < queue_count(); ++queue_index)
+                handle_queue_interrupt(queue_index);
+        });
+        if (!handler)
+            return give_up();
+        handler->set_message_writer([this, i](u32 address, u16 data) {
+            m_msix_table->set_entry(i, address, data);
+        });
+        m_msi_handlers.append(handler.release_nonnull());
+    }
+    m_msix_table->enable();
+
+    // We don't act on configuration changes, so they don't get a vector.
+    m_io_base.offset(REG_CONFIG_VECTOR).out(NO_VECTOR);
+    for (u16 i = 0; i < count; ++i) {
+        u16 entry = shared ? 0 : i;
+        m_io_base.offset(REG_QUEUE_SELECT).out(i);
+        m_io_base.offset(REG_QUEUE_VECTOR).out(entry);
+        // The device reads back NO_VECTOR if it couldn't take the mapping.
+        if (m_io_base.offset(REG_QUEUE_VECTOR).in<u16>() != entry)
+            return give_up();
+    }
+    return true;
+}
+
+void VirtIODevice::finish_initialization()
+{
+    set_status(m_status | STATUS_DRIVER_OK);
+}
+
+void VirtIODevice::fail_initialization()
+{
+    set_status(m_status | STATUS_FAILED);
+}
+
+void VirtIODevice::publish_queue(u16 index)
+{
+    if (queue(index).publish())
+        m_io_base.offset(REG_QUEUE_NOTIFY).out(index);
+}
+
+u16 VirtIODevice::device_config_offset() const
+{
+    return uses_msix() ? DEVICE_CONFIG_OFFSET_WITH_MSIX : DEVICE_CONFIG_OFFSET;
+}
+
+u8 VirtIODevice::config_read8(u16 offset)
+{
+    return m_io_base.offset(device_config_offset() + offset).in<u8>();
+}
+
+u16 VirtIODevice::config_read16(u16 offset)
+{
+    return m_io_base.offset(device_config_offset() + offset).in<u16>();
+}
+
+u32 VirtIODevice::config_read32(u16 offset)
+{
+    return m_io_base.offset(device_config_offset() + offset).in<u32>();
+}
+
+void VirtIODevice::handle_irq(const RegisterState&)
+{
+    // Reading the ISR status also deasserts the interrupt line.
+    u8 isr_status = m_io_base.offset(REG_ISR_STATUS).in<u8>();
+    if (!(isr_status & ISR_QUEUE_INTERRUPT))
+        return;
+    for (u16 i = 0; i < queue_count(); ++i)
+        handle_queue_interrupt(i);
+}
+
+}
@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2020, The SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/NonnullOwnPtrVector.h>
+#include <AK/OwnPtr.h>
+#include <Kernel/IO.h>
+#include <Kernel/Interrupts/MSIHandler.h>
+#include <Kernel/PCI/Device.h>
+#include <Kernel/PCI/MSIXTable.h>
+#include <Kernel/VirtIO/VirtIOQueue.h>
+
+namespace Kernel {
+
+// A virtio device behind the legacy (transitional) PCI interface, which QEMU and most other
+// hypervisors offer by default. Its registers are in the I/O space of BAR0.
+class VirtIODevice : public PCI::Device {
+public:
+    static constexpr u16 pci_vendor_id = 0x1af4;
+
+    virtual ~VirtIODevice() override;
+
+protected:
+    explicit VirtIODevice(PCI::Address);
+
+    // Resets the device and acknowledges it, then offers those of the supported feature bits the device has.
+    void negotiate_features(u32 supported_features);
+    bool has_feature(u32 feature_bit) const { return m_accepted_features & (1u << feature_bit); }
+
+    // Sets up the device's first count virtqueues, and an interrupt for each if MSI-X lets us.
+    bool setup_queues(u16 count);
+    // Tells the device the driver is ready. Queues must not be used before this.
+    void finish_initialization();
+    void fail_initialization();
+
+    size_t queue_count() const { return m_queues.size(); }
+    VirtIOQueue& queue(u16 index) { return m_queues[index]; }
+    // Hands the queue's enqueued requests to the device, and kicks it if it wants to be kicked.
+    void publish_queue(u16 index);
+
+    // Device specific configuration. It moves down while MSI-X is enabled, which these take into account.
+    u8 config_read8(u16 offset);
+    u16 config_read16(u16 offset);
+    u32 config_read32(u16 offset);
+
+    // Called in interrupt context when the device may have used buffers from the queue.
+    virtual void handle_queue_interrupt(u16 queue_index) = 0;
+
+    bool uses_msix() const { return m_msix_table && m_msix_table->is_enabled(); }
+
+private:
+    virtual void handle_irq(const RegisterState&) override;
+
+    void set_status(u8);
+    bool setup_msix(u16 count);
+    u16 device_config_offset() const;
+
+    IOAddress m_io_base;
+    u8 m_status { 0 };
+    u32 m_accepted_features { 0 };
+    NonnullOwnPtrVector<VirtIOQueue> m_queues;
+    OwnPtr<PCI::MSIXTable> m_msix_table;
+    NonnullOwnPtrVector<MSIHandler> m_msi_handlers;
+};
+
+}
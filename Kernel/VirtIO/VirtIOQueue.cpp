@@ -0,0 +1,140 @@
+/*
+ * Copyright (c) 2020, The SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <AK/Memory.h>
+#include <AK/StringView.h>
+#include <Kernel/Arch/i386/CPU.h>
+#include <Kernel/VM/MemoryManager.h>
+#include <Kernel/VirtIO/VirtIOQueue.h>
+
+namespace Kernel {
+
+static constexpr u16 descriptor_flag_next = 1;
+static constexpr u16 descriptor_flag_write = 2;
+static constexpr u16 available_flag_no_interrupt = 1;
+static constexpr u16 used_flag_no_notify = 1;
+
+OwnPtr<VirtIOQueue> VirtIOQueue::try_create(u16 index, u16 size)
+{
+    ASSERT(size);
+    size_t used_ring_offset = round_up_to_power_of_two(sizeof(Descriptor) * size + sizeof(u16) * (3 + size), used_ring_alignment);
+    size_t region_size = PAGE_ROUND_UP(used_ring_offset + sizeof(u16) * 3 + sizeof(UsedElement) * size);
+    auto region = MM.allocate_contiguous_kernel_region(region_size, "VirtIO Queue", Region::Access::Read | Region::Access::Write);
+    if (!region)
+        return nullptr;
+    return adopt_own(*new VirtIOQueue(index, size, region.release_nonnull()));
+}
+
+VirtIOQueue::VirtIOQueue(u16 index, u16 size, NonnullOwnPtr<Region> region)
+    : m_index(index)
+    , m_size(size)
+    , m_region(move(region))
+    , m_available_ring_offset(sizeof(Descriptor) * size)
+    , m_used_ring_offset(round_up_to_power_of_two(m_available_ring_offset + sizeof(u16) * (3 + size), used_ring_alignment))
+    , m_free_descriptor_count(size)
+{
+    memset(m_region->vaddr().as_ptr(), 0, m_region->size());
+    for (u16 i = 0; i + 1 < m_size; ++i)
+        descriptors()[i].next = i + 1;
+    m_tokens.resize(m_size);
+}
+
+VirtIOQueue::~VirtIOQueue()
+{
+}
+
+bool VirtIOQueue::enqueue(const Buffer* buffers, size_t count, u32 token)
+{
+    ASSERT(count);
+    if (count > m_free_descriptor_count)
+        return false;
+
+    u16 head = m_free_head;
+    u16 descriptor_index = head;
+    for (size_t i = 0; i < count; ++i) {
+        auto& descriptor = descriptors()[descriptor_index];
+        descriptor.address = buffers[i].address.get();
+        descriptor.length = buffers[i].length;
+        descriptor.flags = (buffers[i].device_writable ? descriptor_flag_write : 0) | (i + 1 < count ? descriptor_flag_next : 0);
+        if (i + 1 < count)
+            descriptor_index = descriptor.next;
+    }
+    m_free_head = descriptors()[descriptor_index].next;
+    m_free_descriptor_count -= count;
+    m_tokens[head] = token;
+
+    available_ring()[m_next_available_index % m_size] = head;
+    ++m_next_available_index;
+    return true;
+}
+
+bool VirtIOQueue::publish()
+{
+    // The ring entries have to be in place before the device sees the new index.
+    memory_barrier();
+    *available_index() = m_next_available_index;
+    // And the index has to be out before we look at whether the device wants to hear about it.
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    return !(*used_flags() & used_flag_no_notify);
+}
+
+bool VirtIOQueue::has_completions() const
+{
+    return *used_index() != m_last_used_index;
+}
+
+Optional<VirtIOQueue::Completion> VirtIOQueue::take_completion()
+{
+    if (!has_completions())
+        return {};
+    // Don't read the element before the index that says it's there.
+    memory_barrier();
+    auto& element = used_ring()[m_last_used_index % m_size];
+    u16 head = element.id;
+    Completion completion { m_tokens[head], element.length };
+    ++m_last_used_index;
+
+    // Put the whole chain back on the free list.
+    u16 tail = head;
+    size_t chain_length = 1;
+    while (descriptors()[tail].flags & descriptor_flag_next) {
+        tail = descriptors()[tail].next;
+        ++chain_length;
+    }
+    descriptors()[tail].next = m_free_head;
+    m_free_head = head;
+    m_free_descriptor_count += chain_length;
+    return completion;
+}
+
+void VirtIOQueue::set_interrupts_enabled(bool enabled)
+{
+    *available_flags() = enabled ? 0 : available_flag_no_interrupt;
+    if (enabled)
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+}
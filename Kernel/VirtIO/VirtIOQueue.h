@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) 2020, The SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/Optional.h>
+#include <AK/OwnPtr.h>
+#include <AK/Types.h>
+#include <AK/Vector.h>
+#include <Kernel/PhysicalAddress.h>
+#include <Kernel/VM/PhysicalPage.h>
+#include <Kernel/VM/Region.h>
+
+namespace Kernel {
+
+// A split virtqueue: a descriptor table, the ring of requests made available to the device,
+// and the ring the device hands them back on once used. Callers serialize access themselves.
+class VirtIOQueue {
+    AK_MAKE_NONCOPYABLE(VirtIOQueue);
+    AK_MAKE_NONMOVABLE(VirtIOQueue);
+
+public:
+    struct Buffer {
+        PhysicalAddress address;
+        u32 length { 0 };
+        bool device_writable { false };
+    };
+
+    struct Completion {
+        u32 token { 0 };
+        u32 length { 0 };
+    };
+
+    // The legacy interface aligns the used ring to a page, and locates the queue by its page frame number.
+    static constexpr size_t used_ring_alignment = PAGE_SIZE;
+
+    static OwnPtr<VirtIOQueue> try_create(u16 index, u16 size);
+    ~VirtIOQueue();
+
+    u16 index() const { return m_index; }
+    u16 size() const { return m_size; }
+    PhysicalAddress physical_address() const { return m_region->physical_page(0)->paddr(); }
+    size_t free_descriptor_count() const { return m_free_descriptor_count; }
+
+    // Chains the buffers into one request, which comes back from take_completion() with this token.
+    // Returns false if there aren't enough free descriptors for them.
+    bool enqueue(const Buffer*, size_t count, u32 token);
+    // Makes the requests enqueued so far visible to the device. Returns false if it asked not to be notified.
+    bool publish();
+
+    bool has_completions() const;
+    Optional<Completion> take_completion();
+
+    // Only a hint to the device. After enabling interrupts again, check has_completions() before waiting.
+    void set_interrupts_enabled(bool);
+
+private:
+    struct [[gnu::packed]] Descriptor
+    {
+        u64 address;
+        u32 length;
+        u16 flags;
+        u16 next;
+    };
+
+    struct [[gnu::packed]] UsedElement
+    {
+        u32 id;
+        u32 length;
+    };
+
+    VirtIOQueue(u16 index, u16 size, NonnullOwnPtr<Region>);
+
+    volatile Descriptor* descriptors() { return (volatile Descriptor*)m_region->vaddr().as_ptr(); }
+    volatile u16* available_flags() { return (volatile u16*)m_region->vaddr().offset(m_available_ring_offset).as_ptr(); }
+    volatile u16* available_index() { return available_flags() + 1; }
+    volatile u16* available_ring() { return available_flags() + 2; }
+    volatile u16* used_flags() const { return (volatile u16*)m_region->vaddr().offset(m_used_ring_offset).as_ptr(); }
+    volatile u16* used_index() const { return used_flags() + 1; }
+    volatile UsedElement* used_ring() { return (volatile UsedElement*)(used_flags() + 2); }
+
+    u16 m_index { 0 };
+    u16 m_size { 0 };
+    NonnullOwnPtr<Region> m_region;
+    size_t m_available_ring_offset { 0 };
+    size_t m_used_ring_offset { 0 };
+
+    u16 m_free_head { 0 };
+    u16 m_free_descriptor_count { 0 };
+    u16 m_next_available_index { 0 };
+    u16 m_last_used_index { 0 };
+    Vector<u32> m_tokens;
+};
+
+}
@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2020, The SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <Kernel/Arch/i386/CPU.h>
+#include <Kernel/Process.h>
+#include <Kernel/WorkQueue.h>
+
+namespace Kernel {
+
+WorkQueue* g_high_priority_work_queue;
+WorkQueue* g_work_queue;
+
+void DeferredWork::schedule_on_this_processor()
+{
+    InterruptDisabler disabler;
+    if (mark_pending())
+        Processor::current().deferred_work_queue(*this);
+}
+
+void DeferredWork::schedule(WorkQueue& work_queue)
+{
+    if (mark_pending())
+        work_queue.queue(*this);
+}
+
+void DeferredWork::run()
+{
+    // Clear the flag first, so that anything coming in while we run schedules us again.
+    m_pending.store(false, AK::memory_order_release);
+    m_function();
+}
+
+void WorkQueue::initialize()
+{
+    g_high_priority_work_queue = new WorkQueue("WorkQueue (high)");
+    g_work_queue = new WorkQueue("WorkQueue");
+    // Kernel process entry points don't take an argument, so the threads find their queue
+    // through the globals. Don't start them before those are set.
+    g_high_priority_work_queue->spawn([] { g_high_priority_work_queue->run(); }, THREAD_PRIORITY_HIGH);
+    g_work_queue->spawn([] { g_work_queue->run(); }, THREAD_PRIORITY_NORMAL);
+}
+
+WorkQueue::WorkQueue(const char* name)
+    : m_name(name)
+{
+}
+
+void WorkQueue::spawn(void (*entry)(), u32 priority)
+{
+    Thread* thread = nullptr;
+    Process::create_kernel_process(thread, m_name, entry);
+    thread->set_priority(priority);
+}
+
+void WorkQueue::queue(DeferredWork& work)
+{
+    {
+        ScopedSpinLock lock(m_lock);
+        ASSERT(!work.m_next);
+        if (m_tail)
+            m_tail->m_next = &work;
+        else
+            m_head = &work;
+        m_tail = &work;
+    }
+    m_wait_queue.wake_one();
+}
+
+DeferredWork* WorkQueue::dequeue()
+{
+    ScopedSpinLock lock(m_lock);
+    auto* work = m_head;
+    if (!work)
+        return nullptr;
+    m_head = work->m_next;
+    if (!m_head)
+        m_tail = nullptr;
+    work->m_next = nullptr;
+    return work;
+}
+
+void WorkQueue::run()
+{
+    for (;;) {
+        // A wake-up that comes in before we get to wait_on() isn't lost, the queue remembers it.
+        while (auto* work = dequeue())
+            work->run();
+        Thread::current()->wait_on(m_wait_queue, m_name);
+    }
+}
+
+}
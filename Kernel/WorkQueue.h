@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2020, The SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/Atomic.h>
+#include <AK/Function.h>
+#include <Kernel/SpinLock.h>
+#include <Kernel/WaitQueue.h>
+
+namespace Kernel {
+
+// A piece of work an interrupt handler hands off so that it can return quickly.
+// Drivers embed one for each thing they defer. Scheduling it again while it is still
+// pending does nothing, so the function has to pick up everything that has come in since.
+class DeferredWork {
+    AK_MAKE_NONCOPYABLE(DeferredWork);
+    AK_MAKE_NONMOVABLE(DeferredWork);
+
+public:
+    explicit DeferredWork(Function<void()>&& function)
+        : m_function(move(function))
+    {
+    }
+
+    // Runs the work on this processor as soon as the outermost interrupt handler returns,
+    // with interrupts enabled but preemption disabled. The work must not block.
+    void schedule_on_this_processor();
+
+    // Runs the work on a work queue thread, where it may block.
+    void schedule(WorkQueue&);
+
+    bool is_pending() const { return m_pending.load(AK::memory_order_relaxed); }
+
+private:
+    friend class Processor;
+    friend class WorkQueue;
+
+    bool mark_pending() { return !m_pending.exchange(true, AK::memory_order_acq_rel); }
+    void run();
+
+    Function<void()> m_function;
+    Atomic<bool> m_pending { false };
+    DeferredWork* m_next { nullptr };
+};
+
+// A kernel thread that runs deferred work in the order it was queued.
+class WorkQueue {
+    AK_MAKE_NONCOPYABLE(WorkQueue);
+    AK_MAKE_NONMOVABLE(WorkQueue);
+
+public:
+    static void initialize();
+
+    explicit WorkQueue(const char* name);
+
+    // Safe to call from an interrupt handler.
+    void queue(DeferredWork&);
+
+private:
+    void spawn(void (*entry)(), u32 priority);
+    [[noreturn]] void run();
+    DeferredWork* dequeue();
+
+    const char* m_name { nullptr };
+    WaitQueue m_wait_queue;
+    SpinLock<u8> m_lock;
+    DeferredWork* m_head { nullptr };
+    DeferredWork* m_tail { nullptr };
+};
+
+// For work that a user is waiting on, like input and audio.
+extern WorkQueue* g_high_priority_work_queue;
+// For everything else that can't be done in an interrupt handler.
+extern WorkQueue* g_work_queue;
+
+}
@@ -31,6 +31,8 @@
 #include <Kernel/Arch/i386/CPU.h>
 #include <Kernel/CMOS.h>
 #include <Kernel/CommandLine.h>
+#include <Kernel/Devices/AHCIController.h>
+#include <Kernel/Devices/AHCIDiskDevice.h>
 #include <Kernel/Devices/BXVGADevice.h>
 #include <Kernel/Devices/DiskPartition.h>
 #include <Kernel/Devices/EBRPartitionTable.h>
@@ -47,6 +49,7 @@
 #include <Kernel/Devices/SB16.h>
 #include <Kernel/Devices/SerialDevice.h>
 #include <Kernel/Devices/VMWareBackdoor.h>
+#include <Kernel/Devices/VirtIOBlockDevice.h>
 #include <Kernel/Devices/ZeroDevice.h>
 #include <Kernel/FileSystem/Ext2FileSystem.h>
 #include <Kernel/FileSystem/VirtualFileSystem.h>
@@ -61,6 +64,7 @@
 #include <Kernel/Net/LoopbackAdapter.h>
 #include <Kernel/Net/NetworkTask.h>
 #include <Kernel/Net/RTL8139NetworkAdapter.h>
+#include <Kernel/Net/VirtIONetworkAdapter.h>
 #include <Kernel/PCI/Access.h>
 #include <Kernel/PCI/Initializer.h>
 #include <Kernel/Process.h>
@@ -69,10 +73,16 @@
 #include <Kernel/Scheduler.h>
 #include <Kernel/TTY/PTYMultiplexer.h>
 #include <Kernel/TTY/VirtualConsole.h>
+#include <Kernel/Tasks/BlockIOTask.h>
 #include <Kernel/Tasks/FinalizerTask.h>
+#include <Kernel/Tasks/IORingTask.h>
+#include <Kernel/Tasks/MemoryPressureTask.h>
+#include <Kernel/Tasks/PageZeroingTask.h>
 #include <Kernel/Tasks/SyncTask.h>
+#include <Kernel/Tasks/WriteBackTask.h>
 #include <Kernel/Time/TimeManagement.h>
 #include <Kernel/VM/MemoryManager.h>
+#include <Kernel/WorkQueue.h>
 
 // Defined in the linker script
 typedef void (*ctor_func_t)();
@@ -145,6 +155,8 @@ extern "C" [[noreturn]] void init()
     __stack_chk_guard = get_fast_random<u32>();
 
     TimeManagement::initialize();
+    if (APIC::initialized())
+        APIC::the().calibrate_timer();
 
     new NullDevice;
     if (!get_serial_debug())
@@ -212,7 +224,13 @@ void init_stage2()
     }
 
     SyncTask::spawn();
+    WriteBackTask::spawn();
+    BlockIOTask::spawn();
     FinalizerTask::spawn();
+    MemoryPressureTask::spawn();
+    PageZeroingTask::spawn();
+    IORingTask::spawn();
+    WorkQueue::initialize();
 
     PCI::initialize();
 
@@ -244,6 +262,7 @@ void init_stage2()
 
     E1000NetworkAdapter::detect();
     RTL8139NetworkAdapter::detect();
+    VirtIONetworkAdapter::detect();
 
     LoopbackAdapter::the();
 
@@ -260,15 +279,32 @@ void init_stage2()
 
     auto root = kernel_command_line().lookup("root").value_or("/dev/hda");
 
-    if (!root.starts_with("/dev/hda")) {
-        klog() << "init_stage2: root filesystem must be on the first IDE hard drive (/dev/hda)";
+    auto pata0 = PATAChannel::create(PATAChannel::ChannelType::Primary, force_pio);
+    VirtIOBlockDevice::detect();
+    AHCIController::detect();
+
+    RefPtr<BlockDevice> root_disk;
+    StringView root_disk_name;
+    if (root.starts_with("/dev/hda")) {
+        root_disk = pata0->master_device();
+        root_disk_name = "/dev/hda";
+    } else if (root.starts_with("/dev/vda")) {
+        root_disk = VirtIOBlockDevice::device(0);
+        root_disk_name = "/dev/vda";
+    } else if (root.starts_with("/dev/sda")) {
+        root_disk = AHCIController::device(0);
+        root_disk_name = "/dev/sda";
+    } else {
+        klog() << "init_stage2: root filesystem must be on the first IDE hard drive (/dev/hda), virtio disk (/dev/vda) or SATA disk (/dev/sda)";
         Processor::halt();
     }
+    if (!root_disk) {
+        klog() << "init_stage2: couldn't find " << root_disk_name;
+        Processor::halt();
+    }
+    NonnullRefPtr<BlockDevice> root_dev = *root_disk;
 
-    auto pata0 = PATAChannel::create(PATAChannel::ChannelType::Primary, force_pio);
-    NonnullRefPtr<BlockDevice> root_dev = *pata0->master_device();
-
-    root = root.substring(strlen("/dev/hda"), root.length() - strlen("/dev/hda"));
+    root = root.substring(root_disk_name.length(), root.length() - root_disk_name.length());
 
     if (root.length()) {
         auto partition_number = root.to_uint();
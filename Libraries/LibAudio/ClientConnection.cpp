@@ -99,6 +99,38 @@ void ClientConnection::clear_buffer(bool paused)
     send_sync<Messages::AudioServer::ClearBuffer>(paused);
 }
 
+bool ClientConnection::set_up_stream(size_t frame_capacity)
+{
+    if (m_stream)
+        return m_stream->capacity() == frame_capacity;
+    auto stream = StreamRing::create(frame_capacity);
+    if (!stream)
+        return false;
+    stream->shared_buffer().share_with(server_pid());
+    if (!send_sync<Messages::AudioServer::SetUpStream>(stream->shared_buffer().shbuf_id(), frame_capacity)->success())
+        return false;
+    m_stream = move(stream);
+    return true;
+}
+
+size_t ClientConnection::write_to_stream(const Sample* samples, size_t count)
+{
+    ASSERT(m_stream);
+    return m_stream->write(samples, count);
+}
+
+size_t ClientConnection::stream_space_available() const
+{
+    if (!m_stream)
+        return 0;
+    return m_stream->available_to_write();
+}
+
+u32 ClientConnection::get_underrun_count()
+{
+    return send_sync<Messages::AudioServer::GetUnderrunCount>()->underruns();
+}
+
 int ClientConnection::get_playing_buffer()
 {
     return send_sync<Messages::AudioServer::GetPlayingBuffer>()->buffer_id();
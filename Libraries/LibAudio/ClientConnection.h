@@ -28,6 +28,7 @@
 
 #include <AudioServer/AudioClientEndpoint.h>
 #include <AudioServer/AudioServerEndpoint.h>
+#include <LibAudio/StreamRing.h>
 #include <LibIPC/ServerConnection.h>
 
 namespace Audio {
@@ -57,6 +58,13 @@ public:
     void set_paused(bool paused);
     void clear_buffer(bool paused = false);
 
+    // Streaming writes frames straight into a ring the mixer reads from, without a message per buffer.
+    // Pausing applies to the stream as well. Clearing the buffer does not.
+    bool set_up_stream(size_t frame_capacity = 4096);
+    size_t write_to_stream(const Sample*, size_t count);
+    size_t stream_space_available() const;
+    u32 get_underrun_count();
+
     Function<void(i32 buffer_id)> on_finish_playing_buffer;
     Function<void(bool muted)> on_muted_state_change;
     Function<void(int volume)> on_main_mix_volume_change;
@@ -65,6 +73,8 @@ private:
     virtual void handle(const Messages::AudioClient::FinishedPlayingBuffer&) override;
     virtual void handle(const Messages::AudioClient::MutedStateChanged&) override;
     virtual void handle(const Messages::AudioClient::MainMixVolumeChanged&) override;
+
+    RefPtr<StreamRing> m_stream;
 };
 
 }
@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2018-2020, The SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/Atomic.h>
+#include <AK/RefCounted.h>
+#include <AK/SharedBuffer.h>
+#include <AK/StdLibExtras.h>
+#include <LibAudio/Buffer.h>
+
+namespace Audio {
+
+// A single-producer, single-consumer ring of stereo frames in shared memory, so a client can stream to
+// AudioServer without a round trip per buffer. The client only ever moves the write index and the mixer
+// only the read index, so neither side takes a lock or waits for the other.
+// Frames are stored as interleaved left/right floats, which is what the mixer works with.
+class StreamRing : public RefCounted<StreamRing> {
+public:
+    struct Header {
+        // Frames written and read so far. These wrap around, only their difference matters.
+        alignas(64) Atomic<u32> write_index;
+        alignas(64) Atomic<u32> read_index;
+    };
+
+    static constexpr size_t min_capacity = 256;
+    static constexpr size_t max_capacity = 64 * KB;
+
+    static bool is_valid_capacity(size_t frame_capacity)
+    {
+        return frame_capacity >= min_capacity && frame_capacity <= max_capacity && !(frame_capacity & (frame_capacity - 1));
+    }
+
+    static size_t buffer_size_for_capacity(size_t frame_capacity)
+    {
+        return sizeof(Header) + frame_capacity * 2 * sizeof(float);
+    }
+
+    static RefPtr<StreamRing> create(size_t frame_capacity)
+    {
+        if (!is_valid_capacity(frame_capacity))
+            return nullptr;
+        auto buffer = SharedBuffer::create_with_size(buffer_size_for_capacity(frame_capacity));
+        if (!buffer)
+            return nullptr;
+        return adopt(*new StreamRing(buffer.release_nonnull(), frame_capacity));
+    }
+
+    // For the mixer side. The capacity comes from the client, so check it against what was actually shared.
+    static RefPtr<StreamRing> create_with_shared_buffer(NonnullRefPtr<SharedBuffer>&& buffer, size_t frame_capacity)
+    {
+        if (!is_valid_capacity(frame_capacity) || (size_t)buffer->size() < buffer_size_for_capacity(frame_capacity))
+            return nullptr;
+        return adopt(*new StreamRing(move(buffer), frame_capacity));
+    }
+
+    SharedBuffer& shared_buffer() { return *m_buffer; }
+    size_t capacity() const { return m_capacity; }
+
+    // Producer side.
+    size_t available_to_write() const
+    {
+        u32 used = header().write_index.load(AK::memory_order_relaxed) - header().read_index.load(AK::memory_order_acquire);
+        return used >= m_capacity ? 0 : m_capacity - used;
+    }
+
+    size_t write(const Sample* samples, size_t count)
+    {
+        count = min(count, available_to_write());
+        u32 write_index = header().write_index.load(AK::memory_order_relaxed);
+        for (size_t i = 0; i < count; ++i) {
+            float* frame = frames() + ((write_index + i) & (m_capacity - 1)) * 2;
+            frame[0] = samples[i].left;
+            frame[1] = samples[i].right;
+        }
+        header().write_index.store(write_index + count, AK::memory_order_release);
+        return count;
+    }
+
+    // Consumer side. Hands up to max_frames to the callback, in at most two contiguous runs, and marks them read.
+    template<typename Callback>
+    size_t read(size_t max_frames, Callback callback)
+    {
+        u32 read_index = header().read_index.load(AK::memory_order_relaxed);
+        u32 available = header().write_index.load(AK::memory_order_acquire) - read_index;
+        // The other side can put anything into shared memory, so never go by more than our own capacity.
+        size_t count = min(min<size_t>(available, m_capacity), max_frames);
+        for (size_t done = 0; done < count;) {
+            size_t offset = (read_index + done) & (m_capacity - 1);
+            size_t run = min(count - done, m_capacity - offset);
+            callback(const_cast<const float*>(frames() + offset * 2), run);
+            done += run;
+        }
+        header().read_index.store(read_index + count, AK::memory_order_release);
+        return count;
+    }
+
+private:
+    StreamRing(NonnullRefPtr<SharedBuffer>&& buffer, size_t frame_capacity)
+        : m_buffer(move(buffer))
+        , m_capacity(frame_capacity)
+    {
+    }
+
+    Header& header() { return *reinterpret_cast<Header*>(m_buffer->data()); }
+    const Header& header() const { return *reinterpret_cast<const Header*>(m_buffer->data()); }
+    float* frames() { return reinterpret_cast<float*>(reinterpret_cast<u8*>(m_buffer->data()) + sizeof(Header)); }
+
+    NonnullRefPtr<SharedBuffer> m_buffer;
+    size_t m_capacity { 0 };
+};
+
+}
@@ -33,7 +33,6 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <sys/stat.h>
 #include <unistd.h>
 
 extern "C" {
@@ -88,28 +87,25 @@ static void create_struct_dirent(sys_dirent* sys_ent, struct dirent* str_ent)
     str_ent->d_name[sys_ent->namelen] = '\0';
 }
 
-static int allocate_dirp_buffer(DIR* dirp)
+// Directory entries are fetched from the kernel in batches of as many as fit in this.
+static const size_t dirp_buffer_size = 32 * KB;
+
+// Makes sure there's an entry at dirp->nextptr, fetching the next batch of them if needed.
+// Returns an errno value, or 0 (with an empty buffer at the end of the directory).
+static int fill_dirp_buffer(DIR* dirp)
 {
-    if (dirp->buffer) {
+    if (dirp->buffer && dirp->nextptr < dirp->buffer + dirp->buffer_size)
         return 0;
-    }
 
-    struct stat st;
-    // preserve errno since this could be a reentrant call
-    int old_errno = errno;
-    int rc = fstat(dirp->fd, &st);
-    if (rc < 0) {
-        int new_errno = errno;
-        errno = old_errno;
-        return new_errno;
+    if (!dirp->buffer) {
+        dirp->buffer = (char*)malloc(dirp_buffer_size);
+        if (!dirp->buffer)
+            return ENOMEM;
     }
-    size_t size_to_allocate = max(st.st_size, static_cast<off_t>(4096));
-    dirp->buffer = (char*)malloc(size_to_allocate);
-    ssize_t nread = syscall(SC_get_dir_entries, dirp->fd, dirp->buffer, size_to_allocate);
+    ssize_t nread = syscall(SC_get_dir_entries, dirp->fd, dirp->buffer, dirp_buffer_size);
     if (nread < 0) {
-        // uh-oh, the syscall returned an error
-        free(dirp->buffer);
-        dirp->buffer = nullptr;
+        dirp->buffer_size = 0;
+        dirp->nextptr = dirp->buffer;
         return -nread;
     }
     dirp->buffer_size = nread;
@@ -124,7 +120,7 @@ dirent* readdir(DIR* dirp)
     if (dirp->fd == -1)
         return nullptr;
 
-    if (int new_errno = allocate_dirp_buffer(dirp)) {
+    if (int new_errno = fill_dirp_buffer(dirp)) {
         // readdir is allowed to mutate errno
         errno = new_errno;
         return nullptr;
@@ -140,16 +136,6 @@ dirent* readdir(DIR* dirp)
     return &dirp->cur_ent;
 }
 
-static bool compare_sys_struct_dirent(sys_dirent* sys_ent, struct dirent* str_ent)
-{
-    size_t namelen = min((size_t)256, sys_ent->namelen);
-    // These fields are guaranteed by create_struct_dirent to be the same
-    return sys_ent->ino == str_ent->d_ino
-        && sys_ent->file_type == str_ent->d_type
-        && sys_ent->total_size() == str_ent->d_reclen
-        && strncmp(sys_ent->name, str_ent->d_name, namelen) == 0;
-}
-
 int readdir_r(DIR* dirp, struct dirent* entry, struct dirent** result)
 {
     if (!dirp || dirp->fd == -1) {
@@ -157,39 +143,21 @@ int readdir_r(DIR* dirp, struct dirent* entry, struct dirent** result)
         return EBADF;
     }
 
-    if (int new_errno = allocate_dirp_buffer(dirp)) {
+    if (int new_errno = fill_dirp_buffer(dirp)) {
         *result = nullptr;
         return new_errno;
     }
 
-    // This doesn't care about dirp state; seek until we find the entry.
-    // Unfortunately, we can't just compare struct dirent to sys_dirent, so
-    // manually compare the fields. This seems a bit risky, but could work.
-    auto* buffer = dirp->buffer;
-    auto* sys_ent = (sys_dirent*)buffer;
-    bool found = false;
-    while (!(found || buffer >= dirp->buffer + dirp->buffer_size)) {
-        found = compare_sys_struct_dirent(sys_ent, entry);
-
-        // Make sure if we found one, it's the one after (end of buffer or not)
-        buffer += sys_ent->total_size();
-        sys_ent = (sys_dirent*)buffer;
-    }
-
-    // If we found one, but hit end of buffer, then EOD
-    if (found && buffer >= dirp->buffer + dirp->buffer_size) {
+    if (dirp->nextptr >= (dirp->buffer + dirp->buffer_size)) {
         *result = nullptr;
         return 0;
     }
-    // If we never found a match for entry in buffer, start from the beginning
-    else if (!found) {
-        buffer = dirp->buffer;
-        sys_ent = (sys_dirent*)buffer;
-    }
 
-    *result = entry;
+    auto* sys_ent = (sys_dirent*)dirp->nextptr;
     create_struct_dirent(sys_ent, entry);
 
+    dirp->nextptr += sys_ent->total_size();
+    *result = entry;
     return 0;
 }
 
@@ -37,6 +37,8 @@ __BEGIN_DECLS
 #define F_GETFL 3
 #define F_SETFL 4
 #define F_ISTTY 5
+#define F_SETPIPE_SZ 8
+#define F_GETPIPE_SZ 9
 
 #define FD_CLOEXEC 1
 
@@ -88,6 +90,7 @@ int open(const char* path, int options, ...);
 int creat_with_path_length(const char* path, size_t path_length, mode_t);
 int open_with_path_length(const char* path, size_t path_length, int options, mode_t);
 #define AT_FDCWD -100
+#define AT_SYMLINK_NOFOLLOW 0x100
 int openat(int dirfd, const char* path, int options, ...);
 int openat_with_path_length(int dirfd, const char* path, size_t path_length, int options, mode_t);
 
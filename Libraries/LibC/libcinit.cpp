@@ -37,6 +37,7 @@ bool __environ_is_malloced;
 
 void __libc_init()
 {
+    __string_init();
     __malloc_init();
     __stdio_init();
 }
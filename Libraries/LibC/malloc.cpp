@@ -27,7 +27,6 @@
 #include <AK/Bitmap.h>
 #include <AK/InlineLinkedList.h>
 #include <AK/ScopedValueRollback.h>
-#include <AK/Vector.h>
 #include <LibThread/Lock.h>
 #include <assert.h>
 #include <mallocdefs.h>
@@ -64,18 +63,40 @@ static LibThread::Lock& malloc_lock()
 }
 
 constexpr size_t number_of_chunked_blocks_to_keep_around_per_size_class = 4;
-constexpr size_t number_of_big_blocks_to_keep_around_per_size_class = 8;
+
+// Recycled big allocations are kept per power-of-two size, from 128 KiB to 1 MiB. How many blocks a size keeps
+// around grows every time it had to go to the kernel, up to a limit, and all of them share a byte budget.
+constexpr size_t number_of_big_allocators = 4;
+constexpr size_t initial_number_of_big_blocks_to_keep_around = 2;
+constexpr size_t max_number_of_big_blocks_to_keep_around = 32;
+constexpr size_t max_bytes_in_big_blocks_kept_around = 16 * MB;
+
+// Each thread keeps a few free chunks of the smaller size classes to itself, so most malloc() and free()
+// calls never touch malloc_lock(). Chunks move between a thread cache and the shared blocks in batches.
+constexpr size_t thread_cache_max_chunk_size = 1024;
+constexpr size_t thread_cache_batch_size = 32;
+constexpr size_t thread_cache_max_chunks = 2 * thread_cache_batch_size;
 
 static bool s_log_malloc = false;
 static bool s_scrub_malloc = true;
 static bool s_scrub_free = true;
 static bool s_profiling = false;
-static unsigned short size_classes[] = { 8, 16, 32, 64, 128, 252, 508, 1016, 2036, 4090, 8188, 16376, 32756, 0 };
+// Two size classes per power of two. From 2 KiB on, each class is stretched to fill its (64 KiB) block
+// with as many chunks as it could hold anyway, so the largest one takes up a whole block by itself.
+static unsigned short size_classes[] = { 8, 16, 24, 32, 48, 64, 96, 128, 192, 256, 384, 512, 768, 1024, 1536, 2112, 3112, 4360, 6544, 9352, 13096, 21832, 65504, 0 };
 static constexpr size_t num_size_classes = sizeof(size_classes) / sizeof(unsigned short);
 
 constexpr size_t block_size = 64 * KB;
 constexpr size_t block_mask = ~(block_size - 1);
 
+// Size classes up to 1 KiB are all multiples of 8, and the larger ones are more than 256 bytes apart,
+// so two small tables are enough to find the class for any size without searching.
+constexpr size_t small_size_class_limit = 1024;
+constexpr size_t small_size_class_granularity = 8;
+constexpr size_t large_size_class_granularity = 256;
+static u8 s_small_size_class_index[small_size_class_limit / small_size_class_granularity];
+static u8 s_large_size_class_index[block_size / large_size_class_granularity];
+
 struct CommonHeader {
     size_t m_magic;
     size_t m_size;
@@ -130,6 +151,8 @@ struct ChunkedBlock
     size_t chunk_capacity() const { return (block_size - sizeof(ChunkedBlock)) / m_size; }
 };
 
+static_assert(sizeof(ChunkedBlock) + 65504 <= block_size, "The largest size class must fit in a block");
+
 struct Allocator {
     size_t size { 0 };
     size_t block_count { 0 };
@@ -139,10 +162,22 @@ struct Allocator {
     InlineLinkedList<ChunkedBlock> full_blocks;
 };
 
+struct ThreadCache {
+    FreelistEntry* chunks { nullptr };
+    size_t chunk_count { 0 };
+};
+
 struct BigAllocator {
-    Vector<BigAllocationBlock*, number_of_big_blocks_to_keep_around_per_size_class> blocks;
+    size_t size { 0 };
+    size_t keep_count { initial_number_of_big_blocks_to_keep_around };
+    size_t block_count { 0 };
+    BigAllocationBlock* blocks[max_number_of_big_blocks_to_keep_around] { nullptr };
+    size_t hits { 0 };
+    size_t misses { 0 };
 };
 
+static size_t s_bytes_in_big_blocks_kept_around;
+
 // Allocators will be initialized in __malloc_init.
 // We can not rely on global constructors to initialize them,
 // because they must be initialized before other global constructors
@@ -150,34 +185,59 @@ struct BigAllocator {
 // them. We could have used AK::NeverDestoyed to prevent the latter,
 // but it would have not helped with the former.
 static u8 g_allocators_storage[sizeof(Allocator) * num_size_classes];
-static u8 g_big_allocators_storage[sizeof(BigAllocator)];
+static u8 g_big_allocators_storage[sizeof(BigAllocator) * number_of_big_allocators];
 
 static inline Allocator (&allocators())[num_size_classes]
 {
     return reinterpret_cast<Allocator(&)[num_size_classes]>(g_allocators_storage);
 }
 
-static inline BigAllocator (&big_allocators())[1]
+static size_t num_thread_cached_size_classes()
 {
-    return reinterpret_cast<BigAllocator(&)[1]>(g_big_allocators_storage);
+    size_t count = 0;
+    while (size_classes[count] && size_classes[count] <= thread_cache_max_chunk_size)
+        ++count;
+    return count;
+}
+
+// Zero-initialized for every new thread.
+static __thread ThreadCache t_thread_caches[num_size_classes];
+
+static ThreadCache* thread_cache_for(const Allocator& allocator)
+{
+    if (allocator.size > thread_cache_max_chunk_size)
+        return nullptr;
+    return &t_thread_caches[&allocator - allocators()];
+}
+
+static inline BigAllocator (&big_allocators())[number_of_big_allocators]
+{
+    return reinterpret_cast<BigAllocator(&)[number_of_big_allocators]>(g_big_allocators_storage);
 }
 
 static Allocator* allocator_for_size(size_t size, size_t& good_size)
 {
-    for (size_t i = 0; size_classes[i]; ++i) {
-        if (size <= size_classes[i]) {
-            good_size = size_classes[i];
-            return &allocators()[i];
-        }
+    size_t index;
+    if (size <= small_size_class_limit) {
+        index = s_small_size_class_index[(size - 1) / small_size_class_granularity];
+    } else if (size <= size_classes[num_size_classes - 2]) {
+        index = s_large_size_class_index[(size - 1) / large_size_class_granularity];
+        if (size > size_classes[index])
+            ++index;
+    } else {
+        good_size = PAGE_ROUND_UP(size);
+        return nullptr;
     }
-    good_size = PAGE_ROUND_UP(size);
-    return nullptr;
+    good_size = size_classes[index];
+    return &allocators()[index];
 }
 
 static BigAllocator* big_allocator_for_size(size_t size)
 {
-    if (size == 65536)
-        return &big_allocators()[0];
+    for (auto& allocator : big_allocators()) {
+        if (allocator.size == size)
+            return &allocator;
+    }
     return nullptr;
 }
 
@@ -196,10 +256,85 @@ static void os_free(void* ptr, size_t size)
     assert(rc == 0);
 }
 
-static void* malloc_impl(size_t size)
+static ChunkedBlock* usable_block_for(Allocator& allocator, size_t good_size)
 {
-    LOCKER(malloc_lock());
+    ChunkedBlock* block = nullptr;
+
+    for (block = allocator.usable_blocks.head(); block; block = block->next()) {
+        if (block->free_chunks())
+            return block;
+    }
+
+    if (allocator.empty_block_count) {
+        block = allocator.empty_blocks[--allocator.empty_block_count];
+        int rc = madvise(block, block_size, MADV_SET_NONVOLATILE);
+        bool this_block_was_purged = rc == 1;
+        if (rc < 0) {
+            perror("madvise");
+            ASSERT_NOT_REACHED();
+        }
+        rc = mprotect(block, block_size, PROT_READ | PROT_WRITE);
+        if (rc < 0) {
+            perror("mprotect");
+            ASSERT_NOT_REACHED();
+        }
+        if (this_block_was_purged)
+            new (block) ChunkedBlock(good_size);
+        allocator.usable_blocks.append(block);
+        return block;
+    }
+
+    char buffer[64];
+    snprintf(buffer, sizeof(buffer), "malloc: ChunkedBlock(%zu)", good_size);
+    block = (ChunkedBlock*)os_alloc(block_size, buffer);
+    new (block) ChunkedBlock(good_size);
+    allocator.usable_blocks.append(block);
+    ++allocator.block_count;
+    return block;
+}
+
+static void* take_chunk(Allocator& allocator, ChunkedBlock& block)
+{
+    --block.m_free_chunks;
+    void* ptr = block.m_freelist;
+    block.m_freelist = block.m_freelist->next;
+    if (block.is_full()) {
+#ifdef MALLOC_DEBUG
+        dbgprintf("Block %p is now full in size class %zu\n", &block, allocator.size);
+#endif
+        allocator.usable_blocks.remove(&block);
+        allocator.full_blocks.append(&block);
+    }
+#ifdef MALLOC_DEBUG
+    dbgprintf("LibC: allocated %p (chunk in block %p, size %zu)\n", ptr, &block, block.bytes_per_chunk());
+#endif
+    return ptr;
+}
 
+// Moves a batch of free chunks from the shared blocks into this thread's cache. Called with malloc_lock() held.
+static void refill_thread_cache(ThreadCache& cache, Allocator& allocator, size_t good_size)
+{
+    while (cache.chunk_count < thread_cache_batch_size) {
+        auto* block = usable_block_for(allocator, good_size);
+        while (block->free_chunks() && cache.chunk_count < thread_cache_batch_size) {
+            auto* entry = (FreelistEntry*)take_chunk(allocator, *block);
+            entry->next = cache.chunks;
+            cache.chunks = entry;
+            ++cache.chunk_count;
+        }
+    }
+}
+
+static void* take_cached_chunk(ThreadCache& cache)
+{
+    auto* entry = cache.chunks;
+    cache.chunks = entry->next;
+    --cache.chunk_count;
+    return entry;
+}
+
+static void* malloc_impl(size_t size)
+{
     if (s_log_malloc)
         dbgprintf("LibC: malloc(%zu)\n", size);
 
@@ -209,12 +344,30 @@ static void* malloc_impl(size_t size)
     size_t good_size;
     auto* allocator = allocator_for_size(size, good_size);
 
+    if (allocator) {
+        if (auto* cache = thread_cache_for(*allocator)) {
+            if (!cache->chunk_count) {
+                LOCKER(malloc_lock());
+                refill_thread_cache(*cache, *allocator, good_size);
+            }
+            void* ptr = take_cached_chunk(*cache);
+            if (s_scrub_malloc)
+                memset(ptr, MALLOC_SCRUB_BYTE, good_size);
+            ue_notify_malloc(ptr, size);
+            return ptr;
+        }
+    }
+
+    LOCKER(malloc_lock());
+
     if (!allocator) {
         size_t real_size = round_up_to_power_of_two(sizeof(BigAllocationBlock) + size, block_size);
 #ifdef RECYCLE_BIG_ALLOCATIONS
         if (auto* allocator = big_allocator_for_size(real_size)) {
-            if (!allocator->blocks.is_empty()) {
-                auto* block = allocator->blocks.take_last();
+            if (allocator->block_count) {
+                auto* block = allocator->blocks[--allocator->block_count];
+                s_bytes_in_big_blocks_kept_around -= real_size;
+                ++allocator->hits;
                 int rc = madvise(block, real_size, MADV_SET_NONVOLATILE);
                 bool this_block_was_purged = rc == 1;
                 if (rc < 0) {
@@ -231,6 +384,10 @@ static void* malloc_impl(size_t size)
                 ue_notify_malloc(&block->m_slot[0], size);
                 return &block->m_slot[0];
             }
+            // We had to go to the kernel, so hang on to more of these next time.
+            ++allocator->misses;
+            if (allocator->keep_count < max_number_of_big_blocks_to_keep_around)
+                ++allocator->keep_count;
         }
 #endif
         auto* block = (BigAllocationBlock*)os_alloc(real_size, "malloc: BigAllocationBlock");
@@ -239,59 +396,68 @@ static void* malloc_impl(size_t size)
         return &block->m_slot[0];
     }
 
-    ChunkedBlock* block = nullptr;
+    auto* block = usable_block_for(*allocator, good_size);
+    void* ptr = take_chunk(*allocator, *block);
 
-    for (block = allocator->usable_blocks.head(); block; block = block->next()) {
-        if (block->free_chunks())
-            break;
-    }
+    if (s_scrub_malloc)
+        memset(ptr, MALLOC_SCRUB_BYTE, block->m_size);
 
-    if (!block && allocator->empty_block_count) {
-        block = allocator->empty_blocks[--allocator->empty_block_count];
-        int rc = madvise(block, block_size, MADV_SET_NONVOLATILE);
-        bool this_block_was_purged = rc == 1;
-        if (rc < 0) {
-            perror("madvise");
-            ASSERT_NOT_REACHED();
-        }
-        rc = mprotect(block, block_size, PROT_READ | PROT_WRITE);
-        if (rc < 0) {
-            perror("mprotect");
-            ASSERT_NOT_REACHED();
-        }
-        if (this_block_was_purged)
-            new (block) ChunkedBlock(good_size);
-        allocator->usable_blocks.append(block);
-    }
+    ue_notify_malloc(ptr, size);
+    return ptr;
+}
 
-    if (!block) {
-        char buffer[64];
-        snprintf(buffer, sizeof(buffer), "malloc: ChunkedBlock(%zu)", good_size);
-        block = (ChunkedBlock*)os_alloc(block_size, buffer);
-        new (block) ChunkedBlock(good_size);
-        allocator->usable_blocks.append(block);
-        ++allocator->block_count;
-    }
+// Puts a chunk back into its block. Called with malloc_lock() held.
+static void return_chunk(ChunkedBlock* block, void* ptr)
+{
+#ifdef MALLOC_DEBUG
+    dbgprintf("LibC: freeing %p in allocator %p (size=%u, used=%u)\n", ptr, block, block->bytes_per_chunk(), block->used_chunks());
+#endif
+
+    auto* entry = (FreelistEntry*)ptr;
+    entry->next = block->m_freelist;
+    block->m_freelist = entry;
 
-    --block->m_free_chunks;
-    void* ptr = block->m_freelist;
-    block->m_freelist = block->m_freelist->next;
     if (block->is_full()) {
+        size_t good_size;
+        auto* allocator = allocator_for_size(block->m_size, good_size);
 #ifdef MALLOC_DEBUG
-        dbgprintf("Block %p is now full in size class %zu\n", block, good_size);
+        dbgprintf("Block %p no longer full in size class %u\n", block, good_size);
 #endif
-        allocator->usable_blocks.remove(block);
-        allocator->full_blocks.append(block);
+        allocator->full_blocks.remove(block);
+        allocator->usable_blocks.prepend(block);
     }
+
+    ++block->m_free_chunks;
+
+    if (!block->used_chunks()) {
+        size_t good_size;
+        auto* allocator = allocator_for_size(block->m_size, good_size);
+        if (allocator->block_count < number_of_chunked_blocks_to_keep_around_per_size_class) {
 #ifdef MALLOC_DEBUG
-    dbgprintf("LibC: allocated %p (chunk in block %p, size %zu)\n", ptr, block, block->bytes_per_chunk());
+            dbgprintf("Keeping block %p around for size class %u\n", block, good_size);
 #endif
+            allocator->usable_blocks.remove(block);
+            allocator->empty_blocks[allocator->empty_block_count++] = block;
+            mprotect(block, block_size, PROT_NONE);
+            madvise(block, block_size, MADV_SET_VOLATILE);
+            return;
+        }
+#ifdef MALLOC_DEBUG
+        dbgprintf("Releasing block %p for size class %u\n", block, good_size);
+#endif
+        allocator->usable_blocks.remove(block);
+        --allocator->block_count;
+        os_free(block, block_size);
+    }
+}
 
-    if (s_scrub_malloc)
-        memset(ptr, MALLOC_SCRUB_BYTE, block->m_size);
-
-    ue_notify_malloc(ptr, size);
-    return ptr;
+// Returns up to chunk_count chunks from this thread's cache to their blocks. Called with malloc_lock() held.
+static void flush_thread_cache(ThreadCache& cache, size_t chunk_count)
+{
+    for (; chunk_count && cache.chunk_count; --chunk_count) {
+        void* ptr = take_cached_chunk(cache);
+        return_chunk((ChunkedBlock*)((FlatPtr)ptr & block_mask), ptr);
+    }
 }
 
 static void free_impl(void* ptr)
@@ -301,18 +467,19 @@ static void free_impl(void* ptr)
     if (!ptr)
         return;
 
-    LOCKER(malloc_lock());
-
     void* block_base = (void*)((FlatPtr)ptr & block_mask);
     size_t magic = *(size_t*)block_base;
 
     if (magic == MAGIC_BIGALLOC_HEADER) {
+        LOCKER(malloc_lock());
         auto* block = (BigAllocationBlock*)block_base;
 #ifdef RECYCLE_BIG_ALLOCATIONS
         if (auto* allocator = big_allocator_for_size(block->m_size)) {
-            if (allocator->blocks.size() < number_of_big_blocks_to_keep_around_per_size_class) {
-                allocator->blocks.append(block);
-                size_t this_block_size = block->m_size;
+            size_t this_block_size = block->m_size;
+            if (allocator->block_count < allocator->keep_count
+                && s_bytes_in_big_blocks_kept_around + this_block_size <= max_bytes_in_big_blocks_kept_around) {
+                allocator->blocks[allocator->block_count++] = block;
+                s_bytes_in_big_blocks_kept_around += this_block_size;
                 if (mprotect(block, this_block_size, PROT_NONE) < 0) {
                     perror("mprotect");
                     ASSERT_NOT_REACHED();
@@ -332,49 +499,26 @@ static void free_impl(void* ptr)
     assert(magic == MAGIC_PAGE_HEADER);
     auto* block = (ChunkedBlock*)block_base;
 
-#ifdef MALLOC_DEBUG
-    dbgprintf("LibC: freeing %p in allocator %p (size=%u, used=%u)\n", ptr, block, block->bytes_per_chunk(), block->used_chunks());
-#endif
-
+    // The block can't go away under us, since it still counts the chunk we're freeing as used.
     if (s_scrub_free)
         memset(ptr, FREE_SCRUB_BYTE, block->bytes_per_chunk());
 
-    auto* entry = (FreelistEntry*)ptr;
-    entry->next = block->m_freelist;
-    block->m_freelist = entry;
-
-    if (block->is_full()) {
-        size_t good_size;
-        auto* allocator = allocator_for_size(block->m_size, good_size);
-#ifdef MALLOC_DEBUG
-        dbgprintf("Block %p no longer full in size class %u\n", block, good_size);
-#endif
-        allocator->full_blocks.remove(block);
-        allocator->usable_blocks.prepend(block);
-    }
-
-    ++block->m_free_chunks;
-
-    if (!block->used_chunks()) {
-        size_t good_size;
-        auto* allocator = allocator_for_size(block->m_size, good_size);
-        if (allocator->block_count < number_of_chunked_blocks_to_keep_around_per_size_class) {
-#ifdef MALLOC_DEBUG
-            dbgprintf("Keeping block %p around for size class %u\n", block, good_size);
-#endif
-            allocator->usable_blocks.remove(block);
-            allocator->empty_blocks[allocator->empty_block_count++] = block;
-            mprotect(block, block_size, PROT_NONE);
-            madvise(block, block_size, MADV_SET_VOLATILE);
-            return;
+    size_t good_size;
+    auto* allocator = allocator_for_size(block->m_size, good_size);
+    if (auto* cache = thread_cache_for(*allocator)) {
+        if (cache->chunk_count == thread_cache_max_chunks) {
+            LOCKER(malloc_lock());
+            flush_thread_cache(*cache, thread_cache_batch_size);
         }
-#ifdef MALLOC_DEBUG
-        dbgprintf("Releasing block %p for size class %u\n", block, good_size);
-#endif
-        allocator->usable_blocks.remove(block);
-        --allocator->block_count;
-        os_free(block, block_size);
+        auto* entry = (FreelistEntry*)ptr;
+        entry->next = cache->chunks;
+        cache->chunks = entry;
+        ++cache->chunk_count;
+        return;
     }
+
+    LOCKER(malloc_lock());
+    return_chunk(block, ptr);
 }
 
 [[gnu::flatten]] void* malloc(size_t size)
@@ -428,6 +572,13 @@ void* realloc(void* ptr, size_t size)
     return new_ptr;
 }
 
+void __malloc_thread_exit()
+{
+    LOCKER(malloc_lock());
+    for (size_t i = 0; i < num_thread_cached_size_classes(); ++i)
+        flush_thread_cache(t_thread_caches[i], t_thread_caches[i].chunk_count);
+}
+
 void __malloc_init()
 {
     new (&malloc_lock()) LibThread::Lock();
@@ -445,6 +596,69 @@ void __malloc_init()
         allocators()[i].size = size_classes[i];
     }
 
-    new (&big_allocators()[0])(BigAllocator);
+    size_t index = 0;
+    for (size_t i = 0; i < sizeof(s_small_size_class_index); ++i) {
+        while (size_classes[index] < (i + 1) * small_size_class_granularity)
+            ++index;
+        s_small_size_class_index[i] = index;
+    }
+    for (size_t i = small_size_class_limit / large_size_class_granularity; i < sizeof(s_large_size_class_index); ++i) {
+        // The smallest class that fits the smallest size in this slot. Bigger sizes may need the next one.
+        while (size_classes[index] && size_classes[index] < i * large_size_class_granularity + 1)
+            ++index;
+        s_large_size_class_index[i] = index;
+    }
+
+    for (size_t i = 0; i < number_of_big_allocators; ++i) {
+        new (&big_allocators()[i])(BigAllocator);
+        big_allocators()[i].size = (2 * block_size) << i;
+    }
+}
+
+void malloc_stats()
+{
+    struct SizeClassStats {
+        size_t block_count;
+        size_t empty_block_count;
+        size_t used_chunks;
+        size_t free_chunks;
+    };
+    SizeClassStats stats[num_size_classes - 1] {};
+    BigAllocator big_stats[number_of_big_allocators];
+    size_t big_bytes_kept_around;
+
+    // Gather everything first, printing may need to allocate.
+    {
+        LOCKER(malloc_lock());
+        for (size_t i = 0; i < num_size_classes - 1; ++i) {
+            auto& allocator = allocators()[i];
+            stats[i].block_count = allocator.block_count;
+            stats[i].empty_block_count = allocator.empty_block_count;
+            for (auto* block = allocator.usable_blocks.head(); block; block = block->next()) {
+                stats[i].used_chunks += block->used_chunks();
+                stats[i].free_chunks += block->free_chunks();
+            }
+            for (auto* block = allocator.full_blocks.head(); block; block = block->next())
+                stats[i].used_chunks += block->used_chunks();
+        }
+        memcpy(big_stats, big_allocators(), sizeof(big_stats));
+        big_bytes_kept_around = s_bytes_in_big_blocks_kept_around;
+    }
+
+    // Chunks sitting in thread caches count as used, since only their thread can hand them out.
+    fprintf(stderr, "size class  blocks  empty     used chunks     free chunks  fragmentation\n");
+    for (size_t i = 0; i < num_size_classes - 1; ++i) {
+        auto& stat = stats[i];
+        if (!stat.block_count && !stat.empty_block_count)
+            continue;
+        size_t total_chunks = stat.used_chunks + stat.free_chunks;
+        fprintf(stderr, "%10u  %6zu  %5zu  %14zu  %14zu  %12zu%%\n",
+            size_classes[i], stat.block_count, stat.empty_block_count, stat.used_chunks, stat.free_chunks,
+            total_chunks ? stat.free_chunks * 100 / total_chunks : 0);
+    }
+    fprintf(stderr, "big block size  kept  keep limit     hits   misses\n");
+    for (auto& allocator : big_stats)
+        fprintf(stderr, "%14zu  %4zu  %10zu  %7zu  %7zu\n", allocator.size, allocator.block_count, allocator.keep_count, allocator.hits, allocator.misses);
+    fprintf(stderr, "%zu bytes in big blocks kept around\n", big_bytes_kept_around);
 }
 }
@@ -37,6 +37,7 @@
 #define MAP_ANON MAP_ANONYMOUS
 #define MAP_STACK 0x40
 #define MAP_PURGEABLE 0x80
+#define MAP_POPULATE 0x100
 
 #define PROT_READ 0x1
 #define PROT_WRITE 0x2
@@ -45,6 +46,12 @@
 
 #define MAP_FAILED ((void*)-1)
 
+#define MADV_NORMAL 0x0
+#define MADV_RANDOM 0x1
+#define MADV_SEQUENTIAL 0x2
+#define MADV_WILLNEED 0x3
+#define MADV_DONTNEED 0x4
+#define MADV_FREE 0x8
 #define MADV_SET_VOLATILE 0x100
 #define MADV_SET_NONVOLATILE 0x200
 #define MADV_GET_VOLATILE 0x400
@@ -89,7 +89,7 @@ void qsort(void* bot, size_t nmemb, size_t size, int (*compar)(const void*, cons
 
     SizedObjectSlice slice { bot, nmemb, size };
 
-    AK::dual_pivot_quick_sort(slice, 0, nmemb - 1, [=](const SizedObject& a, const SizedObject& b) { return compar(a.data(), b.data()) < 0; });
+    AK::quick_sort(slice, 0, nmemb, [=](const SizedObject& a, const SizedObject& b) { return compar(a.data(), b.data()) < 0; });
 }
 
 void qsort_r(void* bot, size_t nmemb, size_t size, int (*compar)(const void*, const void*, void*), void* arg)
@@ -100,5 +100,5 @@ void qsort_r(void* bot, size_t nmemb, size_t size, int (*compar)(const void*, co
 
     SizedObjectSlice slice { bot, nmemb, size };
 
-    AK::dual_pivot_quick_sort(slice, 0, nmemb - 1, [=](const SizedObject& a, const SizedObject& b) { return compar(a.data(), b.data(), arg) < 0; });
+    AK::quick_sort(slice, 0, nmemb, [=](const SizedObject& a, const SizedObject& b) { return compar(a.data(), b.data(), arg) < 0; });
 }
@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <sys/cdefs.h>
+#include <sys/types.h>
+
+__BEGIN_DECLS
+
+// These are implemented in LibRegex, so programs using them need to link with -lregex.
+
+typedef ssize_t regoff_t;
+
+typedef struct {
+    size_t re_nsub;
+    void* __data;
+} regex_t;
+
+typedef struct {
+    regoff_t rm_so;
+    regoff_t rm_eo;
+} regmatch_t;
+
+#define REG_EXTENDED 1
+#define REG_ICASE 2
+#define REG_NOSUB 4
+#define REG_NEWLINE 8
+
+#define REG_NOTBOL 1
+#define REG_NOTEOL 2
+
+enum {
+    REG_NOERROR = 0,
+    REG_NOMATCH,
+    REG_BADPAT,
+    REG_ECOLLATE,
+    REG_ECTYPE,
+    REG_EESCAPE,
+    REG_ESUBREG,
+    REG_EBRACK,
+    REG_EPAREN,
+    REG_EBRACE,
+    REG_BADBR,
+    REG_ERANGE,
+    REG_ESPACE,
+    REG_BADRPT,
+};
+
+int regcomp(regex_t*, const char* pattern, int cflags);
+int regexec(const regex_t*, const char* string, size_t nmatch, regmatch_t[], int eflags);
+size_t regerror(int errcode, const regex_t*, char* errbuf, size_t errbuf_size);
+void regfree(regex_t*);
+
+__END_DECLS
@@ -25,8 +25,99 @@
  */
 
 #include <Kernel/API/Syscall.h>
+#include <LibThread/Lock.h>
 #include <errno.h>
+#include <limits.h>
 #include <serenity.h>
+#include <string.h>
+
+// Shared buffers come and go at a high rate (audio chunks, window backing stores, download results),
+// and the same few sizes keep coming back. Instead of releasing a buffer that nobody else has mapped
+// any more, we keep it mapped and volatile for a while, and hand it out again from shbuf_create().
+static constexpr size_t max_number_of_pooled_shared_buffers = 8;
+static constexpr size_t max_bytes_in_pooled_shared_buffers = 16 * MB;
+
+struct PooledSharedBuffer {
+    int shbuf_id;
+    void* data;
+    size_t size;
+};
+
+static PooledSharedBuffer s_pooled_shared_buffers[max_number_of_pooled_shared_buffers];
+static size_t s_pooled_shared_buffer_count;
+static size_t s_bytes_in_pooled_shared_buffers;
+static pid_t s_shared_buffer_pool_pid;
+
+static LibThread::Lock& shared_buffer_pool_lock()
+{
+    // Zero-initialized storage is an unlocked Lock, and this way it doesn't need a global constructor.
+    static u32 lock_storage[sizeof(LibThread::Lock) / sizeof(u32)];
+    return *reinterpret_cast<LibThread::Lock*>(&lock_storage);
+}
+
+static void forget_pooled_shared_buffers_after_fork()
+{
+    // A forked child inherits the mappings, but the buffers themselves still belong to the parent.
+    if (s_shared_buffer_pool_pid == getpid())
+        return;
+    s_shared_buffer_pool_pid = getpid();
+    s_pooled_shared_buffer_count = 0;
+    s_bytes_in_pooled_shared_buffers = 0;
+}
+
+static PooledSharedBuffer take_pooled_shared_buffer(size_t index)
+{
+    auto buffer = s_pooled_shared_buffers[index];
+    s_pooled_shared_buffers[index] = s_pooled_shared_buffers[--s_pooled_shared_buffer_count];
+    s_bytes_in_pooled_shared_buffers -= buffer.size;
+    return buffer;
+}
+
+static int take_shared_buffer_from_pool(int size, void** buffer)
+{
+    LibThread::Locker locker(shared_buffer_pool_lock());
+    forget_pooled_shared_buffers_after_fork();
+    size_t rounded_size = ((size_t)size + PAGE_SIZE - 1) & ~(PAGE_SIZE - 1);
+    for (size_t i = 0; i < s_pooled_shared_buffer_count; ++i) {
+        if (s_pooled_shared_buffers[i].size != rounded_size)
+            continue;
+        auto pooled = take_pooled_shared_buffer(i);
+        int rc = syscall(SC_shbuf_set_volatile, pooled.shbuf_id, false);
+        if (rc < 0) {
+            syscall(SC_shbuf_release, pooled.shbuf_id);
+            return -1;
+        }
+        // A purged buffer is back to zero pages already, just like a fresh one.
+        bool was_purged = rc == 1;
+        if (!was_purged)
+            memset(pooled.data, 0, pooled.size);
+        *buffer = pooled.data;
+        return pooled.shbuf_id;
+    }
+    return -1;
+}
+
+static bool put_shared_buffer_in_pool(int shbuf_id)
+{
+    LibThread::Locker locker(shared_buffer_pool_lock());
+    forget_pooled_shared_buffers_after_fork();
+    size_t size = 0;
+    void* data = (void*)syscall(SC_shbuf_reclaim, shbuf_id, &size);
+    if ((int)data < 0 && -(int)data < EMAXERRNO)
+        return false;
+    if (size > max_bytes_in_pooled_shared_buffers) {
+        syscall(SC_shbuf_release, shbuf_id);
+        return true;
+    }
+    // Make room by letting go of the oldest ones.
+    while (s_pooled_shared_buffer_count == max_number_of_pooled_shared_buffers || s_bytes_in_pooled_shared_buffers + size > max_bytes_in_pooled_shared_buffers) {
+        auto evicted = take_pooled_shared_buffer(0);
+        syscall(SC_shbuf_release, evicted.shbuf_id);
+    }
+    s_pooled_shared_buffers[s_pooled_shared_buffer_count++] = { shbuf_id, data, size };
+    s_bytes_in_pooled_shared_buffers += size;
+    return true;
+}
 
 extern "C" {
 
@@ -103,6 +194,8 @@ void* shbuf_get(int shbuf_id, size_t* size)
 
 int shbuf_release(int shbuf_id)
 {
+    if (put_shared_buffer_in_pool(shbuf_id))
+        return 0;
     int rc = syscall(SC_shbuf_release, shbuf_id);
     __RETURN_WITH_ERRNO(rc, rc, -1);
 }
@@ -115,6 +208,11 @@ int shbuf_seal(int shbuf_id)
 
 int shbuf_create(int size, void** buffer)
 {
+    if (size > 0) {
+        int shbuf_id = take_shared_buffer_from_pool(size, buffer);
+        if (shbuf_id >= 0)
+            return shbuf_id;
+    }
     int rc = syscall(SC_shbuf_create, size, buffer);
     __RETURN_WITH_ERRNO(rc, rc, -1);
 }
@@ -131,6 +229,12 @@ int shbuf_allow_all(int shbuf_id)
     __RETURN_WITH_ERRNO(rc, rc, -1);
 }
 
+int anon_create(size_t size, int options)
+{
+    int rc = syscall(SC_anon_create, size, options);
+    __RETURN_WITH_ERRNO(rc, rc, -1);
+}
+
 int get_stack_bounds(uintptr_t* user_stack_base, size_t* user_stack_size)
 {
     int rc = syscall(SC_get_stack_bounds, user_stack_base, user_stack_size);
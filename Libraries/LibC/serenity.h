@@ -40,6 +40,9 @@ void* shbuf_get(int shbuf_id, size_t* size);
 int shbuf_release(int shbuf_id);
 int shbuf_seal(int shbuf_id);
 
+// Creates memory that isn't backed by a file. The fd can be mmap()ed, ftruncate()d while unmapped, and passed with sendfd().
+int anon_create(size_t size, int options);
+
 int module_load(const char* path, size_t path_length);
 int module_unload(const char* name, size_t name_length);
 
@@ -68,6 +71,15 @@ int purge(int mode);
 #define PERF_EVENT_MALLOC 1
 #define PERF_EVENT_FREE 2
 
+// Hardware counters for the calling thread. arg1 is the sample period, or 0 to only count.
+#define PERF_EVENT_CYCLES 3
+#define PERF_EVENT_INSTRUCTIONS 4
+#define PERF_EVENT_CACHE_MISSES 5
+#define PERF_EVENT_BRANCH_MISSES 6
+// arg1 points to a uint64_t that receives the count of the calling thread's counter.
+#define PERF_EVENT_READ_COUNTER 7
+#define PERF_EVENT_DISABLE_COUNTER 8
+
 int perf_event(int type, uintptr_t arg1, uintptr_t arg2);
 
 int get_stack_bounds(uintptr_t* user_stack_base, size_t* user_stack_size);
@@ -31,6 +31,7 @@
 #include <AK/StdLibExtras.h>
 #include <AK/kmalloc.h>
 #include <Kernel/API/Syscall.h>
+#include <LibThread/Lock.h>
 #include <assert.h>
 #include <errno.h>
 #include <fcntl.h>
@@ -39,6 +40,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <sys/internals.h>
+#include <sys/stat.h>
 #include <sys/types.h>
 #include <sys/wait.h>
 #include <unistd.h>
@@ -71,6 +73,17 @@ public:
     bool gets(u8*, size_t);
     bool ungetc(u8 byte) { return m_buffer.enqueue_front(byte); }
 
+    int getc();
+    bool putc(u8);
+
+    // Hand out the buffered data directly, reading more into the buffer first if it's empty.
+    // Returns nullptr on end of file or error.
+    const u8* readptr(size_t& available_size);
+    void readptr_increase(size_t increment) { m_buffer.did_dequeue(increment); }
+
+    void lock() { m_lock.lock(); }
+    void unlock() { m_lock.unlock(); }
+
     int seek(long offset, int whence);
     long tell();
 
@@ -84,6 +97,7 @@ private:
         ~Buffer();
 
         int mode() const { return m_mode; }
+        size_t capacity() const { return m_capacity; }
         void setbuf(u8* data, int mode, size_t size);
         // Make sure to call realize() before enqueuing any data.
         // Dequeuing can be attempted without it.
@@ -134,6 +148,20 @@ private:
     bool m_eof { false };
     pid_t m_popen_child { -1 };
     Buffer m_buffer;
+    LibThread::Lock m_lock;
+};
+
+class ScopedFileLock {
+public:
+    explicit ScopedFileLock(FILE* file)
+        : m_file(file)
+    {
+        m_file->lock();
+    }
+    ~ScopedFileLock() { m_file->unlock(); }
+
+private:
+    FILE* m_file;
 };
 
 FILE::~FILE()
@@ -253,13 +281,24 @@ size_t FILE::read(u8* data, size_t size)
 
     while (size > 0) {
         size_t actual_size;
+        size_t queued_size = 0;
+        const u8* queued_data = nullptr;
 
-        if (m_buffer.may_use()) {
+        bool use_buffer = m_buffer.may_use();
+        if (use_buffer) {
             // Let's see if the buffer has something queued for us.
-            size_t queued_size;
-            const u8* queued_data = m_buffer.begin_dequeue(queued_size);
+            queued_data = m_buffer.begin_dequeue(queued_size);
             if (queued_size == 0) {
-                // Nothing buffered; we're going to have to read some.
+                // Nothing buffered. If the rest of the request would fill the whole buffer anyway,
+                // skip the extra copy and read straight into the user buffer.
+                m_buffer.realize(m_fd);
+                use_buffer = size < m_buffer.capacity();
+            }
+        }
+
+        if (use_buffer) {
+            if (queued_size == 0) {
+                // We're going to have to read some.
                 bool read_some_more = read_into_buffer();
                 if (read_some_more) {
                     // Great, now try this again.
@@ -293,8 +332,15 @@ size_t FILE::write(const u8* data, size_t size)
     while (size > 0) {
         size_t actual_size;
 
-        if (m_buffer.may_use()) {
+        bool use_buffer = m_buffer.may_use();
+        if (use_buffer) {
             m_buffer.realize(m_fd);
+            // If the buffer is empty and the rest of the data would only fill it up to be flushed
+            // right away, write it straight from the user buffer instead.
+            use_buffer = m_buffer.buffered_size() != 0 || size < m_buffer.capacity();
+        }
+
+        if (use_buffer) {
             // Try writing into the buffer.
             size_t available_size;
             u8* buffer_data = m_buffer.begin_enqueue(available_size);
@@ -343,53 +389,74 @@ bool FILE::gets(u8* data, size_t size)
         return false;
 
     while (size > 1) {
-        if (m_buffer.may_use()) {
-            // Let's see if the buffer has something queued for us.
-            size_t queued_size;
-            const u8* queued_data = m_buffer.begin_dequeue(queued_size);
-            if (queued_size == 0) {
-                // Nothing buffered; we're going to have to read some.
-                bool read_some_more = read_into_buffer();
-                if (read_some_more) {
-                    // Great, now try this again.
-                    continue;
-                }
-                *data = 0;
-                return total_read > 0;
-            }
-            size_t actual_size = min(size - 1, queued_size);
-            u8* newline = reinterpret_cast<u8*>(memchr(queued_data, '\n', actual_size));
-            if (newline)
-                actual_size = newline - queued_data + 1;
-            memcpy(data, queued_data, actual_size);
-            m_buffer.did_dequeue(actual_size);
-            total_read += actual_size;
-            data += actual_size;
-            size -= actual_size;
-            if (newline)
-                break;
-        } else {
-            // Sadly, we have to actually read these characters one by one.
-            u8 byte;
-            ssize_t nread = do_read(&byte, 1);
-            if (nread <= 0) {
-                *data = 0;
-                return total_read > 0;
-            }
-            ASSERT(nread == 1);
-            *data = byte;
-            total_read++;
-            data++;
-            size--;
-            if (byte == '\n')
-                break;
-        }
+        size_t queued_size;
+        const u8* queued_data = readptr(queued_size);
+        if (!queued_data)
+            break;
+        size_t actual_size = min(size - 1, queued_size);
+        u8* newline = reinterpret_cast<u8*>(memchr(queued_data, '\n', actual_size));
+        if (newline)
+            actual_size = newline - queued_data + 1;
+        memcpy(data, queued_data, actual_size);
+        readptr_increase(actual_size);
+        total_read += actual_size;
+        data += actual_size;
+        size -= actual_size;
+        if (newline)
+            break;
     }
 
     *data = 0;
     return total_read > 0;
 }
 
+const u8* FILE::readptr(size_t& available_size)
+{
+    const u8* data = m_buffer.begin_dequeue(available_size);
+    if (available_size)
+        return data;
+
+    if (m_buffer.may_use()) {
+        if (!read_into_buffer())
+            return nullptr;
+    } else {
+        // Unbuffered streams hand their data out one byte at a time, through the ungetc() slot.
+        u8 byte;
+        if (do_read(&byte, 1) <= 0)
+            return nullptr;
+        m_buffer.enqueue_front(byte);
+    }
+
+    return m_buffer.begin_dequeue(available_size);
+}
+
+int FILE::getc()
+{
+    size_t available_size;
+    const u8* data = readptr(available_size);
+    if (!data)
+        return EOF;
+    u8 byte = *data;
+    m_buffer.did_dequeue(1);
+    return byte;
+}
+
+bool FILE::putc(u8 byte)
+{
+    m_buffer.realize(m_fd);
+    if (m_buffer.mode() == _IOFBF || (m_buffer.mode() == _IOLBF && byte != '\n')) {
+        // Fast path: there's room in the buffer, and no reason to flush it.
+        size_t available_size;
+        u8* data = m_buffer.begin_enqueue(available_size);
+        if (available_size) {
+            *data = byte;
+            m_buffer.did_enqueue(1);
+            return true;
+        }
+    }
+    return write(&byte, 1) == 1;
+}
+
 int FILE::seek(long offset, int whence)
 {
     bool ok = flush();
@@ -421,12 +488,29 @@ FILE::Buffer::~Buffer()
         free(m_data);
 }
 
+// Regular files get a bigger buffer than BUFSIZ, rounded up to whole filesystem blocks,
+// so that reading or writing them sequentially takes a lot fewer syscalls.
+static constexpr size_t regular_file_buffer_size = 16 * KB;
+static constexpr size_t max_buffer_size = 64 * KB;
+
+static size_t preferred_buffer_size(int fd)
+{
+    struct stat st;
+    if (fstat(fd, &st) < 0 || !S_ISREG(st.st_mode))
+        return BUFSIZ;
+    size_t block_size = st.st_blksize;
+    if (block_size == 0 || block_size > max_buffer_size)
+        return regular_file_buffer_size;
+    return (regular_file_buffer_size + block_size - 1) / block_size * block_size;
+}
+
 void FILE::Buffer::realize(int fd)
 {
     if (m_mode == -1)
         m_mode = isatty(fd) ? _IOLBF : _IOFBF;
 
     if (m_mode != _IONBF && m_data == nullptr) {
+        m_capacity = preferred_buffer_size(fd);
         m_data = reinterpret_cast<u8*>(malloc(m_capacity));
         m_data_is_malloced = true;
     }
@@ -437,6 +521,10 @@ void FILE::Buffer::setbuf(u8* data, int mode, size_t size)
     drop();
     m_mode = mode;
     if (data != nullptr) {
+        if (m_data_is_malloced) {
+            free(m_data);
+            m_data_is_malloced = false;
+        }
         m_data = data;
         m_capacity = size;
     }
@@ -444,11 +532,7 @@ void FILE::Buffer::setbuf(u8* data, int mode, size_t size)
 
 void FILE::Buffer::drop()
 {
-    if (m_data_is_malloced) {
-        free(m_data);
-        m_data = nullptr;
-        m_data_is_malloced = false;
-    }
+    // Note: this keeps the buffer memory around to be reused.
     m_begin = m_end = 0;
     m_empty = true;
     m_ungotten = false;
@@ -575,6 +659,7 @@ int setvbuf(FILE* stream, char* buf, int mode, size_t size)
         errno = EINVAL;
         return -1;
     }
+    ScopedFileLock lock(stream);
     stream->setbuf(reinterpret_cast<u8*>(buf), mode, size);
     return 0;
 }
@@ -589,19 +674,31 @@ void setlinebuf(FILE* stream)
     setvbuf(stream, nullptr, _IOLBF, 0);
 }
 
-int fileno(FILE* stream)
+int fileno_unlocked(FILE* stream)
 {
     ASSERT(stream);
     return stream->fileno();
 }
 
-int feof(FILE* stream)
+int fileno(FILE* stream)
+{
+    return fileno_unlocked(stream);
+}
+
+int feof_unlocked(FILE* stream)
 {
     ASSERT(stream);
     return stream->eof();
 }
 
-int fflush(FILE* stream)
+int feof(FILE* stream)
+{
+    ASSERT(stream);
+    ScopedFileLock lock(stream);
+    return feof_unlocked(stream);
+}
+
+int fflush_unlocked(FILE* stream)
 {
     if (!stream) {
         dbg() << "FIXME: fflush(nullptr) should flush all open streams";
@@ -610,21 +707,39 @@ int fflush(FILE* stream)
     return stream->flush() ? 0 : EOF;
 }
 
-char* fgets(char* buffer, int size, FILE* stream)
+int fflush(FILE* stream)
+{
+    if (!stream)
+        return fflush_unlocked(stream);
+    ScopedFileLock lock(stream);
+    return fflush_unlocked(stream);
+}
+
+char* fgets_unlocked(char* buffer, int size, FILE* stream)
 {
     ASSERT(stream);
     bool ok = stream->gets(reinterpret_cast<u8*>(buffer), size);
     return ok ? buffer : nullptr;
 }
 
+char* fgets(char* buffer, int size, FILE* stream)
+{
+    ASSERT(stream);
+    ScopedFileLock lock(stream);
+    return fgets_unlocked(buffer, size, stream);
+}
+
+int fgetc_unlocked(FILE* stream)
+{
+    ASSERT(stream);
+    return stream->getc();
+}
+
 int fgetc(FILE* stream)
 {
     ASSERT(stream);
-    char ch;
-    size_t nread = fread(&ch, sizeof(char), 1, stream);
-    if (nread == 1)
-        return ch;
-    return EOF;
+    ScopedFileLock lock(stream);
+    return stream->getc();
 }
 
 int getc(FILE* stream)
@@ -634,7 +749,7 @@ int getc(FILE* stream)
 
 int getc_unlocked(FILE* stream)
 {
-    return fgetc(stream);
+    return fgetc_unlocked(stream);
 }
 
 int getchar()
@@ -642,9 +757,14 @@ int getchar()
     return getc(stdin);
 }
 
+int getchar_unlocked()
+{
+    return getc_unlocked(stdin);
+}
+
 ssize_t getdelim(char** lineptr, size_t* n, int delim, FILE* stream)
 {
-    char *ptr, *eptr;
+    ASSERT(stream);
     if (*lineptr == nullptr || *n == 0) {
         *n = BUFSIZ;
         if ((*lineptr = static_cast<char*>(malloc(*n))) == nullptr) {
@@ -652,34 +772,39 @@ ssize_t getdelim(char** lineptr, size_t* n, int delim, FILE* stream)
         }
     }
 
-    for (ptr = *lineptr, eptr = *lineptr + *n;;) {
-        int c = fgetc(stream);
-        if (c == -1) {
-            if (feof(stream)) {
-                *ptr = '\0';
-                return ptr == *lineptr ? -1 : ptr - *lineptr;
-            } else {
+    ScopedFileLock lock(stream);
+    size_t length = 0;
+    for (;;) {
+        // Copy as much of the buffered data as belongs to this line in one go,
+        // instead of going through fgetc() for every byte.
+        size_t queued_size;
+        const u8* queued_data = stream->readptr(queued_size);
+        if (!queued_data) {
+            if (length == 0)
                 return -1;
-            }
-        }
-        *ptr++ = c;
-        if (c == delim) {
-            *ptr = '\0';
-            return ptr - *lineptr;
+            break;
         }
-        if (ptr + 2 >= eptr) {
-            char* nbuf;
-            size_t nbuf_sz = *n * 2;
-            ssize_t d = ptr - *lineptr;
-            if ((nbuf = static_cast<char*>(realloc(*lineptr, nbuf_sz))) == nullptr) {
+        auto* delimiter = reinterpret_cast<const u8*>(memchr(queued_data, delim, queued_size));
+        size_t actual_size = delimiter ? delimiter - queued_data + 1 : queued_size;
+
+        // Leave room for the null terminator.
+        if (length + actual_size + 1 > *n) {
+            size_t new_size = max(*n * 2, length + actual_size + 1);
+            char* new_buffer = static_cast<char*>(realloc(*lineptr, new_size));
+            if (new_buffer == nullptr)
                 return -1;
-            }
-            *lineptr = nbuf;
-            *n = nbuf_sz;
-            eptr = nbuf + nbuf_sz;
-            ptr = nbuf + d;
+            *lineptr = new_buffer;
+            *n = new_size;
         }
+
+        memcpy(*lineptr + length, queued_data, actual_size);
+        stream->readptr_increase(actual_size);
+        length += actual_size;
+        if (delimiter)
+            break;
     }
+    (*lineptr)[length] = '\0';
+    return length;
 }
 
 ssize_t getline(char** lineptr, size_t* n, FILE* stream)
@@ -690,32 +815,48 @@ ssize_t getline(char** lineptr, size_t* n, FILE* stream)
 int ungetc(int c, FILE* stream)
 {
     ASSERT(stream);
+    ScopedFileLock lock(stream);
     bool ok = stream->ungetc(c);
     return ok ? c : EOF;
 }
 
-int fputc(int ch, FILE* stream)
+int fputc_unlocked(int ch, FILE* stream)
 {
     ASSERT(stream);
     u8 byte = ch;
-    size_t nwritten = stream->write(&byte, 1);
-    if (nwritten == 0)
+    if (!stream->putc(byte))
         return EOF;
-    ASSERT(nwritten == 1);
     return byte;
 }
 
+int fputc(int ch, FILE* stream)
+{
+    ASSERT(stream);
+    ScopedFileLock lock(stream);
+    return fputc_unlocked(ch, stream);
+}
+
 int putc(int ch, FILE* stream)
 {
     return fputc(ch, stream);
 }
 
+int putc_unlocked(int ch, FILE* stream)
+{
+    return fputc_unlocked(ch, stream);
+}
+
 int putchar(int ch)
 {
     return putc(ch, stdout);
 }
 
-int fputs(const char* s, FILE* stream)
+int putchar_unlocked(int ch)
+{
+    return putc_unlocked(ch, stdout);
+}
+
+int fputs_unlocked(const char* s, FILE* stream)
 {
     ASSERT(stream);
     size_t len = strlen(s);
@@ -725,27 +866,49 @@ int fputs(const char* s, FILE* stream)
     return 1;
 }
 
+int fputs(const char* s, FILE* stream)
+{
+    ASSERT(stream);
+    ScopedFileLock lock(stream);
+    return fputs_unlocked(s, stream);
+}
+
 int puts(const char* s)
 {
-    int rc = fputs(s, stdout);
+    ScopedFileLock lock(stdout);
+    int rc = fputs_unlocked(s, stdout);
     if (rc == EOF)
         return EOF;
-    return fputc('\n', stdout);
+    return fputc_unlocked('\n', stdout);
 }
 
-void clearerr(FILE* stream)
+void clearerr_unlocked(FILE* stream)
 {
     ASSERT(stream);
     stream->clear_err();
 }
 
-int ferror(FILE* stream)
+void clearerr(FILE* stream)
+{
+    ASSERT(stream);
+    ScopedFileLock lock(stream);
+    clearerr_unlocked(stream);
+}
+
+int ferror_unlocked(FILE* stream)
 {
     ASSERT(stream);
     return stream->error();
 }
 
-size_t fread(void* ptr, size_t size, size_t nmemb, FILE* stream)
+int ferror(FILE* stream)
+{
+    ASSERT(stream);
+    ScopedFileLock lock(stream);
+    return ferror_unlocked(stream);
+}
+
+size_t fread_unlocked(void* ptr, size_t size, size_t nmemb, FILE* stream)
 {
     ASSERT(stream);
     ASSERT(!Checked<size_t>::multiplication_would_overflow(size, nmemb));
@@ -754,7 +917,14 @@ size_t fread(void* ptr, size_t size, size_t nmemb, FILE* stream)
     return nread / size;
 }
 
-size_t fwrite(const void* ptr, size_t size, size_t nmemb, FILE* stream)
+size_t fread(void* ptr, size_t size, size_t nmemb, FILE* stream)
+{
+    ASSERT(stream);
+    ScopedFileLock lock(stream);
+    return fread_unlocked(ptr, size, nmemb, stream);
+}
+
+size_t fwrite_unlocked(const void* ptr, size_t size, size_t nmemb, FILE* stream)
 {
     ASSERT(stream);
     ASSERT(!Checked<size_t>::multiplication_would_overflow(size, nmemb));
@@ -763,15 +933,24 @@ size_t fwrite(const void* ptr, size_t size, size_t nmemb, FILE* stream)
     return nwritten / size;
 }
 
+size_t fwrite(const void* ptr, size_t size, size_t nmemb, FILE* stream)
+{
+    ASSERT(stream);
+    ScopedFileLock lock(stream);
+    return fwrite_unlocked(ptr, size, nmemb, stream);
+}
+
 int fseek(FILE* stream, long offset, int whence)
 {
     ASSERT(stream);
+    ScopedFileLock lock(stream);
     return stream->seek(offset, whence);
 }
 
 long ftell(FILE* stream)
 {
     ASSERT(stream);
+    ScopedFileLock lock(stream);
     return stream->tell();
 }
 
@@ -780,6 +959,7 @@ int fgetpos(FILE* stream, fpos_t* pos)
     ASSERT(stream);
     ASSERT(pos);
 
+    ScopedFileLock lock(stream);
     long val = stream->tell();
     if (val == -1L)
         return 1;
@@ -793,12 +973,14 @@ int fsetpos(FILE* stream, const fpos_t* pos)
     ASSERT(stream);
     ASSERT(pos);
 
+    ScopedFileLock lock(stream);
     return stream->seek((long)*pos, SEEK_SET);
 }
 
 void rewind(FILE* stream)
 {
     ASSERT(stream);
+    ScopedFileLock lock(stream);
     int rc = stream->seek(0, SEEK_SET);
     ASSERT(rc == 0);
 }
@@ -817,19 +999,17 @@ int dbgprintf(const char* fmt, ...)
     return ret;
 }
 
-ALWAYS_INLINE void stdout_putch(char*&, char ch)
-{
-    putchar(ch);
-}
-
-static FILE* __current_stream = nullptr;
+static __thread FILE* __current_stream = nullptr;
 ALWAYS_INLINE static void stream_putch(char*&, char ch)
 {
-    fputc(ch, __current_stream);
+    __current_stream->putc(ch);
 }
 
 int vfprintf(FILE* stream, const char* fmt, va_list ap)
 {
+    ASSERT(stream);
+    // Take the lock once for the whole string, rather than once per character.
+    ScopedFileLock lock(stream);
     __current_stream = stream;
     return printf_internal(stream_putch, nullptr, fmt, ap);
 }
@@ -845,7 +1025,7 @@ int fprintf(FILE* stream, const char* fmt, ...)
 
 int vprintf(const char* fmt, va_list ap)
 {
-    return printf_internal(stdout_putch, nullptr, fmt, ap);
+    return vfprintf(stdout, fmt, ap);
 }
 
 int printf(const char* fmt, ...)
@@ -984,7 +1164,9 @@ static inline bool is_default_stream(FILE* stream)
 int fclose(FILE* stream)
 {
     ASSERT(stream);
+    stream->lock();
     bool ok = stream->close();
+    stream->unlock();
     ScopedValueRollback errno_restorer(errno);
 
     stream->~FILE();
@@ -1140,14 +1322,14 @@ int vfscanf(FILE* stream, const char* fmt, va_list ap)
 
 void flockfile(FILE* filehandle)
 {
-    (void)filehandle;
-    dbgprintf("FIXME: Implement flockfile()\n");
+    ASSERT(filehandle);
+    filehandle->lock();
 }
 
 void funlockfile(FILE* filehandle)
 {
-    (void)filehandle;
-    dbgprintf("FIXME: Implement funlockfile()\n");
+    ASSERT(filehandle);
+    filehandle->unlock();
 }
 
 FILE* tmpfile()
@@ -62,12 +62,17 @@ int fgetpos(FILE*, fpos_t*);
 int fsetpos(FILE*, const fpos_t*);
 long ftell(FILE*);
 char* fgets(char* buffer, int size, FILE*);
+char* fgets_unlocked(char* buffer, int size, FILE*);
 int fputc(int ch, FILE*);
+int fputc_unlocked(int ch, FILE*);
 int fileno(FILE*);
+int fileno_unlocked(FILE*);
 int fgetc(FILE*);
+int fgetc_unlocked(FILE*);
 int getc(FILE*);
 int getc_unlocked(FILE* stream);
 int getchar();
+int getchar_unlocked();
 ssize_t getdelim(char**, size_t*, int, FILE*);
 ssize_t getline(char**, size_t*, FILE*);
 int ungetc(int c, FILE*);
@@ -80,11 +85,17 @@ void funlockfile(FILE* filehandle);
 int fclose(FILE*);
 void rewind(FILE*);
 void clearerr(FILE*);
+void clearerr_unlocked(FILE*);
 int ferror(FILE*);
+int ferror_unlocked(FILE*);
 int feof(FILE*);
+int feof_unlocked(FILE*);
 int fflush(FILE*);
+int fflush_unlocked(FILE*);
 size_t fread(void* ptr, size_t size, size_t nmemb, FILE*);
+size_t fread_unlocked(void* ptr, size_t size, size_t nmemb, FILE*);
 size_t fwrite(const void* ptr, size_t size, size_t nmemb, FILE*);
+size_t fwrite_unlocked(const void* ptr, size_t size, size_t nmemb, FILE*);
 int vprintf(const char* fmt, va_list);
 int vfprintf(FILE*, const char* fmt, va_list);
 int vsprintf(char* buffer, const char* fmt, va_list);
@@ -97,9 +108,12 @@ ssize_t dbgputstr(const char*, ssize_t);
 int sprintf(char* buffer, const char* fmt, ...);
 int snprintf(char* buffer, size_t, const char* fmt, ...);
 int putchar(int ch);
+int putchar_unlocked(int ch);
 int putc(int ch, FILE*);
+int putc_unlocked(int ch, FILE*);
 int puts(const char*);
 int fputs(const char*, FILE*);
+int fputs_unlocked(const char*, FILE*);
 void perror(const char*);
 int scanf(const char* fmt, ...);
 int sscanf(const char* str, const char* fmt, ...);
@@ -25,9 +25,12 @@
  */
 
 #include <AK/Assertions.h>
+#include <AK/DoubleConversion.h>
 #include <AK/HashMap.h>
 #include <AK/Noncopyable.h>
+#include <AK/Optional.h>
 #include <AK/StdLibExtras.h>
+#include <AK/StringView.h>
 #include <AK/Types.h>
 #include <AK/Utf8View.h>
 #include <Kernel/API/Syscall.h>
@@ -399,8 +402,6 @@ double strtod(const char* str, char** endptr)
     }
 
     // Parse base
-    char exponent_lower;
-    char exponent_upper;
     int base = 10;
     if (*parse_ptr == '0') {
         const char base_ch = *(parse_ptr + 1);
@@ -411,13 +412,39 @@ double strtod(const char* str, char** endptr)
     }
 
     if (base == 10) {
-        exponent_lower = 'e';
-        exponent_upper = 'E';
-    } else {
-        exponent_lower = 'p';
-        exponent_upper = 'P';
+        // Decimal numbers are rounded correctly (and quickly) by AK. Only hand it the characters
+        // that could be part of the number, so it doesn't have to find the end of the string.
+        size_t length = 0;
+        if (*parse_ptr != '+' && *parse_ptr != '-') {
+            for (char ch = parse_ptr[length]; isdigit(ch) || ch == '.' || ch == 'e' || ch == 'E' || ch == '+' || ch == '-'; ch = parse_ptr[length])
+                ++length;
+        }
+        size_t consumed_length = 0;
+        auto value = parse_double(StringView(parse_ptr, length), &consumed_length);
+        if (!value.has_value()) {
+            if (endptr)
+                *endptr = const_cast<char*>(str);
+            return 0.0;
+        }
+        if (endptr)
+            *endptr = parse_ptr + consumed_length;
+        if (__builtin_isinf(value.value())) {
+            errno = ERANGE;
+        } else if (value.value() == 0) {
+            for (size_t i = 0; i < consumed_length && parse_ptr[i] != 'e' && parse_ptr[i] != 'E'; ++i) {
+                if (parse_ptr[i] >= '1' && parse_ptr[i] <= '9') {
+                    errno = ERANGE;
+                    break;
+                }
+            }
+        }
+        return sign == Sign::Negative ? -value.value() : value.value();
     }
 
+    // What's left is hexadecimal, with a binary exponent.
+    const char exponent_lower = 'p';
+    const char exponent_upper = 'P';
+
     // Parse "digits", possibly keeping track of the exponent offset.
     // We parse the most significant digits and the position in the
     // base-`base` representation separately. This allows us to handle
@@ -34,9 +34,104 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/internals.h>
+
+#if ARCH(I386)
+#    include <cpuid.h>
+#    include <emmintrin.h>
+#endif
+
+// The SSE2 versions are picked at startup by __string_init(), until then (and on CPUs without SSE2)
+// everything uses the plain versions. The kernel doesn't save AVX state, so there are no AVX versions.
+static bool s_has_sse2 = false;
+
+#if ARCH(I386)
+// Aligned 16-byte loads never cross a page boundary, so reading the rest of the chunk around the first and
+// last byte we care about can't fault. Those extra bytes are masked off.
+
+[[gnu::target("sse2")]] static size_t strlen_sse2(const char* str)
+{
+    auto* chunk = (const __m128i*)((FlatPtr)str & ~15);
+    const __m128i zero = _mm_setzero_si128();
+    u32 mask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_load_si128(chunk), zero)) >> ((FlatPtr)str & 15);
+    if (mask)
+        return __builtin_ctz(mask);
+    for (;;) {
+        ++chunk;
+        mask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_load_si128(chunk), zero));
+        if (mask)
+            return (const char*)chunk + __builtin_ctz(mask) - str;
+    }
+}
+
+[[gnu::target("sse2")]] static const void* memchr_sse2(const void* ptr, int c, size_t size)
+{
+    auto* start = (const u8*)ptr;
+    auto* end = start + size;
+    auto* chunk = (const __m128i*)((FlatPtr)start & ~15);
+    const __m128i needle = _mm_set1_epi8((char)c);
+    u32 mask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_load_si128(chunk), needle)) & (0xffffu << ((FlatPtr)start & 15));
+    for (;;) {
+        if (mask) {
+            auto* found = (const u8*)chunk + __builtin_ctz(mask);
+            return found < end ? found : nullptr;
+        }
+        ++chunk;
+        if ((const u8*)chunk >= end)
+            return nullptr;
+        mask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_load_si128(chunk), needle));
+    }
+}
+
+[[gnu::target("sse2")]] static int memcmp_sse2(const u8* s1, const u8* s2, size_t n)
+{
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        u32 mask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(s1 + i)), _mm_loadu_si128((const __m128i*)(s2 + i))));
+        if (mask != 0xffff) {
+            i += __builtin_ctz(~mask);
+            return s1[i] < s2[i] ? -1 : 1;
+        }
+    }
+    for (; i < n; ++i) {
+        if (s1[i] != s2[i])
+            return s1[i] < s2[i] ? -1 : 1;
+    }
+    return 0;
+}
+
+// For n >= 16. The last 16 bytes are done separately (and possibly overlap the loop) to avoid a byte tail.
+[[gnu::target("sse2")]] static void memcpy_sse2(u8* dest, const u8* src, size_t n)
+{
+    __m128i last = _mm_loadu_si128((const __m128i*)(src + n - 16));
+    for (size_t i = 0; i + 16 <= n; i += 16)
+        _mm_storeu_si128((__m128i*)(dest + i), _mm_loadu_si128((const __m128i*)(src + i)));
+    _mm_storeu_si128((__m128i*)(dest + n - 16), last);
+}
+
+[[gnu::target("sse2")]] static void memset_sse2(u8* dest, int c, size_t n)
+{
+    const __m128i value = _mm_set1_epi8((char)c);
+    for (size_t i = 0; i + 16 <= n; i += 16)
+        _mm_storeu_si128((__m128i*)(dest + i), value);
+    _mm_storeu_si128((__m128i*)(dest + n - 16), value);
+}
+
+// Above this, "rep movsb" and "rep stosb" are at least as fast on CPUs with fast string operations.
+static constexpr size_t sse2_max_copy_size = 2048;
+#endif
 
 extern "C" {
 
+void __string_init()
+{
+#if ARCH(I386)
+    unsigned eax, ebx, ecx, edx;
+    if (__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+        s_has_sse2 = edx & bit_SSE2;
+#endif
+}
+
 void bzero(void* dest, size_t n)
 {
     memset(dest, 0, n);
@@ -75,6 +170,10 @@ size_t strcspn(const char* s, const char* reject)
 
 size_t strlen(const char* str)
 {
+#if ARCH(I386)
+    if (s_has_sse2)
+        return strlen_sse2(str);
+#endif
     size_t len = 0;
     while (*(str++))
         ++len;
@@ -131,6 +230,10 @@ int memcmp(const void* v1, const void* v2, size_t n)
 {
     auto* s1 = (const uint8_t*)v1;
     auto* s2 = (const uint8_t*)v2;
+#if ARCH(I386)
+    if (s_has_sse2 && n >= 16)
+        return memcmp_sse2(s1, s2, n);
+#endif
     while (n-- > 0) {
         if (*s1++ != *s2++)
             return s1[-1] < s2[-1] ? -1 : 1;
@@ -141,6 +244,10 @@ int memcmp(const void* v1, const void* v2, size_t n)
 #if ARCH(I386)
 void* memcpy(void* dest_ptr, const void* src_ptr, size_t n)
 {
+    if (s_has_sse2 && n >= 16 && n <= sse2_max_copy_size) {
+        memcpy_sse2((u8*)dest_ptr, (const u8*)src_ptr, n);
+        return dest_ptr;
+    }
     void* original_dest = dest_ptr;
     asm volatile(
         "rep movsb"
@@ -150,6 +257,10 @@ void* memcpy(void* dest_ptr, const void* src_ptr, size_t n)
 
 void* memset(void* dest_ptr, int c, size_t n)
 {
+    if (s_has_sse2 && n >= 16 && n <= sse2_max_copy_size) {
+        memset_sse2((u8*)dest_ptr, c, n);
+        return dest_ptr;
+    }
     void* original_dest = dest_ptr;
     asm volatile(
         "rep stosb\n"
@@ -189,33 +300,102 @@ void* memmove(void* dest, const void* src, size_t n)
     return dest;
 }
 
-namespace {
-const static void* bitap_bitwise(const void* haystack, size_t haystack_length, const void* needle, size_t needle_length)
+// Crochemore and Perrin's two-way string matching: linear time and constant space, with a bad character
+// table so that most mismatches skip ahead by the whole needle length.
+static const u8* two_way_search(const u8* haystack, size_t haystack_length, const u8* needle, size_t needle_length)
 {
-    ASSERT(needle_length < 32);
-
-    u64 lookup = 0xfffffffe;
-
-    constexpr size_t mask_length = (size_t)((u8)-1) + 1;
-    u64 needle_mask[mask_length];
+    size_t shift[256] = {};
+    for (size_t i = 0; i < needle_length; ++i)
+        shift[needle[i]] = i + 1;
+
+    // Compute the maximal suffix of the needle, for both orderings of the alphabet.
+    size_t ip = (size_t)-1;
+    size_t jp = 0;
+    size_t k = 1;
+    size_t p = 1;
+    while (jp + k < needle_length) {
+        if (needle[ip + k] == needle[jp + k]) {
+            if (k == p) {
+                jp += p;
+                k = 1;
+            } else {
+                ++k;
+            }
+        } else if (needle[ip + k] > needle[jp + k]) {
+            jp += k;
+            k = 1;
+            p = jp - ip;
+        } else {
+            ip = jp++;
+            k = p = 1;
+        }
+    }
+    size_t critical_position = ip;
+    size_t period = p;
+
+    ip = (size_t)-1;
+    jp = 0;
+    k = p = 1;
+    while (jp + k < needle_length) {
+        if (needle[ip + k] == needle[jp + k]) {
+            if (k == p) {
+                jp += p;
+                k = 1;
+            } else {
+                ++k;
+            }
+        } else if (needle[ip + k] < needle[jp + k]) {
+            jp += k;
+            k = 1;
+            p = jp - ip;
+        } else {
+            ip = jp++;
+            k = p = 1;
+        }
+    }
+    if (ip + 1 > critical_position + 1) {
+        critical_position = ip;
+        period = p;
+    }
 
-    for (size_t i = 0; i < mask_length; ++i)
-        needle_mask[i] = 0xffffffff;
+    // If the needle isn't periodic, we can skip further and never need to remember a matched prefix.
+    size_t memory_after_shift;
+    if (memcmp(needle, needle + period, critical_position + 1) != 0) {
+        memory_after_shift = 0;
+        period = max(critical_position, needle_length - critical_position - 1) + 1;
+    } else {
+        memory_after_shift = needle_length - period;
+    }
 
-    for (size_t i = 0; i < needle_length; ++i)
-        needle_mask[((const u8*)needle)[i]] &= ~(0x00000001 << i);
+    size_t memory = 0;
+    for (size_t position = 0; position + needle_length <= haystack_length;) {
+        const u8* window = haystack + position;
 
-    for (size_t i = 0; i < haystack_length; ++i) {
-        lookup |= needle_mask[((const u8*)haystack)[i]];
-        lookup <<= 1;
+        size_t skip = needle_length - shift[window[needle_length - 1]];
+        if (skip) {
+            position += max(skip, memory);
+            memory = 0;
+            continue;
+        }
 
-        if (!(lookup & (0x00000001 << needle_length)))
-            return ((const u8*)haystack) + i - needle_length + 1;
+        // Match the right half of the needle, then the left half.
+        size_t i = max(critical_position + 1, memory);
+        while (i < needle_length && needle[i] == window[i])
+            ++i;
+        if (i < needle_length) {
+            position += i - critical_position;
+            memory = 0;
+            continue;
+        }
+        for (i = critical_position + 1; i > memory && needle[i - 1] == window[i - 1]; --i)
+            ;
+        if (i <= memory)
+            return window;
+        position += period;
+        memory = memory_after_shift;
     }
-
     return nullptr;
 }
-}
 
 const void* memmem(const void* haystack, size_t haystack_length, const void* needle, size_t needle_length)
 {
@@ -225,21 +405,13 @@ const void* memmem(const void* haystack, size_t haystack_length, const void* nee
     if (haystack_length < needle_length)
         return nullptr;
 
+    if (needle_length == 1)
+        return memchr(haystack, *(const u8*)needle, haystack_length);
+
     if (haystack_length == needle_length)
         return memcmp(haystack, needle, haystack_length) == 0 ? haystack : nullptr;
 
-    if (needle_length < 32)
-        return bitap_bitwise(haystack, haystack_length, needle, needle_length);
-
-    // Fallback to a slower search.
-    auto length_diff = haystack_length - needle_length;
-    for (size_t i = 0; i < length_diff; ++i) {
-        const auto* start = ((const u8*)haystack) + i;
-        if (memcmp(start, needle, needle_length) == 0)
-            return start;
-    }
-
-    return nullptr;
+    return two_way_search((const u8*)haystack, haystack_length, (const u8*)needle, needle_length);
 }
 
 char* strcpy(char* dest, const char* src)
@@ -282,6 +454,10 @@ char* strchrnul(const char* str, int c)
 
 void* memchr(const void* ptr, int c, size_t size)
 {
+#if ARCH(I386)
+    if (s_has_sse2)
+        return const_cast<void*>(size ? memchr_sse2(ptr, c, size) : nullptr);
+#endif
     char ch = c;
     auto* cptr = (const char*)ptr;
     for (size_t i = 0; i < size; ++i) {
@@ -421,20 +597,12 @@ char* strsignal(int signum)
 
 char* strstr(const char* haystack, const char* needle)
 {
-    char nch;
-    char hch;
-
-    if ((nch = *needle++) != 0) {
-        size_t len = strlen(needle);
-        do {
-            do {
-                if ((hch = *haystack++) == 0)
-                    return nullptr;
-            } while (hch != nch);
-        } while (strncmp(haystack, needle, len) != 0);
-        --haystack;
-    }
-    return const_cast<char*>(haystack);
+    if (!needle[0])
+        return const_cast<char*>(haystack);
+    haystack = strchr(haystack, needle[0]);
+    if (!haystack || !needle[1])
+        return const_cast<char*>(haystack);
+    return const_cast<char*>(static_cast<const char*>(memmem(haystack, strlen(haystack), needle, strlen(needle))));
 }
 
 char* strpbrk(const char* s, const char* accept)
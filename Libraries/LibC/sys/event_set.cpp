@@ -0,0 +1,52 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <Kernel/API/Syscall.h>
+#include <errno.h>
+#include <sys/event_set.h>
+
+extern "C" {
+
+int event_set_create(int flags)
+{
+    int rc = syscall(SC_event_set_create, flags);
+    __RETURN_WITH_ERRNO(rc, rc, -1);
+}
+
+int event_set_ctl(int set_fd, int op, int fd, unsigned events, void* data)
+{
+    Syscall::SC_event_set_ctl_params params { set_fd, op, fd, events, data };
+    int rc = syscall(SC_event_set_ctl, &params);
+    __RETURN_WITH_ERRNO(rc, rc, -1);
+}
+
+int event_set_wait(int set_fd, struct event_set_event* events, int max_events, const struct timespec* timeout)
+{
+    Syscall::SC_event_set_wait_params params { set_fd, events, max_events, timeout };
+    int rc = syscall(SC_event_set_wait, &params);
+    __RETURN_WITH_ERRNO(rc, rc, -1);
+}
+}
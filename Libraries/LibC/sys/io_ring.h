@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <sys/cdefs.h>
+#include <sys/types.h>
+
+__BEGIN_DECLS
+
+#define IO_RING_OP_NOP 0
+#define IO_RING_OP_READ 1
+#define IO_RING_OP_WRITE 2
+#define IO_RING_OP_ACCEPT 3
+#define IO_RING_OP_RECV 4
+#define IO_RING_OP_SEND 5
+#define IO_RING_OP_FSYNC 6
+
+// The ring is shared with the kernel. Userspace produces submissions by filling in the entry at
+// submission_tail and then advancing it, and consumes completions by advancing completion_head.
+// The kernel owns the other two indices. All offsets are relative to the start of the header.
+struct io_ring_header {
+    unsigned submission_head;
+    unsigned submission_tail;
+    unsigned completion_head;
+    unsigned completion_tail;
+    unsigned submission_entries;
+    unsigned completion_entries;
+    unsigned submissions_offset;
+    unsigned completions_offset;
+    unsigned buffers_offset;
+    unsigned buffers_size;
+};
+
+struct io_ring_submission {
+    unsigned opcode;
+    int fd;
+    // READ, WRITE, RECV and SEND operate on this range of the ring's buffer area.
+    size_t buffer_offset;
+    size_t length;
+    // File offset for READ and WRITE, or -1 to use (and advance) the current one.
+    ssize_t offset;
+    // Passed on to RECV and SEND.
+    int flags;
+    void* user_data;
+};
+
+struct io_ring_completion {
+    void* user_data;
+    // Same as the return value of the corresponding syscall, with errors as negative errno values.
+    ssize_t result;
+};
+
+int io_ring_create(unsigned entries, size_t buffers_size, int flags, struct io_ring_header** ring);
+int io_ring_enter(int ring_fd, unsigned min_complete);
+
+__END_DECLS
@@ -87,6 +87,7 @@ struct ucred {
 #define SO_REUSEADDR 6
 #define SO_BINDTODEVICE 7
 #define SO_KEEPALIVE 9
+#define SO_REUSEPORT 10
 
 struct sockaddr_storage {
     union {
@@ -79,7 +79,7 @@ typedef int pthread_key_t;
 typedef void* pthread_once_t;
 
 typedef struct __pthread_mutex_t {
-    uint32_t lock;
+    uint32_t lock; // 0: unlocked, 1: locked, 2: locked and maybe contended
     pthread_t owner;
     int level;
     int type;
@@ -91,14 +91,32 @@ typedef struct __pthread_mutexattr_t {
 } pthread_mutexattr_t;
 
 typedef struct __pthread_cond_t {
-    int32_t value;
-    uint32_t previous;
-    int clockid; // clockid_t
+    int32_t value; // Sequence number, bumped on every signal and broadcast
+    int clockid;   // clockid_t
 } pthread_cond_t;
 
-typedef void* pthread_rwlock_t;
-typedef void* pthread_rwlockatrr_t;
-typedef void* pthread_spinlock_t;
+typedef struct __pthread_rwlock_t {
+    uint32_t lock; // Reader count, or 0x7fffffff when write-locked. The top bit is set when there are sleepers.
+    uint32_t waiters;
+} pthread_rwlock_t;
+
+typedef struct __pthread_rwlockattr_t {
+    int pshared;
+} pthread_rwlockattr_t;
+
+typedef struct __pthread_spinlock_t {
+    uint32_t lock;
+} pthread_spinlock_t;
+
+typedef struct __pthread_barrier_t {
+    uint32_t count;
+    uint32_t arrived;
+    int32_t generation;
+} pthread_barrier_t;
+
+typedef struct __pthread_barrierattr_t {
+    int pshared;
+} pthread_barrierattr_t;
 typedef struct __pthread_condattr_t {
     int clockid; // clockid_t
 } pthread_condattr_t;
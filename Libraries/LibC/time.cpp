@@ -24,9 +24,11 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <AK/Atomic.h>
 #include <AK/String.h>
 #include <AK/StringBuilder.h>
 #include <Kernel/API/Syscall.h>
+#include <Kernel/API/TimePage.h>
 #include <assert.h>
 #include <errno.h>
 #include <stdio.h>
@@ -37,6 +39,77 @@
 
 extern "C" {
 
+static Atomic<const TimePage*> s_time_page;
+static Atomic<u64> s_last_monotonic_nanoseconds;
+
+static const TimePage* time_page()
+{
+    auto* page = s_time_page.load(AK::memory_order_acquire);
+    if (page)
+        return page;
+    int rc = syscall(SC_map_time_page);
+    if (rc < 0 && -rc < EMAXERRNO)
+        return nullptr;
+    // If another thread got here first, use its mapping; ours is just one page.
+    const TimePage* expected = nullptr;
+    if (!s_time_page.compare_exchange_strong(expected, (const TimePage*)rc, AK::memory_order_acq_rel))
+        return expected;
+    return (const TimePage*)rc;
+}
+
+static inline u64 read_tsc()
+{
+    u32 lsw;
+    u32 msw;
+    asm volatile("rdtsc"
+                 : "=d"(msw), "=a"(lsw));
+    return ((u64)msw << 32) | lsw;
+}
+
+// Reads the clock off the kernel's time page. Returns false if the caller should ask the kernel instead.
+static bool read_time_page(clockid_t clock_id, u64& nanoseconds)
+{
+    auto* page = time_page();
+    if (!page)
+        return false;
+    for (;;) {
+        u32 sequence = page->sequence;
+        if (sequence & 1)
+            continue;
+        asm volatile("" ::: "memory");
+        bool tsc_is_usable = page->flags & TIME_PAGE_TSC_IS_USABLE;
+        // Without the time stamp counter, the page only has the resolution of the kernel's time keeper.
+        // That's no worse than what the kernel has for the wall clock, but the monotonic clock can do better.
+        if (clock_id == CLOCK_MONOTONIC && !tsc_is_usable)
+            return false;
+        nanoseconds = clock_id == CLOCK_MONOTONIC ? page->monotonic_nanoseconds : page->realtime_nanoseconds;
+        if (tsc_is_usable) {
+            u64 now = read_tsc();
+            u64 elapsed_ticks = now > page->tsc ? now - page->tsc : 0;
+            // The page is updated every millisecond or so. If it's been this long, something is off.
+            if (elapsed_ticks > 0xffffffff)
+                return false;
+            nanoseconds += (elapsed_ticks * page->tsc_multiplier) >> page->tsc_shift;
+        }
+        asm volatile("" ::: "memory");
+        if (page->sequence == sequence)
+            break;
+    }
+    if (clock_id != CLOCK_MONOTONIC)
+        return true;
+
+    // Extrapolating from the time stamp counter can get ahead of the next update a little.
+    // Don't let the clock go backwards when that happens.
+    auto last = s_last_monotonic_nanoseconds.load(AK::memory_order_relaxed);
+    do {
+        if (nanoseconds <= last) {
+            nanoseconds = last;
+            break;
+        }
+    } while (!s_last_monotonic_nanoseconds.compare_exchange_strong(last, nanoseconds, AK::memory_order_relaxed));
+    return true;
+}
+
 time_t time(time_t* tloc)
 {
     struct timeval tv;
@@ -50,6 +123,12 @@ time_t time(time_t* tloc)
 
 int gettimeofday(struct timeval* __restrict__ tv, void* __restrict__)
 {
+    u64 nanoseconds;
+    if (read_time_page(CLOCK_REALTIME, nanoseconds)) {
+        tv->tv_sec = nanoseconds / 1'000'000'000;
+        tv->tv_usec = nanoseconds % 1'000'000'000 / 1000;
+        return 0;
+    }
     int rc = syscall(SC_gettimeofday, tv);
     __RETURN_WITH_ERRNO(rc, rc, -1);
 }
@@ -313,6 +392,12 @@ clock_t clock()
 
 int clock_gettime(clockid_t clock_id, struct timespec* ts)
 {
+    u64 nanoseconds;
+    if ((clock_id == CLOCK_MONOTONIC || clock_id == CLOCK_REALTIME) && read_time_page(clock_id, nanoseconds)) {
+        ts->tv_sec = nanoseconds / 1'000'000'000;
+        ts->tv_nsec = nanoseconds % 1'000'000'000;
+        return 0;
+    }
     int rc = syscall(SC_clock_gettime, clock_id, ts);
     __RETURN_WITH_ERRNO(rc, rc, -1);
 }
@@ -41,6 +41,7 @@
 #include <sys/ioctl.h>
 #include <sys/mman.h>
 #include <sys/types.h>
+#include <sys/uio.h>
 #include <termios.h>
 #include <unistd.h>
 
@@ -605,9 +606,14 @@ void sysbeep()
 
 int fsync(int fd)
 {
-    UNUSED_PARAM(fd);
-    dbgprintf("FIXME: Implement fsync()\n");
-    return 0;
+    int rc = syscall(SC_fsync, fd);
+    __RETURN_WITH_ERRNO(rc, rc, -1);
+}
+
+int fdatasync(int fd)
+{
+    int rc = syscall(SC_fdatasync, fd);
+    __RETURN_WITH_ERRNO(rc, rc, -1);
 }
 
 int halt()
@@ -699,12 +705,14 @@ int unveil(const char* path, const char* permissions)
 
 ssize_t pread(int fd, void* buf, size_t count, off_t offset)
 {
-    // FIXME: This is not thread safe and should be implemented in the kernel instead.
-    off_t old_offset = lseek(fd, 0, SEEK_CUR);
-    lseek(fd, offset, SEEK_SET);
-    ssize_t nread = read(fd, buf, count);
-    lseek(fd, old_offset, SEEK_SET);
-    return nread;
+    iovec vec { buf, count };
+    return preadv(fd, &vec, 1, offset);
+}
+
+ssize_t pwrite(int fd, const void* buf, size_t count, off_t offset)
+{
+    iovec vec { const_cast<void*>(buf), count };
+    return pwritev(fd, &vec, 1, offset);
 }
 
 char* getpass(const char* prompt)
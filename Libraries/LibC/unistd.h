@@ -58,6 +58,7 @@ int get_process_name(char* buffer, int buffer_size);
 int set_process_name(const char* name, size_t name_length);
 void dump_backtrace();
 int fsync(int fd);
+int fdatasync(int fd);
 void sysbeep();
 int gettid();
 int donate(int tid);
@@ -100,6 +101,7 @@ int tcsetpgrp(int fd, pid_t pgid);
 ssize_t read(int fd, void* buf, size_t count);
 ssize_t pread(int fd, void* buf, size_t count, off_t);
 ssize_t write(int fd, const void* buf, size_t count);
+ssize_t pwrite(int fd, const void* buf, size_t count, off_t);
 int close(int fd);
 int chdir(const char* path);
 int fchdir(int fd);
@@ -25,402 +25,1049 @@
  */
 
 #include <AK/Assertions.h>
+#include <AK/ByteBuffer.h>
 #include <AK/LogStream.h>
+#include <AK/QuickSort.h>
 #include <AK/Span.h>
+#include <AK/StdLibExtras.h>
 #include <AK/Types.h>
 #include <AK/Vector.h>
 #include <LibCompress/Deflate.h>
+#include <string.h>
 
 namespace Compress {
 
-Vector<u8> Deflate::decompress()
-{
-    bool is_final_block = false;
+static constexpr u16 length_bases[] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+static constexpr u8 length_extra_bits[] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+static constexpr u16 distance_bases[] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+static constexpr u8 distance_extra_bits[] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+static constexpr u8 code_length_order[] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
 
-    do {
-        is_final_block = m_reader.read();
-        auto block_type = m_reader.read_bits(2);
+static constexpr size_t literal_primary_bits = 10;
+static constexpr size_t distance_primary_bits = 8;
+static constexpr size_t code_length_primary_bits = 7;
 
-        switch (block_type) {
-        case 0:
-            decompress_uncompressed_block();
-            break;
-        case 1:
-            decompress_static_block();
-            break;
-        case 2:
-            decompress_dynamic_block();
-            break;
-        case 3:
-            dbg() << "Block contains reserved block type...";
-            ASSERT_NOT_REACHED();
-            break;
-        default:
-            dbg() << "Invalid block type was read...";
-            ASSERT_NOT_REACHED();
-            break;
-        }
-    } while (!is_final_block);
-
-    return m_output_buffer;
+static u32 reverse_bits(u32 code, size_t length)
+{
+    u32 result = 0;
+    for (size_t i = 0; i < length; ++i) {
+        result = (result << 1) | (code & 1);
+        code >>= 1;
+    }
+    return result;
 }
 
-void Deflate::decompress_uncompressed_block()
+Optional<CanonicalCode> CanonicalCode::from_lengths(ReadonlyBytes code_lengths, size_t primary_bits)
 {
-    // Align to the next byte boundary.
-    while (m_reader.get_bit_byte_offset() != 0) {
-        m_reader.read();
+    ASSERT(primary_bits <= max_primary_bits);
+    ASSERT(code_lengths.size() <= max_symbol_count);
+
+    u16 length_counts[max_code_length + 1] = {};
+    for (auto length : code_lengths) {
+        if (length > max_code_length)
+            return {};
+        ++length_counts[length];
+    }
+    length_counts[0] = 0;
+
+    // Over-subscribed codes can't be decoded. Incomplete ones are fine,
+    // the bit patterns they leave unassigned just fail to decode.
+    i32 codes_left = 1;
+    for (size_t length = 1; length <= max_code_length; ++length) {
+        codes_left = (codes_left << 1) - length_counts[length];
+        if (codes_left < 0)
+            return {};
     }
 
-    auto length = m_reader.read_bits(16) & 0xFFFF;
-    auto negated_length = m_reader.read_bits(16) & 0xFFFF;
+    u16 next_code[max_code_length + 1] = {};
+    for (size_t length = 1, code = 0; length <= max_code_length; ++length) {
+        code = (code + length_counts[length - 1]) << 1;
+        next_code[length] = code;
+    }
 
-    if ((length ^ 0xFFFF) != negated_length) {
-        dbg() << "Block length is invalid...";
-        ASSERT_NOT_REACHED();
+    // DEFLATE packs codes starting at their most significant bit, so table
+    // indices are the codes with their bits reversed.
+    u16 codes[max_symbol_count];
+    for (size_t symbol = 0; symbol < code_lengths.size(); ++symbol) {
+        auto length = code_lengths[symbol];
+        if (length)
+            codes[symbol] = reverse_bits(next_code[length]++, length);
     }
 
-    for (size_t i = 0; i < length; i++) {
-        auto byte = m_reader.read_byte();
-        if (byte < 0) {
-            dbg() << "Ran out of bytes while reading uncompressed block...";
-            ASSERT_NOT_REACHED();
-        }
+    CanonicalCode code;
+    code.m_primary_bits = primary_bits;
+    code.m_primary_mask = (1u << primary_bits) - 1;
 
-        m_output_buffer.append(byte);
-        m_history_buffer.enqueue(byte);
+    // Codes longer than the primary table are grouped by their first primary_bits bits,
+    // and each group gets a second level table wide enough for its longest code.
+    u8 subtable_bits[1 << max_primary_bits] = {};
+    for (size_t symbol = 0; symbol < code_lengths.size(); ++symbol) {
+        auto length = code_lengths[symbol];
+        if (length <= primary_bits)
+            continue;
+        auto& bits = subtable_bits[codes[symbol] & code.m_primary_mask];
+        bits = max<u8>(bits, length - primary_bits);
+    }
+
+    size_t table_size = 1 << primary_bits;
+    for (size_t prefix = 0; prefix < (1u << primary_bits); ++prefix) {
+        if (subtable_bits[prefix])
+            table_size += 1 << subtable_bits[prefix];
+    }
+    code.m_table.resize(table_size);
+    memset(code.m_table.data(), 0, table_size * sizeof(u32));
+
+    for (size_t prefix = 0, offset = 1 << primary_bits; prefix < (1u << primary_bits); ++prefix) {
+        if (!subtable_bits[prefix])
+            continue;
+        code.m_table[prefix] = subtable_flag | (subtable_bits[prefix] << 16) | offset;
+        offset += 1 << subtable_bits[prefix];
     }
+
+    for (size_t symbol = 0; symbol < code_lengths.size(); ++symbol) {
+        u32 length = code_lengths[symbol];
+        if (!length)
+            continue;
+        u32 entry = (length << 16) | symbol;
+        if (length <= primary_bits) {
+            for (size_t index = codes[symbol]; index < (1u << primary_bits); index += 1 << length)
+                code.m_table[index] = entry;
+            continue;
+        }
+        auto subtable = code.m_table[codes[symbol] & code.m_primary_mask];
+        auto base = subtable & symbol_mask;
+        for (size_t index = codes[symbol] >> primary_bits; index < (1u << entry_length(subtable)); index += 1 << (length - primary_bits))
+            code.m_table[base + index] = entry;
+    }
+
+    return code;
 }
 
-void Deflate::decompress_static_block()
+static const CanonicalCode& fixed_literal_codes()
 {
-    decompress_huffman_block(m_literal_length_codes, &m_fixed_distance_codes);
+    static CanonicalCode code = [] {
+        u8 lengths[288];
+        memset(lengths, 8, 144);
+        memset(lengths + 144, 9, 256 - 144);
+        memset(lengths + 256, 7, 280 - 256);
+        memset(lengths + 280, 8, 288 - 280);
+        return CanonicalCode::from_lengths({ lengths, sizeof(lengths) }, literal_primary_bits).release_value();
+    }();
+    return code;
 }
 
-void Deflate::decompress_dynamic_block()
+static const CanonicalCode& fixed_distance_codes()
 {
-    auto codes = decode_huffman_codes();
-    if (codes.size() == 2) {
-        decompress_huffman_block(codes[0], &codes[1]);
-    } else {
-        decompress_huffman_block(codes[0], nullptr);
-    }
+    static CanonicalCode code = [] {
+        u8 lengths[32];
+        memset(lengths, 5, sizeof(lengths));
+        return CanonicalCode::from_lengths({ lengths, sizeof(lengths) }, distance_primary_bits).release_value();
+    }();
+    return code;
 }
 
-void Deflate::decompress_huffman_block(CanonicalCode& length_codes, CanonicalCode* distance_codes)
+DeflateDecompressor::DeflateDecompressor(ReadonlyBytes data)
+    : m_input(data)
+    , m_window(ByteBuffer::create_uninitialized(window_size))
 {
-    for (;;) {
-        u32 symbol = length_codes.next_symbol(m_reader);
+}
 
-        // End of block.
-        if (symbol == 256) {
+DeflateDecompressor::DeflateDecompressor()
+    : m_input_complete(false)
+    , m_window(ByteBuffer::create_uninitialized(window_size))
+{
+}
+
+void DeflateDecompressor::set_input(ReadonlyBytes data, bool is_complete)
+{
+    ASSERT(data.size() >= m_input.size());
+    m_input = data;
+    m_input_complete = is_complete;
+}
+
+Optional<ByteBuffer> DeflateDecompressor::decompress_all(ReadonlyBytes data)
+{
+    DeflateDecompressor decompressor { data };
+
+    auto output = ByteBuffer::create_uninitialized(max<size_t>(data.size() * 4, 4096));
+    size_t output_size = 0;
+    for (;;) {
+        if (output_size == output.size())
+            output.grow(output.size() * 2);
+        output_size += decompressor.read({ output.data() + output_size, output.size() - output_size });
+        if (decompressor.has_error())
+            return {};
+        if (decompressor.is_finished())
             break;
-        }
+    }
 
-        // literal byte.
-        if (symbol < 256) {
-            m_history_buffer.enqueue(symbol);
-            m_output_buffer.append(symbol);
+    output.trim(output_size);
+    return output;
+}
+
+size_t DeflateDecompressor::read(Bytes bytes)
+{
+    size_t nread = 0;
+    while (nread < bytes.size()) {
+        if (m_read_position == m_write_position) {
+            if (!decode_more())
+                break;
             continue;
         }
 
-        // Length and distance for copying.
-        ASSERT(distance_codes);
+        size_t read_offset = m_read_position & window_mask;
+        auto chunk_size = min<size_t>(m_write_position - m_read_position, bytes.size() - nread);
+        chunk_size = min(chunk_size, window_size - read_offset);
+        memcpy(bytes.data() + nread, m_window.data() + read_offset, chunk_size);
+        m_read_position += chunk_size;
+        nread += chunk_size;
+    }
+    return nread;
+}
 
-        auto run = decode_run_length(symbol);
-        if (run < 3 || run > 258) {
-            dbg() << "Invalid run length";
-            ASSERT_NOT_REACHED();
-        }
+bool DeflateDecompressor::fail(const char* reason)
+{
+    dbg() << "DeflateDecompressor: " << reason;
+    m_state = State::Error;
+    return false;
+}
 
-        auto distance_symbol = distance_codes->next_symbol(m_reader);
-        auto distance = decode_distance(distance_symbol);
-        if (distance < 1 || distance > 32768) {
-            dbg() << "Invalid distance";
-            ASSERT_NOT_REACHED();
-        }
+void DeflateDecompressor::refill()
+{
+    // NOTE: This assumes a little-endian host.
+    if (m_input.size() - m_input_offset >= sizeof(u64)) {
+        // Load a whole word and keep as many of its bytes as fit. The rest end up above
+        // m_bit_count, where the next refill would have put the same bits anyway.
+        u64 word;
+        memcpy(&word, m_input.offset(m_input_offset), sizeof(word));
+        m_bit_buffer |= word << m_bit_count;
+        auto byte_count = (63 - m_bit_count) / 8;
+        m_input_offset += byte_count;
+        m_bit_count += byte_count * 8;
+        return;
+    }
 
-        copy_from_history(distance, run);
+    while (m_bit_count <= 56 && m_input_offset < m_input.size()) {
+        m_bit_buffer |= (u64)m_input[m_input_offset++] << m_bit_count;
+        m_bit_count += 8;
     }
 }
 
-Vector<CanonicalCode> Deflate::decode_huffman_codes()
+bool DeflateDecompressor::decode_more()
 {
-    // FIXME: This path is not tested.
-    Vector<CanonicalCode> result;
+    switch (m_state) {
+    case State::BlockHeader:
+        return decode_block_header();
+    case State::StoredBlock:
+        return decode_stored_block();
+    case State::HuffmanBlock:
+        return decode_huffman_block();
+    case State::Finished:
+    case State::Error:
+        return false;
+    }
+    ASSERT_NOT_REACHED();
+}
 
-    auto length_code_count = m_reader.read_bits(5) + 257;
-    auto distance_code_count = m_reader.read_bits(5) + 1;
+// The longest possible block header: the block type, the code counts, the code length code,
+// and every literal/length and distance code length as a 7 bit code with 7 extra bits.
+static constexpr size_t max_block_header_bits = 3 + 14 + 19 * 3 + (286 + 30) * 14;
 
-    size_t length_code_code_length = m_reader.read_bits(4) + 4;
+// The longest possible length/distance pair, each a 15 bit code with up to 13 extra bits.
+static constexpr size_t max_symbol_bits = 15 + 5 + 15 + 13;
 
-    Vector<u8> code_length_code_length;
-    code_length_code_length.resize(19);
-    code_length_code_length[16] = m_reader.read_bits(3);
-    code_length_code_length[17] = m_reader.read_bits(3);
-    code_length_code_length[18] = m_reader.read_bits(3);
-    code_length_code_length[0] = m_reader.read_bits(3);
-    for (size_t i = 0; i < length_code_code_length; i++) {
-        auto index = (i % 2 == 0) ? (8 + (i / 2)) : (7 - (i / 2));
-        code_length_code_length[index] = m_reader.read_bits(3);
+bool DeflateDecompressor::decode_block_header()
+{
+    if (!has_input_for(max_block_header_bits))
+        return false;
+
+    u32 is_final_block;
+    u32 block_type;
+    if (!read_bits(1, is_final_block) || !read_bits(2, block_type))
+        return fail("Ran out of input while reading a block header");
+    m_is_final_block = is_final_block;
+
+    switch (block_type) {
+    case 0: {
+        // Stored blocks start at the next byte boundary.
+        consume_bits(m_bit_count % 8);
+
+        u32 length;
+        u32 negated_length;
+        if (!read_bits(16, length) || !read_bits(16, negated_length))
+            return fail("Ran out of input while reading a stored block header");
+        if ((length ^ 0xffff) != negated_length)
+            return fail("Stored block length is invalid");
+
+        m_stored_bytes_remaining = length;
+        m_state = State::StoredBlock;
+        return true;
     }
+    case 1:
+        m_literal_codes = &fixed_literal_codes();
+        m_distance_codes = &fixed_distance_codes();
+        m_state = State::HuffmanBlock;
+        return true;
+    case 2:
+        if (!decode_dynamic_codes())
+            return false;
+        m_literal_codes = &m_dynamic_literal_codes.value();
+        m_distance_codes = &m_dynamic_distance_codes.value();
+        m_state = State::HuffmanBlock;
+        return true;
+    default:
+        return fail("Block uses the reserved block type");
+    }
+}
 
-    auto code_length_code = CanonicalCode(code_length_code_length);
+bool DeflateDecompressor::decode_dynamic_codes()
+{
+    u32 literal_code_count;
+    u32 distance_code_count;
+    u32 code_length_code_count;
+    if (!read_bits(5, literal_code_count) || !read_bits(5, distance_code_count) || !read_bits(4, code_length_code_count))
+        return fail("Ran out of input while reading code counts");
+    literal_code_count += 257;
+    distance_code_count += 1;
+    code_length_code_count += 4;
+    if (literal_code_count > 286 || distance_code_count > 30)
+        return fail("Too many literal/length or distance codes");
+
+    u8 code_length_code_lengths[sizeof(code_length_order)] = {};
+    for (size_t i = 0; i < code_length_code_count; ++i) {
+        u32 length;
+        if (!read_bits(3, length))
+            return fail("Ran out of input while reading the code length code");
+        code_length_code_lengths[code_length_order[i]] = length;
+    }
 
-    Vector<u32> code_lens;
-    code_lens.resize(length_code_count + distance_code_count);
+    auto code_length_code = CanonicalCode::from_lengths({ code_length_code_lengths, sizeof(code_length_code_lengths) }, code_length_primary_bits);
+    if (!code_length_code.has_value())
+        return fail("Code length code is over-subscribed");
 
-    for (size_t index = 0; index < code_lens.capacity();) {
-        auto symbol = code_length_code.next_symbol(m_reader);
+    // Literal/length and distance code lengths form one sequence, and repeats may cross between them.
+    u8 code_lengths[286 + 30];
+    auto total_code_count = literal_code_count + distance_code_count;
+    for (size_t index = 0; index < total_code_count;) {
+        u16 symbol;
+        if (!decode_symbol(code_length_code.value(), symbol))
+            return fail("Invalid code length code");
 
-        if (symbol <= 15) {
-            code_lens[index] = symbol;
-            index++;
+        if (symbol < 16) {
+            code_lengths[index++] = symbol;
             continue;
         }
 
-        u32 run_length;
-        u32 run_value = 0;
-
+        u8 repeated_length = 0;
+        u32 repeat_count;
+        bool ok;
         if (symbol == 16) {
-            if (index == 0) {
-                dbg() << "No code length value avaliable";
-                ASSERT_NOT_REACHED();
-            }
-
-            run_length = m_reader.read_bits(2) + 3;
-            run_value = code_lens[index - 1];
+            if (index == 0)
+                return fail("Code length repeat without a previous length");
+            repeated_length = code_lengths[index - 1];
+            ok = read_bits(2, repeat_count);
+            repeat_count += 3;
         } else if (symbol == 17) {
-            run_length = m_reader.read_bits(3) + 3;
-        } else if (symbol == 18) {
-            run_length = m_reader.read_bits(7) + 11;
+            ok = read_bits(3, repeat_count);
+            repeat_count += 3;
         } else {
-            dbg() << "Code symbol is out of range!";
-            ASSERT_NOT_REACHED();
+            ok = read_bits(7, repeat_count);
+            repeat_count += 11;
         }
+        if (!ok)
+            return fail("Ran out of input while reading code lengths");
+        if (index + repeat_count > total_code_count)
+            return fail("Code length repeat runs past the end");
+
+        memset(code_lengths + index, repeated_length, repeat_count);
+        index += repeat_count;
+    }
+
+    if (!code_lengths[256])
+        return fail("Block has no end-of-block code");
 
-        u32 end = index + run_length;
-        if (end > code_lens.capacity()) {
-            dbg() << "Code run is out of range!";
-            ASSERT_NOT_REACHED();
+    m_dynamic_literal_codes = CanonicalCode::from_lengths({ code_lengths, literal_code_count }, literal_primary_bits);
+    m_dynamic_distance_codes = CanonicalCode::from_lengths({ code_lengths + literal_code_count, distance_code_count }, distance_primary_bits);
+    if (!m_dynamic_literal_codes.has_value() || !m_dynamic_distance_codes.has_value())
+        return fail("Literal/length or distance code is over-subscribed");
+    return true;
+}
+
+bool DeflateDecompressor::decode_stored_block()
+{
+    auto* window = m_window.data();
+    auto start_position = m_write_position;
+    while (m_stored_bytes_remaining && m_write_position - m_read_position < history_size) {
+        size_t write_offset = m_write_position & window_mask;
+
+        // Drain whatever is left in the bit buffer first, then copy straight from the input.
+        if (m_bit_count >= 8) {
+            window[write_offset] = m_bit_buffer & 0xff;
+            consume_bits(8);
+            ++m_write_position;
+            --m_stored_bytes_remaining;
+            continue;
+        }
+        ASSERT(m_bit_count == 0);
+        m_bit_buffer = 0;
+
+        size_t chunk_size = min<size_t>(m_stored_bytes_remaining, m_input.size() - m_input_offset);
+        chunk_size = min(chunk_size, window_size - write_offset);
+        chunk_size = min<size_t>(chunk_size, history_size - (m_write_position - m_read_position));
+        if (!chunk_size) {
+            if (!m_input_complete)
+                return m_write_position != start_position;
+            return fail("Ran out of input while reading a stored block");
         }
 
-        memset(code_lens.data() + index, run_value, run_length);
-        index = end;
+        memcpy(window + write_offset, m_input.offset(m_input_offset), chunk_size);
+        m_input_offset += chunk_size;
+        m_write_position += chunk_size;
+        m_stored_bytes_remaining -= chunk_size;
     }
 
-    Vector<u8> literal_codes;
-    literal_codes.resize(length_code_count);
-    memcpy(literal_codes.data(), code_lens.data(), literal_codes.capacity());
-    result.append(CanonicalCode(literal_codes));
-
-    Vector<u8> distance_codes;
-    distance_codes.resize(distance_code_count);
-    memcpy(distance_codes.data(), code_lens.data() + length_code_count, distance_codes.capacity());
+    if (!m_stored_bytes_remaining)
+        m_state = m_is_final_block ? State::Finished : State::BlockHeader;
+    return true;
+}
 
-    if (distance_code_count == 1 && distance_codes[0] == 0) {
-        return result;
+ALWAYS_INLINE static void copy_match(u8* window, size_t window_mask, u64 write_position, u32 distance, u32 length)
+{
+    auto from = (write_position - distance) & window_mask;
+    auto to = write_position & window_mask;
+    if (distance >= length && from + length <= window_mask && to + length <= window_mask) {
+        memcpy(window + to, window + from, length);
+        return;
     }
+    // Overlapping matches repeat the bytes they've just written, so they have to go one byte at a time.
+    for (u32 i = 0; i < length; ++i)
+        window[(to + i) & window_mask] = window[(from + i) & window_mask];
+}
+
+bool DeflateDecompressor::decode_huffman_block()
+{
+    auto* window = m_window.data();
+    auto& literal_codes = *m_literal_codes;
+    auto& distance_codes = *m_distance_codes;
+    auto start_position = m_write_position;
 
-    u8 one_count = 0;
-    u8 other_count = 0;
+    while (m_write_position - m_read_position < history_size) {
+        if (!has_input_for(max_symbol_bits))
+            return m_write_position != start_position;
 
-    for (size_t i = 0; i < distance_codes.capacity(); i++) {
-        u8 value = distance_codes.at(i);
+        u16 symbol;
+        if (!decode_symbol(literal_codes, symbol))
+            return fail("Invalid literal/length code");
 
-        if (value == 1) {
-            one_count++;
-        } else if (value > 1) {
-            other_count++;
+        if (symbol < 256) {
+            window[m_write_position++ & window_mask] = symbol;
+            continue;
+        }
+
+        if (symbol == 256) {
+            m_state = m_is_final_block ? State::Finished : State::BlockHeader;
+            return true;
         }
+
+        symbol -= 257;
+        if (symbol >= sizeof(length_bases) / sizeof(length_bases[0]))
+            return fail("Invalid length symbol");
+        u32 length;
+        if (!read_bits(length_extra_bits[symbol], length))
+            return fail("Ran out of input while reading a length");
+        length += length_bases[symbol];
+
+        if (!decode_symbol(distance_codes, symbol))
+            return fail("Invalid distance code");
+        if (symbol >= sizeof(distance_bases) / sizeof(distance_bases[0]))
+            return fail("Invalid distance symbol");
+        u32 distance;
+        if (!read_bits(distance_extra_bits[symbol], distance))
+            return fail("Ran out of input while reading a distance");
+        distance += distance_bases[symbol];
+        if (distance > m_write_position)
+            return fail("Distance reaches back past the start of the stream");
+
+        copy_match(window, window_mask, m_write_position, distance, length);
+        m_write_position += length;
     }
+    return true;
+}
 
-    if (one_count == 1 && other_count == 0) {
-        distance_codes.resize(32);
-        distance_codes[31] = 1;
+// Maps match lengths and distances to their symbols. Distances above 256 share
+// a symbol with every other distance in the same 128 byte range.
+struct SymbolTables {
+    u8 length_symbols[259];
+    u8 distance_symbols[512];
+
+    constexpr SymbolTables()
+        : length_symbols()
+        , distance_symbols()
+    {
+        for (size_t symbol = 0; symbol < sizeof(length_bases) / sizeof(length_bases[0]); ++symbol) {
+            for (size_t length = length_bases[symbol]; length < length_bases[symbol] + (1u << length_extra_bits[symbol]) && length <= 258; ++length)
+                length_symbols[length] = symbol;
+        }
+        for (size_t symbol = 0; symbol < sizeof(distance_bases) / sizeof(distance_bases[0]); ++symbol) {
+            for (size_t distance = distance_bases[symbol]; distance < distance_bases[symbol] + (1u << distance_extra_bits[symbol]); ++distance)
+                distance_symbols[distance <= 256 ? distance - 1 : 256 + ((distance - 1) >> 7)] = symbol;
+        }
     }
 
-    result.append(CanonicalCode(distance_codes));
-    return result;
-}
+    constexpr u8 length_symbol(size_t length) const { return length_symbols[length]; }
+    constexpr u8 distance_symbol(size_t distance) const { return distance_symbols[distance <= 256 ? distance - 1 : 256 + ((distance - 1) >> 7)]; }
+};
 
-u32 Deflate::decode_run_length(u32 symbol)
+constexpr static auto symbol_tables = SymbolTables();
+
+// Computes length limited Huffman code lengths for the given symbol frequencies.
+// Unused symbols get a length of 0.
+static void build_code_lengths(const u32* frequencies, size_t count, size_t max_length, u8* lengths)
 {
-    if (symbol <= 264) {
-        return symbol - 254;
+    struct Node {
+        u32 key;
+        u16 symbol;
+    };
+
+    Vector<Node, 288> nodes;
+    for (size_t symbol = 0; symbol < count; ++symbol) {
+        if (frequencies[symbol])
+            nodes.append({ frequencies[symbol], (u16)symbol });
+    }
+
+    memset(lengths, 0, count);
+    if (nodes.is_empty())
+        return;
+    if (nodes.size() == 1) {
+        lengths[nodes[0].symbol] = 1;
+        return;
     }
 
-    if (symbol <= 284) {
-        auto extra_bits = (symbol - 261) / 4;
-        return ((((symbol - 265) % 4) + 4) << extra_bits) + 3 + m_reader.read_bits(extra_bits);
+    quick_sort(nodes, [](auto& a, auto& b) { return a.key < b.key; });
+
+    // Moffat and Katajainen's in-place algorithm: the keys first become parent
+    // indices of the internal nodes, then the depth of each leaf.
+    int n = nodes.size();
+    nodes[0].key += nodes[1].key;
+    int root = 0;
+    int leaf = 2;
+    for (int next = 1; next < n - 1; ++next) {
+        if (leaf >= n || nodes[root].key < nodes[leaf].key) {
+            nodes[next].key = nodes[root].key;
+            nodes[root++].key = next;
+        } else {
+            nodes[next].key = nodes[leaf++].key;
+        }
+        if (leaf >= n || (root < next && nodes[root].key < nodes[leaf].key)) {
+            nodes[next].key += nodes[root].key;
+            nodes[root++].key = next;
+        } else {
+            nodes[next].key += nodes[leaf++].key;
+        }
+    }
+    nodes[n - 2].key = 0;
+    for (int next = n - 3; next >= 0; --next)
+        nodes[next].key = nodes[nodes[next].key].key + 1;
+
+    int available = 1;
+    int used = 0;
+    u32 depth = 0;
+    root = n - 2;
+    int next = n - 1;
+    while (available > 0) {
+        while (root >= 0 && nodes[root].key == depth) {
+            ++used;
+            --root;
+        }
+        while (available > used) {
+            nodes[next--].key = depth;
+            --available;
+        }
+        available = 2 * used;
+        ++depth;
+        used = 0;
     }
 
-    if (symbol == 285) {
-        return 258;
+    // Clamp overlong codes, then lengthen shorter ones until the code is no longer over-subscribed.
+    u32 length_counts[CanonicalCode::max_code_length + 1] = {};
+    for (auto& node : nodes)
+        ++length_counts[min<size_t>(node.key, max_length)];
+
+    u32 total = 0;
+    for (size_t length = max_length; length > 0; --length)
+        total += length_counts[length] << (max_length - length);
+    while (total != (1u << max_length)) {
+        --length_counts[max_length];
+        for (size_t length = max_length - 1; length > 0; --length) {
+            if (length_counts[length]) {
+                --length_counts[length];
+                length_counts[length + 1] += 2;
+                break;
+            }
+        }
+        --total;
     }
 
-    dbg() << "Found invalid symbol in run length " << symbol;
-    ASSERT_NOT_REACHED();
+    // The nodes are still sorted by frequency, so the most frequent symbols get the shortest codes.
+    size_t index = nodes.size();
+    for (size_t length = 1; length <= max_length; ++length) {
+        for (auto i = length_counts[length]; i > 0; --i)
+            lengths[nodes[--index].symbol] = length;
+    }
 }
 
-u32 Deflate::decode_distance(u32 symbol)
+static void assign_codes(const u8* lengths, size_t count, u16* codes)
 {
-    if (symbol <= 3) {
-        return symbol + 1;
+    u16 length_counts[CanonicalCode::max_code_length + 1] = {};
+    for (size_t symbol = 0; symbol < count; ++symbol)
+        ++length_counts[lengths[symbol]];
+    length_counts[0] = 0;
+
+    u16 next_code[CanonicalCode::max_code_length + 1] = {};
+    for (size_t length = 1, code = 0; length <= CanonicalCode::max_code_length; ++length) {
+        code = (code + length_counts[length - 1]) << 1;
+        next_code[length] = code;
     }
 
-    if (symbol <= 29) {
-        auto extra_bits = (symbol / 2) - 1;
-        return (((symbol % 2) + 2) << extra_bits) + 1 + m_reader.read_bits(extra_bits);
+    for (size_t symbol = 0; symbol < count; ++symbol) {
+        auto length = lengths[symbol];
+        codes[symbol] = length ? reverse_bits(next_code[length]++, length) : 0;
     }
+}
 
-    dbg() << "Found invalid symbol in distance" << symbol;
-    ASSERT_NOT_REACHED();
+struct FixedCodes {
+    u8 literal_lengths[288];
+    u16 literal_codes[288];
+    u8 distance_lengths[30];
+    u16 distance_codes[30];
+};
+
+static const FixedCodes& fixed_codes()
+{
+    static FixedCodes codes = [] {
+        FixedCodes codes;
+        memset(codes.literal_lengths, 8, 144);
+        memset(codes.literal_lengths + 144, 9, 256 - 144);
+        memset(codes.literal_lengths + 256, 7, 280 - 256);
+        memset(codes.literal_lengths + 280, 8, 288 - 280);
+        memset(codes.distance_lengths, 5, sizeof(codes.distance_lengths));
+        assign_codes(codes.literal_lengths, 288, codes.literal_codes);
+        assign_codes(codes.distance_lengths, 30, codes.distance_codes);
+        return codes;
+    }();
+    return codes;
 }
 
-void Deflate::copy_from_history(u32 distance, u32 run)
+DeflateCompressor::DeflateCompressor(int level)
+    : m_buffer(ByteBuffer::create_uninitialized(buffer_size))
 {
-    auto head_index = (m_history_buffer.head_index() + m_history_buffer.size()) % m_history_buffer.capacity();
-    auto read_index = (head_index - distance + m_history_buffer.capacity()) % m_history_buffer.capacity();
+    // For the greedy levels, max_lazy is the longest match whose positions all still get hashed.
+    static constexpr LevelParameters level_parameters[] = {
+        { 4, 4, 8, 4, false },
+        { 4, 5, 16, 8, false },
+        { 4, 6, 32, 32, false },
+        { 4, 4, 16, 16, true },
+        { 8, 16, 32, 32, true },
+        { 8, 16, 128, 128, true },
+        { 8, 32, 128, 256, true },
+        { 32, 128, 258, 1024, true },
+        { 32, 258, 258, 4096, true },
+    };
+    ASSERT(level >= min_level && level <= max_level);
+    m_parameters = level_parameters[level - min_level];
+
+    m_hash_head.resize(hash_size);
+    memset(m_hash_head.data(), 0xff, hash_size * sizeof(i32));
+    m_hash_previous.resize(history_size);
+    memset(m_hash_previous.data(), 0xff, history_size * sizeof(i32));
+
+    m_symbols.ensure_capacity(max_block_symbols);
+    memset(m_literal_frequencies, 0, sizeof(m_literal_frequencies));
+    memset(m_distance_frequencies, 0, sizeof(m_distance_frequencies));
+}
 
-    for (size_t i = 0; i < run; i++) {
-        auto data = m_history_buffer.at(read_index++);
-        m_output_buffer.append(data);
-        m_history_buffer.enqueue(data);
-    }
+ByteBuffer DeflateCompressor::compress_all(ReadonlyBytes data, int level)
+{
+    DeflateCompressor compressor { level };
+    compressor.write(data);
+    compressor.finish();
+    return compressor.take_output();
 }
 
-i8 BitStreamReader::read()
+void DeflateCompressor::write(ReadonlyBytes bytes)
 {
-    if (m_current_byte == -1) {
-        return -1;
+    ASSERT(!m_is_finished);
+    while (!bytes.is_empty()) {
+        if (m_buffer_size == buffer_size)
+            slide_window();
+        auto chunk_size = min(bytes.size(), buffer_size - m_buffer_size);
+        memcpy(m_buffer.data() + m_buffer_size, bytes.data(), chunk_size);
+        m_buffer_size += chunk_size;
+        bytes = bytes.slice(chunk_size, bytes.size() - chunk_size);
+        compress(false);
     }
+}
 
-    if (m_remaining_bits == 0) {
-        if (m_data_index + 1 > m_data.size())
-            return -1;
-
-        m_current_byte = m_data.at(m_data_index++);
-        m_remaining_bits = 8;
-    }
+void DeflateCompressor::finish()
+{
+    ASSERT(!m_is_finished);
+    compress(true);
+    flush_block(true);
+    align_to_byte();
+    m_is_finished = true;
+}
 
-    m_remaining_bits--;
-    return (m_current_byte >> (7 - m_remaining_bits)) & 1;
+ByteBuffer DeflateCompressor::take_output()
+{
+    if (m_output.is_empty())
+        return {};
+    auto output = ByteBuffer::copy(m_output.data(), m_output.size());
+    m_output.clear_with_capacity();
+    return output;
 }
 
-i8 BitStreamReader::read_byte()
+void DeflateCompressor::slide_window()
 {
-    m_current_byte = 0;
-    m_remaining_bits = 0;
+    // Only ever called once compress() has consumed all but the lookahead, which lies in the newer half.
+    ASSERT(m_position >= history_size);
+    memmove(m_buffer.data(), m_buffer.data() + history_size, m_buffer_size - history_size);
+    m_buffer_size -= history_size;
+    m_position -= history_size;
+    m_block_start -= history_size;
+
+    for (auto& position : m_hash_head)
+        position = position >= (i32)history_size ? position - (i32)history_size : -1;
+    for (auto& position : m_hash_previous)
+        position = position >= (i32)history_size ? position - (i32)history_size : -1;
+}
 
-    if (m_data_index + 1 > m_data.size())
+ALWAYS_INLINE i32 DeflateCompressor::insert_hash(size_t position)
+{
+    if (position + min_match > m_buffer_size)
         return -1;
+    auto* bytes = m_buffer.data() + position;
+    u32 hash = ((bytes[0] | bytes[1] << 8 | bytes[2] << 16) * 2654435761u) >> (32 - hash_bits);
+    auto candidate = m_hash_head[hash];
+    m_hash_previous[position & (history_size - 1)] = candidate;
+    m_hash_head[hash] = position;
+    return candidate;
+}
+
+size_t DeflateCompressor::longest_match(size_t position, i32 candidate, size_t previous_length, size_t& match_distance) const
+{
+    size_t max_length = min(max_match, m_buffer_size - position);
+    if (previous_length >= max_length)
+        return previous_length;
+
+    size_t best_length = previous_length;
+    size_t nice_length = min<size_t>(m_parameters.nice_length, max_length);
+    size_t chain_length = m_parameters.max_chain;
+    if (previous_length >= m_parameters.good_length)
+        chain_length >>= 2;
+
+    // The oldest position's chain link has just been overwritten by this one, so stop short of it.
+    ssize_t limit = (ssize_t)position - (ssize_t)history_size;
+    auto* buffer = m_buffer.data();
+    auto* current = buffer + position;
+
+    while (candidate >= 0 && candidate > limit && chain_length--) {
+        auto* match = buffer + candidate;
+        if (match[best_length] == current[best_length] && match[0] == current[0] && match[1] == current[1]) {
+            size_t length = 2;
+            while (length + sizeof(u64) <= max_length) {
+                u64 a;
+                u64 b;
+                memcpy(&a, match + length, sizeof(a));
+                memcpy(&b, current + length, sizeof(b));
+                // NOTE: This assumes a little-endian host.
+                if (auto difference = a ^ b) {
+                    length += __builtin_ctzll(difference) / 8;
+                    goto done;
+                }
+                length += sizeof(u64);
+            }
+            while (length < max_length && match[length] == current[length])
+                ++length;
+        done:
+            if (length > best_length) {
+                best_length = length;
+                match_distance = position - candidate;
+                if (length >= nice_length)
+                    break;
+            }
+        }
 
-    return m_data.at(m_data_index++);
+        auto next = m_hash_previous[candidate & (history_size - 1)];
+        if (next >= candidate)
+            break;
+        candidate = next;
+    }
+    return best_length;
 }
 
-u8 BitStreamReader::get_bit_byte_offset()
+void DeflateCompressor::compress(bool flush)
 {
-    return (8 - m_remaining_bits) % 8;
+    if (m_parameters.lazy)
+        compress_lazy(flush);
+    else
+        compress_greedy(flush);
 }
 
-u32 BitStreamReader::read_bits(u8 count)
+void DeflateCompressor::compress_greedy(bool flush)
 {
-    ASSERT(count > 0 && count < 32);
+    while (flush ? m_position < m_buffer_size : m_buffer_size - m_position >= min_lookahead) {
+        auto candidate = insert_hash(m_position);
+        size_t distance = 0;
+        size_t length = candidate >= 0 ? longest_match(m_position, candidate, min_match - 1, distance) : 0;
+        if (length < min_match) {
+            emit_literal(m_buffer[m_position++]);
+            continue;
+        }
 
-    u32 result = 0;
-    for (size_t i = 0; i < count; i++) {
-        result |= read() << i;
+        emit_match(length, distance);
+        if (length <= m_parameters.max_lazy) {
+            for (size_t i = 1; i < length; ++i)
+                insert_hash(m_position + i);
+        }
+        m_position += length;
     }
-    return result;
 }
 
-Vector<u8> Deflate::generate_literal_length_codes()
+void DeflateCompressor::compress_lazy(bool flush)
 {
-    Vector<u8> ll_codes;
-    ll_codes.resize(288);
-    memset(ll_codes.data() + 0, 8, 144 - 0);
-    memset(ll_codes.data() + 144, 9, 256 - 144);
-    memset(ll_codes.data() + 256, 7, 280 - 256);
-    memset(ll_codes.data() + 280, 8, 288 - 280);
-    return ll_codes;
+    // A match is only taken once the match starting one byte later has turned out not to be longer.
+    while (flush ? m_position < m_buffer_size : m_buffer_size - m_position >= min_lookahead) {
+        auto previous_length = m_match_length;
+        auto previous_distance = m_match_distance;
+        m_match_length = min_match - 1;
+
+        auto candidate = insert_hash(m_position);
+        if (candidate >= 0 && previous_length < m_parameters.max_lazy) {
+            m_match_length = longest_match(m_position, candidate, previous_length, m_match_distance);
+            // A minimal match that far back doesn't save anything over the literals.
+            if (m_match_length == min_match && m_match_distance > 4096)
+                m_match_length = min_match - 1;
+        }
+
+        if (previous_length >= min_match && m_match_length <= previous_length) {
+            emit_match(previous_length, previous_distance);
+            auto match_end = m_position - 1 + previous_length;
+            for (size_t i = m_position + 1; i < match_end; ++i)
+                insert_hash(i);
+            m_position = match_end;
+            m_literal_pending = false;
+            m_match_length = min_match - 1;
+        } else if (m_literal_pending) {
+            emit_literal(m_buffer[m_position - 1]);
+            ++m_position;
+        } else {
+            m_literal_pending = true;
+            ++m_position;
+        }
+    }
+
+    if (flush && m_literal_pending) {
+        emit_literal(m_buffer[m_position - 1]);
+        m_literal_pending = false;
+    }
 }
 
-Vector<u8> Deflate::generate_fixed_distance_codes()
+void DeflateCompressor::emit_literal(u8 literal)
 {
-    Vector<u8> fd_codes;
-    fd_codes.resize(32);
-    memset(fd_codes.data(), 5, 32);
-    return fd_codes;
+    m_symbols.unchecked_append({ literal, 0 });
+    ++m_literal_frequencies[literal];
+    ++m_block_input_size;
+    if (m_symbols.size() == max_block_symbols)
+        flush_block(false);
 }
 
-CanonicalCode::CanonicalCode(Vector<u8> codes)
+void DeflateCompressor::emit_match(size_t length, size_t distance)
 {
-    m_symbol_codes.resize(codes.size());
-    m_symbol_values.resize(codes.size());
-
-    auto allocated_symbols_count = 0;
-    auto next_code = 0;
-
-    for (size_t code_length = 1; code_length <= 15; code_length++) {
-        next_code <<= 1;
-        auto start_bit = 1 << code_length;
+    m_symbols.unchecked_append({ (u16)length, (u16)distance });
+    ++m_literal_frequencies[257 + symbol_tables.length_symbol(length)];
+    ++m_distance_frequencies[symbol_tables.distance_symbol(distance)];
+    m_block_input_size += length;
+    if (m_symbols.size() == max_block_symbols)
+        flush_block(false);
+}
 
-        for (size_t symbol = 0; symbol < codes.size(); symbol++) {
-            if (codes.at(symbol) != code_length) {
-                continue;
+void DeflateCompressor::flush_block(bool is_final)
+{
+    ++m_literal_frequencies[256];
+
+    u8 literal_lengths[literal_code_count];
+    u8 distance_lengths[distance_code_count];
+    build_code_lengths(m_literal_frequencies, literal_code_count, CanonicalCode::max_code_length, literal_lengths);
+    build_code_lengths(m_distance_frequencies, distance_code_count, CanonicalCode::max_code_length, distance_lengths);
+
+    size_t literal_count = literal_code_count;
+    while (literal_count > 257 && !literal_lengths[literal_count - 1])
+        --literal_count;
+    size_t distance_count = distance_code_count;
+    while (distance_count > 1 && !distance_lengths[distance_count - 1])
+        --distance_count;
+
+    // Both sets of code lengths are run-length encoded as one sequence.
+    u8 code_lengths[literal_code_count + distance_code_count];
+    memcpy(code_lengths, literal_lengths, literal_count);
+    memcpy(code_lengths + literal_count, distance_lengths, distance_count);
+    auto code_length_total = literal_count + distance_count;
+
+    struct Run {
+        u8 symbol;
+        u8 extra;
+    };
+    Vector<Run, literal_code_count + distance_code_count> runs;
+    u32 code_length_frequencies[sizeof(code_length_order)] = {};
+    auto append_run = [&](u8 symbol, u8 extra) {
+        runs.append({ symbol, extra });
+        ++code_length_frequencies[symbol];
+    };
+    for (size_t i = 0; i < code_length_total;) {
+        auto length = code_lengths[i];
+        size_t run_length = 1;
+        while (i + run_length < code_length_total && code_lengths[i + run_length] == length)
+            ++run_length;
+        i += run_length;
+
+        if (length == 0) {
+            while (run_length >= 11) {
+                auto count = min<size_t>(run_length, 138);
+                append_run(18, count - 11);
+                run_length -= count;
             }
-
-            if (next_code > start_bit) {
-                dbg() << "Canonical code overflows the huffman tree";
-                ASSERT_NOT_REACHED();
+            if (run_length >= 3) {
+                append_run(17, run_length - 3);
+                run_length = 0;
+            }
+        } else {
+            append_run(length, 0);
+            --run_length;
+            while (run_length >= 3) {
+                auto count = min<size_t>(run_length, 6);
+                append_run(16, count - 3);
+                run_length -= count;
             }
-
-            m_symbol_codes[allocated_symbols_count] = start_bit | next_code;
-            m_symbol_values[allocated_symbols_count] = symbol;
-
-            allocated_symbols_count++;
-            next_code++;
         }
+        while (run_length--)
+            append_run(length, 0);
     }
 
-    if (next_code != (1 << 15)) {
-        dbg() << "Canonical code underflows the huffman tree " << next_code;
-        ASSERT_NOT_REACHED();
+    u8 code_length_lengths[sizeof(code_length_order)];
+    u16 code_length_codes[sizeof(code_length_order)];
+    build_code_lengths(code_length_frequencies, sizeof(code_length_order), 7, code_length_lengths);
+    assign_codes(code_length_lengths, sizeof(code_length_order), code_length_codes);
+    size_t code_length_code_count = sizeof(code_length_order);
+    while (code_length_code_count > 4 && !code_length_lengths[code_length_order[code_length_code_count - 1]])
+        --code_length_code_count;
+
+    // Work out the size of every encoding and pick the smallest.
+    static constexpr u8 run_extra_bits[] = { 2, 3, 7 };
+    u64 dynamic_bits = 3 + 5 + 5 + 4 + 3 * code_length_code_count;
+    for (auto& run : runs)
+        dynamic_bits += code_length_lengths[run.symbol] + (run.symbol >= 16 ? run_extra_bits[run.symbol - 16] : 0);
+    u64 fixed_bits = 3;
+
+    auto& fixed = fixed_codes();
+    for (size_t symbol = 0; symbol < literal_code_count; ++symbol) {
+        u64 frequency = m_literal_frequencies[symbol];
+        dynamic_bits += frequency * literal_lengths[symbol];
+        fixed_bits += frequency * fixed.literal_lengths[symbol];
+        if (symbol >= 257) {
+            dynamic_bits += frequency * length_extra_bits[symbol - 257];
+            fixed_bits += frequency * length_extra_bits[symbol - 257];
+        }
+    }
+    for (size_t symbol = 0; symbol < distance_code_count; ++symbol) {
+        u64 frequency = m_distance_frequencies[symbol];
+        dynamic_bits += frequency * (distance_lengths[symbol] + distance_extra_bits[symbol]);
+        fixed_bits += frequency * (fixed.distance_lengths[symbol] + distance_extra_bits[symbol]);
     }
-}
-
-static i32 binary_search(Vector<u32>& heystack, u32 needle)
-{
-    i32 low = 0;
-    i32 high = heystack.size();
 
-    while (low <= high) {
-        u32 mid = (low + high) >> 1;
-        u32 value = heystack.at(mid);
+    bool can_store = m_block_start >= 0;
+    u64 stored_bits = 0;
+    if (can_store) {
+        auto chunk_count = max<size_t>(1, (m_block_input_size + 0xfffe) / 0xffff);
+        stored_bits = chunk_count * (3 + 7 + 32) + m_block_input_size * 8;
+    }
 
-        if (value < needle) {
-            low = mid + 1;
-        } else if (value > needle) {
-            high = mid - 1;
-        } else {
-            return mid;
+    if (can_store && stored_bits <= min(dynamic_bits, fixed_bits)) {
+        write_stored_block({ m_buffer.data() + m_block_start, m_block_input_size }, is_final);
+    } else if (fixed_bits <= dynamic_bits) {
+        write_bits(is_final, 1);
+        write_bits(1, 2);
+        write_huffman_symbols(fixed.literal_lengths, fixed.literal_codes, fixed.distance_lengths, fixed.distance_codes);
+    } else {
+        u16 literal_codes[literal_code_count];
+        u16 distance_codes[distance_code_count];
+        assign_codes(literal_lengths, literal_code_count, literal_codes);
+        assign_codes(distance_lengths, distance_code_count, distance_codes);
+
+        write_bits(is_final, 1);
+        write_bits(2, 2);
+        write_bits(literal_count - 257, 5);
+        write_bits(distance_count - 1, 5);
+        write_bits(code_length_code_count - 4, 4);
+        for (size_t i = 0; i < code_length_code_count; ++i)
+            write_bits(code_length_lengths[code_length_order[i]], 3);
+        for (auto& run : runs) {
+            write_bits(code_length_codes[run.symbol], code_length_lengths[run.symbol]);
+            if (run.symbol >= 16)
+                write_bits(run.extra, run_extra_bits[run.symbol - 16]);
         }
+        write_huffman_symbols(literal_lengths, literal_codes, distance_lengths, distance_codes);
     }
 
-    return -1;
+    m_symbols.clear_with_capacity();
+    memset(m_literal_frequencies, 0, sizeof(m_literal_frequencies));
+    memset(m_distance_frequencies, 0, sizeof(m_distance_frequencies));
+    m_block_start += m_block_input_size;
+    m_block_input_size = 0;
 }
 
-u32 CanonicalCode::next_symbol(BitStreamReader& reader)
+void DeflateCompressor::write_stored_block(ReadonlyBytes bytes, bool is_final)
 {
-    auto code_bits = 1;
+    // Stored blocks hold at most 65535 bytes each, but even an empty one has to be written out.
+    do {
+        auto chunk_size = min<size_t>(bytes.size(), 0xffff);
+        write_bits(is_final && chunk_size == bytes.size(), 1);
+        write_bits(0, 2);
+        align_to_byte();
+        write_bits(chunk_size, 16);
+        write_bits(chunk_size ^ 0xffff, 16);
+        ASSERT(m_bit_count == 0);
+        m_output.append(bytes.data(), chunk_size);
+        bytes = bytes.slice(chunk_size, bytes.size() - chunk_size);
+    } while (!bytes.is_empty());
+}
 
-    for (;;) {
-        code_bits = code_bits << 1 | reader.read();
-        i32 index = binary_search(m_symbol_codes, code_bits);
-        if (index >= 0) {
-            return m_symbol_values.at(index);
+void DeflateCompressor::write_huffman_symbols(const u8* literal_lengths, const u16* literal_codes, const u8* distance_lengths, const u16* distance_codes)
+{
+    for (auto& symbol : m_symbols) {
+        if (!symbol.distance) {
+            write_bits(literal_codes[symbol.literal_or_length], literal_lengths[symbol.literal_or_length]);
+            continue;
         }
+
+        auto length_symbol = symbol_tables.length_symbol(symbol.literal_or_length);
+        write_bits(literal_codes[257 + length_symbol], literal_lengths[257 + length_symbol]);
+        write_bits(symbol.literal_or_length - length_bases[length_symbol], length_extra_bits[length_symbol]);
+
+        auto distance_symbol = symbol_tables.distance_symbol(symbol.distance);
+        write_bits(distance_codes[distance_symbol], distance_lengths[distance_symbol]);
+        write_bits(symbol.distance - distance_bases[distance_symbol], distance_extra_bits[distance_symbol]);
     }
+    write_bits(literal_codes[256], literal_lengths[256]);
 }
+
+void DeflateCompressor::align_to_byte()
+{
+    while (m_bit_count > 0) {
+        m_output.append((u8)m_bit_buffer);
+        m_bit_buffer >>= 8;
+        m_bit_count = m_bit_count > 8 ? m_bit_count - 8 : 0;
+    }
+    m_bit_buffer = 0;
+}
+
 }
@@ -26,73 +26,260 @@
 
 #pragma once
 
-#include <AK/CircularQueue.h>
+#include <AK/ByteBuffer.h>
+#include <AK/Optional.h>
 #include <AK/Span.h>
 #include <AK/Types.h>
 #include <AK/Vector.h>
-#include <cstring>
 
 namespace Compress {
 
-// Reads one bit at a time starting with the rightmost bit
-class BitStreamReader {
+// A table driven decoder for a canonical Huffman code. Codes of up to primary_bits bits
+// are resolved with a single lookup, longer ones through one second level table.
+class CanonicalCode {
 public:
-    BitStreamReader(ReadonlyBytes data)
-        : m_data(data)
+    static constexpr size_t max_code_length = 15;
+    static constexpr size_t max_primary_bits = 10;
+    static constexpr size_t max_symbol_count = 320;
+
+    static Optional<CanonicalCode> from_lengths(ReadonlyBytes code_lengths, size_t primary_bits);
+
+    // Decodes the symbol at the start of bits (least significant bit first). Fails for bit
+    // patterns that an incomplete code doesn't assign.
+    ALWAYS_INLINE bool decode(u32 bits, u16& symbol, u8& length) const
     {
+        auto entry = m_table[bits & m_primary_mask];
+        if (entry & subtable_flag)
+            entry = m_table[(entry & symbol_mask) + ((bits >> m_primary_bits) & ((1u << entry_length(entry)) - 1))];
+        symbol = entry & symbol_mask;
+        length = entry_length(entry);
+        return length != 0;
     }
 
-    i8 read();
-    i8 read_byte();
-    u32 read_bits(u8);
-    u8 get_bit_byte_offset();
-
 private:
-    ReadonlyBytes m_data;
-    size_t m_data_index { 0 };
+    static constexpr u32 symbol_mask = 0xffff;
+    static constexpr u32 subtable_flag = 1u << 24;
+    static u8 entry_length(u32 entry) { return (entry >> 16) & 0xff; }
 
-    i8 m_current_byte { 0 };
-    u8 m_remaining_bits { 0 };
+    CanonicalCode() { }
+
+    // Each entry holds a symbol and its code length, or for long codes
+    // the offset and index width of a second level table.
+    Vector<u32> m_table;
+    u32 m_primary_bits { 0 };
+    u32 m_primary_mask { 0 };
 };
 
-class CanonicalCode {
+// Incremental inflate for raw DEFLATE streams (RFC 1951). Output is produced
+// on demand through read(), and only the last 32 KiB needed for back
+// references are kept around, so memory use doesn't grow with the stream.
+class DeflateDecompressor {
 public:
-    CanonicalCode(Vector<u8>);
-    u32 next_symbol(BitStreamReader&);
+    explicit DeflateDecompressor(ReadonlyBytes data);
+
+    // Starts without any input. Feed it through set_input() as it arrives.
+    DeflateDecompressor();
+
+    // Replaces the input with a longer view of the same stream, e.g. once more of it has
+    // been downloaded. Until is_complete is set, running out of input isn't an error.
+    void set_input(ReadonlyBytes data, bool is_complete);
+
+    // Decompresses up to bytes.size() bytes and returns how many were written.
+    // Returns less only once the stream is finished or has failed, or
+    // when it needs more input than has been set so far.
+    size_t read(Bytes);
+
+    bool is_finished() const { return m_state == State::Finished && m_read_position == m_write_position; }
+    bool has_error() const { return m_state == State::Error; }
+
+    // The number of input bytes that belong to the stream, once it is finished.
+    size_t consumed_input_size() const { return m_input_offset - m_bit_count / 8; }
+
+    static Optional<ByteBuffer> decompress_all(ReadonlyBytes);
 
 private:
-    Vector<u32> m_symbol_codes;
-    Vector<u32> m_symbol_values;
+    enum class State {
+        BlockHeader,
+        StoredBlock,
+        HuffmanBlock,
+        Finished,
+        Error,
+    };
+
+    static constexpr size_t history_size = 32 * 1024;
+    static constexpr size_t window_size = 2 * history_size;
+    static constexpr size_t window_mask = window_size - 1;
+
+    bool decode_more();
+    bool decode_block_header();
+    bool decode_dynamic_codes();
+    bool decode_stored_block();
+    bool decode_huffman_block();
+    bool fail(const char* reason);
+
+    void refill();
+
+    ALWAYS_INLINE u32 peek_bits(u32 count)
+    {
+        if (m_bit_count < count)
+            refill();
+        return m_bit_buffer & ((1ull << count) - 1);
+    }
+
+    ALWAYS_INLINE bool consume_bits(u32 count)
+    {
+        if (count > m_bit_count)
+            return false;
+        m_bit_buffer >>= count;
+        m_bit_count -= count;
+        return true;
+    }
+
+    ALWAYS_INLINE bool read_bits(u32 count, u32& value)
+    {
+        value = peek_bits(count);
+        return consume_bits(count);
+    }
+
+    ALWAYS_INLINE bool decode_symbol(const CanonicalCode& code, u16& symbol)
+    {
+        u8 length;
+        return code.decode(peek_bits(CanonicalCode::max_code_length), symbol, length) && consume_bits(length);
+    }
+
+    // While more input may still arrive, a step is only started once every bit it could need is here.
+    ALWAYS_INLINE bool has_input_for(size_t bit_count) const
+    {
+        return m_input_complete || m_bit_count + (m_input.size() - m_input_offset) * 8 >= bit_count;
+    }
+
+    ReadonlyBytes m_input;
+    size_t m_input_offset { 0 };
+    bool m_input_complete { true };
+
+    // Bits beyond m_bit_count may hold a preloaded copy of upcoming input.
+    u64 m_bit_buffer { 0 };
+    u32 m_bit_count { 0 };
+
+    State m_state { State::BlockHeader };
+    bool m_is_final_block { false };
+    u32 m_stored_bytes_remaining { 0 };
+
+    const CanonicalCode* m_literal_codes { nullptr };
+    const CanonicalCode* m_distance_codes { nullptr };
+    Optional<CanonicalCode> m_dynamic_literal_codes;
+    Optional<CanonicalCode> m_dynamic_distance_codes;
+
+    // Decoded output lives in a ring buffer twice the size of the history, which leaves
+    // room for up to one history's worth of output that hasn't been read yet.
+    ByteBuffer m_window;
+    u64 m_read_position { 0 };
+    u64 m_write_position { 0 };
 };
 
-class Deflate {
+// Streaming DEFLATE encoder. Matches are found through hash chains over the last
+// 32 KiB of input, and each block is written with whichever of the dynamic Huffman,
+// fixed Huffman or stored encodings comes out smallest.
+class DeflateCompressor {
 public:
-    Deflate(ReadonlyBytes data)
-        : m_reader(data)
-        , m_literal_length_codes(generate_literal_length_codes())
-        , m_fixed_distance_codes(generate_fixed_distance_codes())
+    static constexpr int min_level = 1;
+    static constexpr int max_level = 9;
+    static constexpr int default_level = 6;
+
+    explicit DeflateCompressor(int level = default_level);
+
+    // Compressed output for this input becomes available once enough of it has
+    // been written to complete a block, or once finish() has been called.
+    void write(ReadonlyBytes);
+
+    // Compresses the rest of the input and ends the stream. Nothing can be written afterwards.
+    void finish();
+
+    bool is_finished() const { return m_is_finished; }
+
+    // Hands out the compressed output produced since the last call.
+    ByteBuffer take_output();
+
+    static ByteBuffer compress_all(ReadonlyBytes, int level = default_level);
+
+private:
+    struct LevelParameters {
+        u16 good_length;
+        u16 max_lazy;
+        u16 nice_length;
+        u16 max_chain;
+        bool lazy;
+    };
+
+    // A literal if distance is 0, otherwise a match of length literal_or_length.
+    struct Symbol {
+        u16 literal_or_length;
+        u16 distance;
+    };
+
+    static constexpr size_t history_size = 32 * 1024;
+    static constexpr size_t buffer_size = 2 * history_size;
+    static constexpr size_t min_match = 3;
+    static constexpr size_t max_match = 258;
+    static constexpr size_t min_lookahead = max_match + min_match + 1;
+    static constexpr size_t hash_bits = 15;
+    static constexpr size_t hash_size = 1 << hash_bits;
+    static constexpr size_t max_block_symbols = 16 * 1024;
+    static constexpr size_t literal_code_count = 286;
+    static constexpr size_t distance_code_count = 30;
+
+    void compress(bool flush);
+    void compress_greedy(bool flush);
+    void compress_lazy(bool flush);
+    void slide_window();
+    i32 insert_hash(size_t position);
+    size_t longest_match(size_t position, i32 candidate, size_t previous_length, size_t& match_distance) const;
+    void emit_literal(u8);
+    void emit_match(size_t length, size_t distance);
+    void flush_block(bool is_final);
+    void write_stored_block(ReadonlyBytes, bool is_final);
+    void write_huffman_symbols(const u8* literal_lengths, const u16* literal_codes, const u8* distance_lengths, const u16* distance_codes);
+
+    ALWAYS_INLINE void write_bits(u32 value, u32 count)
     {
+        m_bit_buffer |= (u64)value << m_bit_count;
+        m_bit_count += count;
+        if (m_bit_count >= 32) {
+            u8 bytes[] = { (u8)m_bit_buffer, (u8)(m_bit_buffer >> 8), (u8)(m_bit_buffer >> 16), (u8)(m_bit_buffer >> 24) };
+            m_output.append(bytes, sizeof(bytes));
+            m_bit_buffer >>= 32;
+            m_bit_count -= 32;
+        }
     }
+    void align_to_byte();
 
-    Vector<u8> decompress();
+    LevelParameters m_parameters;
 
-private:
-    void decompress_uncompressed_block();
-    void decompress_static_block();
-    void decompress_dynamic_block();
-    void decompress_huffman_block(CanonicalCode&, CanonicalCode*);
-    Vector<CanonicalCode> decode_huffman_codes();
-    void copy_from_history(u32, u32);
-    u32 decode_run_length(u32);
-    u32 decode_distance(u32);
-    Vector<u8> generate_literal_length_codes();
-    Vector<u8> generate_fixed_distance_codes();
-
-    BitStreamReader m_reader;
-    CircularQueue<u8, 32 * 1024> m_history_buffer;
-    Vector<u8, 256> m_output_buffer;
-
-    CanonicalCode m_literal_length_codes;
-    CanonicalCode m_fixed_distance_codes;
+    // Input lives in a buffer that holds up to two histories' worth. Once it is full, the
+    // older half is dropped and hash chain positions are rebased to the new start.
+    ByteBuffer m_buffer;
+    size_t m_buffer_size { 0 };
+    size_t m_position { 0 };
+    Vector<i32> m_hash_head;
+    Vector<i32> m_hash_previous;
+
+    // State carried between calls by the lazy matcher, relative to m_position.
+    bool m_literal_pending { false };
+    size_t m_match_length { min_match - 1 };
+    size_t m_match_distance { 0 };
+
+    // The current block's symbols, and where its input starts in m_buffer.
+    // After a slide the start can be negative, at which point the block can't be stored.
+    Vector<Symbol> m_symbols;
+    u32 m_literal_frequencies[literal_code_count];
+    u32 m_distance_frequencies[distance_code_count];
+    ssize_t m_block_start { 0 };
+    size_t m_block_input_size { 0 };
+
+    u64 m_bit_buffer { 0 };
+    u32 m_bit_count { 0 };
+    Vector<u8> m_output;
+    bool m_is_finished { false };
 };
+
 }
@@ -24,49 +24,185 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
-#include <AK/Assertions.h>
+#include <AK/LogStream.h>
 #include <AK/Span.h>
 #include <AK/Types.h>
-#include <AK/Vector.h>
 #include <LibCompress/Deflate.h>
 #include <LibCompress/Zlib.h>
 
 namespace Compress {
 
-Zlib::Zlib(ReadonlyBytes data)
+static constexpr size_t header_size = 2;
+static constexpr size_t checksum_size = 4;
+
+ZlibDecompressor::ZlibDecompressor(ReadonlyBytes data)
+    : m_input_data(data)
+    , m_header_parsed(true)
+    , m_decompressor(data.size() >= header_size ? data.slice(header_size, data.size() - header_size) : ReadonlyBytes {})
+{
+    m_has_error = !parse_header();
+}
+
+ZlibDecompressor::ZlibDecompressor()
+    : m_input_complete(false)
+{
+}
+
+void ZlibDecompressor::set_input(ReadonlyBytes data, bool is_complete)
 {
     m_input_data = data;
+    m_input_complete = is_complete;
+
+    if (!m_header_parsed) {
+        if (data.size() < header_size && !is_complete)
+            return;
+        m_header_parsed = true;
+        m_has_error = !parse_header();
+    }
+    if (!m_has_error)
+        m_decompressor.set_input(data.slice(header_size, data.size() - header_size), is_complete);
+}
+
+bool ZlibDecompressor::parse_header()
+{
+    if (m_input_data.size() < header_size + (m_input_complete ? checksum_size : 0)) {
+        dbg() << "ZlibDecompressor: Input is too short";
+        return false;
+    }
 
-    u8 compression_info = data.at(0);
-    u8 flags = data.at(1);
+    u8 compression_info = m_input_data[0];
+    u8 flags = m_input_data[1];
 
-    m_compression_method = compression_info & 0xF;
-    m_compression_info = (compression_info >> 4) & 0xF;
-    m_check_bits = flags & 0xF;
-    m_has_dictionary = (flags >> 5) & 0x1;
-    m_compression_level = (flags >> 6) & 0x3;
+    auto compression_method = compression_info & 0xf;
+    auto window_bits = (compression_info >> 4) & 0xf;
+    bool has_dictionary = (flags >> 5) & 0x1;
 
-    ASSERT(m_compression_method == 8);
-    ASSERT(m_compression_info == 7);
-    ASSERT(!m_has_dictionary);
-    ASSERT((compression_info * 256 + flags) % 31 == 0);
+    if (compression_method != 8 || window_bits > 7) {
+        dbg() << "ZlibDecompressor: Unsupported compression method " << compression_method << " with window size " << window_bits;
+        return false;
+    }
+    if (has_dictionary) {
+        dbg() << "ZlibDecompressor: Preset dictionaries are not supported";
+        return false;
+    }
+    if ((compression_info * 256 + flags) % 31 != 0) {
+        dbg() << "ZlibDecompressor: Header check bits are invalid";
+        return false;
+    }
+    return true;
+}
 
-    m_data_bytes = data.slice(2, data.size() - 2 - 4);
+u32 ZlibDecompressor::checksum() const
+{
+    auto bytes = m_input_data.slice(m_input_data.size() - checksum_size, checksum_size);
+    return bytes[0] << 24 | bytes[1] << 16 | bytes[2] << 8 | bytes[3];
 }
 
-Vector<u8> Zlib::decompress()
+size_t ZlibDecompressor::read(Bytes bytes)
 {
-    return Deflate(m_data_bytes).decompress();
+    if (has_error() || !m_header_parsed)
+        return 0;
+
+    auto nread = m_decompressor.read(bytes);
+    m_adler32.update(bytes.slice(0, nread));
+    if (m_decompressor.is_finished() && !m_checksum_verified)
+        verify_checksum();
+    return nread;
 }
 
-u32 Zlib::checksum()
+void ZlibDecompressor::verify_checksum()
 {
-    if (!m_checksum) {
-        auto bytes = m_input_data.slice(m_input_data.size() - 4, 4);
-        m_checksum = bytes.at(0) << 24 | bytes.at(1) << 16 | bytes.at(2) << 8 || bytes.at(3);
+    // The checksum directly follows the DEFLATE stream, which doesn't have to end where the input does.
+    auto checksum_offset = header_size + m_decompressor.consumed_input_size();
+    if (checksum_offset + checksum_size > m_input_data.size()) {
+        if (!m_input_complete)
+            return;
+        dbg() << "ZlibDecompressor: Stream ends without a checksum";
+        m_has_error = true;
+        return;
+    }
+
+    auto bytes = m_input_data.slice(checksum_offset, checksum_size);
+    u32 expected_checksum = bytes[0] << 24 | bytes[1] << 16 | bytes[2] << 8 | bytes[3];
+    if (m_adler32.digest() != expected_checksum) {
+        dbg() << "ZlibDecompressor: Checksum mismatch";
+        m_has_error = true;
+        return;
     }
+    m_checksum_verified = true;
+}
+
+Optional<ByteBuffer> ZlibDecompressor::decompress_all(ReadonlyBytes data)
+{
+    ZlibDecompressor decompressor { data };
 
-    return m_checksum;
+    auto output = ByteBuffer::create_uninitialized(max<size_t>(data.size() * 4, 4096));
+    size_t output_size = 0;
+    for (;;) {
+        if (output_size == output.size())
+            output.grow(output.size() * 2);
+        output_size += decompressor.read({ output.data() + output_size, output.size() - output_size });
+        if (decompressor.has_error())
+            return {};
+        if (decompressor.is_finished())
+            break;
+    }
+
+    output.trim(output_size);
+    return output;
+}
+
+ZlibCompressor::ZlibCompressor(int level)
+    : m_compressor(level)
+    , m_level(level)
+{
+}
+
+void ZlibCompressor::write(ReadonlyBytes bytes)
+{
+    m_adler32.update(bytes);
+    m_compressor.write(bytes);
+}
+
+void ZlibCompressor::finish()
+{
+    m_compressor.finish();
+}
+
+ByteBuffer ZlibCompressor::take_output()
+{
+    ByteBuffer output;
+
+    if (!m_header_written) {
+        // A 32 KiB window with DEFLATE, and the level hint zlib would use.
+        u8 compression_info = 0x78;
+        u8 level_hint = m_level == 1 ? 0 : m_level < 6 ? 1 : m_level == 6 ? 2 : 3;
+        u8 flags = level_hint << 6;
+        flags |= (31 - (compression_info * 256 + flags) % 31) % 31;
+        u8 header[] = { compression_info, flags };
+        output.append(header, sizeof(header));
+        m_header_written = true;
+    }
+
+    auto compressed = m_compressor.take_output();
+    output.append(compressed.data(), compressed.size());
+
+    if (m_compressor.is_finished() && !m_checksum_written) {
+        u32 checksum = m_adler32.digest();
+        u8 bytes[] = { (u8)(checksum >> 24), (u8)(checksum >> 16), (u8)(checksum >> 8), (u8)checksum };
+        output.append(bytes, sizeof(bytes));
+        m_checksum_written = true;
+    }
+
+    return output;
+}
+
+ByteBuffer ZlibCompressor::compress_all(ReadonlyBytes data, int level)
+{
+    ZlibCompressor compressor { level };
+    compressor.write(data);
+    compressor.finish();
+    return compressor.take_output();
 }
 
 }
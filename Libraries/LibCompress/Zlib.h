@@ -26,27 +26,69 @@
 
 #pragma once
 
+#include <AK/ByteBuffer.h>
+#include <AK/Optional.h>
 #include <AK/Span.h>
 #include <AK/Types.h>
-#include <AK/Vector.h>
+#include <LibCompress/Deflate.h>
+#include <LibCrypto/Checksum/Adler32.h>
 
 namespace Compress {
-class Zlib {
+
+// Incremental decoder for zlib streams (RFC 1950), a DEFLATE stream with a
+// small header and an Adler-32 checksum of the output at the end.
+class ZlibDecompressor {
 public:
-    Zlib(ReadonlyBytes data);
+    explicit ZlibDecompressor(ReadonlyBytes data);
+
+    // Starts without any input, see DeflateDecompressor::set_input().
+    ZlibDecompressor();
+    void set_input(ReadonlyBytes data, bool is_complete);
+
+    // Decompresses up to bytes.size() bytes and returns how many were written.
+    // The checksum is verified once the end of the stream has been read.
+    size_t read(Bytes);
+
+    bool is_finished() const { return m_checksum_verified; }
+    bool has_error() const { return m_has_error || m_decompressor.has_error(); }
 
-    Vector<u8> decompress();
-    u32 checksum();
+    // The checksum stored at the end of the stream.
+    u32 checksum() const;
+
+    static Optional<ByteBuffer> decompress_all(ReadonlyBytes);
 
 private:
-    u8 m_compression_method;
-    u8 m_compression_info;
-    u8 m_check_bits;
-    u8 m_has_dictionary;
-    u8 m_compression_level;
+    bool parse_header();
+    void verify_checksum();
 
-    u32 m_checksum;
     ReadonlyBytes m_input_data;
-    ReadonlyBytes m_data_bytes;
+    bool m_input_complete { true };
+    bool m_header_parsed { false };
+    DeflateDecompressor m_decompressor;
+    Crypto::Checksum::Adler32 m_adler32;
+    bool m_has_error { false };
+    bool m_checksum_verified { false };
+};
+
+// Streaming encoder for zlib streams, see ZlibDecompressor.
+class ZlibCompressor {
+public:
+    explicit ZlibCompressor(int level = DeflateCompressor::default_level);
+
+    void write(ReadonlyBytes);
+    void finish();
+
+    // Hands out the compressed output produced since the last call, header and checksum included.
+    ByteBuffer take_output();
+
+    static ByteBuffer compress_all(ReadonlyBytes, int level = DeflateCompressor::default_level);
+
+private:
+    DeflateCompressor m_compressor;
+    Crypto::Checksum::Adler32 m_adler32;
+    int m_level { DeflateCompressor::default_level };
+    bool m_header_written { false };
+    bool m_checksum_written { false };
 };
+
 }
@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2018-2020, The SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <LibCore/Coroutine.h>
+#include <LibCore/IODevice.h>
+#include <LibCore/Socket.h>
+#include <errno.h>
+#include <unistd.h>
+
+namespace Core {
+
+namespace {
+
+class ConnectedAwaiter {
+    AK_MAKE_NONCOPYABLE(ConnectedAwaiter);
+
+public:
+    explicit ConnectedAwaiter(Socket& socket)
+        : m_socket(socket)
+    {
+    }
+
+    ~ConnectedAwaiter() { disarm(); }
+
+    bool await_ready() const { return m_socket.is_connected(); }
+
+    void await_suspend(std::coroutine_handle<> handle)
+    {
+        m_armed = true;
+        m_socket.on_connected = [handle] { handle.resume(); };
+    }
+
+    void await_resume() { disarm(); }
+
+private:
+    void disarm()
+    {
+        if (!m_armed)
+            return;
+        m_armed = false;
+        m_socket.on_connected = nullptr;
+    }
+
+    Socket& m_socket;
+    bool m_armed { false };
+};
+
+}
+
+Task<ByteBuffer> async_read(IODevice& device, size_t max_size)
+{
+    for (;;) {
+        auto buffer = device.read(max_size);
+        if (!buffer.is_empty() || device.eof())
+            co_return buffer;
+        if (device.error() != EAGAIN)
+            co_return ByteBuffer {};
+        co_await readable(device.fd());
+    }
+}
+
+Task<bool> async_write(IODevice& device, ReadonlyBytes data)
+{
+    while (!data.is_empty()) {
+        ssize_t nwritten = ::write(device.fd(), data.data(), data.size());
+        if (nwritten < 0) {
+            if (errno == EINTR)
+                continue;
+            if (errno != EAGAIN)
+                co_return false;
+            co_await writable(device.fd());
+            continue;
+        }
+        data = data.slice(nwritten, data.size() - nwritten);
+    }
+    co_return true;
+}
+
+Task<bool> async_connect(Socket& socket, const String& hostname, int port)
+{
+    if (!socket.connect(hostname, port))
+        co_return false;
+    co_await ConnectedAwaiter { socket };
+    co_return true;
+}
+
+}
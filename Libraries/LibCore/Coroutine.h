@@ -0,0 +1,268 @@
+/*
+ * Copyright (c) 2018-2020, The SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/ByteBuffer.h>
+#include <AK/Noncopyable.h>
+#include <AK/Optional.h>
+#include <AK/StdLibExtras.h>
+#include <AK/String.h>
+#include <LibCore/Forward.h>
+#include <LibCore/Notifier.h>
+#include <LibCore/Timer.h>
+#include <coroutine>
+
+namespace Core {
+
+template<typename T>
+class Task;
+
+namespace Detail {
+
+struct TaskPromiseBase {
+    std::coroutine_handle<> continuation;
+    bool is_detached { false };
+
+    std::suspend_always initial_suspend() noexcept { return {}; }
+
+    struct FinalAwaiter {
+        bool await_ready() noexcept { return false; }
+
+        template<typename Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept
+        {
+            auto& promise = handle.promise();
+            if (promise.continuation)
+                return promise.continuation;
+            if (promise.is_detached)
+                handle.destroy();
+            return std::noop_coroutine();
+        }
+
+        void await_resume() noexcept { }
+    };
+
+    FinalAwaiter final_suspend() noexcept { return {}; }
+    void unhandled_exception() { ASSERT_NOT_REACHED(); }
+};
+
+template<typename T>
+struct TaskPromise : public TaskPromiseBase {
+    Task<T> get_return_object();
+
+    template<typename U>
+    void return_value(U&& value) { m_value = forward<U>(value); }
+
+    T take_value() { return m_value.release_value(); }
+
+private:
+    Optional<T> m_value;
+};
+
+template<>
+struct TaskPromise<void> : public TaskPromiseBase {
+    Task<void> get_return_object();
+    void return_void() { }
+    void take_value() { }
+};
+
+}
+
+// A coroutine that runs on the event loop, suspending whenever it has to wait for I/O or time to pass.
+// Tasks are lazy: nothing runs until the task is co_await-ed by another task, started or detached.
+// The task's frame belongs to the Task object, so destroying a task that is still waiting cancels it.
+template<typename T = void>
+class [[nodiscard]] Task {
+    AK_MAKE_NONCOPYABLE(Task);
+
+public:
+    using promise_type = Detail::TaskPromise<T>;
+    using Handle = std::coroutine_handle<promise_type>;
+
+    Task() { }
+
+    explicit Task(Handle handle)
+        : m_handle(handle)
+    {
+    }
+
+    Task(Task&& other)
+        : m_handle(exchange(other.m_handle, {}))
+    {
+    }
+
+    Task& operator=(Task&& other)
+    {
+        if (this != &other) {
+            destroy();
+            m_handle = exchange(other.m_handle, {});
+        }
+        return *this;
+    }
+
+    ~Task() { destroy(); }
+
+    bool is_done() const { return !m_handle || m_handle.done(); }
+
+    // Runs the task until it first has to wait.
+    void start()
+    {
+        ASSERT(m_handle && !m_handle.done());
+        m_handle.resume();
+    }
+
+    // Runs the task, which then frees itself once it's done. A detached task can't be cancelled.
+    void detach()
+    {
+        auto handle = exchange(m_handle, {});
+        ASSERT(handle && !handle.done());
+        handle.promise().is_detached = true;
+        handle.resume();
+    }
+
+    bool await_ready() const { return m_handle.done(); }
+
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting)
+    {
+        m_handle.promise().continuation = awaiting;
+        return m_handle;
+    }
+
+    T await_resume() { return m_handle.promise().take_value(); }
+
+private:
+    void destroy()
+    {
+        if (m_handle)
+            exchange(m_handle, {}).destroy();
+    }
+
+    Handle m_handle;
+};
+
+template<typename T>
+Task<T> Detail::TaskPromise<T>::get_return_object()
+{
+    return Task<T> { Task<T>::Handle::from_promise(*this) };
+}
+
+inline Task<void> Detail::TaskPromise<void>::get_return_object()
+{
+    return Task<void> { Task<void>::Handle::from_promise(*this) };
+}
+
+// Suspends until the file descriptor is readable or writable.
+class NotifierAwaiter {
+    AK_MAKE_NONCOPYABLE(NotifierAwaiter);
+
+public:
+    NotifierAwaiter(int fd, Notifier::Event event)
+        : m_fd(fd)
+        , m_event(event)
+    {
+    }
+
+    ~NotifierAwaiter() { disarm(); }
+
+    bool await_ready() const { return false; }
+
+    void await_suspend(std::coroutine_handle<> handle)
+    {
+        m_notifier = Notifier::construct(m_fd, m_event);
+        auto resume = [handle] { handle.resume(); };
+        if (m_event == Notifier::Event::Read)
+            m_notifier->on_ready_to_read = move(resume);
+        else
+            m_notifier->on_ready_to_write = move(resume);
+    }
+
+    void await_resume() { disarm(); }
+
+private:
+    // An event may already be queued for the notifier, which mustn't resume us a second time.
+    void disarm()
+    {
+        if (!m_notifier)
+            return;
+        m_notifier->set_enabled(false);
+        m_notifier->on_ready_to_read = nullptr;
+        m_notifier->on_ready_to_write = nullptr;
+        m_notifier = nullptr;
+    }
+
+    int m_fd { -1 };
+    Notifier::Event m_event { Notifier::Event::None };
+    RefPtr<Notifier> m_notifier;
+};
+
+// Suspends for at least the given number of milliseconds.
+class DelayAwaiter {
+    AK_MAKE_NONCOPYABLE(DelayAwaiter);
+
+public:
+    explicit DelayAwaiter(int milliseconds)
+        : m_milliseconds(milliseconds)
+    {
+    }
+
+    ~DelayAwaiter() { disarm(); }
+
+    bool await_ready() const { return false; }
+
+    void await_suspend(std::coroutine_handle<> handle)
+    {
+        m_timer = Timer::create_single_shot(m_milliseconds, [handle] { handle.resume(); });
+        m_timer->start();
+    }
+
+    void await_resume() { disarm(); }
+
+private:
+    void disarm()
+    {
+        if (!m_timer)
+            return;
+        m_timer->stop();
+        m_timer->on_timeout = nullptr;
+        m_timer = nullptr;
+    }
+
+    int m_milliseconds { 0 };
+    RefPtr<Timer> m_timer;
+};
+
+inline NotifierAwaiter readable(int fd) { return { fd, Notifier::Event::Read }; }
+inline NotifierAwaiter writable(int fd) { return { fd, Notifier::Event::Write }; }
+inline DelayAwaiter delay(int milliseconds) { return DelayAwaiter { milliseconds }; }
+
+// Reads up to max_size bytes, waiting for data if there is none yet. Returns an empty buffer on EOF or error.
+Task<ByteBuffer> async_read(IODevice&, size_t max_size);
+// Writes all of the data, waiting whenever the other side can't take more yet.
+Task<bool> async_write(IODevice&, ReadonlyBytes);
+Task<bool> async_connect(Socket&, const String& hostname, int port);
+
+}
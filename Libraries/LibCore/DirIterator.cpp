@@ -62,6 +62,7 @@ bool DirIterator::advance_next()
         }
 
         m_next = de->d_name;
+        m_next_type = de->d_type;
         if (m_next.is_null())
             return false;
 
@@ -83,6 +84,13 @@ bool DirIterator::has_next()
     return advance_next();
 }
 
+unsigned char DirIterator::next_type()
+{
+    if (!has_next())
+        return DT_UNKNOWN;
+    return m_next_type;
+}
+
 String DirIterator::next_path()
 {
     if (m_next.is_null())
@@ -47,13 +47,20 @@ public:
     int error() const { return m_error; }
     const char* error_string() const { return strerror(m_error); }
     bool has_next();
+    // The DT_* type of the entry next_path() is about to return, straight from the directory,
+    // so it costs no stat(). It's DT_UNKNOWN for file systems that don't record the type.
+    unsigned char next_type();
     String next_path();
     String next_full_path();
 
+    // The open directory, for looking up entries with fstatat() and openat().
+    int fd() const { return m_dir ? dirfd(m_dir) : -1; }
+
 private:
     DIR* m_dir = nullptr;
     int m_error = 0;
     String m_next;
+    unsigned char m_next_type { DT_UNKNOWN };
     String m_path;
     int m_flags;
 
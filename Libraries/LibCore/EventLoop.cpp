@@ -47,6 +47,9 @@
 #include <string.h>
 #include <sys/select.h>
 #include <sys/socket.h>
+#ifdef __serenity__
+#    include <sys/event_set.h>
+#endif
 #include <sys/stat.h>
 #include <sys/time.h>
 #include <time.h>
@@ -66,9 +69,16 @@ struct EventLoopTimer {
     bool should_reload { false };
     TimerShouldFireWhenNotVisible fire_when_not_visible { TimerShouldFireWhenNotVisible::No };
     WeakPtr<Object> owner;
+    // Where the timer is in s_timer_heap, unless it's in s_suspended_timers.
+    size_t heap_index { 0 };
+    bool is_suspended { false };
 
     void reload(const timeval& now);
     bool has_expired(const timeval& now) const;
+    bool fires_before(const EventLoopTimer& other) const
+    {
+        return fire_time.tv_sec < other.fire_time.tv_sec || (fire_time.tv_sec == other.fire_time.tv_sec && fire_time.tv_usec < other.fire_time.tv_usec);
+    }
 };
 
 struct EventLoop::Private {
@@ -79,7 +89,18 @@ static EventLoop* s_main_event_loop;
 static Vector<EventLoop*>* s_event_loop_stack;
 static NeverDestroyed<IDAllocator> s_id_allocator;
 static HashMap<int, NonnullOwnPtr<EventLoopTimer>>* s_timers;
+// Timers are kept in a binary min-heap by fire time, so the next one to fire is always at the front.
+// Timers that expired while their owner wasn't visible are set aside until it is visible again.
+static Vector<EventLoopTimer*>* s_timer_heap;
+static Vector<EventLoopTimer*>* s_suspended_timers;
 static HashTable<Notifier*>* s_notifiers;
+#ifdef __serenity__
+// Notifiers are mirrored into a kernel event set, so that each wait only has to tell the kernel what changed.
+static int s_event_set_fd = -1;
+static pid_t s_event_set_pid;
+static HashMap<int, Vector<Notifier*, 1>>* s_notifiers_by_fd;
+static HashTable<int>* s_dirty_notifier_fds;
+#endif
 int EventLoop::s_wake_pipe_fds[2];
 HashMap<int, EventLoop::SignalHandlers> EventLoop::s_signal_handlers;
 int EventLoop::s_handling_signal = 0;
@@ -226,7 +247,13 @@ EventLoop::EventLoop()
     if (!s_event_loop_stack) {
         s_event_loop_stack = new Vector<EventLoop*>;
         s_timers = new HashMap<int, NonnullOwnPtr<EventLoopTimer>>;
+        s_timer_heap = new Vector<EventLoopTimer*>;
+        s_suspended_timers = new Vector<EventLoopTimer*>;
         s_notifiers = new HashTable<Notifier*>;
+#ifdef __serenity__
+        s_notifiers_by_fd = new HashMap<int, Vector<Notifier*, 1>>;
+        s_dirty_notifier_fds = new HashTable<int>;
+#endif
     }
 
     if (!s_main_event_loop) {
@@ -519,8 +546,120 @@ void EventLoop::unregister_signal(int handler_id)
         s_signal_handlers.remove(remove_signo);
 }
 
+static void timer_heap_swap(size_t a, size_t b)
+{
+    auto& heap = *s_timer_heap;
+    swap(heap[a], heap[b]);
+    heap[a]->heap_index = a;
+    heap[b]->heap_index = b;
+}
+
+static void timer_heap_sift_up(size_t index)
+{
+    auto& heap = *s_timer_heap;
+    while (index > 0) {
+        size_t parent = (index - 1) / 2;
+        if (!heap[index]->fires_before(*heap[parent]))
+            break;
+        timer_heap_swap(index, parent);
+        index = parent;
+    }
+}
+
+static void timer_heap_sift_down(size_t index)
+{
+    auto& heap = *s_timer_heap;
+    for (;;) {
+        size_t smallest = index;
+        size_t left = index * 2 + 1;
+        size_t right = left + 1;
+        if (left < heap.size() && heap[left]->fires_before(*heap[smallest]))
+            smallest = left;
+        if (right < heap.size() && heap[right]->fires_before(*heap[smallest]))
+            smallest = right;
+        if (smallest == index)
+            break;
+        timer_heap_swap(index, smallest);
+        index = smallest;
+    }
+}
+
+static void timer_heap_insert(EventLoopTimer& timer)
+{
+    timer.heap_index = s_timer_heap->size();
+    s_timer_heap->append(&timer);
+    timer_heap_sift_up(timer.heap_index);
+}
+
+static void timer_heap_remove(EventLoopTimer& timer)
+{
+    auto& heap = *s_timer_heap;
+    size_t index = timer.heap_index;
+    ASSERT(index < heap.size() && heap[index] == &timer);
+    size_t last = heap.size() - 1;
+    if (index != last)
+        timer_heap_swap(index, last);
+    heap.take_last();
+    if (index < heap.size()) {
+        timer_heap_sift_up(index);
+        timer_heap_sift_down(index);
+    }
+}
+
+#ifdef __serenity__
+static void update_event_set(int wake_pipe_fd)
+{
+    if (s_event_set_fd < 0 || s_event_set_pid != getpid()) {
+        // An event set inherited across fork() is shared with the parent, so start over with our own.
+        if (s_event_set_fd >= 0)
+            close(s_event_set_fd);
+        s_event_set_fd = event_set_create(O_CLOEXEC);
+        if (s_event_set_fd < 0) {
+            perror("event_set_create");
+            ASSERT_NOT_REACHED();
+        }
+        s_event_set_pid = getpid();
+        int rc = event_set_ctl(s_event_set_fd, EVENT_SET_CTL_ADD, wake_pipe_fd, EVENT_SET_IN, (void*)(FlatPtr)wake_pipe_fd);
+        if (rc < 0) {
+            perror("event_set_ctl");
+            ASSERT_NOT_REACHED();
+        }
+        for (auto& it : *s_notifiers_by_fd)
+            s_dirty_notifier_fds->set(it.key);
+    }
+
+    for (int fd : *s_dirty_notifier_fds) {
+        unsigned events = 0;
+        auto it = s_notifiers_by_fd->find(fd);
+        if (it != s_notifiers_by_fd->end()) {
+            for (auto* notifier : it->value) {
+                if (notifier->event_mask() & Notifier::Read)
+                    events |= EVENT_SET_IN;
+                if (notifier->event_mask() & Notifier::Write)
+                    events |= EVENT_SET_OUT;
+                if (notifier->event_mask() & Notifier::Exceptional)
+                    ASSERT_NOT_REACHED();
+            }
+        }
+        // The fd may have been closed and reused since we registered it, so always register it afresh.
+        event_set_ctl(s_event_set_fd, EVENT_SET_CTL_REMOVE, fd, 0, nullptr);
+        if (events && event_set_ctl(s_event_set_fd, EVENT_SET_CTL_ADD, fd, events, (void*)(FlatPtr)fd) < 0) {
+#ifdef EVENTLOOP_DEBUG
+            dbg() << "Core::EventLoop: Failed to watch fd " << fd << " (" << strerror(errno) << ")";
+#endif
+        }
+    }
+    s_dirty_notifier_fds->clear();
+}
+#endif
+
 void EventLoop::wait_for_event(WaitMode mode)
 {
+#ifdef __serenity__
+    event_set_event ready_events[32];
+retry:
+    update_event_set(s_wake_pipe_fds[0]);
+#else
     fd_set rfds;
     fd_set wfds;
 retry:
@@ -545,6 +684,7 @@ retry:
         if (notifier->event_mask() & Notifier::Exceptional)
             ASSERT_NOT_REACHED();
     }
+#endif
 
     bool queued_events_is_empty;
     {
@@ -573,7 +713,12 @@ retry:
     }
 
 try_select_again:
+#ifdef __serenity__
+    timespec timeout_spec = { timeout.tv_sec, timeout.tv_usec * 1000 };
+    int marked_fd_count = event_set_wait(s_event_set_fd, ready_events, sizeof(ready_events) / sizeof(ready_events[0]), should_wait_forever ? nullptr : &timeout_spec);
+#else
     int marked_fd_count = select(max_fd + 1, &rfds, &wfds, nullptr, should_wait_forever ? nullptr : &timeout);
+#endif
     if (marked_fd_count < 0) {
         int saved_errno = errno;
         if (saved_errno == EINTR) {
@@ -587,7 +732,16 @@ try_select_again:
         // Blow up, similar to Core::safe_syscall.
         ASSERT_NOT_REACHED();
     }
-    if (FD_ISSET(s_wake_pipe_fds[0], &rfds)) {
+#ifdef __serenity__
+    bool wake_pipe_is_readable = false;
+    for (int i = 0; i < marked_fd_count; ++i) {
+        if ((FlatPtr)ready_events[i].data == (FlatPtr)s_wake_pipe_fds[0])
+            wake_pipe_is_readable = true;
+    }
+#else
+    bool wake_pipe_is_readable = FD_ISSET(s_wake_pipe_fds[0], &rfds);
+#endif
+    if (wake_pipe_is_readable) {
         int wake_events[8];
         auto nread = read(s_wake_pipe_fds[0], wake_events, sizeof(wake_events));
         if (nread < 0) {
@@ -615,21 +769,40 @@ try_select_again:
         now.tv_usec = now_spec.tv_nsec / 1000;
     }
 
-    for (auto& it : *s_timers) {
-        auto& timer = *it.value;
-        if (!timer.has_expired(now))
+    // Take everything that has expired off the heap first, so a timer with a zero interval
+    // can't keep itself at the front and fires at most once per pass.
+    Vector<EventLoopTimer*, 8> expired_timers;
+    for (size_t i = 0; i < s_suspended_timers->size();) {
+        auto* timer = s_suspended_timers->at(i);
+        if (timer->owner && !timer->owner->is_visible_for_timer_purposes()) {
+            ++i;
             continue;
-        if (it.value->fire_when_not_visible == TimerShouldFireWhenNotVisible::No
-            && it.value->owner
-            && !it.value->owner->is_visible_for_timer_purposes()) {
+        }
+        timer->is_suspended = false;
+        s_suspended_timers->remove(i);
+        expired_timers.append(timer);
+    }
+    while (!s_timer_heap->is_empty() && s_timer_heap->first()->has_expired(now)) {
+        auto* timer = s_timer_heap->first();
+        timer_heap_remove(*timer);
+        if (timer->fire_when_not_visible == TimerShouldFireWhenNotVisible::No
+            && timer->owner
+            && !timer->owner->is_visible_for_timer_purposes()) {
+            timer->is_suspended = true;
+            s_suspended_timers->append(timer);
             continue;
         }
+        expired_timers.append(timer);
+    }
+
+    for (auto* timer : expired_timers) {
 #ifdef EVENTLOOP_DEBUG
-        dbg() << "Core::EventLoop: Timer " << timer.timer_id << " has expired, sending Core::TimerEvent to " << timer.owner;
+        dbg() << "Core::EventLoop: Timer " << timer->timer_id << " has expired, sending Core::TimerEvent to " << timer->owner;
 #endif
-        post_event(*timer.owner, make<TimerEvent>(timer.timer_id));
-        if (timer.should_reload) {
-            timer.reload(now);
+        post_event(*timer->owner, make<TimerEvent>(timer->timer_id));
+        if (timer->should_reload) {
+            timer->reload(now);
+            timer_heap_insert(*timer);
         } else {
             // FIXME: Support removing expired timers that don't want to reload.
             ASSERT_NOT_REACHED();
@@ -639,6 +812,20 @@ try_select_again:
     if (!marked_fd_count)
         return;
 
+#ifdef __serenity__
+    for (int i = 0; i < marked_fd_count; ++i) {
+        int fd = (int)(FlatPtr)ready_events[i].data;
+        auto it = s_notifiers_by_fd->find(fd);
+        if (it == s_notifiers_by_fd->end())
+            continue;
+        for (auto* notifier : it->value) {
+            if ((ready_events[i].events & EVENT_SET_IN) && (notifier->event_mask() & Notifier::Event::Read))
+                post_event(*notifier, make<NotifierReadEvent>(fd));
+            if ((ready_events[i].events & EVENT_SET_OUT) && (notifier->event_mask() & Notifier::Event::Write))
+                post_event(*notifier, make<NotifierWriteEvent>(fd));
+        }
+    }
+#else
     for (auto& notifier : *s_notifiers) {
         if (FD_ISSET(notifier->fd(), &rfds)) {
             if (notifier->event_mask() & Notifier::Event::Read)
@@ -649,6 +836,7 @@ try_select_again:
                 post_event(*notifier, make<NotifierWriteEvent>(notifier->fd()));
         }
     }
+#endif
 }
 
 bool EventLoopTimer::has_expired(const timeval& now) const
@@ -665,18 +853,9 @@ void EventLoopTimer::reload(const timeval& now)
 
 Optional<struct timeval> EventLoop::get_next_timer_expiration()
 {
-    Optional<struct timeval> soonest {};
-    for (auto& it : *s_timers) {
-        auto& fire_time = it.value->fire_time;
-        if (it.value->fire_when_not_visible == TimerShouldFireWhenNotVisible::No
-            && it.value->owner
-            && !it.value->owner->is_visible_for_timer_purposes()) {
-            continue;
-        }
-        if (!soonest.has_value() || fire_time.tv_sec < soonest.value().tv_sec || (fire_time.tv_sec == soonest.value().tv_sec && fire_time.tv_usec < soonest.value().tv_usec))
-            soonest = fire_time;
-    }
-    return soonest;
+    if (s_timer_heap->is_empty())
+        return {};
+    return s_timer_heap->first()->fire_time;
 }
 
 int EventLoop::register_timer(Object& object, int milliseconds, bool should_reload, TimerShouldFireWhenNotVisible fire_when_not_visible)
@@ -695,6 +874,7 @@ int EventLoop::register_timer(Object& object, int milliseconds, bool should_relo
     timer->fire_when_not_visible = fire_when_not_visible;
     int timer_id = s_id_allocator->allocate();
     timer->timer_id = timer_id;
+    timer_heap_insert(*timer);
     s_timers->set(timer_id, move(timer));
     return timer_id;
 }
@@ -705,6 +885,11 @@ bool EventLoop::unregister_timer(int timer_id)
     auto it = s_timers->find(timer_id);
     if (it == s_timers->end())
         return false;
+    auto& timer = *it->value;
+    if (timer.is_suspended)
+        s_suspended_timers->remove_first_matching([&](auto* entry) { return entry == &timer; });
+    else
+        timer_heap_remove(timer);
     s_timers->remove(it);
     return true;
 }
@@ -712,11 +897,41 @@ bool EventLoop::unregister_timer(int timer_id)
 void EventLoop::register_notifier(Badge<Notifier>, Notifier& notifier)
 {
     s_notifiers->set(&notifier);
+#ifdef __serenity__
+    auto it = s_notifiers_by_fd->find(notifier.fd());
+    if (it == s_notifiers_by_fd->end()) {
+        Vector<Notifier*, 1> notifiers;
+        notifiers.append(&notifier);
+        s_notifiers_by_fd->set(notifier.fd(), move(notifiers));
+    } else if (!it->value.contains_slow(&notifier)) {
+        it->value.append(&notifier);
+    }
+    s_dirty_notifier_fds->set(notifier.fd());
+#endif
 }
 
 void EventLoop::unregister_notifier(Badge<Notifier>, Notifier& notifier)
 {
     s_notifiers->remove(&notifier);
+#ifdef __serenity__
+    auto it = s_notifiers_by_fd->find(notifier.fd());
+    if (it == s_notifiers_by_fd->end())
+        return;
+    it->value.remove_first_matching([&](auto* entry) { return entry == &notifier; });
+    if (it->value.is_empty())
+        s_notifiers_by_fd->remove(it);
+    s_dirty_notifier_fds->set(notifier.fd());
+#endif
+}
+
+void EventLoop::notifier_did_change_event_mask(Badge<Notifier>, Notifier& notifier)
+{
+#ifdef __serenity__
+    if (s_notifiers->contains(&notifier))
+        s_dirty_notifier_fds->set(notifier.fd());
+#else
+    (void)notifier;
+#endif
 }
 
 void EventLoop::wake()
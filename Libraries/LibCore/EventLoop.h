@@ -67,6 +67,7 @@ public:
 
     static void register_notifier(Badge<Notifier>, Notifier&);
     static void unregister_notifier(Badge<Notifier>, Notifier&);
+    static void notifier_did_change_event_mask(Badge<Notifier>, Notifier&);
 
     void quit(int);
     void unquit();
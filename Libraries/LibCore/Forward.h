@@ -39,6 +39,7 @@ class Event;
 class EventLoop;
 class File;
 class IODevice;
+class IORing;
 class LocalServer;
 class LocalSocket;
 class MimeData;
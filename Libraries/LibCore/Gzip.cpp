@@ -26,12 +26,11 @@
 
 #include <AK/ByteBuffer.h>
 #include <AK/Optional.h>
+#include <LibCompress/Deflate.h>
 #include <LibCore/Gzip.h>
-#include <LibCore/puff.h>
-#include <limits.h>
+#include <LibCrypto/Checksum/CRC32.h>
 #include <stddef.h>
-
-//#define DEBUG_GZIP
+#include <string.h>
 
 namespace Core {
 
@@ -76,7 +75,8 @@ static Optional<ByteBuffer> get_gzip_payload(const ByteBuffer& data)
 
     // FEXTRA
     if (flags & 4) {
-        u16 length = read_byte() & read_byte() << 8;
+        u16 length = read_byte();
+        length |= read_byte() << 8;
         dbg() << "get_gzip_payload: Header has FEXTRA flag set. Length = " << length;
         current += length;
     }
@@ -116,41 +116,33 @@ Optional<ByteBuffer> Gzip::decompress(const ByteBuffer& data)
         return Optional<ByteBuffer>();
     }
 
-    auto source = optional_payload.value();
-    unsigned long source_len = source.size();
-    auto destination = ByteBuffer::create_uninitialized(1024);
-    while (true) {
-        unsigned long destination_len = destination.size();
-
-#ifdef DEBUG_GZIP
-        dbg() << "Gzip::decompress: Calling puff()\n"
-              << "  destination_data = " << destination.data() << "\n"
-              << "  destination_len = " << destination_len << "\n"
-              << "  source_data = " << source.data() << "\n"
-              << "  source_len = " << source_len;
-#endif
-
-        auto puff_ret = puff(
-            destination.data(), &destination_len,
-            source.data(), &source_len);
-
-        if (puff_ret == 0) {
-            dbg() << "Gzip::decompress: Decompression success.";
-            destination.trim(destination_len);
-            break;
-        }
-
-        if (puff_ret == 1) {
-            // FIXME: Find a better way of decompressing without needing to try over and over again.
-            dbg() << "Gzip::decompress: Output buffer exhausted. Growing.";
-            destination.grow(destination.size() * 2);
-        } else {
-            dbg() << "Gzip::decompress: Error. puff() returned: " << puff_ret;
-            ASSERT_NOT_REACHED();
-        }
+    auto decompressed = Compress::DeflateDecompressor::decompress_all(optional_payload.value().span());
+    if (!decompressed.has_value()) {
+        dbg() << "Gzip::decompress: Payload is not a valid DEFLATE stream.";
+        return Optional<ByteBuffer>();
     }
 
-    return destination;
+    dbg() << "Gzip::decompress: Decompression success.";
+    return decompressed;
+}
+
+// see: https://tools.ietf.org/html/rfc1952#page-5
+ByteBuffer Gzip::compress(const ByteBuffer& data, int level)
+{
+    // Magic, DEFLATE, no flags, no timestamp, the usual extra flags for the fastest/best levels, unknown OS.
+    u8 extra_flags = level == Compress::DeflateCompressor::max_level ? 2 : level == Compress::DeflateCompressor::min_level ? 4 : 0;
+    u8 header[] = { 0x1F, 0x8B, 8, 0, 0, 0, 0, 0, extra_flags, 255 };
+
+    auto compressed = Compress::DeflateCompressor::compress_all(data.span(), level);
+    u32 crc = Crypto::Checksum::CRC32(data.span()).digest();
+    u32 size = data.size();
+    u8 trailer[] = { (u8)crc, (u8)(crc >> 8), (u8)(crc >> 16), (u8)(crc >> 24), (u8)size, (u8)(size >> 8), (u8)(size >> 16), (u8)(size >> 24) };
+
+    auto output = ByteBuffer::create_uninitialized(sizeof(header) + compressed.size() + sizeof(trailer));
+    memcpy(output.data(), header, sizeof(header));
+    memcpy(output.data() + sizeof(header), compressed.data(), compressed.size());
+    memcpy(output.data() + sizeof(header) + compressed.size(), trailer, sizeof(trailer));
+    return output;
 }
 
 }
@@ -36,6 +36,7 @@ class Gzip {
 public:
     static bool is_compressed(const ByteBuffer& data);
     static Optional<ByteBuffer> decompress(const ByteBuffer& data);
+    static ByteBuffer compress(const ByteBuffer& data, int level = 6);
 };
 
 }
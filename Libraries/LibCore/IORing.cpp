@@ -0,0 +1,165 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <LibCore/IORing.h>
+
+#ifdef __serenity__
+
+#    include <AK/Atomic.h>
+#    include <fcntl.h>
+#    include <stdio.h>
+#    include <sys/io_ring.h>
+#    include <unistd.h>
+
+namespace Core {
+
+IORing::IORing(unsigned entries, size_t buffers_size, Object* parent)
+    : Object(parent)
+{
+    m_fd = io_ring_create(entries, buffers_size, O_CLOEXEC, &m_header);
+    if (m_fd < 0) {
+        perror("io_ring_create");
+        return;
+    }
+    m_notifier = Notifier::construct(m_fd, Notifier::Event::Read, this);
+    m_notifier->on_ready_to_read = [this] {
+        reap_completions();
+    };
+}
+
+IORing::~IORing()
+{
+    if (m_fd >= 0)
+        ::close(m_fd);
+}
+
+u8* IORing::buffers()
+{
+    ASSERT(is_open());
+    return reinterpret_cast<u8*>(m_header) + m_header->buffers_offset;
+}
+
+size_t IORing::buffers_size() const
+{
+    return is_open() ? m_header->buffers_size : 0;
+}
+
+bool IORing::read(int fd, size_t buffer_offset, size_t length, ssize_t offset, Callback callback)
+{
+    return submit({ IO_RING_OP_READ, fd, buffer_offset, length, offset, 0, nullptr }, move(callback));
+}
+
+bool IORing::write(int fd, size_t buffer_offset, size_t length, ssize_t offset, Callback callback)
+{
+    return submit({ IO_RING_OP_WRITE, fd, buffer_offset, length, offset, 0, nullptr }, move(callback));
+}
+
+bool IORing::accept(int fd, Callback callback)
+{
+    return submit({ IO_RING_OP_ACCEPT, fd, 0, 0, -1, 0, nullptr }, move(callback));
+}
+
+bool IORing::recv(int fd, size_t buffer_offset, size_t length, int flags, Callback callback)
+{
+    return submit({ IO_RING_OP_RECV, fd, buffer_offset, length, -1, flags, nullptr }, move(callback));
+}
+
+bool IORing::send(int fd, size_t buffer_offset, size_t length, int flags, Callback callback)
+{
+    return submit({ IO_RING_OP_SEND, fd, buffer_offset, length, -1, flags, nullptr }, move(callback));
+}
+
+bool IORing::fsync(int fd, Callback callback)
+{
+    return submit({ IO_RING_OP_FSYNC, fd, 0, 0, -1, 0, nullptr }, move(callback));
+}
+
+bool IORing::submit(const io_ring_submission& submission, Callback callback)
+{
+    if (!is_open())
+        return false;
+
+    unsigned tail = m_header->submission_tail;
+    if (tail - AK::atomic_load(&m_header->submission_head, AK::memory_order_acquire) >= m_header->submission_entries) {
+        // The kernel takes submissions as long as there's room for their completions; give it a chance to.
+        flush();
+        if (tail - AK::atomic_load(&m_header->submission_head, AK::memory_order_acquire) >= m_header->submission_entries)
+            return false;
+    }
+
+    u32 token = m_next_token++;
+    if (!m_next_token)
+        m_next_token = 1;
+    m_callbacks.set(token, move(callback));
+
+    auto* submissions = reinterpret_cast<io_ring_submission*>(reinterpret_cast<u8*>(m_header) + m_header->submissions_offset);
+    auto& entry = submissions[tail & (m_header->submission_entries - 1)];
+    entry = submission;
+    entry.user_data = reinterpret_cast<void*>(static_cast<uintptr_t>(token));
+    AK::atomic_store(&m_header->submission_tail, tail + 1, AK::memory_order_release);
+
+    if (!m_flush_pending) {
+        m_flush_pending = true;
+        deferred_invoke([this](auto&) {
+            if (m_flush_pending)
+                flush();
+        });
+    }
+    return true;
+}
+
+void IORing::flush()
+{
+    m_flush_pending = false;
+    if (io_ring_enter(m_fd, 0) < 0)
+        perror("io_ring_enter");
+}
+
+void IORing::reap_completions()
+{
+    // A callback might drop the last reference to us.
+    NonnullRefPtr<IORing> protector(*this);
+    auto* completions = reinterpret_cast<io_ring_completion*>(reinterpret_cast<u8*>(m_header) + m_header->completions_offset);
+    unsigned head = m_header->completion_head;
+    unsigned tail = AK::atomic_load(&m_header->completion_tail, AK::memory_order_acquire);
+    while (head != tail) {
+        auto completion = completions[head & (m_header->completion_entries - 1)];
+        AK::atomic_store(&m_header->completion_head, ++head, AK::memory_order_release);
+
+        auto token = static_cast<u32>(reinterpret_cast<uintptr_t>(completion.user_data));
+        auto it = m_callbacks.find(token);
+        if (it == m_callbacks.end())
+            continue;
+        auto callback = move(it->value);
+        m_callbacks.remove(it);
+        if (callback)
+            callback(completion.result);
+    }
+}
+
+}
+
+#endif
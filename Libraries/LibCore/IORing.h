@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/Function.h>
+#include <AK/HashMap.h>
+#include <LibCore/Notifier.h>
+#include <LibCore/Object.h>
+
+struct io_ring_header;
+struct io_ring_submission;
+
+namespace Core {
+
+// Batches I/O on a kernel submission/completion ring. Operations queued during one event loop
+// iteration are handed to the kernel with a single syscall, and their callbacks run from the event
+// loop once the kernel has posted the results. Callbacks receive the syscall-style result, with
+// errors as negative errno values.
+class IORing final : public Object {
+    C_OBJECT(IORing)
+public:
+    using Callback = Function<void(ssize_t result)>;
+
+    virtual ~IORing() override;
+
+    bool is_open() const { return m_fd >= 0; }
+    int fd() const { return m_fd; }
+
+    // READ, WRITE, RECV and SEND move data through this area, which is shared with the kernel.
+    u8* buffers();
+    size_t buffers_size() const;
+
+    // These return false if the ring couldn't take another submission.
+    bool read(int fd, size_t buffer_offset, size_t length, ssize_t offset, Callback);
+    bool write(int fd, size_t buffer_offset, size_t length, ssize_t offset, Callback);
+    bool accept(int fd, Callback);
+    bool recv(int fd, size_t buffer_offset, size_t length, int flags, Callback);
+    bool send(int fd, size_t buffer_offset, size_t length, int flags, Callback);
+    bool fsync(int fd, Callback);
+    bool submit(const io_ring_submission&, Callback);
+
+    // Hands everything queued so far to the kernel right away instead of at the end of this event loop iteration.
+    void flush();
+
+private:
+    IORing(unsigned entries, size_t buffers_size, Object* parent = nullptr);
+
+    void reap_completions();
+
+    int m_fd { -1 };
+    io_ring_header* m_header { nullptr };
+    RefPtr<Notifier> m_notifier;
+    HashMap<u32, Callback> m_callbacks;
+    u32 m_next_token { 1 };
+    bool m_flush_pending { false };
+};
+
+}
@@ -27,17 +27,139 @@
 #include <AK/JsonArray.h>
 #include <AK/JsonObject.h>
 #include <AK/JsonValue.h>
+#include <AK/StringBuilder.h>
+#include <Kernel/API/ProcessStatistics.h>
 #include <LibCore/File.h>
 #include <LibCore/ProcessStatisticsReader.h>
 #include <pwd.h>
 #include <stdio.h>
+#include <string.h>
 
 namespace Core {
 
 HashMap<uid_t, String> ProcessStatisticsReader::s_usernames;
 
+template<typename Record>
+static bool read_record(const ByteBuffer& buffer, size_t& offset, size_t record_size, Record& record)
+{
+    if (record_size > buffer.size() || offset > buffer.size() - record_size)
+        return false;
+    // Newer kernels may append fields we don't know about, older ones may have fewer.
+    memset(&record, 0, sizeof(record));
+    memcpy(&record, buffer.data() + offset, min(record_size, sizeof(record)));
+    offset += record_size;
+    return true;
+}
+
+static String string_from_record_field(const char* field, size_t field_size)
+{
+    return String(field, strnlen(field, field_size));
+}
+
+Optional<HashMap<pid_t, Core::ProcessStatistics>> ProcessStatisticsReader::get_all_from_binary()
+{
+    auto file = Core::File::construct("/proc/all_binary");
+    if (!file->open(Core::IODevice::ReadOnly))
+        return {};
+
+    auto buffer = file->read_all();
+    ProcessStatisticsHeader header;
+    size_t offset = 0;
+    if (!read_record(buffer, offset, sizeof(header), header) || header.magic != PROCESS_STATISTICS_MAGIC || header.version < PROCESS_STATISTICS_VERSION)
+        return {};
+    offset = header.header_size;
+
+    HashMap<pid_t, Core::ProcessStatistics> map;
+    for (u32 i = 0; i < header.process_count; ++i) {
+        ProcessStatisticsRecord record;
+        if (!read_record(buffer, offset, header.process_record_size, record))
+            return {};
+        Core::ProcessStatistics process;
+
+        process.pid = record.pid;
+        process.pgid = record.pgid;
+        process.pgp = record.pgp;
+        process.sid = record.sid;
+        process.uid = record.uid;
+        process.gid = record.gid;
+        process.ppid = record.ppid;
+        process.nfds = record.nfds;
+        process.name = string_from_record_field(record.name, sizeof(record.name));
+        process.tty = string_from_record_field(record.tty, sizeof(record.tty));
+        StringBuilder pledge_builder;
+#define __ENUMERATE_PLEDGE_PROMISE(promise) \
+    if (record.pledge & (1u << pledge_index)) \
+        pledge_builder.append(#promise " ");  \
+    ++pledge_index;
+        u32 pledge_index = 0;
+        ENUMERATE_PLEDGE_PROMISES
+#undef __ENUMERATE_PLEDGE_PROMISE
+        process.pledge = pledge_builder.to_string();
+        switch (record.veil) {
+        case ProcessStatisticsVeilDropped:
+            process.veil = "Dropped";
+            break;
+        case ProcessStatisticsVeilLocked:
+            process.veil = "Locked";
+            break;
+        default:
+            process.veil = "None";
+            break;
+        }
+        process.amount_virtual = record.amount_virtual;
+        process.amount_resident = record.amount_resident;
+        process.amount_shared = record.amount_shared;
+        process.amount_private = record.amount_private;
+        process.amount_dirty_private = record.amount_dirty_private;
+        process.amount_clean_inode = record.amount_clean_inode;
+        process.amount_purgeable_volatile = record.amount_purgeable_volatile;
+        process.amount_purgeable_nonvolatile = record.amount_purgeable_nonvolatile;
+        process.icon_id = record.icon_id;
+
+        process.threads.ensure_capacity(record.thread_count);
+        for (u32 j = 0; j < record.thread_count; ++j) {
+            ThreadStatisticsRecord thread_record;
+            if (!read_record(buffer, offset, header.thread_record_size, thread_record))
+                return {};
+            Core::ThreadStatistics thread;
+            thread.tid = thread_record.tid;
+            thread.times_scheduled = thread_record.times_scheduled;
+            thread.name = string_from_record_field(thread_record.name, sizeof(thread_record.name));
+            thread.state = string_from_record_field(thread_record.state, sizeof(thread_record.state));
+            thread.ticks = thread_record.ticks;
+            thread.cpu = thread_record.cpu;
+            thread.times_migrated = thread_record.times_migrated;
+            thread.priority = thread_record.priority;
+            thread.effective_priority = thread_record.effective_priority;
+            thread.syscall_count = thread_record.syscall_count;
+            thread.inode_faults = thread_record.inode_faults;
+            thread.zero_faults = thread_record.zero_faults;
+            thread.cow_faults = thread_record.cow_faults;
+            thread.unix_socket_read_bytes = thread_record.unix_socket_read_bytes;
+            thread.unix_socket_write_bytes = thread_record.unix_socket_write_bytes;
+            thread.ipv4_socket_read_bytes = thread_record.ipv4_socket_read_bytes;
+            thread.ipv4_socket_write_bytes = thread_record.ipv4_socket_write_bytes;
+            thread.file_read_bytes = thread_record.file_read_bytes;
+            thread.file_write_bytes = thread_record.file_write_bytes;
+            thread.runnable_cycles = thread_record.runnable_cycles;
+            thread.blocked_cycles = thread_record.blocked_cycles;
+            thread.queued_cycles = thread_record.queued_cycles;
+            thread.involuntary_switches = thread_record.involuntary_switches;
+            process.threads.append(move(thread));
+        }
+
+        process.username = username_from_uid(process.uid);
+        map.set(process.pid, move(process));
+    }
+    return map;
+}
+
 HashMap<pid_t, Core::ProcessStatistics> ProcessStatisticsReader::get_all()
 {
+    // The binary format is much cheaper to produce and parse, /proc/all remains for older kernels.
+    if (auto map = get_all_from_binary(); map.has_value())
+        return map.release_value();
+
     auto file = Core::File::construct("/proc/all");
     if (!file->open(Core::IODevice::ReadOnly)) {
         fprintf(stderr, "ProcessStatisticsReader: Failed to open /proc/all: %s\n", file->error_string());
@@ -69,6 +191,7 @@ HashMap<pid_t, Core::ProcessStatistics> ProcessStatisticsReader::get_all()
         process.amount_virtual = process_object.get("amount_virtual").to_u32();
         process.amount_resident = process_object.get("amount_resident").to_u32();
         process.amount_shared = process_object.get("amount_shared").to_u32();
+        process.amount_private = process_object.get("amount_private").to_u32();
         process.amount_dirty_private = process_object.get("amount_dirty_private").to_u32();
         process.amount_clean_inode = process_object.get("amount_clean_inode").to_u32();
         process.amount_purgeable_volatile = process_object.get("amount_purgeable_volatile").to_u32();
@@ -86,6 +209,7 @@ HashMap<pid_t, Core::ProcessStatistics> ProcessStatisticsReader::get_all()
             thread.state = thread_object.get("state").to_string();
             thread.ticks = thread_object.get("ticks").to_u32();
             thread.cpu = thread_object.get("cpu").to_u32();
+            thread.times_migrated = thread_object.get("times_migrated").to_u32();
             thread.priority = thread_object.get("priority").to_u32();
             thread.effective_priority = thread_object.get("effective_priority").to_u32();
             thread.syscall_count = thread_object.get("syscall_count").to_u32();
@@ -98,6 +222,10 @@ HashMap<pid_t, Core::ProcessStatistics> ProcessStatisticsReader::get_all()
             thread.ipv4_socket_write_bytes = thread_object.get("ipv4_socket_write_bytes").to_u32();
             thread.file_read_bytes = thread_object.get("file_read_bytes").to_u32();
             thread.file_write_bytes = thread_object.get("file_write_bytes").to_u32();
+            thread.runnable_cycles = thread_object.get("runnable_cycles").to_u64();
+            thread.blocked_cycles = thread_object.get("blocked_cycles").to_u64();
+            thread.queued_cycles = thread_object.get("queued_cycles").to_u64();
+            thread.involuntary_switches = thread_object.get("involuntary_switches").to_u32();
             process.threads.append(move(thread));
         });
 
@@ -27,6 +27,7 @@
 #pragma once
 
 #include <AK/HashMap.h>
+#include <AK/Optional.h>
 #include <AK/String.h>
 #include <unistd.h>
 
@@ -48,13 +49,19 @@ struct ThreadStatistics {
     unsigned file_write_bytes;
     String state;
     u32 cpu;
+    u32 times_migrated;
     u32 priority;
     u32 effective_priority;
     String name;
+    // In TSC cycles, see /proc/PID/schedstat for a breakdown.
+    u64 runnable_cycles;
+    u64 blocked_cycles;
+    u64 queued_cycles;
+    unsigned involuntary_switches;
 };
 
 struct ProcessStatistics {
-    // Keep this in sync with /proc/all.
+    // Keep this in sync with /proc/all and /proc/all_binary.
     // From the kernel side:
     pid_t pid;
     unsigned pgid;
@@ -71,6 +78,7 @@ struct ProcessStatistics {
     size_t amount_virtual;
     size_t amount_resident;
     size_t amount_shared;
+    size_t amount_private;
     size_t amount_dirty_private;
     size_t amount_clean_inode;
     size_t amount_purgeable_volatile;
@@ -88,6 +96,7 @@ public:
     static HashMap<pid_t, Core::ProcessStatistics> get_all();
 
 private:
+    static Optional<HashMap<pid_t, Core::ProcessStatistics>> get_all_from_binary();
     static String username_from_uid(uid_t);
     static HashMap<uid_t, String> s_usernames;
 };
@@ -199,10 +199,18 @@ void Socket::did_update_fd(int fd)
     }
 }
 
+void Socket::set_reading_paused(bool paused)
+{
+    m_reading_paused = paused;
+    if (m_read_notifier)
+        m_read_notifier->set_enabled(!paused);
+}
+
 void Socket::ensure_read_notifier()
 {
     ASSERT(m_connected);
     m_read_notifier = Notifier::construct(fd(), Notifier::Event::Read, this);
+    m_read_notifier->set_enabled(!m_reading_paused);
     m_read_notifier->on_ready_to_read = [this] {
         if (!can_read())
             return;
@@ -56,6 +56,11 @@ public:
     bool is_connected() const { return m_connected; }
     void set_blocking(bool blocking);
 
+    // While paused, on_ready_to_read is not called and unread data stays in the kernel,
+    // so a slow consumer pushes back on the peer instead of piling up data in memory.
+    void set_reading_paused(bool);
+    bool is_reading_paused() const { return m_reading_paused; }
+
     SocketAddress source_address() const { return m_source_address; }
     int source_port() const { return m_source_port; }
 
@@ -84,6 +89,7 @@ private:
     Type m_type { Type::Invalid };
     RefPtr<Notifier> m_notifier;
     RefPtr<Notifier> m_read_notifier;
+    bool m_reading_paused { false };
 };
 
 }
@@ -0,0 +1,286 @@
+/*
+ * Copyright (c) 2020, Ali Mohammad Pur <ali.mpfard@gmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <AK/Platform.h>
+#include <LibCrypto/Authentication/GHash.h>
+
+#if ARCH(I386) || ARCH(X86_64)
+#    include <cpuid.h>
+#    include <wmmintrin.h>
+#endif
+
+namespace Crypto {
+namespace Authentication {
+
+static bool has_pclmul()
+{
+#if ARCH(I386) || ARCH(X86_64)
+    static bool s_has_pclmul = [] {
+        unsigned eax, ebx, ecx, edx;
+        return __get_cpuid(1, &eax, &ebx, &ecx, &edx) && (ecx & bit_PCLMUL) && (edx & bit_SSE2);
+    }();
+    return s_has_pclmul;
+#else
+    return false;
+#endif
+}
+
+static inline u64 load_be64(const u8* data)
+{
+    u64 value;
+    __builtin_memcpy(&value, data, sizeof(value));
+    return __builtin_bswap64(value);
+}
+
+static inline void store_be64(u8* data, u64 value)
+{
+    value = __builtin_bswap64(value);
+    __builtin_memcpy(data, &value, sizeof(value));
+}
+
+// The software fallback multiplies with integer multiplications, with every fourth bit of the
+// operands masked out so that the carries land in the holes and can be masked away again.
+// Unlike the usual table-driven GHASH there are no lookups indexed by secret data.
+// See BearSSL's ghash_ctmul64.c for the derivation.
+static inline u64 carryless_multiply_low(u64 x, u64 y)
+{
+    auto x0 = x & 0x1111111111111111ull;
+    auto x1 = x & 0x2222222222222222ull;
+    auto x2 = x & 0x4444444444444444ull;
+    auto x3 = x & 0x8888888888888888ull;
+    auto y0 = y & 0x1111111111111111ull;
+    auto y1 = y & 0x2222222222222222ull;
+    auto y2 = y & 0x4444444444444444ull;
+    auto y3 = y & 0x8888888888888888ull;
+    auto z0 = (x0 * y0) ^ (x1 * y3) ^ (x2 * y2) ^ (x3 * y1);
+    auto z1 = (x0 * y1) ^ (x1 * y0) ^ (x2 * y3) ^ (x3 * y2);
+    auto z2 = (x0 * y2) ^ (x1 * y1) ^ (x2 * y0) ^ (x3 * y3);
+    auto z3 = (x0 * y3) ^ (x1 * y2) ^ (x2 * y1) ^ (x3 * y0);
+    return (z0 & 0x1111111111111111ull) | (z1 & 0x2222222222222222ull) | (z2 & 0x4444444444444444ull) | (z3 & 0x8888888888888888ull);
+}
+
+static inline u64 reverse_bits(u64 x)
+{
+    x = ((x & 0x5555555555555555ull) << 1) | ((x >> 1) & 0x5555555555555555ull);
+    x = ((x & 0x3333333333333333ull) << 2) | ((x >> 2) & 0x3333333333333333ull);
+    x = ((x & 0x0F0F0F0F0F0F0F0Full) << 4) | ((x >> 4) & 0x0F0F0F0F0F0F0F0Full);
+    return __builtin_bswap64(x);
+}
+
+// y = y * h in GF(2^128), in GHASH's bit order.
+static void multiply(u64 y[2], const u64 h[2])
+{
+    auto y1 = y[0];
+    auto y0 = y[1];
+    auto h1 = h[0];
+    auto h0 = h[1];
+    auto h0r = reverse_bits(h0);
+    auto h1r = reverse_bits(h1);
+    auto y0r = reverse_bits(y0);
+    auto y1r = reverse_bits(y1);
+
+    // Karatsuba, with the high halves of the products computed on the bit-reversed operands.
+    auto z0 = carryless_multiply_low(y0, h0);
+    auto z1 = carryless_multiply_low(y1, h1);
+    auto z2 = carryless_multiply_low(y0 ^ y1, h0 ^ h1);
+    auto z0h = carryless_multiply_low(y0r, h0r);
+    auto z1h = carryless_multiply_low(y1r, h1r);
+    auto z2h = carryless_multiply_low(y0r ^ y1r, h0r ^ h1r);
+    z2 ^= z0 ^ z1;
+    z2h ^= z0h ^ z1h;
+    z0h = reverse_bits(z0h) >> 1;
+    z1h = reverse_bits(z1h) >> 1;
+    z2h = reverse_bits(z2h) >> 1;
+
+    auto v0 = z0;
+    auto v1 = z0h ^ z2;
+    auto v2 = z1 ^ z2h;
+    auto v3 = z1h;
+
+    // GHASH's bits are reflected, so the product is one bit short; shift it back in place.
+    v3 = (v3 << 1) | (v2 >> 63);
+    v2 = (v2 << 1) | (v1 >> 63);
+    v1 = (v1 << 1) | (v0 >> 63);
+    v0 = (v0 << 1);
+
+    // Reduce modulo x^128 + x^7 + x^2 + x + 1.
+    v2 ^= v0 ^ (v0 >> 1) ^ (v0 >> 2) ^ (v0 >> 7);
+    v1 ^= (v0 << 63) ^ (v0 << 62) ^ (v0 << 57);
+    v3 ^= v1 ^ (v1 >> 1) ^ (v1 >> 2) ^ (v1 >> 7);
+    v2 ^= (v1 << 63) ^ (v1 << 62) ^ (v1 << 57);
+
+    y[0] = v3;
+    y[1] = v2;
+}
+
+#if ARCH(I386) || ARCH(X86_64)
+// With PCLMULQDQ, a block held as a 128-bit integer (first byte most significant) is exactly
+// the byte-reflected operand of Intel's "Carry-Less Multiplication Instruction and its Usage
+// for Computing the GCM Mode" white paper, whose algorithms 2 and 5 these follow.
+
+[[gnu::target("pclmul,sse2")]] static inline __m128i load_block(const u64 block[2])
+{
+    return _mm_set_epi64x(block[0], block[1]);
+}
+
+[[gnu::target("pclmul,sse2")]] static inline __m128i load_block(const u8* data)
+{
+    return _mm_set_epi64x(load_be64(data), load_be64(data + 8));
+}
+
+// Accumulates the unreduced 256-bit product of a and b into lo:hi.
+[[gnu::target("pclmul,sse2")]] static inline void multiply_accumulate(__m128i a, __m128i b, __m128i& lo, __m128i& hi)
+{
+    auto low = _mm_clmulepi64_si128(a, b, 0x00);
+    auto middle = _mm_xor_si128(_mm_clmulepi64_si128(a, b, 0x10), _mm_clmulepi64_si128(a, b, 0x01));
+    auto high = _mm_clmulepi64_si128(a, b, 0x11);
+    lo = _mm_xor_si128(lo, _mm_xor_si128(low, _mm_slli_si128(middle, 8)));
+    hi = _mm_xor_si128(hi, _mm_xor_si128(high, _mm_srli_si128(middle, 8)));
+}
+
+[[gnu::target("pclmul,sse2")]] static inline __m128i reduce(__m128i lo, __m128i hi)
+{
+    // Shift the 256-bit product left by one to account for the reflected bit order.
+    auto lo_carry = _mm_srli_epi32(lo, 31);
+    auto hi_carry = _mm_srli_epi32(hi, 31);
+    lo = _mm_slli_epi32(lo, 1);
+    hi = _mm_slli_epi32(hi, 1);
+    auto carry_into_hi = _mm_srli_si128(lo_carry, 12);
+    hi_carry = _mm_slli_si128(hi_carry, 4);
+    lo_carry = _mm_slli_si128(lo_carry, 4);
+    lo = _mm_or_si128(lo, lo_carry);
+    hi = _mm_or_si128(hi, hi_carry);
+    hi = _mm_or_si128(hi, carry_into_hi);
+
+    // Reduce modulo x^128 + x^7 + x^2 + x + 1.
+    auto a = _mm_xor_si128(_mm_xor_si128(_mm_slli_epi32(lo, 31), _mm_slli_epi32(lo, 30)), _mm_slli_epi32(lo, 25));
+    auto b = _mm_srli_si128(a, 4);
+    a = _mm_slli_si128(a, 12);
+    lo = _mm_xor_si128(lo, a);
+    auto c = _mm_xor_si128(_mm_xor_si128(_mm_srli_epi32(lo, 1), _mm_srli_epi32(lo, 2)), _mm_srli_epi32(lo, 7));
+    c = _mm_xor_si128(c, b);
+    lo = _mm_xor_si128(lo, c);
+    return _mm_xor_si128(hi, lo);
+}
+
+[[gnu::target("pclmul,sse2")]] static void process_blocks_pclmul(u64 state[2], const u64 key_powers[4][2], const u8* data, size_t block_count)
+{
+    auto y = load_block(state);
+    auto h1 = load_block(key_powers[0]);
+    auto h2 = load_block(key_powers[1]);
+    auto h3 = load_block(key_powers[2]);
+    auto h4 = load_block(key_powers[3]);
+
+    // ((((y + x0)h + x1)h + x2)h + x3)h = (y + x0)h^4 + x1h^3 + x2h^2 + x3h, which needs only one
+    // reduction for the four blocks.
+    for (; block_count >= 4; block_count -= 4, data += 64) {
+        auto lo = _mm_setzero_si128();
+        auto hi = _mm_setzero_si128();
+        multiply_accumulate(_mm_xor_si128(y, load_block(data)), h4, lo, hi);
+        multiply_accumulate(load_block(data + 16), h3, lo, hi);
+        multiply_accumulate(load_block(data + 32), h2, lo, hi);
+        multiply_accumulate(load_block(data + 48), h1, lo, hi);
+        y = reduce(lo, hi);
+    }
+    for (; block_count > 0; --block_count, data += 16) {
+        auto lo = _mm_setzero_si128();
+        auto hi = _mm_setzero_si128();
+        multiply_accumulate(_mm_xor_si128(y, load_block(data)), h1, lo, hi);
+        y = reduce(lo, hi);
+    }
+
+    alignas(16) u64 result[2];
+    _mm_store_si128((__m128i*)result, y);
+    state[0] = result[1];
+    state[1] = result[0];
+}
+#endif
+
+GHash::GHash(ReadonlyBytes key)
+{
+    ASSERT(key.size() == block_size());
+    m_key[0] = load_be64(key.data());
+    m_key[1] = load_be64(key.data() + 8);
+
+    m_key_powers[0][0] = m_key[0];
+    m_key_powers[0][1] = m_key[1];
+    for (size_t i = 1; i < 4; ++i) {
+        m_key_powers[i][0] = m_key_powers[i - 1][0];
+        m_key_powers[i][1] = m_key_powers[i - 1][1];
+        multiply(m_key_powers[i], m_key);
+    }
+
+    reset();
+}
+
+void GHash::reset()
+{
+    m_state[0] = 0;
+    m_state[1] = 0;
+}
+
+void GHash::process_blocks(const u8* data, size_t block_count)
+{
+#if ARCH(I386) || ARCH(X86_64)
+    if (has_pclmul()) {
+        process_blocks_pclmul(m_state, m_key_powers, data, block_count);
+        return;
+    }
+#endif
+    for (size_t i = 0; i < block_count; ++i, data += block_size()) {
+        m_state[0] ^= load_be64(data);
+        m_state[1] ^= load_be64(data + 8);
+        multiply(m_state, m_key);
+    }
+}
+
+void GHash::update(ReadonlyBytes data)
+{
+    auto whole_blocks = data.size() / block_size();
+    process_blocks(data.data(), whole_blocks);
+
+    auto remaining = data.size() % block_size();
+    if (remaining) {
+        u8 last_block[block_size()] {};
+        __builtin_memcpy(last_block, data.offset(whole_blocks * block_size()), remaining);
+        process_blocks(last_block, 1);
+    }
+}
+
+void GHash::digest(u64 aad_length, u64 ciphertext_length, u8* out)
+{
+    u8 length_block[block_size()];
+    store_be64(length_block, aad_length * 8);
+    store_be64(length_block + 8, ciphertext_length * 8);
+    process_blocks(length_block, 1);
+
+    store_be64(out, m_state[0]);
+    store_be64(out + 8, m_state[1]);
+    reset();
+}
+
+}
+}
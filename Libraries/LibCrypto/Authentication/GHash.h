@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) 2020, Ali Mohammad Pur <ali.mpfard@gmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/Span.h>
+#include <AK/Types.h>
+
+namespace Crypto {
+namespace Authentication {
+
+// GHASH, the universal hash that authenticates the data in GCM.
+// See NIST SP 800-38D, section 6.4.
+class GHash final {
+public:
+    static constexpr size_t block_size() { return 16; }
+    static constexpr size_t digest_size() { return 16; }
+
+    // `key' is the hash subkey H, which GCM derives by encrypting a zero block.
+    explicit GHash(ReadonlyBytes key);
+
+    // Data is zero-padded to a whole number of blocks, so only the last piece of the additional
+    // data, and the last piece of the ciphertext, may have a length that is not a multiple of
+    // the block size.
+    void update(ReadonlyBytes);
+
+    // Mixes in the lengths (in bytes) of the additional data and the ciphertext, and writes
+    // the result into `out'. The hash starts over afterwards.
+    void digest(u64 aad_length, u64 ciphertext_length, u8* out);
+
+    void reset();
+
+private:
+    void process_blocks(const u8* data, size_t block_count);
+
+    // Blocks are kept as two 64-bit big-endian halves, the first half being the most
+    // significant one.
+    u64 m_key[2];
+    u64 m_state[2];
+
+    // H^1 to H^4, for folding four blocks at a time with carry-less multiplication.
+    u64 m_key_powers[4][2];
+};
+
+}
+}
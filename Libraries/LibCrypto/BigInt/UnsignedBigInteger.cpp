@@ -587,40 +587,146 @@ FLATTEN void UnsignedBigInteger::shift_left_without_allocation(
     }
 }
 
+// Below this many words, schoolbook multiplication beats Karatsuba's extra additions.
+static constexpr size_t KARATSUBA_THRESHOLD = 32;
+
+static void schoolbook_multiply(const u32* left, size_t left_length, const u32* right, size_t right_length, u32* output)
+{
+    __builtin_memset(output, 0, (left_length + right_length) * sizeof(u32));
+    for (size_t i = 0; i < left_length; ++i) {
+        u64 carry = 0;
+        for (size_t j = 0; j < right_length; ++j) {
+            u64 product = (u64)left[i] * right[j] + output[i + j] + carry;
+            output[i + j] = (u32)product;
+            carry = product >> 32;
+        }
+        output[i + right_length] = (u32)carry;
+    }
+}
+
+// output[0..length) += addend[0..addend_length), with the carry rippling up to output[length - 1].
+static void add_words_in_place(u32* output, size_t length, const u32* addend, size_t addend_length)
+{
+    u64 carry = 0;
+    size_t i = 0;
+    for (; i < addend_length && i < length; ++i) {
+        u64 sum = (u64)output[i] + addend[i] + carry;
+        output[i] = (u32)sum;
+        carry = sum >> 32;
+    }
+    for (; carry && i < length; ++i) {
+        u64 sum = (u64)output[i] + carry;
+        output[i] = (u32)sum;
+        carry = sum >> 32;
+    }
+}
+
+// output[0..length) -= subtrahend[0..subtrahend_length); the result must not be negative.
+static void subtract_words_in_place(u32* output, size_t length, const u32* subtrahend, size_t subtrahend_length)
+{
+    u32 borrow = 0;
+    size_t i = 0;
+    for (; i < subtrahend_length; ++i) {
+        u64 difference = (u64)output[i] - subtrahend[i] - borrow;
+        output[i] = (u32)difference;
+        borrow = (difference >> 32) ? 1 : 0;
+    }
+    for (; borrow && i < length; ++i) {
+        borrow = output[i] == 0 ? 1 : 0;
+        --output[i];
+    }
+}
+
+// Sums the low and high parts into output[0..high_length + 1).
+static void add_halves(const u32* low, size_t low_length, const u32* high, size_t high_length, u32* output)
+{
+    ASSERT(high_length >= low_length);
+    __builtin_memcpy(output, high, high_length * sizeof(u32));
+    output[high_length] = 0;
+    add_words_in_place(output, high_length + 1, low, low_length);
+}
+
+static size_t karatsuba_scratch_size(size_t left_length, size_t right_length)
+{
+    if (min(left_length, right_length) < KARATSUBA_THRESHOLD)
+        return 0;
+    auto half = min(left_length, right_length) / 2;
+    auto sum_length = (left_length - half + 1) + (right_length - half + 1);
+    return 2 * sum_length + karatsuba_scratch_size(left_length - half + 1, right_length - half + 1);
+}
+
+// Splits both numbers at `half' words, so that with B = 2^(32 * half):
+// left * right = z2 * B^2 + z1 * B + z0, with z0 = l0 * r0, z2 = l1 * r1 and
+// z1 = (l0 + l1)(r0 + r1) - z0 - z2, which takes three multiplications of half the size instead of four.
+static void karatsuba_multiply(const u32* left, size_t left_length, const u32* right, size_t right_length, u32* output, u32* scratch)
+{
+    if (min(left_length, right_length) < KARATSUBA_THRESHOLD) {
+        schoolbook_multiply(left, left_length, right, right_length, output);
+        return;
+    }
+
+    auto half = min(left_length, right_length) / 2;
+    auto left_high_length = left_length - half;
+    auto right_high_length = right_length - half;
+
+    // z0 and z2 go straight into their place in the output.
+    karatsuba_multiply(left, half, right, half, output, scratch);
+    karatsuba_multiply(left + half, left_high_length, right + half, right_high_length, output + 2 * half, scratch);
+
+    auto* left_sum = scratch;
+    auto left_sum_length = left_high_length + 1;
+    auto* right_sum = left_sum + left_sum_length;
+    auto right_sum_length = right_high_length + 1;
+    auto* middle = right_sum + right_sum_length;
+    auto middle_length = left_sum_length + right_sum_length;
+
+    add_halves(left, half, left + half, left_high_length, left_sum);
+    add_halves(right, half, right + half, right_high_length, right_sum);
+    karatsuba_multiply(left_sum, left_sum_length, right_sum, right_sum_length, middle, middle + middle_length);
+
+    subtract_words_in_place(middle, middle_length, output, 2 * half);
+    subtract_words_in_place(middle, middle_length, output + 2 * half, left_high_length + right_high_length);
+    add_words_in_place(output + half, left_length + right_length - half, middle, middle_length);
+}
+
 /**
- * Complexity: O(N^2) where N is the number of words in the larger number
+ * Complexity: O(N^2) where N is the number of words in the smaller number, or
+ * O(N^1.58) once both numbers are at least KARATSUBA_THRESHOLD words long.
  * Multiplication method:
- * An integer is equal to the sum of the powers of two
- * according to the indexes of its 'on' bits.
- * So to multiple x*y, we go over each '1' bit in x (say the i'th bit), 
- * and add y<<i to the result.
+ * Schoolbook multiplication a word at a time, with 64-bit intermediate products.
+ * Large numbers are split in halves, and multiplied with Karatsuba's method.
+ * The temporaries hold the scratch space Karatsuba needs.
  */
 FLATTEN void UnsignedBigInteger::multiply_without_allocation(
     const UnsignedBigInteger& left,
     const UnsignedBigInteger& right,
     UnsignedBigInteger& temp_shift_result,
-    UnsignedBigInteger& temp_shift_plus,
-    UnsignedBigInteger& temp_shift,
-    UnsignedBigInteger& temp_plus,
+    UnsignedBigInteger&,
+    UnsignedBigInteger&,
+    UnsignedBigInteger&,
     UnsignedBigInteger& output)
 {
+    auto left_length = left.trimmed_length();
+    auto right_length = right.trimmed_length();
+
     output.set_to_0();
+    if (left_length == 0 || right_length == 0) {
+        output.m_words.append(0);
+        return;
+    }
+    output.m_words.resize_and_keep_capacity(left_length + right_length);
 
-    // iterate all bits
-    for (size_t word_index = 0; word_index < left.length(); ++word_index) {
-        for (size_t bit_index = 0; bit_index < UnsignedBigInteger::BITS_IN_WORD; ++bit_index) {
-            // If the bit is off - skip over it
-            if (!(left.m_words[word_index] & (1 << bit_index)))
-                continue;
+    temp_shift_result.set_to_0();
+    temp_shift_result.m_words.resize_and_keep_capacity(karatsuba_scratch_size(left_length, right_length));
 
-            const size_t shift_amount = word_index * UnsignedBigInteger::BITS_IN_WORD + bit_index;
+    karatsuba_multiply(left.m_words.data(), left_length, right.m_words.data(), right_length, output.m_words.data(), temp_shift_result.m_words.data());
 
-            // output += (right << shift_amount);
-            shift_left_without_allocation(right, shift_amount, temp_shift_result, temp_shift_plus, temp_shift);
-            add_without_allocation(output, temp_shift, temp_plus);
-            output.set_to(temp_plus);
-        }
-    }
+    // Like the other operations, don't keep high zero words around; callers size things by length().
+    auto product_length = left_length + right_length;
+    while (product_length > 1 && output.m_words[product_length - 1] == 0)
+        --product_length;
+    output.m_words.resize_and_keep_capacity(product_length);
+    output.m_cached_trimmed_length = {};
 }
 
 /**
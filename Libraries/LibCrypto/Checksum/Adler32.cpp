@@ -25,6 +25,7 @@
  */
 
 #include <AK/Span.h>
+#include <AK/StdLibExtras.h>
 #include <AK/Types.h>
 #include <Libraries/LibCrypto/Checksum/Adler32.h>
 
@@ -32,9 +33,21 @@ namespace Crypto::Checksum {
 
 void Adler32::update(ReadonlyBytes data)
 {
-    for (size_t i = 0; i < data.size(); i++) {
-        m_state_a = (m_state_a + data.at(i)) % 65521;
-        m_state_b = (m_state_b + m_state_a) % 65521;
+    // 5552 is the largest block size for which the sums can't overflow 32 bits,
+    // so the modulo only has to be taken once per block.
+    constexpr size_t max_block_size = 5552;
+
+    auto* bytes = data.data();
+    size_t remaining = data.size();
+    while (remaining) {
+        auto block_size = min(remaining, max_block_size);
+        remaining -= block_size;
+        while (block_size--) {
+            m_state_a += *bytes++;
+            m_state_b += m_state_a;
+        }
+        m_state_a %= 65521;
+        m_state_b %= 65521;
     }
 };
 
@@ -24,9 +24,17 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <AK/Platform.h>
 #include <AK/StringBuilder.h>
 #include <LibCrypto/Cipher/AES.h>
 
+// The kernel doesn't preserve the SSE registers of the interrupted thread, so it sticks to the
+// software implementation.
+#if (ARCH(I386) || ARCH(X86_64)) && !defined(KERNEL)
+#    include <cpuid.h>
+#    include <wmmintrin.h>
+#endif
+
 namespace Crypto {
 namespace Cipher {
 
@@ -43,6 +51,488 @@ constexpr void swap_keys(u32* keys, size_t i, size_t j)
     keys[j] = temp;
 }
 
+constexpr u32 RCON[] = {
+    0x01000000,
+    0x02000000,
+    0x04000000,
+    0x08000000,
+    0x10000000,
+    0x20000000,
+    0x40000000,
+    0x80000000,
+    0x1B000000,
+    0x36000000,
+};
+
+static bool has_aes_ni()
+{
+#if (ARCH(I386) || ARCH(X86_64)) && !defined(KERNEL)
+    static bool s_has_aes_ni = [] {
+        unsigned eax, ebx, ecx, edx;
+        return __get_cpuid(1, &eax, &ebx, &ecx, &edx) && (ecx & bit_AES) && (edx & bit_SSE2);
+    }();
+    return s_has_aes_ni;
+#else
+    return false;
+#endif
+}
+
+// The software implementation is bitsliced: two blocks are spread over eight words, with word i
+// holding bit i of every byte. The S-box is then evaluated as a boolean circuit on whole words,
+// so there are no table lookups, and no memory accesses or branches that depend on the data or
+// the key. See "Faster and Timing-Attack Resistant AES-GCM" (Käsper, Schwabe) for the layout,
+// and Boyar and Peralta's work for the S-box circuit.
+namespace Bitsliced {
+
+static inline u32 load_le32(const u8* bytes)
+{
+    return (u32)bytes[0] | ((u32)bytes[1] << 8) | ((u32)bytes[2] << 16) | ((u32)bytes[3] << 24);
+}
+
+static inline void store_le32(u8* bytes, u32 value)
+{
+    bytes[0] = (u8)value;
+    bytes[1] = (u8)(value >> 8);
+    bytes[2] = (u8)(value >> 16);
+    bytes[3] = (u8)(value >> 24);
+}
+
+static inline void swap_bits(u32& x, u32& y, u32 low_mask, u32 high_mask, unsigned shift)
+{
+    u32 a = x;
+    u32 b = y;
+    x = (a & low_mask) | ((b & low_mask) << shift);
+    y = ((a & high_mask) >> shift) | (b & high_mask);
+}
+
+// Converts between eight words of block data and the bitsliced layout. It's its own inverse.
+static void orthogonalize(u32* q)
+{
+    swap_bits(q[0], q[1], 0x55555555, 0xaaaaaaaa, 1);
+    swap_bits(q[2], q[3], 0x55555555, 0xaaaaaaaa, 1);
+    swap_bits(q[4], q[5], 0x55555555, 0xaaaaaaaa, 1);
+    swap_bits(q[6], q[7], 0x55555555, 0xaaaaaaaa, 1);
+
+    swap_bits(q[0], q[2], 0x33333333, 0xcccccccc, 2);
+    swap_bits(q[1], q[3], 0x33333333, 0xcccccccc, 2);
+    swap_bits(q[4], q[6], 0x33333333, 0xcccccccc, 2);
+    swap_bits(q[5], q[7], 0x33333333, 0xcccccccc, 2);
+
+    swap_bits(q[0], q[4], 0x0f0f0f0f, 0xf0f0f0f0, 4);
+    swap_bits(q[1], q[5], 0x0f0f0f0f, 0xf0f0f0f0, 4);
+    swap_bits(q[2], q[6], 0x0f0f0f0f, 0xf0f0f0f0, 4);
+    swap_bits(q[3], q[7], 0x0f0f0f0f, 0xf0f0f0f0, 4);
+}
+
+static void sub_bytes(u32* q)
+{
+    u32 x0 = q[7];
+    u32 x1 = q[6];
+    u32 x2 = q[5];
+    u32 x3 = q[4];
+    u32 x4 = q[3];
+    u32 x5 = q[2];
+    u32 x6 = q[1];
+    u32 x7 = q[0];
+
+    // Top linear transformation.
+    u32 y14 = x3 ^ x5;
+    u32 y13 = x0 ^ x6;
+    u32 y9 = x0 ^ x3;
+    u32 y8 = x0 ^ x5;
+    u32 t0 = x1 ^ x2;
+    u32 y1 = t0 ^ x7;
+    u32 y4 = y1 ^ x3;
+    u32 y12 = y13 ^ y14;
+    u32 y2 = y1 ^ x0;
+    u32 y5 = y1 ^ x6;
+    u32 y3 = y5 ^ y8;
+    u32 t1 = x4 ^ y12;
+    u32 y15 = t1 ^ x5;
+    u32 y20 = t1 ^ x1;
+    u32 y6 = y15 ^ x7;
+    u32 y10 = y15 ^ t0;
+    u32 y11 = y20 ^ y9;
+    u32 y7 = x7 ^ y11;
+    u32 y17 = y10 ^ y11;
+    u32 y19 = y10 ^ y8;
+    u32 y16 = t0 ^ y11;
+    u32 y21 = y13 ^ y16;
+    u32 y18 = x0 ^ y16;
+
+    // Non-linear section: inversion in GF(2^4)^2.
+    u32 t2 = y12 & y15;
+    u32 t3 = y3 & y6;
+    u32 t4 = t3 ^ t2;
+    u32 t5 = y4 & x7;
+    u32 t6 = t5 ^ t2;
+    u32 t7 = y13 & y16;
+    u32 t8 = y5 & y1;
+    u32 t9 = t8 ^ t7;
+    u32 t10 = y2 & y7;
+    u32 t11 = t10 ^ t7;
+    u32 t12 = y9 & y11;
+    u32 t13 = y14 & y17;
+    u32 t14 = t13 ^ t12;
+    u32 t15 = y8 & y10;
+    u32 t16 = t15 ^ t12;
+    u32 t17 = t4 ^ t14;
+    u32 t18 = t6 ^ t16;
+    u32 t19 = t9 ^ t14;
+    u32 t20 = t11 ^ t16;
+    u32 t21 = t17 ^ y20;
+    u32 t22 = t18 ^ y19;
+    u32 t23 = t19 ^ y21;
+    u32 t24 = t20 ^ y18;
+
+    u32 t25 = t21 ^ t22;
+    u32 t26 = t21 & t23;
+    u32 t27 = t24 ^ t26;
+    u32 t28 = t25 & t27;
+    u32 t29 = t28 ^ t22;
+    u32 t30 = t23 ^ t24;
+    u32 t31 = t22 ^ t26;
+    u32 t32 = t31 & t30;
+    u32 t33 = t32 ^ t24;
+    u32 t34 = t23 ^ t33;
+    u32 t35 = t27 ^ t33;
+    u32 t36 = t24 & t35;
+    u32 t37 = t36 ^ t34;
+    u32 t38 = t27 ^ t36;
+    u32 t39 = t29 & t38;
+    u32 t40 = t25 ^ t39;
+
+    u32 t41 = t40 ^ t37;
+    u32 t42 = t29 ^ t33;
+    u32 t43 = t29 ^ t40;
+    u32 t44 = t33 ^ t37;
+    u32 t45 = t42 ^ t41;
+    u32 z0 = t44 & y15;
+    u32 z1 = t37 & y6;
+    u32 z2 = t33 & x7;
+    u32 z3 = t43 & y16;
+    u32 z4 = t40 & y1;
+    u32 z5 = t29 & y7;
+    u32 z6 = t42 & y11;
+    u32 z7 = t45 & y17;
+    u32 z8 = t41 & y10;
+    u32 z9 = t44 & y12;
+    u32 z10 = t37 & y3;
+    u32 z11 = t33 & y4;
+    u32 z12 = t43 & y13;
+    u32 z13 = t40 & y5;
+    u32 z14 = t29 & y2;
+    u32 z15 = t42 & y9;
+    u32 z16 = t45 & y14;
+    u32 z17 = t41 & y8;
+
+    // Bottom linear transformation.
+    u32 t46 = z15 ^ z16;
+    u32 t47 = z10 ^ z11;
+    u32 t48 = z5 ^ z13;
+    u32 t49 = z9 ^ z10;
+    u32 t50 = z2 ^ z12;
+    u32 t51 = z2 ^ z5;
+    u32 t52 = z7 ^ z8;
+    u32 t53 = z0 ^ z3;
+    u32 t54 = z6 ^ z7;
+    u32 t55 = z16 ^ z17;
+    u32 t56 = z12 ^ t48;
+    u32 t57 = t50 ^ t53;
+    u32 t58 = z4 ^ t46;
+    u32 t59 = z3 ^ t54;
+    u32 t60 = t46 ^ t57;
+    u32 t61 = z14 ^ t57;
+    u32 t62 = t52 ^ t58;
+    u32 t63 = t49 ^ t58;
+    u32 t64 = z4 ^ t59;
+    u32 t65 = t61 ^ t62;
+    u32 t66 = z1 ^ t63;
+    u32 s0 = t59 ^ t63;
+    u32 s6 = t56 ^ ~t62;
+    u32 s7 = t48 ^ ~t60;
+    u32 t67 = t64 ^ t65;
+    u32 s3 = t53 ^ t66;
+    u32 s4 = t51 ^ t66;
+    u32 s5 = t47 ^ t65;
+    u32 s1 = t64 ^ ~s3;
+    u32 s2 = t55 ^ ~t67;
+
+    q[7] = s0;
+    q[6] = s1;
+    q[5] = s2;
+    q[4] = s3;
+    q[3] = s4;
+    q[2] = s5;
+    q[1] = s6;
+    q[0] = s7;
+}
+
+// The inverse of the affine transform in the S-box (including its constant), which it applies
+// on both sides of the forward S-box to get the inverse one: InvS(x) = B(S(B(x))).
+static void inverse_affine_transform(u32* q)
+{
+    u32 q0 = ~q[0];
+    u32 q1 = ~q[1];
+    u32 q2 = q[2];
+    u32 q3 = q[3];
+    u32 q4 = q[4];
+    u32 q5 = ~q[5];
+    u32 q6 = ~q[6];
+    u32 q7 = q[7];
+    q[7] = q1 ^ q4 ^ q6;
+    q[6] = q0 ^ q3 ^ q5;
+    q[5] = q7 ^ q2 ^ q4;
+    q[4] = q6 ^ q1 ^ q3;
+    q[3] = q5 ^ q0 ^ q2;
+    q[2] = q4 ^ q7 ^ q1;
+    q[1] = q3 ^ q6 ^ q0;
+    q[0] = q2 ^ q5 ^ q7;
+}
+
+static void inverse_sub_bytes(u32* q)
+{
+    inverse_affine_transform(q);
+    sub_bytes(q);
+    inverse_affine_transform(q);
+}
+
+static void shift_rows(u32* q)
+{
+    for (size_t i = 0; i < 8; ++i) {
+        u32 x = q[i];
+        // clang-format off
+        q[i] = (x & 0x000000ff)
+            | ((x & 0x0000fc00) >> 2) | ((x & 0x00000300) << 6)
+            | ((x & 0x00f00000) >> 4) | ((x & 0x000f0000) << 4)
+            | ((x & 0xc0000000) >> 6) | ((x & 0x3f000000) << 2);
+        // clang-format on
+    }
+}
+
+static void inverse_shift_rows(u32* q)
+{
+    for (size_t i = 0; i < 8; ++i) {
+        u32 x = q[i];
+        // clang-format off
+        q[i] = (x & 0x000000ff)
+            | ((x & 0x00003f00) << 2) | ((x & 0x0000c000) >> 6)
+            | ((x & 0x000f0000) << 4) | ((x & 0x00f00000) >> 4)
+            | ((x & 0x03000000) << 6) | ((x & 0xfc000000) >> 2);
+        // clang-format on
+    }
+}
+
+static inline u32 rotate_right(u32 x, unsigned shift)
+{
+    return (x >> shift) | (x << (32 - shift));
+}
+
+static void mix_columns(u32* q)
+{
+    u32 q0 = q[0], q1 = q[1], q2 = q[2], q3 = q[3], q4 = q[4], q5 = q[5], q6 = q[6], q7 = q[7];
+    u32 r0 = rotate_right(q0, 8), r1 = rotate_right(q1, 8), r2 = rotate_right(q2, 8), r3 = rotate_right(q3, 8);
+    u32 r4 = rotate_right(q4, 8), r5 = rotate_right(q5, 8), r6 = rotate_right(q6, 8), r7 = rotate_right(q7, 8);
+
+    q[0] = q7 ^ r7 ^ r0 ^ rotate_right(q0 ^ r0, 16);
+    q[1] = q0 ^ r0 ^ q7 ^ r7 ^ r1 ^ rotate_right(q1 ^ r1, 16);
+    q[2] = q1 ^ r1 ^ r2 ^ rotate_right(q2 ^ r2, 16);
+    q[3] = q2 ^ r2 ^ q7 ^ r7 ^ r3 ^ rotate_right(q3 ^ r3, 16);
+    q[4] = q3 ^ r3 ^ q7 ^ r7 ^ r4 ^ rotate_right(q4 ^ r4, 16);
+    q[5] = q4 ^ r4 ^ r5 ^ rotate_right(q5 ^ r5, 16);
+    q[6] = q5 ^ r5 ^ r6 ^ rotate_right(q6 ^ r6, 16);
+    q[7] = q6 ^ r6 ^ r7 ^ rotate_right(q7 ^ r7, 16);
+}
+
+static void inverse_mix_columns(u32* q)
+{
+    u32 q0 = q[0], q1 = q[1], q2 = q[2], q3 = q[3], q4 = q[4], q5 = q[5], q6 = q[6], q7 = q[7];
+    u32 r0 = rotate_right(q0, 8), r1 = rotate_right(q1, 8), r2 = rotate_right(q2, 8), r3 = rotate_right(q3, 8);
+    u32 r4 = rotate_right(q4, 8), r5 = rotate_right(q5, 8), r6 = rotate_right(q6, 8), r7 = rotate_right(q7, 8);
+
+    q[0] = q5 ^ q6 ^ q7 ^ r0 ^ r5 ^ r7 ^ rotate_right(q0 ^ q5 ^ q6 ^ r0 ^ r5, 16);
+    q[1] = q0 ^ q5 ^ r0 ^ r1 ^ r5 ^ r6 ^ r7 ^ rotate_right(q1 ^ q5 ^ q7 ^ r1 ^ r5 ^ r6, 16);
+    q[2] = q0 ^ q1 ^ q6 ^ r1 ^ r2 ^ r6 ^ r7 ^ rotate_right(q0 ^ q2 ^ q6 ^ r2 ^ r6 ^ r7, 16);
+    q[3] = q0 ^ q1 ^ q2 ^ q5 ^ q6 ^ r0 ^ r2 ^ r3 ^ r5 ^ rotate_right(q0 ^ q1 ^ q3 ^ q5 ^ q6 ^ q7 ^ r0 ^ r3 ^ r5 ^ r7, 16);
+    q[4] = q1 ^ q2 ^ q3 ^ q5 ^ r1 ^ r3 ^ r4 ^ r5 ^ r6 ^ r7 ^ rotate_right(q1 ^ q2 ^ q4 ^ q5 ^ q7 ^ r1 ^ r4 ^ r5 ^ r6, 16);
+    q[5] = q2 ^ q3 ^ q4 ^ q6 ^ r2 ^ r4 ^ r5 ^ r6 ^ r7 ^ rotate_right(q2 ^ q3 ^ q5 ^ q6 ^ r2 ^ r5 ^ r6 ^ r7, 16);
+    q[6] = q3 ^ q4 ^ q5 ^ q7 ^ r3 ^ r5 ^ r6 ^ r7 ^ rotate_right(q3 ^ q4 ^ q6 ^ q7 ^ r3 ^ r6 ^ r7, 16);
+    q[7] = q4 ^ q5 ^ q6 ^ r4 ^ r6 ^ r7 ^ rotate_right(q4 ^ q5 ^ q7 ^ r4 ^ r7, 16);
+}
+
+static inline void add_round_key(u32* q, const u32* round_key)
+{
+    for (size_t i = 0; i < 8; ++i)
+        q[i] ^= round_key[i];
+}
+
+// Puts one or two blocks into bitsliced form. A missing second block is left as zeros.
+static void load_blocks(u32* q, const u8* first, const u8* second)
+{
+    for (size_t i = 0; i < 4; ++i) {
+        q[i * 2] = load_le32(first + i * 4);
+        q[i * 2 + 1] = second ? load_le32(second + i * 4) : 0;
+    }
+    orthogonalize(q);
+}
+
+static void store_blocks(u32* q, u8* first, u8* second)
+{
+    orthogonalize(q);
+    for (size_t i = 0; i < 4; ++i) {
+        store_le32(first + i * 4, q[i * 2]);
+        if (second)
+            store_le32(second + i * 4, q[i * 2 + 1]);
+    }
+}
+
+static void encrypt(u32* q, const u32* round_keys, size_t rounds)
+{
+    add_round_key(q, round_keys);
+    for (size_t round = 1; round < rounds; ++round) {
+        sub_bytes(q);
+        shift_rows(q);
+        mix_columns(q);
+        add_round_key(q, round_keys + round * 8);
+    }
+    sub_bytes(q);
+    shift_rows(q);
+    add_round_key(q, round_keys + rounds * 8);
+}
+
+// Uses the round keys of the equivalent inverse cipher, see AESCipherKey::expand_decrypt_key().
+static void decrypt(u32* q, const u32* round_keys, size_t rounds)
+{
+    add_round_key(q, round_keys);
+    for (size_t round = 1; round < rounds; ++round) {
+        inverse_shift_rows(q);
+        inverse_sub_bytes(q);
+        inverse_mix_columns(q);
+        add_round_key(q, round_keys + round * 8);
+    }
+    inverse_shift_rows(q);
+    inverse_sub_bytes(q);
+    add_round_key(q, round_keys + rounds * 8);
+}
+
+static u32 sub_word(u32 word)
+{
+    u32 q[8];
+    for (size_t i = 0; i < 8; ++i)
+        q[i] = word;
+    orthogonalize(q);
+    sub_bytes(q);
+    orthogonalize(q);
+    return q[0];
+}
+
+}
+
+#if (ARCH(I386) || ARCH(X86_64)) && !defined(KERNEL)
+[[gnu::target("aes,sse2")]] static u32 sub_word_aes_ni(u32 word)
+{
+    // The low word of the result is SubWord() of the second word of the input.
+    return _mm_cvtsi128_si32(_mm_aeskeygenassist_si128(_mm_set_epi32(0, 0, (int)word, 0), 0));
+}
+
+// Blocks are independent in these, so up to eight of them go through the rounds side by side
+// to keep the AES unit busy.
+[[gnu::target("aes,sse2")]] static void encrypt_blocks_aes_ni(const u8* round_key_bytes, size_t rounds, const u8* in, u8* out, size_t block_count)
+{
+    __m128i keys[15];
+    for (size_t i = 0; i <= rounds; ++i)
+        keys[i] = _mm_loadu_si128((const __m128i*)(round_key_bytes + i * 16));
+
+    constexpr size_t lane_count = 8;
+    while (block_count >= lane_count) {
+        __m128i x[lane_count];
+        for (size_t lane = 0; lane < lane_count; ++lane)
+            x[lane] = _mm_xor_si128(_mm_loadu_si128((const __m128i*)(in + lane * 16)), keys[0]);
+        for (size_t round = 1; round < rounds; ++round) {
+            for (size_t lane = 0; lane < lane_count; ++lane)
+                x[lane] = _mm_aesenc_si128(x[lane], keys[round]);
+        }
+        for (size_t lane = 0; lane < lane_count; ++lane)
+            _mm_storeu_si128((__m128i*)(out + lane * 16), _mm_aesenclast_si128(x[lane], keys[rounds]));
+        in += lane_count * 16;
+        out += lane_count * 16;
+        block_count -= lane_count;
+    }
+
+    for (; block_count > 0; --block_count) {
+        __m128i x = _mm_xor_si128(_mm_loadu_si128((const __m128i*)in), keys[0]);
+        for (size_t round = 1; round < rounds; ++round)
+            x = _mm_aesenc_si128(x, keys[round]);
+        _mm_storeu_si128((__m128i*)out, _mm_aesenclast_si128(x, keys[rounds]));
+        in += 16;
+        out += 16;
+    }
+}
+
+[[gnu::target("aes,sse2")]] static void decrypt_blocks_aes_ni(const u8* round_key_bytes, size_t rounds, const u8* in, u8* out, size_t block_count)
+{
+    __m128i keys[15];
+    for (size_t i = 0; i <= rounds; ++i)
+        keys[i] = _mm_loadu_si128((const __m128i*)(round_key_bytes + i * 16));
+
+    constexpr size_t lane_count = 8;
+    while (block_count >= lane_count) {
+        __m128i x[lane_count];
+        for (size_t lane = 0; lane < lane_count; ++lane)
+            x[lane] = _mm_xor_si128(_mm_loadu_si128((const __m128i*)(in + lane * 16)), keys[0]);
+        for (size_t round = 1; round < rounds; ++round) {
+            for (size_t lane = 0; lane < lane_count; ++lane)
+                x[lane] = _mm_aesdec_si128(x[lane], keys[round]);
+        }
+        for (size_t lane = 0; lane < lane_count; ++lane)
+            _mm_storeu_si128((__m128i*)(out + lane * 16), _mm_aesdeclast_si128(x[lane], keys[rounds]));
+        in += lane_count * 16;
+        out += lane_count * 16;
+        block_count -= lane_count;
+    }
+
+    for (; block_count > 0; --block_count) {
+        __m128i x = _mm_xor_si128(_mm_loadu_si128((const __m128i*)in), keys[0]);
+        for (size_t round = 1; round < rounds; ++round)
+            x = _mm_aesdec_si128(x, keys[round]);
+        _mm_storeu_si128((__m128i*)out, _mm_aesdeclast_si128(x, keys[rounds]));
+        in += 16;
+        out += 16;
+    }
+}
+#endif
+
+static u32 sub_word(u32 word)
+{
+#if (ARCH(I386) || ARCH(X86_64)) && !defined(KERNEL)
+    if (has_aes_ni())
+        return sub_word_aes_ni(word);
+#endif
+    return Bitsliced::sub_word(word);
+}
+
+static constexpr u32 rotate_left(u32 word, unsigned shift)
+{
+    return (word << shift) | (word >> (32 - shift));
+}
+
+// InvMixColumns() of a single column, with the bytes multiplied in GF(2^8) by shifts and
+// masks rather than through lookup tables.
+static u32 inverse_mix_column(u32 column)
+{
+    auto times_two = [](u32 x) {
+        return ((x & 0x7f7f7f7f) << 1) ^ (((x >> 7) & 0x01010101) * 0x1b);
+    };
+    u32 x2 = times_two(column);
+    u32 x4 = times_two(x2);
+    u32 x8 = times_two(x4);
+    u32 x9 = x8 ^ column;
+    u32 x11 = x9 ^ x2;
+    u32 x13 = x9 ^ x4;
+    u32 x14 = x8 ^ x4 ^ x2;
+    return x14 ^ rotate_left(x11, 8) ^ rotate_left(x13, 16) ^ rotate_left(x9, 24);
+}
+
 String AESCipherBlock::to_string() const
 {
     StringBuilder builder;
@@ -59,7 +549,7 @@ String AESCipherKey::to_string() const
     return builder.build();
 }
 
-void AESCipherKey::expand_encrypt_key(const ByteBuffer& user_key, size_t bits)
+void AESCipherKey::expand_round_keys(const ByteBuffer& user_key, size_t bits)
 {
     u32* round_key;
     u32 temp;
@@ -86,13 +576,7 @@ void AESCipherKey::expand_encrypt_key(const ByteBuffer& user_key, size_t bits)
     if (bits == 128) {
         for (;;) {
             temp = round_key[3];
-            // clang-format off
-            round_key[4] = round_key[0] ^
-                    (AESTables::Encode2[(temp >> 16) & 0xff] & 0xff000000) ^
-                    (AESTables::Encode3[(temp >>  8) & 0xff] & 0x00ff0000) ^
-                    (AESTables::Encode0[(temp      ) & 0xff] & 0x0000ff00) ^
-                    (AESTables::Encode1[(temp >> 24)       ] & 0x000000ff) ^ AESTables::RCON[i];
-            // clang-format on
+            round_key[4] = round_key[0] ^ sub_word(rotate_left(temp, 8)) ^ RCON[i];
             round_key[5] = round_key[1] ^ round_key[4];
             round_key[6] = round_key[2] ^ round_key[5];
             round_key[7] = round_key[3] ^ round_key[6];
@@ -109,13 +593,7 @@ void AESCipherKey::expand_encrypt_key(const ByteBuffer& user_key, size_t bits)
     if (bits == 192) {
         for (;;) {
             temp = round_key[5];
-            // clang-format off
-            round_key[6] = round_key[0] ^
-                    (AESTables::Encode2[(temp >> 16) & 0xff] & 0xff000000) ^
-                    (AESTables::Encode3[(temp >>  8) & 0xff] & 0x00ff0000) ^
-                    (AESTables::Encode0[(temp      ) & 0xff] & 0x0000ff00) ^
-                    (AESTables::Encode1[(temp >> 24)       ] & 0x000000ff) ^ AESTables::RCON[i];
-            // clang-format on
+            round_key[6] = round_key[0] ^ sub_word(rotate_left(temp, 8)) ^ RCON[i];
             round_key[7] = round_key[1] ^ round_key[6];
             round_key[8] = round_key[2] ^ round_key[7];
             round_key[9] = round_key[3] ^ round_key[8];
@@ -137,13 +615,7 @@ void AESCipherKey::expand_encrypt_key(const ByteBuffer& user_key, size_t bits)
     if (true) { // bits == 256
         for (;;) {
             temp = round_key[7];
-            // clang-format off
-            round_key[8] = round_key[0] ^
-                    (AESTables::Encode2[(temp >> 16) & 0xff] & 0xff000000) ^
-                    (AESTables::Encode3[(temp >>  8) & 0xff] & 0x00ff0000) ^
-                    (AESTables::Encode0[(temp      ) & 0xff] & 0x0000ff00) ^
-                    (AESTables::Encode1[(temp >> 24)       ] & 0x000000ff) ^ AESTables::RCON[i];
-            // clang-format on
+            round_key[8] = round_key[0] ^ sub_word(rotate_left(temp, 8)) ^ RCON[i];
             round_key[9] = round_key[1] ^ round_key[8];
             round_key[10] = round_key[2] ^ round_key[9];
             round_key[11] = round_key[3] ^ round_key[10];
@@ -153,13 +625,7 @@ void AESCipherKey::expand_encrypt_key(const ByteBuffer& user_key, size_t bits)
                 break;
 
             temp = round_key[11];
-            // clang-format off
-            round_key[12] = round_key[4] ^
-                    (AESTables::Encode2[(temp >> 24)       ] & 0xff000000) ^
-                    (AESTables::Encode3[(temp >> 16) & 0xff] & 0x00ff0000) ^
-                    (AESTables::Encode0[(temp >>  8) & 0xff] & 0x0000ff00) ^
-                    (AESTables::Encode1[(temp      ) & 0xff] & 0x000000ff) ;
-            // clang-format on
+            round_key[12] = round_key[4] ^ sub_word(temp);
             round_key[13] = round_key[5] ^ round_key[12];
             round_key[14] = round_key[6] ^ round_key[13];
             round_key[15] = round_key[7] ^ round_key[14];
@@ -170,11 +636,17 @@ void AESCipherKey::expand_encrypt_key(const ByteBuffer& user_key, size_t bits)
     }
 }
 
+void AESCipherKey::expand_encrypt_key(const ByteBuffer& user_key, size_t bits)
+{
+    expand_round_keys(user_key, bits);
+    update_round_key_layouts();
+}
+
 void AESCipherKey::expand_decrypt_key(const ByteBuffer& user_key, size_t bits)
 {
     u32* round_key;
 
-    expand_encrypt_key(user_key, bits);
+    expand_round_keys(user_key, bits);
 
     round_key = round_keys();
 
@@ -187,213 +659,83 @@ void AESCipherKey::expand_decrypt_key(const ByteBuffer& user_key, size_t bits)
     }
 
     // apply inverse mix-column to middle rounds
-    for (size_t i = 1; i < rounds(); ++i) {
-        round_key += 4;
-        // clang-format off
-        round_key[0] =
-                AESTables::Decode0[AESTables::Encode1[(round_key[0] >> 24)       ] & 0xff] ^
-                AESTables::Decode1[AESTables::Encode1[(round_key[0] >> 16) & 0xff] & 0xff] ^
-                AESTables::Decode2[AESTables::Encode1[(round_key[0] >>  8) & 0xff] & 0xff] ^
-                AESTables::Decode3[AESTables::Encode1[(round_key[0]      ) & 0xff] & 0xff] ;
-        round_key[1] =
-                AESTables::Decode0[AESTables::Encode1[(round_key[1] >> 24)       ] & 0xff] ^
-                AESTables::Decode1[AESTables::Encode1[(round_key[1] >> 16) & 0xff] & 0xff] ^
-                AESTables::Decode2[AESTables::Encode1[(round_key[1] >>  8) & 0xff] & 0xff] ^
-                AESTables::Decode3[AESTables::Encode1[(round_key[1]      ) & 0xff] & 0xff] ;
-        round_key[2] =
-                AESTables::Decode0[AESTables::Encode1[(round_key[2] >> 24)       ] & 0xff] ^
-                AESTables::Decode1[AESTables::Encode1[(round_key[2] >> 16) & 0xff] & 0xff] ^
-                AESTables::Decode2[AESTables::Encode1[(round_key[2] >>  8) & 0xff] & 0xff] ^
-                AESTables::Decode3[AESTables::Encode1[(round_key[2]      ) & 0xff] & 0xff] ;
-        round_key[3] =
-                AESTables::Decode0[AESTables::Encode1[(round_key[3] >> 24)       ] & 0xff] ^
-                AESTables::Decode1[AESTables::Encode1[(round_key[3] >> 16) & 0xff] & 0xff] ^
-                AESTables::Decode2[AESTables::Encode1[(round_key[3] >>  8) & 0xff] & 0xff] ^
-                AESTables::Decode3[AESTables::Encode1[(round_key[3]      ) & 0xff] & 0xff] ;
-        // clang-format on
-    }
+    for (size_t i = 4; i < 4 * rounds(); ++i)
+        round_key[i] = inverse_mix_column(round_key[i]);
+
+    update_round_key_layouts();
 }
 
-void AESCipher::encrypt_block(const AESCipherBlock& in, AESCipherBlock& out)
+void AESCipherKey::update_round_key_layouts()
 {
-    u32 s0, s1, s2, s3, t0, t1, t2, t3;
-    size_t r { 0 };
-
-    const auto& dec_key = key();
-    const auto* round_keys = dec_key.round_keys();
-
-    s0 = get_key(in.data().offset_pointer(0)) ^ round_keys[0];
-    s1 = get_key(in.data().offset_pointer(4)) ^ round_keys[1];
-    s2 = get_key(in.data().offset_pointer(8)) ^ round_keys[2];
-    s3 = get_key(in.data().offset_pointer(12)) ^ round_keys[3];
-
-    r = dec_key.rounds() >> 1;
-
-    // apply the first |r - 1| rounds
-    auto i { 0 };
-    for (;;) {
-        ++i;
-        // clang-format off
-        t0 = AESTables::Encode0[(s0 >> 24)       ] ^
-             AESTables::Encode1[(s1 >> 16) & 0xff] ^
-             AESTables::Encode2[(s2 >>  8) & 0xff] ^
-             AESTables::Encode3[(s3      ) & 0xff] ^ round_keys[4];
-        t1 = AESTables::Encode0[(s1 >> 24)       ] ^
-             AESTables::Encode1[(s2 >> 16) & 0xff] ^
-             AESTables::Encode2[(s3 >>  8) & 0xff] ^
-             AESTables::Encode3[(s0      ) & 0xff] ^ round_keys[5];
-        t2 = AESTables::Encode0[(s2 >> 24)       ] ^
-             AESTables::Encode1[(s3 >> 16) & 0xff] ^
-             AESTables::Encode2[(s0 >>  8) & 0xff] ^
-             AESTables::Encode3[(s1      ) & 0xff] ^ round_keys[6];
-        t3 = AESTables::Encode0[(s3 >> 24)       ] ^
-             AESTables::Encode1[(s0 >> 16) & 0xff] ^
-             AESTables::Encode2[(s1 >>  8) & 0xff] ^
-             AESTables::Encode3[(s2      ) & 0xff] ^ round_keys[7];
-        // clang-format on
-
-        round_keys += 8;
-        --r;
-        ++i;
-        if (r == 0)
-            break;
+    for (size_t i = 0; i < (rounds() + 1) * 4; ++i) {
+        u32 word = m_rd_keys[i];
+        m_rd_key_bytes[i * 4] = (u8)(word >> 24);
+        m_rd_key_bytes[i * 4 + 1] = (u8)(word >> 16);
+        m_rd_key_bytes[i * 4 + 2] = (u8)(word >> 8);
+        m_rd_key_bytes[i * 4 + 3] = (u8)word;
+    }
 
-        // clang-format off
-        s0 = AESTables::Encode0[(t0 >> 24)       ] ^
-             AESTables::Encode1[(t1 >> 16) & 0xff] ^
-             AESTables::Encode2[(t2 >>  8) & 0xff] ^
-             AESTables::Encode3[(t3      ) & 0xff] ^ round_keys[0];
-        s1 = AESTables::Encode0[(t1 >> 24)       ] ^
-             AESTables::Encode1[(t2 >> 16) & 0xff] ^
-             AESTables::Encode2[(t3 >>  8) & 0xff] ^
-             AESTables::Encode3[(t0      ) & 0xff] ^ round_keys[1];
-        s2 = AESTables::Encode0[(t2 >> 24)       ] ^
-             AESTables::Encode1[(t3 >> 16) & 0xff] ^
-             AESTables::Encode2[(t0 >>  8) & 0xff] ^
-             AESTables::Encode3[(t1      ) & 0xff] ^ round_keys[2];
-        s3 = AESTables::Encode0[(t3 >> 24)       ] ^
-             AESTables::Encode1[(t0 >> 16) & 0xff] ^
-             AESTables::Encode2[(t1 >>  8) & 0xff] ^
-             AESTables::Encode3[(t2      ) & 0xff] ^ round_keys[3];
-        // clang-format on
+    // Both bitsliced lanes get the same round key.
+    for (size_t round = 0; round <= rounds(); ++round) {
+        const u8* key = m_rd_key_bytes + round * 16;
+        Bitsliced::load_blocks(m_bitsliced_rd_keys + round * 8, key, key);
     }
+}
 
-    // apply the last round and put the encrypted data into out
-    // clang-format off
-    s0 = (AESTables::Encode2[(t0 >> 24)       ] & 0xff000000) ^
-         (AESTables::Encode3[(t1 >> 16) & 0xff] & 0x00ff0000) ^
-         (AESTables::Encode0[(t2 >>  8) & 0xff] & 0x0000ff00) ^
-         (AESTables::Encode1[(t3      ) & 0xff] & 0x000000ff) ^ round_keys[0];
-    out.put(0, s0);
-
-    s1 = (AESTables::Encode2[(t1 >> 24)       ] & 0xff000000) ^
-         (AESTables::Encode3[(t2 >> 16) & 0xff] & 0x00ff0000) ^
-         (AESTables::Encode0[(t3 >>  8) & 0xff] & 0x0000ff00) ^
-         (AESTables::Encode1[(t0      ) & 0xff] & 0x000000ff) ^ round_keys[1];
-    out.put(4, s1);
-
-    s2 = (AESTables::Encode2[(t2 >> 24)       ] & 0xff000000) ^
-         (AESTables::Encode3[(t3 >> 16) & 0xff] & 0x00ff0000) ^
-         (AESTables::Encode0[(t0 >>  8) & 0xff] & 0x0000ff00) ^
-         (AESTables::Encode1[(t1      ) & 0xff] & 0x000000ff) ^ round_keys[2];
-    out.put(8, s2);
-
-    s3 = (AESTables::Encode2[(t3 >> 24)       ] & 0xff000000) ^
-         (AESTables::Encode3[(t0 >> 16) & 0xff] & 0x00ff0000) ^
-         (AESTables::Encode0[(t1 >>  8) & 0xff] & 0x0000ff00) ^
-         (AESTables::Encode1[(t2      ) & 0xff] & 0x000000ff) ^ round_keys[3];
-    out.put(12, s3);
-    // clang-format on
+void AESCipher::encrypt_block(const AESCipherBlock& in, AESCipherBlock& out)
+{
+    u8 data[BlockSizeInBits / 8];
+    encrypt_blocks(in.data().data(), data, 1);
+    out.overwrite(data, sizeof(data));
 }
 
 void AESCipher::decrypt_block(const AESCipherBlock& in, AESCipherBlock& out)
 {
+    u8 data[BlockSizeInBits / 8];
+    decrypt_blocks(in.data().data(), data, 1);
+    out.overwrite(data, sizeof(data));
+}
 
-    u32 s0, s1, s2, s3, t0, t1, t2, t3;
-    size_t r { 0 };
-
-    const auto& dec_key = key();
-    const auto* round_keys = dec_key.round_keys();
-
-    s0 = get_key(in.data().offset_pointer(0)) ^ round_keys[0];
-    s1 = get_key(in.data().offset_pointer(4)) ^ round_keys[1];
-    s2 = get_key(in.data().offset_pointer(8)) ^ round_keys[2];
-    s3 = get_key(in.data().offset_pointer(12)) ^ round_keys[3];
-
-    r = dec_key.rounds() >> 1;
-
-    // apply the first |r - 1| rounds
-    for (;;) {
-        // clang-format off
-        t0 = AESTables::Decode0[(s0 >> 24)       ] ^
-             AESTables::Decode1[(s3 >> 16) & 0xff] ^
-             AESTables::Decode2[(s2 >>  8) & 0xff] ^
-             AESTables::Decode3[(s1      ) & 0xff] ^ round_keys[4];
-        t1 = AESTables::Decode0[(s1 >> 24)       ] ^
-             AESTables::Decode1[(s0 >> 16) & 0xff] ^
-             AESTables::Decode2[(s3 >>  8) & 0xff] ^
-             AESTables::Decode3[(s2      ) & 0xff] ^ round_keys[5];
-        t2 = AESTables::Decode0[(s2 >> 24)       ] ^
-             AESTables::Decode1[(s1 >> 16) & 0xff] ^
-             AESTables::Decode2[(s0 >>  8) & 0xff] ^
-             AESTables::Decode3[(s3      ) & 0xff] ^ round_keys[6];
-        t3 = AESTables::Decode0[(s3 >> 24)       ] ^
-             AESTables::Decode1[(s2 >> 16) & 0xff] ^
-             AESTables::Decode2[(s1 >>  8) & 0xff] ^
-             AESTables::Decode3[(s0      ) & 0xff] ^ round_keys[7];
-        // clang-format on
-
-        round_keys += 8;
-        --r;
-        if (r == 0)
-            break;
-
-        // clang-format off
-        s0 = AESTables::Decode0[(t0 >> 24)       ] ^
-             AESTables::Decode1[(t3 >> 16) & 0xff] ^
-             AESTables::Decode2[(t2 >>  8) & 0xff] ^
-             AESTables::Decode3[(t1      ) & 0xff] ^ round_keys[0];
-        s1 = AESTables::Decode0[(t1 >> 24)       ] ^
-             AESTables::Decode1[(t0 >> 16) & 0xff] ^
-             AESTables::Decode2[(t3 >>  8) & 0xff] ^
-             AESTables::Decode3[(t2      ) & 0xff] ^ round_keys[1];
-        s2 = AESTables::Decode0[(t2 >> 24)       ] ^
-             AESTables::Decode1[(t1 >> 16) & 0xff] ^
-             AESTables::Decode2[(t0 >>  8) & 0xff] ^
-             AESTables::Decode3[(t3      ) & 0xff] ^ round_keys[2];
-        s3 = AESTables::Decode0[(t3 >> 24)       ] ^
-             AESTables::Decode1[(t2 >> 16) & 0xff] ^
-             AESTables::Decode2[(t1 >>  8) & 0xff] ^
-             AESTables::Decode3[(t0      ) & 0xff] ^ round_keys[3];
-        // clang-format on
+void AESCipher::encrypt_blocks(const u8* in, u8* out, size_t block_count)
+{
+#if (ARCH(I386) || ARCH(X86_64)) && !defined(KERNEL)
+    if (has_aes_ni())
+        return encrypt_blocks_aes_ni(m_key.round_key_bytes(), m_key.rounds(), in, out, block_count);
+#endif
+    u32 q[8];
+    for (; block_count >= 2; block_count -= 2) {
+        Bitsliced::load_blocks(q, in, in + 16);
+        Bitsliced::encrypt(q, m_key.bitsliced_round_keys(), m_key.rounds());
+        Bitsliced::store_blocks(q, out, out + 16);
+        in += 32;
+        out += 32;
+    }
+    if (block_count > 0) {
+        Bitsliced::load_blocks(q, in, nullptr);
+        Bitsliced::encrypt(q, m_key.bitsliced_round_keys(), m_key.rounds());
+        Bitsliced::store_blocks(q, out, nullptr);
     }
+}
 
-    // apply the last round and put the decrypted data into out
-    // clang-format off
-    s0 = ((u32)AESTables::Decode4[(t0 >> 24)       ] << 24) ^
-         ((u32)AESTables::Decode4[(t3 >> 16) & 0xff] << 16) ^
-         ((u32)AESTables::Decode4[(t2 >>  8) & 0xff] <<  8) ^
-         ((u32)AESTables::Decode4[(t1      ) & 0xff]      ) ^ round_keys[0];
-    out.put(0, s0);
-
-    s1 = ((u32)AESTables::Decode4[(t1 >> 24)       ] << 24) ^
-         ((u32)AESTables::Decode4[(t0 >> 16) & 0xff] << 16) ^
-         ((u32)AESTables::Decode4[(t3 >>  8) & 0xff] <<  8) ^
-         ((u32)AESTables::Decode4[(t2      ) & 0xff]      ) ^ round_keys[1];
-    out.put(4, s1);
-
-    s2 = ((u32)AESTables::Decode4[(t2 >> 24)       ] << 24) ^
-         ((u32)AESTables::Decode4[(t1 >> 16) & 0xff] << 16) ^
-         ((u32)AESTables::Decode4[(t0 >>  8) & 0xff] <<  8) ^
-         ((u32)AESTables::Decode4[(t3      ) & 0xff]      ) ^ round_keys[2];
-    out.put(8, s2);
-
-    s3 = ((u32)AESTables::Decode4[(t3 >> 24)       ] << 24) ^
-         ((u32)AESTables::Decode4[(t2 >> 16) & 0xff] << 16) ^
-         ((u32)AESTables::Decode4[(t1 >>  8) & 0xff] <<  8) ^
-         ((u32)AESTables::Decode4[(t0      ) & 0xff]      ) ^ round_keys[3];
-    out.put(12, s3);
-    // clang-format on
+void AESCipher::decrypt_blocks(const u8* in, u8* out, size_t block_count)
+{
+#if (ARCH(I386) || ARCH(X86_64)) && !defined(KERNEL)
+    if (has_aes_ni())
+        return decrypt_blocks_aes_ni(m_key.round_key_bytes(), m_key.rounds(), in, out, block_count);
+#endif
+    u32 q[8];
+    for (; block_count >= 2; block_count -= 2) {
+        Bitsliced::load_blocks(q, in, in + 16);
+        Bitsliced::decrypt(q, m_key.bitsliced_round_keys(), m_key.rounds());
+        Bitsliced::store_blocks(q, out, out + 16);
+        in += 32;
+        out += 32;
+    }
+    if (block_count > 0) {
+        Bitsliced::load_blocks(q, in, nullptr);
+        Bitsliced::decrypt(q, m_key.bitsliced_round_keys(), m_key.rounds());
+        Bitsliced::store_blocks(q, out, nullptr);
+    }
 }
 
 void AESCipherBlock::overwrite(const ReadonlyBytes& span)
@@ -132,6 +132,28 @@ public:
     virtual void encrypt_block(const BlockType& in, BlockType& out) = 0;
     virtual void decrypt_block(const BlockType& in, BlockType& out) = 0;
 
+    // Encrypts (or decrypts) block_count whole blocks. Ciphers can override these to work on
+    // several independent blocks at the same time. in and out may be the same buffer.
+    virtual void encrypt_blocks(const u8* in, u8* out, size_t block_count)
+    {
+        BlockType block { m_padding_mode };
+        for (size_t i = 0; i < block_count; ++i) {
+            block.overwrite(in + i * block_size(), block_size());
+            encrypt_block(block, block);
+            __builtin_memcpy(out + i * block_size(), static_cast<const BlockType&>(block).data().data(), block_size());
+        }
+    }
+
+    virtual void decrypt_blocks(const u8* in, u8* out, size_t block_count)
+    {
+        BlockType block { m_padding_mode };
+        for (size_t i = 0; i < block_count; ++i) {
+            block.overwrite(in + i * block_size(), block_size());
+            decrypt_block(block, block);
+            __builtin_memcpy(out + i * block_size(), static_cast<const BlockType&>(block).data().data(), block_size());
+        }
+    }
+
     virtual String class_name() const = 0;
 
 private:
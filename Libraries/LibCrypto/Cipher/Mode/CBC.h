@@ -73,12 +73,14 @@ public:
         size_t offset { 0 };
         auto block_size = cipher.block_size();
 
+        u8 block[T::BlockType::BlockSizeInBits / 8];
+        ASSERT(block_size == sizeof(block));
+
         while (length >= block_size) {
-            m_cipher_block.overwrite(in.slice(offset, block_size));
-            m_cipher_block.apply_initialization_vector(iv);
-            cipher.encrypt_block(m_cipher_block, m_cipher_block);
+            for (size_t i = 0; i < block_size; ++i)
+                block[i] = in[offset + i] ^ iv[i];
             ASSERT(offset + block_size <= out.size());
-            __builtin_memcpy(out.offset(offset), m_cipher_block.get().data(), block_size);
+            cipher.encrypt_blocks(block, out.offset(offset), 1);
             iv = out.offset(offset);
             length -= block_size;
             offset += block_size;
@@ -114,20 +116,31 @@ public:
         // FIXME (ponder): Should we simply decrypt as much as we can?
         ASSERT(length % block_size == 0);
 
-        m_cipher_block.set_padding_mode(cipher.padding_mode());
+        // Unlike encryption, decryption doesn't depend on the previous block's result,
+        // so the blocks are decrypted a batch at a time.
+        constexpr size_t batch_block_count = 8;
+        u8 decrypted[batch_block_count * T::BlockType::BlockSizeInBits / 8];
+        u8 previous_block[T::BlockType::BlockSizeInBits / 8];
+        ASSERT(block_size == sizeof(previous_block));
+        __builtin_memcpy(previous_block, iv, block_size);
+
         size_t offset { 0 };
 
         while (length > 0) {
-            auto* slice = in.offset(offset);
-            m_cipher_block.overwrite(slice, block_size);
-            cipher.decrypt_block(m_cipher_block, m_cipher_block);
-            m_cipher_block.apply_initialization_vector(iv);
-            auto decrypted = m_cipher_block.get();
-            ASSERT(offset + decrypted.size() <= out.size());
-            __builtin_memcpy(out.offset(offset), decrypted.data(), decrypted.size());
-            iv = slice;
-            length -= block_size;
-            offset += block_size;
+            auto block_count = min(length / block_size, batch_block_count);
+            auto batch_size = block_count * block_size;
+            const auto* slice = in.offset(offset);
+            cipher.decrypt_blocks(slice, decrypted, block_count);
+            for (size_t i = 0; i < block_size; ++i)
+                decrypted[i] ^= previous_block[i];
+            for (size_t i = block_size; i < batch_size; ++i)
+                decrypted[i] ^= slice[i - block_size];
+            __builtin_memcpy(previous_block, slice + batch_size - block_size, block_size);
+
+            ASSERT(offset + batch_size <= out.size());
+            __builtin_memcpy(out.offset(offset), decrypted, batch_size);
+            length -= batch_size;
+            offset += batch_size;
         }
         out = out.slice(0, offset);
         this->prune_padding(out);
@@ -133,8 +133,9 @@ public:
     }
 
 private:
+    static constexpr size_t batch_block_count = 8;
+
     u8 m_ivec_storage[IVSizeInBits / 8];
-    typename T::BlockType m_cipher_block {};
 
     static void increment_inplace(Bytes& in)
     {
@@ -168,29 +169,36 @@ private:
         ASSERT(!ivec.is_empty());
         ASSERT(ivec.size() >= IV_length());
 
-        m_cipher_block.set_padding_mode(cipher.padding_mode());
-
         __builtin_memcpy(m_ivec_storage, ivec.data(), IV_length());
         Bytes iv { m_ivec_storage, IV_length() };
 
         size_t offset { 0 };
-        auto block_size = cipher.block_size();
+        constexpr auto block_size = T::BlockType::BlockSizeInBits / 8;
+        static_assert(block_size == IVSizeInBits / 8);
+
+        // The counter blocks are encrypted a batch at a time, so the cipher can work on
+        // several of them at once.
+        u8 key_stream[batch_block_count * block_size];
 
         while (length > 0) {
-            m_cipher_block.overwrite(iv.slice(0, block_size));
+            auto batch_size = min(sizeof(key_stream), length);
+            auto block_count = (batch_size + block_size - 1) / block_size;
+            for (size_t i = 0; i < block_count; ++i) {
+                __builtin_memcpy(key_stream + i * block_size, iv.data(), block_size);
+                increment_inplace(iv);
+            }
+            cipher.encrypt_blocks(key_stream, key_stream, block_count);
 
-            cipher.encrypt_block(m_cipher_block, m_cipher_block);
+            ASSERT(offset + batch_size <= out.size());
             if (in) {
-                m_cipher_block.apply_initialization_vector(in->data() + offset);
+                for (size_t i = 0; i < batch_size; ++i)
+                    out[offset + i] = (*in)[offset + i] ^ key_stream[i];
+            } else {
+                __builtin_memcpy(out.offset(offset), key_stream, batch_size);
             }
-            auto write_size = min(block_size, length);
-
-            ASSERT(offset + write_size <= out.size());
-            __builtin_memcpy(out.offset(offset), m_cipher_block.get().data(), write_size);
 
-            increment_inplace(iv);
-            length -= write_size;
-            offset += write_size;
+            length -= batch_size;
+            offset += batch_size;
         }
 
         if (ivec_out)
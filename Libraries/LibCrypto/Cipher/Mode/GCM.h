@@ -0,0 +1,204 @@
+/*
+ * Copyright (c) 2020, Ali Mohammad Pur <ali.mpfard@gmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/OwnPtr.h>
+#include <AK/String.h>
+#include <AK/StringBuilder.h>
+#include <AK/StringView.h>
+#include <LibCrypto/Authentication/GHash.h>
+#include <LibCrypto/Cipher/Mode/Mode.h>
+#include <LibCrypto/PK/Code/Code.h>
+
+namespace Crypto {
+namespace Cipher {
+
+// Galois/Counter Mode, see NIST SP 800-38D.
+// Only the recommended 96-bit IVs and full 128-bit tags are supported.
+// The data is encrypted (or decrypted) and authenticated in a single pass over it, a batch of
+// blocks at a time, so a batch is still in the cache when GHASH gets to it.
+template<typename T>
+class GCM : public Mode<T> {
+public:
+    constexpr static size_t IVSizeInBits = 96;
+    constexpr static size_t TagSize = 16;
+
+    virtual ~GCM() { }
+
+    // Like CTR, the underlying cipher is only ever used to encrypt.
+    template<typename KeyType, typename... Args>
+    explicit GCM<T>(const KeyType& user_key, size_t key_bits, Intent = Intent::Encryption, Args... args)
+        : Mode<T>(user_key, key_bits, args...)
+    {
+        u8 hash_subkey[block_size] {};
+        this->cipher().encrypt_blocks(hash_subkey, hash_subkey, 1);
+        m_ghash = make<Authentication::GHash>(ReadonlyBytes { hash_subkey, block_size });
+    }
+
+    virtual String class_name() const override
+    {
+        StringBuilder builder;
+        builder.append(this->cipher().class_name());
+        builder.append("_GCM");
+        return builder.build();
+    }
+
+    virtual size_t IV_length() const override { return IVSizeInBits / 8; }
+
+    // Without additional data, the output is the ciphertext followed by the tag,
+    // so `out' needs room for TagSize more bytes than `in'.
+    virtual void encrypt(const ReadonlyBytes& in, Bytes& out, const Bytes& ivec = {}, Bytes* ivec_out = nullptr) override
+    {
+        ASSERT(!ivec_out);
+        ASSERT(out.size() >= in.size() + TagSize);
+        out = out.slice(0, in.size() + TagSize);
+        encrypt(in, out.slice(0, in.size()), ivec, {}, out.slice(in.size(), TagSize));
+    }
+
+    // The input is the ciphertext followed by the tag. If the tag doesn't match, `out' is
+    // left empty.
+    virtual void decrypt(const ReadonlyBytes& in, Bytes& out, const Bytes& ivec = {}) override
+    {
+        ASSERT(in.size() >= TagSize);
+        auto length = in.size() - TagSize;
+        ASSERT(out.size() >= length);
+        if (decrypt(in.slice(0, length), out.slice(0, length), ivec, {}, in.slice(length, TagSize)) == PK::VerificationConsistency::Consistent)
+            out = out.slice(0, length);
+        else
+            out = out.slice(0, 0);
+    }
+
+    // `in' and `out' may be the same buffer.
+    void encrypt(const ReadonlyBytes& in, Bytes out, const ReadonlyBytes& ivec, const ReadonlyBytes& additional_data, Bytes tag)
+    {
+        ASSERT(out.size() >= in.size());
+        ASSERT(tag.size() == TagSize);
+
+        u8 counter[block_size];
+        u8 tag_mask[block_size];
+        initialize(ivec, counter, tag_mask);
+
+        m_ghash->update(additional_data);
+        crypt(in, out, counter, true);
+        finish(additional_data.size(), in.size(), tag_mask, tag.data());
+    }
+
+    // `in' and `out' may be the same buffer. The plaintext must not be used unless the result
+    // is Consistent; `out' is zeroed when it isn't.
+    PK::VerificationConsistency decrypt(const ReadonlyBytes& in, Bytes out, const ReadonlyBytes& ivec, const ReadonlyBytes& additional_data, const ReadonlyBytes& tag)
+    {
+        ASSERT(out.size() >= in.size());
+
+        u8 counter[block_size];
+        u8 tag_mask[block_size];
+        initialize(ivec, counter, tag_mask);
+
+        m_ghash->update(additional_data);
+        crypt(in, out, counter, false);
+
+        u8 computed_tag[TagSize];
+        finish(additional_data.size(), in.size(), tag_mask, computed_tag);
+
+        // Don't give away how much of the tag matched.
+        u8 difference = tag.size() ^ TagSize;
+        for (size_t i = 0; i < min(tag.size(), TagSize); ++i)
+            difference |= tag[i] ^ computed_tag[i];
+        if (difference != 0) {
+            __builtin_memset(out.data(), 0, in.size());
+            return PK::VerificationConsistency::Inconsistent;
+        }
+        return PK::VerificationConsistency::Consistent;
+    }
+
+private:
+    static constexpr size_t block_size = T::BlockType::BlockSizeInBits / 8;
+    static constexpr size_t batch_block_count = 8;
+    static_assert(block_size == Authentication::GHash::block_size());
+
+    // J0 is the IV followed by a 32-bit counter of 1. It masks the tag, and the data is
+    // encrypted with the counters that follow it.
+    void initialize(const ReadonlyBytes& ivec, u8* counter, u8* tag_mask)
+    {
+        ASSERT(ivec.size() == IV_length());
+        __builtin_memcpy(counter, ivec.data(), IV_length());
+        counter[12] = 0;
+        counter[13] = 0;
+        counter[14] = 0;
+        counter[15] = 1;
+        this->cipher().encrypt_blocks(counter, tag_mask, 1);
+        increment(counter);
+    }
+
+    // Only the last 32 bits count, see the "inc32" function in NIST SP 800-38D.
+    static void increment(u8* counter)
+    {
+        u32 value = ((u32)counter[12] << 24) | ((u32)counter[13] << 16) | ((u32)counter[14] << 8) | counter[15];
+        ++value;
+        counter[12] = value >> 24;
+        counter[13] = value >> 16;
+        counter[14] = value >> 8;
+        counter[15] = value;
+    }
+
+    void crypt(const ReadonlyBytes& in, Bytes& out, u8* counter, bool encrypting)
+    {
+        u8 key_stream[batch_block_count * block_size];
+        size_t offset = 0;
+        while (offset < in.size()) {
+            auto batch_size = min(sizeof(key_stream), in.size() - offset);
+            auto block_count = (batch_size + block_size - 1) / block_size;
+            for (size_t i = 0; i < block_count; ++i) {
+                __builtin_memcpy(key_stream + i * block_size, counter, block_size);
+                increment(counter);
+            }
+            this->cipher().encrypt_blocks(key_stream, key_stream, block_count);
+
+            // GHASH always covers the ciphertext. The input is hashed before it is written over,
+            // in case the decryption is in place.
+            if (!encrypting)
+                m_ghash->update(in.slice(offset, batch_size));
+            for (size_t i = 0; i < batch_size; ++i)
+                out[offset + i] = in[offset + i] ^ key_stream[i];
+            if (encrypting)
+                m_ghash->update(out.slice(offset, batch_size));
+
+            offset += batch_size;
+        }
+    }
+
+    void finish(size_t additional_data_length, size_t length, const u8* tag_mask, u8* tag)
+    {
+        m_ghash->digest(additional_data_length, length, tag);
+        for (size_t i = 0; i < TagSize; ++i)
+            tag[i] ^= tag_mask[i];
+    }
+
+    OwnPtr<Authentication::GHash> m_ghash;
+};
+
+}
+}
@@ -26,6 +26,7 @@
 
 #pragma once
 
+#include <AK/MappedFile.h>
 #include <AK/Optional.h>
 #include <AK/OwnPtr.h>
 #include <LibCrypto/Hash/HashFunction.h>
@@ -144,6 +145,12 @@ public:
 
     virtual void update(const ByteBuffer& buffer) override { update(buffer.data(), buffer.size()); };
     virtual void update(const StringView& string) override { update((const u8*)string.characters_without_null_termination(), string.length()); };
+    // Hashes the file's pages where they are, without reading them into a buffer first.
+    void update(const MappedFile& file)
+    {
+        if (file.is_valid())
+            update((const u8*)file.data(), file.size());
+    }
     inline size_t digest_size() const
     {
         switch (m_kind) {
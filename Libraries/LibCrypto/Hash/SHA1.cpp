@@ -24,9 +24,16 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <AK/Platform.h>
+#include <AK/StdLibExtras.h>
 #include <AK/Types.h>
 #include <LibCrypto/Hash/SHA1.h>
 
+#if ARCH(I386) || ARCH(X86_64)
+#    include <cpuid.h>
+#    include <immintrin.h>
+#endif
+
 namespace Crypto {
 namespace Hash {
 
@@ -35,6 +42,35 @@ inline static constexpr auto ROTATE_LEFT(u32 value, size_t bits)
     return (value << bits) | (value >> (32 - bits));
 }
 
+// Does the 80 rounds on an already expanded message.
+static inline void do_rounds(u32* state, const u32* blocks)
+{
+    auto a = state[0], b = state[1], c = state[2], d = state[3], e = state[4];
+
+    auto round = [&](u32 f, u32 k, u32 w) {
+        auto temp = ROTATE_LEFT(a, 5) + f + e + k + w;
+        e = d;
+        d = c;
+        c = ROTATE_LEFT(b, 30);
+        b = a;
+        a = temp;
+    };
+    for (size_t i = 0; i < 20; ++i)
+        round((b & c) | ((~b) & d), SHA1Constants::RoundConstants[0], blocks[i]);
+    for (size_t i = 20; i < 40; ++i)
+        round(b ^ c ^ d, SHA1Constants::RoundConstants[1], blocks[i]);
+    for (size_t i = 40; i < 60; ++i)
+        round((b & c) | (b & d) | (c & d), SHA1Constants::RoundConstants[2], blocks[i]);
+    for (size_t i = 60; i < 80; ++i)
+        round(b ^ c ^ d, SHA1Constants::RoundConstants[3], blocks[i]);
+
+    state[0] += a;
+    state[1] += b;
+    state[2] += c;
+    state[3] += d;
+    state[4] += e;
+}
+
 inline void SHA1::transform(const u8* data)
 {
     u32 blocks[80];
@@ -45,56 +81,179 @@ inline void SHA1::transform(const u8* data)
     for (size_t i = 16; i < Rounds; ++i)
         blocks[i] = ROTATE_LEFT(blocks[i - 3] ^ blocks[i - 8] ^ blocks[i - 14] ^ blocks[i - 16], 1);
 
-    auto a = m_state[0], b = m_state[1], c = m_state[2], d = m_state[3], e = m_state[4];
-    u32 f, k;
-
-    for (size_t i = 0; i < Rounds; ++i) {
-        if (i <= 19) {
-            f = (b & c) | ((~b) & d);
-            k = SHA1Constants::RoundConstants[0];
-        } else if (i <= 39) {
-            f = b ^ c ^ d;
-            k = SHA1Constants::RoundConstants[1];
-        } else if (i <= 59) {
-            f = (b & c) | (b & d) | (c & d);
-            k = SHA1Constants::RoundConstants[2];
-        } else {
-            f = b ^ c ^ d;
-            k = SHA1Constants::RoundConstants[3];
+    do_rounds(m_state, blocks);
+
+    // "security" measures, as if SHA1 is secure
+    __builtin_memset(blocks, 0, 16 * sizeof(u32));
+}
+
+static bool has_sha_ni()
+{
+#if ARCH(I386) || ARCH(X86_64)
+    static bool s_has_sha_ni = [] {
+        unsigned eax, ebx, ecx, edx;
+        if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx) || !(ecx & bit_SSE4_1))
+            return false;
+        return __get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) && (ebx & bit_SHA);
+    }();
+    return s_has_sha_ni;
+#else
+    return false;
+#endif
+}
+
+static bool has_ssse3()
+{
+#if ARCH(I386) || ARCH(X86_64)
+    static bool s_has_ssse3 = [] {
+        unsigned eax, ebx, ecx, edx;
+        return __get_cpuid(1, &eax, &ebx, &ecx, &edx) && (ecx & bit_SSSE3);
+    }();
+    return s_has_ssse3;
+#else
+    return false;
+#endif
+}
+
+#if ARCH(I386) || ARCH(X86_64)
+// Does four rounds, and leaves `e` holding E for the next four (in the top lane, like the state).
+template<int Function>
+[[gnu::target("sha,sse4.1")]] static inline void sha_ni_rounds(__m128i& abcd, __m128i& e, __m128i message)
+{
+    auto previous_abcd = abcd;
+    abcd = _mm_sha1rnds4_epu32(abcd, _mm_add_epi32(e, message), Function);
+    e = _mm_sha1nexte_epu32(previous_abcd, _mm_setzero_si128());
+}
+
+// w[i..i+3] from the 16 words before them, each vector holding four words.
+[[gnu::target("sha,sse4.1")]] static inline __m128i sha_ni_schedule(__m128i w0, __m128i w4, __m128i w8, __m128i w12)
+{
+    return _mm_sha1msg2_epu32(_mm_xor_si128(_mm_sha1msg1_epu32(w0, w4), w8), w12);
+}
+
+[[gnu::target("ssse3")]] static void transform_blocks_ssse3(u32* state, const u8* data, size_t block_count)
+{
+    const auto byte_swap_mask = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+    alignas(16) u32 blocks[80];
+
+    for (; block_count; --block_count, data += 64) {
+        for (size_t i = 0; i < 16; i += 4)
+            _mm_store_si128((__m128i*)&blocks[i], _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(data + i * 4)), byte_swap_mask));
+        for (size_t i = 16; i < 32; ++i)
+            blocks[i] = ROTATE_LEFT(blocks[i - 3] ^ blocks[i - 8] ^ blocks[i - 14] ^ blocks[i - 16], 1);
+        // From there on, the same recurrence can be written as
+        // w[i] = (w[i-6] xor w[i-16] xor w[i-28] xor w[i-32]) leftrotate 2,
+        // which doesn't depend on the three words before, so four of them can be done at a time.
+        for (size_t i = 32; i < 80; i += 4) {
+            auto w = _mm_xor_si128(_mm_loadu_si128((const __m128i*)&blocks[i - 6]), _mm_load_si128((const __m128i*)&blocks[i - 16]));
+            w = _mm_xor_si128(w, _mm_load_si128((const __m128i*)&blocks[i - 28]));
+            w = _mm_xor_si128(w, _mm_load_si128((const __m128i*)&blocks[i - 32]));
+            _mm_store_si128((__m128i*)&blocks[i], _mm_or_si128(_mm_slli_epi32(w, 2), _mm_srli_epi32(w, 30)));
         }
-        auto temp = ROTATE_LEFT(a, 5) + f + e + k + blocks[i];
-        e = d;
-        d = c;
-        c = ROTATE_LEFT(b, 30);
-        b = a;
-        a = temp;
+        do_rounds(state, blocks);
     }
 
-    m_state[0] += a;
-    m_state[1] += b;
-    m_state[2] += c;
-    m_state[3] += d;
-    m_state[4] += e;
-
-    // "security" measures, as if SHA1 is secure
-    a = 0;
-    b = 0;
-    c = 0;
-    d = 0;
-    e = 0;
     __builtin_memset(blocks, 0, 16 * sizeof(u32));
 }
 
+[[gnu::target("sha,sse4.1")]] static void transform_blocks_sha_ni(u32* state, const u8* data, size_t block_count)
+{
+    // The instructions want the words in reverse order, with A (and E) in the top lane.
+    const auto byte_swap_mask = _mm_set_epi64x(0x0001020304050607ULL, 0x08090a0b0c0d0e0fULL);
+    auto abcd = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)state), 0x1b);
+    auto e = _mm_set_epi32(state[4], 0, 0, 0);
+
+    for (; block_count; --block_count, data += 64) {
+        auto saved_abcd = abcd;
+        auto saved_e = e;
+
+        auto w0 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)data), byte_swap_mask);
+        auto w1 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(data + 16)), byte_swap_mask);
+        auto w2 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(data + 32)), byte_swap_mask);
+        auto w3 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(data + 48)), byte_swap_mask);
+
+        sha_ni_rounds<0>(abcd, e, w0);
+        sha_ni_rounds<0>(abcd, e, w1);
+        sha_ni_rounds<0>(abcd, e, w2);
+        sha_ni_rounds<0>(abcd, e, w3);
+        w0 = sha_ni_schedule(w0, w1, w2, w3);
+        sha_ni_rounds<0>(abcd, e, w0);
+        w1 = sha_ni_schedule(w1, w2, w3, w0);
+        sha_ni_rounds<1>(abcd, e, w1);
+        w2 = sha_ni_schedule(w2, w3, w0, w1);
+        sha_ni_rounds<1>(abcd, e, w2);
+        w3 = sha_ni_schedule(w3, w0, w1, w2);
+        sha_ni_rounds<1>(abcd, e, w3);
+        w0 = sha_ni_schedule(w0, w1, w2, w3);
+        sha_ni_rounds<1>(abcd, e, w0);
+        w1 = sha_ni_schedule(w1, w2, w3, w0);
+        sha_ni_rounds<1>(abcd, e, w1);
+        w2 = sha_ni_schedule(w2, w3, w0, w1);
+        sha_ni_rounds<2>(abcd, e, w2);
+        w3 = sha_ni_schedule(w3, w0, w1, w2);
+        sha_ni_rounds<2>(abcd, e, w3);
+        w0 = sha_ni_schedule(w0, w1, w2, w3);
+        sha_ni_rounds<2>(abcd, e, w0);
+        w1 = sha_ni_schedule(w1, w2, w3, w0);
+        sha_ni_rounds<2>(abcd, e, w1);
+        w2 = sha_ni_schedule(w2, w3, w0, w1);
+        sha_ni_rounds<2>(abcd, e, w2);
+        w3 = sha_ni_schedule(w3, w0, w1, w2);
+        sha_ni_rounds<3>(abcd, e, w3);
+        w0 = sha_ni_schedule(w0, w1, w2, w3);
+        sha_ni_rounds<3>(abcd, e, w0);
+        w1 = sha_ni_schedule(w1, w2, w3, w0);
+        sha_ni_rounds<3>(abcd, e, w1);
+        w2 = sha_ni_schedule(w2, w3, w0, w1);
+        sha_ni_rounds<3>(abcd, e, w2);
+        w3 = sha_ni_schedule(w3, w0, w1, w2);
+        sha_ni_rounds<3>(abcd, e, w3);
+
+        abcd = _mm_add_epi32(abcd, saved_abcd);
+        e = _mm_add_epi32(e, saved_e);
+    }
+
+    _mm_storeu_si128((__m128i*)state, _mm_shuffle_epi32(abcd, 0x1b));
+    state[4] = _mm_extract_epi32(e, 3);
+}
+#endif
+
+void SHA1::transform_blocks(const u8* data, size_t block_count)
+{
+#if ARCH(I386) || ARCH(X86_64)
+    if (has_sha_ni())
+        return transform_blocks_sha_ni(m_state, data, block_count);
+    if (has_ssse3())
+        return transform_blocks_ssse3(m_state, data, block_count);
+#endif
+    for (; block_count; --block_count, data += BlockSize)
+        transform(data);
+}
+
 void SHA1::update(const u8* message, size_t length)
 {
-    for (size_t i = 0; i < length; ++i) {
-        if (m_data_length == BlockSize) {
-            transform(m_data_buffer);
-            m_bit_length += 512;
-            m_data_length = 0;
-        }
-        m_data_buffer[m_data_length++] = message[i];
+    if (m_data_length) {
+        auto to_copy = min(length, BlockSize - m_data_length);
+        __builtin_memcpy(m_data_buffer + m_data_length, message, to_copy);
+        m_data_length += to_copy;
+        message += to_copy;
+        length -= to_copy;
+        if (m_data_length < BlockSize)
+            return;
+        transform_blocks(m_data_buffer, 1);
+        m_bit_length += 512;
+        m_data_length = 0;
     }
+
+    // Whole blocks are hashed straight from the input, which may well be a large mapped file.
+    auto block_count = length / BlockSize;
+    transform_blocks(message, block_count);
+    m_bit_length += block_count * 512;
+    message += block_count * BlockSize;
+    length -= block_count * BlockSize;
+
+    __builtin_memcpy(m_data_buffer, message, length);
+    m_data_length = length;
 }
 
 SHA1::DigestType SHA1::digest()
@@ -116,7 +275,7 @@ SHA1::DigestType SHA1::peek()
     __builtin_memcpy(state, m_state, 20);
 
     if (BlockSize == m_data_length) {
-        transform(m_data_buffer);
+        transform_blocks(m_data_buffer, 1);
         m_bit_length += BlockSize * 8;
         m_data_length = 0;
         i = 0;
@@ -132,7 +291,7 @@ SHA1::DigestType SHA1::peek()
         m_data_buffer[i++] = 0x80;
         while (i < BlockSize)
             m_data_buffer[i++] = 0x00;
-        transform(m_data_buffer);
+        transform_blocks(m_data_buffer, 1);
 
         // Then start another block with BlockSize - 8 bytes of zeros
         __builtin_memset(m_data_buffer, 0, FinalBlockDataSize);
@@ -149,7 +308,7 @@ SHA1::DigestType SHA1::peek()
     m_data_buffer[BlockSize - 7] = m_bit_length >> 48;
     m_data_buffer[BlockSize - 8] = m_bit_length >> 56;
 
-    transform(m_data_buffer);
+    transform_blocks(m_data_buffer, 1);
 
     for (size_t i = 0; i < 4; ++i) {
         digest.data[i + 0] = (m_state[0] >> (24 - i * 8)) & 0x000000ff;
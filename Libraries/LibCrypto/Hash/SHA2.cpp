@@ -24,9 +24,18 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <AK/Platform.h>
+#include <AK/StdLibExtras.h>
 #include <AK/Types.h>
 #include <LibCrypto/Hash/SHA2.h>
 
+// The kernel doesn't preserve the SSE registers of the interrupted thread, so it sticks to the
+// software implementation.
+#if (ARCH(I386) || ARCH(X86_64)) && !defined(KERNEL)
+#    include <cpuid.h>
+#    include <immintrin.h>
+#endif
+
 namespace Crypto {
 namespace Hash {
 constexpr inline static auto ROTRIGHT(u32 a, size_t b) { return (a >> b) | (a << (32 - b)); }
@@ -86,16 +95,117 @@ inline void SHA256::transform(const u8* data)
     m_state[7] += h;
 }
 
-void SHA256::update(const u8* message, size_t length)
+static bool has_sha_ni()
 {
-    for (size_t i = 0; i < length; ++i) {
-        if (m_data_length == BlockSize) {
-            transform(m_data_buffer);
-            m_bit_length += 512;
-            m_data_length = 0;
+#if (ARCH(I386) || ARCH(X86_64)) && !defined(KERNEL)
+    static bool s_has_sha_ni = [] {
+        unsigned eax, ebx, ecx, edx;
+        if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx) || !(ecx & bit_SSE4_1))
+            return false;
+        return __get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) && (ebx & bit_SHA);
+    }();
+    return s_has_sha_ni;
+#else
+    return false;
+#endif
+}
+
+#if (ARCH(I386) || ARCH(X86_64)) && !defined(KERNEL)
+// Does four rounds with the message words w and round constants k[0..3].
+[[gnu::target("sha,sse4.1")]] static inline void sha_ni_rounds(__m128i& abef, __m128i& cdgh, __m128i w, const u32* k)
+{
+    auto message = _mm_add_epi32(w, _mm_loadu_si128((const __m128i*)k));
+    cdgh = _mm_sha256rnds2_epu32(cdgh, abef, message);
+    abef = _mm_sha256rnds2_epu32(abef, cdgh, _mm_shuffle_epi32(message, 0x0e));
+}
+
+// w[i..i+3] from the 16 words before them, each vector holding four words.
+[[gnu::target("sha,sse4.1")]] static inline __m128i sha_ni_schedule(__m128i w0, __m128i w4, __m128i w8, __m128i w12)
+{
+    auto w9 = _mm_alignr_epi8(w12, w8, 4);
+    return _mm_sha256msg2_epu32(_mm_add_epi32(_mm_sha256msg1_epu32(w0, w4), w9), w12);
+}
+
+[[gnu::target("sha,sse4.1")]] static void transform_blocks_sha_ni(u32* state, const u8* data, size_t block_count)
+{
+    const auto byte_swap_mask = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+    const auto* k = SHA256Constants::RoundConstants;
+
+    // The instructions keep the state as ABEF and CDGH.
+    auto dcba = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)state), 0xb1);
+    auto hgfe = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)(state + 4)), 0x1b);
+    auto abef = _mm_alignr_epi8(dcba, hgfe, 8);
+    auto cdgh = _mm_blend_epi16(hgfe, dcba, 0xf0);
+
+    for (; block_count; --block_count, data += 64) {
+        auto saved_abef = abef;
+        auto saved_cdgh = cdgh;
+
+        auto w0 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)data), byte_swap_mask);
+        auto w1 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(data + 16)), byte_swap_mask);
+        auto w2 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(data + 32)), byte_swap_mask);
+        auto w3 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(data + 48)), byte_swap_mask);
+
+        sha_ni_rounds(abef, cdgh, w0, k);
+        sha_ni_rounds(abef, cdgh, w1, k + 4);
+        sha_ni_rounds(abef, cdgh, w2, k + 8);
+        sha_ni_rounds(abef, cdgh, w3, k + 12);
+        for (size_t i = 16; i < 64; i += 16) {
+            w0 = sha_ni_schedule(w0, w1, w2, w3);
+            sha_ni_rounds(abef, cdgh, w0, k + i);
+            w1 = sha_ni_schedule(w1, w2, w3, w0);
+            sha_ni_rounds(abef, cdgh, w1, k + i + 4);
+            w2 = sha_ni_schedule(w2, w3, w0, w1);
+            sha_ni_rounds(abef, cdgh, w2, k + i + 8);
+            w3 = sha_ni_schedule(w3, w0, w1, w2);
+            sha_ni_rounds(abef, cdgh, w3, k + i + 12);
         }
-        m_data_buffer[m_data_length++] = message[i];
+
+        abef = _mm_add_epi32(abef, saved_abef);
+        cdgh = _mm_add_epi32(cdgh, saved_cdgh);
+    }
+
+    auto feba = _mm_shuffle_epi32(abef, 0x1b);
+    auto dchg = _mm_shuffle_epi32(cdgh, 0xb1);
+    _mm_storeu_si128((__m128i*)state, _mm_blend_epi16(feba, dchg, 0xf0));
+    _mm_storeu_si128((__m128i*)(state + 4), _mm_alignr_epi8(dchg, feba, 8));
+}
+#endif
+
+void SHA256::transform_blocks(const u8* data, size_t block_count)
+{
+#if (ARCH(I386) || ARCH(X86_64)) && !defined(KERNEL)
+    if (has_sha_ni())
+        return transform_blocks_sha_ni(m_state, data, block_count);
+#endif
+    for (; block_count; --block_count, data += BlockSize)
+        transform(data);
+}
+
+void SHA256::update(const u8* message, size_t length)
+{
+    if (m_data_length) {
+        auto to_copy = min(length, BlockSize - m_data_length);
+        __builtin_memcpy(m_data_buffer + m_data_length, message, to_copy);
+        m_data_length += to_copy;
+        message += to_copy;
+        length -= to_copy;
+        if (m_data_length < BlockSize)
+            return;
+        transform_blocks(m_data_buffer, 1);
+        m_bit_length += 512;
+        m_data_length = 0;
     }
+
+    // Whole blocks are hashed straight from the input, which may well be a large mapped file.
+    auto block_count = length / BlockSize;
+    transform_blocks(message, block_count);
+    m_bit_length += block_count * 512;
+    message += block_count * BlockSize;
+    length -= block_count * BlockSize;
+
+    __builtin_memcpy(m_data_buffer, message, length);
+    m_data_length = length;
 }
 
 SHA256::DigestType SHA256::digest()
@@ -111,7 +221,7 @@ SHA256::DigestType SHA256::peek()
     size_t i = m_data_length;
 
     if (BlockSize == m_data_length) {
-        transform(m_data_buffer);
+        transform_blocks(m_data_buffer, 1);
         m_bit_length += BlockSize * 8;
         m_data_length = 0;
         i = 0;
@@ -127,7 +237,7 @@ SHA256::DigestType SHA256::peek()
         m_data_buffer[i++] = 0x80;
         while (i < BlockSize)
             m_data_buffer[i++] = 0x00;
-        transform(m_data_buffer);
+        transform_blocks(m_data_buffer, 1);
 
         // Then start another block with BlockSize - 8 bytes of zeros
         __builtin_memset(m_data_buffer, 0, FinalBlockDataSize);
@@ -144,7 +254,7 @@ SHA256::DigestType SHA256::peek()
     m_data_buffer[BlockSize - 7] = m_bit_length >> 48;
     m_data_buffer[BlockSize - 8] = m_bit_length >> 56;
 
-    transform(m_data_buffer);
+    transform_blocks(m_data_buffer, 1);
 
     // SHA uses big-endian and we assume little-endian
     // FIXME: looks like a thing for AK::NetworkOrdered,
@@ -0,0 +1,320 @@
+/*
+ * Copyright (c) 2020, Ali Mohammad Pur <ali.mpfard@gmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <AK/Vector.h>
+#include <LibCrypto/NumberTheory/ModularFunctions.h>
+
+namespace Crypto {
+namespace NumberTheory {
+
+// Montgomery arithmetic works on its own limbs, twice as wide as the words of
+// UnsignedBigInteger when the compiler has a 128-bit type to hold their products.
+#ifdef __SIZEOF_INT128__
+using Limb = u64;
+using DoubleLimb = unsigned __int128;
+#else
+using Limb = u32;
+using DoubleLimb = u64;
+#endif
+
+static constexpr size_t BITS_IN_LIMB = sizeof(Limb) * 8;
+static constexpr size_t WORDS_IN_LIMB = sizeof(Limb) / sizeof(u32);
+
+static void to_limbs(const UnsignedBigInteger& number, Vector<Limb>& limbs, size_t limb_count)
+{
+    limbs.resize(limb_count);
+    for (size_t i = 0; i < limb_count; ++i) {
+        Limb limb = 0;
+        for (size_t j = 0; j < WORDS_IN_LIMB; ++j) {
+            auto word_index = i * WORDS_IN_LIMB + j;
+            if (word_index < number.length())
+                limb |= (Limb)number.words()[word_index] << (32 * j);
+        }
+        limbs[i] = limb;
+    }
+}
+
+static UnsignedBigInteger from_limbs(const Vector<Limb>& limbs)
+{
+    Vector<u32, STARTING_WORD_SIZE> words;
+    words.ensure_capacity(limbs.size() * WORDS_IN_LIMB);
+    for (auto limb : limbs) {
+        for (size_t j = 0; j < WORDS_IN_LIMB; ++j)
+            words.unchecked_append((u32)(limb >> (32 * j)));
+    }
+    return UnsignedBigInteger(move(words));
+}
+
+// Multiplication modulo an odd number N, with the numbers kept in Montgomery form
+// (x * R mod N, with R = 2^(BITS_IN_LIMB * limb_count)). The reduction then only takes
+// multiplications and shifts by whole limbs, instead of a long division.
+class MontgomeryContext {
+public:
+    explicit MontgomeryContext(const UnsignedBigInteger& modulus)
+    {
+        m_limb_count = (modulus.trimmed_length() + WORDS_IN_LIMB - 1) / WORDS_IN_LIMB;
+        to_limbs(modulus, m_modulus, m_limb_count);
+        m_product.resize(m_limb_count + 2);
+
+        // -N^-1 mod 2^BITS_IN_LIMB, by Newton's iteration: every step doubles the number of
+        // correct low bits, and N is its own inverse modulo 8.
+        Limb inverse = m_modulus[0];
+        for (size_t i = 0; i < 5; ++i)
+            inverse *= 2 - m_modulus[0] * inverse;
+        m_negated_inverse = -inverse;
+
+        // R^2 mod N, by doubling 1 modulo N 2 * BITS_IN_LIMB * limb_count times.
+        m_r_squared.resize(m_limb_count);
+        for (auto& limb : m_r_squared)
+            limb = 0;
+        m_r_squared[0] = 1;
+        for (size_t i = 0; i < 2 * BITS_IN_LIMB * m_limb_count; ++i) {
+            Limb carry = 0;
+            for (auto& limb : m_r_squared) {
+                auto shifted_out = limb >> (BITS_IN_LIMB - 1);
+                limb = (limb << 1) | carry;
+                carry = shifted_out;
+            }
+            if (carry || !is_less_than_modulus(m_r_squared.data()))
+                subtract_modulus(m_r_squared.data());
+        }
+    }
+
+    size_t limb_count() const { return m_limb_count; }
+
+    // output = left * right * R^-1 mod N. The output may be one of the inputs.
+    // This interleaves the multiplication with the reduction ("CIOS", see Koç, Acar and
+    // Kaliski, "Analyzing and Comparing Montgomery Multiplication Algorithms").
+    void multiply(const Limb* left, const Limb* right, Limb* output)
+    {
+        auto n = m_limb_count;
+        auto* t = m_product.data();
+        __builtin_memset(t, 0, (n + 2) * sizeof(Limb));
+
+        for (size_t i = 0; i < n; ++i) {
+            Limb carry = 0;
+            for (size_t j = 0; j < n; ++j) {
+                DoubleLimb product = (DoubleLimb)left[j] * right[i] + t[j] + carry;
+                t[j] = (Limb)product;
+                carry = (Limb)(product >> BITS_IN_LIMB);
+            }
+            DoubleLimb sum = (DoubleLimb)t[n] + carry;
+            t[n] = (Limb)sum;
+            t[n + 1] = (Limb)(sum >> BITS_IN_LIMB);
+
+            // Add a multiple of N that clears the lowest limb, then shift that limb out.
+            Limb factor = t[0] * m_negated_inverse;
+            DoubleLimb product = (DoubleLimb)factor * m_modulus[0] + t[0];
+            carry = (Limb)(product >> BITS_IN_LIMB);
+            for (size_t j = 1; j < n; ++j) {
+                product = (DoubleLimb)factor * m_modulus[j] + t[j] + carry;
+                t[j - 1] = (Limb)product;
+                carry = (Limb)(product >> BITS_IN_LIMB);
+            }
+            sum = (DoubleLimb)t[n] + carry;
+            t[n - 1] = (Limb)sum;
+            t[n] = t[n + 1] + (Limb)(sum >> BITS_IN_LIMB);
+        }
+
+        // The result is less than 2N.
+        if (t[n] || !is_less_than_modulus(t))
+            subtract_modulus(t);
+        __builtin_memcpy(output, t, n * sizeof(Limb));
+    }
+
+    // Takes x < N into Montgomery form.
+    void to_montgomery(const Limb* number, Limb* output) { multiply(number, m_r_squared.data(), output); }
+
+    void from_montgomery(const Limb* number, Limb* output)
+    {
+        Vector<Limb> one;
+        one.resize(m_limb_count);
+        for (auto& limb : one)
+            limb = 0;
+        one[0] = 1;
+        multiply(number, one.data(), output);
+    }
+
+private:
+    bool is_less_than_modulus(const Limb* number) const
+    {
+        for (size_t i = m_limb_count; i > 0; --i) {
+            if (number[i - 1] != m_modulus[i - 1])
+                return number[i - 1] < m_modulus[i - 1];
+        }
+        return false;
+    }
+
+    void subtract_modulus(Limb* number) const
+    {
+        Limb borrow = 0;
+        for (size_t i = 0; i < m_limb_count; ++i) {
+            DoubleLimb difference = (DoubleLimb)number[i] - m_modulus[i] - borrow;
+            number[i] = (Limb)difference;
+            borrow = (Limb)(difference >> BITS_IN_LIMB) & 1;
+        }
+    }
+
+    size_t m_limb_count { 0 };
+    Vector<Limb> m_modulus;
+    Limb m_negated_inverse { 0 };
+    Vector<Limb> m_r_squared;
+    Vector<Limb> m_product;
+};
+
+static bool exponent_bit(const UnsignedBigInteger& exponent, size_t index)
+{
+    return (exponent.words()[index / 32] >> (index % 32)) & 1;
+}
+
+// Larger windows need fewer multiplications, but more precomputed powers.
+static size_t window_size_for(size_t exponent_bits)
+{
+    if (exponent_bits > 671)
+        return 6;
+    if (exponent_bits > 239)
+        return 5;
+    if (exponent_bits > 79)
+        return 4;
+    if (exponent_bits > 23)
+        return 3;
+    return 1;
+}
+
+static UnsignedBigInteger montgomery_modular_power(const UnsignedBigInteger& base, const UnsignedBigInteger& exponent, const UnsignedBigInteger& modulus)
+{
+    MontgomeryContext context(modulus);
+    auto n = context.limb_count();
+
+    size_t exponent_bits = 0;
+    if (auto exponent_words = exponent.trimmed_length())
+        exponent_bits = exponent_words * 32 - __builtin_clz(exponent.words()[exponent_words - 1]);
+
+    Vector<Limb> result;
+    to_limbs(1, result, n);
+    if (exponent_bits == 0)
+        return from_limbs(result);
+
+    // table[i] holds base^(2i + 1), in Montgomery form.
+    auto window_size = window_size_for(exponent_bits);
+    Vector<Vector<Limb>> table;
+    table.resize(1 << (window_size - 1));
+    to_limbs(base, table[0], n);
+    context.to_montgomery(table[0].data(), table[0].data());
+    if (table.size() > 1) {
+        Vector<Limb> base_squared;
+        base_squared.resize(n);
+        context.multiply(table[0].data(), table[0].data(), base_squared.data());
+        for (size_t i = 1; i < table.size(); ++i) {
+            table[i].resize(n);
+            context.multiply(table[i - 1].data(), base_squared.data(), table[i].data());
+        }
+    }
+
+    // Scan the exponent from the top. Runs of zeros cost a squaring per bit; otherwise the
+    // longest window ending in a set bit is looked up in the table.
+    bool has_result = false;
+    for (ssize_t bit = exponent_bits - 1; bit >= 0;) {
+        if (!exponent_bit(exponent, bit)) {
+            context.multiply(result.data(), result.data(), result.data());
+            --bit;
+            continue;
+        }
+
+        ssize_t low_bit = max<ssize_t>(bit - window_size + 1, 0);
+        while (!exponent_bit(exponent, low_bit))
+            ++low_bit;
+
+        size_t window = 0;
+        for (ssize_t i = bit; i >= low_bit; --i)
+            window = (window << 1) | exponent_bit(exponent, i);
+
+        if (has_result) {
+            for (ssize_t i = bit; i >= low_bit; --i)
+                context.multiply(result.data(), result.data(), result.data());
+            context.multiply(result.data(), table[window >> 1].data(), result.data());
+        } else {
+            result = table[window >> 1];
+            has_result = true;
+        }
+        bit = low_bit - 1;
+    }
+
+    context.from_montgomery(result.data(), result.data());
+    return from_limbs(result);
+}
+
+UnsignedBigInteger ModularPower(const UnsignedBigInteger& b, const UnsignedBigInteger& e, const UnsignedBigInteger& m)
+{
+    if (m == 1)
+        return 0;
+
+    UnsignedBigInteger temp_1;
+    UnsignedBigInteger temp_2;
+    UnsignedBigInteger temp_3;
+    UnsignedBigInteger temp_4;
+    UnsignedBigInteger temp_multiply;
+    UnsignedBigInteger temp_quotient;
+    UnsignedBigInteger temp_remainder;
+
+    UnsignedBigInteger base { b };
+    if (!(base < m)) {
+        UnsignedBigInteger::divide_without_allocation(b, m, temp_1, temp_2, temp_3, temp_4, temp_quotient, temp_remainder);
+        base.set_to(temp_remainder);
+    }
+
+    // Montgomery reduction needs an odd modulus. That covers RSA and the primality tests.
+    if (m.words()[0] % 2 == 1)
+        return montgomery_modular_power(base, e, m);
+
+    UnsignedBigInteger ep { e };
+    UnsignedBigInteger exp { 1 };
+
+    while (!(ep < 1)) {
+#ifdef NT_DEBUG
+        dbg() << ep.to_base10();
+#endif
+        if (ep.words()[0] % 2 == 1) {
+            // exp = (exp * base) % m;
+            UnsignedBigInteger::multiply_without_allocation(exp, base, temp_1, temp_2, temp_3, temp_4, temp_multiply);
+            UnsignedBigInteger::divide_without_allocation(temp_multiply, m, temp_1, temp_2, temp_3, temp_4, temp_quotient, temp_remainder);
+            exp.set_to(temp_remainder);
+        }
+
+        // ep = ep / 2;
+        UnsignedBigInteger::divide_u16_without_allocation(ep, 2, temp_quotient, temp_remainder);
+        ep.set_to(temp_quotient);
+
+        // base = (base * base) % m;
+        UnsignedBigInteger::multiply_without_allocation(base, base, temp_1, temp_2, temp_3, temp_4, temp_multiply);
+        UnsignedBigInteger::divide_without_allocation(temp_multiply, m, temp_1, temp_2, temp_3, temp_4, temp_quotient, temp_remainder);
+        base.set_to(temp_remainder);
+    }
+    return exp;
+}
+
+}
+}
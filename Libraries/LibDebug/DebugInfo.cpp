@@ -37,19 +37,125 @@ DebugInfo::DebugInfo(NonnullRefPtr<const ELF::Loader> elf)
     : m_elf(elf)
     , m_dwarf_info(Dwarf::DwarfInfo::create(m_elf))
 {
-    prepare_variable_scopes();
+    prepare_unit_address_ranges();
     prepare_lines();
 }
 
-void DebugInfo::prepare_variable_scopes()
+void DebugInfo::prepare_unit_address_ranges()
 {
+    HashMap<u32, size_t> unit_indices_by_offset;
     m_dwarf_info->for_each_compilation_unit([&](const Dwarf::CompilationUnit& unit) {
-        auto root = unit.root_die();
-        parse_scopes_impl(root);
+        unit_indices_by_offset.set(unit.offset(), m_unit_scopes.size());
+        m_unit_scopes.append({ &unit, false, {} });
+    });
+
+    // .debug_aranges lists all the address ranges of each unit, including the code
+    // that the compiler put into sections of its own.
+    Vector<bool> unit_has_ranges;
+    unit_has_ranges.resize(m_unit_scopes.size());
+    for (auto& has_ranges : unit_has_ranges)
+        has_ranges = false;
+
+    auto section = m_elf->image().lookup_section(".debug_aranges");
+    if (!section.is_undefined()) {
+        auto buffer = section.wrapping_byte_buffer();
+        InputMemoryStream stream { buffer.span() };
+        while (!stream.eof()) {
+            auto set_offset = stream.offset();
+            u32 length = 0;
+            u16 version = 0;
+            u32 unit_offset = 0;
+            u8 address_size = 0;
+            u8 segment_size = 0;
+            stream >> length >> version >> unit_offset >> address_size >> segment_size;
+            if (stream.handle_error() || address_size != sizeof(u32) || segment_size != 0)
+                break;
+            size_t set_end = set_offset + sizeof(length) + length;
+
+            // The tuples are aligned to twice the address size.
+            constexpr size_t tuple_size = 2 * sizeof(u32);
+            stream.discard_or_error((tuple_size - (stream.offset() - set_offset) % tuple_size) % tuple_size);
+
+            auto unit_index = unit_indices_by_offset.get(unit_offset);
+            while (!stream.error() && stream.offset() + tuple_size <= set_end) {
+                u32 address = 0;
+                u32 range_length = 0;
+                stream >> address >> range_length;
+                if (!address && !range_length)
+                    break;
+                if (unit_index.has_value() && range_length) {
+                    m_sorted_unit_ranges.append({ address, address + range_length, unit_index.value() });
+                    unit_has_ranges[unit_index.value()] = true;
+                }
+            }
+            if (stream.handle_error() || set_end >= buffer.size())
+                break;
+            stream.seek(set_end);
+        }
+    }
+
+    // Otherwise, the root entry of a unit whose code is all in one place has its address range.
+    for (size_t unit_index = 0; unit_index < m_unit_scopes.size(); ++unit_index) {
+        if (unit_has_ranges[unit_index])
+            continue;
+        auto root = m_unit_scopes[unit_index].unit->root_die();
+        auto low_pc = root.get_attribute(Dwarf::Attribute::LowPc);
+        auto high_pc = root.get_attribute(Dwarf::Attribute::HighPc);
+        if (!low_pc.has_value() || !high_pc.has_value() || root.get_attribute(Dwarf::Attribute::Ranges).has_value()) {
+            m_units_without_address_ranges.append(unit_index);
+            continue;
+        }
+        // Like for scopes, HighPc is an offset from LowPc.
+        m_sorted_unit_ranges.append({ low_pc.value().data.as_u32, low_pc.value().data.as_u32 + high_pc.value().data.as_u32, unit_index });
+    }
+
+    quick_sort(m_sorted_unit_ranges, [](auto& a, auto& b) {
+        return a.address_low < b.address_low;
     });
 }
 
-void DebugInfo::parse_scopes_impl(const Dwarf::DIE& die)
+const Vector<DebugInfo::VariablesScope>& DebugInfo::scopes_of_unit(size_t unit_index) const
+{
+    auto& unit_scopes = m_unit_scopes[unit_index];
+    if (!unit_scopes.is_parsed) {
+        parse_scopes_impl(unit_scopes.unit->root_die(), unit_scopes.scopes);
+        unit_scopes.is_parsed = true;
+    }
+    return unit_scopes.scopes;
+}
+
+template<typename Callback>
+void DebugInfo::for_each_scope_containing(u32 address, Callback callback) const
+{
+    // Find the last range starting at or before the address.
+    size_t begin = 0;
+    size_t end = m_sorted_unit_ranges.size();
+    while (begin < end) {
+        size_t middle = begin + (end - begin) / 2;
+        if (m_sorted_unit_ranges[middle].address_low <= address)
+            begin = middle + 1;
+        else
+            end = middle;
+    }
+
+    Vector<size_t, 4> unit_indices;
+    if (begin > 0 && address < m_sorted_unit_ranges[begin - 1].address_high)
+        unit_indices.append(m_sorted_unit_ranges[begin - 1].unit_index);
+    for (auto unit_index : m_units_without_address_ranges)
+        unit_indices.append(unit_index);
+    quick_sort(unit_indices);
+
+    for (auto unit_index : unit_indices) {
+        for (auto& scope : scopes_of_unit(unit_index)) {
+            if (address < scope.address_low || address >= scope.address_high)
+                continue;
+            if (callback(scope) == IterationDecision::Break)
+                return;
+        }
+    }
+}
+
+void DebugInfo::parse_scopes_impl(const Dwarf::DIE& die, Vector<VariablesScope>& scopes) const
 {
     die.for_each_child([&](const Dwarf::DIE& child) {
         if (child.is_null())
@@ -92,9 +198,9 @@ void DebugInfo::parse_scopes_impl(const Dwarf::DIE& die)
                 return;
             scope.dies_of_variables.append(variable_entry);
         });
-        m_scopes.append(scope);
+        scopes.append(scope);
 
-        parse_scopes_impl(child);
+        parse_scopes_impl(child, scopes);
     });
 }
 
@@ -126,49 +232,72 @@ void DebugInfo::prepare_lines()
     quick_sort(m_sorted_lines, [](auto& a, auto& b) {
         return a.address < b.address;
     });
+
+    for (size_t i = 0; i < m_sorted_lines.size(); ++i)
+        m_line_indices_by_file.ensure(m_sorted_lines[i].file).append(i);
+    for (auto& it : m_line_indices_by_file) {
+        quick_sort(it.value, [&](auto a, auto b) {
+            if (m_sorted_lines[a].line != m_sorted_lines[b].line)
+                return m_sorted_lines[a].line < m_sorted_lines[b].line;
+            return a < b;
+        });
+    }
 }
 
 Optional<DebugInfo::SourcePosition> DebugInfo::get_source_position(u32 target_address) const
 {
-    if (m_sorted_lines.is_empty())
-        return {};
-    if (target_address < m_sorted_lines[0].address)
-        return {};
-
-    // TODO: We can do a binray search here
-    for (size_t i = 0; i < m_sorted_lines.size() - 1; ++i) {
-        if (m_sorted_lines[i + 1].address > target_address) {
-            return Optional<SourcePosition>({ m_sorted_lines[i].file, m_sorted_lines[i].line, m_sorted_lines[i].address });
-        }
+    // Find the first line past the address. The line before it is the one the address is in,
+    // unless there is none (the last line only marks the end of the code).
+    size_t begin = 0;
+    size_t end = m_sorted_lines.size();
+    while (begin < end) {
+        size_t middle = begin + (end - begin) / 2;
+        if (m_sorted_lines[middle].address <= target_address)
+            begin = middle + 1;
+        else
+            end = middle;
     }
-    return {};
+    if (begin == 0 || begin == m_sorted_lines.size())
+        return {};
+    auto& line_info = m_sorted_lines[begin - 1];
+    return Optional<SourcePosition>({ line_info.file, line_info.line, line_info.address });
 }
 
 Optional<u32> DebugInfo::get_instruction_from_source(const String& file, size_t line) const
 {
-    for (const auto& line_entry : m_sorted_lines) {
-        if (line_entry.file == file && line_entry.line == line)
-            return Optional<u32>(line_entry.address);
+    auto it = m_line_indices_by_file.find(file);
+    if (it == m_line_indices_by_file.end())
+        return {};
+
+    // The first entry for the line has the lowest address.
+    auto& indices = it->value;
+    size_t begin = 0;
+    size_t end = indices.size();
+    while (begin < end) {
+        size_t middle = begin + (end - begin) / 2;
+        if (m_sorted_lines[indices[middle]].line < line)
+            begin = middle + 1;
+        else
+            end = middle;
     }
-    return {};
+    if (begin == indices.size() || m_sorted_lines[indices[begin]].line != line)
+        return {};
+    return Optional<u32>(m_sorted_lines[indices[begin]].address);
 }
 
 NonnullOwnPtrVector<DebugInfo::VariableInfo> DebugInfo::get_variables_in_current_scope(const PtraceRegisters& regs) const
 {
     NonnullOwnPtrVector<DebugInfo::VariableInfo> variables;
 
-    // TODO: We can store the scopes in a better data strucutre
-    for (const auto& scope : m_scopes) {
-        if (regs.eip < scope.address_low || regs.eip >= scope.address_high)
-            continue;
-
+    for_each_scope_containing(regs.eip, [&](const VariablesScope& scope) {
         for (const auto& die_entry : scope.dies_of_variables) {
             auto variable_info = create_variable_info(die_entry, regs);
             if (!variable_info)
                 continue;
             variables.append(variable_info.release_nonnull());
         }
-    }
+        return IterationDecision::Continue;
+    });
     return variables;
 }
 
@@ -295,10 +424,12 @@ OwnPtr<DebugInfo::VariableInfo> DebugInfo::create_variable_info(const Dwarf::DIE
 
 String DebugInfo::name_of_containing_function(u32 address) const
 {
-    for (const auto& scope : m_scopes) {
-        if (!scope.is_function || address < scope.address_low || address >= scope.address_high)
-            continue;
-        return scope.name;
-    }
-    return {};
+    String name;
+    for_each_scope_containing(address, [&](const VariablesScope& scope) {
+        if (!scope.is_function)
+            return IterationDecision::Continue;
+        name = scope.name;
+        return IterationDecision::Break;
+    });
+    return name;
 }
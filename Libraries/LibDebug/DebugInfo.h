@@ -26,6 +26,7 @@
 
 #pragma once
 
+#include <AK/HashMap.h>
 #include <AK/NonnullOwnPtrVector.h>
 #include <AK/NonnullRefPtr.h>
 #include <AK/Optional.h>
@@ -106,14 +107,36 @@ public:
     String name_of_containing_function(u32 address) const;
 
 private:
-    void prepare_variable_scopes();
+    // The scopes of a compilation unit are only parsed once an address in it is looked up.
+    struct UnitScopes {
+        const Dwarf::CompilationUnit* unit { nullptr };
+        bool is_parsed { false };
+        Vector<VariablesScope> scopes;
+    };
+
+    struct UnitAddressRange {
+        u32 address_low { 0 };
+        u32 address_high { 0 };
+        size_t unit_index { 0 };
+    };
+
+    void prepare_unit_address_ranges();
     void prepare_lines();
-    void parse_scopes_impl(const Dwarf::DIE& die);
+    void parse_scopes_impl(const Dwarf::DIE& die, Vector<VariablesScope>&) const;
+    const Vector<VariablesScope>& scopes_of_unit(size_t unit_index) const;
+    template<typename Callback>
+    void for_each_scope_containing(u32 address, Callback) const;
     OwnPtr<VariableInfo> create_variable_info(const Dwarf::DIE& variable_die, const PtraceRegisters&) const;
 
     NonnullRefPtr<const ELF::Loader> m_elf;
     NonnullRefPtr<Dwarf::DwarfInfo> m_dwarf_info;
 
-    Vector<VariablesScope> m_scopes;
+    mutable Vector<UnitScopes> m_unit_scopes;
+    Vector<UnitAddressRange> m_sorted_unit_ranges;
+    // Units we don't know the addresses of, which have to be looked at for every address.
+    Vector<size_t> m_units_without_address_ranges;
+
     Vector<LineProgram::LineInfo> m_sorted_lines;
+    // The indices into m_sorted_lines of each file's lines, sorted by line number.
+    HashMap<String, Vector<size_t>> m_line_indices_by_file;
 };
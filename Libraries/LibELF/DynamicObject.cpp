@@ -89,6 +89,12 @@ void DynamicObject::parse()
             m_fini_array_size = entry.val();
             break;
         case DT_HASH:
+            // Prefer DT_GNU_HASH when the object has both.
+            if (m_hash_type != HashType::GNU)
+                m_hash_table_offset = entry.ptr();
+            break;
+        case DT_GNU_HASH:
+            m_hash_type = HashType::GNU;
             m_hash_table_offset = entry.ptr();
             break;
         case DT_SYMTAB:
@@ -151,9 +157,7 @@ void DynamicObject::parse()
         return IterationDecision::Continue;
     });
 
-    auto hash_section_address = hash_section().address().as_ptr();
-    auto num_hash_chains = ((u32*)hash_section_address)[1];
-    m_symbol_count = num_hash_chains;
+    m_symbol_count = hash_section().symbol_count();
 }
 
 const DynamicObject::Relocation DynamicObject::RelocationSection::relocation(unsigned index) const
@@ -200,7 +204,8 @@ const DynamicObject::Section DynamicObject::fini_array_section() const
 
 const DynamicObject::HashSection DynamicObject::hash_section() const
 {
-    return HashSection(Section(*this, m_hash_table_offset, 0, 0, "DT_HASH"), HashType::SYSV);
+    const char* section_name = m_hash_type == HashType::SYSV ? "DT_HASH" : "DT_GNU_HASH";
+    return HashSection(Section(*this, m_hash_table_offset, 0, 0, section_name), m_hash_type);
 }
 
 const DynamicObject::RelocationSection DynamicObject::relocation_section() const
@@ -213,7 +218,7 @@ const DynamicObject::RelocationSection DynamicObject::plt_relocation_section() c
     return RelocationSection(Section(*this, m_plt_relocation_offset_location, m_size_of_plt_relocation_entry_list, m_size_of_relocation_entry, "DT_JMPREL"));
 }
 
-u32 DynamicObject::HashSection::calculate_elf_hash(const char* name) const
+u32 DynamicObject::HashSection::calculate_elf_hash(const char* name)
 {
     // SYSV ELF hash algorithm
     // Note that the GNU HASH algorithm has less collisions
@@ -235,17 +240,27 @@ u32 DynamicObject::HashSection::calculate_elf_hash(const char* name) const
     return hash;
 }
 
-u32 DynamicObject::HashSection::calculate_gnu_hash(const char*) const
+u32 DynamicObject::HashSection::calculate_gnu_hash(const char* name)
 {
-    // FIXME: Implement the GNU hash algorithm
-    ASSERT_NOT_REACHED();
+    // GNU ELF hash algorithm (Bernstein's djb2 hash)
+    u32 hash = 5381;
+
+    for (; *name != '\0'; ++name)
+        hash = hash * 33 + (u8)*name;
+
+    return hash;
 }
 
 const DynamicObject::Symbol DynamicObject::HashSection::lookup_symbol(const char* name) const
 {
-    // FIXME: If we enable gnu hash in the compiler, we should use that here instead
-    //     The algo is way better with less collisions
-    u32 hash_value = (this->*(m_hash_function))(name);
+    if (m_hash_type == HashType::GNU)
+        return lookup_gnu_symbol(name);
+    return lookup_elf_symbol(name);
+}
+
+const DynamicObject::Symbol DynamicObject::HashSection::lookup_elf_symbol(const char* name) const
+{
+    u32 hash_value = calculate_elf_hash(name);
 
     u32* hash_table_begin = (u32*)address().as_ptr();
 
@@ -271,6 +286,90 @@ const DynamicObject::Symbol DynamicObject::HashSection::lookup_symbol(const char
     return m_dynamic.the_undefined_symbol();
 }
 
+// The DT_GNU_HASH table layout is:
+//     u32 num_buckets, u32 symbol_offset, u32 bloom_size, u32 bloom_shift,
+//     FlatPtr bloom[bloom_size], u32 buckets[num_buckets], u32 chains[]
+// Only symbols from symbol_offset onwards are hashed, sorted by bucket. Each chain entry holds the
+// symbol's hash with the lowest bit repurposed as an end-of-chain marker.
+const DynamicObject::Symbol DynamicObject::HashSection::lookup_gnu_symbol(const char* name) const
+{
+    const u32* hash_table_begin = (const u32*)address().as_ptr();
+
+    const u32 num_buckets = hash_table_begin[0];
+    const u32 symbol_offset = hash_table_begin[1];
+    const u32 bloom_size = hash_table_begin[2];
+    const u32 bloom_shift = hash_table_begin[3];
+
+    const FlatPtr* bloom_words = (const FlatPtr*)&hash_table_begin[4];
+    const u32* buckets = (const u32*)&bloom_words[bloom_size];
+    const u32* chains = &buckets[num_buckets];
+
+    if (num_buckets == 0 || bloom_size == 0)
+        return m_dynamic.the_undefined_symbol();
+
+    constexpr u32 bloom_word_size = sizeof(FlatPtr) * 8;
+
+    u32 hash_value = calculate_gnu_hash(name);
+
+    // The bloom filter lets us reject most misses without touching the buckets or the string table.
+    FlatPtr bloom_word = bloom_words[(hash_value / bloom_word_size) % bloom_size];
+    FlatPtr bloom_mask = ((FlatPtr)1 << (hash_value % bloom_word_size)) | ((FlatPtr)1 << ((hash_value >> bloom_shift) % bloom_word_size));
+    if ((bloom_word & bloom_mask) != bloom_mask)
+        return m_dynamic.the_undefined_symbol();
+
+    u32 i = buckets[hash_value % num_buckets];
+    if (i < symbol_offset)
+        return m_dynamic.the_undefined_symbol();
+
+    for (;; ++i) {
+        u32 chain_hash = chains[i - symbol_offset];
+        if ((hash_value | 1) == (chain_hash | 1)) {
+            auto symbol = m_dynamic.symbol(i);
+            if (strcmp(name, symbol.name()) == 0) {
+#ifdef DYNAMIC_LOAD_DEBUG
+                dbgprintf("Returning dynamic symbol with index %d for %s: %p\n", i, symbol.name(), symbol.address());
+#endif
+                return symbol;
+            }
+        }
+        if (chain_hash & 1)
+            break;
+    }
+    return m_dynamic.the_undefined_symbol();
+}
+
+unsigned DynamicObject::HashSection::symbol_count() const
+{
+    const u32* hash_table_begin = (const u32*)address().as_ptr();
+
+    if (m_hash_type == HashType::SYSV) {
+        // num_chains is required to be the number of symbols.
+        return hash_table_begin[1];
+    }
+
+    // DT_GNU_HASH doesn't store the symbol count, so find the end of the last chain.
+    const u32 num_buckets = hash_table_begin[0];
+    const u32 symbol_offset = hash_table_begin[1];
+    const u32 bloom_size = hash_table_begin[2];
+
+    const FlatPtr* bloom_words = (const FlatPtr*)&hash_table_begin[4];
+    const u32* buckets = (const u32*)&bloom_words[bloom_size];
+    const u32* chains = &buckets[num_buckets];
+
+    u32 last_symbol = 0;
+    for (u32 i = 0; i < num_buckets; ++i) {
+        if (buckets[i] > last_symbol)
+            last_symbol = buckets[i];
+    }
+    if (last_symbol < symbol_offset)
+        return symbol_offset;
+
+    while (!(chains[last_symbol - symbol_offset] & 1))
+        ++last_symbol;
+
+    return last_symbol + 1;
+}
+
 const char* DynamicObject::symbol_string_table_string(Elf32_Word index) const
 {
     return (const char*)base_address().offset(m_string_table_offset + index).as_ptr();
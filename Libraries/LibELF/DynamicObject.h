@@ -164,28 +164,25 @@ public:
     public:
         HashSection(const Section& section, HashType hash_type = HashType::SYSV)
             : Section(section.m_dynamic, section.m_section_offset, section.m_section_size_bytes, section.m_entry_size, section.m_name)
+            , m_hash_type(hash_type)
         {
-            switch (hash_type) {
-            case HashType::SYSV:
-                m_hash_function = &HashSection::calculate_elf_hash;
-                break;
-            case HashType::GNU:
-                m_hash_function = &HashSection::calculate_gnu_hash;
-                break;
-            default:
-                ASSERT_NOT_REACHED();
-                break;
-            }
         }
 
+        HashType hash_type() const { return m_hash_type; }
+
         const Symbol lookup_symbol(const char*) const;
 
+        // Number of entries in the dynamic symbol table, as implied by the hash table.
+        unsigned symbol_count() const;
+
     private:
-        u32 calculate_elf_hash(const char* name) const;
-        u32 calculate_gnu_hash(const char* name) const;
+        static u32 calculate_elf_hash(const char* name);
+        static u32 calculate_gnu_hash(const char* name);
+
+        const Symbol lookup_elf_symbol(const char*) const;
+        const Symbol lookup_gnu_symbol(const char*) const;
 
-        typedef u32 (HashSection::*HashFunction)(const char*) const;
-        HashFunction m_hash_function;
+        HashType m_hash_type;
     };
 
     unsigned symbol_count() const { return m_symbol_count; }
@@ -241,6 +238,7 @@ private:
     size_t m_fini_array_size { 0 };
 
     FlatPtr m_hash_table_offset { 0 };
+    HashType m_hash_type { HashType::SYSV };
 
     FlatPtr m_string_table_offset { 0 };
     size_t m_size_of_string_table { 0 };
@@ -156,6 +156,20 @@ Optional<Image::Symbol> Loader::find_demangled_function(const String& name) cons
     return found;
 }
 
+size_t Loader::index_of_first_symbol_after(const SortedSymbol* sorted_symbols, u32 address) const
+{
+    size_t low = 0;
+    size_t high = m_symbol_count;
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        if (sorted_symbols[middle].address > address)
+            high = middle;
+        else
+            low = middle + 1;
+    }
+    return low;
+}
+
 #ifndef KERNEL
 Optional<Image::Symbol> Loader::find_symbol(u32 address, u32* out_offset) const
 {
@@ -192,17 +206,13 @@ Optional<Image::Symbol> Loader::find_symbol(u32 address, u32* out_offset) const
     sorted_symbols = m_sorted_symbols.data();
 #    endif
 
-    for (size_t i = 0; i < m_symbol_count; ++i) {
-        if (sorted_symbols[i].address > address) {
-            if (i == 0)
-                return {};
-            auto& symbol = sorted_symbols[i - 1];
-            if (out_offset)
-                *out_offset = address - symbol.address;
-            return symbol.symbol;
-        }
-    }
-    return {};
+    size_t index = index_of_first_symbol_after(sorted_symbols, address);
+    if (index == 0 || index == m_symbol_count)
+        return {};
+    auto& symbol = sorted_symbols[index - 1];
+    if (out_offset)
+        *out_offset = address - symbol.address;
+    return symbol.symbol;
 }
 #endif
 
@@ -243,29 +253,28 @@ String Loader::symbolicate(u32 address, u32* out_offset) const
     sorted_symbols = m_sorted_symbols.data();
 #endif
 
-    for (size_t i = 0; i < m_symbol_count; ++i) {
-        if (sorted_symbols[i].address > address) {
-            if (i == 0) {
-                if (out_offset)
-                    *out_offset = 0;
-                return "!!";
-            }
-            auto& symbol = sorted_symbols[i - 1];
+    size_t index = index_of_first_symbol_after(sorted_symbols, address);
+    if (index == 0) {
+        if (out_offset)
+            *out_offset = 0;
+        return "!!";
+    }
+    if (index < m_symbol_count) {
+        auto& symbol = sorted_symbols[index - 1];
 
 #ifdef KERNEL
-            auto demangled_name = demangle(symbol.name);
+        auto demangled_name = demangle(symbol.name);
 #else
-            auto& demangled_name = symbol.demangled_name;
-            if (demangled_name.is_null())
-                demangled_name = demangle(symbol.name);
+        auto& demangled_name = symbol.demangled_name;
+        if (demangled_name.is_null())
+            demangled_name = demangle(symbol.name);
 #endif
 
-            if (out_offset) {
-                *out_offset = address - symbol.address;
-                return demangled_name;
-            }
-            return String::format("%s +%u", demangled_name.characters(), address - symbol.address);
+        if (out_offset) {
+            *out_offset = address - symbol.address;
+            return demangled_name;
         }
+        return String::format("%s +%u", demangled_name.characters(), address - symbol.address);
     }
     if (out_offset)
         *out_offset = 0;
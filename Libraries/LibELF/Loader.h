@@ -83,6 +83,9 @@ private:
         Optional<Image::Symbol> symbol;
 #endif
     };
+    // Binary search for the first of the (address-sorted) symbols that starts past the address.
+    size_t index_of_first_symbol_after(const SortedSymbol*, u32 address) const;
+
 #ifdef KERNEL
     mutable OwnPtr<Kernel::Region> m_sorted_symbols_region;
 #else
@@ -57,6 +57,8 @@ void AbstractTableView::select_all()
     }
 }
 
+// Only the rows in view are measured, so that updating a model with a huge number of rows stays cheap.
+// Since columns never shrink here, they grow to fit other rows as those are scrolled into view.
 void AbstractTableView::update_column_sizes()
 {
     if (!model())
@@ -64,7 +66,8 @@ void AbstractTableView::update_column_sizes()
 
     auto& model = *this->model();
     int column_count = model.column_count();
-    int row_count = model.row_count();
+    int first_row = first_visible_row();
+    int last_row = last_visible_row();
     int key_column = model.key_column();
 
     for (int column = 0; column < column_count; ++column) {
@@ -74,7 +77,7 @@ void AbstractTableView::update_column_sizes()
         if (column == key_column && model.is_column_sortable(column))
             header_width += font().width(" \xE2\xAC\x86"); // UPWARDS BLACK ARROW
         int column_width = header_width;
-        for (int row = 0; row < row_count; ++row) {
+        for (int row = first_row; row <= last_row; ++row) {
             auto cell_data = model.data(model.index(row, column));
             int cell_width = 0;
             if (cell_data.is_icon()) {
@@ -92,6 +95,19 @@ void AbstractTableView::update_column_sizes()
     }
 }
 
+int AbstractTableView::first_visible_row() const
+{
+    return vertical_scrollbar().value() / item_height();
+}
+
+int AbstractTableView::last_visible_row() const
+{
+    int visible_height = available_size().height();
+    if (visible_height <= 0)
+        return first_visible_row() - 1;
+    return min(item_count() - 1, (vertical_scrollbar().value() + visible_height - 1) / item_height());
+}
+
 void AbstractTableView::update_content_size()
 {
     if (!model())
@@ -112,6 +112,10 @@ protected:
     virtual void update_column_sizes();
     virtual int item_count() const;
 
+    // The rows that are at least partly scrolled into view, or an empty range if there are none.
+    int first_visible_row() const;
+    int last_visible_row() const;
+
 private:
     bool m_headers_visible { true };
     bool m_in_column_resize { false };
@@ -69,8 +69,9 @@ static bool is_valid_nonfirst_character_of_identifier(char ch)
 
 static bool is_keyword(const StringView& string)
 {
-    static HashTable<String> keywords;
-    if (keywords.is_empty()) {
+    // Built by a static initializer, so that it's safe to lex on more than one thread at once.
+    static auto keywords = [] {
+        HashTable<String> keywords;
         keywords.set("alignas");
         keywords.set("alignof");
         keywords.set("and");
@@ -145,14 +146,15 @@ static bool is_keyword(const StringView& string)
         keywords.set("while");
         keywords.set("xor");
         keywords.set("xor_eq");
-    }
+        return keywords;
+    }();
     return keywords.contains(string);
 }
 
 static bool is_known_type(const StringView& string)
 {
-    static HashTable<String> types;
-    if (types.is_empty()) {
+    static auto types = [] {
+        HashTable<String> types;
         types.set("ByteBuffer");
         types.set("CircularDeque");
         types.set("CircularQueue");
@@ -211,13 +213,28 @@ static bool is_known_type(const StringView& string)
         types.set("unsigned");
         types.set("void");
         types.set("wchar_t");
-    }
+        return types;
+    }();
     return types.contains(string);
 }
 
 Vector<CppToken> CppLexer::lex()
 {
     Vector<CppToken> tokens;
+    lex([&](auto& token) {
+        tokens.append(token);
+        return IterationDecision::Continue;
+    });
+    return tokens;
+}
+
+void CppLexer::lex(Function<IterationDecision(const CppToken&)> callback)
+{
+    bool stopped = false;
+    auto add_token = [&](const CppToken& token) {
+        if (!stopped && callback(token) == IterationDecision::Break)
+            stopped = true;
+    };
 
     size_t token_start_index = 0;
     CppPosition token_start_position;
@@ -227,7 +244,7 @@ Vector<CppToken> CppLexer::lex()
         token.m_type = type;
         token.m_start = m_position;
         token.m_end = m_position;
-        tokens.append(token);
+        add_token(token);
         consume();
     };
 
@@ -240,7 +257,7 @@ Vector<CppToken> CppLexer::lex()
         token.m_type = type;
         token.m_start = token_start_position;
         token.m_end = m_previous_position;
-        tokens.append(token);
+        add_token(token);
     };
 
     auto emit_token_equals = [&](auto type, auto equals_type) {
@@ -324,7 +341,7 @@ Vector<CppToken> CppLexer::lex()
         return 0;
     };
 
-    while (m_index < m_input.length()) {
+    while (!stopped && m_index < m_input.length()) {
         auto ch = peek();
         if (isspace(ch)) {
             begin_token();
@@ -774,7 +791,6 @@ Vector<CppToken> CppLexer::lex()
         dbg() << "Unimplemented token character: " << ch;
         emit_token(CppToken::Type::Unknown);
     }
-    return tokens;
 }
 
 }
@@ -26,6 +26,8 @@
 
 #pragma once
 
+#include <AK/Function.h>
+#include <AK/IterationDecision.h>
 #include <AK/StringView.h>
 #include <AK/Vector.h>
 
@@ -132,6 +134,7 @@ public:
     CppLexer(const StringView&);
 
     Vector<CppToken> lex();
+    void lex(Function<IterationDecision(const CppToken&)>);
 
 private:
     char peek(size_t offset = 0) const;
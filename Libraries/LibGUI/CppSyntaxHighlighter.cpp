@@ -74,15 +74,10 @@ bool CppSyntaxHighlighter::is_navigatable(void* token) const
     return cpp_token == GUI::CppToken::Type::IncludePath;
 }
 
-void CppSyntaxHighlighter::rehighlight(Gfx::Palette palette)
+void CppSyntaxHighlighter::highlight_text(const StringView& text, const Gfx::Palette& palette, SpanCallback& callback)
 {
-    ASSERT(m_editor);
-    auto text = m_editor->text();
     CppLexer lexer(text);
-    auto tokens = lexer.lex();
-
-    Vector<GUI::TextDocumentSpan> spans;
-    for (auto& token : tokens) {
+    lexer.lex([&](auto& token) {
 #ifdef DEBUG_SYNTAX_HIGHLIGHTING
         dbg() << token.to_string() << " @ " << token.m_start.line << ":" << token.m_start.column << " - " << token.m_end.line << ":" << token.m_end.column;
 #endif
@@ -94,14 +89,8 @@ void CppSyntaxHighlighter::rehighlight(Gfx::Palette palette)
         span.font = style.font;
         span.is_skippable = token.m_type == CppToken::Type::Whitespace;
         span.data = reinterpret_cast<void*>(token.m_type);
-        spans.append(span);
-    }
-    m_editor->document().set_spans(spans);
-
-    m_has_brace_buddies = false;
-    highlight_matching_token_pair();
-
-    m_editor->update();
+        return callback(span);
+    });
 }
 
 Vector<SyntaxHighlighter::MatchingTokenPair> CppSyntaxHighlighter::matching_token_pairs() const
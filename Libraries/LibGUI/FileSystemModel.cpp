@@ -25,6 +25,7 @@
  */
 
 #include <AK/LexicalPath.h>
+#include <AK/MappedFile.h>
 #include <AK/QuickSort.h>
 #include <AK/StringBuilder.h>
 #include <LibCore/DirIterator.h>
@@ -34,6 +35,7 @@
 #include <LibGUI/FileSystemModel.h>
 #include <LibGUI/Painter.h>
 #include <LibGfx/Bitmap.h>
+#include <LibGfx/ImageDecoder.h>
 #include <LibThread/BackgroundAction.h>
 #include <dirent.h>
 #include <grp.h>
@@ -132,7 +134,8 @@ void FileSystemModel::Node::traverse_if_needed(const FileSystemModel& model)
     dbg() << "Watching " << full_path << " for changes, m_watch_fd = " << m_watch_fd;
     m_notifier = Core::Notifier::construct(m_watch_fd, Core::Notifier::Event::Read);
     m_notifier->on_ready_to_read = [this, &model] {
-        char buffer[32];
+        // The kernel hands us every pending event at once, so a burst of changes costs one refresh.
+        char buffer[4096];
         int rc = read(m_notifier->fd(), buffer, sizeof(buffer));
         ASSERT(rc >= 0);
 
@@ -470,18 +473,25 @@ static HashMap<String, RefPtr<Gfx::Bitmap>> s_thumbnail_cache;
 
 static RefPtr<Gfx::Bitmap> render_thumbnail(const StringView& path)
 {
-    auto png_bitmap = Gfx::Bitmap::load_from_file(path);
-    if (!png_bitmap)
+    MappedFile mapped_file(path);
+    if (!mapped_file.is_valid())
         return nullptr;
 
-    double scale = min(32 / (double)png_bitmap->width(), 32 / (double)png_bitmap->height());
+    // Decoders that can scale while decoding (like JPEG's) only produce as many pixels as the thumbnail needs.
+    auto decoder = Gfx::ImageDecoder::create(static_cast<const u8*>(mapped_file.data()), mapped_file.size());
+    decoder->set_desired_size({ 32, 32 });
+    auto bitmap = decoder->bitmap();
+    if (!bitmap)
+        return nullptr;
+
+    double scale = min(32 / (double)bitmap->width(), 32 / (double)bitmap->height());
 
-    auto thumbnail = Gfx::Bitmap::create(png_bitmap->format(), { 32, 32 });
-    Gfx::IntRect destination = Gfx::IntRect(0, 0, (int)(png_bitmap->width() * scale), (int)(png_bitmap->height() * scale));
+    auto thumbnail = Gfx::Bitmap::create(bitmap->format(), { 32, 32 });
+    Gfx::IntRect destination = Gfx::IntRect(0, 0, (int)(bitmap->width() * scale), (int)(bitmap->height() * scale));
     destination.center_within(thumbnail->rect());
 
     Painter painter(*thumbnail);
-    painter.draw_scaled_bitmap(destination, *png_bitmap, png_bitmap->rect());
+    painter.draw_scaled_bitmap(destination, *bitmap, bitmap->rect());
     return thumbnail;
 }
 
@@ -59,6 +59,20 @@ char IniLexer::consume()
 Vector<IniToken> IniLexer::lex()
 {
     Vector<IniToken> tokens;
+    lex([&](auto& token) {
+        tokens.append(token);
+        return IterationDecision::Continue;
+    });
+    return tokens;
+}
+
+void IniLexer::lex(Function<IterationDecision(const IniToken&)> callback)
+{
+    bool stopped = false;
+    auto add_token = [&](const IniToken& token) {
+        if (!stopped && callback(token) == IterationDecision::Break)
+            stopped = true;
+    };
 
     size_t token_start_index = 0;
     IniPosition token_start_position;
@@ -68,7 +82,7 @@ Vector<IniToken> IniLexer::lex()
         token.m_type = type;
         token.m_start = m_position;
         token.m_end = m_position;
-        tokens.append(token);
+        add_token(token);
         consume();
     };
 
@@ -82,10 +96,10 @@ Vector<IniToken> IniLexer::lex()
         token.m_type = type;
         token.m_start = token_start_position;
         token.m_end = m_previous_position;
-        tokens.append(token);
+        add_token(token);
     };
 
-    while (m_index < m_input.length()) {
+    while (!stopped && m_index < m_input.length()) {
         auto ch = peek();
 
         if (isspace(ch)) {
@@ -154,7 +168,6 @@ Vector<IniToken> IniLexer::lex()
             commit_token(IniToken::Type::Value);
         }
     }
-    return tokens;
 }
 
 }
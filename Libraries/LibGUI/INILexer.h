@@ -26,7 +26,10 @@
 
 #pragma once
 
+#include <AK/Function.h>
+#include <AK/IterationDecision.h>
 #include <AK/StringView.h>
+#include <AK/Vector.h>
 
 namespace GUI {
 
@@ -75,6 +78,7 @@ public:
     IniLexer(const StringView&);
 
     Vector<IniToken> lex();
+    void lex(Function<IterationDecision(const IniToken&)>);
 
 private:
     char peek(size_t offset = 0) const;
@@ -58,15 +58,10 @@ bool IniSyntaxHighlighter::is_identifier(void* token) const
     return ini_token == GUI::IniToken::Type::Name;
 }
 
-void IniSyntaxHighlighter::rehighlight(Gfx::Palette palette)
+void IniSyntaxHighlighter::highlight_text(const StringView& text, const Gfx::Palette& palette, SpanCallback& callback)
 {
-    ASSERT(m_editor);
-    auto text = m_editor->text();
     IniLexer lexer(text);
-    auto tokens = lexer.lex();
-
-    Vector<GUI::TextDocumentSpan> spans;
-    for (auto& token : tokens) {
+    lexer.lex([&](auto& token) {
         GUI::TextDocumentSpan span;
         span.range.set_start({ token.m_start.line, token.m_start.column });
         span.range.set_end({ token.m_end.line, token.m_end.column });
@@ -75,14 +70,8 @@ void IniSyntaxHighlighter::rehighlight(Gfx::Palette palette)
         span.font = style.font;
         span.is_skippable = token.m_type == IniToken::Type::Whitespace;
         span.data = reinterpret_cast<void*>(token.m_type);
-        spans.append(span);
-    }
-    m_editor->document().set_spans(spans);
-
-    m_has_brace_buddies = false;
-    highlight_matching_token_pair();
-
-    m_editor->update();
+        return callback(span);
+    });
 }
 
 Vector<IniSyntaxHighlighter::MatchingTokenPair> IniSyntaxHighlighter::matching_token_pairs() const
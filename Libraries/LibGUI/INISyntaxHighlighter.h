@@ -38,11 +38,14 @@ public:
     virtual bool is_identifier(void*) const override;
 
     virtual SyntaxLanguage language() const override { return SyntaxLanguage::INI; }
-    virtual void rehighlight(Gfx::Palette) override;
 
 protected:
+    virtual HighlightFunction highlight_function() const override { return highlight_text; }
     virtual Vector<MatchingTokenPair> matching_token_pairs() const override;
     virtual bool token_types_equal(void*, void*) const override;
+
+private:
+    static void highlight_text(const StringView&, const Gfx::Palette&, SpanCallback&);
 };
 
 }
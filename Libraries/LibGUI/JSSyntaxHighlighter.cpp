@@ -155,14 +155,18 @@ bool JSSyntaxHighlighter::is_navigatable(void* token) const
     return false;
 }
 
-void JSSyntaxHighlighter::rehighlight(Gfx::Palette palette)
+bool JSSyntaxHighlighter::can_restart_after_token(void* token) const
 {
-    ASSERT(m_editor);
-    auto text = m_editor->text();
+    // A fresh lexer reads a slash as the start of a regex, which is only right after these.
+    auto js_token = static_cast<JS::TokenType>(reinterpret_cast<size_t>(token));
+    return js_token == JS::TokenType::Semicolon || js_token == JS::TokenType::CurlyOpen;
+}
 
+void JSSyntaxHighlighter::highlight_text(const StringView& text, const Gfx::Palette& palette, SpanCallback& callback)
+{
     JS::Lexer lexer(text);
 
-    Vector<GUI::TextDocumentSpan> spans;
+    bool stopped = false;
     GUI::TextPosition position { 0, 0 };
     GUI::TextPosition start { 0, 0 };
 
@@ -175,7 +179,7 @@ void JSSyntaxHighlighter::rehighlight(Gfx::Palette palette)
     };
 
     auto append_token = [&](StringView str, const JS::Token& token, bool is_trivia) {
-        if (str.is_empty())
+        if (str.is_empty() || stopped)
             return;
 
         start = position;
@@ -191,7 +195,8 @@ void JSSyntaxHighlighter::rehighlight(Gfx::Palette palette)
         span.font = style.font;
         span.is_skippable = is_trivia;
         span.data = reinterpret_cast<void*>(static_cast<size_t>(type));
-        spans.append(span);
+        if (callback(span) == IterationDecision::Break)
+            stopped = true;
         advance_position(str[str.length() - 1]);
 
 #ifdef DEBUG_SYNTAX_HIGHLIGHTING
@@ -202,20 +207,13 @@ void JSSyntaxHighlighter::rehighlight(Gfx::Palette palette)
     };
 
     bool was_eof = false;
-    for (auto token = lexer.next(); !was_eof; token = lexer.next()) {
+    for (auto token = lexer.next(); !was_eof && !stopped; token = lexer.next()) {
         append_token(token.trivia(), token, true);
         append_token(token.value(), token, false);
 
         if (token.type() == JS::TokenType::Eof)
             was_eof = true;
     }
-
-    m_editor->document().set_spans(spans);
-
-    m_has_brace_buddies = false;
-    highlight_matching_token_pair();
-
-    m_editor->update();
 }
 
 Vector<SyntaxHighlighter::MatchingTokenPair> JSSyntaxHighlighter::matching_token_pairs() const
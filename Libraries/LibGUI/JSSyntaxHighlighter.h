@@ -39,11 +39,15 @@ public:
     virtual bool is_navigatable(void*) const override;
 
     virtual SyntaxLanguage language() const override { return SyntaxLanguage::JavaScript; }
-    virtual void rehighlight(Gfx::Palette) override;
 
 protected:
+    virtual HighlightFunction highlight_function() const override { return highlight_text; }
+    virtual bool can_restart_after_token(void*) const override;
     virtual Vector<MatchingTokenPair> matching_token_pairs() const override;
     virtual bool token_types_equal(void*, void*) const override;
+
+private:
+    static void highlight_text(const StringView&, const Gfx::Palette&, SpanCallback&);
 };
 
 }
@@ -24,8 +24,9 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
-#include <AK/TemporaryChange.h>
+#include <AK/FixedArray.h>
 #include <AK/QuickSort.h>
+#include <AK/TemporaryChange.h>
 #include <LibGUI/AbstractView.h>
 #include <LibGUI/SortingProxyModel.h>
 #include <stdio.h>
@@ -109,46 +110,98 @@ void SortingProxyModel::set_key_column_and_sort_order(int column, SortOrder sort
     resort();
 }
 
+Variant SortingProxyModel::sort_key(int target_row) const
+{
+    auto data = target().data(target().index(target_row, m_key_column), m_sort_role);
+    if (data.is_string() && !m_sorting_case_sensitive)
+        return Variant(data.as_string().to_lowercase());
+    return Variant(data);
+}
+
+// Usually only a few rows change between updates, so the previous order is a good start. The rows that are
+// still in order are kept, and only the ones that moved are sorted and then merged back in. If too many rows
+// moved, it's cheaper to sort everything over again.
 void SortingProxyModel::resort(unsigned flags)
 {
     TemporaryChange change(m_sorting, true);
-    auto old_row_mappings = m_row_mappings;
+    auto old_row_mappings = move(m_row_mappings);
     int row_count = target().row_count();
-    m_row_mappings.resize(row_count);
-    for (int i = 0; i < row_count; ++i)
-        m_row_mappings[i] = i;
     if (m_key_column == -1) {
+        m_row_mappings.resize(row_count);
+        for (int i = 0; i < row_count; ++i)
+            m_row_mappings[i] = i;
         did_update(flags);
         return;
     }
-    quick_sort(m_row_mappings, [&](auto row1, auto row2) -> bool {
-        auto data1 = target().data(target().index(row1, m_key_column), m_sort_role);
-        auto data2 = target().data(target().index(row2, m_key_column), m_sort_role);
-        if (data1 == data2)
-            return 0;
-        bool is_less_than;
-        if (data1.is_string() && data2.is_string() && !m_sorting_case_sensitive)
-            is_less_than = data1.as_string().to_lowercase() < data2.as_string().to_lowercase();
-        else
-            is_less_than = data1 < data2;
-        return m_sort_order == SortOrder::Ascending ? is_less_than : !is_less_than;
-    });
+
+    // Looking up and lowercasing the keys is much more expensive than comparing them, so do it once per row.
+    FixedArray<Variant> keys(row_count);
+    for (int row = 0; row < row_count; ++row)
+        keys[row] = sort_key(row);
+    auto is_less_than = [&](int row1, int row2) {
+        if (m_sort_order == SortOrder::Ascending)
+            return keys[row1] < keys[row2];
+        return keys[row2] < keys[row1];
+    };
+
+    Vector<int> kept_rows;
+    Vector<int> moved_rows;
+    kept_rows.ensure_capacity(row_count);
+    for (auto row : old_row_mappings) {
+        if (row >= row_count)
+            continue;
+        if (kept_rows.is_empty() || !is_less_than(row, kept_rows.last())) {
+            kept_rows.unchecked_append(row);
+            continue;
+        }
+        // If only the last kept row is out of place, move that one instead.
+        if (kept_rows.size() >= 2 && !is_less_than(row, kept_rows[kept_rows.size() - 2])) {
+            moved_rows.append(kept_rows.take_last());
+            kept_rows.unchecked_append(row);
+            continue;
+        }
+        moved_rows.append(row);
+    }
+    for (int row = old_row_mappings.size(); row < row_count; ++row)
+        moved_rows.append(row);
+
+    if (moved_rows.size() > static_cast<size_t>(row_count) / 4) {
+        for (auto row : moved_rows)
+            kept_rows.unchecked_append(row);
+        quick_sort(kept_rows, is_less_than);
+        m_row_mappings = move(kept_rows);
+    } else {
+        quick_sort(moved_rows, is_less_than);
+        m_row_mappings.ensure_capacity(row_count);
+        size_t kept_index = 0;
+        size_t moved_index = 0;
+        while (kept_index < kept_rows.size() || moved_index < moved_rows.size()) {
+            if (moved_index == moved_rows.size() || (kept_index < kept_rows.size() && !is_less_than(moved_rows[moved_index], kept_rows[kept_index])))
+                m_row_mappings.unchecked_append(kept_rows[kept_index++]);
+            else
+                m_row_mappings.unchecked_append(moved_rows[moved_index++]);
+        }
+    }
+
+    Vector<int> proxy_rows_by_target_row;
+    proxy_rows_by_target_row.resize(row_count);
+    for (size_t i = 0; i < m_row_mappings.size(); ++i)
+        proxy_rows_by_target_row[m_row_mappings[i]] = i;
+
     for_each_view([&](AbstractView& view) {
         view.selection().change_from_model({}, [&](ModelSelection& selection) {
-            Vector<ModelIndex> selected_indexes_in_target;
+            Vector<ModelIndex> selected_indexes;
             selection.for_each_index([&](const ModelIndex& index) {
-                selected_indexes_in_target.append(target().index(old_row_mappings[index.row()], index.column()));
+                if (static_cast<size_t>(index.row()) >= old_row_mappings.size())
+                    return;
+                int target_row = old_row_mappings[index.row()];
+                if (target_row < row_count)
+                    selected_indexes.append(this->index(proxy_rows_by_target_row[target_row], index.column()));
             });
 
             selection.clear();
-            for (auto& index : selected_indexes_in_target) {
-                for (size_t i = 0; i < m_row_mappings.size(); ++i) {
-                    if (m_row_mappings[i] == index.row()) {
-                        selection.add(this->index(i, index.column()));
-                        continue;
-                    }
-                }
-            }
+            for (auto& index : selected_indexes)
+                selection.add(index);
         });
     });
     did_update(flags);
@@ -62,6 +62,7 @@ private:
     const Model& target() const { return *m_target; }
 
     void resort(unsigned flags = Model::UpdateFlag::DontInvalidateIndexes);
+    Variant sort_key(int target_row) const;
 
     void set_sorting_case_sensitive(bool b) { m_sorting_case_sensitive = b; }
     bool is_sorting_case_sensitive() { return m_sorting_case_sensitive; }
@@ -24,13 +24,271 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <AK/HashFunctions.h>
+#include <AK/StringBuilder.h>
 #include <LibGUI/SyntaxHighlighter.h>
 #include <LibGUI/TextEditor.h>
+#include <LibThread/BackgroundAction.h>
+#include <ctype.h>
 
 namespace GUI {
 
+// Starting over on documents this long happens on a background thread, so opening them doesn't stall the UI.
+static constexpr size_t background_highlighting_line_count = 10000;
+
 SyntaxHighlighter::~SyntaxHighlighter()
 {
+    if (m_background_job)
+        m_background_job->highlighter = nullptr;
+}
+
+u32 SyntaxHighlighter::hash_line(const TextDocumentLine& line)
+{
+    u32 hash = line.length();
+    auto* code_points = line.code_points();
+    for (size_t i = 0; i < line.length(); ++i)
+        hash = pair_int_hash(hash, code_points[i]);
+    return hash;
+}
+
+bool SyntaxHighlighter::is_restart_point(const HighlightedLine& line) const
+{
+    if (line.starts_inside_span)
+        return false;
+    return !line.has_previous_token || can_restart_after_token(line.previous_token);
+}
+
+// Lexes text that starts at the beginning of a line and sorts the spans into lines. Each time a new line is
+// reached, can_stop_at_line() gets to decide whether lexing ends there; the lines returned end just before it.
+Vector<SyntaxHighlighter::HighlightedLine> SyntaxHighlighter::highlight_lines(HighlightFunction highlight, const String& text, const Vector<size_t>& line_offsets, const HighlightedLine& first_line_state, const Gfx::Palette& palette, Function<bool(size_t, const HighlightedLine&)> can_stop_at_line)
+{
+    Vector<HighlightedLine> lines;
+    HighlightedLine first_line;
+    first_line.has_previous_token = first_line_state.has_previous_token;
+    first_line.previous_token = first_line_state.previous_token;
+    lines.append(move(first_line));
+
+    bool has_previous_token = first_line_state.has_previous_token;
+    void* previous_token = first_line_state.previous_token;
+    size_t covered_through_line = 0;
+    bool stopped = false;
+
+    auto start_next_line = [&] {
+        HighlightedLine line;
+        line.starts_inside_span = lines.size() <= covered_through_line;
+        line.has_previous_token = has_previous_token;
+        line.previous_token = previous_token;
+        if (can_stop_at_line(lines.size(), line)) {
+            stopped = true;
+            return false;
+        }
+        lines.append(move(line));
+        return true;
+    };
+
+    auto is_whitespace = [&](const TextDocumentSpan& span) {
+        size_t start = line_offsets[span.range.start().line()] + span.range.start().column();
+        size_t end = min(text.length(), line_offsets[span.range.end().line()] + span.range.end().column() + 1);
+        for (size_t i = start; i < end; ++i) {
+            if (!isspace(text[i]))
+                return false;
+        }
+        return true;
+    };
+
+    SpanCallback callback = [&](const TextDocumentSpan& span) {
+        if (span.range.end().line() >= line_offsets.size())
+            return IterationDecision::Continue;
+        while (lines.size() <= span.range.start().line()) {
+            if (!start_next_line())
+                return IterationDecision::Break;
+        }
+
+        auto line_span = span;
+        line_span.range.set_start({ 0, span.range.start().column() });
+        line_span.range.set_end({ span.range.end().line() - span.range.start().line(), span.range.end().column() });
+        lines.last().spans.append(line_span);
+
+        if (span.range.end().line() > span.range.start().line() && !is_whitespace(span))
+            covered_through_line = max(covered_through_line, span.range.end().line());
+        if (!span.is_skippable) {
+            has_previous_token = true;
+            previous_token = span.data;
+        }
+        return IterationDecision::Continue;
+    };
+    highlight(text, palette, callback);
+
+    while (!stopped && lines.size() < line_offsets.size())
+        start_next_line();
+    return lines;
+}
+
+// Only the lines that changed since the last pass are lexed again. Lexing restarts at the closest line before the
+// first change where a fresh lexer is known to produce the same spans, and ends once it reaches a line after the
+// last change that starts in the same lexer state as it did last time. Everything from there on is reused.
+void SyntaxHighlighter::rehighlight(Gfx::Palette palette)
+{
+    ASSERT(m_editor);
+    if (m_background_job) {
+        m_background_job->needs_rerun = true;
+        return;
+    }
+
+    auto& document = m_editor->document();
+    size_t line_count = document.line_count();
+    size_t old_line_count = m_highlighted_lines.size();
+
+    Vector<u32> hashes;
+    hashes.ensure_capacity(line_count);
+    for (size_t i = 0; i < line_count; ++i)
+        hashes.append(hash_line(document.line(i)));
+
+    size_t common_line_count = min(old_line_count, line_count);
+    size_t unchanged_prefix = 0;
+    while (unchanged_prefix < common_line_count && m_highlighted_lines[unchanged_prefix].hash == hashes[unchanged_prefix])
+        ++unchanged_prefix;
+    size_t unchanged_suffix = 0;
+    while (unchanged_suffix < common_line_count - unchanged_prefix && m_highlighted_lines[old_line_count - unchanged_suffix - 1].hash == hashes[line_count - unchanged_suffix - 1])
+        ++unchanged_suffix;
+
+    // If the text is the same as last time, we're being asked to recolor everything for a new palette.
+    bool start_over = old_line_count == 0 || (unchanged_prefix == old_line_count && old_line_count == line_count);
+    if (start_over) {
+        m_highlighted_lines.clear();
+        if (line_count >= background_highlighting_line_count) {
+            start_background_highlighting(palette);
+            return;
+        }
+    }
+
+    size_t first_line = 0;
+    HighlightedLine first_line_state;
+    if (!start_over) {
+        // Lexers may look past the end of a line, so the line before the first change is lexed again too.
+        first_line = min(unchanged_prefix, common_line_count - 1);
+        if (first_line > 0)
+            --first_line;
+        while (first_line > 0 && !is_restart_point(m_highlighted_lines[first_line]))
+            --first_line;
+        first_line_state.has_previous_token = m_highlighted_lines[first_line].has_previous_token;
+        first_line_state.previous_token = m_highlighted_lines[first_line].previous_token;
+    }
+
+    StringBuilder builder;
+    Vector<size_t> line_offsets;
+    for (size_t i = first_line; i < line_count; ++i) {
+        line_offsets.append(builder.length());
+        builder.append(document.line(i).view());
+        if (i != line_count - 1)
+            builder.append('\n');
+    }
+    auto text = builder.to_string();
+
+    size_t first_unchanged_line = line_count - unchanged_suffix;
+    Optional<size_t> old_line_to_resume_at;
+    auto new_lines = highlight_lines(highlight_function(), text, line_offsets, first_line_state, palette, [&](size_t relative_line, const HighlightedLine& state) {
+        size_t line = first_line + relative_line;
+        if (start_over || line < first_unchanged_line)
+            return false;
+        size_t old_line = old_line_count - (line_count - line);
+        auto& old_state = m_highlighted_lines[old_line];
+        if (state.starts_inside_span || old_state.starts_inside_span || state.has_previous_token != old_state.has_previous_token)
+            return false;
+        if (state.has_previous_token && !token_types_equal(state.previous_token, old_state.previous_token))
+            return false;
+        old_line_to_resume_at = old_line;
+        return true;
+    });
+
+    Vector<HighlightedLine> lines;
+    lines.ensure_capacity(line_count);
+    for (size_t i = 0; i < first_line; ++i)
+        lines.append(move(m_highlighted_lines[i]));
+    // Whitespace may run from the lines we keep into the ones lexed again, which will produce it anew.
+    for (size_t i = first_line; i > 0; --i) {
+        auto& spans = lines[i - 1].spans;
+        size_t span_count = spans.size();
+        spans.remove_all_matching([&](auto& span) { return i - 1 + span.range.end().line() >= first_line; });
+        if (span_count != 0)
+            break;
+    }
+    for (auto& line : new_lines)
+        lines.append(move(line));
+    if (old_line_to_resume_at.has_value()) {
+        for (size_t i = old_line_to_resume_at.value(); i < old_line_count; ++i)
+            lines.append(move(m_highlighted_lines[i]));
+    }
+    ASSERT(lines.size() == line_count);
+    for (size_t i = 0; i < line_count; ++i)
+        lines[i].hash = hashes[i];
+
+    did_highlight(move(lines));
+}
+
+void SyntaxHighlighter::start_background_highlighting(Gfx::Palette palette)
+{
+    auto& document = m_editor->document();
+    size_t line_count = document.line_count();
+
+    Vector<u32> hashes;
+    Vector<size_t> line_offsets;
+    StringBuilder builder;
+    for (size_t i = 0; i < line_count; ++i) {
+        auto& line = document.line(i);
+        hashes.append(hash_line(line));
+        line_offsets.append(builder.length());
+        builder.append(line.view());
+        if (i != line_count - 1)
+            builder.append('\n');
+    }
+
+    m_background_job = adopt(*new BackgroundJob);
+    m_background_job->highlighter = this;
+
+    LibThread::BackgroundAction<Vector<HighlightedLine>>::create(
+        [highlight = highlight_function(), text = builder.to_string(), line_offsets = move(line_offsets), palette] {
+            return highlight_lines(highlight, text, line_offsets, {}, palette, [](auto, auto&) { return false; });
+        },
+        [job = m_background_job, hashes = move(hashes)](Vector<HighlightedLine> lines) {
+            auto* highlighter = job->highlighter;
+            if (!highlighter)
+                return;
+            highlighter->m_background_job = nullptr;
+            if (!highlighter->m_editor)
+                return;
+
+            for (size_t i = 0; i < lines.size(); ++i)
+                lines[i].hash = hashes[i];
+
+            if (!job->needs_rerun) {
+                highlighter->did_highlight(move(lines));
+                return;
+            }
+            // The document changed while we were busy. Use this pass as the baseline and catch up incrementally.
+            highlighter->m_highlighted_lines = move(lines);
+            highlighter->rehighlight(highlighter->m_editor->palette());
+        });
+}
+
+void SyntaxHighlighter::did_highlight(Vector<HighlightedLine> lines)
+{
+    m_highlighted_lines = move(lines);
+
+    Vector<TextDocumentSpan> spans;
+    for (size_t line_index = 0; line_index < m_highlighted_lines.size(); ++line_index) {
+        for (auto span : m_highlighted_lines[line_index].spans) {
+            span.range.set_start({ line_index, span.range.start().column() });
+            span.range.set_end({ line_index + span.range.end().line(), span.range.end().column() });
+            spans.append(span);
+        }
+    }
+    m_editor->document().set_spans(move(spans));
+
+    m_has_brace_buddies = false;
+    highlight_matching_token_pair();
+
+    m_editor->update();
 }
 
 void SyntaxHighlighter::highlight_matching_token_pair()
@@ -128,6 +386,10 @@ void SyntaxHighlighter::highlight_matching_token_pair()
 void SyntaxHighlighter::attach(TextEditor& editor)
 {
     ASSERT(!m_editor);
+    if (m_background_job) {
+        m_background_job->highlighter = nullptr;
+        m_background_job = nullptr;
+    }
     m_editor = editor.make_weak_ptr();
 }
 
@@ -135,6 +397,7 @@ void SyntaxHighlighter::detach()
 {
     ASSERT(m_editor);
     m_editor = nullptr;
+    m_highlighted_lines.clear();
 }
 
 void SyntaxHighlighter::cursor_did_change()
@@ -26,7 +26,9 @@
 
 #pragma once
 
+#include <AK/Function.h>
 #include <AK/Noncopyable.h>
+#include <AK/RefCounted.h>
 #include <AK/WeakPtr.h>
 #include <LibGUI/TextDocument.h>
 #include <LibGfx/Palette.h>
@@ -53,7 +55,7 @@ public:
     virtual ~SyntaxHighlighter();
 
     virtual SyntaxLanguage language() const = 0;
-    virtual void rehighlight(Gfx::Palette) = 0;
+    void rehighlight(Gfx::Palette);
     virtual void highlight_matching_token_pair();
 
     virtual bool is_identifier(void*) const { return false; };
@@ -68,6 +70,15 @@ protected:
 
     WeakPtr<TextEditor> m_editor;
 
+    // Lexes some text and reports its spans in order, positioned relative to the start of the text.
+    // It may run on a background thread, so it mustn't touch the highlighter or the editor.
+    using SpanCallback = Function<IterationDecision(const TextDocumentSpan&)>;
+    using HighlightFunction = void (*)(const StringView&, const Gfx::Palette&, SpanCallback&);
+    virtual HighlightFunction highlight_function() const = 0;
+
+    // Whether a fresh lexer started right after a token of this type lexes the same as one that got there.
+    virtual bool can_restart_after_token(void*) const { return true; }
+
     struct MatchingTokenPair {
         void* open;
         void* close;
@@ -83,6 +94,32 @@ protected:
 
     bool m_has_brace_buddies { false };
     BuddySpan m_brace_buddies[2];
+
+private:
+    struct HighlightedLine {
+        u32 hash { 0 };
+        // Set when a span that isn't only whitespace runs into this line from an earlier one.
+        bool starts_inside_span { false };
+        bool has_previous_token { false };
+        void* previous_token { nullptr };
+        // The spans that start on this line, with line numbers relative to it.
+        Vector<TextDocumentSpan> spans;
+    };
+
+    struct BackgroundJob : public RefCounted<BackgroundJob> {
+        SyntaxHighlighter* highlighter { nullptr };
+        bool needs_rerun { false };
+    };
+
+    static u32 hash_line(const TextDocumentLine&);
+    static Vector<HighlightedLine> highlight_lines(HighlightFunction, const String& text, const Vector<size_t>& line_offsets, const HighlightedLine& first_line_state, const Gfx::Palette&, Function<bool(size_t, const HighlightedLine&)> can_stop_at_line);
+    bool is_restart_point(const HighlightedLine&) const;
+    void start_background_highlighting(Gfx::Palette);
+    void did_highlight(Vector<HighlightedLine>);
+
+    // The state of the last highlighting pass, one entry per document line.
+    Vector<HighlightedLine> m_highlighted_lines;
+    RefPtr<BackgroundJob> m_background_job;
 };
 
 }
@@ -153,6 +153,26 @@ void TableView::paint_event(PaintEvent& event)
         paint_headers(painter);
 }
 
+void TableView::update_column_sizes_for_visible_rows()
+{
+    if (!model())
+        return;
+    update_column_sizes();
+    update_content_size();
+}
+
+void TableView::resize_event(ResizeEvent& event)
+{
+    AbstractTableView::resize_event(event);
+    update_column_sizes_for_visible_rows();
+}
+
+void TableView::did_scroll()
+{
+    AbstractTableView::did_scroll();
+    update_column_sizes_for_visible_rows();
+}
+
 void TableView::keydown_event(KeyEvent& event)
 {
     if (!model())
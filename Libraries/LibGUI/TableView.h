@@ -40,6 +40,11 @@ protected:
 
     virtual void keydown_event(KeyEvent&) override;
     virtual void paint_event(PaintEvent&) override;
+    virtual void resize_event(ResizeEvent&) override;
+    virtual void did_scroll() override;
+
+private:
+    void update_column_sizes_for_visible_rows();
 };
 
 }
@@ -30,7 +30,9 @@
 #include <LibCore/Timer.h>
 #include <LibGUI/TextDocument.h>
 #include <LibGUI/TextEditor.h>
+#include <LibGfx/Font.h>
 #include <ctype.h>
+#include <string.h>
 
 namespace GUI {
 
@@ -57,27 +59,52 @@ TextDocument::~TextDocument()
 }
 
 void TextDocument::set_text(const StringView& text)
+{
+    // The text may be pointing into one of our own lines, so copy it before they go away.
+    replace_original_text(ByteBuffer::copy(text.characters_without_null_termination(), text.length()), nullptr);
+}
+
+bool TextDocument::set_text_from_file(const StringView& path)
+{
+    auto file = make<MappedFile>(path);
+    if (!file->is_valid())
+        return false;
+    replace_original_text({}, move(file));
+    return true;
+}
+
+void TextDocument::replace_original_text(ByteBuffer buffer, OwnPtr<MappedFile> mapped_file)
 {
     m_client_notifications_enabled = false;
     m_spans.clear();
     remove_all_lines();
 
+    m_original_text = move(buffer);
+    m_mapped_original_text = move(mapped_file);
+
+    StringView text;
+    if (m_mapped_original_text)
+        text = { (const char*)m_mapped_original_text->data(), m_mapped_original_text->size() };
+    else
+        text = { (const char*)m_original_text.data(), m_original_text.size() };
+
+    auto* characters = text.characters_without_null_termination();
     size_t start_of_current_line = 0;
 
     auto add_line = [&](size_t current_position) {
-        size_t line_length = current_position - start_of_current_line;
         auto line = make<TextDocumentLine>(*this);
-        if (line_length)
-            line->set_text(*this, text.substring_view(start_of_current_line, current_position - start_of_current_line));
+        if (current_position > start_of_current_line)
+            line->set_undecoded_text({}, text.substring_view(start_of_current_line, current_position - start_of_current_line));
         append_line(move(line));
         start_of_current_line = current_position + 1;
     };
-    size_t i = 0;
-    for (i = 0; i < text.length(); ++i) {
-        if (text[i] == '\n')
-            add_line(i);
+    while (start_of_current_line < text.length()) {
+        auto* newline = (const char*)memchr(characters + start_of_current_line, '\n', text.length() - start_of_current_line);
+        if (!newline)
+            break;
+        add_line(newline - characters);
     }
-    add_line(i);
+    add_line(text.length());
     m_client_notifications_enabled = true;
 
     for (auto* client : m_clients)
@@ -96,6 +123,8 @@ size_t TextDocumentLine::first_non_whitespace_column() const
 
 String TextDocumentLine::to_utf8() const
 {
+    if (!is_decoded())
+        return m_undecoded_text;
     StringBuilder builder;
     builder.append(view());
     return builder.to_string();
@@ -111,15 +140,49 @@ TextDocumentLine::TextDocumentLine(TextDocument& document, const StringView& tex
     set_text(document, text);
 }
 
+int TextDocumentLine::width(const Gfx::Font& font) const
+{
+    if (!is_decoded())
+        return font.width(m_undecoded_text);
+    return font.width(view());
+}
+
+void TextDocumentLine::set_undecoded_text(Badge<TextDocument>, const StringView& utf8)
+{
+    m_text.clear();
+    m_undecoded_text = utf8;
+
+    // Most lines are plain ASCII, where the code point count is just the byte count.
+    m_undecoded_length = utf8.length();
+    for (size_t i = 0; i < utf8.length(); ++i) {
+        if ((u8)utf8[i] >= 0x80) {
+            m_undecoded_length = 0;
+            for ([[maybe_unused]] auto code_point : Utf8View(utf8))
+                ++m_undecoded_length;
+            break;
+        }
+    }
+}
+
+void TextDocumentLine::decode() const
+{
+    m_text.ensure_capacity(m_undecoded_length);
+    for (auto code_point : Utf8View(m_undecoded_text))
+        m_text.append(code_point);
+    m_undecoded_text = {};
+}
+
 void TextDocumentLine::clear(TextDocument& document)
 {
     m_text.clear();
+    m_undecoded_text = {};
     document.update_views({});
 }
 
 void TextDocumentLine::set_text(TextDocument& document, const Vector<u32> text)
 {
     m_text = move(text);
+    m_undecoded_text = {};
     document.update_views({});
 }
 
@@ -130,6 +193,7 @@ void TextDocumentLine::set_text(TextDocument& document, const StringView& text)
         return;
     }
     m_text.clear();
+    m_undecoded_text = {};
     Utf8View utf8_view(text);
     for (auto code_point : utf8_view)
         m_text.append(code_point);
@@ -140,6 +204,7 @@ void TextDocumentLine::append(TextDocument& document, const u32* code_points, si
 {
     if (length == 0)
         return;
+    decode_if_needed();
     m_text.append(code_points, length);
     document.update_views({});
 }
@@ -156,6 +221,7 @@ void TextDocumentLine::prepend(TextDocument& document, u32 code_point)
 
 void TextDocumentLine::insert(TextDocument& document, size_t index, u32 code_point)
 {
+    decode_if_needed();
     if (index == length()) {
         m_text.append(code_point);
     } else {
@@ -166,6 +232,7 @@ void TextDocumentLine::insert(TextDocument& document, size_t index, u32 code_poi
 
 void TextDocumentLine::remove(TextDocument& document, size_t index)
 {
+    decode_if_needed();
     if (index == length()) {
         m_text.take_last();
     } else {
@@ -176,6 +243,7 @@ void TextDocumentLine::remove(TextDocument& document, size_t index)
 
 void TextDocumentLine::remove_range(TextDocument& document, size_t start, size_t length)
 {
+    decode_if_needed();
     ASSERT(length <= m_text.size());
 
     Vector<u32> new_data;
@@ -190,6 +258,7 @@ void TextDocumentLine::remove_range(TextDocument& document, size_t start, size_t
 
 void TextDocumentLine::truncate(TextDocument& document, size_t length)
 {
+    decode_if_needed();
     m_text.resize(length);
     document.update_views({});
 }
@@ -26,11 +26,16 @@
 
 #pragma once
 
+#include <AK/Badge.h>
+#include <AK/ByteBuffer.h>
 #include <AK/HashTable.h>
+#include <AK/MappedFile.h>
 #include <AK/NonnullOwnPtrVector.h>
 #include <AK/NonnullRefPtr.h>
 #include <AK/Optional.h>
+#include <AK/OwnPtr.h>
 #include <AK/RefCounted.h>
+#include <AK/StringView.h>
 #include <AK/Utf32View.h>
 #include <LibCore/Forward.h>
 #include <LibGUI/Command.h>
@@ -81,9 +86,10 @@ public:
     const TextDocumentLine& line(size_t line_index) const { return m_lines[line_index]; }
     TextDocumentLine& line(size_t line_index) { return m_lines[line_index]; }
 
-    void set_spans(const Vector<TextDocumentSpan>& spans) { m_spans = spans; }
+    void set_spans(Vector<TextDocumentSpan> spans) { m_spans = move(spans); }
 
     void set_text(const StringView&);
+    bool set_text_from_file(const StringView& path);
 
     const NonnullOwnPtrVector<TextDocumentLine>& lines() const { return m_lines; }
     NonnullOwnPtrVector<TextDocumentLine>& lines() { return m_lines; }
@@ -141,8 +147,13 @@ private:
     explicit TextDocument(Client* client);
 
     void update_undo_timer();
+    void replace_original_text(ByteBuffer, OwnPtr<MappedFile>);
 
     NonnullOwnPtrVector<TextDocumentLine> m_lines;
+
+    // The UTF-8 text the document was last set to. Untouched lines are views into it.
+    ByteBuffer m_original_text;
+    OwnPtr<MappedFile> m_mapped_original_text;
     Vector<TextDocumentSpan> m_spans;
 
     HashTable<Client*> m_clients;
@@ -160,9 +171,16 @@ public:
     String to_utf8() const;
 
     Utf32View view() const { return { code_points(), length() }; }
-    const u32* code_points() const { return m_text.data(); }
-    size_t length() const { return m_text.size(); }
+    const u32* code_points() const
+    {
+        decode_if_needed();
+        return m_text.data();
+    }
+    size_t length() const { return is_decoded() ? m_text.size() : m_undecoded_length; }
+    int width(const Gfx::Font&) const;
+
     void set_text(TextDocument&, const StringView&);
+    void set_undecoded_text(Badge<TextDocument>, const StringView& utf8);
     void set_text(TextDocument&, Vector<u32>);
     void append(TextDocument&, u32);
     void prepend(TextDocument&, u32);
@@ -176,8 +194,21 @@ public:
     size_t first_non_whitespace_column() const;
 
 private:
+    bool is_decoded() const { return m_undecoded_text.is_null(); }
+    void decode_if_needed() const
+    {
+        if (!is_decoded())
+            decode();
+    }
+    void decode() const;
+
     // NOTE: This vector is null terminated.
-    Vector<u32> m_text;
+    mutable Vector<u32> m_text;
+
+    // Until something needs its code points, a line loaded by TextDocument::set_text()
+    // only points at its UTF-8 bytes in the document's original text.
+    mutable StringView m_undecoded_text;
+    size_t m_undecoded_length { 0 };
 };
 
 class TextDocumentUndoCommand : public Command {
@@ -102,9 +102,21 @@ void TextEditor::create_actions()
 void TextEditor::set_text(const StringView& text)
 {
     m_selection.clear();
-
     document().set_text(text);
+    did_set_text();
+}
 
+bool TextEditor::set_text_from_file(const StringView& path)
+{
+    if (!document().set_text_from_file(path))
+        return false;
+    m_selection.clear();
+    did_set_text();
+    return true;
+}
+
+void TextEditor::did_set_text()
+{
     update_content_size();
     recompute_all_visual_lines();
     if (is_single_line())
@@ -1541,7 +1553,7 @@ void TextEditor::recompute_visual_lines(size_t line_index)
     if (is_line_wrapping_enabled())
         visual_data.visual_rect = { m_horizontal_content_padding, 0, available_width, static_cast<int>(visual_data.visual_line_breaks.size()) * line_height() };
     else
-        visual_data.visual_rect = { m_horizontal_content_padding, 0, font().width(line.view()), line_height() };
+        visual_data.visual_rect = { m_horizontal_content_padding, 0, line.width(font()), line_height() };
 }
 
 template<typename Callback>
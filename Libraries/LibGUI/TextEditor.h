@@ -98,6 +98,7 @@ public:
     Function<void()> on_focusout;
 
     void set_text(const StringView&);
+    bool set_text_from_file(const StringView& path);
     void scroll_cursor_into_view();
     void scroll_position_into_view(const TextPosition&);
     size_t line_count() const { return document().line_count(); }
@@ -237,6 +238,7 @@ private:
     void toggle_selection_if_needed_for_event(const KeyEvent&);
     void delete_selection();
     void did_update_selection();
+    void did_set_text();
     int content_x_for_position(const TextPosition&) const;
     Gfx::IntRect ruler_rect_in_inner_coordinates() const;
     Gfx::IntRect visible_text_rect_in_inner_coordinates() const;
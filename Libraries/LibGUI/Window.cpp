@@ -136,6 +136,8 @@ void Window::server_did_destroy()
     m_pending_paint_event_rects.clear();
     m_back_bitmap = nullptr;
     m_front_bitmap = nullptr;
+    m_backing_stores.clear();
+    m_deferred_paint_rects.clear();
     m_override_cursor = StandardCursor::None;
 }
 
@@ -287,39 +289,46 @@ void Window::handle_multi_paint_event(MultiPaintEvent& event)
         return;
     auto rects = event.rects();
     ASSERT(!rects.is_empty());
-    if (m_back_bitmap && m_back_bitmap->size() != event.window_size()) {
-        // Eagerly discard the backing store if we learn from this paint event that it needs to be bigger.
-        // Otherwise we would have to wait for a resize event to tell us. This way we don't waste the
-        // effort on painting into an undersized bitmap that will be thrown away anyway.
-        m_back_bitmap = nullptr;
+    if (rects.first().is_empty()) {
+        rects.clear();
+        rects.append({ {}, event.window_size() });
     }
-    bool created_new_backing_store = !m_back_bitmap;
-    if (!m_back_bitmap) {
-        m_back_bitmap = create_backing_bitmap(event.window_size());
-        ASSERT(m_back_bitmap);
-    } else if (m_double_buffering_enabled) {
-        bool still_has_pixels = m_back_bitmap->shared_buffer()->set_nonvolatile();
-        if (!still_has_pixels) {
+
+    bool created_new_backing_store = false;
+    if (m_double_buffering_enabled) {
+        if (!prepare_back_bitmap(event.window_size(), rects)) {
+            // WindowServer is still busy with every bitmap we have, so paint once it's done with one of them.
+            m_deferred_paint_rects.append(rects.data(), rects.size());
+            m_deferred_paint_window_size = event.window_size();
+            return;
+        }
+    } else {
+        if (m_back_bitmap && m_back_bitmap->size() != event.window_size()) {
+            // Eagerly discard the backing store if we learn from this paint event that it needs to be bigger.
+            // Otherwise we would have to wait for a resize event to tell us. This way we don't waste the
+            // effort on painting into an undersized bitmap that will be thrown away anyway.
+            m_back_bitmap = nullptr;
+        }
+        if (!m_back_bitmap) {
             m_back_bitmap = create_backing_bitmap(event.window_size());
             ASSERT(m_back_bitmap);
             created_new_backing_store = true;
+            rects.clear();
+            rects.append({ {}, event.window_size() });
         }
     }
 
-    auto rect = rects.first();
-    if (rect.is_empty() || created_new_backing_store) {
-        rects.clear();
-        rects.append({ {}, event.window_size() });
-    }
-
     for (auto& rect : rects) {
         PaintEvent paint_event(rect);
         m_main_widget->dispatch_event(paint_event, this);
     }
 
-    if (m_double_buffering_enabled)
+    if (m_double_buffering_enabled) {
         flip(rects);
-    else if (created_new_backing_store)
+        return;
+    }
+
+    if (created_new_backing_store)
         set_current_backing_bitmap(*m_back_bitmap, true);
 
     if (is_visible()) {
@@ -565,6 +574,8 @@ void Window::set_has_alpha_channel(bool value)
     m_pending_paint_event_rects.clear();
     m_back_bitmap = nullptr;
     m_front_bitmap = nullptr;
+    m_backing_stores.clear();
+    m_deferred_paint_rects.clear();
 
     WindowServerConnection::the().send_sync<Messages::WindowServer::SetWindowHasAlphaChannel>(m_window_id, value);
     update();
@@ -603,26 +614,142 @@ void Window::set_current_backing_bitmap(Gfx::Bitmap& bitmap, bool flush_immediat
     WindowServerConnection::the().send_sync<Messages::WindowServer::SetWindowBackingStore>(m_window_id, 32, bitmap.pitch(), bitmap.shbuf_id(), bitmap.has_alpha_channel(), bitmap.size(), flush_immediately);
 }
 
-void Window::flip(const Vector<Gfx::IntRect, 32>& dirty_rects)
+// One bitmap shown by WindowServer, one flipped to but maybe not picked up yet, and one to paint into.
+static constexpr size_t max_backing_stores = 3;
+
+Window::BackingStore* Window::backing_store_for(const Gfx::Bitmap& bitmap)
 {
-    swap(m_front_bitmap, m_back_bitmap);
+    for (auto& backing_store : m_backing_stores) {
+        if (backing_store.bitmap == &bitmap)
+            return &backing_store;
+    }
+    return nullptr;
+}
 
-    set_current_backing_bitmap(*m_front_bitmap);
+// Picks a bitmap that WindowServer isn't using to paint the next frame into, and brings it up to date with the
+// front bitmap, except for the rects that are about to be repainted anyway.
+bool Window::prepare_back_bitmap(const Gfx::IntSize& size, Vector<Gfx::IntRect, 32>& rects_to_paint)
+{
+    if (m_back_bitmap && m_back_bitmap->size() != size)
+        m_back_bitmap = nullptr;
+    if (m_front_bitmap && m_front_bitmap->size() != size)
+        m_front_bitmap = nullptr;
+    m_backing_stores.remove_all_matching([&](auto& backing_store) {
+        return !backing_store.is_in_use_by_server && backing_store.bitmap->size() != size;
+    });
 
-    if (!m_back_bitmap || m_back_bitmap->size() != m_front_bitmap->size()) {
-        m_back_bitmap = create_backing_bitmap(m_front_bitmap->size());
+    if (!m_back_bitmap) {
+        for (auto& backing_store : m_backing_stores) {
+            if (!backing_store.is_in_use_by_server && backing_store.bitmap->size() == size) {
+                m_back_bitmap = backing_store.bitmap;
+                break;
+            }
+        }
+    }
+
+    if (m_back_bitmap) {
+        if (!m_back_bitmap->shared_buffer()->set_nonvolatile()) {
+            auto& stale_rects = backing_store_for(*m_back_bitmap)->stale_rects;
+            stale_rects.clear_with_capacity();
+            stale_rects.add({ {}, size });
+        }
+    } else {
+        if (m_backing_stores.size() == max_backing_stores)
+            return false;
+        m_back_bitmap = create_backing_bitmap(size);
         ASSERT(m_back_bitmap);
-        memcpy(m_back_bitmap->scanline(0), m_front_bitmap->scanline(0), m_front_bitmap->size_in_bytes());
-        m_back_bitmap->shared_buffer()->set_volatile();
-        return;
+        m_backing_stores.append({ m_back_bitmap, {}, false, false, 0 });
+        m_backing_stores.last().stale_rects.add({ {}, size });
+    }
+
+    auto& back = *backing_store_for(*m_back_bitmap);
+    if (back.stale_rects.is_empty())
+        return true;
+
+    Gfx::DisjointRectSet painted_rects;
+    for (auto& rect : rects_to_paint)
+        painted_rects.add(rect);
+    auto rects_to_copy = back.stale_rects.shatter(painted_rects);
+    back.stale_rects.clear_with_capacity();
+    if (rects_to_copy.is_empty())
+        return true;
+
+    if (!m_front_bitmap) {
+        rects_to_paint.clear();
+        rects_to_paint.append({ {}, size });
+        return true;
     }
 
-    // Copy whatever was painted from the front to the back.
     Painter painter(*m_back_bitmap);
-    for (auto& dirty_rect : dirty_rects)
-        painter.blit(dirty_rect.location(), *m_front_bitmap, dirty_rect);
+    for (auto& rect : rects_to_copy.rects())
+        painter.blit(rect.location(), *m_front_bitmap, rect);
+    return true;
+}
+
+void Window::flip(const Vector<Gfx::IntRect, 32>& dirty_rects)
+{
+    auto& back = *backing_store_for(*m_back_bitmap);
+    for (auto& backing_store : m_backing_stores) {
+        if (&backing_store == &back)
+            continue;
+        for (auto& rect : dirty_rects)
+            backing_store.stale_rects.add(rect);
+    }
+
+    back.serial = ++m_flip_serial;
+    if (back.is_known_to_server) {
+        Vector<Gfx::IntRect> rects_to_send;
+        for (auto& rect : dirty_rects)
+            rects_to_send.append(rect);
+        WindowServerConnection::the().post_message(Messages::WindowServer::FlipWindowBackingStore(m_window_id, m_back_bitmap->shbuf_id(), back.serial, rects_to_send));
+    } else {
+        set_current_backing_bitmap(*m_back_bitmap);
+        back.is_known_to_server = true;
+        // That was synchronous, so WindowServer has stopped using every other bitmap already.
+        for (auto& backing_store : m_backing_stores) {
+            if (&backing_store != &back && backing_store.is_in_use_by_server) {
+                backing_store.is_in_use_by_server = false;
+                backing_store.bitmap->shared_buffer()->set_volatile();
+            }
+        }
+        if (is_visible()) {
+            Vector<Gfx::IntRect> rects_to_send;
+            for (auto& rect : dirty_rects)
+                rects_to_send.append(rect);
+            WindowServerConnection::the().post_message(Messages::WindowServer::DidFinishPainting(m_window_id, rects_to_send));
+        }
+    }
+    back.is_in_use_by_server = true;
+    m_front_bitmap = move(m_back_bitmap);
+
+    // Keep a back bitmap around for painters created outside of paint events, if there is one to spare.
+    for (auto& backing_store : m_backing_stores) {
+        if (!backing_store.is_in_use_by_server && backing_store.bitmap->size() == m_front_bitmap->size()) {
+            m_back_bitmap = backing_store.bitmap;
+            break;
+        }
+    }
+}
 
-    m_back_bitmap->shared_buffer()->set_volatile();
+void Window::backing_store_released(Badge<WindowServerConnection>, int shbuf_id, int serial)
+{
+    for (auto& backing_store : m_backing_stores) {
+        if (backing_store.bitmap->shbuf_id() != shbuf_id)
+            continue;
+        // The bitmap has been flipped to again since WindowServer sent this.
+        if (backing_store.serial >= serial)
+            break;
+        backing_store.is_in_use_by_server = false;
+        backing_store.bitmap->shared_buffer()->set_volatile();
+        if (!m_back_bitmap && m_front_bitmap && backing_store.bitmap->size() == m_front_bitmap->size())
+            m_back_bitmap = backing_store.bitmap;
+        break;
+    }
+
+    if (!m_deferred_paint_rects.is_empty()) {
+        auto rects = move(m_deferred_paint_rects);
+        Core::EventLoop::current().post_event(*this, make<MultiPaintEvent>(rects, m_deferred_paint_window_size));
+    }
 }
 
 RefPtr<Gfx::Bitmap> Window::create_shared_bitmap(Gfx::BitmapFormat format, const Gfx::IntSize& size)
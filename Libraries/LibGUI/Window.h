@@ -33,6 +33,7 @@
 #include <LibGUI/Forward.h>
 #include <LibGUI/WindowType.h>
 #include <LibGfx/Color.h>
+#include <LibGfx/DisjointRectSet.h>
 #include <LibGfx/Forward.h>
 #include <LibGfx/Rect.h>
 
@@ -191,6 +192,7 @@ public:
     static void for_each_window(Badge<WindowServerConnection>, Function<void(Window&)>);
     static void update_all_windows(Badge<WindowServerConnection>);
     void notify_state_changed(Badge<WindowServerConnection>, bool minimized, bool occluded);
+    void backing_store_released(Badge<WindowServerConnection>, int shbuf_id, int serial);
 
     virtual bool is_visible_for_timer_purposes() const override { return m_visible_for_timer_purposes; }
 
@@ -227,11 +229,28 @@ private:
     RefPtr<Gfx::Bitmap> create_backing_bitmap(const Gfx::IntSize&);
     RefPtr<Gfx::Bitmap> create_shared_bitmap(Gfx::BitmapFormat, const Gfx::IntSize&);
     void set_current_backing_bitmap(Gfx::Bitmap&, bool flush_immediately = false);
+    bool prepare_back_bitmap(const Gfx::IntSize&, Vector<Gfx::IntRect, 32>& rects_to_paint);
     void flip(const Vector<Gfx::IntRect, 32>& dirty_rects);
     void force_update();
 
+    // With double buffering, the window paints into one of up to three shared bitmaps while WindowServer shows
+    // another. Flips are asynchronous, and WindowServer tells us when it's done with a bitmap.
+    struct BackingStore {
+        RefPtr<Gfx::Bitmap> bitmap;
+        // What was painted into the other bitmaps since this one was last flipped, and so is out of date in it.
+        Gfx::DisjointRectSet stale_rects;
+        bool is_known_to_server { false };
+        bool is_in_use_by_server { false };
+        int serial { 0 };
+    };
+    BackingStore* backing_store_for(const Gfx::Bitmap&);
+
     RefPtr<Gfx::Bitmap> m_front_bitmap;
     RefPtr<Gfx::Bitmap> m_back_bitmap;
+    Vector<BackingStore, 3> m_backing_stores;
+    int m_flip_serial { 0 };
+    Vector<Gfx::IntRect, 32> m_deferred_paint_rects;
+    Gfx::IntSize m_deferred_paint_window_size;
     RefPtr<Gfx::Bitmap> m_icon;
     RefPtr<Gfx::Bitmap> m_custom_cursor;
     int m_window_id { 0 };
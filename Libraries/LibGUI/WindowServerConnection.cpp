@@ -70,6 +70,7 @@ void WindowServerConnection::handshake()
     set_my_client_id(response->client_id());
     set_system_theme_from_shbuf_id(response->system_theme_buffer_id());
     Desktop::the().did_receive_screen_rect({}, response->screen_rect());
+    set_up_shared_memory_transport();
 }
 
 void WindowServerConnection::handle(const Messages::WindowClient::UpdateSystemTheme& message)
@@ -87,6 +88,12 @@ void WindowServerConnection::handle(const Messages::WindowClient::Paint& message
         Core::EventLoop::current().post_event(*window, make<MultiPaintEvent>(message.rects(), message.window_size()));
 }
 
+void WindowServerConnection::handle(const Messages::WindowClient::BackingStoreReleased& message)
+{
+    if (auto* window = Window::from_window_id(message.window_id()))
+        window->backing_store_released({}, message.shbuf_id(), message.serial());
+}
+
 void WindowServerConnection::handle(const Messages::WindowClient::WindowResized& message)
 {
     if (auto* window = Window::from_window_id(message.window_id())) {
@@ -308,7 +315,7 @@ void WindowServerConnection::handle(const Messages::WindowClient::DragDropped& m
 {
     if (auto* window = Window::from_window_id(message.window_id())) {
         auto mime_data = Core::MimeData::construct();
-        mime_data->set_data(message.data_type(), message.data().to_byte_buffer());
+        mime_data->set_data(message.data_type(), ByteBuffer::copy(message.data().characters_without_null_termination(), message.data().length()));
         Core::EventLoop::current().post_event(*window, make<DropEvent>(message.mouse_position(), message.text(), mime_data));
     }
 }
@@ -40,6 +40,8 @@ public:
     WindowServerConnection()
         : IPC::ServerConnection<WindowClientEndpoint, WindowServerEndpoint>(*this, "/tmp/portal/window")
     {
+        // Widgets invalidate and update their windows in bursts, so send those out once per event loop pass.
+        set_batches_outgoing_messages(true);
         handshake();
     }
 
@@ -48,6 +50,7 @@ public:
 
 private:
     virtual void handle(const Messages::WindowClient::Paint&) override;
+    virtual void handle(const Messages::WindowClient::BackingStoreReleased&) override;
     virtual void handle(const Messages::WindowClient::MouseMove&) override;
     virtual void handle(const Messages::WindowClient::MouseDown&) override;
     virtual void handle(const Messages::WindowClient::MouseDoubleClick&) override;
@@ -51,6 +51,11 @@ static bool size_would_overflow(BitmapFormat format, const IntSize& size)
     return Checked<size_t>::multiplication_would_overflow(size.width(), size.height(), Bitmap::bpp_for_format(format));
 }
 
+static size_t minimum_pitch(int width)
+{
+    return round_up_to_power_of_two(width * sizeof(RGBA32), 16);
+}
+
 RefPtr<Bitmap> Bitmap::create(BitmapFormat format, const IntSize& size)
 {
     if (size_would_overflow(format, size))
@@ -65,9 +70,21 @@ RefPtr<Bitmap> Bitmap::create_purgeable(BitmapFormat format, const IntSize& size
     return adopt(*new Bitmap(format, size, Purgeable::Yes));
 }
 
+RefPtr<Bitmap> Bitmap::create_shareable(BitmapFormat format, const IntSize& size)
+{
+    if (size_would_overflow(format, size))
+        return nullptr;
+    auto buffer = SharedBuffer::create_with_size(minimum_pitch(size.width()) * size.height());
+    if (!buffer)
+        return nullptr;
+    Vector<RGBA32> palette;
+    palette.resize(palette_size(format));
+    return adopt(*new Bitmap(format, buffer.release_nonnull(), size, palette));
+}
+
 Bitmap::Bitmap(BitmapFormat format, const IntSize& size, Purgeable purgeable)
     : m_size(size)
-    , m_pitch(round_up_to_power_of_two(size.width() * sizeof(RGBA32), 16))
+    , m_pitch(minimum_pitch(size.width()))
     , m_format(format)
     , m_purgeable(purgeable == Purgeable::Yes)
 {
@@ -130,7 +147,7 @@ RefPtr<Bitmap> Bitmap::create_with_shared_buffer(BitmapFormat format, NonnullRef
 Bitmap::Bitmap(BitmapFormat format, NonnullRefPtr<SharedBuffer>&& shared_buffer, const IntSize& size, const Vector<RGBA32>& palette)
     : m_size(size)
     , m_data((RGBA32*)shared_buffer->data())
-    , m_pitch(round_up_to_power_of_two(size.width() * sizeof(RGBA32), 16))
+    , m_pitch(minimum_pitch(size.width()))
     , m_format(format)
     , m_shared_buffer(move(shared_buffer))
 {
@@ -192,6 +209,8 @@ RefPtr<Bitmap> Bitmap::to_bitmap_backed_by_shared_buffer() const
     if (m_shared_buffer)
         return *this;
     auto buffer = SharedBuffer::create_with_size(size_in_bytes());
+    if (!buffer)
+        return nullptr;
     auto bitmap = Bitmap::create_with_shared_buffer(m_format, *buffer, m_size, palette_to_vector());
     if (!bitmap)
         return nullptr;
@@ -199,6 +218,19 @@ RefPtr<Bitmap> Bitmap::to_bitmap_backed_by_shared_buffer() const
     return bitmap;
 }
 
+RefPtr<Bitmap> Bitmap::to_purgeable_bitmap() const
+{
+    if (m_purgeable)
+        return *this;
+    auto bitmap = Bitmap::create_purgeable(m_format, m_size);
+    if (!bitmap)
+        return nullptr;
+    if (is_indexed())
+        memcpy(bitmap->m_palette, m_palette, palette_size(m_format) * sizeof(RGBA32));
+    memcpy(bitmap->scanline(0), scanline(0), size_in_bytes());
+    return bitmap;
+}
+
 Bitmap::~Bitmap()
 {
     if (m_needs_munmap) {
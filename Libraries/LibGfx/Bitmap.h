@@ -65,6 +65,7 @@ class Bitmap : public RefCounted<Bitmap> {
 public:
     static RefPtr<Bitmap> create(BitmapFormat, const IntSize&);
     static RefPtr<Bitmap> create_purgeable(BitmapFormat, const IntSize&);
+    static RefPtr<Bitmap> create_shareable(BitmapFormat, const IntSize&);
     static RefPtr<Bitmap> create_wrapper(BitmapFormat, const IntSize&, size_t pitch, RGBA32*);
     static RefPtr<Bitmap> load_from_file(const StringView& path);
     static RefPtr<Bitmap> create_with_shared_buffer(BitmapFormat, NonnullRefPtr<SharedBuffer>&&, const IntSize&);
@@ -83,6 +84,7 @@ public:
     RefPtr<Gfx::Bitmap> rotated(Gfx::RotationDirection) const;
     RefPtr<Gfx::Bitmap> flipped(Gfx::Orientation) const;
     RefPtr<Bitmap> to_bitmap_backed_by_shared_buffer() const;
+    RefPtr<Bitmap> to_purgeable_bitmap() const;
 
     ShareableBitmap to_shareable_bitmap(pid_t peer_pid = -1) const;
 
@@ -117,7 +119,7 @@ public:
             || format == BitmapFormat::Indexed2 || format == BitmapFormat::Indexed1;
     }
 
-    size_t palette_size(BitmapFormat format) const
+    static size_t palette_size(BitmapFormat format)
     {
         switch (format) {
         case BitmapFormat::Indexed1:
@@ -40,6 +40,42 @@ void DisjointRectSet::add(const IntRect& new_rect)
         shatter();
 }
 
+bool DisjointRectSet::intersects(const IntRect& rect) const
+{
+    for (auto& existing_rect : m_rects) {
+        if (existing_rect.intersects(rect))
+            return true;
+    }
+    return false;
+}
+
+DisjointRectSet DisjointRectSet::shatter(const IntRect& hammer) const
+{
+    // Pieces of disjoint rects are disjoint too, so there's no need to go through add().
+    DisjointRectSet result;
+    for (auto& rect : m_rects) {
+        if (!rect.intersects(hammer)) {
+            result.m_rects.append(rect);
+            continue;
+        }
+        for (auto& piece : rect.shatter(hammer))
+            result.m_rects.append(piece);
+    }
+    return result;
+}
+
+DisjointRectSet DisjointRectSet::shatter(const DisjointRectSet& hammer) const
+{
+    DisjointRectSet result;
+    result.m_rects = m_rects;
+    for (auto& hammer_rect : hammer.m_rects) {
+        if (result.is_empty())
+            break;
+        result = result.shatter(hammer_rect);
+    }
+    return result;
+}
+
 void DisjointRectSet::shatter()
 {
     Vector<IntRect, 32> output;
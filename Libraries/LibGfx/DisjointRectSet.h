@@ -39,9 +39,16 @@ public:
         : m_rects(move(other.m_rects))
     {
     }
+    DisjointRectSet& operator=(DisjointRectSet&&) = default;
 
     void add(const IntRect&);
 
+    bool intersects(const IntRect&) const;
+
+    // Returns the parts of this set that are not covered by the hammer rect(s).
+    DisjointRectSet shatter(const IntRect& hammer) const;
+    DisjointRectSet shatter(const DisjointRectSet& hammer) const;
+
     bool is_empty() const { return m_rects.is_empty(); }
     size_t size() const { return m_rects.size(); }
 
@@ -152,6 +152,19 @@ Font::Font(const StringView& name, unsigned* rows, u8* widths, bool is_fixed_wid
         m_min_glyph_width = minimum;
         m_max_glyph_width = maximum;
     }
+
+    update_glyph_advances();
+}
+
+void Font::update_glyph_advances()
+{
+    ASSERT(m_glyph_count <= max_glyph_count);
+    m_glyph_atlas.clear();
+    if (m_fixed_width || !m_glyph_widths) {
+        memset(m_glyph_advances, m_glyph_width, m_glyph_count);
+        return;
+    }
+    memcpy(m_glyph_advances, m_glyph_widths, m_glyph_count);
 }
 
 Font::~Font()
@@ -263,6 +276,33 @@ GlyphBitmap Font::glyph_bitmap(u32 code_point) const
     return GlyphBitmap(&m_rows[code_point * m_glyph_height], { glyph_width(code_point), m_glyph_height });
 }
 
+void Font::build_glyph_atlas() const
+{
+    m_glyph_atlas_pitch = 0;
+    for (size_t i = 0; i < m_glyph_count; ++i) {
+        m_glyph_atlas_offsets[i] = m_glyph_atlas_pitch;
+        m_glyph_atlas_pitch += glyph_width(i);
+    }
+
+    m_glyph_atlas.resize(max<size_t>(m_glyph_atlas_pitch * m_glyph_height, 1));
+    for (size_t i = 0; i < m_glyph_count; ++i) {
+        auto bitmap = glyph_bitmap(i);
+        for (int y = 0; y < bitmap.height(); ++y) {
+            u8* row = m_glyph_atlas.data() + y * m_glyph_atlas_pitch + m_glyph_atlas_offsets[i];
+            for (int x = 0; x < bitmap.width(); ++x)
+                row[x] = bitmap.bit_at(x, y) ? 0xff : 0;
+        }
+    }
+}
+
+GlyphMask Font::glyph_mask(u32 code_point) const
+{
+    ASSERT(code_point < m_glyph_count);
+    if (m_glyph_atlas.is_empty())
+        build_glyph_atlas();
+    return { m_glyph_atlas.data() + m_glyph_atlas_offsets[code_point], m_glyph_atlas_pitch, { glyph_width(code_point), m_glyph_height } };
+}
+
 int Font::glyph_or_emoji_width(u32 code_point) const
 {
     if (code_point < m_glyph_count)
@@ -288,6 +328,16 @@ int Font::width(const Utf8View& utf8) const
     bool first = true;
     int width = 0;
 
+    // Fast path: plain ASCII needs no UTF-8 decoding, only advance table lookups.
+    auto* characters = (const u8*)utf8.as_string().characters_without_null_termination();
+    size_t length = utf8.as_string().length();
+    size_t i = 0;
+    for (; i < length && characters[i] < 0x80; ++i)
+        width += m_glyph_advances[characters[i]];
+    if (i == length)
+        return length ? width + (int)(length - 1) * glyph_spacing() : 0;
+    width = 0;
+
     for (u32 code_point : utf8) {
         if (!first)
             width += glyph_spacing();
@@ -341,6 +391,7 @@ void Font::set_type(FontTypes type)
     m_glyph_count = new_glyph_count;
     m_rows = new_rows;
     m_glyph_widths = new_widths;
+    update_glyph_advances();
 }
 
 }
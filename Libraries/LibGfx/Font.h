@@ -31,6 +31,7 @@
 #include <AK/RefPtr.h>
 #include <AK/String.h>
 #include <AK/Types.h>
+#include <AK/Vector.h>
 #include <LibGfx/Size.h>
 
 namespace Gfx {
@@ -73,6 +74,13 @@ private:
     IntSize m_size;
 };
 
+// A glyph prerendered as one byte of coverage (0 or 255) per pixel, with rows `pitch` bytes apart.
+struct GlyphMask {
+    const u8* data { nullptr };
+    size_t pitch { 0 };
+    IntSize size;
+};
+
 class Font : public RefCounted<Font> {
 public:
     static Font& default_font();
@@ -91,7 +99,14 @@ public:
 
     GlyphBitmap glyph_bitmap(u32 code_point) const;
 
-    u8 glyph_width(size_t ch) const { return m_fixed_width ? m_glyph_width : m_glyph_widths[ch]; }
+    // All glyphs are prerendered as masks and packed side by side into one atlas on first use,
+    // which lets Painter draw text without unpacking glyph bits. The mask doesn't depend on the
+    // text color, so one atlas serves every color. Anything that changes glyph bits through
+    // GlyphBitmap must call did_change_glyph_bitmaps() afterwards.
+    GlyphMask glyph_mask(u32 code_point) const;
+    void did_change_glyph_bitmaps() { m_glyph_atlas.clear(); }
+
+    u8 glyph_width(size_t ch) const { return ch < m_glyph_count ? m_glyph_advances[ch] : m_glyph_width; }
     int glyph_or_emoji_width(u32 code_point) const;
     u8 glyph_height() const { return m_glyph_height; }
     int x_height() const { return m_x_height; }
@@ -108,7 +123,11 @@ public:
     void set_name(const StringView& name) { m_name = name; }
 
     bool is_fixed_width() const { return m_fixed_width; }
-    void set_fixed_width(bool b) { m_fixed_width = b; }
+    void set_fixed_width(bool b)
+    {
+        m_fixed_width = b;
+        update_glyph_advances();
+    }
 
     u8 glyph_spacing() const { return m_glyph_spacing; }
     void set_glyph_spacing(u8 spacing) { m_glyph_spacing = spacing; }
@@ -117,6 +136,7 @@ public:
     {
         ASSERT(m_glyph_widths);
         m_glyph_widths[ch] = width;
+        update_glyph_advances();
     }
 
     int glyph_count() const { return m_glyph_count; }
@@ -130,6 +150,11 @@ private:
     static RefPtr<Font> load_from_memory(const u8*);
     static size_t glyph_count_by_type(FontTypes type);
 
+    void update_glyph_advances();
+    void build_glyph_atlas() const;
+
+    static constexpr size_t max_glyph_count = 384;
+
     String m_name;
     FontTypes m_type;
     size_t m_glyph_count { 256 };
@@ -138,6 +163,14 @@ private:
     u8* m_glyph_widths { nullptr };
     MappedFile m_mapped_file;
 
+    // Per-glyph advance widths, resolved for fixed-width fonts up front so that
+    // measuring text is a single table lookup per code point.
+    u8 m_glyph_advances[max_glyph_count] {};
+
+    mutable Vector<u8> m_glyph_atlas;
+    mutable size_t m_glyph_atlas_pitch { 0 };
+    mutable u32 m_glyph_atlas_offsets[max_glyph_count] {};
+
     u8 m_glyph_width { 0 };
     u8 m_glyph_height { 0 };
     u8 m_x_height { 0 };
@@ -65,6 +65,9 @@ struct ImageDescriptor {
     u16 duration { 0 };
     bool transparent { false };
     bool user_input { false };
+
+    // Used to pick which decoded frames to drop from the cache.
+    size_t last_use { 0 };
 };
 
 struct LogicalScreen {
@@ -80,13 +83,13 @@ struct GIFLoadingContext {
         FrameDescriptorsLoaded,
     };
     State state { NotDecoded };
-    size_t frames_decoded { 0 };
     const u8* data { nullptr };
     size_t data_size { 0 };
     LogicalScreen logical_screen {};
     u8 background_color_index { 0 };
     NonnullOwnPtrVector<ImageDescriptor> images {};
     size_t loops { 1 };
+    size_t use_counter { 0 };
 };
 
 RefPtr<Gfx::Bitmap> load_gif(const StringView& path)
@@ -135,9 +138,12 @@ static Optional<GIFFormat> decode_gif_header(BufferStream& stream)
     return {};
 }
 
+// The code table is flat: every code is the code for the string it extends plus one more byte,
+// so adding a code never copies a string, and strings are only spelled out (backwards) for output.
 class LZWDecoder {
 private:
     static constexpr int max_code_size = 12;
+    static constexpr size_t max_code_count = 1 << max_code_size;
 
 public:
     explicit LZWDecoder(const Vector<u8>& lzw_bytes, u8 min_code_size)
@@ -151,10 +157,10 @@ public:
 
     u16 add_control_code()
     {
-        const u16 control_code = m_code_table.size();
-        m_code_table.append(Vector<u8> {});
-        m_original_code_table.append(Vector<u8> {});
-        if (m_code_table.size() >= m_table_capacity && m_code_size < max_code_size) {
+        const u16 control_code = m_code_count;
+        m_lengths[m_code_count++] = 0;
+        m_original_code_count = m_code_count;
+        if (m_code_count >= m_table_capacity && m_code_size < max_code_size) {
 
             ++m_code_size;
             ++m_original_code_size;
@@ -165,10 +171,10 @@ public:
 
     void reset()
     {
-        m_code_table.clear();
-        m_code_table.append(m_original_code_table);
+        m_code_count = m_original_code_count;
         m_code_size = m_original_code_size;
         m_table_capacity = pow(2, m_code_size);
+        m_previous_code = {};
         m_output.clear();
     }
 
@@ -197,9 +203,9 @@ public:
             m_current_code = (*addr & mask) >> current_bit_offset;
         }
 
-        if (m_current_code > m_code_table.size()) {
+        if (m_current_code > m_code_count || (m_current_code == m_code_count && !m_previous_code.has_value())) {
             dbg() << "Corrupted LZW stream, invalid code: " << m_current_code << " at bit index: "
-                  << m_current_bit_index << ", code table size: " << m_code_table.size();
+                  << m_current_bit_index << ", code table size: " << m_code_count;
             return {};
         }
 
@@ -208,48 +214,70 @@ public:
         return m_current_code;
     }
 
-    Vector<u8>& get_output()
+    const Vector<u8>& get_output()
     {
-        ASSERT(m_current_code <= m_code_table.size());
-        if (m_current_code < m_code_table.size()) {
-            Vector<u8> new_entry = m_output;
-            m_output = m_code_table.at(m_current_code);
-            new_entry.append(m_output[0]);
-            extend_code_table(new_entry);
-        } else if (m_current_code == m_code_table.size()) {
-            m_output.append(m_output[0]);
-            extend_code_table(m_output);
+        ASSERT(m_current_code <= m_code_count);
+        if (m_current_code < m_code_count) {
+            spell_out(m_current_code);
+            if (m_previous_code.has_value())
+                extend_code_table(m_previous_code.value(), m_output[0]);
+        } else {
+            // The code that's about to be added: the previous string plus its own first byte.
+            u8 first_byte = m_first_bytes[m_previous_code.value()];
+            extend_code_table(m_previous_code.value(), first_byte);
+            spell_out(m_current_code);
         }
+        m_previous_code = m_current_code;
         return m_output;
     }
 
 private:
     void init_code_table()
     {
-        m_code_table.clear();
         for (u16 i = 0; i < m_table_capacity; ++i) {
-            m_code_table.append({ (u8)i });
+            m_prefixes[i] = 0;
+            m_suffixes[i] = i;
+            m_first_bytes[i] = i;
+            m_lengths[i] = 1;
         }
-        m_original_code_table = m_code_table;
+        m_code_count = m_table_capacity;
+        m_original_code_count = m_code_count;
     }
 
-    void extend_code_table(const Vector<u8>& entry)
+    void extend_code_table(u16 prefix, u8 suffix)
     {
-        if (entry.size() > 1 && m_code_table.size() < 4096) {
-            m_code_table.append(entry);
-            if (m_code_table.size() >= m_table_capacity && m_code_size < max_code_size) {
+        if (m_code_count < max_code_count) {
+            m_prefixes[m_code_count] = prefix;
+            m_suffixes[m_code_count] = suffix;
+            m_first_bytes[m_code_count] = m_first_bytes[prefix];
+            m_lengths[m_code_count] = m_lengths[prefix] + 1;
+            ++m_code_count;
+            if (m_code_count >= m_table_capacity && m_code_size < max_code_size) {
                 ++m_code_size;
                 m_table_capacity *= 2;
             }
         }
     }
 
+    void spell_out(u16 code)
+    {
+        m_output.resize(m_lengths[code]);
+        for (size_t i = m_lengths[code]; i > 0; --i) {
+            m_output[i - 1] = m_suffixes[code];
+            code = m_prefixes[code];
+        }
+    }
+
     const Vector<u8>& m_lzw_bytes;
 
     int m_current_bit_index { 0 };
 
-    Vector<Vector<u8>> m_code_table {};
-    Vector<Vector<u8>> m_original_code_table {};
+    u16 m_prefixes[max_code_count];
+    u8 m_suffixes[max_code_count];
+    u8 m_first_bytes[max_code_count];
+    u16 m_lengths[max_code_count];
+    u16 m_code_count { 0 };
+    u16 m_original_code_count { 0 };
 
     u8 m_code_size { 0 };
     u8 m_original_code_size { 0 };
@@ -257,84 +285,158 @@ private:
     u32 m_table_capacity { 0 };
 
     u16 m_current_code { 0 };
+    Optional<u16> m_previous_code;
     Vector<u8> m_output {};
 };
 
-static bool decode_frames_up_to_index(GIFLoadingContext& context, size_t frame_index)
+static bool decode_frame(GIFLoadingContext& context, size_t frame_index)
 {
-    if (frame_index >= context.images.size()) {
-        return false;
-    }
-
-    for (size_t i = context.frames_decoded; i <= frame_index; ++i) {
-        auto& image = context.images.at(i);
-        printf("Image %zu: %d,%d %dx%d  %zu bytes LZW-encoded\n", i, image.x, image.y, image.width, image.height, image.lzw_encoded_bytes.size());
+    auto& image = context.images.at(frame_index);
+#ifdef GIF_DEBUG
+    dbg() << "Decoding frame: " << frame_index + 1 << " of " << context.images.size() << ": " << image.x << "," << image.y << " " << image.width << "x" << image.height << ", " << image.lzw_encoded_bytes.size() << " bytes LZW-encoded";
+#endif
 
-        dbg() << "Decoding frame: " << i + 1 << " of " << context.images.size();
+    LZWDecoder decoder(image.lzw_encoded_bytes, image.lzw_min_code_size);
 
-        LZWDecoder decoder(image.lzw_encoded_bytes, image.lzw_min_code_size);
+    // Add GIF-specific control codes
+    const int clear_code = decoder.add_control_code();
+    const int end_of_information_code = decoder.add_control_code();
 
-        // Add GIF-specific control codes
-        const int clear_code = decoder.add_control_code();
-        const int end_of_information_code = decoder.add_control_code();
+    auto background_rgb = context.logical_screen.color_map[context.background_color_index];
+    Color background_color = Color(background_rgb.r, background_rgb.g, background_rgb.b);
 
-        auto background_rgb = context.logical_screen.color_map[context.background_color_index];
-        Color background_color = Color(background_rgb.r, background_rgb.g, background_rgb.b);
+    auto bitmap = Bitmap::create_purgeable(BitmapFormat::RGBA32, { context.logical_screen.width, context.logical_screen.height });
+    if (!bitmap)
+        return false;
+    if (frame_index > 0 && image.disposal_method == ImageDescriptor::DisposalMethod::InPlace) {
+        auto& previous_bitmap = *context.images.at(frame_index - 1).bitmap;
+        for (int y = 0; y < bitmap->height(); ++y)
+            memcpy(bitmap->scanline(y), previous_bitmap.scanline(y), bitmap->width() * sizeof(RGBA32));
+    } else {
+        bitmap->fill(background_color);
+    }
 
-        image.bitmap = Bitmap::create_purgeable(BitmapFormat::RGBA32, { context.logical_screen.width, context.logical_screen.height });
-        image.bitmap->fill(background_color);
-        if (i > 0 && image.disposal_method == ImageDescriptor::DisposalMethod::InPlace) {
-            for (int y = 0; y < image.bitmap->height(); ++y) {
-                for (int x = 0; x < image.bitmap->width(); ++x) {
-                    image.bitmap->set_pixel(x, y, context.images.at(i - 1).bitmap->get_pixel(x, y));
-                }
+    RGB transparent_color { 0, 0, 0 };
+    if (image.transparent) {
+        transparent_color = context.logical_screen.color_map[image.transparency_index];
+    }
+    RGBA32 palette[256];
+    for (size_t i = 0; i < 256; ++i) {
+        auto rgb = context.logical_screen.color_map[i];
+        Color c = Color(rgb.r, rgb.g, rgb.b);
+        if (image.transparent) {
+            if (rgb.r == transparent_color.r && rgb.g == transparent_color.g && rgb.b == transparent_color.b) {
+                c.set_alpha(0);
             }
         }
+        palette[i] = c.value();
+    }
 
-        int pixel_index = 0;
-        RGB transparent_color { 0, 0, 0 };
-        if (image.transparent) {
-            transparent_color = context.logical_screen.color_map[image.transparency_index];
+    int pixel_index = 0;
+    while (true) {
+        Optional<u16> code = decoder.next_code();
+        if (!code.has_value()) {
+            dbg() << "Unexpectedly reached end of gif frame data";
+            return false;
         }
 
-        while (true) {
-            Optional<u16> code = decoder.next_code();
-            if (!code.has_value()) {
-                dbg() << "Unexpectedly reached end of gif frame data";
-                return false;
-            }
+        if (code.value() == clear_code) {
+            decoder.reset();
+            continue;
+        } else if (code.value() == end_of_information_code) {
+            break;
+        }
 
-            if (code.value() == clear_code) {
-                decoder.reset();
-                continue;
-            } else if (code.value() == end_of_information_code) {
-                break;
-            }
+        auto& colors = decoder.get_output();
 
-            auto colors = decoder.get_output();
+        for (auto color : colors) {
+            int x = pixel_index % image.width + image.x;
+            int y = pixel_index / image.width + image.y;
+            if (x < bitmap->width() && y < bitmap->height())
+                bitmap->scanline(y)[x] = palette[color];
+            ++pixel_index;
+        }
+    }
 
-            for (const auto& color : colors) {
-                auto rgb = context.logical_screen.color_map[color];
+    image.bitmap = move(bitmap);
+    return true;
+}
 
-                int x = pixel_index % image.width + image.x;
-                int y = pixel_index / image.width + image.y;
+// Composited frames are decoded as they're asked for. Every checkpoint_interval'th one is kept, so seeking
+// never has to go back further than that, and so are the most recently used others, as long as they fit
+// in frame_cache_budget. For most animations that's all of them.
+static constexpr size_t frame_cache_budget = 32 * 1024 * 1024;
 
-                Color c = Color(rgb.r, rgb.g, rgb.b);
+static size_t frame_size_in_bytes(const GIFLoadingContext& context)
+{
+    return max<size_t>(1, (size_t)context.logical_screen.width * context.logical_screen.height * sizeof(RGBA32));
+}
 
-                if (image.transparent) {
-                    if (rgb.r == transparent_color.r && rgb.g == transparent_color.g && rgb.b == transparent_color.b) {
-                        c.set_alpha(0);
-                    }
-                }
+static size_t max_cached_frame_count(const GIFLoadingContext& context)
+{
+    return max<size_t>(2, frame_cache_budget / frame_size_in_bytes(context));
+}
 
-                image.bitmap->set_pixel(x, y, c);
-                ++pixel_index;
-            }
+static size_t checkpoint_interval(const GIFLoadingContext& context)
+{
+    auto max_checkpoint_count = max_cached_frame_count(context);
+    return max<size_t>(1, (context.images.size() + max_checkpoint_count - 1) / max_checkpoint_count);
+}
+
+static bool is_checkpoint(const GIFLoadingContext& context, size_t frame_index)
+{
+    return frame_index % checkpoint_interval(context) == 0;
+}
+
+static bool depends_on_previous_frame(const GIFLoadingContext& context, size_t frame_index)
+{
+    return frame_index > 0 && context.images.at(frame_index).disposal_method == ImageDescriptor::DisposalMethod::InPlace;
+}
+
+static void evict_frames_except(GIFLoadingContext& context, size_t frame_index)
+{
+    size_t cached_count = 0;
+    for (size_t i = 0; i < context.images.size(); ++i) {
+        if (context.images.at(i).bitmap && !is_checkpoint(context, i))
+            ++cached_count;
+    }
+
+    while (cached_count > max_cached_frame_count(context)) {
+        Optional<size_t> least_recently_used;
+        for (size_t i = 0; i < context.images.size(); ++i) {
+            auto& image = context.images.at(i);
+            if (i == frame_index || !image.bitmap || is_checkpoint(context, i))
+                continue;
+            if (!least_recently_used.has_value() || image.last_use < context.images.at(least_recently_used.value()).last_use)
+                least_recently_used = i;
         }
+        if (!least_recently_used.has_value())
+            return;
+        context.images.at(least_recently_used.value()).bitmap = nullptr;
+        --cached_count;
+    }
+}
+
+static bool decode_frame_with_dependencies(GIFLoadingContext& context, size_t frame_index)
+{
+    if (frame_index >= context.images.size()) {
+        return false;
+    }
+
+    // Go back to the nearest frame that can be composited from what we have.
+    size_t first_frame_to_decode = frame_index;
+    while (!context.images.at(first_frame_to_decode).bitmap && depends_on_previous_frame(context, first_frame_to_decode) && !context.images.at(first_frame_to_decode - 1).bitmap)
+        --first_frame_to_decode;
 
-        ++context.frames_decoded;
+    for (size_t i = first_frame_to_decode; i <= frame_index; ++i) {
+        if (context.images.at(i).bitmap)
+            continue;
+        if (!decode_frame(context, i))
+            return false;
     }
 
+    context.images.at(frame_index).last_use = ++context.use_counter;
+    evict_frames_except(context, frame_index);
     return true;
 }
 
@@ -569,8 +671,9 @@ RefPtr<Gfx::Bitmap> GIFImageDecoderPlugin::bitmap()
 
 void GIFImageDecoderPlugin::set_volatile()
 {
-    for (size_t i = 0; i < m_context->frames_decoded; ++i) {
-        m_context->images.at(i).bitmap->set_volatile();
+    for (auto& image : m_context->images) {
+        if (image.bitmap)
+            image.bitmap->set_volatile();
     }
 }
 
@@ -580,11 +683,12 @@ bool GIFImageDecoderPlugin::set_nonvolatile()
         return false;
     }
 
-    bool success = true;
-    for (size_t i = 0; i < m_context->frames_decoded; ++i) {
-        success &= m_context->images.at(i).bitmap->set_nonvolatile();
+    // Frames that were purged are simply decoded again when they're next asked for.
+    for (auto& image : m_context->images) {
+        if (image.bitmap && !image.bitmap->set_nonvolatile())
+            image.bitmap = nullptr;
     }
-    return success;
+    return true;
 }
 
 bool GIFImageDecoderPlugin::sniff()
@@ -643,7 +747,7 @@ ImageFrameDescriptor GIFImageDecoderPlugin::frame(size_t i)
         }
     }
 
-    if (!decode_frames_up_to_index(*m_context, i)) {
+    if (!decode_frame_with_dependencies(*m_context, i)) {
         m_context->state = GIFLoadingContext::State::Error;
         return {};
     }
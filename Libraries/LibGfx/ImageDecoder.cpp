@@ -38,45 +38,76 @@ namespace Gfx {
 
 ImageDecoder::ImageDecoder(const u8* data, size_t size)
 {
-    m_plugin = make<PNGImageDecoderPlugin>(data, size);
-    if (m_plugin->sniff())
-        return;
+    m_plugin = create_plugin(data, size);
+}
+
+OwnPtr<ImageDecoderPlugin> ImageDecoder::create_plugin(const u8* data, size_t size)
+{
+    OwnPtr<ImageDecoderPlugin> plugin = make<PNGImageDecoderPlugin>(data, size);
+    if (plugin->sniff())
+        return plugin;
 
-    m_plugin = make<GIFImageDecoderPlugin>(data, size);
-    if (m_plugin->sniff())
-        return;
+    plugin = make<GIFImageDecoderPlugin>(data, size);
+    if (plugin->sniff())
+        return plugin;
 
-    m_plugin = make<BMPImageDecoderPlugin>(data, size);
-    if (m_plugin->sniff())
-        return;
+    plugin = make<BMPImageDecoderPlugin>(data, size);
+    if (plugin->sniff())
+        return plugin;
 
-    m_plugin = make<PBMImageDecoderPlugin>(data, size);
-    if (m_plugin->sniff())
-        return;
+    plugin = make<PBMImageDecoderPlugin>(data, size);
+    if (plugin->sniff())
+        return plugin;
 
-    m_plugin = make<PGMImageDecoderPlugin>(data, size);
-    if (m_plugin->sniff())
-        return;
+    plugin = make<PGMImageDecoderPlugin>(data, size);
+    if (plugin->sniff())
+        return plugin;
 
-    m_plugin = make<PPMImageDecoderPlugin>(data, size);
-    if (m_plugin->sniff())
-        return;
+    plugin = make<PPMImageDecoderPlugin>(data, size);
+    if (plugin->sniff())
+        return plugin;
 
-    m_plugin = make<ICOImageDecoderPlugin>(data, size);
-    if (m_plugin->sniff())
-        return;
+    plugin = make<ICOImageDecoderPlugin>(data, size);
+    if (plugin->sniff())
+        return plugin;
 
-    m_plugin = make<JPGImageDecoderPlugin>(data, size);
-    if (m_plugin->sniff())
-        return;
+    plugin = make<JPGImageDecoderPlugin>(data, size);
+    if (plugin->sniff())
+        return plugin;
 
-    m_plugin = nullptr;
+    return nullptr;
 }
 
 ImageDecoder::~ImageDecoder()
 {
 }
 
+void ImageDecoder::append_data(ReadonlyBytes data, bool is_complete)
+{
+    ASSERT(!m_is_data_complete);
+    m_data.append(data.data(), data.size());
+    m_is_data_complete = is_complete;
+
+    if (!m_plugin) {
+        // Wait for enough data to tell the formats apart. Only the incremental ones are any use
+        // before everything has arrived, the others are picked once it has.
+        static constexpr size_t signature_size = 8;
+        if (m_data.size() < signature_size && !is_complete)
+            return;
+        if (auto plugin = make<PNGImageDecoderPlugin>(m_data.data(), m_data.size()); plugin->sniff())
+            m_plugin = move(plugin);
+        else if (auto plugin = make<JPGImageDecoderPlugin>(m_data.data(), m_data.size()); plugin->sniff())
+            m_plugin = move(plugin);
+        else if (is_complete)
+            m_plugin = create_plugin(m_data.data(), m_data.size());
+        if (!m_plugin)
+            return;
+    }
+
+    if (m_plugin->supports_incremental_decoding())
+        m_plugin->did_receive_data(m_data.data(), m_data.size(), is_complete);
+}
+
 RefPtr<Gfx::Bitmap> ImageDecoder::bitmap() const
 {
     if (!m_plugin)
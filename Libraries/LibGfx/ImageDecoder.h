@@ -30,6 +30,8 @@
 #include <AK/OwnPtr.h>
 #include <AK/RefCounted.h>
 #include <AK/RefPtr.h>
+#include <AK/Span.h>
+#include <AK/Vector.h>
 #include <LibGfx/Size.h>
 
 namespace Gfx {
@@ -48,6 +50,14 @@ public:
     virtual IntSize size() = 0;
     virtual RefPtr<Gfx::Bitmap> bitmap() = 0;
 
+    // Formats that can decode directly at a reduced scale use this as a hint to produce a
+    // smaller bitmap that still covers the given size. It must be set before decoding.
+    virtual void set_desired_size(const IntSize&) { }
+
+    // Formats that support it decode into a bitmap backed by a shared buffer, which can then be
+    // handed to another process without a copy. It must be set before decoding.
+    virtual void set_decode_into_shareable_bitmap(bool) { }
+
     virtual void set_volatile() = 0;
     [[nodiscard]] virtual bool set_nonvolatile() = 0;
 
@@ -58,6 +68,15 @@ public:
     virtual size_t frame_count() = 0;
     virtual ImageFrameDescriptor frame(size_t i) = 0;
 
+    // Formats that can decode an image while it is still arriving take it through did_receive_data().
+    // The data pointer may change between calls, but it must always start with the bytes passed before.
+    virtual bool supports_incremental_decoding() const { return false; }
+    virtual void did_receive_data(const u8*, size_t, [[maybe_unused]] bool is_complete) { }
+
+    // How many rows from the top of partial_bitmap() have been decoded so far.
+    virtual int decoded_row_count() { return 0; }
+    virtual RefPtr<Gfx::Bitmap> partial_bitmap() { return nullptr; }
+
 protected:
     ImageDecoderPlugin() { }
 };
@@ -66,6 +85,10 @@ class ImageDecoder : public RefCounted<ImageDecoder> {
 public:
     static NonnullRefPtr<ImageDecoder> create(const u8* data, size_t size) { return adopt(*new ImageDecoder(data, size)); }
     static NonnullRefPtr<ImageDecoder> create(const ByteBuffer& data) { return adopt(*new ImageDecoder(data.data(), data.size())); }
+
+    // Creates a decoder that is fed through append_data() as the image arrives, and
+    // decodes what it can along the way for formats that support it.
+    static NonnullRefPtr<ImageDecoder> create_incremental() { return adopt(*new ImageDecoder); }
     ~ImageDecoder();
 
     bool is_valid() const { return m_plugin; }
@@ -74,6 +97,16 @@ public:
     int width() const { return size().width(); }
     int height() const { return size().height(); }
     RefPtr<Gfx::Bitmap> bitmap() const;
+    void set_desired_size(const IntSize& size)
+    {
+        if (m_plugin)
+            m_plugin->set_desired_size(size);
+    }
+    void set_decode_into_shareable_bitmap(bool shareable)
+    {
+        if (m_plugin)
+            m_plugin->set_decode_into_shareable_bitmap(shareable);
+    }
     void set_volatile()
     {
         if (m_plugin)
@@ -86,10 +119,25 @@ public:
     size_t frame_count() const { return m_plugin ? m_plugin->frame_count() : 0; }
     ImageFrameDescriptor frame(size_t i) const { return m_plugin ? m_plugin->frame(i) : ImageFrameDescriptor(); }
 
+    void append_data(ReadonlyBytes, bool is_complete);
+    bool is_data_complete() const { return m_is_data_complete; }
+    int decoded_row_count() const { return m_plugin ? m_plugin->decoded_row_count() : 0; }
+    RefPtr<Gfx::Bitmap> partial_bitmap() const { return m_plugin ? m_plugin->partial_bitmap() : nullptr; }
+
 private:
     ImageDecoder(const u8*, size_t);
+    ImageDecoder()
+        : m_is_data_complete(false)
+    {
+    }
+
+    static OwnPtr<ImageDecoderPlugin> create_plugin(const u8*, size_t);
 
     mutable OwnPtr<ImageDecoderPlugin> m_plugin;
+
+    // The data received so far by an incremental decoder.
+    Vector<u8> m_data;
+    bool m_is_data_complete { true };
 };
 
 }
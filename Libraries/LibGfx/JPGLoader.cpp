@@ -34,6 +34,12 @@
 #include <LibGfx/Bitmap.h>
 #include <LibGfx/JPGLoader.h>
 #include <math.h>
+#include <string.h>
+
+#if ARCH(I386) || ARCH(X86_64)
+#    include <cpuid.h>
+#    include <emmintrin.h>
+#endif
 
 #define JPG_DBG 0
 #define jpg_dbg(x) \
@@ -116,23 +122,13 @@ using Marker = u16;
  * units of a component C is Ch * Cv, where Ch and Cv represent the horizontal &
  * vertical subsampling factors of the component, respectively. A MacroBlock is
  * an 8x8 block of RGB values before encoding, and 8x8 block of YCbCr values when
- * we're done decoding the huffman stream.
+ * we're done decoding the huffman stream. They're converted to RGB straight into
+ * the bitmap.
  */
 struct Macroblock {
-    union {
-        i32 y[64] = { 0 };
-        i32 r[64];
-    };
-
-    union {
-        i32 cb[64] = { 0 };
-        i32 g[64];
-    };
-
-    union {
-        i32 cr[64] = { 0 };
-        i32 b[64];
-    };
+    i32 y[64] = { 0 };
+    i32 cb[64] = { 0 };
+    i32 cr[64] = { 0 };
 };
 
 struct MacroblockMeta {
@@ -197,6 +193,7 @@ struct JPGLoadingContext {
         NotDecoded = 0,
         Error,
         FrameDecoded,
+        HeaderDecoded,
         BitmapDecoded
     };
 
@@ -218,6 +215,19 @@ struct JPGLoadingContext {
     HuffmanStreamState huffman_stream;
     i32 previous_dc_values[3] = { 0 };
     MacroblockMeta mblock_meta;
+    IntSize header_size;
+    // Each 8x8 block of coefficients is reconstructed into this many pixels square.
+    // Anything less than 8 decodes the image downscaled by 8 / scaled_block_size.
+    u8 scaled_block_size { 8 };
+    bool decode_into_shareable_bitmap { false };
+
+    // When the data is fed in as it arrives, the entropy-coded data is unstuffed into the
+    // huffman stream as far as it goes, and the image is decoded one row of MCUs at a time.
+    bool is_data_complete { true };
+    size_t scan_offset { 0 };
+    bool has_seen_end_of_image { false };
+    Vector<Macroblock> macroblocks;
+    u32 next_vcursor { 0 };
 };
 
 static void generate_huffman_codes(HuffmanTableSpec& table)
@@ -239,7 +249,7 @@ static Optional<size_t> read_huffman_bits(HuffmanStreamState& hstream, size_t co
     size_t value = 0;
     while (count--) {
         if (hstream.byte_offset >= hstream.stream.size()) {
-            dbg() << String::format("Huffman stream exhausted. This could be an error!");
+            jpg_dbg("Huffman stream exhausted. This could be an error!");
             return {};
         }
         u8 current_byte = hstream.stream[hstream.byte_offset];
@@ -373,10 +383,9 @@ static bool build_macroblocks(JPGLoadingContext& context, Vector<Macroblock>& ma
     return true;
 }
 
-static Optional<Vector<Macroblock>> decode_huffman_stream(JPGLoadingContext& context)
+static void prepare_huffman_stream_decoding(JPGLoadingContext& context)
 {
-    Vector<Macroblock> macroblocks;
-    macroblocks.resize(context.mblock_meta.padded_total);
+    context.macroblocks.resize(context.mblock_meta.padded_total);
 
     jpg_dbg("Image width: " << context.frame.width);
     jpg_dbg("Image height: " << context.frame.height);
@@ -389,40 +398,38 @@ static Optional<Vector<Macroblock>> decode_huffman_stream(JPGLoadingContext& con
 
     for (auto& ac_table : context.ac_tables)
         generate_huffman_codes(ac_table);
+}
 
-    for (u32 vcursor = 0; vcursor < context.mblock_meta.vcount; vcursor += context.vsample_factor) {
-        for (u32 hcursor = 0; hcursor < context.mblock_meta.hcount; hcursor += context.hsample_factor) {
-            u32 i = vcursor * context.mblock_meta.hpadded_count + hcursor;
-            if (context.dc_reset_interval > 0) {
-                if (i % context.dc_reset_interval == 0) {
-                    context.previous_dc_values[0] = 0;
-                    context.previous_dc_values[1] = 0;
-                    context.previous_dc_values[2] = 0;
-
-                    // Restart markers are stored in byte boundaries. Advance the huffman stream cursor to
-                    //  the 0th bit of the next byte.
-                    if (context.huffman_stream.byte_offset < context.huffman_stream.stream.size()) {
-                        if (context.huffman_stream.bit_offset > 0) {
-                            context.huffman_stream.bit_offset = 0;
-                            context.huffman_stream.byte_offset++;
-                        }
-
-                        // Skip the restart marker (RSTn).
+static bool decode_huffman_stream_row(JPGLoadingContext& context, u32 vcursor)
+{
+    for (u32 hcursor = 0; hcursor < context.mblock_meta.hcount; hcursor += context.hsample_factor) {
+        u32 i = vcursor * context.mblock_meta.hpadded_count + hcursor;
+        if (context.dc_reset_interval > 0) {
+            if (i % context.dc_reset_interval == 0) {
+                context.previous_dc_values[0] = 0;
+                context.previous_dc_values[1] = 0;
+                context.previous_dc_values[2] = 0;
+
+                // Restart markers are stored in byte boundaries. Advance the huffman stream cursor to
+                //  the 0th bit of the next byte.
+                if (context.huffman_stream.byte_offset < context.huffman_stream.stream.size()) {
+                    if (context.huffman_stream.bit_offset > 0) {
+                        context.huffman_stream.bit_offset = 0;
                         context.huffman_stream.byte_offset++;
                     }
+
+                    // Skip the restart marker (RSTn).
+                    context.huffman_stream.byte_offset++;
                 }
             }
+        }
 
-            if (!build_macroblocks(context, macroblocks, hcursor, vcursor)) {
-                dbg() << "Failed to build Macroblock " << i;
-                dbg() << "Huffman stream byte offset " << context.huffman_stream.byte_offset;
-                dbg() << "Huffman stream bit offset " << context.huffman_stream.bit_offset;
-                return {};
-            }
+        if (!build_macroblocks(context, context.macroblocks, hcursor, vcursor)) {
+            jpg_dbg("Failed to build Macroblock " << i);
+            return false;
         }
     }
-
-    return macroblocks;
+    return true;
 }
 
 static inline bool bounds_okay(const size_t cursor, const size_t delta, const size_t bound)
@@ -798,9 +805,9 @@ static bool skip_marker_with_length(BufferStream& stream)
     return !stream.handle_read_failure();
 }
 
-static void dequantize(JPGLoadingContext& context, Vector<Macroblock>& macroblocks)
+static void dequantize(JPGLoadingContext& context, Vector<Macroblock>& macroblocks, u32 first_vcursor, u32 end_vcursor)
 {
-    for (u32 vcursor = 0; vcursor < context.mblock_meta.vcount; vcursor += context.vsample_factor) {
+    for (u32 vcursor = first_vcursor; vcursor < end_vcursor; vcursor += context.vsample_factor) {
         for (u32 hcursor = 0; hcursor < context.mblock_meta.hcount; hcursor += context.hsample_factor) {
             for (u8 cindex = 0; cindex < context.component_count; cindex++) {
                 auto& component = context.components[cindex];
@@ -819,24 +826,251 @@ static void dequantize(JPGLoadingContext& context, Vector<Macroblock>& macrobloc
     }
 }
 
-static void inverse_dct(const JPGLoadingContext& context, Vector<Macroblock>& macroblocks)
+// Integer IDCT after Loeffler, Ligtenberg and Moschytz, as in the IJG's jidctint.c. The constants are
+// scaled by 2^13, and the column pass keeps two extra bits of precision for the row pass. Coefficients
+// and intermediate results are saturated to 16 bits, which valid data never exceeds. That way the SSE2
+// version can work in 16-bit lanes and still give exactly the same result as the scalar one.
+static constexpr int idct_const_bits = 13;
+static constexpr int idct_pass1_bits = 2;
+
+static constexpr i32 fix_0_298631336 = 2446;
+static constexpr i32 fix_0_390180644 = 3196;
+static constexpr i32 fix_0_541196100 = 4433;
+static constexpr i32 fix_0_765366865 = 6270;
+static constexpr i32 fix_0_899976223 = 7373;
+static constexpr i32 fix_1_175875602 = 9633;
+static constexpr i32 fix_1_501321110 = 12299;
+static constexpr i32 fix_1_847759065 = 15137;
+static constexpr i32 fix_1_961570560 = 16069;
+static constexpr i32 fix_2_053119869 = 16819;
+static constexpr i32 fix_2_562915447 = 20995;
+static constexpr i32 fix_3_072711026 = 25172;
+
+static bool has_sse2()
+{
+#if ARCH(I386) || ARCH(X86_64)
+    static bool s_has_sse2 = [] {
+        unsigned eax, ebx, ecx, edx;
+        return __get_cpuid(1, &eax, &ebx, &ecx, &edx) && (edx & bit_SSE2);
+    }();
+    return s_has_sse2;
+#else
+    return false;
+#endif
+}
+
+ALWAYS_INLINE static i32 saturate_i16(i32 value)
+{
+    return clamp(value, -32768, 32767);
+}
+
+// Transforms the 8 values in[0], in[stride], ... into out[0], out[stride], ..., descaled by shift bits.
+template<int shift>
+ALWAYS_INLINE static void inverse_dct_1d(const i32* in, i32* out, size_t stride)
+{
+    // Even part.
+    i32 z2 = in[2 * stride];
+    i32 z3 = in[6 * stride];
+    i32 z1 = (z2 + z3) * fix_0_541196100;
+    i32 tmp2 = z1 - z3 * fix_1_847759065;
+    i32 tmp3 = z1 + z2 * fix_0_765366865;
+    i32 tmp0 = (in[0] + in[4 * stride]) * (1 << idct_const_bits);
+    i32 tmp1 = (in[0] - in[4 * stride]) * (1 << idct_const_bits);
+
+    const i32 tmp10 = tmp0 + tmp3;
+    const i32 tmp13 = tmp0 - tmp3;
+    const i32 tmp11 = tmp1 + tmp2;
+    const i32 tmp12 = tmp1 - tmp2;
+
+    // Odd part.
+    tmp0 = in[7 * stride];
+    tmp1 = in[5 * stride];
+    tmp2 = in[3 * stride];
+    tmp3 = in[1 * stride];
+    z1 = tmp0 + tmp3;
+    z2 = tmp1 + tmp2;
+    z3 = tmp0 + tmp2;
+    i32 z4 = tmp1 + tmp3;
+    const i32 z5 = (z3 + z4) * fix_1_175875602;
+
+    tmp0 *= fix_0_298631336;
+    tmp1 *= fix_2_053119869;
+    tmp2 *= fix_3_072711026;
+    tmp3 *= fix_1_501321110;
+    z1 *= -fix_0_899976223;
+    z2 *= -fix_2_562915447;
+    z3 = z3 * -fix_1_961570560 + z5;
+    z4 = z4 * -fix_0_390180644 + z5;
+
+    tmp0 += z1 + z3;
+    tmp1 += z2 + z4;
+    tmp2 += z2 + z3;
+    tmp3 += z1 + z4;
+
+    constexpr i32 round = 1 << (shift - 1);
+    out[0 * stride] = saturate_i16((tmp10 + tmp3 + round) >> shift);
+    out[7 * stride] = saturate_i16((tmp10 - tmp3 + round) >> shift);
+    out[1 * stride] = saturate_i16((tmp11 + tmp2 + round) >> shift);
+    out[6 * stride] = saturate_i16((tmp11 - tmp2 + round) >> shift);
+    out[2 * stride] = saturate_i16((tmp12 + tmp1 + round) >> shift);
+    out[5 * stride] = saturate_i16((tmp12 - tmp1 + round) >> shift);
+    out[3 * stride] = saturate_i16((tmp13 + tmp0 + round) >> shift);
+    out[4 * stride] = saturate_i16((tmp13 - tmp0 + round) >> shift);
+}
+
+static void inverse_dct_block(i32* block)
+{
+    i32 coefficients[64];
+    for (size_t i = 0; i < 64; i++)
+        coefficients[i] = saturate_i16(block[i]);
+
+    i32 workspace[64];
+    for (size_t column = 0; column < 8; column++) {
+        const i32* in = coefficients + column;
+        // Most columns only have a DC coefficient, which comes out as a constant.
+        if (!(in[8] | in[16] | in[24] | in[32] | in[40] | in[48] | in[56])) {
+            const i32 dc = saturate_i16(in[0] * (1 << idct_pass1_bits));
+            for (size_t row = 0; row < 8; row++)
+                workspace[row * 8 + column] = dc;
+            continue;
+        }
+        inverse_dct_1d<idct_const_bits - idct_pass1_bits>(in, workspace + column, 8);
+    }
+
+    for (size_t row = 0; row < 8; row++) {
+        const i32* in = workspace + row * 8;
+        inverse_dct_1d<idct_const_bits + idct_pass1_bits + 3>(in, block + row * 8, 1);
+    }
+}
+
+#if ARCH(I386) || ARCH(X86_64)
+struct I32x8 {
+    __m128i lo;
+    __m128i hi;
+};
+
+// Computes a * ca + b * cb for each of the 8 lanes, widened to 32 bits.
+[[gnu::target("sse2")]] ALWAYS_INLINE static I32x8 multiply_add_epi16(__m128i a, __m128i b, i16 ca, i16 cb)
+{
+    const __m128i constants = _mm_set_epi16(cb, ca, cb, ca, cb, ca, cb, ca);
+    return { _mm_madd_epi16(_mm_unpacklo_epi16(a, b), constants), _mm_madd_epi16(_mm_unpackhi_epi16(a, b), constants) };
+}
+
+[[gnu::target("sse2")]] ALWAYS_INLINE static I32x8 add_epi32(I32x8 a, I32x8 b)
+{
+    return { _mm_add_epi32(a.lo, b.lo), _mm_add_epi32(a.hi, b.hi) };
+}
+
+[[gnu::target("sse2")]] ALWAYS_INLINE static I32x8 sub_epi32(I32x8 a, I32x8 b)
+{
+    return { _mm_sub_epi32(a.lo, b.lo), _mm_sub_epi32(a.hi, b.hi) };
+}
+
+template<int shift>
+[[gnu::target("sse2")]] ALWAYS_INLINE static __m128i descale_epi32(I32x8 value)
 {
-    static const float m0 = 2.0 * cos(1.0 / 16.0 * 2.0 * M_PI);
-    static const float m1 = 2.0 * cos(2.0 / 16.0 * 2.0 * M_PI);
-    static const float m3 = 2.0 * cos(2.0 / 16.0 * 2.0 * M_PI);
-    static const float m5 = 2.0 * cos(3.0 / 16.0 * 2.0 * M_PI);
-    static const float m2 = m0 - m5;
-    static const float m4 = m0 + m5;
-    static const float s0 = cos(0.0 / 16.0 * M_PI) / sqrt(8);
-    static const float s1 = cos(1.0 / 16.0 * M_PI) / 2.0;
-    static const float s2 = cos(2.0 / 16.0 * M_PI) / 2.0;
-    static const float s3 = cos(3.0 / 16.0 * M_PI) / 2.0;
-    static const float s4 = cos(4.0 / 16.0 * M_PI) / 2.0;
-    static const float s5 = cos(5.0 / 16.0 * M_PI) / 2.0;
-    static const float s6 = cos(6.0 / 16.0 * M_PI) / 2.0;
-    static const float s7 = cos(7.0 / 16.0 * M_PI) / 2.0;
-
-    for (u32 vcursor = 0; vcursor < context.mblock_meta.vcount; vcursor += context.vsample_factor) {
+    const __m128i round = _mm_set1_epi32(1 << (shift - 1));
+    return _mm_packs_epi32(_mm_srai_epi32(_mm_add_epi32(value.lo, round), shift), _mm_srai_epi32(_mm_add_epi32(value.hi, round), shift));
+}
+
+// The same transform as inverse_dct_1d(), on 8 lanes at once. The multiplications are regrouped so
+// that each one is a pair of products that _mm_madd_epi16() can do in one go.
+template<int shift>
+[[gnu::target("sse2")]] ALWAYS_INLINE static void inverse_dct_1d_sse2(__m128i (&v)[8])
+{
+    // Even part.
+    const I32x8 tmp3 = multiply_add_epi16(v[2], v[6], fix_0_541196100 + fix_0_765366865, fix_0_541196100);
+    const I32x8 tmp2 = multiply_add_epi16(v[2], v[6], fix_0_541196100, fix_0_541196100 - fix_1_847759065);
+    const I32x8 tmp0 = multiply_add_epi16(v[0], v[4], 1 << idct_const_bits, 1 << idct_const_bits);
+    const I32x8 tmp1 = multiply_add_epi16(v[0], v[4], 1 << idct_const_bits, -(1 << idct_const_bits));
+
+    const I32x8 tmp10 = add_epi32(tmp0, tmp3);
+    const I32x8 tmp13 = sub_epi32(tmp0, tmp3);
+    const I32x8 tmp11 = add_epi32(tmp1, tmp2);
+    const I32x8 tmp12 = sub_epi32(tmp1, tmp2);
+
+    // Odd part.
+    const I32x8 z3 = add_epi32(multiply_add_epi16(v[7], v[5], fix_1_175875602 - fix_1_961570560, fix_1_175875602),
+        multiply_add_epi16(v[3], v[1], fix_1_175875602 - fix_1_961570560, fix_1_175875602));
+    const I32x8 z4 = add_epi32(multiply_add_epi16(v[7], v[5], fix_1_175875602, fix_1_175875602 - fix_0_390180644),
+        multiply_add_epi16(v[3], v[1], fix_1_175875602, fix_1_175875602 - fix_0_390180644));
+
+    const I32x8 odd0 = add_epi32(multiply_add_epi16(v[7], v[1], fix_0_298631336 - fix_0_899976223, -fix_0_899976223), z3);
+    const I32x8 odd3 = add_epi32(multiply_add_epi16(v[7], v[1], -fix_0_899976223, fix_1_501321110 - fix_0_899976223), z4);
+    const I32x8 odd1 = add_epi32(multiply_add_epi16(v[5], v[3], fix_2_053119869 - fix_2_562915447, -fix_2_562915447), z4);
+    const I32x8 odd2 = add_epi32(multiply_add_epi16(v[5], v[3], -fix_2_562915447, fix_3_072711026 - fix_2_562915447), z3);
+
+    v[0] = descale_epi32<shift>(add_epi32(tmp10, odd3));
+    v[7] = descale_epi32<shift>(sub_epi32(tmp10, odd3));
+    v[1] = descale_epi32<shift>(add_epi32(tmp11, odd2));
+    v[6] = descale_epi32<shift>(sub_epi32(tmp11, odd2));
+    v[2] = descale_epi32<shift>(add_epi32(tmp12, odd1));
+    v[5] = descale_epi32<shift>(sub_epi32(tmp12, odd1));
+    v[3] = descale_epi32<shift>(add_epi32(tmp13, odd0));
+    v[4] = descale_epi32<shift>(sub_epi32(tmp13, odd0));
+}
+
+[[gnu::target("sse2")]] ALWAYS_INLINE static void transpose_8x8_epi16(__m128i (&v)[8])
+{
+    const __m128i a0 = _mm_unpacklo_epi16(v[0], v[1]);
+    const __m128i a1 = _mm_unpackhi_epi16(v[0], v[1]);
+    const __m128i a2 = _mm_unpacklo_epi16(v[2], v[3]);
+    const __m128i a3 = _mm_unpackhi_epi16(v[2], v[3]);
+    const __m128i a4 = _mm_unpacklo_epi16(v[4], v[5]);
+    const __m128i a5 = _mm_unpackhi_epi16(v[4], v[5]);
+    const __m128i a6 = _mm_unpacklo_epi16(v[6], v[7]);
+    const __m128i a7 = _mm_unpackhi_epi16(v[6], v[7]);
+
+    const __m128i b0 = _mm_unpacklo_epi32(a0, a2);
+    const __m128i b1 = _mm_unpackhi_epi32(a0, a2);
+    const __m128i b2 = _mm_unpacklo_epi32(a1, a3);
+    const __m128i b3 = _mm_unpackhi_epi32(a1, a3);
+    const __m128i b4 = _mm_unpacklo_epi32(a4, a6);
+    const __m128i b5 = _mm_unpackhi_epi32(a4, a6);
+    const __m128i b6 = _mm_unpacklo_epi32(a5, a7);
+    const __m128i b7 = _mm_unpackhi_epi32(a5, a7);
+
+    v[0] = _mm_unpacklo_epi64(b0, b4);
+    v[1] = _mm_unpackhi_epi64(b0, b4);
+    v[2] = _mm_unpacklo_epi64(b1, b5);
+    v[3] = _mm_unpackhi_epi64(b1, b5);
+    v[4] = _mm_unpacklo_epi64(b2, b6);
+    v[5] = _mm_unpackhi_epi64(b2, b6);
+    v[6] = _mm_unpacklo_epi64(b3, b7);
+    v[7] = _mm_unpackhi_epi64(b3, b7);
+}
+
+[[gnu::target("sse2")]] static void inverse_dct_block_sse2(i32* block)
+{
+    __m128i v[8];
+    for (size_t row = 0; row < 8; row++) {
+        auto* in = reinterpret_cast<const __m128i*>(block + row * 8);
+        v[row] = _mm_packs_epi32(_mm_loadu_si128(in), _mm_loadu_si128(in + 1));
+    }
+
+    // Each lane holds a column for the first pass, and a row for the second.
+    inverse_dct_1d_sse2<idct_const_bits - idct_pass1_bits>(v);
+    transpose_8x8_epi16(v);
+    inverse_dct_1d_sse2<idct_const_bits + idct_pass1_bits + 3>(v);
+    transpose_8x8_epi16(v);
+
+    for (size_t row = 0; row < 8; row++) {
+        auto* out = reinterpret_cast<__m128i*>(block + row * 8);
+        _mm_storeu_si128(out, _mm_srai_epi32(_mm_unpacklo_epi16(v[row], v[row]), 16));
+        _mm_storeu_si128(out + 1, _mm_srai_epi32(_mm_unpackhi_epi16(v[row], v[row]), 16));
+    }
+}
+#endif
+
+static void inverse_dct(const JPGLoadingContext& context, Vector<Macroblock>& macroblocks, u32 first_vcursor, u32 end_vcursor)
+{
+    auto* transform_block = inverse_dct_block;
+#if ARCH(I386) || ARCH(X86_64)
+    if (has_sse2())
+        transform_block = inverse_dct_block_sse2;
+#endif
+
+    for (u32 vcursor = first_vcursor; vcursor < end_vcursor; vcursor += context.vsample_factor) {
         for (u32 hcursor = 0; hcursor < context.mblock_meta.hcount; hcursor += context.hsample_factor) {
             for (u8 cindex = 0; cindex < context.component_count; cindex++) {
                 auto& component = context.components[cindex];
@@ -844,141 +1078,7 @@ static void inverse_dct(const JPGLoadingContext& context, Vector<Macroblock>& ma
                     for (u8 hfactor_i = 0; hfactor_i < component.hsample_factor; hfactor_i++) {
                         u32 mb_index = (vcursor + vfactor_i) * context.mblock_meta.hpadded_count + (hfactor_i + hcursor);
                         Macroblock& block = macroblocks[mb_index];
-                        i32* block_component = cindex == 0 ? block.y : (cindex == 1 ? block.cb : block.cr);
-                        for (u32 k = 0; k < 8; ++k) {
-                            const float g0 = block_component[0 * 8 + k] * s0;
-                            const float g1 = block_component[4 * 8 + k] * s4;
-                            const float g2 = block_component[2 * 8 + k] * s2;
-                            const float g3 = block_component[6 * 8 + k] * s6;
-                            const float g4 = block_component[5 * 8 + k] * s5;
-                            const float g5 = block_component[1 * 8 + k] * s1;
-                            const float g6 = block_component[7 * 8 + k] * s7;
-                            const float g7 = block_component[3 * 8 + k] * s3;
-
-                            const float f0 = g0;
-                            const float f1 = g1;
-                            const float f2 = g2;
-                            const float f3 = g3;
-                            const float f4 = g4 - g7;
-                            const float f5 = g5 + g6;
-                            const float f6 = g5 - g6;
-                            const float f7 = g4 + g7;
-
-                            const float e0 = f0;
-                            const float e1 = f1;
-                            const float e2 = f2 - f3;
-                            const float e3 = f2 + f3;
-                            const float e4 = f4;
-                            const float e5 = f5 - f7;
-                            const float e6 = f6;
-                            const float e7 = f5 + f7;
-                            const float e8 = f4 + f6;
-
-                            const float d0 = e0;
-                            const float d1 = e1;
-                            const float d2 = e2 * m1;
-                            const float d3 = e3;
-                            const float d4 = e4 * m2;
-                            const float d5 = e5 * m3;
-                            const float d6 = e6 * m4;
-                            const float d7 = e7;
-                            const float d8 = e8 * m5;
-
-                            const float c0 = d0 + d1;
-                            const float c1 = d0 - d1;
-                            const float c2 = d2 - d3;
-                            const float c3 = d3;
-                            const float c4 = d4 + d8;
-                            const float c5 = d5 + d7;
-                            const float c6 = d6 - d8;
-                            const float c7 = d7;
-                            const float c8 = c5 - c6;
-
-                            const float b0 = c0 + c3;
-                            const float b1 = c1 + c2;
-                            const float b2 = c1 - c2;
-                            const float b3 = c0 - c3;
-                            const float b4 = c4 - c8;
-                            const float b5 = c8;
-                            const float b6 = c6 - c7;
-                            const float b7 = c7;
-
-                            block_component[0 * 8 + k] = b0 + b7;
-                            block_component[1 * 8 + k] = b1 + b6;
-                            block_component[2 * 8 + k] = b2 + b5;
-                            block_component[3 * 8 + k] = b3 + b4;
-                            block_component[4 * 8 + k] = b3 - b4;
-                            block_component[5 * 8 + k] = b2 - b5;
-                            block_component[6 * 8 + k] = b1 - b6;
-                            block_component[7 * 8 + k] = b0 - b7;
-                        }
-                        for (u32 l = 0; l < 8; ++l) {
-                            const float g0 = block_component[l * 8 + 0] * s0;
-                            const float g1 = block_component[l * 8 + 4] * s4;
-                            const float g2 = block_component[l * 8 + 2] * s2;
-                            const float g3 = block_component[l * 8 + 6] * s6;
-                            const float g4 = block_component[l * 8 + 5] * s5;
-                            const float g5 = block_component[l * 8 + 1] * s1;
-                            const float g6 = block_component[l * 8 + 7] * s7;
-                            const float g7 = block_component[l * 8 + 3] * s3;
-
-                            const float f0 = g0;
-                            const float f1 = g1;
-                            const float f2 = g2;
-                            const float f3 = g3;
-                            const float f4 = g4 - g7;
-                            const float f5 = g5 + g6;
-                            const float f6 = g5 - g6;
-                            const float f7 = g4 + g7;
-
-                            const float e0 = f0;
-                            const float e1 = f1;
-                            const float e2 = f2 - f3;
-                            const float e3 = f2 + f3;
-                            const float e4 = f4;
-                            const float e5 = f5 - f7;
-                            const float e6 = f6;
-                            const float e7 = f5 + f7;
-                            const float e8 = f4 + f6;
-
-                            const float d0 = e0;
-                            const float d1 = e1;
-                            const float d2 = e2 * m1;
-                            const float d3 = e3;
-                            const float d4 = e4 * m2;
-                            const float d5 = e5 * m3;
-                            const float d6 = e6 * m4;
-                            const float d7 = e7;
-                            const float d8 = e8 * m5;
-
-                            const float c0 = d0 + d1;
-                            const float c1 = d0 - d1;
-                            const float c2 = d2 - d3;
-                            const float c3 = d3;
-                            const float c4 = d4 + d8;
-                            const float c5 = d5 + d7;
-                            const float c6 = d6 - d8;
-                            const float c7 = d7;
-                            const float c8 = c5 - c6;
-
-                            const float b0 = c0 + c3;
-                            const float b1 = c1 + c2;
-                            const float b2 = c1 - c2;
-                            const float b3 = c0 - c3;
-                            const float b4 = c4 - c8;
-                            const float b5 = c8;
-                            const float b6 = c6 - c7;
-                            const float b7 = c7;
-
-                            block_component[l * 8 + 0] = b0 + b7;
-                            block_component[l * 8 + 1] = b1 + b6;
-                            block_component[l * 8 + 2] = b2 + b5;
-                            block_component[l * 8 + 3] = b3 + b4;
-                            block_component[l * 8 + 4] = b3 - b4;
-                            block_component[l * 8 + 5] = b2 - b5;
-                            block_component[l * 8 + 6] = b1 - b6;
-                            block_component[l * 8 + 7] = b0 - b7;
-                        }
+                        transform_block(cindex == 0 ? block.y : (cindex == 1 ? block.cb : block.cr));
                     }
                 }
             }
@@ -986,31 +1086,44 @@ static void inverse_dct(const JPGLoadingContext& context, Vector<Macroblock>& ma
     }
 }
 
-static void ycbcr_to_rgb(const JPGLoadingContext& context, Vector<Macroblock>& macroblocks)
+static void reduced_inverse_dct(const JPGLoadingContext& context, Vector<Macroblock>& macroblocks, u32 first_vcursor, u32 end_vcursor)
 {
-    for (u32 vcursor = 0; vcursor < context.mblock_meta.vcount; vcursor += context.vsample_factor) {
+    // Reconstructs only the top-left NxN coefficients of each block with an N-point IDCT,
+    // which samples the block's cosine basis at the centers of the downscaled pixels.
+    const u8 block_size = context.scaled_block_size;
+    float cosines[8][8];
+    for (u8 x = 0; x < block_size; x++) {
+        for (u8 u = 0; u < block_size; u++) {
+            float scale = u == 0 ? 1.0f / sqrt(2) : 1.0f;
+            cosines[x][u] = scale * cos((2 * x + 1) * u * M_PI / (2 * block_size));
+        }
+    }
+
+    for (u32 vcursor = first_vcursor; vcursor < end_vcursor; vcursor += context.vsample_factor) {
         for (u32 hcursor = 0; hcursor < context.mblock_meta.hcount; hcursor += context.hsample_factor) {
-            const u32 chroma_block_index = vcursor * context.mblock_meta.hpadded_count + hcursor;
-            const Macroblock& chroma = macroblocks[chroma_block_index];
-            // Overflows are intentional.
-            for (u8 vfactor_i = context.vsample_factor - 1; vfactor_i < context.vsample_factor; --vfactor_i) {
-                for (u8 hfactor_i = context.hsample_factor - 1; hfactor_i < context.hsample_factor; --hfactor_i) {
-                    u32 mb_index = (vcursor + vfactor_i) * context.mblock_meta.hpadded_count + (hcursor + hfactor_i);
-                    i32* y = macroblocks[mb_index].y;
-                    i32* cb = macroblocks[mb_index].cb;
-                    i32* cr = macroblocks[mb_index].cr;
-                    for (u8 i = 7; i < 8; --i) {
-                        for (u8 j = 7; j < 8; --j) {
-                            const u8 pixel = i * 8 + j;
-                            const u32 chroma_pxrow = (i / context.vsample_factor) + 4 * vfactor_i;
-                            const u32 chroma_pxcol = (j / context.hsample_factor) + 4 * hfactor_i;
-                            const u32 chroma_pixel = chroma_pxrow * 8 + chroma_pxcol;
-                            int r = y[pixel] + 1.402f * chroma.cr[chroma_pixel] + 128;
-                            int g = y[pixel] - 0.344f * chroma.cb[chroma_pixel] - 0.714f * chroma.cr[chroma_pixel] + 128;
-                            int b = y[pixel] + 1.772f * chroma.cb[chroma_pixel] + 128;
-                            y[pixel] = r < 0 ? 0 : (r > 255 ? 255 : r);
-                            cb[pixel] = g < 0 ? 0 : (g > 255 ? 255 : g);
-                            cr[pixel] = b < 0 ? 0 : (b > 255 ? 255 : b);
+            for (u8 cindex = 0; cindex < context.component_count; cindex++) {
+                auto& component = context.components[cindex];
+                for (u8 vfactor_i = 0; vfactor_i < component.vsample_factor; vfactor_i++) {
+                    for (u8 hfactor_i = 0; hfactor_i < component.hsample_factor; hfactor_i++) {
+                        u32 mb_index = (vcursor + vfactor_i) * context.mblock_meta.hpadded_count + (hfactor_i + hcursor);
+                        Macroblock& block = macroblocks[mb_index];
+                        i32* block_component = cindex == 0 ? block.y : (cindex == 1 ? block.cb : block.cr);
+                        float rows[8][8];
+                        for (u8 v = 0; v < block_size; v++) {
+                            for (u8 x = 0; x < block_size; x++) {
+                                float sum = 0;
+                                for (u8 u = 0; u < block_size; u++)
+                                    sum += cosines[x][u] * block_component[v * 8 + u];
+                                rows[v][x] = sum;
+                            }
+                        }
+                        for (u8 y = 0; y < block_size; y++) {
+                            for (u8 x = 0; x < block_size; x++) {
+                                float sum = 0;
+                                for (u8 v = 0; v < block_size; v++)
+                                    sum += cosines[y][v] * rows[v][x];
+                                block_component[y * 8 + x] = round(sum / 4);
+                            }
                         }
                     }
                 }
@@ -1019,20 +1132,128 @@ static void ycbcr_to_rgb(const JPGLoadingContext& context, Vector<Macroblock>& m
     }
 }
 
-static void compose_bitmap(JPGLoadingContext& context, const Vector<Macroblock>& macroblocks)
+// Fixed-point YCbCr to RGB conversion as defined by JFIF, with 14 fraction bits so that the SSE2
+// version can multiply in 16-bit lanes. Both versions give exactly the same result.
+static constexpr int color_fraction_bits = 14;
+static constexpr i16 cr_to_r = 22970;  // 1.402
+static constexpr i16 cb_to_g = -5638;  // -0.344136
+static constexpr i16 cr_to_g = -11700; // -0.714136
+static constexpr i16 cb_to_b = 29032;  // 1.772
+
+ALWAYS_INLINE static RGBA32 ycbcr_to_rgb(i32 y, i32 cb, i32 cr)
+{
+    constexpr i32 round = 1 << (color_fraction_bits - 1);
+    y += 128;
+    const i32 r = y + ((cr * cr_to_r + round) >> color_fraction_bits);
+    const i32 g = y + ((cb * cb_to_g + cr * cr_to_g + round) >> color_fraction_bits);
+    const i32 b = y + ((cb * cb_to_b + round) >> color_fraction_bits);
+    return 0xff000000 | clamp(r, 0, 255) << 16 | clamp(g, 0, 255) << 8 | clamp(b, 0, 255);
+}
+
+#if ARCH(I386) || ARCH(X86_64)
+[[gnu::target("sse2")]] ALWAYS_INLINE static __m128i convert_channel_epi16(__m128i y_lo, __m128i y_hi, __m128i chroma_lo, __m128i chroma_hi, i16 cb_factor, i16 cr_factor)
+{
+    const __m128i round = _mm_set1_epi32(1 << (color_fraction_bits - 1));
+    const __m128i factors = _mm_set_epi16(cr_factor, cb_factor, cr_factor, cb_factor, cr_factor, cb_factor, cr_factor, cb_factor);
+    const __m128i lo = _mm_add_epi32(y_lo, _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(chroma_lo, factors), round), color_fraction_bits));
+    const __m128i hi = _mm_add_epi32(y_hi, _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(chroma_hi, factors), round), color_fraction_bits));
+    return _mm_packs_epi32(lo, hi);
+}
+
+// Converts a row of 8 pixels of a full-size block, with chroma that's either not subsampled or halved horizontally.
+[[gnu::target("sse2")]] static void ycbcr_to_rgb_row_sse2(RGBA32* out, const i32* y, const i32* cb, const i32* cr, u32 hsample_factor)
+{
+    auto* y_in = reinterpret_cast<const __m128i*>(y);
+    auto* cb_in = reinterpret_cast<const __m128i*>(cb);
+    auto* cr_in = reinterpret_cast<const __m128i*>(cr);
+    __m128i cb16, cr16;
+    if (hsample_factor == 1) {
+        cb16 = _mm_packs_epi32(_mm_loadu_si128(cb_in), _mm_loadu_si128(cb_in + 1));
+        cr16 = _mm_packs_epi32(_mm_loadu_si128(cr_in), _mm_loadu_si128(cr_in + 1));
+    } else {
+        cb16 = _mm_packs_epi32(_mm_loadu_si128(cb_in), _mm_setzero_si128());
+        cr16 = _mm_packs_epi32(_mm_loadu_si128(cr_in), _mm_setzero_si128());
+        cb16 = _mm_unpacklo_epi16(cb16, cb16);
+        cr16 = _mm_unpacklo_epi16(cr16, cr16);
+    }
+
+    const __m128i offset = _mm_set1_epi32(128);
+    const __m128i y_lo = _mm_add_epi32(_mm_loadu_si128(y_in), offset);
+    const __m128i y_hi = _mm_add_epi32(_mm_loadu_si128(y_in + 1), offset);
+    const __m128i chroma_lo = _mm_unpacklo_epi16(cb16, cr16);
+    const __m128i chroma_hi = _mm_unpackhi_epi16(cb16, cr16);
+
+    const __m128i r = convert_channel_epi16(y_lo, y_hi, chroma_lo, chroma_hi, 0, cr_to_r);
+    const __m128i g = convert_channel_epi16(y_lo, y_hi, chroma_lo, chroma_hi, cb_to_g, cr_to_g);
+    const __m128i b = convert_channel_epi16(y_lo, y_hi, chroma_lo, chroma_hi, cb_to_b, 0);
+
+    const __m128i bg = _mm_unpacklo_epi8(_mm_packus_epi16(b, b), _mm_packus_epi16(g, g));
+    const __m128i ra = _mm_unpacklo_epi8(_mm_packus_epi16(r, r), _mm_set1_epi8(-1));
+    auto* pixels = reinterpret_cast<__m128i*>(out);
+    _mm_storeu_si128(pixels, _mm_unpacklo_epi16(bg, ra));
+    _mm_storeu_si128(pixels + 1, _mm_unpackhi_epi16(bg, ra));
+}
+#endif
+
+static bool create_bitmap(JPGLoadingContext& context)
+{
+    const u32 block_size = context.scaled_block_size;
+    const u32 width = (context.frame.width * block_size + 7) / 8;
+    const u32 height = (context.frame.height * block_size + 7) / 8;
+    if (context.decode_into_shareable_bitmap)
+        context.bitmap = Bitmap::create_shareable(BitmapFormat::RGB32, { (int)width, (int)height });
+    else
+        context.bitmap = Bitmap::create_purgeable(BitmapFormat::RGB32, { (int)width, (int)height });
+    return context.bitmap;
+}
+
+// Converts the MCU rows to RGB straight into the bitmap's scanlines. The subsampled chroma
+// components live in the first block of each MCU, and are upsampled by repeating samples.
+static void compose_bitmap(JPGLoadingContext& context, const Vector<Macroblock>& macroblocks, u32 first_vcursor, u32 end_vcursor)
 {
-    context.bitmap = Bitmap::create_purgeable(BitmapFormat::RGB32, { context.frame.width, context.frame.height });
-
-    for (u32 y = context.frame.height - 1; y < context.frame.height; y--) {
-        const u32 block_row = y / 8;
-        const u32 pixel_row = y % 8;
-        for (u32 x = 0; x < context.frame.width; x++) {
-            const u32 block_column = x / 8;
-            auto& block = macroblocks[block_row * context.mblock_meta.hpadded_count + block_column];
-            const u32 pixel_column = x % 8;
-            const u32 pixel_index = pixel_row * 8 + pixel_column;
-            const Color color { (u8)block.y[pixel_index], (u8)block.cb[pixel_index], (u8)block.cr[pixel_index] };
-            context.bitmap->set_pixel(x, y, color);
+    const u32 block_size = context.scaled_block_size;
+    const u32 width = context.bitmap->width();
+    const u32 height = context.bitmap->height();
+    const u32 hpadded_count = context.mblock_meta.hpadded_count;
+    const u32 hsample_factor = context.hsample_factor;
+    const u32 vsample_factor = context.vsample_factor;
+#if ARCH(I386) || ARCH(X86_64)
+    const bool use_sse2 = block_size == 8 && has_sse2();
+#endif
+
+    for (u32 vcursor = first_vcursor; vcursor < end_vcursor; vcursor += vsample_factor) {
+        for (u32 vfactor_i = 0; vfactor_i < vsample_factor; vfactor_i++) {
+            for (u32 i = 0; i < block_size; i++) {
+                const u32 y = (vcursor + vfactor_i) * block_size + i;
+                if (y >= height)
+                    return;
+                RGBA32* scanline = context.bitmap->scanline(y);
+                const u32 chroma_row = (vfactor_i * block_size + i) / vsample_factor;
+                for (u32 hcursor = 0; hcursor < context.mblock_meta.hcount; hcursor += hsample_factor) {
+                    const Macroblock& chroma = macroblocks[vcursor * hpadded_count + hcursor];
+                    for (u32 hfactor_i = 0; hfactor_i < hsample_factor; hfactor_i++) {
+                        const u32 x = (hcursor + hfactor_i) * block_size;
+                        if (x >= width)
+                            break;
+                        const i32* luma = macroblocks[(vcursor + vfactor_i) * hpadded_count + hcursor + hfactor_i].y + i * 8;
+                        const u32 chroma_column = hfactor_i * block_size;
+                        const i32* cb = chroma.cb + chroma_row * 8;
+                        const i32* cr = chroma.cr + chroma_row * 8;
+                        const u32 count = min(block_size, width - x);
+#if ARCH(I386) || ARCH(X86_64)
+                        if (use_sse2 && count == 8) {
+                            const u32 chroma_offset = chroma_column / hsample_factor;
+                            ycbcr_to_rgb_row_sse2(scanline + x, luma, cb + chroma_offset, cr + chroma_offset, hsample_factor);
+                            continue;
+                        }
+#endif
+                        for (u32 j = 0; j < count; j++) {
+                            const u32 chroma_pixel = (chroma_column + j) / hsample_factor;
+                            scanline[x + j] = ycbcr_to_rgb(luma[j], cb[chroma_pixel], cr[chroma_pixel]);
+                        }
+                    }
+                }
+            }
         }
     }
 }
@@ -1102,69 +1323,193 @@ static bool parse_header(BufferStream& stream, JPGLoadingContext& context)
     ASSERT_NOT_REACHED();
 }
 
-static bool scan_huffman_stream(BufferStream& stream, JPGLoadingContext& context)
+static bool read_header_size(JPGLoadingContext& context)
 {
-    u8 last_byte;
-    u8 current_byte;
-    stream >> current_byte;
-    if (stream.handle_read_failure())
+    // Walks the markers up to the start of frame without building any tables, so the
+    // dimensions are known without decoding the image.
+    ByteBuffer buffer = ByteBuffer::wrap(const_cast<u8*>(context.data), context.data_size);
+    BufferStream stream(buffer);
+    if (read_marker_at_cursor(stream) != JPG_SOI)
         return false;
+    for (;;) {
+        auto marker = read_marker_at_cursor(stream);
+        switch (marker) {
+        case JPG_SOF0: {
+            read_be_word(stream);
+            u8 precision = 0;
+            stream >> precision;
+            u16 height = read_be_word(stream);
+            u16 width = read_be_word(stream);
+            if (stream.handle_read_failure() || !width || !height)
+                return false;
+            context.header_size = { width, height };
+            return true;
+        }
+        case JPG_INVALID:
+        case JPG_SOI:
+        case JPG_EOI:
+        case JPG_SOS:
+            return false;
+        default:
+            if (marker >= JPG_RST0 && marker <= JPG_RST7)
+                return false;
+            if (!skip_marker_with_length(stream))
+                return false;
+            break;
+        }
+    }
+}
 
+// Checks that everything up to the end of the start of scan segment has arrived, so the
+// header can be parsed in one go. Malformed data is left for parse_header() to report.
+static bool has_complete_header(const JPGLoadingContext& context)
+{
+    const u8* data = context.data;
+    size_t offset = 2;
     for (;;) {
-        last_byte = current_byte;
-        stream >> current_byte;
-        if (stream.handle_read_failure()) {
-            dbg() << stream.offset() << ": EOI not found!";
+        // Markers may be preceded by any number of fill bytes.
+        while (offset + 1 < context.data_size && data[offset] == 0xFF && data[offset + 1] == 0xFF)
+            ++offset;
+        if (offset + 4 > context.data_size)
+            return false;
+        if (data[offset] != 0xFF)
+            return true;
+
+        Marker marker = 0xFF00 | data[offset + 1];
+        if (marker == JPG_SOI || marker == JPG_EOI || (marker >= JPG_RST0 && marker <= JPG_RST7))
+            return true;
+
+        // Every other segment carries its length. The scan data has to start after it, too.
+        size_t segment_end = offset + 2 + (data[offset + 2] << 8 | data[offset + 3]);
+        if (segment_end >= context.data_size)
             return false;
+        if (marker == JPG_SOS)
+            return true;
+        offset = segment_end;
+    }
+}
+
+// Unstuffs the entropy-coded data received since the last call into the huffman stream,
+// stopping at the end of image marker.
+static bool scan_huffman_stream(JPGLoadingContext& context)
+{
+    const u8* data = context.data;
+    size_t offset = context.scan_offset;
+    while (!context.has_seen_end_of_image && offset < context.data_size) {
+        u8 byte = data[offset];
+        if (byte != 0xFF) {
+            context.huffman_stream.stream.append(byte);
+            ++offset;
+            continue;
         }
 
-        if (last_byte == 0xFF) {
-            if (current_byte == 0xFF)
-                continue;
-            if (current_byte == 0x00) {
-                stream >> current_byte;
-                context.huffman_stream.stream.append(last_byte);
-                continue;
+        // Wait for the byte after a 0xFF (and any fill bytes) to know what it is.
+        size_t next = offset + 1;
+        while (next < context.data_size && data[next] == 0xFF)
+            ++next;
+        if (next >= context.data_size)
+            break;
+
+        u8 code = data[next];
+        offset = next + 1;
+        if (code == 0x00) {
+            context.huffman_stream.stream.append(0xFF);
+            continue;
+        }
+        Marker marker = 0xFF00 | code;
+        if (marker == JPG_EOI) {
+            context.has_seen_end_of_image = true;
+            break;
+        }
+        if (marker >= JPG_RST0 && marker <= JPG_RST7) {
+            context.huffman_stream.stream.append(code);
+            continue;
+        }
+        dbg() << next << String::format(": Invalid marker: %x!", marker);
+        return false;
+    }
+    context.scan_offset = offset;
+
+    if (context.is_data_complete && !context.has_seen_end_of_image) {
+        dbg() << offset << ": EOI not found!";
+        return false;
+    }
+    return true;
+}
+
+// Decodes the rows of MCUs whose data has arrived and composes them into the bitmap.
+static bool decode_mcu_rows(JPGLoadingContext& context)
+{
+    auto& hstream = context.huffman_stream;
+    while (context.next_vcursor < context.mblock_meta.vcount) {
+        u32 vcursor = context.next_vcursor;
+        auto saved_byte_offset = hstream.byte_offset;
+        auto saved_bit_offset = hstream.bit_offset;
+        i32 saved_dc_values[3];
+        memcpy(saved_dc_values, context.previous_dc_values, sizeof(saved_dc_values));
+
+        if (!decode_huffman_stream_row(context, vcursor)) {
+            if (context.has_seen_end_of_image) {
+                dbg() << "Failed to decode Macroblocks in row " << vcursor;
+                dbg() << "Huffman stream byte offset " << hstream.byte_offset;
+                dbg() << "Huffman stream bit offset " << hstream.bit_offset;
+                return false;
             }
-            Marker marker = 0xFF00 | current_byte;
-            if (marker == JPG_EOI)
-                return true;
-            if (marker >= JPG_RST0 && marker <= JPG_RST7) {
-                context.huffman_stream.stream.append(marker);
-                stream >> current_byte;
-                continue;
+
+            // The rest of the row hasn't arrived yet. Rewind, and start over once it has.
+            hstream.byte_offset = saved_byte_offset;
+            hstream.bit_offset = saved_bit_offset;
+            memcpy(context.previous_dc_values, saved_dc_values, sizeof(saved_dc_values));
+            for (u32 row = vcursor; row < vcursor + context.vsample_factor; row++) {
+                for (u32 column = 0; column < context.mblock_meta.hpadded_count; column++)
+                    context.macroblocks[row * context.mblock_meta.hpadded_count + column] = {};
             }
-            dbg() << stream.offset() << String::format(": Invalid marker: %x!", marker);
-            return false;
-        } else {
-            context.huffman_stream.stream.append(last_byte);
+            return true;
         }
-    }
 
-    ASSERT_NOT_REACHED();
+        u32 end_vcursor = vcursor + context.vsample_factor;
+        dequantize(context, context.macroblocks, vcursor, end_vcursor);
+        if (context.scaled_block_size == 8)
+            inverse_dct(context, context.macroblocks, vcursor, end_vcursor);
+        else
+            reduced_inverse_dct(context, context.macroblocks, vcursor, end_vcursor);
+        compose_bitmap(context, context.macroblocks, vcursor, end_vcursor);
+        context.next_vcursor = end_vcursor;
+    }
+    return true;
 }
 
+// Decodes as much of the image as the data received so far allows. The state only reaches
+// BitmapDecoded once all of it has been decoded.
 static bool decode_jpg(JPGLoadingContext& context)
 {
-    ByteBuffer buffer = ByteBuffer::wrap(const_cast<u8*>(context.data), context.data_size);
-    BufferStream stream(buffer);
-    if (!parse_header(stream, context))
-        return false;
-    if (!scan_huffman_stream(stream, context))
-        return false;
+    if (context.state < JPGLoadingContext::State::HeaderDecoded) {
+        if (!context.is_data_complete && !has_complete_header(context))
+            return true;
 
-    auto result = decode_huffman_stream(context);
-    if (!result.has_value()) {
-        dbg() << stream.offset() << ": Failed to decode Macroblocks!";
-        return false;
+        ByteBuffer buffer = ByteBuffer::wrap(const_cast<u8*>(context.data), context.data_size);
+        BufferStream stream(buffer);
+        if (!parse_header(stream, context))
+            return false;
+        context.scan_offset = stream.offset();
+
+        prepare_huffman_stream_decoding(context);
+        if (!create_bitmap(context))
+            return false;
+        context.state = JPGLoadingContext::State::HeaderDecoded;
     }
 
-    auto macroblocks = result.release_value();
-    dbg() << String::format("%i macroblocks decoded successfully :^)", macroblocks.size());
-    dequantize(context, macroblocks);
-    inverse_dct(context, macroblocks);
-    ycbcr_to_rgb(context, macroblocks);
-    compose_bitmap(context, macroblocks);
+    if (!scan_huffman_stream(context))
+        return false;
+    if (!decode_mcu_rows(context))
+        return false;
+    if (context.next_vcursor < context.mblock_meta.vcount)
+        return true;
+
+    dbg() << String::format("%i macroblocks decoded successfully :^)", context.macroblocks.size());
+    context.macroblocks.clear();
+    context.huffman_stream.stream.clear();
+    context.state = JPGLoadingContext::State::BitmapDecoded;
     return true;
 }
 
@@ -1177,6 +1522,7 @@ static RefPtr<Gfx::Bitmap> load_jpg_impl(const u8* data, size_t data_size)
     if (!decode_jpg(context))
         return nullptr;
 
+    ASSERT(context.state == JPGLoadingContext::State::BitmapDecoded);
     return context.bitmap;
 }
 
@@ -1219,8 +1565,38 @@ IntSize JPGImageDecoderPlugin::size()
         return {};
     if (m_context->state >= JPGLoadingContext::State::FrameDecoded)
         return { m_context->frame.width, m_context->frame.height };
+    if (m_context->header_size.is_empty())
+        read_header_size(*m_context);
 
-    return {};
+    return m_context->header_size;
+}
+
+void JPGImageDecoderPlugin::set_desired_size(const IntSize& desired_size)
+{
+    // The scale is fixed once the bitmap has been created.
+    if (m_context->state >= JPGLoadingContext::State::HeaderDecoded)
+        return;
+    auto natural_size = size();
+    if (natural_size.is_empty() || desired_size.is_empty())
+        return;
+
+    // Pick the smallest supported scale that still covers the desired size.
+    u8 block_size = 1;
+    while (block_size < 8) {
+        int width = (natural_size.width() * block_size + 7) / 8;
+        int height = (natural_size.height() * block_size + 7) / 8;
+        if (width >= desired_size.width() && height >= desired_size.height())
+            break;
+        block_size *= 2;
+    }
+    m_context->scaled_block_size = block_size;
+}
+
+void JPGImageDecoderPlugin::set_decode_into_shareable_bitmap(bool shareable)
+{
+    if (m_context->state >= JPGLoadingContext::State::HeaderDecoded)
+        return;
+    m_context->decode_into_shareable_bitmap = shareable;
 }
 
 RefPtr<Gfx::Bitmap> JPGImageDecoderPlugin::bitmap()
@@ -1232,12 +1608,42 @@ RefPtr<Gfx::Bitmap> JPGImageDecoderPlugin::bitmap()
             m_context->state = JPGLoadingContext::State::Error;
             return nullptr;
         }
-        m_context->state = JPGLoadingContext::State::BitmapDecoded;
+        // Still waiting for the rest of the data.
+        if (m_context->state < JPGLoadingContext::State::BitmapDecoded)
+            return nullptr;
     }
 
     return m_context->bitmap;
 }
 
+void JPGImageDecoderPlugin::did_receive_data(const u8* data, size_t size, bool is_complete)
+{
+    m_context->data = data;
+    m_context->data_size = size;
+    m_context->is_data_complete = is_complete;
+
+    if (m_context->state == JPGLoadingContext::State::Error || m_context->state >= JPGLoadingContext::State::BitmapDecoded)
+        return;
+    if (!decode_jpg(*m_context))
+        m_context->state = JPGLoadingContext::State::Error;
+}
+
+int JPGImageDecoderPlugin::decoded_row_count()
+{
+    if (m_context->state < JPGLoadingContext::State::HeaderDecoded || !m_context->bitmap)
+        return 0;
+    if (m_context->state >= JPGLoadingContext::State::BitmapDecoded)
+        return m_context->bitmap->height();
+    return min<int>(m_context->next_vcursor * m_context->scaled_block_size, m_context->bitmap->height());
+}
+
+RefPtr<Gfx::Bitmap> JPGImageDecoderPlugin::partial_bitmap()
+{
+    if (m_context->state < JPGLoadingContext::State::HeaderDecoded)
+        return nullptr;
+    return m_context->bitmap;
+}
+
 void JPGImageDecoderPlugin::set_volatile()
 {
     if (m_context->bitmap)
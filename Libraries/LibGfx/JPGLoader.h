@@ -44,6 +44,8 @@ public:
     JPGImageDecoderPlugin(const u8*, size_t);
     virtual IntSize size() override;
     virtual RefPtr<Gfx::Bitmap> bitmap() override;
+    virtual void set_desired_size(const IntSize&) override;
+    virtual void set_decode_into_shareable_bitmap(bool) override;
     virtual void set_volatile() override;
     [[nodiscard]] virtual bool set_nonvolatile() override;
     virtual bool sniff() override;
@@ -52,6 +54,11 @@ public:
     virtual size_t frame_count() override;
     virtual ImageFrameDescriptor frame(size_t i) override;
 
+    virtual bool supports_incremental_decoding() const override { return true; }
+    virtual void did_receive_data(const u8*, size_t, bool is_complete) override;
+    virtual int decoded_row_count() override;
+    virtual RefPtr<Gfx::Bitmap> partial_bitmap() override;
+
 private:
     OwnPtr<JPGLoadingContext> m_context;
 };
@@ -28,7 +28,9 @@
 #include <AK/LexicalPath.h>
 #include <AK/MappedFile.h>
 #include <AK/NetworkOrdered.h>
-#include <LibCore/puff.h>
+#include <AK/NumericLimits.h>
+#include <AK/OwnPtr.h>
+#include <LibCompress/Zlib.h>
 #include <LibGfx/PNGLoader.h>
 #include <fcntl.h>
 #include <math.h>
@@ -103,6 +105,12 @@ enum PngInterlaceMethod {
 };
 
 struct PNGLoadingContext {
+    ~PNGLoadingContext()
+    {
+        if (decompression_buffer)
+            munmap(decompression_buffer, decompression_buffer_size);
+    }
+
     enum State {
         NotDecoded = 0,
         Error,
@@ -123,6 +131,7 @@ struct PNGLoadingContext {
     u8 interlace_method { 0 };
     u8 channels { 0 };
     bool has_seen_zlib_header { false };
+    bool decode_into_shareable_bitmap { false };
     bool has_alpha() const { return color_type & 4 || palette_transparency_data.size() > 0; }
     Vector<Scanline> scanlines;
     RefPtr<Gfx::Bitmap> bitmap;
@@ -131,6 +140,14 @@ struct PNGLoadingContext {
     Vector<u8> compressed_data;
     Vector<PaletteEntry> palette_data;
     Vector<u8> palette_transparency_data;
+
+    // When the data is fed in as it arrives, chunks are processed up to the first incomplete one,
+    // and the image data is inflated and unfiltered as far as it goes.
+    bool is_data_complete { true };
+    size_t chunk_offset { sizeof(png_header) };
+    OwnPtr<Compress::ZlibDecompressor> decompressor;
+    size_t decompressed_size { 0 };
+    int decoded_row_count { 0 };
 };
 
 class Streamer {
@@ -173,6 +190,7 @@ public:
     }
 
     bool at_end() const { return !m_size_remaining; }
+    size_t size_remaining() const { return m_size_remaining; }
 
 private:
     const u8* m_data_ptr { nullptr };
@@ -182,6 +200,16 @@ private:
 static RefPtr<Gfx::Bitmap> load_png_impl(const u8*, size_t);
 static bool process_chunk(Streamer&, PNGLoadingContext& context);
 
+static bool has_complete_chunk(const Streamer& streamer)
+{
+    // Length, type, data and CRC.
+    Streamer peeker = streamer;
+    u32 chunk_size;
+    if (!peeker.read(chunk_size))
+        return false;
+    return peeker.size_remaining() >= 4 + (u64)chunk_size + 4;
+}
+
 RefPtr<Gfx::Bitmap> load_png(const StringView& path)
 {
     MappedFile mapped_file(path);
@@ -310,9 +338,9 @@ ALWAYS_INLINE static void unfilter_impl(Gfx::Bitmap& bitmap, int y, const void*
 }
 
 template<typename T>
-ALWAYS_INLINE static void unpack_grayscale_without_alpha(PNGLoadingContext& context)
+ALWAYS_INLINE static void unpack_grayscale_without_alpha(PNGLoadingContext& context, int first_row, int end_row)
 {
-    for (int y = 0; y < context.height; ++y) {
+    for (int y = first_row; y < end_row; ++y) {
         auto* gray_values = reinterpret_cast<const T*>(context.scanlines[y].data.data());
         for (int i = 0; i < context.width; ++i) {
             auto& pixel = (Pixel&)context.bitmap->scanline(y)[i];
@@ -325,9 +353,9 @@ ALWAYS_INLINE static void unpack_grayscale_without_alpha(PNGLoadingContext& cont
 }
 
 template<typename T>
-ALWAYS_INLINE static void unpack_grayscale_with_alpha(PNGLoadingContext& context)
+ALWAYS_INLINE static void unpack_grayscale_with_alpha(PNGLoadingContext& context, int first_row, int end_row)
 {
-    for (int y = 0; y < context.height; ++y) {
+    for (int y = first_row; y < end_row; ++y) {
         auto* tuples = reinterpret_cast<const Tuple<T>*>(context.scanlines[y].data.data());
         for (int i = 0; i < context.width; ++i) {
             auto& pixel = (Pixel&)context.bitmap->scanline(y)[i];
@@ -340,9 +368,9 @@ ALWAYS_INLINE static void unpack_grayscale_with_alpha(PNGLoadingContext& context
 }
 
 template<typename T>
-ALWAYS_INLINE static void unpack_triplets_without_alpha(PNGLoadingContext& context)
+ALWAYS_INLINE static void unpack_triplets_without_alpha(PNGLoadingContext& context, int first_row, int end_row)
 {
-    for (int y = 0; y < context.height; ++y) {
+    for (int y = first_row; y < end_row; ++y) {
         auto* triplets = reinterpret_cast<const Triplet<T>*>(context.scanlines[y].data.data());
         for (int i = 0; i < context.width; ++i) {
             auto& pixel = (Pixel&)context.bitmap->scanline(y)[i];
@@ -354,20 +382,22 @@ ALWAYS_INLINE static void unpack_triplets_without_alpha(PNGLoadingContext& conte
     }
 }
 
-NEVER_INLINE FLATTEN static void unfilter(PNGLoadingContext& context)
+// Unpacks and unfilters the scanlines in [first_row, end_row). Earlier rows must already be done,
+// since the filters predict from the row above.
+NEVER_INLINE FLATTEN static void unfilter(PNGLoadingContext& context, int first_row, int end_row)
 {
     // First unpack the scanlines to RGBA:
     switch (context.color_type) {
     case 0:
         if (context.bit_depth == 8) {
-            unpack_grayscale_without_alpha<u8>(context);
+            unpack_grayscale_without_alpha<u8>(context, first_row, end_row);
         } else if (context.bit_depth == 16) {
-            unpack_grayscale_without_alpha<u16>(context);
+            unpack_grayscale_without_alpha<u16>(context, first_row, end_row);
         } else if (context.bit_depth == 1 || context.bit_depth == 2 || context.bit_depth == 4) {
             auto bit_depth_squared = context.bit_depth * context.bit_depth;
             auto pixels_per_byte = 8 / context.bit_depth;
             auto mask = (1 << context.bit_depth) - 1;
-            for (int y = 0; y < context.height; ++y) {
+            for (int y = first_row; y < end_row; ++y) {
                 auto* gray_values = (u8*)context.scanlines[y].data.data();
                 for (int x = 0; x < context.width; ++x) {
                     auto bit_offset = (8 - context.bit_depth) - (context.bit_depth * (x % pixels_per_byte));
@@ -385,29 +415,29 @@ NEVER_INLINE FLATTEN static void unfilter(PNGLoadingContext& context)
         break;
     case 4:
         if (context.bit_depth == 8) {
-            unpack_grayscale_with_alpha<u8>(context);
+            unpack_grayscale_with_alpha<u8>(context, first_row, end_row);
         } else if (context.bit_depth == 16) {
-            unpack_grayscale_with_alpha<u16>(context);
+            unpack_grayscale_with_alpha<u16>(context, first_row, end_row);
         } else {
             ASSERT_NOT_REACHED();
         }
         break;
     case 2:
         if (context.bit_depth == 8) {
-            unpack_triplets_without_alpha<u8>(context);
+            unpack_triplets_without_alpha<u8>(context, first_row, end_row);
         } else if (context.bit_depth == 16) {
-            unpack_triplets_without_alpha<u16>(context);
+            unpack_triplets_without_alpha<u16>(context, first_row, end_row);
         } else {
             ASSERT_NOT_REACHED();
         }
         break;
     case 6:
         if (context.bit_depth == 8) {
-            for (int y = 0; y < context.height; ++y) {
+            for (int y = first_row; y < end_row; ++y) {
                 memcpy(context.bitmap->scanline(y), context.scanlines[y].data.data(), context.scanlines[y].data.size());
             }
         } else if (context.bit_depth == 16) {
-            for (int y = 0; y < context.height; ++y) {
+            for (int y = first_row; y < end_row; ++y) {
                 auto* triplets = reinterpret_cast<const Quad<u16>*>(context.scanlines[y].data.data());
                 for (int i = 0; i < context.width; ++i) {
                     auto& pixel = (Pixel&)context.bitmap->scanline(y)[i];
@@ -423,7 +453,7 @@ NEVER_INLINE FLATTEN static void unfilter(PNGLoadingContext& context)
         break;
     case 3:
         if (context.bit_depth == 8) {
-            for (int y = 0; y < context.height; ++y) {
+            for (int y = first_row; y < end_row; ++y) {
                 auto* palette_index = (u8*)context.scanlines[y].data.data();
                 for (int i = 0; i < context.width; ++i) {
                     auto& pixel = (Pixel&)context.bitmap->scanline(y)[i];
@@ -440,7 +470,7 @@ NEVER_INLINE FLATTEN static void unfilter(PNGLoadingContext& context)
         } else if (context.bit_depth == 1 || context.bit_depth == 2 || context.bit_depth == 4) {
             auto pixels_per_byte = 8 / context.bit_depth;
             auto mask = (1 << context.bit_depth) - 1;
-            for (int y = 0; y < context.height; ++y) {
+            for (int y = first_row; y < end_row; ++y) {
                 auto* palette_indexes = (u8*)context.scanlines[y].data.data();
                 for (int i = 0; i < context.width; ++i) {
                     auto bit_offset = (8 - context.bit_depth) - (context.bit_depth * (i % pixels_per_byte));
@@ -467,7 +497,7 @@ NEVER_INLINE FLATTEN static void unfilter(PNGLoadingContext& context)
 
     auto dummy_scanline = ByteBuffer::create_zeroed(context.width * sizeof(RGBA32));
 
-    for (int y = 0; y < context.height; ++y) {
+    for (int y = first_row; y < end_row; ++y) {
         auto filter = context.scanlines[y].filter;
         if (filter == 0) {
             if (context.has_alpha())
@@ -542,6 +572,10 @@ static bool decode_png_size(PNGLoadingContext& context)
             return false;
     }
 
+    // Partial data is walked by decode_png_chunks() as it arrives, which picks up the size on the way.
+    if (!context.is_data_complete)
+        return false;
+
     const u8* data_ptr = context.data + sizeof(png_header);
     size_t data_remaining = context.data_size - sizeof(png_header);
 
@@ -570,28 +604,62 @@ static bool decode_png_chunks(PNGLoadingContext& context)
             return false;
     }
 
-    const u8* data_ptr = context.data + sizeof(png_header);
-    int data_remaining = context.data_size - sizeof(png_header);
-
     context.compressed_data.ensure_capacity(context.data_size);
 
-    Streamer streamer(data_ptr, data_remaining);
+    Streamer streamer(context.data + context.chunk_offset, context.data_size - context.chunk_offset);
     while (!streamer.at_end()) {
+        // Leave a chunk that hasn't fully arrived for the next call.
+        if (!context.is_data_complete && !has_complete_chunk(streamer))
+            return false;
         if (!process_chunk(streamer, context)) {
             context.state = PNGLoadingContext::State::Error;
             return false;
         }
+        context.chunk_offset = context.data_size - streamer.size_remaining();
     }
 
+    if (!context.is_data_complete)
+        return false;
+
     context.state = PNGLoadingContext::State::ChunksDecoded;
     return true;
 }
 
-static bool decode_png_bitmap_simple(PNGLoadingContext& context)
+static void release_decompression_buffer(PNGLoadingContext& context)
 {
-    Streamer streamer(context.decompression_buffer, context.decompression_buffer_size);
+    if (context.decompression_buffer)
+        munmap(context.decompression_buffer, context.decompression_buffer_size);
+    context.decompression_buffer = nullptr;
+    context.decompression_buffer_size = 0;
+    context.decompressed_size = 0;
+}
+
+// Unfilters every scanline that has been fully inflated since the last call.
+static RefPtr<Bitmap> create_bitmap(const PNGLoadingContext& context)
+{
+    auto format = context.has_alpha() ? BitmapFormat::RGBA32 : BitmapFormat::RGB32;
+    if (context.decode_into_shareable_bitmap)
+        return Bitmap::create_shareable(format, { context.width, context.height });
+    return Bitmap::create_purgeable(format, { context.width, context.height });
+}
+
+static bool decode_png_rows(PNGLoadingContext& context)
+{
+    auto row_size = ((context.width * context.channels * context.bit_depth) + 7) / 8;
+    int available_rows = min<size_t>(context.decompressed_size / (1 + row_size), context.height);
+    if (available_rows <= context.decoded_row_count)
+        return true;
 
-    for (int y = 0; y < context.height; ++y) {
+    if (!context.bitmap) {
+        context.bitmap = create_bitmap(context);
+        if (!context.bitmap) {
+            context.state = PNGLoadingContext::State::Error;
+            return false;
+        }
+    }
+
+    Streamer streamer(context.decompression_buffer + context.decoded_row_count * (1 + row_size), (available_rows - context.decoded_row_count) * (1 + row_size));
+    for (int y = context.decoded_row_count; y < available_rows; ++y) {
         u8 filter;
         if (!streamer.read(filter)) {
             context.state = PNGLoadingContext::State::Error;
@@ -606,17 +674,14 @@ static bool decode_png_bitmap_simple(PNGLoadingContext& context)
 
         context.scanlines.append({ filter });
         auto& scanline_buffer = context.scanlines.last().data;
-        auto row_size = ((context.width * context.channels * context.bit_depth) + 7) / 8;
         if (!streamer.wrap_bytes(scanline_buffer, row_size)) {
             context.state = PNGLoadingContext::State::Error;
             return false;
         }
     }
 
-    context.bitmap = Bitmap::create_purgeable(context.has_alpha() ? BitmapFormat::RGBA32 : BitmapFormat::RGB32, { context.width, context.height });
-
-    unfilter(context);
-
+    unfilter(context, context.decoded_row_count, available_rows);
+    context.decoded_row_count = available_rows;
     return true;
 }
 
@@ -710,7 +775,7 @@ static bool decode_adam7_pass(PNGLoadingContext& context, Streamer& streamer, in
     }
 
     subimage_context.bitmap = Bitmap::create(context.bitmap->format(), { subimage_context.width, subimage_context.height });
-    unfilter(subimage_context);
+    unfilter(subimage_context, 0, subimage_context.height);
 
     // Copy the subimage data into the main image according to the pass pattern
     for (int y = 0, dy = adam7_starty[pass]; y < subimage_context.height && dy < context.height; ++y, dy += adam7_stepy[pass]) {
@@ -724,7 +789,7 @@ static bool decode_adam7_pass(PNGLoadingContext& context, Streamer& streamer, in
 static bool decode_png_adam7(PNGLoadingContext& context)
 {
     Streamer streamer(context.decompression_buffer, context.decompression_buffer_size);
-    context.bitmap = Bitmap::create_purgeable(context.has_alpha() ? BitmapFormat::RGBA32 : BitmapFormat::RGB32, { context.width, context.height });
+    context.bitmap = create_bitmap(context);
 
     for (int pass = 1; pass <= 7; ++pass) {
         if (!decode_adam7_pass(context, streamer, pass))
@@ -733,6 +798,70 @@ static bool decode_png_adam7(PNGLoadingContext& context)
     return true;
 }
 
+static u64 scanline_data_size(PNGLoadingContext& context, u64 width, u64 height)
+{
+    if (!width || !height)
+        return 0;
+    // Every scanline starts with its filter type byte.
+    return height * (1 + (width * context.channels * context.bit_depth + 7) / 8);
+}
+
+static Optional<size_t> decompressed_data_size(PNGLoadingContext& context)
+{
+    if (context.width <= 0 || context.height <= 0)
+        return {};
+
+    u64 size = 0;
+    if (context.interlace_method == PngInterlaceMethod::Adam7) {
+        for (int pass = 1; pass <= 7; ++pass)
+            size += scanline_data_size(context, adam7_width(context, pass), adam7_height(context, pass));
+    } else {
+        size = scanline_data_size(context, context.width, context.height);
+    }
+
+    // Images this large can't be turned into a bitmap anyway.
+    if (size > (u64)NumericLimits<i32>::max())
+        return {};
+    return size;
+}
+
+// Inflates the image data received so far into the decompression buffer.
+static bool inflate_available_data(PNGLoadingContext& context)
+{
+    if (!context.decompression_buffer) {
+        auto decompressed_size = decompressed_data_size(context);
+        if (!decompressed_size.has_value())
+            return false;
+        context.decompression_buffer_size = decompressed_size.value();
+#ifdef __serenity__
+        context.decompression_buffer = (u8*)mmap_with_name(nullptr, context.decompression_buffer_size, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE, 0, 0, "PNG decompression buffer");
+#else
+        context.decompression_buffer = (u8*)mmap(nullptr, context.decompression_buffer_size, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE, 0, 0);
+#endif
+        if (context.decompression_buffer == MAP_FAILED) {
+            context.decompression_buffer = nullptr;
+            context.decompression_buffer_size = 0;
+            return false;
+        }
+        context.scanlines.ensure_capacity(context.height);
+    }
+
+    // The scanline layout tells us exactly how much data to expect, so inflate straight into the buffer.
+    bool has_all_data = context.state >= PNGLoadingContext::State::ChunksDecoded;
+    if (!context.decompressor)
+        context.decompressor = make<Compress::ZlibDecompressor>();
+    context.decompressor->set_input(context.compressed_data.span(), has_all_data);
+    context.decompressed_size += context.decompressor->read({ context.decompression_buffer + context.decompressed_size, context.decompression_buffer_size - context.decompressed_size });
+    if (context.decompressor->has_error())
+        return false;
+    if (!has_all_data)
+        return true;
+
+    context.decompressor = nullptr;
+    context.compressed_data.clear();
+    return context.decompressed_size == context.decompression_buffer_size;
+}
+
 static bool decode_png_bitmap(PNGLoadingContext& context)
 {
     if (context.state < PNGLoadingContext::State::ChunksDecoded) {
@@ -743,31 +872,15 @@ static bool decode_png_bitmap(PNGLoadingContext& context)
     if (context.state >= PNGLoadingContext::State::BitmapDecoded)
         return true;
 
-    unsigned long srclen = context.compressed_data.size() - 6;
-    unsigned long destlen = 0;
-    int ret = puff(NULL, &destlen, context.compressed_data.data() + 2, &srclen);
-    if (ret != 0) {
-        context.state = PNGLoadingContext::State::Error;
-        return false;
-    }
-    context.decompression_buffer_size = destlen;
-#ifdef __serenity__
-    context.decompression_buffer = (u8*)mmap_with_name(nullptr, context.decompression_buffer_size, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE, 0, 0, "PNG decompression buffer");
-#else
-    context.decompression_buffer = (u8*)mmap(nullptr, context.decompression_buffer_size, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE, 0, 0);
-#endif
-
-    ret = puff(context.decompression_buffer, &destlen, context.compressed_data.data() + 2, &srclen);
-    if (ret != 0) {
+    if (!inflate_available_data(context)) {
+        release_decompression_buffer(context);
         context.state = PNGLoadingContext::State::Error;
         return false;
     }
-    context.compressed_data.clear();
 
-    context.scanlines.ensure_capacity(context.height);
     switch (context.interlace_method) {
     case PngInterlaceMethod::Null:
-        if (!decode_png_bitmap_simple(context))
+        if (!decode_png_rows(context))
             return false;
         break;
     case PngInterlaceMethod::Adam7:
@@ -778,14 +891,37 @@ static bool decode_png_bitmap(PNGLoadingContext& context)
         ASSERT_NOT_REACHED();
     }
 
-    munmap(context.decompression_buffer, context.decompression_buffer_size);
-    context.decompression_buffer = nullptr;
-    context.decompression_buffer_size = 0;
+    release_decompression_buffer(context);
 
     context.state = PNGLoadingContext::State::BitmapDecoded;
     return true;
 }
 
+// Decodes as much of a partially received image as possible. Only non-interlaced images are decoded
+// row by row, since Adam7 spreads every row across all seven passes.
+static bool decode_png_incrementally(PNGLoadingContext& context)
+{
+    if (context.data_size < sizeof(png_header))
+        return true;
+    if (!decode_png_header(context))
+        return false;
+
+    if (!decode_png_chunks(context) && context.state == PNGLoadingContext::State::Error)
+        return false;
+    if (context.state < PNGLoadingContext::State::SizeDecoded && context.width > 0 && context.height > 0)
+        context.state = PNGLoadingContext::State::SizeDecoded;
+
+    if (context.interlace_method != PngInterlaceMethod::Null || context.compressed_data.is_empty())
+        return true;
+
+    if (!inflate_available_data(context)) {
+        release_decompression_buffer(context);
+        context.state = PNGLoadingContext::State::Error;
+        return false;
+    }
+    return decode_png_rows(context);
+}
+
 static RefPtr<Gfx::Bitmap> load_png_impl(const u8* data, size_t data_size)
 {
     PNGLoadingContext context;
@@ -950,6 +1086,13 @@ RefPtr<Gfx::Bitmap> PNGImageDecoderPlugin::bitmap()
     return m_context->bitmap;
 }
 
+void PNGImageDecoderPlugin::set_decode_into_shareable_bitmap(bool shareable)
+{
+    if (m_context->bitmap)
+        return;
+    m_context->decode_into_shareable_bitmap = shareable;
+}
+
 void PNGImageDecoderPlugin::set_volatile()
 {
     if (m_context->bitmap)
@@ -963,6 +1106,39 @@ bool PNGImageDecoderPlugin::set_nonvolatile()
     return m_context->bitmap->set_nonvolatile();
 }
 
+void PNGImageDecoderPlugin::did_receive_data(const u8* data, size_t size, bool is_complete)
+{
+    m_context->data = data;
+    m_context->data_size = size;
+    m_context->is_data_complete = is_complete;
+
+    if (m_context->state == PNGLoadingContext::State::Error || m_context->state >= PNGLoadingContext::State::BitmapDecoded)
+        return;
+
+    if (is_complete) {
+        decode_png_bitmap(*m_context);
+        return;
+    }
+    if (!decode_png_incrementally(*m_context))
+        m_context->state = PNGLoadingContext::State::Error;
+}
+
+int PNGImageDecoderPlugin::decoded_row_count()
+{
+    if (m_context->state == PNGLoadingContext::State::Error)
+        return 0;
+    if (m_context->state >= PNGLoadingContext::State::BitmapDecoded)
+        return m_context->height;
+    return m_context->decoded_row_count;
+}
+
+RefPtr<Gfx::Bitmap> PNGImageDecoderPlugin::partial_bitmap()
+{
+    if (m_context->state == PNGLoadingContext::State::Error)
+        return nullptr;
+    return m_context->bitmap;
+}
+
 bool PNGImageDecoderPlugin::sniff()
 {
     return decode_png_header(*m_context);
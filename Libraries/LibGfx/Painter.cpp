@@ -41,12 +41,365 @@
 #include <math.h>
 #include <stdio.h>
 
+#if ARCH(I386) || ARCH(X86_64)
+#    include <cpuid.h>
+#    include <emmintrin.h>
+#endif
+
 #if defined(__GNUC__) && !defined(__clang__)
 #    pragma GCC optimize("O3")
 #endif
 
 namespace Gfx {
 
+// Scanline kernels for the blending loops that every repaint goes through. The SSE2 versions are picked
+// at runtime and give exactly the same result as Color::blend() as long as the destination is opaque,
+// which it is for the compositor and most backing stores. Groups of pixels with a translucent destination
+// go through Color::blend() instead. The kernel doesn't save AVX state, so there are no AVX versions.
+
+static bool has_sse2()
+{
+#if ARCH(I386) || ARCH(X86_64)
+    static bool s_has_sse2 = [] {
+        unsigned eax, ebx, ecx, edx;
+        return __get_cpuid(1, &eax, &ebx, &ecx, &edx) && (edx & bit_SSE2);
+    }();
+    return s_has_sse2;
+#else
+    return false;
+#endif
+}
+
+// Separable filter for one axis of a scaled blit: for every destination column (or row) in the clipped range,
+// the source pixels that contribute to it and their weights, in 1.14 fixed point and summing to exactly 1.
+struct ScaleFilter {
+    struct Tap {
+        int first;
+        int count;
+    };
+    int max_taps { 0 };
+    Vector<Tap> taps;
+    Vector<i16> weights;
+};
+
+static constexpr int scale_filter_weight_bits = 14;
+// Horizontally filtered channels are kept with 7 fractional bits, so that they still fit in 16 bits
+// and the vertical pass can't overflow 32 bits.
+static constexpr int scale_filter_intermediate_shift = scale_filter_weight_bits - 7;
+static constexpr int scale_filter_output_shift = scale_filter_weight_bits + 7;
+
+ALWAYS_INLINE static u16 div_255(u32 value)
+{
+    return (value + 1 + (value >> 8)) >> 8;
+}
+
+ALWAYS_INLINE static void resample_pixel_vertically(RGBA32* dst, const i16* const* rows, const i16* weights, int count, size_t index)
+{
+    RGBA32 pixel = 0;
+    for (int channel = 0; channel < 4; ++channel) {
+        i32 sum = 0;
+        for (int k = 0; k < count; ++k)
+            sum += rows[k][index * 4 + channel] * weights[k];
+        sum = (sum + (1 << (scale_filter_output_shift - 1))) >> scale_filter_output_shift;
+        pixel |= (RGBA32)max(0, min(255, sum)) << (channel * 8);
+    }
+    *dst = pixel;
+}
+
+ALWAYS_INLINE static void blend_pixel(RGBA32& dst, RGBA32 src)
+{
+    u8 alpha = Color::from_rgba(src).alpha();
+    if (alpha == 0xff)
+        dst = src;
+    else if (alpha)
+        dst = Color::from_rgba(dst).blend(Color::from_rgba(src)).value();
+}
+
+#if ARCH(I386) || ARCH(X86_64)
+// Each 8-bit channel is widened to 16 bits, and (x + 1 + (x >> 8)) >> 8 is x / 255 for all x <= 255 * 255.
+[[gnu::target("sse2")]] ALWAYS_INLINE static __m128i div_255_epu16(__m128i x)
+{
+    return _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(x, _mm_set1_epi16(1)), _mm_srli_epi16(x, 8)), 8);
+}
+
+[[gnu::target("sse2")]] ALWAYS_INLINE static __m128i broadcast_alpha_epi16(__m128i pixels)
+{
+    return _mm_shufflehi_epi16(_mm_shufflelo_epi16(pixels, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+}
+
+// Blends four source pixels over four opaque destination pixels with the given per-channel alphas.
+[[gnu::target("sse2")]] ALWAYS_INLINE static __m128i blend_opaque_epu8(__m128i dst, __m128i src, __m128i alpha_lo, __m128i alpha_hi)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i max = _mm_set1_epi16(255);
+    __m128i lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(src, zero), alpha_lo), _mm_mullo_epi16(_mm_unpacklo_epi8(dst, zero), _mm_sub_epi16(max, alpha_lo)));
+    __m128i hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(src, zero), alpha_hi), _mm_mullo_epi16(_mm_unpackhi_epi8(dst, zero), _mm_sub_epi16(max, alpha_hi)));
+    return _mm_or_si128(_mm_packus_epi16(div_255_epu16(lo), div_255_epu16(hi)), _mm_set1_epi32(0xff000000));
+}
+
+[[gnu::target("sse2")]] ALWAYS_INLINE static bool all_alphas_equal(__m128i pixels, u8 alpha)
+{
+    const __m128i alpha_mask = _mm_set1_epi32(0xff000000);
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(pixels, alpha_mask), _mm_set1_epi32((u32)alpha << 24))) == 0xffff;
+}
+
+[[gnu::target("sse2")]] static void blend_scanline_sse2(RGBA32* dst, const RGBA32* src, size_t count)
+{
+    const __m128i zero = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i s = _mm_loadu_si128((const __m128i*)(src + i));
+        if (all_alphas_equal(s, 0))
+            continue;
+        if (all_alphas_equal(s, 0xff)) {
+            _mm_storeu_si128((__m128i*)(dst + i), s);
+            continue;
+        }
+        __m128i d = _mm_loadu_si128((const __m128i*)(dst + i));
+        if (!all_alphas_equal(d, 0xff)) {
+            for (size_t j = i; j < i + 4; ++j)
+                blend_pixel(dst[j], src[j]);
+            continue;
+        }
+        __m128i alpha_lo = broadcast_alpha_epi16(_mm_unpacklo_epi8(s, zero));
+        __m128i alpha_hi = broadcast_alpha_epi16(_mm_unpackhi_epi8(s, zero));
+        _mm_storeu_si128((__m128i*)(dst + i), blend_opaque_epu8(d, s, alpha_lo, alpha_hi));
+    }
+    for (; i < count; ++i)
+        blend_pixel(dst[i], src[i]);
+}
+
+// Both the source and the destination are treated as opaque.
+[[gnu::target("sse2")]] static void blend_scanline_with_opacity_sse2(RGBA32* dst, const RGBA32* src, size_t count, u8 alpha)
+{
+    const __m128i alpha16 = _mm_set1_epi16(alpha);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i s = _mm_loadu_si128((const __m128i*)(src + i));
+        __m128i d = _mm_loadu_si128((const __m128i*)(dst + i));
+        _mm_storeu_si128((__m128i*)(dst + i), blend_opaque_epu8(d, s, alpha16, alpha16));
+    }
+    for (; i < count; ++i) {
+        Color src_color_with_alpha = Color::from_rgb(src[i]);
+        src_color_with_alpha.set_alpha(alpha);
+        dst[i] = Color::from_rgb(dst[i]).blend(src_color_with_alpha).value();
+    }
+}
+
+[[gnu::target("sse2")]] static void blend_scanline_with_color_sse2(RGBA32* dst, size_t count, Color color)
+{
+    const __m128i color_pixels = _mm_set1_epi32(color.value());
+    const __m128i alpha16 = _mm_set1_epi16(color.alpha());
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i d = _mm_loadu_si128((const __m128i*)(dst + i));
+        if (!all_alphas_equal(d, 0xff)) {
+            for (size_t j = i; j < i + 4; ++j)
+                dst[j] = Color::from_rgba(dst[j]).blend(color).value();
+            continue;
+        }
+        _mm_storeu_si128((__m128i*)(dst + i), blend_opaque_epu8(d, color_pixels, alpha16, alpha16));
+    }
+    for (; i < count; ++i)
+        dst[i] = Color::from_rgba(dst[i]).blend(color).value();
+}
+
+[[gnu::target("sse2")]] static void fill_scanline_sse2(RGBA32* dst, RGBA32 value, size_t count)
+{
+    const __m128i pixels = _mm_set1_epi32(value);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+        _mm_storeu_si128((__m128i*)(dst + i), pixels);
+    for (; i < count; ++i)
+        dst[i] = value;
+}
+
+[[gnu::target("sse2")]] static void copy_scanline_sse2(RGBA32* dst, const RGBA32* src, size_t count)
+{
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_loadu_si128((const __m128i*)(src + i)));
+    for (; i < count; ++i)
+        dst[i] = src[i];
+}
+
+[[gnu::target("sse2")]] static void fill_scanline_with_mask_sse2(RGBA32* dst, const u8* mask, size_t count, RGBA32 value)
+{
+    const __m128i pixels = _mm_set1_epi32(value);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        u32 mask_bytes;
+        memcpy(&mask_bytes, mask + i, sizeof(mask_bytes));
+        if (!mask_bytes)
+            continue;
+        // Widen each 0x00/0xff mask byte into a whole pixel and use it to select between the color and the destination.
+        __m128i pixel_mask = _mm_cvtsi32_si128(mask_bytes);
+        pixel_mask = _mm_unpacklo_epi8(pixel_mask, pixel_mask);
+        pixel_mask = _mm_unpacklo_epi16(pixel_mask, pixel_mask);
+        __m128i d = _mm_loadu_si128((const __m128i*)(dst + i));
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_or_si128(_mm_and_si128(pixel_mask, pixels), _mm_andnot_si128(pixel_mask, d)));
+    }
+    for (; i < count; ++i) {
+        if (mask[i])
+            dst[i] = value;
+    }
+}
+
+// The resampling kernels below work on 16-bit channels: a source pixel is widened to 4x16 bits, optionally
+// premultiplied, and every channel is multiplied by a 14-bit weight with _mm_madd_epi16() against a zero
+// neighbour, which zero-extends it to 32 bits for free.
+[[gnu::target("sse2")]] ALWAYS_INLINE static __m128i premultiply_epi16(__m128i pixel)
+{
+    const __m128i alpha_lane = _mm_set_epi16(0, 0, 0, 0, -1, 0, 0, 0);
+    __m128i premultiplied = div_255_epu16(_mm_mullo_epi16(pixel, broadcast_alpha_epi16(pixel)));
+    return _mm_or_si128(_mm_and_si128(alpha_lane, pixel), _mm_andnot_si128(alpha_lane, premultiplied));
+}
+
+[[gnu::target("sse2")]] static void resample_row_horizontally_sse2(i16* dst, const RGBA32* src, const ScaleFilter& filter, bool premultiply)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i rounding = _mm_set1_epi32(1 << (scale_filter_intermediate_shift - 1));
+    for (size_t i = 0; i < filter.taps.size(); ++i) {
+        auto& tap = filter.taps[i];
+        const i16* weights = &filter.weights[i * filter.max_taps];
+        __m128i sum = zero;
+        for (int k = 0; k < tap.count; ++k) {
+            __m128i pixel = _mm_unpacklo_epi8(_mm_cvtsi32_si128(src[tap.first + k]), zero);
+            if (premultiply)
+                pixel = premultiply_epi16(pixel);
+            sum = _mm_add_epi32(sum, _mm_madd_epi16(_mm_unpacklo_epi16(pixel, zero), _mm_set1_epi32(weights[k])));
+        }
+        sum = _mm_srai_epi32(_mm_add_epi32(sum, rounding), scale_filter_intermediate_shift);
+        _mm_storel_epi64((__m128i*)(dst + i * 4), _mm_packs_epi32(sum, sum));
+    }
+}
+
+[[gnu::target("sse2")]] static void resample_rows_vertically_sse2(RGBA32* dst, const i16* const* rows, const i16* weights, int count, size_t width)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i rounding = _mm_set1_epi32(1 << (scale_filter_output_shift - 1));
+    size_t i = 0;
+    for (; i + 2 <= width; i += 2) {
+        __m128i sum_lo = zero;
+        __m128i sum_hi = zero;
+        for (int k = 0; k < count; ++k) {
+            __m128i values = _mm_loadu_si128((const __m128i*)(rows[k] + i * 4));
+            __m128i weight = _mm_set1_epi32(weights[k]);
+            sum_lo = _mm_add_epi32(sum_lo, _mm_madd_epi16(_mm_unpacklo_epi16(values, zero), weight));
+            sum_hi = _mm_add_epi32(sum_hi, _mm_madd_epi16(_mm_unpackhi_epi16(values, zero), weight));
+        }
+        sum_lo = _mm_srai_epi32(_mm_add_epi32(sum_lo, rounding), scale_filter_output_shift);
+        sum_hi = _mm_srai_epi32(_mm_add_epi32(sum_hi, rounding), scale_filter_output_shift);
+        __m128i channels = _mm_packs_epi32(sum_lo, sum_hi);
+        _mm_storel_epi64((__m128i*)(dst + i), _mm_packus_epi16(channels, channels));
+    }
+    if (i < width)
+        resample_pixel_vertically(dst + i, rows, weights, count, i);
+}
+
+// Above these, "rep stosl" and "rep movsl" are at least as fast on CPUs with fast string operations.
+static constexpr size_t sse2_max_fill_count = 64;
+static constexpr size_t sse2_max_copy_count = 512;
+#endif
+
+static void fill_scanline(RGBA32* dst, RGBA32 value, size_t count)
+{
+#if ARCH(I386) || ARCH(X86_64)
+    if (count <= sse2_max_fill_count && has_sse2())
+        return fill_scanline_sse2(dst, value, count);
+#endif
+    fast_u32_fill(dst, value, count);
+}
+
+static void copy_scanline(RGBA32* dst, const RGBA32* src, size_t count)
+{
+#if ARCH(I386) || ARCH(X86_64)
+    if (count <= sse2_max_copy_count && has_sse2())
+        return copy_scanline_sse2(dst, src, count);
+#endif
+    fast_u32_copy(dst, src, count);
+}
+
+static void fill_scanline_with_mask(RGBA32* dst, const u8* mask, size_t count, RGBA32 value)
+{
+#if ARCH(I386) || ARCH(X86_64)
+    if (has_sse2())
+        return fill_scanline_with_mask_sse2(dst, mask, count, value);
+#endif
+    for (size_t i = 0; i < count; ++i) {
+        if (mask[i])
+            dst[i] = value;
+    }
+}
+
+static void blend_scanline(RGBA32* dst, const RGBA32* src, size_t count)
+{
+#if ARCH(I386) || ARCH(X86_64)
+    if (has_sse2())
+        return blend_scanline_sse2(dst, src, count);
+#endif
+    for (size_t i = 0; i < count; ++i)
+        blend_pixel(dst[i], src[i]);
+}
+
+static void blend_scanline_with_opacity(RGBA32* dst, const RGBA32* src, size_t count, u8 alpha)
+{
+#if ARCH(I386) || ARCH(X86_64)
+    if (has_sse2())
+        return blend_scanline_with_opacity_sse2(dst, src, count, alpha);
+#endif
+    for (size_t i = 0; i < count; ++i) {
+        Color src_color_with_alpha = Color::from_rgb(src[i]);
+        src_color_with_alpha.set_alpha(alpha);
+        dst[i] = Color::from_rgb(dst[i]).blend(src_color_with_alpha).value();
+    }
+}
+
+static void blend_scanline_with_color(RGBA32* dst, size_t count, Color color)
+{
+#if ARCH(I386) || ARCH(X86_64)
+    if (has_sse2())
+        return blend_scanline_with_color_sse2(dst, count, color);
+#endif
+    for (size_t i = 0; i < count; ++i)
+        dst[i] = Color::from_rgba(dst[i]).blend(color).value();
+}
+
+static void resample_row_horizontally(i16* dst, const RGBA32* src, const ScaleFilter& filter, bool premultiply)
+{
+#if ARCH(I386) || ARCH(X86_64)
+    if (has_sse2())
+        return resample_row_horizontally_sse2(dst, src, filter, premultiply);
+#endif
+    for (size_t i = 0; i < filter.taps.size(); ++i) {
+        auto& tap = filter.taps[i];
+        const i16* weights = &filter.weights[i * filter.max_taps];
+        i32 sum[4] = {};
+        for (int k = 0; k < tap.count; ++k) {
+            RGBA32 pixel = src[tap.first + k];
+            u32 alpha = pixel >> 24;
+            for (int channel = 0; channel < 4; ++channel) {
+                u32 value = (pixel >> (channel * 8)) & 0xff;
+                if (premultiply && channel != 3)
+                    value = div_255(value * alpha);
+                sum[channel] += value * weights[k];
+            }
+        }
+        for (int channel = 0; channel < 4; ++channel)
+            dst[i * 4 + channel] = (sum[channel] + (1 << (scale_filter_intermediate_shift - 1))) >> scale_filter_intermediate_shift;
+    }
+}
+
+static void resample_rows_vertically(RGBA32* dst, const i16* const* rows, const i16* weights, int count, size_t width)
+{
+#if ARCH(I386) || ARCH(X86_64)
+    if (has_sse2())
+        return resample_rows_vertically_sse2(dst, rows, weights, count, width);
+#endif
+    for (size_t i = 0; i < width; ++i)
+        resample_pixel_vertically(dst + i, rows, weights, count, i);
+}
+
 template<BitmapFormat format = BitmapFormat::Invalid>
 ALWAYS_INLINE Color get_pixel(const Gfx::Bitmap& bitmap, int x, int y)
 {
@@ -106,7 +459,7 @@ void Painter::clear_rect(const IntRect& a_rect, Color color)
     const size_t dst_skip = m_target->pitch() / sizeof(RGBA32);
 
     for (int i = rect.height() - 1; i >= 0; --i) {
-        fast_u32_fill(dst, color.value(), rect.width());
+        fill_scanline(dst, color.value(), rect.width());
         dst += dst_skip;
     }
 }
@@ -136,8 +489,7 @@ void Painter::fill_rect(const IntRect& a_rect, Color color)
     const size_t dst_skip = m_target->pitch() / sizeof(RGBA32);
 
     for (int i = rect.height() - 1; i >= 0; --i) {
-        for (int j = 0; j < rect.width(); ++j)
-            dst[j] = Color::from_rgba(dst[j]).blend(color).value();
+        blend_scanline_with_color(dst, rect.width(), color);
         dst += dst_skip;
     }
 }
@@ -446,7 +798,15 @@ void Painter::blit_scaled(const IntRect& dst_rect_raw, const Gfx::Bitmap& source
     RGBA32* dst = m_target->scanline(clipped_rect.y()) + clipped_rect.x();
     const size_t dst_skip = m_target->pitch() / sizeof(RGBA32);
 
+    // The source column of every destination column is the same on each row.
     int x_start = first_column + src_rect.left();
+    Vector<int> source_columns;
+    source_columns.resize(clipped_rect.width());
+    for (int x = 0; x < clipped_rect.width(); ++x) {
+        int sx = (x + x_start) * hscale;
+        source_columns[x] = sx < source.size().width() && sx >= 0 ? sx : -1;
+    }
+
     for (int row = first_row; row <= last_row; ++row) {
         int sr = (row + src_rect.top()) * vscale;
         if (sr >= source.size().height() || sr < 0) {
@@ -454,10 +814,9 @@ void Painter::blit_scaled(const IntRect& dst_rect_raw, const Gfx::Bitmap& source
             continue;
         }
         const RGBA32* sl = source.scanline(sr);
-        for (int x = x_start; x < clipped_rect.width() + x_start; ++x) {
-            int sx = x * hscale;
-            if (sx < source.size().width() && sx >= 0)
-                dst[x - x_start] = sl[sx];
+        for (int x = 0; x < clipped_rect.width(); ++x) {
+            if (source_columns[x] >= 0)
+                dst[x] = sl[source_columns[x]];
         }
         dst += dst_skip;
     }
@@ -491,12 +850,7 @@ void Painter::blit_with_opacity(const IntPoint& position, const Gfx::Bitmap& sou
     const unsigned src_skip = source.pitch() / sizeof(RGBA32);
 
     for (int row = first_row; row <= last_row; ++row) {
-        for (int x = 0; x <= (last_column - first_column); ++x) {
-            Color src_color_with_alpha = Color::from_rgb(src[x]);
-            src_color_with_alpha.set_alpha(alpha);
-            Color dst_color = Color::from_rgb(dst[x]);
-            dst[x] = dst_color.blend(src_color_with_alpha).value();
-        }
+        blend_scanline_with_opacity(dst, src, last_column - first_column + 1, alpha);
         dst += dst_skip;
         src += src_skip;
     }
@@ -518,16 +872,17 @@ void Painter::blit_filtered(const IntPoint& position, const Gfx::Bitmap& source,
     const size_t dst_skip = m_target->pitch() / sizeof(RGBA32);
     const size_t src_skip = source.pitch() / sizeof(RGBA32);
 
+    // Filter a scanline at a time, and blend it in one go. Fully transparent pixels stay that way.
+    Vector<RGBA32, 512> filtered;
+    filtered.resize(last_column - first_column + 1);
     for (int row = first_row; row <= last_row; ++row) {
         for (int x = 0; x <= (last_column - first_column); ++x) {
-            u8 alpha = Color::from_rgba(src[x]).alpha();
-            if (alpha == 0xff)
-                dst[x] = filter(Color::from_rgba(src[x])).value();
-            else if (!alpha)
-                continue;
+            if (Color::from_rgba(src[x]).alpha())
+                filtered[x] = filter(Color::from_rgba(src[x])).value();
             else
-                dst[x] = Color::from_rgba(dst[x]).blend(filter(Color::from_rgba(src[x]))).value();
+                filtered[x] = src[x];
         }
+        blend_scanline(dst, filtered.data(), filtered.size());
         dst += dst_skip;
         src += src_skip;
     }
@@ -630,15 +985,7 @@ void Painter::blit_with_alpha(const IntPoint& position, const Gfx::Bitmap& sourc
     const size_t src_skip = source.pitch() / sizeof(RGBA32);
 
     for (int row = first_row; row <= last_row; ++row) {
-        for (int x = 0; x <= (last_column - first_column); ++x) {
-            u8 alpha = Color::from_rgba(src[x]).alpha();
-            if (alpha == 0xff)
-                dst[x] = src[x];
-            else if (!alpha)
-                continue;
-            else
-                dst[x] = Color::from_rgba(dst[x]).blend(Color::from_rgba(src[x])).value();
-        }
+        blend_scanline(dst, src, last_column - first_column + 1);
         dst += dst_skip;
         src += src_skip;
     }
@@ -666,7 +1013,7 @@ void Painter::blit(const IntPoint& position, const Gfx::Bitmap& source, const In
         const RGBA32* src = source.scanline(src_rect.top() + first_row) + src_rect.left() + first_column;
         const size_t src_skip = source.pitch() / sizeof(RGBA32);
         for (int row = first_row; row <= last_row; ++row) {
-            fast_u32_copy(dst, src, clipped_rect.width());
+            copy_scanline(dst, src, clipped_rect.width());
             dst += dst_skip;
             src += src_skip;
         }
@@ -715,7 +1062,7 @@ ALWAYS_INLINE static void do_draw_integer_scaled_bitmap(Gfx::Bitmap& target, con
 template<bool has_alpha_channel, typename GetPixel>
 ALWAYS_INLINE static void do_draw_scaled_bitmap(Gfx::Bitmap& target, const IntRect& dst_rect, const IntRect& clipped_rect, const Gfx::Bitmap& source, const IntRect& src_rect, int hscale, int vscale, GetPixel get_pixel, float opacity)
 {
-    if (dst_rect == clipped_rect && !(dst_rect.width() % src_rect.width()) && !(dst_rect.height() % src_rect.height())) {
+    if (dst_rect == clipped_rect && src_rect == source.rect() && !(dst_rect.width() % src_rect.width()) && !(dst_rect.height() % src_rect.height())) {
         int hfactor = dst_rect.width() / src_rect.width();
         int vfactor = dst_rect.height() / src_rect.height();
         if (hfactor == 2 && vfactor == 2)
@@ -729,12 +1076,16 @@ ALWAYS_INLINE static void do_draw_scaled_bitmap(Gfx::Bitmap& target, const IntRe
 
     bool has_opacity = opacity != 1.0f;
 
+    Vector<int> source_columns;
+    source_columns.resize(clipped_rect.width());
+    for (int x = clipped_rect.left(); x <= clipped_rect.right(); ++x)
+        source_columns[x - clipped_rect.left()] = src_rect.x() + (((x - dst_rect.x()) * hscale) >> 16);
+
     for (int y = clipped_rect.top(); y <= clipped_rect.bottom(); ++y) {
-        auto* scanline = (Color*)target.scanline(y);
-        for (int x = clipped_rect.left(); x <= clipped_rect.right(); ++x) {
-            auto scaled_x = ((x - dst_rect.x()) * hscale) >> 16;
-            auto scaled_y = ((y - dst_rect.y()) * vscale) >> 16;
-            auto src_pixel = get_pixel(source, scaled_x, scaled_y);
+        auto* scanline = (Color*)target.scanline(y) + clipped_rect.left();
+        auto scaled_y = src_rect.y() + (((y - dst_rect.y()) * vscale) >> 16);
+        for (int x = 0; x < clipped_rect.width(); ++x) {
+            auto src_pixel = get_pixel(source, source_columns[x], scaled_y);
             if (has_opacity)
                 src_pixel.set_alpha(src_pixel.alpha() * opacity);
             if constexpr (has_alpha_channel) {
@@ -745,7 +1096,119 @@ ALWAYS_INLINE static void do_draw_scaled_bitmap(Gfx::Bitmap& target, const IntRe
     }
 }
 
-void Painter::draw_scaled_bitmap(const IntRect& a_dst_rect, const Gfx::Bitmap& source, const IntRect& src_rect, float opacity)
+static ScaleFilter make_scale_filter(int src_start, int src_length, int dst_length, int first_dst, int dst_count)
+{
+    ScaleFilter filter;
+    float scale = (float)src_length / dst_length;
+    // Upscaling interpolates between the two nearest source pixels, downscaling averages every source pixel
+    // that is (partially) covered by the destination pixel.
+    bool is_box_filter = scale > 1;
+    filter.max_taps = is_box_filter ? (int)ceilf(scale) + 1 : 2;
+    filter.taps.ensure_capacity(dst_count);
+    filter.weights.resize(dst_count * filter.max_taps);
+
+    Vector<float, 16> tap_weights;
+    for (int i = 0; i < dst_count; ++i) {
+        int d = first_dst + i;
+        int first;
+        tap_weights.clear_with_capacity();
+        if (is_box_filter) {
+            float start = d * scale;
+            float end = min(start + scale, (float)src_length);
+            first = (int)start;
+            for (int x = first; x < end; ++x)
+                tap_weights.append(min(end, x + 1.0f) - max(start, (float)x));
+        } else {
+            float center = max(0.0f, min((float)(src_length - 1), (d + 0.5f) * scale - 0.5f));
+            first = (int)center;
+            float fraction = center - first;
+            tap_weights.append(1 - fraction);
+            if (first + 1 < src_length)
+                tap_weights.append(fraction);
+        }
+
+        float total_weight = 0;
+        for (auto weight : tap_weights)
+            total_weight += weight;
+        i16* weights = &filter.weights[i * filter.max_taps];
+        int total = 0;
+        size_t largest = 0;
+        for (size_t k = 0; k < tap_weights.size(); ++k) {
+            weights[k] = (i16)(tap_weights[k] / total_weight * (1 << scale_filter_weight_bits) + 0.5f);
+            total += weights[k];
+            if (weights[k] > weights[largest])
+                largest = k;
+        }
+        // Rounding must not make the weights add up to anything but 1, or flat areas would change color.
+        weights[largest] += (1 << scale_filter_weight_bits) - total;
+        filter.taps.append({ src_start + first, (int)tap_weights.size() });
+    }
+    return filter;
+}
+
+static void do_draw_smooth_scaled_bitmap(Gfx::Bitmap& target, const IntRect& dst_rect, const IntRect& clipped_rect, const Gfx::Bitmap& source, const IntRect& src_rect, float opacity)
+{
+    auto horizontal = make_scale_filter(src_rect.x(), src_rect.width(), dst_rect.width(), clipped_rect.left() - dst_rect.left(), clipped_rect.width());
+    auto vertical = make_scale_filter(src_rect.y(), src_rect.height(), dst_rect.height(), clipped_rect.top() - dst_rect.top(), clipped_rect.height());
+    size_t width = clipped_rect.width();
+    bool has_alpha_channel = source.has_alpha_channel();
+    u8 alpha = opacity * 255;
+
+    // Source rows are filtered horizontally once and kept while the vertical filter still needs them. A destination
+    // row needs at most max_taps consecutive source rows, so source row y can always live in slot y % max_taps.
+    int slot_count = vertical.max_taps;
+    Vector<i16> row_cache;
+    row_cache.resize(slot_count * width * 4);
+    Vector<int, 16> cached_rows;
+    for (int i = 0; i < slot_count; ++i)
+        cached_rows.append(-1);
+    Vector<const i16*, 16> rows;
+    Vector<RGBA32> resampled;
+    resampled.resize(width);
+
+    for (size_t i = 0; i < vertical.taps.size(); ++i) {
+        auto& tap = vertical.taps[i];
+        rows.clear_with_capacity();
+        for (int y = tap.first; y < tap.first + tap.count; ++y) {
+            int slot = y % slot_count;
+            i16* row = &row_cache[slot * width * 4];
+            if (cached_rows[slot] != y) {
+                resample_row_horizontally(row, source.scanline(y), horizontal, has_alpha_channel);
+                cached_rows[slot] = y;
+            }
+            rows.append(row);
+        }
+        resample_rows_vertically(resampled.data(), rows.data(), &vertical.weights[i * vertical.max_taps], tap.count, width);
+
+        RGBA32* dst = target.scanline(clipped_rect.top() + i) + clipped_rect.left();
+        if (!has_alpha_channel && alpha == 0xff) {
+            for (auto& pixel : resampled)
+                pixel |= 0xff000000;
+            copy_scanline(dst, resampled.data(), width);
+            continue;
+        }
+        for (auto& pixel : resampled) {
+            auto color = Color::from_rgba(pixel);
+            if (has_alpha_channel) {
+                u8 pixel_alpha = color.alpha();
+                if (!pixel_alpha) {
+                    pixel = 0;
+                    continue;
+                }
+                color = Color(min(255, (color.red() * 255 + pixel_alpha / 2) / pixel_alpha),
+                    min(255, (color.green() * 255 + pixel_alpha / 2) / pixel_alpha),
+                    min(255, (color.blue() * 255 + pixel_alpha / 2) / pixel_alpha),
+                    div_255(pixel_alpha * alpha));
+            } else {
+                color.set_alpha(alpha);
+            }
+            pixel = color.value();
+        }
+        blend_scanline(dst, resampled.data(), width);
+    }
+}
+
+void Painter::draw_scaled_bitmap(const IntRect& a_dst_rect, const Gfx::Bitmap& source, const IntRect& src_rect, float opacity, ScalingMode scaling_mode)
 {
     auto dst_rect = a_dst_rect;
     if (dst_rect.size() == src_rect.size())
@@ -758,6 +1221,12 @@ void Painter::draw_scaled_bitmap(const IntRect& a_dst_rect, const Gfx::Bitmap& s
     if (clipped_rect.is_empty())
         return;
 
+    if (scaling_mode == ScalingMode::Smooth && (source.format() == BitmapFormat::RGB32 || source.format() == BitmapFormat::RGBA32)) {
+        if (!safe_src_rect.is_empty())
+            do_draw_smooth_scaled_bitmap(*m_target, dst_rect, clipped_rect, source, safe_src_rect, opacity);
+        return;
+    }
+
     int hscale = (src_rect.width() << 16) / dst_rect.width();
     int vscale = (src_rect.height() << 16) / dst_rect.height();
 
@@ -808,9 +1277,95 @@ FLATTEN void Painter::draw_glyph(const IntPoint& point, u32 code_point, Color co
     draw_glyph(point, code_point, font(), color);
 }
 
+struct PositionedGlyph {
+    int x;
+    GlyphMask mask;
+};
+
+static void draw_glyph_masks(Painter& painter, int y, const Vector<PositionedGlyph, 128>& glyphs, Color color)
+{
+    if (glyphs.is_empty())
+        return;
+
+    // Go through the whole run one scanline at a time rather than glyph by glyph, so each
+    // destination row is touched in one pass from left to right.
+    auto clip = painter.clip_rect();
+    auto translation = painter.translation();
+    auto& target = *painter.target();
+    int top = max(y + translation.y(), clip.top());
+    int bottom = min(y + translation.y() + glyphs.first().mask.size.height() - 1, clip.bottom());
+    for (int row = top; row <= bottom; ++row) {
+        RGBA32* dst = target.scanline(row);
+        int mask_row = row - (y + translation.y());
+        for (auto& glyph : glyphs) {
+            int left = glyph.x + translation.x();
+            int first_column = max(left, clip.left());
+            int last_column = min(left + glyph.mask.size.width() - 1, clip.right());
+            if (first_column > last_column)
+                continue;
+            auto* mask = glyph.mask.data + mask_row * glyph.mask.pitch + (first_column - left);
+            fill_scanline_with_mask(dst + first_column, mask, last_column - first_column + 1, color.value());
+        }
+    }
+}
+
+template<typename Callback>
+static void for_each_code_point(const Utf8View& text, Callback callback)
+{
+    for (u32 code_point : text)
+        callback(code_point);
+}
+
+template<typename Callback>
+static void for_each_code_point(const Utf32View& text, Callback callback)
+{
+    for (size_t i = 0; i < text.length(); ++i)
+        callback(text.code_points()[i]);
+}
+
+template<typename TextType>
+static void draw_text_run_impl(Painter& painter, const IntPoint& point, const TextType& text, const Font& font, Color color)
+{
+    Vector<PositionedGlyph, 128> glyphs;
+    int x = point.x();
+    int space_width = font.glyph_width(' ') + font.glyph_spacing();
+
+    for_each_code_point(text, [&](u32 code_point) {
+        if (code_point == ' ') {
+            x += space_width;
+            return;
+        }
+        if (code_point < (u32)font.glyph_count()) {
+            glyphs.append({ x, font.glyph_mask(code_point) });
+        } else if (auto* emoji = Emoji::emoji_for_code_point(code_point)) {
+            painter.draw_emoji({ x, point.y() }, *emoji, font);
+        } else {
+#ifdef EMOJI_DEBUG
+            dbg() << "Failed to find an emoji for code_point " << code_point;
+#endif
+            glyphs.append({ x, font.glyph_mask('?') });
+        }
+        x += font.glyph_or_emoji_width(code_point) + font.glyph_spacing();
+    });
+
+    draw_glyph_masks(painter, point.y(), glyphs, color);
+}
+
+void Painter::draw_text_run(const IntPoint& point, const Utf8View& text, const Font& font, Color color)
+{
+    draw_text_run_impl(*this, point, text, font, color);
+}
+
+void Painter::draw_text_run(const IntPoint& point, const Utf32View& text, const Font& font, Color color)
+{
+    draw_text_run_impl(*this, point, text, font, color);
+}
+
 FLATTEN void Painter::draw_glyph(const IntPoint& point, u32 code_point, const Font& font, Color color)
 {
-    draw_bitmap(point, font.glyph_bitmap(code_point), color);
+    Vector<PositionedGlyph, 128> glyphs;
+    glyphs.append({ point.x(), font.glyph_mask(code_point) });
+    draw_glyph_masks(*this, point.y(), glyphs, color);
 }
 
 void Painter::draw_emoji(const IntPoint& point, const Gfx::Bitmap& emoji, const Font& font)
@@ -901,17 +1456,7 @@ void Painter::draw_text_line(const IntRect& a_rect, const Utf8View& text, const
         ASSERT_NOT_REACHED();
     }
 
-    auto point = rect.location();
-    int space_width = font.glyph_width(' ') + font.glyph_spacing();
-
-    for (u32 code_point : final_text) {
-        if (code_point == ' ') {
-            point.move_by(space_width, 0);
-            continue;
-        }
-        draw_glyph_or_emoji(point, code_point, font, color);
-        point.move_by(font.glyph_or_emoji_width(code_point) + font.glyph_spacing(), 0);
-    }
+    draw_text_run(rect.location(), final_text, font, color);
 }
 
 void Painter::draw_text_line(const IntRect& a_rect, const Utf32View& text, const Font& font, TextAlignment alignment, Color color, TextElision elision)
@@ -966,18 +1511,7 @@ void Painter::draw_text_line(const IntRect& a_rect, const Utf32View& text, const
         ASSERT_NOT_REACHED();
     }
 
-    auto point = rect.location();
-    int space_width = font.glyph_width(' ') + font.glyph_spacing();
-
-    for (size_t i = 0; i < final_text.length(); ++i) {
-        auto code_point = final_text.code_points()[i];
-        if (code_point == ' ') {
-            point.move_by(space_width, 0);
-            continue;
-        }
-        draw_glyph_or_emoji(point, code_point, font, color);
-        point.move_by(font.glyph_or_emoji_width(code_point) + font.glyph_spacing(), 0);
-    }
+    draw_text_run(rect.location(), final_text, font, color);
 }
 
 void Painter::draw_text(const IntRect& rect, const StringView& text, TextAlignment alignment, Color color, TextElision elision)
@@ -1386,187 +1920,204 @@ PainterStateSaver::~PainterStateSaver()
     m_painter.restore();
 }
 
+// Winding numbers of the filled area are accumulated at this many evenly spaced sample rows per pixel row.
+// Horizontally, coverage is exact.
+static constexpr int path_samples_per_row = 4;
+
+struct PathCrossing {
+    float x;
+    int winding;
+};
+
+// Adds `weight` to the coverage of the pixels between x0 and x1, with partial coverage at both ends.
+// The accumulation buffer holds coverage deltas, so that a span costs four writes no matter how long it is,
+// and a prefix sum over the touched part of the buffer turns them into coverage when the row is done.
+ALWAYS_INLINE static void accumulate_span(float* accumulation, float x0, float x1, float weight, int& min_x, int& max_x)
+{
+    int ix0 = (int)x0;
+    int ix1 = (int)x1;
+    float f0 = x0 - ix0;
+    float f1 = x1 - ix1;
+    accumulation[ix0] += weight * (1 - f0);
+    accumulation[ix0 + 1] += weight * f0;
+    accumulation[ix1] -= weight * (1 - f1);
+    accumulation[ix1 + 1] -= weight * f1;
+    min_x = min(min_x, ix0);
+    max_x = max(max_x, ix1 + 1);
+}
+
+// Fills the area enclosed by the edges, which must be sorted by their minimum y, with an active edge list walked
+// from the top of the path to the bottom.
+static void rasterize_edges(Bitmap& target, const IntRect& clip_rect, const IntPoint& translation, const Vector<Path::SplitLineSegment>& edges, Color color, Painter::WindingRule winding_rule)
+{
+    if (edges.is_empty() || clip_rect.is_empty() || !color.alpha())
+        return;
+
+    float maximum_y = edges.first().maximum_y;
+    for (auto& edge : edges)
+        maximum_y = max(maximum_y, edge.maximum_y);
+
+    int first_row = max(clip_rect.top(), (int)floorf(edges.first().minimum_y + translation.y()));
+    int last_row = min(clip_rect.bottom(), (int)ceilf(maximum_y + translation.y()) - 1);
+    if (first_row > last_row)
+        return;
+
+    // Crossings are clamped to the clip rect, which the buffer covers with one extra cell for the deltas at the right edge.
+    int width = clip_rect.width();
+    float x_offset = translation.x() - clip_rect.left();
+    Vector<float> accumulation;
+    accumulation.resize(width + 2);
+    for (auto& value : accumulation)
+        value = 0;
+
+    Vector<const Path::SplitLineSegment*, 64> active_edges;
+    Vector<PathCrossing, 64> crossings;
+    size_t next_edge = 0;
+    constexpr float sample_weight = 1.0f / path_samples_per_row;
+
+    auto is_inside = [winding_rule](int winding_number) {
+        if (winding_rule == Painter::WindingRule::EvenOdd)
+            return (winding_number & 1) != 0;
+        return winding_number != 0;
+    };
+
+    for (int row = first_row; row <= last_row; ++row) {
+        int min_x = width + 1;
+        int max_x = -1;
+
+        for (int sample = 0; sample < path_samples_per_row; ++sample) {
+            float y = row - translation.y() + (sample + 0.5f) * sample_weight;
+
+            // Each edge covers the rows in [minimum_y, maximum_y).
+            while (next_edge < edges.size() && edges[next_edge].minimum_y <= y)
+                active_edges.append(&edges[next_edge++]);
+            size_t still_active = 0;
+            for (size_t i = 0; i < active_edges.size(); ++i) {
+                if (active_edges[i]->maximum_y > y)
+                    active_edges[still_active++] = active_edges[i];
+            }
+            active_edges.shrink(still_active, true);
+
+            crossings.clear_with_capacity();
+            for (auto* edge : active_edges) {
+                float x = edge->x_of_minimum_y + (y - edge->minimum_y) * edge->inverse_slope + x_offset;
+                x = max(0.0f, min((float)width, x));
+                // The crossings are nearly sorted from the previous sample, so an insertion sort is cheap.
+                size_t index = crossings.size();
+                crossings.append({ x, edge->winding() });
+                while (index > 0 && crossings[index - 1].x > x) {
+                    crossings[index] = crossings[index - 1];
+                    --index;
+                }
+                crossings[index] = { x, edge->winding() };
+            }
+
+            int winding_number = 0;
+            for (size_t i = 0; i + 1 < crossings.size(); ++i) {
+                winding_number += crossings[i].winding;
+                if (is_inside(winding_number) && crossings[i].x < crossings[i + 1].x)
+                    accumulate_span(accumulation.data(), crossings[i].x, crossings[i + 1].x, sample_weight, min_x, max_x);
+            }
+        }
+
+        if (max_x < 0)
+            continue;
+
+        RGBA32* dst = target.scanline(row) + clip_rect.left();
+        float coverage = 0;
+        for (int x = min_x; x <= max_x; ++x) {
+            coverage += accumulation[x];
+            accumulation[x] = 0;
+            if (x >= width)
+                continue;
+            u8 alpha = (u8)(min(fabsf(coverage), 1.0f) * color.alpha() + 0.5f);
+            if (alpha == 0xff)
+                dst[x] = color.value();
+            else if (alpha)
+                dst[x] = Color::from_rgba(dst[x]).blend(color.with_alpha(alpha)).value();
+        }
+    }
+}
+
 void Painter::stroke_path(const Path& path, Color color, int thickness)
 {
-    FloatPoint cursor;
+    // The stroke is the union of a quad around every flattened line and a polygon around every joint between two
+    // of them, all wound the same way so that they can be filled together with the non-zero rule.
+    Vector<Path::SplitLineSegment> edges;
+    float half_thickness = max(thickness, 1) / 2.0f;
+    int joint_vertex_count = thickness > 1 ? 8 : 0;
+
+    Optional<FloatPoint> previous_line_end;
+    auto add_line = [&](const FloatPoint& p0, const FloatPoint& p1) {
+        float dx = p1.x() - p0.x();
+        float dy = p1.y() - p0.y();
+        float length = sqrtf(dx * dx + dy * dy);
+        if (length == 0)
+            return;
+        FloatPoint normal { -dy / length * half_thickness, dx / length * half_thickness };
+        auto a = p0 + normal;
+        auto b = p1 + normal;
+        auto c = p1 - normal;
+        auto d = p0 - normal;
+        Path::append_split_line(edges, a, b);
+        Path::append_split_line(edges, b, c);
+        Path::append_split_line(edges, c, d);
+        Path::append_split_line(edges, d, a);
+
+        if (joint_vertex_count && previous_line_end.has_value() && previous_line_end.value() == p0) {
+            // Clockwise, like the quads.
+            FloatPoint previous_vertex { p0.x() + half_thickness, p0.y() };
+            for (int i = 1; i <= joint_vertex_count; ++i) {
+                float angle = -2 * (float)M_PI * i / joint_vertex_count;
+                FloatPoint vertex { p0.x() + cosf(angle) * half_thickness, p0.y() + sinf(angle) * half_thickness };
+                Path::append_split_line(edges, previous_vertex, vertex);
+                previous_vertex = vertex;
+            }
+        }
+        previous_line_end = p1;
+    };
 
+    FloatPoint cursor;
     for (auto& segment : path.segments()) {
         switch (segment.type()) {
         case Segment::Type::Invalid:
             ASSERT_NOT_REACHED();
             break;
         case Segment::Type::MoveTo:
+            previous_line_end.clear();
             cursor = segment.point();
             break;
         case Segment::Type::LineTo:
-            draw_line(cursor.to_type<int>(), segment.point().to_type<int>(), color, thickness);
+            add_line(cursor, segment.point());
             cursor = segment.point();
             break;
         case Segment::Type::QuadraticBezierCurveTo: {
             auto& through = static_cast<const QuadraticBezierCurveSegment&>(segment).through();
-            draw_quadratic_bezier_curve(through.to_type<int>(), cursor.to_type<int>(), segment.point().to_type<int>(), color, thickness);
+            for_each_line_segment_on_bezier_curve(through, cursor, segment.point(), [&](const FloatPoint& p0, const FloatPoint& p1) {
+                add_line(p0, p1);
+            });
             cursor = segment.point();
             break;
         }
         case Segment::Type::EllipticalArcTo:
             auto& arc = static_cast<const EllipticalArcSegment&>(segment);
-            draw_elliptical_arc(cursor.to_type<int>(), segment.point().to_type<int>(), arc.center().to_type<int>(), arc.radii(), arc.x_axis_rotation(), arc.theta_1(), arc.theta_delta(), color, thickness);
+            for_each_line_segment_on_elliptical_arc(cursor, segment.point(), arc.center(), arc.radii(), arc.x_axis_rotation(), arc.theta_1(), arc.theta_delta(), [&](const FloatPoint& p0, const FloatPoint& p1) {
+                add_line(p0, p1);
+            });
             cursor = segment.point();
             break;
         }
     }
-}
 
-//#define FILL_PATH_DEBUG
+    quick_sort(edges, [](const auto& line0, const auto& line1) {
+        return line0.minimum_y < line1.minimum_y;
+    });
+    rasterize_edges(*m_target, clip_rect(), translation(), edges, color, WindingRule::Nonzero);
+}
 
 void Painter::fill_path(Path& path, Color color, WindingRule winding_rule)
 {
-    const auto& segments = path.split_lines();
-
-    if (segments.size() == 0)
-        return;
-
-    Vector<Path::SplitLineSegment> active_list;
-    active_list.ensure_capacity(segments.size());
-
-    // first, grab the segments for the very first scanline
-    auto first_y = segments.first().maximum_y;
-    auto last_y = segments.last().minimum_y;
-    auto scanline = first_y;
-
-    size_t last_active_segment { 0 };
-
-    for (auto& segment : segments) {
-        if (segment.maximum_y != scanline)
-            break;
-        active_list.append(segment);
-        ++last_active_segment;
-    }
-
-    auto is_inside_shape = [winding_rule](int winding_number) {
-        if (winding_rule == WindingRule::Nonzero)
-            return winding_number != 0;
-
-        if (winding_rule == WindingRule::EvenOdd)
-            return winding_number % 2 == 0;
-
-        ASSERT_NOT_REACHED();
-    };
-
-    auto increment_winding = [winding_rule](int& winding_number, const IntPoint& from, const IntPoint& to) {
-        if (winding_rule == WindingRule::EvenOdd) {
-            ++winding_number;
-            return;
-        }
-
-        if (winding_rule == WindingRule::Nonzero) {
-            if (from.dy_relative_to(to) < 0)
-                ++winding_number;
-            else
-                --winding_number;
-            return;
-        }
-
-        ASSERT_NOT_REACHED();
-    };
-
-    while (scanline >= last_y) {
-        if (active_list.size()) {
-            // sort the active list by 'x' from right to left
-            quick_sort(active_list, [](const auto& line0, const auto& line1) {
-                return line1.x < line0.x;
-            });
-#ifdef FILL_PATH_DEBUG
-            if ((int)scanline % 10 == 0) {
-                draw_text(IntRect(active_list.last().x - 20, scanline, 20, 10), String::format("%d", (int)scanline));
-            }
-#endif
-
-            if (active_list.size() > 1) {
-                auto winding_number { 0 };
-                for (size_t i = 1; i < active_list.size(); ++i) {
-                    auto& previous = active_list[i - 1];
-                    auto& current = active_list[i];
-
-                    int int_distance = fabs(current.x - previous.x);
-                    IntPoint from(previous.x, scanline);
-                    IntPoint to(current.x, scanline);
-
-                    if (int_distance < 1) {
-                        // the two lines intersect on an int grid
-                        // so they should both be treated as a single line segment
-                        goto skip_drawing;
-                    }
-
-                    if (int_distance == 1 && is_inside_shape(winding_number)) {
-                        // The two lines form a singluar edge for the shape
-                        // while they do not intersect, they connect together
-                        goto skip_drawing;
-                    }
-
-                    if (is_inside_shape(winding_number)) {
-                        // The points between this segment and the previous are
-                        // inside the shape
-#ifdef FILL_PATH_DEBUG
-                        dbg() << "y=" << scanline << ": " << winding_number << " at " << i << ": " << from << " -- " << to;
-#endif
-                        draw_line(from, to, color, 1);
-                    }
-
-                skip_drawing:;
-
-                    auto is_passing_through_maxima = scanline == previous.maximum_y
-                        || scanline == previous.minimum_y
-                        || scanline == current.maximum_y
-                        || scanline == current.minimum_y;
-
-                    auto is_passing_through_vertex = false;
-
-                    if (is_passing_through_maxima) {
-                        is_passing_through_vertex = previous.x == current.x;
-                    }
-
-                    if (!is_passing_through_vertex || previous.inverse_slope * current.inverse_slope < 0)
-                        increment_winding(winding_number, from, to);
-
-                    // update the x coord
-                    active_list[i - 1].x -= active_list[i - 1].inverse_slope;
-                }
-                active_list.last().x -= active_list.last().inverse_slope;
-            } else {
-                auto point = IntPoint(active_list[0].x, scanline);
-                draw_line(point, point, color);
-
-                // update the x coord
-                active_list.first().x -= active_list.first().inverse_slope;
-            }
-        }
-
-        --scanline;
-        // remove any edge that goes out of bound from the active list
-        for (size_t i = 0, count = active_list.size(); i < count; ++i) {
-            if (scanline <= active_list[i].minimum_y) {
-                active_list.remove(i);
-                --count;
-                --i;
-            }
-        }
-        for (size_t j = last_active_segment; j < segments.size(); ++j, ++last_active_segment) {
-            auto& segment = segments[j];
-            if (segment.maximum_y < scanline)
-                break;
-            if (segment.minimum_y >= scanline)
-                continue;
-
-            active_list.append(segment);
-        }
-    }
-
-#ifdef FILL_PATH_DEBUG
-    size_t i { 0 };
-    for (auto& segment : segments)
-        draw_line(segment.from, segment.to, Color::from_hsv(++i / segments.size() * 255, 255, 255), 1);
-#endif
+    rasterize_edges(*m_target, clip_rect(), translation(), path.split_lines(), color, winding_rule);
 }
 
 }
@@ -60,7 +60,12 @@ public:
     void draw_rect(const IntRect&, Color, bool rough = false);
     void draw_bitmap(const IntPoint&, const CharacterBitmap&, Color = Color());
     void draw_bitmap(const IntPoint&, const GlyphBitmap&, Color = Color());
-    void draw_scaled_bitmap(const IntRect& dst_rect, const Gfx::Bitmap&, const IntRect& src_rect, float opacity = 1.0f);
+    enum class ScalingMode {
+        NearestNeighbor,
+        // Bilinear when enlarging, box filtered when shrinking. Only RGB32 and RGBA32 bitmaps are filtered.
+        Smooth,
+    };
+    void draw_scaled_bitmap(const IntRect& dst_rect, const Gfx::Bitmap&, const IntRect& src_rect, float opacity = 1.0f, ScalingMode = ScalingMode::NearestNeighbor);
     void draw_triangle(const IntPoint&, const IntPoint&, const IntPoint&, Color);
     void draw_ellipse_intersecting(const IntRect&, Color, int thickness = 1);
     void set_pixel(const IntPoint&, Color);
@@ -83,6 +88,10 @@ public:
     void draw_emoji(const IntPoint&, const Gfx::Bitmap&, const Font&);
     void draw_glyph_or_emoji(const IntPoint&, u32 code_point, const Font&, Color);
 
+    // Draws one line of text starting at the given point, without any alignment or elision.
+    void draw_text_run(const IntPoint&, const Utf8View&, const Font&, Color);
+    void draw_text_run(const IntPoint&, const Utf32View&, const Font&, Color);
+
     static void for_each_line_segment_on_bezier_curve(const FloatPoint& control_point, const FloatPoint& p1, const FloatPoint& p2, Function<void(const FloatPoint&, const FloatPoint&)>&);
     static void for_each_line_segment_on_bezier_curve(const FloatPoint& control_point, const FloatPoint& p1, const FloatPoint& p2, Function<void(const FloatPoint&, const FloatPoint&)>&&);
 
@@ -144,23 +144,28 @@ String Path::to_string() const
     return builder.to_string();
 }
 
+void Path::append_split_line(Vector<SplitLineSegment>& lines, const FloatPoint& from, const FloatPoint& to)
+{
+    if (from.y() == to.y())
+        return;
+
+    auto& top = from.y() < to.y() ? from : to;
+    auto& bottom = from.y() < to.y() ? to : from;
+    lines.append({ from,
+        to,
+        (bottom.x() - top.x()) / (bottom.y() - top.y()),
+        top.x(),
+        bottom.y(),
+        top.y() });
+}
+
 void Path::segmentize_path()
 {
-    Vector<SplitLineSegment> segments;
+    auto& segments = m_split_lines;
+    segments.clear_with_capacity();
 
     auto add_line = [&](const auto& p0, const auto& p1) {
-        float ymax = p0.y(), ymin = p1.y(), x_of_ymin = p1.x(), x_of_ymax = p0.x();
-        auto slope = p0.x() == p1.x() ? 0 : ((float)(p0.y() - p1.y())) / ((float)(p0.x() - p1.x()));
-        if (p0.y() < p1.y()) {
-            swap(ymin, ymax);
-            swap(x_of_ymin, x_of_ymax);
-        }
-
-        segments.append({ FloatPoint(p0.x(), p0.y()),
-            FloatPoint(p1.x(), p1.y()),
-            slope == 0 ? 0 : 1 / slope,
-            x_of_ymin,
-            ymax, ymin, x_of_ymax });
+        append_split_line(segments, p0, p1);
     };
 
     FloatPoint cursor { 0, 0 };
@@ -195,12 +200,12 @@ void Path::segmentize_path()
         }
     }
 
-    // sort segments by ymax
+    // The rasterizer walks the edges from top to bottom.
     quick_sort(segments, [](const auto& line0, const auto& line1) {
-        return line1.maximum_y < line0.maximum_y;
+        return line0.minimum_y < line1.minimum_y;
     });
 
-    m_split_lines = move(segments);
+    m_split_lines_valid = true;
 }
 
 }
@@ -168,17 +168,23 @@ public:
         float x_of_minimum_y;
         float maximum_y;
         float minimum_y;
-        float x;
+
+        // +1 for edges going down, -1 for edges going up.
+        int winding() const { return from.y() < to.y() ? 1 : -1; }
     };
 
+    // Appends the line from `from` to `to` to a list of edges for the rasterizer. Horizontal lines are skipped,
+    // since they never cross a scanline.
+    static void append_split_line(Vector<SplitLineSegment>&, const FloatPoint& from, const FloatPoint& to);
+
     const NonnullRefPtrVector<Segment>& segments() const { return m_segments; }
-    const auto& split_lines()
+
+    // The flattened edges of the path, sorted by their minimum y.
+    const Vector<SplitLineSegment>& split_lines()
     {
-        if (m_split_lines.has_value())
-            return m_split_lines.value();
-        segmentize_path();
-        ASSERT(m_split_lines.has_value());
-        return m_split_lines.value();
+        if (!m_split_lines_valid)
+            segmentize_path();
+        return m_split_lines;
     }
 
     String to_string() const;
@@ -186,7 +192,9 @@ public:
 private:
     void invalidate_split_lines()
     {
-        m_split_lines.clear();
+        // The buffer keeps its capacity, so a path that is edited and drawn repeatedly doesn't reallocate it.
+        m_split_lines.clear_with_capacity();
+        m_split_lines_valid = false;
     }
     void segmentize_path();
 
@@ -198,7 +206,8 @@ private:
 
     NonnullRefPtrVector<Segment> m_segments {};
 
-    Optional<Vector<SplitLineSegment>> m_split_lines {};
+    Vector<SplitLineSegment> m_split_lines;
+    bool m_split_lines_valid { false };
 };
 
 inline const LogStream& operator<<(const LogStream& stream, const Path& path)
@@ -47,6 +47,12 @@ bool encode(Encoder& encoder, const Gfx::ShareableBitmap& shareable_bitmap)
     encoder << shareable_bitmap.shbuf_id();
     encoder << shareable_bitmap.width();
     encoder << shareable_bitmap.height();
+    if (!shareable_bitmap.is_valid())
+        return true;
+    auto& bitmap = *shareable_bitmap.bitmap();
+    encoder << (u32)bitmap.format();
+    if (bitmap.is_indexed())
+        encoder << bitmap.palette_to_vector();
     return true;
 }
 
@@ -62,13 +68,30 @@ bool decode(Decoder& decoder, Gfx::ShareableBitmap& shareable_bitmap)
     if (shbuf_id == -1)
         return true;
 
+    u32 raw_format = 0;
+    if (!decoder.decode(raw_format))
+        return false;
+    auto format = (Gfx::BitmapFormat)raw_format;
+    if (format == Gfx::BitmapFormat::Invalid || raw_format > (u32)Gfx::BitmapFormat::RGBA32)
+        return false;
+    Vector<Gfx::RGBA32> palette;
+    if (Gfx::Bitmap::is_indexed(format)) {
+        if (!decoder.decode(palette))
+            return false;
+        if (palette.size() != Gfx::Bitmap::palette_size(format))
+            return false;
+    }
+
     dbg() << "Decoding a ShareableBitmap with shbuf_id=" << shbuf_id << ", size=" << size;
 
     auto shared_buffer = SharedBuffer::create_from_shbuf_id(shbuf_id);
     if (!shared_buffer)
         return false;
 
-    auto bitmap = Gfx::Bitmap::create_with_shared_buffer(Gfx::BitmapFormat::RGBA32, shared_buffer.release_nonnull(), size);
+    size_t buffer_size = shared_buffer->size();
+    auto bitmap = Gfx::Bitmap::create_with_shared_buffer(format, shared_buffer.release_nonnull(), size, palette);
+    if (!bitmap || bitmap->size_in_bytes() > buffer_size)
+        return false;
     shareable_bitmap = bitmap->to_shareable_bitmap();
     return true;
 }
@@ -36,24 +36,40 @@
 namespace HTTP {
 void HttpJob::start()
 {
-    ASSERT(!m_socket);
-    m_socket = Core::TCPSocket::construct(this);
-    m_socket->on_connected = [this] {
-#ifdef CHTTPJOB_DEBUG
-        dbg() << "HttpJob: on_connected callback";
+    m_task = connect_and_send_request();
+    m_task.start();
+}
+
+Core::Task<void> HttpJob::connect_and_send_request()
+{
+    if (m_is_reusing_connection) {
+        ASSERT(m_socket);
+        add_child(*m_socket);
+    } else {
+        ASSERT(!m_socket);
+        m_socket = Core::TCPSocket::construct(this);
+        bool connected = co_await Core::async_connect(*m_socket, m_request.url().host(), m_request.url().port());
+        if (!connected) {
+            deferred_invoke([this](auto&) { did_fail(Core::NetworkJob::Error::ConnectionFailed); });
+            co_return;
+        }
+#ifdef HTTPJOB_DEBUG
+        dbg() << "HttpJob: Connected";
 #endif
-        on_socket_connected();
-    };
-    bool success = m_socket->connect(m_request.url().host(), m_request.url().port());
-    if (!success) {
-        deferred_invoke([this](auto&) {
-            return did_fail(Core::NetworkJob::Error::ConnectionFailed);
-        });
     }
+
+    register_on_ready_to_read([this] { read_available_data(); });
+
+    m_sent_data = true;
+    auto raw_request = m_request.to_raw_request();
+    bool sent = co_await Core::async_write(*m_socket, raw_request.span());
+    if (!sent)
+        deferred_invoke([this](auto&) { did_fail(Core::NetworkJob::Error::TransmissionFailed); });
 }
 
 void HttpJob::shutdown()
 {
+    m_task = {};
     if (!m_socket)
         return;
     m_socket->on_ready_to_read = nullptr;
@@ -62,11 +78,35 @@ void HttpJob::shutdown()
     m_socket = nullptr;
 }
 
+void HttpJob::set_socket(NonnullRefPtr<Core::Socket> socket)
+{
+    ASSERT(!m_socket);
+    m_socket = move(socket);
+    m_is_reusing_connection = true;
+}
+
+RefPtr<Core::Socket> HttpJob::take_socket()
+{
+    if (!m_socket || !can_reuse_connection())
+        return nullptr;
+    m_socket->set_reading_paused(false);
+    m_socket->on_ready_to_read = nullptr;
+    m_socket->on_connected = nullptr;
+    remove_child(*m_socket);
+    return move(m_socket);
+}
+
 void HttpJob::register_on_ready_to_read(Function<void()> callback)
 {
     m_socket->on_ready_to_read = move(callback);
 }
 
+void HttpJob::set_socket_reading_paused(bool paused)
+{
+    if (m_socket)
+        m_socket->set_reading_paused(paused);
+}
+
 void HttpJob::register_on_ready_to_write(Function<void()> callback)
 {
     // There is no need to wait, the connection is already established
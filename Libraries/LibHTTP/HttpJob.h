@@ -27,6 +27,7 @@
 #pragma once
 
 #include <AK/HashMap.h>
+#include <LibCore/Coroutine.h>
 #include <LibCore/NetworkJob.h>
 #include <LibCore/TCPSocket.h>
 #include <LibHTTP/HttpRequest.h>
@@ -50,10 +51,16 @@ public:
     virtual void start() override;
     virtual void shutdown() override;
 
+    // Sends the request over an idle connection from an earlier job instead of connecting. Call before start().
+    void set_socket(NonnullRefPtr<Core::Socket>);
+    // Hands over the connection once the response is complete, if it can carry another request.
+    RefPtr<Core::Socket> take_socket();
+
 protected:
     virtual bool should_fail_on_empty_payload() const override { return false; }
     virtual void register_on_ready_to_read(Function<void()>) override;
     virtual void register_on_ready_to_write(Function<void()>) override;
+    virtual void set_socket_reading_paused(bool) override;
     virtual bool can_read_line() const override;
     virtual ByteBuffer read_line(size_t) override;
     virtual bool can_read() const override;
@@ -63,7 +70,11 @@ protected:
     virtual bool is_established() const override { return true; }
 
 private:
+    Core::Task<void> connect_and_send_request();
+
     RefPtr<Core::Socket> m_socket;
+    // Declared after the socket, so that cancelling the task can still unhook it from the socket.
+    Core::Task<void> m_task;
 };
 
 }
@@ -60,6 +60,10 @@ public:
     Method method() const { return m_method; }
     void set_method(Method method) { m_method = method; }
 
+    // Whether to ask the server to keep the connection open after the response, so it can be reused.
+    bool keep_alive() const { return m_keep_alive; }
+    void set_keep_alive(bool keep_alive) { m_keep_alive = keep_alive; }
+
     String method_name() const;
     ByteBuffer to_raw_request() const;
 
@@ -74,6 +78,7 @@ private:
     String m_resource;
     Method m_method { GET };
     Vector<Header> m_headers;
+    bool m_keep_alive { false };
 };
 
 }
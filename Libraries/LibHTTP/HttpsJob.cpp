@@ -38,8 +38,13 @@ namespace HTTP {
 
 void HttpsJob::start()
 {
-    ASSERT(!m_socket);
-    m_socket = TLS::TLSv12::construct(this);
+    if (m_is_reusing_connection) {
+        ASSERT(m_socket);
+        add_child(*m_socket);
+    } else {
+        ASSERT(!m_socket);
+        m_socket = TLS::TLSv12::construct(this);
+    }
     m_socket->on_tls_connected = [this] {
 #ifdef HTTPSJOB_DEBUG
         dbg() << "HttpsJob: on_connected callback";
@@ -47,6 +52,8 @@ void HttpsJob::start()
         on_socket_connected();
     };
     m_socket->on_tls_error = [&](TLS::AlertDescription error) {
+        if (retry_on_fresh_connection())
+            return;
         if (error == TLS::AlertDescription::HandshakeFailure) {
             deferred_invoke([this](auto&) {
                 return did_fail(Core::NetworkJob::Error::ProtocolFailed);
@@ -62,12 +69,18 @@ void HttpsJob::start()
         }
     };
     m_socket->on_tls_finished = [&] {
+        if (retry_on_fresh_connection())
+            return;
         finish_up();
     };
     m_socket->on_tls_certificate_request = [this](auto&) {
         if (on_certificate_requested)
             on_certificate_requested(*this);
     };
+    if (m_is_reusing_connection) {
+        deferred_invoke([this](auto&) { on_socket_connected(); });
+        return;
+    }
     bool success = ((TLS::TLSv12&)*m_socket).connect(m_request.url().host(), m_request.url().port());
     if (!success) {
         deferred_invoke([this](auto&) {
@@ -86,6 +99,28 @@ void HttpsJob::shutdown()
     m_socket = nullptr;
 }
 
+void HttpsJob::set_socket(NonnullRefPtr<TLS::TLSv12> socket)
+{
+    ASSERT(!m_socket);
+    m_socket = move(socket);
+    m_is_reusing_connection = true;
+}
+
+RefPtr<TLS::TLSv12> HttpsJob::take_socket()
+{
+    if (!m_socket || !can_reuse_connection())
+        return nullptr;
+    m_socket->set_reading_paused(false);
+    m_socket->on_tls_ready_to_read = nullptr;
+    m_socket->on_tls_ready_to_write = nullptr;
+    m_socket->on_tls_connected = nullptr;
+    m_socket->on_tls_error = nullptr;
+    m_socket->on_tls_finished = nullptr;
+    m_socket->on_tls_certificate_request = nullptr;
+    remove_child(*m_socket);
+    return move(m_socket);
+}
+
 void HttpsJob::set_certificate(String certificate, String private_key)
 {
     if (!m_socket->add_client_key(
@@ -113,11 +148,20 @@ void HttpsJob::register_on_ready_to_read(Function<void()> callback)
     };
 }
 
+void HttpsJob::set_socket_reading_paused(bool paused)
+{
+    if (m_socket)
+        m_socket->set_reading_paused(paused);
+}
+
 void HttpsJob::register_on_ready_to_write(Function<void()> callback)
 {
     m_socket->on_tls_ready_to_write = [callback = move(callback)](auto&) {
         callback();
     };
+    // A connection we picked up from an earlier job is done with its handshake and won't tell us again.
+    if (m_socket->is_established())
+        m_socket->on_tls_ready_to_write(*m_socket);
 }
 
 bool HttpsJob::can_read_line() const
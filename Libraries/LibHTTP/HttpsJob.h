@@ -51,11 +51,17 @@ public:
     virtual void shutdown() override;
     void set_certificate(String certificate, String key);
 
+    // Sends the request over an idle connection from an earlier job instead of connecting. Call before start().
+    void set_socket(NonnullRefPtr<TLS::TLSv12>);
+    // Hands over the connection once the response is complete, if it can carry another request.
+    RefPtr<TLS::TLSv12> take_socket();
+
     Function<void(HttpsJob&)> on_certificate_requested;
 
 protected:
     virtual void register_on_ready_to_read(Function<void()>) override;
     virtual void register_on_ready_to_write(Function<void()>) override;
+    virtual void set_socket_reading_paused(bool) override;
     virtual bool can_read_line() const override;
     virtual ByteBuffer read_line(size_t) override;
     virtual bool can_read() const override;
@@ -24,6 +24,8 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <LibCompress/Deflate.h>
+#include <LibCompress/Zlib.h>
 #include <LibCore/Gzip.h>
 #include <LibCore/TCPSocket.h>
 #include <LibHTTP/HttpResponse.h>
@@ -65,6 +67,18 @@ static ByteBuffer handle_content_encoding(const ByteBuffer& buf, const String& c
         return uncompressed.value();
     }
 
+    if (content_encoding == "deflate") {
+        // "deflate" is supposed to mean zlib-wrapped data, but some servers send raw DEFLATE instead.
+        auto uncompressed = Compress::ZlibDecompressor::decompress_all(buf.span());
+        if (!uncompressed.has_value())
+            uncompressed = Compress::DeflateDecompressor::decompress_all(buf.span());
+        if (!uncompressed.has_value()) {
+            dbg() << "Job::handle_content_encoding: Deflate decompression failed. Returning original buffer.";
+            return buf;
+        }
+        return uncompressed.value();
+    }
+
     return buf;
 }
 
@@ -92,12 +106,24 @@ void Job::on_socket_connected()
         if (!success)
             deferred_invoke([this](auto&) { did_fail(Core::NetworkJob::Error::TransmissionFailed); });
     });
-    register_on_ready_to_read([&] {
-        if (is_cancelled())
+    register_on_ready_to_read([this] { read_available_data(); });
+}
+
+void Job::read_available_data()
+{
+    if (is_cancelled())
+        return;
+    // A kept-alive connection doesn't close at the end of the response, so nothing wakes us up
+    // again for data that has already been buffered. Keep going for as long as we make progress.
+    for (;;) {
+        if (m_state == State::Finished || m_reading_paused)
             return;
         if (m_state == State::InStatus) {
-            if (!can_read_line())
+            if (!can_read_line()) {
+                if (eof() && !retry_on_fresh_connection())
+                    deferred_invoke([this](auto&) { did_fail(Core::NetworkJob::Error::TransmissionFailed); });
                 return;
+            }
             auto line = read_line(PAGE_SIZE);
             if (line.is_null()) {
                 fprintf(stderr, "Job: Expected HTTP status\n");
@@ -114,8 +140,9 @@ void Job::on_socket_connected()
                 return deferred_invoke([this](auto&) { did_fail(Core::NetworkJob::Error::ProtocolFailed); });
             }
             m_code = code.value();
+            m_is_http_1_1 = parts[0] == "HTTP/1.1";
             m_state = State::InHeaders;
-            return;
+            continue;
         }
         if (m_state == State::InHeaders || m_state == State::AfterChunkedEncodingTrailer) {
             if (!can_read_line())
@@ -134,11 +161,20 @@ void Job::on_socket_connected()
             auto chomped_line = String::copy(line, Chomp);
             if (chomped_line.is_empty()) {
                 if (m_state == State::AfterChunkedEncodingTrailer) {
+                    m_response_was_complete = true;
                     return finish_up();
                 } else {
                     m_state = State::InBody;
+                    deferred_invoke([this](auto&) {
+                        if (on_headers_received)
+                            on_headers_received(m_headers, m_code);
+                    });
+                    if (!response_has_body()) {
+                        m_response_was_complete = true;
+                        return finish_up();
+                    }
                 }
-                return;
+                continue;
             }
             auto parts = chomped_line.split(':');
             if (parts.is_empty()) {
@@ -167,10 +203,11 @@ void Job::on_socket_connected()
 #ifdef JOB_DEBUG
             dbg() << "Job: [" << name << "] = '" << value << "'";
 #endif
-            return;
+            continue;
         }
         ASSERT(m_state == State::InBody);
-        ASSERT(can_read());
+        if (!can_read())
+            return;
 
         read_while_data_available([&] {
             auto read_size = 64 * KB;
@@ -224,6 +261,9 @@ void Job::on_socket_connected()
 #endif
                 }
             } else {
+                // Don't read into whatever comes after the body on a kept-alive connection.
+                if (auto content_length = this->content_length(); content_length.has_value())
+                    read_size = min<size_t>(read_size, content_length.value() - m_received_size);
                 auto transfer_encoding = m_headers.get("Transfer-Encoding");
                 if (transfer_encoding.has_value()) {
                     auto encoding = transfer_encoding.value();
@@ -252,9 +292,19 @@ void Job::on_socket_connected()
                 }
             }
 
-            m_received_buffers.append(payload);
+            // Encoded content can only be decoded once all of it has arrived.
+            bool can_pass_along = !m_headers.contains("Content-Encoding");
+            if (!can_pass_along || m_should_keep_passed_along_data)
+                m_received_buffers.append(payload);
             m_received_size += payload.size();
 
+            if (!payload.is_empty() && can_pass_along) {
+                deferred_invoke([this, payload](auto&) {
+                    if (on_data_received)
+                        on_data_received(payload);
+                });
+            }
+
             if (m_current_chunk_remaining_size.has_value()) {
                 auto size = m_current_chunk_remaining_size.value() - payload.size();
 #ifdef JOB_DEBUG
@@ -280,14 +330,7 @@ void Job::on_socket_connected()
                 m_current_chunk_remaining_size = size;
             }
 
-            auto content_length_header = m_headers.get("Content-Length");
-            Optional<u32> content_length {};
-
-            if (content_length_header.has_value()) {
-                auto length = content_length_header.value().to_uint();
-                if (length.has_value())
-                    content_length = length.value();
-            }
+            auto content_length = this->content_length();
 
             deferred_invoke([this, content_length](auto&) { did_progress(content_length, m_received_size); });
 
@@ -295,26 +338,86 @@ void Job::on_socket_connected()
                 auto length = content_length.value();
                 if (m_received_size >= length) {
                     m_received_size = length;
+                    m_response_was_complete = true;
                     finish_up();
                     return IterationDecision::Break;
                 }
             }
-            return IterationDecision::Continue;
+            return m_reading_paused ? IterationDecision::Break : IterationDecision::Continue;
         });
 
-        if (!is_established()) {
+        if (!is_established() && m_state != State::Finished) {
 #ifdef JOB_DEBUG
             dbg() << "Connection appears to have closed, finishing up";
 #endif
             finish_up();
         }
+        // The trailer may already be buffered, and nothing will tell us about it again.
+        if (m_state == State::AfterChunkedEncodingTrailer)
+            continue;
+        return;
+    }
+}
+
+void Job::set_reading_paused(bool paused)
+{
+    if (m_reading_paused == paused)
+        return;
+    m_reading_paused = paused;
+    set_socket_reading_paused(paused);
+    // Whatever got buffered before we paused won't be announced again.
+    if (!paused)
+        deferred_invoke([this](auto&) { read_available_data(); });
+}
+
+Optional<u32> Job::content_length() const
+{
+    auto content_length_header = m_headers.get("Content-Length");
+    if (!content_length_header.has_value())
+        return {};
+    return content_length_header.value().to_uint();
+}
+
+bool Job::response_has_body() const
+{
+    if (m_request.method() == HttpRequest::HEAD || m_code == 204 || m_code == 304 || (m_code >= 100 && m_code < 200))
+        return false;
+    auto content_length = this->content_length();
+    return !content_length.has_value() || content_length.value() > 0 || m_headers.contains("Transfer-Encoding");
+}
+
+bool Job::can_reuse_connection() const
+{
+    // A response without a length or chunked framing only ends when the server closes the connection.
+    if (!m_request.keep_alive() || !m_response_was_complete || !response())
+        return false;
+    auto connection = response()->headers().get("Connection");
+    if (connection.has_value())
+        return connection.value().equals_ignoring_case("keep-alive");
+    return m_is_http_1_1;
+}
+
+bool Job::retry_on_fresh_connection()
+{
+    // The server may have closed a kept-alive connection just as we picked it up.
+    if (!m_is_reusing_connection || m_state != State::InStatus)
+        return false;
+    m_is_reusing_connection = false;
+    m_sent_data = false;
+    deferred_invoke([this](auto&) {
+        shutdown();
+        start();
     });
+    return true;
 }
 
 void Job::finish_up()
 {
     m_state = State::Finished;
-    auto flattened_buffer = ByteBuffer::create_uninitialized(m_received_size);
+    size_t buffered_size = 0;
+    for (auto& received_buffer : m_received_buffers)
+        buffered_size += received_buffer.size();
+    auto flattened_buffer = ByteBuffer::create_uninitialized(buffered_size);
     u8* flat_ptr = flattened_buffer.data();
     for (auto& received_buffer : m_received_buffers) {
         memcpy(flat_ptr, received_buffer.data(), received_buffer.size());
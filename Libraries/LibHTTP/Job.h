@@ -43,14 +43,36 @@ public:
     virtual void start() override = 0;
     virtual void shutdown() override = 0;
 
+    const URL& url() const { return m_request.url(); }
+
     HttpResponse* response() { return static_cast<HttpResponse*>(Core::NetworkJob::response()); }
     const HttpResponse* response() const { return static_cast<const HttpResponse*>(Core::NetworkJob::response()); }
 
+    // These are called as the response comes in, ahead of on_finish. Body data is
+    // only passed along if it's usable as-is, i.e. it has no Content-Encoding.
+    Function<void(const HashMap<String, String, CaseInsensitiveStringTraits>& response_headers, int response_code)> on_headers_received;
+    Function<void(const ByteBuffer&)> on_data_received;
+
+    // Whether the connection can carry another request now that the response has been read.
+    bool can_reuse_connection() const;
+
+    // While paused, no more of the response is read from the socket, which pushes back on the server.
+    void set_reading_paused(bool);
+    bool is_reading_paused() const { return m_reading_paused; }
+
+    // Whether body data passed to on_data_received should also end up in the final response payload.
+    void set_should_keep_passed_along_data(bool should_keep) { m_should_keep_passed_along_data = should_keep; }
+
 protected:
     void finish_up();
     void on_socket_connected();
+    void read_available_data();
+    Optional<u32> content_length() const;
+    bool response_has_body() const;
+    bool retry_on_fresh_connection();
     virtual void register_on_ready_to_read(Function<void()>) = 0;
     virtual void register_on_ready_to_write(Function<void()>) = 0;
+    virtual void set_socket_reading_paused(bool) = 0;
     virtual bool can_read_line() const = 0;
     virtual ByteBuffer read_line(size_t) = 0;
     virtual bool can_read() const = 0;
@@ -78,6 +100,11 @@ protected:
     bool m_sent_data { 0 };
     Optional<ssize_t> m_current_chunk_remaining_size;
     Optional<size_t> m_current_chunk_total_size;
+    bool m_is_reusing_connection { false };
+    bool m_is_http_1_1 { false };
+    bool m_response_was_complete { false };
+    bool m_reading_paused { false };
+    bool m_should_keep_passed_along_data { true };
 };
 
 }
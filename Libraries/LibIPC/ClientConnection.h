@@ -34,8 +34,11 @@
 #include <LibCore/Timer.h>
 #include <LibIPC/Endpoint.h>
 #include <LibIPC/Message.h>
+#include <LibIPC/OutgoingMessageBatch.h>
+#include <LibIPC/SharedMemoryTransport.h>
 #include <errno.h>
 #include <stdio.h>
+#include <string.h>
 #include <sys/socket.h>
 #include <sys/types.h>
 #include <unistd.h>
@@ -109,31 +112,27 @@ public:
         if (!m_socket->is_open())
             return;
 
-        auto buffer = message.encode();
-
-        auto bytes_remaining = buffer.size();
-        while (bytes_remaining) {
-            auto nwritten = write(m_socket->fd(), buffer.data(), buffer.size());
-            if (nwritten < 0) {
-                switch (errno) {
-                case EPIPE:
-                    dbg() << *this << "::post_message: Disconnected from peer";
-                    shutdown();
-                    return;
-                case EAGAIN:
-                    dbg() << *this << "::post_message: Client buffer overflowed.";
-                    did_misbehave();
-                    return;
-                default:
-                    perror("Connection::post_message write");
-                    shutdown();
-                    return;
-                }
-            }
-            bytes_remaining -= nwritten;
+        if (m_batches_outgoing_messages) {
+            if (m_outgoing_batch.is_empty())
+                deferred_invoke([this](auto&) { flush_outgoing_messages(); });
+            m_outgoing_batch.append(message);
+            return;
         }
 
-        m_responsiveness_timer->start();
+        Vector<MessageBuffer> buffers;
+        buffers.append(message.encode());
+        send_buffers(buffers);
+    }
+
+    // Holds on to posted messages until the event loop comes around, then sends them all at once.
+    // Only for connections that post from the thread running the event loop.
+    void set_batches_outgoing_messages(bool batches) { m_batches_outgoing_messages = batches; }
+
+    void flush_outgoing_messages()
+    {
+        if (m_outgoing_batch.is_empty() || !m_socket->is_open())
+            return;
+        send_buffers(m_outgoing_batch.take_buffers());
     }
 
     void drain_messages_from_client()
@@ -146,7 +145,8 @@ public:
             u8 buffer[4096];
             ssize_t nread = recv(m_socket->fd(), buffer, sizeof(buffer), MSG_DONTWAIT);
             if (nread == 0 || (nread == -1 && errno == EAGAIN)) {
-                if (bytes.is_empty()) {
+                // With the shared memory transport, messages may be waiting in the ring without anything on the socket.
+                if (bytes.is_empty() && (nread == 0 || !m_transport)) {
                     Core::EventLoop::current().post_event(*this, make<DisconnectedEvent>(client_id()));
                     return;
                 }
@@ -165,8 +165,29 @@ public:
             did_become_responsive();
         }
 
+        if (m_transport) {
+            drain_messages_from_transport(bytes.span());
+            return;
+        }
+
         size_t decoded_bytes = 0;
         for (size_t index = 0; index < bytes.size(); index += decoded_bytes) {
+            if (bytes.size() - index >= sizeof(SharedMemoryTransport::SetupRequest)) {
+                SharedMemoryTransport::SetupRequest request;
+                memcpy(&request, bytes.data() + index, sizeof(request));
+                if (request.magic == SharedMemoryTransport::SetupRequest::static_magic) {
+                    index += sizeof(request);
+                    if (!set_up_shared_memory_transport(request))
+                        return;
+                    if (m_transport) {
+                        drain_messages_from_transport({ bytes.data() + index, bytes.size() - index });
+                        return;
+                    }
+                    // We couldn't attach to it, so the client carries on over the socket.
+                    decoded_bytes = 0;
+                    continue;
+                }
+            }
             auto remaining_bytes = ByteBuffer::wrap(bytes.data() + index, bytes.size() - index);
             auto message = Endpoint::decode_message(remaining_bytes, decoded_bytes);
             if (!message) {
@@ -203,6 +224,9 @@ public:
     pid_t client_pid() const { return m_client_pid; }
     void set_client_pid(pid_t pid) { m_client_pid = pid; }
 
+    // For passing file descriptors along with messages (see sendfd()).
+    int socket_fd() const { return m_socket->fd(); }
+
     virtual void die() = 0;
 
 protected:
@@ -221,9 +245,103 @@ protected:
     }
 
 private:
+    void send_buffers(const Vector<MessageBuffer>& buffers)
+    {
+        if (m_transport) {
+            for (auto& buffer : buffers) {
+                switch (m_transport->send(m_socket->fd(), buffer.span())) {
+                case SharedMemoryTransport::SendResult::Sent:
+                    continue;
+                case SharedMemoryTransport::SendResult::RingFull:
+                    dbg() << *this << "::post_message: Client buffer overflowed.";
+                    did_misbehave();
+                    return;
+                case SharedMemoryTransport::SendResult::Failed:
+                    if (errno == EAGAIN) {
+                        dbg() << *this << "::post_message: Client buffer overflowed.";
+                        did_misbehave();
+                        return;
+                    }
+                    dbg() << *this << "::post_message: Disconnected from peer";
+                    shutdown();
+                    return;
+                }
+            }
+        } else if (!OutgoingMessageBatch::write_buffers(m_socket->fd(), buffers)) {
+            switch (errno) {
+            case EPIPE:
+                dbg() << *this << "::post_message: Disconnected from peer";
+                shutdown();
+                return;
+            case EAGAIN:
+                dbg() << *this << "::post_message: Client buffer overflowed.";
+                did_misbehave();
+                return;
+            default:
+                perror("Connection::post_message write");
+                shutdown();
+                return;
+            }
+        }
+
+        m_responsiveness_timer->start();
+    }
+
+    bool set_up_shared_memory_transport(const SharedMemoryTransport::SetupRequest& request)
+    {
+        // Whatever we posted so far has to go out ahead of the answer, over the socket.
+        flush_outgoing_messages();
+        if (!m_socket->is_open())
+            return false;
+        auto transport = SharedMemoryTransport::attach(request.shbuf_id);
+        SharedMemoryTransport::SetupResponse response;
+        response.accepted = transport != nullptr;
+        if (write(m_socket->fd(), &response, sizeof(response)) != sizeof(response)) {
+            shutdown();
+            return false;
+        }
+        m_transport = move(transport);
+        return true;
+    }
+
+    void drain_messages_from_transport(ReadonlyBytes socket_bytes)
+    {
+        if (!m_transport->did_receive_from_socket(socket_bytes)) {
+            did_misbehave("Sent garbage alongside the shared memory transport");
+            return;
+        }
+        do {
+            Vector<ByteBuffer> messages;
+            if (!m_transport->take_messages(messages)) {
+                did_misbehave("Corrupted the shared memory transport");
+                return;
+            }
+            if (!messages.is_empty()) {
+                m_responsiveness_timer->stop();
+                did_become_responsive();
+            }
+            for (auto& buffer : messages) {
+                size_t decoded_bytes = 0;
+                auto message = Endpoint::decode_message(buffer, decoded_bytes);
+                if (!message || decoded_bytes != buffer.size()) {
+                    dbg() << "drain_messages_from_client: Endpoint didn't recognize message";
+                    did_misbehave();
+                    return;
+                }
+                if (auto response = m_endpoint.handle(*message))
+                    post_message(*response);
+                if (!m_socket->is_open())
+                    return;
+            }
+        } while (!m_transport->prepare_to_wait());
+    }
+
     Endpoint& m_endpoint;
     NonnullRefPtr<Core::LocalSocket> m_socket;
     RefPtr<Core::Timer> m_responsiveness_timer;
+    OwnPtr<SharedMemoryTransport> m_transport;
+    OutgoingMessageBatch m_outgoing_batch;
+    bool m_batches_outgoing_messages { false };
     int m_client_id { -1 };
     int m_client_pid { -1 };
 };
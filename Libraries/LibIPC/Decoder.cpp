@@ -114,6 +114,27 @@ bool Decoder::decode(String& value)
     return !m_stream.handle_read_failure();
 }
 
+bool Decoder::decode(StringView& value)
+{
+    i32 length = 0;
+    m_stream >> length;
+    if (m_stream.handle_read_failure())
+        return false;
+    if (length < 0) {
+        value = {};
+        return true;
+    }
+    if (length == 0) {
+        value = "";
+        return true;
+    }
+    auto bytes = m_stream.read_raw_in_place(static_cast<size_t>(length));
+    if (m_stream.handle_read_failure())
+        return false;
+    value = StringView(bytes.data(), bytes.size());
+    return true;
+}
+
 bool Decoder::decode(URL& value)
 {
     String string;
@@ -59,6 +59,8 @@ public:
     bool decode(i64&);
     bool decode(float&);
     bool decode(String&);
+    // Points into the message buffer, so it's only valid for as long as the message is.
+    bool decode(StringView&);
     bool decode(URL&);
     bool decode(Dictionary&);
 
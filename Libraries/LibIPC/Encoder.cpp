@@ -134,11 +134,16 @@ Encoder& Encoder::operator<<(const StringView& value)
 }
 
 Encoder& Encoder::operator<<(const String& value)
+{
+    return encode_string(value.view());
+}
+
+Encoder& Encoder::encode_string(const StringView& value)
 {
     if (value.is_null())
         return *this << (i32)-1;
     *this << static_cast<i32>(value.length());
-    return *this << value.view();
+    return *this << value;
 }
 
 Encoder& Encoder::operator<<(const URL& value)
@@ -58,6 +58,8 @@ public:
     Encoder& operator<<(const char*);
     Encoder& operator<<(const StringView&);
     Encoder& operator<<(const String&);
+    // Encodes a StringView the same way as a String, unlike operator<< which writes just the characters.
+    Encoder& encode_string(const StringView&);
     Encoder& operator<<(const URL&);
     Encoder& operator<<(const Dictionary&);
 
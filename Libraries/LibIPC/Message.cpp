@@ -28,6 +28,49 @@
 
 namespace IPC {
 
+static constexpr size_t size_class_granularity = 32;
+static constexpr size_t size_class_count = 16;
+static constexpr size_t max_free_blocks_per_size_class = 32;
+
+struct FreeBlock {
+    FreeBlock* next;
+};
+
+// Per thread, so messages made on other threads than the main one need no locking.
+static __thread FreeBlock* s_free_blocks[size_class_count];
+static __thread size_t s_free_block_counts[size_class_count];
+
+static size_t size_class_for(size_t size)
+{
+    return (size + size_class_granularity - 1) / size_class_granularity - 1;
+}
+
+void* Message::operator new(size_t size)
+{
+    auto size_class = size_class_for(size);
+    if (size_class >= size_class_count)
+        return ::operator new(size);
+    if (auto* block = s_free_blocks[size_class]) {
+        s_free_blocks[size_class] = block->next;
+        --s_free_block_counts[size_class];
+        return block;
+    }
+    return ::operator new((size_class + 1) * size_class_granularity);
+}
+
+void Message::operator delete(void* ptr, size_t size)
+{
+    auto size_class = size_class_for(size);
+    if (size_class >= size_class_count || s_free_block_counts[size_class] >= max_free_blocks_per_size_class) {
+        ::operator delete(ptr);
+        return;
+    }
+    auto* block = static_cast<FreeBlock*>(ptr);
+    block->next = s_free_blocks[size_class];
+    s_free_blocks[size_class] = block;
+    ++s_free_block_counts[size_class];
+}
+
 Message::Message()
 {
 }
@@ -26,6 +26,8 @@
 
 #pragma once
 
+#include <AK/ByteBuffer.h>
+#include <AK/OwnPtr.h>
 #include <AK/Vector.h>
 
 namespace IPC {
@@ -36,13 +38,30 @@ class Message {
 public:
     virtual ~Message();
 
+    // Messages come and go all the time, so their memory is recycled instead of going back to malloc.
+    static void* operator new(size_t);
+    static void operator delete(void*, size_t);
+
+    // Parameters marked [View] point into the buffer the message was received in. A connection
+    // that holds on to a message after decoding it has to keep that buffer alive along with it.
+    void set_receive_buffer(const ByteBuffer& buffer) { m_receive_buffer = buffer; }
+
     virtual int endpoint_magic() const = 0;
     virtual int message_id() const = 0;
     virtual const char* message_name() const = 0;
     virtual MessageBuffer encode() const = 0;
 
+    // Messages marked [Mergeable] in their endpoint definition can be folded into a queued
+    // message of the same kind whose other parameters are equal, by appending their vectors to it.
+    virtual bool is_mergeable() const { return false; }
+    virtual OwnPtr<Message> clone() const { return nullptr; }
+    virtual bool merge(const Message&) { return false; }
+
 protected:
     Message();
+
+private:
+    ByteBuffer m_receive_buffer;
 };
 
 }
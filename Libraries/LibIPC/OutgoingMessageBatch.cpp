@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2018-2020, The SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <LibIPC/OutgoingMessageBatch.h>
+#include <errno.h>
+#include <sys/uio.h>
+
+namespace IPC {
+
+static constexpr size_t max_buffers_per_write = 64;
+
+void OutgoingMessageBatch::append(const Message& message)
+{
+    if (!message.is_mergeable()) {
+        m_entries.append({ message.encode(), nullptr });
+        return;
+    }
+    // Only merge into the message right before, so nothing ends up reordered.
+    if (!m_entries.is_empty() && m_entries.last().mergeable_message && m_entries.last().mergeable_message->merge(message))
+        return;
+    m_entries.append({ {}, message.clone() });
+}
+
+Vector<MessageBuffer> OutgoingMessageBatch::take_buffers()
+{
+    Vector<MessageBuffer> buffers;
+    buffers.ensure_capacity(m_entries.size());
+    for (auto& entry : m_entries) {
+        if (entry.mergeable_message)
+            buffers.append(entry.mergeable_message->encode());
+        else
+            buffers.append(move(entry.buffer));
+    }
+    m_entries.clear();
+    return buffers;
+}
+
+bool OutgoingMessageBatch::write_buffers(int fd, const Vector<MessageBuffer>& buffers)
+{
+    Vector<iovec, max_buffers_per_write> iovecs;
+    size_t index = 0;
+    while (index < buffers.size()) {
+        iovecs.clear();
+        for (size_t i = index; i < buffers.size() && iovecs.size() < max_buffers_per_write; ++i)
+            iovecs.append({ const_cast<u8*>(buffers[i].data()), buffers[i].size() });
+
+        size_t first = 0;
+        while (first < iovecs.size()) {
+            auto nwritten = writev(fd, &iovecs[first], iovecs.size() - first);
+            if (nwritten < 0) {
+                if (errno == EINTR)
+                    continue;
+                return false;
+            }
+            // Skip over what made it out, which may end in the middle of a buffer.
+            while (nwritten > 0) {
+                auto& iovec = iovecs[first];
+                if ((size_t)nwritten < iovec.iov_len) {
+                    iovec.iov_base = (u8*)iovec.iov_base + nwritten;
+                    iovec.iov_len -= nwritten;
+                    break;
+                }
+                nwritten -= iovec.iov_len;
+                ++first;
+            }
+        }
+        index += iovecs.size();
+    }
+    return true;
+}
+
+}
@@ -33,8 +33,11 @@
 #include <LibCore/Notifier.h>
 #include <LibCore/SyscallUtils.h>
 #include <LibIPC/Message.h>
+#include <LibIPC/OutgoingMessageBatch.h>
+#include <LibIPC/SharedMemoryTransport.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <sys/select.h>
 #include <sys/socket.h>
 #include <sys/types.h>
@@ -80,23 +83,65 @@ public:
     void set_my_client_id(int id) { m_my_client_id = id; }
     int my_client_id() const { return m_my_client_id; }
 
+    // For receiving file descriptors passed along with messages (see recvfd()).
+    int socket_fd() const { return m_connection->fd(); }
+
     template<typename MessageType>
     OwnPtr<MessageType> wait_for_specific_message()
     {
         return wait_for_specific_endpoint_message<MessageType, LocalEndpoint>();
     }
 
-    bool post_message(const Message& message)
+    // Moves this connection's messages from the socket into memory shared with the server, if it
+    // agrees. Call it once server_pid() is right, since the shared buffer is only handed to that process.
+    void set_up_shared_memory_transport()
     {
-        auto buffer = message.encode();
-        int nwritten = write(m_connection->fd(), buffer.data(), buffer.size());
+        ASSERT(!m_transport);
+        flush_outgoing_messages();
+        auto transport = SharedMemoryTransport::create(m_server_pid);
+        if (!transport)
+            return;
+        SharedMemoryTransport::SetupRequest request;
+        request.shbuf_id = transport->shbuf_id();
+        int nwritten = write(m_connection->fd(), &request, sizeof(request));
         if (nwritten < 0) {
             perror("write");
             ASSERT_NOT_REACHED();
-            return false;
         }
-        ASSERT(static_cast<size_t>(nwritten) == buffer.size());
-        return true;
+        ASSERT(static_cast<size_t>(nwritten) == sizeof(request));
+
+        // Anything else the server sends before answering ends up in m_unprocessed_messages as usual.
+        m_pending_transport = move(transport);
+        while (m_pending_transport) {
+            wait_until_readable();
+            drain_messages_from_server();
+        }
+    }
+
+    bool post_message(const Message& message)
+    {
+        if (m_batches_outgoing_messages) {
+            if (m_outgoing_batch.is_empty())
+                deferred_invoke([this](auto&) { flush_outgoing_messages(); });
+            m_outgoing_batch.append(message);
+            return true;
+        }
+
+        Vector<MessageBuffer> buffers;
+        buffers.append(message.encode());
+        return send_buffers(buffers);
+    }
+
+    // Holds on to posted messages until the event loop comes around or we wait for a response,
+    // then sends them all at once. Only for connections that post from the thread running the event loop.
+    void set_batches_outgoing_messages(bool batches) { m_batches_outgoing_messages = batches; }
+
+    void flush_outgoing_messages()
+    {
+        if (m_outgoing_batch.is_empty())
+            return;
+        bool success = send_buffers(m_outgoing_batch.take_buffers());
+        ASSERT(success);
     }
 
     template<typename RequestType, typename... Args>
@@ -110,9 +155,38 @@ public:
     }
 
 private:
+    bool send_buffers(const Vector<MessageBuffer>& buffers)
+    {
+        if (m_transport) {
+            for (auto& buffer : buffers) {
+                for (;;) {
+                    auto result = m_transport->send(m_connection->fd(), buffer.span());
+                    if (result == SharedMemoryTransport::SendResult::Sent)
+                        break;
+                    if (result == SharedMemoryTransport::SendResult::Failed) {
+                        perror("write");
+                        ASSERT_NOT_REACHED();
+                        return false;
+                    }
+                    // Like a blocking socket, wait for the server to make room.
+                    usleep(1000);
+                }
+            }
+            return true;
+        }
+        if (!OutgoingMessageBatch::write_buffers(m_connection->fd(), buffers)) {
+            perror("writev");
+            ASSERT_NOT_REACHED();
+            return false;
+        }
+        return true;
+    }
+
     template<typename MessageType, typename Endpoint>
     OwnPtr<MessageType> wait_for_specific_endpoint_message()
     {
+        // Whatever we're waiting for may be the answer to something still in the batch.
+        flush_outgoing_messages();
         for (;;) {
             // Double check we don't already have the event waiting for us.
             // Otherwise we might end up blocked for a while for no reason.
@@ -124,26 +198,62 @@ private:
                     return m_unprocessed_messages.take(i).template release_nonnull<MessageType>();
             }
 
-            fd_set rfds;
-            FD_ZERO(&rfds);
-            FD_SET(m_connection->fd(), &rfds);
-            int rc = Core::safe_syscall(select, m_connection->fd() + 1, &rfds, nullptr, nullptr, nullptr);
-            if (rc < 0) {
-                perror("select");
-            }
-            ASSERT(rc > 0);
-            ASSERT(FD_ISSET(m_connection->fd(), &rfds));
+            wait_until_readable();
             if (!drain_messages_from_server())
                 return nullptr;
         }
     }
 
+    void wait_until_readable()
+    {
+        fd_set rfds;
+        FD_ZERO(&rfds);
+        FD_SET(m_connection->fd(), &rfds);
+        int rc = Core::safe_syscall(select, m_connection->fd() + 1, &rfds, nullptr, nullptr, nullptr);
+        if (rc < 0) {
+            perror("select");
+        }
+        ASSERT(rc > 0);
+        ASSERT(FD_ISSET(m_connection->fd(), &rfds));
+    }
+
+    void queue_message(const ByteBuffer& bytes, size_t& decoded_bytes, const ByteBuffer& receive_buffer)
+    {
+        OwnPtr<Message> message = LocalEndpoint::decode_message(bytes, decoded_bytes);
+        if (!message)
+            message = PeerEndpoint::decode_message(bytes, decoded_bytes);
+        ASSERT(message);
+        ASSERT(decoded_bytes);
+        // The message is handled later, so whatever it points into has to stick around until then.
+        message->set_receive_buffer(receive_buffer);
+        m_unprocessed_messages.append(message.release_nonnull());
+    }
+
+    void drain_messages_from_transport(ReadonlyBytes socket_bytes)
+    {
+        bool ok = m_transport->did_receive_from_socket(socket_bytes);
+        ASSERT(ok);
+        do {
+            Vector<ByteBuffer> messages;
+            ok = m_transport->take_messages(messages);
+            ASSERT(ok);
+            for (auto& buffer : messages) {
+                size_t decoded_bytes = 0;
+                queue_message(buffer, decoded_bytes, buffer);
+                ASSERT(decoded_bytes == buffer.size());
+            }
+        } while (!m_transport->prepare_to_wait());
+    }
+
     bool drain_messages_from_server()
     {
-        Vector<u8> bytes;
+        // Received straight into a ByteBuffer, which the decoded messages can then share.
+        auto bytes = ByteBuffer::create_uninitialized(4096);
+        size_t received_size = 0;
         for (;;) {
-            u8 buffer[4096];
-            ssize_t nread = recv(m_connection->fd(), buffer, sizeof(buffer), MSG_DONTWAIT);
+            if (received_size == bytes.size())
+                bytes.grow(bytes.size() * 2);
+            ssize_t nread = recv(m_connection->fd(), bytes.data() + received_size, bytes.size() - received_size, MSG_DONTWAIT);
             if (nread < 0) {
                 if (errno == EAGAIN)
                     break;
@@ -157,20 +267,33 @@ private:
                 exit(1);
                 return false;
             }
-            bytes.append(buffer, nread);
+            received_size += nread;
         }
+        bytes.trim(received_size);
 
-        size_t decoded_bytes = 0;
-        for (size_t index = 0; index < bytes.size(); index += decoded_bytes) {
-            auto remaining_bytes = ByteBuffer::wrap(bytes.data() + index, bytes.size() - index);
-            if (auto message = LocalEndpoint::decode_message(remaining_bytes, decoded_bytes)) {
-                m_unprocessed_messages.append(message.release_nonnull());
-            } else if (auto message = PeerEndpoint::decode_message(remaining_bytes, decoded_bytes)) {
-                m_unprocessed_messages.append(message.release_nonnull());
-            } else {
-                ASSERT_NOT_REACHED();
+        if (m_transport) {
+            drain_messages_from_transport(bytes.span());
+        } else {
+            size_t decoded_bytes = 0;
+            for (size_t index = 0; index < bytes.size(); index += decoded_bytes) {
+                if (m_pending_transport && bytes.size() - index >= sizeof(SharedMemoryTransport::SetupResponse)) {
+                    SharedMemoryTransport::SetupResponse response;
+                    memcpy(&response, bytes.data() + index, sizeof(response));
+                    if (response.magic == SharedMemoryTransport::SetupResponse::static_magic) {
+                        index += sizeof(response);
+                        if (response.accepted) {
+                            m_transport = move(m_pending_transport);
+                            drain_messages_from_transport({ bytes.data() + index, bytes.size() - index });
+                            break;
+                        }
+                        m_pending_transport = nullptr;
+                        decoded_bytes = 0;
+                        continue;
+                    }
+                }
+                auto remaining_bytes = ByteBuffer::wrap(bytes.data() + index, bytes.size() - index);
+                queue_message(remaining_bytes, decoded_bytes, bytes);
             }
-            ASSERT(decoded_bytes);
         }
 
         if (!m_unprocessed_messages.is_empty()) {
@@ -194,6 +317,10 @@ private:
     RefPtr<Core::LocalSocket> m_connection;
     RefPtr<Core::Notifier> m_notifier;
     NonnullOwnPtrVector<Message> m_unprocessed_messages;
+    OwnPtr<SharedMemoryTransport> m_transport;
+    OwnPtr<SharedMemoryTransport> m_pending_transport;
+    OutgoingMessageBatch m_outgoing_batch;
+    bool m_batches_outgoing_messages { false };
     int m_server_pid { -1 };
     int m_my_client_id { -1 };
 };
@@ -0,0 +1,273 @@
+/*
+ * Copyright (c) 2018-2020, The SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <AK/Atomic.h>
+#include <LibIPC/SharedMemoryTransport.h>
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+
+namespace IPC {
+
+// Must be a power of two, so positions can keep counting past 2^32 and still land on the right byte.
+static constexpr u32 ring_capacity = 64 * 1024;
+
+// Every record in a ring starts with its length. This length stands for a message sent through the socket instead.
+static constexpr u32 spilled_message_marker = 0xffffffff;
+
+// What the socket carries once the transport is in use.
+static constexpr u8 wake_up_tag = 0;
+static constexpr u8 spilled_message_tag = 1;
+
+// The reader owns head and the writer owns tail, and they're kept apart so the two sides don't
+// fight over a cache line. Both only ever count up; they're reduced modulo the capacity when used.
+struct SharedMemoryTransport::Ring {
+    alignas(64) Atomic<u32> head;
+    alignas(64) Atomic<u32> tail;
+    Atomic<u32> reader_is_waiting;
+};
+
+struct SharedMemoryTransport::Layout {
+    Ring rings[2];
+    u8 data[2][ring_capacity];
+};
+
+OwnPtr<SharedMemoryTransport> SharedMemoryTransport::create(pid_t peer_pid)
+{
+    auto buffer = SharedBuffer::create_with_size(sizeof(Layout));
+    if (!buffer)
+        return nullptr;
+    if (!buffer->share_with(peer_pid))
+        return nullptr;
+    auto transport = adopt_own(*new SharedMemoryTransport(buffer.release_nonnull(), true));
+    for (auto& ring : transport->layout().rings) {
+        ring.head.store(0);
+        ring.tail.store(0);
+        // Nobody has looked at the ring yet, so the first message needs a wake-up.
+        ring.reader_is_waiting.store(1);
+    }
+    return transport;
+}
+
+OwnPtr<SharedMemoryTransport> SharedMemoryTransport::attach(int shbuf_id)
+{
+    auto buffer = SharedBuffer::create_from_shbuf_id(shbuf_id);
+    if (!buffer || buffer->size() < (int)sizeof(Layout))
+        return nullptr;
+    return adopt_own(*new SharedMemoryTransport(buffer.release_nonnull(), false));
+}
+
+SharedMemoryTransport::SharedMemoryTransport(NonnullRefPtr<SharedBuffer> buffer, bool is_creator)
+    : m_buffer(move(buffer))
+    , m_is_creator(is_creator)
+{
+}
+
+SharedMemoryTransport::~SharedMemoryTransport()
+{
+}
+
+SharedMemoryTransport::Layout& SharedMemoryTransport::layout()
+{
+    return *reinterpret_cast<Layout*>(m_buffer->data());
+}
+
+static void copy_into_ring(u8* ring_data, u32 position, const u8* data, u32 length)
+{
+    auto offset = position % ring_capacity;
+    auto first_part = min(length, ring_capacity - offset);
+    memcpy(ring_data + offset, data, first_part);
+    memcpy(ring_data, data + first_part, length - first_part);
+}
+
+static void copy_out_of_ring(const u8* ring_data, u32 position, u8* data, u32 length)
+{
+    auto offset = position % ring_capacity;
+    auto first_part = min(length, ring_capacity - offset);
+    memcpy(data, ring_data + offset, first_part);
+    memcpy(data + first_part, ring_data, length - first_part);
+}
+
+static bool write_fully(int fd, const u8* data, size_t size)
+{
+    while (size) {
+        auto nwritten = write(fd, data, size);
+        if (nwritten < 0) {
+            if (errno == EINTR)
+                continue;
+            return false;
+        }
+        data += nwritten;
+        size -= nwritten;
+    }
+    return true;
+}
+
+bool SharedMemoryTransport::push(u32 length, const u8* data, u32 space_to_leave)
+{
+    u32 record_size = sizeof(length) + (data ? length : 0);
+    auto& ring = layout().rings[outgoing_index()];
+    auto head = ring.head.load(AK::memory_order_acquire);
+    auto tail = ring.tail.load(AK::memory_order_relaxed);
+    u32 used = tail - head;
+    if (used > ring_capacity || record_size + space_to_leave > ring_capacity - used)
+        return false;
+
+    auto* ring_data = layout().data[outgoing_index()];
+    copy_into_ring(ring_data, tail, reinterpret_cast<const u8*>(&length), sizeof(length));
+    if (data)
+        copy_into_ring(ring_data, tail + sizeof(length), data, length);
+    ring.tail.store(tail + record_size);
+    return true;
+}
+
+void SharedMemoryTransport::wake_up_peer(int fd)
+{
+    // Pairs with prepare_to_wait(): either the reader sees the new tail, or we see that it's waiting.
+    auto& ring = layout().rings[outgoing_index()];
+    if (!ring.reader_is_waiting.exchange(0))
+        return;
+    // If this fails because the socket is full, the peer has plenty to wake up for already.
+    u8 tag = wake_up_tag;
+    (void)write(fd, &tag, sizeof(tag));
+}
+
+SharedMemoryTransport::SendResult SharedMemoryTransport::send(int fd, ReadonlyBytes message)
+{
+    // Always leave room for a marker, so a message that doesn't fit can still be sent in order.
+    if (message.size() < ring_capacity && push(message.size(), message.data(), sizeof(u32))) {
+        wake_up_peer(fd);
+        return SendResult::Sent;
+    }
+
+    auto& ring = layout().rings[outgoing_index()];
+    u32 used = ring.tail.load(AK::memory_order_relaxed) - ring.head.load(AK::memory_order_acquire);
+    if (used > ring_capacity - sizeof(u32))
+        return SendResult::RingFull;
+
+    // The message goes out before its marker, so the reader never finds a marker with nothing
+    // on the way. It may see the message first though, and hold on to it until the marker shows up.
+    u8 header[1 + sizeof(u32)];
+    header[0] = spilled_message_tag;
+    u32 size = message.size();
+    memcpy(header + 1, &size, sizeof(size));
+    if (!write_fully(fd, header, sizeof(header)) || !write_fully(fd, message.data(), message.size()))
+        return SendResult::Failed;
+
+    bool pushed = push(spilled_message_marker, nullptr, 0);
+    ASSERT(pushed);
+    wake_up_peer(fd);
+    return SendResult::Sent;
+}
+
+bool SharedMemoryTransport::did_receive_from_socket(ReadonlyBytes bytes)
+{
+    m_socket_bytes.append(bytes.data(), bytes.size());
+
+    size_t index = 0;
+    while (index < m_socket_bytes.size()) {
+        auto tag = m_socket_bytes[index];
+        if (tag == wake_up_tag) {
+            ++index;
+            continue;
+        }
+        if (tag != spilled_message_tag)
+            return false;
+        if (m_socket_bytes.size() - index < 1 + sizeof(u32))
+            break;
+        u32 size;
+        memcpy(&size, &m_socket_bytes[index + 1], sizeof(size));
+        if (m_socket_bytes.size() - index - 1 - sizeof(u32) < size)
+            break;
+        m_spilled_messages.append(ByteBuffer::copy(&m_socket_bytes[index + 1 + sizeof(u32)], size));
+        index += 1 + sizeof(u32) + size;
+    }
+
+    // Keep whatever is left of a spilled message that hasn't fully arrived yet.
+    Vector<u8> remaining_bytes;
+    remaining_bytes.append(m_socket_bytes.data() + index, m_socket_bytes.size() - index);
+    m_socket_bytes = move(remaining_bytes);
+    return true;
+}
+
+bool SharedMemoryTransport::take_messages(Vector<ByteBuffer>& messages)
+{
+    auto& ring = layout().rings[incoming_index()];
+    auto* ring_data = layout().data[incoming_index()];
+    for (;;) {
+        auto head = ring.head.load(AK::memory_order_relaxed);
+        u32 available = ring.tail.load(AK::memory_order_acquire) - head;
+        if (available == 0)
+            return true;
+        if (available > ring_capacity || available < sizeof(u32))
+            return false;
+
+        u32 length;
+        copy_out_of_ring(ring_data, head, reinterpret_cast<u8*>(&length), sizeof(length));
+        if (length == spilled_message_marker) {
+            // It's still on its way through the socket.
+            if (m_spilled_messages.is_empty())
+                return true;
+            messages.append(m_spilled_messages.take_first());
+            ring.head.store(head + sizeof(u32), AK::memory_order_release);
+            continue;
+        }
+        if (length > available - sizeof(u32))
+            return false;
+
+        // Copy the message out before decoding it, so the peer can't change it underneath us.
+        auto message = ByteBuffer::create_uninitialized(length);
+        copy_out_of_ring(ring_data, head + sizeof(u32), message.data(), length);
+        ring.head.store(head + sizeof(u32) + length, AK::memory_order_release);
+        messages.append(move(message));
+    }
+}
+
+bool SharedMemoryTransport::has_message_to_take()
+{
+    auto& ring = layout().rings[incoming_index()];
+    auto head = ring.head.load(AK::memory_order_relaxed);
+    u32 available = ring.tail.load() - head;
+    if (available == 0)
+        return false;
+    if (available < sizeof(u32))
+        return true;
+    u32 length;
+    copy_out_of_ring(layout().data[incoming_index()], head, reinterpret_cast<u8*>(&length), sizeof(length));
+    return length != spilled_message_marker || !m_spilled_messages.is_empty();
+}
+
+bool SharedMemoryTransport::prepare_to_wait()
+{
+    auto& ring = layout().rings[incoming_index()];
+    ring.reader_is_waiting.store(1);
+    if (!has_message_to_take())
+        return true;
+    ring.reader_is_waiting.store(0);
+    return false;
+}
+
+}
@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2018-2020, The SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/ByteBuffer.h>
+#include <AK/OwnPtr.h>
+#include <AK/SharedBuffer.h>
+#include <AK/Span.h>
+#include <AK/Vector.h>
+#include <sys/types.h>
+
+namespace IPC {
+
+// A pair of single-producer, single-consumer rings in a buffer shared by both ends of a
+// connection, so that messages don't have to be copied through the kernel. Once a connection
+// has switched over to it, the socket only carries a wake-up byte when the peer is waiting for
+// messages, and the occasional message that doesn't fit into the ring. Those leave a marker
+// behind in the ring, so everything is still received in the order it was sent.
+class SharedMemoryTransport {
+public:
+    // Sent in place of a message to set up the transport, and to answer whether it was.
+    // Their magics are far outside the range of endpoint magics picked in the .ipc files.
+    struct SetupRequest {
+        static constexpr u32 static_magic = 0x474e4952; // "RING"
+        u32 magic { static_magic };
+        i32 shbuf_id { -1 };
+    };
+    struct SetupResponse {
+        static constexpr u32 static_magic = 0x4b434152; // "RACK"
+        u32 magic { static_magic };
+        i32 accepted { 0 };
+    };
+
+    static OwnPtr<SharedMemoryTransport> create(pid_t peer_pid);
+    static OwnPtr<SharedMemoryTransport> attach(int shbuf_id);
+    ~SharedMemoryTransport();
+
+    int shbuf_id() const { return m_buffer->shbuf_id(); }
+
+    enum class SendResult {
+        Sent,
+        RingFull,
+        Failed,
+    };
+    SendResult send(int fd, ReadonlyBytes message);
+
+    // Returns false if the peer wrote something other than wake-ups and spilled messages.
+    bool did_receive_from_socket(ReadonlyBytes);
+
+    // Returns false if the peer corrupted the ring.
+    bool take_messages(Vector<ByteBuffer>&);
+
+    // Asks the peer to wake us up through the socket when it sends the next message.
+    // Returns false if there are messages to take already, so we shouldn't wait.
+    bool prepare_to_wait();
+
+private:
+    struct Ring;
+    struct Layout;
+
+    SharedMemoryTransport(NonnullRefPtr<SharedBuffer>, bool is_creator);
+
+    Layout& layout();
+    size_t outgoing_index() const { return m_is_creator ? 0 : 1; }
+    size_t incoming_index() const { return m_is_creator ? 1 : 0; }
+
+    bool push(u32 length, const u8* data, u32 space_to_leave);
+    void wake_up_peer(int fd);
+    bool has_message_to_take();
+
+    NonnullRefPtr<SharedBuffer> m_buffer;
+    bool m_is_creator { false };
+    Vector<u8> m_socket_bytes;
+    Vector<ByteBuffer> m_spilled_messages;
+};
+
+}
@@ -25,6 +25,7 @@
  */
 
 #include <AK/SharedBuffer.h>
+#include <LibGfx/Bitmap.h>
 #include <LibImageDecoderClient/Client.h>
 
 namespace ImageDecoderClient {
@@ -42,11 +43,7 @@ void Client::handshake()
     set_server_pid(response->server_pid());
 }
 
-void Client::handle(const Messages::ImageDecoderClient::Dummy&)
-{
-}
-
-RefPtr<Gfx::Bitmap> Client::decode_image(const ByteBuffer& encoded_data)
+RefPtr<SharedBuffer> Client::share_encoded_data(const ByteBuffer& encoded_data)
 {
     if (encoded_data.is_empty())
         return nullptr;
@@ -61,28 +58,60 @@ RefPtr<Gfx::Bitmap> Client::decode_image(const ByteBuffer& encoded_data)
 
     encoded_buffer->seal();
     encoded_buffer->share_with(server_pid());
+    return encoded_buffer;
+}
 
-    auto response = send_sync<Messages::ImageDecoderServer::DecodeImage>(encoded_buffer->shbuf_id(), encoded_data.size());
-    auto bitmap_format = (Gfx::BitmapFormat)response->bitmap_format();
-    if (bitmap_format == Gfx::BitmapFormat::Invalid) {
+RefPtr<Gfx::Bitmap> Client::adopt_decoded_bitmap(const Gfx::ShareableBitmap& shareable_bitmap)
+{
+    if (!shareable_bitmap.is_valid()) {
 #ifdef IMAGE_DECODER_CLIENT_DEBUG
         dbg() << "Response image was invalid";
 #endif
         return nullptr;
     }
 
-    if (response->size().is_empty()) {
+    // We've mapped the buffer now, so the service no longer needs to hold on to it.
+    RefPtr<Gfx::Bitmap> bitmap = const_cast<Gfx::Bitmap*>(shareable_bitmap.bitmap());
+    post_message(Messages::ImageDecoderServer::DisownSharedBuffer(bitmap->shbuf_id()));
+
+    if (bitmap->size().is_empty()) {
         dbg() << "Response image was empty";
         return nullptr;
     }
+    return bitmap;
+}
 
-    auto decoded_buffer = SharedBuffer::create_from_shbuf_id(response->decoded_shbuf_id());
-    if (!decoded_buffer) {
-        dbg() << "Could not map decoded image shbuf_id=" << response->decoded_shbuf_id();
+RefPtr<Gfx::Bitmap> Client::decode_image(const ByteBuffer& encoded_data, const Gfx::IntSize& desired_size)
+{
+    auto encoded_buffer = share_encoded_data(encoded_data);
+    if (!encoded_buffer)
         return nullptr;
+
+    auto response = send_sync<Messages::ImageDecoderServer::DecodeImage>(encoded_buffer->shbuf_id(), encoded_data.size(), desired_size);
+    return adopt_decoded_bitmap(response->bitmap());
+}
+
+void Client::decode_image_async(const ByteBuffer& encoded_data, const Gfx::IntSize& desired_size, Function<void(RefPtr<Gfx::Bitmap>)> callback)
+{
+    auto encoded_buffer = share_encoded_data(encoded_data);
+    if (!encoded_buffer) {
+        callback(nullptr);
+        return;
     }
 
-    return Gfx::Bitmap::create_with_shared_buffer(bitmap_format, decoded_buffer.release_nonnull(), response->size(), response->palette());
+    i32 request_id = ++m_next_request_id;
+    m_pending_decodes.set(request_id, make<PendingDecode>(PendingDecode { encoded_buffer, move(callback) }));
+    post_message(Messages::ImageDecoderServer::DecodeImageAsync(request_id, encoded_buffer->shbuf_id(), encoded_data.size(), desired_size));
+}
+
+void Client::handle(const Messages::ImageDecoderClient::DidDecodeImage& message)
+{
+    auto it = m_pending_decodes.find(message.request_id());
+    if (it == m_pending_decodes.end())
+        return;
+    auto pending_decode = move(it->value);
+    m_pending_decodes.remove(it);
+    pending_decode->callback(adopt_decoded_bitmap(message.bitmap()));
 }
 
 }
@@ -26,6 +26,7 @@
 
 #pragma once
 
+#include <AK/Function.h>
 #include <AK/HashMap.h>
 #include <ImageDecoder/ImageDecoderClientEndpoint.h>
 #include <ImageDecoder/ImageDecoderServerEndpoint.h>
@@ -41,12 +42,27 @@ class Client
 public:
     virtual void handshake() override;
 
-    RefPtr<Gfx::Bitmap> decode_image(const ByteBuffer&);
+    RefPtr<Gfx::Bitmap> decode_image(const ByteBuffer&, const Gfx::IntSize& desired_size = {});
+
+    // Returns right away. The callback is called from the event loop with the decoded bitmap
+    // (or nullptr), so any number of images can be decoding in the service at the same time.
+    void decode_image_async(const ByteBuffer&, const Gfx::IntSize& desired_size, Function<void(RefPtr<Gfx::Bitmap>)> callback);
 
 private:
     Client();
 
-    virtual void handle(const Messages::ImageDecoderClient::Dummy&) override;
+    virtual void handle(const Messages::ImageDecoderClient::DidDecodeImage&) override;
+
+    RefPtr<SharedBuffer> share_encoded_data(const ByteBuffer&);
+    RefPtr<Gfx::Bitmap> adopt_decoded_bitmap(const Gfx::ShareableBitmap&);
+
+    struct PendingDecode {
+        // Kept alive until the reply, since the service may not have mapped it yet.
+        RefPtr<SharedBuffer> encoded_buffer;
+        Function<void(RefPtr<Gfx::Bitmap>)> callback;
+    };
+    HashMap<i32, OwnPtr<PendingDecode>> m_pending_decodes;
+    i32 m_next_request_id { 0 };
 };
 
 }
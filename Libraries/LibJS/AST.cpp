@@ -30,6 +30,7 @@
 #include <AK/StringBuilder.h>
 #include <LibCrypto/BigInt/SignedBigInteger.h>
 #include <LibJS/AST.h>
+#include <LibJS/Bytecode/Block.h>
 #include <LibJS/Interpreter.h>
 #include <LibJS/Runtime/Accessor.h>
 #include <LibJS/Runtime/Array.h>
@@ -45,11 +46,12 @@
 #include <LibJS/Runtime/ScriptFunction.h>
 #include <LibJS/Runtime/Shape.h>
 #include <LibJS/Runtime/StringObject.h>
+#include <LibJS/ScopeAnalysis.h>
 #include <stdio.h>
 
 namespace JS {
 
-static void update_function_name(Value& value, const FlyString& name)
+void update_function_name(Value& value, const FlyString& name)
 {
     if (!value.is_object())
         return;
@@ -74,6 +76,14 @@ static String get_function_name(Interpreter& interpreter, Value value)
     return value.to_string(interpreter);
 }
 
+ScopeNode::ScopeNode()
+{
+}
+
+ScopeNode::~ScopeNode()
+{
+}
+
 Value ScopeNode::execute(Interpreter& interpreter, GlobalObject& global_object) const
 {
     return interpreter.run(global_object, *this);
@@ -86,7 +96,12 @@ Value FunctionDeclaration::execute(Interpreter&, GlobalObject&) const
 
 Value FunctionExpression::execute(Interpreter& interpreter, GlobalObject& global_object) const
 {
-    return ScriptFunction::create(global_object, name(), body(), parameters(), function_length(), interpreter.current_environment(), m_is_arrow_function);
+    return instantiate(interpreter, global_object);
+}
+
+ScriptFunction* FunctionExpression::instantiate(Interpreter& interpreter, GlobalObject& global_object) const
+{
+    return ScriptFunction::create(global_object, *this, interpreter.current_environment(), m_is_arrow_function);
 }
 
 Value ExpressionStatement::execute(Interpreter& interpreter, GlobalObject& global_object) const
@@ -122,12 +137,29 @@ CallExpression::ThisAndCallee CallExpression::compute_this_and_callee(Interprete
         auto* this_value = is_super_property_lookup ? &interpreter.this_value(global_object).as_object() : lookup_target.to_object(interpreter, global_object);
         if (interpreter.exception())
             return {};
-        auto callee = lookup_target.to_object(interpreter, global_object)->get(member_expression.computed_property_name(interpreter, global_object)).value_or(js_undefined());
+        auto* lookup_target_object = lookup_target.to_object(interpreter, global_object);
+        if (interpreter.exception())
+            return {};
+        auto callee = member_expression.get_from(interpreter, global_object, *lookup_target_object);
         return { this_value, callee };
     }
     return { &global_object, m_callee->execute(interpreter, global_object) };
 }
 
+Value CallExpression::throw_type_error_for_callee(Interpreter& interpreter, Value callee, const char* call_type) const
+{
+    if (m_callee->is_identifier() || m_callee->is_member_expression()) {
+        String expression_string;
+        if (m_callee->is_identifier()) {
+            expression_string = static_cast<const Identifier&>(*m_callee).string();
+        } else {
+            expression_string = static_cast<const MemberExpression&>(*m_callee).to_string_approximation();
+        }
+        return interpreter.throw_exception<TypeError>(ErrorType::IsNotAEvaluatedFrom, callee.to_string_without_side_effects().characters(), call_type, expression_string.characters());
+    }
+    return interpreter.throw_exception<TypeError>(ErrorType::IsNotA, callee.to_string_without_side_effects().characters(), call_type);
+}
+
 Value CallExpression::execute(Interpreter& interpreter, GlobalObject& global_object) const
 {
     auto [this_value, callee] = compute_this_and_callee(interpreter, global_object);
@@ -137,21 +169,8 @@ Value CallExpression::execute(Interpreter& interpreter, GlobalObject& global_obj
     ASSERT(!callee.is_empty());
 
     if (!callee.is_function()
-        || (is_new_expression() && (callee.as_object().is_native_function() && !static_cast<NativeFunction&>(callee.as_object()).has_constructor()))) {
-        String error_message;
-        auto call_type = is_new_expression() ? "constructor" : "function";
-        if (m_callee->is_identifier() || m_callee->is_member_expression()) {
-            String expression_string;
-            if (m_callee->is_identifier()) {
-                expression_string = static_cast<const Identifier&>(*m_callee).string();
-            } else {
-                expression_string = static_cast<const MemberExpression&>(*m_callee).to_string_approximation();
-            }
-            return interpreter.throw_exception<TypeError>(ErrorType::IsNotAEvaluatedFrom, callee.to_string_without_side_effects().characters(), call_type, expression_string.characters());
-        } else {
-            return interpreter.throw_exception<TypeError>(ErrorType::IsNotA, callee.to_string_without_side_effects().characters(), call_type);
-        }
-    }
+        || (is_new_expression() && (callee.as_object().is_native_function() && !static_cast<NativeFunction&>(callee.as_object()).has_constructor())))
+        return throw_type_error_for_callee(interpreter, callee, is_new_expression() ? "constructor" : "function");
 
     auto& function = callee.as_function();
 
@@ -545,6 +564,8 @@ Reference Expression::to_reference(Interpreter&, GlobalObject&) const
 
 Reference Identifier::to_reference(Interpreter& interpreter, GlobalObject&) const
 {
+    if (m_environment_coordinate.has_value())
+        return { Reference::LocalVariable, string(), m_environment_coordinate.value() };
     return interpreter.get_reference(string());
 }
 
@@ -556,7 +577,10 @@ Reference MemberExpression::to_reference(Interpreter& interpreter, GlobalObject&
     auto property_name = computed_property_name(interpreter, global_object);
     if (!property_name.is_valid())
         return {};
-    return { object_value, property_name };
+    Reference reference { object_value, property_name };
+    if (!m_computed)
+        reference.set_lookup_cache(m_reference_cache);
+    return reference;
 }
 
 Value UnaryExpression::execute(Interpreter& interpreter, GlobalObject& global_object) const
@@ -578,7 +602,9 @@ Value UnaryExpression::execute(Interpreter& interpreter, GlobalObject& global_ob
     }
 
     Value lhs_result;
-    if (m_op == UnaryOp::Typeof && m_lhs->is_identifier()) {
+    if (m_op == UnaryOp::Typeof && m_lhs->is_identifier() && static_cast<const Identifier&>(*m_lhs).environment_coordinate().has_value()) {
+        lhs_result = interpreter.get_variable(static_cast<const Identifier&>(*m_lhs).environment_coordinate().value());
+    } else if (m_op == UnaryOp::Typeof && m_lhs->is_identifier()) {
         auto reference = m_lhs->to_reference(interpreter, global_object);
         if (interpreter.exception()) {
             return {};
@@ -606,33 +632,7 @@ Value UnaryExpression::execute(Interpreter& interpreter, GlobalObject& global_ob
     case UnaryOp::Minus:
         return unary_minus(interpreter, lhs_result);
     case UnaryOp::Typeof:
-        switch (lhs_result.type()) {
-        case Value::Type::Empty:
-            ASSERT_NOT_REACHED();
-            return {};
-        case Value::Type::Undefined:
-            return js_string(interpreter, "undefined");
-        case Value::Type::Null:
-            // yes, this is on purpose. yes, this is how javascript works.
-            // yes, it's silly.
-            return js_string(interpreter, "object");
-        case Value::Type::Number:
-            return js_string(interpreter, "number");
-        case Value::Type::String:
-            return js_string(interpreter, "string");
-        case Value::Type::Object:
-            if (lhs_result.is_function())
-                return js_string(interpreter, "function");
-            return js_string(interpreter, "object");
-        case Value::Type::Boolean:
-            return js_string(interpreter, "boolean");
-        case Value::Type::Symbol:
-            return js_string(interpreter, "symbol");
-        case Value::Type::BigInt:
-            return js_string(interpreter, "bigint");
-        default:
-            ASSERT_NOT_REACHED();
-        }
+        return js_string(interpreter, lhs_result.typeof_string());
     case UnaryOp::Void:
         return js_undefined();
     case UnaryOp::Delete:
@@ -1042,7 +1042,12 @@ void FunctionNode::dump(int indent, const char* class_name) const
     }
     print_indent(indent + 1);
     printf("(Body)\n");
-    body().dump(indent + 2);
+    if (auto* body = parsed_body()) {
+        body->dump(indent + 2);
+    } else {
+        print_indent(indent + 2);
+        printf("(Not parsed yet)\n");
+    }
 }
 
 void FunctionDeclaration::dump(int indent) const
@@ -1136,6 +1141,8 @@ void ForOfStatement::dump(int indent) const
 
 Value Identifier::execute(Interpreter& interpreter, GlobalObject& global_object) const
 {
+    if (m_environment_coordinate.has_value())
+        return interpreter.get_variable(m_environment_coordinate.value());
     auto value = interpreter.get_variable(string(), global_object);
     if (value.is_empty())
         return interpreter.throw_exception<ReferenceError>(ErrorType::UnknownIdentifier, string().characters());
@@ -1390,7 +1397,10 @@ Value VariableDeclaration::execute(Interpreter& interpreter, GlobalObject& globa
                 return {};
             auto variable_name = declarator.id().string();
             update_function_name(initalizer_result, variable_name);
-            interpreter.set_variable(variable_name, initalizer_result, global_object, true);
+            if (declarator.id().environment_coordinate().has_value())
+                interpreter.set_variable(declarator.id().environment_coordinate().value(), initalizer_result, true);
+            else
+                interpreter.set_variable(variable_name, initalizer_result, global_object, true);
         }
     }
     return js_undefined();
@@ -1582,7 +1592,24 @@ Value MemberExpression::execute(Interpreter& interpreter, GlobalObject& global_o
     auto* object_result = object_value.to_object(interpreter, global_object);
     if (interpreter.exception())
         return {};
-    return object_result->get(computed_property_name(interpreter, global_object)).value_or(js_undefined());
+    return get_from(interpreter, global_object, *object_result);
+}
+
+Value MemberExpression::get_from(Interpreter& interpreter, GlobalObject& global_object, const Object& object) const
+{
+    if (m_computed)
+        return object.get(computed_property_name(interpreter, global_object)).value_or(js_undefined());
+
+    auto cached_value = m_load_cache.get(object);
+    if (!cached_value.is_empty())
+        return cached_value;
+
+    auto& property_name = static_cast<const Identifier&>(*m_property).string();
+    auto value = object.get(property_name);
+    if (interpreter.exception())
+        return {};
+    m_load_cache.update_for_get(object, StringOrSymbol(property_name));
+    return value.value_or(js_undefined());
 }
 
 Value StringLiteral::execute(Interpreter& interpreter, GlobalObject&) const
@@ -1941,4 +1968,78 @@ void ScopeNode::add_functions(NonnullRefPtrVector<FunctionDeclaration> functions
     m_functions.append(move(functions));
 }
 
+EnvironmentLayout& ScopeNode::environment_layout() const
+{
+    if (!m_environment_layout) {
+        m_environment_layout = EnvironmentLayout::create();
+        for (auto& declaration : m_variables) {
+            for (auto& declarator : declaration.declarations())
+                m_environment_layout->add(declarator.id().string(), declaration.declaration_kind());
+        }
+    }
+    return *m_environment_layout;
+}
+
+FunctionNode::FunctionNode(const FlyString& name, NonnullRefPtr<LazyFunctionBody> lazy_body, Vector<Parameter> parameters, i32 function_length)
+    : m_name(name)
+    , m_lazy_body(move(lazy_body))
+    , m_parameters(move(parameters))
+    , m_function_length(function_length)
+{
+    for (auto& parameter : m_parameters)
+        m_lazy_body->environment_layout().add(parameter.name, DeclarationKind::Var);
+}
+
+EnvironmentLayout& FunctionNode::environment_layout() const
+{
+    if (m_lazy_body)
+        return m_lazy_body->environment_layout();
+    if (!m_environment_layout) {
+        m_environment_layout = EnvironmentLayout::create();
+        for (auto& parameter : m_parameters)
+            m_environment_layout->add(parameter.name, DeclarationKind::Var);
+        if (m_body->is_scope_node()) {
+            for (auto& declaration : static_cast<const ScopeNode&>(*m_body).variables()) {
+                for (auto& declarator : declaration.declarations())
+                    m_environment_layout->add(declarator.id().string(), DeclarationKind::Var);
+            }
+        }
+    }
+    return *m_environment_layout;
+}
+
+const Statement* FunctionNode::parsed_body() const
+{
+    if (m_lazy_body)
+        return m_lazy_body->body();
+    return m_body;
+}
+
+const Statement& FunctionNode::body() const
+{
+    auto* body = parsed_body();
+    ASSERT(body);
+    return *body;
+}
+
+LazyFunctionBody::LazyFunctionBody(String source, SourcePosition position, bool is_arrow_function, bool strict_mode, bool allow_super_property_lookup, bool allow_super_constructor_call)
+    : m_source(move(source))
+    , m_position(position)
+    , m_is_arrow_function(is_arrow_function)
+    , m_strict_mode(strict_mode)
+    , m_allow_super_property_lookup(allow_super_property_lookup)
+    , m_allow_super_constructor_call(allow_super_constructor_call)
+    , m_environment_layout(EnvironmentLayout::create())
+{
+}
+
+LazyFunctionBody::~LazyFunctionBody()
+{
+}
+
+void LazyFunctionBody::set_scope_analysis_context(NonnullRefPtr<ScopeAnalysisContext> context)
+{
+    m_scope_analysis_context = move(context);
+}
+
 }
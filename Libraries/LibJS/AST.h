@@ -27,13 +27,19 @@
 
 #pragma once
 
+#include <AK/ArenaAllocator.h>
 #include <AK/FlyString.h>
 #include <AK/HashMap.h>
 #include <AK/NonnullRefPtrVector.h>
+#include <AK/Optional.h>
+#include <AK/OwnPtr.h>
 #include <AK/RefPtr.h>
 #include <AK/String.h>
 #include <AK/Vector.h>
+#include <LibJS/Bytecode/Register.h>
 #include <LibJS/Forward.h>
+#include <LibJS/Runtime/EnvironmentLayout.h>
+#include <LibJS/Runtime/PropertyLookupCache.h>
 #include <LibJS/Runtime/PropertyName.h>
 #include <LibJS/Runtime/Value.h>
 
@@ -41,6 +47,7 @@ namespace JS {
 
 class VariableDeclaration;
 class FunctionDeclaration;
+class BlockStatement;
 
 template<class T, class... Args>
 static inline NonnullRefPtr<T>
@@ -49,12 +56,22 @@ create_ast_node(Args&&... args)
     return adopt(*new T(forward<Args>(args)...));
 }
 
-class ASTNode : public RefCounted<ASTNode> {
+// Gives anonymous functions the name of whatever they're being assigned to.
+void update_function_name(Value&, const FlyString& name);
+
+class ASTNode
+    : public RefCounted<ASTNode>
+    , public ArenaAllocated {
 public:
     virtual ~ASTNode() { }
     virtual const char* class_name() const = 0;
     virtual Value execute(Interpreter&, GlobalObject&) const = 0;
+    // Emits the code for this node and returns the register holding its value, if any.
+    // Nodes without bytecode of their own are evaluated by the AST interpreter instead.
+    virtual Optional<Bytecode::Register> generate_bytecode(Bytecode::Generator&) const;
     virtual void dump(int indent) const;
+    // Resolves the identifiers within this node to environment slots; see ScopeAnalysis.
+    virtual void analyze_scopes(ScopeAnalysis&) const { }
     virtual bool is_identifier() const { return false; }
     virtual bool is_spread_expression() const { return false; }
     virtual bool is_member_expression() const { return false; }
@@ -73,6 +90,8 @@ private:
 
 class Statement : public ASTNode {
 public:
+    virtual Optional<Bytecode::Register> generate_bytecode(Bytecode::Generator&) const override;
+
     const FlyString& label() const { return m_label; }
     void set_label(FlyString string) { m_label = string; }
 
@@ -83,6 +102,7 @@ protected:
 class EmptyStatement final : public Statement {
 public:
     Value execute(Interpreter&, GlobalObject&) const override { return js_undefined(); }
+    virtual Optional<Bytecode::Register> generate_bytecode(Bytecode::Generator&) const override;
     const char* class_name() const override { return "EmptyStatement"; }
 };
 
@@ -100,8 +120,10 @@ public:
     }
 
     Value execute(Interpreter&, GlobalObject&) const override;
+    virtual Optional<Bytecode::Register> generate_bytecode(Bytecode::Generator&) const override;
     const char* class_name() const override { return "ExpressionStatement"; }
     virtual void dump(int indent) const override;
+    virtual void analyze_scopes(ScopeAnalysis&) const override;
 
 private:
     NonnullRefPtr<Expression> m_expression;
@@ -123,7 +145,9 @@ public:
 
     const NonnullRefPtrVector<Statement>& children() const { return m_children; }
     virtual Value execute(Interpreter&, GlobalObject&) const override;
+    virtual Optional<Bytecode::Register> generate_bytecode(Bytecode::Generator&) const override;
     virtual void dump(int indent) const override;
+    virtual void analyze_scopes(ScopeAnalysis&) const override;
 
     void add_variables(NonnullRefPtrVector<VariableDeclaration>);
     void add_functions(NonnullRefPtrVector<FunctionDeclaration>);
@@ -132,14 +156,24 @@ public:
     bool in_strict_mode() const { return m_strict_mode; }
     void set_strict_mode() { m_strict_mode = true; }
 
+    // The bytecode for running this as a program or function body, generated on first use.
+    const Bytecode::Block& bytecode() const;
+
+    // The bindings of the environment created when entering this scope as a block.
+    EnvironmentLayout& environment_layout() const;
+
+    virtual ~ScopeNode() override;
+
 protected:
-    ScopeNode() { }
+    ScopeNode();
 
 private:
     virtual bool is_scope_node() const final { return true; }
     NonnullRefPtrVector<Statement> m_children;
     NonnullRefPtrVector<VariableDeclaration> m_variables;
     NonnullRefPtrVector<FunctionDeclaration> m_functions;
+    mutable OwnPtr<Bytecode::Block> m_bytecode;
+    mutable RefPtr<EnvironmentLayout> m_environment_layout;
     bool m_strict_mode { false };
 };
 
@@ -168,6 +202,45 @@ public:
 class Declaration : public Statement {
 };
 
+// The body of a function that the parser only skimmed over, see Parser::set_parse_function_bodies_lazily().
+// It is parsed the first time any function object created from it is called, and shared by all of them.
+class LazyFunctionBody : public RefCounted<LazyFunctionBody> {
+public:
+    struct SourcePosition {
+        size_t offset { 0 };
+        size_t line_number { 0 };
+        size_t line_column { 0 };
+    };
+
+    LazyFunctionBody(String source, SourcePosition, bool is_arrow_function, bool strict_mode, bool allow_super_property_lookup, bool allow_super_constructor_call);
+    ~LazyFunctionBody();
+
+    // Parses the body unless that has already happened. Returns false if it has a syntax error.
+    bool parse();
+
+    const BlockStatement* body() const { return m_body; }
+    const String& syntax_error() const { return m_syntax_error; }
+
+    // Starts out with the parameters of the function; the variables of the body are added once it's parsed.
+    EnvironmentLayout& environment_layout() { return m_environment_layout; }
+
+    // The environments around the function, recorded by the scope analysis of the code containing it.
+    void set_scope_analysis_context(NonnullRefPtr<ScopeAnalysisContext>);
+
+private:
+    String m_source;
+    SourcePosition m_position;
+    bool m_is_arrow_function { false };
+    bool m_strict_mode { false };
+    bool m_allow_super_property_lookup { false };
+    bool m_allow_super_constructor_call { false };
+
+    NonnullRefPtr<EnvironmentLayout> m_environment_layout;
+    RefPtr<ScopeAnalysisContext> m_scope_analysis_context;
+    RefPtr<BlockStatement> m_body;
+    String m_syntax_error;
+};
+
 class FunctionNode {
 public:
     struct Parameter {
@@ -177,10 +250,18 @@ public:
     };
 
     const FlyString& name() const { return m_name; }
-    const Statement& body() const { return *m_body; }
+    // Only available once the body has been parsed, see LazyFunctionBody.
+    const Statement& body() const;
     const Vector<Parameter>& parameters() const { return m_parameters; };
     i32 function_length() const { return m_function_length; }
 
+    // Non-null if the body is parsed on the first call, in which case body() is only valid afterwards.
+    LazyFunctionBody* lazy_body() const { return m_lazy_body.ptr(); }
+    const Statement* parsed_body() const;
+
+    // The bindings of the environment created for each call: the parameters, then the variables of the body.
+    EnvironmentLayout& environment_layout() const;
+
 protected:
     FunctionNode(const FlyString& name, NonnullRefPtr<Statement> body, Vector<Parameter> parameters, i32 function_length, NonnullRefPtrVector<VariableDeclaration> variables)
         : m_name(name)
@@ -191,15 +272,21 @@ protected:
     {
     }
 
+    FunctionNode(const FlyString& name, NonnullRefPtr<LazyFunctionBody>, Vector<Parameter> parameters, i32 function_length);
+
     void dump(int indent, const char* class_name) const;
+    void analyze_function_scopes(ScopeAnalysis&, bool parent_is_known) const;
 
     const NonnullRefPtrVector<VariableDeclaration>& variables() const { return m_variables; }
 
 private:
     FlyString m_name;
-    NonnullRefPtr<Statement> m_body;
+    RefPtr<Statement> m_body;
+    // Mutable since parsing it is just filling in what was there all along.
+    mutable RefPtr<LazyFunctionBody> m_lazy_body;
     const Vector<Parameter> m_parameters;
     NonnullRefPtrVector<VariableDeclaration> m_variables;
+    mutable RefPtr<EnvironmentLayout> m_environment_layout;
     const i32 m_function_length;
 };
 
@@ -214,8 +301,15 @@ public:
     {
     }
 
+    FunctionDeclaration(const FlyString& name, NonnullRefPtr<LazyFunctionBody> lazy_body, Vector<Parameter> parameters, i32 function_length)
+        : FunctionNode(name, move(lazy_body), move(parameters), function_length)
+    {
+    }
+
     virtual Value execute(Interpreter&, GlobalObject&) const override;
+    virtual Optional<Bytecode::Register> generate_bytecode(Bytecode::Generator&) const override;
     virtual void dump(int indent) const override;
+    virtual void analyze_scopes(ScopeAnalysis&) const override;
 
 private:
     virtual const char* class_name() const override { return "FunctionDeclaration"; }
@@ -233,8 +327,18 @@ public:
     {
     }
 
+    FunctionExpression(const FlyString& name, NonnullRefPtr<LazyFunctionBody> lazy_body, Vector<Parameter> parameters, i32 function_length, bool is_arrow_function = false)
+        : FunctionNode(name, move(lazy_body), move(parameters), function_length)
+        , m_is_arrow_function(is_arrow_function)
+    {
+    }
+
     virtual Value execute(Interpreter&, GlobalObject&) const override;
+    virtual Optional<Bytecode::Register> generate_bytecode(Bytecode::Generator&) const override;
     virtual void dump(int indent) const override;
+    virtual void analyze_scopes(ScopeAnalysis&) const override;
+
+    ScriptFunction* instantiate(Interpreter&, GlobalObject&) const;
 
 private:
     virtual const char* class_name() const override { return "FunctionExpression"; }
@@ -258,7 +362,9 @@ public:
     const Expression* argument() const { return m_argument; }
 
     virtual Value execute(Interpreter&, GlobalObject&) const override;
+    virtual Optional<Bytecode::Register> generate_bytecode(Bytecode::Generator&) const override;
     virtual void dump(int indent) const override;
+    virtual void analyze_scopes(ScopeAnalysis&) const override;
 
 private:
     virtual const char* class_name() const override { return "ReturnStatement"; }
@@ -280,7 +386,9 @@ public:
     const Statement* alternate() const { return m_alternate; }
 
     virtual Value execute(Interpreter&, GlobalObject&) const override;
+    virtual Optional<Bytecode::Register> generate_bytecode(Bytecode::Generator&) const override;
     virtual void dump(int indent) const override;
+    virtual void analyze_scopes(ScopeAnalysis&) const override;
 
 private:
     virtual const char* class_name() const override { return "IfStatement"; }
@@ -302,7 +410,9 @@ public:
     const Statement& body() const { return *m_body; }
 
     virtual Value execute(Interpreter&, GlobalObject&) const override;
+    virtual Optional<Bytecode::Register> generate_bytecode(Bytecode::Generator&) const override;
     virtual void dump(int indent) const override;
+    virtual void analyze_scopes(ScopeAnalysis&) const override;
 
 private:
     virtual const char* class_name() const override { return "WhileStatement"; }
@@ -323,7 +433,9 @@ public:
     const Statement& body() const { return *m_body; }
 
     virtual Value execute(Interpreter&, GlobalObject&) const override;
+    virtual Optional<Bytecode::Register> generate_bytecode(Bytecode::Generator&) const override;
     virtual void dump(int indent) const override;
+    virtual void analyze_scopes(ScopeAnalysis&) const override;
 
 private:
     virtual const char* class_name() const override { return "DoWhileStatement"; }
@@ -348,7 +460,9 @@ public:
     const Statement& body() const { return *m_body; }
 
     virtual Value execute(Interpreter&, GlobalObject&) const override;
+    virtual Optional<Bytecode::Register> generate_bytecode(Bytecode::Generator&) const override;
     virtual void dump(int indent) const override;
+    virtual void analyze_scopes(ScopeAnalysis&) const override;
 
 private:
     virtual const char* class_name() const override { return "ForStatement"; }
@@ -374,6 +488,7 @@ public:
 
     virtual Value execute(Interpreter&, GlobalObject&) const override;
     virtual void dump(int indent) const override;
+    virtual void analyze_scopes(ScopeAnalysis&) const override;
 
 private:
     virtual const char* class_name() const override { return "ForInStatement"; }
@@ -398,6 +513,7 @@ public:
 
     virtual Value execute(Interpreter&, GlobalObject&) const override;
     virtual void dump(int indent) const override;
+    virtual void analyze_scopes(ScopeAnalysis&) const override;
 
 private:
     virtual const char* class_name() const override { return "ForOfStatement"; }
@@ -442,7 +558,9 @@ public:
     }
 
     virtual Value execute(Interpreter&, GlobalObject&) const override;
+    virtual Optional<Bytecode::Register> generate_bytecode(Bytecode::Generator&) const override;
     virtual void dump(int indent) const override;
+    virtual void analyze_scopes(ScopeAnalysis&) const override;
 
 private:
     virtual const char* class_name() const override { return "BinaryExpression"; }
@@ -468,7 +586,9 @@ public:
     }
 
     virtual Value execute(Interpreter&, GlobalObject&) const override;
+    virtual Optional<Bytecode::Register> generate_bytecode(Bytecode::Generator&) const override;
     virtual void dump(int indent) const override;
+    virtual void analyze_scopes(ScopeAnalysis&) const override;
 
 private:
     virtual const char* class_name() const override { return "LogicalExpression"; }
@@ -497,7 +617,9 @@ public:
     }
 
     virtual Value execute(Interpreter&, GlobalObject&) const override;
+    virtual Optional<Bytecode::Register> generate_bytecode(Bytecode::Generator&) const override;
     virtual void dump(int indent) const override;
+    virtual void analyze_scopes(ScopeAnalysis&) const override;
 
 private:
     virtual const char* class_name() const override { return "UnaryExpression"; }
@@ -514,7 +636,9 @@ public:
     }
 
     virtual void dump(int indent) const override;
+    virtual void analyze_scopes(ScopeAnalysis&) const override;
     virtual Value execute(Interpreter&, GlobalObject&) const override;
+    virtual Optional<Bytecode::Register> generate_bytecode(Bytecode::Generator&) const override;
 
 private:
     virtual const char* class_name() const override { return "SequenceExpression"; }
@@ -535,6 +659,7 @@ public:
     }
 
     virtual Value execute(Interpreter&, GlobalObject&) const override;
+    virtual Optional<Bytecode::Register> generate_bytecode(Bytecode::Generator&) const override;
     virtual void dump(int indent) const override;
 
 private:
@@ -551,6 +676,7 @@ public:
     }
 
     virtual Value execute(Interpreter&, GlobalObject&) const override;
+    virtual Optional<Bytecode::Register> generate_bytecode(Bytecode::Generator&) const override;
     virtual void dump(int indent) const override;
 
 private:
@@ -585,6 +711,7 @@ public:
     StringView value() const { return m_value; }
 
     virtual Value execute(Interpreter&, GlobalObject&) const override;
+    virtual Optional<Bytecode::Register> generate_bytecode(Bytecode::Generator&) const override;
     virtual void dump(int indent) const override;
 
 private:
@@ -598,6 +725,7 @@ public:
     explicit NullLiteral() { }
 
     virtual Value execute(Interpreter&, GlobalObject&) const override;
+    virtual Optional<Bytecode::Register> generate_bytecode(Bytecode::Generator&) const override;
     virtual void dump(int indent) const override;
 
 private:
@@ -634,15 +762,23 @@ public:
 
     const FlyString& string() const { return m_string; }
 
+    // Set by the scope analysis if this names a binding with a fixed slot in an enclosing environment.
+    const Optional<EnvironmentCoordinate>& environment_coordinate() const { return m_environment_coordinate; }
+
     virtual Value execute(Interpreter&, GlobalObject&) const override;
+    virtual Optional<Bytecode::Register> generate_bytecode(Bytecode::Generator&) const override;
     virtual void dump(int indent) const override;
+    virtual void analyze_scopes(ScopeAnalysis&) const override;
     virtual bool is_identifier() const override { return true; }
     virtual Reference to_reference(Interpreter&, GlobalObject&) const override;
 
 private:
+    friend class ScopeAnalysis;
+
     virtual const char* class_name() const override { return "Identifier"; }
 
     FlyString m_string;
+    mutable Optional<EnvironmentCoordinate> m_environment_coordinate;
 };
 
 class ClassMethod final : public ASTNode {
@@ -667,6 +803,7 @@ public:
 
     virtual Value execute(Interpreter&, GlobalObject&) const override;
     virtual void dump(int indent) const override;
+    virtual void analyze_scopes(ScopeAnalysis&) const override;
 
 private:
     virtual const char* class_name() const override { return "ClassMethod"; }
@@ -701,6 +838,7 @@ public:
 
     virtual Value execute(Interpreter&, GlobalObject&) const override;
     virtual void dump(int indent) const override;
+    virtual void analyze_scopes(ScopeAnalysis&) const override;
 
 private:
     virtual const char* class_name() const override { return "ClassExpression"; }
@@ -720,6 +858,7 @@ public:
 
     virtual Value execute(Interpreter&, GlobalObject&) const override;
     virtual void dump(int indent) const override;
+    virtual void analyze_scopes(ScopeAnalysis&) const override;
 
 private:
     virtual const char* class_name() const override { return "ClassDeclaration"; }
@@ -735,6 +874,7 @@ public:
 
     virtual Value execute(Interpreter&, GlobalObject&) const override;
     virtual void dump(int indent) const override;
+    virtual void analyze_scopes(ScopeAnalysis&) const override;
     virtual bool is_spread_expression() const override { return true; }
 
 private:
@@ -746,6 +886,7 @@ private:
 class ThisExpression final : public Expression {
 public:
     virtual Value execute(Interpreter&, GlobalObject&) const override;
+    virtual Optional<Bytecode::Register> generate_bytecode(Bytecode::Generator&) const override;
     virtual void dump(int indent) const override;
 
 private:
@@ -766,7 +907,11 @@ public:
     }
 
     virtual Value execute(Interpreter&, GlobalObject&) const override;
+    virtual Optional<Bytecode::Register> generate_bytecode(Bytecode::Generator&) const override;
     virtual void dump(int indent) const override;
+    virtual void analyze_scopes(ScopeAnalysis&) const override;
+
+    Value throw_type_error_for_callee(Interpreter&, Value callee, const char* call_type) const;
 
 private:
     virtual const char* class_name() const override { return "CallExpression"; }
@@ -821,7 +966,9 @@ public:
     }
 
     virtual Value execute(Interpreter&, GlobalObject&) const override;
+    virtual Optional<Bytecode::Register> generate_bytecode(Bytecode::Generator&) const override;
     virtual void dump(int indent) const override;
+    virtual void analyze_scopes(ScopeAnalysis&) const override;
 
 private:
     virtual const char* class_name() const override { return "AssignmentExpression"; }
@@ -846,7 +993,9 @@ public:
     }
 
     virtual Value execute(Interpreter&, GlobalObject&) const override;
+    virtual Optional<Bytecode::Register> generate_bytecode(Bytecode::Generator&) const override;
     virtual void dump(int indent) const override;
+    virtual void analyze_scopes(ScopeAnalysis&) const override;
 
 private:
     virtual const char* class_name() const override { return "UpdateExpression"; }
@@ -900,7 +1049,9 @@ public:
     DeclarationKind declaration_kind() const { return m_declaration_kind; }
 
     virtual Value execute(Interpreter&, GlobalObject&) const override;
+    virtual Optional<Bytecode::Register> generate_bytecode(Bytecode::Generator&) const override;
     virtual void dump(int indent) const override;
+    virtual void analyze_scopes(ScopeAnalysis&) const override;
 
     const NonnullRefPtrVector<VariableDeclarator>& declarations() const { return m_declarations; }
 
@@ -939,6 +1090,7 @@ public:
     bool is_method() const { return m_is_method; }
 
     virtual void dump(int indent) const override;
+    virtual void analyze_scopes(ScopeAnalysis&) const override;
     virtual Value execute(Interpreter&, GlobalObject&) const override;
 
 private:
@@ -959,6 +1111,7 @@ public:
 
     virtual Value execute(Interpreter&, GlobalObject&) const override;
     virtual void dump(int indent) const override;
+    virtual void analyze_scopes(ScopeAnalysis&) const override;
 
 private:
     virtual const char* class_name() const override { return "ObjectExpression"; }
@@ -976,7 +1129,9 @@ public:
     const Vector<RefPtr<Expression>>& elements() const { return m_elements; }
 
     virtual Value execute(Interpreter&, GlobalObject&) const override;
+    virtual Optional<Bytecode::Register> generate_bytecode(Bytecode::Generator&) const override;
     virtual void dump(int indent) const override;
+    virtual void analyze_scopes(ScopeAnalysis&) const override;
 
 private:
     virtual const char* class_name() const override { return "ArrayExpression"; }
@@ -999,6 +1154,7 @@ public:
 
     virtual Value execute(Interpreter&, GlobalObject&) const override;
     virtual void dump(int indent) const override;
+    virtual void analyze_scopes(ScopeAnalysis&) const override;
 
     const NonnullRefPtrVector<Expression>& expressions() const { return m_expressions; }
     const NonnullRefPtrVector<Expression>& raw_strings() const { return m_raw_strings; }
@@ -1020,6 +1176,7 @@ public:
 
     virtual Value execute(Interpreter&, GlobalObject&) const override;
     virtual void dump(int indent) const override;
+    virtual void analyze_scopes(ScopeAnalysis&) const override;
 
 private:
     virtual const char* class_name() const override { return "TaggedTemplateLiteral"; }
@@ -1038,7 +1195,9 @@ public:
     }
 
     virtual Value execute(Interpreter&, GlobalObject&) const override;
+    virtual Optional<Bytecode::Register> generate_bytecode(Bytecode::Generator&) const override;
     virtual void dump(int indent) const override;
+    virtual void analyze_scopes(ScopeAnalysis&) const override;
     virtual Reference to_reference(Interpreter&, GlobalObject&) const override;
 
     bool is_computed() const { return m_computed; }
@@ -1047,6 +1206,9 @@ public:
 
     PropertyName computed_property_name(Interpreter&, GlobalObject&) const;
 
+    // Gets the property from the given object (the already evaluated object expression).
+    Value get_from(Interpreter&, GlobalObject&, const Object&) const;
+
     String to_string_approximation() const;
 
 private:
@@ -1056,6 +1218,9 @@ private:
     NonnullRefPtr<Expression> m_object;
     NonnullRefPtr<Expression> m_property;
     bool m_computed { false };
+    // Used for non-computed properties only, one for plain loads and one for references (i.e. stores).
+    PropertyLookupCache m_load_cache;
+    PropertyLookupCache m_reference_cache;
 };
 
 class ConditionalExpression final : public Expression {
@@ -1068,7 +1233,9 @@ public:
     }
 
     virtual void dump(int indent) const override;
+    virtual void analyze_scopes(ScopeAnalysis&) const override;
     virtual Value execute(Interpreter&, GlobalObject&) const override;
+    virtual Optional<Bytecode::Register> generate_bytecode(Bytecode::Generator&) const override;
 
 private:
     virtual const char* class_name() const override { return "ConditionalExpression"; }
@@ -1113,6 +1280,7 @@ public:
     const BlockStatement* finalizer() const { return m_finalizer; }
 
     virtual void dump(int indent) const override;
+    virtual void analyze_scopes(ScopeAnalysis&) const override;
     virtual Value execute(Interpreter&, GlobalObject&) const override;
 
 private:
@@ -1133,6 +1301,7 @@ public:
     const Expression& argument() const { return m_argument; }
 
     virtual void dump(int indent) const override;
+    virtual void analyze_scopes(ScopeAnalysis&) const override;
     virtual Value execute(Interpreter&, GlobalObject&) const override;
 
 private:
@@ -1153,6 +1322,7 @@ public:
     const NonnullRefPtrVector<Statement>& consequent() const { return m_consequent; }
 
     virtual void dump(int indent) const override;
+    virtual void analyze_scopes(ScopeAnalysis&) const override;
     virtual Value execute(Interpreter&, GlobalObject&) const override;
 
 private:
@@ -1171,6 +1341,7 @@ public:
     }
 
     virtual void dump(int indent) const override;
+    virtual void analyze_scopes(ScopeAnalysis&) const override;
     virtual Value execute(Interpreter&, GlobalObject&) const override;
 
 private:
@@ -1188,6 +1359,7 @@ public:
     }
 
     virtual Value execute(Interpreter&, GlobalObject&) const override;
+    virtual Optional<Bytecode::Register> generate_bytecode(Bytecode::Generator&) const override;
 
     const FlyString& target_label() const { return m_target_label; }
 
@@ -1205,6 +1377,7 @@ public:
     }
 
     virtual Value execute(Interpreter&, GlobalObject&) const override;
+    virtual Optional<Bytecode::Register> generate_bytecode(Bytecode::Generator&) const override;
 
     const FlyString& target_label() const { return m_target_label; }
 
@@ -1219,6 +1392,7 @@ public:
     DebuggerStatement() { }
 
     virtual Value execute(Interpreter&, GlobalObject&) const override;
+    virtual Optional<Bytecode::Register> generate_bytecode(Bytecode::Generator&) const override;
 
 private:
     virtual const char* class_name() const override { return "DebuggerStatement"; }
@@ -0,0 +1,644 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <LibJS/AST.h>
+#include <LibJS/Bytecode/Generator.h>
+#include <LibJS/Bytecode/Op.h>
+
+namespace JS {
+
+using Bytecode::Register;
+
+const Bytecode::Block& ScopeNode::bytecode() const
+{
+    if (!m_bytecode)
+        m_bytecode = Bytecode::Generator::generate(*this);
+    return *m_bytecode;
+}
+
+Optional<Register> ASTNode::generate_bytecode(Bytecode::Generator& generator) const
+{
+    // Only expressions get here, statements have their own fallback below.
+    auto dst = generator.allocate_register();
+    generator.emit<Bytecode::Op::EvaluateExpression>(dst, static_cast<const Expression&>(*this));
+    return dst;
+}
+
+Optional<Register> Statement::generate_bytecode(Bytecode::Generator& generator) const
+{
+    generator.emit_evaluate_statement(*this);
+    return {};
+}
+
+Optional<Register> EmptyStatement::generate_bytecode(Bytecode::Generator&) const
+{
+    return {};
+}
+
+Optional<Register> ExpressionStatement::generate_bytecode(Bytecode::Generator& generator) const
+{
+    return m_expression->generate_bytecode(generator);
+}
+
+Optional<Register> ScopeNode::generate_bytecode(Bytecode::Generator& generator) const
+{
+    generator.begin_scope(*this);
+    for (auto& child : children())
+        generator.emit_statement_for_effect(child);
+    generator.end_scope(*this);
+    return {};
+}
+
+Optional<Register> FunctionDeclaration::generate_bytecode(Bytecode::Generator&) const
+{
+    // Function declarations are hoisted when entering the scope they're in.
+    return {};
+}
+
+Optional<Register> FunctionExpression::generate_bytecode(Bytecode::Generator& generator) const
+{
+    auto dst = generator.allocate_register();
+    generator.emit<Bytecode::Op::NewFunction>(dst, *this);
+    return dst;
+}
+
+Optional<Register> ReturnStatement::generate_bytecode(Bytecode::Generator& generator) const
+{
+    Optional<Register> value;
+    if (m_argument)
+        value = m_argument->generate_bytecode(generator);
+    generator.emit<Bytecode::Op::Return>(value);
+    return {};
+}
+
+Optional<Register> IfStatement::generate_bytecode(Bytecode::Generator& generator) const
+{
+    auto predicate = m_predicate->generate_bytecode(generator);
+    auto else_label = generator.make_label();
+    generator.emit<Bytecode::Op::JumpIfFalse>(predicate.value(), else_label);
+    generator.emit_statement_for_effect(*m_consequent);
+    if (m_alternate) {
+        auto end_label = generator.make_label();
+        generator.emit<Bytecode::Op::Jump>(end_label);
+        generator.link_label(else_label);
+        generator.emit_statement_for_effect(*m_alternate);
+        generator.link_label(end_label);
+    } else {
+        generator.link_label(else_label);
+    }
+    return {};
+}
+
+Optional<Register> WhileStatement::generate_bytecode(Bytecode::Generator& generator) const
+{
+    auto test_label = generator.make_label();
+    auto end_label = generator.make_label();
+
+    generator.link_label(test_label);
+    auto test_result = m_test->generate_bytecode(generator);
+    generator.emit<Bytecode::Op::JumpIfFalse>(test_result.value(), end_label);
+
+    generator.begin_loop(end_label, test_label);
+    generator.emit_statement_for_effect(*m_body);
+    generator.end_loop();
+
+    generator.emit<Bytecode::Op::Jump>(test_label);
+    generator.link_label(end_label);
+    return {};
+}
+
+Optional<Register> DoWhileStatement::generate_bytecode(Bytecode::Generator& generator) const
+{
+    auto body_label = generator.make_label();
+    auto test_label = generator.make_label();
+    auto end_label = generator.make_label();
+
+    generator.link_label(body_label);
+    generator.begin_loop(end_label, test_label);
+    generator.emit_statement_for_effect(*m_body);
+    generator.end_loop();
+
+    generator.link_label(test_label);
+    auto test_result = m_test->generate_bytecode(generator);
+    generator.emit<Bytecode::Op::JumpIfTrue>(test_result.value(), body_label);
+    generator.link_label(end_label);
+    return {};
+}
+
+Optional<Register> ForStatement::generate_bytecode(Bytecode::Generator& generator) const
+{
+    // let and const declarations in the header get a scope of their own, like in execute().
+    RefPtr<BlockStatement> wrapper;
+    if (m_init && m_init->is_variable_declaration() && static_cast<const VariableDeclaration*>(m_init.ptr())->declaration_kind() != DeclarationKind::Var) {
+        wrapper = create_ast_node<BlockStatement>();
+        NonnullRefPtrVector<VariableDeclaration> decls;
+        decls.append(*static_cast<const VariableDeclaration*>(m_init.ptr()));
+        wrapper->add_variables(decls);
+        generator.block().retain_node(*wrapper);
+        generator.begin_scope(*wrapper);
+    }
+
+    if (m_init)
+        (void)m_init->generate_bytecode(generator);
+
+    auto test_label = generator.make_label();
+    auto update_label = generator.make_label();
+    auto end_label = generator.make_label();
+
+    generator.link_label(test_label);
+    if (m_test) {
+        auto test_result = m_test->generate_bytecode(generator);
+        generator.emit<Bytecode::Op::JumpIfFalse>(test_result.value(), end_label);
+    }
+
+    generator.begin_loop(end_label, update_label);
+    generator.emit_statement_for_effect(*m_body);
+    generator.end_loop();
+
+    generator.link_label(update_label);
+    if (m_update)
+        (void)m_update->generate_bytecode(generator);
+    generator.emit<Bytecode::Op::Jump>(test_label);
+    generator.link_label(end_label);
+
+    if (wrapper)
+        generator.end_scope(*wrapper);
+    return {};
+}
+
+static void emit_binary_op(Bytecode::Generator& generator, BinaryOp op, Register dst, Register lhs, Register rhs)
+{
+    switch (op) {
+    case BinaryOp::Addition:
+        generator.emit<Bytecode::Op::Add>(dst, lhs, rhs);
+        return;
+    case BinaryOp::Subtraction:
+        generator.emit<Bytecode::Op::Sub>(dst, lhs, rhs);
+        return;
+    case BinaryOp::Multiplication:
+        generator.emit<Bytecode::Op::Mul>(dst, lhs, rhs);
+        return;
+    case BinaryOp::Division:
+        generator.emit<Bytecode::Op::Div>(dst, lhs, rhs);
+        return;
+    case BinaryOp::Modulo:
+        generator.emit<Bytecode::Op::Mod>(dst, lhs, rhs);
+        return;
+    case BinaryOp::Exponentiation:
+        generator.emit<Bytecode::Op::Exp>(dst, lhs, rhs);
+        return;
+    case BinaryOp::TypedEquals:
+        generator.emit<Bytecode::Op::TypedEquals>(dst, lhs, rhs);
+        return;
+    case BinaryOp::TypedInequals:
+        generator.emit<Bytecode::Op::TypedInequals>(dst, lhs, rhs);
+        return;
+    case BinaryOp::AbstractEquals:
+        generator.emit<Bytecode::Op::AbstractEquals>(dst, lhs, rhs);
+        return;
+    case BinaryOp::AbstractInequals:
+        generator.emit<Bytecode::Op::AbstractInequals>(dst, lhs, rhs);
+        return;
+    case BinaryOp::GreaterThan:
+        generator.emit<Bytecode::Op::GreaterThan>(dst, lhs, rhs);
+        return;
+    case BinaryOp::GreaterThanEquals:
+        generator.emit<Bytecode::Op::GreaterThanEquals>(dst, lhs, rhs);
+        return;
+    case BinaryOp::LessThan:
+        generator.emit<Bytecode::Op::LessThan>(dst, lhs, rhs);
+        return;
+    case BinaryOp::LessThanEquals:
+        generator.emit<Bytecode::Op::LessThanEquals>(dst, lhs, rhs);
+        return;
+    case BinaryOp::BitwiseAnd:
+        generator.emit<Bytecode::Op::BitwiseAnd>(dst, lhs, rhs);
+        return;
+    case BinaryOp::BitwiseOr:
+        generator.emit<Bytecode::Op::BitwiseOr>(dst, lhs, rhs);
+        return;
+    case BinaryOp::BitwiseXor:
+        generator.emit<Bytecode::Op::BitwiseXor>(dst, lhs, rhs);
+        return;
+    case BinaryOp::LeftShift:
+        generator.emit<Bytecode::Op::LeftShift>(dst, lhs, rhs);
+        return;
+    case BinaryOp::RightShift:
+        generator.emit<Bytecode::Op::RightShift>(dst, lhs, rhs);
+        return;
+    case BinaryOp::UnsignedRightShift:
+        generator.emit<Bytecode::Op::UnsignedRightShift>(dst, lhs, rhs);
+        return;
+    case BinaryOp::In:
+        generator.emit<Bytecode::Op::In>(dst, lhs, rhs);
+        return;
+    case BinaryOp::InstanceOf:
+        generator.emit<Bytecode::Op::InstanceOf>(dst, lhs, rhs);
+        return;
+    }
+    ASSERT_NOT_REACHED();
+}
+
+Optional<Register> BinaryExpression::generate_bytecode(Bytecode::Generator& generator) const
+{
+    auto lhs = m_lhs->generate_bytecode(generator);
+    auto rhs = m_rhs->generate_bytecode(generator);
+    auto dst = generator.allocate_register();
+    emit_binary_op(generator, m_op, dst, lhs.value(), rhs.value());
+    return dst;
+}
+
+Optional<Register> LogicalExpression::generate_bytecode(Bytecode::Generator& generator) const
+{
+    auto dst = generator.allocate_register();
+    auto lhs = m_lhs->generate_bytecode(generator);
+    generator.emit<Bytecode::Op::Move>(dst, lhs.value());
+
+    auto end_label = generator.make_label();
+    switch (m_op) {
+    case LogicalOp::And:
+        generator.emit<Bytecode::Op::JumpIfFalse>(dst, end_label);
+        break;
+    case LogicalOp::Or:
+        generator.emit<Bytecode::Op::JumpIfTrue>(dst, end_label);
+        break;
+    case LogicalOp::NullishCoalescing:
+        generator.emit<Bytecode::Op::JumpIfNotNullish>(dst, end_label);
+        break;
+    }
+
+    auto rhs = m_rhs->generate_bytecode(generator);
+    generator.emit<Bytecode::Op::Move>(dst, rhs.value());
+    generator.link_label(end_label);
+    return dst;
+}
+
+Optional<Register> UnaryExpression::generate_bytecode(Bytecode::Generator& generator) const
+{
+    if (m_op == UnaryOp::Delete)
+        return ASTNode::generate_bytecode(generator);
+
+    auto dst = generator.allocate_register();
+
+    if (m_op == UnaryOp::Typeof && m_lhs->is_identifier()) {
+        generator.emit<Bytecode::Op::TypeofVariable>(dst, static_cast<const Identifier&>(*m_lhs));
+        return dst;
+    }
+
+    auto src = m_lhs->generate_bytecode(generator).value();
+    switch (m_op) {
+    case UnaryOp::BitwiseNot:
+        generator.emit<Bytecode::Op::BitwiseNot>(dst, src);
+        break;
+    case UnaryOp::Not:
+        generator.emit<Bytecode::Op::Not>(dst, src);
+        break;
+    case UnaryOp::Plus:
+        generator.emit<Bytecode::Op::UnaryPlus>(dst, src);
+        break;
+    case UnaryOp::Minus:
+        generator.emit<Bytecode::Op::UnaryMinus>(dst, src);
+        break;
+    case UnaryOp::Typeof:
+        generator.emit<Bytecode::Op::Typeof>(dst, src);
+        break;
+    case UnaryOp::Void:
+        generator.emit<Bytecode::Op::Load>(dst, js_undefined());
+        break;
+    case UnaryOp::Delete:
+        ASSERT_NOT_REACHED();
+    }
+    return dst;
+}
+
+Optional<Register> SequenceExpression::generate_bytecode(Bytecode::Generator& generator) const
+{
+    Optional<Register> last_value;
+    for (auto& expression : m_expressions)
+        last_value = expression.generate_bytecode(generator);
+    return last_value;
+}
+
+Optional<Register> BooleanLiteral::generate_bytecode(Bytecode::Generator& generator) const
+{
+    auto dst = generator.allocate_register();
+    generator.emit<Bytecode::Op::Load>(dst, Value(m_value));
+    return dst;
+}
+
+Optional<Register> NumericLiteral::generate_bytecode(Bytecode::Generator& generator) const
+{
+    auto dst = generator.allocate_register();
+    generator.emit<Bytecode::Op::Load>(dst, Value(m_value));
+    return dst;
+}
+
+Optional<Register> StringLiteral::generate_bytecode(Bytecode::Generator& generator) const
+{
+    auto dst = generator.allocate_register();
+    generator.emit<Bytecode::Op::NewString>(dst, m_value);
+    return dst;
+}
+
+Optional<Register> NullLiteral::generate_bytecode(Bytecode::Generator& generator) const
+{
+    auto dst = generator.allocate_register();
+    generator.emit<Bytecode::Op::Load>(dst, js_null());
+    return dst;
+}
+
+Optional<Register> Identifier::generate_bytecode(Bytecode::Generator& generator) const
+{
+    auto dst = generator.allocate_register();
+    generator.emit<Bytecode::Op::GetVariable>(dst, *this);
+    return dst;
+}
+
+Optional<Register> ThisExpression::generate_bytecode(Bytecode::Generator& generator) const
+{
+    auto dst = generator.allocate_register();
+    generator.emit<Bytecode::Op::ResolveThis>(dst);
+    return dst;
+}
+
+Optional<Register> CallExpression::generate_bytecode(Bytecode::Generator& generator) const
+{
+    if (m_callee->is_super_expression())
+        return ASTNode::generate_bytecode(generator);
+    for (auto& argument : m_arguments) {
+        if (argument.is_spread)
+            return ASTNode::generate_bytecode(generator);
+    }
+
+    Register callee { 0 };
+    Optional<Register> this_value;
+    if (!is_new_expression() && m_callee->is_member_expression()) {
+        auto& member_expression = static_cast<const MemberExpression&>(*m_callee);
+        if (member_expression.object().is_super_expression())
+            return ASTNode::generate_bytecode(generator);
+        auto object = member_expression.object().generate_bytecode(generator).value();
+        this_value = generator.allocate_register();
+        generator.emit<Bytecode::Op::ToObject>(this_value.value(), object);
+        callee = generator.allocate_register();
+        if (member_expression.is_computed()) {
+            auto property = member_expression.property().generate_bytecode(generator).value();
+            generator.emit<Bytecode::Op::GetByValue>(callee, this_value.value(), property);
+        } else {
+            generator.emit<Bytecode::Op::GetById>(callee, this_value.value(), static_cast<const Identifier&>(member_expression.property()).string());
+        }
+    } else {
+        callee = m_callee->generate_bytecode(generator).value();
+    }
+
+    Vector<Register> arguments;
+    arguments.ensure_capacity(m_arguments.size());
+    for (auto& argument : m_arguments)
+        arguments.append(argument.value->generate_bytecode(generator).value());
+
+    auto dst = generator.allocate_register();
+    if (is_new_expression())
+        generator.emit_with_extra_register_slots<Bytecode::Op::New>(arguments.size(), dst, callee, *this, arguments);
+    else
+        generator.emit_with_extra_register_slots<Bytecode::Op::Call>(arguments.size(), dst, callee, this_value, *this, arguments);
+    return dst;
+}
+
+static Optional<BinaryOp> binary_op_for_assignment(AssignmentOp op)
+{
+    switch (op) {
+    case AssignmentOp::Assignment:
+        return {};
+    case AssignmentOp::AdditionAssignment:
+        return BinaryOp::Addition;
+    case AssignmentOp::SubtractionAssignment:
+        return BinaryOp::Subtraction;
+    case AssignmentOp::MultiplicationAssignment:
+        return BinaryOp::Multiplication;
+    case AssignmentOp::DivisionAssignment:
+        return BinaryOp::Division;
+    case AssignmentOp::ModuloAssignment:
+        return BinaryOp::Modulo;
+    case AssignmentOp::ExponentiationAssignment:
+        return BinaryOp::Exponentiation;
+    case AssignmentOp::BitwiseAndAssignment:
+        return BinaryOp::BitwiseAnd;
+    case AssignmentOp::BitwiseOrAssignment:
+        return BinaryOp::BitwiseOr;
+    case AssignmentOp::BitwiseXorAssignment:
+        return BinaryOp::BitwiseXor;
+    case AssignmentOp::LeftShiftAssignment:
+        return BinaryOp::LeftShift;
+    case AssignmentOp::RightShiftAssignment:
+        return BinaryOp::RightShift;
+    case AssignmentOp::UnsignedRightShiftAssignment:
+        return BinaryOp::UnsignedRightShift;
+    }
+    ASSERT_NOT_REACHED();
+}
+
+Optional<Register> AssignmentExpression::generate_bytecode(Bytecode::Generator& generator) const
+{
+    const MemberExpression* member_expression = nullptr;
+    if (m_lhs->is_member_expression()) {
+        member_expression = static_cast<const MemberExpression*>(m_lhs.ptr());
+        if (member_expression->object().is_super_expression())
+            return ASTNode::generate_bytecode(generator);
+    } else if (!m_lhs->is_identifier()) {
+        return ASTNode::generate_bytecode(generator);
+    }
+
+    // Like execute(), this evaluates the right hand side first.
+    auto value = m_rhs->generate_bytecode(generator).value();
+    auto binary_op = binary_op_for_assignment(m_op);
+
+    if (!member_expression) {
+        auto& identifier = static_cast<const Identifier&>(*m_lhs);
+        if (binary_op.has_value()) {
+            auto current_value = generator.allocate_register();
+            generator.emit<Bytecode::Op::GetVariable>(current_value, identifier);
+            auto result = generator.allocate_register();
+            emit_binary_op(generator, binary_op.value(), result, current_value, value);
+            value = result;
+        }
+        generator.emit<Bytecode::Op::SetVariable>(identifier, value);
+        return value;
+    }
+
+    auto object = member_expression->object().generate_bytecode(generator).value();
+    Optional<Register> property;
+    FlyString property_name;
+    if (member_expression->is_computed())
+        property = member_expression->property().generate_bytecode(generator);
+    else
+        property_name = static_cast<const Identifier&>(member_expression->property()).string();
+
+    if (binary_op.has_value()) {
+        auto current_value = generator.allocate_register();
+        if (property.has_value())
+            generator.emit<Bytecode::Op::GetByValue>(current_value, object, property.value());
+        else
+            generator.emit<Bytecode::Op::GetById>(current_value, object, property_name);
+        auto result = generator.allocate_register();
+        emit_binary_op(generator, binary_op.value(), result, current_value, value);
+        value = result;
+    }
+
+    if (property.has_value())
+        generator.emit<Bytecode::Op::PutByValue>(object, property.value(), value);
+    else
+        generator.emit<Bytecode::Op::PutById>(object, property_name, value);
+    return value;
+}
+
+Optional<Register> UpdateExpression::generate_bytecode(Bytecode::Generator& generator) const
+{
+    const MemberExpression* member_expression = nullptr;
+    if (m_argument->is_member_expression()) {
+        member_expression = static_cast<const MemberExpression*>(m_argument.ptr());
+        if (member_expression->object().is_super_expression())
+            return ASTNode::generate_bytecode(generator);
+    } else if (!m_argument->is_identifier()) {
+        return ASTNode::generate_bytecode(generator);
+    }
+
+    Optional<Register> object;
+    Optional<Register> property;
+    auto old_value = generator.allocate_register();
+    if (member_expression) {
+        object = member_expression->object().generate_bytecode(generator);
+        if (member_expression->is_computed()) {
+            property = member_expression->property().generate_bytecode(generator);
+            generator.emit<Bytecode::Op::GetByValue>(old_value, object.value(), property.value());
+        } else {
+            generator.emit<Bytecode::Op::GetById>(old_value, object.value(), static_cast<const Identifier&>(member_expression->property()).string());
+        }
+    } else {
+        generator.emit<Bytecode::Op::GetVariable>(old_value, static_cast<const Identifier&>(*m_argument));
+    }
+    generator.emit<Bytecode::Op::ToNumeric>(old_value, old_value);
+
+    auto new_value = generator.allocate_register();
+    if (m_op == UpdateOp::Increment)
+        generator.emit<Bytecode::Op::Increment>(new_value, old_value);
+    else
+        generator.emit<Bytecode::Op::Decrement>(new_value, old_value);
+
+    if (property.has_value())
+        generator.emit<Bytecode::Op::PutByValue>(object.value(), property.value(), new_value);
+    else if (object.has_value())
+        generator.emit<Bytecode::Op::PutById>(object.value(), static_cast<const Identifier&>(member_expression->property()).string(), new_value);
+    else
+        generator.emit<Bytecode::Op::SetVariable>(static_cast<const Identifier&>(*m_argument), new_value);
+
+    return m_prefixed ? new_value : old_value;
+}
+
+Optional<Register> VariableDeclaration::generate_bytecode(Bytecode::Generator& generator) const
+{
+    for (auto& declarator : m_declarations) {
+        if (auto* init = declarator.init()) {
+            auto value = init->generate_bytecode(generator).value();
+            generator.emit<Bytecode::Op::InitializeVariable>(declarator.id(), value);
+        }
+    }
+    return {};
+}
+
+Optional<Register> MemberExpression::generate_bytecode(Bytecode::Generator& generator) const
+{
+    if (m_object->is_super_expression())
+        return ASTNode::generate_bytecode(generator);
+
+    auto object = m_object->generate_bytecode(generator).value();
+    auto dst = generator.allocate_register();
+    if (is_computed()) {
+        auto property = m_property->generate_bytecode(generator).value();
+        generator.emit<Bytecode::Op::GetByValue>(dst, object, property);
+    } else {
+        generator.emit<Bytecode::Op::GetById>(dst, object, static_cast<const Identifier&>(*m_property).string());
+    }
+    return dst;
+}
+
+Optional<Register> ConditionalExpression::generate_bytecode(Bytecode::Generator& generator) const
+{
+    auto dst = generator.allocate_register();
+    auto alternate_label = generator.make_label();
+    auto end_label = generator.make_label();
+
+    auto test_result = m_test->generate_bytecode(generator).value();
+    generator.emit<Bytecode::Op::JumpIfFalse>(test_result, alternate_label);
+    auto consequent = m_consequent->generate_bytecode(generator).value();
+    generator.emit<Bytecode::Op::Move>(dst, consequent);
+    generator.emit<Bytecode::Op::Jump>(end_label);
+
+    generator.link_label(alternate_label);
+    auto alternate = m_alternate->generate_bytecode(generator).value();
+    generator.emit<Bytecode::Op::Move>(dst, alternate);
+    generator.link_label(end_label);
+    return dst;
+}
+
+Optional<Register> ArrayExpression::generate_bytecode(Bytecode::Generator& generator) const
+{
+    // Holes and spread elements are left to the AST interpreter.
+    for (auto& element : m_elements) {
+        if (!element || element->is_spread_expression())
+            return ASTNode::generate_bytecode(generator);
+    }
+
+    Vector<Register> elements;
+    elements.ensure_capacity(m_elements.size());
+    for (auto& element : m_elements)
+        elements.append(element->generate_bytecode(generator).value());
+
+    auto dst = generator.allocate_register();
+    generator.emit_with_extra_register_slots<Bytecode::Op::NewArray>(elements.size(), dst, elements);
+    return dst;
+}
+
+Optional<Register> BreakStatement::generate_bytecode(Bytecode::Generator& generator) const
+{
+    if (!m_target_label.is_null() || !generator.is_in_loop())
+        return Statement::generate_bytecode(generator);
+    generator.emit_break();
+    return {};
+}
+
+Optional<Register> ContinueStatement::generate_bytecode(Bytecode::Generator& generator) const
+{
+    if (!m_target_label.is_null() || !generator.is_in_loop())
+        return Statement::generate_bytecode(generator);
+    generator.emit_continue();
+    return {};
+}
+
+Optional<Register> DebuggerStatement::generate_bytecode(Bytecode::Generator&) const
+{
+    return {};
+}
+
+}
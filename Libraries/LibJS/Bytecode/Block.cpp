@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <AK/LogStream.h>
+#include <LibJS/AST.h>
+#include <LibJS/Bytecode/Block.h>
+#include <LibJS/Bytecode/Op.h>
+#include <stdio.h>
+
+namespace JS::Bytecode {
+
+Block::~Block()
+{
+    for (size_t offset = 0; offset < m_buffer.size();) {
+        auto& instruction = *reinterpret_cast<Instruction*>(m_buffer.data() + offset);
+        offset += align_up(instruction.length());
+        Instruction::destroy(instruction);
+    }
+}
+
+void* Block::allocate_instruction(size_t size)
+{
+    size_t offset = m_buffer.size();
+    m_buffer.resize(offset + align_up(size));
+    return m_buffer.data() + offset;
+}
+
+Label Block::make_label()
+{
+    m_label_offsets.append(0);
+    return Label { m_label_offsets.size() - 1 };
+}
+
+void Block::specialize() const
+{
+    for_each_instruction([](size_t, auto& instruction) {
+        switch (instruction.type()) {
+#define __BYTECODE_NUMBER_BINARY_OP(op, number_op)            \
+    case Instruction::Type::op:                               \
+        instruction.rewrite_as(Instruction::Type::number_op); \
+        break;
+            JS_ENUMERATE_BYTECODE_NUMBER_BINARY_OPS(__BYTECODE_NUMBER_BINARY_OP)
+#undef __BYTECODE_NUMBER_BINARY_OP
+        default:
+            break;
+        }
+    });
+}
+
+void Block::dump() const
+{
+    printf("Bytecode (%zu registers, %zu bytes):\n", m_register_count, m_buffer.size());
+    for_each_instruction([&](size_t offset, auto& instruction) {
+        for (size_t i = 0; i < m_label_offsets.size(); ++i) {
+            if (m_label_offsets[i] == offset)
+                printf("@%zu:\n", i);
+        }
+        printf("[%4zu] %s\n", offset, instruction.to_string().characters());
+    });
+}
+
+}
@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/NonnullOwnPtr.h>
+#include <AK/NonnullRefPtrVector.h>
+#include <AK/Optional.h>
+#include <AK/Vector.h>
+#include <LibJS/Bytecode/Instruction.h>
+#include <LibJS/Bytecode/Label.h>
+#include <LibJS/Bytecode/Register.h>
+#include <LibJS/Forward.h>
+
+namespace JS::Bytecode {
+
+// The bytecode for one function body (or program).
+class Block {
+    AK_MAKE_NONCOPYABLE(Block);
+    AK_MAKE_NONMOVABLE(Block);
+
+public:
+    static constexpr size_t instruction_alignment = 8;
+
+    static NonnullOwnPtr<Block> create() { return adopt_own(*new Block); }
+    ~Block();
+
+    void* allocate_instruction(size_t size);
+
+    size_t size() const { return m_buffer.size(); }
+    const Instruction& instruction_at(size_t offset) const { return *reinterpret_cast<const Instruction*>(m_buffer.data() + offset); }
+
+    template<typename Callback>
+    void for_each_instruction(Callback callback) const
+    {
+        for (size_t offset = 0; offset < m_buffer.size();) {
+            auto& instruction = instruction_at(offset);
+            callback(offset, instruction);
+            offset += align_up(instruction.length());
+        }
+    }
+
+    static size_t align_up(size_t size) { return (size + instruction_alignment - 1) & ~(instruction_alignment - 1); }
+
+    Label make_label();
+    void link_label(Label label, size_t offset) { m_label_offsets[label.index()] = offset; }
+    size_t label_offset(Label label) const { return m_label_offsets[label.index()]; }
+
+    void set_register_count(size_t count) { m_register_count = count; }
+    size_t register_count() const { return m_register_count; }
+
+    // Where the value of the last expression statement ends up, for programs.
+    void set_completion_register(Register reg) { m_completion_register = reg; }
+    const Optional<Register>& completion_register() const { return m_completion_register; }
+
+    // Nodes that the bytecode refers to, but which aren't part of the AST.
+    void retain_node(NonnullRefPtr<ASTNode> node) { m_retained_nodes.append(move(node)); }
+
+    // Runs and loop iterations both count towards a block being hot. Once it is, its generic
+    // arithmetic and comparison instructions are swapped for ones that assume numbers.
+    static constexpr u32 specialization_threshold = 1000;
+    bool note_execution() const { return ++m_execution_count == specialization_threshold; }
+    void specialize() const;
+
+    void dump() const;
+
+private:
+    Block() { }
+
+    Vector<u8> m_buffer;
+    Vector<size_t> m_label_offsets;
+    size_t m_register_count { 0 };
+    Optional<Register> m_completion_register;
+    NonnullRefPtrVector<ASTNode> m_retained_nodes;
+    mutable u32 m_execution_count { 0 };
+};
+
+}
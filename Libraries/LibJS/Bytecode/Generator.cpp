@@ -0,0 +1,147 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <LibJS/AST.h>
+#include <LibJS/Bytecode/Generator.h>
+#include <LibJS/Bytecode/Op.h>
+
+namespace JS::Bytecode {
+
+Generator::Generator()
+    : m_block(Block::create())
+{
+}
+
+NonnullOwnPtr<Block> Generator::generate(const ScopeNode& node)
+{
+    Generator generator;
+
+    // The scope itself is entered (and left) by whoever runs it, see Interpreter::run().
+    if (node.is_program()) {
+        auto completion = generator.allocate_register();
+        generator.m_block->set_completion_register(completion);
+        for (auto& child : node.children()) {
+            auto result = generator.emit_statement(child);
+            if (result.has_value())
+                generator.emit<Op::Move>(completion, result.value());
+            else
+                generator.emit<Op::Load>(completion, js_undefined());
+        }
+    } else {
+        for (auto& child : node.children())
+            generator.emit_statement_for_effect(child);
+    }
+    generator.emit<Op::End>();
+
+    generator.m_block->set_register_count(generator.m_next_register);
+    return move(generator.m_block);
+}
+
+Register Generator::allocate_register()
+{
+    return Register { m_next_register++ };
+}
+
+Optional<Register> Generator::emit_statement(const Statement& statement)
+{
+    // Labels (and the labelled break and continue that go with them) are left to the AST interpreter.
+    if (!statement.label().is_null())
+        return statement.Statement::generate_bytecode(*this);
+    return statement.generate_bytecode(*this);
+}
+
+void Generator::begin_scope(const ScopeNode& scope_node)
+{
+    emit<Op::EnterScope>(scope_node);
+    m_scopes.append(&scope_node);
+}
+
+void Generator::end_scope(const ScopeNode& scope_node)
+{
+    ASSERT(!m_scopes.is_empty() && m_scopes.last() == &scope_node);
+    m_scopes.take_last();
+    emit<Op::ExitScope>(scope_node);
+}
+
+void Generator::begin_loop(Label break_target, Label continue_target)
+{
+    m_loops.append({ break_target, continue_target, m_scopes.size() });
+}
+
+void Generator::end_loop()
+{
+    m_loops.take_last();
+}
+
+const ScopeNode* Generator::outermost_scope_in_loop() const
+{
+    auto& loop = m_loops.last();
+    if (m_scopes.size() > loop.scope_depth)
+        return m_scopes[loop.scope_depth];
+    return nullptr;
+}
+
+void Generator::emit_break()
+{
+    if (auto* scope = outermost_scope_in_loop())
+        emit<Op::ExitScope>(*scope);
+    emit<Op::Jump>(m_loops.last().break_target);
+}
+
+void Generator::emit_continue()
+{
+    if (auto* scope = outermost_scope_in_loop())
+        emit<Op::ExitScope>(*scope);
+    emit<Op::Jump>(m_loops.last().continue_target);
+}
+
+void Generator::emit_evaluate_statement(const Statement& statement)
+{
+    if (!is_in_loop()) {
+        emit<Op::EvaluateStatement>(statement, Optional<Label> {}, Optional<Label> {});
+        return;
+    }
+
+    if (!outermost_scope_in_loop()) {
+        emit<Op::EvaluateStatement>(statement, m_loops.last().break_target, m_loops.last().continue_target);
+        return;
+    }
+
+    // The scopes we've entered since the start of the loop have to be left on the way out,
+    // so go through a couple of landing pads that do that.
+    auto break_landing_pad = make_label();
+    auto continue_landing_pad = make_label();
+    auto end = make_label();
+    emit<Op::EvaluateStatement>(statement, break_landing_pad, continue_landing_pad);
+    emit<Op::Jump>(end);
+    link_label(break_landing_pad);
+    emit_break();
+    link_label(continue_landing_pad);
+    emit_continue();
+    link_label(end);
+}
+
+}
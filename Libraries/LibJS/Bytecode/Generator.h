@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/NonnullOwnPtr.h>
+#include <AK/Optional.h>
+#include <AK/Vector.h>
+#include <LibJS/Bytecode/Block.h>
+#include <LibJS/Bytecode/Label.h>
+#include <LibJS/Bytecode/Register.h>
+#include <LibJS/Forward.h>
+
+namespace JS::Bytecode {
+
+// Walks the AST of a function body (or program) and emits the bytecode for it.
+class Generator {
+public:
+    static NonnullOwnPtr<Block> generate(const ScopeNode&);
+
+    Register allocate_register();
+
+    template<typename OpType, typename... Args>
+    void emit(Args&&... args)
+    {
+        void* slot = m_block->allocate_instruction(sizeof(OpType));
+        new (slot) OpType(forward<Args>(args)...);
+    }
+
+    // For instructions that store a list of registers after themselves.
+    template<typename OpType, typename... Args>
+    void emit_with_extra_register_slots(size_t extra_register_slots, Args&&... args)
+    {
+        void* slot = m_block->allocate_instruction(sizeof(OpType) + extra_register_slots * sizeof(Register));
+        new (slot) OpType(forward<Args>(args)...);
+    }
+
+    Label make_label() { return m_block->make_label(); }
+    void link_label(Label label) { m_block->link_label(label, m_block->size()); }
+
+    void begin_scope(const ScopeNode&);
+    void end_scope(const ScopeNode&);
+
+    void begin_loop(Label break_target, Label continue_target);
+    void end_loop();
+    bool is_in_loop() const { return !m_loops.is_empty(); }
+
+    void emit_break();
+    void emit_continue();
+
+    // Runs the statement in the AST interpreter, with a way back into the enclosing loop
+    // if it breaks or continues.
+    void emit_evaluate_statement(const Statement&);
+
+    // Like generate_bytecode(), but leaves labelled statements to the AST interpreter.
+    Optional<Register> emit_statement(const Statement&);
+    // For statements whose completion value isn't needed.
+    void emit_statement_for_effect(const Statement& statement) { (void)emit_statement(statement); }
+
+    Block& block() { return *m_block; }
+
+private:
+    Generator();
+
+    struct Loop {
+        Label break_target;
+        Label continue_target;
+        size_t scope_depth { 0 };
+    };
+
+    // The first scope that was entered inside the innermost loop, if any.
+    const ScopeNode* outermost_scope_in_loop() const;
+
+    NonnullOwnPtr<Block> m_block;
+    u32 m_next_register { 0 };
+    Vector<Loop> m_loops;
+    Vector<const ScopeNode*> m_scopes;
+};
+
+}
@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/Forward.h>
+#include <AK/Types.h>
+
+#define JS_ENUMERATE_BYTECODE_OPS(O) \
+    O(Load)                          \
+    O(Move)                          \
+    O(NewString)                     \
+    O(NewArray)                      \
+    O(NewFunction)                   \
+    O(GetVariable)                   \
+    O(SetVariable)                   \
+    O(InitializeVariable)            \
+    O(TypeofVariable)                \
+    O(GetById)                       \
+    O(GetByValue)                    \
+    O(PutById)                       \
+    O(PutByValue)                    \
+    O(ToObject)                      \
+    O(ToNumeric)                     \
+    O(ResolveThis)                   \
+    O(Add)                           \
+    O(Sub)                           \
+    O(Mul)                           \
+    O(Div)                           \
+    O(Mod)                           \
+    O(Exp)                           \
+    O(TypedEquals)                   \
+    O(TypedInequals)                 \
+    O(AbstractEquals)                \
+    O(AbstractInequals)              \
+    O(GreaterThan)                   \
+    O(GreaterThanEquals)             \
+    O(LessThan)                      \
+    O(LessThanEquals)                \
+    O(BitwiseAnd)                    \
+    O(BitwiseOr)                     \
+    O(BitwiseXor)                    \
+    O(LeftShift)                     \
+    O(RightShift)                    \
+    O(UnsignedRightShift)            \
+    O(In)                            \
+    O(InstanceOf)                    \
+    O(AddNumber)                     \
+    O(SubNumber)                     \
+    O(MulNumber)                     \
+    O(DivNumber)                     \
+    O(ModNumber)                     \
+    O(TypedEqualsNumber)             \
+    O(TypedInequalsNumber)           \
+    O(GreaterThanNumber)             \
+    O(GreaterThanEqualsNumber)       \
+    O(LessThanNumber)                \
+    O(LessThanEqualsNumber)          \
+    O(BitwiseAndNumber)              \
+    O(BitwiseOrNumber)               \
+    O(BitwiseXorNumber)              \
+    O(BitwiseNot)                    \
+    O(Not)                           \
+    O(UnaryPlus)                     \
+    O(UnaryMinus)                    \
+    O(Typeof)                        \
+    O(Increment)                     \
+    O(Decrement)                     \
+    O(Jump)                          \
+    O(JumpIfTrue)                    \
+    O(JumpIfFalse)                   \
+    O(JumpIfNotNullish)              \
+    O(Call)                          \
+    O(New)                           \
+    O(EnterScope)                    \
+    O(ExitScope)                     \
+    O(EvaluateExpression)            \
+    O(EvaluateStatement)             \
+    O(Return)                        \
+    O(End)
+
+namespace JS::Bytecode {
+
+class Interpreter;
+
+// Instructions are laid out back to back in a Block, so they can't have vtables:
+// everything that depends on the kind of instruction switches on type() instead.
+class Instruction {
+public:
+    enum class Type {
+#define __BYTECODE_OP(op) op,
+        JS_ENUMERATE_BYTECODE_OPS(__BYTECODE_OP)
+#undef __BYTECODE_OP
+    };
+
+    Type type() const { return m_type; }
+    size_t length() const;
+    String to_string() const;
+
+    static void destroy(Instruction&);
+
+    // Swaps this instruction for another kind with the same layout, even while its Block is running.
+    // This is how hot blocks switch to (and back from) their specialized instructions.
+    void rewrite_as(Type type) const { m_type = type; }
+
+protected:
+    explicit Instruction(Type type)
+        : m_type(type)
+    {
+    }
+
+private:
+    mutable Type m_type;
+};
+
+}
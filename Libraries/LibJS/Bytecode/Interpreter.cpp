@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <LibJS/Bytecode/Block.h>
+#include <LibJS/Bytecode/Interpreter.h>
+#include <LibJS/Bytecode/Op.h>
+#include <LibJS/Interpreter.h>
+
+namespace JS::Bytecode {
+
+Interpreter::Interpreter(JS::Interpreter& vm, GlobalObject& global_object)
+    : m_vm(vm)
+    , m_global_object(global_object)
+    , m_registers(vm.heap())
+{
+}
+
+Interpreter::~Interpreter()
+{
+}
+
+Value Interpreter::run(const Block& block)
+{
+    m_block = &block;
+    if (block.note_execution())
+        block.specialize();
+    m_registers.values().resize(block.register_count());
+    for (auto& value : m_registers.values())
+        value = js_undefined();
+
+    // Each instruction jumps straight to the code for the next one (rather than going back
+    // through a switch), which gives the branch predictor a lot more to work with.
+    static void* const dispatch_table[] = {
+#define __BYTECODE_OP(op) &&handle_##op,
+        JS_ENUMERATE_BYTECODE_OPS(__BYTECODE_OP)
+#undef __BYTECODE_OP
+    };
+
+    size_t offset = 0;
+    const Instruction* instruction = &block.instruction_at(offset);
+    goto* dispatch_table[static_cast<size_t>(instruction->type())];
+
+#define __BYTECODE_OP(op)                                                       \
+    handle_##op:                                                                \
+    {                                                                           \
+        auto& op_instruction = static_cast<const Op::op&>(*instruction);        \
+        m_next_offset = offset + Block::align_up(op_instruction.length_impl()); \
+        op_instruction.execute(*this);                                          \
+        if (m_should_stop || m_vm.exception())                                  \
+            goto done;                                                          \
+        offset = m_next_offset;                                                 \
+        instruction = &block.instruction_at(offset);                            \
+        goto* dispatch_table[static_cast<size_t>(instruction->type())];         \
+    }
+    JS_ENUMERATE_BYTECODE_OPS(__BYTECODE_OP)
+#undef __BYTECODE_OP
+
+done:
+    if (m_did_return)
+        return m_return_value;
+    if (block.completion_register().has_value())
+        return reg(block.completion_register().value());
+    return js_undefined();
+}
+
+}
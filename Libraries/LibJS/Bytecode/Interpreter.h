@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <LibJS/Bytecode/Block.h>
+#include <LibJS/Bytecode/Label.h>
+#include <LibJS/Bytecode/Register.h>
+#include <LibJS/Forward.h>
+#include <LibJS/Runtime/MarkedValueList.h>
+#include <LibJS/Runtime/Value.h>
+
+namespace JS::Bytecode {
+
+// Runs a Block. The environment and scope handling is shared with the AST interpreter,
+// which is also what bytecode falls back to for nodes that don't have bytecode of their own.
+class Interpreter {
+    AK_MAKE_NONCOPYABLE(Interpreter);
+    AK_MAKE_NONMOVABLE(Interpreter);
+
+public:
+    Interpreter(JS::Interpreter&, GlobalObject&);
+    ~Interpreter();
+
+    // Returns the value of the last expression statement for programs,
+    // and the return value (or undefined) for function bodies.
+    Value run(const Block&);
+    bool did_return() const { return m_did_return; }
+
+    JS::Interpreter& vm() { return m_vm; }
+    GlobalObject& global_object() { return m_global_object; }
+
+    Value& reg(Register reg) { return m_registers.values()[reg.index()]; }
+
+    void jump(Label target)
+    {
+        auto target_offset = m_block->label_offset(target);
+        if (target_offset < m_next_offset && m_block->note_execution())
+            m_block->specialize();
+        m_next_offset = target_offset;
+    }
+    void do_return(Value value)
+    {
+        m_return_value = value;
+        m_did_return = true;
+        m_should_stop = true;
+    }
+    void stop() { m_should_stop = true; }
+
+private:
+    JS::Interpreter& m_vm;
+    GlobalObject& m_global_object;
+    MarkedValueList m_registers;
+    const Block* m_block { nullptr };
+    size_t m_next_offset { 0 };
+    Value m_return_value;
+    bool m_did_return { false };
+    bool m_should_stop { false };
+};
+
+}
@@ -0,0 +1,696 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <AK/StringBuilder.h>
+#include <LibCrypto/BigInt/SignedBigInteger.h>
+#include <LibJS/AST.h>
+#include <LibJS/Bytecode/Interpreter.h>
+#include <LibJS/Bytecode/Op.h>
+#include <LibJS/Interpreter.h>
+#include <LibJS/Runtime/Array.h>
+#include <LibJS/Runtime/BigInt.h>
+#include <LibJS/Runtime/Error.h>
+#include <LibJS/Runtime/GlobalObject.h>
+#include <LibJS/Runtime/MarkedValueList.h>
+#include <LibJS/Runtime/NativeFunction.h>
+#include <LibJS/Runtime/PrimitiveString.h>
+#include <LibJS/Runtime/ScriptFunction.h>
+#include <math.h>
+
+namespace JS::Bytecode {
+
+size_t Instruction::length() const
+{
+    switch (type()) {
+#define __BYTECODE_OP(op)                                       \
+    case Type::op:                                              \
+        return static_cast<const Op::op&>(*this).length_impl();
+        JS_ENUMERATE_BYTECODE_OPS(__BYTECODE_OP)
+#undef __BYTECODE_OP
+    }
+    ASSERT_NOT_REACHED();
+}
+
+String Instruction::to_string() const
+{
+    switch (type()) {
+#define __BYTECODE_OP(op)                                     \
+    case Type::op:                                            \
+        return static_cast<const Op::op&>(*this).to_string();
+        JS_ENUMERATE_BYTECODE_OPS(__BYTECODE_OP)
+#undef __BYTECODE_OP
+    }
+    ASSERT_NOT_REACHED();
+}
+
+void Instruction::destroy(Instruction& instruction)
+{
+    switch (instruction.type()) {
+#define __BYTECODE_OP(op)                        \
+    case Type::op:                               \
+        static_cast<Op::op&>(instruction).~op(); \
+        return;
+        JS_ENUMERATE_BYTECODE_OPS(__BYTECODE_OP)
+#undef __BYTECODE_OP
+    }
+    ASSERT_NOT_REACHED();
+}
+
+static String register_list_to_string(const Register* registers, size_t count)
+{
+    StringBuilder builder;
+    for (size_t i = 0; i < count; ++i) {
+        if (i)
+            builder.append(", ");
+        builder.appendf("$%u", registers[i].index());
+    }
+    return builder.to_string();
+}
+
+}
+
+namespace JS::Bytecode::Op {
+
+void Load::execute(Bytecode::Interpreter& interpreter) const
+{
+    interpreter.reg(m_dst) = m_value;
+}
+
+String Load::to_string() const
+{
+    return String::format("Load $%u, %s", m_dst.index(), m_value.to_string_without_side_effects().characters());
+}
+
+void Move::execute(Bytecode::Interpreter& interpreter) const
+{
+    interpreter.reg(m_dst) = interpreter.reg(m_src);
+}
+
+String Move::to_string() const
+{
+    return String::format("Move $%u, $%u", m_dst.index(), m_src.index());
+}
+
+void NewString::execute(Bytecode::Interpreter& interpreter) const
+{
+    interpreter.reg(m_dst) = js_string(interpreter.vm(), m_string);
+}
+
+String NewString::to_string() const
+{
+    return String::format("NewString $%u, \"%s\"", m_dst.index(), m_string.characters());
+}
+
+void NewArray::execute(Bytecode::Interpreter& interpreter) const
+{
+    auto* array = Array::create(interpreter.global_object());
+    for (size_t i = 0; i < m_element_count; ++i)
+        array->indexed_properties().append(interpreter.reg(m_elements[i]));
+    interpreter.reg(m_dst) = array;
+}
+
+String NewArray::to_string() const
+{
+    return String::format("NewArray $%u, [%s]", m_dst.index(), register_list_to_string(m_elements, m_element_count).characters());
+}
+
+void NewFunction::execute(Bytecode::Interpreter& interpreter) const
+{
+    interpreter.reg(m_dst) = m_function_expression.instantiate(interpreter.vm(), interpreter.global_object());
+}
+
+String NewFunction::to_string() const
+{
+    return String::format("NewFunction $%u, \"%s\"", m_dst.index(), m_function_expression.name().characters());
+}
+
+static String format_variable(const FlyString& name, const Optional<EnvironmentCoordinate>& coordinate)
+{
+    if (!coordinate.has_value())
+        return name;
+    return String::format("%s@%u:%u", name.characters(), coordinate.value().hops, coordinate.value().index);
+}
+
+void GetVariable::execute(Bytecode::Interpreter& interpreter) const
+{
+    if (m_environment_coordinate.has_value()) {
+        interpreter.reg(m_dst) = interpreter.vm().get_variable(m_environment_coordinate.value());
+        return;
+    }
+    auto value = interpreter.vm().get_variable(m_name, interpreter.global_object());
+    if (value.is_empty()) {
+        interpreter.vm().throw_exception<ReferenceError>(ErrorType::UnknownIdentifier, m_name.characters());
+        return;
+    }
+    interpreter.reg(m_dst) = value;
+}
+
+String GetVariable::to_string() const
+{
+    return String::format("GetVariable $%u, %s", m_dst.index(), format_variable(m_name, m_environment_coordinate).characters());
+}
+
+void SetVariable::execute(Bytecode::Interpreter& interpreter) const
+{
+    auto& value = interpreter.reg(m_src);
+    update_function_name(value, m_name);
+    if (m_environment_coordinate.has_value())
+        interpreter.vm().set_variable(m_environment_coordinate.value(), value);
+    else
+        interpreter.vm().set_variable(m_name, value, interpreter.global_object());
+}
+
+String SetVariable::to_string() const
+{
+    return String::format("SetVariable %s, $%u", format_variable(m_name, m_environment_coordinate).characters(), m_src.index());
+}
+
+void InitializeVariable::execute(Bytecode::Interpreter& interpreter) const
+{
+    auto& value = interpreter.reg(m_src);
+    update_function_name(value, m_name);
+    if (m_environment_coordinate.has_value())
+        interpreter.vm().set_variable(m_environment_coordinate.value(), value, true);
+    else
+        interpreter.vm().set_variable(m_name, value, interpreter.global_object(), true);
+}
+
+String InitializeVariable::to_string() const
+{
+    return String::format("InitializeVariable %s, $%u", format_variable(m_name, m_environment_coordinate).characters(), m_src.index());
+}
+
+static Value typeof_value(JS::Interpreter& interpreter, Value value)
+{
+    return js_string(interpreter, value.typeof_string());
+}
+
+void TypeofVariable::execute(Bytecode::Interpreter& interpreter) const
+{
+    Value value;
+    if (m_environment_coordinate.has_value())
+        value = interpreter.vm().get_variable(m_environment_coordinate.value());
+    else
+        value = interpreter.vm().get_variable(m_name, interpreter.global_object()).value_or(js_undefined());
+    interpreter.reg(m_dst) = typeof_value(interpreter.vm(), value);
+}
+
+String TypeofVariable::to_string() const
+{
+    return String::format("TypeofVariable $%u, %s", m_dst.index(), format_variable(m_name, m_environment_coordinate).characters());
+}
+
+static PropertyName property_name_from_value(JS::Interpreter& interpreter, Value value)
+{
+    if (value.is_integer() && value.as_i32() >= 0)
+        return value.as_i32();
+    if (value.is_symbol())
+        return &value.as_symbol();
+    auto string = value.to_string(interpreter);
+    if (interpreter.exception())
+        return {};
+    return string;
+}
+
+static void get_property(Bytecode::Interpreter& interpreter, Register dst, Value base, const PropertyName& property_name)
+{
+    auto* object = base.to_object(interpreter.vm(), interpreter.global_object());
+    if (!object)
+        return;
+    auto value = object->get(property_name).value_or(js_undefined());
+    if (interpreter.vm().exception())
+        return;
+    interpreter.reg(dst) = value;
+}
+
+static void put_property(Bytecode::Interpreter& interpreter, Value base, const PropertyName& property_name, Value value)
+{
+    auto& vm = interpreter.vm();
+    if (!base.is_object() && vm.in_strict_mode()) {
+        vm.throw_exception<TypeError>(ErrorType::ReferencePrimitiveAssignment, property_name.to_string().characters());
+        return;
+    }
+    auto* object = base.to_object(vm, interpreter.global_object());
+    if (!object)
+        return;
+    object->put(property_name, value);
+}
+
+void GetById::execute(Bytecode::Interpreter& interpreter) const
+{
+    auto base = interpreter.reg(m_base);
+    if (base.is_object()) {
+        auto cached_value = m_cache.get(base.as_object());
+        if (!cached_value.is_empty()) {
+            interpreter.reg(m_dst) = cached_value;
+            return;
+        }
+    }
+    get_property(interpreter, m_dst, base, m_property);
+    if (base.is_object() && !interpreter.vm().exception())
+        m_cache.update_for_get(base.as_object(), StringOrSymbol(m_property));
+}
+
+String GetById::to_string() const
+{
+    return String::format("GetById $%u, $%u, %s", m_dst.index(), m_base.index(), m_property.characters());
+}
+
+void GetByValue::execute(Bytecode::Interpreter& interpreter) const
+{
+    auto property_name = property_name_from_value(interpreter.vm(), interpreter.reg(m_property));
+    if (interpreter.vm().exception())
+        return;
+    get_property(interpreter, m_dst, interpreter.reg(m_base), property_name);
+}
+
+String GetByValue::to_string() const
+{
+    return String::format("GetByValue $%u, $%u, $%u", m_dst.index(), m_base.index(), m_property.index());
+}
+
+void PutById::execute(Bytecode::Interpreter& interpreter) const
+{
+    auto& value = interpreter.reg(m_src);
+    update_function_name(value, m_property);
+    auto base = interpreter.reg(m_base);
+    if (base.is_object() && m_cache.put(base.as_object(), value))
+        return;
+    put_property(interpreter, base, m_property, value);
+    if (base.is_object() && !interpreter.vm().exception())
+        m_cache.update_for_put(base.as_object(), StringOrSymbol(m_property));
+}
+
+String PutById::to_string() const
+{
+    return String::format("PutById $%u, %s, $%u", m_base.index(), m_property.characters(), m_src.index());
+}
+
+void PutByValue::execute(Bytecode::Interpreter& interpreter) const
+{
+    auto property_name = property_name_from_value(interpreter.vm(), interpreter.reg(m_property));
+    if (interpreter.vm().exception())
+        return;
+    auto& value = interpreter.reg(m_src);
+    if (property_name.is_symbol())
+        update_function_name(value, String::format("[%s]", property_name.as_symbol()->description().characters()));
+    else
+        update_function_name(value, property_name.to_string());
+    put_property(interpreter, interpreter.reg(m_base), property_name, value);
+}
+
+String PutByValue::to_string() const
+{
+    return String::format("PutByValue $%u, $%u, $%u", m_base.index(), m_property.index(), m_src.index());
+}
+
+void ResolveThis::execute(Bytecode::Interpreter& interpreter) const
+{
+    interpreter.reg(m_dst) = interpreter.vm().resolve_this_binding();
+}
+
+String ResolveThis::to_string() const
+{
+    return String::format("ResolveThis $%u", m_dst.index());
+}
+
+static Value typed_equals(JS::Interpreter& interpreter, Value lhs, Value rhs) { return Value(strict_eq(interpreter, lhs, rhs)); }
+static Value typed_inequals(JS::Interpreter& interpreter, Value lhs, Value rhs) { return Value(!strict_eq(interpreter, lhs, rhs)); }
+static Value abstract_equals(JS::Interpreter& interpreter, Value lhs, Value rhs) { return Value(abstract_eq(interpreter, lhs, rhs)); }
+static Value abstract_inequals(JS::Interpreter& interpreter, Value lhs, Value rhs) { return Value(!abstract_eq(interpreter, lhs, rhs)); }
+
+#define JS_DEFINE_BYTECODE_BINARY_OP(OpName, operation)                                               \
+    void OpName::execute(Bytecode::Interpreter& interpreter) const                                    \
+    {                                                                                                 \
+        auto result = operation(interpreter.vm(), interpreter.reg(m_lhs), interpreter.reg(m_rhs));    \
+        if (!interpreter.vm().exception())                                                            \
+            interpreter.reg(m_dst) = result;                                                          \
+    }                                                                                                 \
+                                                                                                      \
+    String OpName::to_string() const                                                                  \
+    {                                                                                                 \
+        return String::format(#OpName " $%u, $%u, $%u", m_dst.index(), m_lhs.index(), m_rhs.index()); \
+    }
+
+JS_DEFINE_BYTECODE_BINARY_OP(Add, add)
+JS_DEFINE_BYTECODE_BINARY_OP(Sub, sub)
+JS_DEFINE_BYTECODE_BINARY_OP(Mul, mul)
+JS_DEFINE_BYTECODE_BINARY_OP(Div, div)
+JS_DEFINE_BYTECODE_BINARY_OP(Mod, mod)
+JS_DEFINE_BYTECODE_BINARY_OP(Exp, exp)
+JS_DEFINE_BYTECODE_BINARY_OP(TypedEquals, typed_equals)
+JS_DEFINE_BYTECODE_BINARY_OP(TypedInequals, typed_inequals)
+JS_DEFINE_BYTECODE_BINARY_OP(AbstractEquals, abstract_equals)
+JS_DEFINE_BYTECODE_BINARY_OP(AbstractInequals, abstract_inequals)
+JS_DEFINE_BYTECODE_BINARY_OP(GreaterThan, greater_than)
+JS_DEFINE_BYTECODE_BINARY_OP(GreaterThanEquals, greater_than_equals)
+JS_DEFINE_BYTECODE_BINARY_OP(LessThan, less_than)
+JS_DEFINE_BYTECODE_BINARY_OP(LessThanEquals, less_than_equals)
+JS_DEFINE_BYTECODE_BINARY_OP(BitwiseAnd, bitwise_and)
+JS_DEFINE_BYTECODE_BINARY_OP(BitwiseOr, bitwise_or)
+JS_DEFINE_BYTECODE_BINARY_OP(BitwiseXor, bitwise_xor)
+JS_DEFINE_BYTECODE_BINARY_OP(LeftShift, left_shift)
+JS_DEFINE_BYTECODE_BINARY_OP(RightShift, right_shift)
+JS_DEFINE_BYTECODE_BINARY_OP(UnsignedRightShift, unsigned_right_shift)
+JS_DEFINE_BYTECODE_BINARY_OP(In, in)
+JS_DEFINE_BYTECODE_BINARY_OP(InstanceOf, instance_of)
+#undef JS_DEFINE_BYTECODE_BINARY_OP
+
+static Value add_numbers(double lhs, double rhs) { return Value(lhs + rhs); }
+static Value sub_numbers(double lhs, double rhs) { return Value(lhs - rhs); }
+static Value mul_numbers(double lhs, double rhs) { return Value(lhs * rhs); }
+static Value div_numbers(double lhs, double rhs) { return Value(lhs / rhs); }
+static Value typed_equals_numbers(double lhs, double rhs) { return Value(lhs == rhs); }
+static Value typed_inequals_numbers(double lhs, double rhs) { return Value(lhs != rhs); }
+
+// Same as mod() for two numbers.
+static Value mod_numbers(double lhs, double rhs)
+{
+    if (__builtin_isnan(lhs) || __builtin_isnan(rhs))
+        return js_nan();
+    auto trunc = (double)(i32)(lhs / rhs);
+    return Value(lhs - trunc * rhs);
+}
+static Value greater_than_numbers(double lhs, double rhs) { return Value(lhs > rhs); }
+static Value greater_than_equals_numbers(double lhs, double rhs) { return Value(lhs >= rhs); }
+static Value less_than_numbers(double lhs, double rhs) { return Value(lhs < rhs); }
+static Value less_than_equals_numbers(double lhs, double rhs) { return Value(lhs <= rhs); }
+
+// Same as bitwise_and() and friends for two numbers, including how they treat NaN and infinity.
+template<typename Callback>
+static Value bitwise_numbers(double lhs, double rhs, Callback callback)
+{
+    if (__builtin_isnan(lhs) || __builtin_isinf(lhs) || __builtin_isnan(rhs) || __builtin_isinf(rhs))
+        return Value(0);
+    return Value(callback((i32)lhs, (i32)rhs));
+}
+
+static Value bitwise_and_numbers(double lhs, double rhs)
+{
+    return bitwise_numbers(lhs, rhs, [](i32 a, i32 b) { return a & b; });
+}
+
+static Value bitwise_or_numbers(double lhs, double rhs)
+{
+    return bitwise_numbers(lhs, rhs, [](i32 a, i32 b) { return a | b; });
+}
+
+static Value bitwise_xor_numbers(double lhs, double rhs)
+{
+    return bitwise_numbers(lhs, rhs, [](i32 a, i32 b) { return a ^ b; });
+}
+
+#define JS_DEFINE_BYTECODE_NUMBER_BINARY_OP(OpName, NumberOpName, operation)                                \
+    void NumberOpName::execute(Bytecode::Interpreter& interpreter) const                                    \
+    {                                                                                                       \
+        auto lhs = interpreter.reg(m_lhs);                                                                  \
+        auto rhs = interpreter.reg(m_rhs);                                                                  \
+        if (lhs.is_number() && rhs.is_number()) {                                                           \
+            interpreter.reg(m_dst) = operation(lhs.as_double(), rhs.as_double());                           \
+            return;                                                                                         \
+        }                                                                                                   \
+        rewrite_as(Type::OpName);                                                                           \
+        static_cast<const OpName&>(static_cast<const Instruction&>(*this)).execute(interpreter);            \
+    }                                                                                                       \
+                                                                                                            \
+    String NumberOpName::to_string() const                                                                  \
+    {                                                                                                       \
+        return String::format(#NumberOpName " $%u, $%u, $%u", m_dst.index(), m_lhs.index(), m_rhs.index()); \
+    }
+
+JS_DEFINE_BYTECODE_NUMBER_BINARY_OP(Add, AddNumber, add_numbers)
+JS_DEFINE_BYTECODE_NUMBER_BINARY_OP(Sub, SubNumber, sub_numbers)
+JS_DEFINE_BYTECODE_NUMBER_BINARY_OP(Mul, MulNumber, mul_numbers)
+JS_DEFINE_BYTECODE_NUMBER_BINARY_OP(Div, DivNumber, div_numbers)
+JS_DEFINE_BYTECODE_NUMBER_BINARY_OP(Mod, ModNumber, mod_numbers)
+JS_DEFINE_BYTECODE_NUMBER_BINARY_OP(TypedEquals, TypedEqualsNumber, typed_equals_numbers)
+JS_DEFINE_BYTECODE_NUMBER_BINARY_OP(TypedInequals, TypedInequalsNumber, typed_inequals_numbers)
+JS_DEFINE_BYTECODE_NUMBER_BINARY_OP(GreaterThan, GreaterThanNumber, greater_than_numbers)
+JS_DEFINE_BYTECODE_NUMBER_BINARY_OP(GreaterThanEquals, GreaterThanEqualsNumber, greater_than_equals_numbers)
+JS_DEFINE_BYTECODE_NUMBER_BINARY_OP(LessThan, LessThanNumber, less_than_numbers)
+JS_DEFINE_BYTECODE_NUMBER_BINARY_OP(LessThanEquals, LessThanEqualsNumber, less_than_equals_numbers)
+JS_DEFINE_BYTECODE_NUMBER_BINARY_OP(BitwiseAnd, BitwiseAndNumber, bitwise_and_numbers)
+JS_DEFINE_BYTECODE_NUMBER_BINARY_OP(BitwiseOr, BitwiseOrNumber, bitwise_or_numbers)
+JS_DEFINE_BYTECODE_NUMBER_BINARY_OP(BitwiseXor, BitwiseXorNumber, bitwise_xor_numbers)
+#undef JS_DEFINE_BYTECODE_NUMBER_BINARY_OP
+
+static Value to_object(JS::Interpreter& interpreter, Value value)
+{
+    auto* object = value.to_object(interpreter, interpreter.global_object());
+    if (!object)
+        return {};
+    return object;
+}
+
+static Value to_numeric(JS::Interpreter& interpreter, Value value) { return value.to_numeric(interpreter); }
+static Value logical_not(JS::Interpreter&, Value value) { return Value(!value.to_boolean()); }
+
+static Value increment(JS::Interpreter& interpreter, Value value)
+{
+    if (value.is_number())
+        return Value(value.as_double() + 1);
+    return js_bigint(interpreter, value.as_bigint().big_integer().plus(Crypto::SignedBigInteger { 1 }));
+}
+
+static Value decrement(JS::Interpreter& interpreter, Value value)
+{
+    if (value.is_number())
+        return Value(value.as_double() - 1);
+    return js_bigint(interpreter, value.as_bigint().big_integer().minus(Crypto::SignedBigInteger { 1 }));
+}
+
+#define JS_DEFINE_BYTECODE_UNARY_OP(OpName, operation)                            \
+    void OpName::execute(Bytecode::Interpreter& interpreter) const                \
+    {                                                                             \
+        auto result = operation(interpreter.vm(), interpreter.reg(m_src));        \
+        if (!interpreter.vm().exception())                                        \
+            interpreter.reg(m_dst) = result;                                      \
+    }                                                                             \
+                                                                                  \
+    String OpName::to_string() const                                              \
+    {                                                                             \
+        return String::format(#OpName " $%u, $%u", m_dst.index(), m_src.index()); \
+    }
+
+JS_DEFINE_BYTECODE_UNARY_OP(ToObject, to_object)
+JS_DEFINE_BYTECODE_UNARY_OP(ToNumeric, to_numeric)
+JS_DEFINE_BYTECODE_UNARY_OP(BitwiseNot, bitwise_not)
+JS_DEFINE_BYTECODE_UNARY_OP(Not, logical_not)
+JS_DEFINE_BYTECODE_UNARY_OP(UnaryPlus, unary_plus)
+JS_DEFINE_BYTECODE_UNARY_OP(UnaryMinus, unary_minus)
+JS_DEFINE_BYTECODE_UNARY_OP(Typeof, typeof_value)
+JS_DEFINE_BYTECODE_UNARY_OP(Increment, increment)
+JS_DEFINE_BYTECODE_UNARY_OP(Decrement, decrement)
+#undef JS_DEFINE_BYTECODE_UNARY_OP
+
+void Jump::execute(Bytecode::Interpreter& interpreter) const
+{
+    interpreter.jump(m_target);
+}
+
+String Jump::to_string() const
+{
+    return String::format("Jump @%zu", m_target.index());
+}
+
+void JumpIfTrue::execute(Bytecode::Interpreter& interpreter) const
+{
+    if (interpreter.reg(m_condition).to_boolean())
+        interpreter.jump(m_target);
+}
+
+String JumpIfTrue::to_string() const
+{
+    return String::format("JumpIfTrue $%u, @%zu", m_condition.index(), m_target.index());
+}
+
+void JumpIfFalse::execute(Bytecode::Interpreter& interpreter) const
+{
+    if (!interpreter.reg(m_condition).to_boolean())
+        interpreter.jump(m_target);
+}
+
+String JumpIfFalse::to_string() const
+{
+    return String::format("JumpIfFalse $%u, @%zu", m_condition.index(), m_target.index());
+}
+
+void JumpIfNotNullish::execute(Bytecode::Interpreter& interpreter) const
+{
+    auto& condition = interpreter.reg(m_condition);
+    if (!condition.is_null() && !condition.is_undefined())
+        interpreter.jump(m_target);
+}
+
+String JumpIfNotNullish::to_string() const
+{
+    return String::format("JumpIfNotNullish $%u, @%zu", m_condition.index(), m_target.index());
+}
+
+void Call::execute(Bytecode::Interpreter& interpreter) const
+{
+    auto& vm = interpreter.vm();
+    auto callee = interpreter.reg(m_callee);
+    if (!callee.is_function()) {
+        m_expression.throw_type_error_for_callee(vm, callee, "function");
+        return;
+    }
+
+    MarkedValueList arguments(vm.heap());
+    arguments.values().ensure_capacity(m_argument_count);
+    for (size_t i = 0; i < m_argument_count; ++i)
+        arguments.append(interpreter.reg(m_arguments[i]));
+
+    Value this_value = m_this_value.has_value() ? interpreter.reg(m_this_value.value()) : Value(&interpreter.global_object());
+    auto result = vm.call(callee.as_function(), this_value, move(arguments));
+    if (!vm.exception())
+        interpreter.reg(m_dst) = result;
+}
+
+String Call::to_string() const
+{
+    if (m_this_value.has_value())
+        return String::format("Call $%u, $%u, this=$%u, (%s)", m_dst.index(), m_callee.index(), m_this_value.value().index(), register_list_to_string(m_arguments, m_argument_count).characters());
+    return String::format("Call $%u, $%u, (%s)", m_dst.index(), m_callee.index(), register_list_to_string(m_arguments, m_argument_count).characters());
+}
+
+void New::execute(Bytecode::Interpreter& interpreter) const
+{
+    auto& vm = interpreter.vm();
+    auto callee = interpreter.reg(m_callee);
+    if (!callee.is_function() || (callee.as_object().is_native_function() && !static_cast<NativeFunction&>(callee.as_object()).has_constructor())) {
+        m_expression.throw_type_error_for_callee(vm, callee, "constructor");
+        return;
+    }
+
+    MarkedValueList arguments(vm.heap());
+    arguments.values().ensure_capacity(m_argument_count);
+    for (size_t i = 0; i < m_argument_count; ++i)
+        arguments.append(interpreter.reg(m_arguments[i]));
+
+    auto& function = callee.as_function();
+    auto result = vm.construct(function, function, move(arguments), interpreter.global_object());
+    if (!vm.exception())
+        interpreter.reg(m_dst) = result;
+}
+
+String New::to_string() const
+{
+    return String::format("New $%u, $%u, (%s)", m_dst.index(), m_callee.index(), register_list_to_string(m_arguments, m_argument_count).characters());
+}
+
+void EnterScope::execute(Bytecode::Interpreter& interpreter) const
+{
+    interpreter.vm().enter_scope(m_scope_node, {}, ScopeType::Block, interpreter.global_object());
+}
+
+String EnterScope::to_string() const
+{
+    return String::format("EnterScope %s", m_scope_node.class_name());
+}
+
+void ExitScope::execute(Bytecode::Interpreter& interpreter) const
+{
+    interpreter.vm().exit_scope(m_scope_node);
+}
+
+String ExitScope::to_string() const
+{
+    return String::format("ExitScope %s", m_scope_node.class_name());
+}
+
+void EvaluateExpression::execute(Bytecode::Interpreter& interpreter) const
+{
+    auto result = m_expression.execute(interpreter.vm(), interpreter.global_object());
+    if (!interpreter.vm().exception())
+        interpreter.reg(m_dst) = result;
+}
+
+String EvaluateExpression::to_string() const
+{
+    return String::format("EvaluateExpression $%u, %s", m_dst.index(), m_expression.class_name());
+}
+
+void EvaluateStatement::execute(Bytecode::Interpreter& interpreter) const
+{
+    auto& vm = interpreter.vm();
+    m_statement.execute(vm, interpreter.global_object());
+    if (vm.exception() || !vm.should_unwind())
+        return;
+
+    if (vm.should_unwind_until(ScopeType::Function, {})) {
+        vm.stop_unwind();
+        interpreter.do_return(vm.last_value());
+        return;
+    }
+    if (m_break_target.has_value() && vm.should_unwind_until(ScopeType::Breakable, {})) {
+        vm.stop_unwind();
+        interpreter.jump(m_break_target.value());
+        return;
+    }
+    if (m_continue_target.has_value() && vm.should_unwind_until(ScopeType::Continuable, {})) {
+        vm.stop_unwind();
+        interpreter.jump(m_continue_target.value());
+        return;
+    }
+    // Whatever we're unwinding to is further out than this code, so let it carry on.
+    interpreter.stop();
+}
+
+String EvaluateStatement::to_string() const
+{
+    StringBuilder builder;
+    builder.appendf("EvaluateStatement %s", m_statement.class_name());
+    if (m_break_target.has_value())
+        builder.appendf(", break=@%zu", m_break_target.value().index());
+    if (m_continue_target.has_value())
+        builder.appendf(", continue=@%zu", m_continue_target.value().index());
+    return builder.to_string();
+}
+
+void Return::execute(Bytecode::Interpreter& interpreter) const
+{
+    interpreter.do_return(m_value.has_value() ? interpreter.reg(m_value.value()) : js_undefined());
+}
+
+String Return::to_string() const
+{
+    if (m_value.has_value())
+        return String::format("Return $%u", m_value.value().index());
+    return "Return";
+}
+
+void End::execute(Bytecode::Interpreter& interpreter) const
+{
+    interpreter.stop();
+}
+
+String End::to_string() const
+{
+    return "End";
+}
+
+}
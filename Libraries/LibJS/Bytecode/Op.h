@@ -0,0 +1,636 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/FlyString.h>
+#include <AK/Optional.h>
+#include <AK/String.h>
+#include <AK/Vector.h>
+#include <LibJS/AST.h>
+#include <LibJS/Bytecode/Instruction.h>
+#include <LibJS/Bytecode/Label.h>
+#include <LibJS/Bytecode/Register.h>
+#include <LibJS/Forward.h>
+#include <LibJS/Runtime/Value.h>
+
+namespace JS::Bytecode::Op {
+
+// Loads a constant. Since a Block may be run by more than one Interpreter (and outlive them),
+// the value must not be a cell.
+class Load final : public Instruction {
+public:
+    Load(Register dst, Value value)
+        : Instruction(Type::Load)
+        , m_dst(dst)
+        , m_value(value)
+    {
+        ASSERT(!value.is_cell());
+    }
+
+    void execute(Bytecode::Interpreter&) const;
+    String to_string() const;
+    size_t length_impl() const { return sizeof(*this); }
+
+private:
+    Register m_dst;
+    Value m_value;
+};
+
+class Move final : public Instruction {
+public:
+    Move(Register dst, Register src)
+        : Instruction(Type::Move)
+        , m_dst(dst)
+        , m_src(src)
+    {
+    }
+
+    void execute(Bytecode::Interpreter&) const;
+    String to_string() const;
+    size_t length_impl() const { return sizeof(*this); }
+
+private:
+    Register m_dst;
+    Register m_src;
+};
+
+class NewString final : public Instruction {
+public:
+    NewString(Register dst, String string)
+        : Instruction(Type::NewString)
+        , m_dst(dst)
+        , m_string(move(string))
+    {
+    }
+
+    void execute(Bytecode::Interpreter&) const;
+    String to_string() const;
+    size_t length_impl() const { return sizeof(*this); }
+
+private:
+    Register m_dst;
+    String m_string;
+};
+
+class NewArray final : public Instruction {
+public:
+    NewArray(Register dst, const Vector<Register>& elements)
+        : Instruction(Type::NewArray)
+        , m_dst(dst)
+        , m_element_count(elements.size())
+    {
+        for (size_t i = 0; i < m_element_count; ++i)
+            new (&m_elements[i]) Register(elements[i]);
+    }
+
+    void execute(Bytecode::Interpreter&) const;
+    String to_string() const;
+    size_t length_impl() const { return sizeof(*this) + sizeof(Register) * m_element_count; }
+
+private:
+    Register m_dst;
+    size_t m_element_count { 0 };
+    Register m_elements[0];
+};
+
+class NewFunction final : public Instruction {
+public:
+    NewFunction(Register dst, const FunctionExpression& function_expression)
+        : Instruction(Type::NewFunction)
+        , m_dst(dst)
+        , m_function_expression(function_expression)
+    {
+    }
+
+    void execute(Bytecode::Interpreter&) const;
+    String to_string() const;
+    size_t length_impl() const { return sizeof(*this); }
+
+private:
+    Register m_dst;
+    const FunctionExpression& m_function_expression;
+};
+
+class GetVariable final : public Instruction {
+public:
+    GetVariable(Register dst, const Identifier& identifier)
+        : Instruction(Type::GetVariable)
+        , m_dst(dst)
+        , m_name(identifier.string())
+        , m_environment_coordinate(identifier.environment_coordinate())
+    {
+    }
+
+    void execute(Bytecode::Interpreter&) const;
+    String to_string() const;
+    size_t length_impl() const { return sizeof(*this); }
+
+private:
+    Register m_dst;
+    FlyString m_name;
+    Optional<EnvironmentCoordinate> m_environment_coordinate;
+};
+
+// Assigns to an existing variable (or creates a global one), like a = b.
+class SetVariable final : public Instruction {
+public:
+    SetVariable(const Identifier& identifier, Register src)
+        : Instruction(Type::SetVariable)
+        , m_name(identifier.string())
+        , m_environment_coordinate(identifier.environment_coordinate())
+        , m_src(src)
+    {
+    }
+
+    void execute(Bytecode::Interpreter&) const;
+    String to_string() const;
+    size_t length_impl() const { return sizeof(*this); }
+
+private:
+    FlyString m_name;
+    Optional<EnvironmentCoordinate> m_environment_coordinate;
+    Register m_src;
+};
+
+// Gives a declared variable its initial value, like let a = b.
+class InitializeVariable final : public Instruction {
+public:
+    InitializeVariable(const Identifier& identifier, Register src)
+        : Instruction(Type::InitializeVariable)
+        , m_name(identifier.string())
+        , m_environment_coordinate(identifier.environment_coordinate())
+        , m_src(src)
+    {
+    }
+
+    void execute(Bytecode::Interpreter&) const;
+    String to_string() const;
+    size_t length_impl() const { return sizeof(*this); }
+
+private:
+    FlyString m_name;
+    Optional<EnvironmentCoordinate> m_environment_coordinate;
+    Register m_src;
+};
+
+// typeof on a variable name, which is "undefined" rather than a ReferenceError if it's not declared.
+class TypeofVariable final : public Instruction {
+public:
+    TypeofVariable(Register dst, const Identifier& identifier)
+        : Instruction(Type::TypeofVariable)
+        , m_dst(dst)
+        , m_name(identifier.string())
+        , m_environment_coordinate(identifier.environment_coordinate())
+    {
+    }
+
+    void execute(Bytecode::Interpreter&) const;
+    String to_string() const;
+    size_t length_impl() const { return sizeof(*this); }
+
+private:
+    Register m_dst;
+    FlyString m_name;
+    Optional<EnvironmentCoordinate> m_environment_coordinate;
+};
+
+class GetById final : public Instruction {
+public:
+    GetById(Register dst, Register base, FlyString property)
+        : Instruction(Type::GetById)
+        , m_dst(dst)
+        , m_base(base)
+        , m_property(move(property))
+    {
+    }
+
+    void execute(Bytecode::Interpreter&) const;
+    String to_string() const;
+    size_t length_impl() const { return sizeof(*this); }
+
+private:
+    Register m_dst;
+    Register m_base;
+    FlyString m_property;
+    PropertyLookupCache m_cache;
+};
+
+class GetByValue final : public Instruction {
+public:
+    GetByValue(Register dst, Register base, Register property)
+        : Instruction(Type::GetByValue)
+        , m_dst(dst)
+        , m_base(base)
+        , m_property(property)
+    {
+    }
+
+    void execute(Bytecode::Interpreter&) const;
+    String to_string() const;
+    size_t length_impl() const { return sizeof(*this); }
+
+private:
+    Register m_dst;
+    Register m_base;
+    Register m_property;
+};
+
+class PutById final : public Instruction {
+public:
+    PutById(Register base, FlyString property, Register src)
+        : Instruction(Type::PutById)
+        , m_base(base)
+        , m_property(move(property))
+        , m_src(src)
+    {
+    }
+
+    void execute(Bytecode::Interpreter&) const;
+    String to_string() const;
+    size_t length_impl() const { return sizeof(*this); }
+
+private:
+    Register m_base;
+    FlyString m_property;
+    Register m_src;
+    PropertyLookupCache m_cache;
+};
+
+class PutByValue final : public Instruction {
+public:
+    PutByValue(Register base, Register property, Register src)
+        : Instruction(Type::PutByValue)
+        , m_base(base)
+        , m_property(property)
+        , m_src(src)
+    {
+    }
+
+    void execute(Bytecode::Interpreter&) const;
+    String to_string() const;
+    size_t length_impl() const { return sizeof(*this); }
+
+private:
+    Register m_base;
+    Register m_property;
+    Register m_src;
+};
+
+class ResolveThis final : public Instruction {
+public:
+    explicit ResolveThis(Register dst)
+        : Instruction(Type::ResolveThis)
+        , m_dst(dst)
+    {
+    }
+
+    void execute(Bytecode::Interpreter&) const;
+    String to_string() const;
+    size_t length_impl() const { return sizeof(*this); }
+
+private:
+    Register m_dst;
+};
+
+#define JS_ENUMERATE_BYTECODE_BINARY_OPS(O) \
+    O(Add)                                  \
+    O(Sub)                                  \
+    O(Mul)                                  \
+    O(Div)                                  \
+    O(Mod)                                  \
+    O(Exp)                                  \
+    O(TypedEquals)                          \
+    O(TypedInequals)                        \
+    O(AbstractEquals)                       \
+    O(AbstractInequals)                     \
+    O(GreaterThan)                          \
+    O(GreaterThanEquals)                    \
+    O(LessThan)                             \
+    O(LessThanEquals)                       \
+    O(BitwiseAnd)                           \
+    O(BitwiseOr)                            \
+    O(BitwiseXor)                           \
+    O(LeftShift)                            \
+    O(RightShift)                           \
+    O(UnsignedRightShift)                   \
+    O(In)                                   \
+    O(InstanceOf)
+
+#define JS_DECLARE_BYTECODE_BINARY_OP(OpName)                \
+    class OpName final : public Instruction {                \
+    public:                                                  \
+        OpName(Register dst, Register lhs, Register rhs)     \
+            : Instruction(Type::OpName)                      \
+            , m_dst(dst)                                     \
+            , m_lhs(lhs)                                     \
+            , m_rhs(rhs)                                     \
+        {                                                    \
+        }                                                    \
+                                                             \
+        void execute(Bytecode::Interpreter&) const;          \
+        String to_string() const;                            \
+        size_t length_impl() const { return sizeof(*this); } \
+                                                             \
+    private:                                                 \
+        Register m_dst;                                      \
+        Register m_lhs;                                      \
+        Register m_rhs;                                      \
+    };
+
+JS_ENUMERATE_BYTECODE_BINARY_OPS(JS_DECLARE_BYTECODE_BINARY_OP)
+#undef JS_DECLARE_BYTECODE_BINARY_OP
+
+// Variants of the binary ops that only handle numbers, which hot blocks switch to (see Block::specialize()).
+// Nothing creates these directly: they share the layout of the generic op, and turn back into it for good
+// the first time one of the operands turns out not to be a number.
+#define JS_ENUMERATE_BYTECODE_NUMBER_BINARY_OPS(O)     \
+    O(Add, AddNumber)                                 \
+    O(Sub, SubNumber)                                 \
+    O(Mul, MulNumber)                                 \
+    O(Div, DivNumber)                                 \
+    O(Mod, ModNumber)                                 \
+    O(TypedEquals, TypedEqualsNumber)                 \
+    O(TypedInequals, TypedInequalsNumber)             \
+    O(GreaterThan, GreaterThanNumber)                 \
+    O(GreaterThanEquals, GreaterThanEqualsNumber)     \
+    O(LessThan, LessThanNumber)                       \
+    O(LessThanEquals, LessThanEqualsNumber)           \
+    O(BitwiseAnd, BitwiseAndNumber)                   \
+    O(BitwiseOr, BitwiseOrNumber)                     \
+    O(BitwiseXor, BitwiseXorNumber)
+
+#define JS_DECLARE_BYTECODE_NUMBER_BINARY_OP(OpName, NumberOpName) \
+    class NumberOpName final : public Instruction {                \
+    public:                                                        \
+        void execute(Bytecode::Interpreter&) const;                \
+        String to_string() const;                                  \
+        size_t length_impl() const { return sizeof(*this); }       \
+                                                                   \
+    private:                                                       \
+        Register m_dst;                                            \
+        Register m_lhs;                                            \
+        Register m_rhs;                                            \
+    };                                                             \
+    static_assert(sizeof(NumberOpName) == sizeof(OpName));
+
+JS_ENUMERATE_BYTECODE_NUMBER_BINARY_OPS(JS_DECLARE_BYTECODE_NUMBER_BINARY_OP)
+#undef JS_DECLARE_BYTECODE_NUMBER_BINARY_OP
+
+#define JS_ENUMERATE_BYTECODE_UNARY_OPS(O) \
+    O(ToObject)                            \
+    O(ToNumeric)                           \
+    O(BitwiseNot)                          \
+    O(Not)                                 \
+    O(UnaryPlus)                           \
+    O(UnaryMinus)                          \
+    O(Typeof)                              \
+    O(Increment)                           \
+    O(Decrement)
+
+#define JS_DECLARE_BYTECODE_UNARY_OP(OpName)                 \
+    class OpName final : public Instruction {                \
+    public:                                                  \
+        OpName(Register dst, Register src)                   \
+            : Instruction(Type::OpName)                      \
+            , m_dst(dst)                                     \
+            , m_src(src)                                     \
+        {                                                    \
+        }                                                    \
+                                                             \
+        void execute(Bytecode::Interpreter&) const;          \
+        String to_string() const;                            \
+        size_t length_impl() const { return sizeof(*this); } \
+                                                             \
+    private:                                                 \
+        Register m_dst;                                      \
+        Register m_src;                                      \
+    };
+
+JS_ENUMERATE_BYTECODE_UNARY_OPS(JS_DECLARE_BYTECODE_UNARY_OP)
+#undef JS_DECLARE_BYTECODE_UNARY_OP
+
+class Jump final : public Instruction {
+public:
+    explicit Jump(Label target)
+        : Instruction(Type::Jump)
+        , m_target(target)
+    {
+    }
+
+    void execute(Bytecode::Interpreter&) const;
+    String to_string() const;
+    size_t length_impl() const { return sizeof(*this); }
+
+private:
+    Label m_target;
+};
+
+#define JS_ENUMERATE_BYTECODE_CONDITIONAL_JUMP_OPS(O) \
+    O(JumpIfTrue)                                     \
+    O(JumpIfFalse)                                    \
+    O(JumpIfNotNullish)
+
+#define JS_DECLARE_BYTECODE_CONDITIONAL_JUMP_OP(OpName)      \
+    class OpName final : public Instruction {                \
+    public:                                                  \
+        OpName(Register condition, Label target)             \
+            : Instruction(Type::OpName)                      \
+            , m_condition(condition)                         \
+            , m_target(target)                               \
+        {                                                    \
+        }                                                    \
+                                                             \
+        void execute(Bytecode::Interpreter&) const;          \
+        String to_string() const;                            \
+        size_t length_impl() const { return sizeof(*this); } \
+                                                             \
+    private:                                                 \
+        Register m_condition;                                \
+        Label m_target;                                      \
+    };
+
+JS_ENUMERATE_BYTECODE_CONDITIONAL_JUMP_OPS(JS_DECLARE_BYTECODE_CONDITIONAL_JUMP_OP)
+#undef JS_DECLARE_BYTECODE_CONDITIONAL_JUMP_OP
+
+// Calls a function. Without a this value, the global object is used.
+class Call final : public Instruction {
+public:
+    Call(Register dst, Register callee, Optional<Register> this_value, const CallExpression& expression, const Vector<Register>& arguments)
+        : Instruction(Type::Call)
+        , m_dst(dst)
+        , m_callee(callee)
+        , m_this_value(this_value)
+        , m_expression(expression)
+        , m_argument_count(arguments.size())
+    {
+        for (size_t i = 0; i < m_argument_count; ++i)
+            new (&m_arguments[i]) Register(arguments[i]);
+    }
+
+    void execute(Bytecode::Interpreter&) const;
+    String to_string() const;
+    size_t length_impl() const { return sizeof(*this) + sizeof(Register) * m_argument_count; }
+
+private:
+    Register m_dst;
+    Register m_callee;
+    Optional<Register> m_this_value;
+    const CallExpression& m_expression;
+    size_t m_argument_count { 0 };
+    Register m_arguments[0];
+};
+
+class New final : public Instruction {
+public:
+    New(Register dst, Register callee, const CallExpression& expression, const Vector<Register>& arguments)
+        : Instruction(Type::New)
+        , m_dst(dst)
+        , m_callee(callee)
+        , m_expression(expression)
+        , m_argument_count(arguments.size())
+    {
+        for (size_t i = 0; i < m_argument_count; ++i)
+            new (&m_arguments[i]) Register(arguments[i]);
+    }
+
+    void execute(Bytecode::Interpreter&) const;
+    String to_string() const;
+    size_t length_impl() const { return sizeof(*this) + sizeof(Register) * m_argument_count; }
+
+private:
+    Register m_dst;
+    Register m_callee;
+    const CallExpression& m_expression;
+    size_t m_argument_count { 0 };
+    Register m_arguments[0];
+};
+
+class EnterScope final : public Instruction {
+public:
+    explicit EnterScope(const ScopeNode& scope_node)
+        : Instruction(Type::EnterScope)
+        , m_scope_node(scope_node)
+    {
+    }
+
+    void execute(Bytecode::Interpreter&) const;
+    String to_string() const;
+    size_t length_impl() const { return sizeof(*this); }
+
+private:
+    const ScopeNode& m_scope_node;
+};
+
+// Leaves the given scope, along with any scopes that were entered after it.
+class ExitScope final : public Instruction {
+public:
+    explicit ExitScope(const ScopeNode& scope_node)
+        : Instruction(Type::ExitScope)
+        , m_scope_node(scope_node)
+    {
+    }
+
+    void execute(Bytecode::Interpreter&) const;
+    String to_string() const;
+    size_t length_impl() const { return sizeof(*this); }
+
+private:
+    const ScopeNode& m_scope_node;
+};
+
+// Runs an expression in the AST interpreter. This is how we deal with expressions
+// that don't have bytecode of their own.
+class EvaluateExpression final : public Instruction {
+public:
+    EvaluateExpression(Register dst, const Expression& expression)
+        : Instruction(Type::EvaluateExpression)
+        , m_dst(dst)
+        , m_expression(expression)
+    {
+    }
+
+    void execute(Bytecode::Interpreter&) const;
+    String to_string() const;
+    size_t length_impl() const { return sizeof(*this); }
+
+private:
+    Register m_dst;
+    const Expression& m_expression;
+};
+
+// Runs a statement in the AST interpreter. If the statement returns, we return too.
+// If it breaks out of (or continues) the loop it's in, we jump to the given targets.
+class EvaluateStatement final : public Instruction {
+public:
+    EvaluateStatement(const Statement& statement, Optional<Label> break_target, Optional<Label> continue_target)
+        : Instruction(Type::EvaluateStatement)
+        , m_statement(statement)
+        , m_break_target(break_target)
+        , m_continue_target(continue_target)
+    {
+    }
+
+    void execute(Bytecode::Interpreter&) const;
+    String to_string() const;
+    size_t length_impl() const { return sizeof(*this); }
+
+private:
+    const Statement& m_statement;
+    Optional<Label> m_break_target;
+    Optional<Label> m_continue_target;
+};
+
+class Return final : public Instruction {
+public:
+    explicit Return(Optional<Register> value)
+        : Instruction(Type::Return)
+        , m_value(value)
+    {
+    }
+
+    void execute(Bytecode::Interpreter&) const;
+    String to_string() const;
+    size_t length_impl() const { return sizeof(*this); }
+
+private:
+    Optional<Register> m_value;
+};
+
+// Falls off the end of the code, without returning a value.
+class End final : public Instruction {
+public:
+    End()
+        : Instruction(Type::End)
+    {
+    }
+
+    void execute(Bytecode::Interpreter&) const;
+    String to_string() const;
+    size_t length_impl() const { return sizeof(*this); }
+};
+
+}
@@ -44,18 +44,20 @@
 #define JS_DEFINE_NATIVE_SETTER(name) \
     void name([[maybe_unused]] JS::Interpreter& interpreter, [[maybe_unused]] JS::GlobalObject& global_object, JS::Value value)
 
-#define JS_ENUMERATE_NATIVE_OBJECTS                                              \
-    __JS_ENUMERATE(Array, array, ArrayPrototype, ArrayConstructor)               \
-    __JS_ENUMERATE(BigIntObject, bigint, BigIntPrototype, BigIntConstructor)     \
-    __JS_ENUMERATE(BooleanObject, boolean, BooleanPrototype, BooleanConstructor) \
-    __JS_ENUMERATE(Date, date, DatePrototype, DateConstructor)                   \
-    __JS_ENUMERATE(Error, error, ErrorPrototype, ErrorConstructor)               \
-    __JS_ENUMERATE(Function, function, FunctionPrototype, FunctionConstructor)   \
-    __JS_ENUMERATE(NumberObject, number, NumberPrototype, NumberConstructor)     \
-    __JS_ENUMERATE(Object, object, ObjectPrototype, ObjectConstructor)           \
-    __JS_ENUMERATE(ProxyObject, proxy, ProxyPrototype, ProxyConstructor)         \
-    __JS_ENUMERATE(RegExpObject, regexp, RegExpPrototype, RegExpConstructor)     \
-    __JS_ENUMERATE(StringObject, string, StringPrototype, StringConstructor)     \
+#define JS_ENUMERATE_NATIVE_OBJECTS                                                         \
+    __JS_ENUMERATE(Array, array, ArrayPrototype, ArrayConstructor)                          \
+    __JS_ENUMERATE(ArrayBuffer, array_buffer, ArrayBufferPrototype, ArrayBufferConstructor) \
+    __JS_ENUMERATE(BigIntObject, bigint, BigIntPrototype, BigIntConstructor)                \
+    __JS_ENUMERATE(BooleanObject, boolean, BooleanPrototype, BooleanConstructor)            \
+    __JS_ENUMERATE(DataView, data_view, DataViewPrototype, DataViewConstructor)             \
+    __JS_ENUMERATE(Date, date, DatePrototype, DateConstructor)                              \
+    __JS_ENUMERATE(Error, error, ErrorPrototype, ErrorConstructor)                          \
+    __JS_ENUMERATE(Function, function, FunctionPrototype, FunctionConstructor)              \
+    __JS_ENUMERATE(NumberObject, number, NumberPrototype, NumberConstructor)                \
+    __JS_ENUMERATE(Object, object, ObjectPrototype, ObjectConstructor)                      \
+    __JS_ENUMERATE(ProxyObject, proxy, ProxyPrototype, ProxyConstructor)                    \
+    __JS_ENUMERATE(RegExpObject, regexp, RegExpPrototype, RegExpConstructor)                \
+    __JS_ENUMERATE(StringObject, string, StringPrototype, StringConstructor)                \
     __JS_ENUMERATE(SymbolObject, symbol, SymbolPrototype, SymbolConstructor)
 
 #define JS_ENUMERATE_ERROR_SUBCLASSES                                                                   \
@@ -68,6 +70,17 @@
     __JS_ENUMERATE(TypeError, type_error, TypeErrorPrototype, TypeErrorConstructor)                     \
     __JS_ENUMERATE(URIError, uri_error, URIErrorPrototype, URIErrorConstructor)
 
+#define JS_ENUMERATE_TYPED_ARRAYS                                                                                               \
+    __JS_ENUMERATE(Uint8Array, uint8_array, Uint8ArrayPrototype, Uint8ArrayConstructor, u8)                                     \
+    __JS_ENUMERATE(Uint8ClampedArray, uint8_clamped_array, Uint8ClampedArrayPrototype, Uint8ClampedArrayConstructor, ClampedU8) \
+    __JS_ENUMERATE(Uint16Array, uint16_array, Uint16ArrayPrototype, Uint16ArrayConstructor, u16)                                \
+    __JS_ENUMERATE(Uint32Array, uint32_array, Uint32ArrayPrototype, Uint32ArrayConstructor, u32)                                \
+    __JS_ENUMERATE(Int8Array, int8_array, Int8ArrayPrototype, Int8ArrayConstructor, i8)                                         \
+    __JS_ENUMERATE(Int16Array, int16_array, Int16ArrayPrototype, Int16ArrayConstructor, i16)                                    \
+    __JS_ENUMERATE(Int32Array, int32_array, Int32ArrayPrototype, Int32ArrayConstructor, i32)                                    \
+    __JS_ENUMERATE(Float32Array, float32_array, Float32ArrayPrototype, Float32ArrayConstructor, float)                          \
+    __JS_ENUMERATE(Float64Array, float64_array, Float64ArrayPrototype, Float64ArrayConstructor, double)
+
 #define JS_ENUMERATE_ITERATOR_PROTOTYPES            \
     __JS_ENUMERATE(Iterator, iterator)              \
     __JS_ENUMERATE(ArrayIterator, array_iterator)   \
@@ -97,11 +110,15 @@ namespace JS {
 class ASTNode;
 class BigInt;
 class BoundFunction;
+class CallExpression;
 class Cell;
 class DeferGC;
+struct EnvironmentCoordinate;
+class EnvironmentLayout;
 class Error;
 class Exception;
 class Expression;
+class FunctionExpression;
 class Accessor;
 class GlobalObject;
 class HandleImpl;
@@ -112,13 +129,18 @@ class LexicalEnvironment;
 class MarkedValueList;
 class NativeProperty;
 class PrimitiveString;
+class PropertyLookupCache;
 class Reference;
+class ScopeAnalysis;
+class ScopeAnalysisContext;
 class ScopeNode;
+class ScriptFunction;
 class Shape;
 class Statement;
 class Symbol;
 class Token;
-class Uint8ClampedArray;
+class TypedArrayBase;
+class TypedArrayPrototype;
 class Value;
 enum class DeclarationKind;
 
@@ -129,9 +151,22 @@ enum class DeclarationKind;
 JS_ENUMERATE_BUILTIN_TYPES
 #undef __JS_ENUMERATE
 
+#define __JS_ENUMERATE(ClassName, snake_name, PrototypeName, ConstructorName, ArrayType) \
+    class ClassName;                                                                     \
+    class ConstructorName;                                                               \
+    class PrototypeName;
+JS_ENUMERATE_TYPED_ARRAYS
+#undef __JS_ENUMERATE
+
 struct Argument;
 
 template<class T>
 class Handle;
 
+namespace Bytecode {
+class Block;
+class Generator;
+class Interpreter;
+}
+
 }
@@ -27,6 +27,7 @@
 #pragma once
 
 #include <AK/Badge.h>
+#include <AK/IntrusiveList.h>
 #include <AK/Noncopyable.h>
 #include <AK/RefCounted.h>
 #include <AK/RefPtr.h>
@@ -44,6 +45,9 @@ public:
     Cell* cell() { return m_cell; }
     const Cell* cell() const { return m_cell; }
 
+    // Links this handle into the Heap's list of handles, which are all roots.
+    IntrusiveListNode m_list_node;
+
 private:
     template<class T>
     friend class Handle;
@@ -26,6 +26,7 @@
 
 #include <AK/Badge.h>
 #include <AK/HashTable.h>
+#include <AK/QuickSort.h>
 #include <LibJS/Heap/Handle.h>
 #include <LibJS/Heap/Heap.h>
 #include <LibJS/Heap/HeapBlock.h>
@@ -34,6 +35,7 @@
 #include <LibJS/Runtime/Object.h>
 #include <setjmp.h>
 #include <stdio.h>
+#include <time.h>
 
 #ifdef __serenity__
 #    include <serenity.h>
@@ -45,8 +47,20 @@
 //#define HEAP_DEBUG
 #endif
 
+// Checks before every minor collection that each old cell pointing to a young one has been remembered.
+//#define WRITE_BARRIER_DEBUG
+
 namespace JS {
 
+size_t Heap::s_sweep_count = 0;
+
+static u64 monotonic_microseconds()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (u64)now.tv_sec * 1000000 + now.tv_nsec / 1000;
+}
+
 Heap::Heap(Interpreter& interpreter)
     : m_interpreter(interpreter)
 {
@@ -55,6 +69,18 @@ Heap::Heap(Interpreter& interpreter)
 Heap::~Heap()
 {
     collect_garbage(CollectionType::CollectEverything);
+    ASSERT(m_blocks.is_empty());
+}
+
+Heap::SizeClass& Heap::size_class_for(size_t cell_size)
+{
+    size_t index = cell_size / 16 - 1;
+    if (index >= m_size_classes.size())
+        m_size_classes.resize(index + 1);
+    auto& size_class = m_size_classes[index];
+    if (!size_class)
+        size_class = make<SizeClass>();
+    return *size_class;
 }
 
 Cell* Heap::allocate_cell(size_t size)
@@ -68,32 +94,149 @@ Cell* Heap::allocate_cell(size_t size)
         ++m_allocations_since_last_gc;
     }
 
-    for (auto& block : m_blocks) {
-        if (size > block->cell_size())
-            continue;
-        if (auto* cell = block->allocate())
-            return cell;
+    size_t cell_size = cell_size_for(size);
+    auto& size_class = size_class_for(cell_size);
+    ++size_class.allocation_count;
+
+    // Blocks left unswept by the last collection are swept here, when their size class runs out of room.
+    while (!size_class.usable_blocks.first() && size_class.unswept_blocks.first()) {
+        sweep_block(*size_class.unswept_blocks.first(), true);
+        ++m_collection_statistics.blocks_swept_during_allocation;
+    }
+
+    auto* block = size_class.usable_blocks.first();
+    if (!block) {
+        block = HeapBlock::create_with_cell_size(*this, cell_size).leak_ptr();
+        m_blocks.set(block);
+        ++size_class.block_count;
+        size_class.usable_blocks.append(*block);
     }
 
-    size_t cell_size = round_up_to_power_of_two(size, 16);
-    auto block = HeapBlock::create_with_cell_size(*this, cell_size);
     auto* cell = block->allocate();
-    m_blocks.append(move(block));
+    ASSERT(cell);
+    if (!block->has_free_cells())
+        size_class.usable_blocks.remove(*block);
     return cell;
 }
 
+void Heap::did_allocate(const Cell& cell)
+{
+    auto it = m_allocation_counts.find(cell.class_name());
+    if (it == m_allocation_counts.end())
+        m_allocation_counts.set(cell.class_name(), 1);
+    else
+        ++it->value;
+}
+
+void Heap::destroy_block(HeapBlock& block)
+{
+#ifdef HEAP_DEBUG
+    dbg() << " - Reclaim HeapBlock @ " << &block << ": cell_size=" << block.cell_size();
+#endif
+    auto& size_class = size_class_for(block.cell_size());
+    block.m_list_node.remove();
+    --size_class.block_count;
+    m_blocks.remove(&block);
+    delete &block;
+}
+
+void Heap::dump_statistics() const
+{
+    fprintf(stderr, "Heap: %zu blocks of %zu bytes\n", m_blocks.size(), HeapBlock::block_size);
+    for (size_t i = 0; i < m_size_classes.size(); ++i) {
+        auto& size_class = m_size_classes[i];
+        if (!size_class)
+            continue;
+        fprintf(stderr, "  %4zu-byte cells: %8zu allocations, %4zu blocks\n", (i + 1) * 16, size_class->allocation_count, size_class->block_count);
+    }
+
+    auto& stats = m_collection_statistics;
+    fprintf(stderr, "Garbage collections: %zu (%zu full), %zu cells promoted, total pause %.3f ms, longest pause %.3f ms, %zu blocks swept during allocation\n",
+        stats.collection_count, stats.full_collection_count, stats.cells_promoted, stats.total_pause_microseconds / 1000.0, stats.longest_pause_microseconds / 1000.0, stats.blocks_swept_during_allocation);
+    for (size_t i = 0; i < CollectionStatistics::pause_histogram_size; ++i) {
+        if (!stats.pause_histogram[i])
+            continue;
+        if (i == CollectionStatistics::pause_histogram_size - 1)
+            fprintf(stderr, "  >= %7u us: %zu\n", 1u << i, stats.pause_histogram[i]);
+        else
+            fprintf(stderr, "  %7u-%7u us: %zu\n", 1u << i, (1u << (i + 1)) - 1, stats.pause_histogram[i]);
+    }
+
+    if (m_allocation_counts.is_empty())
+        return;
+
+    // Different translation units may hand out distinct copies of the same class name, so merge them by value.
+    HashMap<String, size_t> counts_by_name;
+    for (auto& it : m_allocation_counts) {
+        auto existing = counts_by_name.get(it.key);
+        counts_by_name.set(it.key, existing.value_or(0) + it.value);
+    }
+    Vector<String> names;
+    for (auto& it : counts_by_name)
+        names.append(it.key);
+    quick_sort(names, [&](auto& a, auto& b) { return counts_by_name.get(a).value() > counts_by_name.get(b).value(); });
+
+    fprintf(stderr, "Allocations by cell class:\n");
+    for (auto& name : names)
+        fprintf(stderr, "  %8zu %s\n", counts_by_name.get(name).value(), name.characters());
+}
+
 void Heap::collect_garbage(CollectionType collection_type)
 {
-    if (collection_type == CollectionType::CollectGarbage) {
-        if (m_gc_deferrals) {
-            m_should_gc_when_deferral_ends = true;
-            return;
-        }
+    if (collection_type == CollectionType::CollectGarbage && m_gc_deferrals) {
+        m_should_gc_when_deferral_ends = true;
+        return;
+    }
+
+    auto start_time = monotonic_microseconds();
+
+    // Free whatever the previous collection found dead, so that every cell left is either old (marked) or young.
+    finish_sweeping();
+
+    bool full_collection = collection_type != CollectionType::CollectGarbage
+        || m_cells_promoted_since_full_gc > max(m_cells_alive_after_full_gc, min_promotions_between_full_gc);
+
+    if (full_collection)
+        clear_marks();
+#ifdef WRITE_BARRIER_DEBUG
+    else
+        verify_write_barriers();
+#endif
+
+    if (collection_type != CollectionType::CollectEverything) {
         HashTable<Cell*> roots;
         gather_roots(roots);
-        mark_live_cells(roots);
+        auto marked_cell_count = mark_live_cells(roots, full_collection);
+        if (full_collection) {
+            m_cells_promoted_since_full_gc = 0;
+            m_cells_alive_after_full_gc = marked_cell_count;
+            ++m_collection_statistics.full_collection_count;
+        } else {
+            m_cells_promoted_since_full_gc += marked_cell_count;
+            m_collection_statistics.cells_promoted += marked_cell_count;
+        }
     }
-    sweep_dead_cells();
+
+    // Sweeping is deferred until a size class needs a block, so it isn't part of the pause.
+    for (auto* block : m_blocks)
+        size_class_for(block->cell_size()).unswept_blocks.append(*block);
+
+    if (collection_type == CollectionType::CollectEverything)
+        finish_sweeping();
+
+    did_pause(monotonic_microseconds() - start_time);
+}
+
+void Heap::did_pause(u64 microseconds)
+{
+    auto& stats = m_collection_statistics;
+    ++stats.collection_count;
+    stats.total_pause_microseconds += microseconds;
+    stats.longest_pause_microseconds = max(stats.longest_pause_microseconds, microseconds);
+    size_t bucket = 0;
+    while (bucket < CollectionStatistics::pause_histogram_size - 1 && microseconds >= (2u << bucket))
+        ++bucket;
+    ++stats.pause_histogram[bucket];
 }
 
 void Heap::gather_roots(HashTable<Cell*>& roots)
@@ -102,11 +245,11 @@ void Heap::gather_roots(HashTable<Cell*>& roots)
 
     gather_conservative_roots(roots);
 
-    for (auto* handle : m_handles)
-        roots.set(handle->cell());
+    for (auto& handle : m_handles)
+        roots.set(handle.cell());
 
-    for (auto* list : m_marked_value_lists) {
-        for (auto& value : list->values()) {
+    for (auto& list : m_marked_value_lists) {
+        for (auto& value : list.values()) {
             if (value.is_cell())
                 roots.set(value.as_cell());
         }
@@ -199,7 +342,7 @@ void Heap::gather_conservative_roots(HashTable<Cell*>& roots)
 Cell* Heap::cell_from_possible_pointer(FlatPtr pointer)
 {
     auto* possible_heap_block = HeapBlock::from_cell(reinterpret_cast<const Cell*>(pointer));
-    if (m_blocks.find([possible_heap_block](auto& block) { return block.ptr() == possible_heap_block; }) == m_blocks.end())
+    if (!m_blocks.contains(possible_heap_block))
         return nullptr;
     return possible_heap_block->cell_from_possible_pointer(pointer);
 }
@@ -208,6 +351,7 @@ class MarkingVisitor final : public Cell::Visitor {
 public:
     MarkingVisitor() { }
 
+    // In a minor collection, old cells are already marked, so only young ones are visited.
     virtual void visit_impl(Cell* cell)
     {
         if (cell->is_marked())
@@ -216,11 +360,26 @@ public:
         dbg() << "  ! " << cell;
 #endif
         cell->set_marked(true);
-        cell->visit_children(*this);
+        m_work_list.append(cell);
+        ++m_marked_cell_count;
+    }
+
+    // Children are visited from a work list rather than recursively, since some object
+    // graphs (like long linked lists, or ropes of concatenated strings) are very deep.
+    void visit_all_children()
+    {
+        while (!m_work_list.is_empty())
+            m_work_list.take_last()->visit_children(*this);
     }
+
+    size_t marked_cell_count() const { return m_marked_cell_count; }
+
+private:
+    Vector<Cell*> m_work_list;
+    size_t m_marked_cell_count { 0 };
 };
 
-void Heap::mark_live_cells(const HashTable<Cell*>& roots)
+size_t Heap::mark_live_cells(const HashTable<Cell*>& roots, bool full_collection)
 {
 #ifdef HEAP_DEBUG
     dbg() << "mark_live_cells:";
@@ -228,70 +387,138 @@ void Heap::mark_live_cells(const HashTable<Cell*>& roots)
     MarkingVisitor visitor;
     for (auto* root : roots)
         visitor.visit(root);
+
+    // A minor collection doesn't look into old cells, so the young cells stored in them since the last
+    // collection are found through the remembered set instead. They all become old now, so it starts over.
+    if (!full_collection) {
+        for (auto* cell : m_remembered_cells) {
+            cell->visit_children(visitor);
+            cell->set_remembered(false);
+        }
+        m_remembered_cells.clear_with_capacity();
+    }
+
+    visitor.visit_all_children();
+    return visitor.marked_cell_count();
 }
 
-void Heap::sweep_dead_cells()
+void Heap::clear_marks()
 {
-#ifdef HEAP_DEBUG
-    dbg() << "sweep_dead_cells:";
-#endif
-    Vector<HeapBlock*, 32> empty_blocks;
-
-    for (auto& block : m_blocks) {
-        bool block_has_live_cells = false;
+    for (auto* block : m_blocks) {
         block->for_each_cell([&](Cell* cell) {
             if (cell->is_live()) {
-                if (!cell->is_marked()) {
-#ifdef HEAP_DEBUG
-                    dbg() << "  ~ " << cell;
-#endif
-                    block->deallocate(cell);
-                } else {
-                    cell->set_marked(false);
-                    block_has_live_cells = true;
-                }
+                cell->set_marked(false);
+                cell->set_remembered(false);
             }
         });
-        if (!block_has_live_cells)
-            empty_blocks.append(block);
     }
+    m_remembered_cells.clear_with_capacity();
+}
 
-    for (auto* block : empty_blocks) {
+void Heap::remember(Badge<Cell>, Cell& cell)
+{
+    ASSERT(cell.is_marked());
+    cell.set_remembered(true);
+    m_remembered_cells.append(&cell);
+}
+
+class WriteBarrierVerifier final : public Cell::Visitor {
+public:
+    explicit WriteBarrierVerifier(Cell& old_cell)
+        : m_old_cell(old_cell)
+    {
+    }
+
+    virtual void visit_impl(Cell* cell)
+    {
+        if (cell->is_marked())
+            return;
+        dbg() << "Missing write barrier: " << &m_old_cell << " points to young " << cell;
+        ASSERT_NOT_REACHED();
+    }
+
+private:
+    Cell& m_old_cell;
+};
+
+void Heap::verify_write_barriers()
+{
+    for (auto* block : m_blocks) {
+        block->for_each_cell([&](Cell* cell) {
+            if (!cell->is_live() || !cell->is_marked() || cell->is_remembered())
+                return;
+            WriteBarrierVerifier verifier(*cell);
+            cell->visit_children(verifier);
+        });
+    }
+}
+
+void Heap::sweep_block(HeapBlock& block, bool keep_if_empty)
+{
+    ++s_sweep_count;
+
+    bool block_has_live_cells = false;
+    block.for_each_cell([&](Cell* cell) {
+        if (cell->is_live()) {
+            if (!cell->is_marked()) {
 #ifdef HEAP_DEBUG
-        dbg() << " - Reclaim HeapBlock @ " << block << ": cell_size=" << block->cell_size();
+                dbg() << "  ~ " << cell;
 #endif
-        m_blocks.remove_first_matching([block](auto& entry) { return entry == block; });
+                block.deallocate(cell);
+            } else {
+                // Survivors keep their mark bit. That's what makes them old.
+                block_has_live_cells = true;
+            }
+        }
+    });
+
+    if (!block_has_live_cells && !keep_if_empty) {
+        destroy_block(block);
+        return;
     }
 
+    auto& size_class = size_class_for(block.cell_size());
+    if (block.has_free_cells())
+        size_class.usable_blocks.append(block);
+    else
+        size_class.unswept_blocks.remove(block);
+}
+
+void Heap::finish_sweeping()
+{
 #ifdef HEAP_DEBUG
-    for (auto& block : m_blocks) {
-        dbg() << " > Live HeapBlock @ " << block << ": cell_size=" << block->cell_size();
-    }
+    dbg() << "finish_sweeping:";
 #endif
+    for (auto& size_class : m_size_classes) {
+        if (!size_class)
+            continue;
+        while (auto* block = size_class->unswept_blocks.first())
+            sweep_block(*block, false);
+    }
 }
 
 void Heap::did_create_handle(Badge<HandleImpl>, HandleImpl& impl)
 {
-    ASSERT(!m_handles.contains(&impl));
-    m_handles.set(&impl);
+    ASSERT(!m_handles.contains(impl));
+    m_handles.append(impl);
 }
 
 void Heap::did_destroy_handle(Badge<HandleImpl>, HandleImpl& impl)
 {
-    ASSERT(m_handles.contains(&impl));
-    m_handles.remove(&impl);
+    ASSERT(m_handles.contains(impl));
+    m_handles.remove(impl);
 }
 
 void Heap::did_create_marked_value_list(Badge<MarkedValueList>, MarkedValueList& list)
 {
-    ASSERT(!m_marked_value_lists.contains(&list));
-    m_marked_value_lists.set(&list);
+    ASSERT(!m_marked_value_lists.contains(list));
+    m_marked_value_lists.append(list);
 }
 
 void Heap::did_destroy_marked_value_list(Badge<MarkedValueList>, MarkedValueList& list)
 {
-    ASSERT(m_marked_value_lists.contains(&list));
-    m_marked_value_lists.remove(&list);
+    ASSERT(m_marked_value_lists.contains(list));
+    m_marked_value_lists.remove(list);
 }
 
 void Heap::defer_gc(Badge<DeferGC>)
@@ -301,14 +528,7 @@ void Heap::defer_gc(Badge<DeferGC>)
 
 void Heap::undefer_gc(Badge<DeferGC>)
 {
-    ASSERT(m_gc_deferrals > 0);
-    --m_gc_deferrals;
-
-    if (!m_gc_deferrals) {
-        if (m_should_gc_when_deferral_ends)
-            collect_garbage();
-        m_should_gc_when_deferral_ends = false;
-    }
+    end_gc_deferral();
 }
 
 }
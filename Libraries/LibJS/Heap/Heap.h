@@ -26,14 +26,19 @@
 
 #pragma once
 
+#include <AK/HashMap.h>
 #include <AK/HashTable.h>
+#include <AK/IntrusiveList.h>
 #include <AK/Noncopyable.h>
 #include <AK/NonnullOwnPtr.h>
+#include <AK/OwnPtr.h>
 #include <AK/Types.h>
 #include <AK/Vector.h>
 #include <LibJS/Forward.h>
 #include <LibJS/Heap/Handle.h>
+#include <LibJS/Heap/HeapBlock.h>
 #include <LibJS/Runtime/Cell.h>
+#include <LibJS/Runtime/MarkedValueList.h>
 
 namespace JS {
 
@@ -45,26 +50,41 @@ public:
     explicit Heap(Interpreter&);
     ~Heap();
 
+    // Collections are deferred while a cell is being constructed and initialized, so it can't be promoted
+    // to the old generation halfway through. Constructors and initialize() don't need write barriers.
     template<typename T, typename... Args>
     T* allocate_without_global_object(Args&&... args)
     {
         auto* memory = allocate_cell(sizeof(T));
+        ++m_gc_deferrals;
         new (memory) T(forward<Args>(args)...);
-        return static_cast<T*>(memory);
+        auto* cell = static_cast<T*>(memory);
+        if (m_should_record_allocation_statistics)
+            did_allocate(*cell);
+        end_gc_deferral();
+        return cell;
     }
 
     template<typename T, typename... Args>
     T* allocate(GlobalObject& global_object, Args&&... args)
     {
         auto* memory = allocate_cell(sizeof(T));
+        ++m_gc_deferrals;
         new (memory) T(forward<Args>(args)...);
         auto* cell = static_cast<T*>(memory);
+        if (m_should_record_allocation_statistics)
+            did_allocate(*cell);
         cell->initialize(global_object);
+        end_gc_deferral();
         return cell;
     }
 
     enum class CollectionType {
+        // Collects the young generation, or the whole heap if enough cells have been promoted since the last full collection.
         CollectGarbage,
+        // Collects the whole heap.
+        CollectAllGarbage,
+        // Frees every cell, reachable or not.
         CollectEverything,
     };
 
@@ -75,6 +95,25 @@ public:
     bool should_collect_on_every_allocation() const { return m_should_collect_on_every_allocation; }
     void set_should_collect_on_every_allocation(bool b) { m_should_collect_on_every_allocation = b; }
 
+    bool should_record_allocation_statistics() const { return m_should_record_allocation_statistics; }
+    void set_should_record_allocation_statistics(bool b) { m_should_record_allocation_statistics = b; }
+    void dump_statistics() const;
+
+    struct CollectionStatistics {
+        static constexpr size_t pause_histogram_size = 20;
+
+        size_t collection_count { 0 };
+        size_t full_collection_count { 0 };
+        size_t cells_promoted { 0 };
+        u64 total_pause_microseconds { 0 };
+        u64 longest_pause_microseconds { 0 };
+        // Bucket N counts the pauses that took [2^N, 2^(N+1)) microseconds. The last bucket has no upper bound.
+        size_t pause_histogram[pause_histogram_size] {};
+        size_t blocks_swept_during_allocation { 0 };
+    };
+
+    const CollectionStatistics& collection_statistics() const { return m_collection_statistics; }
+
     void did_create_handle(Badge<HandleImpl>, HandleImpl&);
     void did_destroy_handle(Badge<HandleImpl>, HandleImpl&);
 
@@ -84,26 +123,72 @@ public:
     void defer_gc(Badge<DeferGC>);
     void undefer_gc(Badge<DeferGC>);
 
+    // Called by Cell::write_barrier() when a cell of the old generation may have been made to point
+    // to a young one. The next minor collection treats the cell's children as roots.
+    void remember(Badge<Cell>, Cell&);
+
+    // Incremented whenever any heap frees cells, so caches holding raw cell pointers know when to forget them.
+    static size_t sweep_count() { return s_sweep_count; }
+
 private:
+    static size_t s_sweep_count;
+
+    struct SizeClass {
+        // Swept blocks with at least one free cell.
+        IntrusiveList<HeapBlock, &HeapBlock::m_list_node> usable_blocks;
+        // Blocks that may still hold cells the last collection found dead.
+        IntrusiveList<HeapBlock, &HeapBlock::m_list_node> unswept_blocks;
+        size_t block_count { 0 };
+        size_t allocation_count { 0 };
+    };
+
+    static size_t cell_size_for(size_t size) { return round_up_to_power_of_two(size, 16); }
+    SizeClass& size_class_for(size_t cell_size);
+
     Cell* allocate_cell(size_t);
+    void did_allocate(const Cell&);
+    void destroy_block(HeapBlock&);
+
+    void end_gc_deferral()
+    {
+        ASSERT(m_gc_deferrals > 0);
+        if (!--m_gc_deferrals && m_should_gc_when_deferral_ends) {
+            m_should_gc_when_deferral_ends = false;
+            collect_garbage();
+        }
+    }
 
     void gather_roots(HashTable<Cell*>&);
     void gather_conservative_roots(HashTable<Cell*>&);
-    void mark_live_cells(const HashTable<Cell*>& live_cells);
-    void sweep_dead_cells();
+    size_t mark_live_cells(const HashTable<Cell*>& live_cells, bool full_collection);
+    void clear_marks();
+    void verify_write_barriers();
+    void sweep_block(HeapBlock&, bool keep_if_empty);
+    void finish_sweeping();
+    void did_pause(u64 microseconds);
 
     Cell* cell_from_possible_pointer(FlatPtr);
 
     size_t m_max_allocations_between_gc { 10000 };
     size_t m_allocations_since_last_gc { false };
 
+    // A full collection is due once the old generation has grown by as many cells as survived the last one.
+    static constexpr size_t min_promotions_between_full_gc = 10000;
+    size_t m_cells_promoted_since_full_gc { 0 };
+    size_t m_cells_alive_after_full_gc { 0 };
+    Vector<Cell*> m_remembered_cells;
+
     bool m_should_collect_on_every_allocation { false };
+    bool m_should_record_allocation_statistics { false };
 
     Interpreter& m_interpreter;
-    Vector<NonnullOwnPtr<HeapBlock>> m_blocks;
-    HashTable<HandleImpl*> m_handles;
-
-    HashTable<MarkedValueList*> m_marked_value_lists;
+    HashTable<HeapBlock*> m_blocks;
+    Vector<OwnPtr<SizeClass>> m_size_classes;
+    HashMap<const char*, size_t> m_allocation_counts;
+    CollectionStatistics m_collection_statistics;
+    // Handles and argument lists come and go on every native call, so they link themselves in rather than being hashed.
+    IntrusiveList<HandleImpl, &HandleImpl::m_list_node> m_handles;
+    IntrusiveList<MarkedValueList, &MarkedValueList::m_list_node> m_marked_value_lists;
 
     size_t m_gc_deferrals { 0 };
     bool m_should_gc_when_deferral_ends { false };
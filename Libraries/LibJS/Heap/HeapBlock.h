@@ -26,6 +26,7 @@
 
 #pragma once
 
+#include <AK/IntrusiveList.h>
 #include <AK/Types.h>
 #include <LibJS/Forward.h>
 #include <LibJS/Runtime/Cell.h>
@@ -39,9 +40,14 @@ public:
 
     void operator delete(void*);
 
+    // Links this block into one of its size class's block lists in the Heap.
+    IntrusiveListNode m_list_node;
+
     size_t cell_size() const { return m_cell_size; }
     size_t cell_count() const { return (block_size - sizeof(HeapBlock)) / m_cell_size; }
 
+    bool has_free_cells() const { return m_freelist; }
+
     Cell* allocate();
     void deallocate(Cell*);
 
@@ -64,6 +70,8 @@ public:
         if (pointer < reinterpret_cast<FlatPtr>(m_storage))
             return nullptr;
         size_t cell_index = (pointer - reinterpret_cast<FlatPtr>(m_storage)) / m_cell_size;
+        if (cell_index >= cell_count())
+            return nullptr;
         return cell(cell_index);
     }
 
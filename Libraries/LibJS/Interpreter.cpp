@@ -27,6 +27,7 @@
 #include <AK/Badge.h>
 #include <AK/StringBuilder.h>
 #include <LibJS/AST.h>
+#include <LibJS/Bytecode/Interpreter.h>
 #include <LibJS/Interpreter.h>
 #include <LibJS/Runtime/Error.h>
 #include <LibJS/Runtime/GlobalObject.h>
@@ -81,19 +82,27 @@ Value Interpreter::run(GlobalObject& global_object, const Statement& statement,
     auto& block = static_cast<const ScopeNode&>(statement);
     enter_scope(block, move(arguments), scope_type, global_object);
 
-    if (block.children().is_empty())
-        m_last_value = js_undefined();
-
-    for (auto& node : block.children()) {
-        m_last_value = node.execute(*this, global_object);
-        if (should_unwind()) {
-            if (should_unwind_until(ScopeType::Breakable, block.label()))
-                stop_unwind();
-            break;
+    bool did_return = false;
+
+    if (m_bytecode_enabled && (block.is_program() || scope_type == ScopeType::Function)) {
+        Bytecode::Interpreter bytecode_interpreter(*this, global_object);
+        m_last_value = bytecode_interpreter.run(block.bytecode());
+        did_return = bytecode_interpreter.did_return();
+    } else {
+        if (block.children().is_empty())
+            m_last_value = js_undefined();
+
+        for (auto& node : block.children()) {
+            m_last_value = node.execute(*this, global_object);
+            if (should_unwind()) {
+                if (should_unwind_until(ScopeType::Breakable, block.label()))
+                    stop_unwind();
+                break;
+            }
         }
-    }
 
-    bool did_return = m_unwind_until == ScopeType::Function;
+        did_return = m_unwind_until == ScopeType::Function;
+    }
 
     if (m_unwind_until == scope_type)
         m_unwind_until = ScopeType::None;
@@ -106,7 +115,7 @@ Value Interpreter::run(GlobalObject& global_object, const Statement& statement,
 void Interpreter::enter_scope(const ScopeNode& scope_node, ArgumentVector arguments, ScopeType scope_type, GlobalObject& global_object)
 {
     for (auto& declaration : scope_node.functions()) {
-        auto* function = ScriptFunction::create(global_object, declaration.name(), declaration.body(), declaration.parameters(), declaration.function_length(), current_environment());
+        auto* function = ScriptFunction::create(global_object, declaration, current_environment());
         set_variable(declaration.name(), function, global_object);
     }
 
@@ -115,29 +124,31 @@ void Interpreter::enter_scope(const ScopeNode& scope_node, ArgumentVector argume
         return;
     }
 
-    HashMap<FlyString, Variable> scope_variables_with_declaration_kind;
-    scope_variables_with_declaration_kind.ensure_capacity(16);
-
-    for (auto& declaration : scope_node.variables()) {
-        for (auto& declarator : declaration.declarations()) {
-            if (scope_node.is_program()) {
+    RefPtr<EnvironmentLayout> layout;
+    if (scope_node.is_program()) {
+        for (auto& declaration : scope_node.variables()) {
+            for (auto& declarator : declaration.declarations()) {
                 global_object.put(declarator.id().string(), js_undefined());
                 if (exception())
                     return;
-            } else {
-                scope_variables_with_declaration_kind.set(declarator.id().string(), { js_undefined(), declaration.declaration_kind() });
             }
         }
+    } else {
+        layout = &scope_node.environment_layout();
     }
 
-    for (auto& argument : arguments) {
-        scope_variables_with_declaration_kind.set(argument.name, { argument.value, DeclarationKind::Var });
+    if (!arguments.is_empty()) {
+        layout = layout ? layout->clone() : EnvironmentLayout::create();
+        for (auto& argument : arguments)
+            layout->add(argument.name, DeclarationKind::Var);
     }
 
     bool pushed_lexical_environment = false;
 
-    if (!scope_variables_with_declaration_kind.is_empty()) {
-        auto* block_lexical_environment = heap().allocate<LexicalEnvironment>(global_object, move(scope_variables_with_declaration_kind), current_environment());
+    if (layout && !layout->is_empty()) {
+        auto* block_lexical_environment = heap().allocate<LexicalEnvironment>(global_object, *layout, current_environment());
+        for (auto& argument : arguments)
+            block_lexical_environment->set(argument.name, { argument.value, DeclarationKind::Var });
         m_call_stack.last().environment = block_lexical_environment;
         pushed_lexical_environment = true;
     }
@@ -195,6 +206,30 @@ Value Interpreter::get_variable(const FlyString& name, GlobalObject& global_obje
     return value;
 }
 
+LexicalEnvironment& Interpreter::environment_at(const EnvironmentCoordinate& coordinate)
+{
+    auto* environment = current_environment();
+    for (u32 i = 0; i < coordinate.hops; ++i)
+        environment = environment->parent();
+    ASSERT(environment);
+    return *environment;
+}
+
+Value Interpreter::get_variable(const EnvironmentCoordinate& coordinate)
+{
+    return environment_at(coordinate).value_at(coordinate.index);
+}
+
+void Interpreter::set_variable(const EnvironmentCoordinate& coordinate, Value value, bool first_assignment)
+{
+    auto& environment = environment_at(coordinate);
+    if (!first_assignment && environment.declaration_kind_at(coordinate.index) == DeclarationKind::Const) {
+        throw_exception<TypeError>(ErrorType::InvalidAssignToConst);
+        return;
+    }
+    environment.set_value_at(coordinate.index, value);
+}
+
 Reference Interpreter::get_reference(const FlyString& name)
 {
     if (m_call_stack.size()) {
@@ -34,6 +34,7 @@
 #include <LibJS/AST.h>
 #include <LibJS/Console.h>
 #include <LibJS/Forward.h>
+#include <LibJS/Heap/DeferGC.h>
 #include <LibJS/Heap/Heap.h>
 #include <LibJS/Runtime/ErrorTypes.h>
 #include <LibJS/Runtime/Exception.h>
@@ -61,7 +62,8 @@ struct ScopeFrame {
 struct CallFrame {
     FlyString function_name;
     Value this_value;
-    Vector<Value> arguments;
+    // Most calls pass only a few arguments; keep those in the frame rather than in a separate allocation.
+    Vector<Value, 8> arguments;
     LexicalEnvironment* environment { nullptr };
 };
 
@@ -78,6 +80,8 @@ public:
     static NonnullOwnPtr<Interpreter> create(Args&&... args)
     {
         auto interpreter = adopt_own(*new Interpreter);
+        // The global object fills in its fields in initialize(), which write barriers don't cover.
+        DeferGC defer_gc(interpreter->heap());
         interpreter->m_global_object = interpreter->heap().allocate_without_global_object<GlobalObjectType>(forward<Args>(args)...);
         static_cast<GlobalObjectType*>(interpreter->m_global_object)->initialize();
         return interpreter;
@@ -109,6 +113,10 @@ public:
     Value get_variable(const FlyString& name, GlobalObject&);
     void set_variable(const FlyString& name, Value, GlobalObject&, bool first_assignment = false);
 
+    // Direct access to a binding whose slot was resolved by the scope analysis.
+    Value get_variable(const EnvironmentCoordinate&);
+    void set_variable(const EnvironmentCoordinate&, Value, bool first_assignment = false);
+
     Reference get_reference(const FlyString& name);
 
     Symbol* get_global_symbol(const String& description);
@@ -198,6 +206,10 @@ public:
     bool underscore_is_last_value() const { return m_underscore_is_last_value; }
     void set_underscore_is_last_value(bool b) { m_underscore_is_last_value = b; }
 
+    // Run programs and function bodies as bytecode instead of walking the AST.
+    bool bytecode_enabled() const { return m_bytecode_enabled; }
+    void set_bytecode_enabled(bool enabled) { m_bytecode_enabled = enabled; }
+
     Console& console() { return m_console; }
     const Console& console() const { return m_console; }
 
@@ -215,6 +227,8 @@ public:
 private:
     Interpreter();
 
+    LexicalEnvironment& environment_at(const EnvironmentCoordinate&);
+
     Heap m_heap;
 
     Value m_last_value;
@@ -230,6 +244,7 @@ private:
     FlyString m_unwind_until_label;
 
     bool m_underscore_is_last_value { false };
+    bool m_bytecode_enabled { false };
 
     Console m_console;
 
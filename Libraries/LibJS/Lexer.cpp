@@ -38,8 +38,16 @@ HashMap<String, TokenType> Lexer::s_two_char_tokens;
 HashMap<char, TokenType> Lexer::s_single_char_tokens;
 
 Lexer::Lexer(StringView source)
+    : Lexer(source, 0, 1, 1)
+{
+}
+
+Lexer::Lexer(StringView source, size_t offset, size_t line_number, size_t line_column)
     : m_source(source)
+    , m_position(offset)
     , m_current_token(TokenType::Eof, StringView(nullptr), StringView(nullptr), 0, 0)
+    , m_line_number(line_number)
+    , m_line_column(line_column - 1)
 {
     if (s_keywords.is_empty()) {
         s_keywords.set("await", TokenType::Await);
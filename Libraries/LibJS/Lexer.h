@@ -37,9 +37,13 @@ namespace JS {
 class Lexer {
 public:
     explicit Lexer(StringView source);
+    // Starts lexing at an offset into the source, with the position of the character found there.
+    Lexer(StringView source, size_t offset, size_t line_number, size_t line_column);
 
     Token next();
 
+    const StringView& source() const { return m_source; }
+
 private:
     void consume();
     void consume_exponent();
@@ -29,6 +29,7 @@
 #include <AK/HashMap.h>
 #include <AK/ScopeGuard.h>
 #include <AK/StdLibExtras.h>
+#include <LibJS/ScopeAnalysis.h>
 
 namespace JS {
 
@@ -74,7 +75,8 @@ Parser::ParserState::ParserState(Lexer lexer)
 }
 
 Parser::Parser(Lexer lexer)
-    : m_parser_state(move(lexer))
+    : m_node_arena(ArenaAllocator::create())
+    , m_parser_state(move(lexer))
 {
     if (g_operator_precedence.is_empty()) {
         // https://developer.mozilla.org/en-US/docs/Web/JavaScript/Reference/Operators/Operator_Precedence
@@ -237,6 +239,8 @@ NonnullRefPtr<Program> Parser::parse_program()
     } else {
         syntax_error("Unclosed scope");
     }
+    if (!has_errors())
+        ScopeAnalysis::analyze(*program);
     return program;
 }
 
@@ -372,6 +376,13 @@ RefPtr<FunctionExpression> Parser::try_parse_arrow_function_expression(bool expe
     if (function_length == -1)
         function_length = parameters.size();
 
+    if (m_parse_function_bodies_lazily && match(TokenType::CurlyOpen)) {
+        auto lazy_body = preparse_function_body(true);
+        state_rollback_guard.disarm();
+        m_parser_state.m_var_scopes.take_last();
+        return create_ast_node<FunctionExpression>("", move(lazy_body), move(parameters), function_length, true);
+    }
+
     auto function_body_result = [this]() -> RefPtr<BlockStatement> {
         if (match(TokenType::CurlyOpen)) {
             // Parse a function body with statements
@@ -861,7 +872,7 @@ NonnullRefPtr<TemplateLiteral> Parser::parse_template_literal(bool is_tagged)
     NonnullRefPtrVector<Expression> expressions;
     NonnullRefPtrVector<Expression> raw_strings;
 
-    auto append_empty_string = [&expressions, &raw_strings, is_tagged]() {
+    auto append_empty_string = [this, &expressions, &raw_strings, is_tagged]() {
         auto string_literal = create_ast_node<StringLiteral>("");
         expressions.append(string_literal);
         if (is_tagged)
@@ -1226,6 +1237,14 @@ NonnullRefPtr<FunctionNodeType> Parser::parse_function_node(bool check_for_funct
 
     ScopePusher scope(*this, ScopePusher::Var | ScopePusher::Function);
 
+    // Like (function() { ... })(), which would be parsed twice in a row otherwise.
+    bool is_likely_invoked_right_away = false;
+    if (check_for_function_and_name && m_parse_function_bodies_lazily) {
+        auto& token = m_parser_state.m_current_token;
+        auto offset = source_offset_of(token) - token.trivia().length();
+        is_likely_invoked_right_away = offset > 0 && m_parser_state.m_lexer.source()[offset - 1] == '(';
+    }
+
     if (check_for_function_and_name)
         consume(TokenType::Function);
 
@@ -1266,6 +1285,11 @@ NonnullRefPtr<FunctionNodeType> Parser::parse_function_node(bool check_for_funct
     if (function_length == -1)
         function_length = parameters.size();
 
+    if (m_parse_function_bodies_lazily && !is_likely_invoked_right_away) {
+        auto lazy_body = preparse_function_body(false);
+        return create_ast_node<FunctionNodeType>(name, move(lazy_body), move(parameters), function_length);
+    }
+
     auto body = parse_block_statement();
     body->add_variables(m_parser_state.m_var_scopes.last());
     body->add_functions(m_parser_state.m_function_scopes.last());
@@ -1767,6 +1791,113 @@ void Parser::syntax_error(const String& message, size_t line, size_t column)
     m_parser_state.m_errors.append({ message, line, column });
 }
 
+size_t Parser::source_offset_of(const Token& token) const
+{
+    return token.value().characters_without_null_termination() - m_parser_state.m_lexer.source().characters_without_null_termination();
+}
+
+void Parser::set_parse_function_bodies_lazily(bool parse_function_bodies_lazily)
+{
+    m_parse_function_bodies_lazily = parse_function_bodies_lazily;
+    if (m_parse_function_bodies_lazily && m_source.is_null())
+        m_source = m_parser_state.m_lexer.source();
+}
+
+NonnullRefPtr<LazyFunctionBody> Parser::preparse_function_body(bool is_arrow_function)
+{
+    auto& start_token = m_parser_state.m_current_token;
+    LazyFunctionBody::SourcePosition position { source_offset_of(start_token), start_token.line_number(), start_token.line_column() };
+    auto lazy_body = adopt(*new LazyFunctionBody(m_source, position, is_arrow_function, m_parser_state.m_strict_mode, m_parser_state.m_allow_super_property_lookup, m_parser_state.m_allow_super_constructor_call));
+
+    // The lexer tells regular expressions and template literals apart on its own, so the tokens
+    // are the same as when parsing the body. Everything else is checked on the first call.
+    consume(TokenType::CurlyOpen);
+    Vector<TokenType, 32> closing_tokens;
+    closing_tokens.append(TokenType::CurlyClose);
+    while (!closing_tokens.is_empty()) {
+        auto type = m_parser_state.m_current_token.type();
+        switch (type) {
+        case TokenType::CurlyOpen:
+            closing_tokens.append(TokenType::CurlyClose);
+            break;
+        case TokenType::ParenOpen:
+            closing_tokens.append(TokenType::ParenClose);
+            break;
+        case TokenType::BracketOpen:
+            closing_tokens.append(TokenType::BracketClose);
+            break;
+        case TokenType::TemplateLiteralExprStart:
+            closing_tokens.append(TokenType::TemplateLiteralExprEnd);
+            break;
+        case TokenType::CurlyClose:
+        case TokenType::ParenClose:
+        case TokenType::BracketClose:
+        case TokenType::TemplateLiteralExprEnd:
+        case TokenType::Eof:
+            if (type != closing_tokens.last()) {
+                expected(Token::name(closing_tokens.last()));
+                return lazy_body;
+            }
+            closing_tokens.take_last();
+            break;
+        case TokenType::UnterminatedTemplateLiteral:
+            syntax_error("Unterminated template literal");
+            return lazy_body;
+        case TokenType::Invalid:
+        case TokenType::UnterminatedRegexLiteral:
+        case TokenType::UnterminatedStringLiteral:
+            syntax_error(String::format("Unexpected token %s", m_parser_state.m_current_token.name()));
+            return lazy_body;
+        default:
+            break;
+        }
+        consume();
+    }
+
+    // The body would have ended any "use strict" directive search of the surrounding code.
+    m_parser_state.m_use_strict_directive = UseStrictDirectiveState::None;
+    return lazy_body;
+}
+
+bool LazyFunctionBody::parse()
+{
+    if (m_body)
+        return true;
+    if (!m_syntax_error.is_null())
+        return false;
+
+    Parser parser(Lexer(m_source, m_position.offset, m_position.line_number, m_position.line_column));
+    parser.set_parse_function_bodies_lazily(true);
+    parser.m_parser_state.m_strict_mode = m_strict_mode;
+    parser.m_parser_state.m_allow_super_property_lookup = m_allow_super_property_lookup;
+    parser.m_parser_state.m_allow_super_constructor_call = m_allow_super_constructor_call;
+
+    NonnullRefPtr<BlockStatement> body = [&] {
+        ScopePusher scope(parser, ScopePusher::Var | ScopePusher::Function);
+        auto body = parser.parse_block_statement();
+        // Mirrors Parser::parse_function_node(); arrow functions don't get the variables declared in them.
+        if (!m_is_arrow_function) {
+            body->add_variables(parser.m_parser_state.m_var_scopes.last());
+            body->add_functions(parser.m_parser_state.m_function_scopes.last());
+        }
+        return body;
+    }();
+
+    if (parser.has_errors()) {
+        m_syntax_error = parser.errors()[0].to_string();
+        return false;
+    }
+
+    for (auto& declaration : body->variables()) {
+        for (auto& declarator : declaration.declarations())
+            m_environment_layout->add(declarator.id().string(), DeclarationKind::Var);
+    }
+    if (m_scope_analysis_context)
+        ScopeAnalysis::analyze(*body, *m_scope_analysis_context);
+    m_body = move(body);
+    return true;
+}
+
 void Parser::save_state()
 {
     m_saved_state.append(m_parser_state);
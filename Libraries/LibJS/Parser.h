@@ -26,6 +26,7 @@
 
 #pragma once
 
+#include <AK/ArenaAllocator.h>
 #include <AK/NonnullRefPtr.h>
 #include <AK/StringBuilder.h>
 #include <LibJS/AST.h>
@@ -45,6 +46,11 @@ public:
 
     NonnullRefPtr<Program> parse_program();
 
+    // Only checks that the brackets of function bodies match up, and leaves parsing them to their
+    // first call, see LazyFunctionBody. Functions that look like they get invoked right away are
+    // still parsed completely.
+    void set_parse_function_bodies_lazily(bool);
+
     template<typename FunctionNodeType>
     NonnullRefPtr<FunctionNodeType> parse_function_node(bool check_for_function_and_name = true, bool allow_super_property_lookup = false, bool allow_super_constructor_call = false);
 
@@ -120,6 +126,7 @@ public:
 
 private:
     friend class ScopePusher;
+    friend class LazyFunctionBody;
 
     int operator_precedence(TokenType) const;
     Associativity operator_associativity(TokenType) const;
@@ -140,6 +147,9 @@ private:
     void save_state();
     void load_state();
 
+    size_t source_offset_of(const Token&) const;
+    NonnullRefPtr<LazyFunctionBody> preparse_function_body(bool is_arrow_function);
+
     enum class UseStrictDirectiveState {
         None,
         Looking,
@@ -161,7 +171,19 @@ private:
         explicit ParserState(Lexer);
     };
 
+    // The nodes of a program are allocated together, and (mostly) die together.
+    template<typename T, typename... Args>
+    NonnullRefPtr<T> create_ast_node(Args&&... args)
+    {
+        return m_node_arena->create_object<T>(forward<Args>(args)...);
+    }
+
+    NonnullRefPtr<ArenaAllocator> m_node_arena;
     ParserState m_parser_state;
     Vector<ParserState> m_saved_state;
+
+    bool m_parse_function_bodies_lazily { false };
+    // Kept alive by the lazy function bodies, which parse themselves from it.
+    String m_source;
 };
 }
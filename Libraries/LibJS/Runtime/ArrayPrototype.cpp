@@ -110,6 +110,15 @@ static size_t get_length(Interpreter& interpreter, Object& object)
     return length_property.to_size_t(interpreter);
 }
 
+// A dense array of numbers can be searched without going through Object::get() for every index.
+static const SimpleIndexedPropertyStorage* numeric_elements(const Object& object, size_t length)
+{
+    auto* storage = object.indexed_properties().numeric_storage();
+    if (!storage || storage->array_like_size() != length)
+        return nullptr;
+    return storage;
+}
+
 static void for_each_item(Interpreter& interpreter, GlobalObject& global_object, const String& name, AK::Function<IterationDecision(size_t index, Value value, Value callback_result)> callback, bool skip_empty = true)
 {
     auto* this_object = interpreter.this_value(global_object).to_object(interpreter, global_object);
@@ -437,6 +446,17 @@ JS_DEFINE_NATIVE_FUNCTION(ArrayPrototype::index_of)
             from_index = max(length + from_index, 0);
     }
     auto search_element = interpreter.argument(0);
+    if (auto* storage = numeric_elements(*this_object, length)) {
+        if (!search_element.is_number())
+            return Value(-1);
+        auto& elements = storage->elements();
+        auto number = search_element.as_double();
+        for (i32 i = from_index; i < length; ++i) {
+            if (elements[i].as_double() == number)
+                return Value(i);
+        }
+        return Value(-1);
+    }
     for (i32 i = from_index; i < length; ++i) {
         auto element = this_object->get(i);
         if (interpreter.exception())
@@ -610,6 +630,17 @@ JS_DEFINE_NATIVE_FUNCTION(ArrayPrototype::last_index_of)
             from_index = length + from_index;
     }
     auto search_element = interpreter.argument(0);
+    if (auto* storage = numeric_elements(*this_object, length)) {
+        if (!search_element.is_number())
+            return Value(-1);
+        auto& elements = storage->elements();
+        auto number = search_element.as_double();
+        for (i32 i = from_index; i >= 0; --i) {
+            if (elements[i].as_double() == number)
+                return Value(i);
+        }
+        return Value(-1);
+    }
     for (i32 i = from_index; i >= 0; --i) {
         auto element = this_object->get(i);
         if (interpreter.exception())
@@ -641,6 +672,26 @@ JS_DEFINE_NATIVE_FUNCTION(ArrayPrototype::includes)
             from_index = max(length + from_index, 0);
     }
     auto value_to_find = interpreter.argument(0);
+    if (auto* storage = numeric_elements(*this_object, length)) {
+        if (!value_to_find.is_number())
+            return Value(false);
+        auto& elements = storage->elements();
+        if (value_to_find.is_nan()) {
+            if (storage->element_kind() == SimpleIndexedPropertyStorage::ElementKind::Int32)
+                return Value(false);
+            for (i32 i = from_index; i < length; ++i) {
+                if (elements[i].is_nan())
+                    return Value(true);
+            }
+            return Value(false);
+        }
+        auto number = value_to_find.as_double();
+        for (i32 i = from_index; i < length; ++i) {
+            if (elements[i].as_double() == number)
+                return Value(true);
+        }
+        return Value(false);
+    }
     for (i32 i = from_index; i < length; ++i) {
         auto element = this_object->get(i).value_or(js_undefined());
         if (interpreter.exception())
@@ -46,6 +46,16 @@ public:
     bool is_live() const { return m_live; }
     void set_live(bool b) { m_live = b; }
 
+    bool is_remembered() const { return m_remembered; }
+    void set_remembered(bool b) { m_remembered = b; }
+
+    // Must be called right after storing a reference to another cell in this one, see Heap::remember().
+    void write_barrier()
+    {
+        if (m_mark && !m_remembered)
+            remember();
+    }
+
     virtual const char* class_name() const = 0;
 
     class Visitor {
@@ -67,8 +77,12 @@ protected:
     Cell() { }
 
 private:
+    void remember();
+
+    // Cells that survived a collection stay marked until the next full one. They're the old generation.
     bool m_mark { false };
     bool m_live { true };
+    bool m_remembered { false };
 };
 
 const LogStream& operator<<(const LogStream&, const Cell*);
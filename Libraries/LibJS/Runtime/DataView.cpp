@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <LibJS/Interpreter.h>
+#include <LibJS/Runtime/DataView.h>
+#include <LibJS/Runtime/GlobalObject.h>
+
+namespace JS {
+
+DataView* DataView::create(GlobalObject& global_object, ArrayBuffer& array_buffer, size_t byte_offset, size_t byte_length)
+{
+    auto& interpreter = global_object.interpreter();
+    return interpreter.heap().allocate<DataView>(global_object, array_buffer, byte_offset, byte_length, *global_object.data_view_prototype());
+}
+
+DataView::DataView(ArrayBuffer& array_buffer, size_t byte_offset, size_t byte_length, Object& prototype)
+    : Object(prototype)
+    , m_viewed_array_buffer(&array_buffer)
+    , m_data(array_buffer.buffer().data() + byte_offset)
+    , m_byte_offset(byte_offset)
+    , m_byte_length(byte_length)
+{
+    ASSERT(byte_offset + byte_length <= array_buffer.byte_length());
+}
+
+DataView::~DataView()
+{
+}
+
+void DataView::visit_children(Visitor& visitor)
+{
+    Object::visit_children(visitor);
+    visitor.visit(m_viewed_array_buffer);
+}
+
+}
@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <LibJS/Runtime/ArrayBuffer.h>
+#include <LibJS/Runtime/Object.h>
+
+namespace JS {
+
+class DataView final : public Object {
+    JS_OBJECT(DataView, Object);
+
+public:
+    static DataView* create(GlobalObject&, ArrayBuffer&, size_t byte_offset, size_t byte_length);
+
+    DataView(ArrayBuffer&, size_t byte_offset, size_t byte_length, Object& prototype);
+    virtual ~DataView() override;
+
+    ArrayBuffer& viewed_array_buffer() { return *m_viewed_array_buffer; }
+    size_t byte_offset() const { return m_byte_offset; }
+    size_t byte_length() const { return m_byte_length; }
+
+    u8* data() { return m_data; }
+
+private:
+    virtual bool is_data_view() const override { return true; }
+    virtual void visit_children(Visitor&) override;
+
+    ArrayBuffer* m_viewed_array_buffer { nullptr };
+    u8* m_data { nullptr };
+    size_t m_byte_offset { 0 };
+    size_t m_byte_length { 0 };
+};
+
+}
@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <LibJS/Interpreter.h>
+#include <LibJS/Runtime/DataView.h>
+#include <LibJS/Runtime/DataViewConstructor.h>
+#include <LibJS/Runtime/Error.h>
+#include <LibJS/Runtime/GlobalObject.h>
+
+namespace JS {
+
+DataViewConstructor::DataViewConstructor(GlobalObject& global_object)
+    : NativeFunction("DataView", *global_object.function_prototype())
+{
+}
+
+void DataViewConstructor::initialize(GlobalObject& global_object)
+{
+    NativeFunction::initialize(global_object);
+    define_property("prototype", global_object.data_view_prototype(), 0);
+    define_property("length", Value(1), Attribute::Configurable);
+}
+
+DataViewConstructor::~DataViewConstructor()
+{
+}
+
+Value DataViewConstructor::call(Interpreter& interpreter)
+{
+    return interpreter.throw_exception<TypeError>(ErrorType::CallWithoutNew, "DataView");
+}
+
+Value DataViewConstructor::construct(Interpreter& interpreter, Function&)
+{
+    auto buffer_value = interpreter.argument(0);
+    if (!buffer_value.is_object() || !buffer_value.as_object().is_array_buffer())
+        return interpreter.throw_exception<TypeError>(ErrorType::NotA, "ArrayBuffer");
+    auto& array_buffer = static_cast<ArrayBuffer&>(buffer_value.as_object());
+
+    auto byte_offset = interpreter.argument(1).to_index(interpreter);
+    if (interpreter.exception())
+        return {};
+    if (byte_offset > array_buffer.byte_length())
+        return interpreter.throw_exception<RangeError>(ErrorType::DataViewOutOfRange, byte_offset);
+
+    size_t byte_length = array_buffer.byte_length() - byte_offset;
+    if (!interpreter.argument(2).is_undefined()) {
+        byte_length = interpreter.argument(2).to_index(interpreter);
+        if (interpreter.exception())
+            return {};
+        if ((u64)byte_offset + byte_length > array_buffer.byte_length())
+            return interpreter.throw_exception<RangeError>(ErrorType::DataViewOutOfRange, byte_offset + byte_length);
+    }
+    return DataView::create(global_object(), array_buffer, byte_offset, byte_length);
+}
+
+}
@@ -0,0 +1,250 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <AK/Function.h>
+#include <LibJS/Interpreter.h>
+#include <LibJS/Runtime/DataView.h>
+#include <LibJS/Runtime/DataViewPrototype.h>
+#include <LibJS/Runtime/Error.h>
+#include <LibJS/Runtime/GlobalObject.h>
+#include <LibJS/Runtime/TypedArray.h>
+#include <string.h>
+
+namespace JS {
+
+DataViewPrototype::DataViewPrototype(GlobalObject& global_object)
+    : Object(*global_object.object_prototype())
+{
+}
+
+void DataViewPrototype::initialize(GlobalObject& global_object)
+{
+    Object::initialize(global_object);
+    u8 attr = Attribute::Writable | Attribute::Configurable;
+
+    define_native_property("buffer", buffer_getter, nullptr, Attribute::Configurable);
+    define_native_property("byteLength", byte_length_getter, nullptr, Attribute::Configurable);
+    define_native_property("byteOffset", byte_offset_getter, nullptr, Attribute::Configurable);
+
+    define_native_function("getInt8", get_int8, 1, attr);
+    define_native_function("getUint8", get_uint8, 1, attr);
+    define_native_function("getInt16", get_int16, 1, attr);
+    define_native_function("getUint16", get_uint16, 1, attr);
+    define_native_function("getInt32", get_int32, 1, attr);
+    define_native_function("getUint32", get_uint32, 1, attr);
+    define_native_function("getFloat32", get_float32, 1, attr);
+    define_native_function("getFloat64", get_float64, 1, attr);
+    define_native_function("setInt8", set_int8, 2, attr);
+    define_native_function("setUint8", set_uint8, 2, attr);
+    define_native_function("setInt16", set_int16, 2, attr);
+    define_native_function("setUint16", set_uint16, 2, attr);
+    define_native_function("setInt32", set_int32, 2, attr);
+    define_native_function("setUint32", set_uint32, 2, attr);
+    define_native_function("setFloat32", set_float32, 2, attr);
+    define_native_function("setFloat64", set_float64, 2, attr);
+
+    define_property(global_object.interpreter().well_known_symbol_to_string_tag(), js_string(global_object.heap(), "DataView"), Attribute::Configurable);
+}
+
+DataViewPrototype::~DataViewPrototype()
+{
+}
+
+static DataView* typed_this(Interpreter& interpreter, GlobalObject& global_object)
+{
+    auto* this_object = interpreter.this_value(global_object).to_object(interpreter, global_object);
+    if (!this_object)
+        return nullptr;
+    if (!this_object->is_data_view()) {
+        interpreter.throw_exception<TypeError>(ErrorType::NotA, "DataView");
+        return nullptr;
+    }
+    return static_cast<DataView*>(this_object);
+}
+
+// Validates the byte index argument and returns a pointer to the bytes of the requested element, or nullptr after throwing.
+static u8* element_bytes(Interpreter& interpreter, DataView& data_view, size_t element_size)
+{
+    auto index = interpreter.argument(0).to_index(interpreter);
+    if (interpreter.exception())
+        return nullptr;
+    if ((u64)index + element_size > data_view.byte_length()) {
+        interpreter.throw_exception<RangeError>(ErrorType::DataViewOutOfRange, index);
+        return nullptr;
+    }
+    return data_view.data() + index;
+}
+
+// DataView accesses default to big-endian, so bytes are reversed unless the requested order matches the host's.
+static void copy_bytes(u8* destination, const u8* source, size_t size, bool little_endian)
+{
+    constexpr bool host_is_little_endian = __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__;
+    if (little_endian == host_is_little_endian) {
+        memcpy(destination, source, size);
+        return;
+    }
+    for (size_t i = 0; i < size; ++i)
+        destination[i] = source[size - i - 1];
+}
+
+template<typename T>
+static Value get_view_value(Interpreter& interpreter, GlobalObject& global_object)
+{
+    auto* data_view = typed_this(interpreter, global_object);
+    if (!data_view)
+        return {};
+    auto* bytes = element_bytes(interpreter, *data_view, sizeof(T));
+    if (!bytes)
+        return {};
+    auto little_endian = interpreter.argument(1).to_boolean();
+    T value;
+    copy_bytes(reinterpret_cast<u8*>(&value), bytes, sizeof(T), little_endian);
+    return Value(static_cast<double>(value));
+}
+
+template<typename T>
+static Value set_view_value(Interpreter& interpreter, GlobalObject& global_object)
+{
+    auto* data_view = typed_this(interpreter, global_object);
+    if (!data_view)
+        return {};
+    auto* bytes = element_bytes(interpreter, *data_view, sizeof(T));
+    if (!bytes)
+        return {};
+    auto number = interpreter.argument(1).to_number(interpreter);
+    if (interpreter.exception())
+        return {};
+    auto little_endian = interpreter.argument(2).to_boolean();
+    auto value = number_to_element<T>(number.as_double());
+    copy_bytes(bytes, reinterpret_cast<const u8*>(&value), sizeof(T), little_endian);
+    return js_undefined();
+}
+
+JS_DEFINE_NATIVE_GETTER(DataViewPrototype::buffer_getter)
+{
+    auto* data_view = typed_this(interpreter, global_object);
+    if (!data_view)
+        return {};
+    return &data_view->viewed_array_buffer();
+}
+
+JS_DEFINE_NATIVE_GETTER(DataViewPrototype::byte_length_getter)
+{
+    auto* data_view = typed_this(interpreter, global_object);
+    if (!data_view)
+        return {};
+    return Value((double)data_view->byte_length());
+}
+
+JS_DEFINE_NATIVE_GETTER(DataViewPrototype::byte_offset_getter)
+{
+    auto* data_view = typed_this(interpreter, global_object);
+    if (!data_view)
+        return {};
+    return Value((double)data_view->byte_offset());
+}
+
+JS_DEFINE_NATIVE_FUNCTION(DataViewPrototype::get_int8)
+{
+    return get_view_value<i8>(interpreter, global_object);
+}
+
+JS_DEFINE_NATIVE_FUNCTION(DataViewPrototype::get_uint8)
+{
+    return get_view_value<u8>(interpreter, global_object);
+}
+
+JS_DEFINE_NATIVE_FUNCTION(DataViewPrototype::get_int16)
+{
+    return get_view_value<i16>(interpreter, global_object);
+}
+
+JS_DEFINE_NATIVE_FUNCTION(DataViewPrototype::get_uint16)
+{
+    return get_view_value<u16>(interpreter, global_object);
+}
+
+JS_DEFINE_NATIVE_FUNCTION(DataViewPrototype::get_int32)
+{
+    return get_view_value<i32>(interpreter, global_object);
+}
+
+JS_DEFINE_NATIVE_FUNCTION(DataViewPrototype::get_uint32)
+{
+    return get_view_value<u32>(interpreter, global_object);
+}
+
+JS_DEFINE_NATIVE_FUNCTION(DataViewPrototype::get_float32)
+{
+    return get_view_value<float>(interpreter, global_object);
+}
+
+JS_DEFINE_NATIVE_FUNCTION(DataViewPrototype::get_float64)
+{
+    return get_view_value<double>(interpreter, global_object);
+}
+
+JS_DEFINE_NATIVE_FUNCTION(DataViewPrototype::set_int8)
+{
+    return set_view_value<i8>(interpreter, global_object);
+}
+
+JS_DEFINE_NATIVE_FUNCTION(DataViewPrototype::set_uint8)
+{
+    return set_view_value<u8>(interpreter, global_object);
+}
+
+JS_DEFINE_NATIVE_FUNCTION(DataViewPrototype::set_int16)
+{
+    return set_view_value<i16>(interpreter, global_object);
+}
+
+JS_DEFINE_NATIVE_FUNCTION(DataViewPrototype::set_uint16)
+{
+    return set_view_value<u16>(interpreter, global_object);
+}
+
+JS_DEFINE_NATIVE_FUNCTION(DataViewPrototype::set_int32)
+{
+    return set_view_value<i32>(interpreter, global_object);
+}
+
+JS_DEFINE_NATIVE_FUNCTION(DataViewPrototype::set_uint32)
+{
+    return set_view_value<u32>(interpreter, global_object);
+}
+
+JS_DEFINE_NATIVE_FUNCTION(DataViewPrototype::set_float32)
+{
+    return set_view_value<float>(interpreter, global_object);
+}
+
+JS_DEFINE_NATIVE_FUNCTION(DataViewPrototype::set_float64)
+{
+    return set_view_value<double>(interpreter, global_object);
+}
+
+}
@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <LibJS/Runtime/Object.h>
+
+namespace JS {
+
+class DataViewPrototype final : public Object {
+    JS_OBJECT(DataViewPrototype, Object);
+
+public:
+    explicit DataViewPrototype(GlobalObject&);
+    virtual void initialize(GlobalObject&) override;
+    virtual ~DataViewPrototype() override;
+
+private:
+    JS_DECLARE_NATIVE_GETTER(buffer_getter);
+    JS_DECLARE_NATIVE_GETTER(byte_length_getter);
+    JS_DECLARE_NATIVE_GETTER(byte_offset_getter);
+
+    JS_DECLARE_NATIVE_FUNCTION(get_int8);
+    JS_DECLARE_NATIVE_FUNCTION(get_uint8);
+    JS_DECLARE_NATIVE_FUNCTION(get_int16);
+    JS_DECLARE_NATIVE_FUNCTION(get_uint16);
+    JS_DECLARE_NATIVE_FUNCTION(get_int32);
+    JS_DECLARE_NATIVE_FUNCTION(get_uint32);
+    JS_DECLARE_NATIVE_FUNCTION(get_float32);
+    JS_DECLARE_NATIVE_FUNCTION(get_float64);
+    JS_DECLARE_NATIVE_FUNCTION(set_int8);
+    JS_DECLARE_NATIVE_FUNCTION(set_uint8);
+    JS_DECLARE_NATIVE_FUNCTION(set_int16);
+    JS_DECLARE_NATIVE_FUNCTION(set_uint16);
+    JS_DECLARE_NATIVE_FUNCTION(set_int32);
+    JS_DECLARE_NATIVE_FUNCTION(set_uint32);
+    JS_DECLARE_NATIVE_FUNCTION(set_float32);
+    JS_DECLARE_NATIVE_FUNCTION(set_float64);
+};
+
+}
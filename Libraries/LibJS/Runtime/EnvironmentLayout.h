@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/FlyString.h>
+#include <AK/HashMap.h>
+#include <AK/RefCounted.h>
+#include <AK/Vector.h>
+#include <LibJS/Forward.h>
+
+namespace JS {
+
+// The position of a binding as found by the scope analysis: the number of parent
+// environments to skip from the current one, and the slot within that environment.
+struct EnvironmentCoordinate {
+    u32 hops { 0 };
+    u32 index { 0 };
+};
+
+// The names and declaration kinds of the bindings of a LexicalEnvironment, in slot order.
+// Layouts are computed once per scope and shared by every environment created for it.
+class EnvironmentLayout : public RefCounted<EnvironmentLayout> {
+public:
+    static NonnullRefPtr<EnvironmentLayout> create() { return adopt(*new EnvironmentLayout); }
+    NonnullRefPtr<EnvironmentLayout> clone() const;
+
+    size_t size() const { return m_slots.size(); }
+    bool is_empty() const { return m_slots.is_empty(); }
+
+    const FlyString& name_at(size_t index) const { return m_slots[index].name; }
+    DeclarationKind declaration_kind_at(size_t index) const { return m_slots[index].declaration_kind; }
+    Optional<u32> index_of(const FlyString& name) const { return m_indices.get(name); }
+
+    // Adding a name that's already in the layout replaces its declaration kind but keeps its slot.
+    u32 add(const FlyString& name, DeclarationKind);
+
+private:
+    EnvironmentLayout() { }
+
+    struct Slot {
+        FlyString name;
+        DeclarationKind declaration_kind;
+    };
+
+    Vector<Slot> m_slots;
+    HashMap<FlyString, u32> m_indices;
+};
+
+}
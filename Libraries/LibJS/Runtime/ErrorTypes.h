@@ -32,18 +32,22 @@
     M(ArrayPrototypeOneArg, "Array.prototype.%s() requires at least one argument")                     \
     M(AccessorBadField, "Accessor descriptor's '%s' field must be a function or undefined")            \
     M(AccessorValueOrWritable, "Accessor property descriptor cannot specify a value or writable key")  \
+    M(ArrayBufferInvalidLength, "Invalid array buffer length")                                         \
     M(BigIntBadOperator, "Cannot use %s operator with BigInt")                                         \
     M(BigIntBadOperatorOtherType, "Cannot use %s operator with BigInt and other type")                 \
     M(BigIntIntArgument, "BigInt argument must be an integer")                                         \
     M(BigIntInvalidValue, "Invalid value for BigInt: %s")                                              \
+    M(CallWithoutNew, "%s constructor must be called with 'new'")                                      \
     M(ClassDoesNotExtendAConstructorOrNull, "Class extends value %s is not a constructor or null")     \
     M(Convert, "Cannot convert %s to %s")                                                              \
     M(ConvertUndefinedToObject, "Cannot convert undefined to object")                                  \
+    M(DataViewOutOfRange, "Offset %zu is outside the bounds of the DataView")                          \
     M(DescChangeNonConfigurable, "Cannot change attributes of non-configurable property '%s'")         \
     M(FunctionArgsNotObject, "Argument array must be an object")                                       \
     M(InOperatorWithObject, "'in' operator must be used on an object")                                 \
     M(InstanceOfOperatorBadPrototype, "'prototype' property of %s is not an object")                   \
     M(InvalidAssignToConst, "Invalid assignment to const variable")                                    \
+    M(InvalidIndex, "Index must be a non-negative integer")                                            \
     M(InvalidLeftHandAssignment, "Invalid left-hand side in assignment")                               \
     M(InvalidRadix, "Radix must be an integer no less than 2, and no greater than 36")                 \
     M(IsNotA, "%s is not a %s")                                                                        \
@@ -145,8 +149,14 @@
     M(ReflectBadArgumentsList, "Arguments list must be an object")                                     \
     M(ReflectBadNewTarget, "Optional third argument of Reflect.construct() must be a constructor")     \
     M(ReflectBadDescriptorArgument, "Descriptor argument is not an object")                            \
+    M(RegExpCompileError, "Invalid regular expression /%s/: %s")                                       \
+    M(RegExpObjectBadFlag, "Invalid RegExp flag '%c'")                                                 \
+    M(RegExpObjectRepeatedFlag, "Repeated RegExp flag '%c'")                                           \
     M(StringRawCannotConvert, "Cannot convert property 'raw' to object from %s")                       \
     M(StringRepeatCountMustBe, "repeat count must be a %s number")                                     \
+    M(TypedArrayInvalidBufferLength, "Byte length of %s should be a multiple of %zu")                  \
+    M(TypedArrayInvalidByteOffset, "Start offset of %s should be a multiple of %zu")                   \
+    M(TypedArrayOutOfRange, "%s range is outside the bounds of its ArrayBuffer")                       \
     M(ThisHasNotBeenInitialized, "|this| has not been initialized")                                    \
     M(ThisIsAlreadyInitialized, "|this| is already initialized")                                       \
     M(ToObjectNullOrUndef, "ToObject on null or undefined")                                            \
@@ -32,6 +32,7 @@
 #include <LibJS/Runtime/FunctionConstructor.h>
 #include <LibJS/Runtime/GlobalObject.h>
 #include <LibJS/Runtime/ScriptFunction.h>
+#include <LibJS/ScopeAnalysis.h>
 
 namespace JS {
 
@@ -87,6 +88,7 @@ Value FunctionConstructor::construct(Interpreter& interpreter, Function&)
         interpreter.throw_exception<SyntaxError>(error.to_string());
         return {};
     }
+    ScopeAnalysis::analyze(*function_expression);
     return function_expression->execute(interpreter, global_object());
 }
 
@@ -27,6 +27,8 @@
 
 #include <AK/LogStream.h>
 #include <LibJS/Interpreter.h>
+#include <LibJS/Runtime/ArrayBufferConstructor.h>
+#include <LibJS/Runtime/ArrayBufferPrototype.h>
 #include <LibJS/Runtime/ArrayConstructor.h>
 #include <LibJS/Runtime/ArrayIteratorPrototype.h>
 #include <LibJS/Runtime/ArrayPrototype.h>
@@ -35,6 +37,8 @@
 #include <LibJS/Runtime/BooleanConstructor.h>
 #include <LibJS/Runtime/BooleanPrototype.h>
 #include <LibJS/Runtime/ConsoleObject.h>
+#include <LibJS/Runtime/DataViewConstructor.h>
+#include <LibJS/Runtime/DataViewPrototype.h>
 #include <LibJS/Runtime/DateConstructor.h>
 #include <LibJS/Runtime/DatePrototype.h>
 #include <LibJS/Runtime/ErrorConstructor.h>
@@ -62,6 +66,8 @@
 #include <LibJS/Runtime/StringPrototype.h>
 #include <LibJS/Runtime/SymbolConstructor.h>
 #include <LibJS/Runtime/SymbolPrototype.h>
+#include <LibJS/Runtime/TypedArrayConstructor.h>
+#include <LibJS/Runtime/TypedArrayPrototype.h>
 #include <LibJS/Runtime/Value.h>
 
 namespace JS {
@@ -87,13 +93,20 @@ void GlobalObject::initialize()
     JS_ENUMERATE_BUILTIN_TYPES
 #undef __JS_ENUMERATE
 
+    // The typed array prototypes all inherit from this one, so it has to exist before they do.
+    m_typed_array_prototype = heap().allocate<TypedArrayPrototype>(*this, *this);
+
+#define __JS_ENUMERATE(ClassName, snake_name, PrototypeName, ConstructorName, Type) \
+    m_##snake_name##_prototype = heap().allocate<PrototypeName>(*this, *this);
+    JS_ENUMERATE_TYPED_ARRAYS
+#undef __JS_ENUMERATE
+
 #define __JS_ENUMERATE(ClassName, snake_name)                                    \
     if (!m_##snake_name##_prototype)                                             \
         m_##snake_name##_prototype = heap().allocate<ClassName##Prototype>(*this, *this);
     JS_ENUMERATE_ITERATOR_PROTOTYPES
 #undef __JS_ENUMERATE
 
-
     u8 attr = Attribute::Writable | Attribute::Configurable;
     define_native_function("gc", gc, 0, attr);
     define_native_function("isNaN", is_nan, 1, attr);
@@ -111,8 +124,10 @@ void GlobalObject::initialize()
     define_property("Reflect", heap().allocate<ReflectObject>(*this, *this), attr);
 
     add_constructor("Array", m_array_constructor, *m_array_prototype);
+    add_constructor("ArrayBuffer", m_array_buffer_constructor, *m_array_buffer_prototype);
     add_constructor("BigInt", m_bigint_constructor, *m_bigint_prototype);
     add_constructor("Boolean", m_boolean_constructor, *m_boolean_prototype);
+    add_constructor("DataView", m_data_view_constructor, *m_data_view_prototype);
     add_constructor("Date", m_date_constructor, *m_date_prototype);
     add_constructor("Error", m_error_constructor, *m_error_prototype);
     add_constructor("Function", m_function_constructor, *m_function_prototype);
@@ -127,6 +142,11 @@ void GlobalObject::initialize()
     add_constructor(#ClassName, m_##snake_name##_constructor, *m_##snake_name##_prototype);
     JS_ENUMERATE_ERROR_SUBCLASSES
 #undef __JS_ENUMERATE
+
+#define __JS_ENUMERATE(ClassName, snake_name, PrototypeName, ConstructorName, Type) \
+    add_constructor(#ClassName, m_##snake_name##_constructor, *m_##snake_name##_prototype);
+    JS_ENUMERATE_TYPED_ARRAYS
+#undef __JS_ENUMERATE
 }
 
 GlobalObject::~GlobalObject()
@@ -139,16 +159,31 @@ void GlobalObject::visit_children(Visitor& visitor)
 
     visitor.visit(m_empty_object_shape);
 
+    // Some of these (like the iterator prototypes) can't be reached through any property.
 #define __JS_ENUMERATE(ClassName, snake_name, PrototypeName, ConstructorName) \
-    visitor.visit(m_##snake_name##_constructor);
-    JS_ENUMERATE_ERROR_SUBCLASSES
+    visitor.visit(m_##snake_name##_constructor);                          \
+    visitor.visit(m_##snake_name##_prototype);
+    JS_ENUMERATE_BUILTIN_TYPES
+#undef __JS_ENUMERATE
+
+#define __JS_ENUMERATE(ClassName, snake_name, PrototypeName, ConstructorName, Type) \
+    visitor.visit(m_##snake_name##_constructor);                                \
+    visitor.visit(m_##snake_name##_prototype);
+    JS_ENUMERATE_TYPED_ARRAYS
 #undef __JS_ENUMERATE
+
+#define __JS_ENUMERATE(ClassName, snake_name) \
+    visitor.visit(m_##snake_name##_prototype);
+    JS_ENUMERATE_ITERATOR_PROTOTYPES
+#undef __JS_ENUMERATE
+
+    visitor.visit(m_typed_array_prototype);
 }
 
 JS_DEFINE_NATIVE_FUNCTION(GlobalObject::gc)
 {
     dbg() << "Forced garbage collection requested!";
-    interpreter.heap().collect_garbage();
+    interpreter.heap().collect_garbage(Heap::CollectionType::CollectAllGarbage);
     return js_undefined();
 }
 
@@ -49,11 +49,19 @@ public:
     JS_ENUMERATE_BUILTIN_TYPES
 #undef __JS_ENUMERATE
 
+#define __JS_ENUMERATE(ClassName, snake_name, PrototypeName, ConstructorName, Type)      \
+    ConstructorName* snake_name##_constructor() { return m_##snake_name##_constructor; } \
+    Object* snake_name##_prototype() { return m_##snake_name##_prototype; }
+    JS_ENUMERATE_TYPED_ARRAYS
+#undef __JS_ENUMERATE
+
 #define __JS_ENUMERATE(ClassName, snake_name) \
     Object* snake_name##_prototype() { return m_##snake_name##_prototype; }
     JS_ENUMERATE_ITERATOR_PROTOTYPES
 #undef __JS_ENUMERATE
 
+    Object* typed_array_prototype() { return m_typed_array_prototype; }
+
 protected:
     virtual void visit_children(Visitor&) override;
 
@@ -74,11 +82,19 @@ private:
     JS_ENUMERATE_BUILTIN_TYPES
 #undef __JS_ENUMERATE
 
+#define __JS_ENUMERATE(ClassName, snake_name, PrototypeName, ConstructorName, Type) \
+    ConstructorName* m_##snake_name##_constructor { nullptr };                      \
+    Object* m_##snake_name##_prototype { nullptr };
+    JS_ENUMERATE_TYPED_ARRAYS
+#undef __JS_ENUMERATE
+
 #define __JS_ENUMERATE(ClassName, snake_name) \
     Object* m_##snake_name##_prototype { nullptr };
     JS_ENUMERATE_ITERATOR_PROTOTYPES
 #undef __JS_ENUMERATE
 
+    // The %TypedArray%.prototype object shared by all the typed array prototypes.
+    Object* m_typed_array_prototype { nullptr };
 };
 
 template<typename ConstructorType>
@@ -33,6 +33,29 @@ SimpleIndexedPropertyStorage::SimpleIndexedPropertyStorage(Vector<Value>&& initi
     : m_array_size(initial_values.size())
     , m_packed_elements(move(initial_values))
 {
+    for (auto& value : m_packed_elements)
+        did_store(value);
+}
+
+static bool is_int32(Value value)
+{
+    return value.is_integer() && !value.is_negative_zero();
+}
+
+void SimpleIndexedPropertyStorage::did_store(Value value)
+{
+    if (m_element_kind == ElementKind::Generic)
+        return;
+    if (!value.is_number())
+        m_element_kind = ElementKind::Generic;
+    else if (m_element_kind == ElementKind::Int32 && !is_int32(value))
+        m_element_kind = ElementKind::Double;
+}
+
+void SimpleIndexedPropertyStorage::did_shrink()
+{
+    if (m_array_size == 0)
+        m_element_kind = ElementKind::Int32;
 }
 
 bool SimpleIndexedPropertyStorage::has_index(u32 index) const
@@ -50,57 +73,71 @@ Optional<ValueAndAttributes> SimpleIndexedPropertyStorage::get(u32 index) const
 void SimpleIndexedPropertyStorage::put(u32 index, Value value, PropertyAttributes attributes)
 {
     ASSERT(attributes == default_attributes);
-    ASSERT(index < SPARSE_ARRAY_THRESHOLD);
 
     if (index >= m_array_size) {
+        // Anything between the old end and the new element is a hole.
+        if (index > m_array_size)
+            m_element_kind = ElementKind::Generic;
         m_array_size = index + 1;
-        if (index >= m_packed_elements.size())
-            m_packed_elements.resize(index + MIN_PACKED_RESIZE_AMOUNT >= SPARSE_ARRAY_THRESHOLD ? SPARSE_ARRAY_THRESHOLD : index + MIN_PACKED_RESIZE_AMOUNT);
+        m_packed_elements.grow_capacity(m_array_size);
+        m_packed_elements.resize(m_array_size);
     }
     m_packed_elements[index] = value;
+    did_store(value);
 }
 
 void SimpleIndexedPropertyStorage::remove(u32 index)
 {
-    if (index < m_array_size)
+    if (index < m_array_size) {
         m_packed_elements[index] = {};
+        m_element_kind = ElementKind::Generic;
+    }
 }
 
 void SimpleIndexedPropertyStorage::insert(u32 index, Value value, PropertyAttributes attributes)
 {
     ASSERT(attributes == default_attributes);
-    ASSERT(index < SPARSE_ARRAY_THRESHOLD);
     m_array_size++;
-    ASSERT(m_array_size <= SPARSE_ARRAY_THRESHOLD);
     m_packed_elements.insert(index, value);
+    did_store(value);
 }
 
 ValueAndAttributes SimpleIndexedPropertyStorage::take_first()
 {
     m_array_size--;
-    return { m_packed_elements.take_first(), default_attributes };
+    auto first_element = m_packed_elements.take_first();
+    did_shrink();
+    return { first_element, default_attributes };
 }
 
 ValueAndAttributes SimpleIndexedPropertyStorage::take_last()
 {
     m_array_size--;
-    auto last_element = m_packed_elements[m_array_size];
-    m_packed_elements[m_array_size] = {};
+    auto last_element = m_packed_elements.take_last();
+    did_shrink();
     return { last_element, default_attributes };
 }
 
 void SimpleIndexedPropertyStorage::set_array_like_size(size_t new_size)
 {
-    ASSERT(new_size <= SPARSE_ARRAY_THRESHOLD);
+    if (new_size > m_array_size)
+        m_element_kind = ElementKind::Generic;
     m_array_size = new_size;
     m_packed_elements.resize(new_size);
+    did_shrink();
 }
 
 GenericIndexedPropertyStorage::GenericIndexedPropertyStorage(SimpleIndexedPropertyStorage&& storage)
 {
     m_array_size = storage.array_like_size();
-    for (auto& element : move(storage.m_packed_elements))
-        m_packed_elements.append({ element, default_attributes });
+    auto& elements = storage.m_packed_elements;
+    m_packed_elements.ensure_capacity(min(elements.size(), (size_t)SPARSE_ARRAY_THRESHOLD));
+    for (size_t i = 0; i < elements.size(); ++i) {
+        if (i < SPARSE_ARRAY_THRESHOLD)
+            m_packed_elements.append({ elements[i], default_attributes });
+        else if (!elements[i].is_empty())
+            m_sparse_elements.set(i, { elements[i], default_attributes });
+    }
 }
 
 bool GenericIndexedPropertyStorage::has_index(u32 index) const
@@ -283,10 +320,11 @@ Optional<ValueAndAttributes> IndexedProperties::get(Object* this_object, u32 ind
 
 void IndexedProperties::put(Object* this_object, u32 index, Value value, PropertyAttributes attributes, bool evaluate_accessors)
 {
-    if (m_storage->is_simple_storage() && (index >= SPARSE_ARRAY_THRESHOLD || attributes != default_attributes))
+    if (m_storage->is_simple_storage() && (attributes != default_attributes || index > array_like_size() + SPARSE_ARRAY_HOLE_THRESHOLD))
         switch_to_generic_storage();
     if (m_storage->is_simple_storage() || !evaluate_accessors) {
         m_storage->put(index, value, attributes);
+        m_owner->write_barrier();
         return;
     }
 
@@ -296,6 +334,7 @@ void IndexedProperties::put(Object* this_object, u32 index, Value value, Propert
         value_here.value().value.as_accessor().call_setter(this_object, value);
     } else {
         m_storage->put(index, value, attributes);
+        m_owner->write_barrier();
     }
 }
 
@@ -312,9 +351,10 @@ bool IndexedProperties::remove(u32 index)
 
 void IndexedProperties::insert(u32 index, Value value, PropertyAttributes attributes)
 {
-    if (m_storage->is_simple_storage() && (index >= SPARSE_ARRAY_THRESHOLD || attributes != default_attributes || array_like_size() == SPARSE_ARRAY_THRESHOLD))
+    if (m_storage->is_simple_storage() && (attributes != default_attributes || index > array_like_size()))
         switch_to_generic_storage();
     m_storage->insert(index, value, attributes);
+    m_owner->write_barrier();
 }
 
 ValueAndAttributes IndexedProperties::take_first(Object *this_object)
@@ -343,13 +383,21 @@ void IndexedProperties::append_all(Object* this_object, const IndexedProperties&
         if (this_object && this_object->interpreter().exception())
             return;
         m_storage->put(m_storage->array_like_size(), element.value, element.attributes);
+        m_owner->write_barrier();
     }
 }
 
+void IndexedProperties::set_array_like_size(size_t new_size)
+{
+    if (m_storage->is_simple_storage() && array_like_size() <= LENGTH_SETTER_GENERIC_STORAGE_THRESHOLD && new_size > LENGTH_SETTER_GENERIC_STORAGE_THRESHOLD)
+        switch_to_generic_storage();
+    m_storage->set_array_like_size(new_size);
+}
+
 Vector<ValueAndAttributes> IndexedProperties::values_unordered() const
 {
     if (m_storage->is_simple_storage()) {
-        auto elements = static_cast<const SimpleIndexedPropertyStorage&>(*m_storage).elements();
+        auto& elements = static_cast<const SimpleIndexedPropertyStorage&>(*m_storage).elements();
         Vector<ValueAndAttributes> with_attributes;
         for (auto& value : elements)
             with_attributes.append({ value, default_attributes });
@@ -366,7 +414,7 @@ Vector<ValueAndAttributes> IndexedProperties::values_unordered() const
 
 void IndexedProperties::switch_to_generic_storage()
 {
-    auto storage = static_cast<const SimpleIndexedPropertyStorage&>(*m_storage);
+    auto& storage = static_cast<SimpleIndexedPropertyStorage&>(*m_storage);
     m_storage = make<GenericIndexedPropertyStorage>(move(storage));
 }
 
@@ -35,6 +35,11 @@ namespace JS {
 const u32 SPARSE_ARRAY_THRESHOLD = 200;
 const u32 MIN_PACKED_RESIZE_AMOUNT = 20;
 
+// Simple storage is kept dense: a put that would leave a bigger hole than this, or a length
+// setter growing the array past the second limit, switches the array to generic storage.
+const u32 SPARSE_ARRAY_HOLE_THRESHOLD = 200;
+const u32 LENGTH_SETTER_GENERIC_STORAGE_THRESHOLD = 4 * MB;
+
 struct ValueAndAttributes {
     Value value;
     PropertyAttributes attributes { default_attributes };
@@ -66,6 +71,15 @@ public:
 
 class SimpleIndexedPropertyStorage final : public IndexedPropertyStorage {
 public:
+    // What every element below array_like_size() is known to be. Int32 and Double arrays have no
+    // holes, so their elements can be read straight out of elements() without checking for empty values.
+    // An array that becomes empty goes back to Int32.
+    enum class ElementKind : u8 {
+        Int32,
+        Double,
+        Generic,
+    };
+
     SimpleIndexedPropertyStorage() = default;
     explicit SimpleIndexedPropertyStorage(Vector<Value>&& initial_values);
 
@@ -83,13 +97,20 @@ public:
     virtual void set_array_like_size(size_t new_size) override;
 
     virtual bool is_simple_storage() const override { return true; }
-    Vector<Value> elements() const { return m_packed_elements; }
+    const Vector<Value>& elements() const { return m_packed_elements; }
+
+    ElementKind element_kind() const { return m_element_kind; }
+    bool has_numeric_elements() const { return m_element_kind != ElementKind::Generic; }
 
 private:
     friend GenericIndexedPropertyStorage;
 
+    void did_store(Value);
+    void did_shrink();
+
     size_t m_array_size { 0 };
     Vector<Value> m_packed_elements;
+    ElementKind m_element_kind { ElementKind::Int32 };
 };
 
 class GenericIndexedPropertyStorage final : public IndexedPropertyStorage {
@@ -137,11 +158,16 @@ private:
 
 class IndexedProperties {
 public:
-    IndexedProperties() = default;
+    explicit IndexedProperties(Cell& owner)
+        : m_owner(&owner)
+    {
+    }
 
-    IndexedProperties(Vector<Value>&& values)
-        : m_storage(make<SimpleIndexedPropertyStorage>(move(values)))
+    IndexedProperties(Cell& owner, Vector<Value>&& values)
+        : m_owner(&owner)
+        , m_storage(make<SimpleIndexedPropertyStorage>(move(values)))
     {
+        owner.write_barrier();
     }
 
     bool has_index(u32 index) const { return m_storage->has_index(index); }
@@ -162,13 +188,24 @@ public:
     size_t size() const { return m_storage->size(); }
     bool is_empty() const { return size() == 0; }
     size_t array_like_size() const { return m_storage->array_like_size(); }
-    void set_array_like_size(size_t new_size) { m_storage->set_array_like_size(new_size); };
+    void set_array_like_size(size_t new_size);
 
     Vector<ValueAndAttributes> values_unordered() const;
 
+    // Returns the simple storage if this is a dense array of numbers, so callers can skip the generic paths.
+    const SimpleIndexedPropertyStorage* numeric_storage() const
+    {
+        if (!m_storage->is_simple_storage())
+            return nullptr;
+        auto& storage = static_cast<const SimpleIndexedPropertyStorage&>(*m_storage);
+        return storage.has_numeric_elements() ? &storage : nullptr;
+    }
+
 private:
     void switch_to_generic_storage();
 
+    // The object these are the elements of, which has to be told about stored values, see Cell::write_barrier().
+    Cell* m_owner { nullptr };
     NonnullOwnPtr<IndexedPropertyStorage> m_storage { make<SimpleIndexedPropertyStorage>() };
 };
 
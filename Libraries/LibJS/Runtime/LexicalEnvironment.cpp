@@ -41,17 +41,19 @@ LexicalEnvironment::LexicalEnvironment(EnvironmentRecordType environment_record_
 {
 }
 
-LexicalEnvironment::LexicalEnvironment(HashMap<FlyString, Variable> variables, LexicalEnvironment* parent)
-    : m_parent(parent)
-    , m_variables(move(variables))
+LexicalEnvironment::LexicalEnvironment(EnvironmentLayout& layout, LexicalEnvironment* parent)
+    : LexicalEnvironment(layout, parent, EnvironmentRecordType::Declarative)
 {
 }
 
-LexicalEnvironment::LexicalEnvironment(HashMap<FlyString, Variable> variables, LexicalEnvironment* parent, EnvironmentRecordType environment_record_type)
+LexicalEnvironment::LexicalEnvironment(EnvironmentLayout& layout, LexicalEnvironment* parent, EnvironmentRecordType environment_record_type)
     : m_parent(parent)
-    , m_variables(move(variables))
+    , m_layout(layout)
     , m_environment_record_type(environment_record_type)
 {
+    m_values.ensure_capacity(layout.size());
+    for (size_t i = 0; i < layout.size(); ++i)
+        m_values.unchecked_append(js_undefined());
 }
 
 LexicalEnvironment::~LexicalEnvironment()
@@ -66,18 +68,40 @@ void LexicalEnvironment::visit_children(Visitor& visitor)
     visitor.visit(m_home_object);
     visitor.visit(m_new_target);
     visitor.visit(m_current_function);
-    for (auto& it : m_variables)
-        visitor.visit(it.value.value);
+    for (auto& value : m_values)
+        visitor.visit(value);
+    if (m_dynamic_variables) {
+        for (auto& it : *m_dynamic_variables)
+            visitor.visit(it.value.value);
+    }
 }
 
 Optional<Variable> LexicalEnvironment::get(const FlyString& name) const
 {
-    return m_variables.get(name);
+    if (m_layout) {
+        auto index = m_layout->index_of(name);
+        if (index.has_value())
+            return Variable { m_values[index.value()], m_layout->declaration_kind_at(index.value()) };
+    }
+    if (!m_dynamic_variables)
+        return {};
+    return m_dynamic_variables->get(name);
 }
 
 void LexicalEnvironment::set(const FlyString& name, Variable variable)
 {
-    m_variables.set(name, variable);
+    if (m_layout) {
+        auto index = m_layout->index_of(name);
+        if (index.has_value()) {
+            m_values[index.value()] = variable.value;
+            write_barrier();
+            return;
+        }
+    }
+    if (!m_dynamic_variables)
+        m_dynamic_variables = make<HashMap<FlyString, Variable>>();
+    m_dynamic_variables->set(name, variable);
+    write_barrier();
 }
 
 bool LexicalEnvironment::has_super_binding() const
@@ -126,6 +150,7 @@ void LexicalEnvironment::bind_this_value(Value this_value)
         return;
     }
     m_this_value = this_value;
+    write_barrier();
     m_this_binding_status = ThisBindingStatus::Initialized;
 }
 
@@ -28,7 +28,9 @@
 
 #include <AK/FlyString.h>
 #include <AK/HashMap.h>
+#include <AK/OwnPtr.h>
 #include <LibJS/Runtime/Cell.h>
+#include <LibJS/Runtime/EnvironmentLayout.h>
 #include <LibJS/Runtime/Value.h>
 
 namespace JS {
@@ -56,8 +58,8 @@ public:
 
     LexicalEnvironment();
     LexicalEnvironment(EnvironmentRecordType);
-    LexicalEnvironment(HashMap<FlyString, Variable> variables, LexicalEnvironment* parent);
-    LexicalEnvironment(HashMap<FlyString, Variable> variables, LexicalEnvironment* parent, EnvironmentRecordType);
+    LexicalEnvironment(EnvironmentLayout&, LexicalEnvironment* parent);
+    LexicalEnvironment(EnvironmentLayout&, LexicalEnvironment* parent, EnvironmentRecordType);
     virtual ~LexicalEnvironment() override;
 
     LexicalEnvironment* parent() const { return m_parent; }
@@ -65,11 +67,20 @@ public:
     Optional<Variable> get(const FlyString&) const;
     void set(const FlyString&, Variable);
 
-    void clear();
-
-    const HashMap<FlyString, Variable>& variables() const { return m_variables; }
-
-    void set_home_object(Value object) { m_home_object = object; }
+    // Access to the bindings of the layout by slot, for identifiers the scope analysis has resolved.
+    Value value_at(size_t index) const { return m_values[index]; }
+    void set_value_at(size_t index, Value value)
+    {
+        m_values[index] = value;
+        write_barrier();
+    }
+    DeclarationKind declaration_kind_at(size_t index) const { return m_layout->declaration_kind_at(index); }
+
+    void set_home_object(Value object)
+    {
+        m_home_object = object;
+        write_barrier();
+    }
     bool has_super_binding() const;
     Value get_super_base();
 
@@ -79,20 +90,35 @@ public:
     void bind_this_value(Value this_value);
 
     // Not a standard operation.
-    void replace_this_binding(Value this_value) { m_this_value = this_value; }
+    void replace_this_binding(Value this_value)
+    {
+        m_this_value = this_value;
+        write_barrier();
+    }
 
     Value new_target() const { return m_new_target; };
-    void set_new_target(Value new_target) { m_new_target = new_target; }
+    void set_new_target(Value new_target)
+    {
+        m_new_target = new_target;
+        write_barrier();
+    }
 
     Function* current_function() const { return m_current_function; }
-    void set_current_function(Function& function) { m_current_function = &function; }
+    void set_current_function(Function& function)
+    {
+        m_current_function = &function;
+        write_barrier();
+    }
 
 private:
     virtual const char* class_name() const override { return "LexicalEnvironment"; }
     virtual void visit_children(Visitor&) override;
 
     LexicalEnvironment* m_parent { nullptr };
-    HashMap<FlyString, Variable> m_variables;
+    RefPtr<EnvironmentLayout> m_layout;
+    Vector<Value> m_values;
+    // Bindings that aren't part of the layout, e.g. those created by class declarations.
+    OwnPtr<HashMap<FlyString, Variable>> m_dynamic_variables;
     EnvironmentRecordType m_environment_record_type = EnvironmentRecordType::Declarative;
     ThisBindingStatus m_this_binding_status = ThisBindingStatus::Uninitialized;
     Value m_home_object;
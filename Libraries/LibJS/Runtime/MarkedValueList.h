@@ -26,6 +26,7 @@
 
 #pragma once
 
+#include <AK/IntrusiveList.h>
 #include <AK/Noncopyable.h>
 #include <AK/Vector.h>
 #include <LibJS/Forward.h>
@@ -50,6 +51,9 @@ public:
 
     void append(Value);
 
+    // Links this list into the Heap's list of marked value lists, whose values are all roots.
+    IntrusiveListNode m_list_node;
+
 private:
     Heap& m_heap;
     Vector<Value, 32> m_values;
@@ -81,6 +81,10 @@ JS_DEFINE_NATIVE_FUNCTION(NumberPrototype::to_string)
     if (interpreter.exception() || radix < 2 || radix > 36)
         return interpreter.throw_exception<RangeError>(ErrorType::InvalidRadix);
 
+    // Base 10 has its own shortest round-trip formatting, which also handles NaN, the infinities and zeros.
+    if (radix == 10)
+        return js_string(interpreter, number_value.to_string_without_side_effects());
+
     if (number_value.is_positive_infinity())
         return js_string(interpreter, "Infinity");
     if (number_value.is_negative_infinity())
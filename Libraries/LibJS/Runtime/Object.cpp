@@ -134,6 +134,7 @@ bool Object::set_prototype(Object* new_prototype)
         return true;
     }
     m_shape = m_shape->create_prototype_transition(new_prototype);
+    write_barrier();
     return true;
 }
 
@@ -334,6 +335,7 @@ void Object::set_shape(Shape& new_shape)
 {
     m_storage.resize(new_shape.property_count());
     m_shape = &new_shape;
+    write_barrier();
 }
 
 bool Object::define_property(const StringOrSymbol& property_name, const Object& descriptor, bool throw_exceptions)
@@ -531,6 +533,7 @@ bool Object::put_own_property(Object& this_object, const StringOrSymbol& propert
         call_native_property_setter(const_cast<Object*>(&this_object), value_here, value);
     } else {
         m_storage[metadata.value().offset] = value;
+        write_barrier();
     }
     return true;
 }
@@ -619,6 +622,7 @@ void Object::ensure_shape_is_unique()
         return;
 
     m_shape = m_shape->create_unique_clone();
+    write_barrier();
 }
 
 Value Object::get_by_index(u32 property_index) const
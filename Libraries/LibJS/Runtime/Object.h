@@ -125,6 +125,9 @@ public:
     virtual bool is_bigint_object() const { return false; }
     virtual bool is_string_iterator_object() const { return false; }
     virtual bool is_array_iterator_object() const { return false; }
+    virtual bool is_array_buffer() const { return false; }
+    virtual bool is_typed_array() const { return false; }
+    virtual bool is_data_view() const { return false; }
 
     virtual const char* class_name() const override { return "Object"; }
     virtual void visit_children(Cell::Visitor&) override;
@@ -142,10 +145,15 @@ public:
     virtual Value to_string() const;
 
     Value get_direct(size_t index) const { return m_storage[index]; }
+    void put_direct(size_t index, Value value)
+    {
+        m_storage[index] = value;
+        write_barrier();
+    }
 
     const IndexedProperties& indexed_properties() const { return m_indexed_properties; }
     IndexedProperties& indexed_properties() { return m_indexed_properties; }
-    void set_indexed_property_elements(Vector<Value>&& values) { m_indexed_properties = IndexedProperties(move(values)); }
+    void set_indexed_property_elements(Vector<Value>&& values) { m_indexed_properties = IndexedProperties(*this, move(values)); }
 
     Value invoke(const StringOrSymbol& property_name, Optional<MarkedValueList> arguments = {});
 
@@ -170,7 +178,7 @@ private:
     bool m_is_extensible { true };
     Shape* m_shape { nullptr };
     Vector<Value> m_storage;
-    IndexedProperties m_indexed_properties;
+    IndexedProperties m_indexed_properties { *this };
 };
 
 }
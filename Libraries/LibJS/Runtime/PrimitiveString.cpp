@@ -24,15 +24,83 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <AK/FlyString.h>
+#include <AK/Vector.h>
 #include <LibJS/Heap/Heap.h>
 #include <LibJS/Interpreter.h>
 #include <LibJS/Runtime/PrimitiveString.h>
+#include <string.h>
 
 namespace JS {
 
+static constexpr size_t min_average_rope_piece_length = 256;
+static constexpr size_t max_interned_length = 32;
+
 PrimitiveString::PrimitiveString(String string)
     : m_string(move(string))
+    , m_length(m_string.length())
+{
+    intern_if_short();
+}
+
+PrimitiveString::PrimitiveString(PrimitiveString& lhs, PrimitiveString& rhs)
+    : m_lhs(&lhs)
+    , m_rhs(&rhs)
+    , m_length(lhs.length() + rhs.length())
+    , m_rope_node_count(min(lhs.m_rope_node_count + rhs.m_rope_node_count + 1, m_length))
+    , m_is_rope(true)
+{
+    if (m_rope_node_count * min_average_rope_piece_length > m_length)
+        resolve_rope();
+}
+
+void PrimitiveString::visit_children(Cell::Visitor& visitor)
 {
+    Cell::visit_children(visitor);
+    if (m_is_rope) {
+        visitor.visit(m_lhs);
+        visitor.visit(m_rhs);
+    }
+}
+
+void PrimitiveString::resolve_rope() const
+{
+    ASSERT(m_is_rope);
+
+    char* buffer;
+    auto impl = StringImpl::create_uninitialized(m_length, buffer);
+    size_t offset = 0;
+
+    // Walk the leaves from left to right without recursing, since ropes built
+    // in a loop tend to be deep and lopsided.
+    Vector<const PrimitiveString*, 32> stack;
+    stack.append(m_rhs);
+    stack.append(m_lhs);
+    while (!stack.is_empty()) {
+        auto* piece = stack.take_last();
+        if (piece->m_is_rope) {
+            stack.append(piece->m_rhs);
+            stack.append(piece->m_lhs);
+            continue;
+        }
+        memcpy(buffer + offset, piece->m_string.characters(), piece->m_length);
+        offset += piece->m_length;
+    }
+    ASSERT(offset == m_length);
+
+    m_string = move(impl);
+    m_lhs = nullptr;
+    m_rhs = nullptr;
+    m_rope_node_count = 0;
+    m_is_rope = false;
+    intern_if_short();
+}
+
+void PrimitiveString::intern_if_short() const
+{
+    if (m_string.is_null() || m_length > max_interned_length || m_string.impl()->is_fly())
+        return;
+    m_string = FlyString(m_string).impl();
 }
 
 PrimitiveString::~PrimitiveString()
@@ -49,4 +117,13 @@ PrimitiveString* js_string(Interpreter& interpreter, String string)
     return js_string(interpreter.heap(), string);
 }
 
+PrimitiveString* js_rope_string(Interpreter& interpreter, PrimitiveString& lhs, PrimitiveString& rhs)
+{
+    if (!lhs.length())
+        return &rhs;
+    if (!rhs.length())
+        return &lhs;
+    return interpreter.heap().allocate_without_global_object<PrimitiveString>(lhs, rhs);
+}
+
 }
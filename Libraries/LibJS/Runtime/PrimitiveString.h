@@ -31,20 +31,50 @@
 
 namespace JS {
 
+// A PrimitiveString is either a plain string, or a "rope": the concatenation of two other
+// PrimitiveStrings, which isn't carried out until someone asks for the characters.
+// This turns building a long string piece by piece with + from quadratic into linear work.
+//
+// A rope made of many tiny pieces costs more to keep around (and to mark) than its characters,
+// so once its pieces get too small on average, it's flattened right away. Since the pieces
+// appended after that have to add up to a fraction of the flattened length before it happens
+// again, the copying stays linear overall.
+//
+// Short strings are interned as FlyStrings, so that comparing two of them (and using them as
+// property names) doesn't have to look at their characters.
 class PrimitiveString final : public Cell {
 public:
     explicit PrimitiveString(String);
+    PrimitiveString(PrimitiveString& lhs, PrimitiveString& rhs);
     virtual ~PrimitiveString();
 
-    const String& string() const { return m_string; }
+    const String& string() const
+    {
+        if (m_is_rope)
+            resolve_rope();
+        return m_string;
+    }
+
+    size_t length() const { return m_length; }
+    bool is_rope() const { return m_is_rope; }
 
 private:
     virtual const char* class_name() const override { return "PrimitiveString"; }
+    virtual void visit_children(Visitor&) override;
+
+    void resolve_rope() const;
+    void intern_if_short() const;
 
-    String m_string;
+    mutable String m_string;
+    mutable PrimitiveString* m_lhs { nullptr };
+    mutable PrimitiveString* m_rhs { nullptr };
+    size_t m_length { 0 };
+    mutable size_t m_rope_node_count { 0 };
+    mutable bool m_is_rope { false };
 };
 
 PrimitiveString* js_string(Heap&, String);
 PrimitiveString* js_string(Interpreter&, String);
+PrimitiveString* js_rope_string(Interpreter&, PrimitiveString& lhs, PrimitiveString& rhs);
 
 }
@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <LibJS/Heap/Heap.h>
+#include <LibJS/Runtime/Object.h>
+#include <LibJS/Runtime/PropertyLookupCache.h>
+#include <LibJS/Runtime/Shape.h>
+
+namespace JS {
+
+static bool is_cacheable_value(Value value)
+{
+    // Accessors and native properties need to be called, which the slow path takes care of.
+    return !value.is_empty() && !value.is_accessor() && !value.is_native_property();
+}
+
+bool PropertyLookupCache::is_stale() const
+{
+    return m_sweep_count != Heap::sweep_count();
+}
+
+Value PropertyLookupCache::get(const Object& object) const
+{
+    if (is_stale())
+        return {};
+    auto* shape = &object.shape();
+    for (auto& entry : m_entries) {
+        if (entry.shape != shape)
+            continue;
+        if (entry.holder && &entry.holder->shape() != entry.holder_shape)
+            return {};
+        auto value = (entry.holder ? entry.holder : &object)->get_direct(entry.offset);
+        if (!is_cacheable_value(value))
+            return {};
+        return value;
+    }
+    return {};
+}
+
+bool PropertyLookupCache::put(Object& object, Value value) const
+{
+    if (is_stale())
+        return false;
+    auto* shape = &object.shape();
+    for (auto& entry : m_entries) {
+        if (entry.shape != shape)
+            continue;
+        if (entry.holder || !entry.is_writable || !is_cacheable_value(object.get_direct(entry.offset)))
+            return false;
+        object.put_direct(entry.offset, value);
+        return true;
+    }
+    return false;
+}
+
+void PropertyLookupCache::add_entry(const Entry& entry) const
+{
+    if (is_stale()) {
+        for (auto& stale_entry : m_entries)
+            stale_entry = {};
+        m_next_entry = 0;
+        m_sweep_count = Heap::sweep_count();
+    }
+    m_entries[m_next_entry] = entry;
+    m_next_entry = (m_next_entry + 1) % entry_count;
+}
+
+void PropertyLookupCache::update_for_get(const Object& object, const StringOrSymbol& property_name) const
+{
+    auto& shape = object.shape();
+    if (object.is_proxy_object() || shape.is_unique())
+        return;
+
+    if (auto metadata = shape.lookup(property_name); metadata.has_value()) {
+        if (is_cacheable_value(object.get_direct(metadata.value().offset)))
+            add_entry({ &shape, nullptr, nullptr, static_cast<u32>(metadata.value().offset), metadata.value().attributes.is_writable() });
+        return;
+    }
+
+    // Methods usually live on the prototype, so remember a hit there too. The receiver's shape
+    // pins down which object that is, and the prototype's own shape whether it still has the property.
+    auto* prototype = shape.prototype();
+    if (!prototype || prototype->is_proxy_object() || prototype->shape().is_unique())
+        return;
+    auto metadata = prototype->shape().lookup(property_name);
+    if (!metadata.has_value() || !is_cacheable_value(prototype->get_direct(metadata.value().offset)))
+        return;
+    add_entry({ &shape, prototype, &prototype->shape(), static_cast<u32>(metadata.value().offset), false });
+}
+
+void PropertyLookupCache::update_for_put(const Object& object, const StringOrSymbol& property_name) const
+{
+    // Only stores to an existing own data property are cached, anything else may involve a
+    // setter on the prototype chain or a shape transition.
+    auto& shape = object.shape();
+    if (object.is_proxy_object() || shape.is_unique())
+        return;
+    auto metadata = shape.lookup(property_name);
+    if (!metadata.has_value() || !metadata.value().attributes.is_writable() || !is_cacheable_value(object.get_direct(metadata.value().offset)))
+        return;
+    add_entry({ &shape, nullptr, nullptr, static_cast<u32>(metadata.value().offset), true });
+}
+
+}
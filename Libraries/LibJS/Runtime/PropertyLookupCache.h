@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/Types.h>
+#include <LibJS/Forward.h>
+#include <LibJS/Runtime/StringOrSymbol.h>
+#include <LibJS/Runtime/Value.h>
+
+namespace JS {
+
+// An inline cache for one property access site with a fixed property name, e.g. `a.b`.
+// It remembers where the property was found for the last few shapes seen there, either
+// on the object itself or on its prototype, so repeated accesses skip the shape's property
+// table and the prototype chain walk.
+//
+// Only non-unique shapes are cached: they never change, so any transition (a property being
+// added, removed or reconfigured, or the prototype changing) gives the object a shape that
+// simply misses. Since the cache isn't visible to the garbage collector, it forgets
+// everything whenever cells have been swept, as their addresses may have been reused.
+class PropertyLookupCache {
+public:
+    // Return an empty value or false respectively if the access didn't hit the cache.
+    Value get(const Object&) const;
+    bool put(Object&, Value) const;
+
+    // Called after the slow path to remember where the property was found, if possible.
+    void update_for_get(const Object&, const StringOrSymbol& property_name) const;
+    void update_for_put(const Object&, const StringOrSymbol& property_name) const;
+
+private:
+    struct Entry {
+        const Shape* shape { nullptr };
+        // The prototype the property was found on, or null for an own property.
+        const Object* holder { nullptr };
+        const Shape* holder_shape { nullptr };
+        u32 offset { 0 };
+        bool is_writable { false };
+    };
+
+    static constexpr size_t entry_count = 4;
+
+    bool is_stale() const;
+    void add_entry(const Entry&) const;
+
+    mutable Entry m_entries[entry_count];
+    mutable size_t m_next_entry { 0 };
+    mutable size_t m_sweep_count { 0 };
+};
+
+}
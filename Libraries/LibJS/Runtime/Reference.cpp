@@ -29,6 +29,7 @@
 #include <LibJS/Runtime/Error.h>
 #include <LibJS/Runtime/GlobalObject.h>
 #include <LibJS/Runtime/Object.h>
+#include <LibJS/Runtime/PropertyLookupCache.h>
 #include <LibJS/Runtime/Reference.h>
 
 namespace JS {
@@ -43,7 +44,9 @@ void Reference::put(Interpreter& interpreter, GlobalObject& global_object, Value
     }
 
     if (is_local_variable() || is_global_variable()) {
-        if (is_local_variable())
+        if (m_environment_coordinate.has_value())
+            interpreter.set_variable(m_environment_coordinate.value(), value);
+        else if (is_local_variable())
             interpreter.set_variable(m_name.to_string(), value, global_object);
         else
             global_object.put(m_name, value);
@@ -59,7 +62,12 @@ void Reference::put(Interpreter& interpreter, GlobalObject& global_object, Value
     if (!object)
         return;
 
+    if (m_lookup_cache && m_lookup_cache->put(*object, value))
+        return;
+
     object->put(m_name, value);
+    if (m_lookup_cache && !interpreter.exception())
+        m_lookup_cache->update_for_put(*object, m_name.to_string_or_symbol());
 }
 
 void Reference::throw_reference_error(Interpreter& interpreter, GlobalObject&)
@@ -84,7 +92,9 @@ Value Reference::get(Interpreter& interpreter, GlobalObject& global_object)
 
     if (is_local_variable() || is_global_variable()) {
         Value value;
-        if (is_local_variable())
+        if (m_environment_coordinate.has_value())
+            value = interpreter.get_variable(m_environment_coordinate.value());
+        else if (is_local_variable())
             value = interpreter.get_variable(m_name.to_string(), global_object);
         else
             value = global_object.get(m_name);
@@ -101,7 +111,16 @@ Value Reference::get(Interpreter& interpreter, GlobalObject& global_object)
     if (!object)
         return {};
 
-    return object->get(m_name).value_or(js_undefined());
+    if (m_lookup_cache) {
+        auto cached_value = m_lookup_cache->get(*object);
+        if (!cached_value.is_empty())
+            return cached_value;
+    }
+
+    auto value = object->get(m_name);
+    if (m_lookup_cache && !interpreter.exception())
+        m_lookup_cache->update_for_get(*object, m_name.to_string_or_symbol());
+    return value.value_or(js_undefined());
 }
 
 }
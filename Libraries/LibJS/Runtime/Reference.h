@@ -26,7 +26,10 @@
 
 #pragma once
 
+#include <AK/Optional.h>
 #include <AK/String.h>
+#include <LibJS/Forward.h>
+#include <LibJS/Runtime/EnvironmentLayout.h>
 #include <LibJS/Runtime/PropertyName.h>
 #include <LibJS/Runtime/Value.h>
 
@@ -51,6 +54,15 @@ public:
     {
     }
 
+    Reference(LocalVariableTag, const String& name, const EnvironmentCoordinate& environment_coordinate, bool strict = false)
+        : m_base(js_null())
+        , m_name(name)
+        , m_strict(strict)
+        , m_local_variable(true)
+        , m_environment_coordinate(environment_coordinate)
+    {
+    }
+
     enum GlobalVariableTag { GlobalVariable };
     Reference(GlobalVariableTag, const String& name, bool strict = false)
         : m_base(js_null())
@@ -88,6 +100,9 @@ public:
     void put(Interpreter&, GlobalObject&, Value);
     Value get(Interpreter&, GlobalObject&);
 
+    // Lets property accesses through this reference use the inline cache of the expression it came from.
+    void set_lookup_cache(const PropertyLookupCache& cache) { m_lookup_cache = &cache; }
+
 private:
     void throw_reference_error(Interpreter&, GlobalObject&);
 
@@ -96,6 +111,8 @@ private:
     bool m_strict { false };
     bool m_local_variable { false };
     bool m_global_variable { false };
+    Optional<EnvironmentCoordinate> m_environment_coordinate;
+    const PropertyLookupCache* m_lookup_cache { nullptr };
 };
 
 const LogStream& operator<<(const LogStream&, const Value&);
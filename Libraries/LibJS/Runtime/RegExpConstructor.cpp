@@ -55,15 +55,26 @@ Value RegExpConstructor::call(Interpreter& interpreter)
 
 Value RegExpConstructor::construct(Interpreter& interpreter, Function&)
 {
-    if (!interpreter.argument_count())
-        return RegExpObject::create(global_object(), "(?:)", "");
-    auto contents = interpreter.argument(0).to_string(interpreter);
-    if (interpreter.exception())
-        return {};
-    auto flags = interpreter.argument_count() > 1 ? interpreter.argument(1).to_string(interpreter) : "";
-    if (interpreter.exception())
-        return {};
-    return RegExpObject::create(global_object(), contents, flags);
+    auto pattern = interpreter.argument(0);
+    auto flags = interpreter.argument(1);
+
+    String contents = String::empty();
+    String flags_string = String::empty();
+    if (pattern.is_object() && pattern.as_object().is_regexp_object()) {
+        auto& regexp_object = static_cast<RegExpObject&>(pattern.as_object());
+        contents = regexp_object.content();
+        flags_string = regexp_object.flags();
+    } else if (!pattern.is_undefined()) {
+        contents = pattern.to_string(interpreter);
+        if (interpreter.exception())
+            return {};
+    }
+    if (!flags.is_undefined()) {
+        flags_string = flags.to_string(interpreter);
+        if (interpreter.exception())
+            return {};
+    }
+    return RegExpObject::create(global_object(), contents, flags_string);
 }
 
 }
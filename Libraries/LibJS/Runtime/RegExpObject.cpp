@@ -27,33 +27,127 @@
 #include <AK/StringBuilder.h>
 #include <LibJS/Heap/Heap.h>
 #include <LibJS/Interpreter.h>
+#include <LibJS/Runtime/Array.h>
+#include <LibJS/Runtime/Error.h>
 #include <LibJS/Runtime/GlobalObject.h>
 #include <LibJS/Runtime/PrimitiveString.h>
 #include <LibJS/Runtime/RegExpObject.h>
 #include <LibJS/Runtime/Value.h>
-
+#include <string.h>
 
 namespace JS {
 
 RegExpObject* RegExpObject::create(GlobalObject& global_object, String content, String flags)
 {
-    return global_object.heap().allocate<RegExpObject>(global_object, content, flags, *global_object.regexp_prototype());
+    auto& interpreter = global_object.interpreter();
+    Regex::Options options;
+    for (size_t i = 0; i < flags.length(); ++i) {
+        char flag = flags[i];
+        if (!strchr("gimsuy", flag)) {
+            interpreter.throw_exception<SyntaxError>(ErrorType::RegExpObjectBadFlag, flag);
+            return nullptr;
+        }
+        if (flags.substring_view(0, i).contains(StringView(&flags[i], 1))) {
+            interpreter.throw_exception<SyntaxError>(ErrorType::RegExpObjectRepeatedFlag, flag);
+            return nullptr;
+        }
+        if (flag == 'i')
+            options.case_insensitive = true;
+        else if (flag == 'm')
+            options.multiline = true;
+        else if (flag == 's')
+            options.dot_all = true;
+    }
+
+    Regex::Pattern pattern(content, Regex::Syntax::ECMAScript, options);
+    if (pattern.has_error()) {
+        interpreter.throw_exception<SyntaxError>(ErrorType::RegExpCompileError, content.characters(), Regex::error_string(pattern.error()));
+        return nullptr;
+    }
+    return global_object.heap().allocate<RegExpObject>(global_object, content, flags, move(pattern), *global_object.regexp_prototype());
 }
 
-RegExpObject::RegExpObject(String content, String flags, Object& prototype)
+RegExpObject::RegExpObject(String content, String flags, Regex::Pattern pattern, Object& prototype)
     : Object(prototype)
     , m_content(content)
     , m_flags(flags)
+    , m_pattern(move(pattern))
+{
+}
+
+void RegExpObject::initialize(GlobalObject& global_object)
 {
+    Object::initialize(global_object);
+    define_property("lastIndex", Value(0), Attribute::Writable);
 }
 
 RegExpObject::~RegExpObject()
 {
 }
 
+Optional<Regex::Match> RegExpObject::match(Interpreter& interpreter, const String& string)
+{
+    bool uses_last_index = global() || sticky();
+    size_t last_index = 0;
+    if (uses_last_index) {
+        last_index = get("lastIndex").to_size_t(interpreter);
+        if (interpreter.exception())
+            return {};
+    }
+
+    Optional<Regex::Match> match;
+    if (last_index <= string.length()) {
+        Regex::MatchFlags flags;
+        flags.sticky = sticky();
+        match = m_pattern.search(string, last_index, flags);
+    }
+    if (uses_last_index)
+        put("lastIndex", Value(match.has_value() ? (double)match.value().span().end : 0));
+    return match;
+}
+
+Value RegExpObject::exec(Interpreter& interpreter, GlobalObject& global_object, const String& string)
+{
+    auto match = this->match(interpreter, string);
+    if (interpreter.exception())
+        return {};
+    if (!match.has_value())
+        return js_null();
+
+    auto* array = Array::create(global_object);
+    for (size_t i = 0; i < match.value().groups.size(); ++i)
+        array->indexed_properties().append(capture(interpreter, string, match.value(), i));
+    array->put("index", Value((double)match.value().span().start));
+    array->put("input", js_string(interpreter, string));
+    array->put("groups", named_groups(interpreter, global_object, string, match.value()));
+    return array;
+}
+
+Value RegExpObject::capture(Interpreter& interpreter, const String& string, const Regex::Match& match, size_t group)
+{
+    if (group >= match.groups.size() || !match.groups[group].has_value())
+        return js_undefined();
+    auto& span = match.groups[group].value();
+    return js_string(interpreter, string.substring(span.start, span.length()));
+}
+
+Value RegExpObject::named_groups(Interpreter& interpreter, GlobalObject& global_object, const String& string, const Regex::Match& match) const
+{
+    if (!m_pattern.has_group_names())
+        return js_undefined();
+    auto* groups = Object::create_empty(global_object);
+    auto& names = m_pattern.group_names();
+    for (size_t i = 0; i < names.size(); ++i) {
+        if (!names[i].is_null())
+            groups->put(names[i], capture(interpreter, string, match, i + 1));
+    }
+    return groups;
+}
+
 Value RegExpObject::to_string() const
 {
-    return js_string(interpreter(), String::format("/%s/%s", content().characters(), flags().characters()));
+    auto source = content().is_empty() ? "(?:)" : content().characters();
+    return js_string(interpreter(), String::format("/%s/%s", source, flags().characters()));
 }
 
 }
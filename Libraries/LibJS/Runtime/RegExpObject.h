@@ -28,6 +28,7 @@
 
 #include <LibJS/AST.h>
 #include <LibJS/Runtime/Object.h>
+#include <LibRegex/Regex.h>
 
 namespace JS {
 
@@ -35,13 +36,30 @@ class RegExpObject : public Object {
     JS_OBJECT(RegExpObject, Object);
 
 public:
+    // Throws a SyntaxError and returns nullptr if the pattern or the flags are invalid.
     static RegExpObject* create(GlobalObject&, String content, String flags);
 
-    RegExpObject(String content, String flags, Object& prototype);
+    RegExpObject(String content, String flags, Regex::Pattern, Object& prototype);
+    virtual void initialize(GlobalObject&) override;
     virtual ~RegExpObject() override;
 
     const String& content() const { return m_content; }
     const String& flags() const { return m_flags; }
+    const Regex::Pattern& pattern() const { return m_pattern; }
+
+    bool global() const { return m_flags.contains("g"); }
+    bool sticky() const { return m_flags.contains("y"); }
+
+    // Searches the string from lastIndex for global and sticky regexps (and updates it), or
+    // from the start otherwise.
+    Optional<Regex::Match> match(Interpreter&, const String&);
+    // Like match(), but returns the array exec() does, or null.
+    Value exec(Interpreter&, GlobalObject&, const String&);
+
+    // The string a group of a match captured, or undefined if it didn't participate.
+    static Value capture(Interpreter&, const String&, const Regex::Match&, size_t group);
+    // The groups object of a match: the captures by group name, or undefined if no group has a name.
+    Value named_groups(Interpreter&, GlobalObject&, const String&, const Regex::Match&) const;
 
     Value to_string() const override;
 
@@ -50,6 +68,7 @@ private:
 
     String m_content;
     String m_flags;
+    Regex::Pattern m_pattern;
 };
 
 }
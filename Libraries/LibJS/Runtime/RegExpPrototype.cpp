@@ -28,6 +28,7 @@
 #include <AK/StringBuilder.h>
 #include <LibJS/Heap/Heap.h>
 #include <LibJS/Interpreter.h>
+#include <LibJS/Runtime/Error.h>
 #include <LibJS/Runtime/GlobalObject.h>
 #include <LibJS/Runtime/PrimitiveString.h>
 #include <LibJS/Runtime/RegExpObject.h>
@@ -36,12 +37,138 @@
 namespace JS {
 
 RegExpPrototype::RegExpPrototype(GlobalObject& global_object)
-    : RegExpObject({}, {}, *global_object.object_prototype())
+    : RegExpObject({}, {}, Regex::Pattern({}), *global_object.object_prototype())
 {
 }
 
+void RegExpPrototype::initialize(GlobalObject& global_object)
+{
+    // The prototype isn't a RegExp that can be matched with, so it gets no lastIndex.
+    Object::initialize(global_object);
+    u8 attr = Attribute::Writable | Attribute::Configurable;
+    define_native_function("exec", exec, 1, attr);
+    define_native_function("test", test, 1, attr);
+    define_native_function("toString", to_string, 0, attr);
+
+    define_native_property("flags", flags, nullptr, Attribute::Configurable);
+    define_native_property("source", source, nullptr, Attribute::Configurable);
+    define_native_property("global", global, nullptr, Attribute::Configurable);
+    define_native_property("ignoreCase", ignore_case, nullptr, Attribute::Configurable);
+    define_native_property("multiline", multiline, nullptr, Attribute::Configurable);
+    define_native_property("dotAll", dot_all, nullptr, Attribute::Configurable);
+    define_native_property("unicode", unicode, nullptr, Attribute::Configurable);
+    define_native_property("sticky", sticky, nullptr, Attribute::Configurable);
+}
+
 RegExpPrototype::~RegExpPrototype()
 {
 }
 
+static RegExpObject* regexp_object_from(Interpreter& interpreter, GlobalObject& global_object)
+{
+    auto* this_object = interpreter.this_value(global_object).to_object(interpreter, global_object);
+    if (!this_object)
+        return nullptr;
+    if (!this_object->is_regexp_object()) {
+        interpreter.throw_exception<TypeError>(ErrorType::NotA, "RegExp");
+        return nullptr;
+    }
+    return static_cast<RegExpObject*>(this_object);
+}
+
+static Value has_flag(Interpreter& interpreter, GlobalObject& global_object, char flag)
+{
+    auto* regexp_object = regexp_object_from(interpreter, global_object);
+    if (!regexp_object)
+        return {};
+    return Value(regexp_object->flags().contains(StringView(&flag, 1)));
+}
+
+JS_DEFINE_NATIVE_GETTER(RegExpPrototype::flags)
+{
+    auto* regexp_object = regexp_object_from(interpreter, global_object);
+    if (!regexp_object)
+        return {};
+    // The flags always come out in this order, whatever order they were given in.
+    StringBuilder builder;
+    for (char flag : { 'g', 'i', 'm', 's', 'u', 'y' }) {
+        if (regexp_object->flags().contains(StringView(&flag, 1)))
+            builder.append(flag);
+    }
+    return js_string(interpreter, builder.to_string());
+}
+
+JS_DEFINE_NATIVE_GETTER(RegExpPrototype::source)
+{
+    auto* regexp_object = regexp_object_from(interpreter, global_object);
+    if (!regexp_object)
+        return {};
+    if (regexp_object->content().is_empty())
+        return js_string(interpreter, "(?:)");
+    return js_string(interpreter, regexp_object->content());
+}
+
+JS_DEFINE_NATIVE_GETTER(RegExpPrototype::global)
+{
+    return has_flag(interpreter, global_object, 'g');
+}
+
+JS_DEFINE_NATIVE_GETTER(RegExpPrototype::ignore_case)
+{
+    return has_flag(interpreter, global_object, 'i');
+}
+
+JS_DEFINE_NATIVE_GETTER(RegExpPrototype::multiline)
+{
+    return has_flag(interpreter, global_object, 'm');
+}
+
+JS_DEFINE_NATIVE_GETTER(RegExpPrototype::dot_all)
+{
+    return has_flag(interpreter, global_object, 's');
+}
+
+JS_DEFINE_NATIVE_GETTER(RegExpPrototype::unicode)
+{
+    return has_flag(interpreter, global_object, 'u');
+}
+
+JS_DEFINE_NATIVE_GETTER(RegExpPrototype::sticky)
+{
+    return has_flag(interpreter, global_object, 'y');
+}
+
+JS_DEFINE_NATIVE_FUNCTION(RegExpPrototype::exec)
+{
+    auto* regexp_object = regexp_object_from(interpreter, global_object);
+    if (!regexp_object)
+        return {};
+    auto string = interpreter.argument(0).to_string(interpreter);
+    if (interpreter.exception())
+        return {};
+    return regexp_object->exec(interpreter, global_object, string);
+}
+
+JS_DEFINE_NATIVE_FUNCTION(RegExpPrototype::test)
+{
+    auto* regexp_object = regexp_object_from(interpreter, global_object);
+    if (!regexp_object)
+        return {};
+    auto string = interpreter.argument(0).to_string(interpreter);
+    if (interpreter.exception())
+        return {};
+    auto match = regexp_object->match(interpreter, string);
+    if (interpreter.exception())
+        return {};
+    return Value(match.has_value());
+}
+
+JS_DEFINE_NATIVE_FUNCTION(RegExpPrototype::to_string)
+{
+    auto* regexp_object = regexp_object_from(interpreter, global_object);
+    if (!regexp_object)
+        return {};
+    return regexp_object->to_string();
+}
+
 }
@@ -47,18 +47,20 @@ static ScriptFunction* typed_this(Interpreter& interpreter, GlobalObject& global
     return static_cast<ScriptFunction*>(this_object);
 }
 
-ScriptFunction* ScriptFunction::create(GlobalObject& global_object, const FlyString& name, const Statement& body, Vector<FunctionNode::Parameter> parameters, i32 m_function_length, LexicalEnvironment* parent_environment, bool is_arrow_function)
+ScriptFunction* ScriptFunction::create(GlobalObject& global_object, const FunctionNode& function_node, LexicalEnvironment* parent_environment, bool is_arrow_function)
 {
-    return global_object.heap().allocate<ScriptFunction>(global_object, global_object, name, body, move(parameters), m_function_length, parent_environment, *global_object.function_prototype(), is_arrow_function);
+    return global_object.heap().allocate<ScriptFunction>(global_object, global_object, function_node, parent_environment, *global_object.function_prototype(), is_arrow_function);
 }
 
-ScriptFunction::ScriptFunction(GlobalObject& global_object, const FlyString& name, const Statement& body, Vector<FunctionNode::Parameter> parameters, i32 m_function_length, LexicalEnvironment* parent_environment, Object& prototype, bool is_arrow_function)
+ScriptFunction::ScriptFunction(GlobalObject& global_object, const FunctionNode& function_node, LexicalEnvironment* parent_environment, Object& prototype, bool is_arrow_function)
     : Function(prototype, is_arrow_function ? interpreter().this_value(global_object) : Value(), {})
-    , m_name(name)
-    , m_body(body)
-    , m_parameters(move(parameters))
+    , m_name(function_node.name())
+    , m_body(function_node.parsed_body())
+    , m_lazy_body(function_node.lazy_body())
+    , m_parameters(function_node.parameters())
+    , m_environment_layout(function_node.environment_layout())
     , m_parent_environment(parent_environment)
-    , m_function_length(m_function_length)
+    , m_function_length(function_node.function_length())
     , m_is_arrow_function(is_arrow_function)
 {
 }
@@ -87,20 +89,11 @@ void ScriptFunction::visit_children(Visitor& visitor)
 
 LexicalEnvironment* ScriptFunction::create_environment()
 {
-    HashMap<FlyString, Variable> variables;
-    for (auto& parameter : m_parameters) {
-        variables.set(parameter.name, { js_undefined(), DeclarationKind::Var });
-    }
-
-    if (body().is_scope_node()) {
-        for (auto& declaration : static_cast<const ScopeNode&>(body()).variables()) {
-            for (auto& declarator : declaration.declarations()) {
-                variables.set(declarator.id().string(), { js_undefined(), DeclarationKind::Var });
-            }
-        }
-    }
+    // The body has to be parsed before the environment is created, as its variables get slots in it.
+    if (!m_body && m_lazy_body->parse())
+        m_body = m_lazy_body->body();
 
-    auto* environment = heap().allocate<LexicalEnvironment>(global_object(), move(variables), m_parent_environment, LexicalEnvironment::EnvironmentRecordType::Function);
+    auto* environment = heap().allocate<LexicalEnvironment>(global_object(), *m_environment_layout, m_parent_environment, LexicalEnvironment::EnvironmentRecordType::Function);
     environment->set_home_object(home_object());
     environment->set_current_function(*this);
     return environment;
@@ -108,6 +101,9 @@ LexicalEnvironment* ScriptFunction::create_environment()
 
 Value ScriptFunction::call(Interpreter& interpreter)
 {
+    if (!m_body)
+        return interpreter.throw_exception<SyntaxError>(m_lazy_body->syntax_error());
+
     auto& argument_values = interpreter.call_frame().arguments;
     ArgumentVector arguments;
     for (size_t i = 0; i < m_parameters.size(); ++i) {
@@ -130,7 +126,7 @@ Value ScriptFunction::call(Interpreter& interpreter)
         arguments.append({ parameter.name, value });
         interpreter.current_environment()->set(parameter.name, { value, DeclarationKind::Var });
     }
-    return interpreter.run(global_object(), m_body, arguments, ScopeType::Function);
+    return interpreter.run(global_object(), *m_body, arguments, ScopeType::Function);
 }
 
 Value ScriptFunction::construct(Interpreter& interpreter, Function&)
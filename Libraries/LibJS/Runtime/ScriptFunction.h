@@ -35,13 +35,14 @@ class ScriptFunction final : public Function {
     JS_OBJECT(ScriptFunction, Function);
 
 public:
-    static ScriptFunction* create(GlobalObject&, const FlyString& name, const Statement& body, Vector<FunctionNode::Parameter> parameters, i32 m_function_length, LexicalEnvironment* parent_environment, bool is_arrow_function = false);
+    static ScriptFunction* create(GlobalObject&, const FunctionNode&, LexicalEnvironment* parent_environment, bool is_arrow_function = false);
 
-    ScriptFunction(GlobalObject&, const FlyString& name, const Statement& body, Vector<FunctionNode::Parameter> parameters, i32 m_function_length, LexicalEnvironment* parent_environment, Object& prototype, bool is_arrow_function = false);
+    ScriptFunction(GlobalObject&, const FunctionNode&, LexicalEnvironment* parent_environment, Object& prototype, bool is_arrow_function = false);
     virtual void initialize(GlobalObject&) override;
     virtual ~ScriptFunction();
 
-    const Statement& body() const { return m_body; }
+    // Null until the first call if the function's body is parsed lazily, see LazyFunctionBody.
+    const Statement* body() const { return m_body; }
     const Vector<FunctionNode::Parameter>& parameters() const { return m_parameters; };
 
     virtual Value call(Interpreter&) override;
@@ -59,8 +60,10 @@ private:
     JS_DECLARE_NATIVE_GETTER(name_getter);
 
     FlyString m_name;
-    NonnullRefPtr<Statement> m_body;
+    RefPtr<Statement> m_body;
+    RefPtr<LazyFunctionBody> m_lazy_body;
     const Vector<FunctionNode::Parameter> m_parameters;
+    NonnullRefPtr<EnvironmentLayout> m_environment_layout;
     LexicalEnvironment* m_parent_environment { nullptr };
     i32 m_function_length;
     bool m_is_arrow_function;
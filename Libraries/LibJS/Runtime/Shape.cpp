@@ -48,6 +48,7 @@ Shape* Shape::create_put_transition(const StringOrSymbol& property_name, Propert
         return existing_shape;
     auto* new_shape = heap().allocate<Shape>(m_global_object, *this, property_name, attributes, TransitionType::Put);
     m_forward_transitions.set(key, new_shape);
+    write_barrier();
     return new_shape;
 }
 
@@ -58,12 +59,20 @@ Shape* Shape::create_configure_transition(const StringOrSymbol& property_name, P
         return existing_shape;
     auto* new_shape = heap().allocate<Shape>(m_global_object, *this, property_name, attributes, TransitionType::Configure);
     m_forward_transitions.set(key, new_shape);
+    write_barrier();
     return new_shape;
 }
 
 Shape* Shape::create_prototype_transition(Object* new_prototype)
 {
-    return heap().allocate<Shape>(m_global_object, *this, new_prototype);
+    // Objects that are all created the same way and then get the same prototype should end up
+    // sharing a shape, just like with property transitions.
+    if (auto* existing_shape = m_prototype_transitions.get(new_prototype).value_or(nullptr))
+        return existing_shape;
+    auto* new_shape = heap().allocate<Shape>(m_global_object, *this, new_prototype);
+    m_prototype_transitions.set(new_prototype, new_shape);
+    write_barrier();
+    return new_shape;
 }
 
 Shape::Shape(GlobalObject& global_object)
@@ -79,6 +88,19 @@ Shape::Shape(Shape& previous_shape, const StringOrSymbol& property_name, Propert
     , m_prototype(previous_shape.m_prototype)
     , m_transition_type(transition_type)
 {
+    // Objects being set up (prototypes, in particular) walk through a long chain of shapes that
+    // nobody ever looks at again. Rather than building a new property table for every step of
+    // the way, take over the previous shape's table. It'll rebuild its own if it's ever needed.
+    if (!previous_shape.m_property_table)
+        return;
+    m_property_table = move(previous_shape.m_property_table);
+    if (transition_type == TransitionType::Put) {
+        m_property_table->set(property_name, { m_property_table->size(), attributes });
+    } else if (transition_type == TransitionType::Configure) {
+        auto it = m_property_table->find(property_name);
+        ASSERT(it != m_property_table->end());
+        it->value.attributes = attributes;
+    }
 }
 
 Shape::Shape(Shape& previous_shape, Object* new_prototype)
@@ -87,6 +109,7 @@ Shape::Shape(Shape& previous_shape, Object* new_prototype)
     , m_prototype(new_prototype)
     , m_transition_type(TransitionType::Prototype)
 {
+    m_property_table = move(previous_shape.m_property_table);
 }
 
 Shape::~Shape()
@@ -102,10 +125,16 @@ void Shape::visit_children(Cell::Visitor& visitor)
     m_property_name.visit_children(visitor);
     for (auto& it : m_forward_transitions)
         visitor.visit(it.value);
+    for (auto& it : m_prototype_transitions) {
+        visitor.visit(it.key);
+        visitor.visit(it.value);
+    }
 
-    ensure_property_table();
-    for (auto& it : *m_property_table)
-        it.key.visit_children(visitor);
+    // A shape without a table gets its keys from the transition chain, which is visited above.
+    if (m_property_table) {
+        for (auto& it : *m_property_table)
+            it.key.visit_children(visitor);
+    }
 }
 
 Optional<PropertyMetadata> Shape::lookup(const StringOrSymbol& property_name) const
@@ -176,6 +205,7 @@ void Shape::add_property_to_unique_shape(const StringOrSymbol& property_name, Pr
     ASSERT(m_property_table);
     ASSERT(!m_property_table->contains(property_name));
     m_property_table->set(property_name, { m_property_table->size(), attributes });
+    write_barrier();
 }
 
 void Shape::reconfigure_property_in_unique_shape(const StringOrSymbol& property_name, PropertyAttributes attributes)
@@ -89,7 +89,11 @@ public:
 
     Vector<Property> property_table_ordered() const;
 
-    void set_prototype_without_transition(Object* new_prototype) { m_prototype = new_prototype; }
+    void set_prototype_without_transition(Object* new_prototype)
+    {
+        m_prototype = new_prototype;
+        write_barrier();
+    }
 
     void remove_property_from_unique_shape(const StringOrSymbol&, size_t offset);
     void add_property_to_unique_shape(const StringOrSymbol&, PropertyAttributes attributes);
@@ -106,6 +110,7 @@ private:
     mutable OwnPtr<HashMap<StringOrSymbol, PropertyMetadata>> m_property_table;
 
     HashMap<TransitionKey, Shape*> m_forward_transitions;
+    HashMap<Object*, Shape*> m_prototype_transitions;
     Shape* m_previous { nullptr };
     StringOrSymbol m_property_name;
     PropertyAttributes m_attributes { 0 };
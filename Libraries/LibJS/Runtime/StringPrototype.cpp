@@ -29,13 +29,16 @@
 #include <AK/StringBuilder.h>
 #include <LibJS/Heap/Heap.h>
 #include <LibJS/Interpreter.h>
+#include <LibJS/Runtime/Array.h>
 #include <LibJS/Runtime/Error.h>
 #include <LibJS/Runtime/GlobalObject.h>
 #include <LibJS/Runtime/PrimitiveString.h>
+#include <LibJS/Runtime/RegExpObject.h>
 #include <LibJS/Runtime/StringObject.h>
 #include <LibJS/Runtime/StringIterator.h>
 #include <LibJS/Runtime/StringPrototype.h>
 #include <LibJS/Runtime/Value.h>
+#include <ctype.h>
 #include <string.h>
 
 namespace JS {
@@ -89,6 +92,9 @@ void StringPrototype::initialize(GlobalObject& global_object)
     define_native_function("includes", includes, 1, attr);
     define_native_function("slice", slice, 2, attr);
     define_native_function("lastIndexOf", last_index_of, 1, attr);
+    define_native_function("match", match, 1, attr);
+    define_native_function("replace", replace, 2, attr);
+    define_native_function("split", split, 2, attr);
     define_native_function(global_object.interpreter().well_known_symbol_iterator(), symbol_iterator, 0, attr);
 }
 
@@ -452,6 +458,283 @@ JS_DEFINE_NATIVE_FUNCTION(StringPrototype::last_index_of)
     return Value(-1);
 }
 
+// The index of the code point after the one at the index, for stepping over empty matches.
+static size_t advance_string_index(const String& string, size_t index)
+{
+    ++index;
+    while (index < string.length() && (string[index] & 0xc0) == 0x80)
+        ++index;
+    return index;
+}
+
+static RegExpObject* regexp_object_from(Interpreter& interpreter, GlobalObject& global_object, Value value)
+{
+    if (value.is_object() && value.as_object().is_regexp_object())
+        return static_cast<RegExpObject*>(&value.as_object());
+    auto pattern = value.is_undefined() ? String::empty() : value.to_string(interpreter);
+    if (interpreter.exception())
+        return nullptr;
+    return RegExpObject::create(global_object, pattern, "");
+}
+
+JS_DEFINE_NATIVE_FUNCTION(StringPrototype::match)
+{
+    auto string = ak_string_from(interpreter, global_object);
+    if (string.is_null())
+        return {};
+    auto* regexp_object = regexp_object_from(interpreter, global_object, interpreter.argument(0));
+    if (!regexp_object)
+        return {};
+    if (!regexp_object->global())
+        return regexp_object->exec(interpreter, global_object, string);
+
+    regexp_object->put("lastIndex", Value(0));
+    auto* array = Array::create(global_object);
+    for (;;) {
+        auto match = regexp_object->match(interpreter, string);
+        if (interpreter.exception())
+            return {};
+        if (!match.has_value())
+            break;
+        auto& span = match.value().span();
+        array->indexed_properties().append(js_string(interpreter, string.substring(span.start, span.length())));
+        if (!span.length())
+            regexp_object->put("lastIndex", Value((double)advance_string_index(string, span.end)));
+    }
+    if (array->indexed_properties().is_empty())
+        return js_null();
+    return array;
+}
+
+static String expand_replacement(const String& replacement, const String& string, const Regex::Match& match, const Regex::Pattern* pattern)
+{
+    auto append_group = [&](StringBuilder& builder, size_t group) {
+        if (group < match.groups.size() && match.groups[group].has_value()) {
+            auto& span = match.groups[group].value();
+            builder.append(string.substring_view(span.start, span.length()));
+        }
+    };
+
+    StringBuilder builder;
+    auto& span = match.span();
+    size_t group_count = match.groups.size() - 1;
+    for (size_t i = 0; i < replacement.length(); ++i) {
+        char c = replacement[i];
+        char next = i + 1 < replacement.length() ? replacement[i + 1] : 0;
+        if (c != '$' || !next) {
+            builder.append(c);
+            continue;
+        }
+        if (next == '$') {
+            builder.append('$');
+            ++i;
+        } else if (next == '&') {
+            builder.append(string.substring_view(span.start, span.length()));
+            ++i;
+        } else if (next == '`') {
+            builder.append(string.substring_view(0, span.start));
+            ++i;
+        } else if (next == '\'') {
+            builder.append(string.substring_view(span.end, string.length() - span.end));
+            ++i;
+        } else if (isdigit(next)) {
+            // $nn takes precedence over $n, as long as there are that many groups.
+            size_t group = next - '0';
+            char after = i + 2 < replacement.length() ? replacement[i + 2] : 0;
+            if (isdigit(after) && group * 10 + (after - '0') >= 1 && group * 10 + (after - '0') <= group_count) {
+                append_group(builder, group * 10 + (after - '0'));
+                i += 2;
+            } else if (group >= 1 && group <= group_count) {
+                append_group(builder, group);
+                ++i;
+            } else {
+                builder.append(c);
+            }
+        } else if (next == '<' && pattern && pattern->has_group_names()) {
+            auto close = replacement.substring_view(i + 2, replacement.length() - i - 2).find_first_of('>');
+            if (!close.has_value()) {
+                builder.append(c);
+                continue;
+            }
+            auto name = replacement.substring_view(i + 2, close.value());
+            auto& group_names = pattern->group_names();
+            for (size_t group = 0; group < group_names.size(); ++group) {
+                if (group_names[group] == name)
+                    append_group(builder, group + 1);
+            }
+            i += close.value() + 2;
+        } else {
+            builder.append(c);
+        }
+    }
+    return builder.to_string();
+}
+
+JS_DEFINE_NATIVE_FUNCTION(StringPrototype::replace)
+{
+    auto string = ak_string_from(interpreter, global_object);
+    if (string.is_null())
+        return {};
+    auto search_value = interpreter.argument(0);
+    auto replace_value = interpreter.argument(1);
+
+    String replacement;
+    if (!replace_value.is_function()) {
+        replacement = replace_value.to_string(interpreter);
+        if (interpreter.exception())
+            return {};
+    }
+
+    Vector<Regex::Match> matches;
+    RegExpObject* regexp_object = nullptr;
+    if (search_value.is_object() && search_value.as_object().is_regexp_object()) {
+        regexp_object = static_cast<RegExpObject*>(&search_value.as_object());
+        bool global = regexp_object->global();
+        if (global)
+            regexp_object->put("lastIndex", Value(0));
+        for (;;) {
+            auto match = regexp_object->match(interpreter, string);
+            if (interpreter.exception())
+                return {};
+            if (!match.has_value())
+                break;
+            matches.append(match.value());
+            if (!global)
+                break;
+            auto& span = match.value().span();
+            if (!span.length())
+                regexp_object->put("lastIndex", Value((double)advance_string_index(string, span.end)));
+        }
+    } else {
+        auto search_string = search_value.to_string(interpreter);
+        if (interpreter.exception())
+            return {};
+        auto position = string.index_of(search_string);
+        if (position.has_value()) {
+            Regex::Match match;
+            match.groups.append(Regex::Span { position.value(), position.value() + search_string.length() });
+            matches.append(move(match));
+        }
+    }
+
+    StringBuilder builder;
+    size_t last_end = 0;
+    for (auto& match : matches) {
+        auto& span = match.span();
+        builder.append(string.substring_view(last_end, span.start - last_end));
+        last_end = span.end;
+
+        if (!replace_value.is_function()) {
+            builder.append(expand_replacement(replacement, string, match, regexp_object ? &regexp_object->pattern() : nullptr));
+            continue;
+        }
+
+        MarkedValueList arguments(interpreter.heap());
+        for (size_t i = 0; i < match.groups.size(); ++i)
+            arguments.append(RegExpObject::capture(interpreter, string, match, i));
+        arguments.append(Value((double)span.start));
+        arguments.append(js_string(interpreter, string));
+        if (regexp_object && regexp_object->pattern().has_group_names())
+            arguments.append(regexp_object->named_groups(interpreter, global_object, string, match));
+        auto result = interpreter.call(replace_value.as_function(), js_undefined(), move(arguments));
+        if (interpreter.exception())
+            return {};
+        auto result_string = result.to_string(interpreter);
+        if (interpreter.exception())
+            return {};
+        builder.append(result_string);
+    }
+    builder.append(string.substring_view(last_end, string.length() - last_end));
+    return js_string(interpreter, builder.to_string());
+}
+
+JS_DEFINE_NATIVE_FUNCTION(StringPrototype::split)
+{
+    auto string = ak_string_from(interpreter, global_object);
+    if (string.is_null())
+        return {};
+    auto separator = interpreter.argument(0);
+    size_t limit = NumericLimits<u32>::max();
+    if (!interpreter.argument(1).is_undefined()) {
+        limit = interpreter.argument(1).to_size_t(interpreter);
+        if (interpreter.exception())
+            return {};
+    }
+
+    auto* array = Array::create(global_object);
+    if (limit == 0)
+        return array;
+    auto append = [&](Value value) {
+        array->indexed_properties().append(value);
+        return array->indexed_properties().array_like_size() < limit;
+    };
+    auto append_part = [&](size_t start, size_t end) {
+        return append(js_string(interpreter, string.substring(start, end - start)));
+    };
+
+    if (separator.is_undefined()) {
+        append(js_string(interpreter, string));
+        return array;
+    }
+
+    if (separator.is_object() && separator.as_object().is_regexp_object()) {
+        // This searches on its own, leaving lastIndex alone.
+        auto& pattern = static_cast<RegExpObject&>(separator.as_object()).pattern();
+        if (string.is_empty()) {
+            if (!pattern.search(string).has_value())
+                append(js_string(interpreter, string));
+            return array;
+        }
+
+        size_t part_start = 0;
+        size_t position = 0;
+        while (position < string.length()) {
+            auto match = pattern.search(string, position);
+            if (!match.has_value() || match.value().span().start >= string.length())
+                break;
+            auto& span = match.value().span();
+            if (span.end == part_start) {
+                position = advance_string_index(string, position);
+                continue;
+            }
+            if (!append_part(part_start, span.start))
+                return array;
+            for (size_t i = 1; i < match.value().groups.size(); ++i) {
+                if (!append(RegExpObject::capture(interpreter, string, match.value(), i)))
+                    return array;
+            }
+            part_start = position = span.end;
+        }
+        append_part(part_start, string.length());
+        return array;
+    }
+
+    auto separator_string = separator.to_string(interpreter);
+    if (interpreter.exception())
+        return {};
+    if (separator_string.is_empty()) {
+        for (size_t i = 0; i < string.length();) {
+            auto next = advance_string_index(string, i);
+            if (!append_part(i, next))
+                break;
+            i = next;
+        }
+        return array;
+    }
+
+    size_t part_start = 0;
+    for (;;) {
+        auto position = string.index_of(separator_string, part_start);
+        if (!position.has_value())
+            break;
+        if (!append_part(part_start, position.value()))
+            return array;
+        part_start = position.value() + separator_string.length();
+    }
+    append_part(part_start, string.length());
+    return array;
+}
+
 JS_DEFINE_NATIVE_FUNCTION(StringPrototype::symbol_iterator)
 {
     auto this_object = interpreter.this_value(global_object);
@@ -60,6 +60,9 @@ private:
     JS_DECLARE_NATIVE_FUNCTION(includes);
     JS_DECLARE_NATIVE_FUNCTION(slice);
     JS_DECLARE_NATIVE_FUNCTION(last_index_of);
+    JS_DECLARE_NATIVE_FUNCTION(match);
+    JS_DECLARE_NATIVE_FUNCTION(replace);
+    JS_DECLARE_NATIVE_FUNCTION(split);
 
     JS_DECLARE_NATIVE_FUNCTION(symbol_iterator);
 };
@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <LibJS/Interpreter.h>
+#include <LibJS/Runtime/GlobalObject.h>
+#include <LibJS/Runtime/TypedArray.h>
+
+namespace JS {
+
+TypedArrayBase::TypedArrayBase(ArrayBuffer& array_buffer, size_t byte_offset, size_t array_length, size_t element_size, Object& prototype)
+    : Object(prototype)
+    , m_viewed_array_buffer(&array_buffer)
+    , m_data(array_buffer.buffer().data() + byte_offset)
+    , m_byte_offset(byte_offset)
+    , m_array_length(array_length)
+    , m_element_size(element_size)
+{
+    ASSERT(byte_offset + array_length * element_size <= array_buffer.byte_length());
+}
+
+TypedArrayBase::~TypedArrayBase()
+{
+}
+
+void TypedArrayBase::visit_children(Visitor& visitor)
+{
+    Object::visit_children(visitor);
+    visitor.visit(m_viewed_array_buffer);
+}
+
+template<typename T>
+static Value element_to_value(T element)
+{
+    if constexpr (IsSame<T, ClampedU8>::value)
+        return Value((i32)element.value);
+    else
+        return Value(static_cast<double>(element));
+}
+
+template<typename T>
+bool TypedArray<T>::put_by_index(u32 property_index, Value value)
+{
+    // Stores past the end of a typed array are silently dropped.
+    if (property_index >= array_length())
+        return true;
+    if (value.is_number()) {
+        data()[property_index] = number_to_element<T>(value.as_double());
+        return true;
+    }
+    auto number = value.to_number(interpreter());
+    if (interpreter().exception())
+        return {};
+    data()[property_index] = number_to_element<T>(number.as_double());
+    return true;
+}
+
+template<typename T>
+Value TypedArray<T>::get_by_index(u32 property_index) const
+{
+    if (property_index >= array_length())
+        return js_undefined();
+    return element_to_value<T>(data()[property_index]);
+}
+
+#define __JS_ENUMERATE(ClassName, snake_name, PrototypeName, ConstructorName, Type)                                                                     \
+    template class TypedArray<Type>;                                                                                                                    \
+                                                                                                                                                        \
+    ClassName* ClassName::create(GlobalObject& global_object, size_t array_length)                                                                      \
+    {                                                                                                                                                   \
+        auto* array_buffer = ArrayBuffer::create(global_object, array_length * sizeof(Type));                                                           \
+        return create(global_object, *array_buffer, 0, array_length);                                                                                   \
+    }                                                                                                                                                   \
+                                                                                                                                                        \
+    ClassName* ClassName::create(GlobalObject& global_object, ArrayBuffer& array_buffer, size_t byte_offset, size_t array_length)                       \
+    {                                                                                                                                                   \
+        auto& interpreter = global_object.interpreter();                                                                                                \
+        return interpreter.heap().allocate<ClassName>(global_object, array_buffer, byte_offset, array_length, *global_object.snake_name##_prototype()); \
+    }                                                                                                                                                   \
+                                                                                                                                                        \
+    ClassName::ClassName(ArrayBuffer& array_buffer, size_t byte_offset, size_t array_length, Object& prototype)                                         \
+        : TypedArray(array_buffer, byte_offset, array_length, prototype)                                                                                \
+    {                                                                                                                                                   \
+    }                                                                                                                                                   \
+                                                                                                                                                        \
+    ClassName::~ClassName() { }                                                                                                                         \
+                                                                                                                                                        \
+    TypedArrayBase* ClassName::create_subarray(GlobalObject& global_object, size_t byte_offset, size_t array_length)                                    \
+    {                                                                                                                                                   \
+        return create(global_object, viewed_array_buffer(), byte_offset, array_length);                                                                 \
+    }
+JS_ENUMERATE_TYPED_ARRAYS
+#undef __JS_ENUMERATE
+
+}
@@ -0,0 +1,146 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/StdLibExtras.h>
+#include <LibJS/Runtime/ArrayBuffer.h>
+#include <LibJS/Runtime/Object.h>
+#include <math.h>
+
+namespace JS {
+
+// The element type of Uint8ClampedArray. Stores round and clamp to [0, 255] instead of wrapping around.
+struct ClampedU8 {
+    u8 value;
+};
+
+// ToUint8Clamp: rounds to the nearest integer, with ties going to the even one.
+inline u8 clamp_to_u8(double number)
+{
+    if (__builtin_isnan(number) || number <= 0)
+        return 0;
+    if (number >= 255)
+        return 255;
+    auto floored = floor(number);
+    if (floored + 0.5 < number)
+        return floored + 1;
+    if (number < floored + 0.5)
+        return floored;
+    auto result = (u8)floored;
+    return result % 2 == 0 ? result : result + 1;
+}
+
+// Converts a number to an element the way a store into a typed array of that element type does.
+template<typename T>
+inline T number_to_element(double number)
+{
+    if constexpr (IsSame<T, ClampedU8>::value) {
+        return { clamp_to_u8(number) };
+    } else if constexpr (IsSame<T, float>::value || IsSame<T, double>::value) {
+        return static_cast<T>(number);
+    } else {
+        // Integer elements wrap around modulo 2^32 before they are truncated to the element size.
+        if (__builtin_isnan(number) || __builtin_isinf(number))
+            return 0;
+        auto integer = number < 0 ? -floor(-number) : floor(number);
+        auto wrapped = fmod(integer, 4294967296.0);
+        if (wrapped < 0)
+            wrapped += 4294967296.0;
+        return static_cast<T>(static_cast<u32>(wrapped));
+    }
+}
+
+class TypedArrayBase : public Object {
+    JS_OBJECT(TypedArrayBase, Object);
+
+public:
+    virtual ~TypedArrayBase() override;
+
+    ArrayBuffer& viewed_array_buffer() { return *m_viewed_array_buffer; }
+    const ArrayBuffer& viewed_array_buffer() const { return *m_viewed_array_buffer; }
+    size_t byte_offset() const { return m_byte_offset; }
+    size_t array_length() const { return m_array_length; }
+    size_t element_size() const { return m_element_size; }
+    size_t byte_length() const { return m_array_length * m_element_size; }
+
+    u8* raw_data() { return m_data; }
+    const u8* raw_data() const { return m_data; }
+
+    // Creates a typed array of the same type that views part of this one's buffer.
+    virtual TypedArrayBase* create_subarray(GlobalObject&, size_t byte_offset, size_t array_length) = 0;
+
+protected:
+    TypedArrayBase(ArrayBuffer&, size_t byte_offset, size_t array_length, size_t element_size, Object& prototype);
+
+private:
+    virtual bool is_typed_array() const final { return true; }
+    virtual void visit_children(Visitor&) override;
+
+    ArrayBuffer* m_viewed_array_buffer { nullptr };
+    // ArrayBuffers never reallocate their storage, so the start of the view is computed once.
+    u8* m_data { nullptr };
+    size_t m_byte_offset { 0 };
+    size_t m_array_length { 0 };
+    size_t m_element_size { 0 };
+};
+
+template<typename T>
+class TypedArray : public TypedArrayBase {
+public:
+    T* data() { return reinterpret_cast<T*>(raw_data()); }
+    const T* data() const { return reinterpret_cast<const T*>(raw_data()); }
+
+    virtual bool put_by_index(u32 property_index, Value) override;
+    virtual Value get_by_index(u32 property_index) const override;
+
+protected:
+    TypedArray(ArrayBuffer& array_buffer, size_t byte_offset, size_t array_length, Object& prototype)
+        : TypedArrayBase(array_buffer, byte_offset, array_length, sizeof(T), prototype)
+    {
+    }
+};
+
+#define JS_DECLARE_TYPED_ARRAY(ClassName, snake_name, PrototypeName, ConstructorName, Type)                       \
+    class ClassName final : public TypedArray<Type> {                                                             \
+        JS_OBJECT(ClassName, TypedArray<Type>);                                                                   \
+                                                                                                                  \
+    public:                                                                                                       \
+        static ClassName* create(GlobalObject&, size_t array_length);                                             \
+        static ClassName* create(GlobalObject&, ArrayBuffer&, size_t byte_offset, size_t array_length);           \
+                                                                                                                  \
+        ClassName(ArrayBuffer&, size_t byte_offset, size_t array_length, Object& prototype);                      \
+        virtual ~ClassName() override;                                                                            \
+                                                                                                                  \
+        virtual TypedArrayBase* create_subarray(GlobalObject&, size_t byte_offset, size_t array_length) override; \
+    };
+
+#define __JS_ENUMERATE(ClassName, snake_name, PrototypeName, ConstructorName, Type)     \
+    JS_DECLARE_TYPED_ARRAY(ClassName, snake_name, PrototypeName, ConstructorName, Type)
+JS_ENUMERATE_TYPED_ARRAYS
+#undef __JS_ENUMERATE
+
+}
@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <LibJS/Interpreter.h>
+#include <LibJS/Runtime/Error.h>
+#include <LibJS/Runtime/GlobalObject.h>
+#include <LibJS/Runtime/TypedArray.h>
+#include <LibJS/Runtime/TypedArrayConstructor.h>
+#include <string.h>
+
+namespace JS {
+
+template<typename ArrayType, typename ElementType>
+static Value construct_typed_array(Interpreter& interpreter, GlobalObject& global_object, const char* class_name)
+{
+    constexpr size_t element_size = sizeof(ElementType);
+    auto first_argument = interpreter.argument(0);
+
+    if (!first_argument.is_object()) {
+        auto length = first_argument.to_index(interpreter);
+        if (interpreter.exception())
+            return {};
+        if ((u64)length * element_size > ArrayBuffer::max_byte_length)
+            return interpreter.throw_exception<RangeError>(ErrorType::ArrayBufferInvalidLength);
+        return ArrayType::create(global_object, length);
+    }
+
+    auto& object = first_argument.as_object();
+
+    if (object.is_array_buffer()) {
+        auto& array_buffer = static_cast<ArrayBuffer&>(object);
+        auto byte_offset = interpreter.argument(1).to_index(interpreter);
+        if (interpreter.exception())
+            return {};
+        if (byte_offset % element_size != 0)
+            return interpreter.throw_exception<RangeError>(ErrorType::TypedArrayInvalidByteOffset, class_name, element_size);
+
+        size_t length;
+        if (interpreter.argument(2).is_undefined()) {
+            if (array_buffer.byte_length() % element_size != 0)
+                return interpreter.throw_exception<RangeError>(ErrorType::TypedArrayInvalidBufferLength, class_name, element_size);
+            if (byte_offset > array_buffer.byte_length())
+                return interpreter.throw_exception<RangeError>(ErrorType::TypedArrayOutOfRange, class_name);
+            length = (array_buffer.byte_length() - byte_offset) / element_size;
+        } else {
+            length = interpreter.argument(2).to_index(interpreter);
+            if (interpreter.exception())
+                return {};
+            if ((u64)byte_offset + (u64)length * element_size > array_buffer.byte_length())
+                return interpreter.throw_exception<RangeError>(ErrorType::TypedArrayOutOfRange, class_name);
+        }
+        return ArrayType::create(global_object, array_buffer, byte_offset, length);
+    }
+
+    if (object.is_typed_array()) {
+        auto& source = static_cast<TypedArrayBase&>(object);
+        auto* typed_array = ArrayType::create(global_object, source.array_length());
+        if (StringView(source.class_name()) == class_name) {
+            memcpy(typed_array->raw_data(), source.raw_data(), source.byte_length());
+            return typed_array;
+        }
+        for (size_t i = 0; i < source.array_length(); ++i)
+            typed_array->put_by_index(i, source.get(i));
+        return typed_array;
+    }
+
+    // FIXME: Iterables should go through their iterator instead of being treated as array-likes.
+    auto length_value = object.get("length");
+    if (interpreter.exception())
+        return {};
+    auto length = length_value.to_size_t(interpreter);
+    if (interpreter.exception())
+        return {};
+    if ((u64)length * element_size > ArrayBuffer::max_byte_length)
+        return interpreter.throw_exception<RangeError>(ErrorType::ArrayBufferInvalidLength);
+    auto* typed_array = ArrayType::create(global_object, length);
+    for (size_t i = 0; i < length; ++i) {
+        auto value = object.get(i).value_or(js_undefined());
+        if (interpreter.exception())
+            return {};
+        typed_array->put_by_index(i, value);
+        if (interpreter.exception())
+            return {};
+    }
+    return typed_array;
+}
+
+#define __JS_ENUMERATE(ClassName, snake_name, PrototypeName, ConstructorName, Type)              \
+    ConstructorName::ConstructorName(GlobalObject& global_object)                                \
+        : NativeFunction(#ClassName, *global_object.function_prototype())                        \
+    {                                                                                            \
+    }                                                                                            \
+                                                                                                 \
+    void ConstructorName::initialize(GlobalObject& global_object)                                \
+    {                                                                                            \
+        NativeFunction::initialize(global_object);                                               \
+        define_property("prototype", global_object.snake_name##_prototype(), 0);                 \
+        define_property("length", Value(3), Attribute::Configurable);                            \
+        define_property("BYTES_PER_ELEMENT", Value((i32)sizeof(Type)), 0);                       \
+    }                                                                                            \
+                                                                                                 \
+    ConstructorName::~ConstructorName() { }                                                      \
+                                                                                                 \
+    Value ConstructorName::call(Interpreter& interpreter)                                        \
+    {                                                                                            \
+        return interpreter.throw_exception<TypeError>(ErrorType::CallWithoutNew, #ClassName);    \
+    }                                                                                            \
+                                                                                                 \
+    Value ConstructorName::construct(Interpreter& interpreter, Function&)                        \
+    {                                                                                            \
+        return construct_typed_array<ClassName, Type>(interpreter, global_object(), #ClassName); \
+    }
+JS_ENUMERATE_TYPED_ARRAYS
+#undef __JS_ENUMERATE
+
+}
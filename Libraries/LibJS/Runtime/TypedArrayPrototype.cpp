@@ -0,0 +1,223 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <AK/Function.h>
+#include <AK/Vector.h>
+#include <LibJS/Interpreter.h>
+#include <LibJS/Runtime/Error.h>
+#include <LibJS/Runtime/GlobalObject.h>
+#include <LibJS/Runtime/TypedArray.h>
+#include <LibJS/Runtime/TypedArrayPrototype.h>
+#include <string.h>
+
+namespace JS {
+
+TypedArrayPrototype::TypedArrayPrototype(GlobalObject& global_object)
+    : Object(*global_object.object_prototype())
+{
+}
+
+void TypedArrayPrototype::initialize(GlobalObject& global_object)
+{
+    Object::initialize(global_object);
+    u8 attr = Attribute::Writable | Attribute::Configurable;
+
+    define_native_property("buffer", buffer_getter, nullptr, Attribute::Configurable);
+    define_native_property("byteLength", byte_length_getter, nullptr, Attribute::Configurable);
+    define_native_property("byteOffset", byte_offset_getter, nullptr, Attribute::Configurable);
+    define_native_property("length", length_getter, nullptr, Attribute::Configurable);
+    define_native_function("fill", fill, 1, attr);
+    define_native_function("set", set, 1, attr);
+    define_native_function("subarray", subarray, 2, attr);
+
+    define_native_property(global_object.interpreter().well_known_symbol_to_string_tag(), to_string_tag_getter, nullptr, Attribute::Configurable);
+}
+
+TypedArrayPrototype::~TypedArrayPrototype()
+{
+}
+
+static TypedArrayBase* typed_this(Interpreter& interpreter, GlobalObject& global_object)
+{
+    auto* this_object = interpreter.this_value(global_object).to_object(interpreter, global_object);
+    if (!this_object)
+        return nullptr;
+    if (!this_object->is_typed_array()) {
+        interpreter.throw_exception<TypeError>(ErrorType::NotA, "TypedArray");
+        return nullptr;
+    }
+    return static_cast<TypedArrayBase*>(this_object);
+}
+
+JS_DEFINE_NATIVE_GETTER(TypedArrayPrototype::buffer_getter)
+{
+    auto* typed_array = typed_this(interpreter, global_object);
+    if (!typed_array)
+        return {};
+    return &typed_array->viewed_array_buffer();
+}
+
+JS_DEFINE_NATIVE_GETTER(TypedArrayPrototype::byte_length_getter)
+{
+    auto* typed_array = typed_this(interpreter, global_object);
+    if (!typed_array)
+        return {};
+    return Value((double)typed_array->byte_length());
+}
+
+JS_DEFINE_NATIVE_GETTER(TypedArrayPrototype::byte_offset_getter)
+{
+    auto* typed_array = typed_this(interpreter, global_object);
+    if (!typed_array)
+        return {};
+    return Value((double)typed_array->byte_offset());
+}
+
+JS_DEFINE_NATIVE_GETTER(TypedArrayPrototype::length_getter)
+{
+    auto* typed_array = typed_this(interpreter, global_object);
+    if (!typed_array)
+        return {};
+    return Value((double)typed_array->array_length());
+}
+
+JS_DEFINE_NATIVE_GETTER(TypedArrayPrototype::to_string_tag_getter)
+{
+    auto this_value = interpreter.this_value(global_object);
+    if (!this_value.is_object() || !this_value.as_object().is_typed_array())
+        return js_undefined();
+    return js_string(interpreter, this_value.as_object().class_name());
+}
+
+JS_DEFINE_NATIVE_FUNCTION(TypedArrayPrototype::fill)
+{
+    auto* typed_array = typed_this(interpreter, global_object);
+    if (!typed_array)
+        return {};
+    auto value = interpreter.argument(0).to_number(interpreter);
+    if (interpreter.exception())
+        return {};
+    auto length = typed_array->array_length();
+    auto start = resolve_relative_index(interpreter, interpreter.argument(1), length, 0);
+    if (interpreter.exception())
+        return {};
+    auto end = resolve_relative_index(interpreter, interpreter.argument(2), length, length);
+    if (interpreter.exception())
+        return {};
+    for (size_t i = start; i < end; ++i)
+        typed_array->put(i, value);
+    return typed_array;
+}
+
+JS_DEFINE_NATIVE_FUNCTION(TypedArrayPrototype::set)
+{
+    auto* typed_array = typed_this(interpreter, global_object);
+    if (!typed_array)
+        return {};
+    auto source_value = interpreter.argument(0);
+    auto offset = interpreter.argument(1).to_index(interpreter);
+    if (interpreter.exception())
+        return {};
+
+    if (source_value.is_object() && source_value.as_object().is_typed_array()) {
+        auto& source = static_cast<TypedArrayBase&>(source_value.as_object());
+        if ((u64)source.array_length() + offset > typed_array->array_length()) {
+            interpreter.throw_exception<RangeError>(ErrorType::TypedArrayOutOfRange, "Source");
+            return {};
+        }
+        // Arrays of the same type are copied byte for byte; memmove() takes care of views into the same buffer.
+        if (StringView(source.class_name()) == typed_array->class_name()) {
+            memmove(typed_array->raw_data() + offset * typed_array->element_size(), source.raw_data(), source.byte_length());
+            return js_undefined();
+        }
+        // Otherwise every element is converted, so read them all first in case the two arrays overlap.
+        Vector<Value> values;
+        values.ensure_capacity(source.array_length());
+        for (size_t i = 0; i < source.array_length(); ++i)
+            values.unchecked_append(source.get(i));
+        for (size_t i = 0; i < values.size(); ++i)
+            typed_array->put(offset + i, values[i]);
+        return js_undefined();
+    }
+
+    auto* source = source_value.to_object(interpreter, global_object);
+    if (!source)
+        return {};
+    auto length_value = source->get("length");
+    if (interpreter.exception())
+        return {};
+    auto length = length_value.to_size_t(interpreter);
+    if (interpreter.exception())
+        return {};
+    if ((u64)length + offset > typed_array->array_length()) {
+        interpreter.throw_exception<RangeError>(ErrorType::TypedArrayOutOfRange, "Source");
+        return {};
+    }
+    for (size_t i = 0; i < length; ++i) {
+        auto value = source->get(i).value_or(js_undefined());
+        if (interpreter.exception())
+            return {};
+        typed_array->put(offset + i, value);
+        if (interpreter.exception())
+            return {};
+    }
+    return js_undefined();
+}
+
+JS_DEFINE_NATIVE_FUNCTION(TypedArrayPrototype::subarray)
+{
+    auto* typed_array = typed_this(interpreter, global_object);
+    if (!typed_array)
+        return {};
+    auto length = typed_array->array_length();
+    auto begin = resolve_relative_index(interpreter, interpreter.argument(0), length, 0);
+    if (interpreter.exception())
+        return {};
+    auto end = resolve_relative_index(interpreter, interpreter.argument(1), length, length);
+    if (interpreter.exception())
+        return {};
+    auto new_length = end > begin ? end - begin : 0;
+    auto byte_offset = typed_array->byte_offset() + begin * typed_array->element_size();
+    return typed_array->create_subarray(global_object, byte_offset, new_length);
+}
+
+#define __JS_ENUMERATE(ClassName, snake_name, PrototypeName, ConstructorName, Type) \
+    PrototypeName::PrototypeName(GlobalObject& global_object)                       \
+        : Object(*global_object.typed_array_prototype())                            \
+    {                                                                               \
+    }                                                                               \
+                                                                                    \
+    void PrototypeName::initialize(GlobalObject& global_object)                     \
+    {                                                                               \
+        Object::initialize(global_object);                                          \
+        define_property("BYTES_PER_ELEMENT", Value((i32)sizeof(Type)), 0);          \
+    }                                                                               \
+                                                                                    \
+    PrototypeName::~PrototypeName() { }
+JS_ENUMERATE_TYPED_ARRAYS
+#undef __JS_ENUMERATE
+
+}
@@ -25,7 +25,9 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <AK/DoubleConversion.h>
 #include <AK/FlyString.h>
+#include <AK/NumericLimits.h>
 #include <AK/String.h>
 #include <AK/StringBuilder.h>
 #include <AK/Utf8View.h>
@@ -99,6 +101,41 @@ Function& Value::as_function()
     return static_cast<Function&>(as_object());
 }
 
+const char* Value::typeof_string() const
+{
+    switch (m_type) {
+    case Type::Undefined:
+        return "undefined";
+    case Type::Null:
+        // yes, this is on purpose. yes, this is how javascript works.
+        // yes, it's silly.
+        return "object";
+    case Type::Number:
+        return "number";
+    case Type::String:
+        return "string";
+    case Type::Object:
+        if (is_function())
+            return "function";
+        return "object";
+    case Type::Boolean:
+        return "boolean";
+    case Type::Symbol:
+        return "symbol";
+    case Type::BigInt:
+        return "bigint";
+    default:
+        ASSERT_NOT_REACHED();
+    }
+}
+
+static String number_to_string(double value)
+{
+    char buffer[double_string_buffer_size];
+    auto length = format_double(value, buffer);
+    return String(buffer, length);
+}
+
 String Value::to_string_without_side_effects() const
 {
     switch (m_type) {
@@ -115,7 +152,7 @@ String Value::to_string_without_side_effects() const
             return is_negative_infinity() ? "-Infinity" : "Infinity";
         if (is_integer())
             return String::number(as_i32());
-        return String::format("%.4f", m_value.as_double);
+        return number_to_string(m_value.as_double);
     case Type::String:
         return m_value.as_string->string();
     case Type::Symbol:
@@ -159,7 +196,7 @@ String Value::to_string(Interpreter& interpreter) const
             return is_negative_infinity() ? "-Infinity" : "Infinity";
         if (is_integer())
             return String::number(as_i32());
-        return String::format("%.4f", m_value.as_double);
+        return number_to_string(m_value.as_double);
     case Type::String:
         return m_value.as_string->string();
     case Type::Symbol:
@@ -369,6 +406,23 @@ size_t Value::to_size_t(Interpreter& interpreter) const
     return number.as_size_t();
 }
 
+size_t Value::to_index(Interpreter& interpreter) const
+{
+    if (is_undefined() || is_empty())
+        return 0;
+    auto number = to_number(interpreter);
+    if (interpreter.exception())
+        return 0;
+    if (number.is_nan())
+        return 0;
+    auto integer = number.as_double() < 0 ? -floor(-number.as_double()) : floor(number.as_double());
+    if (integer < 0 || integer > NumericLimits<u32>::max()) {
+        interpreter.throw_exception<RangeError>(ErrorType::InvalidIndex);
+        return 0;
+    }
+    return (size_t)integer;
+}
+
 Value greater_than(Interpreter& interpreter, Value lhs, Value rhs)
 {
     TriState relation = abstract_relation(interpreter, false, lhs, rhs);
@@ -572,15 +626,18 @@ Value add(Interpreter& interpreter, Value lhs, Value rhs)
         return {};
 
     if (lhs_primitive.is_string() || rhs_primitive.is_string()) {
-        auto lhs_string = lhs_primitive.to_string(interpreter);
+        auto* lhs_string = lhs_primitive.to_primitive_string(interpreter);
         if (interpreter.exception())
             return {};
-        auto rhs_string = rhs_primitive.to_string(interpreter);
+        auto* rhs_string = rhs_primitive.to_primitive_string(interpreter);
         if (interpreter.exception())
             return {};
-        StringBuilder builder(lhs_string.length() + rhs_string.length());
-        builder.append(lhs_string);
-        builder.append(rhs_string);
+        // Short strings are cheaper to just copy than to keep around as separate pieces.
+        if (lhs_string->length() + rhs_string->length() >= 32)
+            return js_rope_string(interpreter, *lhs_string, *rhs_string);
+        StringBuilder builder(lhs_string->length() + rhs_string->length());
+        builder.append(lhs_string->string());
+        builder.append(rhs_string->string());
         return js_string(interpreter, builder.to_string());
     }
 
@@ -806,6 +863,11 @@ bool same_value_non_numeric(Interpreter&, Value lhs, Value rhs)
     case Value::Type::Null:
         return true;
     case Value::Type::String:
+        if (&lhs.as_string() == &rhs.as_string())
+            return true;
+        // Checking the lengths first saves flattening ropes that can't be equal.
+        if (lhs.as_string().length() != rhs.as_string().length())
+            return false;
         return lhs.as_string().string() == rhs.as_string().string();
     case Value::Type::Symbol:
         return &lhs.as_symbol() == &rhs.as_symbol();
@@ -0,0 +1,393 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <LibJS/AST.h>
+#include <LibJS/Runtime/EnvironmentLayout.h>
+#include <LibJS/ScopeAnalysis.h>
+
+namespace JS {
+
+void ScopeAnalysis::analyze(const Program& program)
+{
+    ScopeAnalysis analysis;
+    program.analyze_scopes(analysis);
+    analysis.finish();
+}
+
+void ScopeAnalysis::analyze(const FunctionExpression& function)
+{
+    // A function created by the Function constructor, which is analyzed on its own.
+    ScopeAnalysis analysis;
+    analysis.push_environment(EnvironmentLayout::create(), false);
+    function.analyze_scopes(analysis);
+    analysis.pop_environment();
+    analysis.finish();
+}
+
+void ScopeAnalysis::analyze(const BlockStatement& function_body, const ScopeAnalysisContext& context)
+{
+    ScopeAnalysis analysis;
+    analysis.m_environments = context.environments;
+    analysis.m_dynamic_bindings = context.dynamic_bindings;
+    // The body runs directly in the function's environment, which is the innermost one captured.
+    for (auto& child : function_body.children())
+        child.analyze_scopes(analysis);
+    analysis.finish();
+}
+
+NonnullRefPtr<ScopeAnalysisContext> ScopeAnalysis::capture_context()
+{
+    auto context = adopt(*new ScopeAnalysisContext);
+    context->environments = m_environments;
+    m_captured_contexts.append(context);
+    return context;
+}
+
+void ScopeAnalysis::push_environment(EnvironmentLayout& layout, bool parent_is_known)
+{
+    m_environments.append({ layout, parent_is_known });
+}
+
+void ScopeAnalysis::pop_environment()
+{
+    m_environments.take_last();
+}
+
+void ScopeAnalysis::resolve(const Identifier& identifier)
+{
+    u32 hops = 0;
+    for (ssize_t i = m_environments.size() - 1; i >= 0; --i) {
+        auto& environment = m_environments[i];
+        auto index = environment.layout->index_of(identifier.string());
+        if (index.has_value()) {
+            identifier.m_environment_coordinate = EnvironmentCoordinate { hops, index.value() };
+            m_resolved_identifiers.append(&identifier);
+            return;
+        }
+        if (!environment.parent_is_known)
+            return;
+        ++hops;
+    }
+}
+
+void ScopeAnalysis::finish()
+{
+    // Class declarations add their bindings to whatever environment is current when they run,
+    // which may shadow the slot we found.
+    if (m_dynamic_bindings.is_empty())
+        return;
+    for (auto& context : m_captured_contexts)
+        context->dynamic_bindings = m_dynamic_bindings;
+    for (auto* identifier : m_resolved_identifiers) {
+        if (m_dynamic_bindings.contains(identifier->string()))
+            identifier->m_environment_coordinate.clear();
+    }
+}
+
+void ScopeNode::analyze_scopes(ScopeAnalysis& analysis) const
+{
+    // Mirrors Interpreter::enter_scope(): a program's variables live on the global object,
+    // and blocks without variables don't get an environment.
+    auto& layout = environment_layout();
+    bool has_environment = !is_program() && !layout.is_empty();
+    if (has_environment)
+        analysis.push_environment(layout);
+    for (auto& child : m_children)
+        child.analyze_scopes(analysis);
+    if (has_environment)
+        analysis.pop_environment();
+}
+
+void FunctionNode::analyze_function_scopes(ScopeAnalysis& analysis, bool parent_is_known) const
+{
+    analysis.push_environment(environment_layout(), parent_is_known);
+    for (auto& parameter : m_parameters) {
+        if (parameter.default_value)
+            parameter.default_value->analyze_scopes(analysis);
+    }
+    if (m_lazy_body) {
+        // The body gets analyzed once it's parsed.
+        m_lazy_body->set_scope_analysis_context(analysis.capture_context());
+    } else if (m_body->is_scope_node()) {
+        // The body runs directly in the function's environment.
+        for (auto& child : static_cast<const ScopeNode&>(*m_body).children())
+            child.analyze_scopes(analysis);
+    } else {
+        m_body->analyze_scopes(analysis);
+    }
+    analysis.pop_environment();
+}
+
+void FunctionDeclaration::analyze_scopes(ScopeAnalysis& analysis) const
+{
+    analyze_function_scopes(analysis, false);
+}
+
+void FunctionExpression::analyze_scopes(ScopeAnalysis& analysis) const
+{
+    analyze_function_scopes(analysis, true);
+}
+
+void ExpressionStatement::analyze_scopes(ScopeAnalysis& analysis) const
+{
+    m_expression->analyze_scopes(analysis);
+}
+
+void ReturnStatement::analyze_scopes(ScopeAnalysis& analysis) const
+{
+    if (m_argument)
+        m_argument->analyze_scopes(analysis);
+}
+
+void IfStatement::analyze_scopes(ScopeAnalysis& analysis) const
+{
+    m_predicate->analyze_scopes(analysis);
+    m_consequent->analyze_scopes(analysis);
+    if (m_alternate)
+        m_alternate->analyze_scopes(analysis);
+}
+
+void WhileStatement::analyze_scopes(ScopeAnalysis& analysis) const
+{
+    m_test->analyze_scopes(analysis);
+    m_body->analyze_scopes(analysis);
+}
+
+void DoWhileStatement::analyze_scopes(ScopeAnalysis& analysis) const
+{
+    m_test->analyze_scopes(analysis);
+    m_body->analyze_scopes(analysis);
+}
+
+void ForStatement::analyze_scopes(ScopeAnalysis& analysis) const
+{
+    // A let or const initializer gets a wrapper block, see ForStatement::execute().
+    RefPtr<EnvironmentLayout> layout;
+    if (m_init && m_init->is_variable_declaration()) {
+        auto& declaration = static_cast<const VariableDeclaration&>(*m_init);
+        if (declaration.declaration_kind() != DeclarationKind::Var) {
+            layout = EnvironmentLayout::create();
+            for (auto& declarator : declaration.declarations())
+                layout->add(declarator.id().string(), declaration.declaration_kind());
+        }
+    }
+
+    bool has_environment = layout && !layout->is_empty();
+    if (has_environment)
+        analysis.push_environment(*layout);
+    if (m_init)
+        m_init->analyze_scopes(analysis);
+    if (m_test)
+        m_test->analyze_scopes(analysis);
+    if (m_update)
+        m_update->analyze_scopes(analysis);
+    m_body->analyze_scopes(analysis);
+    if (has_environment)
+        analysis.pop_environment();
+}
+
+void ForInStatement::analyze_scopes(ScopeAnalysis& analysis) const
+{
+    m_lhs->analyze_scopes(analysis);
+    m_rhs->analyze_scopes(analysis);
+    m_body->analyze_scopes(analysis);
+}
+
+void ForOfStatement::analyze_scopes(ScopeAnalysis& analysis) const
+{
+    m_lhs->analyze_scopes(analysis);
+    m_rhs->analyze_scopes(analysis);
+    m_body->analyze_scopes(analysis);
+}
+
+void BinaryExpression::analyze_scopes(ScopeAnalysis& analysis) const
+{
+    m_lhs->analyze_scopes(analysis);
+    m_rhs->analyze_scopes(analysis);
+}
+
+void LogicalExpression::analyze_scopes(ScopeAnalysis& analysis) const
+{
+    m_lhs->analyze_scopes(analysis);
+    m_rhs->analyze_scopes(analysis);
+}
+
+void UnaryExpression::analyze_scopes(ScopeAnalysis& analysis) const
+{
+    m_lhs->analyze_scopes(analysis);
+}
+
+void SequenceExpression::analyze_scopes(ScopeAnalysis& analysis) const
+{
+    for (auto& expression : m_expressions)
+        expression.analyze_scopes(analysis);
+}
+
+void Identifier::analyze_scopes(ScopeAnalysis& analysis) const
+{
+    analysis.resolve(*this);
+}
+
+void ClassMethod::analyze_scopes(ScopeAnalysis& analysis) const
+{
+    m_key->analyze_scopes(analysis);
+    m_function->analyze_scopes(analysis);
+}
+
+void ClassExpression::analyze_scopes(ScopeAnalysis& analysis) const
+{
+    if (m_super_class)
+        m_super_class->analyze_scopes(analysis);
+    if (m_constructor)
+        m_constructor->analyze_scopes(analysis);
+    for (auto& method : m_methods)
+        method.analyze_scopes(analysis);
+}
+
+void ClassDeclaration::analyze_scopes(ScopeAnalysis& analysis) const
+{
+    analysis.add_dynamic_binding(m_class_expression->name());
+    m_class_expression->analyze_scopes(analysis);
+}
+
+void SpreadExpression::analyze_scopes(ScopeAnalysis& analysis) const
+{
+    m_target->analyze_scopes(analysis);
+}
+
+void CallExpression::analyze_scopes(ScopeAnalysis& analysis) const
+{
+    m_callee->analyze_scopes(analysis);
+    for (auto& argument : m_arguments)
+        argument.value->analyze_scopes(analysis);
+}
+
+void AssignmentExpression::analyze_scopes(ScopeAnalysis& analysis) const
+{
+    m_lhs->analyze_scopes(analysis);
+    m_rhs->analyze_scopes(analysis);
+}
+
+void UpdateExpression::analyze_scopes(ScopeAnalysis& analysis) const
+{
+    m_argument->analyze_scopes(analysis);
+}
+
+void VariableDeclaration::analyze_scopes(ScopeAnalysis& analysis) const
+{
+    for (auto& declarator : m_declarations) {
+        declarator.id().analyze_scopes(analysis);
+        if (auto* init = declarator.init())
+            init->analyze_scopes(analysis);
+    }
+}
+
+void ObjectProperty::analyze_scopes(ScopeAnalysis& analysis) const
+{
+    m_key->analyze_scopes(analysis);
+    if (m_value)
+        m_value->analyze_scopes(analysis);
+}
+
+void ObjectExpression::analyze_scopes(ScopeAnalysis& analysis) const
+{
+    for (auto& property : m_properties)
+        property.analyze_scopes(analysis);
+}
+
+void ArrayExpression::analyze_scopes(ScopeAnalysis& analysis) const
+{
+    for (auto& element : m_elements) {
+        if (element)
+            element->analyze_scopes(analysis);
+    }
+}
+
+void TemplateLiteral::analyze_scopes(ScopeAnalysis& analysis) const
+{
+    for (auto& expression : m_expressions)
+        expression.analyze_scopes(analysis);
+}
+
+void TaggedTemplateLiteral::analyze_scopes(ScopeAnalysis& analysis) const
+{
+    m_tag->analyze_scopes(analysis);
+    m_template_literal->analyze_scopes(analysis);
+}
+
+void MemberExpression::analyze_scopes(ScopeAnalysis& analysis) const
+{
+    m_object->analyze_scopes(analysis);
+    if (m_computed)
+        m_property->analyze_scopes(analysis);
+}
+
+void ConditionalExpression::analyze_scopes(ScopeAnalysis& analysis) const
+{
+    m_test->analyze_scopes(analysis);
+    m_consequent->analyze_scopes(analysis);
+    m_alternate->analyze_scopes(analysis);
+}
+
+void TryStatement::analyze_scopes(ScopeAnalysis& analysis) const
+{
+    m_block->analyze_scopes(analysis);
+
+    if (m_handler) {
+        // The catch parameter goes into the environment of the handler's block, see Interpreter::enter_scope().
+        auto layout = m_handler->body().environment_layout().clone();
+        layout->add(m_handler->parameter(), DeclarationKind::Var);
+        analysis.push_environment(layout);
+        for (auto& child : m_handler->body().children())
+            child.analyze_scopes(analysis);
+        analysis.pop_environment();
+    }
+
+    if (m_finalizer)
+        m_finalizer->analyze_scopes(analysis);
+}
+
+void ThrowStatement::analyze_scopes(ScopeAnalysis& analysis) const
+{
+    m_argument->analyze_scopes(analysis);
+}
+
+void SwitchCase::analyze_scopes(ScopeAnalysis& analysis) const
+{
+    if (m_test)
+        m_test->analyze_scopes(analysis);
+    for (auto& statement : m_consequent)
+        statement.analyze_scopes(analysis);
+}
+
+void SwitchStatement::analyze_scopes(ScopeAnalysis& analysis) const
+{
+    m_discriminant->analyze_scopes(analysis);
+    for (auto& switch_case : m_cases)
+        switch_case.analyze_scopes(analysis);
+}
+
+}
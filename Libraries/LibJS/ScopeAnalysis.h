@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/FlyString.h>
+#include <AK/HashTable.h>
+#include <AK/NonnullRefPtr.h>
+#include <AK/RefCounted.h>
+#include <AK/RefPtr.h>
+#include <AK/Vector.h>
+#include <LibJS/Forward.h>
+
+namespace JS {
+
+// Resolves identifiers to the slots of the environments they will find their bindings in
+// (see EnvironmentCoordinate), by mirroring the environments the interpreter creates for
+// function calls and blocks. Names that can only be found at runtime are left unresolved
+// and go through the name-based lookup instead: globals, bindings created by class
+// declarations, and anything outside of a function declaration, whose parent environment
+// depends on which scope instantiated it.
+class ScopeAnalysis {
+public:
+    static void analyze(const Program&);
+    static void analyze(const FunctionExpression&);
+    // Analyzes a lazily parsed function body in the environments captured around it.
+    static void analyze(const BlockStatement& function_body, const ScopeAnalysisContext&);
+
+    void push_environment(EnvironmentLayout&, bool parent_is_known = true);
+    void pop_environment();
+
+    void resolve(const Identifier&);
+    void add_dynamic_binding(const FlyString& name) { m_dynamic_bindings.set(name); }
+
+    // Records the current environments for analyzing a function body later, see LazyFunctionBody.
+    NonnullRefPtr<ScopeAnalysisContext> capture_context();
+
+    struct Environment {
+        NonnullRefPtr<EnvironmentLayout> layout;
+        bool parent_is_known { true };
+    };
+
+private:
+    ScopeAnalysis() { }
+
+    void finish();
+
+    Vector<Environment> m_environments;
+    Vector<const Identifier*> m_resolved_identifiers;
+    HashTable<FlyString> m_dynamic_bindings;
+    Vector<NonnullRefPtr<ScopeAnalysisContext>> m_captured_contexts;
+};
+
+class ScopeAnalysisContext : public RefCounted<ScopeAnalysisContext> {
+public:
+    Vector<ScopeAnalysis::Environment> environments;
+    // Filled in once the analysis that captured the context has seen all of its code.
+    HashTable<FlyString> dynamic_bindings;
+};
+
+}
@@ -0,0 +1,12 @@
+// Run with `js array-numeric.js` (AST) or `js -b array-numeric.js` (bytecode).
+
+const values = [];
+for (let i = 0; i < 20000; ++i) values.push(i % 1000);
+
+let sum = 0;
+for (let round = 0; round < 20; ++round) {
+    for (let i = 0; i < values.length; ++i)
+        sum += values[i];
+    sum += values.indexOf(999) + values.lastIndexOf(1) + (values.includes(-1) ? 1 : 0);
+}
+console.log(sum);
@@ -0,0 +1,14 @@
+// Run with `js function-calls.js` (AST) or `js -b function-calls.js` (bytecode).
+
+function fib(n) {
+    if (n < 2) return n;
+    return fib(n - 1) + fib(n - 2);
+}
+
+function add(a, b) {
+    return a + b;
+}
+
+let total = fib(24);
+for (let i = 0; i < 200000; ++i) total = add(total, i) % 1000003;
+console.log(total);
@@ -0,0 +1,8 @@
+// Run with `js loop-arithmetic.js` (AST) or `js -b loop-arithmetic.js` (bytecode).
+
+let sum = 0;
+for (let i = 0; i < 1000000; ++i) {
+    sum = (sum + i * 3) % 1000003;
+    if (i % 7 === 0) sum -= 1;
+}
+console.log(sum);
@@ -0,0 +1,20 @@
+#!/bin/sh
+# Times parsing the LibJS test suite as one big script, once with function bodies
+# parsed on their first call (the default) and once with everything parsed up front.
+# Run with `./parse-corpus.sh [path/to/js]`.
+
+set -e
+
+js=${1:-js}
+corpus=/tmp/parse-corpus.js
+
+cd "$(dirname "$0")/.."
+find . -name '*.js' ! -path './benchmarks/*' | sort | xargs cat > "$corpus"
+echo "Corpus: $(wc -c < "$corpus") bytes"
+
+printf "Lazy:  "
+"$js" -P "$corpus"
+printf "Eager: "
+"$js" -P -E "$corpus"
+
+rm -f "$corpus"
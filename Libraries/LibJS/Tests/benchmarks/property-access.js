@@ -0,0 +1,13 @@
+// Run with `js property-access.js` (AST) or `js -b property-access.js` (bytecode).
+
+const point = { x: 0, y: 0 };
+const values = [];
+for (let i = 0; i < 1000; ++i) values[i] = i;
+
+for (let round = 0; round < 300; ++round) {
+    for (let i = 0; i < values.length; ++i) {
+        point.x += values[i];
+        point.y = point.x - point.y;
+    }
+}
+console.log(point.x, point.y);
@@ -0,0 +1,8 @@
+// Run with `js string-building.js` (AST) or `js -b string-building.js` (bytecode).
+
+let result = "";
+for (let i = 0; i < 200000; ++i) {
+    result += "x";
+    if (i % 1000 === 0) result += i;
+}
+console.log(result.length);
@@ -0,0 +1,90 @@
+describe("large dense arrays", () => {
+    test("arrays grown past 200 elements keep their elements", () => {
+        var a = [];
+        for (var i = 0; i < 1000; ++i) a.push(i);
+        expect(a).toHaveLength(1000);
+        expect(a[0]).toBe(0);
+        expect(a[999]).toBe(999);
+        expect(a.pop()).toBe(999);
+        expect(a).toHaveLength(999);
+    });
+
+    test("map over a large array", () => {
+        var a = [];
+        for (var i = 0; i < 500; ++i) a.push(i);
+        var b = a.map(x => x * 2);
+        expect(b).toHaveLength(500);
+        expect(b[499]).toBe(998);
+    });
+
+    test("length setter and Array constructor with large lengths", () => {
+        var a = new Array(1000);
+        expect(a).toHaveLength(1000);
+        expect(a[500]).toBeUndefined();
+        expect(500 in a).toBeFalse();
+        a[500] = 1;
+        expect(500 in a).toBeTrue();
+        a.length = 10;
+        expect(a).toHaveLength(10);
+    });
+
+    test("far-away index makes the array sparse", () => {
+        var a = [1, 2, 3];
+        a[100000] = 4;
+        expect(a).toHaveLength(100001);
+        expect(a[2]).toBe(3);
+        expect(a[100000]).toBe(4);
+        expect(50000 in a).toBeFalse();
+    });
+
+    test("large array converted to generic storage keeps its elements", () => {
+        var a = [];
+        for (var i = 0; i < 300; ++i) a.push(i);
+        Object.defineProperty(a, 0, { value: "x", writable: false });
+        expect(a[0]).toBe("x");
+        expect(a[250]).toBe(250);
+        expect(a[299]).toBe(299);
+        expect(a).toHaveLength(300);
+    });
+});
+
+describe("searching numeric arrays", () => {
+    test("indexOf, lastIndexOf and includes on integers", () => {
+        var a = [];
+        for (var i = 0; i < 300; ++i) a.push(i % 100);
+        expect(a.indexOf(42)).toBe(42);
+        expect(a.indexOf(42, 50)).toBe(142);
+        expect(a.lastIndexOf(42)).toBe(242);
+        expect(a.indexOf("42")).toBe(-1);
+        expect(a.includes(99)).toBeTrue();
+        expect(a.includes(100)).toBeFalse();
+        expect(a.includes(NaN)).toBeFalse();
+        expect(a.includes(undefined)).toBeFalse();
+    });
+
+    test("indexOf, lastIndexOf and includes on doubles", () => {
+        var a = [0.5, -0, NaN, 1.5];
+        expect(a.indexOf(0)).toBe(1);
+        expect(a.indexOf(NaN)).toBe(-1);
+        expect(a.lastIndexOf(NaN)).toBe(-1);
+        expect(a.includes(NaN)).toBeTrue();
+        expect(a.includes(0)).toBeTrue();
+        expect(a.lastIndexOf(1.5)).toBe(3);
+    });
+
+    test("elements stored after a search are seen by the next one", () => {
+        var a = [1, 2, 3];
+        expect(a.indexOf("foo")).toBe(-1);
+        a[1] = "foo";
+        expect(a.indexOf("foo")).toBe(1);
+        a.length = 0;
+        a.push(7);
+        expect(a.indexOf(7)).toBe(0);
+    });
+
+    test("holes are not found as undefined by indexOf", () => {
+        var a = [1, , 3];
+        expect(a.indexOf(undefined)).toBe(-1);
+        expect(a.includes(undefined)).toBeTrue();
+    });
+});
@@ -0,0 +1,44 @@
+test("basic functionality", () => {
+    expect(ArrayBuffer).toHaveLength(1);
+    expect(ArrayBuffer.name).toBe("ArrayBuffer");
+    expect(new ArrayBuffer().byteLength).toBe(0);
+    expect(new ArrayBuffer(16).byteLength).toBe(16);
+    expect(new ArrayBuffer(2.7).byteLength).toBe(2);
+    expect(Object.prototype.toString.call(new ArrayBuffer(1))).toBe("[object ArrayBuffer]");
+});
+
+test("must be called with new", () => {
+    expect(() => {
+        ArrayBuffer(1);
+    }).toThrowWithMessage(TypeError, "ArrayBuffer constructor must be called with 'new'");
+});
+
+test("invalid lengths", () => {
+    expect(() => {
+        new ArrayBuffer(-1);
+    }).toThrowWithMessage(RangeError, "Index must be a non-negative integer");
+    expect(() => {
+        new ArrayBuffer(2 ** 31);
+    }).toThrowWithMessage(RangeError, "Invalid array buffer length");
+});
+
+test("isView", () => {
+    var buffer = new ArrayBuffer(8);
+    expect(ArrayBuffer.isView(buffer)).toBeFalse();
+    expect(ArrayBuffer.isView([])).toBeFalse();
+    expect(ArrayBuffer.isView(new Uint8Array(buffer))).toBeTrue();
+    expect(ArrayBuffer.isView(new DataView(buffer))).toBeTrue();
+});
+
+test("slice", () => {
+    var bytes = new Uint8Array([1, 2, 3, 4, 5]);
+    var slice = bytes.buffer.slice(1, -1);
+    expect(slice.byteLength).toBe(3);
+    expect(new Uint8Array(slice)[0]).toBe(2);
+    expect(bytes.buffer.slice(-2).byteLength).toBe(2);
+    expect(bytes.buffer.slice(4, 2).byteLength).toBe(0);
+
+    // Slices are copies, not views.
+    new Uint8Array(slice)[0] = 42;
+    expect(bytes[1]).toBe(2);
+});
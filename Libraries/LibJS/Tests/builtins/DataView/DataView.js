@@ -0,0 +1,72 @@
+test("basic functionality", () => {
+    expect(DataView).toHaveLength(1);
+    var buffer = new ArrayBuffer(8);
+    var view = new DataView(buffer, 2);
+    expect(view.buffer).toBe(buffer);
+    expect(view.byteOffset).toBe(2);
+    expect(view.byteLength).toBe(6);
+    expect(new DataView(buffer, 1, 3).byteLength).toBe(3);
+    expect(Object.prototype.toString.call(view)).toBe("[object DataView]");
+});
+
+test("invalid arguments", () => {
+    expect(() => {
+        DataView(new ArrayBuffer(1));
+    }).toThrowWithMessage(TypeError, "DataView constructor must be called with 'new'");
+    expect(() => {
+        new DataView([]);
+    }).toThrowWithMessage(TypeError, "Not a ArrayBuffer");
+    expect(() => {
+        new DataView(new ArrayBuffer(4), 5);
+    }).toThrowWithMessage(RangeError, "Offset 5 is outside the bounds of the DataView");
+    expect(() => {
+        new DataView(new ArrayBuffer(4), 2, 3);
+    }).toThrowWithMessage(RangeError, "Offset 5 is outside the bounds of the DataView");
+});
+
+test("big-endian by default", () => {
+    var buffer = new ArrayBuffer(4);
+    var view = new DataView(buffer);
+    view.setUint32(0, 0x01020304);
+    var bytes = new Uint8Array(buffer);
+    expect(bytes[0]).toBe(1);
+    expect(bytes[3]).toBe(4);
+    expect(view.getUint32(0)).toBe(0x01020304);
+    expect(view.getUint32(0, true)).toBe(0x04030201);
+    expect(view.getUint16(1)).toBe(0x0203);
+});
+
+test("little-endian accesses", () => {
+    var view = new DataView(new ArrayBuffer(8));
+    view.setInt16(0, -2, true);
+    expect(view.getUint8(0)).toBe(0xfe);
+    expect(view.getUint8(1)).toBe(0xff);
+    expect(view.getInt16(0, true)).toBe(-2);
+    view.setFloat64(0, 1.5, true);
+    expect(view.getFloat64(0, true)).toBe(1.5);
+    view.setFloat32(4, -0.25);
+    expect(view.getFloat32(4)).toBe(-0.25);
+});
+
+test("integer conversion", () => {
+    var view = new DataView(new ArrayBuffer(4));
+    view.setInt8(0, 200);
+    expect(view.getInt8(0)).toBe(-56);
+    expect(view.getUint8(0)).toBe(200);
+    view.setUint32(0, -1);
+    expect(view.getUint32(0)).toBe(4294967295);
+    expect(view.getInt32(0)).toBe(-1);
+});
+
+test("out of bounds accesses", () => {
+    var view = new DataView(new ArrayBuffer(4));
+    expect(() => {
+        view.getInt32(1);
+    }).toThrowWithMessage(RangeError, "Offset 1 is outside the bounds of the DataView");
+    expect(() => {
+        view.setUint8(4, 0);
+    }).toThrowWithMessage(RangeError, "Offset 4 is outside the bounds of the DataView");
+    expect(() => {
+        view.getUint8(-1);
+    }).toThrowWithMessage(RangeError, "Index must be a non-negative integer");
+});
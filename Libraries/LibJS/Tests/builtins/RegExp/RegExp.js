@@ -0,0 +1,51 @@
+test("basic functionality", () => {
+    expect(RegExp).toHaveLength(2);
+    expect(RegExp.name).toBe("RegExp");
+    expect(new RegExp().source).toBe("(?:)");
+    expect(new RegExp("a+", "g").source).toBe("a+");
+    expect(new RegExp("a+", "g").global).toBeTrue();
+    expect(new RegExp(/b/i).flags).toBe("i");
+    expect(new RegExp(/b/i, "g").flags).toBe("g");
+    expect(RegExp("c").source).toBe("c");
+});
+
+test("invalid patterns", () => {
+    expect(() => {
+        new RegExp("(");
+    }).toThrowWithMessage(SyntaxError, "Invalid regular expression /(/: Unmatched ( or )");
+    expect(() => {
+        new RegExp("a**");
+    }).toThrowWithMessage(SyntaxError, "Invalid regular expression /a**/: Nothing to repeat");
+    expect(() => {
+        new RegExp("[b-a]");
+    }).toThrowWithMessage(SyntaxError, "Invalid regular expression /[b-a]/: Invalid range in character class");
+});
+
+test("invalid flags", () => {
+    expect(() => {
+        new RegExp("a", "q");
+    }).toThrowWithMessage(SyntaxError, "Invalid RegExp flag 'q'");
+    expect(() => {
+        new RegExp("a", "gig");
+    }).toThrowWithMessage(SyntaxError, "Repeated RegExp flag 'g'");
+});
+
+test("flag getters", () => {
+    const regexp = /x/gimsuy;
+    expect(regexp.flags).toBe("gimsuy");
+    expect(regexp.global).toBeTrue();
+    expect(regexp.ignoreCase).toBeTrue();
+    expect(regexp.multiline).toBeTrue();
+    expect(regexp.dotAll).toBeTrue();
+    expect(regexp.unicode).toBeTrue();
+    expect(regexp.sticky).toBeTrue();
+    expect(/x/.flags).toBe("");
+    expect(/x/.global).toBeFalse();
+    expect(new RegExp("x", "yg").flags).toBe("gy");
+});
+
+test("string conversion", () => {
+    expect(/a\/b/g.toString()).toBe("/a\\/b/g");
+    expect(new RegExp().toString()).toBe("/(?:)/");
+    expect(String(/q/m)).toBe("/q/m");
+});
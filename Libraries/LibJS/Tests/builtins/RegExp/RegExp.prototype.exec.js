@@ -0,0 +1,67 @@
+test("basic functionality", () => {
+    expect(RegExp.prototype.exec).toHaveLength(1);
+
+    const result = /a(b)(x)?c/.exec("xxabcx");
+    expect(result).toHaveLength(3);
+    expect(result[0]).toBe("abc");
+    expect(result[1]).toBe("b");
+    expect(result[2]).toBeUndefined();
+    expect(result.index).toBe(2);
+    expect(result.input).toBe("xxabcx");
+    expect(result.groups).toBeUndefined();
+
+    expect(/z/.exec("abc")).toBeNull();
+});
+
+test("named groups", () => {
+    const result = /(?<year>\d{4})-(?<month>\d\d)/.exec("on 2020-09-10");
+    expect(result.groups.year).toBe("2020");
+    expect(result.groups.month).toBe("09");
+    expect(/(?<a>x)\k<a>/.exec("axxb")[0]).toBe("xx");
+});
+
+test("syntax", () => {
+    expect(/a{2,3}/.exec("aaaa")[0]).toBe("aaa");
+    expect(/a{2,3}?/.exec("aaaa")[0]).toBe("aa");
+    expect(/a{,2}/.exec("a{,2}")[0]).toBe("a{,2}");
+    expect(/[^a-c\d]+/.exec("ab12xyz")[0]).toBe("xyz");
+    expect(/\bfoo\b/.exec("afoo foo").index).toBe(5);
+    expect(/(a)\1/.exec("xaa")[0]).toBe("aa");
+    expect(/a(?=b)/.exec("acab").index).toBe(2);
+    expect(/a(?!b)/.exec("abac").index).toBe(2);
+    expect(/(a|ab)(c|bcd)(d*)/.exec("abcd")).toEqual(["abcd", "a", "bcd", ""]);
+    expect(/\x41B\u{43}/.exec("ABC")[0]).toBe("ABC");
+    expect(/./.exec("\n")).toBeNull();
+    expect(/./s.exec("\n")[0]).toBe("\n");
+    expect(/^b$/.exec("a\nb")).toBeNull();
+    expect(/^b$/m.exec("a\nb\nc")[0]).toBe("b");
+    expect(/ABC/i.exec("xabc")[0]).toBe("abc");
+    expect(/[A-C]+/i.exec("xabc")[0]).toBe("abc");
+});
+
+test("global and sticky regexps use lastIndex", () => {
+    const global = /o/g;
+    expect(global.lastIndex).toBe(0);
+    expect(global.exec("foo").index).toBe(1);
+    expect(global.lastIndex).toBe(2);
+    expect(global.exec("foo").index).toBe(2);
+    expect(global.exec("foo")).toBeNull();
+    expect(global.lastIndex).toBe(0);
+
+    const sticky = /o/y;
+    expect(sticky.exec("foo")).toBeNull();
+    sticky.lastIndex = 1;
+    expect(sticky.exec("foo").index).toBe(1);
+    expect(sticky.lastIndex).toBe(2);
+
+    const neither = /o/;
+    neither.lastIndex = 2;
+    expect(neither.exec("foo").index).toBe(1);
+    expect(neither.lastIndex).toBe(2);
+});
+
+test("catastrophic backtracking finishes", () => {
+    expect(/(a+)+$/.exec("a".repeat(40) + "b")).toBeNull();
+    expect(/(x+x+)+y/.exec("x".repeat(50))).toBeNull();
+    expect(/(a|aa)*b/.exec("a".repeat(40) + "b")[0]).toBe("a".repeat(40) + "b");
+});
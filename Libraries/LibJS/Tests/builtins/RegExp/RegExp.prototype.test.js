@@ -0,0 +1,25 @@
+test("basic functionality", () => {
+    expect(RegExp.prototype.test).toHaveLength(1);
+
+    expect(/abc/.test("xxabc")).toBeTrue();
+    expect(/abd/.test("xxabc")).toBeFalse();
+    expect(/^\d+$/.test("1234")).toBeTrue();
+    expect(/^\d+$/.test("12a4")).toBeFalse();
+    expect(/undefined/.test()).toBeTrue();
+});
+
+test("global regexps advance lastIndex", () => {
+    const regexp = /a/g;
+    expect(regexp.test("aa")).toBeTrue();
+    expect(regexp.lastIndex).toBe(1);
+    expect(regexp.test("aa")).toBeTrue();
+    expect(regexp.lastIndex).toBe(2);
+    expect(regexp.test("aa")).toBeFalse();
+    expect(regexp.lastIndex).toBe(0);
+});
+
+test("called on a non-RegExp", () => {
+    expect(() => {
+        RegExp.prototype.test.call({}, "a");
+    }).toThrowWithMessage(TypeError, "Not a RegExp object");
+});
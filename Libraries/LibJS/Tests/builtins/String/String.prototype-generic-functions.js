@@ -16,6 +16,9 @@ test("basic functionality", () => {
         "substring",
         "includes",
         "slice",
+        "match",
+        "replace",
+        "split",
     ];
 
     genericStringPrototypeFunctions.forEach(name => {
@@ -0,0 +1,16 @@
+test("basic functionality", () => {
+    expect(String.prototype.match).toHaveLength(1);
+
+    const result = "hello friends".match(/fr(ie)nds/);
+    expect(result[0]).toBe("friends");
+    expect(result[1]).toBe("ie");
+    expect(result.index).toBe(6);
+    expect("hello".match(/x/)).toBeNull();
+    expect("a.b".match(".").index).toBe(0);
+});
+
+test("global regexps return all matches", () => {
+    expect("a1b22c333".match(/\d+/g)).toEqual(["1", "22", "333"]);
+    expect("abc".match(/x/g)).toBeNull();
+    expect("abc".match(/(?:)/g)).toEqual(["", "", "", ""]);
+});
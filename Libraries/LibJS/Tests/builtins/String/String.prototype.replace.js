@@ -0,0 +1,23 @@
+test("basic functionality", () => {
+    expect(String.prototype.replace).toHaveLength(2);
+
+    expect("hello".replace("l", "L")).toBe("heLlo");
+    expect("hello".replace("x", "L")).toBe("hello");
+    expect("hello world".replace(/o/, "0")).toBe("hell0 world");
+    expect("hello world".replace(/o/g, "0")).toBe("hell0 w0rld");
+    expect("aaa".replace(/a*?/g, "-")).toBe("-a-a-a-");
+});
+
+test("substitutions", () => {
+    expect("John Smith".replace(/(\w+)\s(\w+)/, "$2, $1")).toBe("Smith, John");
+    expect("abc".replace(/b/, "[$&|$`|$'|$$]")).toBe("a[b|a|c|$]c");
+    expect("abc".replace("b", "$&$&")).toBe("abbc");
+    expect("x-y".replace(/(?<a>\w)-(?<b>\w)/, "$<b>-$<a>")).toBe("y-x");
+    expect("abc".replace(/(b)/, "$2$")).toBe("a$2$c");
+});
+
+test("replacement functions", () => {
+    expect("abcb".replace(/b/g, (match, offset, string) => match.toUpperCase() + offset + string.length)).toBe("aB14cB34");
+    expect("a1".replace(/(\d)/, (match, digit) => digit * 2)).toBe("a2");
+    expect("x-y".replace(/(?<first>\w)-/, (...args) => args[args.length - 1].first)).toBe("xy");
+});
@@ -0,0 +1,20 @@
+test("basic functionality", () => {
+    expect(String.prototype.split).toHaveLength(2);
+
+    expect("a,b,,c".split(",")).toEqual(["a", "b", "", "c"]);
+    expect("a, b".split(", ")).toEqual(["a", "b"]);
+    expect("abc".split("")).toEqual(["a", "b", "c"]);
+    expect("abc".split()).toEqual(["abc"]);
+    expect("".split(",")).toEqual([""]);
+    expect("a,b,c".split(",", 2)).toEqual(["a", "b"]);
+    expect("a,b,c".split(",", 0)).toEqual([]);
+});
+
+test("regexp separators", () => {
+    expect("a1b22c".split(/\d+/)).toEqual(["a", "b", "c"]);
+    expect("a1b2c".split(/(\d)/)).toEqual(["a", "1", "b", "2", "c"]);
+    expect("abc".split(/(?:)/)).toEqual(["a", "b", "c"]);
+    expect("".split(/x/)).toEqual([""]);
+    expect("".split(/(?:)/)).toEqual([]);
+    expect("a1b2c".split(/\d/, 2)).toEqual(["a", "b"]);
+});
@@ -0,0 +1,193 @@
+const TYPED_ARRAYS = [
+    { array: Uint8Array, bytes: 1 },
+    { array: Uint8ClampedArray, bytes: 1 },
+    { array: Uint16Array, bytes: 2 },
+    { array: Uint32Array, bytes: 4 },
+    { array: Int8Array, bytes: 1 },
+    { array: Int16Array, bytes: 2 },
+    { array: Int32Array, bytes: 4 },
+    { array: Float32Array, bytes: 4 },
+    { array: Float64Array, bytes: 8 },
+];
+
+describe("constructors", () => {
+    test("basic properties", () => {
+        TYPED_ARRAYS.forEach(T => {
+            var array = T.array;
+            var bytes = T.bytes;
+            expect(array).toHaveLength(3);
+            expect(array.BYTES_PER_ELEMENT).toBe(bytes);
+            expect(array.prototype.BYTES_PER_ELEMENT).toBe(bytes);
+
+            var typedArray = new array(4);
+            expect(typedArray).toHaveLength(4);
+            expect(typedArray.byteLength).toBe(4 * bytes);
+            expect(typedArray.byteOffset).toBe(0);
+            expect(typedArray.buffer.byteLength).toBe(4 * bytes);
+            expect(typedArray[0]).toBe(0);
+            expect(Object.prototype.toString.call(typedArray)).toBe("[object " + array.name + "]");
+
+            expect(() => {
+                array(1);
+            }).toThrowWithMessage(TypeError, array.name + " constructor must be called with 'new'");
+        });
+    });
+
+    test("from an array-like", () => {
+        TYPED_ARRAYS.forEach(T => {
+            var array = T.array;
+            var typedArray = new array([1, 2, 3]);
+            expect(typedArray).toHaveLength(3);
+            expect(typedArray[2]).toBe(3);
+            expect(new array({ length: 2, 0: 5 })[0]).toBe(5);
+        });
+    });
+
+    test("from another typed array", () => {
+        var source = new Float64Array([1.5, -1, 300]);
+        var copy = new Float64Array(source);
+        copy[0] = 2;
+        expect(source[0]).toBe(1.5);
+        var converted = new Uint8Array(source);
+        expect(converted[0]).toBe(1);
+        expect(converted[1]).toBe(255);
+        expect(converted[2]).toBe(44);
+    });
+
+    test("views into an ArrayBuffer", () => {
+        var buffer = new ArrayBuffer(16);
+        var whole = new Uint32Array(buffer);
+        expect(whole).toHaveLength(4);
+        var part = new Uint16Array(buffer, 4, 2);
+        expect(part.byteOffset).toBe(4);
+        expect(part).toHaveLength(2);
+        expect(part.buffer).toBe(buffer);
+        part[0] = 0xffff;
+        expect(new Uint8Array(buffer)[4]).toBe(0xff);
+        expect(new Uint8Array(buffer, 8)).toHaveLength(8);
+    });
+
+    test("invalid views", () => {
+        var buffer = new ArrayBuffer(6);
+        expect(() => {
+            new Uint32Array(buffer, 2);
+        }).toThrowWithMessage(RangeError, "Start offset of Uint32Array should be a multiple of 4");
+        expect(() => {
+            new Uint32Array(buffer);
+        }).toThrowWithMessage(RangeError, "Byte length of Uint32Array should be a multiple of 4");
+        expect(() => {
+            new Uint16Array(buffer, 2, 3);
+        }).toThrowWithMessage(RangeError, "Uint16Array range is outside the bounds of its ArrayBuffer");
+        expect(() => {
+            new Uint8Array(buffer, 7);
+        }).toThrowWithMessage(RangeError, "Uint8Array range is outside the bounds of its ArrayBuffer");
+    });
+});
+
+describe("element conversion", () => {
+    test("integer arrays wrap around", () => {
+        var int8 = new Int8Array([127, 128, 255, 256, -129, 1.9, -1.9, NaN, Infinity]);
+        expect(int8[0]).toBe(127);
+        expect(int8[1]).toBe(-128);
+        expect(int8[2]).toBe(-1);
+        expect(int8[3]).toBe(0);
+        expect(int8[4]).toBe(127);
+        expect(int8[5]).toBe(1);
+        expect(int8[6]).toBe(-1);
+        expect(int8[7]).toBe(0);
+        expect(int8[8]).toBe(0);
+
+        var uint32 = new Uint32Array([-1, 2 ** 32 + 5]);
+        expect(uint32[0]).toBe(4294967295);
+        expect(uint32[1]).toBe(5);
+    });
+
+    test("Uint8ClampedArray clamps and rounds half to even", () => {
+        var clamped = new Uint8ClampedArray([-5, 300, 1.5, 2.5, 0.5, 254.6, NaN]);
+        expect(clamped[0]).toBe(0);
+        expect(clamped[1]).toBe(255);
+        expect(clamped[2]).toBe(2);
+        expect(clamped[3]).toBe(2);
+        expect(clamped[4]).toBe(0);
+        expect(clamped[5]).toBe(255);
+        expect(clamped[6]).toBe(0);
+    });
+
+    test("float arrays", () => {
+        var float32 = new Float32Array([0.1, NaN]);
+        expect(float32[0]).not.toBe(0.1);
+        expect(Math.abs(float32[0] - 0.1) < 0.0001).toBeTrue();
+        expect(float32[1]).toBeNaN();
+    });
+
+    test("out of bounds accesses", () => {
+        var typedArray = new Int32Array(2);
+        typedArray[5] = 1;
+        expect(typedArray[5]).toBeUndefined();
+        expect(typedArray).toHaveLength(2);
+    });
+});
+
+describe("prototype methods", () => {
+    test("fill", () => {
+        var typedArray = new Int16Array(5);
+        expect(typedArray.fill(3, 1, -1)).toBe(typedArray);
+        expect(typedArray[0]).toBe(0);
+        expect(typedArray[1]).toBe(3);
+        expect(typedArray[3]).toBe(3);
+        expect(typedArray[4]).toBe(0);
+    });
+
+    test("subarray shares the buffer", () => {
+        var typedArray = new Uint16Array([1, 2, 3, 4, 5]);
+        var sub = typedArray.subarray(1, -1);
+        expect(sub).toHaveLength(3);
+        expect(sub.byteOffset).toBe(2);
+        expect(sub.buffer).toBe(typedArray.buffer);
+        sub[0] = 42;
+        expect(typedArray[1]).toBe(42);
+        expect(typedArray.subarray(3, 1)).toHaveLength(0);
+        expect(typedArray.subarray(-2)[0]).toBe(4);
+    });
+
+    test("set", () => {
+        var typedArray = new Uint8Array(6);
+        typedArray.set([1, 2, 3], 1);
+        expect(typedArray[0]).toBe(0);
+        expect(typedArray[1]).toBe(1);
+        expect(typedArray[3]).toBe(3);
+
+        typedArray.set(new Float64Array([300.5]), 5);
+        expect(typedArray[5]).toBe(44);
+
+        expect(() => {
+            typedArray.set([1, 2], 5);
+        }).toThrowWithMessage(RangeError, "Source range is outside the bounds of its ArrayBuffer");
+    });
+
+    test("set with overlapping arrays", () => {
+        var bytes = new Uint8Array([1, 2, 3, 4, 0, 0]);
+        bytes.set(bytes.subarray(0, 4), 2);
+        expect(bytes[2]).toBe(1);
+        expect(bytes[5]).toBe(4);
+
+        var buffer = new ArrayBuffer(8);
+        var wide = new Uint16Array(buffer);
+        wide.set([1, 2, 3, 4]);
+        var narrow = new Uint8Array(buffer, 0, 4);
+        wide.set(narrow);
+        expect(wide[0]).toBe(1);
+        expect(wide[1]).toBe(0);
+        expect(wide[2]).toBe(2);
+        expect(wide[3]).toBe(0);
+    });
+
+    test("prototypes share %TypedArray%.prototype", () => {
+        var typedArrayPrototype = Object.getPrototypeOf(Int8Array.prototype);
+        expect(Object.getPrototypeOf(Float64Array.prototype)).toBe(typedArrayPrototype);
+        expect(typedArrayPrototype[Symbol.toStringTag]).toBeUndefined();
+        expect(() => {
+            typedArrayPrototype.length;
+        }).toThrowWithMessage(TypeError, "Not a TypedArray");
+    });
+});
@@ -0,0 +1,94 @@
+// test-js parses function bodies on their first call, which is what these tests are about.
+
+test("syntax errors in a function body are thrown when it is called", () => {
+    function broken() {
+        return 1 +;
+    }
+    expect(broken).toThrowWithMessage(SyntaxError, "Unexpected token Semicolon");
+    // The error is remembered, not reported again by parsing the body again.
+    expect(broken).toThrowWithMessage(SyntaxError, "(line: 5, column: 19)");
+});
+
+test("functions see the variables around them", () => {
+    var a = 1;
+    let b = 2;
+    function outer(c) {
+        var d = 4;
+        function inner() {
+            return a + b + c + d;
+        }
+        return inner;
+    }
+    expect(outer(3)()).toBe(10);
+    a = 10;
+    expect(outer(3)()).toBe(19);
+});
+
+test("closures created before and after the body is parsed share it", () => {
+    function counter() {
+        let count = 0;
+        return () => ++count;
+    }
+    const first = counter();
+    const second = counter();
+    expect(first()).toBe(1);
+    expect(first()).toBe(2);
+    expect(second()).toBe(1);
+});
+
+test("variables declared in the body get their own slots", () => {
+    function f(x) {
+        var y = x * 2;
+        let z = y + 1;
+        return [x, y, z];
+    }
+    expect(f(1)).toEqual([1, 2, 3]);
+    expect(f(5)).toEqual([5, 10, 11]);
+});
+
+test("strict mode is inherited and detected", () => {
+    function sloppy() {
+        return isStrictMode();
+    }
+    function strict() {
+        "use strict";
+        return (() => {
+            return isStrictMode();
+        })();
+    }
+    expect(sloppy()).toBeFalse();
+    expect(strict()).toBeTrue();
+});
+
+test("super property lookups in methods", () => {
+    class A {
+        value() {
+            return 1;
+        }
+    }
+    class B extends A {
+        value() {
+            return super.value() + 1;
+        }
+    }
+    expect(new B().value()).toBe(2);
+});
+
+test("brackets in strings, regular expressions and template literals", () => {
+    function f() {
+        const s = "}{)(][";
+        const r = /[}]+/;
+        const t = `${"}"}${`${[1, 2].map(x => { return x * 2; })}`}`;
+        return [s, typeof r, t];
+    }
+    expect(f()).toEqual(["}{)(][", "object", "}2,4"]);
+});
+
+test("functions defined in template literal expressions", () => {
+    const t = `a${function () {
+        return "b";
+    }()}c${(x => {
+        return x;
+    })("d")}`;
+    expect(t).toBe("abcd");
+});
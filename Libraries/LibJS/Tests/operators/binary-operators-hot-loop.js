@@ -0,0 +1,34 @@
+test("arithmetic on numbers in a hot loop", () => {
+    let sum = 0;
+    let product = 1;
+    for (let i = 0; i < 3000; ++i) {
+        sum = sum + i;
+        product = (product * 3) / 3;
+    }
+    expect(sum).toBe(4498500);
+    expect(product).toBe(1);
+});
+
+test("operands that stop being numbers in a hot loop", () => {
+    const values = [];
+    for (let i = 0; i < 3000; ++i) values.push(i);
+    values.push("x", 1n, true, null, NaN, -2.5);
+
+    const results = [];
+    for (let i = 0; i < values.length; ++i) {
+        const value = values[i];
+        if (typeof value === "bigint") {
+            results.push(value + 1n);
+            continue;
+        }
+        results.push(String([value + 1, value - 1, value < 3, value >= 3, value & 6, value | 1, value ^ 2, value % 4, value === 1, value !== 1]));
+    }
+
+    expect(results[2999]).toBe("3000,2998,false,true,6,2999,2997,3,false,true");
+    expect(results[3000]).toBe("x1,NaN,false,false,0,1,2,NaN,false,true");
+    expect(results[3001]).toBe(2n);
+    expect(results[3002]).toBe("2,0,true,false,0,1,3,1,false,true");
+    expect(results[3003]).toBe("1,-1,true,false,0,1,2,0,false,true");
+    expect(results[3004]).toBe("NaN,NaN,false,false,0,1,2,NaN,false,true");
+    expect(results[3005]).toBe("-1.5,-3.5,true,false,6,-1,-4,-2.5,false,true");
+});
@@ -0,0 +1,55 @@
+// Property accesses that see objects of several shapes, or whose objects change shape
+// between accesses, must not get stale results from the lookup cache.
+
+test("accesses that see several shapes", () => {
+    class P {
+        get x() {
+            return "getter";
+        }
+        m() {
+            return "prototype";
+        }
+    }
+    const objects = [new P(), { x: 1, m: () => "own" }, { a: 0, x: 2, m: () => "other" }, new P()];
+    const results = [];
+    for (let i = 0; i < 3 * objects.length; ++i) {
+        const o = objects[i % objects.length];
+        results.push(o.x, o.m());
+    }
+    expect(results.slice(0, 8)).toEqual(["getter", "prototype", 1, "own", 2, "other", "getter", "prototype"]);
+    expect(results.slice(8, 16)).toEqual(results.slice(0, 8));
+});
+
+test("shape transitions", () => {
+    const read = o => o.v;
+    const o = { v: 1 };
+    expect(read(o)).toBe(1);
+    expect(read(o)).toBe(1);
+    delete o.v;
+    expect(read(o)).toBeUndefined();
+
+    Object.getPrototypeOf(o).v = "inherited";
+    expect(read(o)).toBe("inherited");
+    o.v = "own";
+    expect(read(o)).toBe("own");
+    delete Object.prototype.v;
+});
+
+test("prototype changes", () => {
+    function C() {}
+    C.prototype.f = () => 1;
+    const c = new C();
+    expect(c.f()).toBe(1);
+    C.prototype.f = () => 2;
+    expect(c.f()).toBe(2);
+    Object.setPrototypeOf(c, { f: () => 3 });
+    expect(c.f()).toBe(3);
+});
+
+test("stores to properties that stop being writable", () => {
+    const o = { v: 0 };
+    for (let i = 0; i < 3; ++i) o.v = o.v + 1;
+    Object.defineProperty(o, "v", { writable: false });
+    o.v = 100;
+    expect(o.v).toBe(3);
+});
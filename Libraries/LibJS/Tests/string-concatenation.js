@@ -0,0 +1,41 @@
+test("concatenating short strings", () => {
+    expect("foo" + "bar").toBe("foobar");
+    expect("" + "bar").toBe("bar");
+    expect("foo" + "").toBe("foo");
+    expect("a" + 1 + 2).toBe("a12");
+    expect(1 + 2 + "a").toBe("3a");
+});
+
+test("concatenating long strings", () => {
+    const a = "The quick brown fox ";
+    const b = "jumps over the lazy dog";
+    const s = a + b;
+    expect(s).toBe("The quick brown fox jumps over the lazy dog");
+    expect(s.length).toBe(43);
+    expect(s + s).toBe(
+        "The quick brown fox jumps over the lazy dogThe quick brown fox jumps over the lazy dog"
+    );
+    expect((a + b).indexOf("fox")).toBe(16);
+});
+
+test("building a string piece by piece", () => {
+    let s = "";
+    for (let i = 0; i < 5000; ++i) s += String.fromCharCode(97 + (i % 26));
+    expect(s.length).toBe(5000);
+    expect(s.charAt(0)).toBe("a");
+    expect(s.charAt(25)).toBe("z");
+    expect(s.charAt(4999)).toBe(String.fromCharCode(97 + (4999 % 26)));
+
+    let t = "";
+    for (let i = 0; i < 100; ++i) t = i + "," + t;
+    expect(t.startsWith("99,98,97,")).toBeTrue();
+    expect(t.substring(t.length - 5)).toBe(",1,0,");
+});
+
+test("concatenated strings as property keys", () => {
+    const key = "a rather long property name, " + "made of two parts";
+    const o = {};
+    o[key] = 1;
+    expect(o["a rather long property name, made of two parts"]).toBe(1);
+    expect(Object.keys(o)[0]).toBe(key);
+});
@@ -0,0 +1,70 @@
+test("closures see the variables of enclosing functions", () => {
+    const makeCounter = () => {
+        let count = 0;
+        return () => ++count;
+    };
+    const a = makeCounter();
+    const b = makeCounter();
+    a();
+    a();
+    expect(a()).toBe(3);
+    expect(b()).toBe(1);
+});
+
+test("inner blocks shadow outer variables", () => {
+    let x = 1;
+    const readOuter = () => x;
+    {
+        let x = 2;
+        const readInner = () => x;
+        x = 3;
+        expect(readInner()).toBe(3);
+    }
+    expect(x).toBe(1);
+    expect(readOuter()).toBe(1);
+});
+
+test("each for loop initializer gets its own environment", () => {
+    let i = "outer";
+    let sum = 0;
+    for (let i = 0; i < 5; ++i) {
+        let doubled = i * 2;
+        sum += doubled;
+    }
+    expect(sum).toBe(20);
+    expect(i).toBe("outer");
+});
+
+test("catch parameter", () => {
+    let e = "outer";
+    try {
+        throw 42;
+    } catch (e) {
+        let f = () => e;
+        expect(f()).toBe(42);
+    }
+    expect(e).toBe("outer");
+});
+
+test("parameters and default values", () => {
+    const add = (a, b = a + 1) => {
+        var c = a + b;
+        return () => c;
+    };
+    expect(add(1)()).toBe(3);
+    expect(add(1, 5)()).toBe(6);
+});
+
+test("class declarations shadow outer variables", () => {
+    let A = 1;
+    {
+        let x = 0;
+        class A {}
+        expect(typeof A).toBe("function");
+    }
+});
+
+test("functions created by the Function constructor", () => {
+    const f = new Function("a", "let b = a * 2; return () => a + b;");
+    expect(f(3)()).toBe(9);
+});
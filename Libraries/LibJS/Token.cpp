@@ -26,6 +26,8 @@
 
 #include "Token.h"
 #include <AK/Assertions.h>
+#include <AK/DoubleConversion.h>
+#include <AK/Optional.h>
 #include <AK/StringBuilder.h>
 #include <AK/Utf32View.h>
 #include <ctype.h>
@@ -54,23 +56,23 @@ const char* Token::name() const
 double Token::double_value() const
 {
     ASSERT(type() == TokenType::NumericLiteral);
-    String value_string(m_value);
-    if (value_string[0] == '0' && value_string.length() >= 2) {
-        if (value_string[1] == 'x' || value_string[1] == 'X') {
+    if (m_value.length() >= 2 && m_value[0] == '0') {
+        char prefix = m_value[1];
+        if (prefix == 'x' || prefix == 'X') {
             // hexadecimal
-            return static_cast<double>(strtoul(value_string.characters() + 2, nullptr, 16));
-        } else if (value_string[1] == 'o' || value_string[1] == 'O') {
+            return static_cast<double>(strtoul(String(m_value.substring_view(2, m_value.length() - 2)).characters(), nullptr, 16));
+        } else if (prefix == 'o' || prefix == 'O') {
             // octal
-            return static_cast<double>(strtoul(value_string.characters() + 2, nullptr, 8));
-        } else if (value_string[1] == 'b' || value_string[1] == 'B') {
+            return static_cast<double>(strtoul(String(m_value.substring_view(2, m_value.length() - 2)).characters(), nullptr, 8));
+        } else if (prefix == 'b' || prefix == 'B') {
             // binary
-            return static_cast<double>(strtoul(value_string.characters() + 2, nullptr, 2));
-        } else if (isdigit(value_string[1])) {
+            return static_cast<double>(strtoul(String(m_value.substring_view(2, m_value.length() - 2)).characters(), nullptr, 2));
+        } else if (isdigit(prefix)) {
             // also octal, but syntax error in strict mode
-            return static_cast<double>(strtoul(value_string.characters() + 1, nullptr, 8));
+            return static_cast<double>(strtoul(String(m_value.substring_view(1, m_value.length() - 1)).characters(), nullptr, 8));
         }
     }
-    return strtod(value_string.characters(), nullptr);
+    return parse_double(m_value).value_or(0);
 }
 
 static u32 hex2int(char x)
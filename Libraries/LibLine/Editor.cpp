@@ -26,11 +26,13 @@
 
 #include "Editor.h"
 #include <AK/JsonObject.h>
+#include <AK/MappedFile.h>
 #include <AK/StringBuilder.h>
 #include <AK/Utf32View.h>
 #include <AK/Utf8View.h>
 #include <LibCore/Event.h>
 #include <LibCore/EventLoop.h>
+#include <LibCore/File.h>
 #include <LibCore/Notifier.h>
 #include <ctype.h>
 #include <stdio.h>
@@ -78,9 +80,91 @@ void Editor::add_to_history(const String& line)
 {
     if (line.is_empty())
         return;
-    if ((m_history.size() + 1) > m_history_capacity)
+    if ((m_history.size() + 1) > m_history_capacity) {
         m_history.take_first();
+        ++m_history_first_id;
+        ++m_history_evicted_since_reindex;
+    }
     m_history.append(line);
+    m_history_index.add(m_history_first_id + m_history.size() - 1, line);
+
+    if (m_history_evicted_since_reindex > max<size_t>(m_history_capacity, 1024)) {
+        m_history_index.clear();
+        for (size_t i = 0; i < m_history.size(); ++i)
+            m_history_index.add(m_history_first_id + i, m_history[i]);
+        m_history_evicted_since_reindex = 0;
+    }
+}
+
+void Editor::set_history_capacity(size_t capacity)
+{
+    ASSERT(capacity);
+    m_history_capacity = capacity;
+    while (m_history.size() > m_history_capacity) {
+        m_history.take_first();
+        ++m_history_first_id;
+        ++m_history_evicted_since_reindex;
+    }
+}
+
+bool Editor::load_history(const String& path)
+{
+    // There's nothing to map for a missing or empty file, and MappedFile would complain about it.
+    struct stat st;
+    if (stat(path.characters(), &st) < 0)
+        return false;
+    if (!st.st_size) {
+        m_history_saved_up_to_id = m_history_first_id + m_history.size();
+        m_history_file_line_count = 0;
+        return true;
+    }
+
+    MappedFile file(path);
+    if (!file.is_valid())
+        return false;
+
+    StringView contents { (const char*)file.data(), file.size() };
+    Vector<StringView> lines;
+    size_t start = 0;
+    for (size_t i = 0; i < contents.length(); ++i) {
+        if (contents[i] != '\n')
+            continue;
+        lines.append(contents.substring_view(start, i - start));
+        start = i + 1;
+    }
+    if (start < contents.length())
+        lines.append(contents.substring_view(start, contents.length() - start));
+
+    size_t first_line = lines.size() > m_history_capacity ? lines.size() - m_history_capacity : 0;
+    for (size_t i = first_line; i < lines.size(); ++i)
+        add_to_history(lines[i]);
+
+    m_history_saved_up_to_id = m_history_first_id + m_history.size();
+    m_history_file_line_count = lines.size();
+    return true;
+}
+
+bool Editor::save_history(const String& path)
+{
+    // Appending keeps what other editors wrote in the meantime, but don't let the file grow forever.
+    bool should_rewrite = m_history_file_line_count > 2 * m_history_capacity;
+    auto mode = should_rewrite ? Core::IODevice::WriteOnly : Core::IODevice::WriteOnly | Core::IODevice::Append;
+    auto file_or_error = Core::File::open(path, (Core::IODevice::OpenMode)mode, 0600);
+    if (file_or_error.is_error())
+        return false;
+    auto& file = *file_or_error.value();
+
+    size_t first_index = 0;
+    if (!should_rewrite && m_history_saved_up_to_id > m_history_first_id)
+        first_index = min<size_t>(m_history_saved_up_to_id - m_history_first_id, m_history.size());
+    for (size_t i = first_index; i < m_history.size(); ++i) {
+        file.write(m_history[i]);
+        file.write("\n");
+    }
+
+    m_history_file_line_count = should_rewrite ? m_history.size() : m_history_file_line_count + m_history.size() - first_index;
+    m_history_saved_up_to_id = m_history_first_id + m_history.size();
+    return true;
 }
 
 void Editor::clear_line()
@@ -1130,13 +1214,24 @@ bool Editor::search(const StringView& phrase, bool allow_empty, bool from_beginn
     // Do not search for empty strings.
     if (allow_empty || phrase.length() > 0) {
         size_t search_offset = m_search_offset;
-        for (size_t i = m_history_cursor; i > 0; --i) {
-            auto contains = from_beginning ? m_history[i - 1].starts_with(phrase) : m_history[i - 1].contains(phrase);
-            if (contains) {
-                last_matching_offset = i - 1;
-                if (search_offset == 0)
+        auto matches = [&](size_t index) {
+            if (!(from_beginning ? m_history[index].starts_with(phrase) : m_history[index].contains(phrase)))
+                return false;
+            last_matching_offset = index;
+            return search_offset-- == 0;
+        };
+        if (auto* candidates = m_history_index.candidates_for(phrase)) {
+            for (size_t i = candidates->size(); i > 0; --i) {
+                auto id = candidates->at(i - 1);
+                if (id < m_history_first_id)
+                    break;
+                if (id - m_history_first_id < m_history_cursor && matches(id - m_history_first_id))
+                    break;
+            }
+        } else {
+            for (size_t i = m_history_cursor; i > 0; --i) {
+                if (matches(i - 1))
                     break;
-                --search_offset;
             }
         }
 
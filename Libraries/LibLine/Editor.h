@@ -40,6 +40,7 @@
 #include <LibCore/DirIterator.h>
 #include <LibCore/Notifier.h>
 #include <LibCore/Object.h>
+#include <LibLine/HistoryIndex.h>
 #include <LibLine/Span.h>
 #include <LibLine/StringMetrics.h>
 #include <LibLine/Style.h>
@@ -99,6 +100,12 @@ public:
 
     void add_to_history(const String&);
     const Vector<String>& history() const { return m_history; }
+    void set_history_capacity(size_t);
+
+    // The history file has one entry per line, oldest first. Only the newest entries that fit in the history are loaded,
+    // and saving appends the entries added since loading, so several editors can share a file without overwriting each other.
+    bool load_history(const String& path);
+    bool save_history(const String& path);
 
     void register_character_input_callback(char ch, Function<bool(Editor&)> callback);
     StringMetrics actual_rendered_string_metrics(const StringView&) const;
@@ -367,6 +374,14 @@ private:
     Vector<String> m_history;
     size_t m_history_cursor { 0 };
     size_t m_history_capacity { 100 };
+    // Entries get an id in the order they're added; m_history[i] has id m_history_first_id + i.
+    u32 m_history_first_id { 0 };
+    HistoryIndex m_history_index;
+    // Evicted entries linger in the index until there are enough of them to be worth rebuilding it.
+    size_t m_history_evicted_since_reindex { 0 };
+    // The entries with lower ids are already in the history file, which has m_history_file_line_count lines.
+    u32 m_history_saved_up_to_id { 0 };
+    size_t m_history_file_line_count { 0 };
 
     enum class InputState {
         Free,
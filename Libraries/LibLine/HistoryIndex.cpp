@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2020, The SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <LibLine/HistoryIndex.h>
+
+namespace Line {
+
+u32 HistoryIndex::trigram_at(const StringView& string, size_t index)
+{
+    return (u8)string[index] | ((u8)string[index + 1] << 8) | ((u8)string[index + 2] << 16);
+}
+
+void HistoryIndex::add(u32 id, const StringView& entry)
+{
+    for (size_t i = 0; i + 3 <= entry.length(); ++i) {
+        auto& entries = m_entries_by_trigram.ensure(trigram_at(entry, i));
+        // Entries are added in order, so a repeated trigram within one entry is always the last one on the list.
+        if (entries.is_empty() || entries.last() != id)
+            entries.append(id);
+    }
+}
+
+const Vector<u32>* HistoryIndex::candidates_for(const StringView& phrase) const
+{
+    static const Vector<u32> no_entries;
+
+    if (phrase.length() < 3)
+        return nullptr;
+
+    const Vector<u32>* rarest = nullptr;
+    for (size_t i = 0; i + 3 <= phrase.length(); ++i) {
+        auto it = m_entries_by_trigram.find(trigram_at(phrase, i));
+        if (it == m_entries_by_trigram.end())
+            return &no_entries;
+        if (!rarest || it->value.size() < rarest->size())
+            rarest = &it->value;
+    }
+    return rarest;
+}
+
+}
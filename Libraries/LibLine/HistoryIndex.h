@@ -0,0 +1,53 @@
+/*
+ * Copyright (c) 2020, The SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/HashMap.h>
+#include <AK/StringView.h>
+#include <AK/Vector.h>
+
+namespace Line {
+
+// Maps every three-byte sequence in the history to the entries that contain it, so a search only
+// has to look at the entries sharing the rarest trigram of its phrase, not at the whole history.
+// Entries are identified by the order in which they were added, and identifiers are never reused.
+class HistoryIndex {
+public:
+    void add(u32 id, const StringView& entry);
+    void clear() { m_entries_by_trigram.clear(); }
+
+    // The ids of the entries that may contain the phrase, oldest first; whoever asks still has to check.
+    // Returns nullptr if the phrase is too short to look up, in which case any entry may contain it.
+    const Vector<u32>* candidates_for(const StringView& phrase) const;
+
+private:
+    static u32 trigram_at(const StringView&, size_t index);
+
+    HashMap<u32, Vector<u32>> m_entries_by_trigram;
+};
+
+}
@@ -27,6 +27,8 @@
 #include <AK/SharedBuffer.h>
 #include <LibProtocol/Client.h>
 #include <LibProtocol/Download.h>
+#include <stdio.h>
+#include <sys/socket.h>
 
 namespace Protocol {
 
@@ -47,16 +49,24 @@ bool Client::is_supported_protocol(const String& protocol)
     return send_sync<Messages::ProtocolServer::IsSupportedProtocol>(protocol)->supported();
 }
 
-RefPtr<Download> Client::start_download(const String& url, const HashMap<String, String>& request_headers)
+RefPtr<Download> Client::start_download(const String& url, const HashMap<String, String>& request_headers, bool stream_response)
 {
     IPC::Dictionary header_dictionary;
     for (auto& it : request_headers)
         header_dictionary.add(it.key, it.value);
 
-    i32 download_id = send_sync<Messages::ProtocolServer::StartDownload>(url, header_dictionary)->download_id();
+    i32 download_id = send_sync<Messages::ProtocolServer::StartDownload>(url, header_dictionary, stream_response)->download_id();
     if (download_id < 0)
         return nullptr;
     auto download = Download::create_from_id({}, *this, download_id);
+    if (stream_response) {
+        // The server passed us the read end of a pipe that the body is streamed into.
+        int stream_fd = recvfd(socket_fd());
+        if (stream_fd < 0)
+            perror("recvfd");
+        else
+            download->set_stream_fd({}, stream_fd);
+    }
     m_downloads.set(download_id, download);
     return download;
 }
@@ -92,6 +102,13 @@ void Client::handle(const Messages::ProtocolClient::DownloadProgress& message)
     }
 }
 
+void Client::handle(const Messages::ProtocolClient::DownloadHeadersReceived& message)
+{
+    if (auto download = const_cast<Download*>(m_downloads.get(message.download_id()).value_or(nullptr))) {
+        download->did_receive_headers({}, message.status_code(), message.response_headers());
+    }
+}
+
 OwnPtr<Messages::ProtocolClient::CertificateRequestedResponse> Client::handle(const Messages::ProtocolClient::CertificateRequested& message)
 {
     if (auto download = const_cast<Download*>(m_downloads.get(message.download_id()).value_or(nullptr))) {
@@ -44,7 +44,8 @@ public:
     virtual void handshake() override;
 
     bool is_supported_protocol(const String&);
-    RefPtr<Download> start_download(const String& url, const HashMap<String, String>& request_headers = {});
+    // With stream_response, the download's on_headers_received and on_data_received are called as the response arrives.
+    RefPtr<Download> start_download(const String& url, const HashMap<String, String>& request_headers = {}, bool stream_response = false);
 
     bool stop_download(Badge<Download>, Download&);
     bool set_certificate(Badge<Download>, Download&, String, String);
@@ -54,6 +55,7 @@ private:
 
     virtual void handle(const Messages::ProtocolClient::DownloadProgress&) override;
     virtual void handle(const Messages::ProtocolClient::DownloadFinished&) override;
+    virtual void handle(const Messages::ProtocolClient::DownloadHeadersReceived&) override;
     virtual OwnPtr<Messages::ProtocolClient::CertificateRequestedResponse> handle(const Messages::ProtocolClient::CertificateRequested&) override;
 
     HashMap<i32, RefPtr<Download>> m_downloads;
@@ -27,6 +27,10 @@
 #include <AK/SharedBuffer.h>
 #include <LibProtocol/Client.h>
 #include <LibProtocol/Download.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <unistd.h>
 
 namespace Protocol {
 
@@ -36,6 +40,14 @@ Download::Download(Client& client, i32 download_id)
 {
 }
 
+Download::~Download()
+{
+    if (m_stream_fd >= 0) {
+        m_stream_notifier->set_enabled(false);
+        close(m_stream_fd);
+    }
+}
+
 bool Download::stop()
 {
     return m_client->stop_download({}, *this);
@@ -43,6 +55,15 @@ bool Download::stop()
 
 void Download::did_finish(Badge<Client>, bool success, Optional<u32> status_code, u32 total_size, i32 shbuf_id, const IPC::Dictionary& response_headers)
 {
+    if (m_stream_fd >= 0) {
+        // The server closes its end before telling us it's done, so this won't block.
+        read_from_stream();
+        m_stream_notifier->set_enabled(false);
+        m_stream_notifier = nullptr;
+        close(m_stream_fd);
+        m_stream_fd = -1;
+    }
+
     if (!on_finish)
         return;
 
@@ -51,6 +72,14 @@ void Download::did_finish(Badge<Client>, bool success, Optional<u32> status_code
     if (success && shbuf_id != -1) {
         shared_buffer = SharedBuffer::create_from_shbuf_id(shbuf_id);
         payload = ByteBuffer::wrap(shared_buffer->data(), total_size);
+    } else if (success && !m_received_buffers.is_empty()) {
+        payload = ByteBuffer::create_uninitialized(m_received_size);
+        u8* payload_ptr = payload.data();
+        for (auto& received_buffer : m_received_buffers) {
+            memcpy(payload_ptr, received_buffer.data(), received_buffer.size());
+            payload_ptr += received_buffer.size();
+        }
+        m_received_buffers.clear();
     }
 
     // FIXME: It's a bit silly that we copy the response headers here just so we can move them into a HashMap with different traits.
@@ -68,6 +97,61 @@ void Download::did_progress(Badge<Client>, Optional<u32> total_size, u32 downloa
         on_progress(total_size, downloaded_size);
 }
 
+void Download::did_receive_headers(Badge<Client>, Optional<u32> status_code, const IPC::Dictionary& response_headers)
+{
+    if (!on_headers_received)
+        return;
+
+    HashMap<String, String, CaseInsensitiveStringTraits> caseless_response_headers;
+    response_headers.for_each_entry([&](auto& name, auto& value) {
+        caseless_response_headers.set(name, value);
+    });
+
+    on_headers_received(caseless_response_headers, status_code);
+}
+
+void Download::set_stream_fd(Badge<Client>, int fd)
+{
+    ASSERT(m_stream_fd == -1);
+    m_stream_fd = fd;
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    m_stream_notifier = Core::Notifier::construct(fd, Core::Notifier::Event::Read);
+    m_stream_notifier->on_ready_to_read = [this] { read_from_stream(); };
+}
+
+void Download::read_from_stream()
+{
+    // Keep ourselves alive in case a callback drops the last reference to us.
+    NonnullRefPtr<Download> protector(*this);
+    for (;;) {
+        u8 buffer[16 * KB];
+        ssize_t nread = read(m_stream_fd, buffer, sizeof(buffer));
+        if (nread < 0) {
+            if (errno == EINTR)
+                continue;
+            if (errno != EAGAIN)
+                perror("Download: read");
+            return;
+        }
+        if (nread == 0) {
+            // The server is done writing; DownloadFinished is on its way.
+            m_stream_notifier->set_enabled(false);
+            return;
+        }
+        did_receive_data(ByteBuffer::copy(buffer, nread));
+    }
+}
+
+void Download::did_receive_data(ByteBuffer data)
+{
+    if (on_data_received)
+        on_data_received(data);
+    if (m_should_buffer_all_input) {
+        m_received_size += data.size();
+        m_received_buffers.append(move(data));
+    }
+}
+
 void Download::did_request_certificates(Badge<Client>)
 {
     if (on_certificate_requested) {
@@ -31,7 +31,9 @@
 #include <AK/Function.h>
 #include <AK/RefCounted.h>
 #include <AK/String.h>
+#include <AK/Vector.h>
 #include <AK/WeakPtr.h>
+#include <LibCore/Notifier.h>
 #include <LibIPC/Forward.h>
 
 namespace Protocol {
@@ -50,21 +52,40 @@ public:
         return adopt(*new Download(client, download_id));
     }
 
+    ~Download();
+
     int id() const { return m_download_id; }
     bool stop();
 
+    // A streamed download normally still hands all of the body to on_finish. Turn this off
+    // if on_data_received is all you need, so it doesn't pile up in memory.
+    void set_should_buffer_all_input(bool should_buffer) { m_should_buffer_all_input = should_buffer; }
+
     Function<void(bool success, const ByteBuffer& payload, RefPtr<SharedBuffer> payload_storage, const HashMap<String, String, CaseInsensitiveStringTraits>& response_headers, Optional<u32> status_code)> on_finish;
     Function<void(Optional<u32> total_size, u32 downloaded_size)> on_progress;
+    Function<void(const HashMap<String, String, CaseInsensitiveStringTraits>& response_headers, Optional<u32> status_code)> on_headers_received;
+    Function<void(const ByteBuffer&)> on_data_received;
     Function<CertificateAndKey()> on_certificate_requested;
 
     void did_finish(Badge<Client>, bool success, Optional<u32> status_code, u32 total_size, i32 shbuf_id, const IPC::Dictionary& response_headers);
     void did_progress(Badge<Client>, Optional<u32> total_size, u32 downloaded_size);
     void did_request_certificates(Badge<Client>);
+    void did_receive_headers(Badge<Client>, Optional<u32> status_code, const IPC::Dictionary& response_headers);
+    void set_stream_fd(Badge<Client>, int fd);
 
 private:
     explicit Download(Client&, i32 download_id);
+
+    void read_from_stream();
+    void did_receive_data(ByteBuffer);
+
     WeakPtr<Client> m_client;
     int m_download_id { -1 };
+    int m_stream_fd { -1 };
+    RefPtr<Core::Notifier> m_stream_notifier;
+    bool m_should_buffer_all_input { true };
+    Vector<ByteBuffer> m_received_buffers;
+    size_t m_received_size { 0 };
 };
 
 }
@@ -34,6 +34,7 @@
 #include <signal.h>
 #include <stdio.h>
 #include <string.h>
+#include <sys/internals.h>
 #include <sys/mman.h>
 #include <time.h>
 #include <unistd.h>
@@ -134,6 +135,7 @@ int pthread_create(pthread_t* thread, pthread_attr_t* attributes, void* (*start_
 
 void pthread_exit(void* value_ptr)
 {
+    __malloc_thread_exit();
     exit_thread(value_ptr);
 }
 
@@ -168,31 +170,57 @@ int pthread_mutex_destroy(pthread_mutex_t*)
     return 0;
 }
 
+// Mutexes are three-state futex locks: 0 is unlocked, 1 is locked, 2 is locked with (maybe) sleeping waiters.
+// Only waking up from (or going to) the 2 state costs a syscall, and contenders spin for a bit first,
+// since most critical sections are shorter than a trip through the kernel.
+
+static constexpr int mutex_spin_count = 100;
+
+static inline void spin_pause()
+{
+    asm volatile("pause");
+}
+
+static inline i32* futex_word(u32* word)
+{
+    return reinterpret_cast<i32*>(word);
+}
+
+static void mutex_lock_contended(pthread_mutex_t* mutex)
+{
+    for (int i = 0; i < mutex_spin_count; ++i) {
+        u32 expected = 0;
+        if (AK::atomic_load(&mutex->lock, AK::memory_order_relaxed) == 0
+            && AK::atomic_compare_exchange_strong(&mutex->lock, expected, 1u, AK::memory_order_acquire))
+            return;
+        spin_pause();
+    }
+
+    // Whoever holds the lock now has to wake someone when unlocking. We might end up marking an
+    // uncontended lock as contended, which only costs the next unlock a spurious FUTEX_WAKE.
+    while (AK::atomic_exchange(&mutex->lock, 2u, AK::memory_order_acquire) != 0)
+        futex(futex_word(&mutex->lock), FUTEX_WAIT, 2, nullptr);
+}
+
 int pthread_mutex_lock(pthread_mutex_t* mutex)
 {
-    auto& atomic = reinterpret_cast<Atomic<u32>&>(mutex->lock);
     pthread_t this_thread = pthread_self();
-    for (;;) {
-        u32 expected = false;
-        if (!atomic.compare_exchange_strong(expected, true, AK::memory_order_acq_rel)) {
-            if (mutex->type == PTHREAD_MUTEX_RECURSIVE && mutex->owner == this_thread) {
-                mutex->level++;
-                return 0;
-            }
-            sched_yield();
-            continue;
-        }
-        mutex->owner = this_thread;
-        mutex->level = 0;
+    if (mutex->type == PTHREAD_MUTEX_RECURSIVE && mutex->owner == this_thread) {
+        mutex->level++;
         return 0;
     }
+    u32 expected = 0;
+    if (!AK::atomic_compare_exchange_strong(&mutex->lock, expected, 1u, AK::memory_order_acquire))
+        mutex_lock_contended(mutex);
+    mutex->owner = this_thread;
+    mutex->level = 0;
+    return 0;
 }
 
 int pthread_mutex_trylock(pthread_mutex_t* mutex)
 {
-    auto& atomic = reinterpret_cast<Atomic<u32>&>(mutex->lock);
-    u32 expected = false;
-    if (!atomic.compare_exchange_strong(expected, true, AK::memory_order_acq_rel)) {
+    u32 expected = 0;
+    if (!AK::atomic_compare_exchange_strong(&mutex->lock, expected, 1u, AK::memory_order_acquire)) {
         if (mutex->type == PTHREAD_MUTEX_RECURSIVE && mutex->owner == pthread_self()) {
             mutex->level++;
             return 0;
@@ -211,7 +239,8 @@ int pthread_mutex_unlock(pthread_mutex_t* mutex)
         return 0;
     }
     mutex->owner = 0;
-    mutex->lock = 0;
+    if (AK::atomic_exchange(&mutex->lock, 0u, AK::memory_order_release) == 2)
+        futex(futex_word(&mutex->lock), FUTEX_WAKE, 1, nullptr);
     return 0;
 }
 
@@ -476,7 +505,6 @@ int pthread_setschedparam(pthread_t thread, int policy, const struct sched_param
 int pthread_cond_init(pthread_cond_t* cond, const pthread_condattr_t* attr)
 {
     cond->value = 0;
-    cond->previous = 0;
     cond->clockid = attr ? attr->clockid : CLOCK_MONOTONIC;
     return 0;
 }
@@ -486,14 +514,27 @@ int pthread_cond_destroy(pthread_cond_t*)
     return 0;
 }
 
+// Condition variables are a futex sequence number: waiters sleep for as long as it stays the value they
+// saw while still holding the mutex, so a signal sent between unlocking and sleeping isn't lost.
 static int cond_wait(pthread_cond_t* cond, pthread_mutex_t* mutex, const struct timespec* abstime)
 {
-    i32 value = cond->value;
-    cond->previous = value;
+    i32 value = AK::atomic_load(&cond->value, AK::memory_order_relaxed);
+
+    // We can't tell whether anyone else is sleeping on the mutex, so take it back as contended.
+    int level = mutex->level;
+    mutex->level = 0;
     pthread_mutex_unlock(mutex);
     int rc = futex(&cond->value, FUTEX_WAIT, value, abstime);
-    pthread_mutex_lock(mutex);
-    return rc;
+    int saved_errno = errno;
+    while (AK::atomic_exchange(&mutex->lock, 2u, AK::memory_order_acquire) != 0)
+        futex(futex_word(&mutex->lock), FUTEX_WAIT, 2, nullptr);
+    mutex->owner = pthread_self();
+    mutex->level = level;
+
+    if (rc < 0 && saved_errno == ETIMEDOUT)
+        return ETIMEDOUT;
+    // EAGAIN just means we were signalled before we got to sleep.
+    return 0;
 }
 
 int pthread_cond_wait(pthread_cond_t* cond, pthread_mutex_t* mutex)
@@ -527,8 +568,7 @@ int pthread_cond_timedwait(pthread_cond_t* cond, pthread_mutex_t* mutex, const s
 
 int pthread_cond_signal(pthread_cond_t* cond)
 {
-    u32 value = cond->previous + 1;
-    cond->value = value;
+    AK::atomic_fetch_add(&cond->value, 1, AK::memory_order_release);
     int rc = futex(&cond->value, FUTEX_WAKE, 1, nullptr);
     ASSERT(rc == 0);
     return 0;
@@ -536,13 +576,189 @@ int pthread_cond_signal(pthread_cond_t* cond)
 
 int pthread_cond_broadcast(pthread_cond_t* cond)
 {
-    u32 value = cond->previous + 1;
-    cond->value = value;
+    AK::atomic_fetch_add(&cond->value, 1, AK::memory_order_release);
     int rc = futex(&cond->value, FUTEX_WAKE, INT32_MAX, nullptr);
     ASSERT(rc == 0);
     return 0;
 }
 
+// Read/write locks keep the reader count (or rwlock_write_locked) in the low 31 bits of the lock word,
+// and set rwlock_has_sleepers when someone went to sleep on it. There's no writer preference.
+
+static constexpr u32 rwlock_write_locked = 0x7fffffff;
+static constexpr u32 rwlock_max_readers = 0x7ffffffe;
+static constexpr u32 rwlock_has_sleepers = 0x80000000;
+
+int pthread_rwlock_init(pthread_rwlock_t* rwlock, const pthread_rwlockattr_t*)
+{
+    rwlock->lock = 0;
+    rwlock->waiters = 0;
+    return 0;
+}
+
+int pthread_rwlock_destroy(pthread_rwlock_t*)
+{
+    return 0;
+}
+
+int pthread_rwlock_tryrdlock(pthread_rwlock_t* rwlock)
+{
+    u32 value = AK::atomic_load(&rwlock->lock, AK::memory_order_relaxed);
+    for (;;) {
+        u32 count = value & ~rwlock_has_sleepers;
+        if (count == rwlock_write_locked)
+            return EBUSY;
+        if (count == rwlock_max_readers)
+            return EAGAIN;
+        if (AK::atomic_compare_exchange_strong(&rwlock->lock, value, value + 1, AK::memory_order_acquire))
+            return 0;
+    }
+}
+
+int pthread_rwlock_trywrlock(pthread_rwlock_t* rwlock)
+{
+    u32 expected = 0;
+    if (!AK::atomic_compare_exchange_strong(&rwlock->lock, expected, rwlock_write_locked, AK::memory_order_acquire))
+        return EBUSY;
+    return 0;
+}
+
+static int rwlock_lock(pthread_rwlock_t* rwlock, int (*try_lock)(pthread_rwlock_t*), bool (*must_wait)(u32 count))
+{
+    for (int i = 0; i < mutex_spin_count; ++i) {
+        int rc = try_lock(rwlock);
+        if (rc != EBUSY)
+            return rc;
+        spin_pause();
+    }
+
+    int rc;
+    while ((rc = try_lock(rwlock)) == EBUSY) {
+        u32 value = AK::atomic_load(&rwlock->lock, AK::memory_order_relaxed);
+        if (!must_wait(value & ~rwlock_has_sleepers))
+            continue;
+        u32 sleeping_value = value | rwlock_has_sleepers;
+        AK::atomic_fetch_add(&rwlock->waiters, 1u);
+        (void)AK::atomic_compare_exchange_strong(&rwlock->lock, value, sleeping_value);
+        futex(futex_word(&rwlock->lock), FUTEX_WAIT, (i32)sleeping_value, nullptr);
+        AK::atomic_fetch_add(&rwlock->waiters, (u32)-1);
+    }
+    return rc;
+}
+
+int pthread_rwlock_rdlock(pthread_rwlock_t* rwlock)
+{
+    return rwlock_lock(rwlock, pthread_rwlock_tryrdlock, [](u32 count) { return count == rwlock_write_locked; });
+}
+
+int pthread_rwlock_wrlock(pthread_rwlock_t* rwlock)
+{
+    return rwlock_lock(rwlock, pthread_rwlock_trywrlock, [](u32 count) { return count != 0; });
+}
+
+int pthread_rwlock_unlock(pthread_rwlock_t* rwlock)
+{
+    u32 value = AK::atomic_load(&rwlock->lock, AK::memory_order_relaxed);
+    u32 new_value;
+    u32 waiters;
+    do {
+        u32 count = value & ~rwlock_has_sleepers;
+        waiters = AK::atomic_load(&rwlock->waiters, AK::memory_order_relaxed);
+        new_value = (count == rwlock_write_locked || count == 1) ? 0 : value - 1;
+    } while (!AK::atomic_compare_exchange_strong(&rwlock->lock, value, new_value, AK::memory_order_release));
+
+    // Both readers and writers may be asleep, so let all of them race for the lock.
+    if (new_value == 0 && (waiters || (value & rwlock_has_sleepers)))
+        futex(futex_word(&rwlock->lock), FUTEX_WAKE, INT32_MAX, nullptr);
+    return 0;
+}
+
+int pthread_rwlockattr_init(pthread_rwlockattr_t* attr)
+{
+    attr->pshared = PTHREAD_PROCESS_PRIVATE;
+    return 0;
+}
+
+int pthread_rwlockattr_destroy(pthread_rwlockattr_t*)
+{
+    return 0;
+}
+
+int pthread_spin_init(pthread_spinlock_t* lock, int)
+{
+    lock->lock = 0;
+    return 0;
+}
+
+int pthread_spin_destroy(pthread_spinlock_t*)
+{
+    return 0;
+}
+
+int pthread_spin_lock(pthread_spinlock_t* lock)
+{
+    for (;;) {
+        if (AK::atomic_exchange(&lock->lock, 1u, AK::memory_order_acquire) == 0)
+            return 0;
+        while (AK::atomic_load(&lock->lock, AK::memory_order_relaxed))
+            spin_pause();
+    }
+}
+
+int pthread_spin_trylock(pthread_spinlock_t* lock)
+{
+    if (AK::atomic_exchange(&lock->lock, 1u, AK::memory_order_acquire) != 0)
+        return EBUSY;
+    return 0;
+}
+
+int pthread_spin_unlock(pthread_spinlock_t* lock)
+{
+    AK::atomic_store(&lock->lock, 0u, AK::memory_order_release);
+    return 0;
+}
+
+int pthread_barrier_init(pthread_barrier_t* barrier, const pthread_barrierattr_t*, unsigned count)
+{
+    if (count == 0)
+        return EINVAL;
+    barrier->count = count;
+    barrier->arrived = 0;
+    barrier->generation = 0;
+    return 0;
+}
+
+int pthread_barrier_destroy(pthread_barrier_t*)
+{
+    return 0;
+}
+
+int pthread_barrier_wait(pthread_barrier_t* barrier)
+{
+    // Read the generation before arriving, the last thread to arrive bumps it right after.
+    i32 generation = AK::atomic_load(&barrier->generation, AK::memory_order_acquire);
+    if (AK::atomic_fetch_add(&barrier->arrived, 1u, AK::memory_order_acq_rel) + 1 == barrier->count) {
+        AK::atomic_store(&barrier->arrived, 0u, AK::memory_order_relaxed);
+        AK::atomic_fetch_add(&barrier->generation, 1, AK::memory_order_release);
+        futex(&barrier->generation, FUTEX_WAKE, INT32_MAX, nullptr);
+        return PTHREAD_BARRIER_SERIAL_THREAD;
+    }
+    while (AK::atomic_load(&barrier->generation, AK::memory_order_acquire) == generation)
+        futex(&barrier->generation, FUTEX_WAIT, generation, nullptr);
+    return 0;
+}
+
+int pthread_barrierattr_init(pthread_barrierattr_t* attr)
+{
+    attr->pshared = PTHREAD_PROCESS_PRIVATE;
+    return 0;
+}
+
+int pthread_barrierattr_destroy(pthread_barrierattr_t*)
+{
+    return 0;
+}
+
 static const int max_keys = 64;
 
 typedef void (*KeyDestructor)(void*);
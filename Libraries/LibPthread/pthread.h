@@ -79,7 +79,13 @@ int pthread_setschedparam(pthread_t thread, int policy, const struct sched_param
 #define PTHREAD_MUTEX_RECURSIVE 1
 #define PTHREAD_MUTEX_DEFAULT PTHREAD_MUTEX_NORMAL
 #define PTHREAD_MUTEX_INITIALIZER { 0, 0, 0, PTHREAD_MUTEX_DEFAULT }
-#define PTHREAD_COND_INITIALIZER { 0, 0, CLOCK_MONOTONIC }
+#define PTHREAD_COND_INITIALIZER { 0, CLOCK_MONOTONIC }
+#define PTHREAD_RWLOCK_INITIALIZER { 0, 0 }
+
+#define PTHREAD_PROCESS_PRIVATE 0
+#define PTHREAD_PROCESS_SHARED 1
+
+#define PTHREAD_BARRIER_SERIAL_THREAD -1
 
 int pthread_key_create(pthread_key_t* key, void (*destructor)(void*));
 int pthread_key_delete(pthread_key_t key);
@@ -96,6 +102,22 @@ int pthread_cond_timedwait(pthread_cond_t*, pthread_mutex_t*, const struct times
 
 void pthread_testcancel(void);
 
+int pthread_rwlock_init(pthread_rwlock_t*, const pthread_rwlockattr_t*);
+int pthread_rwlock_destroy(pthread_rwlock_t*);
+int pthread_rwlock_rdlock(pthread_rwlock_t*);
+int pthread_rwlock_tryrdlock(pthread_rwlock_t*);
+int pthread_rwlock_wrlock(pthread_rwlock_t*);
+int pthread_rwlock_trywrlock(pthread_rwlock_t*);
+int pthread_rwlock_unlock(pthread_rwlock_t*);
+int pthread_rwlockattr_init(pthread_rwlockattr_t*);
+int pthread_rwlockattr_destroy(pthread_rwlockattr_t*);
+
+int pthread_barrier_init(pthread_barrier_t*, const pthread_barrierattr_t*, unsigned);
+int pthread_barrier_destroy(pthread_barrier_t*);
+int pthread_barrier_wait(pthread_barrier_t*);
+int pthread_barrierattr_init(pthread_barrierattr_t*);
+int pthread_barrierattr_destroy(pthread_barrierattr_t*);
+
 int pthread_spin_destroy(pthread_spinlock_t*);
 int pthread_spin_init(pthread_spinlock_t*, int);
 int pthread_spin_lock(pthread_spinlock_t*);
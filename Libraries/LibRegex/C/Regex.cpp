@@ -0,0 +1,187 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <AK/StringView.h>
+#include <LibRegex/Regex.h>
+#include <regex.h>
+#include <string.h>
+
+struct CompiledRegex {
+    Regex::Pattern pattern;
+    bool no_subexpressions { false };
+};
+
+static int error_code(Regex::Error error)
+{
+    switch (error) {
+    case Regex::Error::None:
+        return REG_NOERROR;
+    case Regex::Error::InvalidCharacterClass:
+        return REG_ECTYPE;
+    case Regex::Error::TrailingBackslash:
+        return REG_EESCAPE;
+    case Regex::Error::InvalidBackReference:
+        return REG_ESUBREG;
+    case Regex::Error::UnmatchedBracket:
+        return REG_EBRACK;
+    case Regex::Error::UnmatchedParenthesis:
+        return REG_EPAREN;
+    case Regex::Error::UnmatchedBrace:
+        return REG_EBRACE;
+    case Regex::Error::InvalidRepetitionCount:
+        return REG_BADBR;
+    case Regex::Error::InvalidRange:
+        return REG_ERANGE;
+    case Regex::Error::PatternTooLarge:
+        return REG_ESPACE;
+    case Regex::Error::NothingToRepeat:
+        return REG_BADRPT;
+    case Regex::Error::InvalidPattern:
+    case Regex::Error::InvalidGroupName:
+    case Regex::Error::UnsupportedFeature:
+        return REG_BADPAT;
+    }
+    ASSERT_NOT_REACHED();
+}
+
+extern "C" {
+
+int regcomp(regex_t* regex, const char* pattern, int cflags)
+{
+    Regex::Options options;
+    options.case_insensitive = cflags & REG_ICASE;
+    // With REG_NEWLINE, newlines separate lines for ^ and $, and . and non-matching lists
+    // don't match them.
+    options.multiline = cflags & REG_NEWLINE;
+    options.dot_all = !(cflags & REG_NEWLINE);
+
+    auto syntax = (cflags & REG_EXTENDED) ? Regex::Syntax::POSIXExtended : Regex::Syntax::POSIXBasic;
+    auto* compiled = new CompiledRegex { Regex::Pattern(pattern, syntax, options), (cflags & REG_NOSUB) != 0 };
+    if (compiled->pattern.has_error()) {
+        int error = error_code(compiled->pattern.error());
+        delete compiled;
+        regex->__data = nullptr;
+        return error;
+    }
+
+    regex->re_nsub = compiled->pattern.group_count();
+    regex->__data = compiled;
+    return REG_NOERROR;
+}
+
+int regexec(const regex_t* regex, const char* string, size_t nmatch, regmatch_t pmatch[], int eflags)
+{
+    auto* compiled = (const CompiledRegex*)regex->__data;
+    if (!compiled)
+        return REG_BADPAT;
+
+    Regex::MatchFlags flags;
+    flags.not_beginning_of_line = eflags & REG_NOTBOL;
+    flags.not_end_of_line = eflags & REG_NOTEOL;
+    auto match = compiled->pattern.search(string, 0, flags);
+    if (!match.has_value())
+        return REG_NOMATCH;
+
+    if (compiled->no_subexpressions)
+        return REG_NOERROR;
+    for (size_t i = 0; i < nmatch; ++i) {
+        if (i < match.value().groups.size() && match.value().groups[i].has_value()) {
+            pmatch[i].rm_so = match.value().groups[i].value().start;
+            pmatch[i].rm_eo = match.value().groups[i].value().end;
+        } else {
+            pmatch[i].rm_so = -1;
+            pmatch[i].rm_eo = -1;
+        }
+    }
+    return REG_NOERROR;
+}
+
+size_t regerror(int errcode, const regex_t*, char* errbuf, size_t errbuf_size)
+{
+    const char* message;
+    switch (errcode) {
+    case REG_NOERROR:
+        message = "Success";
+        break;
+    case REG_NOMATCH:
+        message = "No match";
+        break;
+    case REG_BADPAT:
+        message = "Invalid regular expression";
+        break;
+    case REG_ECOLLATE:
+        message = "Invalid collation element";
+        break;
+    case REG_ECTYPE:
+        message = "Invalid character class name";
+        break;
+    case REG_EESCAPE:
+        message = "Trailing backslash";
+        break;
+    case REG_ESUBREG:
+        message = "Invalid back reference";
+        break;
+    case REG_EBRACK:
+        message = "Unmatched [ or [^";
+        break;
+    case REG_EPAREN:
+        message = "Unmatched ( or \\(";
+        break;
+    case REG_EBRACE:
+        message = "Unmatched \\{";
+        break;
+    case REG_BADBR:
+        message = "Invalid content of \\{\\}";
+        break;
+    case REG_ERANGE:
+        message = "Invalid range end";
+        break;
+    case REG_ESPACE:
+        message = "Memory exhausted";
+        break;
+    case REG_BADRPT:
+        message = "Invalid preceding regular expression";
+        break;
+    default:
+        message = "Unknown error";
+        break;
+    }
+
+    size_t length = strlen(message);
+    if (errbuf_size) {
+        size_t copied = min(length, errbuf_size - 1);
+        memcpy(errbuf, message, copied);
+        errbuf[copied] = '\0';
+    }
+    return length + 1;
+}
+
+void regfree(regex_t* regex)
+{
+    delete (CompiledRegex*)regex->__data;
+    regex->__data = nullptr;
+}
+}
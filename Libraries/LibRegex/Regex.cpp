@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <LibRegex/Regex.h>
+#include <LibRegex/RegexMatcher.h>
+#include <LibRegex/RegexParser.h>
+
+namespace Regex {
+
+const char* error_string(Error error)
+{
+    switch (error) {
+    case Error::None:
+        return "Success";
+    case Error::InvalidPattern:
+        return "Invalid pattern";
+    case Error::InvalidCharacterClass:
+        return "Invalid character class name";
+    case Error::TrailingBackslash:
+        return "Trailing backslash";
+    case Error::InvalidBackReference:
+        return "Invalid back reference";
+    case Error::UnmatchedBracket:
+        return "Unmatched [";
+    case Error::UnmatchedParenthesis:
+        return "Unmatched ( or )";
+    case Error::UnmatchedBrace:
+        return "Unmatched {";
+    case Error::InvalidRepetitionCount:
+        return "Invalid repetition count";
+    case Error::InvalidRange:
+        return "Invalid range in character class";
+    case Error::PatternTooLarge:
+        return "Pattern too large";
+    case Error::NothingToRepeat:
+        return "Nothing to repeat";
+    case Error::InvalidGroupName:
+        return "Invalid capture group name";
+    case Error::UnsupportedFeature:
+        return "Unsupported feature";
+    }
+    ASSERT_NOT_REACHED();
+}
+
+Pattern::Pattern(StringView pattern, Syntax syntax, Options options)
+{
+    m_program.syntax = syntax;
+    m_program.options = options;
+
+    Parser parser(pattern, syntax, options);
+    auto node = parser.parse();
+    if (!node) {
+        m_error = parser.error();
+        m_error_offset = parser.error_offset();
+        return;
+    }
+
+    m_group_names = parser.group_names();
+    m_error = compile(*node, parser.group_count(), syntax, options, m_program);
+    if (m_error != Error::None)
+        m_error_offset = pattern.length();
+}
+
+bool Pattern::has_group_names() const
+{
+    for (auto& name : m_group_names) {
+        if (!name.is_null())
+            return true;
+    }
+    return false;
+}
+
+Optional<Match> Pattern::search(StringView input, size_t start, MatchFlags flags) const
+{
+    if (has_error())
+        return {};
+
+    Matcher matcher(m_program, input, flags);
+    auto registers = matcher.search(start);
+    if (!registers.has_value())
+        return {};
+
+    Match match;
+    for (size_t group = 0; group <= m_program.group_count; ++group) {
+        size_t group_start = registers.value()[2 * group];
+        size_t group_end = registers.value()[2 * group + 1];
+        Optional<Span> span;
+        if (group_start != Matcher::unset && group_end != Matcher::unset)
+            span = Span { group_start, group_end };
+        match.groups.append(span);
+    }
+    return match;
+}
+
+}
@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/Optional.h>
+#include <AK/String.h>
+#include <AK/StringView.h>
+#include <AK/Vector.h>
+#include <LibRegex/RegexOptions.h>
+#include <LibRegex/RegexProgram.h>
+
+namespace Regex {
+
+struct Span {
+    size_t start { 0 };
+    size_t end { 0 };
+
+    size_t length() const { return end - start; }
+};
+
+struct Match {
+    // Byte offsets into the input; groups[0] is the whole match, and groups that didn't
+    // participate in it are empty.
+    Vector<Optional<Span>> groups;
+
+    const Span& span() const { return groups[0].value(); }
+};
+
+// A compiled regular expression. Compile it once and search with it as often as needed.
+class Pattern {
+public:
+    explicit Pattern(StringView pattern, Syntax = Syntax::ECMAScript, Options = {});
+
+    bool has_error() const { return m_error != Error::None; }
+    Error error() const { return m_error; }
+    size_t error_offset() const { return m_error_offset; }
+
+    Syntax syntax() const { return m_program.syntax; }
+    const Options& options() const { return m_program.options; }
+
+    size_t group_count() const { return m_program.group_count; }
+    // The names of the capturing groups by their index minus one, null for unnamed groups.
+    const Vector<String>& group_names() const { return m_group_names; }
+    bool has_group_names() const;
+
+    Optional<Match> search(StringView input, size_t start = 0, MatchFlags = {}) const;
+
+private:
+    Program m_program;
+    Vector<String> m_group_names;
+    Error m_error { Error::None };
+    size_t m_error_offset { 0 };
+};
+
+}
@@ -0,0 +1,275 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <AK/StringBuilder.h>
+#include <LibRegex/RegexProgram.h>
+#include <ctype.h>
+
+namespace Regex {
+
+// Counted repetitions get unrolled, so something like (a{1000}){1000} has to be refused.
+static constexpr size_t max_program_size = 1 << 20;
+
+class Compiler {
+public:
+    Compiler(Program& program)
+        : m_program(program)
+    {
+    }
+
+    bool compile(const Node& node)
+    {
+        // Group 0 is the whole match.
+        emit_instruction(OpCode::Save, 0);
+        if (!emit(node))
+            return false;
+        emit_instruction(OpCode::Save, 1);
+        emit_instruction(OpCode::Match);
+        m_program.register_count = 2 * (m_program.group_count + 1) + m_mark_count;
+        return true;
+    }
+
+private:
+    size_t emit_instruction(OpCode op, u32 arg0 = 0, u32 arg1 = 0)
+    {
+        m_program.instructions.append({ op, arg0, arg1 });
+        return m_program.instructions.size() - 1;
+    }
+
+    size_t here() const { return m_program.instructions.size(); }
+    Instruction& at(size_t pc) { return m_program.instructions[pc]; }
+
+    bool emit(const Node&);
+    bool emit_repetition(const Node&);
+
+    Program& m_program;
+    size_t m_mark_count { 0 };
+};
+
+bool Compiler::emit(const Node& node)
+{
+    if (here() > max_program_size)
+        return false;
+
+    switch (node.type) {
+    case Node::Type::Empty:
+        return true;
+    case Node::Type::Character: {
+        u32 code_point = node.code_point;
+        if (m_program.options.case_insensitive && code_point < 128)
+            code_point = tolower(code_point);
+        emit_instruction(OpCode::Char, code_point);
+        return true;
+    }
+    case Node::Type::AnyCharacter:
+        emit_instruction(OpCode::AnyCharacter);
+        return true;
+    case Node::Type::Class:
+        m_program.classes.append(node.character_class);
+        emit_instruction(OpCode::Class, m_program.classes.size() - 1);
+        return true;
+    case Node::Type::Sequence:
+        for (auto& child : node.children) {
+            if (!emit(child))
+                return false;
+        }
+        return true;
+    case Node::Type::Alternation: {
+        // split L1, L2; L1: first; jump end; L2: split ... last; end:
+        Vector<size_t> jumps_to_end;
+        for (size_t i = 0; i < node.children.size(); ++i) {
+            bool is_last = i == node.children.size() - 1;
+            size_t split = 0;
+            if (!is_last)
+                split = emit_instruction(OpCode::Split, here() + 1);
+            if (!emit(node.children[i]))
+                return false;
+            if (!is_last) {
+                jumps_to_end.append(emit_instruction(OpCode::Jump));
+                at(split).arg1 = here();
+            }
+        }
+        for (auto jump : jumps_to_end)
+            at(jump).arg0 = here();
+        return true;
+    }
+    case Node::Type::Group:
+        if (!node.group)
+            return emit(node.children.first());
+        emit_instruction(OpCode::Save, 2 * node.group);
+        if (!emit(node.children.first()))
+            return false;
+        emit_instruction(OpCode::Save, 2 * node.group + 1);
+        return true;
+    case Node::Type::Assertion:
+        switch (node.assertion) {
+        case AssertionType::BeginningOfLine:
+            emit_instruction(OpCode::BeginningOfLine);
+            break;
+        case AssertionType::EndOfLine:
+            emit_instruction(OpCode::EndOfLine);
+            break;
+        case AssertionType::WordBoundary:
+            emit_instruction(OpCode::WordBoundary);
+            break;
+        case AssertionType::NotWordBoundary:
+            emit_instruction(OpCode::NotWordBoundary);
+            break;
+        }
+        return true;
+    case Node::Type::BackReference:
+        m_program.can_use_nfa = false;
+        emit_instruction(OpCode::BackReference, node.group);
+        return true;
+    case Node::Type::Lookahead: {
+        m_program.can_use_nfa = false;
+        auto lookahead = emit_instruction(OpCode::Lookahead, node.negated);
+        if (!emit(node.children.first()))
+            return false;
+        emit_instruction(OpCode::LookaheadMatch);
+        at(lookahead).arg1 = here();
+        return true;
+    }
+    case Node::Type::Repetition:
+        return emit_repetition(node);
+    }
+    ASSERT_NOT_REACHED();
+}
+
+bool Compiler::emit_repetition(const Node& node)
+{
+    auto& body = node.children.first();
+    if (node.max == 0)
+        return true;
+    if (node.min > max_program_size || (node.max != Node::unbounded && node.max > max_program_size))
+        return false;
+
+    for (size_t i = 0; i < node.min; ++i) {
+        if (!emit(body))
+            return false;
+    }
+
+    // Each split prefers to go on matching when greedy, and to stop when lazy.
+    auto emit_split = [&] {
+        return emit_instruction(OpCode::Split, here() + 1);
+    };
+    auto patch_split = [&](size_t split, size_t exit) {
+        if (node.greedy) {
+            at(split).arg1 = exit;
+        } else {
+            at(split).arg0 = exit;
+            at(split).arg1 = split + 1;
+        }
+    };
+
+    if (node.max == Node::unbounded) {
+        // loop: split body, exit; body: [mark] body [check]; jump loop; exit:
+        // An iteration that matched nothing can't be followed by another one, or x* for
+        // some x that can match empty would loop forever.
+        bool needs_progress_check = body.can_match_empty();
+        size_t mark = 2 * (m_program.group_count + 1) + m_mark_count;
+        if (needs_progress_check)
+            ++m_mark_count;
+
+        auto split = emit_split();
+        if (needs_progress_check)
+            emit_instruction(OpCode::SetMark, mark);
+        if (!emit(body))
+            return false;
+        if (needs_progress_check)
+            emit_instruction(OpCode::CheckProgress, mark);
+        emit_instruction(OpCode::Jump, split);
+        patch_split(split, here());
+        return true;
+    }
+
+    // The optional copies nest: split body1, exit; body1: split body2, exit; ...; exit:
+    Vector<size_t> splits;
+    for (size_t i = node.min; i < node.max; ++i) {
+        splits.append(emit_split());
+        if (!emit(body))
+            return false;
+    }
+    for (auto split : splits)
+        patch_split(split, here());
+    return true;
+}
+
+static void find_literal_prefix(const Node& node, StringBuilder& prefix, bool& done)
+{
+    if (done)
+        return;
+    switch (node.type) {
+    case Node::Type::Character:
+        if (node.code_point >= 128) {
+            done = true;
+            return;
+        }
+        prefix.append((char)node.code_point);
+        return;
+    case Node::Type::Sequence:
+        for (auto& child : node.children)
+            find_literal_prefix(child, prefix, done);
+        return;
+    case Node::Type::Group:
+        find_literal_prefix(node.children.first(), prefix, done);
+        return;
+    case Node::Type::Empty:
+    case Node::Type::Assertion:
+    case Node::Type::Lookahead:
+        // These don't consume anything, so whatever comes next still has to be matched.
+        return;
+    default:
+        done = true;
+        return;
+    }
+}
+
+Error compile(const Node& node, size_t group_count, Syntax syntax, const Options& options, Program& program)
+{
+    program.syntax = syntax;
+    program.options = options;
+    program.group_count = group_count;
+
+    Compiler compiler(program);
+    if (!compiler.compile(node))
+        return Error::PatternTooLarge;
+
+    const Node* first = &node;
+    if (first->type == Node::Type::Sequence)
+        first = &first->children.first();
+    program.anchored_at_start = first->type == Node::Type::Assertion && first->assertion == AssertionType::BeginningOfLine && !options.multiline;
+
+    if (!options.case_insensitive) {
+        StringBuilder prefix;
+        bool done = false;
+        find_literal_prefix(node, prefix, done);
+        program.literal_prefix = prefix.to_string();
+    }
+    return Error::None;
+}
+
+}
@@ -0,0 +1,431 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <LibRegex/RegexMatcher.h>
+#include <ctype.h>
+#include <string.h>
+
+namespace Regex {
+
+Matcher::Matcher(const Program& program, StringView input, const MatchFlags& flags)
+    : m_program(program)
+    , m_input(input)
+    , m_flags(flags)
+{
+    // Enough for any reasonable pattern to do its backtracking, while still bounding the
+    // time a pathological one can take before we switch to the NFA.
+    size_t budget = 4 * (m_input.length() + 1);
+    if (budget > NumericLimits<size_t>::max() / m_program.instructions.size())
+        budget = NumericLimits<size_t>::max();
+    else
+        budget *= m_program.instructions.size();
+    m_step_budget = max(budget, (size_t)100000);
+}
+
+size_t Matcher::next_position(size_t position) const
+{
+    if (position >= m_input.length())
+        return position + 1;
+    u32 code_point;
+    return position + decode(position, code_point);
+}
+
+bool Matcher::is_line_terminator(u32 code_point) const
+{
+    if (code_point == '\n')
+        return true;
+    if (m_program.syntax != Syntax::ECMAScript)
+        return false;
+    return code_point == '\r' || code_point == 0x2028 || code_point == 0x2029;
+}
+
+bool Matcher::follows_line_terminator(size_t position) const
+{
+    u8 previous = m_input[position - 1];
+    if (previous == '\n')
+        return true;
+    if (m_program.syntax != Syntax::ECMAScript)
+        return false;
+    if (previous == '\r')
+        return true;
+    // U+2028 and U+2029 are E2 80 A8 and E2 80 A9.
+    return position >= 3 && (previous == 0xa8 || previous == 0xa9) && (u8)m_input[position - 2] == 0x80 && (u8)m_input[position - 3] == 0xe2;
+}
+
+bool Matcher::is_word_character(size_t position) const
+{
+    if (position >= m_input.length())
+        return false;
+    char c = m_input[position];
+    return isalnum(c) || c == '_';
+}
+
+bool Matcher::matches(const Instruction& instruction, u32 code_point) const
+{
+    switch (instruction.op) {
+    case OpCode::Char:
+        if (m_program.options.case_insensitive && code_point < 128)
+            code_point = tolower(code_point);
+        return code_point == instruction.arg0;
+    case OpCode::Class:
+        return m_program.classes[instruction.arg0].contains(code_point);
+    case OpCode::AnyCharacter:
+        return m_program.options.dot_all || !is_line_terminator(code_point);
+    default:
+        return false;
+    }
+}
+
+bool Matcher::check_assertion(OpCode op, size_t position) const
+{
+    switch (op) {
+    case OpCode::BeginningOfLine:
+        if (position == 0)
+            return !m_flags.not_beginning_of_line;
+        return m_program.options.multiline && follows_line_terminator(position);
+    case OpCode::EndOfLine: {
+        if (position == m_input.length())
+            return !m_flags.not_end_of_line;
+        u32 code_point;
+        decode(position, code_point);
+        return m_program.options.multiline && is_line_terminator(code_point);
+    }
+    case OpCode::WordBoundary:
+    case OpCode::NotWordBoundary: {
+        bool is_boundary = (position > 0 && is_word_character(position - 1)) != is_word_character(position);
+        return is_boundary == (op == OpCode::WordBoundary);
+    }
+    default:
+        ASSERT_NOT_REACHED();
+    }
+}
+
+bool Matcher::matches_back_reference(size_t group, const size_t* registers, size_t& position) const
+{
+    size_t start = registers[2 * group];
+    size_t end = registers[2 * group + 1];
+    // A group that didn't participate in the match matches the empty string.
+    if (start == unset || end == unset || end < start)
+        return true;
+
+    size_t length = end - start;
+    if (position + length > m_input.length())
+        return false;
+    for (size_t i = 0; i < length; ++i) {
+        char a = m_input[start + i];
+        char b = m_input[position + i];
+        if (m_program.options.case_insensitive ? tolower(a) != tolower(b) : a != b)
+            return false;
+    }
+    position += length;
+    return true;
+}
+
+Optional<size_t> Matcher::find_literal_prefix(size_t start) const
+{
+    auto& prefix = m_program.literal_prefix;
+    auto* data = m_input.characters_without_null_termination();
+    size_t position = start;
+    while (position + prefix.length() <= m_input.length()) {
+        auto* found = (const char*)memchr(data + position, prefix[0], m_input.length() - prefix.length() - position + 1);
+        if (!found)
+            return {};
+        position = found - data;
+        if (!memcmp(data + position + 1, prefix.characters() + 1, prefix.length() - 1))
+            return position;
+        ++position;
+    }
+    return {};
+}
+
+Optional<Vector<size_t>> Matcher::search(size_t start)
+{
+    if (start > m_input.length())
+        return {};
+
+    bool only_at_start = m_flags.sticky || m_program.anchored_at_start;
+    for (size_t position = start; position <= m_input.length(); position = next_position(position)) {
+        if (!m_program.literal_prefix.is_empty()) {
+            auto found = find_literal_prefix(position);
+            if (!found.has_value() || (only_at_start && found.value() != position))
+                return {};
+            position = found.value();
+        }
+        if (backtrack(position))
+            return m_registers;
+        if (m_budget_exceeded)
+            return simulate_nfa(position);
+        if (only_at_start)
+            break;
+    }
+    return {};
+}
+
+bool Matcher::backtrack(size_t start)
+{
+    m_registers.resize(m_program.register_count);
+    for (auto& value : m_registers)
+        value = unset;
+    m_backtrack_stack.clear_with_capacity();
+    size_t position = start;
+    return run(0, 0, position);
+}
+
+// Runs from the pc until the program (or the lookahead being run) matches, backtracking as
+// far down as the base of the backtrack stack.
+bool Matcher::run(size_t base, size_t pc, size_t& position)
+{
+    auto& instructions = m_program.instructions;
+    for (;;) {
+        if (m_program.can_use_nfa && ++m_steps > m_step_budget) {
+            m_budget_exceeded = true;
+            return false;
+        }
+
+        auto& instruction = instructions[pc];
+        bool failed = false;
+        switch (instruction.op) {
+        case OpCode::Char:
+        case OpCode::Class:
+        case OpCode::AnyCharacter: {
+            u32 code_point;
+            if (position < m_input.length()) {
+                size_t length = decode(position, code_point);
+                if (matches(instruction, code_point)) {
+                    position += length;
+                    ++pc;
+                    break;
+                }
+            }
+            failed = true;
+            break;
+        }
+        case OpCode::Split:
+            m_backtrack_stack.append({ BacktrackEntry::Kind::Resume, instruction.arg1, position });
+            pc = instruction.arg0;
+            break;
+        case OpCode::Jump:
+            pc = instruction.arg0;
+            break;
+        case OpCode::Save:
+        case OpCode::SetMark:
+            m_backtrack_stack.append({ BacktrackEntry::Kind::Restore, instruction.arg0, m_registers[instruction.arg0] });
+            m_registers[instruction.arg0] = position;
+            ++pc;
+            break;
+        case OpCode::CheckProgress:
+            failed = m_registers[instruction.arg0] == position;
+            ++pc;
+            break;
+        case OpCode::BeginningOfLine:
+        case OpCode::EndOfLine:
+        case OpCode::WordBoundary:
+        case OpCode::NotWordBoundary:
+            failed = !check_assertion(instruction.op, position);
+            ++pc;
+            break;
+        case OpCode::BackReference:
+            failed = !matches_back_reference(instruction.arg0, m_registers.data(), position);
+            ++pc;
+            break;
+        case OpCode::Lookahead:
+            failed = !run_lookahead(pc, position);
+            pc = instruction.arg1;
+            break;
+        case OpCode::LookaheadMatch:
+        case OpCode::Match:
+            return true;
+        }
+
+        if (!failed)
+            continue;
+        for (;;) {
+            if (m_backtrack_stack.size() == base)
+                return false;
+            auto entry = m_backtrack_stack.take_last();
+            if (entry.kind == BacktrackEntry::Kind::Restore) {
+                m_registers[entry.index] = entry.value;
+                continue;
+            }
+            pc = entry.index;
+            position = entry.value;
+            break;
+        }
+    }
+}
+
+bool Matcher::run_lookahead(size_t pc, size_t position)
+{
+    auto& instruction = m_program.instructions[pc];
+    size_t base = m_backtrack_stack.size();
+    size_t lookahead_position = position;
+    bool matched = run(base, pc + 1, lookahead_position);
+
+    if (instruction.arg0) {
+        // The captures of a negative lookahead never survive it.
+        while (m_backtrack_stack.size() > base) {
+            auto entry = m_backtrack_stack.take_last();
+            if (entry.kind == BacktrackEntry::Kind::Restore)
+                m_registers[entry.index] = entry.value;
+        }
+        return !matched;
+    }
+    if (!matched)
+        return false;
+
+    // Lookaheads are atomic: nothing backtracks into them, but their captures are still
+    // undone when backtracking past them.
+    size_t kept = base;
+    for (size_t i = base; i < m_backtrack_stack.size(); ++i) {
+        if (m_backtrack_stack[i].kind == BacktrackEntry::Kind::Restore)
+            m_backtrack_stack[kept++] = m_backtrack_stack[i];
+    }
+    m_backtrack_stack.shrink(kept);
+    return true;
+}
+
+// Follows the instructions that don't consume anything from the pc, and adds a thread for
+// each consuming one (or Match) that it gets to, in order of priority.
+void Matcher::add_thread(ThreadList& list, u32 pc, size_t position, const size_t* registers)
+{
+    auto& instructions = m_program.instructions;
+    size_t register_count = m_program.register_count;
+    m_closure_registers.clear_with_capacity();
+    m_closure_registers.append(registers, register_count);
+    m_closure_stack.clear_with_capacity();
+    m_closure_stack.append({ BacktrackEntry::Kind::Resume, pc, 0 });
+
+    while (!m_closure_stack.is_empty()) {
+        auto entry = m_closure_stack.take_last();
+        if (entry.kind == BacktrackEntry::Kind::Restore) {
+            m_closure_registers[entry.index] = entry.value;
+            continue;
+        }
+
+        pc = entry.index;
+        for (;;) {
+            if (m_visited[pc] == m_generation)
+                break;
+            m_visited[pc] = m_generation;
+
+            auto& instruction = instructions[pc];
+            if (instruction.op == OpCode::Jump) {
+                pc = instruction.arg0;
+                continue;
+            }
+            if (instruction.op == OpCode::Split) {
+                // Whatever the preferred branch saves is restored before the other one runs.
+                m_closure_stack.append({ BacktrackEntry::Kind::Resume, instruction.arg1, 0 });
+                pc = instruction.arg0;
+                continue;
+            }
+            if (instruction.op == OpCode::Save || instruction.op == OpCode::SetMark) {
+                m_closure_stack.append({ BacktrackEntry::Kind::Restore, instruction.arg0, m_closure_registers[instruction.arg0] });
+                m_closure_registers[instruction.arg0] = position;
+                ++pc;
+                continue;
+            }
+            if (instruction.op == OpCode::CheckProgress) {
+                if (m_closure_registers[instruction.arg0] == position)
+                    break;
+                ++pc;
+                continue;
+            }
+            if (instruction.op == OpCode::BeginningOfLine || instruction.op == OpCode::EndOfLine || instruction.op == OpCode::WordBoundary || instruction.op == OpCode::NotWordBoundary) {
+                if (!check_assertion(instruction.op, position))
+                    break;
+                ++pc;
+                continue;
+            }
+
+            list.program_counters.append(pc);
+            list.registers.append(m_closure_registers.data(), register_count);
+            break;
+        }
+    }
+}
+
+Optional<Vector<size_t>> Matcher::simulate_nfa(size_t start)
+{
+    auto& instructions = m_program.instructions;
+    size_t register_count = m_program.register_count;
+    bool can_start_anywhere = !m_flags.sticky && !m_program.anchored_at_start;
+
+    m_visited.resize(instructions.size());
+    for (auto& generation : m_visited)
+        generation = 0;
+    m_generation = 1;
+
+    Vector<size_t> initial_registers;
+    initial_registers.resize(register_count);
+    for (auto& value : initial_registers)
+        value = unset;
+
+    ThreadList current;
+    ThreadList next;
+    Optional<Vector<size_t>> result;
+    for (size_t position = start;;) {
+        // A thread that starts here has a lower priority than all of those started earlier.
+        if (!result.has_value() && (position == start || can_start_anywhere))
+            add_thread(current, 0, position, initial_registers.data());
+
+        if (current.program_counters.is_empty()) {
+            if (result.has_value() || !can_start_anywhere || position >= m_input.length())
+                break;
+            position = next_position(position);
+            ++m_generation;
+            continue;
+        }
+
+        u32 code_point = 0;
+        size_t length = 0;
+        if (position < m_input.length())
+            length = decode(position, code_point);
+
+        ++m_generation;
+        next.clear();
+        for (size_t i = 0; i < current.program_counters.size(); ++i) {
+            auto& instruction = instructions[current.program_counters[i]];
+            const size_t* registers = &current.registers[i * register_count];
+            if (instruction.op == OpCode::Match) {
+                // This beats every thread after it, but not the ones before it.
+                Vector<size_t> match;
+                match.append(registers, register_count);
+                result = move(match);
+                break;
+            }
+            if (length && matches(instruction, code_point))
+                add_thread(next, current.program_counters[i] + 1, position + length, registers);
+        }
+        swap(current, next);
+        if (position >= m_input.length())
+            break;
+        position += length;
+    }
+    return result;
+}
+
+}
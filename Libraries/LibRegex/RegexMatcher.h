@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/NumericLimits.h>
+#include <AK/Optional.h>
+#include <AK/StringView.h>
+#include <AK/Vector.h>
+#include <LibRegex/RegexProgram.h>
+
+namespace Regex {
+
+// Runs a compiled program over an input. Matching backtracks, which is fast for the usual
+// patterns but can take exponential time on pathological ones; once that uses up its step
+// budget, the search starts over on an NFA simulation (a Pike VM) that takes linear time.
+class Matcher {
+public:
+    static constexpr size_t unset = NumericLimits<size_t>::max();
+
+    Matcher(const Program&, StringView input, const MatchFlags&);
+
+    // Finds the first match at or after the start, and returns its registers.
+    Optional<Vector<size_t>> search(size_t start);
+
+private:
+    struct BacktrackEntry {
+        enum class Kind {
+            Resume,
+            Restore,
+        };
+        Kind kind;
+        // The program counter to resume at, or the register to restore.
+        u32 index;
+        size_t value;
+    };
+
+    struct ThreadList {
+        Vector<u32> program_counters;
+        // register_count registers per thread.
+        Vector<size_t> registers;
+
+        void clear()
+        {
+            program_counters.clear_with_capacity();
+            registers.clear_with_capacity();
+        }
+    };
+
+    bool backtrack(size_t start);
+    bool run(size_t base, size_t pc, size_t& position);
+    bool run_lookahead(size_t pc, size_t position);
+
+    Optional<Vector<size_t>> simulate_nfa(size_t start);
+    void add_thread(ThreadList&, u32 pc, size_t position, const size_t* registers);
+
+    Optional<size_t> find_literal_prefix(size_t start) const;
+
+    size_t decode(size_t position, u32& code_point) const { return decode_code_point(m_input, position, code_point); }
+    size_t next_position(size_t position) const;
+    bool matches(const Instruction&, u32 code_point) const;
+    bool check_assertion(OpCode, size_t position) const;
+    bool is_line_terminator(u32 code_point) const;
+    bool follows_line_terminator(size_t position) const;
+    bool is_word_character(size_t position) const;
+    bool matches_back_reference(size_t group, const size_t* registers, size_t& position) const;
+
+    const Program& m_program;
+    StringView m_input;
+    MatchFlags m_flags;
+
+    Vector<size_t> m_registers;
+    Vector<BacktrackEntry> m_backtrack_stack;
+    size_t m_steps { 0 };
+    size_t m_step_budget { 0 };
+    bool m_budget_exceeded { false };
+
+    Vector<u32> m_visited;
+    u32 m_generation { 0 };
+    Vector<BacktrackEntry> m_closure_stack;
+    Vector<size_t> m_closure_registers;
+};
+
+}
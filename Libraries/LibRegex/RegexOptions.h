@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/Types.h>
+
+namespace Regex {
+
+enum class Syntax {
+    ECMAScript,
+    POSIXBasic,
+    POSIXExtended,
+};
+
+struct Options {
+    bool case_insensitive { false };
+    // ^ and $ also match next to line terminators.
+    bool multiline { false };
+    // . also matches line terminators.
+    bool dot_all { false };
+};
+
+struct MatchFlags {
+    // Only look for a match at the start position.
+    bool sticky { false };
+    // The start (end) of the input isn't the start (end) of a line, for ^ ($).
+    bool not_beginning_of_line { false };
+    bool not_end_of_line { false };
+};
+
+enum class Error {
+    None,
+    InvalidPattern,
+    InvalidCharacterClass,
+    TrailingBackslash,
+    InvalidBackReference,
+    UnmatchedBracket,
+    UnmatchedParenthesis,
+    UnmatchedBrace,
+    InvalidRepetitionCount,
+    InvalidRange,
+    PatternTooLarge,
+    NothingToRepeat,
+    InvalidGroupName,
+    UnsupportedFeature,
+};
+
+const char* error_string(Error);
+
+}
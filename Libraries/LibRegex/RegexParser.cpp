@@ -0,0 +1,923 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <AK/QuickSort.h>
+#include <LibRegex/RegexParser.h>
+#include <ctype.h>
+
+namespace Regex {
+
+void CharacterClass::add_range(u32 from, u32 to)
+{
+    for (u32 code_point = from; code_point <= to && code_point < 128; ++code_point)
+        m_ascii[code_point / 32] |= 1u << (code_point % 32);
+    if (to < 128)
+        return;
+
+    m_ranges.append({ max(from, 128u), min(to, max_code_point) });
+    quick_sort(m_ranges, [](auto& a, auto& b) { return a.from < b.from; });
+
+    Vector<Range> merged;
+    for (auto& range : m_ranges) {
+        if (!merged.is_empty() && range.from <= merged.last().to + 1)
+            merged.last().to = max(merged.last().to, range.to);
+        else
+            merged.append(range);
+    }
+    m_ranges = move(merged);
+}
+
+void CharacterClass::add(const CharacterClass& other)
+{
+    for (size_t i = 0; i < 4; ++i)
+        m_ascii[i] |= other.m_ascii[i];
+    for (auto& range : other.m_ranges)
+        add_range(range.from, range.to);
+}
+
+void CharacterClass::add_case_variants()
+{
+    for (u32 code_point = 'a'; code_point <= 'z'; ++code_point) {
+        u32 upper = code_point - 'a' + 'A';
+        if (contains(code_point) || contains(upper)) {
+            add(code_point);
+            add(upper);
+        }
+    }
+}
+
+void CharacterClass::invert()
+{
+    for (size_t i = 0; i < 4; ++i)
+        m_ascii[i] = ~m_ascii[i];
+
+    Vector<Range> inverted;
+    u32 next_from = 128;
+    for (auto& range : m_ranges) {
+        if (range.from > next_from)
+            inverted.append({ next_from, range.from - 1 });
+        next_from = range.to + 1;
+    }
+    if (next_from <= max_code_point)
+        inverted.append({ next_from, max_code_point });
+    m_ranges = move(inverted);
+}
+
+CharacterClass CharacterClass::digits()
+{
+    CharacterClass digits;
+    digits.add_range('0', '9');
+    return digits;
+}
+
+CharacterClass CharacterClass::word_characters()
+{
+    CharacterClass word_characters;
+    word_characters.add_range('a', 'z');
+    word_characters.add_range('A', 'Z');
+    word_characters.add_range('0', '9');
+    word_characters.add('_');
+    return word_characters;
+}
+
+CharacterClass CharacterClass::whitespace()
+{
+    // WhiteSpace and LineTerminator in ECMAScript.
+    CharacterClass whitespace;
+    whitespace.add_range('\t', '\r');
+    whitespace.add(' ');
+    whitespace.add(0xa0);
+    whitespace.add(0x1680);
+    whitespace.add_range(0x2000, 0x200a);
+    whitespace.add_range(0x2028, 0x2029);
+    whitespace.add(0x202f);
+    whitespace.add(0x205f);
+    whitespace.add(0x3000);
+    whitespace.add(0xfeff);
+    return whitespace;
+}
+
+bool Node::can_match_empty() const
+{
+    switch (type) {
+    case Type::Empty:
+    case Type::Assertion:
+    case Type::BackReference:
+    case Type::Lookahead:
+        return true;
+    case Type::Character:
+    case Type::AnyCharacter:
+    case Type::Class:
+        return false;
+    case Type::Sequence:
+        for (auto& child : children) {
+            if (!child.can_match_empty())
+                return false;
+        }
+        return true;
+    case Type::Alternation:
+        for (auto& child : children) {
+            if (child.can_match_empty())
+                return true;
+        }
+        return false;
+    case Type::Repetition:
+        return min == 0 || children.first().can_match_empty();
+    case Type::Group:
+        return children.first().can_match_empty();
+    }
+    ASSERT_NOT_REACHED();
+}
+
+Parser::Parser(StringView pattern, Syntax syntax, const Options& options)
+    : m_pattern(pattern)
+    , m_syntax(syntax)
+    , m_options(options)
+{
+}
+
+bool Parser::next_is(const char* string) const
+{
+    for (size_t i = 0; string[i]; ++i) {
+        if (peek(i) != string[i])
+            return false;
+    }
+    return true;
+}
+
+bool Parser::try_consume(const char* string)
+{
+    if (!next_is(string))
+        return false;
+    m_offset += strlen(string);
+    return true;
+}
+
+u32 Parser::consume_code_point()
+{
+    u32 code_point;
+    m_offset += decode_code_point(m_pattern, m_offset, code_point);
+    return code_point;
+}
+
+bool Parser::set_error(Error error)
+{
+    if (m_error == Error::None) {
+        m_error = error;
+        m_error_offset = m_offset;
+    }
+    return false;
+}
+
+OwnPtr<Node> Parser::make_class(CharacterClass character_class)
+{
+    auto node = make<Node>(Node::Type::Class);
+    node->character_class = move(character_class);
+    return node;
+}
+
+OwnPtr<Node> Parser::make_character(u32 code_point)
+{
+    auto node = make<Node>(Node::Type::Character);
+    node->code_point = code_point;
+    return node;
+}
+
+OwnPtr<Node> Parser::make_assertion(AssertionType assertion)
+{
+    auto node = make<Node>(Node::Type::Assertion);
+    node->assertion = assertion;
+    return node;
+}
+
+OwnPtr<Node> Parser::parse()
+{
+    count_groups();
+
+    auto node = parse_alternation();
+    if (!node)
+        return nullptr;
+    if (!done()) {
+        set_error(Error::UnmatchedParenthesis);
+        return nullptr;
+    }
+    if (m_has_named_back_references && !resolve_named_back_references(*node))
+        return nullptr;
+    return node;
+}
+
+void Parser::count_groups()
+{
+    // ECMAScript allows back references to groups that come later, and \N is only one if
+    // there are at least N groups.
+    if (!is_ecmascript())
+        return;
+    bool in_class = false;
+    for (size_t i = 0; i < m_pattern.length(); ++i) {
+        char c = m_pattern[i];
+        if (c == '\\') {
+            ++i;
+        } else if (in_class) {
+            in_class = c != ']';
+        } else if (c == '[') {
+            in_class = true;
+        } else if (c == '(') {
+            if (i + 1 < m_pattern.length() && m_pattern[i + 1] == '?') {
+                bool is_named = i + 3 < m_pattern.length() && m_pattern[i + 2] == '<' && m_pattern[i + 3] != '=' && m_pattern[i + 3] != '!';
+                if (!is_named)
+                    continue;
+                m_has_named_groups = true;
+            }
+            ++m_total_group_count;
+        }
+    }
+}
+
+bool Parser::at_end_of_alternative() const
+{
+    if (done())
+        return true;
+    if (is_basic())
+        return next_is("\\)") || next_is("\\|");
+    return peek() == ')' || peek() == '|';
+}
+
+OwnPtr<Node> Parser::parse_alternation()
+{
+    auto first = parse_sequence();
+    if (!first)
+        return nullptr;
+
+    const char* separator = is_basic() ? "\\|" : "|";
+    if (!next_is(separator))
+        return first;
+
+    auto alternation = make<Node>(Node::Type::Alternation);
+    alternation->children.append(first.release_nonnull());
+    while (try_consume(separator)) {
+        auto alternative = parse_sequence();
+        if (!alternative)
+            return nullptr;
+        alternation->children.append(alternative.release_nonnull());
+    }
+    return alternation;
+}
+
+OwnPtr<Node> Parser::parse_sequence()
+{
+    auto sequence = make<Node>(Node::Type::Sequence);
+    while (!at_end_of_alternative()) {
+        auto& children = sequence->children;
+        auto atom = parse_atom(children.is_empty());
+        if (!atom)
+            return nullptr;
+
+        // In basic syntax, a * right after a leading ^ is a literal *.
+        if (is_basic() && atom->type == Node::Type::Assertion && atom->assertion == AssertionType::BeginningOfLine) {
+            children.append(atom.release_nonnull());
+            continue;
+        }
+
+        size_t min;
+        size_t max;
+        bool greedy;
+        while (parse_quantifier(min, max, greedy)) {
+            if (atom->type == Node::Type::Assertion || (is_ecmascript() && atom->type == Node::Type::Repetition)) {
+                set_error(Error::NothingToRepeat);
+                return nullptr;
+            }
+            auto repetition = make<Node>(Node::Type::Repetition);
+            repetition->min = min;
+            repetition->max = max;
+            repetition->greedy = greedy;
+            repetition->children.append(atom.release_nonnull());
+            atom = move(repetition);
+        }
+        if (m_error != Error::None)
+            return nullptr;
+        children.append(atom.release_nonnull());
+    }
+
+    if (sequence->children.size() == 1)
+        return sequence->children.take_last();
+    if (sequence->children.is_empty())
+        return make<Node>(Node::Type::Empty);
+    return sequence;
+}
+
+Optional<size_t> Parser::parse_decimal()
+{
+    if (!isdigit(peek()))
+        return {};
+    size_t value = 0;
+    while (isdigit(peek())) {
+        // Saturate rather than overflow; counts this large get rejected later anyway.
+        value = min(value * 10 + (peek() - '0'), (size_t)1000000000);
+        ++m_offset;
+    }
+    return value;
+}
+
+Optional<u32> Parser::parse_hex(size_t digits)
+{
+    u32 value = 0;
+    for (size_t i = 0; i < digits; ++i) {
+        char c = peek(i);
+        if (!isxdigit(c))
+            return {};
+        value = value * 16 + (isdigit(c) ? c - '0' : tolower(c) - 'a' + 10);
+    }
+    m_offset += digits;
+    return value;
+}
+
+bool Parser::parse_repetition_bounds(size_t& min, size_t& max)
+{
+    // At the first digit, after the opening brace.
+    auto lower = parse_decimal();
+    if (!lower.has_value())
+        return is_ecmascript() ? false : set_error(Error::InvalidRepetitionCount);
+    min = max = lower.value();
+    if (try_consume(",")) {
+        auto upper = parse_decimal();
+        max = upper.has_value() ? upper.value() : Node::unbounded;
+    }
+    if (!try_consume(is_basic() ? "\\}" : "}"))
+        return is_ecmascript() ? false : set_error(Error::UnmatchedBrace);
+    if (min > max)
+        return set_error(Error::InvalidRepetitionCount);
+    return true;
+}
+
+bool Parser::parse_quantifier(size_t& min, size_t& max, bool& greedy)
+{
+    greedy = true;
+    if (!is_basic() && try_consume("+")) {
+        min = 1;
+        max = Node::unbounded;
+    } else if (!is_basic() && try_consume("?")) {
+        min = 0;
+        max = 1;
+    } else if (try_consume("*")) {
+        min = 0;
+        max = Node::unbounded;
+    } else if (is_basic() && try_consume("\\{")) {
+        if (!parse_repetition_bounds(min, max))
+            return false;
+    } else if (!is_basic() && peek() == '{') {
+        // A brace that doesn't start a valid quantifier is just a brace, in ECMAScript's web
+        // compatibility syntax as well as in most POSIX implementations.
+        if (!is_ecmascript() && !isdigit(peek(1)))
+            return false;
+        auto start_offset = m_offset++;
+        if (!parse_repetition_bounds(min, max)) {
+            if (m_error == Error::None)
+                m_offset = start_offset;
+            return false;
+        }
+    } else {
+        return false;
+    }
+
+    if (is_ecmascript() && try_consume("?"))
+        greedy = false;
+    return true;
+}
+
+OwnPtr<Node> Parser::parse_atom(bool at_start_of_sequence)
+{
+    if (is_basic()) {
+        if (next_is("\\("))
+            return parse_group();
+        if (next_is("\\{")) {
+            set_error(Error::NothingToRepeat);
+            return nullptr;
+        }
+        if (peek() == '\\')
+            return parse_posix_escape();
+        if (peek() == '[')
+            return parse_bracket_expression();
+        if (try_consume("."))
+            return make<Node>(Node::Type::AnyCharacter);
+        // ^ and $ are only special at the ends of the (sub)expression, and * at its start.
+        if (at_start_of_sequence && peek() == '^') {
+            ++m_offset;
+            return make_assertion(AssertionType::BeginningOfLine);
+        }
+        if (peek() == '$' && (m_offset + 1 == m_pattern.length() || next_is("$\\)") || next_is("$\\|"))) {
+            ++m_offset;
+            return make_assertion(AssertionType::EndOfLine);
+        }
+        return make_character(consume_code_point());
+    }
+
+    switch (peek()) {
+    case '^':
+        ++m_offset;
+        return make_assertion(AssertionType::BeginningOfLine);
+    case '$':
+        ++m_offset;
+        return make_assertion(AssertionType::EndOfLine);
+    case '.':
+        ++m_offset;
+        return make<Node>(Node::Type::AnyCharacter);
+    case '(':
+        return parse_group();
+    case '[':
+        return is_ecmascript() ? parse_class() : parse_bracket_expression();
+    case '\\':
+        return is_ecmascript() ? parse_escape() : parse_posix_escape();
+    case '*':
+    case '+':
+    case '?':
+        set_error(Error::NothingToRepeat);
+        return nullptr;
+    case '{': {
+        size_t min;
+        size_t max;
+        bool greedy;
+        if (parse_quantifier(min, max, greedy) || m_error != Error::None) {
+            set_error(Error::NothingToRepeat);
+            return nullptr;
+        }
+        ++m_offset;
+        return make_character('{');
+    }
+    default:
+        return make_character(consume_code_point());
+    }
+}
+
+OwnPtr<Node> Parser::parse_group()
+{
+    auto group = make<Node>(Node::Type::Group);
+    if (is_basic()) {
+        m_offset += 2;
+    } else {
+        ++m_offset;
+    }
+
+    if (is_ecmascript() && peek() == '?') {
+        if (try_consume("?:")) {
+        } else if (try_consume("?=") || try_consume("?!")) {
+            group->type = Node::Type::Lookahead;
+            group->negated = m_pattern[m_offset - 1] == '!';
+        } else if (next_is("?<=") || next_is("?<!")) {
+            set_error(Error::UnsupportedFeature);
+            return nullptr;
+        } else if (try_consume("?<")) {
+            size_t name_start = m_offset;
+            while (isalnum(peek()) || peek() == '_' || peek() == '$')
+                ++m_offset;
+            auto name = m_pattern.substring_view(name_start, m_offset - name_start);
+            if (name.is_empty() || isdigit(name[0]) || !try_consume(">") || m_group_names.contains_slow(name)) {
+                set_error(Error::InvalidGroupName);
+                return nullptr;
+            }
+            group->group = ++m_group_count;
+            group->group_name = name;
+        } else {
+            set_error(Error::InvalidPattern);
+            return nullptr;
+        }
+    } else {
+        group->group = ++m_group_count;
+    }
+    if (group->group)
+        m_group_names.append(group->group_name);
+
+    auto body = parse_alternation();
+    if (!body)
+        return nullptr;
+    if (!try_consume(is_basic() ? "\\)" : ")")) {
+        set_error(Error::UnmatchedParenthesis);
+        return nullptr;
+    }
+    group->children.append(body.release_nonnull());
+    return group;
+}
+
+u32 Parser::parse_character_escape()
+{
+    // After the backslash, for the escapes that stand for a single code point.
+    char c = peek();
+    switch (c) {
+    case 't':
+        ++m_offset;
+        return '\t';
+    case 'n':
+        ++m_offset;
+        return '\n';
+    case 'v':
+        ++m_offset;
+        return '\v';
+    case 'f':
+        ++m_offset;
+        return '\f';
+    case 'r':
+        ++m_offset;
+        return '\r';
+    case 'c':
+        if (isalpha(peek(1))) {
+            m_offset += 2;
+            return m_pattern[m_offset - 1] % 32;
+        }
+        // Web compatibility: a lone \c stands for the backslash itself.
+        return '\\';
+    case 'x':
+        ++m_offset;
+        if (auto value = parse_hex(2); value.has_value())
+            return value.value();
+        return 'x';
+    case 'u': {
+        ++m_offset;
+        if (peek() == '{') {
+            size_t start_offset = m_offset++;
+            u32 value = 0;
+            size_t digits = 0;
+            while (isxdigit(peek()) && value <= CharacterClass::max_code_point) {
+                value = value * 16 + parse_hex(1).value();
+                ++digits;
+            }
+            if (digits && value <= CharacterClass::max_code_point && try_consume("}"))
+                return value;
+            m_offset = start_offset;
+            return 'u';
+        }
+        auto value = parse_hex(4);
+        if (!value.has_value())
+            return 'u';
+        // Surrogate pairs stand for the code point they encode.
+        if (value.value() >= 0xd800 && value.value() < 0xdc00 && next_is("\\u")) {
+            size_t start_offset = m_offset;
+            m_offset += 2;
+            auto low = parse_hex(4);
+            if (low.has_value() && low.value() >= 0xdc00 && low.value() < 0xe000)
+                return 0x10000 + ((value.value() - 0xd800) << 10) + (low.value() - 0xdc00);
+            m_offset = start_offset;
+        }
+        return value.value();
+    }
+    default:
+        break;
+    }
+
+    // Web compatibility: legacy octal escapes, of which \0 is the only one left in the spec.
+    if (c >= '0' && c <= '7') {
+        u32 value = 0;
+        for (size_t i = 0; i < 3 && peek() >= '0' && peek() <= '7' && value * 8 + (peek() - '0') <= 0377; ++i)
+            value = value * 8 + (m_pattern[m_offset++] - '0');
+        return value;
+    }
+    return consume_code_point();
+}
+
+OwnPtr<Node> Parser::parse_escape()
+{
+    ++m_offset;
+    if (done()) {
+        set_error(Error::TrailingBackslash);
+        return nullptr;
+    }
+
+    char c = peek();
+    switch (c) {
+    case 'b':
+    case 'B':
+        ++m_offset;
+        return make_assertion(c == 'b' ? AssertionType::WordBoundary : AssertionType::NotWordBoundary);
+    case 'd':
+    case 'D':
+    case 'w':
+    case 'W':
+    case 's':
+    case 'S': {
+        --m_offset;
+        CharacterClass character_class;
+        bool is_single_code_point;
+        u32 code_point;
+        parse_class_atom(character_class, is_single_code_point, code_point);
+        return make_class(move(character_class));
+    }
+    case 'k':
+        if (m_has_named_groups && peek(1) == '<') {
+            m_offset += 2;
+            size_t name_start = m_offset;
+            while (!done() && peek() != '>')
+                ++m_offset;
+            if (!try_consume(">")) {
+                set_error(Error::InvalidGroupName);
+                return nullptr;
+            }
+            auto back_reference = make<Node>(Node::Type::BackReference);
+            back_reference->group_name = m_pattern.substring_view(name_start, m_offset - name_start - 1);
+            m_has_named_back_references = true;
+            return back_reference;
+        }
+        break;
+    default:
+        break;
+    }
+
+    if (c >= '1' && c <= '9') {
+        size_t start_offset = m_offset;
+        auto group = parse_decimal().value();
+        if (group <= m_total_group_count) {
+            auto back_reference = make<Node>(Node::Type::BackReference);
+            back_reference->group = group;
+            return back_reference;
+        }
+        m_offset = start_offset;
+    }
+    return make_character(parse_character_escape());
+}
+
+bool Parser::parse_class_atom(CharacterClass& character_class, bool& is_single_code_point, u32& code_point)
+{
+    // Either a single code point, or one of the character class escapes.
+    is_single_code_point = true;
+    if (peek() != '\\') {
+        code_point = consume_code_point();
+        return true;
+    }
+    if (m_offset + 1 == m_pattern.length()) {
+        ++m_offset;
+        return set_error(Error::TrailingBackslash);
+    }
+
+    // This is also used by parse_escape(), after the backslash.
+    char c = peek(1);
+    switch (c) {
+    case 'd':
+    case 'D':
+    case 'w':
+    case 'W':
+    case 's':
+    case 'S': {
+        m_offset += 2;
+        is_single_code_point = false;
+        CharacterClass escape_class;
+        switch (tolower(c)) {
+        case 'd':
+            escape_class = CharacterClass::digits();
+            break;
+        case 'w':
+            escape_class = CharacterClass::word_characters();
+            break;
+        default:
+            escape_class = CharacterClass::whitespace();
+            break;
+        }
+        if (isupper(c))
+            escape_class.invert();
+        character_class.add(escape_class);
+        return true;
+    }
+    case 'b':
+        m_offset += 2;
+        code_point = '\b';
+        return true;
+    case '-':
+        m_offset += 2;
+        code_point = '-';
+        return true;
+    default:
+        ++m_offset;
+        code_point = parse_character_escape();
+        return true;
+    }
+}
+
+OwnPtr<Node> Parser::parse_class()
+{
+    ++m_offset;
+    bool negated = try_consume("^");
+    CharacterClass character_class;
+    while (!try_consume("]")) {
+        if (done()) {
+            set_error(Error::UnmatchedBracket);
+            return nullptr;
+        }
+
+        bool is_single_code_point;
+        u32 from;
+        if (!parse_class_atom(character_class, is_single_code_point, from))
+            return nullptr;
+        if (!is_single_code_point)
+            continue;
+        if (peek() != '-' || peek(1) == ']' || m_offset + 1 >= m_pattern.length()) {
+            character_class.add(from);
+            continue;
+        }
+
+        ++m_offset;
+        bool to_is_single_code_point;
+        u32 to;
+        if (!parse_class_atom(character_class, to_is_single_code_point, to))
+            return nullptr;
+        if (!to_is_single_code_point) {
+            // Web compatibility: something like [a-\d] is a, - and the digits.
+            character_class.add(from);
+            character_class.add('-');
+            continue;
+        }
+        if (from > to) {
+            set_error(Error::InvalidRange);
+            return nullptr;
+        }
+        character_class.add_range(from, to);
+    }
+
+    if (m_options.case_insensitive)
+        character_class.add_case_variants();
+    if (negated)
+        character_class.invert();
+    return make_class(move(character_class));
+}
+
+bool Parser::parse_posix_class_name(CharacterClass& character_class)
+{
+    size_t name_start = m_offset;
+    while (!done() && !next_is(":]"))
+        ++m_offset;
+    if (!try_consume(":]"))
+        return set_error(Error::UnmatchedBracket);
+    auto name = m_pattern.substring_view(name_start, m_offset - name_start - 2);
+
+    struct NamedClass {
+        const char* name;
+        int (*contains)(int);
+    };
+    static const NamedClass named_classes[] = {
+        { "alnum", isalnum },
+        { "alpha", isalpha },
+        { "blank", [](int c) -> int { return c == ' ' || c == '\t'; } },
+        { "cntrl", iscntrl },
+        { "digit", isdigit },
+        { "graph", isgraph },
+        { "lower", islower },
+        { "print", isprint },
+        { "punct", ispunct },
+        { "space", isspace },
+        { "upper", isupper },
+        { "xdigit", isxdigit },
+    };
+    for (auto& named_class : named_classes) {
+        if (name != named_class.name)
+            continue;
+        for (u32 c = 0; c < 128; ++c) {
+            if (named_class.contains(c))
+                character_class.add(c);
+        }
+        return true;
+    }
+    m_offset = name_start;
+    return set_error(Error::InvalidCharacterClass);
+}
+
+OwnPtr<Node> Parser::parse_bracket_expression()
+{
+    // POSIX bracket expressions have no escapes, and a ] right at the start is just a ].
+    ++m_offset;
+    bool negated = try_consume("^");
+    CharacterClass character_class;
+    bool first = true;
+
+    auto parse_element = [&](u32& code_point) {
+        if (try_consume("[.") || try_consume("[=")) {
+            char terminator = m_pattern[m_offset - 1];
+            code_point = consume_code_point();
+            if (peek() != terminator || peek(1) != ']')
+                return set_error(Error::UnmatchedBracket);
+            m_offset += 2;
+            return true;
+        }
+        code_point = consume_code_point();
+        return true;
+    };
+
+    while (first || peek() != ']') {
+        first = false;
+        if (done()) {
+            set_error(Error::UnmatchedBracket);
+            return nullptr;
+        }
+        if (try_consume("[:")) {
+            if (!parse_posix_class_name(character_class))
+                return nullptr;
+            continue;
+        }
+
+        u32 from;
+        if (!parse_element(from))
+            return nullptr;
+        if (peek() != '-' || peek(1) == ']' || m_offset + 1 >= m_pattern.length()) {
+            character_class.add(from);
+            continue;
+        }
+
+        ++m_offset;
+        u32 to;
+        if (!parse_element(to))
+            return nullptr;
+        if (from > to) {
+            set_error(Error::InvalidRange);
+            return nullptr;
+        }
+        character_class.add_range(from, to);
+    }
+    ++m_offset;
+
+    if (m_options.case_insensitive)
+        character_class.add_case_variants();
+    if (negated) {
+        // With REG_NEWLINE, a non-matching list doesn't match newlines either.
+        if (m_options.multiline)
+            character_class.add('\n');
+        character_class.invert();
+    }
+    return make_class(move(character_class));
+}
+
+OwnPtr<Node> Parser::parse_posix_escape()
+{
+    ++m_offset;
+    if (done()) {
+        set_error(Error::TrailingBackslash);
+        return nullptr;
+    }
+
+    char c = peek();
+    if (c >= '1' && c <= '9') {
+        ++m_offset;
+        size_t group = c - '0';
+        if (group > m_group_count) {
+            set_error(Error::InvalidBackReference);
+            return nullptr;
+        }
+        auto back_reference = make<Node>(Node::Type::BackReference);
+        back_reference->group = group;
+        return back_reference;
+    }
+
+    // The common GNU extensions.
+    switch (c) {
+    case 'w':
+    case 'W':
+    case 's':
+    case 'S': {
+        --m_offset;
+        CharacterClass character_class;
+        bool is_single_code_point;
+        u32 code_point;
+        parse_class_atom(character_class, is_single_code_point, code_point);
+        return make_class(move(character_class));
+    }
+    case 'b':
+    case 'B':
+        ++m_offset;
+        return make_assertion(c == 'b' ? AssertionType::WordBoundary : AssertionType::NotWordBoundary);
+    default:
+        return make_character(consume_code_point());
+    }
+}
+
+bool Parser::resolve_named_back_references(Node& node)
+{
+    if (node.type == Node::Type::BackReference && !node.group_name.is_null()) {
+        auto index = m_group_names.find_first_index(node.group_name);
+        if (!index.has_value())
+            return set_error(Error::InvalidGroupName);
+        node.group = index.value() + 1;
+    }
+    for (auto& child : node.children) {
+        if (!resolve_named_back_references(child))
+            return false;
+    }
+    return true;
+}
+
+}
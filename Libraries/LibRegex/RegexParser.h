@@ -0,0 +1,221 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/NonnullOwnPtrVector.h>
+#include <AK/NumericLimits.h>
+#include <AK/Optional.h>
+#include <AK/OwnPtr.h>
+#include <AK/String.h>
+#include <AK/StringView.h>
+#include <AK/Vector.h>
+#include <LibRegex/RegexOptions.h>
+
+namespace Regex {
+
+// Reads the UTF-8 encoded code point at the offset, and returns its length. Bytes that
+// aren't valid UTF-8 are taken as code points of their own.
+inline size_t decode_code_point(const StringView& string, size_t offset, u32& code_point)
+{
+    u8 first = string[offset];
+    size_t length = 1;
+    if (first >= 0xf0 && first < 0xf8) {
+        code_point = first & 0x07;
+        length = 4;
+    } else if (first >= 0xe0) {
+        code_point = first & 0x0f;
+        length = 3;
+    } else if (first >= 0xc0) {
+        code_point = first & 0x1f;
+        length = 2;
+    }
+    if (length == 1 || offset + length > string.length()) {
+        code_point = first;
+        return 1;
+    }
+    for (size_t i = 1; i < length; ++i) {
+        u8 byte = string[offset + i];
+        if ((byte & 0xc0) != 0x80) {
+            code_point = first;
+            return 1;
+        }
+        code_point = (code_point << 6) | (byte & 0x3f);
+    }
+    return length;
+}
+
+// A set of code points: a bitmap for ASCII, and sorted ranges for everything above.
+class CharacterClass {
+public:
+    static constexpr u32 max_code_point = 0x10ffff;
+
+    void add(u32 code_point) { add_range(code_point, code_point); }
+    void add_range(u32 from, u32 to);
+    void add(const CharacterClass&);
+    void add_case_variants();
+    void invert();
+
+    bool contains(u32 code_point) const
+    {
+        if (code_point < 128)
+            return m_ascii[code_point / 32] & (1u << (code_point % 32));
+        for (auto& range : m_ranges) {
+            if (code_point < range.from)
+                return false;
+            if (code_point <= range.to)
+                return true;
+        }
+        return false;
+    }
+
+    static CharacterClass digits();
+    static CharacterClass word_characters();
+    static CharacterClass whitespace();
+
+private:
+    struct Range {
+        u32 from;
+        u32 to;
+    };
+
+    u32 m_ascii[4] {};
+    Vector<Range> m_ranges;
+};
+
+enum class AssertionType {
+    BeginningOfLine,
+    EndOfLine,
+    WordBoundary,
+    NotWordBoundary,
+};
+
+struct Node {
+    enum class Type {
+        Empty,
+        Character,
+        AnyCharacter,
+        Class,
+        Sequence,
+        Alternation,
+        Repetition,
+        Group,
+        Assertion,
+        BackReference,
+        Lookahead,
+    };
+
+    static constexpr size_t unbounded = NumericLimits<size_t>::max();
+
+    explicit Node(Type type)
+        : type(type)
+    {
+    }
+
+    bool can_match_empty() const;
+
+    Type type;
+    // Sequence and Alternation have any number of children, Repetition, Group and Lookahead have one.
+    NonnullOwnPtrVector<Node> children;
+
+    u32 code_point { 0 };
+    CharacterClass character_class;
+    AssertionType assertion { AssertionType::BeginningOfLine };
+
+    size_t min { 0 };
+    size_t max { 0 };
+    bool greedy { true };
+
+    // For capturing groups and back references; 0 for non-capturing groups.
+    size_t group { 0 };
+    String group_name;
+    bool negated { false };
+};
+
+class Parser {
+public:
+    Parser(StringView pattern, Syntax, const Options&);
+
+    OwnPtr<Node> parse();
+
+    Error error() const { return m_error; }
+    size_t error_offset() const { return m_error_offset; }
+
+    size_t group_count() const { return m_group_count; }
+    // The names of the capturing groups by their index minus one, null for unnamed groups.
+    const Vector<String>& group_names() const { return m_group_names; }
+
+private:
+    bool done() const { return m_offset >= m_pattern.length(); }
+    char peek(size_t ahead = 0) const { return m_offset + ahead < m_pattern.length() ? m_pattern[m_offset + ahead] : 0; }
+    bool next_is(const char*) const;
+    bool try_consume(const char*);
+    u32 consume_code_point();
+    bool set_error(Error);
+
+    bool is_basic() const { return m_syntax == Syntax::POSIXBasic; }
+    bool is_ecmascript() const { return m_syntax == Syntax::ECMAScript; }
+
+    void count_groups();
+    bool at_end_of_alternative() const;
+
+    OwnPtr<Node> parse_alternation();
+    OwnPtr<Node> parse_sequence();
+    OwnPtr<Node> parse_atom(bool at_start_of_sequence);
+    OwnPtr<Node> parse_group();
+    OwnPtr<Node> parse_escape();
+    OwnPtr<Node> parse_posix_escape();
+    OwnPtr<Node> parse_class();
+    OwnPtr<Node> parse_bracket_expression();
+    bool parse_quantifier(size_t& min, size_t& max, bool& greedy);
+    bool parse_repetition_bounds(size_t& min, size_t& max);
+    bool parse_class_atom(CharacterClass&, bool& is_single_code_point, u32& code_point);
+    u32 parse_character_escape();
+    bool parse_posix_class_name(CharacterClass&);
+    Optional<size_t> parse_decimal();
+    Optional<u32> parse_hex(size_t digits);
+    bool resolve_named_back_references(Node&);
+
+    OwnPtr<Node> make_class(CharacterClass);
+    OwnPtr<Node> make_character(u32 code_point);
+    OwnPtr<Node> make_assertion(AssertionType);
+
+    StringView m_pattern;
+    Syntax m_syntax;
+    Options m_options;
+    size_t m_offset { 0 };
+
+    Error m_error { Error::None };
+    size_t m_error_offset { 0 };
+
+    size_t m_group_count { 0 };
+    size_t m_total_group_count { 0 };
+    Vector<String> m_group_names;
+    bool m_has_named_groups { false };
+    bool m_has_named_back_references { false };
+};
+
+}
@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/String.h>
+#include <AK/Vector.h>
+#include <LibRegex/RegexOptions.h>
+#include <LibRegex/RegexParser.h>
+
+namespace Regex {
+
+enum class OpCode : u8 {
+    // Matches the code point in arg0.
+    Char,
+    // Matches a code point in the class at index arg0.
+    Class,
+    AnyCharacter,
+    // Continues at arg0, and at arg1 if that fails.
+    Split,
+    Jump,
+    // Stores the current position into register arg0.
+    Save,
+    // Like Save, for the start position of an iteration of a loop whose body can match empty.
+    SetMark,
+    // Fails if the position hasn't moved on since the SetMark of register arg0.
+    CheckProgress,
+    BeginningOfLine,
+    EndOfLine,
+    WordBoundary,
+    NotWordBoundary,
+    // Matches what group arg0 matched.
+    BackReference,
+    // Runs the program from the next instruction up to a LookaheadMatch, then continues at
+    // arg1 if it matched (if it didn't when arg0 is set) and fails otherwise.
+    Lookahead,
+    LookaheadMatch,
+    Match,
+};
+
+struct Instruction {
+    OpCode op;
+    u32 arg0 { 0 };
+    u32 arg1 { 0 };
+};
+
+struct Program {
+    Vector<Instruction> instructions;
+    Vector<CharacterClass> classes;
+
+    Syntax syntax { Syntax::ECMAScript };
+    Options options;
+
+    // Registers 2n and 2n+1 are the start and end of group n, followed by the loop marks.
+    size_t group_count { 0 };
+    size_t register_count { 0 };
+
+    // What every match starts with, so the search can skip ahead with memchr().
+    String literal_prefix;
+    bool anchored_at_start { false };
+    // Back references and lookaheads need backtracking; anything else can also run on the
+    // NFA simulation, which takes linear time.
+    bool can_use_nfa { true };
+};
+
+Error compile(const Node&, size_t group_count, Syntax, const Options&, Program&);
+
+}
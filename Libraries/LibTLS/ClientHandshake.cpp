@@ -24,6 +24,7 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <AK/HashMap.h>
 #include <AK/Random.h>
 #include <LibCore/Timer.h>
 #include <LibCrypto/ASN1/DER.h>
@@ -85,6 +86,10 @@ ssize_t TLSv12::handle_hello(const ByteBuffer& buffer, WritePacketStage& write_p
         return (i8)Error::NeedMoreData;
     }
 
+    // The server resumes the session we offered by echoing its ID back.
+    bool session_was_resumed = m_context.session_id_size && session_length == m_context.session_id_size
+        && !memcmp(m_context.session_id, buffer.offset_pointer(res), session_length);
+
     if (session_length && session_length <= 32) {
         memcpy(m_context.session_id, buffer.offset_pointer(res), session_length);
         m_context.session_id_size = session_length;
@@ -135,6 +140,11 @@ ssize_t TLSv12::handle_hello(const ByteBuffer& buffer, WritePacketStage& write_p
         }
     }
 
+    if (session_was_resumed && !try_resume_cached_session()) {
+        dbg() << "Server resumed a session we don't have";
+        return (i8)Error::UnexpectedMessage;
+    }
+
     if (res > 2) {
         res += 2;
     }
@@ -236,7 +246,14 @@ ssize_t TLSv12::handle_finished(const ByteBuffer& buffer, WritePacketStage& writ
 #ifdef TLS_DEBUG
     dbg() << "FIXME: handle_finished :: Check message validity";
 #endif
+    if (m_context.is_resuming_session) {
+        // The server spoke first, we still have to send our own change cipher spec and finished.
+        write_packets = WritePacketStage::Finished;
+        return handle_message(buffer);
+    }
+
     m_context.connection_status = ConnectionStatus::Established;
+    cache_session();
 
     if (m_handshake_timeout_timer) {
         // Disable the handshake timeout timer as handshake has been established.
@@ -251,6 +268,66 @@ ssize_t TLSv12::handle_finished(const ByteBuffer& buffer, WritePacketStage& writ
     return handle_message(buffer);
 }
 
+struct CachedSession {
+    u8 session_id[32];
+    u8 session_id_size { 0 };
+    CipherSuite cipher;
+    ByteBuffer master_key;
+};
+
+// Sessions of completed full handshakes, shared by all connections of the process.
+static HashMap<String, CachedSession>& session_cache()
+{
+    static HashMap<String, CachedSession>* cache;
+    if (!cache)
+        cache = new HashMap<String, CachedSession>;
+    return *cache;
+}
+
+void TLSv12::offer_cached_session()
+{
+    if (m_context.is_server || m_session_cache_key.is_null())
+        return;
+    auto it = session_cache().find(m_session_cache_key);
+    if (it == session_cache().end())
+        return;
+    memcpy(m_context.session_id, it->value.session_id, it->value.session_id_size);
+    m_context.session_id_size = it->value.session_id_size;
+}
+
+bool TLSv12::try_resume_cached_session()
+{
+    auto it = session_cache().find(m_session_cache_key);
+    if (it == session_cache().end() || it->value.cipher != m_context.cipher)
+        return false;
+
+#ifdef TLS_DEBUG
+    dbg() << "Resuming session for " << m_session_cache_key;
+#endif
+    m_context.master_key = ByteBuffer::copy(it->value.master_key.data(), it->value.master_key.size());
+    if (!expand_key())
+        return false;
+    m_context.is_resuming_session = true;
+    m_context.connection_status = ConnectionStatus::KeyExchange;
+    return true;
+}
+
+void TLSv12::cache_session()
+{
+    if (m_session_cache_key.is_null())
+        return;
+    if (!m_context.session_id_size || m_context.master_key.is_empty()) {
+        session_cache().remove(m_session_cache_key);
+        return;
+    }
+    CachedSession session;
+    memcpy(session.session_id, m_context.session_id, m_context.session_id_size);
+    session.session_id_size = m_context.session_id_size;
+    session.cipher = m_context.cipher;
+    session.master_key = ByteBuffer::copy(m_context.master_key.data(), m_context.master_key.size());
+    session_cache().set(m_session_cache_key, move(session));
+}
+
 void TLSv12::build_random(PacketBuilder& builder)
 {
     u8 random_bytes[48];
@@ -639,6 +716,7 @@ ssize_t TLSv12::handle_payload(const ByteBuffer& vbuffer)
                 auto packet = build_change_cipher_spec();
                 write_packet(packet);
             }
+            m_context.local_sequence_number = 0;
             {
 #ifdef TLS_DEBUG
                 dbg() << "> client finished";
@@ -647,6 +725,13 @@ ssize_t TLSv12::handle_payload(const ByteBuffer& vbuffer)
                 write_packet(packet);
             }
             m_context.connection_status = ConnectionStatus::Established;
+            if (m_handshake_timeout_timer) {
+                m_handshake_timeout_timer->stop();
+                m_handshake_timeout_timer->remove_from_parent();
+                m_handshake_timeout_timer = nullptr;
+            }
+            if (on_tls_ready_to_write)
+                on_tls_ready_to_write(*this);
             break;
         }
         payload_size++;
@@ -42,7 +42,8 @@ bool TLSv12::expand_key()
     }
 
     auto key_size = key_length();
-    auto mac_size = mac_length();
+    // AEAD ciphers authenticate the records themselves, so there are no MAC keys.
+    auto mac_size = is_aead() ? 0 : mac_length();
     auto iv_size = iv_length();
 
     pseudorandom_function(
@@ -85,8 +86,13 @@ bool TLSv12::expand_key()
     memcpy(m_context.crypto.local_iv, client_iv, iv_size);
     memcpy(m_context.crypto.remote_iv, server_iv, iv_size);
 
-    m_aes_local = make<Crypto::Cipher::AESCipher::CBCMode>(ByteBuffer::wrap(client_key, key_size), key_size * 8, Crypto::Cipher::Intent::Encryption, Crypto::Cipher::PaddingMode::RFC5246);
-    m_aes_remote = make<Crypto::Cipher::AESCipher::CBCMode>(ByteBuffer::wrap(server_key, key_size), key_size * 8, Crypto::Cipher::Intent::Decryption, Crypto::Cipher::PaddingMode::RFC5246);
+    if (is_aead()) {
+        m_aes_gcm_local = make<Crypto::Cipher::AESCipher::GCMMode>(ByteBuffer::wrap(client_key, key_size), key_size * 8, Crypto::Cipher::Intent::Encryption);
+        m_aes_gcm_remote = make<Crypto::Cipher::AESCipher::GCMMode>(ByteBuffer::wrap(server_key, key_size), key_size * 8, Crypto::Cipher::Intent::Decryption);
+    } else {
+        m_aes_local = make<Crypto::Cipher::AESCipher::CBCMode>(ByteBuffer::wrap(client_key, key_size), key_size * 8, Crypto::Cipher::Intent::Encryption, Crypto::Cipher::PaddingMode::RFC5246);
+        m_aes_remote = make<Crypto::Cipher::AESCipher::CBCMode>(ByteBuffer::wrap(server_key, key_size), key_size * 8, Crypto::Cipher::Intent::Decryption, Crypto::Cipher::PaddingMode::RFC5246);
+    }
 
     m_context.crypto.created = 1;
 
@@ -65,7 +65,9 @@ void TLSv12::update_packet(ByteBuffer& packet)
                 update_hash(packet.slice_view(header_size, packet.size() - header_size));
             }
         }
-        if (m_context.cipher_spec_set && m_context.crypto.created) {
+        if (m_context.cipher_spec_set && m_context.crypto.created && is_aead()) {
+            encrypt_aead_packet(packet);
+        } else if (m_context.cipher_spec_set && m_context.crypto.created) {
             size_t length = packet.size() - header_size + mac_length();
             auto block_size = m_aes_local->cipher().block_size();
             // If the length is already a multiple a block_size,
@@ -130,6 +132,87 @@ void TLSv12::update_packet(ByteBuffer& packet)
     ++m_context.local_sequence_number;
 }
 
+// RFC 5288: An AEAD record carries the explicit part of the nonce, followed by the ciphertext
+// and the tag. The sequence number makes for an explicit nonce that never repeats under a key.
+void TLSv12::encrypt_aead_packet(ByteBuffer& packet)
+{
+    constexpr size_t header_size = 5;
+    constexpr size_t explicit_nonce_size = 8;
+    // The salt that the key exchange gives us, which makes up the rest of the nonce.
+    constexpr size_t gcm_implicit_nonce_size = 4;
+    constexpr size_t tag_size = Crypto::Cipher::AESCipher::GCMMode::TagSize;
+    size_t length = packet.size() - header_size;
+
+    u64 sequence_number = convert_between_host_and_network(m_context.local_sequence_number);
+
+    ASSERT(iv_length() == gcm_implicit_nonce_size);
+    u8 nonce[gcm_implicit_nonce_size + explicit_nonce_size];
+    memcpy(nonce, m_context.crypto.local_iv, gcm_implicit_nonce_size);
+    memcpy(nonce + gcm_implicit_nonce_size, &sequence_number, explicit_nonce_size);
+
+    // The sequence number and the header of the plaintext record are authenticated as well.
+    u8 additional_data[sizeof(sequence_number) + header_size];
+    memcpy(additional_data, &sequence_number, sizeof(sequence_number));
+    memcpy(additional_data + sizeof(sequence_number), packet.data(), header_size);
+
+    auto ct = ByteBuffer::create_uninitialized(header_size + explicit_nonce_size + length + tag_size);
+    ct.overwrite(0, packet.data(), header_size - 2);
+    *(u16*)ct.offset_pointer(header_size - 2) = convert_between_host_and_network((u16)(ct.size() - header_size));
+    ct.overwrite(header_size, &sequence_number, explicit_nonce_size);
+
+    // The plaintext is encrypted and authenticated straight into the record.
+    auto ciphertext = ct.span().slice(header_size + explicit_nonce_size, length);
+    auto tag = ct.span().slice(header_size + explicit_nonce_size + length, tag_size);
+    m_aes_gcm_local->encrypt(packet.span().slice(header_size, length), ciphertext, { nonce, sizeof(nonce) }, { additional_data, sizeof(additional_data) }, tag);
+
+    packet = ct;
+}
+
+ssize_t TLSv12::decrypt_aead_message(const ByteBuffer& buffer, size_t length, ByteBuffer& plain)
+{
+    constexpr size_t header_size = 5;
+    constexpr size_t explicit_nonce_size = 8;
+    constexpr size_t gcm_implicit_nonce_size = 4;
+    constexpr size_t tag_size = Crypto::Cipher::AESCipher::GCMMode::TagSize;
+
+    if (length < explicit_nonce_size + tag_size) {
+        dbg() << "broken packet";
+        auto packet = build_alert(true, (u8)AlertDescription::DecryptError);
+        write_packet(packet);
+        return (i8)Error::BrokenPacket;
+    }
+    size_t plain_length = length - explicit_nonce_size - tag_size;
+
+    ASSERT(iv_length() == gcm_implicit_nonce_size);
+    u8 nonce[gcm_implicit_nonce_size + explicit_nonce_size];
+    memcpy(nonce, m_context.crypto.remote_iv, gcm_implicit_nonce_size);
+    memcpy(nonce + gcm_implicit_nonce_size, buffer.offset_pointer(header_size), explicit_nonce_size);
+
+    u64 sequence_number = convert_between_host_and_network(m_context.remote_sequence_number);
+    u8 additional_data[sizeof(sequence_number) + header_size];
+    memcpy(additional_data, &sequence_number, sizeof(sequence_number));
+    memcpy(additional_data + sizeof(sequence_number), buffer.data(), header_size - 2);
+    *(u16*)(additional_data + sizeof(sequence_number) + header_size - 2) = convert_between_host_and_network((u16)plain_length);
+
+    auto decrypted = ByteBuffer::create_uninitialized(plain_length);
+    auto ciphertext = buffer.span().slice(header_size + explicit_nonce_size, plain_length);
+    auto tag = buffer.span().slice(header_size + explicit_nonce_size + plain_length, tag_size);
+    auto consistency = m_aes_gcm_remote->decrypt(ciphertext, decrypted.span(), { nonce, sizeof(nonce) }, { additional_data, sizeof(additional_data) }, tag);
+    if (consistency != Crypto::PK::VerificationConsistency::Consistent) {
+        dbg() << "integrity check failed (length " << plain_length << ")";
+        auto packet = build_alert(true, (u8)AlertDescription::BadRecordMAC);
+        write_packet(packet);
+        return (i8)Error::IntegrityCheckFailed;
+    }
+
+#ifdef TLS_DEBUG
+    dbg() << "Decrypted: ";
+    print_buffer(decrypted);
+#endif
+    plain = decrypted;
+    return plain_length;
+}
+
 void TLSv12::update_hash(const ByteBuffer& message)
 {
     m_context.handshake_hash.update(message);
@@ -203,7 +286,12 @@ ssize_t TLSv12::handle_message(const ByteBuffer& buffer)
 #endif
     ByteBuffer plain = buffer.slice_view(buffer_position, buffer.size() - buffer_position);
 
-    if (m_context.cipher_spec_set && type != MessageType::ChangeCipher) {
+    if (m_context.cipher_spec_set && type != MessageType::ChangeCipher && is_aead()) {
+        auto result = decrypt_aead_message(buffer, length, plain);
+        if (result < 0)
+            return result;
+        length = result;
+    } else if (m_context.cipher_spec_set && type != MessageType::ChangeCipher) {
 #ifdef TLS_DEBUG
         dbg() << "Encrypted: ";
         print_buffer(buffer.slice_view(header_size, length));
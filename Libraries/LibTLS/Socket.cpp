@@ -95,6 +95,8 @@ bool TLSv12::write(const ByteBuffer& buffer)
 bool TLSv12::connect(const String& hostname, int port)
 {
     set_sni(hostname);
+    m_session_cache_key = String::format("%s:%d", hostname.characters(), port);
+    offer_cached_session();
     return Core::Socket::connect(hostname, port);
 }
 
@@ -159,6 +161,10 @@ bool TLSv12::common_connect(const struct sockaddr* saddr, socklen_t length)
 
 void TLSv12::read_from_socket()
 {
+    // Whoever reads from us will call back in when it wants more.
+    if (is_reading_paused())
+        return;
+
     if (m_context.application_buffer.size() > 0) {
         deferred_invoke([&](auto&) { read_from_socket(); });
         if (on_tls_ready_to_read)
@@ -62,15 +62,14 @@ enum class CipherSuite {
     AES_256_GCM_SHA384 = 0x1302,
     AES_128_CCM_SHA256 = 0x1304,
     AES_128_CCM_8_SHA256 = 0x1305,
+    RSA_WITH_AES_256_GCM_SHA384 = 0x009D,
 
     // We support these
     RSA_WITH_AES_128_CBC_SHA = 0x002F,
     RSA_WITH_AES_256_CBC_SHA = 0x0035,
     RSA_WITH_AES_128_CBC_SHA256 = 0x003C,
     RSA_WITH_AES_256_CBC_SHA256 = 0x003D,
-    // TODO
     RSA_WITH_AES_128_GCM_SHA256 = 0x009C,
-    RSA_WITH_AES_256_GCM_SHA384 = 0x009D,
 };
 
 #define ENUMERATE_ALERT_DESCRIPTIONS                        \
@@ -297,6 +296,9 @@ struct Context {
     size_t send_retries { 0 };
 
     time_t handshake_initiation_timestamp { 0 };
+
+    // Set when the server accepted the session we offered, so the key exchange is skipped.
+    bool is_resuming_session { false };
 };
 
 class TLSv12 : public Core::Socket {
@@ -334,7 +336,7 @@ public:
 
     bool supports_cipher(CipherSuite suite) const
     {
-        return suite == CipherSuite::RSA_WITH_AES_128_CBC_SHA256 || suite == CipherSuite::RSA_WITH_AES_256_CBC_SHA256 || suite == CipherSuite::RSA_WITH_AES_128_CBC_SHA || suite == CipherSuite::RSA_WITH_AES_256_CBC_SHA;
+        return suite == CipherSuite::RSA_WITH_AES_128_GCM_SHA256 || suite == CipherSuite::RSA_WITH_AES_128_CBC_SHA256 || suite == CipherSuite::RSA_WITH_AES_256_CBC_SHA256 || suite == CipherSuite::RSA_WITH_AES_128_CBC_SHA || suite == CipherSuite::RSA_WITH_AES_256_CBC_SHA;
     }
 
     bool supports_version(Version v) const
@@ -370,6 +372,8 @@ private:
     void ensure_hmac(size_t digest_size, bool local);
 
     void update_packet(ByteBuffer& packet);
+    void encrypt_aead_packet(ByteBuffer& packet);
+    ssize_t decrypt_aead_message(const ByteBuffer& buffer, size_t length, ByteBuffer& plain);
     void update_hash(const ByteBuffer& in);
 
     void write_packet(ByteBuffer& packet);
@@ -461,7 +465,23 @@ private:
         case CipherSuite::AES_256_GCM_SHA384:
         case CipherSuite::RSA_WITH_AES_128_GCM_SHA256:
         case CipherSuite::RSA_WITH_AES_256_GCM_SHA384:
-            return 12;
+            // This is only the implicit part of the nonce, the other 8 bytes are sent with every record.
+            return 4;
+        }
+    }
+
+    bool is_aead() const
+    {
+        switch (m_context.cipher) {
+        case CipherSuite::AES_128_GCM_SHA256:
+        case CipherSuite::AES_256_GCM_SHA384:
+        case CipherSuite::AES_128_CCM_SHA256:
+        case CipherSuite::AES_128_CCM_8_SHA256:
+        case CipherSuite::RSA_WITH_AES_128_GCM_SHA256:
+        case CipherSuite::RSA_WITH_AES_256_GCM_SHA384:
+            return true;
+        default:
+            return false;
         }
     }
 
@@ -469,6 +489,10 @@ private:
 
     bool compute_master_secret(size_t length);
 
+    void offer_cached_session();
+    bool try_resume_cached_session();
+    void cache_session();
+
     void try_disambiguate_error() const;
 
     Context m_context;
@@ -479,10 +503,16 @@ private:
     OwnPtr<Crypto::Cipher::AESCipher::CBCMode> m_aes_local;
     OwnPtr<Crypto::Cipher::AESCipher::CBCMode> m_aes_remote;
 
+    OwnPtr<Crypto::Cipher::AESCipher::GCMMode> m_aes_gcm_local;
+    OwnPtr<Crypto::Cipher::AESCipher::GCMMode> m_aes_gcm_remote;
+
     bool m_has_scheduled_write_flush { false };
     i32 m_max_wait_time_for_handshake_in_seconds { 10 };
 
     RefPtr<Core::Timer> m_handshake_timeout_timer;
+
+    // "host:port" that sessions of this connection are cached under, empty if they aren't.
+    String m_session_cache_key;
 };
 
 namespace Constants {
@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/MergeSort.h>
+#include <AK/NonnullRefPtrVector.h>
+#include <AK/Vector.h>
+#include <LibThread/Thread.h>
+#include <unistd.h>
+
+namespace LibThread {
+
+// Sorts big vectors on all CPUs: each thread merge_sort()s one slice, and then neighbouring slices
+// are merged pairwise (again in parallel) until a single run is left. Like merge_sort(), this is stable.
+// Vectors too small to be worth starting threads for are just merge_sort()ed on the calling thread.
+template<typename T, typename LessThan>
+void parallel_sort(Vector<T>& vector, LessThan less_than)
+{
+    static constexpr size_t min_elements_per_thread = 4096;
+
+    size_t size = vector.size();
+    long cpu_count = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t thread_count = min(cpu_count > 1 ? (size_t)cpu_count : 1, size / min_elements_per_thread);
+    if (thread_count < 2) {
+        merge_sort(vector, move(less_than));
+        return;
+    }
+
+    auto run_in_parallel = [](size_t task_count, auto task) {
+        NonnullRefPtrVector<Thread> threads;
+        for (size_t i = 1; i < task_count; ++i) {
+            threads.append(Thread::construct([&task, i] {
+                task(i);
+                return 0;
+            },
+                "Sort"));
+            threads.last().start();
+        }
+        task(0);
+        for (auto& thread : threads)
+            thread.join();
+    };
+
+    Vector<size_t> bounds;
+    for (size_t i = 0; i <= thread_count; ++i)
+        bounds.append(size * i / thread_count);
+
+    run_in_parallel(thread_count, [&](size_t i) {
+        merge_sort(vector, bounds[i], bounds[i + 1], less_than);
+    });
+
+    while (bounds.size() > 2) {
+        size_t run_count = bounds.size() - 1;
+        run_in_parallel(run_count / 2, [&](size_t i) {
+            auto thread_less_than = less_than;
+            Vector<T> buffer;
+            buffer.ensure_capacity(bounds[2 * i + 1] - bounds[2 * i]);
+            AK::Detail::merge_adjacent(vector, bounds[2 * i], bounds[2 * i + 1], bounds[2 * i + 2], buffer, thread_less_than);
+        });
+
+        Vector<size_t> merged_bounds;
+        for (size_t i = 0; i < bounds.size(); i += 2)
+            merged_bounds.append(bounds[i]);
+        if (run_count % 2)
+            merged_bounds.append(bounds.last());
+        bounds = move(merged_bounds);
+    }
+}
+
+}
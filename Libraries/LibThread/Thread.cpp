@@ -50,6 +50,9 @@ void LibThread::Thread::start()
         nullptr,
         [](void* arg) -> void* {
             Thread* self = static_cast<Thread*>(arg);
+            // The thread may well be done (and have cleared m_tid) before pthread_create() returns,
+            // so record the tid to join from here as well.
+            self->m_joinable_tid = pthread_self();
             size_t exit_code = self->m_action();
             self->m_tid = 0;            
             return (void*)exit_code;
@@ -57,6 +60,8 @@ void LibThread::Thread::start()
         static_cast<void*>(this));
 
     ASSERT(rc == 0);
+    if (m_tid)
+        m_joinable_tid = m_tid;
     if (!m_thread_name.is_empty()) {
         rc = pthread_setname_np(m_tid, m_thread_name.characters());
         ASSERT(rc == 0);
@@ -71,3 +76,13 @@ void LibThread::Thread::quit(void *code)
     m_tid = 0;
     pthread_exit(code);
 }
+
+int LibThread::Thread::join()
+{
+    ASSERT(m_joinable_tid);
+    void* exit_code = nullptr;
+    int rc = pthread_join(m_joinable_tid, &exit_code);
+    ASSERT(rc == 0);
+    m_joinable_tid = 0;
+    return (int)(uintptr_t)exit_code;
+}
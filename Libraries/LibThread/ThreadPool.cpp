@@ -0,0 +1,165 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <LibThread/ThreadPool.h>
+#include <unistd.h>
+
+namespace LibThread {
+
+class CompletionReceiver final : public Core::Object {
+    C_OBJECT(CompletionReceiver)
+};
+
+static ThreadPool* s_the;
+static Core::Object* s_completion_receiver;
+
+// The pool (and worker index) the current thread belongs to, if any.
+static __thread ThreadPool* t_current_pool;
+static __thread size_t t_current_worker_index;
+
+Core::Object& completion_receiver()
+{
+    if (s_completion_receiver == nullptr)
+        s_completion_receiver = &CompletionReceiver::construct().leak_ref();
+    return *s_completion_receiver;
+}
+
+ThreadPool& ThreadPool::the()
+{
+    if (s_the == nullptr) {
+        long cpu_count = sysconf(_SC_NPROCESSORS_ONLN);
+        s_the = new ThreadPool(cpu_count > 1 ? cpu_count : 1);
+    }
+    return *s_the;
+}
+
+ThreadPool::ThreadPool(size_t thread_count)
+{
+    ASSERT(thread_count > 0);
+    for (size_t i = 0; i < thread_count; ++i)
+        m_workers.append(make<Worker>());
+    for (size_t i = 0; i < thread_count; ++i) {
+        m_workers[i].thread = Thread::construct([this, i] {
+            worker_loop(i);
+            return 0;
+        },
+            "ThreadPool");
+        m_workers[i].thread->start();
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    pthread_mutex_lock(&m_mutex);
+    m_exiting = true;
+    pthread_cond_broadcast(&m_work_available);
+    pthread_mutex_unlock(&m_mutex);
+
+    for (auto& worker : m_workers)
+        worker.thread->join();
+}
+
+void ThreadPool::enqueue(Function<void()> task)
+{
+    size_t index;
+    if (t_current_pool == this)
+        index = t_current_worker_index;
+    else
+        index = m_next_worker++ % m_workers.size();
+
+    // Count the task before it's visible, so that whoever takes it never sees the count go below zero.
+    ++m_queued_task_count;
+    {
+        auto& worker = m_workers[index];
+        LOCKER(worker.lock);
+        worker.tasks.enqueue(move(task));
+    }
+
+    pthread_mutex_lock(&m_mutex);
+    pthread_cond_signal(&m_work_available);
+    if (m_waiter_count.load() > 0)
+        pthread_cond_broadcast(&m_task_done);
+    pthread_mutex_unlock(&m_mutex);
+}
+
+bool ThreadPool::take_task(size_t preferred_worker, Function<void()>& task)
+{
+    // Start with our own queue, then try to steal from everyone else's.
+    for (size_t i = 0; i < m_workers.size(); ++i) {
+        auto& worker = m_workers[(preferred_worker + i) % m_workers.size()];
+        LOCKER(worker.lock);
+        if (worker.tasks.is_empty())
+            continue;
+        task = worker.tasks.dequeue();
+        --m_queued_task_count;
+        return true;
+    }
+    return false;
+}
+
+void ThreadPool::did_finish_task()
+{
+    if (m_waiter_count.load() == 0)
+        return;
+    pthread_mutex_lock(&m_mutex);
+    pthread_cond_broadcast(&m_task_done);
+    pthread_mutex_unlock(&m_mutex);
+}
+
+bool ThreadPool::run_one_task()
+{
+    Function<void()> task;
+    if (!take_task(t_current_pool == this ? t_current_worker_index : 0, task))
+        return false;
+    task();
+    did_finish_task();
+    return true;
+}
+
+void ThreadPool::worker_loop(size_t index)
+{
+    t_current_pool = this;
+    t_current_worker_index = index;
+
+    for (;;) {
+        Function<void()> task;
+        if (take_task(index, task)) {
+            task();
+            did_finish_task();
+            continue;
+        }
+
+        pthread_mutex_lock(&m_mutex);
+        while (m_queued_task_count.load() == 0 && !m_exiting)
+            pthread_cond_wait(&m_work_available, &m_mutex);
+        bool should_exit = m_exiting && m_queued_task_count.load() == 0;
+        pthread_mutex_unlock(&m_mutex);
+        if (should_exit)
+            return;
+    }
+}
+
+}
@@ -0,0 +1,251 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/Atomic.h>
+#include <AK/Function.h>
+#include <AK/NonnullOwnPtrVector.h>
+#include <AK/NonnullRefPtr.h>
+#include <AK/Optional.h>
+#include <AK/Queue.h>
+#include <AK/RefCounted.h>
+#include <AK/RefPtr.h>
+#include <LibCore/Event.h>
+#include <LibCore/EventLoop.h>
+#include <LibCore/Object.h>
+#include <LibThread/Lock.h>
+#include <LibThread/Thread.h>
+#include <pthread.h>
+
+namespace LibThread {
+
+class ThreadPool;
+
+// The object completion callbacks are posted to on the main thread's event loop.
+Core::Object& completion_receiver();
+
+template<typename Result>
+class Future final : public RefCounted<Future<Result>> {
+    friend class ThreadPool;
+
+public:
+    bool is_ready() const { return m_ready.load(AK::memory_order_acquire); }
+
+    // Blocks until the result is available. While waiting, the calling thread
+    // helps out by running other tasks queued on the pool, so it's safe to do
+    // this from inside a pool task as well.
+    Result& await();
+
+    // Calls the callback from the main thread's event loop once the result is
+    // available (right away, if it already is). Must be called on the main thread.
+    void on_complete(Function<void(Result&)>);
+
+private:
+    explicit Future(ThreadPool& pool)
+        : m_pool(pool)
+    {
+    }
+
+    void resolve(Result&&);
+    void post_completion(Function<void(Result&)>);
+
+    ThreadPool& m_pool;
+    Lock m_lock;
+    Atomic<bool> m_ready { false };
+    Optional<Result> m_result;
+    Function<void(Result&)> m_on_complete;
+};
+
+// A fixed set of worker threads, each with its own task queue. Tasks queued from a worker
+// go onto that worker's own queue, others are spread over the queues in turn. Workers that
+// run out of tasks steal from the other queues before going to sleep.
+class ThreadPool {
+    AK_MAKE_NONCOPYABLE(ThreadPool);
+    AK_MAKE_NONMOVABLE(ThreadPool);
+
+public:
+    // A pool with one thread per CPU, started on first use and never torn down.
+    static ThreadPool& the();
+
+    explicit ThreadPool(size_t thread_count);
+    ~ThreadPool();
+
+    size_t thread_count() const { return m_workers.size(); }
+
+    void enqueue(Function<void()>);
+
+    template<typename Result>
+    NonnullRefPtr<Future<Result>> submit(Function<Result()> task)
+    {
+        auto future = adopt(*new Future<Result>(*this));
+        auto* future_ptr = future.ptr();
+        enqueue([future_ptr, protector = future, task = move(task)] {
+            future_ptr->resolve(task());
+        });
+        return future;
+    }
+
+    // Calls callback(i) for every i in [begin, end), in chunks of grain_size indices that are
+    // handed out to the pool's threads (and the calling thread) as they become free. Returns
+    // once all of them are done.
+    template<typename Callback>
+    void parallel_for(size_t begin, size_t end, size_t grain_size, Callback callback);
+
+    // Runs a single queued task on the calling thread, if there is one.
+    bool run_one_task();
+
+    // Runs queued tasks (or sleeps) until condition() holds.
+    template<typename Condition>
+    void run_tasks_until(Condition condition);
+
+private:
+    struct Worker {
+        Lock lock;
+        Queue<Function<void()>> tasks;
+        RefPtr<Thread> thread;
+    };
+
+    void worker_loop(size_t index);
+    bool take_task(size_t preferred_worker, Function<void()>&);
+    void did_finish_task();
+
+    NonnullOwnPtrVector<Worker> m_workers;
+    pthread_mutex_t m_mutex = PTHREAD_MUTEX_INITIALIZER;
+    pthread_cond_t m_work_available = PTHREAD_COND_INITIALIZER;
+    pthread_cond_t m_task_done = PTHREAD_COND_INITIALIZER;
+    Atomic<size_t> m_queued_task_count { 0 };
+    Atomic<size_t> m_waiter_count { 0 };
+    Atomic<size_t> m_next_worker { 0 };
+    bool m_exiting { false };
+};
+
+template<typename Condition>
+void ThreadPool::run_tasks_until(Condition condition)
+{
+    while (!condition()) {
+        if (run_one_task())
+            continue;
+
+        ++m_waiter_count;
+        pthread_mutex_lock(&m_mutex);
+        while (!condition() && m_queued_task_count.load() == 0)
+            pthread_cond_wait(&m_task_done, &m_mutex);
+        pthread_mutex_unlock(&m_mutex);
+        --m_waiter_count;
+    }
+}
+
+template<typename Callback>
+void ThreadPool::parallel_for(size_t begin, size_t end, size_t grain_size, Callback callback)
+{
+    if (begin >= end)
+        return;
+    if (grain_size == 0)
+        grain_size = 1;
+
+    size_t chunk_count = (end - begin + grain_size - 1) / grain_size;
+    Atomic<size_t> next_chunk { 0 };
+    auto run_chunks = [&] {
+        for (;;) {
+            size_t chunk = next_chunk++;
+            if (chunk >= chunk_count)
+                return;
+            size_t chunk_begin = begin + chunk * grain_size;
+            size_t chunk_end = min(chunk_begin + grain_size, end);
+            for (size_t i = chunk_begin; i < chunk_end; ++i)
+                callback(i);
+        }
+    };
+
+    // The helpers refer to this stack frame, so wait for all of them to have exited,
+    // not just for the last chunk to be done.
+    size_t helper_count = min(thread_count(), chunk_count - 1);
+    Atomic<size_t> finished_helpers { 0 };
+    for (size_t i = 0; i < helper_count; ++i) {
+        enqueue([&] {
+            run_chunks();
+            finished_helpers++;
+        });
+    }
+    run_chunks();
+    run_tasks_until([&] { return finished_helpers.load() == helper_count; });
+}
+
+template<typename Result>
+Result& Future<Result>::await()
+{
+    m_pool.run_tasks_until([this] { return is_ready(); });
+    return m_result.value();
+}
+
+template<typename Result>
+void Future<Result>::resolve(Result&& result)
+{
+    Function<void(Result&)> on_complete;
+    {
+        LOCKER(m_lock);
+        m_result = move(result);
+        m_ready.store(true);
+        on_complete = move(m_on_complete);
+    }
+    if (on_complete)
+        post_completion(move(on_complete));
+}
+
+template<typename Result>
+void Future<Result>::on_complete(Function<void(Result&)> callback)
+{
+    // Make sure the receiver for the completion event gets created here, on the main thread.
+    completion_receiver();
+    {
+        LOCKER(m_lock);
+        if (!is_ready()) {
+            m_on_complete = move(callback);
+            return;
+        }
+    }
+    post_completion(move(callback));
+}
+
+template<typename Result>
+void Future<Result>::post_completion(Function<void(Result&)> callback)
+{
+    auto* self = this;
+    NonnullRefPtr<Future> protector(*this);
+    Core::EventLoop::main().post_event(completion_receiver(), make<Core::DeferredInvocationEvent>([self, protector, callback = move(callback)](auto&) {
+        callback(self->m_result.value());
+    }));
+    Core::EventLoop::wake();
+}
+
+template<typename Callback>
+void parallel_for(size_t begin, size_t end, size_t grain_size, Callback callback)
+{
+    ThreadPool::the().parallel_for(begin, end, grain_size, move(callback));
+}
+
+}
@@ -0,0 +1,242 @@
+/*
+ * Copyright (c) 2018-2020, The SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <LibCore/DirIterator.h>
+#include <LibThread/ThreadPool.h>
+#include <LibThread/TreeWalk.h>
+#include <errno.h>
+#include <fcntl.h>
+
+namespace LibThread {
+
+struct TreeWalk::Child {
+    Entry entry;
+    // If the entry couldn't be stat'ed.
+    int error { 0 };
+    // The listing of the entry, if it's a directory we're going into.
+    Node* node { nullptr };
+};
+
+// A directory, which is listed by a task on the pool. It belongs to whoever reports its
+// entries once it's ready.
+struct TreeWalk::Node {
+    String path;
+    int depth { 0 };
+    int error { 0 };
+    Vector<Child> children;
+    Atomic<bool> ready { false };
+};
+
+static unsigned char type_from_mode(mode_t mode)
+{
+    // The DT_* values are the file type bits of the mode, shifted down.
+    return (mode & S_IFMT) >> 12;
+}
+
+TreeWalk::TreeWalk(const StringView& root)
+    : m_root(root)
+{
+}
+
+TreeWalk::~TreeWalk()
+{
+}
+
+void TreeWalk::schedule(Node& node)
+{
+    if (m_queued_directories.load() >= m_max_queued_directories) {
+        list_directory(node);
+        return;
+    }
+    ++m_queued_directories;
+    ++m_pending_tasks;
+    ThreadPool::the().enqueue([this, &node] {
+        --m_queued_directories;
+        list_directory(node);
+        --m_pending_tasks;
+    });
+}
+
+void TreeWalk::list_directory(Node& node)
+{
+    Core::DirIterator iterator(node.path, Core::DirIterator::SkipParentAndBaseDir);
+    if (iterator.has_error())
+        node.error = iterator.error();
+
+    while (!m_cancelled.load() && iterator.has_next()) {
+        Child child;
+        auto type = iterator.next_type();
+        auto name = iterator.next_path();
+        if (node.path.ends_with("/"))
+            child.entry.path = String::format("%s%s", node.path.characters(), name.characters());
+        else
+            child.entry.path = String::format("%s/%s", node.path.characters(), name.characters());
+        child.entry.depth = node.depth + 1;
+        child.entry.type = type;
+
+        if (m_stat_entries || type == DT_UNKNOWN || (type == DT_LNK && m_follow_symlinks)) {
+            if (fstatat(iterator.fd(), name.characters(), &child.entry.stat, m_follow_symlinks ? 0 : AT_SYMLINK_NOFOLLOW) < 0) {
+                child.error = errno;
+            } else {
+                child.entry.has_stat = true;
+                child.entry.type = type_from_mode(child.entry.stat.st_mode);
+            }
+        }
+
+        if (child.entry.type == DT_DIR && should_list(child.entry.depth)) {
+            child.node = new Node;
+            child.node->path = child.entry.path;
+            child.node->depth = child.entry.depth;
+            schedule(*child.node);
+        }
+        node.children.append(move(child));
+    }
+
+    if (!node.error && iterator.has_error())
+        node.error = iterator.error();
+    finish(node);
+}
+
+void TreeWalk::finish(Node& node)
+{
+    if (m_ordered_output) {
+        node.ready.store(true, AK::memory_order_release);
+        return;
+    }
+    LOCKER(m_completed_lock);
+    m_completed.append(&node);
+    ++m_completed_count;
+}
+
+bool TreeWalk::run()
+{
+    Entry root_entry;
+    root_entry.path = m_root;
+    int rc = m_follow_symlinks ? stat(m_root.characters(), &root_entry.stat) : lstat(m_root.characters(), &root_entry.stat);
+    if (rc < 0) {
+        if (on_error)
+            on_error(m_root, errno);
+        return true;
+    }
+    root_entry.has_stat = true;
+    root_entry.type = type_from_mode(root_entry.stat.st_mode);
+
+    Node* root_node = nullptr;
+    if (root_entry.type == DT_DIR && should_list(0)) {
+        root_node = new Node;
+        root_node->path = m_root;
+        schedule(*root_node);
+    }
+
+    bool completed = m_ordered_output ? emit_ordered(root_entry, root_node) : emit_unordered(root_entry, root_node);
+
+    // Whatever is still being listed refers to us, so wait for it even if we're stopping early.
+    if (!completed)
+        m_cancelled = true;
+    ThreadPool::the().run_tasks_until([this] { return m_pending_tasks.load() == 0; });
+
+    if (m_ordered_output) {
+        delete_tree(root_node);
+    } else {
+        for (auto* node : m_completed)
+            delete node;
+        m_completed.clear();
+    }
+    return completed;
+}
+
+bool TreeWalk::emit_ordered(const Entry& entry, Node* node)
+{
+    if (on_entry && on_entry(entry) == IterationDecision::Break)
+        return false;
+    if (!node)
+        return true;
+
+    ThreadPool::the().run_tasks_until([node] { return node->ready.load(AK::memory_order_acquire); });
+    if (node->error && on_error)
+        on_error(node->path, node->error);
+
+    for (auto& child : node->children) {
+        if (child.error && on_error)
+            on_error(child.entry.path, child.error);
+        if (!emit_ordered(child.entry, child.node))
+            return false;
+        delete child.node;
+        child.node = nullptr;
+    }
+    return true;
+}
+
+bool TreeWalk::emit_unordered(const Entry& root_entry, Node* root_node)
+{
+    if (on_entry && on_entry(root_entry) == IterationDecision::Break)
+        return false;
+
+    // Every directory that's being listed ends up on m_completed exactly once.
+    size_t unreported_count = root_node ? 1 : 0;
+    while (unreported_count) {
+        ThreadPool::the().run_tasks_until([this] { return m_completed_count.load() > 0; });
+        Vector<Node*> completed;
+        {
+            LOCKER(m_completed_lock);
+            completed = move(m_completed);
+            m_completed_count = 0;
+        }
+
+        for (size_t i = 0; i < completed.size(); ++i) {
+            auto* node = completed[i];
+            --unreported_count;
+            if (node->error && on_error)
+                on_error(node->path, node->error);
+            for (auto& child : node->children) {
+                if (child.node)
+                    ++unreported_count;
+                if (child.error && on_error)
+                    on_error(child.entry.path, child.error);
+                if (on_entry && on_entry(child.entry) == IterationDecision::Break) {
+                    // Leave the rest for run() to clean up once the pool is done with them.
+                    LOCKER(m_completed_lock);
+                    for (size_t j = i; j < completed.size(); ++j)
+                        m_completed.append(completed[j]);
+                    return false;
+                }
+            }
+            delete node;
+        }
+    }
+    return true;
+}
+
+void TreeWalk::delete_tree(Node* node)
+{
+    if (!node)
+        return;
+    for (auto& child : node->children)
+        delete_tree(child.node);
+    delete node;
+}
+
+}
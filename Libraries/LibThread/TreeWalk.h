@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2018-2020, The SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/Atomic.h>
+#include <AK/Function.h>
+#include <AK/IterationDecision.h>
+#include <AK/Noncopyable.h>
+#include <AK/String.h>
+#include <AK/Vector.h>
+#include <LibThread/Lock.h>
+#include <dirent.h>
+#include <sys/stat.h>
+
+namespace LibThread {
+
+// Walks a directory tree, like nftw(). Directories are listed (and what's in them stat'ed,
+// where needed) on the thread pool, but the callbacks are always called on the thread that
+// calls run().
+class TreeWalk {
+    AK_MAKE_NONCOPYABLE(TreeWalk);
+    AK_MAKE_NONMOVABLE(TreeWalk);
+
+public:
+    struct Entry {
+        String path;
+        // 0 for the root, 1 for what's directly inside it, and so on.
+        int depth { 0 };
+        // A DT_* value. DT_UNKNOWN only if the type wasn't recorded and stat() failed.
+        unsigned char type { DT_UNKNOWN };
+        bool has_stat { false };
+        struct stat stat {};
+    };
+
+    explicit TreeWalk(const StringView& root);
+    ~TreeWalk();
+
+    // Look at what symlinks point to, rather than at the links themselves.
+    void set_follow_symlinks(bool follow_symlinks) { m_follow_symlinks = follow_symlinks; }
+    // Stat every entry, not only the ones whose type isn't recorded in the directory.
+    void set_stat_entries(bool stat_entries) { m_stat_entries = stat_entries; }
+    // Report entries in the order a single-threaded depth-first walk would (the default),
+    // or one directory at a time, in whichever order they're listed.
+    void set_ordered_output(bool ordered_output) { m_ordered_output = ordered_output; }
+    // Don't list directories deeper than this. -1 (the default) means no limit.
+    void set_max_depth(int max_depth) { m_max_depth = max_depth; }
+    // How many directories may wait on the pool's queues at once. Past that, the threads
+    // list the subdirectories they come across themselves, depth first.
+    void set_max_queued_directories(size_t max_queued_directories) { m_max_queued_directories = max_queued_directories; }
+
+    Function<IterationDecision(const Entry&)> on_entry;
+    Function<void(const String& path, int error)> on_error;
+
+    // Returns false if on_entry stopped the walk early.
+    bool run();
+
+private:
+    struct Node;
+    struct Child;
+
+    bool should_list(int depth) const { return m_max_depth < 0 || depth < m_max_depth; }
+    void schedule(Node&);
+    void list_directory(Node&);
+    void finish(Node&);
+    bool emit_ordered(const Entry&, Node*);
+    bool emit_unordered(const Entry&, Node*);
+    static void delete_tree(Node*);
+
+    String m_root;
+    bool m_follow_symlinks { false };
+    bool m_stat_entries { false };
+    bool m_ordered_output { true };
+    int m_max_depth { -1 };
+    size_t m_max_queued_directories { 64 };
+
+    Atomic<bool> m_cancelled { false };
+    Atomic<size_t> m_queued_directories { 0 };
+    Atomic<size_t> m_pending_tasks { 0 };
+
+    // Listed directories, for unordered output.
+    Lock m_completed_lock;
+    Vector<Node*> m_completed;
+    Atomic<size_t> m_completed_count { 0 };
+};
+
+}
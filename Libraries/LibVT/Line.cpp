@@ -24,6 +24,7 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <AK/Optional.h>
 #include <LibVT/Line.h>
 #include <string.h>
 
@@ -31,6 +32,7 @@ namespace VT {
 
 Line::Line(u16 length)
 {
+    m_attribute_runs.append({ 0, {} });
     set_length(length);
 }
 
@@ -40,7 +42,6 @@ Line::~Line()
         delete[] m_code_points.as_u32;
     else
         delete[] m_code_points.as_u8;
-    delete[] m_attributes;
 }
 
 template<typename CodepointType>
@@ -68,50 +69,100 @@ void Line::set_length(u16 new_length)
     else
         m_code_points.as_u8 = create_new_code_point_array<u8>(new_length, m_code_points.as_u8, m_length);
 
-    auto* new_attributes = new Attribute[new_length];
-    if (m_attributes) {
-        for (size_t i = 0; i < min(m_length, new_length); ++i)
-            new_attributes[i] = m_attributes[i];
-    }
-    delete[] m_attributes;
-    m_attributes = new_attributes;
+    auto old_length = m_length;
     m_length = new_length;
+    if (new_length < old_length) {
+        while (m_attribute_runs.size() > 1 && m_attribute_runs.last().start_column >= new_length)
+            m_attribute_runs.take_last();
+    } else {
+        set_attributes(old_length, new_length, {});
+    }
+    m_dirty_start_column = min(m_dirty_start_column, new_length);
+    m_dirty_end_column = min(m_dirty_end_column, new_length);
 }
 
 void Line::clear(Attribute attribute)
 {
-    if (m_dirty) {
-        for (u16 i = 0; i < m_length; ++i) {
+    if (m_dirty_start_column == 0 && m_dirty_end_column == m_length) {
+        for (u16 i = 0; i < m_length; ++i)
             set_code_point(i, ' ');
-            m_attributes[i] = attribute;
-        }
+        m_attribute_runs.clear_with_capacity();
+        m_attribute_runs.append({ 0, move(attribute) });
         return;
     }
     for (unsigned i = 0; i < m_length; ++i) {
         if (code_point(i) != ' ')
-            m_dirty = true;
+            set_dirty(true);
         set_code_point(i, ' ');
     }
-    for (unsigned i = 0; i < m_length; ++i) {
-        if (m_attributes[i] != attribute)
-            m_dirty = true;
-        m_attributes[i] = attribute;
+    if (m_attribute_runs.size() != 1 || m_attribute_runs[0].attribute != attribute) {
+        set_dirty(true);
+        m_attribute_runs.clear_with_capacity();
+        m_attribute_runs.append({ 0, move(attribute) });
     }
 }
 
 bool Line::has_only_one_background_color() const
 {
-    if (!m_length)
-        return true;
-    // FIXME: Cache this result?
-    auto color = m_attributes[0].background_color;
-    for (size_t i = 1; i < m_length; ++i) {
-        if (m_attributes[i].background_color != color)
+    auto color = m_attribute_runs[0].attribute.background_color;
+    for (size_t i = 1; i < m_attribute_runs.size(); ++i) {
+        if (m_attribute_runs[i].attribute.background_color != color)
             return false;
     }
     return true;
 }
 
+size_t Line::attribute_run_index(size_t column) const
+{
+    // Text is mostly written left to right, so the last run is the most likely one.
+    if (column >= m_attribute_runs.last().start_column)
+        return m_attribute_runs.size() - 1;
+    size_t low = 0;
+    size_t high = m_attribute_runs.size() - 1;
+    while (low + 1 < high) {
+        size_t middle = (low + high) / 2;
+        if (m_attribute_runs[middle].start_column <= column)
+            low = middle;
+        else
+            high = middle;
+    }
+    return low;
+}
+
+void Line::set_attributes(size_t start_column, size_t end_column, const Attribute& attribute)
+{
+    ASSERT(start_column <= end_column && end_column <= m_length);
+    if (start_column == end_column)
+        return;
+
+    size_t first_run = attribute_run_index(start_column);
+    size_t last_run = attribute_run_index(end_column - 1);
+    if (first_run == last_run && m_attribute_runs[first_run].attribute == attribute)
+        return;
+
+    // Replace the runs from first_run through last_run with the part of first_run before start_column,
+    // the new run, and the part of last_run after end_column.
+    size_t last_run_end = attribute_run_end(last_run);
+    Optional<AttributeRun> tail;
+    if (end_column < last_run_end)
+        tail = AttributeRun { (u16)end_column, m_attribute_runs[last_run].attribute };
+
+    size_t insert_index = first_run;
+    if (m_attribute_runs[first_run].start_column < start_column)
+        ++insert_index;
+    for (size_t i = last_run + 1; i > insert_index; --i)
+        m_attribute_runs.remove(insert_index);
+
+    m_attribute_runs.insert(insert_index, { (u16)start_column, attribute });
+    if (tail.has_value())
+        m_attribute_runs.insert(insert_index + 1, tail.release_value());
+
+    if (insert_index + 1 < m_attribute_runs.size() && m_attribute_runs[insert_index + 1].attribute == attribute)
+        m_attribute_runs.remove(insert_index + 1);
+    if (insert_index > 0 && m_attribute_runs[insert_index - 1].attribute == attribute)
+        m_attribute_runs.remove(insert_index);
+}
+
 void Line::convert_to_utf32()
 {
     ASSERT(!m_utf32);
@@ -119,7 +170,7 @@ void Line::convert_to_utf32()
     for (size_t i = 0; i < m_length; ++i) {
         new_code_points[i] = m_code_points.as_u8[i];
     }
-    delete m_code_points.as_u8;
+    delete[] m_code_points.as_u8;
     m_code_points.as_u32 = new_code_points;
     m_utf32 = true;
 }
@@ -28,6 +28,7 @@
 
 #include <AK/Noncopyable.h>
 #include <AK/String.h>
+#include <AK/Vector.h>
 #include <LibVT/XtermColors.h>
 
 namespace VT {
@@ -68,7 +69,7 @@ struct Attribute {
 
     bool operator==(const Attribute& other) const
     {
-        return foreground_color == other.foreground_color && background_color == other.background_color && flags == other.flags;
+        return foreground_color == other.foreground_color && background_color == other.background_color && flags == other.flags && href_id == other.href_id;
     }
     bool operator!=(const Attribute& other) const
     {
@@ -108,23 +109,54 @@ public:
             m_code_points.as_u8[index] = code_point;
     }
 
-    bool is_dirty() const { return m_dirty; }
-    void set_dirty(bool b) { m_dirty = b; }
+    // Only the columns in [dirty_start_column(), dirty_end_column()) have changed since the line was last flushed.
+    bool is_dirty() const { return m_dirty_start_column < m_dirty_end_column; }
+    void set_dirty(bool b)
+    {
+        m_dirty_start_column = 0;
+        m_dirty_end_column = b ? m_length : 0;
+    }
+    void mark_dirty(u16 start_column, u16 end_column)
+    {
+        if (!is_dirty()) {
+            m_dirty_start_column = start_column;
+            m_dirty_end_column = end_column;
+            return;
+        }
+        m_dirty_start_column = min(m_dirty_start_column, start_column);
+        m_dirty_end_column = max(m_dirty_end_column, end_column);
+    }
+    u16 dirty_start_column() const { return m_dirty_start_column; }
+    u16 dirty_end_column() const { return m_dirty_end_column; }
 
-    const Attribute* attributes() const { return m_attributes; }
-    Attribute* attributes() { return m_attributes; }
+    // Attributes are stored as runs of columns that share the same one, since most lines only have a few.
+    const Attribute& attribute_at(size_t column) const { return m_attribute_runs[attribute_run_index(column)].attribute; }
+    void set_attribute_at(size_t column, const Attribute& attribute) { set_attributes(column, column + 1, attribute); }
+    void set_attributes(size_t start_column, size_t end_column, const Attribute&);
 
     void convert_to_utf32();
 
     bool is_utf32() const { return m_utf32; }
 
 private:
+    struct AttributeRun {
+        u16 start_column;
+        Attribute attribute;
+    };
+
+    size_t attribute_run_index(size_t column) const;
+    size_t attribute_run_end(size_t run_index) const
+    {
+        return run_index + 1 < m_attribute_runs.size() ? m_attribute_runs[run_index + 1].start_column : m_length;
+    }
+
     union {
         u8* as_u8;
         u32* as_u32;
     } m_code_points { nullptr };
-    Attribute* m_attributes { nullptr };
-    bool m_dirty { false };
+    Vector<AttributeRun, 1> m_attribute_runs;
+    u16 m_dirty_start_column { 0 };
+    u16 m_dirty_end_column { 0 };
     bool m_utf32 { false };
     u16 m_length { 0 };
 };
@@ -52,6 +52,7 @@ void Terminal::clear()
 void Terminal::clear_including_history()
 {
     m_history.clear();
+    m_history_start = 0;
     clear();
 
     m_client.terminal_history_changed();
@@ -244,7 +245,7 @@ void Terminal::escape$t(const ParamVector& params)
 {
     if (params.size() < 1)
         return;
-    dbgprintf("FIXME: escape$t: Ps: %u (param count: %d)\n", params[0], params.size());
+    dbgprintf("FIXME: escape$t: Ps: %u (param count: %zu)\n", params[0], params.size());
 }
 
 void Terminal::DECSTBM(const ParamVector& params)
@@ -732,15 +733,21 @@ void Terminal::scroll_up()
 {
     // NOTE: We have to invalidate the cursor first.
     invalidate_cursor();
+    auto line = m_lines.take(m_scroll_region_top);
     if (m_scroll_region_top == 0) {
-        auto line = move(m_lines.ptr_at(m_scroll_region_top));
-        m_history.append(move(line));
-        while (m_history.size() > max_history_size())
-            m_history.take_first();
+        if (m_history.size() < max_history_size()) {
+            m_history.append(move(line));
+            line = make<Line>(m_columns);
+        } else {
+            // Reuse the oldest line in the history for the new line at the bottom.
+            swap(line, m_history.ptr_at(m_history_start));
+            m_history_start = (m_history_start + 1) % m_history.size();
+        }
         m_client.terminal_history_changed();
     }
-    m_lines.remove(m_scroll_region_top);
-    m_lines.insert(m_scroll_region_bottom, make<Line>(m_columns));
+    line->set_length(m_columns);
+    line->clear({});
+    m_lines.insert(m_scroll_region_bottom, move(line));
     m_need_full_flush = true;
 }
 
@@ -774,9 +781,10 @@ void Terminal::put_character_at(unsigned row, unsigned column, u32 code_point)
     ASSERT(column < columns());
     auto& line = m_lines[row];
     line.set_code_point(column, code_point);
-    line.attributes()[column] = m_current_attribute;
-    line.attributes()[column].flags |= Attribute::Touched;
-    line.set_dirty(true);
+    auto attribute = m_current_attribute;
+    attribute.flags |= Attribute::Touched;
+    line.set_attribute_at(column, attribute);
+    line.mark_dirty(column, column + 1);
 
     m_last_code_point = code_point;
 }
@@ -1001,6 +1009,50 @@ void Terminal::on_code_point(u32 code_point)
     }
 }
 
+void Terminal::on_input(ReadonlyBytes bytes)
+{
+    size_t index = 0;
+    while (index < bytes.size()) {
+        if (m_parser_state == Normal) {
+            if (auto count = put_printable_characters(bytes.slice(index, bytes.size() - index))) {
+                index += count;
+                continue;
+            }
+        }
+        on_input(bytes[index++]);
+    }
+}
+
+static inline bool is_printable_ascii(u8 ch)
+{
+    return ch >= 0x20 && ch < 0x7f;
+}
+
+// Puts a run of printable ASCII characters on the cursor line in one go, instead of one on_code_point() each.
+// The character that reaches the last column is left to on_code_point(), which knows how to wrap.
+size_t Terminal::put_printable_characters(ReadonlyBytes bytes)
+{
+    if (m_stomp)
+        return 0;
+    size_t count = 0;
+    size_t max_count = min(bytes.size(), (size_t)(m_columns - 1 - m_cursor_column));
+    while (count < max_count && is_printable_ascii(bytes[count]))
+        ++count;
+    if (!count)
+        return 0;
+
+    auto& line = m_lines[m_cursor_row];
+    for (size_t i = 0; i < count; ++i)
+        line.set_code_point(m_cursor_column + i, bytes[i]);
+    auto attribute = m_current_attribute;
+    attribute.flags |= Attribute::Touched;
+    line.set_attributes(m_cursor_column, m_cursor_column + count, attribute);
+    line.mark_dirty(m_cursor_column, m_cursor_column + count);
+    m_last_code_point = bytes[count - 1];
+    set_cursor(m_cursor_row, m_cursor_column + count);
+    return count;
+}
+
 void Terminal::inject_string(const StringView& str)
 {
     for (size_t i = 0; i < str.length(); ++i)
@@ -1153,7 +1205,7 @@ void Terminal::set_size(u16 columns, u16 rows)
 
 void Terminal::invalidate_cursor()
 {
-    m_lines[m_cursor_row].set_dirty(true);
+    m_lines[m_cursor_row].mark_dirty(m_cursor_column, m_cursor_column + 1);
 }
 
 void Terminal::execute_hashtag(u8 hashtag)
@@ -1181,7 +1233,7 @@ Attribute Terminal::attribute_at(const Position& position) const
     auto& line = this->line(position.row());
     if (position.column() >= line.length())
         return {};
-    return line.attributes()[position.column()];
+    return line.attribute_at(position.column());
 }
 
 }
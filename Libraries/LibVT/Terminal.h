@@ -28,6 +28,7 @@
 
 #include <AK/Noncopyable.h>
 #include <AK/NonnullOwnPtrVector.h>
+#include <AK/Span.h>
 #include <AK/String.h>
 #include <AK/Vector.h>
 #include <Kernel/API/KeyCode.h>
@@ -57,6 +58,7 @@ public:
 
     void invalidate_cursor();
     void on_input(u8);
+    void on_input(ReadonlyBytes);
 
     void clear();
     void clear_including_history();
@@ -76,13 +78,13 @@ public:
     Line& line(size_t index)
     {
         if (index < m_history.size())
-            return m_history[index];
+            return history_line(index);
         return m_lines[index - m_history.size()];
     }
     const Line& line(size_t index) const
     {
         if (index < m_history.size())
-            return m_history[index];
+            return history_line(index);
         return m_lines[index - m_history.size()];
     }
 
@@ -96,7 +98,7 @@ public:
     }
 
     size_t max_history_size() const { return 500; }
-    const NonnullOwnPtrVector<Line>& history() const { return m_history; }
+    size_t history_size() const { return m_history.size(); }
 
     void inject_string(const StringView&);
     void handle_key_press(KeyCode, u32, u8 flags);
@@ -107,6 +109,10 @@ private:
     typedef Vector<unsigned, 4> ParamVector;
 
     void on_code_point(u32);
+    size_t put_printable_characters(ReadonlyBytes);
+
+    Line& history_line(size_t index) { return m_history[(m_history_start + index) % m_history.size()]; }
+    const Line& history_line(size_t index) const { return m_history[(m_history_start + index) % m_history.size()]; }
 
     void scroll_up();
     void scroll_down();
@@ -154,7 +160,9 @@ private:
 
     TerminalClient& m_client;
 
+    // Once full, the history is a ring buffer whose oldest line is at m_history_start.
     NonnullOwnPtrVector<Line> m_history;
+    size_t m_history_start { 0 };
     NonnullOwnPtrVector<Line> m_lines;
 
     size_t m_scroll_region_top { 0 };
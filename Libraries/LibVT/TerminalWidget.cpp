@@ -83,8 +83,7 @@ void TerminalWidget::set_pty_master_fd(int fd)
             set_pty_master_fd(-1);
             return;
         }
-        for (ssize_t i = 0; i < nread; ++i)
-            m_terminal.on_input(buffer[i]);
+        m_terminal.on_input({ buffer, (size_t)nread });
         flush_dirty_lines();
     };
 }
@@ -274,33 +273,38 @@ void TerminalWidget::paint_event(GUI::PaintEvent& event)
     invalidate_cursor();
 
     int rows_from_history = 0;
-    int first_row_from_history = m_terminal.history().size();
+    int first_row_from_history = m_terminal.history_size();
     int row_with_cursor = m_terminal.cursor_row();
     if (m_scrollbar->value() != m_scrollbar->max()) {
         rows_from_history = min((int)m_terminal.rows(), m_scrollbar->max() - m_scrollbar->value());
-        first_row_from_history = m_terminal.history().size() - (m_scrollbar->max() - m_scrollbar->value());
+        first_row_from_history = m_terminal.history_size() - (m_scrollbar->max() - m_scrollbar->value());
         row_with_cursor = m_terminal.cursor_row() + rows_from_history;
     }
 
+    // Most updates only cover the cells that changed, so only paint the columns inside the update rect.
+    int column_width = font().glyph_width('x');
+    int first_column = max(0, (event.rect().left() - frame_thickness() - m_inset) / column_width);
+    int end_column = max(0, (event.rect().right() - frame_thickness() - m_inset) / column_width + 1);
+
     for (u16 visual_row = 0; visual_row < m_terminal.rows(); ++visual_row) {
         auto row_rect = this->row_rect(visual_row);
-        if (!event.rect().contains(row_rect))
+        if (!event.rect().intersects(row_rect))
             continue;
         auto& line = m_terminal.line(first_row_from_history + visual_row);
         bool has_only_one_background_color = line.has_only_one_background_color();
         if (visual_beep_active)
             painter.clear_rect(row_rect, Color::Red);
         else if (has_only_one_background_color)
-            painter.clear_rect(row_rect, color_from_rgb(line.attributes()[0].background_color).with_alpha(m_opacity));
+            painter.clear_rect(row_rect, color_from_rgb(line.attribute_at(0).background_color).with_alpha(m_opacity));
 
-        for (size_t column = 0; column < line.length(); ++column) {
+        for (size_t column = first_column; column < min((size_t)end_column, (size_t)line.length()); ++column) {
             u32 code_point = line.code_point(column);
             bool should_reverse_fill_for_cursor_or_selection = m_cursor_blink_state
                 && m_has_logical_focus
                 && visual_row == row_with_cursor
                 && column == m_terminal.cursor_column();
             should_reverse_fill_for_cursor_or_selection |= selection_contains({ first_row_from_history + visual_row, (int)column });
-            auto attribute = line.attributes()[column];
+            auto& attribute = line.attribute_at(column);
             auto text_color = color_from_rgb(should_reverse_fill_for_cursor_or_selection ? attribute.background_color : attribute.foreground_color);
             auto character_rect = glyph_rect(visual_row, column);
             auto cell_rect = character_rect.inflated(0, m_line_spacing);
@@ -357,7 +361,7 @@ void TerminalWidget::paint_event(GUI::PaintEvent& event)
         auto& cursor_line = m_terminal.line(first_row_from_history + row_with_cursor);
         if (m_terminal.cursor_row() < (m_terminal.rows() - rows_from_history)) {
             auto cell_rect = glyph_rect(row_with_cursor, m_terminal.cursor_column()).inflated(0, m_line_spacing);
-            painter.draw_rect(cell_rect, color_from_rgb(cursor_line.attributes()[m_terminal.cursor_column()].foreground_color));
+            painter.draw_rect(cell_rect, color_from_rgb(cursor_line.attribute_at(m_terminal.cursor_column()).foreground_color));
         }
     }
 }
@@ -396,10 +400,18 @@ void TerminalWidget::flush_dirty_lines()
     }
     Gfx::IntRect rect;
     for (int i = 0; i < m_terminal.rows(); ++i) {
-        if (m_terminal.visible_line(i).is_dirty()) {
+        auto& line = m_terminal.visible_line(i);
+        if (!line.is_dirty())
+            continue;
+        // Emoji can be wider than a cell, so lines that may contain them are repainted in full.
+        if (line.is_utf32()) {
             rect = rect.united(row_rect(i));
-            m_terminal.visible_line(i).set_dirty(false);
+        } else {
+            auto start_rect = glyph_rect(i, line.dirty_start_column()).inflated(0, m_line_spacing);
+            auto end_rect = glyph_rect(i, line.dirty_end_column() - 1).inflated(0, m_line_spacing);
+            rect = rect.united(start_rect.united(end_rect));
         }
+        line.set_dirty(false);
     }
     update(rect);
 }
@@ -709,7 +721,7 @@ String TerminalWidget::selected_text() const
         int last_column = last_selection_column_on_row(row);
         for (int column = first_column; column <= last_column; ++column) {
             auto& line = m_terminal.line(row);
-            if (line.attributes()[column].is_untouched()) {
+            if (line.attribute_at(column).is_untouched()) {
                 builder.append('\n');
                 break;
             }
@@ -742,7 +754,7 @@ int TerminalWidget::last_selection_column_on_row(int row) const
 void TerminalWidget::terminal_history_changed()
 {
     bool was_max = m_scrollbar->value() == m_scrollbar->max();
-    m_scrollbar->set_max(m_terminal.history().size());
+    m_scrollbar->set_max(m_terminal.history_size());
     if (was_max)
         m_scrollbar->set_value(m_scrollbar->max());
     m_scrollbar->update();
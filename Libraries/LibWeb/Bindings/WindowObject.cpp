@@ -89,6 +89,8 @@ void WindowObject::visit_children(Visitor& visitor)
     GlobalObject::visit_children(visitor);
     visitor.visit(m_xhr_constructor);
     visitor.visit(m_xhr_prototype);
+    for (auto& it : m_prototypes)
+        visitor.visit(it.value);
 }
 
 static DOM::Window* impl_from(JS::Interpreter& interpreter, JS::GlobalObject& global_object)
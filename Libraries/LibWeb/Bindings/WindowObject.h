@@ -26,7 +26,9 @@
 
 #pragma once
 
+#include <AK/HashMap.h>
 #include <AK/Weakable.h>
+#include <LibJS/Heap/Heap.h>
 #include <LibJS/Runtime/GlobalObject.h>
 #include <LibWeb/Forward.h>
 
@@ -47,6 +49,18 @@ public:
     XMLHttpRequestPrototype* xhr_prototype() { return m_xhr_prototype; }
     XMLHttpRequestConstructor* xhr_constructor() { return m_xhr_constructor; }
 
+    template<typename T>
+    JS::Object& ensure_web_prototype(const String& class_name)
+    {
+        auto it = m_prototypes.find(class_name);
+        if (it != m_prototypes.end())
+            return *it->value;
+        auto* prototype = heap().allocate<T>(*this, *this);
+        m_prototypes.set(class_name, prototype);
+        write_barrier();
+        return *prototype;
+    }
+
 private:
     virtual const char* class_name() const override { return "WindowObject"; }
     virtual void visit_children(Visitor&) override;
@@ -69,6 +83,8 @@ private:
 
     XMLHttpRequestConstructor* m_xhr_constructor { nullptr };
     XMLHttpRequestPrototype* m_xhr_prototype { nullptr };
+
+    HashMap<String, JS::Object*> m_prototypes;
 };
 
 }
@@ -718,13 +718,14 @@ public:
     }
 
     struct ValueAndImportant {
-        String value;
+        // Points into `buffer`, so it's only good until the next value is consumed.
+        StringView value;
         bool important { false };
     };
 
     ValueAndImportant consume_css_value()
     {
-        buffer.clear();
+        buffer.clear_with_capacity();
 
         int paren_nesting_level = 0;
         bool important = false;
@@ -782,10 +783,9 @@ public:
         while (!buffer.is_empty() && isspace(buffer.last()))
             buffer.take_last();
 
-        auto string = String::copy(buffer);
-        buffer.clear();
-
-        return { string, important };
+        if (buffer.is_empty())
+            return { "", important };
+        return { StringView(buffer.data(), buffer.size()), important };
     }
 
     Optional<CSS::StyleProperty> parse_property()
@@ -797,11 +797,10 @@ public:
         }
         if (peek() == '}')
             return {};
-        buffer.clear();
+        auto name_start = index;
         while (is_valid_property_name_char(peek()))
-            buffer.append(consume_one());
-        auto property_name = String::copy(buffer);
-        buffer.clear();
+            consume_one();
+        auto property_name = css.substring_view(name_start, index - name_start);
         consume_whitespace_or_comments();
         consume_specific(':');
         consume_whitespace_or_comments();
@@ -818,6 +817,7 @@ public:
             dbg() << "CSSParser: Unrecognized property '" << property_name << "'";
         }
         auto value = parse_css_value(m_context, property_value);
+        buffer.clear_with_capacity();
         if (!value)
             return {};
         return CSS::StyleProperty { property_id, value.release_nonnull(), important };
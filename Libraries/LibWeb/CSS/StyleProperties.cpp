@@ -26,6 +26,7 @@
 
 #include <LibCore/DirIterator.h>
 #include <LibWeb/CSS/StyleProperties.h>
+#include <LibWeb/CSS/StyleResolver.h>
 #include <LibWeb/FontCache.h>
 #include <ctype.h>
 
@@ -229,6 +230,31 @@ bool StyleProperties::operator==(const StyleProperties& other) const
     return true;
 }
 
+bool StyleProperties::has_same_inherited_properties(const StyleProperties& other) const
+{
+    size_t inherited_property_count = 0;
+    for (auto& it : m_property_values) {
+        if (!StyleResolver::is_inherited_property((CSS::PropertyID)it.key))
+            continue;
+        ++inherited_property_count;
+        auto jt = other.m_property_values.find(it.key);
+        if (jt == other.m_property_values.end())
+            return false;
+        auto& my_value = *it.value;
+        auto& other_value = *jt->value;
+        if (my_value.type() != other_value.type())
+            return false;
+        if (my_value.to_string() != other_value.to_string())
+            return false;
+    }
+
+    for (auto& it : other.m_property_values) {
+        if (StyleResolver::is_inherited_property((CSS::PropertyID)it.key))
+            --inherited_property_count;
+    }
+    return inherited_property_count == 0;
+}
+
 CSS::TextAlign StyleProperties::text_align() const
 {
     auto string = string_or_fallback(CSS::PropertyID::TextAlign, "left");
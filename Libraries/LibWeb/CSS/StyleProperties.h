@@ -77,6 +77,8 @@ public:
     bool operator==(const StyleProperties&) const;
     bool operator!=(const StyleProperties& other) const { return !(*this == other); }
 
+    bool has_same_inherited_properties(const StyleProperties&) const;
+
     CSS::Position position() const;
     Optional<int> z_index() const;
 
@@ -24,7 +24,9 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <AK/HashFunctions.h>
 #include <AK/QuickSort.h>
+#include <LibThread/ThreadPool.h>
 #include <LibWeb/CSS/Parser/CSSParser.h>
 #include <LibWeb/CSS/SelectorEngine.h>
 #include <LibWeb/CSS/StyleResolver.h>
@@ -66,9 +68,135 @@ void StyleResolver::for_each_stylesheet(Callback callback) const
     }
 }
 
-Vector<MatchingRule> StyleResolver::collect_matching_rules(const DOM::Element& element) const
+static u32 ancestor_filter_hash(CSS::Selector::SimpleSelector::Type type, u32 string_hash)
 {
-    Vector<MatchingRule> matching_rules;
+    return pair_int_hash(string_hash, static_cast<u32>(type));
+}
+
+// A small Bloom filter of the ids, classes and tag names of an element's ancestors.
+// It can tell for certain that no ancestor has a given one, which lets us reject most
+// selectors with descendant and child combinators without walking up the tree.
+class AncestorFilter {
+public:
+    explicit AncestorFilter(const DOM::Element& element)
+    {
+        for (auto* ancestor = element.parent(); ancestor; ancestor = ancestor->parent()) {
+            if (!is<DOM::Element>(*ancestor))
+                continue;
+            auto& ancestor_element = downcast<DOM::Element>(*ancestor);
+            add(ancestor_filter_hash(Selector::SimpleSelector::Type::TagName, ancestor_element.local_name().hash()));
+            auto id = ancestor_element.attribute(HTML::AttributeNames::id);
+            if (!id.is_empty())
+                add(ancestor_filter_hash(Selector::SimpleSelector::Type::Id, id.hash()));
+            for (auto& class_name : ancestor_element.class_names())
+                add(ancestor_filter_hash(Selector::SimpleSelector::Type::Class, class_name.hash()));
+        }
+    }
+
+    bool may_contain(u32 hash) const
+    {
+        return has_bit(hash % bit_count) && has_bit((hash >> 16) % bit_count);
+    }
+
+private:
+    static constexpr size_t bit_count = 1024;
+
+    void add(u32 hash)
+    {
+        set_bit(hash % bit_count);
+        set_bit((hash >> 16) % bit_count);
+    }
+
+    bool has_bit(size_t bit) const { return m_bits[bit / 32] & (1u << (bit % 32)); }
+    void set_bit(size_t bit) { m_bits[bit / 32] |= 1u << (bit % 32); }
+
+    u32 m_bits[bit_count / 32] {};
+};
+
+static Vector<u32, 4> collect_ancestor_hashes(const Selector& selector)
+{
+    Vector<u32, 4> hashes;
+    auto& complex_selectors = selector.complex_selectors();
+    for (size_t i = complex_selectors.size() - 1; i > 0; --i) {
+        // Whatever is to the left of a descendant or child combinator has to match an
+        // ancestor of the element, even if there are sibling combinators further right.
+        auto relation = complex_selectors[i].relation;
+        if (relation != Selector::ComplexSelector::Relation::Descendant && relation != Selector::ComplexSelector::Relation::ImmediateChild)
+            continue;
+        for (auto& simple_selector : complex_selectors[i - 1].compound_selector) {
+            switch (simple_selector.type) {
+            case Selector::SimpleSelector::Type::Id:
+            case Selector::SimpleSelector::Type::Class:
+            case Selector::SimpleSelector::Type::TagName:
+                hashes.append(ancestor_filter_hash(simple_selector.type, simple_selector.value.hash()));
+                break;
+            default:
+                break;
+            }
+        }
+    }
+    return hashes;
+}
+
+const StyleResolver::RuleCache& StyleResolver::rule_cache() const
+{
+    if (m_rule_cache)
+        return *m_rule_cache;
+
+    m_rule_cache = make<RuleCache>();
+
+    auto add_to_bucket = [](auto& map, const FlyString& key, RuleCandidate&& candidate) {
+        auto it = map.find(key);
+        if (it == map.end()) {
+            map.set(key, {});
+            it = map.find(key);
+        }
+        it->value.append(move(candidate));
+    };
+
+    auto widen_scope = [](auto& map, const FlyString& key, InvalidationScope scope) {
+        auto it = map.find(key);
+        if (it == map.end())
+            map.set(key, scope);
+        else if (it->value < scope)
+            it->value = scope;
+    };
+
+    auto add_invalidation_scopes = [&](const Selector& selector) {
+        auto& complex_selectors = selector.complex_selectors();
+        for (size_t i = 0; i < complex_selectors.size(); ++i) {
+            auto scope = InvalidationScope::Element;
+            if (i != complex_selectors.size() - 1) {
+                auto relation = complex_selectors[i + 1].relation;
+                if (relation == Selector::ComplexSelector::Relation::AdjacentSibling || relation == Selector::ComplexSelector::Relation::GeneralSibling)
+                    scope = InvalidationScope::SiblingSubtrees;
+                else
+                    scope = InvalidationScope::Subtree;
+            }
+            if (scope == InvalidationScope::SiblingSubtrees)
+                m_rule_cache->has_sibling_dependent_selectors = true;
+            for (auto& simple_selector : complex_selectors[i].compound_selector) {
+                if (scope == InvalidationScope::Element) {
+                    switch (simple_selector.pseudo_class) {
+                    case Selector::SimpleSelector::PseudoClass::FirstChild:
+                    case Selector::SimpleSelector::PseudoClass::LastChild:
+                    case Selector::SimpleSelector::PseudoClass::OnlyChild:
+                    case Selector::SimpleSelector::PseudoClass::Empty:
+                        m_rule_cache->has_sibling_dependent_selectors = true;
+                        break;
+                    default:
+                        break;
+                    }
+                }
+                if (simple_selector.type == Selector::SimpleSelector::Type::Id)
+                    widen_scope(m_rule_cache->id_invalidation_scopes, simple_selector.value, scope);
+                else if (simple_selector.type == Selector::SimpleSelector::Type::Class)
+                    widen_scope(m_rule_cache->class_invalidation_scopes, simple_selector.value, scope);
+                if (simple_selector.attribute_match_type != Selector::SimpleSelector::AttributeMatchType::None)
+                    widen_scope(m_rule_cache->attribute_invalidation_scopes, simple_selector.attribute_name, scope);
+            }
+        }
+    };
 
     size_t style_sheet_index = 0;
     for_each_stylesheet([&](auto& sheet) {
@@ -76,10 +204,32 @@ Vector<MatchingRule> StyleResolver::collect_matching_rules(const DOM::Element& e
         for (auto& rule : sheet.rules()) {
             size_t selector_index = 0;
             for (auto& selector : rule.selectors()) {
-                if (SelectorEngine::matches(selector, element)) {
-                    matching_rules.append({ rule, style_sheet_index, rule_index, selector_index });
-                    break;
+                add_invalidation_scopes(selector);
+                RuleCandidate candidate { { rule, style_sheet_index, rule_index, selector_index }, collect_ancestor_hashes(selector) };
+
+                const Selector::SimpleSelector* key_selector = nullptr;
+                for (auto& simple_selector : selector.complex_selectors().last().compound_selector) {
+                    if (simple_selector.type == Selector::SimpleSelector::Type::Id) {
+                        key_selector = &simple_selector;
+                        break;
+                    }
+                    if (simple_selector.type == Selector::SimpleSelector::Type::Class) {
+                        if (!key_selector || key_selector->type == Selector::SimpleSelector::Type::TagName)
+                            key_selector = &simple_selector;
+                    } else if (simple_selector.type == Selector::SimpleSelector::Type::TagName) {
+                        if (!key_selector)
+                            key_selector = &simple_selector;
+                    }
                 }
+
+                if (!key_selector)
+                    m_rule_cache->other_rules.append(move(candidate));
+                else if (key_selector->type == Selector::SimpleSelector::Type::Id)
+                    add_to_bucket(m_rule_cache->rules_by_id, key_selector->value, move(candidate));
+                else if (key_selector->type == Selector::SimpleSelector::Type::Class)
+                    add_to_bucket(m_rule_cache->rules_by_class, key_selector->value, move(candidate));
+                else
+                    add_to_bucket(m_rule_cache->rules_by_tag_name, key_selector->value, move(candidate));
                 ++selector_index;
             }
             ++rule_index;
@@ -87,6 +237,100 @@ Vector<MatchingRule> StyleResolver::collect_matching_rules(const DOM::Element& e
         ++style_sheet_index;
     });
 
+    return *m_rule_cache;
+}
+
+void StyleResolver::invalidate_rule_cache()
+{
+    m_rule_cache = nullptr;
+    ++m_rule_cache_generation;
+}
+
+static InvalidationScope find_invalidation_scope(const HashMap<FlyString, InvalidationScope>& map, const FlyString& key)
+{
+    auto it = map.find(key);
+    if (it == map.end())
+        return InvalidationScope::None;
+    return it->value;
+}
+
+InvalidationScope StyleResolver::invalidation_scope_for_id(const FlyString& id) const
+{
+    return find_invalidation_scope(rule_cache().id_invalidation_scopes, id);
+}
+
+InvalidationScope StyleResolver::invalidation_scope_for_class(const FlyString& class_name) const
+{
+    return find_invalidation_scope(rule_cache().class_invalidation_scopes, class_name);
+}
+
+InvalidationScope StyleResolver::invalidation_scope_for_attribute(const FlyString& attribute_name) const
+{
+    return find_invalidation_scope(rule_cache().attribute_invalidation_scopes, attribute_name);
+}
+
+Vector<MatchingRule> StyleResolver::collect_matching_rules(const DOM::Element& element) const
+{
+    auto& cache = rule_cache();
+
+    Vector<const RuleCandidate*> candidates;
+    auto add_candidates = [&](auto& rules) {
+        for (auto& candidate : rules)
+            candidates.append(&candidate);
+    };
+
+    auto id = element.attribute(HTML::AttributeNames::id);
+    if (!id.is_empty()) {
+        auto it = cache.rules_by_id.find(id.hash(), [&](auto& entry) { return entry.key == id; });
+        if (it != cache.rules_by_id.end())
+            add_candidates(it->value);
+    }
+    for (auto& class_name : element.class_names()) {
+        auto it = cache.rules_by_class.find(class_name);
+        if (it != cache.rules_by_class.end())
+            add_candidates(it->value);
+    }
+    auto it = cache.rules_by_tag_name.find(element.local_name());
+    if (it != cache.rules_by_tag_name.end())
+        add_candidates(it->value);
+    add_candidates(cache.other_rules);
+
+    // Put the candidates back in document order, so that each rule is represented by
+    // its first matching selector, same as when every selector is tried in turn.
+    quick_sort(candidates, [](auto* a, auto* b) {
+        auto& a_rule = a->matching_rule;
+        auto& b_rule = b->matching_rule;
+        if (a_rule.style_sheet_index != b_rule.style_sheet_index)
+            return a_rule.style_sheet_index < b_rule.style_sheet_index;
+        if (a_rule.rule_index != b_rule.rule_index)
+            return a_rule.rule_index < b_rule.rule_index;
+        return a_rule.selector_index < b_rule.selector_index;
+    });
+
+    Vector<MatchingRule> matching_rules;
+    Optional<AncestorFilter> ancestor_filter;
+
+    for (auto* candidate : candidates) {
+        auto& rule = candidate->matching_rule;
+        if (!matching_rules.is_empty() && matching_rules.last().style_sheet_index == rule.style_sheet_index && matching_rules.last().rule_index == rule.rule_index)
+            continue;
+        if (!candidate->ancestor_hashes.is_empty()) {
+            if (!ancestor_filter.has_value())
+                ancestor_filter = AncestorFilter(element);
+            bool rejected = false;
+            for (auto hash : candidate->ancestor_hashes) {
+                if (!ancestor_filter.value().may_contain(hash)) {
+                    rejected = true;
+                    break;
+                }
+            }
+            if (rejected)
+                continue;
+        }
+        if (SelectorEngine::matches(rule.rule->selectors()[rule.selector_index], element))
+            matching_rules.append(rule);
+    }
+
 #ifdef HTML_DEBUG
     dbgprintf("Rules matching Element{%p}\n", &element);
     for (auto& rule : matching_rules) {
@@ -97,6 +341,33 @@ Vector<MatchingRule> StyleResolver::collect_matching_rules(const DOM::Element& e
     return matching_rules;
 }
 
+void StyleResolver::prematch_rules_in_parallel(const Vector<const DOM::Element*>& elements)
+{
+    // Below this, handing the work to other threads costs more than it saves.
+    static constexpr size_t min_elements_to_parallelize = 256;
+    static constexpr size_t elements_per_task = 32;
+
+    if (elements.size() < min_elements_to_parallelize)
+        return;
+
+    // Build the cache here, so that the threads only ever read it.
+    rule_cache();
+
+    Vector<Vector<MatchingRule>> results;
+    results.resize(elements.size());
+    LibThread::ThreadPool::the().parallel_for(0, elements.size(), elements_per_task, [&](size_t i) {
+        results[i] = collect_matching_rules(*elements[i]);
+    });
+
+    for (size_t i = 0; i < elements.size(); ++i)
+        m_prematched_rules.set(elements[i], move(results[i]));
+}
+
+void StyleResolver::clear_prematched_rules()
+{
+    m_prematched_rules.clear();
+}
+
 bool StyleResolver::is_inherited_property(CSS::PropertyID property_id)
 {
     static HashTable<CSS::PropertyID> inherited_properties;
@@ -519,8 +790,59 @@ static void set_property_expanding_shorthands(StyleProperties& style, CSS::Prope
     style.set_property(property_id, value);
 }
 
+static bool is_affected_by_hover(const DOM::Element& element)
+{
+    auto* hovered_node = element.document().hovered_node();
+    return hovered_node && (&element == hovered_node || element.is_ancestor_of(*hovered_node));
+}
+
+static bool have_same_attributes(const DOM::Element& a, const DOM::Element& b)
+{
+    size_t attribute_count = 0;
+    bool same = true;
+    a.for_each_attribute([&](auto& name, auto& value) {
+        ++attribute_count;
+        if (same && b.attribute(name) != value)
+            same = false;
+    });
+    if (!same)
+        return false;
+    b.for_each_attribute([&](auto&, auto&) {
+        --attribute_count;
+    });
+    return attribute_count == 0;
+}
+
+RefPtr<StyleProperties> StyleResolver::find_shareable_style(const DOM::Element& element, const StyleProperties* parent_style) const
+{
+    static constexpr size_t max_siblings_to_check = 8;
+
+    if (rule_cache().has_sibling_dependent_selectors || is_affected_by_hover(element))
+        return nullptr;
+
+    // Siblings share their ancestors, so with the same tag name and attributes (and thus the
+    // same classes and presentational hints), they match exactly the same rules.
+    size_t siblings_checked = 0;
+    for (auto* sibling = element.previous_element_sibling(); sibling && siblings_checked < max_siblings_to_check; sibling = sibling->previous_element_sibling(), ++siblings_checked) {
+        auto& shareable_style = sibling->shareable_style({});
+        if (!shareable_style.has_value())
+            continue;
+        if (shareable_style.value().parent_style.ptr() != parent_style || shareable_style.value().rule_cache_generation != m_rule_cache_generation)
+            continue;
+        if (sibling->local_name() != element.local_name() || is_affected_by_hover(*sibling) || !have_same_attributes(*sibling, element))
+            continue;
+        return shareable_style.value().style;
+    }
+    return nullptr;
+}
+
 NonnullRefPtr<StyleProperties> StyleResolver::resolve_style(const DOM::Element& element, const StyleProperties* parent_style) const
 {
+    if (auto shared_style = find_shareable_style(element, parent_style)) {
+        element.set_shareable_style({}, { *shared_style, parent_style, m_rule_cache_generation });
+        return shared_style.release_nonnull();
+    }
+
     auto style = StyleProperties::create();
 
     if (parent_style) {
@@ -532,7 +854,13 @@ NonnullRefPtr<StyleProperties> StyleResolver::resolve_style(const DOM::Element&
 
     element.apply_presentational_hints(*style);
 
-    auto matching_rules = collect_matching_rules(element);
+    Vector<MatchingRule> matching_rules;
+    if (auto it = m_prematched_rules.find(&element); it != m_prematched_rules.end()) {
+        matching_rules = move(it->value);
+        m_prematched_rules.remove(it);
+    } else {
+        matching_rules = collect_matching_rules(element);
+    }
 
     quick_sort(matching_rules, [&](MatchingRule& a, MatchingRule& b) {
         auto& a_selector = a.rule->selectors()[a.selector_index];
@@ -562,6 +890,7 @@ NonnullRefPtr<StyleProperties> StyleResolver::resolve_style(const DOM::Element&
         }
     }
 
+    element.set_shareable_style({}, { style, parent_style, m_rule_cache_generation });
     return style;
 }
 
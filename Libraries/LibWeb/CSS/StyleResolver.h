@@ -26,6 +26,8 @@
 
 #pragma once
 
+#include <AK/FlyString.h>
+#include <AK/HashMap.h>
 #include <AK/NonnullRefPtrVector.h>
 #include <AK/OwnPtr.h>
 #include <LibWeb/CSS/StyleProperties.h>
@@ -40,6 +42,15 @@ struct MatchingRule {
     size_t selector_index { 0 };
 };
 
+// How much of the tree may have to be restyled when an id, class or attribute
+// of an element changes, based on where it appears in the document's selectors.
+enum class InvalidationScope {
+    None,
+    Element,
+    Subtree,
+    SiblingSubtrees,
+};
+
 class StyleResolver {
 public:
     explicit StyleResolver(DOM::Document&);
@@ -52,13 +63,58 @@ public:
 
     Vector<MatchingRule> collect_matching_rules(const DOM::Element&) const;
 
+    // Matches the selectors for all of these elements on the thread pool, ahead of the
+    // resolve_style() calls that will need them. Matching only reads the DOM and the
+    // rule cache, so it's safe to do concurrently as long as neither changes until
+    // clear_prematched_rules().
+    void prematch_rules_in_parallel(const Vector<const DOM::Element*>&);
+    void clear_prematched_rules();
+
     static bool is_inherited_property(CSS::PropertyID);
 
+    void invalidate_rule_cache();
+
+    InvalidationScope invalidation_scope_for_id(const FlyString&) const;
+    InvalidationScope invalidation_scope_for_class(const FlyString&) const;
+    InvalidationScope invalidation_scope_for_attribute(const FlyString&) const;
+
 private:
     template<typename Callback>
     void for_each_stylesheet(Callback) const;
 
+    struct RuleCandidate {
+        MatchingRule matching_rule;
+        // Hashes of the ids, classes and tag names that some ancestor of a matching
+        // element must have, checked against an AncestorFilter before matching.
+        Vector<u32, 4> ancestor_hashes;
+    };
+
+    // Every selector is filed once under the id, class or tag name of its rightmost
+    // compound selector, so that an element only has to be matched against the
+    // selectors that could possibly apply to it.
+    struct RuleCache {
+        HashMap<FlyString, Vector<RuleCandidate>> rules_by_id;
+        HashMap<FlyString, Vector<RuleCandidate>> rules_by_class;
+        HashMap<FlyString, Vector<RuleCandidate>> rules_by_tag_name;
+        Vector<RuleCandidate> other_rules;
+
+        HashMap<FlyString, InvalidationScope> id_invalidation_scopes;
+        HashMap<FlyString, InvalidationScope> class_invalidation_scopes;
+        HashMap<FlyString, InvalidationScope> attribute_invalidation_scopes;
+
+        // Whether some selector depends on an element's position among its siblings
+        // or on its children, which rules out sharing styles between siblings.
+        bool has_sibling_dependent_selectors { false };
+    };
+
+    const RuleCache& rule_cache() const;
+
+    RefPtr<StyleProperties> find_shareable_style(const DOM::Element&, const StyleProperties* parent_style) const;
+
     DOM::Document& m_document;
+    mutable OwnPtr<RuleCache> m_rule_cache;
+    mutable HashMap<const DOM::Element*, Vector<MatchingRule>> m_prematched_rules;
+    u32 m_rule_cache_generation { 0 };
 };
 
 }
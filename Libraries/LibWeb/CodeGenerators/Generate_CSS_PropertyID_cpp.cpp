@@ -24,8 +24,10 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <AK/HashFunctions.h>
 #include <AK/JsonObject.h>
 #include <AK/StringBuilder.h>
+#include <AK/Vector.h>
 #include <LibCore/File.h>
 #include <ctype.h>
 #include <stdio.h>
@@ -45,6 +47,41 @@ static String title_casify(const String& dashy_name)
     return builder.to_string();
 }
 
+static u32 hash_property_name(const StringView& name, u32 seed)
+{
+    u32 hash = 0;
+    for (auto ch : name)
+        hash = hash * seed + (u8)tolower(ch);
+    return int_hash(hash);
+}
+
+// Finds a seed for hash_property_name() that gives each property its own slot.
+static void find_perfect_hash(const Vector<String>& names, u32& seed, size_t& table_size)
+{
+    for (table_size = 64; table_size < names.size() * 2; table_size *= 2)
+        ;
+    for (;;) {
+        for (seed = 31; seed < 100000; seed += 2) {
+            Vector<bool> used;
+            used.ensure_capacity(table_size);
+            for (size_t i = 0; i < table_size; ++i)
+                used.unchecked_append(false);
+            bool collided = false;
+            for (auto& name : names) {
+                auto slot = hash_property_name(name, seed) % table_size;
+                if (used[slot]) {
+                    collided = true;
+                    break;
+                }
+                used[slot] = true;
+            }
+            if (!collided)
+                return;
+        }
+        table_size *= 2;
+    }
+}
+
 int main(int argc, char** argv)
 {
     if (argc != 2) {
@@ -60,19 +97,46 @@ int main(int argc, char** argv)
     ASSERT(json.value().is_object());
 
     out() << "#include <AK/Assertions.h>";
+    out() << "#include <AK/HashFunctions.h>";
     out() << "#include <LibWeb/CSS/PropertyID.h>";
     out() << "namespace Web::CSS {";
 
-    out() << "PropertyID property_id_from_string(const StringView& string) {";
-
+    Vector<String> names;
+    size_t max_length = 0;
     json.value().as_object().for_each_member([&](auto& name, auto& value) {
         ASSERT(value.is_object());
-        out() << "    if (string.equals_ignoring_case(\"" << name << "\"))";
-        out() << "        return PropertyID::" << title_casify(name) << ";";
+        names.append(name);
+        max_length = max(max_length, name.length());
     });
 
-    out() << "    return PropertyID::Invalid;";
+    u32 seed;
+    size_t table_size;
+    find_perfect_hash(names, seed, table_size);
+
+    Vector<String> slots;
+    slots.resize(table_size);
+    for (auto& name : names)
+        slots[hash_property_name(name, seed) % table_size] = name;
 
+    out() << "static const PropertyID s_property_id_slots[" << table_size << "] = {";
+    for (auto& slot : slots) {
+        if (slot.is_null())
+            out() << "    PropertyID::Invalid,";
+        else
+            out() << "    PropertyID::" << title_casify(slot) << ",";
+    }
+    out() << "};";
+
+    out() << "PropertyID property_id_from_string(const StringView& string) {";
+    out() << "    if (string.is_empty() || string.length() > " << max_length << ")";
+    out() << "        return PropertyID::Invalid;";
+    out() << "    u32 hash = 0;";
+    out() << "    for (auto ch : string)";
+    out() << "        hash = hash * " << seed << " + (u8)(ch >= 'A' && ch <= 'Z' ? ch + ('a' - 'A') : ch);";
+    out() << "    auto property_id = s_property_id_slots[int_hash(hash) % " << table_size << "];";
+    out() << "    if (property_id == PropertyID::Invalid || !string.equals_ignoring_case(string_from_property_id(property_id)))";
+    out() << "        return PropertyID::Invalid;";
+    out() << "    return property_id;";
     out() << "}";
 
     out() << "const char* string_from_property_id(PropertyID property_id) {";
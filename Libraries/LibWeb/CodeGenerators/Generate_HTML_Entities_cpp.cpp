@@ -0,0 +1,178 @@
+/*
+ * Copyright (c) 2020, The SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <AK/JsonArray.h>
+#include <AK/JsonObject.h>
+#include <AK/QuickSort.h>
+#include <AK/Vector.h>
+#include <LibCore/File.h>
+#include <stdio.h>
+
+// Turns the WHATWG named character reference table into a trie, laid out so that the
+// children of each node are next to each other and sorted, which lets the tokenizer find
+// the longest matching reference with one binary search per input character.
+
+struct TrieNode {
+    char character { 0 };
+    u32 code_points[2] { 0, 0 };
+    Vector<size_t> children;
+};
+
+int main(int argc, char** argv)
+{
+    if (argc != 2) {
+        fprintf(stderr, "usage: %s <path/to/HTML/Parser/Entities.json>\n", argv[0]);
+        return 1;
+    }
+    auto file = Core::File::construct(argv[1]);
+    if (!file->open(Core::IODevice::ReadOnly))
+        return 1;
+
+    auto json = JsonValue::from_string(file->read_all());
+    ASSERT(json.has_value());
+    ASSERT(json.value().is_object());
+
+    Vector<TrieNode> nodes;
+    nodes.append(TrieNode {});
+
+    json.value().as_object().for_each_member([&](auto& name, auto& value) {
+        ASSERT(name.starts_with('&'));
+        ASSERT(value.is_object());
+        auto code_points = value.as_object().get("codepoints").as_array();
+        ASSERT(code_points.size() == 1 || code_points.size() == 2);
+
+        size_t node_index = 0;
+        for (size_t i = 1; i < name.length(); ++i) {
+            Optional<size_t> child_index;
+            for (auto index : nodes[node_index].children) {
+                if (nodes[index].character == name[i]) {
+                    child_index = index;
+                    break;
+                }
+            }
+            if (!child_index.has_value()) {
+                child_index = nodes.size();
+                nodes[node_index].children.append(nodes.size());
+                TrieNode child;
+                child.character = name[i];
+                nodes.append(move(child));
+            }
+            node_index = child_index.value();
+        }
+        ASSERT(!nodes[node_index].code_points[0]);
+        for (int i = 0; i < code_points.size(); ++i)
+            nodes[node_index].code_points[i] = code_points[i].to_u32();
+    });
+
+    // Number the nodes breadth first, so that siblings end up next to each other.
+    Vector<size_t> order;
+    Vector<size_t> new_index;
+    new_index.resize(nodes.size());
+    order.append(0);
+    for (size_t i = 0; i < order.size(); ++i) {
+        auto& node = nodes[order[i]];
+        quick_sort(node.children, [&](auto a, auto b) { return nodes[a].character < nodes[b].character; });
+        new_index[order[i]] = i;
+        order.append(node.children);
+    }
+    ASSERT(order.size() <= 0xffff);
+
+    out() << "#include <LibWeb/HTML/Parser/Entities.h>";
+    out() << "namespace Web::HTML {";
+
+    out() << "struct EntityTrieNode {";
+    out() << "    char character;";
+    out() << "    u8 child_count;";
+    out() << "    u16 first_child;";
+    out() << "    u16 code_points_index;";
+    out() << "};";
+
+    Vector<size_t> code_points_indices;
+    out() << "static constexpr u32 s_entity_code_points[][2] = {";
+    out() << "    { 0, 0 },";
+    size_t code_points_count = 1;
+    for (auto index : order) {
+        auto& node = nodes[index];
+        if (!node.code_points[0]) {
+            code_points_indices.append(0);
+            continue;
+        }
+        out() << "    { " << node.code_points[0] << ", " << node.code_points[1] << " },";
+        code_points_indices.append(code_points_count++);
+    }
+    out() << "};";
+
+    out() << "static constexpr EntityTrieNode s_entity_trie[] = {";
+    for (size_t i = 0; i < order.size(); ++i) {
+        auto& node = nodes[order[i]];
+        ASSERT(node.children.size() <= 0xff);
+        size_t first_child = node.children.is_empty() ? 0 : new_index[node.children.first()];
+        out() << "    { " << (int)node.character << ", " << node.children.size() << ", " << first_child << ", " << code_points_indices[i] << " },";
+    }
+    out() << "};";
+
+    out() << R"~~~(
+static const EntityTrieNode* find_child(const EntityTrieNode& node, char character)
+{
+    size_t begin = node.first_child;
+    size_t end = begin + node.child_count;
+    while (begin < end) {
+        size_t middle = begin + (end - begin) / 2;
+        auto& child = s_entity_trie[middle];
+        if (child.character == character)
+            return &child;
+        if (child.character < character)
+            begin = middle + 1;
+        else
+            end = middle;
+    }
+    return nullptr;
+}
+
+Optional<EntityMatch> code_points_from_entity(const StringView& entity)
+{
+    Optional<EntityMatch> match;
+    auto* node = &s_entity_trie[0];
+    for (size_t i = 0; i < entity.length(); ++i) {
+        node = find_child(*node, entity[i]);
+        if (!node)
+            break;
+        if (!node->code_points_index)
+            continue;
+        auto& code_points = s_entity_code_points[node->code_points_index];
+        EntityMatch new_match { { code_points[0] }, entity.substring_view(0, i + 1) };
+        if (code_points[1])
+            new_match.code_points.append(code_points[1]);
+        match = move(new_match);
+    }
+    return match;
+}
+)~~~";
+
+    out() << "}";
+
+    return 0;
+}
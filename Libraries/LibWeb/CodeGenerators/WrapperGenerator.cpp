@@ -113,6 +113,8 @@ struct Interface {
     // Added for convenience after parsing
     String wrapper_class;
     String wrapper_base_class;
+    String prototype_class;
+    String prototype_base_class;
     String fully_qualified_name;
 };
 
@@ -292,6 +294,9 @@ static OwnPtr<Interface> parse_interface(const StringView& input)
 
     interface->wrapper_class = String::format("%sWrapper", interface->name.characters());
     interface->wrapper_base_class = String::format("%sWrapper", interface->parent_name.is_empty() ? "" : interface->parent_name.characters());
+    interface->prototype_class = String::format("%sPrototype", interface->name.characters());
+    if (!interface->parent_name.is_empty())
+        interface->prototype_base_class = String::format("%sPrototype", interface->parent_name.characters());
 
     return interface;
 }
@@ -443,6 +448,21 @@ static void generate_header(const IDL::Interface& interface)
     auto is_foo_wrapper_name = snake_name(String::format("Is%s", wrapper_class.characters()));
     out() << "    virtual bool " << is_foo_wrapper_name << "() const final { return true; }";
 
+    if (wrapper_base_class == "Wrapper") {
+        out() << "private:";
+        out() << "    NonnullRefPtr<" << interface.fully_qualified_name << "> m_impl;";
+    }
+
+    out() << "};";
+
+    // The attributes and functions live on one prototype per interface and global object, shared by
+    // all the wrappers, rather than being defined again on every wrapper we create.
+    out() << "class " << interface.prototype_class << " final : public JS::Object {";
+    out() << "    JS_OBJECT(" << interface.prototype_class << ", JS::Object);";
+    out() << "public:";
+    out() << "    explicit " << interface.prototype_class << "(JS::GlobalObject&);";
+    out() << "    virtual void initialize(JS::GlobalObject&) override;";
+    out() << "    virtual ~" << interface.prototype_class << "() override;";
     out() << "private:";
 
     for (auto& function : interface.functions) {
@@ -455,10 +475,6 @@ static void generate_header(const IDL::Interface& interface)
             out() << "    JS_DECLARE_NATIVE_SETTER(" << snake_name(attribute.name) << "_setter);";
     }
 
-    if (wrapper_base_class == "Wrapper") {
-        out() << "    NonnullRefPtr<" << interface.fully_qualified_name << "> m_impl;";
-    }
-
     out() << "};";
 
     if (should_emit_wrapper_factory(interface)) {
@@ -480,7 +496,7 @@ void generate_implementation(const IDL::Interface& interface)
     out() << "#include <LibJS/Runtime/GlobalObject.h>";
     out() << "#include <LibJS/Runtime/Error.h>";
     out() << "#include <LibJS/Runtime/Function.h>";
-    out() << "#include <LibJS/Runtime/Uint8ClampedArray.h>";
+    out() << "#include <LibJS/Runtime/TypedArray.h>";
     out() << "#include <LibWeb/Bindings/NodeWrapperFactory.h>";
     out() << "#include <LibWeb/Bindings/" << wrapper_class << ".h>";
     out() << "#include <LibWeb/DOM/Element.h>";
@@ -492,6 +508,7 @@ void generate_implementation(const IDL::Interface& interface)
     out() << "#include <LibWeb/Bindings/HTMLImageElementWrapper.h>";
     out() << "#include <LibWeb/Bindings/ImageDataWrapper.h>";
     out() << "#include <LibWeb/Bindings/CanvasRenderingContext2DWrapper.h>";
+    out() << "#include <LibWeb/Bindings/WindowObject.h>";
 
     // FIXME: This is a total hack until we can figure out the namespace for a given type somehow.
     out() << "using namespace Web::DOM;";
@@ -500,21 +517,47 @@ void generate_implementation(const IDL::Interface& interface)
     out() << "namespace Web::Bindings {";
 
     // Implementation: Wrapper constructor
+    auto ensure_prototype = [](auto& prototype_class, auto& name) {
+        return String::format("static_cast<WindowObject&>(global_object).ensure_web_prototype<%s>(\"%s\")", prototype_class.characters(), name.characters());
+    };
+
     out() << wrapper_class << "::" << wrapper_class << "(JS::GlobalObject& global_object, " << interface.fully_qualified_name << "& impl)";
     if (wrapper_base_class == "Wrapper") {
-        out() << "    : Wrapper(*global_object.object_prototype())";
+        out() << "    : Wrapper(" << ensure_prototype(interface.prototype_class, interface.name) << ")";
         out() << "    , m_impl(impl)";
     } else {
         out() << "    : " << wrapper_base_class << "(global_object, impl)";
     }
     out() << "{";
+    if (wrapper_base_class != "Wrapper")
+        out() << "    set_prototype(&" << ensure_prototype(interface.prototype_class, interface.name) << ");";
     out() << "}";
 
     // Implementation: Wrapper initialize()
     out() << "void " << wrapper_class << "::initialize(JS::GlobalObject& global_object)";
     out() << "{";
-    out() << "    [[maybe_unused]] u8 default_attributes = JS::Attribute::Enumerable | JS::Attribute::Configurable;";
     out() << "    " << wrapper_base_class << "::initialize(global_object);";
+    out() << "}";
+
+    // Implementation: Wrapper destructor
+    out() << wrapper_class << "::~" << wrapper_class << "()";
+    out() << "{";
+    out() << "}";
+
+    // Implementation: Prototype constructor
+    out() << interface.prototype_class << "::" << interface.prototype_class << "(JS::GlobalObject& global_object)";
+    if (interface.prototype_base_class.is_null())
+        out() << "    : Object(*global_object.object_prototype())";
+    else
+        out() << "    : Object(" << ensure_prototype(interface.prototype_base_class, interface.parent_name) << ")";
+    out() << "{";
+    out() << "}";
+
+    // Implementation: Prototype initialize()
+    out() << "void " << interface.prototype_class << "::initialize(JS::GlobalObject& global_object)";
+    out() << "{";
+    out() << "    [[maybe_unused]] u8 default_attributes = JS::Attribute::Enumerable | JS::Attribute::Configurable;";
+    out() << "    Object::initialize(global_object);";
 
     for (auto& attribute : interface.attributes) {
         out() << "    define_native_property(\"" << attribute.name << "\", " << attribute.getter_callback_name << ", " << (attribute.readonly ? "nullptr" : attribute.setter_callback_name) << ", default_attributes);";
@@ -526,8 +569,8 @@ void generate_implementation(const IDL::Interface& interface)
 
     out() << "}";
 
-    // Implementation: Wrapper destructor
-    out() << wrapper_class << "::~" << wrapper_class << "()";
+    // Implementation: Prototype destructor
+    out() << interface.prototype_class << "::~" << interface.prototype_class << "()";
     out() << "{";
     out() << "}";
 
@@ -631,7 +674,7 @@ void generate_implementation(const IDL::Interface& interface)
 
     // Implementation: Attributes
     for (auto& attribute : interface.attributes) {
-        out() << "JS_DEFINE_NATIVE_GETTER(" << wrapper_class << "::" << attribute.getter_callback_name << ")";
+        out() << "JS_DEFINE_NATIVE_GETTER(" << interface.prototype_class << "::" << attribute.getter_callback_name << ")";
         out() << "{";
         out() << "    auto* impl = impl_from(interpreter, global_object);";
         out() << "    if (!impl)";
@@ -651,7 +694,7 @@ void generate_implementation(const IDL::Interface& interface)
         out() << "}";
 
         if (!attribute.readonly) {
-            out() << "JS_DEFINE_NATIVE_SETTER(" << wrapper_class << "::" << attribute.setter_callback_name << ")";
+            out() << "JS_DEFINE_NATIVE_SETTER(" << interface.prototype_class << "::" << attribute.setter_callback_name << ")";
             out() << "{";
             out() << "    auto* impl = impl_from(interpreter, global_object);";
             out() << "    if (!impl)";
@@ -674,7 +717,7 @@ void generate_implementation(const IDL::Interface& interface)
 
     // Implementation: Functions
     for (auto& function : interface.functions) {
-        out() << "JS_DEFINE_NATIVE_FUNCTION(" << wrapper_class << "::" << snake_name(function.name) << ")";
+        out() << "JS_DEFINE_NATIVE_FUNCTION(" << interface.prototype_class << "::" << snake_name(function.name) << ")";
         out() << "{";
         out() << "    auto* impl = impl_from(interpreter, global_object);";
         out() << "    if (!impl)";
@@ -25,6 +25,7 @@
  */
 
 #include <LibWeb/DOM/CharacterData.h>
+#include <LibWeb/Layout/LayoutNode.h>
 
 namespace Web::DOM {
 
@@ -38,4 +39,13 @@ CharacterData::~CharacterData()
 {
 }
 
+void CharacterData::set_data(const String& data)
+{
+    if (m_data == data)
+        return;
+    m_data = data;
+    if (layout_node())
+        layout_node()->set_needs_layout();
+}
+
 }
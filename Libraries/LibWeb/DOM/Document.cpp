@@ -53,6 +53,7 @@
 #include <LibWeb/HTML/HTMLTitleElement.h>
 #include <LibWeb/Layout/LayoutDocument.h>
 #include <LibWeb/Layout/LayoutTreeBuilder.h>
+#include <LibWeb/Layout/LayoutWidget.h>
 #include <LibWeb/Origin.h>
 #include <LibWeb/Page/Frame.h>
 #include <LibWeb/PageView.h>
@@ -232,6 +233,12 @@ URL Document::complete_url(const String& string) const
 void Document::invalidate_layout()
 {
     m_layout_root = nullptr;
+    m_pending_layout_roots.clear();
+}
+
+void Document::add_pending_layout_root(Badge<LayoutNode>, LayoutBlock& block)
+{
+    m_pending_layout_roots.append(block);
 }
 
 void Document::force_layout()
@@ -240,6 +247,14 @@ void Document::force_layout()
     layout();
 }
 
+static bool is_in_layout_tree(const LayoutNode& layout_node, const LayoutDocument& layout_root)
+{
+    auto* ancestor = &layout_node;
+    while (ancestor->parent())
+        ancestor = ancestor->parent();
+    return ancestor == &layout_root;
+}
+
 void Document::layout()
 {
     if (!frame())
@@ -249,7 +264,26 @@ void Document::layout()
         LayoutTreeBuilder tree_builder;
         m_layout_root = static_ptr_cast<LayoutDocument>(tree_builder.build(*this));
     }
-    m_layout_root->layout();
+
+    // Only the parts of the tree that changed are laid out again. Boxes that don't
+    // need to be laid out skip themselves, and fixed-size boxes whose contents changed
+    // are laid out in place, without involving their ancestors.
+    auto pending_layout_roots = move(m_pending_layout_roots);
+    if (m_layout_root->needs_layout() || m_layout_root->child_needs_layout()) {
+        m_layout_root->layout();
+        m_layout_root->clear_needs_layout();
+    }
+    for (auto& layout_root : pending_layout_roots) {
+        if (!layout_root.child_needs_layout() || !is_in_layout_tree(layout_root, *m_layout_root))
+            continue;
+        layout_root.layout();
+        layout_root.clear_needs_layout();
+        layout_root.for_each_in_subtree_of_type<LayoutWidget>([&](auto& widget) {
+            widget.update_widget();
+            return IterationDecision::Continue;
+        });
+    }
+    m_layout_root->invalidate_display_lists();
     m_layout_root->set_needs_display();
 
     if (frame()->is_main_frame())
@@ -258,11 +292,22 @@ void Document::layout()
 
 void Document::update_style()
 {
+    // Cascading needs the parent's style, so elements are restyled in tree order, but the
+    // selector matching that dominates it doesn't, and can be done for all of them up front.
+    Vector<const Element*> elements_to_restyle;
+    for_each_in_subtree_of_type<Element>([&](auto& element) {
+        if (element.needs_style_update())
+            elements_to_restyle.append(&element);
+        return IterationDecision::Continue;
+    });
+    style_resolver().prematch_rules_in_parallel(elements_to_restyle);
+
     for_each_in_subtree_of_type<Element>([&](auto& element) {
         if (element.needs_style_update())
             element.recompute_style();
         return IterationDecision::Continue;
     });
+    style_resolver().clear_prematched_rules();
     update_layout();
 }
 
@@ -427,6 +472,7 @@ JS::Interpreter& Document::interpreter()
 JS::Value Document::run_javascript(const StringView& source)
 {
     auto parser = JS::Parser(JS::Lexer(source));
+    parser.set_parse_function_bodies_lazily(true);
     auto program = parser.parse_program();
     if (parser.has_errors()) {
         parser.print_errors();
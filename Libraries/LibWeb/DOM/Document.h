@@ -26,6 +26,7 @@
 
 #pragma once
 
+#include <AK/Badge.h>
 #include <AK/FlyString.h>
 #include <AK/Function.h>
 #include <AK/NonnullRefPtrVector.h>
@@ -117,6 +118,8 @@ public:
     void update_style();
     void update_layout();
 
+    void add_pending_layout_root(Badge<LayoutNode>, LayoutBlock&);
+
     virtual bool is_child_allowed(const Node&) const override;
 
     const LayoutDocument* layout_node() const;
@@ -174,6 +177,7 @@ private:
     RefPtr<Window> m_window;
 
     RefPtr<LayoutDocument> m_layout_root;
+    NonnullRefPtrVector<LayoutBlock> m_pending_layout_roots;
 
     Optional<Color> m_link_color;
     Optional<Color> m_active_link_color;
@@ -82,17 +82,87 @@ String Element::attribute(const FlyString& name) const
 
 void Element::set_attribute(const FlyString& name, const String& value)
 {
-    if (auto* attribute = find_attribute(name))
+    String old_value;
+    if (auto* attribute = find_attribute(name)) {
+        old_value = attribute->value();
         attribute->set_value(value);
-    else
+    } else {
         m_attributes.empend(name, value);
+    }
 
     parse_attribute(name, value);
+    invalidate_style_after_attribute_change(name, old_value);
 }
 
 void Element::remove_attribute(const FlyString& name)
 {
+    auto old_value = attribute(name);
+    if (old_value.is_null())
+        return;
+
     m_attributes.remove_first_matching([&](auto& attribute) { return attribute.name() == name; });
+
+    if (name == HTML::AttributeNames::class_)
+        m_classes.clear();
+    invalidate_style_after_attribute_change(name, old_value);
+}
+
+void Element::invalidate_style_after_attribute_change(const FlyString& name, const String& old_value)
+{
+    // Our last style no longer says anything about elements with our new attributes.
+    m_shareable_style.clear();
+
+    // Elements that aren't in the document yet will get styled when they are inserted.
+    if (!is_connected())
+        return;
+
+    auto& style_resolver = document().style_resolver();
+
+    // Any attribute may feed into this element's presentational hints, so we always restyle it.
+    auto scope = CSS::InvalidationScope::Element;
+    auto widen_scope = [&](CSS::InvalidationScope new_scope) {
+        if (new_scope > scope)
+            scope = new_scope;
+    };
+
+    widen_scope(style_resolver.invalidation_scope_for_attribute(name));
+
+    if (name == HTML::AttributeNames::id) {
+        if (!old_value.is_empty())
+            widen_scope(style_resolver.invalidation_scope_for_id(old_value));
+        auto new_value = attribute(name);
+        if (!new_value.is_empty())
+            widen_scope(style_resolver.invalidation_scope_for_id(new_value));
+    } else if (name == HTML::AttributeNames::class_) {
+        // Only the classes that were added or removed can change which rules match.
+        auto old_classes = old_value.split_view(' ');
+        for (auto& old_class : old_classes) {
+            if (!has_class(old_class))
+                widen_scope(style_resolver.invalidation_scope_for_class(old_class));
+        }
+        for (auto& new_class : m_classes) {
+            if (!old_classes.contains_slow(new_class))
+                widen_scope(style_resolver.invalidation_scope_for_class(new_class));
+        }
+    }
+
+    switch (scope) {
+    case CSS::InvalidationScope::None:
+        break;
+    case CSS::InvalidationScope::Element:
+        set_needs_style_update(true);
+        document().schedule_style_update();
+        break;
+    case CSS::InvalidationScope::Subtree:
+        invalidate_style();
+        break;
+    case CSS::InvalidationScope::SiblingSubtrees:
+        if (parent())
+            parent()->invalidate_style();
+        else
+            invalidate_style();
+        break;
+    }
 }
 
 void Element::set_attributes(Vector<Attribute>&& attributes)
@@ -167,29 +237,40 @@ enum class StyleDifference {
     None,
     NeedsRepaint,
     NeedsRelayout,
+    NeedsLayoutTreeRebuild,
 };
 
-static StyleDifference compute_style_difference(const CSS::StyleProperties& old_style, const CSS::StyleProperties& new_style, const Document& document)
+static bool is_paint_only_property(CSS::PropertyID property_id)
+{
+    return property_id == CSS::PropertyID::Color || property_id == CSS::PropertyID::BackgroundColor;
+}
+
+static bool differs_only_in_paint_properties(const CSS::StyleProperties& old_style, const CSS::StyleProperties& new_style)
+{
+    bool only_paint_properties = true;
+    auto check_property = [&](auto property_id, auto& value, auto& other_style) {
+        if (!only_paint_properties || is_paint_only_property(property_id))
+            return;
+        auto other_value = other_style.property(property_id);
+        if (!other_value.has_value() || other_value.value()->type() != value.type() || other_value.value()->to_string() != value.to_string())
+            only_paint_properties = false;
+    };
+    old_style.for_each_property([&](auto property_id, auto& value) { check_property(property_id, value, new_style); });
+    new_style.for_each_property([&](auto property_id, auto& value) { check_property(property_id, value, old_style); });
+    return only_paint_properties;
+}
+
+static StyleDifference compute_style_difference(const CSS::StyleProperties& old_style, const CSS::StyleProperties& new_style)
 {
     if (old_style == new_style)
         return StyleDifference::None;
 
-    bool needs_repaint = false;
-    bool needs_relayout = false;
-
     if (new_style.display() != old_style.display())
-        needs_relayout = true;
-
-    if (new_style.color_or_fallback(CSS::PropertyID::Color, document, Color::Black) != old_style.color_or_fallback(CSS::PropertyID::Color, document, Color::Black))
-        needs_repaint = true;
-    else if (new_style.color_or_fallback(CSS::PropertyID::BackgroundColor, document, Color::Black) != old_style.color_or_fallback(CSS::PropertyID::BackgroundColor, document, Color::Black))
-        needs_repaint = true;
+        return StyleDifference::NeedsLayoutTreeRebuild;
 
-    if (needs_relayout)
-        return StyleDifference::NeedsRelayout;
-    if (needs_repaint)
+    if (differs_only_in_paint_properties(old_style, new_style))
         return StyleDifference::NeedsRepaint;
-    return StyleDifference::None;
+    return StyleDifference::NeedsRelayout;
 }
 
 void Element::recompute_style()
@@ -205,9 +286,9 @@ void Element::recompute_style()
     if (!layout_node()) {
         if (style->display() == CSS::Display::None)
             return;
-        // We need a new layout tree here!
         LayoutTreeBuilder tree_builder;
-        tree_builder.build(*this);
+        if (!tree_builder.insert_subtree(*this))
+            document().invalidate_layout();
         return;
     }
 
@@ -215,17 +296,32 @@ void Element::recompute_style()
     if (layout_node()->is_widget())
         return;
 
-    auto diff = compute_style_difference(layout_node()->specified_style(), *style, document());
+    auto& old_style = layout_node()->specified_style();
+    auto diff = compute_style_difference(old_style, *style);
     if (diff == StyleDifference::None)
         return;
-    layout_node()->set_specified_style(*style);
-    if (diff == StyleDifference::NeedsRelayout) {
-        document().force_layout();
+
+    // Our children keep their style unless something they inherit from us has changed.
+    if (!old_style.has_same_inherited_properties(*style)) {
+        for_each_child_of_type<Element>([&](auto& child) {
+            child.set_needs_style_update(true);
+        });
+    }
+
+    // Document::update_style() lays out the document once all elements have been restyled.
+    if (diff == StyleDifference::NeedsLayoutTreeRebuild) {
+        LayoutTreeBuilder tree_builder;
+        if (!tree_builder.remove_subtree(*this) || !tree_builder.insert_subtree(*this))
+            document().invalidate_layout();
         return;
     }
-    if (diff == StyleDifference::NeedsRepaint) {
+
+    layout_node()->set_specified_style(*style);
+
+    if (diff == StyleDifference::NeedsRelayout)
+        layout_node()->set_needs_layout();
+    else if (diff == StyleDifference::NeedsRepaint)
         layout_node()->set_needs_display();
-    }
 }
 
 NonnullRefPtr<CSS::StyleProperties> Element::computed_style()
@@ -265,7 +361,6 @@ void Element::set_inner_html(StringView markup)
 
     set_needs_style_update(true);
     document().schedule_style_update();
-    document().invalidate_layout();
 }
 
 String Element::inner_html() const
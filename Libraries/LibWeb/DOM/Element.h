@@ -26,7 +26,9 @@
 
 #pragma once
 
+#include <AK/Badge.h>
 #include <AK/FlyString.h>
+#include <AK/Optional.h>
 #include <AK/String.h>
 #include <LibWeb/DOM/Attribute.h>
 #include <LibWeb/DOM/NonDocumentTypeChildNode.h>
@@ -84,6 +86,15 @@ public:
     const CSS::StyleProperties* resolved_style() const { return m_resolved_style.ptr(); }
     NonnullRefPtr<CSS::StyleProperties> computed_style();
 
+    // The last style StyleResolver computed for this element, which siblings may share.
+    struct ShareableStyle {
+        NonnullRefPtr<CSS::StyleProperties> style;
+        RefPtr<const CSS::StyleProperties> parent_style;
+        u32 rule_cache_generation { 0 };
+    };
+    const Optional<ShareableStyle>& shareable_style(Badge<CSS::StyleResolver>) const { return m_shareable_style; }
+    void set_shareable_style(Badge<CSS::StyleResolver>, ShareableStyle&& shareable_style) const { m_shareable_style = move(shareable_style); }
+
     String inner_html() const;
     void set_inner_html(StringView);
 
@@ -91,6 +102,8 @@ protected:
     RefPtr<LayoutNode> create_layout_node(const CSS::StyleProperties* parent_style) override;
 
 private:
+    void invalidate_style_after_attribute_change(const FlyString& name, const String& old_value);
+
     Attribute* find_attribute(const FlyString& name);
     const Attribute* find_attribute(const FlyString& name) const;
 
@@ -98,6 +111,7 @@ private:
     Vector<Attribute> m_attributes;
 
     RefPtr<CSS::StyleProperties> m_resolved_style;
+    mutable Optional<ShareableStyle> m_shareable_style;
 
     Vector<FlyString> m_classes;
 };
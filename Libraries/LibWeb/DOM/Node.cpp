@@ -45,6 +45,7 @@
 #include <LibWeb/Layout/LayoutInline.h>
 #include <LibWeb/Layout/LayoutNode.h>
 #include <LibWeb/Layout/LayoutText.h>
+#include <LibWeb/Layout/LayoutTreeBuilder.h>
 
 //#define EVENT_DEBUG
 
@@ -97,6 +98,26 @@ RefPtr<LayoutNode> Node::create_layout_node(const CSS::StyleProperties*)
     return nullptr;
 }
 
+void Node::inserted_into(Node& parent)
+{
+    if (!parent.layout_node())
+        return;
+    LayoutTreeBuilder tree_builder;
+    if (!tree_builder.insert_subtree(*this))
+        document().invalidate_layout();
+    document().schedule_style_update();
+}
+
+void Node::removed_from(Node&)
+{
+    if (!layout_node())
+        return;
+    LayoutTreeBuilder tree_builder;
+    if (!tree_builder.remove_subtree(*this))
+        document().invalidate_layout();
+    document().schedule_style_update();
+}
+
 void Node::invalidate_style()
 {
     for_each_in_subtree_of_type<Element>([&](auto& element) {
@@ -117,7 +138,8 @@ void Node::dispatch_event(NonnullRefPtr<Event> event)
         if (listener.event_name == event->type()) {
             auto& function = const_cast<EventListener&>(*listener.listener).function();
 #ifdef EVENT_DEBUG
-            static_cast<const JS::ScriptFunction&>(function).body().dump(0);
+            if (auto* body = static_cast<const JS::ScriptFunction&>(function).body())
+                body->dump(0);
 #endif
             auto& global_object = function.global_object();
             auto* this_value = wrap(global_object, *this);
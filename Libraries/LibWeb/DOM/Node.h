@@ -106,8 +106,8 @@ public:
     Element* parent_element();
     const Element* parent_element() const;
 
-    virtual void inserted_into(Node&) { }
-    virtual void removed_from(Node&) { }
+    virtual void inserted_into(Node&);
+    virtual void removed_from(Node&);
     virtual void children_changed() { }
 
     const LayoutNode* layout_node() const { return m_layout_node; }
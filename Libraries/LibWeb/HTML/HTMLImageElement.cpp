@@ -41,12 +41,16 @@ HTMLImageElement::HTMLImageElement(DOM::Document& document, const FlyString& tag
     : HTMLElement(document, tag_name)
 {
     m_image_loader.on_load = [this] {
+        if (layout_node())
+            layout_node()->set_needs_layout();
         this->document().update_layout();
         dispatch_event(DOM::Event::create("load"));
     };
 
     m_image_loader.on_fail = [this] {
         dbg() << "HTMLImageElement: Resource did fail: " << this->src();
+        if (layout_node())
+            layout_node()->set_needs_layout();
         this->document().update_layout();
         dispatch_event(DOM::Event::create("error"));
     };
@@ -55,6 +59,22 @@ HTMLImageElement::HTMLImageElement(DOM::Document& document, const FlyString& tag
         if (layout_node())
             layout_node()->set_needs_display();
     };
+
+    m_image_loader.on_decode = [this] {
+        if (layout_node())
+            layout_node()->set_needs_display();
+    };
+
+    m_image_loader.on_partial_load = [this](bool size_became_known) {
+        if (!layout_node())
+            return;
+        if (!size_became_known) {
+            layout_node()->set_needs_display();
+            return;
+        }
+        layout_node()->set_needs_layout();
+        this->document().update_layout();
+    };
 }
 
 HTMLImageElement::~HTMLImageElement()
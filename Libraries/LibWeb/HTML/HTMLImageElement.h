@@ -47,6 +47,8 @@ public:
     String src() const { return attribute(HTML::AttributeNames::src); }
 
     const Gfx::Bitmap* bitmap() const;
+    unsigned natural_width() const { return m_image_loader.width(); }
+    unsigned natural_height() const { return m_image_loader.height(); }
 
 private:
     virtual void apply_presentational_hints(CSS::StyleProperties&) const override;
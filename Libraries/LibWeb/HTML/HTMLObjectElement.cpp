@@ -47,6 +47,11 @@ HTMLObjectElement::HTMLObjectElement(DOM::Document& document, const FlyString& t
         m_should_show_fallback_content = true;
         this->document().force_layout();
     };
+
+    m_image_loader.on_decode = [this] {
+        if (layout_node())
+            layout_node()->set_needs_display();
+    };
 }
 
 HTMLObjectElement::~HTMLObjectElement()
@@ -37,6 +37,7 @@
 #include <LibWeb/HTML/HTMLHeadElement.h>
 #include <LibWeb/HTML/HTMLScriptElement.h>
 #include <LibWeb/HTML/Parser/HTMLDocumentParser.h>
+#include <LibWeb/HTML/Parser/HTMLPreloadScanner.h>
 #include <LibWeb/HTML/Parser/HTMLToken.h>
 
 namespace Web::HTML {
@@ -123,6 +124,12 @@ HTMLDocumentParser::HTMLDocumentParser(const StringView& input, const String& en
 {
 }
 
+HTMLDocumentParser::HTMLDocumentParser(DOM::Document& existing_document, const String& encoding)
+    : m_tokenizer(encoding)
+    , m_document(existing_document)
+{
+}
+
 HTMLDocumentParser::~HTMLDocumentParser()
 {
 }
@@ -132,6 +139,30 @@ void HTMLDocumentParser::run(const URL& url)
     m_document->set_url(url);
     m_document->set_source(m_tokenizer.source());
 
+    parse_available_input();
+    the_end();
+}
+
+void HTMLDocumentParser::append_input(const StringView& input)
+{
+    m_tokenizer.append_input(input);
+    parse_available_input();
+}
+
+void HTMLDocumentParser::close_input()
+{
+    m_tokenizer.close_input();
+    m_document->set_source(m_tokenizer.source());
+
+    parse_available_input();
+    the_end();
+}
+
+void HTMLDocumentParser::parse_available_input()
+{
+    if (m_stop_parsing)
+        return;
+
     for (;;) {
         auto optional_token = m_tokenizer.next_token();
         if (!optional_token.has_value())
@@ -141,6 +172,12 @@ void HTMLDocumentParser::run(const URL& url)
 #ifdef PARSER_DEBUG
         dbg() << "[" << insertion_mode_name() << "] " << token.to_string();
 #endif
+        if (m_next_line_feed_can_be_ignored) {
+            m_next_line_feed_can_be_ignored = false;
+            if (token.is_character() && token.code_point() == '\n')
+                continue;
+        }
+
         process_using_the_rules_for(m_insertion_mode, token);
 
         if (m_stop_parsing) {
@@ -151,10 +188,12 @@ void HTMLDocumentParser::run(const URL& url)
         }
     }
 
+    // Make the text parsed so far visible, even if more of it is still to come.
     flush_character_insertions();
+}
 
-    // "The end"
-
+void HTMLDocumentParser::the_end()
+{
     auto scripts_to_execute_when_parsing_has_finished = m_document->take_scripts_to_execute_when_parsing_has_finished({});
     for (auto& script : scripts_to_execute_when_parsing_has_finished) {
         script.execute_script();
@@ -649,22 +688,22 @@ void HTMLDocumentParser::flush_character_insertions()
     m_character_insertion_node->set_data(m_character_insertion_builder.to_string());
     m_character_insertion_node->parent()->children_changed();
     m_character_insertion_builder.clear();
+    m_character_insertion_node = nullptr;
 }
 
 void HTMLDocumentParser::insert_character(u32 data)
 {
     auto node = find_character_insertion_node();
-    if (node == m_character_insertion_node) {
-        m_character_insertion_builder.append(Utf32View { &data, 1 });
+    if (!node)
         return;
-    }
-    if (!m_character_insertion_node) {
-        m_character_insertion_node = node;
+    if (node == m_character_insertion_node) {
         m_character_insertion_builder.append(Utf32View { &data, 1 });
         return;
     }
     flush_character_insertions();
     m_character_insertion_node = node;
+    // The node may already have text in it, e.g. from before parsing was interrupted to wait for more input.
+    m_character_insertion_builder.append(node->data());
     m_character_insertion_builder.append(Utf32View { &data, 1 });
 }
 
@@ -1161,12 +1200,7 @@ void HTMLDocumentParser::handle_in_body(HTMLToken& token)
         // If the next token is a U+000A LINE FEED (LF) character token,
         // then ignore that token and move on to the next one.
         // (Newlines at the start of pre blocks are ignored as an authoring convenience.)
-        auto next_token = m_tokenizer.next_token();
-        if (next_token.has_value() && next_token.value().is_character() && next_token.value().code_point() == '\n') {
-            // Ignore it.
-        } else {
-            process_using_the_rules_for(m_insertion_mode, next_token.value());
-        }
+        m_next_line_feed_can_be_ignored = true;
         return;
     }
 
@@ -1483,8 +1517,7 @@ void HTMLDocumentParser::handle_in_body(HTMLToken& token)
     if (token.is_start_tag() && token.tag_name() == HTML::TagNames::image) {
         // Parse error. Change the token's tag name to HTML::TagNames::img and reprocess it. (Don't ask.)
         PARSE_ERROR();
-        token.m_tag.tag_name.clear();
-        token.m_tag.tag_name.append(HTML::TagNames::img);
+        token.set_tag_name(HTML::TagNames::img);
         process_using_the_rules_for(m_insertion_mode, token);
         return;
     }
@@ -1497,17 +1530,11 @@ void HTMLDocumentParser::handle_in_body(HTMLToken& token)
         // If the next token is a U+000A LINE FEED (LF) character token,
         // then ignore that token and move on to the next one.
         // (Newlines at the start of pre blocks are ignored as an authoring convenience.)
-        auto next_token = m_tokenizer.next_token();
+        m_next_line_feed_can_be_ignored = true;
 
         m_original_insertion_mode = m_insertion_mode;
         m_frameset_ok = false;
         m_insertion_mode = InsertionMode::Text;
-
-        if (next_token.has_value() && next_token.value().is_character() && next_token.value().code_point() == '\n') {
-            // Ignore it.
-        } else {
-            process_using_the_rules_for(m_insertion_mode, next_token.value());
-        }
         return;
     }
 
@@ -1769,6 +1796,14 @@ void HTMLDocumentParser::handle_text(HTMLToken& token)
         NonnullRefPtr<HTMLScriptElement> script = downcast<HTMLScriptElement>(current_node());
         m_stack_of_open_elements.pop();
         m_insertion_mode = m_original_insertion_mode;
+        // A parser-blocking script is about to stall the parser until it has been fetched and run,
+        // so look ahead for the subresources that come after it and start fetching them meanwhile.
+        if (!m_parsing_fragment && !m_has_run_preload_scanner && script->has_attribute(HTML::AttributeNames::src) && !script->has_attribute(HTML::AttributeNames::async) && !script->has_attribute(HTML::AttributeNames::defer)) {
+            m_has_run_preload_scanner = true;
+            HTMLPreloadScanner preload_scanner(document(), m_tokenizer.remaining_source());
+            preload_scanner.scan();
+        }
+
         // FIXME: Handle tokenizer insertion point stuff here.
         increment_script_nesting_level();
         script->prepare_script({});
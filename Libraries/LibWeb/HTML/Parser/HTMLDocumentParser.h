@@ -65,10 +65,18 @@ class HTMLDocumentParser {
 public:
     HTMLDocumentParser(const StringView& input, const String& encoding);
     HTMLDocumentParser(const StringView& input, const String& encoding, DOM::Document& existing_document);
+
+    // Creates a parser for a document whose input arrives piece by piece, e.g. while it's being downloaded.
+    // Each call to append_input() builds as much of the DOM as the input so far allows.
+    HTMLDocumentParser(DOM::Document& existing_document, const String& encoding);
+
     ~HTMLDocumentParser();
 
     void run(const URL&);
 
+    void append_input(const StringView&);
+    void close_input();
+
     DOM::Document& document();
 
     static NonnullRefPtrVector<DOM::Node> parse_html_fragment(DOM::Element& context_element, const StringView&);
@@ -112,6 +120,9 @@ private:
     void handle_after_frameset(HTMLToken&);
     void handle_after_after_frameset(HTMLToken&);
 
+    void parse_available_input();
+    void the_end();
+
     void stop_parsing() { m_stop_parsing = true; }
 
     void generate_implied_end_tags(const FlyString& exception = {});
@@ -173,6 +184,8 @@ private:
     bool m_aborted { false };
     bool m_parser_pause_flag { false };
     bool m_stop_parsing { false };
+    bool m_has_run_preload_scanner { false };
+    bool m_next_line_feed_can_be_ignored { false };
     size_t m_script_nesting_level { 0 };
 
     RefPtr<DOM::Document> m_document;
@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <LibWeb/DOM/Document.h>
+#include <LibWeb/DOM/TagNames.h>
+#include <LibWeb/HTML/AttributeNames.h>
+#include <LibWeb/HTML/Parser/HTMLPreloadScanner.h>
+#include <LibWeb/Loader/ResourceLoader.h>
+
+//#define PRELOAD_DEBUG
+
+namespace Web::HTML {
+
+HTMLPreloadScanner::HTMLPreloadScanner(DOM::Document& document, const StringView& input)
+    : m_document(document)
+    , m_tokenizer(input, "utf-8")
+{
+}
+
+void HTMLPreloadScanner::preload(Resource::Type type, const StringView& url_string)
+{
+    if (url_string.is_empty())
+        return;
+    auto url = m_document.complete_url(url_string);
+    if (!url.is_valid())
+        return;
+
+#ifdef PRELOAD_DEBUG
+    dbg() << "HTMLPreloadScanner: Preloading " << url;
+#endif
+
+    // The resource ends up in the ResourceLoader cache, where the element that
+    // eventually asks for the same URL will pick it up.
+    LoadRequest request;
+    request.set_url(url);
+    // Images are streamed so they can be shown while they load, see ImageLoader::load().
+    ResourceLoader::the().load_resource(type, request, type == Resource::Type::Image);
+}
+
+void HTMLPreloadScanner::scan()
+{
+    for (;;) {
+        auto optional_token = m_tokenizer.next_token();
+        if (!optional_token.has_value())
+            break;
+        auto& token = optional_token.value();
+        if (token.is_end_of_file())
+            break;
+        if (!token.is_start_tag())
+            continue;
+
+        auto tag_name = token.tag_name();
+        if (tag_name == HTML::TagNames::script) {
+            preload(Resource::Type::Generic, token.attribute(HTML::AttributeNames::src));
+            m_tokenizer.set_state({}, HTMLTokenizer::State::ScriptData);
+        } else if (tag_name == HTML::TagNames::link) {
+            bool is_stylesheet = false;
+            for (auto& part : token.attribute(HTML::AttributeNames::rel).split_view(' ')) {
+                if (part == "stylesheet")
+                    is_stylesheet = true;
+            }
+            if (is_stylesheet)
+                preload(Resource::Type::Generic, token.attribute(HTML::AttributeNames::href));
+        } else if (tag_name == HTML::TagNames::img) {
+            preload(Resource::Type::Image, token.attribute(HTML::AttributeNames::src));
+        } else if (tag_name == HTML::TagNames::style || tag_name == HTML::TagNames::xmp || tag_name == HTML::TagNames::iframe || tag_name == HTML::TagNames::noembed || tag_name == HTML::TagNames::noframes) {
+            m_tokenizer.set_state({}, HTMLTokenizer::State::RAWTEXT);
+        } else if (tag_name == HTML::TagNames::title || tag_name == HTML::TagNames::textarea) {
+            m_tokenizer.set_state({}, HTMLTokenizer::State::RCDATA);
+        } else if (tag_name == HTML::TagNames::plaintext) {
+            break;
+        }
+    }
+}
+
+}
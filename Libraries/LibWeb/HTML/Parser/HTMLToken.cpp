@@ -71,12 +71,18 @@ String HTMLToken::to_string() const
         builder.append("} }");
     }
 
-    if (type() == HTMLToken::Type::Comment || type() == HTMLToken::Type::Character) {
+    if (type() == HTMLToken::Type::Comment) {
         builder.append(" { data: '");
         builder.append(m_comment_or_character.data.to_string());
         builder.append("' }");
     }
 
+    if (type() == HTMLToken::Type::Character) {
+        builder.append(" { data: '");
+        builder.append_code_point(m_code_point);
+        builder.append("' }");
+    }
+
     return builder.to_string();
 
     //dbg() << "[" << String::format("%42s", state_name(m_state)) << "] " << builder.to_string();
@@ -54,7 +54,7 @@ public:
     {
         HTMLToken token;
         token.m_type = Type::Character;
-        token.m_comment_or_character.data.append(code_point);
+        token.m_code_point = code_point;
         return token;
     }
 
@@ -63,6 +63,7 @@ public:
         HTMLToken token;
         token.m_type = Type::StartTag;
         token.m_tag.tag_name.append(tag_name);
+        token.m_tag.interned_tag_name = tag_name;
         return token;
     }
 
@@ -76,9 +77,7 @@ public:
     u32 code_point() const
     {
         ASSERT(is_character());
-        Utf8View view(m_comment_or_character.data.string_view());
-        ASSERT(view.length_in_code_points() == 1);
-        return *view.begin();
+        return m_code_point;
     }
 
     bool is_parser_whitespace() const
@@ -98,10 +97,10 @@ public:
         }
     }
 
-    String tag_name() const
+    const FlyString& tag_name() const
     {
         ASSERT(is_start_tag() || is_end_tag());
-        return m_tag.tag_name.to_string();
+        return m_tag.interned_tag_name;
     }
 
     bool is_self_closing() const
@@ -171,6 +170,16 @@ public:
     String to_string() const;
 
 private:
+    // The tree builder compares tag names against HTML::TagNames a great many times per token,
+    // so the tokenizer interns the name once it's complete to make those pointer comparisons.
+    void set_tag_name(const FlyString& tag_name)
+    {
+        m_tag.tag_name.clear();
+        m_tag.tag_name.append(tag_name);
+        m_tag.interned_tag_name = tag_name;
+    }
+    void intern_tag_name() { m_tag.interned_tag_name = m_tag.tag_name.string_view(); }
+
     struct AttributeBuilder {
         StringBuilder prefix_builder;
         StringBuilder local_name_builder;
@@ -197,16 +206,19 @@ private:
     // Type::EndTag
     struct {
         StringBuilder tag_name;
+        FlyString interned_tag_name;
         bool self_closing { false };
         bool self_closing_acknowledged { false };
         Vector<AttributeBuilder> attributes;
     } m_tag;
 
     // Type::Comment
-    // Type::Character
     struct {
         StringBuilder data;
     } m_comment_or_character;
+
+    // Type::Character
+    u32 m_code_point { 0 };
 };
 
 }
@@ -100,9 +100,7 @@ namespace Web::HTML {
             if (consumed_as_part_of_an_attribute()) {                                              \
                 m_current_token.m_tag.attributes.last().value_builder.append_code_point(code_point); \
             } else {                                                                               \
-                create_new_token(HTMLToken::Type::Character);                                      \
-                m_current_token.m_comment_or_character.data.append_code_point(code_point);           \
-                m_queued_tokens.enqueue(m_current_token);                                          \
+                m_queued_tokens.enqueue(HTMLToken::make_character(code_point));                    \
             }                                                                                      \
         }                                                                                          \
     } while (0)
@@ -159,12 +157,10 @@ namespace Web::HTML {
         return m_queued_tokens.dequeue();         \
     } while (0)
 
-#define EMIT_CHARACTER(code_point)                                                \
-    do {                                                                         \
-        create_new_token(HTMLToken::Type::Character);                            \
-        m_current_token.m_comment_or_character.data.append_code_point(code_point); \
-        m_queued_tokens.enqueue(m_current_token);                                \
-        return m_queued_tokens.dequeue();                                        \
+#define EMIT_CHARACTER(code_point)                                         \
+    do {                                                                  \
+        m_queued_tokens.enqueue(HTMLToken::make_character(code_point));   \
+        return m_queued_tokens.dequeue();                                 \
     } while (0)
 
 #define EMIT_CURRENT_CHARACTER \
@@ -193,6 +189,9 @@ namespace Web::HTML {
     }                     \
     }
 
+// The length of the longest named character reference, e.g. "CounterClockwiseContourIntegral;".
+static constexpr size_t max_entity_length = 32;
+
 static inline bool is_surrogate(u32 code_point)
 {
     return (code_point & 0xfffff800) == 0xd800;
@@ -215,8 +214,11 @@ static inline bool is_control(u32 code_point)
 
 Optional<u32> HTMLTokenizer::next_code_point()
 {
-    if (m_utf8_iterator == m_utf8_view.end())
+    if (m_utf8_iterator == m_utf8_view.end()) {
+        if (!m_input_is_complete)
+            m_ran_out_of_input = true;
         return {};
+    }
     m_prev_utf8_iterator = m_utf8_iterator;
     ++m_utf8_iterator;
 #ifdef TOKENIZER_TRACE
@@ -230,12 +232,69 @@ Optional<u32> HTMLTokenizer::peek_code_point(size_t offset) const
     auto it = m_utf8_iterator;
     for (size_t i = 0; i < offset && it != m_utf8_view.end(); ++i)
         ++it;
-    if (it == m_utf8_view.end())
+    if (it == m_utf8_view.end()) {
+        if (!m_input_is_complete)
+            m_ran_out_of_input = true;
         return {};
+    }
     return *it;
 }
 
 Optional<HTMLToken> HTMLTokenizer::next_token()
+{
+    if (m_input_is_complete)
+        return next_token_impl();
+
+    if (!m_queued_tokens.is_empty())
+        return m_queued_tokens.dequeue();
+
+    // Running into the end of the input doesn't mean EOF while more of it may still arrive.
+    // When that happens, forget whatever this attempt produced and rewind to where it started,
+    // so the same token is tokenized again from scratch once the next chunk has been appended.
+    save_checkpoint();
+    m_ran_out_of_input = false;
+    auto token = next_token_impl();
+    if (m_ran_out_of_input) {
+        restore_checkpoint();
+        m_queued_tokens.clear();
+        token = {};
+    }
+    m_checkpoint.clear();
+    return token;
+}
+
+void HTMLTokenizer::save_checkpoint()
+{
+    Checkpoint checkpoint;
+    checkpoint.byte_offset = m_utf8_view.byte_offset_of(m_utf8_iterator);
+    checkpoint.prev_byte_offset = m_utf8_view.byte_offset_of(m_prev_utf8_iterator);
+    checkpoint.state = m_state;
+    checkpoint.return_state = m_return_state;
+    checkpoint.temporary_buffer = m_temporary_buffer;
+    checkpoint.character_reference_code = m_character_reference_code;
+    checkpoint.has_emitted_eof = m_has_emitted_eof;
+    // The current and last emitted start tag tokens are only saved once they're about to be replaced,
+    // since copying them up front for every single character token would be a waste.
+    m_checkpoint = move(checkpoint);
+}
+
+void HTMLTokenizer::restore_checkpoint()
+{
+    auto& checkpoint = m_checkpoint.value();
+    m_utf8_iterator = iterator_at_byte_offset(checkpoint.byte_offset);
+    m_prev_utf8_iterator = iterator_at_byte_offset(checkpoint.prev_byte_offset);
+    m_state = checkpoint.state;
+    m_return_state = checkpoint.return_state;
+    m_temporary_buffer = move(checkpoint.temporary_buffer);
+    m_character_reference_code = checkpoint.character_reference_code;
+    m_has_emitted_eof = checkpoint.has_emitted_eof;
+    if (checkpoint.current_token.has_value())
+        m_current_token = move(checkpoint.current_token.value());
+    if (checkpoint.last_emitted_start_tag.has_value())
+        m_last_emitted_start_tag = move(checkpoint.last_emitted_start_tag.value());
+}
+
+Optional<HTMLToken> HTMLTokenizer::next_token_impl()
 {
 _StartOfFunction:
     if (!m_queued_tokens.is_empty())
@@ -1533,6 +1592,10 @@ _StartOfFunction:
             {
                 size_t byte_offset = m_utf8_view.byte_offset_of(m_prev_utf8_iterator);
 
+                // The longest named character reference may extend past the input we have so far.
+                if (!m_input_is_complete && m_decoded_input.length() - byte_offset <= max_entity_length)
+                    m_ran_out_of_input = true;
+
                 auto match = HTML::code_points_from_entity(m_decoded_input.substring_view(byte_offset, m_decoded_input.length() - byte_offset - 1));
 
                 if (match.has_value()) {
@@ -2608,6 +2671,8 @@ bool HTMLTokenizer::consume_next_if_match(const StringView& string, CaseSensitiv
 
 void HTMLTokenizer::create_new_token(HTMLToken::Type type)
 {
+    if (m_checkpoint.has_value() && !m_checkpoint.value().current_token.has_value())
+        m_checkpoint.value().current_token = move(m_current_token);
     m_current_token = {};
     m_current_token.m_type = type;
 }
@@ -2619,6 +2684,90 @@ HTMLTokenizer::HTMLTokenizer(const StringView& input, const String& encoding)
     m_decoded_input = decoder->to_utf8(input);
     m_utf8_view = Utf8View(m_decoded_input);
     m_utf8_iterator = m_utf8_view.begin();
+    m_prev_utf8_iterator = m_utf8_iterator;
+}
+
+HTMLTokenizer::HTMLTokenizer(const String& encoding)
+    : m_decoder(TextCodec::decoder_for(encoding))
+    , m_is_streaming(true)
+    , m_input_is_complete(false)
+{
+    ASSERT(m_decoder);
+    m_utf8_iterator = m_utf8_view.begin();
+    m_prev_utf8_iterator = m_utf8_iterator;
+}
+
+// Returns how many bytes at the end of the input form an incomplete UTF-8 sequence.
+// This is harmless for single-byte encodings, where it only delays a few bytes until the next chunk.
+static size_t incomplete_utf8_suffix_length(const StringView& input)
+{
+    for (size_t length = 1; length <= 3 && length <= input.length(); ++length) {
+        u8 byte = input[input.length() - length];
+        if ((byte & 0xc0) == 0x80)
+            continue;
+        size_t sequence_length = 1;
+        if ((byte & 0xe0) == 0xc0)
+            sequence_length = 2;
+        else if ((byte & 0xf0) == 0xe0)
+            sequence_length = 3;
+        else if ((byte & 0xf8) == 0xf0)
+            sequence_length = 4;
+        return sequence_length > length ? length : 0;
+    }
+    return 0;
+}
+
+void HTMLTokenizer::append_input(const StringView& input)
+{
+    ASSERT(m_is_streaming);
+    ASSERT(!m_input_is_complete);
+
+    StringBuilder builder(m_undecoded_tail.length() + input.length());
+    builder.append(m_undecoded_tail);
+    builder.append(input);
+    auto bytes = builder.string_view();
+
+    auto complete_length = bytes.length() - incomplete_utf8_suffix_length(bytes);
+    m_undecoded_tail = bytes.substring_view(complete_length, bytes.length() - complete_length);
+    append_decoded_input(m_decoder->to_utf8(bytes.substring_view(0, complete_length)));
+}
+
+void HTMLTokenizer::close_input()
+{
+    ASSERT(m_is_streaming);
+    ASSERT(!m_input_is_complete);
+
+    if (!m_undecoded_tail.is_empty()) {
+        append_decoded_input(m_decoder->to_utf8(m_undecoded_tail));
+        m_undecoded_tail = {};
+    }
+    m_input_is_complete = true;
+    m_source = m_source_builder.to_string();
+    m_source_builder.clear();
+}
+
+void HTMLTokenizer::append_decoded_input(const String& input)
+{
+    if (input.is_empty())
+        return;
+    m_source_builder.append(input);
+
+    // Drop the input that has been consumed, except for the last code point, which may still be reconsumed.
+    size_t keep_offset = m_utf8_view.byte_offset_of(m_prev_utf8_iterator);
+    size_t offset = m_utf8_view.byte_offset_of(m_utf8_iterator) - keep_offset;
+    StringBuilder builder(m_decoded_input.length() - keep_offset + input.length());
+    builder.append(m_utf8_view.as_string().substring_view(keep_offset, m_decoded_input.length() - keep_offset));
+    builder.append(input);
+    m_decoded_input = builder.to_string();
+
+    m_utf8_view = Utf8View(m_decoded_input);
+    m_prev_utf8_iterator = m_utf8_view.begin();
+    m_utf8_iterator = iterator_at_byte_offset(offset);
+}
+
+AK::Utf8CodepointIterator HTMLTokenizer::iterator_at_byte_offset(size_t byte_offset) const
+{
+    return m_utf8_view.substring_view(byte_offset, m_utf8_view.byte_length() - byte_offset).begin();
 }
 
 void HTMLTokenizer::will_switch_to([[maybe_unused]] State new_state)
@@ -2645,8 +2794,13 @@ void HTMLTokenizer::switch_to(Badge<HTMLDocumentParser>, State new_state)
 
 void HTMLTokenizer::will_emit(HTMLToken& token)
 {
-    if (token.is_start_tag())
-        m_last_emitted_start_tag = token;
+    if (token.is_start_tag() || token.is_end_tag())
+        token.intern_tag_name();
+    if (!token.is_start_tag())
+        return;
+    if (m_checkpoint.has_value() && !m_checkpoint.value().last_emitted_start_tag.has_value())
+        m_checkpoint.value().last_emitted_start_tag = move(m_last_emitted_start_tag);
+    m_last_emitted_start_tag = token;
 }
 
 bool HTMLTokenizer::current_end_tag_token_is_appropriate() const
@@ -2654,7 +2808,7 @@ bool HTMLTokenizer::current_end_tag_token_is_appropriate() const
     ASSERT(m_current_token.is_end_tag());
     if (!m_last_emitted_start_tag.is_start_tag())
         return false;
-    return m_current_token.tag_name() == m_last_emitted_start_tag.tag_name();
+    return m_last_emitted_start_tag.tag_name() == m_current_token.m_tag.tag_name.string_view();
 }
 
 bool HTMLTokenizer::consumed_as_part_of_an_attribute() const
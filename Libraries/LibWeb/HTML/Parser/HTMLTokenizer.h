@@ -27,12 +27,17 @@
 #pragma once
 
 #include <AK/Queue.h>
+#include <AK/StringBuilder.h>
 #include <AK/StringView.h>
 #include <AK/Types.h>
 #include <AK/Utf8View.h>
 #include <LibWeb/Forward.h>
 #include <LibWeb/HTML/Parser/HTMLToken.h>
 
+namespace TextCodec {
+class Decoder;
+}
+
 namespace Web::HTML {
 
 #define ENUMERATE_TOKENIZER_STATES                                        \
@@ -121,22 +126,62 @@ class HTMLTokenizer {
 public:
     explicit HTMLTokenizer(const StringView& input, const String& encoding);
 
+    // Creates a tokenizer whose input arrives piece by piece through append_input(),
+    // e.g. while the document is still being downloaded.
+    explicit HTMLTokenizer(const String& encoding);
+
     enum class State {
 #define __ENUMERATE_TOKENIZER_STATE(state) state,
         ENUMERATE_TOKENIZER_STATES
 #undef __ENUMERATE_TOKENIZER_STATE
     };
 
+    // Returns nothing once all input has been tokenized. If more input may still be appended,
+    // that also happens whenever the remaining input isn't enough to produce the next token.
     Optional<HTMLToken> next_token();
 
+    void append_input(const StringView&);
+    void close_input();
+    bool is_input_complete() const { return m_input_is_complete; }
+
     void switch_to(Badge<HTMLDocumentParser>, State new_state);
+    void set_state(Badge<HTMLPreloadScanner>, State new_state) { m_state = new_state; }
 
     void set_blocked(bool b) { m_blocked = b; }
     bool is_blocked() const { return m_blocked; }
 
-    String source() const { return m_decoded_input; }
+    String source() const { return m_is_streaming ? m_source : m_decoded_input; }
+
+    // The part of the input that hasn't been consumed yet.
+    StringView remaining_source() const
+    {
+        auto offset = m_utf8_view.byte_offset_of(m_utf8_iterator);
+        return m_utf8_view.as_string().substring_view(offset, m_utf8_view.byte_length() - offset);
+    }
 
 private:
+    Optional<HTMLToken> next_token_impl();
+
+    void append_decoded_input(const String&);
+    AK::Utf8CodepointIterator iterator_at_byte_offset(size_t) const;
+
+    // Everything next_token_impl() may change before it runs out of input, so that
+    // tokenizing the current token can be retried from scratch once more input arrives.
+    struct Checkpoint {
+        size_t byte_offset { 0 };
+        size_t prev_byte_offset { 0 };
+        State state { State::Data };
+        State return_state { State::Data };
+        Vector<u32> temporary_buffer;
+        u32 character_reference_code { 0 };
+        bool has_emitted_eof { false };
+        Optional<HTMLToken> current_token;
+        Optional<HTMLToken> last_emitted_start_tag;
+    };
+
+    void save_checkpoint();
+    void restore_checkpoint();
+
     Optional<u32> next_code_point();
     Optional<u32> peek_code_point(size_t offset) const;
     bool consume_next_if_match(const StringView&, CaseSensitivity = CaseSensitivity::CaseSensitive);
@@ -185,6 +230,19 @@ private:
     u32 m_character_reference_code { 0 };
 
     bool m_blocked { false };
+
+    TextCodec::Decoder* m_decoder { nullptr };
+    bool m_is_streaming { false };
+    bool m_input_is_complete { true };
+    mutable bool m_ran_out_of_input { false };
+    Optional<Checkpoint> m_checkpoint;
+
+    // Bytes at the end of the last chunk that might be the start of a UTF-8 sequence
+    // completed by the next one.
+    String m_undecoded_tail;
+
+    StringBuilder m_source_builder;
+    String m_source;
 };
 
 }
@@ -58,11 +58,36 @@ LayoutNode& LayoutBlock::inline_wrapper()
 
 void LayoutBlock::layout(LayoutMode layout_mode)
 {
+    // The other layout modes are used for measuring content, and leave us in a state that
+    // doesn't match a regular layout, so only LayoutMode::Default is ever skipped.
+    if (layout_mode == LayoutMode::Default && !needs_layout() && !child_needs_layout() && m_width_of_containing_block_at_last_layout.has_value()) {
+        if (m_width_of_containing_block_at_last_layout.value() == width_of_logical_containing_block())
+            return;
+    }
+
     compute_width();
     layout_inside(layout_mode);
     compute_height();
 
     layout_absolutely_positioned_descendants();
+
+    if (layout_mode == LayoutMode::Default)
+        m_width_of_containing_block_at_last_layout = width_of_logical_containing_block();
+    else
+        m_width_of_containing_block_at_last_layout = {};
+}
+
+bool LayoutBlock::is_relayout_boundary() const
+{
+    // A block with a fixed size can be laid out again in place, since nothing outside it
+    // depends on its contents. Table layout and line layout look at content sizes, though.
+    if (is_anonymous() || is_root() || is_inline() || is_table() || is_table_row() || is_table_cell() || is_table_row_group())
+        return false;
+    if (is_absolutely_positioned())
+        return false;
+    if (!m_width_of_containing_block_at_last_layout.has_value())
+        return false;
+    return style().width().is_absolute() && style().height().is_absolute();
 }
 
 void LayoutBlock::layout_absolutely_positioned_descendant(LayoutBox& box)
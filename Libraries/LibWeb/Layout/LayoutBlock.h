@@ -41,6 +41,8 @@ public:
     virtual void layout(LayoutMode = LayoutMode::Default) override;
     virtual void paint(PaintContext&, PaintPhase) override;
 
+    virtual bool is_relayout_boundary() const override;
+
     virtual LayoutNode& inline_wrapper() override;
 
     Vector<LineBox>& line_boxes() { return m_line_boxes; }
@@ -93,6 +95,10 @@ private:
     void layout_contained_boxes(LayoutMode);
 
     Vector<LineBox> m_line_boxes;
+
+    // The containing block width of the last layout in LayoutMode::Default, if any.
+    // If neither that nor anything inside us has changed, there is nothing to redo.
+    Optional<float> m_width_of_containing_block_at_last_layout;
 };
 
 template<typename Callback>
@@ -167,10 +167,6 @@ void LayoutBox::paint(PaintContext& context, PaintPhase phase)
     if (!is_visible())
         return;
 
-    Gfx::PainterStateSaver saver(context.painter());
-    if (is_fixed_position())
-        context.painter().translate(context.scroll_offset());
-
     Gfx::FloatRect padded_rect;
     padded_rect.set_x(absolute_x() - box_model().padding.left.to_px(*this));
     padded_rect.set_width(width() + box_model().padding.left.to_px(*this) + box_model().padding.right.to_px(*this));
@@ -206,8 +202,6 @@ void LayoutBox::paint(PaintContext& context, PaintPhase phase)
         paint_border(context, Edge::Bottom, bordered_rect, CSS::PropertyID::BorderBottomStyle, style().border_bottom());
     }
 
-    LayoutNodeWithStyleAndBoxModelMetrics::paint(context, phase);
-
     if (phase == PaintPhase::Overlay && node() && document().inspected_node() == node()) {
         auto content_rect = absolute_rect();
 
@@ -56,6 +56,8 @@ void LayoutDocument::build_stacking_context_tree()
             ASSERT(!box.stacking_context());
             return IterationDecision::Continue;
         }
+        if (box.is_fixed_position())
+            m_has_fixed_position_boxes = true;
         auto* parent_context = box.enclosing_stacking_context();
         ASSERT(parent_context);
         box.set_stacking_context(make<StackingContext>(box, parent_context));
@@ -82,6 +84,7 @@ void LayoutDocument::layout(LayoutMode layout_mode)
     set_height(lowest_bottom);
 
     layout_absolutely_positioned_descendants();
+    invalidate_display_lists();
 
     // FIXME: This is a total hack. Make sure any GUI::Widgets are moved into place after layout.
     //        We should stop embedding GUI::Widgets entirely, since that won't work out-of-process.
@@ -102,15 +105,10 @@ void LayoutDocument::did_set_viewport_rect(Badge<Frame>, const Gfx::IntRect& a_v
 
 void LayoutDocument::paint_all_phases(PaintContext& context)
 {
-    paint(context, PaintPhase::Background);
-    paint(context, PaintPhase::Border);
-    paint(context, PaintPhase::Foreground);
-    paint(context, PaintPhase::Overlay);
-}
-
-void LayoutDocument::paint(PaintContext& context, PaintPhase phase)
-{
-    stacking_context()->paint(context, phase);
+    stacking_context()->paint(context, PaintPhase::Background);
+    stacking_context()->paint(context, PaintPhase::Border);
+    stacking_context()->paint(context, PaintPhase::Foreground);
+    stacking_context()->paint(context, PaintPhase::Overlay);
 }
 
 HitTestResult LayoutDocument::hit_test(const Gfx::IntPoint& position, HitTestType type) const
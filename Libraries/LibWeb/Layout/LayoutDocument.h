@@ -41,7 +41,6 @@ public:
     virtual void layout(LayoutMode = LayoutMode::Default) override;
 
     void paint_all_phases(PaintContext&);
-    virtual void paint(PaintContext&, PaintPhase) override;
 
     virtual HitTestResult hit_test(const Gfx::IntPoint&, HitTestType) const override;
 
@@ -54,8 +53,17 @@ public:
 
     void build_stacking_context_tree();
 
+    // Bumped whenever the layout tree or its geometry changes, to tell stacking contexts
+    // that their display lists are stale.
+    u32 display_list_generation() const { return m_display_list_generation; }
+    void invalidate_display_lists() { ++m_display_list_generation; }
+
+    bool has_fixed_position_boxes() const { return m_has_fixed_position_boxes; }
+
 private:
     LayoutRange m_selection;
+    u32 m_display_list_generation { 0 };
+    bool m_has_fixed_position_boxes { false };
 };
 
 }
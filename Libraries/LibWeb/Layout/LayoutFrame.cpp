@@ -73,14 +73,18 @@ void LayoutFrame::paint(PaintContext& context, PaintPhase phase)
 
         context.painter().save();
         auto old_viewport_rect = context.viewport_rect();
+        auto old_dirty_rect = context.dirty_rect();
 
         context.painter().add_clip_rect(enclosing_int_rect(absolute_rect()));
         context.painter().translate(absolute_x(), absolute_y());
 
         context.set_viewport_rect({ {}, node().hosted_frame()->size() });
+        if (old_dirty_rect.has_value())
+            context.set_dirty_rect(old_dirty_rect.value().translated(-absolute_x(), -absolute_y()));
         const_cast<LayoutDocument*>(hosted_layout_tree)->paint_all_phases(context);
 
         context.set_viewport_rect(old_viewport_rect);
+        context.set_dirty_rect(old_dirty_rect);
         context.painter().restore();
     }
 }
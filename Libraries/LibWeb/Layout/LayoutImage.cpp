@@ -29,6 +29,7 @@
 #include <LibGfx/ImageDecoder.h>
 #include <LibGfx/StylePainter.h>
 #include <LibWeb/Layout/LayoutImage.h>
+#include <math.h>
 
 namespace Web {
 
@@ -54,7 +55,8 @@ int LayoutImage::preferred_height() const
 
 void LayoutImage::layout(LayoutMode layout_mode)
 {
-    if (!m_image_loader.has_loaded_or_failed()) {
+    // A loading image already takes up its space once the size is known from its header.
+    if (!m_image_loader.has_loaded_or_failed() && (!m_image_loader.width() || !m_image_loader.height())) {
         set_has_intrinsic_width(true);
         set_has_intrinsic_height(true);
         set_intrinsic_width(0);
@@ -93,6 +95,9 @@ void LayoutImage::layout(LayoutMode layout_mode)
     }
 
     LayoutReplaced::layout(layout_mode);
+
+    // Images are only decoded when painted, and then no larger than they're displayed.
+    m_image_loader.set_displayed_size({ (int)ceilf(width()), (int)ceilf(height()) });
 }
 
 void LayoutImage::paint(PaintContext& context, PaintPhase phase)
@@ -115,8 +120,16 @@ void LayoutImage::paint(PaintContext& context, PaintPhase phase)
             if (alt.is_empty())
                 alt = image_element.src();
             context.painter().draw_text(enclosing_int_rect(absolute_rect()), alt, Gfx::TextAlignment::Center, specified_style().color_or_fallback(CSS::PropertyID::Color, document(), Color::Black), Gfx::TextElision::Right);
-        } else if (auto* bitmap = m_image_loader.bitmap()) {
-            context.painter().draw_scaled_bitmap(enclosing_int_rect(absolute_rect()), *bitmap, bitmap->rect());
+        } else if (auto* bitmap = m_image_loader.partial_bitmap()) {
+            // Only paint the rows that have been decoded so far, scaled to the part of the box they cover.
+            auto row_count = m_image_loader.decoded_row_count();
+            if (row_count > 0 && bitmap->height() > 0) {
+                auto rect = enclosing_int_rect(absolute_rect());
+                rect.set_height(rect.height() * row_count / bitmap->height());
+                context.painter().draw_scaled_bitmap(rect, *bitmap, { 0, 0, bitmap->width(), row_count }, 1.0f, Gfx::Painter::ScalingMode::Smooth);
+            }
+        } else if (auto* bitmap = m_image_loader.decoded_bitmap()) {
+            context.painter().draw_scaled_bitmap(enclosing_int_rect(absolute_rect()), *bitmap, bitmap->rect(), 1.0f, Gfx::Painter::ScalingMode::Smooth);
         }
     }
 }
@@ -56,6 +56,48 @@ void LayoutNode::layout(LayoutMode layout_mode)
     });
 }
 
+void LayoutNode::set_needs_layout()
+{
+    m_needs_layout = true;
+    if (auto* layout_root = document().layout_node())
+        layout_root->invalidate_display_lists();
+
+    // An absolutely positioned box gets laid out by its containing block, which may be
+    // outside the nearest relayout boundary, so changes inside one have to go all the way up.
+    bool can_stop_at_relayout_boundary = !is_absolutely_positioned();
+    for (auto* ancestor = parent(); ancestor; ancestor = ancestor->parent()) {
+        if (ancestor->m_child_needs_layout && can_stop_at_relayout_boundary)
+            return;
+        ancestor->m_child_needs_layout = true;
+        if (can_stop_at_relayout_boundary && !ancestor->m_needs_layout && ancestor->is_relayout_boundary()) {
+            document().add_pending_layout_root({}, downcast<LayoutBlock>(*ancestor));
+            return;
+        }
+        if (ancestor->is_absolutely_positioned())
+            can_stop_at_relayout_boundary = false;
+    }
+}
+
+void LayoutNode::clear_needs_layout()
+{
+    if (!m_needs_layout && !m_child_needs_layout)
+        return;
+    m_needs_layout = false;
+    m_child_needs_layout = false;
+    for_each_child([](auto& child) {
+        child.clear_needs_layout();
+    });
+}
+
+void LayoutNode::detach_from_dom()
+{
+    for_each_in_subtree([](auto& layout_node) {
+        if (layout_node.m_node && layout_node.m_node->layout_node() == &layout_node)
+            layout_node.m_node->set_layout_node({}, nullptr);
+        return IterationDecision::Continue;
+    });
+}
+
 bool LayoutNode::can_contain_boxes_with_position_absolute() const
 {
     return style().position() != CSS::Position::Static || is_root();
@@ -90,16 +132,13 @@ const LayoutBlock* LayoutNode::containing_block() const
     return nearest_block_ancestor();
 }
 
-void LayoutNode::paint(PaintContext& context, PaintPhase phase)
+void LayoutNode::set_visible(bool visible)
 {
-    if (!is_visible())
+    if (m_visible == visible)
         return;
-
-    for_each_child([&](auto& child) {
-        if (child.is_box() && downcast<LayoutBox>(child).stacking_context())
-            return;
-        child.paint(context, phase);
-    });
+    m_visible = visible;
+    if (auto* layout_root = document().layout_node())
+        layout_root->invalidate_display_lists();
 }
 
 HitTestResult LayoutNode::hit_test(const Gfx::IntPoint& position, HitTestType type) const
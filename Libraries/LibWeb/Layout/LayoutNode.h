@@ -99,13 +99,25 @@ public:
 
     virtual void layout(LayoutMode);
 
+    bool needs_layout() const { return m_needs_layout; }
+    bool child_needs_layout() const { return m_child_needs_layout; }
+    void set_needs_layout();
+    void clear_needs_layout();
+
+    // A node that can be laid out again on its own, without affecting anything outside it.
+    virtual bool is_relayout_boundary() const { return false; }
+
+    // Unhooks this subtree from its DOM nodes, after it has been taken out of the layout tree.
+    void detach_from_dom();
+
     enum class PaintPhase {
         Background,
         Border,
         Foreground,
         Overlay,
     };
-    virtual void paint(PaintContext&, PaintPhase);
+    // Paints this node only. Its descendants are painted by the display list of its stacking context.
+    virtual void paint(PaintContext&, PaintPhase) { }
 
     bool is_floating() const;
     bool is_absolutely_positioned() const;
@@ -130,7 +142,7 @@ public:
     virtual void split_into_lines(LayoutBlock& container, LayoutMode);
 
     bool is_visible() const { return m_visible; }
-    void set_visible(bool visible) { m_visible = visible; }
+    void set_visible(bool);
 
     virtual void set_needs_display();
 
@@ -154,6 +166,8 @@ private:
     bool m_has_style { false };
     bool m_visible { true };
     bool m_children_are_inline { false };
+    bool m_needs_layout { true };
+    bool m_child_needs_layout { false };
 };
 
 class LayoutNodeWithStyle : public LayoutNode {
@@ -161,7 +175,11 @@ public:
     virtual ~LayoutNodeWithStyle() override { }
 
     const CSS::StyleProperties& specified_style() const { return m_specified_style; }
-    void set_specified_style(const CSS::StyleProperties& style) { m_specified_style = style; }
+    void set_specified_style(const CSS::StyleProperties& style)
+    {
+        m_specified_style = style;
+        apply_style(style);
+    }
 
     const ImmutableLayoutStyle& style() const { return static_cast<const ImmutableLayoutStyle&>(m_style); }
 
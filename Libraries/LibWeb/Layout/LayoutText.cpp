@@ -182,60 +182,88 @@ void LayoutText::for_each_chunk(Callback callback, LayoutMode layout_mode, bool
         commit_chunk(view.end(), false, true);
 }
 
-void LayoutText::split_into_lines_by_rules(LayoutBlock& container, LayoutMode layout_mode, bool do_collapse, bool do_wrap_lines, bool do_wrap_breaks)
+void LayoutText::update_text_for_rendering(bool do_collapse, bool skip_leading_whitespace)
 {
-    auto& font = specified_style().font();
-    float space_width = font.glyph_width(' ') + font.glyph_spacing();
+    auto& data = node().data();
+    if (!do_collapse)
+        skip_leading_whitespace = false;
+    if (m_source_text.impl() && m_source_text == data && m_source_was_collapsed == do_collapse && m_source_skipped_leading_whitespace == skip_leading_whitespace)
+        return;
 
-    auto& line_boxes = container.line_boxes();
-    container.ensure_last_line_box();
-    float available_width = container.width() - line_boxes.last().width();
+    m_source_text = data;
+    m_source_was_collapsed = do_collapse;
+    m_source_skipped_leading_whitespace = skip_leading_whitespace;
+    m_chunk_cache.clear();
+
+    if (!do_collapse) {
+        m_text_for_rendering = data;
+        return;
+    }
 
     // Collapse whitespace into single spaces
-    if (do_collapse) {
-        auto utf8_view = Utf8View(node().data());
-        StringBuilder builder(node().data().length());
-        auto it = utf8_view.begin();
-        auto skip_over_whitespace = [&] {
-            auto prev = it;
-            while (it != utf8_view.end() && isspace(*it)) {
-                prev = it;
-                ++it;
-            }
-            it = prev;
-        };
-        if (line_boxes.last().ends_in_whitespace())
+    auto utf8_view = Utf8View(data);
+    StringBuilder builder(data.length());
+    auto it = utf8_view.begin();
+    auto skip_over_whitespace = [&] {
+        auto prev = it;
+        while (it != utf8_view.end() && isspace(*it)) {
+            prev = it;
+            ++it;
+        }
+        it = prev;
+    };
+    if (skip_leading_whitespace)
+        skip_over_whitespace();
+    for (; it != utf8_view.end(); ++it) {
+        if (!isspace(*it)) {
+            builder.append(utf8_view.as_string().characters_without_null_termination() + utf8_view.byte_offset_of(it), it.code_point_length_in_bytes());
+        } else {
+            builder.append(' ');
             skip_over_whitespace();
-        for (; it != utf8_view.end(); ++it) {
-            if (!isspace(*it)) {
-                builder.append(utf8_view.as_string().characters_without_null_termination() + utf8_view.byte_offset_of(it), it.code_point_length_in_bytes());
-            } else {
-                builder.append(' ');
-                skip_over_whitespace();
-            }
         }
-        m_text_for_rendering = builder.to_string();
-    } else {
-        m_text_for_rendering = node().data();
     }
+    m_text_for_rendering = builder.to_string();
+}
+
+const Vector<LayoutText::Chunk>& LayoutText::chunks_for(const Gfx::Font& font, LayoutMode layout_mode, bool do_wrap_lines, bool do_wrap_breaks)
+{
+    if (m_chunk_cache.has_value()) {
+        auto& cache = m_chunk_cache.value();
+        if (cache.font.ptr() == &font && cache.layout_mode == layout_mode && cache.do_wrap_lines == do_wrap_lines && cache.do_wrap_breaks == do_wrap_breaks)
+            return cache.chunks;
+    }
+
+    ChunkCache cache;
+    cache.font = const_cast<Gfx::Font&>(font);
+    cache.layout_mode = layout_mode;
+    cache.do_wrap_lines = do_wrap_lines;
+    cache.do_wrap_breaks = do_wrap_breaks;
 
     // do_wrap_lines  => chunks_are_words
     // !do_wrap_lines => chunks_are_lines
-    struct Chunk {
-        Utf8View view;
-        int start { 0 };
-        int length { 0 };
-        bool is_break { false };
-        bool is_all_whitespace { false };
-    };
-    Vector<Chunk> chunks;
-
     for_each_chunk(
         [&](const Utf8View& view, int start, int length, bool is_break, bool is_all_whitespace) {
-            chunks.append({ Utf8View(view), start, length, is_break, is_all_whitespace });
+            bool starts_with_space = !view.is_empty() && isspace(*view.begin());
+            cache.chunks.append({ start, length, font.width(view), is_break, is_all_whitespace, starts_with_space });
         },
         layout_mode, do_wrap_lines, do_wrap_breaks);
 
+    m_chunk_cache = move(cache);
+    return m_chunk_cache.value().chunks;
+}
+
+void LayoutText::split_into_lines_by_rules(LayoutBlock& container, LayoutMode layout_mode, bool do_collapse, bool do_wrap_lines, bool do_wrap_breaks)
+{
+    auto& font = specified_style().font();
+    float space_width = font.glyph_width(' ') + font.glyph_spacing();
+
+    auto& line_boxes = container.line_boxes();
+    container.ensure_last_line_box();
+    float available_width = container.width() - line_boxes.last().width();
+
+    update_text_for_rendering(do_collapse, line_boxes.last().ends_in_whitespace());
+    auto& chunks = chunks_for(font, layout_mode, do_wrap_lines, do_wrap_breaks);
+
     for (size_t i = 0; i < chunks.size(); ++i) {
         auto& chunk = chunks[i];
 
@@ -246,12 +274,12 @@ void LayoutText::split_into_lines_by_rules(LayoutBlock& container, LayoutMode la
         float chunk_width;
         bool need_collapse = false;
         if (do_wrap_lines) {
-            need_collapse = do_collapse && isspace(*chunk.view.begin()) && line_boxes.last().ends_in_whitespace();
+            need_collapse = do_collapse && chunk.starts_with_space && line_boxes.last().ends_in_whitespace();
 
             if (need_collapse)
                 chunk_width = space_width;
             else
-                chunk_width = font.width(chunk.view) + font.glyph_spacing();
+                chunk_width = chunk.width + font.glyph_spacing();
 
             if (line_boxes.last().width() > 0 && chunk_width > available_width) {
                 container.add_line_box();
@@ -260,7 +288,7 @@ void LayoutText::split_into_lines_by_rules(LayoutBlock& container, LayoutMode la
             if (need_collapse & line_boxes.last().fragments().is_empty())
                 continue;
         } else {
-            chunk_width = font.width(chunk.view);
+            chunk_width = chunk.width;
         }
 
         line_boxes.last().add_fragment(*this, chunk.start, need_collapse ? 1 : chunk.length, chunk_width, font.glyph_height());
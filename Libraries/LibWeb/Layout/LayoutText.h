@@ -26,6 +26,7 @@
 
 #pragma once
 
+#include <AK/Optional.h>
 #include <LibWeb/DOM/Text.h>
 #include <LibWeb/Layout/LayoutNode.h>
 
@@ -59,7 +60,35 @@ private:
     template<typename Callback>
     void for_each_chunk(Callback, LayoutMode, bool do_wrap_lines, bool do_wrap_breaks) const;
 
+    void update_text_for_rendering(bool do_collapse, bool skip_leading_whitespace);
+
+    struct Chunk {
+        int start { 0 };
+        int length { 0 };
+        int width { 0 };
+        bool is_break { false };
+        bool is_all_whitespace { false };
+        bool starts_with_space { false };
+    };
+    const Vector<Chunk>& chunks_for(const Gfx::Font&, LayoutMode, bool do_wrap_lines, bool do_wrap_breaks);
+
     String m_text_for_rendering;
+
+    // Whitespace collapsing, word segmentation and per-word measurement only depend
+    // on the DOM text, the white-space rules and the font, so they are kept across
+    // layout passes and recomputed only when one of those changes.
+    String m_source_text;
+    bool m_source_was_collapsed { false };
+    bool m_source_skipped_leading_whitespace { false };
+
+    struct ChunkCache {
+        RefPtr<Gfx::Font> font;
+        LayoutMode layout_mode { LayoutMode::Default };
+        bool do_wrap_lines { false };
+        bool do_wrap_breaks { false };
+        Vector<Chunk> chunks;
+    };
+    Optional<ChunkCache> m_chunk_cache;
 };
 
 }
@@ -26,6 +26,7 @@
 
 #include <LibWeb/DOM/Document.h>
 #include <LibWeb/DOM/ParentNode.h>
+#include <LibWeb/Layout/LayoutBlock.h>
 #include <LibWeb/Layout/LayoutNode.h>
 #include <LibWeb/Layout/LayoutTable.h>
 #include <LibWeb/Layout/LayoutText.h>
@@ -86,4 +87,98 @@ RefPtr<LayoutNode> LayoutTreeBuilder::build(DOM::Node& node)
     return create_layout_tree(node, nullptr);
 }
 
+static bool has_stacking_context(LayoutNode& layout_node)
+{
+    // FIXME: Update the stacking context tree in place as well.
+    bool found = false;
+    layout_node.for_each_in_subtree_of_type<LayoutBox>([&](auto& box) {
+        if (box.stacking_context() || box.establishes_stacking_context()) {
+            found = true;
+            return IterationDecision::Break;
+        }
+        return IterationDecision::Continue;
+    });
+    return found;
+}
+
+bool LayoutTreeBuilder::insert_subtree(DOM::Node& node)
+{
+    if (node.layout_node() || !node.parent())
+        return true;
+    auto* parent_layout_node = node.parent()->layout_node();
+    if (!parent_layout_node)
+        return true;
+    if (parent_layout_node->is_replaced())
+        return false;
+
+    auto layout_node = create_layout_tree(node, &parent_layout_node->specified_style());
+    if (!layout_node)
+        return true;
+    if (has_stacking_context(*layout_node))
+        return false;
+
+    LayoutNode* next_layout_node = nullptr;
+    for (auto* sibling = node.next_sibling(); sibling && !next_layout_node; sibling = sibling->next_sibling())
+        next_layout_node = sibling->layout_node();
+
+    LayoutNode* insertion_parent = parent_layout_node;
+    if (!parent_layout_node->first_child()) {
+        if (!layout_node->is_inline() && !is<LayoutBlock>(*parent_layout_node))
+            return false;
+        parent_layout_node->set_children_are_inline(layout_node->is_inline());
+    } else if (parent_layout_node->children_are_inline()) {
+        if (!layout_node->is_inline())
+            return false;
+    } else if (layout_node->is_inline()) {
+        // Inline content among blocks lives in anonymous wrappers, which we can only grow at the end.
+        if (next_layout_node || !is<LayoutBlock>(*parent_layout_node))
+            return false;
+        insertion_parent = &parent_layout_node->inline_wrapper();
+    }
+
+    if (next_layout_node && next_layout_node->parent() != insertion_parent)
+        return false;
+
+    if (next_layout_node)
+        insertion_parent->insert_before(*layout_node, next_layout_node);
+    else
+        insertion_parent->append_child(*layout_node);
+
+    layout_node->set_needs_layout();
+    return true;
+}
+
+bool LayoutTreeBuilder::remove_subtree(DOM::Node& node)
+{
+    auto* layout_node = node.layout_node();
+    if (!layout_node)
+        return true;
+    auto* parent = layout_node->parent();
+    if (!parent)
+        return false;
+    if (has_stacking_context(*layout_node))
+        return false;
+
+    // The line boxes of the block we're in may have fragments pointing into this subtree.
+    LayoutNode* ancestor = parent;
+    while (ancestor && !is<LayoutBlock>(*ancestor))
+        ancestor = ancestor->parent();
+    if (ancestor) {
+        auto& block = downcast<LayoutBlock>(*ancestor);
+        block.line_boxes().clear();
+        block.set_needs_layout();
+    }
+
+    NonnullRefPtr<LayoutNode> protector = *layout_node;
+    layout_node->detach_from_dom();
+    parent->remove_child(*layout_node);
+
+    // Don't leave an empty anonymous wrapper behind.
+    if (parent->is_anonymous() && !parent->first_child() && parent->parent()) {
+        NonnullRefPtr<LayoutNode> parent_protector = *parent;
+        parent->parent()->remove_child(*parent);
+    }
+    return true;
+}
+
 }
@@ -36,6 +36,12 @@ public:
     LayoutTreeBuilder();
 
     RefPtr<LayoutNode> build(DOM::Node&);
+
+    // These update the layout tree in place after a DOM node was inserted into or is about
+    // to be removed from a rendered part of the document. If that can't be done in place,
+    // they return false, and the whole layout tree has to be rebuilt.
+    bool insert_subtree(DOM::Node&);
+    bool remove_subtree(DOM::Node&);
 };
 
 }
@@ -146,9 +146,14 @@ bool FrameLoader::load(const URL& url, Type type)
         return false;
     }
 
+    m_incremental_parser = nullptr;
+    m_is_parsing_incrementally = false;
+    m_incrementally_parsed_size = 0;
+
     LoadRequest request;
     request.set_url(url);
-    set_resource(ResourceLoader::the().load_resource(Resource::Type::Generic, request));
+    // Stream the response, so HTML can be parsed while the rest of it is still arriving.
+    set_resource(ResourceLoader::the().load_resource(Resource::Type::Generic, request, true));
 
     if (type == Type::Navigation)
         frame().page().client().page_did_start_loading(url);
@@ -200,8 +205,61 @@ void FrameLoader::load_error_page(const URL& failed_url, const String& error)
         });
 }
 
+void FrameLoader::resource_did_receive_data()
+{
+    if (!m_is_parsing_incrementally) {
+        if (resource()->mime_type() != "text/html")
+            return;
+        auto document = adopt(*new DOM::Document(resource()->url()));
+        m_incremental_parser = make<HTML::HTMLDocumentParser>(document, resource()->encoding());
+        m_is_parsing_incrementally = true;
+        frame().set_document(document);
+    }
+    parse_incrementally();
+}
+
+void FrameLoader::parse_incrementally()
+{
+    // The parser is already busy further up the stack, it'll pick up the new data once it returns.
+    if (!m_incremental_parser)
+        return;
+
+    NonnullRefPtr<Resource> resource = *this->resource();
+    auto parser = m_incremental_parser.release_nonnull();
+    for (;;) {
+        auto data = resource->is_loaded() ? resource->encoded_data().span() : resource->received_data();
+        if (m_incrementally_parsed_size >= data.size())
+            break;
+        auto new_data = data.slice(m_incrementally_parsed_size, data.size() - m_incrementally_parsed_size);
+        m_incrementally_parsed_size = data.size();
+        parser->append_input(StringView(new_data.data(), new_data.size()));
+
+        // Parsing may have run scripts that navigated somewhere else.
+        if (this->resource() != resource.ptr())
+            return;
+    }
+
+    if (resource->is_failed())
+        return;
+
+    if (!resource->is_loaded()) {
+        m_incremental_parser = move(parser);
+        return;
+    }
+
+    parser->close_input();
+    if (this->resource() != resource.ptr())
+        return;
+    did_finish_loading(parser->document());
+}
+
 void FrameLoader::resource_did_load()
 {
+    if (m_is_parsing_incrementally) {
+        parse_incrementally();
+        return;
+    }
+
     auto url = resource()->url();
 
     if (!resource()->has_encoded_data()) {
@@ -225,14 +283,23 @@ void FrameLoader::resource_did_load()
     }
 
     frame().set_document(document);
-    frame().page().client().page_did_change_title(document->title());
+    did_finish_loading(*document);
+}
 
+void FrameLoader::did_finish_loading(DOM::Document& document)
+{
+    frame().page().client().page_did_change_title(document.title());
+
+    auto& url = resource()->url();
     if (!url.fragment().is_empty())
         frame().scroll_to_anchor(url.fragment());
 }
 
 void FrameLoader::resource_did_fail()
 {
+    m_incremental_parser = nullptr;
+    m_is_parsing_incrementally = false;
+
     load_error_page(resource()->url(), resource()->error());
 }
 
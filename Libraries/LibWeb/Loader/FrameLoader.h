@@ -27,6 +27,7 @@
 #pragma once
 
 #include <AK/Forward.h>
+#include <AK/OwnPtr.h>
 #include <LibWeb/Forward.h>
 #include <LibWeb/Loader/Resource.h>
 
@@ -51,13 +52,23 @@ public:
 
 private:
     // ^ResourceClient
+    virtual void resource_did_receive_data() override;
     virtual void resource_did_load() override;
     virtual void resource_did_fail() override;
 
+    void parse_incrementally();
+    void did_finish_loading(DOM::Document&);
+
     void load_error_page(const URL& failed_url, const String& error_message);
     RefPtr<DOM::Document> create_document_from_mime_type(const ByteBuffer&, const URL&, const String& mime_type, const String& encoding);
 
     Frame& m_frame;
+
+    // HTML documents are parsed as they arrive, so they can be laid out and painted before the download finishes.
+    // While the parser is busy, e.g. waiting for a script, it's taken out of here by the parse_incrementally() call on the stack.
+    OwnPtr<HTML::HTMLDocumentParser> m_incremental_parser;
+    bool m_is_parsing_incrementally { false };
+    size_t m_incrementally_parsed_size { 0 };
 };
 
 }
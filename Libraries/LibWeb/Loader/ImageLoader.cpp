@@ -42,7 +42,8 @@ void ImageLoader::load(const URL& url)
     m_loading_state = LoadingState::Loading;
     LoadRequest request;
     request.set_url(url);
-    set_resource(ResourceLoader::the().load_resource(Resource::Type::Image, request));
+    // Stream the response so the image can be shown top to bottom while it arrives.
+    set_resource(ResourceLoader::the().load_resource(Resource::Type::Image, request, true));
 }
 
 void ImageLoader::set_visible_in_viewport(bool visible_in_viewport) const
@@ -58,6 +59,25 @@ void ImageLoader::set_visible_in_viewport(bool visible_in_viewport) const
         const_cast<ImageResource*>(resource())->update_volatility();
 }
 
+void ImageLoader::resource_did_receive_data()
+{
+    ASSERT(resource());
+
+    bool size_became_known = false;
+    if (!m_partial_size_known && !resource()->natural_size().is_empty()) {
+        m_partial_size_known = true;
+        size_became_known = true;
+    }
+
+    auto row_count = resource()->decoded_row_count();
+    if (!size_became_known && row_count == m_partial_row_count)
+        return;
+    m_partial_row_count = row_count;
+
+    if (on_partial_load)
+        on_partial_load(size_became_known);
+}
+
 void ImageLoader::resource_did_load()
 {
     ASSERT(resource());
@@ -127,31 +147,33 @@ void ImageLoader::resource_did_fail()
         on_fail();
 }
 
+void ImageLoader::resource_did_decode()
+{
+    if (on_decode)
+        on_decode();
+}
+
 bool ImageLoader::has_image() const
 {
     if (!resource())
         return false;
     if (resource()->should_decode_in_process())
         return const_cast<ImageResource*>(resource())->ensure_decoder().bitmap();
-    return true;
+    return !resource()->natural_size().is_empty();
 }
 
 unsigned ImageLoader::width() const
 {
     if (!resource())
         return 0;
-    if (resource()->should_decode_in_process())
-        return const_cast<ImageResource*>(resource())->ensure_decoder().width();
-    return bitmap() ? bitmap()->width() : 0;
+    return resource()->natural_size().width();
 }
 
 unsigned ImageLoader::height() const
 {
     if (!resource())
         return 0;
-    if (resource()->should_decode_in_process())
-        return const_cast<ImageResource*>(resource())->ensure_decoder().height();
-    return bitmap() ? bitmap()->height() : 0;
+    return resource()->natural_size().height();
 }
 
 const Gfx::Bitmap* ImageLoader::bitmap() const
@@ -161,4 +183,25 @@ const Gfx::Bitmap* ImageLoader::bitmap() const
     return resource()->bitmap(m_current_frame_index);
 }
 
+const Gfx::Bitmap* ImageLoader::decoded_bitmap() const
+{
+    if (!resource())
+        return nullptr;
+    return resource()->decoded_bitmap(m_current_frame_index);
+}
+
+const Gfx::Bitmap* ImageLoader::partial_bitmap() const
+{
+    if (!resource() || has_loaded_or_failed())
+        return nullptr;
+    return resource()->partial_bitmap();
+}
+
+int ImageLoader::decoded_row_count() const
+{
+    if (!resource() || has_loaded_or_failed())
+        return 0;
+    return resource()->decoded_row_count();
+}
+
 }
@@ -40,11 +40,20 @@ public:
 
     const Gfx::Bitmap* bitmap() const;
 
+    // Doesn't wait for the image to be decoded, see ImageResource::decoded_bitmap().
+    const Gfx::Bitmap* decoded_bitmap() const;
+
+    // While the image is loading, the part of it that has been decoded so far.
+    // Only the top decoded_row_count() rows of the bitmap hold pixels.
+    const Gfx::Bitmap* partial_bitmap() const;
+    int decoded_row_count() const;
+
     bool has_image() const;
 
     bool has_loaded_or_failed() const { return m_loading_state != LoadingState::Loading; }
 
     void set_visible_in_viewport(bool) const;
+    void set_displayed_size(const Gfx::IntSize& size) const { m_displayed_size = size; }
 
     unsigned width() const;
     unsigned height() const;
@@ -52,12 +61,19 @@ public:
     Function<void()> on_load;
     Function<void()> on_fail;
     Function<void()> on_animate;
+    Function<void()> on_decode;
+
+    // Called while loading as more of the image has been decoded, with whether its size just became known.
+    Function<void(bool size_became_known)> on_partial_load;
 
 private:
     // ^ImageResourceClient
+    virtual void resource_did_receive_data() override;
     virtual void resource_did_load() override;
     virtual void resource_did_fail() override;
+    virtual void resource_did_decode() override;
     virtual bool is_visible_in_viewport() const override { return m_visible_in_viewport; }
+    virtual Gfx::IntSize displayed_size() const override { return m_displayed_size; }
 
     void animate();
 
@@ -69,6 +85,10 @@ private:
     };
 
     mutable bool m_visible_in_viewport { false };
+    mutable Gfx::IntSize m_displayed_size;
+
+    bool m_partial_size_known { false };
+    int m_partial_row_count { 0 };
 
     size_t m_current_frame_index { 0 };
     size_t m_loops_completed { 0 };
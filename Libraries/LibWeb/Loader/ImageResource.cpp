@@ -32,6 +32,15 @@
 
 namespace Web {
 
+// One connection for all images, so the service can decode several of them at the same time.
+static ImageDecoderClient::Client& image_decoder_client()
+{
+    static RefPtr<ImageDecoderClient::Client> client;
+    if (!client)
+        client = ImageDecoderClient::Client::construct();
+    return *client;
+}
+
 ImageResource::ImageResource(const LoadRequest& request)
     : Resource(Type::Image, request)
 {
@@ -53,8 +62,46 @@ Gfx::ImageDecoder& ImageResource::ensure_decoder()
     return *m_decoder;
 }
 
+bool ImageResource::should_decode_partially() const
+{
+    // Only these formats can be decoded before all of the data has arrived.
+    return mime_type() == "image/png" || mime_type() == "image/jpeg";
+}
+
+void ImageResource::did_receive_partial_data(ReadonlyBytes data)
+{
+    if (!should_decode_partially())
+        return;
+    if (!m_partial_decoder)
+        m_partial_decoder = Gfx::ImageDecoder::create_incremental();
+    m_partial_decoder->append_data(data, false);
+}
+
+void ImageResource::release_partial_decoder_if_loaded() const
+{
+    if (m_partial_decoder && has_encoded_data())
+        m_partial_decoder = nullptr;
+}
+
+const Gfx::Bitmap* ImageResource::partial_bitmap() const
+{
+    release_partial_decoder_if_loaded();
+    if (!m_partial_decoder)
+        return nullptr;
+    return m_partial_decoder->partial_bitmap();
+}
+
+int ImageResource::decoded_row_count() const
+{
+    release_partial_decoder_if_loaded();
+    if (!m_partial_decoder)
+        return 0;
+    return m_partial_decoder->decoded_row_count();
+}
+
 const Gfx::Bitmap* ImageResource::bitmap(size_t frame_index) const
 {
+    release_partial_decoder_if_loaded();
     if (!has_encoded_data())
         return nullptr;
 
@@ -65,35 +112,125 @@ const Gfx::Bitmap* ImageResource::bitmap(size_t frame_index) const
             return m_decoder->frame(frame_index).image;
         return m_decoder->bitmap();
     }
-    if (!m_decoded_image && !m_has_attempted_decode) {
-        auto image_decoder_client = ImageDecoderClient::Client::construct();
-        m_decoded_image = image_decoder_client->decode_image(encoded_data());
-        m_has_attempted_decode = true;
+    if (m_decode_failed)
+        return nullptr;
+
+    if (m_decoded_image && m_decoded_image->is_volatile() && !m_decoded_image->set_nonvolatile())
+        m_decoded_image = nullptr;
+
+    auto desired_size = desired_decode_size();
+    if (m_decoded_image && (m_decoded_image->width() < desired_size.width() || m_decoded_image->height() < desired_size.height()))
+        m_decoded_image = nullptr;
+
+    if (!m_decoded_image)
+        const_cast<ImageResource*>(this)->did_decode(image_decoder_client().decode_image(encoded_data(), desired_size));
+    return m_decoded_image;
+}
+
+const Gfx::Bitmap* ImageResource::decoded_bitmap(size_t frame_index) const
+{
+    release_partial_decoder_if_loaded();
+    if (!has_encoded_data())
+        return nullptr;
+
+    if (should_decode_in_process())
+        return bitmap(frame_index);
+    if (m_decode_failed)
+        return nullptr;
+
+    if (m_decoded_image && m_decoded_image->is_volatile() && !m_decoded_image->set_nonvolatile())
+        m_decoded_image = nullptr;
+
+    // A smaller image than we'd like is still good enough to paint until the larger one is in.
+    auto desired_size = desired_decode_size();
+    bool needs_decode = !m_decoded_image || m_decoded_image->width() < desired_size.width() || m_decoded_image->height() < desired_size.height();
+    if (needs_decode && !m_decode_in_progress) {
+        m_decode_in_progress = true;
+        auto& self = const_cast<ImageResource&>(*this);
+        image_decoder_client().decode_image_async(encoded_data(), desired_size, [&self, protector = NonnullRefPtr<ImageResource>(self)](auto decoded_image) {
+            self.m_decode_in_progress = false;
+            self.did_decode(move(decoded_image));
+            self.for_each_client([](auto& client) {
+                static_cast<ImageResourceClient&>(client).resource_did_decode();
+            });
+        });
     }
     return m_decoded_image;
 }
 
-void ImageResource::update_volatility()
+void ImageResource::did_decode(RefPtr<Gfx::Bitmap> decoded_image)
 {
-    if (!m_decoder)
+    if (!decoded_image) {
+        m_decode_failed = true;
+        m_decoded_image = nullptr;
         return;
+    }
+    // The decoder hands back a shared buffer. Keep our own copy in purgeable memory instead,
+    // so the kernel can reclaim it while the image is offscreen. See update_volatility().
+    m_decoded_image = decoded_image->to_purgeable_bitmap();
+    if (!m_decoded_image)
+        m_decoded_image = move(decoded_image);
+}
+
+Gfx::IntSize ImageResource::natural_size() const
+{
+    release_partial_decoder_if_loaded();
+    if (m_partial_decoder)
+        return m_partial_decoder->size();
+    if (!has_encoded_data())
+        return {};
+    if (should_decode_in_process())
+        return const_cast<ImageResource*>(this)->ensure_decoder().size();
+    if (!m_natural_size.has_value())
+        m_natural_size = Gfx::ImageDecoder::create(encoded_data())->size();
+    return m_natural_size.value();
+}
 
+Gfx::IntSize ImageResource::desired_decode_size() const
+{
+    auto natural_size = this->natural_size();
+    Gfx::IntSize displayed_size;
+    bool needs_natural_size = false;
+    const_cast<ImageResource*>(this)->for_each_client([&](auto& client) {
+        auto client_size = static_cast<const ImageResourceClient&>(client).displayed_size();
+        if (client_size.is_empty()) {
+            needs_natural_size = true;
+            return;
+        }
+        displayed_size = { max(displayed_size.width(), client_size.width()), max(displayed_size.height(), client_size.height()) };
+    });
+
+    if (needs_natural_size || displayed_size.is_empty())
+        return natural_size;
+    return { min(displayed_size.width(), natural_size.width()), min(displayed_size.height(), natural_size.height()) };
+}
+
+void ImageResource::update_volatility()
+{
     bool visible_in_viewport = false;
     for_each_client([&](auto& client) {
         if (static_cast<const ImageResourceClient&>(client).is_visible_in_viewport())
             visible_in_viewport = true;
     });
 
-    if (!visible_in_viewport) {
-        m_decoder->set_volatile();
-        return;
+    if (m_decoder) {
+        if (!visible_in_viewport)
+            m_decoder->set_volatile();
+        else if (!m_decoder->set_nonvolatile())
+            m_decoder = nullptr;
     }
 
-    bool still_has_decoded_image = m_decoder->set_nonvolatile();
-    if (still_has_decoded_image)
+    if (!m_decoded_image || !m_decoded_image->is_purgeable())
+        return;
+
+    if (!visible_in_viewport) {
+        m_decoded_image->set_volatile();
         return;
+    }
 
-    m_decoder = nullptr;
+    // If the pixels were purged while we were offscreen, decode again on the next paint.
+    if (!m_decoded_image->set_nonvolatile())
+        m_decoded_image = nullptr;
 }
 
 ImageResourceClient::~ImageResourceClient()
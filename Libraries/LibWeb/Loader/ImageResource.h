@@ -26,6 +26,8 @@
 
 #pragma once
 
+#include <AK/Optional.h>
+#include <LibGfx/Size.h>
 #include <LibWeb/Loader/Resource.h>
 
 namespace Web {
@@ -38,15 +40,44 @@ public:
     Gfx::ImageDecoder& ensure_decoder();
     const Gfx::Bitmap* bitmap(size_t frame_index = 0) const;
 
+    // Like bitmap(), but never waits for the ImageDecoder service. If no image of the wanted size
+    // is around yet, this starts decoding one and returns what we have (possibly nothing) for now.
+    // Clients are told through resource_did_decode() once the new image is in.
+    const Gfx::Bitmap* decoded_bitmap(size_t frame_index = 0) const;
+
+    // The intrinsic size of the image, read from its header without decoding any pixels.
+    Gfx::IntSize natural_size() const;
+
+    // While a streamed load is in progress, the image as far as it has been decoded.
+    // Only the top decoded_row_count() rows of the bitmap hold pixels.
+    const Gfx::Bitmap* partial_bitmap() const;
+    int decoded_row_count() const;
+
     bool should_decode_in_process() const;
 
     void update_volatility();
 
 private:
     explicit ImageResource(const LoadRequest&);
+
+    // ^Resource
+    virtual void did_receive_partial_data(ReadonlyBytes) override;
+
+    bool should_decode_partially() const;
+    void release_partial_decoder_if_loaded() const;
+
+    Gfx::IntSize desired_decode_size() const;
+    void did_decode(RefPtr<Gfx::Bitmap>);
+
     RefPtr<Gfx::ImageDecoder> m_decoder;
     mutable RefPtr<Gfx::Bitmap> m_decoded_image;
-    mutable bool m_has_attempted_decode { false };
+    mutable bool m_decode_failed { false };
+    mutable bool m_decode_in_progress { false };
+    mutable Optional<Gfx::IntSize> m_natural_size;
+
+    // Decodes the image as it arrives. It's dropped once the load completes, and the
+    // complete image goes through the same decoding as a non-streamed one.
+    mutable RefPtr<Gfx::ImageDecoder> m_partial_decoder;
 };
 
 class ImageResourceClient : public ResourceClient {
@@ -55,6 +86,12 @@ public:
 
     virtual bool is_visible_in_viewport() const { return false; }
 
+    // The size this client paints the image at, or an empty size if it needs the full image.
+    virtual Gfx::IntSize displayed_size() const { return {}; }
+
+    // A decode started by ImageResource::decoded_bitmap() has finished.
+    virtual void resource_did_decode() { }
+
 protected:
     ImageResource* resource() { return static_cast<ImageResource*>(ResourceClient::resource()); }
     const ImageResource* resource() const { return static_cast<const ImageResource*>(ResourceClient::resource()); }
@@ -84,13 +84,43 @@ static String mime_type_from_content_type(const String& content_type)
     return content_type;
 }
 
+void Resource::did_receive_headers(Badge<ResourceLoader>, const HashMap<String, String, CaseInsensitiveStringTraits>& headers)
+{
+    ASSERT(!m_loaded);
+    set_response_headers(headers);
+    m_has_received_headers = true;
+}
+
+void Resource::did_receive_data(Badge<ResourceLoader>, const ByteBuffer& data)
+{
+    ASSERT(!m_loaded);
+    if (!m_has_received_headers)
+        return;
+    m_received_data.append(data.data(), data.size());
+    did_receive_partial_data(data.span());
+
+    for_each_client([](auto& client) {
+        client.resource_did_receive_data();
+    });
+}
+
 void Resource::did_load(Badge<ResourceLoader>, const ByteBuffer& data, const HashMap<String, String, CaseInsensitiveStringTraits>& headers)
 {
     ASSERT(!m_loaded);
     m_encoded_data = data;
-    m_response_headers = headers;
+    m_received_data.clear();
+    set_response_headers(headers);
     m_loaded = true;
 
+    for_each_client([](auto& client) {
+        client.resource_did_load();
+    });
+}
+
+void Resource::set_response_headers(const HashMap<String, String, CaseInsensitiveStringTraits>& headers)
+{
+    m_response_headers = headers;
+
     auto content_type = headers.get("Content-Type");
     if (content_type.has_value()) {
 #ifdef RESOURCE_DEBUG
@@ -111,10 +141,6 @@ void Resource::did_load(Badge<ResourceLoader>, const ByteBuffer& data, const Has
         m_encoding = "utf-8"; // FIXME: This doesn't seem nice.
         m_mime_type = Core::guess_mime_type_based_on_filename(url());
     }
-
-    for_each_client([](auto& client) {
-        client.resource_did_load();
-    });
 }
 
 void Resource::did_fail(Badge<ResourceLoader>, const String& error)
@@ -31,6 +31,7 @@
 #include <AK/HashTable.h>
 #include <AK/Noncopyable.h>
 #include <AK/RefCounted.h>
+#include <AK/Span.h>
 #include <AK/URL.h>
 #include <AK/WeakPtr.h>
 #include <AK/Weakable.h>
@@ -64,9 +65,13 @@ public:
 
     bool has_encoded_data() const { return !m_encoded_data.is_null(); }
 
+    const LoadRequest& request() const { return m_request; }
     const URL& url() const { return m_request.url(); }
     const ByteBuffer& encoded_data() const { return m_encoded_data; }
 
+    // For streamed loads, the part of the body that has arrived so far while the load is still in progress.
+    ReadonlyBytes received_data() const { return m_received_data.span(); }
+
     const HashMap<String, String, CaseInsensitiveStringTraits>& response_headers() const { return m_response_headers; }
 
     void register_client(Badge<ResourceClient>, ResourceClient&);
@@ -77,15 +82,24 @@ public:
 
     void for_each_client(Function<void(ResourceClient&)>);
 
+    void did_receive_headers(Badge<ResourceLoader>, const HashMap<String, String, CaseInsensitiveStringTraits>& headers);
+    void did_receive_data(Badge<ResourceLoader>, const ByteBuffer& data);
     void did_load(Badge<ResourceLoader>, const ByteBuffer& data, const HashMap<String, String, CaseInsensitiveStringTraits>& headers);
     void did_fail(Badge<ResourceLoader>, const String& error);
 
 protected:
     explicit Resource(Type, const LoadRequest&);
 
+    // Called with each part of a streamed response body as it arrives, before clients are told about it.
+    virtual void did_receive_partial_data(ReadonlyBytes) { }
+
 private:
+    void set_response_headers(const HashMap<String, String, CaseInsensitiveStringTraits>&);
+
     LoadRequest m_request;
     ByteBuffer m_encoded_data;
+    Vector<u8> m_received_data;
+    bool m_has_received_headers { false };
     Type m_type { Type::Generic };
     bool m_loaded { false };
     bool m_failed { false };
@@ -100,6 +114,7 @@ class ResourceClient : public Weakable<ResourceClient> {
 public:
     virtual ~ResourceClient();
 
+    virtual void resource_did_receive_data() { }
     virtual void resource_did_load() { }
     virtual void resource_did_fail() { }
 
@@ -72,42 +72,218 @@ void ResourceLoader::load_sync(const URL& url, Function<void(const ByteBuffer&,
     loop.exec();
 }
 
-static HashMap<LoadRequest, NonnullRefPtr<Resource>> s_resource_cache;
+struct CacheControl {
+    bool no_store { false };
+    bool no_cache { false };
+    Optional<time_t> max_age;
+};
 
-RefPtr<Resource> ResourceLoader::load_resource(Resource::Type type, const LoadRequest& request)
+static CacheControl parse_cache_control(const Resource& resource)
+{
+    CacheControl cache_control;
+    auto header = resource.response_headers().get("Cache-Control");
+    if (!header.has_value())
+        return cache_control;
+    for (auto& part : header.value().split_view(',')) {
+        auto directive = String(part).trim_whitespace();
+        if (directive.equals_ignoring_case("no-store")) {
+            cache_control.no_store = true;
+        } else if (directive.equals_ignoring_case("no-cache")) {
+            cache_control.no_cache = true;
+        } else if (directive.starts_with("max-age=", CaseSensitivity::CaseInsensitive)) {
+            auto seconds = directive.substring_view(8, directive.length() - 8).to_uint();
+            if (seconds.has_value())
+                cache_control.max_age = seconds.value();
+        }
+    }
+    return cache_control;
+}
+
+static bool is_http_url(const URL& url)
+{
+    return url.protocol() == "http" || url.protocol() == "https";
+}
+
+bool ResourceLoader::is_fresh(const CachedResource& cached_resource) const
+{
+    auto& resource = *cached_resource.resource;
+    if (!is_http_url(resource.url()))
+        return true;
+    auto cache_control = parse_cache_control(resource);
+    if (cache_control.no_cache)
+        return false;
+    // Without an explicit lifetime from the server, fall back to a short heuristic one.
+    auto lifetime = cache_control.max_age.value_or(heuristic_freshness_lifetime);
+    return time(nullptr) - cached_resource.fetched_at < lifetime;
+}
+
+RefPtr<Resource> ResourceLoader::load_resource(Resource::Type type, const LoadRequest& request, bool stream_response)
 {
     if (!request.is_valid())
         return nullptr;
 
-    auto it = s_resource_cache.find(request);
-    if (it != s_resource_cache.end()) {
-        if (it->value->type() != type) {
+    RefPtr<Resource> stale_resource;
+    auto it = m_resource_cache.find(request);
+    if (it != m_resource_cache.end()) {
+        auto& cached_resource = it->value;
+        if (cached_resource.resource->type() != type) {
             dbg() << "FIXME: Not using cached resource for " << request.url() << " since there's a type mismatch.";
-        } else {
+        } else if (!cached_resource.resource->is_loaded() && !cached_resource.resource->is_failed()) {
+            // Still in flight, just wait along with everyone else.
+            cached_resource.last_use = ++m_cache_use_counter;
+            return cached_resource.resource;
+        } else if (cached_resource.resource->is_loaded() && is_fresh(cached_resource)) {
 #ifdef CACHE_DEBUG
             dbg() << "Reusing cached resource for: " << request.url();
 #endif
-            return it->value;
+            cached_resource.last_use = ++m_cache_use_counter;
+            return cached_resource.resource;
+        } else if (cached_resource.resource->is_loaded()) {
+            stale_resource = cached_resource.resource;
         }
     }
 
+    // Clients of a cached resource may still be using it, so revalidating or refetching
+    // it always goes into a fresh Resource that replaces it in the cache.
     auto resource = Resource::create({}, type, request);
+    m_resource_cache.set(request, { resource, ++m_cache_use_counter, time(nullptr) });
 
-    s_resource_cache.set(request, resource);
+    HashMap<String, String> request_headers;
+    if (stale_resource) {
+        auto etag = stale_resource->response_headers().get("ETag");
+        if (etag.has_value())
+            request_headers.set("If-None-Match", etag.value());
+        auto last_modified = stale_resource->response_headers().get("Last-Modified");
+        if (last_modified.has_value())
+            request_headers.set("If-Modified-Since", last_modified.value());
+        if (request_headers.is_empty())
+            stale_resource = nullptr;
+    }
+
+    Function<void(const HashMap<String, String, CaseInsensitiveStringTraits>&, Optional<u32>)> headers_callback;
+    Function<void(const ByteBuffer&)> data_callback;
+    if (stream_response) {
+        headers_callback = [resource](auto& headers, auto status_code) {
+            // Error pages, redirects and revalidations are only dealt with once the load has finished.
+            if (status_code.has_value() && status_code.value() >= 200 && status_code.value() <= 299)
+                const_cast<Resource&>(*resource).did_receive_headers({}, headers);
+        };
+        data_callback = [resource](auto& data) {
+            const_cast<Resource&>(*resource).did_receive_data({}, data);
+        };
+    }
 
     load(
         request.url(),
-        [=](auto& data, auto& headers) {
-            const_cast<Resource&>(*resource).did_load({}, data, headers);
+        request_headers,
+        [this, resource, stale_resource](auto& data, auto& headers, auto status_code) {
+            if (stale_resource && status_code.has_value() && status_code.value() == 304) {
+#ifdef CACHE_DEBUG
+                dbg() << "Revalidated cached resource for: " << resource->url();
+#endif
+                // Not modified: keep the data we had, but take any updated headers from the response.
+                auto merged_headers = stale_resource->response_headers();
+                for (auto& it : headers)
+                    merged_headers.set(it.key, it.value);
+                const_cast<Resource&>(*resource).did_load({}, stale_resource->encoded_data(), merged_headers);
+            } else {
+                const_cast<Resource&>(*resource).did_load({}, data, headers);
+            }
+            did_finish_loading_cached_resource(*resource);
         },
-        [=](auto& error) {
+        [this, resource](auto& error) {
             const_cast<Resource&>(*resource).did_fail({}, error);
-        });
+            did_finish_loading_cached_resource(*resource);
+        },
+        move(headers_callback),
+        move(data_callback));
+
+    return resource;
+}
+
+void ResourceLoader::did_finish_loading_cached_resource(const Resource& resource)
+{
+    auto it = m_resource_cache.find(resource.request());
+    if (it == m_resource_cache.end() || it->value.resource.ptr() != &resource)
+        return;
+    if (resource.is_failed() || parse_cache_control(resource).no_store) {
+        m_resource_cache.remove(it);
+        return;
+    }
+    it->value.fetched_at = time(nullptr);
+    evict_from_cache_if_needed();
+}
+
+void ResourceLoader::evict_from_cache_if_needed()
+{
+    size_t cache_size = 0;
+    for (auto& it : m_resource_cache)
+        cache_size += it.value.resource->encoded_data().size();
+
+    while (cache_size > max_cache_size) {
+        // Evict the least recently used resource that nobody but the cache holds on to.
+        // Resources that are still in use wouldn't free any memory anyway.
+        Optional<LoadRequest> victim;
+        u64 oldest_use = NumericLimits<u64>::max();
+        for (auto& it : m_resource_cache) {
+            if (it.value.resource->ref_count() > 1 || !it.value.resource->is_loaded())
+                continue;
+            if (it.value.last_use < oldest_use) {
+                oldest_use = it.value.last_use;
+                victim = it.key;
+            }
+        }
+        if (!victim.has_value())
+            break;
+#ifdef CACHE_DEBUG
+        dbg() << "Evicting cached resource for: " << victim.value().url();
+#endif
+        auto it = m_resource_cache.find(victim.value());
+        cache_size -= it->value.resource->encoded_data().size();
+        m_resource_cache.remove(it);
+    }
+}
+
+class SyncResourceClient final : public ResourceClient {
+public:
+    SyncResourceClient(Resource& resource, Core::EventLoop& loop)
+        : m_loop(loop)
+    {
+        set_resource(&resource);
+    }
 
+    virtual ~SyncResourceClient() override { }
+
+private:
+    virtual void resource_did_load() override { m_loop.quit(0); }
+    virtual void resource_did_fail() override { m_loop.quit(0); }
+
+    Core::EventLoop& m_loop;
+};
+
+RefPtr<Resource> ResourceLoader::load_resource_sync(Resource::Type type, const LoadRequest& request)
+{
+    // Going through the resource cache means this picks up loads that were started ahead of time.
+    auto resource = load_resource(type, request);
+    if (!resource || resource->is_loaded() || resource->is_failed())
+        return resource;
+
+    Core::EventLoop loop;
+    SyncResourceClient client(*resource, loop);
+    loop.exec();
     return resource;
 }
 
 void ResourceLoader::load(const URL& url, Function<void(const ByteBuffer&, const HashMap<String, String, CaseInsensitiveStringTraits>& response_headers)> success_callback, Function<void(const String&)> error_callback)
+{
+    load(
+        url, {}, [success_callback = move(success_callback)](auto& data, auto& response_headers, auto) {
+            success_callback(data, response_headers);
+        },
+        move(error_callback));
+}
+
+void ResourceLoader::load(const URL& url, const HashMap<String, String>& request_headers, Function<void(const ByteBuffer&, const HashMap<String, String, CaseInsensitiveStringTraits>& response_headers, Optional<u32> status_code)> success_callback, Function<void(const String&)> error_callback, Function<void(const HashMap<String, String, CaseInsensitiveStringTraits>& response_headers, Optional<u32> status_code)> headers_callback, Function<void(const ByteBuffer&)> data_callback)
 {
     if (is_port_blocked(url.port())) {
         dbg() << "ResourceLoader::load: Error: blocked port " << url.port() << " for URL: " << url;
@@ -117,7 +293,7 @@ void ResourceLoader::load(const URL& url, Function<void(const ByteBuffer&, const
     if (url.protocol() == "about") {
         dbg() << "Loading about: URL " << url;
         deferred_invoke([success_callback = move(success_callback)](auto&) {
-            success_callback(ByteBuffer::wrap(const_cast<char*>(String::empty().characters()), 1), {});
+            success_callback(ByteBuffer::wrap(const_cast<char*>(String::empty().characters()), 1), {}, {});
         });
         return;
     }
@@ -132,7 +308,7 @@ void ResourceLoader::load(const URL& url, Function<void(const ByteBuffer&, const
             data = url.data_payload().to_byte_buffer();
 
         deferred_invoke([data = move(data), success_callback = move(success_callback)](auto&) {
-            success_callback(data, {});
+            success_callback(data, {}, {});
         });
         return;
     }
@@ -149,20 +325,23 @@ void ResourceLoader::load(const URL& url, Function<void(const ByteBuffer&, const
 
         auto data = f->read_all();
         deferred_invoke([data = move(data), success_callback = move(success_callback)](auto&) {
-            success_callback(data, {});
+            success_callback(data, {}, {});
         });
         return;
     }
 
     if (url.protocol() == "http" || url.protocol() == "https" || url.protocol() == "gemini") {
-        HashMap<String, String> headers;
+        auto headers = request_headers;
         headers.set("User-Agent", m_user_agent);
-        auto download = protocol_client().start_download(url.to_string(), headers);
+        bool stream_response = headers_callback || data_callback;
+        auto download = protocol_client().start_download(url.to_string(), headers, stream_response);
         if (!download) {
             if (error_callback)
                 error_callback("Failed to initiate load");
             return;
         }
+        download->on_headers_received = move(headers_callback);
+        download->on_data_received = move(data_callback);
         download->on_finish = [this, success_callback = move(success_callback), error_callback = move(error_callback)](bool success, const ByteBuffer& payload, auto, auto& response_headers, auto status_code) {
             --m_pending_loads;
             if (on_load_counter_change)
@@ -177,7 +356,7 @@ void ResourceLoader::load(const URL& url, Function<void(const ByteBuffer&, const
                     error_callback(String::format("HTTP error (%u)", status_code.value()));
                 return;
             }
-            success_callback(ByteBuffer::copy(payload.data(), payload.size()), response_headers);
+            success_callback(ByteBuffer::copy(payload.data(), payload.size()), response_headers, status_code);
         };
         download->on_certificate_requested = []() -> Protocol::Download::CertificateAndKey {
             return {};
@@ -210,6 +389,7 @@ void ResourceLoader::save_to(JsonObject& object)
     Object::save_to(object);
     object.set("pending_loads", m_pending_loads);
     object.set("user_agent", m_user_agent);
+    object.set("cached_resources", m_resource_cache.size());
 }
 
 }
@@ -30,6 +30,7 @@
 #include <AK/URL.h>
 #include <LibCore/Object.h>
 #include <LibWeb/Loader/Resource.h>
+#include <time.h>
 
 namespace Protocol {
 class Client;
@@ -42,7 +43,9 @@ class ResourceLoader : public Core::Object {
 public:
     static ResourceLoader& the();
 
-    RefPtr<Resource> load_resource(Resource::Type, const LoadRequest&);
+    // With stream_response, clients are also told about the response body as it arrives, see Resource::received_data().
+    RefPtr<Resource> load_resource(Resource::Type, const LoadRequest&, bool stream_response = false);
+    RefPtr<Resource> load_resource_sync(Resource::Type, const LoadRequest&);
 
     void load(const URL&, Function<void(const ByteBuffer&, const HashMap<String, String, CaseInsensitiveStringTraits>& response_headers)> success_callback, Function<void(const String&)> error_callback = nullptr);
     void load_sync(const URL&, Function<void(const ByteBuffer&, const HashMap<String, String, CaseInsensitiveStringTraits>& response_headers)> success_callback, Function<void(const String&)> error_callback = nullptr);
@@ -59,6 +62,27 @@ private:
     ResourceLoader();
     static bool is_port_blocked(int port);
 
+    void load(const URL&, const HashMap<String, String>& request_headers, Function<void(const ByteBuffer&, const HashMap<String, String, CaseInsensitiveStringTraits>& response_headers, Optional<u32> status_code)> success_callback, Function<void(const String&)> error_callback, Function<void(const HashMap<String, String, CaseInsensitiveStringTraits>& response_headers, Optional<u32> status_code)> headers_callback = nullptr, Function<void(const ByteBuffer&)> data_callback = nullptr);
+
+    struct CachedResource {
+        NonnullRefPtr<Resource> resource;
+        u64 last_use { 0 };
+        time_t fetched_at { 0 };
+    };
+
+    bool is_fresh(const CachedResource&) const;
+    void did_finish_loading_cached_resource(const Resource&);
+    void evict_from_cache_if_needed();
+
+    // Resources that only the cache holds on to are evicted once their encoded data adds up to more than this.
+    static constexpr size_t max_cache_size = 32 * 1024 * 1024;
+
+    // How long an HTTP response without an explicit Cache-Control max-age counts as fresh.
+    static constexpr time_t heuristic_freshness_lifetime = 5 * 60;
+
+    HashMap<LoadRequest, CachedResource> m_resource_cache;
+    u64 m_cache_use_counter { 0 };
+
     virtual void save_to(JsonObject&) override;
 
     int m_pending_loads { 0 };
@@ -246,8 +246,7 @@ bool EventHandler::handle_keydown(KeyCode key, unsigned, u32 code_point)
             builder.append(text_node.data().substring_view(m_frame.cursor_position().offset(), text_node.data().length() - m_frame.cursor_position().offset()));
             text_node.set_data(builder.to_string());
             m_frame.set_cursor_position({ *m_frame.cursor_position().node(), m_frame.cursor_position().offset() - 1 });
-            // FIXME: This should definitely use incremental layout invalidation instead!
-            text_node.document().force_layout();
+            text_node.document().update_layout();
             return true;
         }
 
@@ -260,8 +259,7 @@ bool EventHandler::handle_keydown(KeyCode key, unsigned, u32 code_point)
             text_node.set_data(builder.to_string());
             // FIXME: This will advance the cursor incorrectly when inserting multiple whitespaces (DOM vs layout whitespace collapse difference.)
             m_frame.set_cursor_position({ *m_frame.cursor_position().node(), m_frame.cursor_position().offset() + 1 });
-            // FIXME: This should definitely use incremental layout invalidation instead!
-            text_node.document().force_layout();
+            text_node.document().update_layout();
             return true;
         }
     }
@@ -89,8 +89,11 @@ void Frame::set_size(const Gfx::IntSize& size)
     if (m_size == size)
         return;
     m_size = size;
-    if (m_document)
+    if (m_document) {
+        if (auto* layout_root = m_document->layout_node())
+            layout_root->set_needs_layout();
         m_document->layout();
+    }
 }
 
 void Frame::set_viewport_rect(const Gfx::IntRect& rect)
@@ -110,7 +110,7 @@ void PageView::select_all()
         last_layout_node_index_in_node = downcast<LayoutText>(*last_layout_node).text_for_rendering().length() - 1;
 
     layout_root->selection().set({ first_layout_node, 0 }, { last_layout_node, last_layout_node_index_in_node });
-    update();
+    invalidate_backing_store();
 }
 
 String PageView::selected_text() const
@@ -137,7 +137,7 @@ void PageView::page_did_set_document_in_main_frame(DOM::Document* document)
         on_set_document(document);
     layout_and_sync_size();
     scroll_to_top();
-    update();
+    invalidate_backing_store();
 }
 
 void PageView::page_did_start_loading(const URL& url)
@@ -148,7 +148,7 @@ void PageView::page_did_start_loading(const URL& url)
 
 void PageView::page_did_change_selection()
 {
-    update();
+    invalidate_backing_store();
 }
 
 void PageView::page_did_request_cursor_change(GUI::StandardCursor cursor)
@@ -203,9 +203,10 @@ void PageView::page_did_unhover_link()
         on_link_hover({});
 }
 
-void PageView::page_did_invalidate(const Gfx::IntRect&)
+void PageView::page_did_invalidate(const Gfx::IntRect& content_rect)
 {
-    update();
+    m_backing_store_damage.add(content_rect);
+    update(Gfx::IntRect(to_widget_position(content_rect.location()), content_rect.size()).intersected(widget_inner_rect()));
 }
 
 void PageView::page_did_change_favicon(const Gfx::Bitmap& bitmap)
@@ -235,6 +236,7 @@ void PageView::layout_and_sync_size()
     }
 
     page().main_frame().set_viewport_rect(viewport_rect_in_content_coordinates());
+    invalidate_backing_store();
 
 #ifdef HTML_DEBUG
     dbgprintf("\033[33;1mLayout tree after layout:\033[0m\n");
@@ -248,6 +250,91 @@ void PageView::resize_event(GUI::ResizeEvent& event)
     layout_and_sync_size();
 }
 
+void PageView::invalidate_backing_store()
+{
+    m_backing_store_needs_full_repaint = true;
+    update();
+}
+
+bool PageView::can_scroll_backing_store() const
+{
+    // The document background image is painted relative to the viewport, and so are
+    // fixed position boxes, so their pixels don't move along with the rest of the page.
+    if (document()->background_image())
+        return false;
+    return !layout_root()->has_fixed_position_boxes();
+}
+
+void PageView::paint_into_backing_store(const Gfx::IntRect& content_rect)
+{
+    Gfx::IntPoint scroll_offset { horizontal_scrollbar().value(), vertical_scrollbar().value() };
+
+    Gfx::Painter painter(*m_backing_store);
+    painter.add_clip_rect(content_rect.translated(-scroll_offset.x(), -scroll_offset.y()));
+
+    painter.fill_rect(m_backing_store->rect(), document()->background_color(palette()));
+
+    if (auto background_bitmap = document()->background_image()) {
+        painter.draw_tiled_bitmap(m_backing_store->rect(), *background_bitmap);
+    }
+
+    painter.translate(-scroll_offset.x(), -scroll_offset.y());
+
+    PaintContext context(painter, palette(), scroll_offset);
+    context.set_should_show_line_box_borders(m_should_show_line_box_borders);
+    context.set_viewport_rect(viewport_rect_in_content_coordinates());
+    context.set_dirty_rect(content_rect);
+    layout_root()->paint_all_phases(context);
+}
+
+void PageView::update_backing_store()
+{
+    auto size = widget_inner_rect().size();
+    Gfx::IntPoint scroll_offset { horizontal_scrollbar().value(), vertical_scrollbar().value() };
+
+    if (!m_backing_store || m_backing_store->size() != size) {
+        m_backing_store = Gfx::Bitmap::create(Gfx::BitmapFormat::RGB32, size);
+        m_backing_store_needs_full_repaint = true;
+    }
+
+    auto delta = scroll_offset - m_backing_store_scroll_offset;
+    m_backing_store_scroll_offset = scroll_offset;
+    if (!m_backing_store_needs_full_repaint && !delta.is_null()) {
+        if (!can_scroll_backing_store() || abs(delta.x()) >= size.width() || abs(delta.y()) >= size.height()) {
+            m_backing_store_needs_full_repaint = true;
+        } else {
+            auto scrolled_backing_store = Gfx::Bitmap::create(Gfx::BitmapFormat::RGB32, size);
+            Gfx::Painter painter(*scrolled_backing_store);
+            painter.blit({ -delta.x(), -delta.y() }, *m_backing_store, m_backing_store->rect());
+            m_backing_store = move(scrolled_backing_store);
+
+            auto viewport_rect = viewport_rect_in_content_coordinates();
+            if (delta.y() > 0)
+                m_backing_store_damage.add({ viewport_rect.x(), viewport_rect.bottom() + 1 - delta.y(), viewport_rect.width(), delta.y() });
+            else if (delta.y() < 0)
+                m_backing_store_damage.add({ viewport_rect.x(), viewport_rect.y(), viewport_rect.width(), -delta.y() });
+            if (delta.x() > 0)
+                m_backing_store_damage.add({ viewport_rect.right() + 1 - delta.x(), viewport_rect.y(), delta.x(), viewport_rect.height() });
+            else if (delta.x() < 0)
+                m_backing_store_damage.add({ viewport_rect.x(), viewport_rect.y(), -delta.x(), viewport_rect.height() });
+        }
+    }
+
+    if (m_backing_store_needs_full_repaint) {
+        m_backing_store_damage.clear();
+        m_backing_store_damage.add(viewport_rect_in_content_coordinates());
+        m_backing_store_needs_full_repaint = false;
+    }
+
+    auto viewport_rect = viewport_rect_in_content_coordinates();
+    for (auto& rect : m_backing_store_damage.rects()) {
+        auto dirty_rect = rect.intersected(viewport_rect);
+        if (!dirty_rect.is_empty())
+            paint_into_backing_store(dirty_rect);
+    }
+    m_backing_store_damage.clear();
+}
+
 void PageView::paint_event(GUI::PaintEvent& event)
 {
     GUI::Frame::paint_event(event);
@@ -256,24 +343,23 @@ void PageView::paint_event(GUI::PaintEvent& event)
     painter.add_clip_rect(widget_inner_rect());
     painter.add_clip_rect(event.rect());
 
-    if (!layout_root()) {
+    if (!layout_root() || widget_inner_rect().is_empty()) {
         painter.fill_rect(event.rect(), palette().color(background_role()));
         return;
     }
 
-    painter.fill_rect(event.rect(), document()->background_color(palette()));
-
-    if (auto background_bitmap = document()->background_image()) {
-        painter.draw_tiled_bitmap(event.rect(), *background_bitmap);
+    update_backing_store();
+    if (!m_backing_store) {
+        painter.fill_rect(event.rect(), palette().color(background_role()));
+        return;
     }
+    painter.blit(widget_inner_rect().location(), *m_backing_store, m_backing_store->rect());
+}
 
-    painter.translate(frame_thickness(), frame_thickness());
-    painter.translate(-horizontal_scrollbar().value(), -vertical_scrollbar().value());
-
-    PaintContext context(painter, palette(), { horizontal_scrollbar().value(), vertical_scrollbar().value() });
-    context.set_should_show_line_box_borders(m_should_show_line_box_borders);
-    context.set_viewport_rect(viewport_rect_in_content_coordinates());
-    layout_root()->paint_all_phases(context);
+void PageView::theme_change_event(GUI::ThemeChangeEvent& event)
+{
+    GUI::ScrollableWidget::theme_change_event(event);
+    invalidate_backing_store();
 }
 
 void PageView::mousemove_event(GUI::MouseEvent& event)
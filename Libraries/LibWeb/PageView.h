@@ -28,6 +28,7 @@
 
 #include <AK/URL.h>
 #include <LibGUI/ScrollableWidget.h>
+#include <LibGfx/DisjointRectSet.h>
 #include <LibWeb/DOM/Document.h>
 #include <LibWeb/Page/Page.h>
 #include <LibWeb/WebViewHooks.h>
@@ -59,7 +60,11 @@ public:
 
     URL url() const;
 
-    void set_should_show_line_box_borders(bool value) { m_should_show_line_box_borders = value; }
+    void set_should_show_line_box_borders(bool value)
+    {
+        m_should_show_line_box_borders = value;
+        invalidate_backing_store();
+    }
 
     virtual bool accepts_focus() const override { return true; }
 
@@ -82,6 +87,7 @@ private:
     virtual void mouseup_event(GUI::MouseEvent&) override;
     virtual void keydown_event(GUI::KeyEvent&) override;
     virtual void drop_event(GUI::DropEvent&) override;
+    virtual void theme_change_event(GUI::ThemeChangeEvent&) override;
 
     virtual void did_scroll() override;
 
@@ -107,8 +113,20 @@ private:
 
     void layout_and_sync_size();
 
+    void invalidate_backing_store();
+    void update_backing_store();
+    void paint_into_backing_store(const Gfx::IntRect& content_rect);
+    bool can_scroll_backing_store() const;
+
     bool m_should_show_line_box_borders { false };
 
+    // The page as last painted, so that scrolling only needs to shift it and paint the
+    // newly exposed strips, and invalidations only need to repaint what they touched.
+    RefPtr<Gfx::Bitmap> m_backing_store;
+    Gfx::IntPoint m_backing_store_scroll_offset;
+    Gfx::DisjointRectSet m_backing_store_damage;
+    bool m_backing_store_needs_full_repaint { true };
+
     NonnullOwnPtr<Page> m_page;
 
     RefPtr<GUI::Action> m_copy_action;
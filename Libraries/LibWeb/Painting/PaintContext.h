@@ -26,6 +26,7 @@
 
 #pragma once
 
+#include <AK/Optional.h>
 #include <LibGfx/Palette.h>
 #include <LibGfx/Rect.h>
 #include <LibGfx/Forward.h>
@@ -52,11 +53,18 @@ public:
 
     const Gfx::IntPoint& scroll_offset() const { return m_scroll_offset; }
 
+    // The part of the page that needs to be repainted, in content coordinates.
+    // Without one, everything is painted.
+    const Optional<Gfx::IntRect>& dirty_rect() const { return m_dirty_rect; }
+    void set_dirty_rect(const Optional<Gfx::IntRect>& rect) { m_dirty_rect = rect; }
+    bool is_dirty(const Gfx::IntRect& rect) const { return !m_dirty_rect.has_value() || m_dirty_rect.value().intersects(rect); }
+
 private:
     Gfx::Painter& m_painter;
     Palette m_palette;
     Gfx::IntRect m_viewport_rect;
     Gfx::IntPoint m_scroll_offset;
+    Optional<Gfx::IntRect> m_dirty_rect;
     bool m_should_show_line_box_borders { false };
 };
 
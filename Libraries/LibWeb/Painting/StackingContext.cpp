@@ -25,9 +25,12 @@
  */
 
 #include <AK/QuickSort.h>
+#include <LibGfx/Painter.h>
 #include <LibWeb/DOM/Node.h>
+#include <LibWeb/Layout/LayoutBlock.h>
 #include <LibWeb/Layout/LayoutBox.h>
 #include <LibWeb/Layout/LayoutDocument.h>
+#include <LibWeb/Painting/PaintContext.h>
 #include <LibWeb/Painting/StackingContext.h>
 
 namespace Web {
@@ -47,15 +50,69 @@ StackingContext::StackingContext(LayoutBox& box, StackingContext* parent)
     }
 }
 
+static Gfx::IntRect paint_bounds(const LayoutBox& box)
+{
+    auto margin_box = box.box_model().margin_box(box);
+    Gfx::FloatRect rect;
+    rect.set_x(box.absolute_x() - margin_box.left);
+    rect.set_width(box.width() + margin_box.left + margin_box.right);
+    rect.set_y(box.absolute_y() - margin_box.top);
+    rect.set_height(box.height() + margin_box.top + margin_box.bottom);
+
+    // Inline content may overflow the block that holds it.
+    if (is<LayoutBlock>(box) && box.children_are_inline()) {
+        for (auto& line_box : downcast<LayoutBlock>(box).line_boxes()) {
+            for (auto& fragment : line_box.fragments())
+                rect = rect.united(fragment.absolute_rect());
+        }
+    }
+
+    // Leave some room for things like text underlines that are drawn just outside their box.
+    auto bounds = enclosing_int_rect(rect);
+    bounds.inflate(2, 2);
+    return bounds;
+}
+
+void StackingContext::append_to_display_list(LayoutNode& node)
+{
+    if (!node.is_visible())
+        return;
+
+    // Only boxes paint anything themselves; text is painted by the line boxes of its block.
+    if (is<LayoutBox>(node))
+        m_display_list.append(node, paint_bounds(downcast<LayoutBox>(node)));
+
+    node.for_each_child([&](auto& child) {
+        // Children that establish their own stacking context are painted by it.
+        if (child.is_box() && downcast<LayoutBox>(child).stacking_context())
+            return;
+        append_to_display_list(child);
+    });
+}
+
+const DisplayList& StackingContext::ensure_display_list()
+{
+    auto generation = m_box.root().display_list_generation();
+    if (m_display_list_generation.has_value() && m_display_list_generation.value() == generation)
+        return m_display_list;
+
+    m_display_list.clear();
+    append_to_display_list(m_box);
+    m_display_list_generation = generation;
+    return m_display_list;
+}
+
 void StackingContext::paint(PaintContext& context, LayoutNode::PaintPhase phase)
 {
-    if (!m_box.is_root()) {
-        m_box.paint(context, phase);
+    auto& display_list = ensure_display_list();
+    if (m_box.is_fixed_position()) {
+        Gfx::PainterStateSaver saver(context.painter());
+        context.painter().translate(context.scroll_offset());
+        display_list.paint(context, phase, context.scroll_offset());
     } else {
-        // NOTE: LayoutDocument::paint() merely calls StackingContext::paint()
-        //       so we call its base class instead.
-        downcast<LayoutDocument>(m_box).LayoutBlock::paint(context, phase);
+        display_list.paint(context, phase);
     }
+
     for (auto* child : m_children) {
         child->paint(context, phase);
     }
@@ -28,6 +28,7 @@
 
 #include <AK/Vector.h>
 #include <LibWeb/Layout/LayoutNode.h>
+#include <LibWeb/Painting/DisplayList.h>
 
 namespace Web {
 
@@ -46,9 +47,15 @@ public:
     void dump(int indent = 0) const;
 
 private:
+    const DisplayList& ensure_display_list();
+    void append_to_display_list(LayoutNode&);
+
     LayoutBox& m_box;
     StackingContext* const m_parent { nullptr };
     Vector<StackingContext*> m_children;
+
+    DisplayList m_display_list;
+    Optional<u32> m_display_list_generation;
 };
 
 }
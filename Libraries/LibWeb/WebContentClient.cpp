@@ -40,6 +40,7 @@ void WebContentClient::handshake()
     auto response = send_sync<Messages::WebContentServer::Greet>(getpid());
     set_my_client_id(response->client_id());
     set_server_pid(response->server_pid());
+    set_up_shared_memory_transport();
 }
 
 void WebContentClient::handle(const Messages::WebContentClient::DidPaint& message)
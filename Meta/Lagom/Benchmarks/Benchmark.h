@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) 2018-2020, The SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/QuickSort.h>
+#include <AK/Types.h>
+#include <AK/Vector.h>
+#include <chrono>
+#include <math.h>
+
+namespace Benchmarks {
+
+struct Statistics {
+    size_t iterations { 0 };
+    u64 min_ns { 0 };
+    u64 median_ns { 0 };
+    u64 mean_ns { 0 };
+    u64 stddev_ns { 0 };
+};
+
+// Handed to every benchmark. Whatever the benchmark does before calling run() is set-up,
+// and isn't timed.
+class State {
+public:
+    State(size_t warmup_iterations, size_t min_iterations, u64 min_time_ns)
+        : m_warmup_iterations(warmup_iterations)
+        , m_min_iterations(min_iterations)
+        , m_min_time_ns(min_time_ns)
+    {
+    }
+
+    // Runs the body a few times untimed, then times single runs of it until both the
+    // minimum number of iterations and the minimum total time have been reached.
+    template<typename Callback>
+    void run(Callback body)
+    {
+        for (size_t i = 0; i < m_warmup_iterations; ++i)
+            body();
+
+        Vector<u64> samples;
+        u64 total_ns = 0;
+        while (samples.size() < m_min_iterations || total_ns < m_min_time_ns) {
+            auto start = std::chrono::steady_clock::now();
+            body();
+            auto end = std::chrono::steady_clock::now();
+            u64 elapsed_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+            samples.append(elapsed_ns);
+            total_ns += elapsed_ns;
+        }
+
+        quick_sort(samples);
+        m_statistics.iterations = samples.size();
+        m_statistics.min_ns = samples.first();
+        m_statistics.median_ns = samples[samples.size() / 2];
+        m_statistics.mean_ns = total_ns / samples.size();
+        double variance = 0;
+        for (auto sample : samples) {
+            double difference = (double)sample - (double)m_statistics.mean_ns;
+            variance += difference * difference;
+        }
+        m_statistics.stddev_ns = (u64)sqrt(variance / samples.size());
+        m_did_run = true;
+    }
+
+    bool did_run() const { return m_did_run; }
+    const Statistics& statistics() const { return m_statistics; }
+
+private:
+    size_t m_warmup_iterations { 0 };
+    size_t m_min_iterations { 0 };
+    u64 m_min_time_ns { 0 };
+    bool m_did_run { false };
+    Statistics m_statistics;
+};
+
+using BenchmarkFunction = void (*)(State&);
+
+struct Case {
+    const char* name;
+    BenchmarkFunction function;
+};
+
+Vector<Case>& all_cases();
+
+struct Registration {
+    Registration(const char* name, BenchmarkFunction function)
+    {
+        all_cases().append({ name, function });
+    }
+};
+
+// Keeps the compiler from optimizing away a result nobody looks at.
+template<typename T>
+inline void do_not_optimize(const T& value)
+{
+    asm volatile(""
+                 :
+                 : "r"(&value)
+                 : "memory");
+}
+
+// Where the source tree is, for benchmarks that load their inputs from Base/.
+const char* source_directory();
+
+}
+
+#define BENCHMARK(name)                                                           \
+    static void benchmark_##name(Benchmarks::State&);                             \
+    static Benchmarks::Registration registration_##name(#name, benchmark_##name); \
+    static void benchmark_##name(Benchmarks::State& state)
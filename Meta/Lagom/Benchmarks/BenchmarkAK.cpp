@@ -0,0 +1,152 @@
+/*
+ * Copyright (c) 2018-2020, The SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "Benchmark.h"
+#include <AK/HashMap.h>
+#include <AK/JsonArray.h>
+#include <AK/JsonObject.h>
+#include <AK/JsonParser.h>
+#include <AK/String.h>
+#include <AK/StringBuilder.h>
+
+static constexpr int hash_map_size = 100'000;
+
+BENCHMARK(hash_map_insert_int)
+{
+    state.run([] {
+        HashMap<int, int> map;
+        for (int i = 0; i < hash_map_size; ++i)
+            map.set(i * 7, i);
+        Benchmarks::do_not_optimize(map);
+    });
+}
+
+BENCHMARK(hash_map_lookup_int)
+{
+    HashMap<int, int> map;
+    for (int i = 0; i < hash_map_size; ++i)
+        map.set(i * 7, i);
+
+    state.run([&] {
+        int found = 0;
+        for (int i = 0; i < hash_map_size * 2; ++i)
+            found += map.contains(i * 7 / 2);
+        Benchmarks::do_not_optimize(found);
+    });
+}
+
+BENCHMARK(hash_map_insert_string)
+{
+    Vector<String> keys;
+    for (int i = 0; i < hash_map_size; ++i)
+        keys.append(String::format("key-%d", i));
+
+    state.run([&] {
+        HashMap<String, int> map;
+        for (int i = 0; i < hash_map_size; ++i)
+            map.set(keys[i], i);
+        Benchmarks::do_not_optimize(map);
+    });
+}
+
+BENCHMARK(string_builder_append)
+{
+    state.run([] {
+        StringBuilder builder;
+        for (int i = 0; i < 100'000; ++i) {
+            builder.append("Well, hello friends! ");
+            builder.append('x');
+            builder.appendf("%d", i);
+        }
+        auto string = builder.build();
+        Benchmarks::do_not_optimize(string);
+    });
+}
+
+BENCHMARK(string_split)
+{
+    StringBuilder builder;
+    for (int i = 0; i < 50'000; ++i)
+        builder.appendf("field%d,", i);
+    auto line = builder.build();
+
+    state.run([&] {
+        auto parts = line.split(',');
+        Benchmarks::do_not_optimize(parts);
+    });
+}
+
+BENCHMARK(string_compare_and_hash)
+{
+    Vector<String> strings;
+    for (int i = 0; i < 10'000; ++i)
+        strings.append(String::format("/usr/share/some/deeply/nested/path/number/%d", i));
+
+    state.run([&] {
+        unsigned hash = 0;
+        for (size_t i = 1; i < strings.size(); ++i) {
+            hash ^= strings[i].hash();
+            hash += strings[i] == strings[i - 1];
+        }
+        Benchmarks::do_not_optimize(hash);
+    });
+}
+
+static String make_json_document()
+{
+    JsonArray array;
+    for (int i = 0; i < 5'000; ++i) {
+        JsonObject object;
+        object.set("id", i);
+        object.set("name", String::format("process-%d", i));
+        object.set("ratio", i / 3.0);
+        object.set("running", i % 2 == 0);
+        JsonArray children;
+        for (int j = 0; j < 4; ++j)
+            children.append(i * 4 + j);
+        object.set("children", move(children));
+        array.append(move(object));
+    }
+    return array.to_string();
+}
+
+BENCHMARK(json_parse)
+{
+    auto document = make_json_document();
+    state.run([&] {
+        auto value = JsonParser(document).parse();
+        Benchmarks::do_not_optimize(value);
+    });
+}
+
+BENCHMARK(json_serialize)
+{
+    auto value = JsonParser(make_json_document()).parse();
+    state.run([&] {
+        auto string = value.value().to_string();
+        Benchmarks::do_not_optimize(string);
+    });
+}
@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) 2018-2020, The SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "Benchmark.h"
+#include <AK/MappedFile.h>
+#include <AK/String.h>
+#include <LibGfx/Bitmap.h>
+#include <LibGfx/JPGLoader.h>
+#include <LibGfx/PNGLoader.h>
+#include <LibGfx/Painter.h>
+#include <unistd.h>
+
+static MappedFile map_source_file(const char* path)
+{
+    return MappedFile(String::format("%s/%s", Benchmarks::source_directory(), path));
+}
+
+BENCHMARK(png_decode)
+{
+    auto file = map_source_file("Base/res/wallpapers/sunset-retro.png");
+    if (!file.is_valid())
+        return;
+    state.run([&] {
+        auto bitmap = Gfx::load_png_from_memory((const u8*)file.data(), file.size());
+        Benchmarks::do_not_optimize(bitmap);
+    });
+}
+
+BENCHMARK(jpeg_decode)
+{
+    auto file = map_source_file("Base/res/html/misc/jpgsuite_files/oh-lena.jpg");
+    if (!file.is_valid())
+        return;
+    state.run([&] {
+        auto bitmap = Gfx::load_jpg_from_memory((const u8*)file.data(), file.size());
+        Benchmarks::do_not_optimize(bitmap);
+    });
+}
+
+// Gfx::Painter loads the default font from /res, which only exists on Serenity or in a chroot of its root filesystem.
+static bool can_paint()
+{
+    return access("/res/fonts/Katica10.font", R_OK) == 0;
+}
+
+static RefPtr<Gfx::Bitmap> make_bitmap(Gfx::BitmapFormat format, int width, int height)
+{
+    auto bitmap = Gfx::Bitmap::create(format, { width, height });
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x)
+            bitmap->set_pixel(x, y, Color(x, y, x ^ y, format == Gfx::BitmapFormat::RGBA32 ? (x + y) & 0xff : 0xff));
+    }
+    return bitmap;
+}
+
+BENCHMARK(painter_blit_opaque)
+{
+    if (!can_paint())
+        return;
+    auto target = make_bitmap(Gfx::BitmapFormat::RGB32, 1024, 768);
+    auto source = make_bitmap(Gfx::BitmapFormat::RGB32, 256, 256);
+    Gfx::Painter painter(*target);
+    state.run([&] {
+        for (int y = 0; y < 768; y += 256) {
+            for (int x = 0; x < 1024; x += 256)
+                painter.blit({ x, y }, *source, source->rect());
+        }
+    });
+}
+
+BENCHMARK(painter_blit_alpha)
+{
+    if (!can_paint())
+        return;
+    auto target = make_bitmap(Gfx::BitmapFormat::RGB32, 1024, 768);
+    auto source = make_bitmap(Gfx::BitmapFormat::RGBA32, 256, 256);
+    Gfx::Painter painter(*target);
+    state.run([&] {
+        for (int y = 0; y < 768; y += 256) {
+            for (int x = 0; x < 1024; x += 256)
+                painter.blit({ x, y }, *source, source->rect());
+        }
+    });
+}
+
+BENCHMARK(painter_draw_scaled_bitmap)
+{
+    if (!can_paint())
+        return;
+    auto target = make_bitmap(Gfx::BitmapFormat::RGB32, 1024, 768);
+    auto source = make_bitmap(Gfx::BitmapFormat::RGB32, 320, 240);
+    Gfx::Painter painter(*target);
+    state.run([&] {
+        painter.draw_scaled_bitmap(target->rect(), *source, source->rect());
+    });
+}
+
+BENCHMARK(painter_fill_rect)
+{
+    if (!can_paint())
+        return;
+    auto target = make_bitmap(Gfx::BitmapFormat::RGB32, 1024, 768);
+    Gfx::Painter painter(*target);
+    state.run([&] {
+        painter.fill_rect(target->rect(), Color::from_rgb(0x336699));
+        painter.fill_rect({ 10, 10, 500, 500 }, Color(255, 0, 0, 128));
+    });
+}
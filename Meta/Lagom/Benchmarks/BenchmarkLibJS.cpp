@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2018-2020, The SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "Benchmark.h"
+#include <AK/StringBuilder.h>
+#include <LibJS/Interpreter.h>
+#include <LibJS/Lexer.h>
+#include <LibJS/Parser.h>
+#include <LibJS/Runtime/GlobalObject.h>
+
+static String make_program()
+{
+    StringBuilder builder;
+    for (int i = 0; i < 500; ++i) {
+        builder.appendf("function f%d(a, b) {\n", i);
+        builder.append("    let total = 0;\n");
+        builder.append("    for (let i = 0; i < a; ++i) {\n");
+        builder.append("        if (i % 3 === 0) total += b * i; else total -= [i, b, { x: i }].length;\n");
+        builder.append("    }\n");
+        builder.append("    return `${total}:${a}:${b}`;\n");
+        builder.append("}\n");
+    }
+    return builder.build();
+}
+
+BENCHMARK(js_parse)
+{
+    auto source = make_program();
+    state.run([&] {
+        auto parser = JS::Parser(JS::Lexer(source));
+        auto program = parser.parse_program();
+        Benchmarks::do_not_optimize(program);
+    });
+}
+
+BENCHMARK(js_execute)
+{
+    auto source = R"(
+        function fib(n) { return n < 2 ? n : fib(n - 1) + fib(n - 2); }
+        var result = 0;
+        for (var i = 0; i < 20; ++i)
+            result += fib(15);
+        var objects = [];
+        for (var i = 0; i < 2000; ++i)
+            objects.push({ index: i, name: "object" + i });
+        var total = objects.map(function (o) { return o.index * 2; })
+                           .filter(function (n) { return n % 3 === 0; })
+                           .reduce(function (a, b) { return a + b; }, 0);
+    )";
+    auto program = JS::Parser(JS::Lexer(source)).parse_program();
+    auto interpreter = JS::Interpreter::create<JS::GlobalObject>();
+
+    state.run([&] {
+        interpreter->run(interpreter->global_object(), *program);
+        ASSERT(!interpreter->exception());
+    });
+}
@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2018-2020, The SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "Benchmark.h"
+#include <AK/ByteBuffer.h>
+#include <AK/StringBuilder.h>
+#include <LibVT/Terminal.h>
+#include <stdio.h>
+
+class NullTerminalClient final : public VT::TerminalClient {
+public:
+    virtual void beep() override { }
+    virtual void set_window_title(const StringView&) override { }
+    virtual void set_window_progress(int, int) override { }
+    virtual void terminal_did_resize(u16, u16) override { }
+    virtual void terminal_history_changed() override { }
+    virtual void emit(const u8*, size_t) override { }
+};
+
+// Roughly what `cat` of a source file looks like: lines of varying length, some of them wrapping.
+static ByteBuffer make_plain_text()
+{
+    StringBuilder builder;
+    for (int i = 0; i < 40'000; ++i) {
+        for (int j = 0; j < i % 120; ++j)
+            builder.append('a' + (i + j) % 26);
+        builder.append("\r\n");
+    }
+    return builder.to_byte_buffer();
+}
+
+// Roughly what `ls --color` looks like: short runs of text switching between a few SGR colors.
+static ByteBuffer make_colored_text()
+{
+    StringBuilder builder;
+    for (int i = 0; i < 40'000; ++i) {
+        builder.appendf("\033[%d;1mentry%d\033[0m  ", 31 + i % 7, i);
+        if (i % 6 == 5)
+            builder.append("\r\n");
+    }
+    return builder.to_byte_buffer();
+}
+
+static void feed_terminal(Benchmarks::State& state, const ByteBuffer& text)
+{
+    NullTerminalClient client;
+    VT::Terminal terminal(client);
+    terminal.set_size(80, 25);
+    state.run([&] {
+        // Like TerminalWidget, hand over what one read() of the pty master would return at a time.
+        for (size_t i = 0; i < text.size(); i += BUFSIZ)
+            terminal.on_input(text.span().slice(i, min((size_t)BUFSIZ, text.size() - i)));
+        Benchmarks::do_not_optimize(terminal);
+    });
+}
+
+BENCHMARK(terminal_plain_text)
+{
+    feed_terminal(state, make_plain_text());
+}
+
+BENCHMARK(terminal_colored_text)
+{
+    feed_terminal(state, make_colored_text());
+}
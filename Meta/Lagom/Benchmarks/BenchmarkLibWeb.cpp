@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) 2018-2020, The SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "Benchmark.h"
+#include <AK/StringBuilder.h>
+#include <LibWeb/HTML/Parser/HTMLTokenizer.h>
+
+static String make_document()
+{
+    StringBuilder builder;
+    builder.append("<!DOCTYPE html>\n<html><head><title>Benchmark</title>\n");
+    builder.append("<style>body { color: #333; } .row > td { padding: 2px; }</style></head>\n<body>\n");
+    for (int i = 0; i < 2'000; ++i) {
+        builder.appendf("<div class=\"row row-%d\" id='item%d' data-index=%d>\n", i % 7, i, i);
+        builder.appendf("  <a href=\"/items/%d?sort=asc&amp;page=2\">Item &lt;%d&gt; &copy; &#169;</a>\n", i, i);
+        builder.append("  <!-- a comment that the tokenizer has to skip over -->\n");
+        builder.append("  <p>Some <b>bold</b> and <i>italic</i> text, with a <br/> line break.</p>\n");
+        builder.append("</div>\n");
+    }
+    builder.append("<script>for (var i = 0; i < 10; ++i) { if (i < 5 && i > 2) console.log('<tag>'); }</script>\n");
+    builder.append("</body></html>\n");
+    return builder.build();
+}
+
+BENCHMARK(html_tokenize)
+{
+    auto document = make_document();
+    state.run([&] {
+        Web::HTML::HTMLTokenizer tokenizer(document, "utf-8");
+        size_t token_count = 0;
+        for (;;) {
+            auto token = tokenizer.next_token();
+            if (!token.has_value() || token.value().is_end_of_file())
+                break;
+            ++token_count;
+        }
+        Benchmarks::do_not_optimize(token_count);
+    });
+}
@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2018-2020, The SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "Benchmark.h"
+#include <AK/JsonArray.h>
+#include <AK/JsonObject.h>
+#include <AK/String.h>
+#include <LibCore/ArgsParser.h>
+#include <stdio.h>
+
+namespace Benchmarks {
+
+Vector<Case>& all_cases()
+{
+    static Vector<Case> cases;
+    return cases;
+}
+
+const char* source_directory()
+{
+    return SERENITY_SOURCE_DIR;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    const char* filter = nullptr;
+    bool output_json = false;
+    bool list = false;
+    int warmup_iterations = 3;
+    int min_iterations = 10;
+    int min_time_ms = 500;
+
+    Core::ArgsParser args_parser;
+    args_parser.add_option(output_json, "Print the results as JSON", "json", 'j');
+    args_parser.add_option(list, "List the benchmarks and exit", "list", 'l');
+    args_parser.add_option(warmup_iterations, "Untimed runs before measuring", "warmup", 'w', "count");
+    args_parser.add_option(min_iterations, "Minimum number of timed runs", "iterations", 'i', "count");
+    args_parser.add_option(min_time_ms, "Minimum time to spend measuring each benchmark", "min-time", 't', "ms");
+    args_parser.add_positional_argument(filter, "Only run benchmarks matching this glob", "filter", Core::ArgsParser::Required::No);
+    args_parser.parse(argc, argv);
+
+    auto cases = Benchmarks::all_cases();
+    quick_sort(cases, [](auto& a, auto& b) { return strcmp(a.name, b.name) < 0; });
+
+    if (list) {
+        for (auto& benchmark : cases)
+            printf("%s\n", benchmark.name);
+        return 0;
+    }
+
+    if (!output_json)
+        printf("%-28s %10s %12s %12s %12s %12s\n", "benchmark", "iterations", "min (us)", "median (us)", "mean (us)", "stddev (us)");
+
+    JsonArray json_results;
+    for (auto& benchmark : cases) {
+        if (filter && !String(benchmark.name).matches(filter, CaseSensitivity::CaseInsensitive))
+            continue;
+
+        Benchmarks::State state(warmup_iterations, min_iterations, (u64)min_time_ms * 1'000'000);
+        benchmark.function(state);
+        if (!state.did_run()) {
+            fprintf(stderr, "%s: skipped, its input isn't available\n", benchmark.name);
+            continue;
+        }
+
+        auto& statistics = state.statistics();
+        if (output_json) {
+            JsonObject result;
+            result.set("name", benchmark.name);
+            result.set("iterations", statistics.iterations);
+            result.set("min_ns", statistics.min_ns);
+            result.set("median_ns", statistics.median_ns);
+            result.set("mean_ns", statistics.mean_ns);
+            result.set("stddev_ns", statistics.stddev_ns);
+            json_results.append(move(result));
+        } else {
+            printf("%-28s %10zu %12.2f %12.2f %12.2f %12.2f\n", benchmark.name, statistics.iterations,
+                statistics.min_ns / 1000.0, statistics.median_ns / 1000.0, statistics.mean_ns / 1000.0, statistics.stddev_ns / 1000.0);
+            fflush(stdout);
+        }
+    }
+
+    if (output_json)
+        printf("%s\n", json_results.to_string().characters());
+    return 0;
+}
@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <AK/ByteBuffer.h>
+#include <LibCompress/Deflate.h>
+#include <LibCompress/Zlib.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// Compresses the input in uneven pieces and checks that it decompresses back to itself.
+// The first byte picks the compression level and the size of the pieces.
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+    if (size < 1)
+        return 0;
+
+    int level = Compress::DeflateCompressor::min_level + data[0] % Compress::DeflateCompressor::max_level;
+    size_t piece_size = 1 + (data[0] >> 4) * 4096;
+    ReadonlyBytes input { data + 1, size - 1 };
+
+    Compress::ZlibCompressor compressor { level };
+    ByteBuffer compressed;
+    for (size_t offset = 0; offset < input.size(); offset += piece_size) {
+        compressor.write(input.slice(offset, min(piece_size, input.size() - offset)));
+        auto output = compressor.take_output();
+        compressed.append(output.data(), output.size());
+    }
+    compressor.finish();
+    auto output = compressor.take_output();
+    compressed.append(output.data(), output.size());
+
+    auto decompressed = Compress::ZlibDecompressor::decompress_all(compressed.span());
+    ASSERT(decompressed.has_value());
+    ASSERT(decompressed.value().size() == input.size());
+    ASSERT(!memcmp(decompressed.value().data(), input.data(), input.size()));
+    return 0;
+}
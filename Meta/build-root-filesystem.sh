@@ -109,6 +109,12 @@ mknod mnt/dev/hdd b 4 1
 for hd in a b c d; do
     chmod 600 mnt/dev/hd$hd
 done
+mknod mnt/dev/vda b 6 0
+mknod mnt/dev/vdb b 6 1
+chmod 600 mnt/dev/vda mnt/dev/vdb
+mknod mnt/dev/sda b 8 0
+mknod mnt/dev/sdb b 8 1
+chmod 600 mnt/dev/sda mnt/dev/sdb
 
 ln -s /proc/self/fd/0 mnt/dev/stdin
 ln -s /proc/self/fd/1 mnt/dev/stdout
@@ -29,6 +29,7 @@
 #include <AK/SharedBuffer.h>
 #include <AudioServer/AudioClientEndpoint.h>
 #include <LibAudio/Buffer.h>
+#include <LibAudio/StreamRing.h>
 #include <LibCore/EventLoop.h>
 #include <errno.h>
 #include <stdio.h>
@@ -156,6 +157,30 @@ OwnPtr<Messages::AudioServer::GetPlayingBufferResponse> ClientConnection::handle
     return make<Messages::AudioServer::GetPlayingBufferResponse>(id);
 }
 
+OwnPtr<Messages::AudioServer::SetUpStreamResponse> ClientConnection::handle(const Messages::AudioServer::SetUpStream& message)
+{
+    auto shared_buffer = SharedBuffer::create_from_shbuf_id(message.buffer_id());
+    if (!shared_buffer)
+        return make<Messages::AudioServer::SetUpStreamResponse>(false);
+
+    auto stream = Audio::StreamRing::create_with_shared_buffer(shared_buffer.release_nonnull(), message.frame_capacity());
+    if (!stream)
+        return make<Messages::AudioServer::SetUpStreamResponse>(false);
+
+    if (!m_queue)
+        m_queue = m_mixer.create_queue(*this);
+
+    return make<Messages::AudioServer::SetUpStreamResponse>(m_queue->set_stream(stream.release_nonnull()));
+}
+
+OwnPtr<Messages::AudioServer::GetUnderrunCountResponse> ClientConnection::handle(const Messages::AudioServer::GetUnderrunCount&)
+{
+    u32 underruns = 0;
+    if (m_queue)
+        underruns = m_queue->underrun_count();
+    return make<Messages::AudioServer::GetUnderrunCountResponse>(underruns);
+}
+
 OwnPtr<Messages::AudioServer::GetMutedResponse> ClientConnection::handle(const Messages::AudioServer::GetMuted&)
 {
     return make<Messages::AudioServer::GetMutedResponse>(m_mixer.is_muted());
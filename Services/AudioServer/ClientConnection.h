@@ -64,6 +64,8 @@ private:
     virtual OwnPtr<Messages::AudioServer::SetPausedResponse> handle(const Messages::AudioServer::SetPaused&) override;
     virtual OwnPtr<Messages::AudioServer::ClearBufferResponse> handle(const Messages::AudioServer::ClearBuffer&) override;
     virtual OwnPtr<Messages::AudioServer::GetPlayingBufferResponse> handle(const Messages::AudioServer::GetPlayingBuffer&) override;
+    virtual OwnPtr<Messages::AudioServer::SetUpStreamResponse> handle(const Messages::AudioServer::SetUpStream&) override;
+    virtual OwnPtr<Messages::AudioServer::GetUnderrunCountResponse> handle(const Messages::AudioServer::GetUnderrunCount&) override;
     virtual OwnPtr<Messages::AudioServer::GetMutedResponse> handle(const Messages::AudioServer::GetMuted&) override;
     virtual OwnPtr<Messages::AudioServer::SetMutedResponse> handle(const Messages::AudioServer::SetMuted&) override;
 
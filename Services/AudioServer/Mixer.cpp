@@ -24,14 +24,118 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
-#include <AK/BufferStream.h>
 #include <AK/NumericLimits.h>
 #include <AudioServer/ClientConnection.h>
 #include <AudioServer/Mixer.h>
+#include <LibCore/ConfigFile.h>
 #include <pthread.h>
+#include <string.h>
+
+#if ARCH(I386) || ARCH(X86_64)
+#    include <cpuid.h>
+#    include <emmintrin.h>
+#endif
 
 namespace AudioServer {
 
+// The mixer works on a whole period at a time, as interleaved left/right floats. Each queue adds its
+// frames onto the period, then the period is scaled, clamped and converted for the device in one go.
+// The SSE2 versions are picked at runtime. The kernel doesn't save AVX state, so there are no AVX versions.
+
+static bool has_sse2()
+{
+#if ARCH(I386) || ARCH(X86_64)
+    static bool s_has_sse2 = [] {
+        unsigned eax, ebx, ecx, edx;
+        return __get_cpuid(1, &eax, &ebx, &ecx, &edx) && (edx & bit_SSE2);
+    }();
+    return s_has_sse2;
+#else
+    return false;
+#endif
+}
+
+static inline i16 to_i16(float sample, float scale)
+{
+    return max(-1.0f, min(sample * scale, 1.0f)) * NumericLimits<i16>::max();
+}
+
+#if ARCH(I386) || ARCH(X86_64)
+[[gnu::target("sse2")]] static void add_frames_sse2(float* output, const float* frames, size_t float_count)
+{
+    size_t i = 0;
+    for (; i + 4 <= float_count; i += 4)
+        _mm_storeu_ps(output + i, _mm_add_ps(_mm_loadu_ps(output + i), _mm_loadu_ps(frames + i)));
+    for (; i < float_count; ++i)
+        output[i] += frames[i];
+}
+
+[[gnu::target("sse2")]] static void add_samples_sse2(float* output, const Audio::Sample* samples, size_t count)
+{
+    size_t i = 0;
+    for (; i + 2 <= count; i += 2) {
+        auto first = _mm_cvtpd_ps(_mm_loadu_pd(&samples[i].left));
+        auto second = _mm_cvtpd_ps(_mm_loadu_pd(&samples[i + 1].left));
+        auto* out = output + i * 2;
+        _mm_storeu_ps(out, _mm_add_ps(_mm_loadu_ps(out), _mm_movelh_ps(first, second)));
+    }
+    for (; i < count; ++i) {
+        output[i * 2] += samples[i].left;
+        output[i * 2 + 1] += samples[i].right;
+    }
+}
+
+[[gnu::target("sse2")]] static void convert_to_i16_sse2(i16* output, const float* input, size_t float_count, float scale)
+{
+    auto volume = _mm_set1_ps(scale);
+    auto low = _mm_set1_ps(-1.0f);
+    auto high = _mm_set1_ps(1.0f);
+    auto max_value = _mm_set1_ps(NumericLimits<i16>::max());
+    size_t i = 0;
+    for (; i + 8 <= float_count; i += 8) {
+        auto a = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(input + i), volume), low), high);
+        auto b = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(input + i + 4), volume), low), high);
+        auto packed = _mm_packs_epi32(_mm_cvttps_epi32(_mm_mul_ps(a, max_value)), _mm_cvttps_epi32(_mm_mul_ps(b, max_value)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(output + i), packed);
+    }
+    for (; i < float_count; ++i)
+        output[i] = to_i16(input[i], scale);
+}
+#endif
+
+static void add_frames(float* output, const float* frames, size_t frame_count)
+{
+#if ARCH(I386) || ARCH(X86_64)
+    if (has_sse2())
+        return add_frames_sse2(output, frames, frame_count * 2);
+#endif
+    for (size_t i = 0; i < frame_count * 2; ++i)
+        output[i] += frames[i];
+}
+
+static void add_samples(float* output, const Audio::Sample* samples, size_t count)
+{
+#if ARCH(I386) || ARCH(X86_64)
+    if (has_sse2())
+        return add_samples_sse2(output, samples, count);
+#endif
+    for (size_t i = 0; i < count; ++i) {
+        output[i * 2] += samples[i].left;
+        output[i * 2 + 1] += samples[i].right;
+    }
+}
+
+static void convert_to_i16(i16* output, const float* input, size_t frame_count, int volume)
+{
+    float scale = (float)volume / 100.0f;
+#if ARCH(I386) || ARCH(X86_64)
+    if (has_sse2())
+        return convert_to_i16_sse2(output, input, frame_count * 2, scale);
+#endif
+    for (size_t i = 0; i < frame_count * 2; ++i)
+        output[i] = to_i16(input[i], scale);
+}
+
 Mixer::Mixer()
     : m_device(Core::File::construct("/dev/audio", this))
     , m_sound_thread(
@@ -46,11 +150,15 @@ Mixer::Mixer()
         return;
     }
 
+    // A shorter period means less latency between a client writing a frame and it being heard,
+    // at the cost of more wakeups.
+    auto config = Core::ConfigFile::get_for_system("AudioServer");
+    int period_frames = config->read_num_entry("Mixer", "PeriodFrames", max_period_frames);
+    m_period_frames = max<int>(min_period_frames, min<int>(period_frames, max_period_frames));
+
     pthread_mutex_init(&m_pending_mutex, nullptr);
     pthread_cond_init(&m_pending_cond, nullptr);
 
-    m_zero_filled_buffer = (u8*)malloc(4096);
-    bzero(m_zero_filled_buffer, 4096);
     m_sound_thread.start();
 }
 
@@ -72,6 +180,9 @@ void Mixer::mix()
 {
     decltype(m_pending_mixing) active_mix_queues;
 
+    float mixed_buffer[max_period_frames * 2];
+    i16 output_buffer[max_period_frames * 2];
+
     for (;;) {
         if (active_mix_queues.is_empty()) {
             pthread_mutex_lock(&m_pending_mutex);
@@ -82,8 +193,8 @@ void Mixer::mix()
 
         active_mix_queues.remove_all_matching([&](auto& entry) { return !entry->client(); });
 
-        Audio::Sample mixed_buffer[1024];
-        auto mixed_buffer_length = (int)(sizeof(mixed_buffer) / sizeof(Audio::Sample));
+        size_t frame_count = m_period_frames;
+        memset(mixed_buffer, 0, frame_count * 2 * sizeof(float));
 
         // Mix the buffers together into the output
         for (auto& queue : active_mix_queues) {
@@ -91,44 +202,16 @@ void Mixer::mix()
                 queue->clear();
                 continue;
             }
-
-            for (int i = 0; i < mixed_buffer_length; ++i) {
-                auto& mixed_sample = mixed_buffer[i];
-                Audio::Sample sample;
-                if (!queue->get_next_sample(sample))
-                    break;
-                mixed_sample += sample;
-            }
+            queue->mix_into(mixed_buffer, frame_count);
         }
 
-        bool muted = m_muted;
-
         // output the mixed stuff to the device
-        u8 raw_buffer[4096];
-        auto buffer = ByteBuffer::wrap(muted ? m_zero_filled_buffer : raw_buffer, sizeof(raw_buffer));
-
-        BufferStream stream(buffer);
-        if (!muted) {
-            for (int i = 0; i < mixed_buffer_length; ++i) {
-                auto& mixed_sample = mixed_buffer[i];
-
-                mixed_sample.scale(m_main_volume);
-                mixed_sample.clip();
+        if (m_muted)
+            memset(output_buffer, 0, frame_count * 2 * sizeof(i16));
+        else
+            convert_to_i16(output_buffer, mixed_buffer, frame_count, m_main_volume);
 
-                i16 out_sample;
-                out_sample = mixed_sample.left * NumericLimits<i16>::max();
-                stream << out_sample;
-
-                ASSERT(!stream.at_end()); // we should have enough space for both channels in one buffer!
-                out_sample = mixed_sample.right * NumericLimits<i16>::max();
-                stream << out_sample;
-            }
-        }
-
-        if (stream.offset() != 0) {
-            buffer.trim(stream.offset());
-        }
-        m_device->write(buffer);
+        m_device->write(reinterpret_cast<const u8*>(output_buffer), frame_count * 2 * sizeof(i16));
     }
 }
 
@@ -160,4 +243,56 @@ void BufferQueue::enqueue(NonnullRefPtr<Audio::Buffer>&& buffer)
     m_remaining_samples += buffer->sample_count();
     m_queue.enqueue(move(buffer));
 }
+
+bool BufferQueue::set_stream(NonnullRefPtr<Audio::StreamRing>&& stream)
+{
+    if (m_stream)
+        return false;
+    m_stream = move(stream);
+    m_active_stream.store(m_stream.ptr(), AK::memory_order_release);
+    return true;
+}
+
+size_t BufferQueue::mix_into(float* output, size_t frame_count)
+{
+    if (m_paused) {
+        m_was_playing = false;
+        return 0;
+    }
+
+    size_t mixed = 0;
+    if (auto* stream = m_active_stream.load(AK::memory_order_acquire)) {
+        stream->read(frame_count, [&](const float* frames, size_t count) {
+            add_frames(output + mixed * 2, frames, count);
+            mixed += count;
+        });
+    }
+
+    while (mixed < frame_count) {
+        while (!m_current && !m_queue.is_empty())
+            m_current = m_queue.dequeue();
+
+        if (!m_current)
+            break;
+
+        size_t count = min(frame_count - mixed, (size_t)(m_current->sample_count() - m_position));
+        add_samples(output + mixed * 2, m_current->samples() + m_position, count);
+        mixed += count;
+        m_position += count;
+        m_remaining_samples -= count;
+        m_played_samples += count;
+
+        if (m_position >= m_current->sample_count()) {
+            m_client->did_finish_playing_buffer({}, m_current->shbuf_id());
+            m_current = nullptr;
+            m_position = 0;
+        }
+    }
+
+    // Running dry in the middle of playback means the client didn't keep up, and there will be a gap.
+    if (mixed < frame_count && m_was_playing)
+        m_underruns.fetch_add(1, AK::memory_order_relaxed);
+    m_was_playing = mixed == frame_count;
+    return mixed;
+}
 }
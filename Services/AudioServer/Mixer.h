@@ -27,6 +27,7 @@
 #pragma once
 
 #include "ClientConnection.h"
+#include <AK/Atomic.h>
 #include <AK/Badge.h>
 #include <AK/ByteBuffer.h>
 #include <AK/NonnullRefPtrVector.h>
@@ -34,6 +35,7 @@
 #include <AK/RefCounted.h>
 #include <AK/WeakPtr.h>
 #include <LibAudio/Buffer.h>
+#include <LibAudio/StreamRing.h>
 #include <LibCore/File.h>
 #include <LibThread/Lock.h>
 #include <LibThread/Thread.h>
@@ -50,28 +52,15 @@ public:
     bool is_full() const { return m_queue.size() >= 3; }
     void enqueue(NonnullRefPtr<Audio::Buffer>&&);
 
-    bool get_next_sample(Audio::Sample& sample)
-    {
-        if (m_paused)
-            return false;
-
-        while (!m_current && !m_queue.is_empty())
-            m_current = m_queue.dequeue();
-
-        if (!m_current)
-            return false;
+    // Adds up to `frame_count` frames, as interleaved left/right floats, onto `output`.
+    // Returns how many frames this queue had to offer.
+    size_t mix_into(float* output, size_t frame_count);
 
-        sample = m_current->samples()[m_position++];
-        --m_remaining_samples;
-        ++m_played_samples;
+    // The stream can only be set up once, since the mixer thread may be reading from it at any time.
+    bool set_stream(NonnullRefPtr<Audio::StreamRing>&&);
+    bool has_stream() const { return m_stream; }
 
-        if (m_position >= m_current->sample_count()) {
-            m_client->did_finish_playing_buffer({}, m_current->shbuf_id());
-            m_current = nullptr;
-            m_position = 0;
-        }
-        return true;
-    }
+    u32 underrun_count() const { return m_underruns.load(AK::memory_order_relaxed); }
 
     ClientConnection* client() { return m_client.ptr(); }
 
@@ -106,6 +95,11 @@ private:
     int m_remaining_samples{ 0 };
     int m_played_samples{ 0 };
     bool m_paused{ false };
+    bool m_was_playing { false };
+    Atomic<u32> m_underruns { 0 };
+    RefPtr<Audio::StreamRing> m_stream;
+    // What the mixer thread looks at, published once m_stream is set.
+    Atomic<Audio::StreamRing*> m_active_stream { nullptr };
     WeakPtr<ClientConnection> m_client;
 };
 
@@ -123,6 +117,12 @@ public:
     bool is_muted() const { return m_muted; }
     void set_muted(bool);
 
+    // The sound card plays from a 1024 frame buffer, so a longer period would only add latency.
+    static constexpr size_t max_period_frames = 1024;
+    static constexpr size_t min_period_frames = 64;
+
+    size_t period_frames() const { return m_period_frames; }
+
 private:
     Vector<NonnullRefPtr<BufferQueue>> m_pending_mixing;
     pthread_mutex_t m_pending_mutex;
@@ -135,7 +135,7 @@ private:
     bool m_muted{ false };
     int m_main_volume{ 100 };
 
-    u8* m_zero_filled_buffer{ nullptr };
+    size_t m_period_frames { max_period_frames };
 
     void mix();
 };
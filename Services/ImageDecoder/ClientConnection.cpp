@@ -30,7 +30,9 @@
 #include <ImageDecoder/ImageDecoderClientEndpoint.h>
 #include <LibGfx/Bitmap.h>
 #include <LibGfx/ImageDecoder.h>
+#include <LibGfx/ShareableBitmap.h>
 #include <LibGfx/SystemTheme.h>
+#include <LibThread/ThreadPool.h>
 
 namespace ImageDecoder {
 
@@ -58,9 +60,9 @@ OwnPtr<Messages::ImageDecoderServer::GreetResponse> ClientConnection::handle(con
     return make<Messages::ImageDecoderServer::GreetResponse>(client_id(), getpid());
 }
 
-OwnPtr<Messages::ImageDecoderServer::DecodeImageResponse> ClientConnection::handle(const Messages::ImageDecoderServer::DecodeImage& message)
+RefPtr<SharedBuffer> ClientConnection::map_encoded_buffer(i32 shbuf_id, size_t encoded_size)
 {
-    auto encoded_buffer = SharedBuffer::create_from_shbuf_id(message.encoded_shbuf_id());
+    auto encoded_buffer = SharedBuffer::create_from_shbuf_id(shbuf_id);
     if (!encoded_buffer) {
 #ifdef IMAGE_DECODER_DEBUG
         dbg() << "Could not map encoded data buffer";
@@ -68,7 +70,7 @@ OwnPtr<Messages::ImageDecoderServer::DecodeImageResponse> ClientConnection::hand
         return nullptr;
     }
 
-    if (message.encoded_size() > (size_t)encoded_buffer->size()) {
+    if (encoded_size > (size_t)encoded_buffer->size()) {
 #ifdef IMAGE_DECODER_DEBUG
         dbg() << "Encoded buffer is smaller than encoded size";
 #endif
@@ -76,27 +78,71 @@ OwnPtr<Messages::ImageDecoderServer::DecodeImageResponse> ClientConnection::hand
     }
 
 #ifdef IMAGE_DECODER_DEBUG
-    dbg() << "Trying to decode " << message.encoded_size() << " bytes of image(?) data in shbuf_id=" << message.encoded_shbuf_id() << " (shbuf size: " << encoded_buffer->size() << ")";
+    dbg() << "Trying to decode " << encoded_size << " bytes of image(?) data in shbuf_id=" << shbuf_id << " (shbuf size: " << encoded_buffer->size() << ")";
 #endif
+    return encoded_buffer;
+}
 
-    auto decoder = Gfx::ImageDecoder::create((const u8*)encoded_buffer->data(), message.encoded_size());
+// This may run on any of the thread pool's threads, so it must not touch the connection.
+static RefPtr<Gfx::Bitmap> decode(const SharedBuffer& encoded_buffer, size_t encoded_size, const Gfx::IntSize& desired_size)
+{
+    auto decoder = Gfx::ImageDecoder::create((const u8*)encoded_buffer.data(), encoded_size);
+    if (!desired_size.is_empty())
+        decoder->set_desired_size(desired_size);
+    decoder->set_decode_into_shareable_bitmap(true);
     auto bitmap = decoder->bitmap();
-
     if (!bitmap) {
 #ifdef IMAGE_DECODER_DEBUG
         dbg() << "Could not decode image from encoded data";
 #endif
-        return make<Messages::ImageDecoderServer::DecodeImageResponse>(-1, Gfx::IntSize(), (i32)Gfx::BitmapFormat::Invalid, Vector<u32>());
+        return nullptr;
     }
 
-    // FIXME: We should fix ShareableBitmap so you can send it in responses as well as requests..
-    m_shareable_bitmap = bitmap->to_bitmap_backed_by_shared_buffer();
-    m_shareable_bitmap->shared_buffer()->share_with(client_pid());
-    Vector<u32> palette;
-    if (m_shareable_bitmap->is_indexed()) {
-        palette = m_shareable_bitmap->palette_to_vector();
+    // Decoders that can't decode into a shared buffer themselves get copied into one here.
+    return bitmap->to_bitmap_backed_by_shared_buffer();
+}
+
+Gfx::ShareableBitmap ClientConnection::share_bitmap(RefPtr<Gfx::Bitmap> bitmap)
+{
+    if (!bitmap)
+        return {};
+    auto shareable_bitmap = bitmap->to_shareable_bitmap(client_pid());
+    if (shareable_bitmap.is_valid())
+        m_shared_bitmaps.set(bitmap->shbuf_id(), move(bitmap));
+    return shareable_bitmap;
+}
+
+OwnPtr<Messages::ImageDecoderServer::DecodeImageResponse> ClientConnection::handle(const Messages::ImageDecoderServer::DecodeImage& message)
+{
+    auto encoded_buffer = map_encoded_buffer(message.encoded_shbuf_id(), message.encoded_size());
+    if (!encoded_buffer)
+        return nullptr;
+
+    auto bitmap = decode(*encoded_buffer, message.encoded_size(), message.desired_size());
+    return make<Messages::ImageDecoderServer::DecodeImageResponse>(share_bitmap(move(bitmap)));
+}
+
+void ClientConnection::handle(const Messages::ImageDecoderServer::DecodeImageAsync& message)
+{
+    auto encoded_buffer = map_encoded_buffer(message.encoded_shbuf_id(), message.encoded_size());
+    if (!encoded_buffer) {
+        post_message(Messages::ImageDecoderClient::DidDecodeImage(message.request_id(), {}));
+        return;
     }
-    return make<Messages::ImageDecoderServer::DecodeImageResponse>(m_shareable_bitmap->shbuf_id(), m_shareable_bitmap->size(), (i32)m_shareable_bitmap->format(), palette);
+
+    size_t encoded_size = message.encoded_size();
+    auto desired_size = message.desired_size();
+    auto future = LibThread::ThreadPool::the().submit<RefPtr<Gfx::Bitmap>>([encoded_buffer = encoded_buffer.release_nonnull(), encoded_size, desired_size] {
+        return decode(encoded_buffer, encoded_size, desired_size);
+    });
+    future->on_complete([this, protector = NonnullRefPtr<ClientConnection>(*this), request_id = message.request_id()](auto& bitmap) {
+        post_message(Messages::ImageDecoderClient::DidDecodeImage(request_id, share_bitmap(move(bitmap))));
+    });
+}
+
+void ClientConnection::handle(const Messages::ImageDecoderServer::DisownSharedBuffer& message)
+{
+    m_shared_bitmaps.remove(message.shbuf_id());
 }
 
 }
@@ -48,8 +48,14 @@ public:
 private:
     virtual OwnPtr<Messages::ImageDecoderServer::GreetResponse> handle(const Messages::ImageDecoderServer::Greet&) override;
     virtual OwnPtr<Messages::ImageDecoderServer::DecodeImageResponse> handle(const Messages::ImageDecoderServer::DecodeImage&) override;
+    virtual void handle(const Messages::ImageDecoderServer::DecodeImageAsync&) override;
+    virtual void handle(const Messages::ImageDecoderServer::DisownSharedBuffer&) override;
 
-    RefPtr<Gfx::Bitmap> m_shareable_bitmap;
+    RefPtr<SharedBuffer> map_encoded_buffer(i32 shbuf_id, size_t encoded_size);
+    Gfx::ShareableBitmap share_bitmap(RefPtr<Gfx::Bitmap>);
+
+    // Decoded bitmaps stay alive here until the client has mapped them and tells us to let go.
+    HashMap<i32, RefPtr<Gfx::Bitmap>> m_shared_bitmaps;
 };
 
 }
@@ -39,6 +39,7 @@ public:
     u32 ttl() const { return m_ttl; }
     const String& record_data() const { return m_record_data; }
 
+    time_t expiration_time() const { return m_expiration_time; }
     bool has_expired() const;
 
 private:
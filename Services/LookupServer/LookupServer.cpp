@@ -28,6 +28,7 @@
 #include "DNSRequest.h"
 #include "DNSResponse.h"
 #include <AK/HashMap.h>
+#include <AK/NumericLimits.h>
 #include <AK/String.h>
 #include <AK/StringBuilder.h>
 #include <LibCore/ConfigFile.h>
@@ -37,13 +38,22 @@
 #include <LibCore/LocalSocket.h>
 #include <LibCore/UDPSocket.h>
 #include <stdio.h>
+#include <time.h>
 #include <unistd.h>
 
+// How long to remember that a name doesn't exist.
+// FIXME: This should come from the SOA record in the authority section, once we parse that.
+static constexpr time_t negative_cache_ttl = 60;
+
+static constexpr int query_timeout_ms = 1000;
+static constexpr size_t max_cached_lookups = 256;
+
 LookupServer::LookupServer()
 {
     auto config = Core::ConfigFile::get_for_system("LookupServer");
     dbg() << "Using network config file at " << config->file_name();
     m_nameserver = config->read_entry("DNS", "Nameserver", "1.1.1.1");
+    m_should_prefetch = config->read_bool_entry("DNS", "Prefetch", true);
 
     load_etc_hosts();
 
@@ -115,113 +125,163 @@ void LookupServer::service_client(RefPtr<Core::LocalSocket> socket)
     auto hostname = String((const char*)client_buffer + 1, nrecv - 1, Chomp);
     dbg() << "Got request for '" << hostname << "' (using IP " << m_nameserver << ")";
 
-    Vector<String> responses;
+    // The socket stays open until we've responded, however long that takes.
+    auto respond = [socket](const Vector<String>& responses) {
+        auto& client = const_cast<Core::LocalSocket&>(*socket);
+        if (responses.is_empty()) {
+            int nsent = client.write("Not found.\n");
+            if (nsent < 0)
+                perror("write");
+            return;
+        }
+        for (auto& response : responses) {
+            auto line = String::format("%s\n", response.characters());
+            int nsent = client.write(line);
+            if (nsent < 0) {
+                perror("write");
+                break;
+            }
+        }
+    };
 
     if (auto known_host = m_etc_hosts.get(hostname); known_host.has_value()) {
+        Vector<String> responses;
         responses.append(known_host.value());
-    } else if (!hostname.is_empty()) {
-        bool did_timeout;
-        int retries = 3;
-        do {
-            did_timeout = false;
-            if (lookup_type == 'L')
-                responses = lookup(hostname, did_timeout, T_A);
-            else if (lookup_type == 'R')
-                responses = lookup(hostname, did_timeout, T_PTR);
-            if (!did_timeout)
-                break;
-        } while (--retries);
-        if (did_timeout) {
-            fprintf(stderr, "LookupServer: Out of retries :(\n");
-            return;
-        }
+        respond(responses);
+        return;
     }
 
-    if (responses.is_empty()) {
-        int nsent = socket->write("Not found.\n");
-        if (nsent < 0)
-            perror("write");
+    if (hostname.is_empty()) {
+        respond({});
         return;
     }
-    for (auto& response : responses) {
-        auto line = String::format("%s\n", response.characters());
-        int nsent = socket->write(line);
-        if (nsent < 0) {
-            perror("write");
-            break;
-        }
-    }
+
+    lookup(hostname, lookup_type == 'L' ? T_A : T_PTR, move(respond));
 }
 
-Vector<String> LookupServer::lookup(const String& hostname, bool& did_timeout, unsigned short record_type, ShouldRandomizeCase should_randomize_case)
+void LookupServer::lookup(const String& hostname, unsigned short record_type, LookupCallback callback)
 {
-    if (auto it = m_lookup_cache.find(hostname); it != m_lookup_cache.end()) {
+    auto key = String::format("%u:%s", record_type, hostname.characters());
+
+    if (auto it = m_lookup_cache.find(key); it != m_lookup_cache.end()) {
         auto& cached_lookup = it->value;
-        if (cached_lookup.question.record_type() == record_type) {
+        auto now = time(nullptr);
+        if (now < cached_lookup.expiration_time) {
             Vector<String> responses;
             for (auto& cached_answer : cached_lookup.answers) {
-                dbg() << "Cache hit: " << hostname << " -> " << cached_answer.record_data() << ", expired: " << cached_answer.has_expired();
-                if (!cached_answer.has_expired()) {
-                    responses.append(cached_answer.record_data());
-                }
+                dbg() << "Cache hit: " << hostname << " -> " << cached_answer.record_data();
+                responses.append(cached_answer.record_data());
             }
-            if (!responses.is_empty())
-                return responses;
+
+            // Refresh names that are still being asked for during the last tenth of their lifetime,
+            // so they are already up to date by the time they would have expired.
+            auto lifetime = cached_lookup.expiration_time - cached_lookup.fetch_time;
+            bool should_prefetch = m_should_prefetch && !cached_lookup.answers.is_empty() && (cached_lookup.expiration_time - now) * 10 <= lifetime;
+            if (should_prefetch && !m_pending_lookups.contains(key))
+                start_lookup(key, hostname, record_type);
+
+            callback(responses);
+            return;
         }
         m_lookup_cache.remove(it);
     }
 
-    DNSRequest request;
-    request.add_question(hostname, record_type, should_randomize_case);
-
-    auto buffer = request.to_byte_buffer();
+    if (auto it = m_pending_lookups.find(key); it != m_pending_lookups.end()) {
+        it->value->callbacks.append(move(callback));
+        return;
+    }
 
-    auto udp_socket = Core::UDPSocket::construct();
-    udp_socket->set_blocking(true);
+    start_lookup(key, hostname, record_type).callbacks.append(move(callback));
+}
 
-    struct timeval timeout {
-        1, 0
-    };
+LookupServer::PendingLookup& LookupServer::start_lookup(const String& key, const String& hostname, unsigned short record_type)
+{
+    auto pending_lookup = make<PendingLookup>();
+    pending_lookup->hostname = hostname;
+    pending_lookup->record_type = record_type;
+    pending_lookup->timer = Core::Timer::create_single_shot(query_timeout_ms, [this, key] { did_time_out(key); });
+
+    auto& lookup = *pending_lookup;
+    m_pending_lookups.set(key, move(pending_lookup));
+    send_query(key, lookup);
+    return lookup;
+}
 
-    int rc = setsockopt(udp_socket->fd(), SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
-    if (rc < 0) {
-        perror("setsockopt(SOL_SOCKET, SO_RCVTIMEO)");
-        return {};
+void LookupServer::send_query(const String& key, PendingLookup& lookup)
+{
+    --lookup.attempts_left;
+    lookup.request = DNSRequest();
+    lookup.request.add_question(lookup.hostname, lookup.record_type, lookup.should_randomize_case);
+
+    // Every attempt gets its own socket, so a late answer to an earlier one can't be mistaken for this one.
+    // If anything fails here, the timer will take care of trying again.
+    lookup.socket = Core::UDPSocket::construct();
+    lookup.socket->set_blocking(false);
+    if (lookup.socket->connect(m_nameserver, 53)) {
+        lookup.socket->on_ready_to_read = [this, key] { did_receive_response(key); };
+        if (!lookup.socket->write(lookup.request.to_byte_buffer()))
+            perror("write");
     }
+    lookup.timer->restart(query_timeout_ms);
+}
+
+void LookupServer::did_time_out(const String& key)
+{
+    auto it = m_pending_lookups.find(key);
+    if (it == m_pending_lookups.end())
+        return;
+    auto& lookup = *it->value;
+    RefPtr<Core::Timer> keeper = lookup.timer;
 
-    if (!udp_socket->connect(m_nameserver, 53))
-        return {};
+    if (lookup.attempts_left <= 0) {
+        fprintf(stderr, "LookupServer: Out of retries :(\n");
+        finish_lookup(key, {});
+        return;
+    }
+    send_query(key, lookup);
+}
 
-    if (!udp_socket->write(buffer))
-        return {};
+void LookupServer::did_receive_response(const String& key)
+{
+    auto it = m_pending_lookups.find(key);
+    if (it == m_pending_lookups.end())
+        return;
+    auto& lookup = *it->value;
+    auto& request = lookup.request;
+    RefPtr<Core::UDPSocket> keeper = lookup.socket;
 
     u8 response_buffer[4096];
-    int nrecv = udp_socket->read(response_buffer, sizeof(response_buffer));
-    if (nrecv == 0)
-        return {};
+    int nrecv = lookup.socket->read(response_buffer, sizeof(response_buffer));
+    if (nrecv <= 0)
+        return;
 
+    // Anything that doesn't answer our question is ignored, and we keep waiting for the real response.
     auto o_response = DNSResponse::from_raw_response(response_buffer, nrecv);
     if (!o_response.has_value())
-        return {};
+        return;
 
     auto& response = o_response.value();
 
     if (response.id() != request.id()) {
         dbgprintf("LookupServer: ID mismatch (%u vs %u) :(\n", response.id(), request.id());
-        return {};
+        return;
     }
 
     if (response.code() == DNSResponse::Code::REFUSED) {
-        if (should_randomize_case == ShouldRandomizeCase::Yes) {
+        if (lookup.should_randomize_case == ShouldRandomizeCase::Yes) {
             // Retry with 0x20 case randomization turned off.
-            return lookup(hostname, did_timeout, record_type, ShouldRandomizeCase::No);
+            lookup.should_randomize_case = ShouldRandomizeCase::No;
+            ++lookup.attempts_left;
+            send_query(key, lookup);
+            return;
         }
-        return {};
+        finish_lookup(key, {});
+        return;
     }
 
     if (response.question_count() != request.question_count()) {
         dbgprintf("LookupServer: Question count (%u vs %u) :(\n", response.question_count(), request.question_count());
-        return {};
+        return;
     }
 
     for (size_t i = 0; i < request.question_count(); ++i) {
@@ -231,29 +291,58 @@ Vector<String> LookupServer::lookup(const String& hostname, bool& did_timeout, u
             dbg() << "Request and response questions do not match";
             dbg() << "   Request: {_" << request_question.name() << "_, " << request_question.record_type() << ", " << request_question.class_code() << "}";
             dbg() << "  Response: {_" << response_question.name() << "_, " << response_question.record_type() << ", " << response_question.class_code() << "}";
-            return {};
+            return;
         }
     }
 
-    if (response.answer_count() < 1) {
-        dbgprintf("LookupServer: Not enough answers (%u) :(\n", response.answer_count());
-        return {};
+    if (response.code() == DNSResponse::Code::NXDOMAIN) {
+        cache_lookup(key, {}, time(nullptr) + negative_cache_ttl);
+        finish_lookup(key, {});
+        return;
+    }
+
+    if (response.code() != DNSResponse::Code::NOERROR) {
+        // The server couldn't tell us, which says nothing about the name itself. Don't cache that.
+        finish_lookup(key, {});
+        return;
     }
 
-    Vector<String, 8> responses;
-    Vector<DNSAnswer, 8> cacheable_answers;
+    Vector<String> responses;
+    Vector<DNSAnswer> cacheable_answers;
+    time_t expiration_time = NumericLimits<time_t>::max();
     for (auto& answer : response.answers()) {
-        if (answer.type() != T_A)
+        if (answer.type() != lookup.record_type)
             continue;
         responses.append(answer.record_data());
-        if (!answer.has_expired())
+        if (!answer.has_expired()) {
             cacheable_answers.append(answer);
+            expiration_time = min(expiration_time, answer.expiration_time());
+        }
     }
 
-    if (!cacheable_answers.is_empty()) {
-        if (m_lookup_cache.size() >= 256)
-            m_lookup_cache.remove(m_lookup_cache.begin());
-        m_lookup_cache.set(hostname, { request.questions()[0], move(cacheable_answers) });
+    if (responses.is_empty()) {
+        // The name exists, but has no records of this type.
+        cache_lookup(key, {}, time(nullptr) + negative_cache_ttl);
+    } else if (!cacheable_answers.is_empty()) {
+        cache_lookup(key, move(cacheable_answers), expiration_time);
     }
-    return responses;
+    finish_lookup(key, responses);
+}
+
+void LookupServer::finish_lookup(const String& key, const Vector<String>& responses)
+{
+    auto it = m_pending_lookups.find(key);
+    ASSERT(it != m_pending_lookups.end());
+    auto lookup = move(it->value);
+    m_pending_lookups.remove(it);
+
+    for (auto& callback : lookup->callbacks)
+        callback(responses);
+}
+
+void LookupServer::cache_lookup(const String& key, Vector<DNSAnswer>&& answers, time_t expiration_time)
+{
+    if (!m_lookup_cache.contains(key) && m_lookup_cache.size() >= max_cached_lookups)
+        m_lookup_cache.remove(m_lookup_cache.begin());
+    m_lookup_cache.set(key, { move(answers), time(nullptr), expiration_time });
 }
@@ -28,8 +28,12 @@
 
 #include "DNSRequest.h"
 #include "DNSResponse.h"
+#include <AK/Function.h>
 #include <AK/HashMap.h>
+#include <AK/NonnullOwnPtr.h>
 #include <LibCore/Object.h>
+#include <LibCore/Timer.h>
+#include <LibCore/UDPSocket.h>
 
 class DNSAnswer;
 
@@ -40,17 +44,42 @@ public:
     LookupServer();
 
 private:
-    void load_etc_hosts();
-    void service_client(RefPtr<Core::LocalSocket>);
-    Vector<String> lookup(const String& hostname, bool& did_timeout, unsigned short record_type, ShouldRandomizeCase = ShouldRandomizeCase::Yes);
+    using LookupCallback = Function<void(const Vector<String>&)>;
 
     struct CachedLookup {
-        DNSQuestion question;
+        // Empty if the name is known not to exist.
         Vector<DNSAnswer> answers;
+        time_t fetch_time { 0 };
+        time_t expiration_time { 0 };
+    };
+
+    // A query that is waiting for the nameserver. Everyone asking for the same name while it's
+    // in flight is added to its callbacks instead of sending another query.
+    struct PendingLookup {
+        String hostname;
+        unsigned short record_type { 0 };
+        ShouldRandomizeCase should_randomize_case { ShouldRandomizeCase::Yes };
+        DNSRequest request;
+        RefPtr<Core::UDPSocket> socket;
+        RefPtr<Core::Timer> timer;
+        int attempts_left { 3 };
+        Vector<LookupCallback> callbacks;
     };
 
+    void load_etc_hosts();
+    void service_client(RefPtr<Core::LocalSocket>);
+    void lookup(const String& hostname, unsigned short record_type, LookupCallback);
+    PendingLookup& start_lookup(const String& key, const String& hostname, unsigned short record_type);
+    void send_query(const String& key, PendingLookup&);
+    void did_receive_response(const String& key);
+    void did_time_out(const String& key);
+    void finish_lookup(const String& key, const Vector<String>& responses);
+    void cache_lookup(const String& key, Vector<DNSAnswer>&&, time_t expiration_time);
+
     RefPtr<Core::LocalServer> m_local_server;
     String m_nameserver;
+    bool m_should_prefetch { true };
     HashMap<String, String> m_etc_hosts;
     HashMap<String, CachedLookup> m_lookup_cache;
+    HashMap<String, NonnullOwnPtr<PendingLookup>> m_pending_lookups;
 };
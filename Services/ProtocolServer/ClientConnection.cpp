@@ -30,6 +30,10 @@
 #include <ProtocolServer/Download.h>
 #include <ProtocolServer/Protocol.h>
 #include <ProtocolServer/ProtocolClientEndpoint.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <sys/socket.h>
+#include <unistd.h>
 
 namespace ProtocolServer {
 
@@ -69,6 +73,23 @@ OwnPtr<Messages::ProtocolServer::StartDownloadResponse> ClientConnection::handle
     auto download = protocol->start_download(*this, url, message.request_headers().entries());
     if (!download)
         return make<Messages::ProtocolServer::StartDownloadResponse>(-1);
+    download->set_should_stream_response(message.stream_response());
+    if (message.stream_response()) {
+        // The client picks up the read end with recvfd() once it has our response.
+        int fds[2];
+        if (pipe(fds) < 0) {
+            perror("pipe");
+        } else {
+            if (sendfd(socket_fd(), fds[0]) < 0) {
+                perror("sendfd");
+                close(fds[1]);
+            } else {
+                fcntl(fds[1], F_SETFL, fcntl(fds[1], F_GETFL) | O_NONBLOCK);
+                download->set_stream_fd(fds[1]);
+            }
+            close(fds[0]);
+        }
+    }
     auto id = download->id();
     m_downloads.set(id, move(download));
     return make<Messages::ProtocolServer::StartDownloadResponse>(id);
@@ -116,6 +137,14 @@ void ClientConnection::did_request_certificates(Badge<Download>, Download& downl
     post_message(Messages::ProtocolClient::CertificateRequested(download.id()));
 }
 
+void ClientConnection::did_receive_download_headers(Badge<Download>, Download& download)
+{
+    IPC::Dictionary response_headers;
+    for (auto& it : download.response_headers())
+        response_headers.add(it.key, it.value);
+    post_message(Messages::ProtocolClient::DownloadHeadersReceived(download.id(), download.status_code(), response_headers));
+}
+
 OwnPtr<Messages::ProtocolServer::GreetResponse> ClientConnection::handle(const Messages::ProtocolServer::Greet&)
 {
     return make<Messages::ProtocolServer::GreetResponse>(client_id());
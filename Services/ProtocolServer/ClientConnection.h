@@ -47,6 +47,7 @@ public:
     void did_finish_download(Badge<Download>, Download&, bool success);
     void did_progress_download(Badge<Download>, Download&);
     void did_request_certificates(Badge<Download>, Download&);
+    void did_receive_download_headers(Badge<Download>, Download&);
 
 private:
     virtual OwnPtr<Messages::ProtocolServer::GreetResponse> handle(const Messages::ProtocolServer::Greet&) override;
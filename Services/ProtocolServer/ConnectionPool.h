@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2018-2020, The SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/Function.h>
+#include <AK/HashMap.h>
+#include <AK/String.h>
+#include <AK/URL.h>
+#include <AK/Vector.h>
+#include <LibCore/Timer.h>
+
+namespace ProtocolServer {
+
+// Keeps connections around after their response has been read, so that the next
+// download from the same host can skip connecting (and for TLS, the handshake).
+template<typename SocketType>
+class ConnectionPool {
+public:
+    // Should call the given function once the connection becomes unusable while idle,
+    // e.g. because the server closed it.
+    using WatchFunction = void (*)(SocketType&, Function<void()>);
+
+    explicit ConnectionPool(WatchFunction watch)
+        : m_watch(watch)
+    {
+    }
+
+    RefPtr<SocketType> take(const URL& url)
+    {
+        auto it = m_idle_connections.find(key_for(url));
+        if (it == m_idle_connections.end() || it->value.is_empty())
+            return nullptr;
+        auto connection = it->value.take_last();
+        connection.idle_timer->stop();
+        return move(connection.socket);
+    }
+
+    void put(const URL& url, NonnullRefPtr<SocketType> socket)
+    {
+        auto key = key_for(url);
+        auto& connections = m_idle_connections.ensure(key);
+        if (connections.size() >= max_idle_connections_per_host)
+            return;
+        auto* socket_ptr = socket.ptr();
+        m_watch(*socket, [this, key, socket_ptr] { evict(key, socket_ptr); });
+        auto idle_timer = Core::Timer::create_single_shot(idle_timeout_ms, [this, key, socket_ptr] { evict(key, socket_ptr); });
+        connections.append({ move(socket), move(idle_timer) });
+    }
+
+private:
+    static constexpr size_t max_idle_connections_per_host = 6;
+    static constexpr int idle_timeout_ms = 10000;
+
+    struct IdleConnection {
+        NonnullRefPtr<SocketType> socket;
+        NonnullRefPtr<Core::Timer> idle_timer;
+    };
+
+    static String key_for(const URL& url)
+    {
+        return String::format("%s:%d", url.host().characters(), url.port());
+    }
+
+    void evict(const String& key, SocketType* socket)
+    {
+        auto it = m_idle_connections.find(key);
+        if (it == m_idle_connections.end())
+            return;
+        auto& connections = it->value;
+        for (size_t i = 0; i < connections.size(); ++i) {
+            if (connections[i].socket.ptr() != socket)
+                continue;
+            auto connection = connections.take(i);
+            connection.idle_timer->stop();
+            // We're called from one of the socket's or the timer's callbacks, so only let go of them afterwards.
+            socket->deferred_invoke([protector = move(connection.socket), idle_timer = move(connection.idle_timer)](auto&) {});
+            return;
+        }
+    }
+
+    WatchFunction m_watch;
+    HashMap<String, Vector<IdleConnection>> m_idle_connections;
+};
+
+}
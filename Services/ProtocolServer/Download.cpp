@@ -27,6 +27,9 @@
 #include <AK/Badge.h>
 #include <ProtocolServer/ClientConnection.h>
 #include <ProtocolServer/Download.h>
+#include <errno.h>
+#include <stdio.h>
+#include <unistd.h>
 
 namespace ProtocolServer {
 
@@ -41,6 +44,7 @@ Download::Download(ClientConnection& client)
 
 Download::~Download()
 {
+    close_stream();
 }
 
 void Download::stop()
@@ -63,11 +67,85 @@ void Download::set_certificate(String, String)
 {
 }
 
+void Download::set_stream_fd(int fd)
+{
+    ASSERT(m_stream_fd == -1);
+    m_stream_fd = fd;
+    m_stream_notifier = Core::Notifier::construct(fd, Core::Notifier::Event::Write);
+    m_stream_notifier->set_enabled(false);
+    m_stream_notifier->on_ready_to_write = [this] { flush_stream(); };
+    did_start_streaming();
+}
+
 void Download::did_finish(bool success)
 {
+    if (m_stream_fd < 0 || !success)
+        return finish(success);
+
+    // Whatever couldn't be passed along as it came in (e.g. encoded content) goes out in one piece.
+    if (!m_payload.is_empty()) {
+        m_stream_queue.append(m_payload);
+        m_streamed_size += m_payload.size();
+        m_payload.clear();
+    }
+    m_total_size = m_streamed_size;
+
+    // Only tell the client we're done once it can read all of the body from the pipe.
+    m_pending_finish = success;
+    flush_stream();
+}
+
+void Download::finish(bool success)
+{
+    close_stream();
     m_client.did_finish_download({}, *this, success);
 }
 
+void Download::flush_stream()
+{
+    while (!m_stream_queue.is_empty()) {
+        auto& buffer = m_stream_queue.first();
+        ssize_t nwritten = write(m_stream_fd, buffer.data() + m_stream_queue_offset, buffer.size() - m_stream_queue_offset);
+        if (nwritten < 0) {
+            if (errno == EINTR)
+                continue;
+            if (errno == EAGAIN) {
+                // The client is behind, so stop pulling data off the network until it catches up.
+                m_stream_notifier->set_enabled(true);
+                set_reading_paused(true);
+                return;
+            }
+            perror("Download: write");
+            close_stream();
+            break;
+        }
+        m_stream_queue_offset += nwritten;
+        if (m_stream_queue_offset == buffer.size()) {
+            m_stream_queue.take_first();
+            m_stream_queue_offset = 0;
+        }
+    }
+
+    if (m_stream_notifier)
+        m_stream_notifier->set_enabled(false);
+    set_reading_paused(false);
+
+    if (m_pending_finish.has_value())
+        finish(m_pending_finish.value());
+}
+
+void Download::close_stream()
+{
+    if (m_stream_fd < 0)
+        return;
+    m_stream_notifier->set_enabled(false);
+    m_stream_notifier = nullptr;
+    close(m_stream_fd);
+    m_stream_fd = -1;
+    m_stream_queue.clear();
+    m_stream_queue_offset = 0;
+}
+
 void Download::did_progress(Optional<u32> total_size, u32 downloaded_size)
 {
     m_total_size = total_size;
@@ -80,4 +158,22 @@ void Download::did_request_certificates()
     m_client.did_request_certificates({}, *this);
 }
 
+void Download::did_receive_headers(Optional<u32> status_code, const HashMap<String, String, CaseInsensitiveStringTraits>& response_headers)
+{
+    if (!m_should_stream_response)
+        return;
+    m_status_code = status_code;
+    m_response_headers = response_headers;
+    m_client.did_receive_download_headers({}, *this);
+}
+
+void Download::did_receive_data(const ByteBuffer& data)
+{
+    if (m_stream_fd < 0 || data.is_empty())
+        return;
+    m_stream_queue.append(data);
+    m_streamed_size += data.size();
+    flush_stream();
+}
+
 }
@@ -31,6 +31,8 @@
 #include <AK/Optional.h>
 #include <AK/RefCounted.h>
 #include <AK/URL.h>
+#include <AK/Vector.h>
+#include <LibCore/Notifier.h>
 #include <ProtocolServer/Forward.h>
 
 namespace ProtocolServer {
@@ -51,6 +53,12 @@ public:
     void stop();
     virtual void set_certificate(String, String);
 
+    bool should_stream_response() const { return m_should_stream_response; }
+    void set_should_stream_response(bool should_stream_response) { m_should_stream_response = should_stream_response; }
+
+    // The body of a streamed response is written into this (nonblocking) pipe as it comes in.
+    void set_stream_fd(int fd);
+
 protected:
     explicit Download(ClientConnection&);
 
@@ -58,10 +66,20 @@ protected:
     void did_progress(Optional<u32> total_size, u32 downloaded_size);
     void set_status_code(u32 status_code) { m_status_code = status_code; }
     void did_request_certificates();
+    void did_receive_headers(Optional<u32> status_code, const HashMap<String, String, CaseInsensitiveStringTraits>&);
+    void did_receive_data(const ByteBuffer&);
     void set_payload(const ByteBuffer&);
     void set_response_headers(const HashMap<String, String, CaseInsensitiveStringTraits>&);
 
+    // Stop (or resume) reading from the network while the client is behind on reading the stream.
+    virtual void set_reading_paused(bool) { }
+    virtual void did_start_streaming() { }
+
 private:
+    void flush_stream();
+    void close_stream();
+    void finish(bool success);
+
     ClientConnection& m_client;
     i32 m_id { 0 };
     URL m_url;
@@ -70,6 +88,13 @@ private:
     size_t m_downloaded_size { 0 };
     ByteBuffer m_payload;
     HashMap<String, String, CaseInsensitiveStringTraits> m_response_headers;
+    bool m_should_stream_response { false };
+    int m_stream_fd { -1 };
+    RefPtr<Core::Notifier> m_stream_notifier;
+    Vector<ByteBuffer> m_stream_queue;
+    size_t m_stream_queue_offset { 0 };
+    size_t m_streamed_size { 0 };
+    Optional<bool> m_pending_finish;
 };
 
 }
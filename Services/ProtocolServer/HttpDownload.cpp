@@ -27,6 +27,7 @@
 #include <LibHTTP/HttpJob.h>
 #include <LibHTTP/HttpResponse.h>
 #include <ProtocolServer/HttpDownload.h>
+#include <ProtocolServer/HttpProtocol.h>
 
 namespace ProtocolServer {
 
@@ -40,6 +41,8 @@ HttpDownload::HttpDownload(ClientConnection& client, NonnullRefPtr<HTTP::HttpJob
             set_payload(response->payload());
             set_response_headers(response->headers());
         }
+        if (success)
+            HttpProtocol::did_finish_job(*m_job);
 
         // if we didn't know the total size, pretend that the download finished successfully
         // and set the total size to the downloaded size
@@ -51,12 +54,31 @@ HttpDownload::HttpDownload(ClientConnection& client, NonnullRefPtr<HTTP::HttpJob
     m_job->on_progress = [this](Optional<u32> total, u32 current) {
         did_progress(total, current);
     };
+    m_job->on_headers_received = [this](auto& response_headers, int response_code) {
+        did_receive_headers(response_code, response_headers);
+    };
+    m_job->on_data_received = [this](auto& data) {
+        did_receive_data(data);
+    };
+}
+
+void HttpDownload::set_reading_paused(bool paused)
+{
+    m_job->set_reading_paused(paused);
+}
+
+void HttpDownload::did_start_streaming()
+{
+    // The body goes straight into the stream, there's no need for the job to hold on to it as well.
+    m_job->set_should_keep_passed_along_data(false);
 }
 
 HttpDownload::~HttpDownload()
 {
     m_job->on_finish = nullptr;
     m_job->on_progress = nullptr;
+    m_job->on_headers_received = nullptr;
+    m_job->on_data_received = nullptr;
     m_job->shutdown();
 }
 
@@ -41,6 +41,9 @@ public:
 private:
     explicit HttpDownload(ClientConnection&, NonnullRefPtr<HTTP::HttpJob>);
 
+    virtual void set_reading_paused(bool) override;
+    virtual void did_start_streaming() override;
+
     NonnullRefPtr<HTTP::HttpJob> m_job;
 };
 
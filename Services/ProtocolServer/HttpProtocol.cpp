@@ -24,13 +24,27 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <LibCore/Socket.h>
 #include <LibHTTP/HttpJob.h>
 #include <LibHTTP/HttpRequest.h>
+#include <ProtocolServer/ConnectionPool.h>
 #include <ProtocolServer/HttpDownload.h>
 #include <ProtocolServer/HttpProtocol.h>
 
 namespace ProtocolServer {
 
+static void watch_idle_connection(Core::Socket& socket, Function<void()> on_unusable)
+{
+    // The server has nothing to say on an idle connection, except that it's closing it.
+    socket.on_ready_to_read = move(on_unusable);
+}
+
+static ConnectionPool<Core::Socket>& connection_pool()
+{
+    static ConnectionPool<Core::Socket> pool(watch_idle_connection);
+    return pool;
+}
+
 HttpProtocol::HttpProtocol()
     : Protocol("http")
 {
@@ -46,10 +60,19 @@ OwnPtr<Download> HttpProtocol::start_download(ClientConnection& client, const UR
     request.set_method(HTTP::HttpRequest::Method::GET);
     request.set_url(url);
     request.set_headers(headers);
-    auto job = request.schedule();
-    if (!job)
-        return nullptr;
-    return HttpDownload::create_with_job({}, client, (HTTP::HttpJob&)*job);
+    request.set_keep_alive(true);
+    auto job = HTTP::HttpJob::construct(request);
+    if (auto socket = connection_pool().take(url))
+        job->set_socket(socket.release_nonnull());
+    auto download = HttpDownload::create_with_job({}, client, (HTTP::HttpJob&)*job);
+    job->start();
+    return download;
+}
+
+void HttpProtocol::did_finish_job(HTTP::HttpJob& job)
+{
+    if (auto socket = job.take_socket())
+        connection_pool().put(job.url(), socket.release_nonnull());
 }
 
 }
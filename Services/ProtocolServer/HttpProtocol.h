@@ -26,6 +26,7 @@
 
 #pragma once
 
+#include <LibHTTP/Forward.h>
 #include <ProtocolServer/Protocol.h>
 
 namespace ProtocolServer {
@@ -36,6 +37,9 @@ public:
     virtual ~HttpProtocol() override;
 
     virtual OwnPtr<Download> start_download(ClientConnection&, const URL&, const HashMap<String, String>& headers) override;
+
+    // Keeps the job's connection around for later downloads from the same host, if it can be reused.
+    static void did_finish_job(HTTP::HttpJob&);
 };
 
 }
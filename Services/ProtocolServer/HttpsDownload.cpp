@@ -27,6 +27,7 @@
 #include <LibHTTP/HttpResponse.h>
 #include <LibHTTP/HttpsJob.h>
 #include <ProtocolServer/HttpsDownload.h>
+#include <ProtocolServer/HttpsProtocol.h>
 
 namespace ProtocolServer {
 
@@ -40,6 +41,8 @@ HttpsDownload::HttpsDownload(ClientConnection& client, NonnullRefPtr<HTTP::Https
             set_payload(response->payload());
             set_response_headers(response->headers());
         }
+        if (success)
+            HttpsProtocol::did_finish_job(*m_job);
 
         // if we didn't know the total size, pretend that the download finished successfully
         // and set the total size to the downloaded size
@@ -51,6 +54,12 @@ HttpsDownload::HttpsDownload(ClientConnection& client, NonnullRefPtr<HTTP::Https
     m_job->on_progress = [this](Optional<u32> total, u32 current) {
         did_progress(total, current);
     };
+    m_job->on_headers_received = [this](auto& response_headers, int response_code) {
+        did_receive_headers(response_code, response_headers);
+    };
+    m_job->on_data_received = [this](auto& data) {
+        did_receive_data(data);
+    };
     m_job->on_certificate_requested = [this](auto&) {
         did_request_certificates();
     };
@@ -61,10 +70,23 @@ void HttpsDownload::set_certificate(String certificate, String key)
     m_job->set_certificate(move(certificate), move(key));
 }
 
+void HttpsDownload::set_reading_paused(bool paused)
+{
+    m_job->set_reading_paused(paused);
+}
+
+void HttpsDownload::did_start_streaming()
+{
+    // The body goes straight into the stream, there's no need for the job to hold on to it as well.
+    m_job->set_should_keep_passed_along_data(false);
+}
+
 HttpsDownload::~HttpsDownload()
 {
     m_job->on_finish = nullptr;
     m_job->on_progress = nullptr;
+    m_job->on_headers_received = nullptr;
+    m_job->on_data_received = nullptr;
     m_job->shutdown();
 }
 
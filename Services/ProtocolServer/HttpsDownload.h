@@ -41,6 +41,9 @@ public:
 private:
     explicit HttpsDownload(ClientConnection&, NonnullRefPtr<HTTP::HttpsJob>);
 
+    virtual void set_reading_paused(bool) override;
+    virtual void did_start_streaming() override;
+
     virtual void set_certificate(String certificate, String key) override;
 
     NonnullRefPtr<HTTP::HttpsJob> m_job;
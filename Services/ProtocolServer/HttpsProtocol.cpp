@@ -26,11 +26,27 @@
 
 #include <LibHTTP/HttpRequest.h>
 #include <LibHTTP/HttpsJob.h>
+#include <LibTLS/TLSv12.h>
+#include <ProtocolServer/ConnectionPool.h>
 #include <ProtocolServer/HttpsDownload.h>
 #include <ProtocolServer/HttpsProtocol.h>
 
 namespace ProtocolServer {
 
+static void watch_idle_connection(TLS::TLSv12& socket, Function<void()> on_unusable)
+{
+    // The server has nothing to say on an idle connection, except that it's closing it.
+    socket.on_tls_finished = move(on_unusable);
+    socket.on_tls_error = [&socket](auto) { socket.on_tls_finished(); };
+    socket.on_tls_ready_to_read = [](auto& socket) { socket.on_tls_finished(); };
+}
+
+static ConnectionPool<TLS::TLSv12>& connection_pool()
+{
+    static ConnectionPool<TLS::TLSv12> pool(watch_idle_connection);
+    return pool;
+}
+
 HttpsProtocol::HttpsProtocol()
     : Protocol("https")
 {
@@ -46,10 +62,19 @@ OwnPtr<Download> HttpsProtocol::start_download(ClientConnection& client, const U
     request.set_method(HTTP::HttpRequest::Method::GET);
     request.set_url(url);
     request.set_headers(headers);
+    request.set_keep_alive(true);
     auto job = HTTP::HttpsJob::construct(request);
+    if (auto socket = connection_pool().take(url))
+        job->set_socket(socket.release_nonnull());
     auto download = HttpsDownload::create_with_job({}, client, (HTTP::HttpsJob&)*job);
     job->start();
     return download;
 }
 
+void HttpsProtocol::did_finish_job(HTTP::HttpsJob& job)
+{
+    if (auto socket = job.take_socket())
+        connection_pool().put(job.url(), socket.release_nonnull());
+}
+
 }
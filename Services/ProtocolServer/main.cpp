@@ -31,16 +31,19 @@
 #include <ProtocolServer/HttpProtocol.h>
 #include <ProtocolServer/HttpsProtocol.h>
 #include <ProtocolServer/ClientConnection.h>
+#include <signal.h>
 
 int main(int, char**)
 {
-    if (pledge("stdio inet shared_buffer accept unix rpath cpath fattr", nullptr) < 0) {
+    if (pledge("stdio inet shared_buffer accept unix rpath cpath fattr sendfd", nullptr) < 0) {
         perror("pledge");
         return 1;
     }
     Core::EventLoop event_loop;
+    // Streamed downloads are written into pipes, and the client may close its end at any time.
+    signal(SIGPIPE, SIG_IGN);
     // FIXME: Establish a connection to LookupServer and then drop "unix"?
-    if (pledge("stdio inet shared_buffer accept unix", nullptr) < 0) {
+    if (pledge("stdio inet shared_buffer accept unix sendfd", nullptr) < 0) {
         perror("pledge");
         return 1;
     }
@@ -29,6 +29,7 @@
 #include <LibGfx/StylePainter.h>
 #include <WindowServer/Button.h>
 #include <WindowServer/Event.h>
+#include <WindowServer/WindowFrame.h>
 #include <WindowServer/WindowManager.h>
 
 namespace WindowServer {
@@ -65,6 +66,7 @@ void Button::on_mouse_event(const MouseEvent& event)
     if (event.type() == Event::MouseDown && event.button() == MouseButton::Left) {
         m_pressed = true;
         wm.set_cursor_tracking_button(this);
+        m_frame.set_dirty();
         wm.invalidate(screen_rect());
         return;
     }
@@ -85,6 +87,7 @@ void Button::on_mouse_event(const MouseEvent& event)
             // However, we don't know that rect yet. We can make an educated
             // guess which also looks okay even when wrong:
             m_hovered = false;
+            m_frame.set_dirty();
             wm.invalidate(screen_rect());
         }
         return;
@@ -94,8 +97,10 @@ void Button::on_mouse_event(const MouseEvent& event)
         bool old_hovered = m_hovered;
         m_hovered = rect().contains(event.position());
         wm.set_hovered_button(m_hovered ? this : nullptr);
-        if (old_hovered != m_hovered)
+        if (old_hovered != m_hovered) {
+            m_frame.set_dirty();
             wm.invalidate(screen_rect());
+        }
     }
 
     if (event.type() == Event::MouseMove && event.buttons() & (unsigned)MouseButton::Left) {
@@ -103,8 +108,10 @@ void Button::on_mouse_event(const MouseEvent& event)
             return;
         bool old_pressed = m_pressed;
         m_pressed = m_hovered;
-        if (old_pressed != m_pressed)
+        if (old_pressed != m_pressed) {
+            m_frame.set_dirty();
             wm.invalidate(screen_rect());
+        }
     }
 }
 
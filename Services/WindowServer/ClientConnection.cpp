@@ -80,6 +80,8 @@ ClientConnection* ClientConnection::from_client_id(int client_id)
 ClientConnection::ClientConnection(NonnullRefPtr<Core::LocalSocket> client_socket, int client_id)
     : IPC::ClientConnection<WindowServerEndpoint>(*this, move(client_socket), client_id)
 {
+    // Input events and paints for a client tend to come in bursts, so send those out once per event loop pass.
+    set_batches_outgoing_messages(true);
     if (!s_connections)
         s_connections = new HashMap<int, NonnullRefPtr<ClientConnection>>;
     s_connections->set(client_id, *this);
@@ -338,6 +340,13 @@ OwnPtr<Messages::WindowServer::GetWallpaperResponse> ClientConnection::handle(co
     return make<Messages::WindowServer::GetWallpaperResponse>(Compositor::the().wallpaper_path());
 }
 
+OwnPtr<Messages::WindowServer::GetCompositorStatisticsResponse> ClientConnection::handle(const Messages::WindowServer::GetCompositorStatistics&)
+{
+    auto& statistics = Compositor::the().frame_statistics();
+    u32 average_compose_time_us = statistics.frame_count ? statistics.total_compose_time_us / statistics.frame_count : 0;
+    return make<Messages::WindowServer::GetCompositorStatisticsResponse>(statistics.frame_count, statistics.missed_frame_count, statistics.last_compose_time_us, statistics.max_compose_time_us, average_compose_time_us);
+}
+
 OwnPtr<Messages::WindowServer::SetResolutionResponse> ClientConnection::handle(const Messages::WindowServer::SetResolution& message)
 {
     return make<Messages::WindowServer::SetResolutionResponse>(WindowManager::the().set_resolution(message.resolution().width(), message.resolution().height()), WindowManager::the().resolution());
@@ -561,6 +570,23 @@ void ClientConnection::handle(const Messages::WindowServer::DidFinishPainting& m
     WindowSwitcher::the().refresh_if_needed();
 }
 
+void ClientConnection::handle(const Messages::WindowServer::DidScrollWindowContents& message)
+{
+    auto it = m_windows.find(message.window_id());
+    if (it == m_windows.end()) {
+        did_misbehave("DidScrollWindowContents: Bad window ID");
+        return;
+    }
+    auto& window = *(*it).value;
+    // The client has already scrolled its backing store, so the composited pixels only need to follow along.
+    if (window.type() == WindowType::MenuApplet)
+        window.invalidate(message.rect());
+    else
+        Compositor::the().invalidate_scrolled_window_contents(window, message.rect(), message.delta());
+
+    WindowSwitcher::the().refresh_if_needed();
+}
+
 OwnPtr<Messages::WindowServer::SetWindowBackingStoreResponse> ClientConnection::handle(const Messages::WindowServer::SetWindowBackingStore& message)
 {
     int window_id = message.window_id();
@@ -570,9 +596,7 @@ OwnPtr<Messages::WindowServer::SetWindowBackingStoreResponse> ClientConnection::
         return nullptr;
     }
     auto& window = *(*it).value;
-    if (window.last_backing_store() && window.last_backing_store()->shbuf_id() == message.shbuf_id()) {
-        window.swap_backing_stores();
-    } else {
+    if (!window.flip_backing_store(message.shbuf_id())) {
         auto shared_buffer = SharedBuffer::create_from_shbuf_id(message.shbuf_id());
         if (!shared_buffer)
             return make<Messages::WindowServer::SetWindowBackingStoreResponse>();
@@ -589,6 +613,30 @@ OwnPtr<Messages::WindowServer::SetWindowBackingStoreResponse> ClientConnection::
     return make<Messages::WindowServer::SetWindowBackingStoreResponse>();
 }
 
+void ClientConnection::handle(const Messages::WindowServer::FlipWindowBackingStore& message)
+{
+    auto it = m_windows.find(message.window_id());
+    if (it == m_windows.end()) {
+        did_misbehave("FlipWindowBackingStore: Bad window ID");
+        return;
+    }
+    auto& window = *(*it).value;
+    auto* previous_backing_store = window.backing_store();
+    int previous_shbuf_id = previous_backing_store ? previous_backing_store->shbuf_id() : -1;
+    if (!window.flip_backing_store(message.shbuf_id())) {
+        did_misbehave("FlipWindowBackingStore: Unknown backing store");
+        return;
+    }
+    for (auto& rect : message.dirty_rects())
+        window.invalidate(rect);
+
+    // Nothing reads the previous backing store once it isn't current, so the client may paint into it again.
+    if (previous_shbuf_id != -1 && previous_shbuf_id != message.shbuf_id())
+        post_message(Messages::WindowClient::BackingStoreReleased(message.window_id(), previous_shbuf_id, message.serial()));
+
+    WindowSwitcher::the().refresh_if_needed();
+}
+
 OwnPtr<Messages::WindowServer::SetGlobalCursorTrackingResponse> ClientConnection::handle(const Messages::WindowServer::SetGlobalCursorTracking& message)
 {
     int window_id = message.window_id();
@@ -641,6 +689,7 @@ OwnPtr<Messages::WindowServer::SetWindowHasAlphaChannelResponse> ClientConnectio
         return nullptr;
     }
     it->value->set_has_alpha_channel(message.has_alpha_channel());
+    Compositor::the().recompute_occlusions();
     return make<Messages::WindowServer::SetWindowHasAlphaChannelResponse>();
 }
 
@@ -32,10 +32,13 @@
 #include "Window.h"
 #include "WindowManager.h"
 #include <AK/Memory.h>
+#include <AK/QuickSort.h>
 #include <LibCore/Timer.h>
 #include <LibGfx/Font.h>
 #include <LibGfx/Painter.h>
 #include <LibThread/BackgroundAction.h>
+#include <LibThread/ThreadPool.h>
+#include <time.h>
 
 namespace WindowServer {
 
@@ -45,6 +48,22 @@ Compositor& Compositor::the()
     return s_the;
 }
 
+// None of our display devices can tell us when they're in vertical blank, so
+// frames are timed by the monotonic clock instead.
+static constexpr i64 frame_interval_in_microseconds = 1000000 / 60;
+
+static i64 microseconds_since_boot()
+{
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (i64)now.tv_sec * 1000000 + now.tv_nsec / 1000;
+}
+
+static i64 current_frame_index()
+{
+    return microseconds_since_boot() / frame_interval_in_microseconds;
+}
+
 static WallpaperMode mode_to_enum(const String& name)
 {
     if (name == "simple")
@@ -60,23 +79,10 @@ static WallpaperMode mode_to_enum(const String& name)
 
 Compositor::Compositor()
 {
-    m_display_link_notify_timer = add<Core::Timer>(
-        1000 / 60, [this] {
-            notify_display_links();
-        });
-    m_display_link_notify_timer->stop();
-
-    m_compose_timer = Core::Timer::create_single_shot(
-        1000 / 60,
-        [this] {
-            compose();
-        },
-        this);
-
-    m_immediate_compose_timer = Core::Timer::create_single_shot(
+    m_frame_timer = Core::Timer::create_single_shot(
         0,
         [this] {
-            compose();
+            compose_frame(current_frame_index());
         },
         this);
 
@@ -101,9 +107,41 @@ void Compositor::init_bitmaps()
 
     m_buffers_are_flipped = false;
 
+    m_shifted_rects.clear();
+    m_scaled_wallpaper = nullptr;
     invalidate();
 }
 
+void Compositor::update_scaled_wallpaper()
+{
+    auto size = Screen::the().size();
+    if (m_scaled_wallpaper && m_scaled_wallpaper->size() == size)
+        return;
+
+    m_scaled_wallpaper = Gfx::Bitmap::create(m_wallpaper->has_alpha_channel() ? Gfx::BitmapFormat::RGBA32 : Gfx::BitmapFormat::RGB32, size);
+    if (m_wallpaper->has_alpha_channel())
+        m_scaled_wallpaper->fill(Color::Transparent);
+    Gfx::Painter painter(*m_scaled_wallpaper);
+    painter.draw_scaled_bitmap(m_scaled_wallpaper->rect(), *m_wallpaper, m_wallpaper->rect(), 1.0f, Gfx::Painter::ScalingMode::Smooth);
+}
+
+// Everything compose() needs to know about a window, captured on the main thread
+// so that the window stack can be composited in parallel without any locking.
+struct WindowPaintInfo {
+    const WindowFrame* frame { nullptr };
+    Gfx::IntRect frame_rect;
+    Gfx::IntRect rect;
+    RefPtr<Gfx::Bitmap> backing_store;
+    Gfx::IntRect backing_rect;
+    float opacity { 1.0f };
+    bool is_unresponsive { false };
+    Vector<Gfx::IntRect, 32> paint_rects;
+};
+
+// Below this many dirty pixels, handing out bands to the thread pool costs more than it saves.
+static constexpr size_t min_dirty_area_for_parallel_compose = 256 * 256;
+static constexpr int min_band_height = 32;
+
 void Compositor::compose()
 {
     auto& wm = WindowManager::the();
@@ -112,112 +150,150 @@ void Compositor::compose()
     auto& ws = Screen::the();
 
     auto dirty_rects = move(m_dirty_rects);
+    auto shifted_rects = move(m_shifted_rects);
 
-    if (dirty_rects.size() == 0) {
+    if (dirty_rects.size() == 0 && shifted_rects.is_empty()) {
         // nothing dirtied since the last compose pass.
         return;
     }
+    auto compose_start_time = microseconds_since_boot();
 
     dirty_rects.add(Gfx::IntRect::intersection(m_last_geometry_label_rect, Screen::the().rect()));
     dirty_rects.add(Gfx::IntRect::intersection(m_last_cursor_rect, Screen::the().rect()));
     dirty_rects.add(Gfx::IntRect::intersection(m_last_dnd_rect, Screen::the().rect()));
     dirty_rects.add(Gfx::IntRect::intersection(current_cursor_rect(), Screen::the().rect()));
 
-    auto any_dirty_rect_intersects_window = [&dirty_rects](const Window& window) {
-        auto window_frame_rect = window.frame().rect();
-        for (auto& dirty_rect : dirty_rects.rects()) {
-            if (dirty_rect.intersects(window_frame_rect))
-                return true;
-        }
-        return false;
-    };
-
     Color background_color = wm.palette().desktop_background();
     String background_color_entry = wm.config()->read_entry("Background", "Color", "");
     if (!background_color_entry.is_empty()) {
         background_color = Color::from_string(background_color_entry).value_or(background_color);
     }
+    Color window_background_color = wm.palette().window();
+
+    // The scaled wallpaper has to exist before any band starts painting it.
+    if (m_wallpaper && m_wallpaper_mode == WallpaperMode::Scaled)
+        update_scaled_wallpaper();
+
+    // Snapshot the window stack from back to front.
+    Vector<WindowPaintInfo> windows;
+    auto snapshot_window = [&](Window& window) -> IterationDecision {
+        // Only paint the parts of the window that are both dirty and visible.
+        // A fullscreen window is painted on its own, so nothing can cover it.
+        WindowPaintInfo info;
+        info.frame_rect = window.frame().rect();
+        for (auto& dirty_rect : dirty_rects.rects()) {
+            if (!dirty_rect.intersects(info.frame_rect))
+                continue;
+            if (window.is_fullscreen()) {
+                info.paint_rects.append(dirty_rect);
+                continue;
+            }
+            for (auto& visible_rect : window.visible_rects().rects()) {
+                if (visible_rect.intersects(dirty_rect))
+                    info.paint_rects.append(visible_rect.intersected(dirty_rect));
+            }
+        }
+        if (info.paint_rects.is_empty())
+            return IterationDecision::Continue;
 
-    // Paint the wallpaper.
-    for (auto& dirty_rect : dirty_rects.rects()) {
-        if (any_opaque_window_contains_rect(dirty_rect))
-            continue;
+        if (!window.is_fullscreen()) {
+            window.frame().prepare_for_paint();
+            info.frame = &window.frame();
+        }
+        info.rect = window.rect();
+        info.backing_store = window.backing_store();
+        info.opacity = window.opacity();
+        info.is_unresponsive = window.client() && window.client()->is_unresponsive();
+        if (!info.backing_store) {
+            windows.append(move(info));
+            return IterationDecision::Continue;
+        }
+
+        // Decide where we would paint this window's backing store.
+        // This is subtly different from widow.rect(), because window
+        // size may be different from its backing store size. This
+        // happens when the window has been resized and the client
+        // has not yet attached a new backing store. In this case,
+        // we want to try to blit the backing store at the same place
+        // it was previously, and fill the rest of the window with its
+        // background color.
+        Gfx::IntRect& backing_rect = info.backing_rect;
+        backing_rect.set_size(info.backing_store->size());
+        switch (wm.resize_direction_of_window(window)) {
+        case ResizeDirection::None:
+        case ResizeDirection::Right:
+        case ResizeDirection::Down:
+        case ResizeDirection::DownRight:
+            backing_rect.set_location(window.rect().location());
+            break;
+        case ResizeDirection::Left:
+        case ResizeDirection::Up:
+        case ResizeDirection::UpLeft:
+            backing_rect.set_right_without_resize(window.rect().right());
+            backing_rect.set_bottom_without_resize(window.rect().bottom());
+            break;
+        case ResizeDirection::UpRight:
+            backing_rect.set_left(window.rect().left());
+            backing_rect.set_bottom_without_resize(window.rect().bottom());
+            break;
+        case ResizeDirection::DownLeft:
+            backing_rect.set_right_without_resize(window.rect().right());
+            backing_rect.set_top(window.rect().top());
+            break;
+        }
+        windows.append(move(info));
+        return IterationDecision::Continue;
+    };
+
+    if (auto* fullscreen_window = wm.active_fullscreen_window()) {
+        snapshot_window(*fullscreen_window);
+    } else {
+        wm.for_each_visible_window_from_back_to_front([&](Window& window) {
+            return snapshot_window(window);
+        });
+    }
+
+    auto paint_wallpaper = [&](Gfx::Painter& painter, const Gfx::IntRect& dirty_rect) {
         // FIXME: If the wallpaper is opaque, no need to fill with color!
-        m_back_painter->fill_rect(dirty_rect, background_color);
+        painter.fill_rect(dirty_rect, background_color);
         if (m_wallpaper) {
             if (m_wallpaper_mode == WallpaperMode::Simple) {
-                m_back_painter->blit(dirty_rect.location(), *m_wallpaper, dirty_rect);
+                painter.blit(dirty_rect.location(), *m_wallpaper, dirty_rect);
             } else if (m_wallpaper_mode == WallpaperMode::Center) {
                 Gfx::IntPoint offset { ws.size().width() / 2 - m_wallpaper->size().width() / 2,
                     ws.size().height() / 2 - m_wallpaper->size().height() / 2 };
-                m_back_painter->blit_offset(dirty_rect.location(), *m_wallpaper,
+                painter.blit_offset(dirty_rect.location(), *m_wallpaper,
                     dirty_rect, offset);
             } else if (m_wallpaper_mode == WallpaperMode::Tile) {
-                m_back_painter->draw_tiled_bitmap(dirty_rect, *m_wallpaper);
+                painter.draw_tiled_bitmap(dirty_rect, *m_wallpaper);
             } else if (m_wallpaper_mode == WallpaperMode::Scaled) {
-                float hscale = (float)m_wallpaper->size().width() / (float)ws.size().width();
-                float vscale = (float)m_wallpaper->size().height() / (float)ws.size().height();
-
-                m_back_painter->blit_scaled(dirty_rect, *m_wallpaper, dirty_rect, hscale, vscale);
+                painter.blit(dirty_rect.location(), *m_scaled_wallpaper, dirty_rect);
             } else {
                 ASSERT_NOT_REACHED();
             }
         }
-    }
+    };
 
-    auto compose_window = [&](Window& window) -> IterationDecision {
-        if (!any_dirty_rect_intersects_window(window))
-            return IterationDecision::Continue;
-        Gfx::PainterStateSaver saver(*m_back_painter);
-        m_back_painter->add_clip_rect(window.frame().rect());
-        RefPtr<Gfx::Bitmap> backing_store = window.backing_store();
-        for (auto& dirty_rect : dirty_rects.rects()) {
-            if (!window.is_fullscreen() && any_opaque_window_above_this_one_contains_rect(window, dirty_rect))
+    auto compose_window = [&](Gfx::Painter& painter, const WindowPaintInfo& window, const Gfx::IntRect& band_rect) {
+        Gfx::PainterStateSaver saver(painter);
+        painter.add_clip_rect(window.frame_rect);
+        auto* backing_store = window.backing_store.ptr();
+        for (auto& paint_rect : window.paint_rects) {
+            auto dirty_rect = paint_rect.intersected(band_rect);
+            if (dirty_rect.is_empty())
                 continue;
-            Gfx::PainterStateSaver saver(*m_back_painter);
-            m_back_painter->add_clip_rect(dirty_rect);
+            Gfx::PainterStateSaver saver(painter);
+            painter.add_clip_rect(dirty_rect);
             if (!backing_store)
-                m_back_painter->fill_rect(dirty_rect, wm.palette().window());
-            if (!window.is_fullscreen())
-                window.frame().paint(*m_back_painter);
+                painter.fill_rect(dirty_rect, window_background_color);
+            if (window.frame)
+                window.frame->paint(painter);
             if (!backing_store)
                 continue;
 
-            // Decide where we would paint this window's backing store.
-            // This is subtly different from widow.rect(), because window
-            // size may be different from its backing store size. This
-            // happens when the window has been resized and the client
-            // has not yet attached a new backing store. In this case,
-            // we want to try to blit the backing store at the same place
-            // it was previously, and fill the rest of the window with its
-            // background color.
-            Gfx::IntRect backing_rect;
-            backing_rect.set_size(backing_store->size());
-            switch (WindowManager::the().resize_direction_of_window(window)) {
-            case ResizeDirection::None:
-            case ResizeDirection::Right:
-            case ResizeDirection::Down:
-            case ResizeDirection::DownRight:
-                backing_rect.set_location(window.rect().location());
-                break;
-            case ResizeDirection::Left:
-            case ResizeDirection::Up:
-            case ResizeDirection::UpLeft:
-                backing_rect.set_right_without_resize(window.rect().right());
-                backing_rect.set_bottom_without_resize(window.rect().bottom());
-                break;
-            case ResizeDirection::UpRight:
-                backing_rect.set_left(window.rect().left());
-                backing_rect.set_bottom_without_resize(window.rect().bottom());
-                break;
-            case ResizeDirection::DownLeft:
-                backing_rect.set_right_without_resize(window.rect().right());
-                backing_rect.set_top(window.rect().top());
-                break;
-            }
-
+            auto& backing_rect = window.backing_rect;
             Gfx::IntRect dirty_rect_in_backing_coordinates = dirty_rect
-                                                                 .intersected(window.rect())
+                                                                 .intersected(window.rect)
                                                                  .intersected(backing_rect)
                                                                  .translated(-backing_rect.location());
 
@@ -225,30 +301,64 @@ void Compositor::compose()
                 continue;
             auto dst = backing_rect.location().translated(dirty_rect_in_backing_coordinates.location());
 
-            if (window.client() && window.client()->is_unresponsive()) {
-                m_back_painter->blit_filtered(dst, *backing_store, dirty_rect_in_backing_coordinates, [](Color src) {
+            if (window.is_unresponsive) {
+                painter.blit_filtered(dst, *backing_store, dirty_rect_in_backing_coordinates, [](Color src) {
                     return src.to_grayscale().darkened(0.75f);
                 });
             } else {
-                m_back_painter->blit(dst, *backing_store, dirty_rect_in_backing_coordinates, window.opacity());
+                painter.blit(dst, *backing_store, dirty_rect_in_backing_coordinates, window.opacity);
             }
 
-            for (auto background_rect : window.rect().shatter(backing_rect))
-                m_back_painter->fill_rect(background_rect, wm.palette().window());
+            for (auto background_rect : window.rect.shatter(backing_rect))
+                painter.fill_rect(background_rect, window_background_color);
         }
-        return IterationDecision::Continue;
     };
 
-    // Paint the window stack.
-    if (auto* fullscreen_window = wm.active_fullscreen_window()) {
-        compose_window(*fullscreen_window);
-    } else {
-        wm.for_each_visible_window_from_back_to_front([&](Window& window) {
-            return compose_window(window);
+    // Paint the wallpaper (only where no opaque window will be painted over it), and then the window stack.
+    auto compose_band = [&](Gfx::Painter& painter, const Gfx::IntRect& band_rect) {
+        for (auto& dirty_rect : dirty_rects.rects()) {
+            if (!dirty_rect.intersects(band_rect))
+                continue;
+            for (auto& uncovered_rect : m_uncovered_rects.rects()) {
+                auto rect = dirty_rect.intersected(uncovered_rect).intersected(band_rect);
+                if (!rect.is_empty())
+                    paint_wallpaper(painter, rect);
+            }
+        }
+        for (auto& window : windows)
+            compose_window(painter, window, band_rect);
+    };
+
+    // Horizontal bands of the back buffer don't share any pixels, so each one can be
+    // composited on its own thread, with its own painter clipped to the band.
+    size_t dirty_area = 0;
+    int dirty_top = ws.height();
+    int dirty_bottom = -1;
+    for (auto& dirty_rect : dirty_rects.rects()) {
+        dirty_area += dirty_rect.width() * dirty_rect.height();
+        dirty_top = min(dirty_top, dirty_rect.top());
+        dirty_bottom = max(dirty_bottom, dirty_rect.bottom());
+    }
+    size_t band_count = 1;
+    if (dirty_area >= min_dirty_area_for_parallel_compose)
+        band_count = min(LibThread::ThreadPool::the().thread_count() + 1, (size_t)max(1, (dirty_bottom - dirty_top + 1) / min_band_height));
+
+    if (band_count > 1) {
+        int dirty_height = dirty_bottom - dirty_top + 1;
+        LibThread::ThreadPool::the().parallel_for(0, band_count, 1, [&](size_t i) {
+            int top = dirty_top + dirty_height * i / band_count;
+            int bottom = dirty_top + dirty_height * (i + 1) / band_count;
+            Gfx::IntRect band_rect { 0, top, ws.width(), bottom - top };
+            Gfx::Painter painter(*m_back_bitmap);
+            painter.add_clip_rect(band_rect);
+            compose_band(painter, band_rect);
         });
+    } else {
+        compose_band(*m_back_painter, ws.rect());
+    }
 
+    if (!wm.active_fullscreen_window())
         draw_geometry_label();
-    }
 
     run_animations();
 
@@ -264,6 +374,14 @@ void Compositor::compose()
 
     for (auto& r : dirty_rects.rects())
         flush(r);
+    for (auto& r : shifted_rects.rects())
+        flush(r);
+
+    auto compose_time = (u32)(microseconds_since_boot() - compose_start_time);
+    ++m_frame_statistics.frame_count;
+    m_frame_statistics.last_compose_time_us = compose_time;
+    m_frame_statistics.max_compose_time_us = max(m_frame_statistics.max_compose_time_us, compose_time);
+    m_frame_statistics.total_compose_time_us += compose_time;
 }
 
 void Compositor::flush(const Gfx::IntRect& a_rect)
@@ -314,16 +432,54 @@ void Compositor::invalidate(const Gfx::IntRect& a_rect)
         return;
 
     m_dirty_rects.add(rect);
+    start_compose_async_timer();
+}
+
+void Compositor::start_compose_async_timer()
+{
+    if (m_frame_timer->is_active())
+        return;
+
+    // If nothing has been composed during the current frame yet, there's no reason to wait.
+    // Otherwise, this waits for the next frame to start, so that bursts of invalidations
+    // are coalesced into one compose per frame.
+    auto now = microseconds_since_boot();
+    auto frame_index = now / frame_interval_in_microseconds;
+    if (frame_index > m_last_frame_index) {
+        m_scheduled_frame_index = frame_index;
+        m_frame_timer->start(0);
+        return;
+    }
+    m_scheduled_frame_index = frame_index + 1;
+    auto delay = m_scheduled_frame_index * frame_interval_in_microseconds - now;
+    m_frame_timer->start((delay + 999) / 1000);
+}
 
-    // We delay composition by a timer interval, but to not affect latency too
-    // much, if a pending compose is not already scheduled, we also schedule an
-    // immediate compose the next spin of the event loop.
-    if (!m_compose_timer->is_active()) {
-        m_compose_timer->start();
-        m_immediate_compose_timer->start();
+void Compositor::compose_frame(i64 frame_index)
+{
+    // Every frame boundary we slept through while something was waiting to be composed is a missed frame.
+    if (m_scheduled_frame_index >= 0 && frame_index > m_scheduled_frame_index)
+        m_frame_statistics.missed_frame_count += frame_index - m_scheduled_frame_index;
+    m_scheduled_frame_index = -1;
+    m_last_frame_index = frame_index;
+
+    compose();
+
+    // Display links tick once per frame, for as long as anyone is listening.
+    if (m_display_link_count) {
+        notify_display_links();
+        start_compose_async_timer();
     }
 }
 
+void Compositor::compose_after_input()
+{
+    if (m_dirty_rects.is_empty() && m_shifted_rects.is_empty())
+        return;
+    m_frame_timer->stop();
+    compose_frame(current_frame_index());
+}
+
 bool Compositor::set_background_color(const String& background_color)
 {
     auto& wm = WindowManager::the();
@@ -360,6 +516,7 @@ bool Compositor::set_wallpaper(const String& path, Function<void(bool)>&& callba
         [this, path, callback = move(callback)](RefPtr<Gfx::Bitmap> bitmap) {
             m_wallpaper_path = path;
             m_wallpaper = move(bitmap);
+            m_scaled_wallpaper = nullptr;
             invalidate();
             callback(true);
         });
@@ -427,6 +584,7 @@ bool Compositor::set_resolution(int desired_width, int desired_height)
     }
     bool success = Screen::the().set_resolution(desired_width, desired_height);
     init_bitmaps();
+    recompute_occlusions();
     compose();
     return success;
 }
@@ -503,81 +661,180 @@ void Compositor::increment_display_link_count(Badge<ClientConnection>)
 {
     ++m_display_link_count;
     if (m_display_link_count == 1)
-        m_display_link_notify_timer->start();
+        start_compose_async_timer();
 }
 
 void Compositor::decrement_display_link_count(Badge<ClientConnection>)
 {
     ASSERT(m_display_link_count);
     --m_display_link_count;
-    if (!m_display_link_count)
-        m_display_link_notify_timer->stop();
 }
 
-bool Compositor::any_opaque_window_contains_rect(const Gfx::IntRect& rect)
+static bool is_opaque(const Window& window)
 {
-    bool found_containing_window = false;
-    WindowManager::the().for_each_visible_window_from_back_to_front([&](Window& window) {
-        if (window.is_minimized())
-            return IterationDecision::Continue;
-        if (window.opacity() < 1.0f)
-            return IterationDecision::Continue;
-        if (window.has_alpha_channel()) {
-            // FIXME: Just because the window has an alpha channel doesn't mean it's not opaque.
-            //        Maybe there's some way we could know this?
-            return IterationDecision::Continue;
-        }
-        if (window.frame().rect().contains(rect)) {
-            found_containing_window = true;
-            return IterationDecision::Break;
-        }
-        return IterationDecision::Continue;
-    });
-    return found_containing_window;
-};
+    // FIXME: Just because the window has an alpha channel doesn't mean it's not opaque.
+    //        Maybe there's some way we could know this?
+    return window.opacity() >= 1.0f && !window.has_alpha_channel();
+}
 
-bool Compositor::any_opaque_window_above_this_one_contains_rect(const Window& a_window, const Gfx::IntRect& rect)
+static void shift_pixels(Gfx::Bitmap& bitmap, const Gfx::DisjointRectSet& rects, const Gfx::IntPoint& delta)
 {
-    bool found_containing_window = false;
-    bool checking = false;
-    WindowManager::the().for_each_visible_window_from_back_to_front([&](Window& window) {
-        if (&window == &a_window) {
-            checking = true;
-            return IterationDecision::Continue;
+    // The source rects are disjoint, but a destination may still overlap another source. Like memmove(),
+    // walk the scanlines (and the rects on a scanline) against the direction of the shift so that every
+    // source pixel has been read before anything is written over it.
+    Vector<Gfx::IntRect, 32> sorted_rects;
+    for (auto& rect : rects.rects())
+        sorted_rects.append(rect);
+    quick_sort(sorted_rects, [&](auto& a, auto& b) { return delta.x() > 0 ? a.x() > b.x() : a.x() < b.x(); });
+
+    int top = sorted_rects.first().top();
+    int bottom = sorted_rects.first().bottom();
+    for (auto& rect : sorted_rects) {
+        top = min(top, rect.top());
+        bottom = max(bottom, rect.bottom());
+    }
+
+    auto shift_scanline = [&](int y) {
+        for (auto& rect : sorted_rects) {
+            if (y < rect.top() || y > rect.bottom())
+                continue;
+            memmove(bitmap.scanline(y + delta.y()) + rect.x() + delta.x(), bitmap.scanline(y) + rect.x(), rect.width() * sizeof(Gfx::RGBA32));
         }
-        if (!checking)
-            return IterationDecision::Continue;
-        if (!window.is_visible())
-            return IterationDecision::Continue;
-        if (window.is_minimized())
-            return IterationDecision::Continue;
-        if (window.opacity() < 1.0f)
+    };
+
+    if (delta.y() > 0) {
+        for (int y = bottom; y >= top; --y)
+            shift_scanline(y);
+    } else {
+        for (int y = top; y <= bottom; ++y)
+            shift_scanline(y);
+    }
+}
+
+void Compositor::shift_composited_pixels(const Window& window, const Gfx::IntRect& source_rect, const Gfx::IntPoint& delta, const Gfx::IntRect& destination_clip_rect)
+{
+    auto& wm = WindowManager::the();
+    auto screen_rect = Screen::the().rect();
+    auto destination_rect = source_rect.translated(delta).intersected(destination_clip_rect);
+
+    auto can_shift = [&] {
+        if (delta.is_null() || m_flash_flush || wm.active_fullscreen_window())
+            return false;
+        if (!window.is_visible() || window.is_minimized() || !is_opaque(window))
+            return false;
+        // Minimize animations draw straight into the back buffer without any bookkeeping.
+        bool any_window_animating = false;
+        wm.for_each_window([&](Window& other_window) {
+            if (other_window.in_minimize_animation()) {
+                any_window_animating = true;
+                return IterationDecision::Break;
+            }
             return IterationDecision::Continue;
-        if (window.has_alpha_channel())
+        });
+        return !any_window_animating;
+    };
+
+    // Composited pixels can only be reused where this window is the topmost thing on screen, both
+    // before and after the shift. Translucent windows in front of it make that impossible to tell.
+    Gfx::DisjointRectSet covered_rects;
+    bool found_window = false;
+    if (can_shift()) {
+        wm.for_each_visible_window_from_front_to_back([&](Window& other_window) {
+            if (&other_window == &window) {
+                found_window = true;
+                return IterationDecision::Break;
+            }
+            if (other_window.is_minimized())
+                return IterationDecision::Continue;
+            auto other_frame_rect = other_window.frame().rect();
+            if (!other_frame_rect.intersects(source_rect) && !other_frame_rect.intersects(destination_rect))
+                return IterationDecision::Continue;
+            if (!is_opaque(other_window))
+                return IterationDecision::Break;
+            covered_rects.add(other_frame_rect);
+            covered_rects.add(other_frame_rect.translated(-delta));
             return IterationDecision::Continue;
-        if (window.frame().rect().contains(rect)) {
-            found_containing_window = true;
-            return IterationDecision::Break;
+        });
+    }
+
+    Gfx::DisjointRectSet source_rects;
+    if (found_window) {
+        auto rect = source_rect
+                        .intersected(destination_rect.translated(-delta))
+                        .intersected(screen_rect)
+                        .intersected(screen_rect.translated(-delta));
+        if (!rect.is_empty())
+            source_rects.add(rect);
+        // Pixels that are going to be recomposited anyway aren't up to date, and neither are the ones
+        // that we drew on top of the window stack last time.
+        source_rects = source_rects.shatter(covered_rects).shatter(m_dirty_rects);
+        source_rects = source_rects.shatter(m_last_cursor_rect).shatter(m_last_dnd_rect).shatter(m_last_geometry_label_rect);
+    }
+
+    Gfx::DisjointRectSet shifted_rects;
+    if (!source_rects.is_empty()) {
+        shift_pixels(*m_back_bitmap, source_rects, delta);
+        for (auto& rect : source_rects.rects()) {
+            shifted_rects.add(rect.translated(delta));
+            m_shifted_rects.add(rect.translated(delta));
         }
-        return IterationDecision::Continue;
-    });
-    return found_containing_window;
-};
+        start_compose_async_timer();
+    }
+
+    // Whatever the shifted pixels don't account for has to be recomposited.
+    auto invalidate_exposed_rects = [&](const Gfx::IntRect& rect) {
+        auto clipped_rect = rect.intersected(screen_rect);
+        if (clipped_rect.is_empty())
+            return;
+        Gfx::DisjointRectSet exposed_rects;
+        exposed_rects.add(clipped_rect);
+        for (auto& exposed_rect : exposed_rects.shatter(shifted_rects).rects())
+            invalidate(exposed_rect);
+    };
+    invalidate_exposed_rects(source_rect);
+    invalidate_exposed_rects(destination_rect);
+}
+
+void Compositor::invalidate_moved_window(const Window& window, const Gfx::IntRect& old_frame_rect)
+{
+    auto new_frame_rect = window.frame().rect();
+    shift_composited_pixels(window, old_frame_rect, new_frame_rect.location() - old_frame_rect.location(), new_frame_rect);
+}
+
+void Compositor::invalidate_scrolled_window_contents(const Window& window, const Gfx::IntRect& rect, const Gfx::IntPoint& delta)
+{
+    auto screen_rect = rect.translated(window.position()).intersected(window.rect());
+    shift_composited_pixels(window, screen_rect, delta, screen_rect);
+}
 
 void Compositor::recompute_occlusions()
 {
+    // Walk the stack from front to back, handing each window whatever part of
+    // its frame hasn't already been covered by an opaque window in front of it.
     auto& wm = WindowManager::the();
-    wm.for_each_visible_window_from_back_to_front([&](Window& window) {
-        if (wm.m_switcher.is_visible()) {
-            window.set_occluded(false);
-        } else {
-            if (any_opaque_window_above_this_one_contains_rect(window, window.frame().rect()))
-                window.set_occluded(true);
-            else
-                window.set_occluded(false);
+    Gfx::DisjointRectSet covered_rects;
+    wm.for_each_visible_window_from_front_to_back([&](Window& window) {
+        if (window.is_minimized()) {
+            window.set_visible_rects({});
+            window.set_occluded(true);
+            return IterationDecision::Continue;
         }
+        auto window_frame_rect = window.frame().rect().intersected(Screen::the().rect());
+        Gfx::DisjointRectSet visible_rects;
+        if (!window_frame_rect.is_empty())
+            visible_rects.add(window_frame_rect);
+        visible_rects = visible_rects.shatter(covered_rects);
+        window.set_occluded(!wm.m_switcher.is_visible() && visible_rects.is_empty());
+        window.set_visible_rects(move(visible_rects));
+
+        if (is_opaque(window) && !window_frame_rect.is_empty())
+            covered_rects.add(window_frame_rect);
         return IterationDecision::Continue;
     });
+
+    Gfx::DisjointRectSet uncovered_rects;
+    uncovered_rects.add(Screen::the().rect());
+    m_uncovered_rects = uncovered_rects.shatter(covered_rects);
 }
 
 }
@@ -52,6 +52,9 @@ public:
     static Compositor& the();
 
     void compose();
+    // Input should show up on screen as soon as possible, so this composes pending changes
+    // right away instead of waiting for the next frame.
+    void compose_after_input();
     void invalidate();
     void invalidate(const Gfx::IntRect&);
 
@@ -70,23 +73,42 @@ public:
     void increment_display_link_count(Badge<ClientConnection>);
     void decrement_display_link_count(Badge<ClientConnection>);
 
+    struct FrameStatistics {
+        u32 frame_count { 0 };
+        u32 missed_frame_count { 0 };
+        u32 last_compose_time_us { 0 };
+        u32 max_compose_time_us { 0 };
+        u64 total_compose_time_us { 0 };
+    };
+    const FrameStatistics& frame_statistics() const { return m_frame_statistics; }
+
     void recompute_occlusions();
 
+    // These reuse the pixels that are already composited where they're still valid, and only invalidate the rest.
+    void invalidate_moved_window(const Window&, const Gfx::IntRect& old_frame_rect);
+    void invalidate_scrolled_window_contents(const Window&, const Gfx::IntRect&, const Gfx::IntPoint& delta);
+
 private:
     Compositor();
     void init_bitmaps();
+    void update_scaled_wallpaper();
     void flip_buffers();
     void flush(const Gfx::IntRect&);
+    void start_compose_async_timer();
+    void compose_frame(i64 frame_index);
+    void shift_composited_pixels(const Window&, const Gfx::IntRect& source_rect, const Gfx::IntPoint& delta, const Gfx::IntRect& destination_clip_rect);
     void draw_cursor();
     void draw_geometry_label();
     void draw_menubar();
     void run_animations();
     void notify_display_links();
-    bool any_opaque_window_contains_rect(const Gfx::IntRect&);
-    bool any_opaque_window_above_this_one_contains_rect(const Window&, const Gfx::IntRect&);
 
-    RefPtr<Core::Timer> m_compose_timer;
-    RefPtr<Core::Timer> m_immediate_compose_timer;
+    // Frames are paced by a 60 Hz clock: everything that happens during one frame is
+    // composed at the start of the next one, and display links are notified right after.
+    RefPtr<Core::Timer> m_frame_timer;
+    i64 m_last_frame_index { -1 };
+    i64 m_scheduled_frame_index { -1 };
+    FrameStatistics m_frame_statistics;
     bool m_flash_flush { false };
     bool m_buffers_are_flipped { false };
     bool m_screen_can_set_buffer { false };
@@ -97,6 +119,8 @@ private:
     OwnPtr<Gfx::Painter> m_front_painter;
 
     Gfx::DisjointRectSet m_dirty_rects;
+    Gfx::DisjointRectSet m_uncovered_rects;
+    Gfx::DisjointRectSet m_shifted_rects;
 
     Gfx::IntRect m_last_cursor_rect;
     Gfx::IntRect m_last_dnd_rect;
@@ -105,8 +129,9 @@ private:
     String m_wallpaper_path;
     WallpaperMode m_wallpaper_mode { WallpaperMode::Unchecked };
     RefPtr<Gfx::Bitmap> m_wallpaper;
+    // The wallpaper as it is shown in the Scaled mode, rebuilt when the wallpaper or the resolution changes.
+    RefPtr<Gfx::Bitmap> m_scaled_wallpaper;
 
-    RefPtr<Core::Timer> m_display_link_notify_timer;
     size_t m_display_link_count { 0 };
 };
 
@@ -28,6 +28,7 @@
 #include <LibCore/LocalSocket.h>
 #include <LibCore/Object.h>
 #include <WindowServer/ClientConnection.h>
+#include <WindowServer/Compositor.h>
 #include <WindowServer/Cursor.h>
 #include <WindowServer/Event.h>
 #include <WindowServer/EventLoop.h>
@@ -131,6 +132,7 @@ void EventLoop::drain_mouse()
         screen.on_receive_mouse_data(state);
     if (!state.is_relative)
         screen.on_receive_mouse_data(state);
+    Compositor::the().compose_after_input();
 }
 
 void EventLoop::drain_keyboard()
@@ -144,6 +146,7 @@ void EventLoop::drain_keyboard()
         ASSERT(nread == sizeof(::KeyEvent));
         screen.on_receive_keyboard_data(event);
     }
+    Compositor::the().compose_after_input();
 }
 
 }
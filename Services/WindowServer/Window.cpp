@@ -140,6 +140,38 @@ void Window::set_title(const String& title)
     WindowManager::the().notify_title_changed(*this);
 }
 
+// Together with the current one, this is enough for triple-buffered clients.
+static constexpr size_t max_retained_backing_stores = 2;
+
+void Window::set_backing_store(RefPtr<Gfx::Bitmap>&& backing_store)
+{
+    if (m_backing_store) {
+        if (m_retained_backing_stores.size() == max_retained_backing_stores)
+            m_retained_backing_stores.take_first();
+        m_retained_backing_stores.append(move(m_backing_store));
+    }
+    m_backing_store = move(backing_store);
+
+    // Backing stores of another size belong to a frame the client will never flip to again.
+    if (m_backing_store)
+        m_retained_backing_stores.remove_all_matching([&](auto& retained) { return retained->size() != m_backing_store->size(); });
+}
+
+bool Window::flip_backing_store(int shbuf_id)
+{
+    if (m_backing_store && m_backing_store->shbuf_id() == shbuf_id)
+        return true;
+    for (size_t i = 0; i < m_retained_backing_stores.size(); ++i) {
+        if (m_retained_backing_stores[i]->shbuf_id() != shbuf_id)
+            continue;
+        swap(m_backing_store, m_retained_backing_stores[i]);
+        if (!m_retained_backing_stores[i])
+            m_retained_backing_stores.remove(i);
+        return true;
+    }
+    return false;
+}
+
 void Window::set_rect(const Gfx::IntRect& rect)
 {
     ASSERT(!rect.is_empty());
@@ -252,6 +284,9 @@ void Window::set_occluded(bool occluded)
     if (m_occluded == occluded)
         return;
     m_occluded = occluded;
+    // Paints are dropped while we're occluded, so catch up on everything once we're visible again.
+    if (!occluded)
+        request_update({ {}, size() });
     WindowManager::the().notify_occlusion_state_changed(*this);
 }
 
@@ -359,6 +394,7 @@ void Window::set_visible(bool b)
     if (m_visible == b)
         return;
     m_visible = b;
+    Compositor::the().recompute_occlusions();
     invalidate();
 }
 
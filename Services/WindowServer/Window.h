@@ -108,6 +108,10 @@ public:
     bool is_occluded() const { return m_occluded; }
     void set_occluded(bool);
 
+    // The parts of frame().rect() that aren't covered by opaque windows above this one.
+    const Gfx::DisjointRectSet& visible_rects() const { return m_visible_rects; }
+    void set_visible_rects(Gfx::DisjointRectSet&& rects) { m_visible_rects = move(rects); }
+
     bool is_movable() const
     {
         return m_type == WindowType::Normal;
@@ -179,18 +183,9 @@ public:
     const Gfx::Bitmap* backing_store() const { return m_backing_store.ptr(); }
     Gfx::Bitmap* backing_store() { return m_backing_store.ptr(); }
 
-    void set_backing_store(RefPtr<Gfx::Bitmap>&& backing_store)
-    {
-        m_last_backing_store = move(m_backing_store);
-        m_backing_store = move(backing_store);
-    }
-
-    void swap_backing_stores()
-    {
-        swap(m_backing_store, m_last_backing_store);
-    }
-
-    Gfx::Bitmap* last_backing_store() { return m_last_backing_store.ptr(); }
+    void set_backing_store(RefPtr<Gfx::Bitmap>&&);
+    // Makes one of the backing stores the client has set before current again, without mapping it anew.
+    bool flip_backing_store(int shbuf_id);
 
     void set_global_cursor_tracking_enabled(bool);
     void set_automatic_cursor_tracking_enabled(bool enabled) { m_automatic_cursor_tracking_enabled = enabled; }
@@ -300,8 +295,11 @@ private:
     WindowTileType m_tiled { WindowTileType::None };
     Gfx::IntRect m_untiled_rect;
     bool m_occluded { false };
+    Gfx::DisjointRectSet m_visible_rects;
     RefPtr<Gfx::Bitmap> m_backing_store;
-    RefPtr<Gfx::Bitmap> m_last_backing_store;
+    // Clients cycle through up to three backing stores. The ones that aren't current are kept around so that
+    // flipping back to them is cheap.
+    Vector<RefPtr<Gfx::Bitmap>, 2> m_retained_backing_stores;
     int m_window_id { -1 };
     i32 m_client_id { -1 };
     float m_opacity { 1 };
@@ -134,12 +134,14 @@ void WindowFrame::set_button_icons()
         m_maximize_button->set_icon(m_window.is_maximized() ? *s_restore_icon : *s_maximize_icon);
 
     s_last_title_button_icons_path = icons_path;
+    set_dirty();
 }
 
 void WindowFrame::did_set_maximized(Badge<Window>, bool maximized)
 {
     ASSERT(m_maximize_button);
     m_maximize_button->set_icon(maximized ? *s_restore_icon : *s_maximize_icon);
+    set_dirty();
 }
 
 Gfx::IntRect WindowFrame::title_bar_rect() const
@@ -176,45 +178,84 @@ void WindowFrame::paint_notification_frame(Gfx::Painter& painter)
     Gfx::WindowTheme::current().paint_notification_frame(painter, outer_rect, m_window.rect(), palette, m_buttons.last().relative_rect());
 }
 
-void WindowFrame::paint_normal_frame(Gfx::Painter& painter)
+String WindowFrame::title_text() const
 {
-    auto palette = WindowManager::the().palette();
-    auto& window = m_window;
-    Gfx::IntRect outer_rect = { {}, rect().size() };
-    String title_text;
-    if (window.client() && window.client()->is_unresponsive()) {
+    if (m_window.client() && m_window.client()->is_unresponsive()) {
         StringBuilder builder;
-        builder.append(window.title());
+        builder.append(m_window.title());
         builder.append(" (Not responding)");
-        title_text = builder.to_string();
-    } else {
-        title_text = window.title();
+        return builder.to_string();
     }
+    return m_window.title();
+}
 
+void WindowFrame::paint_normal_frame(Gfx::Painter& painter)
+{
+    auto palette = WindowManager::the().palette();
+    Gfx::IntRect outer_rect = { {}, rect().size() };
     auto leftmost_button_rect = m_buttons.is_empty() ? Gfx::IntRect() : m_buttons.last().relative_rect();
-    Gfx::WindowTheme::current().paint_normal_frame(painter, window_state_for_theme(), outer_rect, m_window.rect(), title_text, m_window.icon(), palette, leftmost_button_rect);
+    Gfx::WindowTheme::current().paint_normal_frame(painter, m_cached_window_state, outer_rect, m_window.rect(), m_cached_title_text, m_window.icon(), palette, leftmost_button_rect);
 }
 
-void WindowFrame::paint(Gfx::Painter& painter)
+void WindowFrame::render_frame(Gfx::Painter& painter)
 {
-    if (m_window.is_frameless())
-        return;
-
-    Gfx::PainterStateSaver saver(painter);
-    painter.translate(rect().location());
-
     if (m_window.type() == WindowType::Notification)
         paint_notification_frame(painter);
-    else if (m_window.type() == WindowType::Normal)
-        paint_normal_frame(painter);
     else
-        return;
+        paint_normal_frame(painter);
 
     for (auto& button : m_buttons) {
         button.paint(painter);
     }
 }
 
+void WindowFrame::prepare_for_paint()
+{
+    m_has_frame_to_paint = !m_window.is_frameless() && (m_window.type() == WindowType::Notification || m_window.type() == WindowType::Normal);
+    if (!m_has_frame_to_paint)
+        return;
+
+    auto frame_rect = rect();
+    m_cached_location = frame_rect.location();
+    auto title_text = this->title_text();
+    auto window_state = window_state_for_theme();
+    if (!m_dirty && m_cached_size == frame_rect.size() && m_cached_title_text == title_text && m_cached_window_state == window_state)
+        return;
+
+    m_dirty = false;
+    m_cached_size = frame_rect.size();
+    m_cached_title_text = move(title_text);
+    m_cached_window_state = window_state;
+
+    // The window contents cover everything inside the window rect, so only the border
+    // and title bar around it are kept. Each piece is rendered with the whole frame
+    // translated into place, and the painter's clip takes care of the rest.
+    m_cached_pieces.clear();
+    Gfx::IntRect outer_rect = { {}, frame_rect.size() };
+    auto window_rect = m_window.rect().translated(-frame_rect.location());
+    for (auto& piece_rect : outer_rect.shatter(window_rect)) {
+        auto bitmap = Gfx::Bitmap::create(Gfx::BitmapFormat::RGBA32, piece_rect.size());
+        if (!bitmap) {
+            m_cached_pieces.clear();
+            m_dirty = true;
+            return;
+        }
+        bitmap->fill(Color::Transparent);
+        Gfx::Painter painter(*bitmap);
+        painter.translate(-piece_rect.location());
+        render_frame(painter);
+        m_cached_pieces.append({ piece_rect, bitmap.release_nonnull() });
+    }
+}
+
+void WindowFrame::paint(Gfx::Painter& painter) const
+{
+    if (!m_has_frame_to_paint)
+        return;
+    for (auto& piece : m_cached_pieces)
+        painter.blit(m_cached_location.translated(piece.rect.location()), *piece.bitmap, piece.bitmap->rect());
+}
+
 static Gfx::IntRect frame_rect_for_window(Window& window, const Gfx::IntRect& rect)
 {
     if (window.is_frameless())
@@ -234,6 +275,7 @@ Gfx::IntRect WindowFrame::rect() const
 
 void WindowFrame::invalidate_title_bar()
 {
+    set_dirty();
     Compositor::the().invalidate(title_bar_rect().translated(rect().location()));
 }
 
@@ -242,13 +284,19 @@ void WindowFrame::notify_window_rect_changed(const Gfx::IntRect& old_rect, const
     layout_buttons();
 
     auto& wm = WindowManager::the();
-    wm.invalidate(frame_rect_for_window(m_window, old_rect));
-    wm.invalidate(frame_rect_for_window(m_window, new_rect));
+    if (old_rect.size() == new_rect.size()) {
+        // Moving doesn't change what the window looks like, so reuse what's already on screen.
+        Compositor::the().invalidate_moved_window(m_window, frame_rect_for_window(m_window, old_rect));
+    } else {
+        wm.invalidate(frame_rect_for_window(m_window, old_rect));
+        wm.invalidate(frame_rect_for_window(m_window, new_rect));
+    }
     wm.notify_rect_changed(m_window, old_rect, new_rect);
 }
 
 void WindowFrame::layout_buttons()
 {
+    set_dirty();
     auto palette = WindowManager::the().palette();
     int window_button_width = palette.window_title_button_width();
     int window_button_height = palette.window_title_button_height();
@@ -28,7 +28,11 @@
 
 #include <AK/Forward.h>
 #include <AK/NonnullOwnPtrVector.h>
+#include <AK/NonnullRefPtr.h>
+#include <AK/String.h>
+#include <AK/Vector.h>
 #include <LibGfx/Forward.h>
+#include <LibGfx/Rect.h>
 #include <LibGfx/WindowTheme.h>
 
 namespace WindowServer {
@@ -43,11 +47,19 @@ public:
     ~WindowFrame();
 
     Gfx::IntRect rect() const;
-    void paint(Gfx::Painter&);
+
+    // The frame is rendered once into cached bitmaps by prepare_for_paint(), and paint() just
+    // blits them. paint() touches nothing else, so the compositor can call it off the main thread.
+    void prepare_for_paint();
+    void paint(Gfx::Painter&) const;
     void on_mouse_event(const MouseEvent&);
     void notify_window_rect_changed(const Gfx::IntRect& old_rect, const Gfx::IntRect& new_rect);
     void invalidate_title_bar();
 
+    // Size, title and window state changes are picked up automatically, anything else
+    // that changes how the frame looks (buttons, icons, theme) must call this.
+    void set_dirty() { m_dirty = true; }
+
     Gfx::IntRect title_bar_rect() const;
     Gfx::IntRect title_bar_icon_rect() const;
     Gfx::IntRect title_bar_text_rect() const;
@@ -60,6 +72,8 @@ public:
 private:
     void paint_notification_frame(Gfx::Painter&);
     void paint_normal_frame(Gfx::Painter&);
+    void render_frame(Gfx::Painter&);
+    String title_text() const;
 
     Gfx::WindowTheme::WindowState window_state_for_theme() const;
 
@@ -68,6 +82,19 @@ private:
     Button* m_close_button { nullptr };
     Button* m_maximize_button { nullptr };
     Button* m_minimize_button { nullptr };
+
+    // The parts of the frame outside the window rect, relative to the frame.
+    struct CachedPiece {
+        Gfx::IntRect rect;
+        NonnullRefPtr<Gfx::Bitmap> bitmap;
+    };
+    Vector<CachedPiece, 4> m_cached_pieces;
+    bool m_dirty { true };
+    bool m_has_frame_to_paint { false };
+    Gfx::IntPoint m_cached_location;
+    Gfx::IntSize m_cached_size;
+    String m_cached_title_text;
+    Gfx::WindowTheme::WindowState m_cached_window_state { Gfx::WindowTheme::WindowState::Inactive };
 };
 
 }
@@ -1121,6 +1121,7 @@ void WindowManager::set_highlight_window(Window* window)
     m_highlight_window = window ? window->make_weak_ptr() : nullptr;
     if (m_highlight_window)
         m_highlight_window->invalidate();
+    Compositor::the().recompute_occlusions();
 }
 
 bool WindowManager::is_active_window_or_accessory(Window& window) const
@@ -1401,6 +1402,7 @@ bool WindowManager::update_theme(String theme_path, String theme_name)
         return IterationDecision::Continue;
     });
     MenuManager::the().did_change_theme();
+    Compositor::the().recompute_occlusions();
     auto wm_config = Core::ConfigFile::open("/etc/WindowServer/WindowServer.ini");
     wm_config->write_entry("Theme", "Name", theme_name);
     wm_config->sync();
@@ -37,6 +37,7 @@ public:
     ~FileDescriptionCollector();
 
     void collect();
+    const Vector<int, 32>& fds() const { return m_fds; }
     void add(int fd);
 
 private:
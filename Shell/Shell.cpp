@@ -42,6 +42,7 @@
 #include <inttypes.h>
 #include <pwd.h>
 #include <signal.h>
+#include <spawn.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -195,6 +196,20 @@ Vector<StringView> Shell::split_path(const StringView& path)
 }
 
 Vector<String> Shell::expand_globs(const StringView& path, StringView base)
+{
+    Vector<String> results;
+    for_each_glob_match(path, base, [&](auto& match) {
+        results.append(match);
+        return IterationDecision::Continue;
+    });
+
+    // Make the output predictable and nice.
+    quick_sort(results);
+
+    return results;
+}
+
+IterationDecision Shell::for_each_glob_match(const StringView& path, StringView base, Function<IterationDecision(const String&)> callback)
 {
     if (path.starts_with('/'))
         base = "/";
@@ -203,7 +218,7 @@ Vector<String> Shell::expand_globs(const StringView& path, StringView base)
     struct stat statbuf;
     if (lstat(base_string.characters(), &statbuf) < 0) {
         perror("lstat");
-        return {};
+        return IterationDecision::Continue;
     }
 
     StringBuilder resolved_base_path_builder;
@@ -211,66 +226,112 @@ Vector<String> Shell::expand_globs(const StringView& path, StringView base)
     if (S_ISDIR(statbuf.st_mode))
         resolved_base_path_builder.append('/');
 
-    auto resolved_base = resolved_base_path_builder.string_view();
-
-    auto results = expand_globs(move(parts), resolved_base);
+    auto resolved_base = resolved_base_path_builder.build();
 
-    for (auto& entry : results) {
-        entry = entry.substring(resolved_base.length(), entry.length() - resolved_base.length());
+    Function<IterationDecision(const String&)> relative_callback = [&](auto& match) {
+        auto entry = match.substring(resolved_base.length(), match.length() - resolved_base.length());
         if (entry.is_empty())
             entry = ".";
+        return callback(entry);
+    };
+    return for_each_glob_match(parts, 0, resolved_base, false, relative_callback);
+}
+
+const Vector<Shell::GlobDirectoryEntry>& Shell::cached_directory_listing(const String& path)
+{
+    auto it = m_glob_directory_cache.find(path);
+    if (it != m_glob_directory_cache.end())
+        return it->value;
+
+    Vector<GlobDirectoryEntry> entries;
+    Core::DirIterator di(path, Core::DirIterator::SkipParentAndBaseDir);
+    while (!di.has_error() && di.has_next()) {
+        auto type = di.next_type();
+        entries.append({ di.next_path(), type });
     }
 
-    // Make the output predictable and nice.
-    quick_sort(results);
+    m_glob_directory_cache.set(path, move(entries));
+    return m_glob_directory_cache.find(path)->value;
+}
 
-    return results;
+static String join_glob_path(const String& base, const String& name)
+{
+    StringBuilder builder;
+    builder.append(base);
+    if (!base.ends_with('/'))
+        builder.append('/');
+    builder.append(name);
+    return builder.build();
 }
 
-Vector<String> Shell::expand_globs(Vector<StringView> path_segments, const StringView& base)
+IterationDecision Shell::for_each_glob_match(const Vector<StringView>& path_segments, size_t segment_index, const String& base, bool known_to_exist, Function<IterationDecision(const String&)>& callback)
 {
-    if (path_segments.is_empty()) {
-        String base_str = base;
-        if (access(base_str.characters(), F_OK) == 0)
-            return { move(base_str) };
-        return {};
+    if (segment_index == path_segments.size()) {
+        if (known_to_exist || access(base.characters(), F_OK) == 0)
+            return callback(base);
+        return IterationDecision::Continue;
     }
 
-    auto first_segment = path_segments.take_first();
-    if (is_glob(first_segment)) {
-        Vector<String> result;
+    auto segment = path_segments[segment_index];
+    bool is_last_segment = segment_index + 1 == path_segments.size();
 
-        Core::DirIterator di(base, Core::DirIterator::SkipParentAndBaseDir);
-        if (di.has_error())
-            return {};
+    if (segment == "**") {
+        // Matches any number of directories, including none at all.
+        if (!is_last_segment && for_each_glob_match(path_segments, segment_index + 1, base, false, callback) == IterationDecision::Break)
+            return IterationDecision::Break;
 
-        while (di.has_next()) {
-            String path = di.next_path();
-
-            // Dotfiles have to be explicitly requested
-            if (path[0] == '.' && first_segment[0] != '.')
+        // Copy the listing, the recursion below may rehash the cache.
+        auto entries = cached_directory_listing(base);
+        for (auto& entry : entries) {
+            if (entry.name[0] == '.')
                 continue;
+            auto path = join_glob_path(base, entry.name);
+            if (is_last_segment && callback(path) == IterationDecision::Break)
+                return IterationDecision::Break;
 
-            if (path.matches(first_segment, CaseSensitivity::CaseSensitive)) {
-                StringBuilder builder;
-                builder.append(base);
-                if (!base.ends_with('/'))
-                    builder.append('/');
-                builder.append(path);
-                result.append(expand_globs(path_segments, builder.string_view()));
+            // Don't follow symlinks here, they could lead us around in circles.
+            auto type = entry.type;
+            if (type == DT_UNKNOWN) {
+                struct stat st;
+                if (lstat(path.characters(), &st) == 0 && S_ISDIR(st.st_mode))
+                    type = DT_DIR;
             }
+            if (type == DT_DIR && for_each_glob_match(path_segments, segment_index, path, true, callback) == IterationDecision::Break)
+                return IterationDecision::Break;
         }
+        return IterationDecision::Continue;
+    }
 
-        return result;
-    } else {
-        StringBuilder builder;
-        builder.append(base);
-        if (!base.ends_with('/'))
-            builder.append('/');
-        builder.append(first_segment);
+    if (!is_glob(segment))
+        return for_each_glob_match(path_segments, segment_index + 1, join_glob_path(base, segment), false, callback);
 
-        return expand_globs(move(path_segments), builder.string_view());
+    // Every match has to start with the literal part of the pattern, which is much cheaper to check.
+    size_t literal_prefix_length = 0;
+    while (literal_prefix_length < segment.length() && segment[literal_prefix_length] != '*' && segment[literal_prefix_length] != '?')
+        ++literal_prefix_length;
+    auto literal_prefix = segment.substring_view(0, literal_prefix_length);
+
+    auto entries = cached_directory_listing(base);
+    for (auto& entry : entries) {
+        // Dotfiles have to be explicitly requested
+        if (entry.name[0] == '.' && segment[0] != '.')
+            continue;
+
+        if (!entry.name.starts_with(literal_prefix))
+            continue;
+
+        // Only directories (or what may point to one) can match a segment with more to follow.
+        if (!is_last_segment && entry.type != DT_DIR && entry.type != DT_LNK && entry.type != DT_UNKNOWN)
+            continue;
+
+        if (!entry.name.matches(segment, CaseSensitivity::CaseSensitive))
+            continue;
+
+        if (for_each_glob_match(path_segments, segment_index + 1, join_glob_path(base, entry.name), true, callback) == IterationDecision::Break)
+            return IterationDecision::Break;
     }
+
+    return IterationDecision::Continue;
 }
 
 Vector<AST::Command> Shell::expand_aliases(Vector<AST::Command> initial_commands)
@@ -392,9 +453,8 @@ bool Shell::is_runnable(const StringView& name)
     if (access(name.to_string().characters(), X_OK) == 0)
         return true;
 
-    return !!binary_search(cached_path.span(), name.to_string(), [](const String& name, const String& program) -> int {
-        return strcmp(name.characters(), program.characters());
-    });
+    ensure_path_is_cached();
+    return m_program_cache.contains(name.to_string());
 }
 
 int Shell::run_command(const StringView& cmd)
@@ -402,6 +462,9 @@ int Shell::run_command(const StringView& cmd)
     if (cmd.is_empty())
         return 0;
 
+    m_glob_directory_cache.clear();
+    m_path_completion_cache.clear();
+
     auto command = Parser(cmd).parse();
 
     if (!command)
@@ -439,6 +502,9 @@ RefPtr<Job> Shell::run_command(const AST::Command& command)
 {
     FileDescriptionCollector fds;
 
+    m_glob_directory_cache.clear();
+    m_path_completion_cache.clear();
+
     if (options.verbose) {
         fprintf(stderr, "+ ");
         for (auto& arg : command.argv)
@@ -509,20 +575,46 @@ RefPtr<Job> Shell::run_command(const AST::Command& command)
 
     argv.append(nullptr);
 
-    int retval = 0;
-    if (run_builtin(argv.size() - 1, argv.data(), retval))
-        return nullptr;
-
-    int sync_pipe[2];
-    if (pipe(sync_pipe) < 0) {
-        perror("pipe");
+    // Builtins act on the shell itself, so they run right here. The exception is a builtin feeding
+    // a pipe: its reader hasn't been started yet, and a full pipe would block the shell forever.
+    bool is_builtin = has_builtin(argv[0]);
+    if (is_builtin && !command.is_pipe_source) {
+        int retval = 0;
+        run_builtin_in_process(argv, rewirings, retval);
+        last_return_code = retval;
         return nullptr;
     }
 
-    pid_t child = fork();
-    if (child < 0) {
-        perror("fork");
-        return nullptr;
+    bool is_first = !command.pipeline || (command.pipeline && command.pipeline->pgid == -1);
+
+    pid_t child = -1;
+    int sync_pipe[2] { -1, -1 };
+
+    // Only a command that's about to take the terminal needs code to run in the child before exec.
+    // Anything else can be spawned directly from its cached path, without a $PATH walk.
+    Optional<String> program_path;
+    if (!is_builtin && !command.should_wait)
+        program_path = cached_program_path(argv[0]);
+
+    if (program_path.has_value()) {
+        child = spawn_program(program_path.value(), argv, rewirings, fds, is_first ? 0 : command.pipeline->pgid);
+        if (child < 0)
+            return nullptr;
+    } else {
+        if (pipe(sync_pipe) < 0) {
+            perror("pipe");
+            return nullptr;
+        }
+
+        // Don't let a forked builtin flush our buffered output a second time.
+        fflush(stdout);
+        fflush(stderr);
+
+        child = fork();
+        if (child < 0) {
+            perror("fork");
+            return nullptr;
+        }
     }
 
     if (child == 0) {
@@ -559,6 +651,13 @@ RefPtr<Job> Shell::run_command(const AST::Command& command)
 
         close(sync_pipe[0]);
 
+        int retval = 0;
+        if (run_builtin(argv.size() - 1, argv.data(), retval)) {
+            fflush(stdout);
+            fflush(stderr);
+            _exit(retval);
+        }
+
         int rc = execvp(argv[0], const_cast<char* const*>(argv.data()));
         if (rc < 0) {
             if (errno == ENOENT) {
@@ -587,9 +686,8 @@ RefPtr<Job> Shell::run_command(const AST::Command& command)
         ASSERT_NOT_REACHED();
     }
 
-    close(sync_pipe[0]);
-
-    bool is_first = !command.pipeline || (command.pipeline && command.pipeline->pgid == -1);
+    if (sync_pipe[0] != -1)
+        close(sync_pipe[0]);
 
     if (command.pipeline) {
         if (is_first) {
@@ -597,8 +695,10 @@ RefPtr<Job> Shell::run_command(const AST::Command& command)
         }
     }
 
+    // A spawned child sets its own process group too, and may already have exec'd by now (EACCES).
+    // Setting it from here as well makes sure the group exists before the next stage joins it.
     pid_t pgid = is_first ? child : (command.pipeline ? command.pipeline->pgid : child);
-    if (setpgid(child, pgid) < 0)
+    if (setpgid(child, pgid) < 0 && errno != EACCES)
         perror("setpgid");
 
     if (command.should_wait) {
@@ -606,16 +706,18 @@ RefPtr<Job> Shell::run_command(const AST::Command& command)
         tcsetpgrp(STDIN_FILENO, pgid);
     }
 
-    while (write(sync_pipe[1], "x", 1) < 0) {
-        if (errno != EINTR) {
-            perror("write");
-            // There's nothing interesting we can do here.
-            break;
+    if (sync_pipe[1] != -1) {
+        while (write(sync_pipe[1], "x", 1) < 0) {
+            if (errno != EINTR) {
+                perror("write");
+                // There's nothing interesting we can do here.
+                break;
+            }
+            dbg() << "Oof";
         }
-        dbg() << "Oof";
-    }
 
-    close(sync_pipe[1]);
+        close(sync_pipe[1]);
+    }
 
     StringBuilder cmd;
     cmd.join(" ", command.argv);
@@ -636,6 +738,87 @@ RefPtr<Job> Shell::run_command(const AST::Command& command)
     return *job;
 }
 
+bool Shell::run_builtin_in_process(const Vector<const char*>& argv, const NonnullRefPtrVector<AST::Rewiring>& rewirings, int& retval)
+{
+    struct SavedFileDescriptor {
+        int original;
+        int saved;
+    };
+    Vector<SavedFileDescriptor, 4> saved_fds;
+
+    fflush(stdout);
+    fflush(stderr);
+
+    for (auto& rewiring : rewirings) {
+        int saved = fcntl(rewiring.source_fd, F_DUPFD, 10);
+        if (saved >= 0)
+            fcntl(saved, F_SETFD, FD_CLOEXEC);
+        saved_fds.append({ rewiring.source_fd, saved });
+        if (dup2(rewiring.dest_fd, rewiring.source_fd) < 0)
+            perror("dup2(builtin)");
+    }
+
+    bool did_run = run_builtin(argv.size() - 1, const_cast<const char**>(argv.data()), retval);
+
+    fflush(stdout);
+    fflush(stderr);
+
+    // Undo the redirections in reverse, in case several of them rewired the same descriptor.
+    for (ssize_t i = saved_fds.size() - 1; i >= 0; --i) {
+        auto& fd = saved_fds[i];
+        if (fd.saved < 0) {
+            close(fd.original);
+            continue;
+        }
+        if (dup2(fd.saved, fd.original) < 0)
+            perror("dup2(restore)");
+        close(fd.saved);
+    }
+
+    return did_run;
+}
+
+pid_t Shell::spawn_program(const String& program_path, const Vector<const char*>& argv, const NonnullRefPtrVector<AST::Rewiring>& rewirings, const FileDescriptionCollector& fds, pid_t pgid)
+{
+    posix_spawn_file_actions_t file_actions;
+    posix_spawn_file_actions_init(&file_actions);
+
+    // Mirror what a forked child does: rewire first, then drop every descriptor it mustn't keep.
+    // A failing action kills the child, so don't close anything twice.
+    Vector<int, 32> fds_to_close;
+    auto close_in_child = [&](int fd) {
+        if (fd >= 0 && !fds_to_close.contains_slow(fd))
+            fds_to_close.append(fd);
+    };
+
+    for (auto& rewiring : rewirings) {
+        posix_spawn_file_actions_adddup2(&file_actions, rewiring.dest_fd, rewiring.source_fd);
+        if (rewiring.other_pipe_end)
+            close_in_child(rewiring.other_pipe_end->dest_fd);
+    }
+    for (auto fd : fds.fds())
+        close_in_child(fd);
+    for (auto fd : fds_to_close)
+        posix_spawn_file_actions_addclose(&file_actions, fd);
+
+    posix_spawnattr_t attributes;
+    posix_spawnattr_init(&attributes);
+    posix_spawnattr_setflags(&attributes, POSIX_SPAWN_SETPGROUP);
+    posix_spawnattr_setpgroup(&attributes, pgid);
+
+    pid_t child = -1;
+    int rc = posix_spawn(&child, program_path.characters(), &file_actions, &attributes, const_cast<char* const*>(argv.data()), environ);
+
+    posix_spawnattr_destroy(&attributes);
+    posix_spawn_file_actions_destroy(&file_actions);
+
+    if (rc != 0) {
+        fprintf(stderr, "posix_spawn(%s): %s\n", argv[0], strerror(rc));
+        return -1;
+    }
+    return child;
+}
+
 NonnullRefPtrVector<Job> Shell::run_commands(Vector<AST::Command>& commands)
 {
     NonnullRefPtrVector<Job> jobs_to_wait_for;
@@ -738,26 +921,13 @@ String Shell::get_history_path()
 
 void Shell::load_history()
 {
-    auto history_file = Core::File::construct(get_history_path());
-    if (!history_file->open(Core::IODevice::ReadOnly))
-        return;
-    while (history_file->can_read_line()) {
-        auto b = history_file->read_line(1024);
-        // skip the newline and terminating bytes
-        editor->add_to_history(String(reinterpret_cast<const char*>(b.data()), b.size() - 2));
-    }
+    editor->set_history_capacity(history_capacity);
+    editor->load_history(get_history_path());
 }
 
 void Shell::save_history()
 {
-    auto file_or_error = Core::File::open(get_history_path(), Core::IODevice::WriteOnly, 0600);
-    if (file_or_error.is_error())
-        return;
-    auto& file = *file_or_error.value();
-    for (const auto& line : editor->history()) {
-        file.write(line);
-        file.write("\n");
-    }
+    editor->save_history(get_history_path());
 }
 
 String Shell::escape_token(const String& token)
@@ -818,57 +988,100 @@ String Shell::unescape_token(const String& token)
 
 void Shell::cache_path()
 {
-    if (!cached_path.is_empty())
-        cached_path.clear_with_capacity();
+    m_program_cache.clear();
+    m_sorted_cached_names_are_stale = true;
+    m_path_cache_is_stale = false;
+
+    for (auto& watcher : m_path_watchers)
+        close(watcher.fd());
+    m_path_watchers.clear();
 
     // Add shell builtins to the cache.
     for (const auto& builtin_name : builtin_names)
-        cached_path.append(escape_token(builtin_name));
+        m_program_cache.set(escape_token(builtin_name), {});
 
     // Add aliases to the cache.
-    for (const auto& alias : m_aliases) {
-        auto name = escape_token(alias.key);
-        if (cached_path.contains_slow(name))
-            continue;
-        cached_path.append(name);
-    }
+    for (const auto& alias : m_aliases)
+        m_program_cache.set(escape_token(alias.key), {});
 
     String path = getenv("PATH");
-    if (!path.is_empty()) {
-        auto directories = path.split(':');
-        for (const auto& directory : directories) {
-            Core::DirIterator programs(directory.characters(), Core::DirIterator::SkipDots);
-            while (programs.has_next()) {
-                auto program = programs.next_path();
-                String program_path = String::format("%s/%s", directory.characters(), program.characters());
-                auto escaped_name = escape_token(program);
-                if (cached_path.contains_slow(escaped_name))
-                    continue;
-                if (access(program_path.characters(), X_OK) == 0)
-                    cached_path.append(escaped_name);
-            }
+    if (path.is_empty())
+        return;
+
+    auto directories = path.split(':');
+    for (const auto& directory : directories) {
+        Core::DirIterator programs(directory.characters(), Core::DirIterator::SkipDots);
+        while (programs.has_next()) {
+            auto program = programs.next_path();
+            auto escaped_name = escape_token(program);
+            // Earlier PATH entries win, as they would for execvp().
+            if (m_program_cache.contains(escaped_name))
+                continue;
+            String program_path = String::format("%s/%s", directory.characters(), program.characters());
+            if (access(program_path.characters(), X_OK) == 0)
+                m_program_cache.set(escaped_name, program_path);
         }
+        watch_path_directory(directory);
     }
+}
+
+void Shell::watch_path_directory(const String& directory)
+{
+#ifdef __serenity__
+    int watch_fd = watch_file(directory.characters(), directory.length());
+    if (watch_fd < 0)
+        return;
+    fcntl(watch_fd, F_SETFD, FD_CLOEXEC);
+
+    // Any change to a PATH directory invalidates the whole cache; it's rebuilt on the next lookup.
+    auto notifier = Core::Notifier::construct(watch_fd, Core::Notifier::Event::Read);
+    notifier->on_ready_to_read = [this, watch_fd] {
+        char buffer[4096];
+        read(watch_fd, buffer, sizeof(buffer));
+        m_path_cache_is_stale = true;
+    };
+    m_path_watchers.append(move(notifier));
+#else
+    // There's no watch_file() on other systems; `export PATH=...` still rebuilds the cache.
+    (void)directory;
+#endif
+}
 
-    quick_sort(cached_path);
+void Shell::ensure_path_is_cached()
+{
+    if (m_path_cache_is_stale)
+        cache_path();
 }
 
-void Shell::add_entry_to_cache(const String& entry)
+void Shell::add_entry_to_cache(const String& entry, const String& path)
 {
-    size_t index = 0;
-    auto match = binary_search(
-        cached_path.span(), entry, [](const String& name, const String& program) -> int {
-            return strcmp(name.characters(), program.characters());
-        },
-        &index);
-
-    if (match)
+    ensure_path_is_cached();
+    if (m_program_cache.contains(entry))
         return;
+    m_program_cache.set(entry, path);
+    m_sorted_cached_names_are_stale = true;
+}
 
-    while (strcmp(cached_path[index].characters(), entry.characters()) < 0) {
-        index++;
+Optional<String> Shell::cached_program_path(const String& name)
+{
+    ensure_path_is_cached();
+    auto path = m_program_cache.get(escape_token(name));
+    if (!path.has_value() || path.value().is_empty())
+        return {};
+    return path.value();
+}
+
+Vector<String, 256>& Shell::sorted_cached_names()
+{
+    ensure_path_is_cached();
+    if (m_sorted_cached_names_are_stale) {
+        m_sorted_cached_names.clear_with_capacity();
+        for (auto& entry : m_program_cache)
+            m_sorted_cached_names.append(entry.key);
+        quick_sort(m_sorted_cached_names);
+        m_sorted_cached_names_are_stale = false;
     }
-    cached_path.insert(index, entry);
+    return m_sorted_cached_names;
 }
 
 void Shell::highlight(Line::Editor& editor) const
@@ -937,34 +1150,41 @@ Vector<Line::CompletionSuggestion> Shell::complete_path(const String& base, cons
     auto token_length = escape_token(token).length();
     editor->suggest(token_length, original_token.length() - token_length);
 
-    // only suggest dot-files if path starts with a dot
-    Core::DirIterator files(path,
-        token.starts_with('.') ? Core::DirIterator::SkipParentAndBaseDir : Core::DirIterator::SkipDots);
-
-    Vector<Line::CompletionSuggestion> suggestions;
-
-    while (files.has_next()) {
-        auto file = files.next_path();
-        if (file.starts_with(token)) {
-            struct stat program_status;
-            String file_path = String::format("%s/%s", path.characters(), file.characters());
-            int stat_error = stat(file_path.characters(), &program_status);
-            if (!stat_error) {
-                if (S_ISDIR(program_status.st_mode)) {
-                    suggestions.append({ escape_token(file), "/" });
-                } else {
-                    suggestions.append({ escape_token(file), " " });
-                }
+    // Typing more of the same name only narrows down the last set of matches, so there's no need to look at the directory again.
+    auto& cache = m_path_completion_cache;
+    if (!cache.has_value() || cache.value().directory != path || !token.starts_with(cache.value().token) || (token.starts_with('.') && !cache.value().token.starts_with('.'))) {
+        cache = PathCompletionCache { path, {}, {} };
+        for (auto& entry : cached_directory_listing(path)) {
+            // only suggest dot-files if path starts with a dot
+            if (entry.name.starts_with('.') && !token.starts_with('.'))
+                continue;
+            if (!entry.name.starts_with(token))
+                continue;
+            bool is_directory = entry.type == DT_DIR;
+            if (entry.type == DT_LNK || entry.type == DT_UNKNOWN) {
+                struct stat program_status;
+                String file_path = String::format("%s/%s", path.characters(), entry.name.characters());
+                if (stat(file_path.characters(), &program_status) < 0)
+                    continue;
+                is_directory = S_ISDIR(program_status.st_mode);
             }
+            cache.value().matches.append({ entry.name, is_directory ? DT_DIR : DT_REG });
         }
+    } else {
+        cache.value().matches.remove_all_matching([&](auto& entry) { return !entry.name.starts_with(token); });
     }
+    cache.value().token = token;
 
+    Vector<Line::CompletionSuggestion> suggestions;
+    for (auto& entry : cache.value().matches)
+        suggestions.append({ escape_token(entry.name), entry.type == DT_DIR ? "/" : " " });
     return suggestions;
 }
 
 Vector<Line::CompletionSuggestion> Shell::complete_program_name(const String& name, size_t offset)
 {
-    auto match = binary_search(cached_path.span(), name, [](const String& name, const String& program) -> int {
+    auto& cached_names = sorted_cached_names();
+    auto match = binary_search(cached_names.span(), name, [](const String& name, const String& program) -> int {
         return strncmp(name.characters(), program.characters(), name.length());
     });
 
@@ -980,14 +1200,14 @@ Vector<Line::CompletionSuggestion> Shell::complete_program_name(const String& na
 
     Vector<Line::CompletionSuggestion> suggestions;
 
-    int index = match - cached_path.data();
-    for (int i = index - 1; i >= 0 && cached_path[i].starts_with(name); --i) {
-        suggestions.append({ cached_path[i], " " });
+    int index = match - cached_names.data();
+    for (int i = index - 1; i >= 0 && cached_names[i].starts_with(name); --i) {
+        suggestions.append({ cached_names[i], " " });
     }
-    for (size_t i = index + 1; i < cached_path.size() && cached_path[i].starts_with(name); ++i) {
-        suggestions.append({ cached_path[i], " " });
+    for (size_t i = index + 1; i < cached_names.size() && cached_names[i].starts_with(name); ++i) {
+        suggestions.append({ cached_names[i], " " });
     }
-    suggestions.append({ cached_path[index], " " });
+    suggestions.append({ cached_names[index], " " });
 
     return suggestions;
 }
@@ -64,6 +64,7 @@
     __ENUMERATE_SHELL_OPTION(inline_exec_keep_empty_segments, false, "Keep empty segments in inline execute $(...)") \
     __ENUMERATE_SHELL_OPTION(verbose, false, "Announce every command that is about to be executed")
 
+class FileDescriptionCollector;
 class Shell;
 
 class Shell : public Core::Object {
@@ -84,8 +85,9 @@ public:
     String prompt() const;
 
     static String expand_tilde(const String&);
-    static Vector<String> expand_globs(const StringView& path, StringView base);
-    static Vector<String> expand_globs(Vector<StringView> path_segments, const StringView& base);
+    Vector<String> expand_globs(const StringView& path, StringView base);
+    // Calls back with each match relative to `base` as soon as it's found, in directory order.
+    IterationDecision for_each_glob_match(const StringView& path, StringView base, Function<IterationDecision(const String&)>);
     Vector<AST::Command> expand_aliases(Vector<AST::Command>);
     String resolve_path(String) const;
     String resolve_alias(const String&) const;
@@ -142,6 +144,7 @@ public:
     String get_history_path();
     void load_history();
     void save_history();
+    static constexpr size_t history_capacity = 10000;
     void print_path(const String& path);
 
     bool read_single_line();
@@ -166,7 +169,6 @@ public:
     Vector<String> directory_stack;
     CircularQueue<String, 8> cd_history; // FIXME: have a configurable cd history length
     HashMap<u64, NonnullRefPtr<Job>> jobs;
-    Vector<String, 256> cached_path;
 
     enum ShellEventType {
         ReadLine,
@@ -189,7 +191,19 @@ private:
     virtual void save_to(JsonObject&) override;
 
     void cache_path();
-    void add_entry_to_cache(const String&);
+    void ensure_path_is_cached();
+    void watch_path_directory(const String&);
+    void add_entry_to_cache(const String&, const String& path = {});
+    Optional<String> cached_program_path(const String& name);
+    Vector<String, 256>& sorted_cached_names();
+    struct GlobDirectoryEntry {
+        String name;
+        unsigned char type;
+    };
+    const Vector<GlobDirectoryEntry>& cached_directory_listing(const String& path);
+    IterationDecision for_each_glob_match(const Vector<StringView>& path_segments, size_t segment_index, const String& base, bool known_to_exist, Function<IterationDecision(const String&)>&);
+    bool run_builtin_in_process(const Vector<const char*>& argv, const NonnullRefPtrVector<AST::Rewiring>&, int& retval);
+    pid_t spawn_program(const String& program_path, const Vector<const char*>& argv, const NonnullRefPtrVector<AST::Rewiring>&, const FileDescriptionCollector&, pid_t pgid);
     void stop_all_jobs();
     const Job* m_current_job { nullptr };
     LocalFrame* find_frame_containing_local_variable(const String& name);
@@ -220,6 +234,25 @@ private:
 
     HashMap<String, String> m_aliases;
     bool m_is_interactive { true };
+
+    // Escaped program name -> full path. Builtins and aliases map to an empty path.
+    HashMap<String, String> m_program_cache;
+    // Only rebuilt for completion, which needs the names in order.
+    Vector<String, 256> m_sorted_cached_names;
+    bool m_sorted_cached_names_are_stale { true };
+    bool m_path_cache_is_stale { true };
+    NonnullRefPtrVector<Core::Notifier> m_path_watchers;
+
+    // Directory listings read while expanding globs. Dropped whenever a command runs, as it may change them.
+    HashMap<String, Vector<GlobDirectoryEntry>> m_glob_directory_cache;
+
+    // What the last path completion matched, so it can be narrowed down as the user types on.
+    struct PathCompletionCache {
+        String directory;
+        String token;
+        Vector<GlobDirectoryEntry> matches;
+    };
+    Optional<PathCompletionCache> m_path_completion_cache;
 };
 
 static constexpr bool is_word_character(char c)
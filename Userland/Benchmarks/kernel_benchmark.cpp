@@ -0,0 +1,423 @@
+/*
+ * Copyright (c) 2018-2020, The SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <AK/JsonArray.h>
+#include <AK/JsonObject.h>
+#include <AK/Optional.h>
+#include <AK/StringView.h>
+#include <AK/Types.h>
+#include <AK/Vector.h>
+#include <LibCore/ArgsParser.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <serenity.h>
+#include <spawn.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+// Costs of the kernel's hot paths, measured from userspace. Each benchmark reports a single
+// number, so that runs from different builds can be compared (or diffed, with --json).
+
+extern char** environ;
+
+static u64 now_ns()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (u64)ts.tv_sec * 1'000'000'000 + ts.tv_nsec;
+}
+
+static bool wait_for_child(pid_t pid)
+{
+    int status = 0;
+    return waitpid(pid, &status, 0) == pid && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+static Optional<u64> null_syscall()
+{
+    constexpr int iterations = 100000;
+    u64 start = now_ns();
+    for (int i = 0; i < iterations; ++i)
+        getppid();
+    return (now_ns() - start) / iterations;
+}
+
+static Optional<u64> pipe_ping_pong()
+{
+    constexpr int round_trips = 10000;
+    int to_child[2];
+    int to_parent[2];
+    if (pipe(to_child) < 0 || pipe(to_parent) < 0) {
+        perror("pipe");
+        return {};
+    }
+
+    pid_t pid = fork();
+    if (pid < 0) {
+        perror("fork");
+        return {};
+    }
+    if (pid == 0) {
+        close(to_child[1]);
+        close(to_parent[0]);
+        char byte;
+        while (read(to_child[0], &byte, 1) == 1)
+            write(to_parent[1], &byte, 1);
+        _exit(0);
+    }
+    close(to_child[0]);
+    close(to_parent[1]);
+
+    u64 start = now_ns();
+    for (int i = 0; i < round_trips; ++i) {
+        char byte = 'x';
+        if (write(to_child[1], &byte, 1) != 1 || read(to_parent[0], &byte, 1) != 1) {
+            perror("ping-pong");
+            return {};
+        }
+    }
+    u64 elapsed = now_ns() - start;
+
+    close(to_child[1]);
+    close(to_parent[0]);
+    if (!wait_for_child(pid))
+        return {};
+    // Every round trip switches to the child and back.
+    return elapsed / (round_trips * 2);
+}
+
+static int32_t s_futex_turn;
+
+static void pass_futex_turn(int32_t to)
+{
+    __atomic_store_n(&s_futex_turn, to, __ATOMIC_RELEASE);
+    futex(&s_futex_turn, FUTEX_WAKE, 1, nullptr);
+}
+
+static void wait_for_futex_turn(int32_t mine)
+{
+    for (;;) {
+        int32_t turn = __atomic_load_n(&s_futex_turn, __ATOMIC_ACQUIRE);
+        if (turn == mine)
+            return;
+        futex(&s_futex_turn, FUTEX_WAIT, turn, nullptr);
+    }
+}
+
+static constexpr int futex_round_trips = 10000;
+
+static void* futex_partner(void*)
+{
+    for (int i = 0; i < futex_round_trips; ++i) {
+        wait_for_futex_turn(1);
+        pass_futex_turn(0);
+    }
+    return nullptr;
+}
+
+static Optional<u64> futex_wake()
+{
+    s_futex_turn = 0;
+    pthread_t thread;
+    if (pthread_create(&thread, nullptr, futex_partner, nullptr) != 0) {
+        perror("pthread_create");
+        return {};
+    }
+
+    u64 start = now_ns();
+    for (int i = 0; i < futex_round_trips; ++i) {
+        pass_futex_turn(1);
+        wait_for_futex_turn(0);
+    }
+    u64 elapsed = now_ns() - start;
+
+    pthread_join(thread, nullptr);
+    return elapsed / (futex_round_trips * 2);
+}
+
+static Optional<u64> anonymous_page_fault()
+{
+    constexpr size_t size = 64 * MB;
+    auto* region = (u8*)mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE, 0, 0);
+    if (region == MAP_FAILED) {
+        perror("mmap");
+        return {};
+    }
+
+    u64 start = now_ns();
+    for (size_t offset = 0; offset < size; offset += PAGE_SIZE)
+        region[offset] = 1;
+    u64 elapsed = now_ns() - start;
+
+    munmap(region, size);
+    return elapsed / (size / PAGE_SIZE);
+}
+
+template<typename Callback>
+static Optional<u64> time_children(Callback start_child)
+{
+    constexpr int iterations = 200;
+    u64 start = now_ns();
+    for (int i = 0; i < iterations; ++i) {
+        pid_t pid = start_child();
+        if (pid < 0 || !wait_for_child(pid))
+            return {};
+    }
+    return (now_ns() - start) / iterations / 1000;
+}
+
+static Optional<u64> fork_exit()
+{
+    return time_children([] {
+        pid_t pid = fork();
+        if (pid < 0)
+            perror("fork");
+        if (pid == 0)
+            _exit(0);
+        return pid;
+    });
+}
+
+static Optional<u64> fork_exec()
+{
+    return time_children([] {
+        pid_t pid = fork();
+        if (pid < 0)
+            perror("fork");
+        if (pid == 0) {
+            const char* argv[] = { "/bin/true", nullptr };
+            execve(argv[0], const_cast<char**>(argv), environ);
+            _exit(127);
+        }
+        return pid;
+    });
+}
+
+static Optional<u64> spawn()
+{
+    return time_children([] {
+        pid_t pid;
+        const char* argv[] = { "/bin/true", nullptr };
+        int rc = posix_spawn(&pid, argv[0], nullptr, nullptr, const_cast<char**>(argv), environ);
+        if (rc != 0) {
+            fprintf(stderr, "posix_spawn: %s\n", strerror(rc));
+            return -1;
+        }
+        return pid;
+    });
+}
+
+static constexpr size_t transfer_size = 32 * MB;
+static constexpr size_t transfer_chunk_size = 64 * KB;
+
+// Forks a writer that connects with connect_to() and sends transfer_size bytes, and returns the MiB/s read.
+template<typename ConnectCallback>
+static Optional<u64> measure_stream(int listen_fd, ConnectCallback connect_to)
+{
+    pid_t pid = fork();
+    if (pid < 0) {
+        perror("fork");
+        return {};
+    }
+    if (pid == 0) {
+        int fd = connect_to();
+        if (fd < 0)
+            _exit(1);
+        static u8 buffer[transfer_chunk_size];
+        memset(buffer, 0x5a, sizeof(buffer));
+        for (size_t total_written = 0; total_written < transfer_size;) {
+            ssize_t nwritten = write(fd, buffer, sizeof(buffer));
+            if (nwritten <= 0)
+                _exit(1);
+            total_written += nwritten;
+        }
+        close(fd);
+        _exit(0);
+    }
+
+    int fd = accept(listen_fd, nullptr, nullptr);
+    if (fd < 0) {
+        perror("accept");
+        return {};
+    }
+    u64 start = now_ns();
+    size_t total_read = 0;
+    for (;;) {
+        static u8 buffer[transfer_chunk_size];
+        ssize_t nread = read(fd, buffer, sizeof(buffer));
+        if (nread < 0) {
+            perror("read");
+            break;
+        }
+        if (nread == 0)
+            break;
+        total_read += nread;
+    }
+    u64 elapsed = now_ns() - start;
+    close(fd);
+
+    if (!wait_for_child(pid) || total_read != transfer_size)
+        return {};
+    return (u64)transfer_size * 1'000'000'000 / max(elapsed, (u64)1) / MB;
+}
+
+static Optional<u64> local_socket_throughput()
+{
+    sockaddr_un address {};
+    address.sun_family = AF_UNIX;
+    strncpy(address.sun_path, "/tmp/kernel_benchmark", sizeof(address.sun_path) - 1);
+    unlink(address.sun_path);
+
+    int listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listen_fd < 0 || bind(listen_fd, (const sockaddr*)&address, sizeof(address)) < 0 || listen(listen_fd, 1) < 0) {
+        perror("local socket");
+        return {};
+    }
+    auto result = measure_stream(listen_fd, [&] {
+        int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd >= 0 && connect(fd, (const sockaddr*)&address, sizeof(address)) < 0)
+            return -1;
+        return fd;
+    });
+    close(listen_fd);
+    unlink(address.sun_path);
+    return result;
+}
+
+static Optional<u64> tcp_loopback_throughput()
+{
+    sockaddr_in address {};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(8547);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    int listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (listen_fd < 0 || bind(listen_fd, (const sockaddr*)&address, sizeof(address)) < 0 || listen(listen_fd, 1) < 0) {
+        perror("tcp socket");
+        return {};
+    }
+    auto result = measure_stream(listen_fd, [&] {
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (fd >= 0 && connect(fd, (const sockaddr*)&address, sizeof(address)) < 0)
+            return -1;
+        return fd;
+    });
+    close(listen_fd);
+    return result;
+}
+
+static Optional<u64> mmap_munmap()
+{
+    constexpr int iterations = 10000;
+    u64 start = now_ns();
+    for (int i = 0; i < iterations; ++i) {
+        void* region = mmap(nullptr, PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE, 0, 0);
+        if (region == MAP_FAILED) {
+            perror("mmap");
+            return {};
+        }
+        munmap(region, PAGE_SIZE);
+    }
+    return (now_ns() - start) / iterations;
+}
+
+struct Benchmark {
+    const char* name;
+    const char* unit;
+    Optional<u64> (*run)();
+};
+
+// Keep names and units stable, tools compare results between runs by them.
+static const Benchmark s_benchmarks[] = {
+    { "null_syscall", "ns", null_syscall },
+    { "pipe_context_switch", "ns", pipe_ping_pong },
+    { "futex_wake", "ns", futex_wake },
+    { "anonymous_page_fault", "ns", anonymous_page_fault },
+    { "mmap_munmap", "ns", mmap_munmap },
+    { "fork_exit", "us", fork_exit },
+    { "fork_exec", "us", fork_exec },
+    { "posix_spawn", "us", spawn },
+    { "local_socket_throughput", "MiB/s", local_socket_throughput },
+    { "tcp_loopback_throughput", "MiB/s", tcp_loopback_throughput },
+};
+
+int main(int argc, char** argv)
+{
+    bool output_json = false;
+    Vector<const char*> names;
+
+    Core::ArgsParser args_parser;
+    args_parser.add_option(output_json, "Print the results as JSON", "json", 'j');
+    args_parser.add_positional_argument(names, "Only run these benchmarks", "name", Core::ArgsParser::Required::No);
+    args_parser.parse(argc, argv);
+
+    auto should_run = [&](const char* name) {
+        if (names.is_empty())
+            return true;
+        for (auto* requested : names) {
+            if (StringView(requested) == name)
+                return true;
+        }
+        return false;
+    };
+
+    JsonArray json_results;
+    bool any_failed = false;
+
+    for (auto& benchmark : s_benchmarks) {
+        if (!should_run(benchmark.name))
+            continue;
+
+        auto value = benchmark.run();
+        if (!value.has_value()) {
+            fprintf(stderr, "%s: failed\n", benchmark.name);
+            any_failed = true;
+            continue;
+        }
+
+        if (output_json) {
+            JsonObject result;
+            result.set("name", benchmark.name);
+            result.set("value", value.value());
+            result.set("unit", benchmark.unit);
+            json_results.append(move(result));
+        } else {
+            printf("%-24s %10llu %s\n", benchmark.name, value.value(), benchmark.unit);
+        }
+    }
+
+    if (output_json)
+        printf("%s\n", json_results.to_string().characters());
+
+    return any_failed ? 1 : 0;
+}
@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <assert.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <sys/event_set.h>
+#include <unistd.h>
+
+static int wait_without_blocking(int set_fd, event_set_event& event)
+{
+    timespec timeout = { 0, 0 };
+    return event_set_wait(set_fd, &event, 1, &timeout);
+}
+
+int main(int, char**)
+{
+    int level_pipe[2];
+    int edge_pipe[2];
+    int rc = pipe(level_pipe);
+    assert(rc == 0);
+    rc = pipe(edge_pipe);
+    assert(rc == 0);
+
+    int set_fd = event_set_create(O_CLOEXEC);
+    assert(set_fd >= 0);
+
+    rc = event_set_ctl(set_fd, EVENT_SET_CTL_ADD, level_pipe[0], EVENT_SET_IN, (void*)1);
+    assert(rc == 0);
+    rc = event_set_ctl(set_fd, EVENT_SET_CTL_ADD, level_pipe[0], EVENT_SET_IN, (void*)1);
+    assert(rc < 0);
+
+    event_set_event event;
+    assert(wait_without_blocking(set_fd, event) == 0);
+
+    // A level-triggered registration keeps reporting for as long as the pipe has data.
+    write(level_pipe[1], "x", 1);
+    for (int i = 0; i < 3; ++i) {
+        assert(wait_without_blocking(set_fd, event) == 1);
+        assert(event.events == EVENT_SET_IN);
+        assert(event.data == (void*)1);
+    }
+    char buffer[8];
+    read(level_pipe[0], buffer, sizeof(buffer));
+    assert(wait_without_blocking(set_fd, event) == 0);
+
+    rc = event_set_ctl(set_fd, EVENT_SET_CTL_REMOVE, level_pipe[0], 0, nullptr);
+    assert(rc == 0);
+    rc = event_set_ctl(set_fd, EVENT_SET_CTL_ADD, edge_pipe[0], EVENT_SET_IN | EVENT_SET_EDGE_TRIGGERED, (void*)2);
+    assert(rc == 0);
+
+    // An edge-triggered registration reports once, and again only after it has been re-armed by a read.
+    write(edge_pipe[1], "xy", 2);
+    assert(wait_without_blocking(set_fd, event) == 1);
+    assert(event.data == (void*)2);
+    assert(wait_without_blocking(set_fd, event) == 0);
+    read(edge_pipe[0], buffer, 1);
+    assert(wait_without_blocking(set_fd, event) == 1);
+    read(edge_pipe[0], buffer, 1);
+    assert(wait_without_blocking(set_fd, event) == 0);
+
+    // Closing the last fd for a description drops its registration.
+    close(edge_pipe[0]);
+    close(edge_pipe[1]);
+    assert(wait_without_blocking(set_fd, event) == 0);
+
+    printf("PASS\n");
+    return 0;
+}
@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <AK/Types.h>
+#include <spawn.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+// Latency of starting a child that exits or execs right away, the way a shell does it.
+// Everything runs twice: once as a small process, and again after dirtying a large mapping,
+// since building the child's page tables is what used to make fork() scale with our size.
+
+static constexpr int iteration_count = 200;
+static constexpr size_t dirty_size = 64 * MB;
+
+extern char** environ;
+
+static u64 now_ns()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (u64)ts.tv_sec * 1'000'000'000 + ts.tv_nsec;
+}
+
+static bool fork_and_exit()
+{
+    pid_t pid = fork();
+    if (pid < 0) {
+        perror("fork");
+        return false;
+    }
+    if (pid == 0)
+        _exit(0);
+    return waitpid(pid, nullptr, 0) == pid;
+}
+
+static bool fork_and_exec()
+{
+    pid_t pid = fork();
+    if (pid < 0) {
+        perror("fork");
+        return false;
+    }
+    if (pid == 0) {
+        const char* argv[] = { "/bin/true", nullptr };
+        execve(argv[0], const_cast<char**>(argv), environ);
+        _exit(127);
+    }
+    int status = 0;
+    return waitpid(pid, &status, 0) == pid && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+static bool spawn()
+{
+    pid_t pid;
+    const char* argv[] = { "/bin/true", nullptr };
+    int rc = posix_spawn(&pid, argv[0], nullptr, nullptr, const_cast<char**>(argv), environ);
+    if (rc != 0) {
+        fprintf(stderr, "posix_spawn: %s\n", strerror(rc));
+        return false;
+    }
+    int status = 0;
+    return waitpid(pid, &status, 0) == pid && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+static bool benchmark(const char* name, bool (*function)())
+{
+    u64 start = now_ns();
+    for (int i = 0; i < iteration_count; ++i) {
+        if (!function())
+            return false;
+    }
+    u64 elapsed_ns = now_ns() - start;
+    printf("%-16s %llu us per child\n", name, elapsed_ns / iteration_count / 1000);
+    return true;
+}
+
+static bool run_all()
+{
+    return benchmark("fork+_exit", fork_and_exit)
+        && benchmark("fork+exec", fork_and_exec)
+        && benchmark("posix_spawn", spawn);
+}
+
+int main()
+{
+    printf("Small process:\n");
+    if (!run_all())
+        return 1;
+
+    auto* dirty = (u8*)mmap(nullptr, dirty_size, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE, 0, 0);
+    if (dirty == MAP_FAILED) {
+        perror("mmap");
+        return 1;
+    }
+    for (size_t i = 0; i < dirty_size; i += PAGE_SIZE)
+        dirty[i] = 1;
+
+    printf("With %zu MiB dirtied:\n", dirty_size / MB);
+    if (!run_all())
+        return 1;
+    munmap(dirty, dirty_size);
+    return 0;
+}
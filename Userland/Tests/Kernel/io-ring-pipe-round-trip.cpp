@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/io_ring.h>
+#include <unistd.h>
+
+static io_ring_header* s_ring;
+
+static void queue(unsigned opcode, int fd, size_t length, uintptr_t user_data)
+{
+    auto* submissions = (io_ring_submission*)((char*)s_ring + s_ring->submissions_offset);
+    auto& submission = submissions[s_ring->submission_tail & (s_ring->submission_entries - 1)];
+    submission = { opcode, fd, 0, length, -1, 0, (void*)user_data };
+    __atomic_store_n(&s_ring->submission_tail, s_ring->submission_tail + 1, __ATOMIC_RELEASE);
+}
+
+static io_ring_completion reap()
+{
+    auto* completions = (io_ring_completion*)((char*)s_ring + s_ring->completions_offset);
+    assert(s_ring->completion_head != __atomic_load_n(&s_ring->completion_tail, __ATOMIC_ACQUIRE));
+    auto completion = completions[s_ring->completion_head & (s_ring->completion_entries - 1)];
+    __atomic_store_n(&s_ring->completion_head, s_ring->completion_head + 1, __ATOMIC_RELEASE);
+    return completion;
+}
+
+int main(int, char**)
+{
+    int pipe_fds[2];
+    int rc = pipe(pipe_fds);
+    assert(rc == 0);
+
+    int ring_fd = io_ring_create(4, 4096, O_CLOEXEC, &s_ring);
+    assert(ring_fd >= 0);
+    assert(s_ring->submission_entries == 4);
+
+    // The read can't finish until there's something in the pipe, so the other two complete first.
+    queue(IO_RING_OP_READ, pipe_fds[0], 16, 1);
+    queue(IO_RING_OP_NOP, -1, 0, 2);
+    queue(IO_RING_OP_READ, 1234, 16, 3);
+    rc = io_ring_enter(ring_fd, 2);
+    assert(rc == 3);
+
+    auto first = reap();
+    auto second = reap();
+    assert(first.user_data == (void*)2 && first.result == 0);
+    assert(second.user_data == (void*)3 && second.result == -EBADF);
+
+    write(pipe_fds[1], "hello", 5);
+    rc = io_ring_enter(ring_fd, 1);
+    assert(rc == 0);
+
+    auto read_completion = reap();
+    assert(read_completion.user_data == (void*)1);
+    assert(read_completion.result == 5);
+    assert(!memcmp((char*)s_ring + s_ring->buffers_offset, "hello", 5));
+
+    printf("PASS\n");
+    return 0;
+}
@@ -0,0 +1,148 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <AK/Types.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+
+// Random-access throughput on a 64 MiB mapping.
+// The anonymous mapping is backed by scattered 4 KiB pages, while the framebuffer is physically
+// contiguous and gets mapped with 2 MiB pages. Comparing the two shows what the TLB misses cost us.
+
+static constexpr size_t region_size = 64 * MB;
+static constexpr size_t access_count = 16 * MB;
+
+static u64 now_ns()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (u64)ts.tv_sec * 1'000'000'000 + ts.tv_nsec;
+}
+
+static void benchmark(const char* name, volatile u32* base, size_t size)
+{
+    size_t word_count = size / sizeof(u32);
+
+    // Touch everything once so we're not measuring page faults.
+    for (size_t i = 0; i < word_count; i += PAGE_SIZE / sizeof(u32))
+        base[i] = i;
+
+    u32 state = 0x12345678;
+    u32 sum = 0;
+    u64 start = now_ns();
+    for (size_t i = 0; i < access_count; ++i) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        sum += base[state % word_count];
+    }
+    u64 elapsed_ns = now_ns() - start;
+    if (!elapsed_ns)
+        elapsed_ns = 1;
+
+    printf("%-12s %6zu MiB: %zu accesses in %llu ms, %llu Maccesses/s (checksum %08x)\n",
+        name,
+        size / MB,
+        access_count,
+        elapsed_ns / 1'000'000,
+        (u64)access_count * 1000 / elapsed_ns,
+        sum);
+}
+
+static void print_large_page_statistics()
+{
+    FILE* fp = fopen("/proc/memstat", "r");
+    if (!fp)
+        return;
+    char buffer[4096];
+    size_t nread = fread(buffer, 1, sizeof(buffer) - 1, fp);
+    fclose(fp);
+    buffer[nread] = '\0';
+    const char* keys[] = { "\"large_page_mappings\"", "\"large_page_demotions\"" };
+    for (auto* key : keys) {
+        auto* found = strstr(buffer, key);
+        if (!found)
+            continue;
+        auto* end = strpbrk(found, ",}");
+        printf("%.*s\n", end ? (int)(end - found) : (int)strlen(found), found);
+    }
+}
+
+int main()
+{
+    auto* anonymous = (u32*)mmap(nullptr, region_size, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE, 0, 0);
+    if (anonymous == MAP_FAILED) {
+        perror("mmap");
+        return 1;
+    }
+    benchmark("anonymous", anonymous, region_size);
+    munmap(anonymous, region_size);
+
+    int fd = open("/dev/fb0", O_RDWR);
+    if (fd < 0) {
+        perror("open /dev/fb0");
+        print_large_page_statistics();
+        return 0;
+    }
+
+    FBResolution original_resolution;
+    if (ioctl(fd, FB_IOCTL_GET_RESOLUTION, &original_resolution) < 0) {
+        perror("ioctl");
+        return 1;
+    }
+
+    // 4096x2048 at 32bpp, double buffered, is exactly 64 MiB.
+    FBResolution resolution;
+    resolution.width = 4096;
+    resolution.height = 2048;
+    resolution.pitch = resolution.width * sizeof(u32);
+    bool changed_resolution = ioctl(fd, FB_IOCTL_SET_RESOLUTION, &resolution) == 0;
+    if (!changed_resolution) {
+        printf("Couldn't switch to 4096x2048, benchmarking the framebuffer at its current size\n");
+        resolution = original_resolution;
+    }
+
+    size_t framebuffer_size = resolution.pitch * resolution.height * 2;
+    auto* framebuffer = (u32*)mmap(nullptr, framebuffer_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (framebuffer == MAP_FAILED) {
+        perror("mmap");
+    } else {
+        benchmark("framebuffer", framebuffer, framebuffer_size);
+        print_large_page_statistics();
+        munmap(framebuffer, framebuffer_size);
+    }
+
+    if (changed_resolution)
+        ioctl(fd, FB_IOCTL_SET_RESOLUTION, &original_resolution);
+    close(fd);
+    return 0;
+}
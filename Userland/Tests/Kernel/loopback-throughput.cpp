@@ -0,0 +1,159 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <arpa/inet.h>
+#include <assert.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+static constexpr size_t transfer_size = 16 * 1024 * 1024;
+static constexpr size_t chunk_size = 64 * 1024;
+
+static unsigned elapsed_ms(const timespec& start)
+{
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start.tv_sec) * 1000 + (now.tv_nsec - start.tv_nsec) / 1000000;
+}
+
+// Forks a writer that connects with connect_to() and sends transfer_size bytes, and returns how long reading them took.
+template<typename ConnectCallback>
+static unsigned measure(int listen_fd, ConnectCallback connect_to)
+{
+    pid_t pid = fork();
+    assert(pid >= 0);
+    if (pid == 0) {
+        int fd = connect_to();
+        static unsigned char buffer[chunk_size];
+        memset(buffer, 0x5a, sizeof(buffer));
+        for (size_t total_written = 0; total_written < transfer_size;) {
+            ssize_t nwritten = write(fd, buffer, sizeof(buffer));
+            assert(nwritten > 0);
+            total_written += nwritten;
+        }
+        close(fd);
+        _exit(0);
+    }
+
+    int fd = accept(listen_fd, nullptr, nullptr);
+    assert(fd >= 0);
+    timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    size_t total_read = 0;
+    for (;;) {
+        static unsigned char buffer[chunk_size];
+        ssize_t nread = read(fd, buffer, sizeof(buffer));
+        assert(nread >= 0);
+        if (nread == 0)
+            break;
+        total_read += nread;
+    }
+    unsigned ms = elapsed_ms(start);
+    assert(total_read == transfer_size);
+
+    int status = 0;
+    waitpid(pid, &status, 0);
+    assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    close(fd);
+    return ms ? ms : 1;
+}
+
+static void check_udp_loopback()
+{
+    // Datagrams to 127.0.0.1 are handed straight to the receiving socket.
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    assert(fd >= 0);
+    sockaddr_in address {};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(8546);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    int rc = bind(fd, (const sockaddr*)&address, sizeof(address));
+    assert(rc == 0);
+    const char message[] = "loopback";
+    ssize_t nsent = sendto(fd, message, sizeof(message), 0, (const sockaddr*)&address, sizeof(address));
+    assert(nsent == sizeof(message));
+    char buffer[64];
+    ssize_t nreceived = recv(fd, buffer, sizeof(buffer), 0);
+    assert(nreceived == sizeof(message));
+    assert(!memcmp(buffer, message, sizeof(message)));
+    close(fd);
+}
+
+int main(int, char**)
+{
+    check_udp_loopback();
+
+    sockaddr_in inet_address {};
+    inet_address.sin_family = AF_INET;
+    inet_address.sin_port = htons(8545);
+    inet_address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    int inet_listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    assert(inet_listen_fd >= 0);
+    int rc = bind(inet_listen_fd, (const sockaddr*)&inet_address, sizeof(inet_address));
+    assert(rc == 0);
+    rc = listen(inet_listen_fd, 1);
+    assert(rc == 0);
+    unsigned tcp_ms = measure(inet_listen_fd, [&] {
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        assert(fd >= 0);
+        int rc = connect(fd, (const sockaddr*)&inet_address, sizeof(inet_address));
+        assert(rc == 0);
+        return fd;
+    });
+    close(inet_listen_fd);
+
+    sockaddr_un local_address {};
+    local_address.sun_family = AF_UNIX;
+    strncpy(local_address.sun_path, "/tmp/loopback-throughput", sizeof(local_address.sun_path) - 1);
+    unlink(local_address.sun_path);
+    int local_listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    assert(local_listen_fd >= 0);
+    rc = bind(local_listen_fd, (const sockaddr*)&local_address, sizeof(local_address));
+    assert(rc == 0);
+    rc = listen(local_listen_fd, 1);
+    assert(rc == 0);
+    unsigned local_ms = measure(local_listen_fd, [&] {
+        int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        assert(fd >= 0);
+        int rc = connect(fd, (const sockaddr*)&local_address, sizeof(local_address));
+        assert(rc == 0);
+        return fd;
+    });
+    close(local_listen_fd);
+    unlink(local_address.sun_path);
+
+    unsigned megabytes = transfer_size / (1024 * 1024);
+    printf("TCP over 127.0.0.1: %u MB in %u ms (%u MB/s)\n", megabytes, tcp_ms, megabytes * 1000 / tcp_ms);
+    printf("LocalSocket:        %u MB in %u ms (%u MB/s)\n", megabytes, local_ms, megabytes * 1000 / local_ms);
+    printf("PASS\n");
+    return 0;
+}
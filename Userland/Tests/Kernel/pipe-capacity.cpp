@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+int main(int, char**)
+{
+    int pipe_fds[2];
+    int rc = pipe(pipe_fds);
+    assert(rc == 0);
+
+    int capacity = fcntl(pipe_fds[0], F_GETPIPE_SZ);
+    assert(capacity > 0);
+
+    // Sizes are rounded up to whole pages.
+    rc = fcntl(pipe_fds[1], F_SETPIPE_SZ, 1000);
+    assert(rc == 4096);
+    assert(fcntl(pipe_fds[0], F_GETPIPE_SZ) == 4096);
+
+    // Unread data is carried over, and the pipe can't shrink below it.
+    char buffer[6000];
+    memset(buffer, 'x', sizeof(buffer));
+    fcntl(pipe_fds[1], F_SETFL, O_NONBLOCK);
+    ssize_t nwritten = write(pipe_fds[1], buffer, 3000);
+    assert(nwritten == 3000);
+    rc = fcntl(pipe_fds[1], F_SETPIPE_SZ, 2000);
+    assert(rc < 0 && errno == EBUSY);
+    rc = fcntl(pipe_fds[1], F_SETPIPE_SZ, 256 * 1024);
+    assert(rc == 256 * 1024);
+    ssize_t nread = read(pipe_fds[0], buffer, sizeof(buffer));
+    assert(nread == 3000);
+
+    rc = fcntl(pipe_fds[1], F_SETPIPE_SZ, 64 * 1024 * 1024);
+    assert(rc < 0 && errno == EPERM);
+
+    int fd = open("/dev/null", O_RDONLY);
+    rc = fcntl(fd, F_SETPIPE_SZ, 4096);
+    assert(rc < 0 && errno == EINVAL);
+
+    printf("PASS\n");
+    return 0;
+}
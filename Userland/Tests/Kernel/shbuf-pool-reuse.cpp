@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <assert.h>
+#include <serenity.h>
+#include <stdio.h>
+#include <string.h>
+
+int main(int, char**)
+{
+    void* data = nullptr;
+    int shbuf_id = shbuf_create(10000, &data);
+    assert(shbuf_id >= 0);
+    memset(data, 0xaa, 10000);
+    int rc = shbuf_release(shbuf_id);
+    assert(rc == 0);
+
+    // Nobody else had it mapped, so the same buffer comes back, and it's as clean as a new one.
+    void* reused_data = nullptr;
+    int reused_shbuf_id = shbuf_create(10000, &reused_data);
+    assert(reused_shbuf_id == shbuf_id);
+    assert(reused_data == data);
+    for (size_t i = 0; i < 10000; ++i)
+        assert(((unsigned char*)reused_data)[i] == 0);
+
+    // A sealed buffer can't be written to again, so it's never pooled.
+    rc = shbuf_seal(reused_shbuf_id);
+    assert(rc == 0);
+    rc = shbuf_release(reused_shbuf_id);
+    assert(rc == 0);
+    void* new_data = nullptr;
+    int new_shbuf_id = shbuf_create(10000, &new_data);
+    assert(new_shbuf_id >= 0 && new_shbuf_id != reused_shbuf_id);
+
+    printf("PASS\n");
+    return 0;
+}
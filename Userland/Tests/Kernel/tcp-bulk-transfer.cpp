@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <arpa/inet.h>
+#include <assert.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+static constexpr size_t transfer_size = 1024 * 1024;
+
+int main(int, char**)
+{
+    int listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    assert(listen_fd >= 0);
+
+    int value = -1;
+    socklen_t value_size = sizeof(value);
+    int rc = getsockopt(listen_fd, IPPROTO_TCP, TCP_NODELAY, &value, &value_size);
+    assert(rc == 0 && value == 0);
+    value = 1;
+    rc = setsockopt(listen_fd, IPPROTO_TCP, TCP_NODELAY, &value, sizeof(value));
+    assert(rc == 0);
+    value = 0;
+    rc = getsockopt(listen_fd, IPPROTO_TCP, TCP_NODELAY, &value, &value_size);
+    assert(rc == 0 && value == 1);
+
+    sockaddr_in address {};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(8543);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    rc = bind(listen_fd, (const sockaddr*)&address, sizeof(address));
+    assert(rc == 0);
+    rc = listen(listen_fd, 1);
+    assert(rc == 0);
+
+    pid_t pid = fork();
+    assert(pid >= 0);
+    if (pid == 0) {
+        // A single write much larger than the MSS and the send buffer: it has to be segmented and paced by the windows.
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        assert(fd >= 0);
+        rc = connect(fd, (const sockaddr*)&address, sizeof(address));
+        assert(rc == 0);
+        static unsigned char buffer[transfer_size];
+        for (size_t i = 0; i < transfer_size; ++i)
+            buffer[i] = i % 251;
+        size_t total_written = 0;
+        while (total_written < transfer_size) {
+            ssize_t nwritten = write(fd, buffer + total_written, transfer_size - total_written);
+            assert(nwritten > 0);
+            total_written += nwritten;
+        }
+        close(fd);
+        _exit(0);
+    }
+
+    int fd = accept(listen_fd, nullptr, nullptr);
+    assert(fd >= 0);
+    size_t total_read = 0;
+    for (;;) {
+        unsigned char buffer[4096];
+        ssize_t nread = read(fd, buffer, sizeof(buffer));
+        assert(nread >= 0);
+        if (nread == 0)
+            break;
+        for (ssize_t i = 0; i < nread; ++i)
+            assert(buffer[i] == (total_read + i) % 251);
+        total_read += nread;
+    }
+    assert(total_read == transfer_size);
+
+    int status = 0;
+    waitpid(pid, &status, 0);
+    assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+    close(fd);
+    close(listen_fd);
+    printf("PASS\n");
+    return 0;
+}
@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <arpa/inet.h>
+#include <assert.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+static int listen_on(const sockaddr_in& address, bool reuse_port)
+{
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    assert(fd >= 0);
+    if (reuse_port) {
+        int value = 1;
+        int rc = setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &value, sizeof(value));
+        assert(rc == 0);
+    }
+    int rc = bind(fd, (const sockaddr*)&address, sizeof(address));
+    assert(rc == 0);
+    if (listen(fd, 4) < 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+int main(int, char**)
+{
+    sockaddr_in address {};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(8544);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    // Without SO_REUSEPORT, a second listener on the same address is refused.
+    int first_fd = listen_on(address, false);
+    assert(first_fd >= 0);
+    assert(listen_on(address, false) < 0);
+    assert(listen_on(address, true) < 0);
+    close(first_fd);
+
+    // With it, both listeners share the port, and every connection lands on exactly one of them.
+    first_fd = listen_on(address, true);
+    assert(first_fd >= 0);
+    int second_fd = listen_on(address, true);
+    assert(second_fd >= 0);
+
+    int value = 0;
+    socklen_t value_size = sizeof(value);
+    int rc = getsockopt(second_fd, SOL_SOCKET, SO_REUSEPORT, &value, &value_size);
+    assert(rc == 0 && value == 1);
+
+    static constexpr int connection_count = 8;
+    int client_fds[connection_count];
+    for (int i = 0; i < connection_count; ++i) {
+        client_fds[i] = socket(AF_INET, SOCK_STREAM, 0);
+        assert(client_fds[i] >= 0);
+        rc = connect(client_fds[i], (const sockaddr*)&address, sizeof(address));
+        assert(rc == 0);
+    }
+
+    int accepted = 0;
+    while (accepted < connection_count) {
+        fd_set fds;
+        FD_ZERO(&fds);
+        FD_SET(first_fd, &fds);
+        FD_SET(second_fd, &fds);
+        timeval timeout { 5, 0 };
+        rc = select((first_fd > second_fd ? first_fd : second_fd) + 1, &fds, nullptr, nullptr, &timeout);
+        assert(rc > 0);
+        int listen_fds[] = { first_fd, second_fd };
+        for (int fd : listen_fds) {
+            if (!FD_ISSET(fd, &fds))
+                continue;
+            int accepted_fd = accept(fd, nullptr, nullptr);
+            assert(accepted_fd >= 0);
+            close(accepted_fd);
+            ++accepted;
+        }
+    }
+
+    for (int i = 0; i < connection_count; ++i)
+        close(client_fds[i]);
+    close(first_fd);
+    close(second_fd);
+
+    printf("PASS\n");
+    return 0;
+}
@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <AK/Types.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Malloc/free throughput with several threads allocating at once, both for objects that are freed by
+// the thread that allocated them and for objects that are handed over to (and freed by) another thread.
+
+static constexpr int iterations_per_thread = 200000;
+static constexpr int live_allocations = 64;
+static constexpr int max_thread_count = 8;
+
+static pthread_barrier_t s_start_barrier;
+
+static u64 now_ns()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (u64)ts.tv_sec * 1'000'000'000 + ts.tv_nsec;
+}
+
+static size_t size_for_iteration(int i)
+{
+    // Cycle through the small size classes, with the occasional mid-size allocation.
+    static constexpr size_t sizes[] = { 8, 24, 48, 100, 16, 200, 32, 500, 64, 1000, 12, 3000 };
+    return sizes[i % (sizeof(sizes) / sizeof(sizes[0]))];
+}
+
+static void* local_worker(void*)
+{
+    void* allocations[live_allocations] {};
+    pthread_barrier_wait(&s_start_barrier);
+    for (int i = 0; i < iterations_per_thread; ++i) {
+        auto& slot = allocations[i % live_allocations];
+        free(slot);
+        slot = malloc(size_for_iteration(i));
+        *(volatile u8*)slot = 1;
+    }
+    for (auto* allocation : allocations)
+        free(allocation);
+    return nullptr;
+}
+
+// Each thread frees what its neighbour allocated in the previous round.
+static void* s_handoff[max_thread_count][live_allocations];
+static int s_thread_count;
+
+static void* handoff_worker(void* argument)
+{
+    int index = (int)(FlatPtr)argument;
+    auto& mine = s_handoff[index];
+    auto& neighbours = s_handoff[(index + 1) % s_thread_count];
+    pthread_barrier_wait(&s_start_barrier);
+    for (int round = 0; round < iterations_per_thread / live_allocations; ++round) {
+        for (int i = 0; i < live_allocations; ++i)
+            mine[i] = malloc(size_for_iteration(round + i));
+        pthread_barrier_wait(&s_start_barrier);
+        for (int i = 0; i < live_allocations; ++i)
+            free(neighbours[i]);
+        pthread_barrier_wait(&s_start_barrier);
+    }
+    return nullptr;
+}
+
+static bool benchmark(const char* name, void* (*worker)(void*), int thread_count, bool main_thread_joins_barriers)
+{
+    pthread_t threads[max_thread_count];
+    s_thread_count = thread_count;
+    pthread_barrier_init(&s_start_barrier, nullptr, main_thread_joins_barriers ? thread_count + 1 : thread_count);
+    u64 start = now_ns();
+    for (int i = 0; i < thread_count; ++i) {
+        if (pthread_create(&threads[i], nullptr, worker, (void*)(FlatPtr)i) != 0) {
+            perror("pthread_create");
+            return false;
+        }
+    }
+    if (main_thread_joins_barriers) {
+        pthread_barrier_wait(&s_start_barrier);
+        start = now_ns();
+    }
+    for (int i = 0; i < thread_count; ++i)
+        pthread_join(threads[i], nullptr);
+    u64 elapsed_ns = now_ns() - start;
+    pthread_barrier_destroy(&s_start_barrier);
+
+    u64 total_operations = (u64)thread_count * iterations_per_thread;
+    printf("%-8s %d threads: %6llu ms, %4llu ns per malloc+free\n", name, thread_count, elapsed_ns / 1'000'000, elapsed_ns / total_operations);
+    return true;
+}
+
+int main()
+{
+    for (int thread_count = 1; thread_count <= max_thread_count; thread_count *= 2) {
+        if (!benchmark("local", local_worker, thread_count, true))
+            return 1;
+        if (!benchmark("handoff", handoff_worker, thread_count, false))
+            return 1;
+    }
+    return 0;
+}
@@ -50,6 +50,12 @@ const static TestCase g_test_cases[] = {
     { (const u8[]) { 0, 1, 1, 2 }, 4u, (const u8[]) { 1, 5 }, 2u, -1 },
     { (const u8[64]) { 0 }, 64u, (const u8[33]) { 0 }, 33u, 0 },
     { (const u8[64]) { 0, 1, 1, 2 }, 64u, (const u8[33]) { 1, 1 }, 2u, 1 },
+    { (const u8*)"abcabcabd", 9u, (const u8*)"abcabd", 6u, 3 },
+    { (const u8*)"aaaaaaaaab", 10u, (const u8*)"aaab", 4u, 6 },
+    { (const u8*)"aaaaaaaaaa", 10u, (const u8*)"aaab", 4u, -1 },
+    { (const u8*)"xyzxyzxyz", 9u, (const u8*)"zxyzx", 5u, 2 },
+    { (const u8*)"the quick brown fox", 19u, (const u8*)"fox", 3u, 16 },
+    { (const u8*)"the quick brown fox", 19u, (const u8*)"foxes", 5u, -1 },
 };
 
 int main()
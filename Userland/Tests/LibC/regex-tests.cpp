@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <regex.h>
+#include <stdio.h>
+#include <string.h>
+
+struct TestCase {
+    const char* pattern;
+    int cflags;
+    const char* string;
+    int result;
+    regoff_t match_start { -1 };
+    regoff_t match_end { -1 };
+};
+
+const static TestCase g_test_cases[] = {
+    { "abc", 0, "xxabcxx", 0, 2, 5 },
+    { "abd", 0, "xxabcxx", REG_NOMATCH },
+    { "a*b", 0, "xaaab", 0, 1, 5 },
+    { "^a", 0, "ba", REG_NOMATCH },
+    { "*a", 0, "x*a", 0, 1, 3 },
+    { "a\\{2\\}", 0, "aaa", 0, 0, 2 },
+    { "\\(ab\\)\\1", 0, "xabab", 0, 1, 5 },
+    { "a|b", 0, "a|b", 0, 0, 3 },
+    { "a+", 0, "aa+", 0, 1, 3 },
+    { "a|b", REG_EXTENDED, "xb", 0, 1, 2 },
+    { "(ab|cd)+", REG_EXTENDED, "xabcdab", 0, 1, 7 },
+    { "a{2,}", REG_EXTENDED, "aaaa", 0, 0, 4 },
+    { "[[:digit:]]+", REG_EXTENDED, "ab123", 0, 2, 5 },
+    { "[]a]+", REG_EXTENDED, "x]a]", 0, 1, 4 },
+    { "[^a]", REG_EXTENDED, "a\n", 0, 1, 2 },
+    { "[^a]", REG_EXTENDED | REG_NEWLINE, "a\n", REG_NOMATCH },
+    { "^b$", REG_EXTENDED, "a\nb", REG_NOMATCH },
+    { "^b$", REG_EXTENDED | REG_NEWLINE, "a\nb", 0, 2, 3 },
+    { "ABC", REG_ICASE, "xabc", 0, 1, 4 },
+    { "(a+)+$", REG_EXTENDED, "aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaab", REG_NOMATCH },
+    { "(", REG_EXTENDED, "", REG_EPAREN },
+    { "\\(", 0, "", REG_EPAREN },
+    { "[a", 0, "", REG_EBRACK },
+    { "a{2", REG_EXTENDED, "", REG_EBRACE },
+    { "a{3,2}", REG_EXTENDED, "", REG_BADBR },
+    { "[z-a]", 0, "", REG_ERANGE },
+    { "[[:foo:]]", 0, "", REG_ECTYPE },
+    { "\\1(a)", REG_EXTENDED, "", REG_ESUBREG },
+    { "*", REG_EXTENDED, "", REG_BADRPT },
+    { "a\\", 0, "", REG_EESCAPE },
+};
+
+int main()
+{
+    bool failed = false;
+    size_t i = 0;
+    for (const auto& test_case : g_test_cases) {
+        regex_t regex;
+        int result = regcomp(&regex, test_case.pattern, test_case.cflags);
+        regmatch_t match { -1, -1 };
+        if (result == 0) {
+            result = regexec(&regex, test_case.string, 1, &match, 0);
+            regfree(&regex);
+        }
+
+        if (result != test_case.result || match.rm_so != test_case.match_start || match.rm_eo != test_case.match_end) {
+            failed = true;
+            char message[64];
+            regerror(result, nullptr, message, sizeof(message));
+            fprintf(stderr, "Test %zu FAILED! /%s/: got %d (%s), match %zd-%zd\n", i, test_case.pattern, result, message, match.rm_so, match.rm_eo);
+        }
+        ++i;
+    }
+
+    regex_t regex;
+    regcomp(&regex, "\\([a-z]*\\)=\\([0-9]*\\)\\(x\\)*", 0);
+    if (regex.re_nsub != 3) {
+        failed = true;
+        fprintf(stderr, "re_nsub FAILED! expected 3, got %zu\n", regex.re_nsub);
+    }
+    regmatch_t matches[5];
+    if (regexec(&regex, "key=42", 5, matches, 0) != 0
+        || matches[1].rm_so != 0 || matches[1].rm_eo != 3
+        || matches[2].rm_so != 4 || matches[2].rm_eo != 6
+        || matches[3].rm_so != -1 || matches[4].rm_so != -1) {
+        failed = true;
+        fprintf(stderr, "Subexpressions FAILED!\n");
+    }
+    if (regexec(&regex, "key=42", 0, nullptr, REG_NOTBOL) != 0) {
+        failed = true;
+        fprintf(stderr, "REG_NOTBOL without an anchor FAILED!\n");
+    }
+    regfree(&regex);
+
+    regcomp(&regex, "^a", REG_NOSUB);
+    if (regexec(&regex, "a", 0, nullptr, REG_NOTBOL) != REG_NOMATCH) {
+        failed = true;
+        fprintf(stderr, "REG_NOTBOL FAILED!\n");
+    }
+    regfree(&regex);
+
+    printf(failed ? "FAIL\n" : "PASS\n");
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <AK/Types.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+// Throughput of tiny critical sections with more and more threads fighting over the same lock.
+// A lock that sleeps in the kernel instead of spinning on sched_yield() should keep the total
+// time roughly flat as the thread count grows, instead of burning all CPUs on retries.
+
+static constexpr int iterations_per_thread = 100000;
+static constexpr int max_thread_count = 16;
+
+static pthread_mutex_t s_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_rwlock_t s_rwlock = PTHREAD_RWLOCK_INITIALIZER;
+static pthread_spinlock_t s_spinlock;
+static pthread_barrier_t s_start_barrier;
+static u32 s_counter;
+
+static u64 now_ns()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (u64)ts.tv_sec * 1'000'000'000 + ts.tv_nsec;
+}
+
+static void* mutex_worker(void*)
+{
+    pthread_barrier_wait(&s_start_barrier);
+    for (int i = 0; i < iterations_per_thread; ++i) {
+        pthread_mutex_lock(&s_mutex);
+        ++s_counter;
+        pthread_mutex_unlock(&s_mutex);
+    }
+    return nullptr;
+}
+
+static void* spinlock_worker(void*)
+{
+    pthread_barrier_wait(&s_start_barrier);
+    for (int i = 0; i < iterations_per_thread; ++i) {
+        pthread_spin_lock(&s_spinlock);
+        ++s_counter;
+        pthread_spin_unlock(&s_spinlock);
+    }
+    return nullptr;
+}
+
+// One in sixteen acquisitions is a write, the rest are reads.
+static void* rwlock_worker(void*)
+{
+    pthread_barrier_wait(&s_start_barrier);
+    for (int i = 0; i < iterations_per_thread; ++i) {
+        if ((i % 16) == 0) {
+            pthread_rwlock_wrlock(&s_rwlock);
+            ++s_counter;
+        } else {
+            pthread_rwlock_rdlock(&s_rwlock);
+            (void)s_counter;
+        }
+        pthread_rwlock_unlock(&s_rwlock);
+    }
+    return nullptr;
+}
+
+static bool benchmark(const char* name, void* (*worker)(void*), int thread_count, bool counts_everything)
+{
+    pthread_t threads[max_thread_count];
+    s_counter = 0;
+    pthread_barrier_init(&s_start_barrier, nullptr, thread_count + 1);
+    for (int i = 0; i < thread_count; ++i) {
+        if (pthread_create(&threads[i], nullptr, worker, nullptr) != 0) {
+            perror("pthread_create");
+            return false;
+        }
+    }
+
+    pthread_barrier_wait(&s_start_barrier);
+    u64 start = now_ns();
+    for (int i = 0; i < thread_count; ++i)
+        pthread_join(threads[i], nullptr);
+    u64 elapsed_ns = now_ns() - start;
+    pthread_barrier_destroy(&s_start_barrier);
+
+    u32 expected = (u32)thread_count * iterations_per_thread;
+    if (!counts_everything)
+        expected = (u32)thread_count * ((iterations_per_thread + 15) / 16);
+    if (s_counter != expected) {
+        fprintf(stderr, "%s: counter is %u, expected %u\n", name, s_counter, expected);
+        return false;
+    }
+
+    u64 total_operations = (u64)thread_count * iterations_per_thread;
+    printf("%-8s %2d threads: %6llu ms, %5llu ns per lock\n", name, thread_count, elapsed_ns / 1'000'000, elapsed_ns / total_operations);
+    return true;
+}
+
+int main()
+{
+    pthread_spin_init(&s_spinlock, PTHREAD_PROCESS_PRIVATE);
+    for (int thread_count = 1; thread_count <= max_thread_count; thread_count *= 2) {
+        if (!benchmark("mutex", mutex_worker, thread_count, true))
+            return 1;
+        if (!benchmark("spinlock", spinlock_worker, thread_count, true))
+            return 1;
+        if (!benchmark("rwlock", rwlock_worker, thread_count, false))
+            return 1;
+    }
+    return 0;
+}
@@ -24,6 +24,7 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <AK/ByteBuffer.h>
 #include <AK/Vector.h>
 #include <LibCore/ArgsParser.h>
 #include <assert.h>
@@ -31,10 +32,22 @@
 #include <fcntl.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <sys/sendfile.h>
 #include <sys/stat.h>
 #include <string.h>
 #include <unistd.h>
 
+static size_t io_buffer_size(int fd)
+{
+    // Copy in large multiples of the file system's preferred block size.
+    constexpr size_t minimum_size = 64 * KB;
+    struct stat st;
+    if (fstat(fd, &st) < 0 || st.st_blksize <= 0)
+        return minimum_size;
+    size_t block_size = st.st_blksize;
+    return (minimum_size + block_size - 1) / block_size * block_size;
+}
+
 int main(int argc, char** argv)
 {
     if (pledge("stdio rpath", nullptr) < 0) {
@@ -70,9 +83,23 @@ int main(int argc, char** argv)
     }
 
     for (auto& fd : fds) {
+        // Let the kernel move the data when it can. It refuses sources it can't read at an offset,
+        // like pipes, and those we copy through a buffer ourselves.
+        ssize_t nsent;
+        while ((nsent = sendfile(1, fd, nullptr, 1 * MB)) > 0)
+            ;
+        if (nsent < 0 && errno != EINVAL) {
+            perror("sendfile");
+            return 3;
+        }
+        if (nsent == 0) {
+            close(fd);
+            continue;
+        }
+        auto buffer = ByteBuffer::create_uninitialized(io_buffer_size(fd));
         for (;;) {
-            char buf[32768];
-            ssize_t nread = read(fd, buf, sizeof(buf));
+            auto* buf = buffer.data();
+            ssize_t nread = read(fd, buf, buffer.size());
             if (nread == 0)
                 break;
             if (nread < 0) {
@@ -24,14 +24,19 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <AK/Atomic.h>
+#include <AK/ByteBuffer.h>
 #include <AK/LexicalPath.h>
 #include <AK/String.h>
 #include <AK/StringBuilder.h>
 #include <LibCore/ArgsParser.h>
 #include <LibCore/DirIterator.h>
+#include <LibThread/ThreadPool.h>
 #include <assert.h>
+#include <errno.h>
 #include <fcntl.h>
 #include <stdio.h>
+#include <sys/sendfile.h>
 #include <sys/stat.h>
 #include <unistd.h>
 
@@ -41,7 +46,7 @@ bool copy_directory(String, String);
 
 int main(int argc, char** argv)
 {
-    if (pledge("stdio rpath wpath cpath fattr", nullptr) < 0) {
+    if (pledge("stdio rpath wpath cpath fattr thread", nullptr) < 0) {
         perror("pledge");
         return 1;
     }
@@ -86,6 +91,7 @@ bool copy_file_or_directory(String src_path, String dst_path, bool recursion_all
     }
 
     if (S_ISDIR(src_stat.st_mode)) {
+        close(src_fd);
         if (!recursion_allowed) {
             fprintf(stderr, "cp: -r not specified; omitting directory '%s'\n", src_path.characters());
             return false;
@@ -95,6 +101,17 @@ bool copy_file_or_directory(String src_path, String dst_path, bool recursion_all
     return copy_file(src_path, dst_path, src_stat, src_fd);
 }
 
+static size_t io_buffer_size(int fd)
+{
+    // Copy in large multiples of the file system's preferred block size.
+    constexpr size_t minimum_size = 64 * KB;
+    struct stat st;
+    if (fstat(fd, &st) < 0 || st.st_blksize <= 0)
+        return minimum_size;
+    size_t block_size = st.st_blksize;
+    return (minimum_size + block_size - 1) / block_size * block_size;
+}
+
 /**
  * Copy a source file to a destination file. Returns true if successful, false
  * otherwise. If there is an error, its description is output to stderr.
@@ -128,9 +145,21 @@ bool copy_file(String src_path, String dst_path, struct stat src_stat, int src_f
         }
     }
 
-    for (;;) {
-        char buffer[32768];
-        ssize_t nread = read(src_fd, buffer, sizeof(buffer));
+    // Let the kernel move the data when it can, and copy it through a buffer ourselves when it can't.
+    ssize_t nsent;
+    while ((nsent = sendfile(dst_fd, src_fd, nullptr, 1 * MB)) > 0)
+        ;
+    if (nsent < 0 && errno != EINVAL) {
+        perror("sendfile");
+        return false;
+    }
+
+    ByteBuffer buffer;
+    if (nsent < 0)
+        buffer = ByteBuffer::create_uninitialized(io_buffer_size(src_fd));
+
+    while (nsent < 0) {
+        ssize_t nread = read(src_fd, buffer.data(), buffer.size());
         if (nread < 0) {
             perror("read src");
             return false;
@@ -138,7 +167,7 @@ bool copy_file(String src_path, String dst_path, struct stat src_stat, int src_f
         if (nread == 0)
             break;
         ssize_t remaining_to_write = nread;
-        char* bufptr = buffer;
+        u8* bufptr = buffer.data();
         while (remaining_to_write) {
             ssize_t nwritten = write(dst_fd, bufptr, remaining_to_write);
             if (nwritten < 0) {
@@ -164,10 +193,16 @@ bool copy_file(String src_path, String dst_path, struct stat src_stat, int src_f
     return true;
 }
 
+struct FileToCopy {
+    String src_path;
+    String dst_path;
+};
+
 /**
- * Copy the contents of a source directory into a destination directory.
+ * Recreate a source directory tree at the destination, and collect the files
+ * that have to be copied into it.
  */
-bool copy_directory(String src_path, String dst_path)
+static bool create_directory_tree(const String& src_path, const String& dst_path, Vector<FileToCopy>& files)
 {
     int rc = mkdir(dst_path.characters(), 0755);
     if (rc < 0) {
@@ -180,14 +215,48 @@ bool copy_directory(String src_path, String dst_path)
         return false;
     }
     while (di.has_next()) {
+        auto type = di.next_type();
         String filename = di.next_path();
-        bool is_copied = copy_file_or_directory(
-            String::format("%s/%s", src_path.characters(), filename.characters()),
-            String::format("%s/%s", dst_path.characters(), filename.characters()),
-            true);
-        if (!is_copied) {
-            return false;
+        auto child_src_path = String::format("%s/%s", src_path.characters(), filename.characters());
+        auto child_dst_path = String::format("%s/%s", dst_path.characters(), filename.characters());
+
+        // Symlinks are followed, like everywhere else in cp.
+        if (type == DT_UNKNOWN || type == DT_LNK) {
+            struct stat st;
+            if (stat(child_src_path.characters(), &st) < 0) {
+                perror("stat src");
+                return false;
+            }
+            type = S_ISDIR(st.st_mode) ? DT_DIR : DT_REG;
         }
+
+        if (type == DT_DIR) {
+            if (!create_directory_tree(child_src_path, child_dst_path, files))
+                return false;
+            continue;
+        }
+        files.append({ move(child_src_path), move(child_dst_path) });
     }
     return true;
 }
+
+/**
+ * Copy the contents of a source directory into a destination directory.
+ *
+ * The directories are created first, after which the files are copied in parallel.
+ */
+bool copy_directory(String src_path, String dst_path)
+{
+    Vector<FileToCopy> files;
+    if (!create_directory_tree(src_path, dst_path, files))
+        return false;
+
+    Atomic<bool> failed { false };
+    LibThread::ThreadPool::the().parallel_for(0, files.size(), 1, [&](size_t i) {
+        if (failed.load())
+            return;
+        if (!copy_file_or_directory(files[i].src_path, files[i].dst_path, false))
+            failed = true;
+    });
+    return !failed.load();
+}
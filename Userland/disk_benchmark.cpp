@@ -25,30 +25,52 @@
  */
 
 #include <AK/ByteBuffer.h>
+#include <AK/JsonArray.h>
+#include <AK/JsonObject.h>
+#include <AK/QuickSort.h>
 #include <AK/String.h>
 #include <AK/Types.h>
 #include <AK/Vector.h>
 #include <LibCore/ElapsedTimer.h>
 #include <fcntl.h>
 #include <getopt.h>
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <sys/stat.h>
+#include <time.h>
 #include <unistd.h>
 
+struct Options {
+    bool allow_cache { false };
+    bool random_access { false };
+    bool fsync_after_write { false };
+    int thread_count { 1 };
+};
+
 struct Result {
-    u64 write_bps;
-    u64 read_bps;
+    u64 write_bps { 0 };
+    u64 read_bps { 0 };
+    Vector<u32> write_latencies_us;
+    Vector<u32> read_latencies_us;
+};
+
+struct Percentiles {
+    u32 p50 { 0 };
+    u32 p99 { 0 };
+    u32 p999 { 0 };
 };
 
-static Result average_result(const Vector<Result>& results)
+static Result average_result(Vector<Result>& results)
 {
     Result average;
 
     for (auto& res : results) {
         average.write_bps += res.write_bps;
         average.read_bps += res.read_bps;
+        average.write_latencies_us.append(move(res.write_latencies_us));
+        average.read_latencies_us.append(move(res.read_latencies_us));
     }
 
     average.write_bps /= results.size();
@@ -57,13 +79,38 @@ static Result average_result(const Vector<Result>& results)
     return average;
 }
 
+static Percentiles percentiles(Vector<u32>& latencies)
+{
+    if (latencies.is_empty())
+        return {};
+    quick_sort(latencies);
+    // Nearest-rank percentiles: the smallest sample that at least this fraction of samples doesn't exceed.
+    auto rank = [&](u32 per_mille) {
+        size_t index = (latencies.size() * per_mille + 999) / 1000;
+        return latencies[index ? index - 1 : 0];
+    };
+    return { rank(500), rank(990), rank(999) };
+}
+
+static u64 now_us()
+{
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (u64)now.tv_sec * 1000000 + now.tv_nsec / 1000;
+}
+
 static void exit_with_usage(int rc)
 {
-    fprintf(stderr, "Usage: disk_benchmark [-h] [-d directory] [-t time_per_benchmark] [-f file_size1,file_size2,...] [-b block_size1,block_size2,...]\n");
+    fprintf(stderr, "Usage: disk_benchmark [-h] [-c] [-r] [-s] [-j] [-d directory] [-t time_per_benchmark] [-n threads] [-f file_size1,file_size2,...] [-b block_size1,block_size2,...]\n");
+    fprintf(stderr, "  -c  Allow the block cache (files are opened with O_DIRECT otherwise)\n");
+    fprintf(stderr, "  -r  Access blocks at random offsets instead of sequentially\n");
+    fprintf(stderr, "  -s  fsync() after every write\n");
+    fprintf(stderr, "  -n  Number of threads issuing I/O at the same time\n");
+    fprintf(stderr, "  -j  Print the results as JSON\n");
     exit(rc);
 }
 
-static Result benchmark(const String& filename, int file_size, int block_size, ByteBuffer& buffer, bool allow_cache);
+static Result benchmark(const String& filename, int file_size, int block_size, const Options&);
 
 int main(int argc, char** argv)
 {
@@ -71,16 +118,26 @@ int main(int argc, char** argv)
     int time_per_benchmark = 10;
     Vector<int> file_sizes;
     Vector<int> block_sizes;
-    bool allow_cache = false;
+    Options options;
+    bool output_json = false;
 
     int opt;
-    while ((opt = getopt(argc, argv, "chd:t:f:b:")) != -1) {
+    while ((opt = getopt(argc, argv, "chrsjd:t:n:f:b:")) != -1) {
         switch (opt) {
         case 'h':
             exit_with_usage(0);
             break;
         case 'c':
-            allow_cache = true;
+            options.allow_cache = true;
+            break;
+        case 'r':
+            options.random_access = true;
+            break;
+        case 's':
+            options.fsync_after_write = true;
+            break;
+        case 'j':
+            output_json = true;
             break;
         case 'd':
             directory = strdup(optarg);
@@ -88,6 +145,9 @@ int main(int argc, char** argv)
         case 't':
             time_per_benchmark = atoi(optarg);
             break;
+        case 'n':
+            options.thread_count = max(1, atoi(optarg));
+            break;
         case 'f':
             for (auto size : String(optarg).split(','))
                 file_sizes.append(atoi(size.characters()));
@@ -96,6 +156,8 @@ int main(int argc, char** argv)
             for (auto size : String(optarg).split(','))
                 block_sizes.append(atoi(size.characters()));
             break;
+        default:
+            exit_with_usage(1);
         }
     }
 
@@ -110,41 +172,180 @@ int main(int argc, char** argv)
 
     auto filename = String::format("%s/disk_benchmark.tmp", directory);
 
+    JsonArray json_results;
+
     for (auto file_size : file_sizes) {
         for (auto block_size : block_sizes) {
-            if (block_size > file_size)
+            if (block_size <= 0 || block_size > file_size)
                 continue;
 
-            auto buffer = ByteBuffer::create_uninitialized(block_size);
-
             Vector<Result> results;
 
-            printf("Running: file_size=%d block_size=%d\n", file_size, block_size);
+            if (!output_json)
+                printf("Running: file_size=%d block_size=%d\n", file_size, block_size);
             Core::ElapsedTimer timer;
             timer.start();
             while (timer.elapsed() < time_per_benchmark * 1000) {
-                printf(".");
-                fflush(stdout);
-                results.append(benchmark(filename, file_size, block_size, buffer, allow_cache));
+                if (!output_json) {
+                    printf(".");
+                    fflush(stdout);
+                }
+                results.append(benchmark(filename, file_size, block_size, options));
                 usleep(100);
             }
+            auto run_count = results.size();
+            auto elapsed = timer.elapsed();
             auto average = average_result(results);
-            printf("\nFinished: runs=%zu time=%dms write_bps=%llu read_bps=%llu\n", results.size(), timer.elapsed(), average.write_bps, average.read_bps);
+            auto write_latency = percentiles(average.write_latencies_us);
+            auto read_latency = percentiles(average.read_latencies_us);
+
+            if (output_json) {
+                auto latency_object = [](const Percentiles& latency) {
+                    JsonObject object;
+                    object.set("p50", latency.p50);
+                    object.set("p99", latency.p99);
+                    object.set("p999", latency.p999);
+                    return object;
+                };
+                JsonObject result;
+                result.set("file_size", file_size);
+                result.set("block_size", block_size);
+                result.set("pattern", options.random_access ? "random" : "sequential");
+                result.set("threads", options.thread_count);
+                result.set("cache", options.allow_cache);
+                result.set("fsync", options.fsync_after_write);
+                result.set("runs", run_count);
+                result.set("time_ms", elapsed);
+                result.set("write_bps", average.write_bps);
+                result.set("read_bps", average.read_bps);
+                result.set("write_latency_us", latency_object(write_latency));
+                result.set("read_latency_us", latency_object(read_latency));
+                json_results.append(move(result));
+            } else {
+                printf("\nFinished: runs=%zu time=%dms write_bps=%llu read_bps=%llu\n", run_count, elapsed, average.write_bps, average.read_bps);
+                printf("Latency (us): write p50=%u p99=%u p999=%u read p50=%u p99=%u p999=%u\n",
+                    write_latency.p50, write_latency.p99, write_latency.p999,
+                    read_latency.p50, read_latency.p99, read_latency.p999);
+            }
 
             sleep(1);
         }
     }
 
+    if (output_json) {
+        printf("%s\n", json_results.to_string().characters());
+        return 0;
+    }
+
     if (isatty(0)) {
         printf("Press any key to exit...\n");
         fgetc(stdin);
     }
 }
 
-Result benchmark(const String& filename, int file_size, int block_size, ByteBuffer& buffer, bool allow_cache)
+struct Worker {
+    pthread_t thread;
+    int fd { -1 };
+    bool is_write { false };
+    const Options* options { nullptr };
+    int block_size { 0 };
+    int block_count { 0 };
+    int first_block { 0 };
+    int operation_count { 0 };
+    u32 random_state { 0 };
+    ByteBuffer buffer;
+    Vector<u32> latencies_us;
+    bool failed { false };
+};
+
+static void* run_worker(void* argument)
+{
+    auto& worker = *static_cast<Worker*>(argument);
+
+    for (int i = 0; i < worker.operation_count; ++i) {
+        int block = worker.first_block + i;
+        if (worker.options->random_access) {
+            // xorshift32; each thread has its own state, so there's nothing to synchronize.
+            worker.random_state ^= worker.random_state << 13;
+            worker.random_state ^= worker.random_state >> 17;
+            worker.random_state ^= worker.random_state << 5;
+            block = worker.random_state % worker.block_count;
+        }
+        off_t offset = (off_t)block * worker.block_size;
+
+        auto start = now_us();
+        ssize_t n;
+        if (worker.is_write) {
+            n = pwrite(worker.fd, worker.buffer.data(), worker.block_size, offset);
+            if (n >= 0 && worker.options->fsync_after_write && fsync(worker.fd) < 0) {
+                perror("fsync");
+                worker.failed = true;
+                return nullptr;
+            }
+        } else {
+            n = pread(worker.fd, worker.buffer.data(), worker.block_size, offset);
+        }
+        if (n < 0) {
+            perror(worker.is_write ? "pwrite" : "pread");
+            worker.failed = true;
+            return nullptr;
+        }
+        worker.latencies_us.append(now_us() - start);
+    }
+    return nullptr;
+}
+
+// Runs one pass over the file with all threads at once, and returns the throughput in bytes per second.
+static Optional<u64> run_pass(int fd, bool is_write, int file_size, int block_size, const Options& options, Vector<u32>& latencies_us)
+{
+    int block_count = file_size / block_size;
+    int thread_count = min(options.thread_count, block_count);
+
+    Vector<Worker> workers;
+    workers.resize(thread_count);
+
+    // Sequential passes split the file into one contiguous range per thread.
+    int first_block = 0;
+    for (int i = 0; i < thread_count; ++i) {
+        auto& worker = workers[i];
+        worker.fd = fd;
+        worker.is_write = is_write;
+        worker.options = &options;
+        worker.block_size = block_size;
+        worker.block_count = block_count;
+        worker.operation_count = block_count / thread_count + (i < block_count % thread_count ? 1 : 0);
+        worker.first_block = first_block;
+        worker.random_state = 0x9e3779b9u * (i + 1);
+        worker.buffer = ByteBuffer::create_zeroed(block_size);
+        worker.latencies_us.ensure_capacity(worker.operation_count);
+        first_block += worker.operation_count;
+    }
+
+    auto start = now_us();
+    for (auto& worker : workers) {
+        if (pthread_create(&worker.thread, nullptr, run_worker, &worker) != 0) {
+            perror("pthread_create");
+            exit(1);
+        }
+    }
+
+    bool failed = false;
+    for (auto& worker : workers) {
+        pthread_join(worker.thread, nullptr);
+        failed |= worker.failed;
+        latencies_us.append(move(worker.latencies_us));
+    }
+    if (failed)
+        return {};
+
+    auto elapsed = now_us() - start;
+    return (u64)block_count * block_size * 1000000 / max(elapsed, (u64)1);
+}
+
+Result benchmark(const String& filename, int file_size, int block_size, const Options& options)
 {
     int flags = O_CREAT | O_TRUNC | O_RDWR;
-    if (!allow_cache)
+    if (!options.allow_cache)
         flags |= O_DIRECT;
 
     int fd = open(filename.characters(), flags, 0644);
@@ -159,40 +360,23 @@ Result benchmark(const String& filename, int file_size, int block_size, ByteBuff
         exit(1);
     };
 
-    Result res;
-
-    Core::ElapsedTimer timer;
-
-    timer.start();
-    int nwrote = 0;
-    for (int j = 0; j < file_size; j += block_size) {
-        int n = write(fd, buffer.data(), block_size);
-        if (n < 0) {
-            perror("write");
-            cleanup_and_exit();
-        }
-        nwrote += n;
+    // Random writes don't necessarily touch every block, so give the file its full size up front.
+    if (options.random_access && ftruncate(fd, file_size) < 0) {
+        perror("ftruncate");
+        cleanup_and_exit();
     }
 
-    res.write_bps = (u64)(timer.elapsed() ? (file_size / timer.elapsed()) : file_size) * 1000;
+    Result res;
 
-    if (lseek(fd, 0, SEEK_SET) < 0) {
-        perror("lseek");
+    auto write_bps = run_pass(fd, true, file_size, block_size, options, res.write_latencies_us);
+    if (!write_bps.has_value())
         cleanup_and_exit();
-    }
-
-    timer.start();
-    int nread = 0;
-    while (nread < file_size) {
-        int n = read(fd, buffer.data(), block_size);
-        if (n < 0) {
-            perror("read");
-            cleanup_and_exit();
-        }
-        nread += n;
-    }
+    res.write_bps = write_bps.value();
 
-    res.read_bps = (u64)(timer.elapsed() ? (file_size / timer.elapsed()) : file_size) * 1000;
+    auto read_bps = run_pass(fd, false, file_size, block_size, options, res.read_latencies_us);
+    if (!read_bps.has_value())
+        cleanup_and_exit();
+    res.read_bps = read_bps.value();
 
     if (close(fd) != 0) {
         perror("close");
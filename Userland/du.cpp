@@ -30,9 +30,9 @@
 #include <AK/Vector.h>
 #include <LibCore/ArgsParser.h>
 #include <LibCore/DateTime.h>
-#include <LibCore/DirIterator.h>
 #include <LibCore/File.h>
 #include <LibCore/Object.h>
+#include <LibThread/TreeWalk.h>
 #include <limits.h>
 #include <math.h>
 #include <stdio.h>
@@ -141,43 +141,27 @@ int parse_args(int argc, char** argv, Vector<String>& files, DuOption& du_option
     return 0;
 }
 
-int print_space_usage(const String& path, const DuOption& du_option, int max_depth)
+// The space a file itself takes up, not counting anything inside it.
+static long long size_of(const struct stat& st, const DuOption& du_option)
 {
-    struct stat path_stat;
-    if (lstat(path.characters(), &path_stat) < 0) {
-        perror("lstat");
-        return 1;
-    }
-
-    if (--max_depth >= 0 && S_ISDIR(path_stat.st_mode)) {
-        auto di = Core::DirIterator(path, Core::DirIterator::SkipParentAndBaseDir);
-        if (di.has_error()) {
-            fprintf(stderr, "DirIterator: %s\n", di.error_string());
-            return 1;
-        }
-        while (di.has_next()) {
-            const auto child_path = di.next_full_path();
-            if (du_option.all || Core::File::is_directory(child_path)) {
-                if (print_space_usage(child_path, du_option, max_depth))
-                    return 1;
-            }
-        }
+    long long size = st.st_size;
+    if (du_option.apparent_size) {
+        const auto block_size = 512;
+        size = st.st_blocks * block_size;
     }
+    return size;
+}
 
+static void print_usage_line(const String& path, const struct stat& st, long long size, const DuOption& du_option)
+{
     const auto basename = LexicalPath(path).basename();
     for (const auto& pattern : du_option.excluded_patterns) {
         if (basename.matches(pattern, CaseSensitivity::CaseSensitive))
-            return 0;
-    }
-
-    long long size = path_stat.st_size;
-    if (du_option.apparent_size) {
-        const auto block_size = 512;
-        size = path_stat.st_blocks * block_size;
+            return;
     }
 
     if ((du_option.threshold > 0 && size < du_option.threshold) || (du_option.threshold < 0 && size > -du_option.threshold))
-        return 0;
+        return;
 
     const long long block_size = 1024;
     size = size / block_size + (size % block_size != 0);
@@ -185,13 +169,13 @@ int print_space_usage(const String& path, const DuOption& du_option, int max_dep
     if (du_option.time_type == DuOption::TimeType::NotUsed)
         printf("%lld\t%s\n", size, path.characters());
     else {
-        auto time = path_stat.st_mtime;
+        auto time = st.st_mtime;
         switch (du_option.time_type) {
         case DuOption::TimeType::Access:
-            time = path_stat.st_atime;
+            time = st.st_atime;
             break;
         case DuOption::TimeType::Status:
-            time = path_stat.st_ctime;
+            time = st.st_ctime;
         default:
             break;
         }
@@ -199,6 +183,55 @@ int print_space_usage(const String& path, const DuOption& du_option, int max_dep
         const auto formatted_time = Core::DateTime::from_timestamp(time).to_string();
         printf("%lld\t%s\t%s\n", size, formatted_time.characters(), path.characters());
     }
+}
 
-    return 0;
+int print_space_usage(const String& path, const DuOption& du_option, int max_depth)
+{
+    // The directories we're in. Each one is printed with the total of everything below it once
+    // the walk leaves it, which the entries coming in depth-first order tell us.
+    struct Directory {
+        String path;
+        struct stat stat;
+        int depth;
+        long long size;
+    };
+    Vector<Directory> directories;
+    bool had_error = false;
+
+    auto leave_directory = [&] {
+        auto directory = directories.take_last();
+        if (directory.depth <= max_depth)
+            print_usage_line(directory.path, directory.stat, directory.size, du_option);
+        if (!directories.is_empty())
+            directories.last().size += directory.size;
+    };
+
+    LibThread::TreeWalk walk(path);
+    walk.set_stat_entries(true);
+    walk.on_entry = [&](auto& entry) {
+        while (!directories.is_empty() && directories.last().depth >= entry.depth)
+            leave_directory();
+        if (!entry.has_stat)
+            return IterationDecision::Continue;
+
+        auto size = size_of(entry.stat, du_option);
+        if (entry.type == DT_DIR) {
+            directories.append({ entry.path, entry.stat, entry.depth, size });
+            return IterationDecision::Continue;
+        }
+        if (!directories.is_empty())
+            directories.last().size += size;
+        if (entry.depth == 0 || (du_option.all && entry.depth <= max_depth))
+            print_usage_line(entry.path, entry.stat, size, du_option);
+        return IterationDecision::Continue;
+    };
+    walk.on_error = [&](auto& error_path, int error) {
+        fprintf(stderr, "du: %s: %s\n", error_path.characters(), strerror(error));
+        had_error = true;
+    };
+    walk.run();
+
+    while (!directories.is_empty())
+        leave_directory();
+    return had_error ? 1 : 0;
 }
@@ -24,25 +24,21 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
-#include <assert.h>
+#include <AK/Vector.h>
 #include <stdio.h>
-#include <string.h>
 #include <unistd.h>
 
+// fgrep is grep -F.
 int main(int argc, char** argv)
 {
-    if (argc < 2) {
-        printf("usage: fgrep <str>\n");
-        return 0;
-    }
-    for (;;) {
-        char buf[4096];
-        auto* str = fgets(buf, sizeof(buf), stdin);
-        if (str && strstr(str, argv[1]))
-            write(1, buf, strlen(buf));
-        if (feof(stdin))
-            return 0;
-        ASSERT(str);
-    }
-    return 0;
+    Vector<char*> arguments;
+    arguments.append(const_cast<char*>("grep"));
+    arguments.append(const_cast<char*>("-F"));
+    for (int i = 1; i < argc; ++i)
+        arguments.append(argv[i]);
+    arguments.append(nullptr);
+
+    execvp("grep", arguments.data());
+    perror("execvp");
+    return 2;
 }
@@ -27,11 +27,12 @@
 #include <AK/NonnullOwnPtr.h>
 #include <AK/OwnPtr.h>
 #include <AK/Vector.h>
-#include <LibCore/DirIterator.h>
+#include <LibThread/TreeWalk.h>
 #include <getopt.h>
 #include <grp.h>
 #include <pwd.h>
 #include <stdio.h>
+#include <string.h>
 #include <sys/stat.h>
 #include <sys/wait.h>
 #include <unistd.h>
@@ -39,6 +40,8 @@
 bool g_follow_symlinks = false;
 bool g_there_was_an_error = false;
 bool g_have_seen_action_command = false;
+// Whether any command looks at more than the file type, so the walk might as well stat everything.
+bool g_need_stat = false;
 
 [[noreturn]] static void fatal_error(const char* format, ...)
 {
@@ -53,28 +56,50 @@ bool g_have_seen_action_command = false;
     exit(1);
 }
 
+// What we know about a file while walking the tree. Its type comes from the directory entry
+// where possible, and the file is only stat'ed (once) when a command needs more than that.
+struct FileData {
+    const char* full_path;
+    unsigned char d_type { DT_UNKNOWN };
+
+    const struct stat* ensure_stat()
+    {
+        if (!stat_was_attempted) {
+            stat_was_attempted = true;
+            auto stat_func = g_follow_symlinks ? ::stat : ::lstat;
+            int rc = stat_func(full_path, &stat);
+            if (rc < 0) {
+                perror(full_path);
+                g_there_was_an_error = true;
+            } else {
+                stat_succeeded = true;
+            }
+        }
+        return stat_succeeded ? &stat : nullptr;
+    }
+
+    struct stat stat {};
+    bool stat_was_attempted { false };
+    bool stat_succeeded { false };
+};
+
 class Command {
 public:
     virtual ~Command() { }
-    virtual bool evaluate(const char* file_path) const = 0;
+    virtual bool evaluate(FileData&) const = 0;
 };
 
 class StatCommand : public Command {
 public:
     virtual bool evaluate(const struct stat&) const = 0;
 
-private:
-    virtual bool evaluate(const char* file_path) const override
+protected:
+    virtual bool evaluate(FileData& file_data) const override
     {
-        struct stat stat;
-        auto stat_func = g_follow_symlinks ? ::stat : ::lstat;
-        int rc = stat_func(file_path, &stat);
-        if (rc < 0) {
-            perror(file_path);
-            g_there_was_an_error = true;
+        auto* stat = file_data.ensure_stat();
+        if (!stat)
             return false;
-        }
-        return evaluate(stat);
+        return evaluate(*stat);
     }
 };
 
@@ -89,6 +114,34 @@ public:
     }
 
 private:
+    virtual bool evaluate(FileData& file_data) const override
+    {
+        // Symlinks we're following have to be looked at, as does everything the file system
+        // doesn't know the type of. For anything else, the directory entry is enough.
+        auto type = file_data.d_type;
+        if (type == DT_UNKNOWN || (type == DT_LNK && g_follow_symlinks))
+            return StatCommand::evaluate(file_data);
+
+        switch (m_type) {
+        case 'b':
+            return type == DT_BLK;
+        case 'c':
+            return type == DT_CHR;
+        case 'd':
+            return type == DT_DIR;
+        case 'l':
+            return type == DT_LNK;
+        case 'p':
+            return type == DT_FIFO;
+        case 'f':
+            return type == DT_REG;
+        case 's':
+            return type == DT_SOCK;
+        default:
+            ASSERT_NOT_REACHED();
+        }
+    }
+
     virtual bool evaluate(const struct stat& stat) const override
     {
         auto type = stat.st_mode;
@@ -220,9 +273,9 @@ public:
     }
 
 private:
-    virtual bool evaluate(const char* file_path) const override
+    virtual bool evaluate(FileData& file_data) const override
     {
-        printf("%s%c", file_path, m_terminator);
+        printf("%s%c", file_data.full_path, m_terminator);
         return true;
     }
 
@@ -237,7 +290,7 @@ public:
     }
 
 private:
-    virtual bool evaluate(const char* file_path) const override
+    virtual bool evaluate(FileData& file_data) const override
     {
         pid_t pid = fork();
 
@@ -252,7 +305,7 @@ private:
             auto argv = const_cast<Vector<char*>&>(m_argv);
             for (auto& arg : argv) {
                 if (StringView(arg) == "{}")
-                    arg = const_cast<char*>(file_path);
+                    arg = const_cast<char*>(file_data.full_path);
             }
             argv.append(nullptr);
             execvp(m_argv[0], argv.data());
@@ -282,9 +335,9 @@ public:
     }
 
 private:
-    virtual bool evaluate(const char* file_path) const override
+    virtual bool evaluate(FileData& file_data) const override
     {
-        return m_lhs->evaluate(file_path) && m_rhs->evaluate(file_path);
+        return m_lhs->evaluate(file_data) && m_rhs->evaluate(file_data);
     }
 
     NonnullOwnPtr<Command> m_lhs;
@@ -300,9 +353,9 @@ public:
     }
 
 private:
-    virtual bool evaluate(const char* file_path) const override
+    virtual bool evaluate(FileData& file_data) const override
     {
-        return m_lhs->evaluate(file_path) || m_rhs->evaluate(file_path);
+        return m_lhs->evaluate(file_data) || m_rhs->evaluate(file_data);
     }
 
     NonnullOwnPtr<Command> m_lhs;
@@ -328,12 +381,16 @@ static OwnPtr<Command> parse_simple_command(char* argv[])
     } else if (arg == "-type") {
         return make<TypeCommand>(argv[++optind]);
     } else if (arg == "-links") {
+        g_need_stat = true;
         return make<LinksCommand>(argv[++optind]);
     } else if (arg == "-user") {
+        g_need_stat = true;
         return make<UserCommand>(argv[++optind]);
     } else if (arg == "-group") {
+        g_need_stat = true;
         return make<GroupCommand>(argv[++optind]);
     } else if (arg == "-size") {
+        g_need_stat = true;
         return make<SizeCommand>(argv[++optind]);
     } else if (arg == "-print") {
         g_have_seen_action_command = true;
@@ -442,27 +499,31 @@ static const char* parse_options(int argc, char* argv[])
     }
 }
 
-static void walk_tree(const char* root_path, Command& command)
-{
-    command.evaluate(root_path);
-
-    Core::DirIterator dir_iterator(root_path, Core::DirIterator::SkipParentAndBaseDir);
-    if (dir_iterator.has_error() && dir_iterator.error() == ENOTDIR)
-        return;
-
-    while (dir_iterator.has_next())
-        walk_tree(dir_iterator.next_full_path().characters(), command);
-
-    if (dir_iterator.has_error()) {
-        fprintf(stderr, "%s: %s\n", root_path, dir_iterator.error_string());
-        g_there_was_an_error = true;
-    }
-}
-
 int main(int argc, char* argv[])
 {
     auto root_path = parse_options(argc, argv);
     auto command = parse_all_commands(argv);
-    walk_tree(root_path, *command);
+
+    // The directories are listed in parallel, but the commands see the files in the same order
+    // as they would if we walked the tree ourselves.
+    LibThread::TreeWalk walk(root_path);
+    walk.set_follow_symlinks(g_follow_symlinks);
+    walk.set_stat_entries(g_need_stat);
+    walk.on_entry = [&](auto& entry) {
+        FileData file_data { entry.path.characters(), entry.type };
+        if (entry.has_stat) {
+            file_data.stat = entry.stat;
+            file_data.stat_succeeded = true;
+        }
+        // If the walk tried and failed, it has already complained.
+        file_data.stat_was_attempted = entry.has_stat || g_need_stat;
+        command->evaluate(file_data);
+        return IterationDecision::Continue;
+    };
+    walk.on_error = [](auto& path, int error) {
+        fprintf(stderr, "%s: %s\n", path.characters(), strerror(error));
+        g_there_was_an_error = true;
+    };
+    walk.run();
     return g_there_was_an_error ? 1 : 0;
 }
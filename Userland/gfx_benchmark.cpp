@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <AK/Function.h>
+#include <AK/String.h>
+#include <AK/Vector.h>
+#include <LibCore/ElapsedTimer.h>
+#include <LibGfx/Bitmap.h>
+#include <LibGfx/Painter.h>
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+static constexpr int rows = 256;
+
+static void exit_with_usage(int rc)
+{
+    fprintf(stderr, "Usage: gfx_benchmark [-h] [-t time_per_benchmark_ms] [-w width1,width2,...]\n");
+    exit(rc);
+}
+
+static void fill_with_noise(Gfx::Bitmap& bitmap, bool translucent)
+{
+    u32 seed = 0x9e3779b9;
+    for (int y = 0; y < bitmap.height(); ++y) {
+        for (int x = 0; x < bitmap.width(); ++x) {
+            seed = seed * 1103515245 + 12345;
+            u32 alpha = translucent ? (seed >> 24) : 0xff;
+            bitmap.scanline(y)[x] = (seed & 0xffffff) | (alpha << 24);
+        }
+    }
+}
+
+static void benchmark(const char* name, int width, int time_per_benchmark, Function<void()> callback)
+{
+    int iterations = 0;
+    Core::ElapsedTimer timer;
+    timer.start();
+    while (timer.elapsed() < time_per_benchmark) {
+        callback();
+        ++iterations;
+    }
+    int elapsed = max(timer.elapsed(), 1);
+    double megapixels = (double)iterations * width * rows / 1000000;
+    printf("%-20s width=%-5d %8.1f Mpx/s\n", name, width, megapixels * 1000 / elapsed);
+}
+
+int main(int argc, char** argv)
+{
+    int time_per_benchmark = 1000;
+    Vector<int> widths;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "ht:w:")) != -1) {
+        switch (opt) {
+        case 'h':
+            exit_with_usage(0);
+            break;
+        case 't':
+            time_per_benchmark = atoi(optarg);
+            break;
+        case 'w':
+            for (auto width : String(optarg).split(','))
+                widths.append(atoi(width.characters()));
+            break;
+        default:
+            exit_with_usage(1);
+        }
+    }
+
+    if (widths.is_empty())
+        widths = { 16, 64, 512, 1920 };
+
+    for (auto width : widths) {
+        if (width <= 0)
+            continue;
+        auto target = Gfx::Bitmap::create(Gfx::BitmapFormat::RGB32, { width, rows });
+        auto opaque_source = Gfx::Bitmap::create(Gfx::BitmapFormat::RGB32, { width, rows });
+        auto translucent_source = Gfx::Bitmap::create(Gfx::BitmapFormat::RGBA32, { width, rows });
+        if (!target || !opaque_source || !translucent_source) {
+            fprintf(stderr, "Failed to allocate bitmaps of width %d\n", width);
+            return 1;
+        }
+        fill_with_noise(*target, false);
+        fill_with_noise(*opaque_source, false);
+        fill_with_noise(*translucent_source, true);
+
+        Gfx::Painter painter(*target);
+        benchmark("fill", width, time_per_benchmark, [&] {
+            painter.fill_rect(target->rect(), Color::from_rgb(0x336699));
+        });
+        benchmark("fill_translucent", width, time_per_benchmark, [&] {
+            painter.fill_rect(target->rect(), Color::from_rgba(0x80336699));
+        });
+        benchmark("blit", width, time_per_benchmark, [&] {
+            painter.blit({}, *opaque_source, opaque_source->rect());
+        });
+        benchmark("blit_with_alpha", width, time_per_benchmark, [&] {
+            painter.blit({}, *translucent_source, translucent_source->rect());
+        });
+        benchmark("blit_with_opacity", width, time_per_benchmark, [&] {
+            painter.blit({}, *opaque_source, opaque_source->rect(), 0.5f);
+        });
+        benchmark("blit_brightened", width, time_per_benchmark, [&] {
+            painter.blit_brightened({}, *translucent_source, translucent_source->rect());
+        });
+    }
+
+    return 0;
+}
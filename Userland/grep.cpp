@@ -0,0 +1,549 @@
+/*
+ * Copyright (c) 2018-2020, The SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <AK/Atomic.h>
+#include <AK/ByteBuffer.h>
+#include <AK/LexicalPath.h>
+#include <AK/MappedFile.h>
+#include <AK/OwnPtr.h>
+#include <AK/String.h>
+#include <AK/StringBuilder.h>
+#include <AK/Vector.h>
+#include <LibCore/ArgsParser.h>
+#include <LibCore/DirIterator.h>
+#include <LibRegex/Regex.h>
+#include <LibThread/Lock.h>
+#include <LibThread/ThreadPool.h>
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if ARCH(I386) || ARCH(X86_64)
+#    include <cpuid.h>
+#    include <emmintrin.h>
+#endif
+
+static bool has_sse2()
+{
+#if ARCH(I386) || ARCH(X86_64)
+    static bool s_has_sse2 = [] {
+        unsigned eax, ebx, ecx, edx;
+        return __get_cpuid(1, &eax, &ebx, &ecx, &edx) && (edx & bit_SSE2);
+    }();
+    return s_has_sse2;
+#else
+    return false;
+#endif
+}
+
+class Matcher {
+public:
+    virtual ~Matcher() { }
+
+    // Returns the offset of a match at or after start that lies within a single line,
+    // or nothing if there's no such match left in the buffer.
+    virtual Optional<size_t> find(const u8* data, size_t size, size_t start) const = 0;
+};
+
+class LiteralMatcher final : public Matcher {
+public:
+    LiteralMatcher(const StringView& needle, bool ignore_case)
+        : m_needle(needle)
+        , m_ignore_case(ignore_case)
+    {
+        if (m_ignore_case)
+            m_needle = m_needle.to_lowercase();
+
+        // Horspool's bad character table: how far the window may move when its last byte is c.
+        size_t length = m_needle.length();
+        for (size_t i = 0; i < 256; ++i)
+            m_shift[i] = length;
+        for (size_t i = 0; i + 1 < length; ++i) {
+            m_shift[(u8)m_needle[i]] = length - 1 - i;
+            if (m_ignore_case)
+                m_shift[toupper((u8)m_needle[i])] = length - 1 - i;
+        }
+    }
+
+    virtual Optional<size_t> find(const u8* data, size_t size, size_t start) const override
+    {
+        size_t length = m_needle.length();
+        if (length == 0)
+            return start < size ? start : Optional<size_t> {};
+        if (m_ignore_case)
+            return find_horspool<true>(data, size, start);
+        if (length == 1) {
+            auto* found = (const u8*)memchr(data + start, m_needle[0], size - start);
+            if (!found)
+                return {};
+            return found - data;
+        }
+#if ARCH(I386) || ARCH(X86_64)
+        if (has_sse2())
+            return find_sse2(data, size, start);
+#endif
+        return find_horspool<false>(data, size, start);
+    }
+
+private:
+    template<bool ignore_case>
+    Optional<size_t> find_horspool(const u8* data, size_t size, size_t start) const
+    {
+        size_t length = m_needle.length();
+        auto* needle = (const u8*)m_needle.characters();
+        size_t position = start;
+        while (position + length <= size) {
+            u8 last = data[position + length - 1];
+            if ((ignore_case ? (u8)tolower(last) : last) == needle[length - 1]) {
+                size_t i = 0;
+                if constexpr (ignore_case) {
+                    while (i + 1 < length && (u8)tolower(data[position + i]) == needle[i])
+                        ++i;
+                } else {
+                    while (i + 1 < length && data[position + i] == needle[i])
+                        ++i;
+                }
+                if (i + 1 >= length)
+                    return position;
+            }
+            position += m_shift[last];
+        }
+        return {};
+    }
+
+#if ARCH(I386) || ARCH(X86_64)
+    // Compares 16 candidate positions at once against the first and the last byte of the
+    // needle, and only looks at the rest of it where both of those matched.
+    [[gnu::target("sse2")]] Optional<size_t> find_sse2(const u8* data, size_t size, size_t start) const
+    {
+        size_t length = m_needle.length();
+        auto* needle = (const u8*)m_needle.characters();
+        auto first = _mm_set1_epi8((char)needle[0]);
+        auto last = _mm_set1_epi8((char)needle[length - 1]);
+
+        size_t position = start;
+        while (position + length - 1 + 16 <= size) {
+            auto block_first = _mm_loadu_si128((const __m128i*)(data + position));
+            auto block_last = _mm_loadu_si128((const __m128i*)(data + position + length - 1));
+            unsigned mask = _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(block_first, first), _mm_cmpeq_epi8(block_last, last)));
+            while (mask) {
+                unsigned bit = __builtin_ctz(mask);
+                if (!memcmp(data + position + bit + 1, needle + 1, length - 2))
+                    return position + bit;
+                mask &= mask - 1;
+            }
+            position += 16;
+        }
+        return find_horspool<false>(data, size, position);
+    }
+#endif
+
+    String m_needle;
+    bool m_ignore_case { false };
+    size_t m_shift[256];
+};
+
+class RegexMatcher final : public Matcher {
+public:
+    explicit RegexMatcher(const Regex::Pattern& pattern)
+        : m_pattern(pattern)
+    {
+    }
+
+    virtual Optional<size_t> find(const u8* data, size_t size, size_t start) const override
+    {
+        StringView buffer { (const char*)data, size };
+        while (start < size) {
+            auto match = m_pattern.search(buffer, start);
+            if (!match.has_value())
+                return {};
+            auto& span = match.value().span();
+
+            // The whole buffer is searched in one go, so a match may run across a line break.
+            // In that case, see whether the line it starts on matches by itself.
+            size_t line_start = span.start;
+            while (line_start > start && data[line_start - 1] != '\n')
+                --line_start;
+            auto* newline = (const u8*)memchr(data + span.start, '\n', size - span.start);
+            size_t line_end = newline ? newline - data : size;
+            if (span.end <= line_end)
+                return span.start;
+
+            auto line_match = m_pattern.search(buffer.substring_view(line_start, line_end - line_start));
+            if (line_match.has_value())
+                return line_start + line_match.value().span().start;
+            start = line_end + 1;
+        }
+        return {};
+    }
+
+private:
+    const Regex::Pattern& m_pattern;
+};
+
+struct Options {
+    bool invert { false };
+    bool count { false };
+    bool files_with_matches { false };
+    bool line_numbers { false };
+    bool quiet { false };
+    bool show_filenames { false };
+};
+
+static Options s_options;
+static OwnPtr<Matcher> s_matcher;
+static OwnPtr<Regex::Pattern> s_pattern;
+static Atomic<bool> s_any_line_selected { false };
+static Atomic<bool> s_had_error { false };
+static LibThread::Lock s_output_lock;
+
+static void write_to_stdout(const StringView& string)
+{
+    LOCKER(s_output_lock);
+    size_t offset = 0;
+    while (offset < string.length()) {
+        ssize_t nwritten = write(STDOUT_FILENO, string.characters_without_null_termination() + offset, string.length() - offset);
+        if (nwritten < 0) {
+            if (errno == EINTR)
+                continue;
+            exit(2);
+        }
+        offset += nwritten;
+    }
+}
+
+// Collects the output for one file and hands it to stdout in large pieces, whole lines at a time,
+// so that files searched in parallel don't interleave within a line.
+class Output {
+public:
+    ~Output() { flush(); }
+
+    void append_line(const String& filename, size_t line_number, const u8* line, size_t length)
+    {
+        if (s_options.show_filenames) {
+            m_builder.append(filename);
+            m_builder.append(':');
+        }
+        if (s_options.line_numbers)
+            m_builder.appendf("%zu:", line_number);
+        m_builder.append((const char*)line, length);
+        m_builder.append('\n');
+        if (m_builder.length() >= 64 * KB)
+            flush();
+    }
+
+    void append(const StringView& string) { m_builder.append(string); }
+
+    void flush()
+    {
+        if (m_builder.length() == 0)
+            return;
+        write_to_stdout(m_builder.string_view());
+        m_builder.clear();
+    }
+
+private:
+    StringBuilder m_builder;
+};
+
+static size_t count_newlines(const u8* data, size_t size)
+{
+    size_t count = 0;
+    const u8* end = data + size;
+    while (data < end) {
+        auto* newline = (const u8*)memchr(data, '\n', end - data);
+        if (!newline)
+            break;
+        ++count;
+        data = newline + 1;
+    }
+    return count;
+}
+
+static void search_buffer(const String& filename, const u8* data, size_t size)
+{
+    Output output;
+    size_t selected_count = 0;
+    bool stop_at_first = s_options.quiet || s_options.files_with_matches;
+    bool print_lines = !s_options.count && !stop_at_first;
+
+    // Line numbers are only counted for the stretches we skip over when they're needed.
+    size_t line_number = 1;
+    size_t line_number_position = 0;
+    auto line_number_at = [&](size_t position) {
+        line_number += count_newlines(data + line_number_position, position - line_number_position);
+        line_number_position = position;
+        return line_number;
+    };
+
+    auto select_line = [&](size_t line_start, size_t line_end) {
+        ++selected_count;
+        if (print_lines)
+            output.append_line(filename, s_options.line_numbers ? line_number_at(line_start) : 0, data + line_start, line_end - line_start);
+    };
+
+    // Selects every line in [start, end), for -v.
+    auto select_lines = [&](size_t start, size_t end) {
+        while (start < end) {
+            auto* newline = (const u8*)memchr(data + start, '\n', end - start);
+            size_t line_end = newline ? newline - data : end;
+            select_line(start, line_end);
+            if (stop_at_first)
+                return;
+            start = line_end + 1;
+        }
+    };
+
+    size_t position = 0;
+    while (position < size) {
+        if (stop_at_first && selected_count)
+            break;
+        auto match = s_matcher->find(data, size, position);
+        if (!match.has_value()) {
+            if (s_options.invert)
+                select_lines(position, size);
+            break;
+        }
+
+        // Only the line around the match is ever looked at, everything in between is skipped.
+        size_t line_start = match.value();
+        while (line_start > position && data[line_start - 1] != '\n')
+            --line_start;
+        auto* newline = (const u8*)memchr(data + match.value(), '\n', size - match.value());
+        size_t line_end = newline ? newline - data : size;
+
+        if (s_options.invert)
+            select_lines(position, line_start);
+        else
+            select_line(line_start, line_end);
+        position = line_end + 1;
+    }
+
+    if (selected_count)
+        s_any_line_selected = true;
+    if (s_options.quiet)
+        return;
+    if (s_options.files_with_matches) {
+        if (selected_count) {
+            output.append(filename);
+            output.append("\n");
+        }
+    } else if (s_options.count) {
+        if (s_options.show_filenames) {
+            output.append(filename);
+            output.append(":");
+        }
+        output.append(String::format("%zu\n", selected_count));
+    }
+}
+
+static bool read_all(int fd, ByteBuffer& buffer)
+{
+    for (;;) {
+        u8 chunk[64 * KB];
+        ssize_t nread = read(fd, chunk, sizeof(chunk));
+        if (nread < 0) {
+            if (errno == EINTR)
+                continue;
+            return false;
+        }
+        if (nread == 0)
+            return true;
+        buffer.append(chunk, nread);
+    }
+}
+
+static void search_file(const String& path)
+{
+    if (path == "-") {
+        ByteBuffer buffer;
+        if (!read_all(STDIN_FILENO, buffer)) {
+            perror("read");
+            s_had_error = true;
+            return;
+        }
+        search_buffer("(standard input)", buffer.data(), buffer.size());
+        return;
+    }
+
+    struct stat st;
+    if (stat(path.characters(), &st) < 0) {
+        fprintf(stderr, "grep: %s: %s\n", path.characters(), strerror(errno));
+        s_had_error = true;
+        return;
+    }
+    if (S_ISDIR(st.st_mode)) {
+        fprintf(stderr, "grep: %s: Is a directory\n", path.characters());
+        return;
+    }
+
+    if (S_ISREG(st.st_mode)) {
+        if (st.st_size == 0) {
+            search_buffer(path, nullptr, 0);
+            return;
+        }
+        MappedFile file(path);
+        if (!file.is_valid()) {
+            s_had_error = true;
+            return;
+        }
+        search_buffer(path, (const u8*)file.data(), file.size());
+        return;
+    }
+
+    // Pipes and devices can't be mapped, so read those in full instead.
+    int fd = open(path.characters(), O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "grep: %s: %s\n", path.characters(), strerror(errno));
+        s_had_error = true;
+        return;
+    }
+    ByteBuffer buffer;
+    bool ok = read_all(fd, buffer);
+    close(fd);
+    if (!ok) {
+        fprintf(stderr, "grep: %s: %s\n", path.characters(), strerror(errno));
+        s_had_error = true;
+        return;
+    }
+    search_buffer(path, buffer.data(), buffer.size());
+}
+
+static Atomic<size_t> s_pending_task_count { 0 };
+
+static void enqueue_search(Function<void()> task)
+{
+    ++s_pending_task_count;
+    LibThread::ThreadPool::the().enqueue([task = move(task)] {
+        task();
+        --s_pending_task_count;
+    });
+}
+
+// Walks the tree on the thread pool: every directory is listed by its own task, which queues
+// the files it finds to be searched (and its subdirectories to be listed) in parallel.
+static void search_directory(const String& path)
+{
+    Core::DirIterator iterator(path, Core::DirIterator::SkipDots);
+    if (iterator.has_error()) {
+        fprintf(stderr, "grep: %s: %s\n", path.characters(), iterator.error_string());
+        s_had_error = true;
+        return;
+    }
+    while (iterator.has_next()) {
+        auto entry_path = LexicalPath::canonicalized_path(String::format("%s/%s", path.characters(), iterator.next_path().characters()));
+        struct stat st;
+        if (lstat(entry_path.characters(), &st) < 0) {
+            fprintf(stderr, "grep: %s: %s\n", entry_path.characters(), strerror(errno));
+            s_had_error = true;
+            continue;
+        }
+        if (S_ISDIR(st.st_mode))
+            enqueue_search([entry_path] { search_directory(entry_path); });
+        else if (S_ISREG(st.st_mode))
+            enqueue_search([entry_path] { search_file(entry_path); });
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (pledge("stdio rpath thread", nullptr) < 0) {
+        perror("pledge");
+        return 2;
+    }
+
+    bool fixed_strings = false;
+    bool extended = false;
+    bool ignore_case = false;
+    bool recursive = false;
+    bool with_filename = false;
+    bool no_filename = false;
+    const char* pattern = nullptr;
+    Vector<const char*> paths;
+
+    Core::ArgsParser args_parser;
+    args_parser.add_option(extended, "Interpret the pattern as an extended regular expression", "extended-regexp", 'E');
+    args_parser.add_option(fixed_strings, "Interpret the pattern as a fixed string", "fixed-strings", 'F');
+    args_parser.add_option(ignore_case, "Ignore case distinctions", "ignore-case", 'i');
+    args_parser.add_option(s_options.invert, "Select lines that don't match", "invert-match", 'v');
+    args_parser.add_option(s_options.count, "Only print the number of selected lines per file", "count", 'c');
+    args_parser.add_option(s_options.files_with_matches, "Only print the names of files with selected lines", "files-with-matches", 'l');
+    args_parser.add_option(s_options.line_numbers, "Prefix each line with its line number", "line-number", 'n');
+    args_parser.add_option(s_options.quiet, "Print nothing, only set the exit status", "quiet", 'q');
+    args_parser.add_option(recursive, "Search directories recursively", "recursive", 'r');
+    args_parser.add_option(with_filename, "Prefix each line with its file name", "with-filename", 'H');
+    args_parser.add_option(no_filename, "Don't prefix lines with file names", "no-filename", 'h');
+    args_parser.add_positional_argument(pattern, "Pattern to search for", "pattern");
+    args_parser.add_positional_argument(paths, "Files to search", "files", Core::ArgsParser::Required::No);
+    args_parser.parse(argc, argv);
+
+    if (fixed_strings) {
+        if (strchr(pattern, '\n')) {
+            fprintf(stderr, "grep: Patterns spanning several lines are not supported\n");
+            return 2;
+        }
+        s_matcher = make<LiteralMatcher>(pattern, ignore_case);
+    } else {
+        Regex::Options options;
+        options.case_insensitive = ignore_case;
+        options.multiline = true;
+        s_pattern = make<Regex::Pattern>(pattern, extended ? Regex::Syntax::POSIXExtended : Regex::Syntax::POSIXBasic, options);
+        if (s_pattern->has_error()) {
+            fprintf(stderr, "grep: %s\n", Regex::error_string(s_pattern->error()));
+            return 2;
+        }
+        s_matcher = make<RegexMatcher>(*s_pattern);
+    }
+
+    if (paths.is_empty())
+        paths.append(recursive ? "." : "-");
+    s_options.show_filenames = !no_filename && (with_filename || recursive || paths.size() > 1);
+
+    for (auto* path : paths) {
+        struct stat st;
+        if (recursive && stat(path, &st) == 0 && S_ISDIR(st.st_mode)) {
+            String directory = path;
+            enqueue_search([directory] { search_directory(directory); });
+            continue;
+        }
+        if (!recursive) {
+            search_file(path);
+            continue;
+        }
+        String file = path;
+        enqueue_search([file] { search_file(file); });
+    }
+    if (recursive)
+        LibThread::ThreadPool::the().run_tasks_until([] { return s_pending_task_count.load() == 0; });
+
+    if (s_had_error && !(s_options.quiet && s_any_line_selected))
+        return 2;
+    return s_any_line_selected ? 0 : 1;
+}
@@ -24,15 +24,14 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
-#include <AK/JsonArray.h>
 #include <AK/JsonObject.h>
-#include <AK/JsonValue.h>
+#include <AK/JsonPullParser.h>
 #include <AK/StringBuilder.h>
 #include <LibCore/File.h>
 #include <stdio.h>
 
 static bool use_color = false;
-static void print(const String& name, const JsonValue&, Vector<String>& trail);
+static bool print(JsonPullParser&, JsonPullParser::Event, const String& name, Vector<String>& trail);
 
 static const char* color_name = "";
 static const char* color_index = "";
@@ -73,8 +72,6 @@ int main(int argc, char** argv)
     }
 
     auto file_contents = file->read_all();
-    auto json = JsonValue::from_string(file_contents);
-    ASSERT(json.has_value());
 
     if (use_color) {
         color_name = "\033[33;1m";
@@ -86,43 +83,64 @@ int main(int argc, char** argv)
         color_off = "\033[0m";
     }
 
+    // The document is printed as it's parsed, so it never needs to be held as a JsonValue tree.
+    JsonPullParser parser(file_contents);
     Vector<String> trail;
-    print("json", json.value(), trail);
+    if (!print(parser, parser.next(), "json", trail) || parser.next() != JsonPullParser::Event::End) {
+        fprintf(stderr, "gron: %s is not valid JSON\n", argv[1]);
+        return 1;
+    }
     return 0;
 }
 
-static void print(const String& name, const JsonValue& value, Vector<String>& trail)
+static bool print(JsonPullParser& parser, JsonPullParser::Event event, const String& name, Vector<String>& trail)
 {
+    if (event == JsonPullParser::Event::Error || event == JsonPullParser::Event::End)
+        return false;
+
     for (size_t i = 0; i < trail.size(); ++i)
         printf("%s", trail[i].characters());
 
     printf("%s%s%s = ", color_name, name.characters(), color_off);
 
-    if (value.is_object()) {
+    if (event == JsonPullParser::Event::ObjectStart) {
         printf("%s{}%s;\n", color_brace, color_off);
         trail.append(String::format("%s%s%s.", color_name, name.characters(), color_off));
-        value.as_object().for_each_member([&](auto& on, auto& ov) { print(on, ov, trail); });
+        for (;;) {
+            event = parser.next();
+            if (event == JsonPullParser::Event::ObjectEnd)
+                break;
+            if (event != JsonPullParser::Event::Key)
+                return false;
+            String member_name = parser.string();
+            if (!print(parser, parser.next(), member_name, trail))
+                return false;
+        }
         trail.take_last();
-        return;
+        return true;
     }
-    if (value.is_array()) {
+    if (event == JsonPullParser::Event::ArrayStart) {
         printf("%s[]%s;\n", color_brace, color_off);
         trail.append(String::format("%s%s%s", color_name, name.characters(), color_off));
-        for (int i = 0; i < value.as_array().size(); ++i) {
+        for (int i = 0;; ++i) {
+            event = parser.next();
+            if (event == JsonPullParser::Event::ArrayEnd)
+                break;
             auto element_name = String::format("%s%s[%s%s%d%s%s]%s", color_off, color_brace, color_off, color_index, i, color_off, color_brace, color_off);
-            print(element_name, value.as_array()[i], trail);
+            if (!print(parser, event, element_name, trail))
+                return false;
         }
         trail.take_last();
-        return;
+        return true;
     }
-    switch (value.type()) {
-    case JsonValue::Type::Null:
+    switch (event) {
+    case JsonPullParser::Event::Null:
         printf("%s", color_null);
         break;
-    case JsonValue::Type::Bool:
+    case JsonPullParser::Event::Bool:
         printf("%s", color_bool);
         break;
-    case JsonValue::Type::String:
+    case JsonPullParser::Event::String:
         printf("%s", color_string);
         break;
     default:
@@ -130,5 +148,6 @@ static void print(const String& name, const JsonValue& value, Vector<String>& tr
         break;
     }
 
-    printf("%s%s;\n", value.serialized<StringBuilder>().characters(), color_off);
+    printf("%s%s;\n", parser.value().serialized<StringBuilder>().characters(), color_off);
+    return true;
 }
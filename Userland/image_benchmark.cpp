@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <AK/MappedFile.h>
+#include <AK/String.h>
+#include <AK/Vector.h>
+#include <LibCore/ElapsedTimer.h>
+#include <LibGfx/Bitmap.h>
+#include <LibGfx/ImageDecoder.h>
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+static void exit_with_usage(int rc)
+{
+    fprintf(stderr, "Usage: image_benchmark [-h] [-t time_per_benchmark_ms] [-s size1,size2,...] <file...>\n");
+    exit(rc);
+}
+
+static void benchmark(const char* path, const MappedFile& file, int size, int time_per_benchmark)
+{
+    int iterations = 0;
+    Gfx::IntSize decoded_size;
+    Core::ElapsedTimer timer;
+    timer.start();
+    while (timer.elapsed() < time_per_benchmark) {
+        auto decoder = Gfx::ImageDecoder::create(static_cast<const u8*>(file.data()), file.size());
+        if (size)
+            decoder->set_desired_size({ size, size });
+        auto bitmap = decoder->bitmap();
+        if (!bitmap) {
+            fprintf(stderr, "%s: Failed to decode\n", path);
+            return;
+        }
+        decoded_size = bitmap->size();
+        ++iterations;
+    }
+    int elapsed = max(timer.elapsed(), 1);
+    double megapixels = (double)iterations * decoded_size.width() * decoded_size.height() / 1000000;
+    printf("%-40s %5dx%-5d %8.2f ms %8.1f Mpx/s\n", path, decoded_size.width(), decoded_size.height(), (double)elapsed / iterations, megapixels * 1000 / elapsed);
+}
+
+int main(int argc, char** argv)
+{
+    int time_per_benchmark = 1000;
+    Vector<int> sizes;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "ht:s:")) != -1) {
+        switch (opt) {
+        case 'h':
+            exit_with_usage(0);
+            break;
+        case 't':
+            time_per_benchmark = atoi(optarg);
+            break;
+        case 's':
+            for (auto size : String(optarg).split(','))
+                sizes.append(atoi(size.characters()));
+            break;
+        default:
+            exit_with_usage(1);
+        }
+    }
+
+    if (optind >= argc)
+        exit_with_usage(1);
+
+    // A size of 0 decodes at the natural size. Others ask the decoder for at least that many pixels
+    // each way, which decoders that can scale while decoding (like JPEG's) use to do less work.
+    if (sizes.is_empty())
+        sizes = { 0 };
+
+    for (int i = optind; i < argc; ++i) {
+        MappedFile file(argv[i]);
+        if (!file.is_valid()) {
+            fprintf(stderr, "%s: Failed to open\n", argv[i]);
+            return 1;
+        }
+        for (auto size : sizes) {
+            if (size < 0)
+                continue;
+            benchmark(argv[i], file, size, time_per_benchmark);
+        }
+    }
+
+    return 0;
+}
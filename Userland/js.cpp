@@ -28,12 +28,15 @@
 #include <AK/NonnullOwnPtr.h>
 #include <AK/StringBuilder.h>
 #include <LibCore/ArgsParser.h>
+#include <LibCore/ElapsedTimer.h>
 #include <LibCore/File.h>
 #include <LibJS/AST.h>
+#include <LibJS/Bytecode/Block.h>
 #include <LibJS/Console.h>
 #include <LibJS/Interpreter.h>
 #include <LibJS/Parser.h>
 #include <LibJS/Runtime/Array.h>
+#include <LibJS/Runtime/ArrayBuffer.h>
 #include <LibJS/Runtime/Date.h>
 #include <LibJS/Runtime/Error.h>
 #include <LibJS/Runtime/Function.h>
@@ -42,6 +45,7 @@
 #include <LibJS/Runtime/PrimitiveString.h>
 #include <LibJS/Runtime/RegExpObject.h>
 #include <LibJS/Runtime/Shape.h>
+#include <LibJS/Runtime/TypedArray.h>
 #include <LibJS/Runtime/Value.h>
 #include <LibLine/Editor.h>
 #include <signal.h>
@@ -65,6 +69,9 @@ private:
 };
 
 static bool s_dump_ast = false;
+static bool s_dump_bytecode = false;
+static bool s_eager_parse = false;
+static bool s_parse_only = false;
 static bool s_print_last_result = false;
 static RefPtr<Line::Editor> s_editor;
 static int s_repl_line_level = 0;
@@ -234,6 +241,24 @@ static void print_regexp(const JS::Object& object, HashTable<JS::Object*>&)
     printf("\033[34;1m/%s/%s\033[0m", regexp.content().characters(), regexp.flags().characters());
 }
 
+static void print_array_buffer(const JS::Object& object, HashTable<JS::Object*>&)
+{
+    auto& array_buffer = static_cast<const JS::ArrayBuffer&>(object);
+    printf("\033[34;1mArrayBuffer\033[0m { byteLength: \033[35;1m%zu\033[0m }", array_buffer.byte_length());
+}
+
+static void print_typed_array(JS::Object& object, HashTable<JS::Object*>& seen_objects)
+{
+    auto& typed_array = static_cast<JS::TypedArrayBase&>(object);
+    printf("\033[34;1m%s\033[0m(%zu) [ ", typed_array.class_name(), typed_array.array_length());
+    for (size_t i = 0; i < typed_array.array_length(); ++i) {
+        if (i > 0)
+            fputs(", ", stdout);
+        print_value(typed_array.get(i), seen_objects);
+    }
+    fputs(" ]", stdout);
+}
+
 static void print_value(JS::Value value, HashTable<JS::Object*>& seen_objects)
 {
     if (value.is_empty()) {
@@ -264,6 +289,10 @@ static void print_value(JS::Value value, HashTable<JS::Object*>& seen_objects)
             return print_error(object, seen_objects);
         if (object.is_regexp_object())
             return print_regexp(object, seen_objects);
+        if (object.is_array_buffer())
+            return print_array_buffer(object, seen_objects);
+        if (object.is_typed_array())
+            return print_typed_array(object, seen_objects);
         return print_object(object, seen_objects);
     }
 
@@ -338,11 +367,27 @@ static bool write_to_file(const StringView& path)
 static bool parse_and_run(JS::Interpreter& interpreter, const StringView& source)
 {
     auto parser = JS::Parser(JS::Lexer(source));
+    // The AST dump should show every function body.
+    parser.set_parse_function_bodies_lazily(!s_eager_parse && !s_dump_ast);
+
+    Core::ElapsedTimer parse_timer;
+    parse_timer.start();
     auto program = parser.parse_program();
+    if (s_parse_only) {
+        if (parser.has_errors()) {
+            parser.print_errors();
+            return false;
+        }
+        printf("Parsed in %d ms\n", parse_timer.elapsed());
+        return true;
+    }
 
     if (s_dump_ast)
         program->dump(0);
 
+    if (s_dump_bytecode && !parser.has_errors())
+        program->bytecode().dump();
+
     if (parser.has_errors()) {
         auto error = parser.errors()[0];
         auto hint = error.source_location_hint(source);
@@ -540,13 +585,20 @@ int main(int argc, char** argv)
 {
     bool gc_on_every_allocation = false;
     bool disable_syntax_highlight = false;
+    bool use_bytecode = false;
+    bool dump_heap_statistics = false;
     const char* script_path = nullptr;
 
     Core::ArgsParser args_parser;
     args_parser.add_option(s_dump_ast, "Dump the AST", "dump-ast", 'A');
+    args_parser.add_option(s_dump_bytecode, "Dump the bytecode", "dump-bytecode", 'd');
+    args_parser.add_option(use_bytecode, "Run programs as bytecode", "bytecode", 'b');
+    args_parser.add_option(s_eager_parse, "Parse function bodies before running, rather than on their first call", "eager-parse", 'E');
+    args_parser.add_option(s_parse_only, "Only parse the script, and print how long that took", "parse-only", 'P');
     args_parser.add_option(s_print_last_result, "Print last result", "print-last-result", 'l');
     args_parser.add_option(gc_on_every_allocation, "GC on every allocation", "gc-on-every-allocation", 'g');
     args_parser.add_option(disable_syntax_highlight, "Disable live syntax highlighting", "no-syntax-highlight", 's');
+    args_parser.add_option(dump_heap_statistics, "Dump heap and garbage collection statistics after running the script", "dump-heap-statistics", 'H');
     args_parser.add_positional_argument(script_path, "Path to script file", "script", Core::ArgsParser::Required::No);
     args_parser.parse(argc, argv);
 
@@ -565,6 +617,7 @@ int main(int argc, char** argv)
         ReplConsoleClient console_client(interpreter->console());
         interpreter->console().set_client(console_client);
         interpreter->heap().set_should_collect_on_every_allocation(gc_on_every_allocation);
+        interpreter->set_bytecode_enabled(use_bytecode);
         interpreter->set_underscore_is_last_value(true);
 
         s_editor = Line::Editor::construct();
@@ -851,6 +904,8 @@ int main(int argc, char** argv)
         ReplConsoleClient console_client(interpreter->console());
         interpreter->console().set_client(console_client);
         interpreter->heap().set_should_collect_on_every_allocation(gc_on_every_allocation);
+        interpreter->heap().set_should_record_allocation_statistics(dump_heap_statistics);
+        interpreter->set_bytecode_enabled(use_bytecode);
 
         signal(SIGINT, [](int) {
             sigint_handler();
@@ -870,7 +925,10 @@ int main(int argc, char** argv)
             source = file_contents;
         }
 
-        if (!parse_and_run(*interpreter, source))
+        bool success = parse_and_run(*interpreter, source);
+        if (dump_heap_statistics)
+            interpreter->heap().dump_statistics();
+        if (!success)
             return 1;
     }
 
@@ -58,19 +58,32 @@ int main(int argc, char** argv)
         return 1;
     }
 
-    printf("%4s  %-10s\n", " ", "CPU0");
     auto file_contents = proc_interrupts->read_all();
     auto json = JsonValue::from_string(file_contents);
     ASSERT(json.has_value());
-    json.value().as_array().for_each([](auto& value) {
+    auto& handlers = json.value().as_array();
+
+    size_t cpu_count = 1;
+    if (!handlers.is_empty())
+        cpu_count = max<size_t>(cpu_count, handlers.at(0).as_object().get("per_cpu_call_counts").as_array().size());
+
+    printf("%4s  ", " ");
+    for (size_t cpu = 0; cpu < cpu_count; ++cpu)
+        printf("%-10s ", String::format("CPU%zu", cpu).characters());
+    printf("%-10s  %-8s  %-30s\n", "", "Affinity", "");
+
+    handlers.for_each([cpu_count](auto& value) {
         auto handler = value.as_object();
         auto purpose = handler.get("purpose").to_string();
         auto interrupt = handler.get("interrupt_line").to_string();
         auto controller = handler.get("controller").to_string();
-        auto call_count = handler.get("call_count").to_string();
+        auto affinity = String::format("CPU%u", handler.get("cpu_handler").to_u32());
+        auto& per_cpu_call_counts = handler.get("per_cpu_call_counts").as_array();
 
-        printf("%4s: %-10s %-10s  %-30s\n",
-            interrupt.characters(), call_count.characters(), controller.characters(), purpose.characters());
+        printf("%4s: ", interrupt.characters());
+        for (size_t cpu = 0; cpu < cpu_count; ++cpu)
+            printf("%-10s ", cpu < static_cast<size_t>(per_cpu_call_counts.size()) ? per_cpu_call_counts.at(cpu).to_string().characters() : "0");
+        printf("%-10s  %-8s  %-30s\n", controller.characters(), affinity.characters(), purpose.characters());
     });
 
     return 0;
@@ -50,11 +50,16 @@ int main(int argc, char** argv)
     Core::EventLoop loop;
     auto protocol_client = Protocol::Client::construct();
 
-    auto download = protocol_client->start_download(url.to_string());
+    auto download = protocol_client->start_download(url.to_string(), {}, true);
     if (!download) {
         fprintf(stderr, "Failed to start download for '%s'\n", url_str);
         return 1;
     }
+    // Write the body out as it comes in instead of holding all of it until the end.
+    download->set_should_buffer_all_input(false);
+    download->on_data_received = [&](auto& data) {
+        write(STDOUT_FILENO, data.data(), data.size());
+    };
     u32 previous_downloaded_size { 0 };
     timeval prev_time, current_time, time_diff;
     gettimeofday(&prev_time, nullptr);
@@ -82,6 +87,7 @@ int main(int argc, char** argv)
     download->on_finish = [&](bool success, auto& payload, auto, auto&, auto) {
         fprintf(stderr, "\033]9;-1;\033\\");
         fprintf(stderr, "\n");
+        // Only non-empty if the server couldn't stream it to us.
         if (success)
             write(STDOUT_FILENO, payload.data(), payload.size());
         else
@@ -30,34 +30,57 @@
 #include <stdlib.h>
 #include <string.h>
 
+static int event_type_from_name(const StringView& name)
+{
+    if (name == "cycles")
+        return PERF_EVENT_CYCLES;
+    if (name == "instructions")
+        return PERF_EVENT_INSTRUCTIONS;
+    if (name == "cache-misses")
+        return PERF_EVENT_CACHE_MISSES;
+    if (name == "branch-misses")
+        return PERF_EVENT_BRANCH_MISSES;
+    return 0;
+}
+
 int main(int argc, char** argv)
 {
     Core::ArgsParser args_parser;
 
     const char* pid_argument = nullptr;
     const char* cmd_argument = nullptr;
+    bool all_processes = false;
     bool enable = false;
     bool disable = false;
+    const char* event_argument = nullptr;
+    int sample_period = 100000;
 
     args_parser.add_option(pid_argument, "Target PID", nullptr, 'p', "PID");
+    args_parser.add_option(all_processes, "Profile all processes", nullptr, 'a');
     args_parser.add_option(enable, "Enable", nullptr, 'e');
     args_parser.add_option(disable, "Disable", nullptr, 'd');
     args_parser.add_option(cmd_argument, "Command", nullptr, 'c', "command");
+    args_parser.add_option(event_argument, "Sample on a hardware event (cycles, instructions, cache-misses, branch-misses) instead of the timer", nullptr, 'E', "event");
+    args_parser.add_option(sample_period, "Events between samples (default 100000)", nullptr, 'P', "period");
 
     args_parser.parse(argc, argv);
 
-    if (!pid_argument && !cmd_argument) {
+    if (!pid_argument && !cmd_argument && !all_processes) {
         args_parser.print_usage(stdout, argv[0]);
         return 0;
     }
 
-    if (pid_argument) {
+    if (pid_argument || all_processes) {
+        if (event_argument) {
+            fprintf(stderr, "-E only works together with -c.\n");
+            return 1;
+        }
         if (!(enable ^ disable)) {
-            fprintf(stderr, "-p <PID> requires -e xor -d.\n");
+            fprintf(stderr, "-p <PID> and -a require -e xor -d.\n");
             return 1;
         }
 
-        pid_t pid = atoi(pid_argument);
+        pid_t pid = all_processes ? -1 : atoi(pid_argument);
 
         if (enable) {
             if (profiling_enable(pid) < 0) {
@@ -83,6 +106,23 @@ int main(int argc, char** argv)
 
     cmd_argv.append(nullptr);
 
+    if (event_argument) {
+        int event_type = event_type_from_name(event_argument);
+        if (!event_type) {
+            fprintf(stderr, "Unknown event '%s'\n", event_argument);
+            return 1;
+        }
+        if (sample_period <= 0) {
+            fprintf(stderr, "The sample period must be positive.\n");
+            return 1;
+        }
+        // The counter belongs to this thread, which carries on as the command's main thread after exec.
+        if (perf_event(event_type, sample_period, 0) < 0) {
+            perror("perf_event");
+            return 1;
+        }
+    }
+
     dbg() << "Enabling profiling for PID " << getpid();
     profiling_enable(getpid());
     if (execvp(cmd_argv[0], const_cast<char**>(cmd_argv.data())) < 0) {
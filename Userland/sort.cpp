@@ -24,40 +24,430 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
-#include <AK/QuickSort.h>
-#include <AK/String.h>
+#include <AK/Optional.h>
+#include <AK/StringView.h>
 #include <AK/Vector.h>
+#include <LibCore/ArgsParser.h>
+#include <LibThread/ParallelSort.h>
+#include <ctype.h>
+#include <fcntl.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
+
+// Input is read into one arena, and lines are sorted as offsets into it. Once the arena grows past the
+// memory limit, its lines are sorted and written out to a temporary file as a run, and the runs are
+// k-way merged at the end. Small inputs never touch the disk.
+
+struct KeySpec {
+    size_t start_field { 1 };
+    // 0 means up to the end of the line.
+    size_t end_field { 0 };
+};
+
+static Optional<KeySpec> s_key;
+static int s_separator = -1;
+static bool s_numeric = false;
+static bool s_reverse = false;
+static bool s_unique = false;
+
+static bool is_blank(char ch)
+{
+    return ch == ' ' || ch == '\t';
+}
+
+// Without a separator, fields are separated by runs of blanks, and the blanks before a field belong to it.
+// Those are skipped when comparing, as with -b.
+static size_t field_start(const StringView& line, size_t field)
+{
+    size_t position = 0;
+    if (s_separator >= 0) {
+        for (size_t i = 1; i < field; ++i) {
+            while (position < line.length() && line[position] != s_separator)
+                ++position;
+            if (position == line.length())
+                return position;
+            ++position;
+        }
+        return position;
+    }
+    for (size_t i = 1; i < field; ++i) {
+        while (position < line.length() && is_blank(line[position]))
+            ++position;
+        while (position < line.length() && !is_blank(line[position]))
+            ++position;
+    }
+    while (position < line.length() && is_blank(line[position]))
+        ++position;
+    return position;
+}
+
+static size_t field_end(const StringView& line, size_t field)
+{
+    size_t position = 0;
+    if (s_separator >= 0) {
+        for (size_t i = 1; i <= field; ++i) {
+            if (i > 1)
+                ++position;
+            while (position < line.length() && line[position] != s_separator)
+                ++position;
+            if (position >= line.length())
+                return line.length();
+        }
+        return position;
+    }
+    for (size_t i = 1; i <= field; ++i) {
+        while (position < line.length() && is_blank(line[position]))
+            ++position;
+        while (position < line.length() && !is_blank(line[position]))
+            ++position;
+    }
+    return position;
+}
+
+static StringView key_of(const StringView& line)
+{
+    if (!s_key.has_value())
+        return line;
+    auto& key = s_key.value();
+    size_t start = field_start(line, key.start_field);
+    size_t end = key.end_field ? field_end(line, key.end_field) : line.length();
+    if (end <= start)
+        return {};
+    return line.substring_view(start, end - start);
+}
+
+// Leading blanks, an optional minus sign, digits and a decimal point. Anything else counts as zero.
+static double parse_number(const StringView& string)
+{
+    size_t i = 0;
+    while (i < string.length() && is_blank(string[i]))
+        ++i;
+    bool negative = false;
+    if (i < string.length() && string[i] == '-') {
+        negative = true;
+        ++i;
+    }
+    double value = 0;
+    for (; i < string.length() && isdigit(string[i]); ++i)
+        value = value * 10 + (string[i] - '0');
+    if (i < string.length() && string[i] == '.') {
+        double scale = 0.1;
+        for (++i; i < string.length() && isdigit(string[i]); ++i) {
+            value += (string[i] - '0') * scale;
+            scale /= 10;
+        }
+    }
+    return negative ? -value : value;
+}
+
+static int compare_bytes(const StringView& a, const StringView& b)
+{
+    int result = memcmp(a.characters_without_null_termination(), b.characters_without_null_termination(), min(a.length(), b.length()));
+    if (result)
+        return result;
+    if (a.length() == b.length())
+        return 0;
+    return a.length() < b.length() ? -1 : 1;
+}
+
+static int compare_keys(const StringView& a, const StringView& b)
+{
+    auto key_a = key_of(a);
+    auto key_b = key_of(b);
+    if (s_numeric) {
+        double number_a = parse_number(key_a);
+        double number_b = parse_number(key_b);
+        if (number_a != number_b)
+            return number_a < number_b ? -1 : 1;
+        return 0;
+    }
+    return compare_bytes(key_a, key_b);
+}
+
+static int compare_lines(const StringView& a, const StringView& b)
+{
+    int result = compare_keys(a, b);
+    // Lines with equal keys are ordered by their whole contents, unless only one of them is wanted anyway.
+    if (result == 0 && !s_unique && (s_key.has_value() || s_numeric))
+        result = compare_bytes(a, b);
+    return s_reverse ? -result : result;
+}
+
+struct Output {
+    explicit Output(FILE* file)
+        : file(file)
+    {
+    }
+
+    FILE* file { nullptr };
+    bool has_previous { false };
+    Vector<char> previous;
+
+    void write_line(const StringView& line)
+    {
+        if (s_unique) {
+            StringView previous_line { previous.data(), previous.size() };
+            if (has_previous && compare_keys(previous_line, line) == 0)
+                return;
+            previous.clear();
+            previous.append(line.characters_without_null_termination(), line.length());
+            has_previous = true;
+        }
+        fwrite(line.characters_without_null_termination(), 1, line.length(), file);
+        fputc('\n', file);
+    }
+};
+
+class Sorter {
+public:
+    explicit Sorter(size_t memory_limit)
+        : m_memory_limit(memory_limit)
+    {
+    }
+
+    bool read_from(int fd)
+    {
+        for (;;) {
+            static constexpr size_t block_size = 64 * KB;
+            size_t old_size = m_arena.size();
+            m_arena.resize(old_size + block_size);
+            ssize_t nread = read(fd, m_arena.data() + old_size, block_size);
+            if (nread < 0) {
+                perror("read");
+                m_arena.resize(old_size);
+                return false;
+            }
+            m_arena.resize(old_size + nread);
+            if (nread == 0)
+                break;
+
+            for (size_t position = old_size; position < m_arena.size(); ++position) {
+                auto* newline = (const char*)memchr(m_arena.data() + position, '\n', m_arena.size() - position);
+                if (!newline)
+                    break;
+                position = newline - m_arena.data();
+                m_lines.append({ m_line_start, position - m_line_start });
+                m_line_start = position + 1;
+            }
+
+            if (m_arena.size() >= m_memory_limit && !m_lines.is_empty() && !spill())
+                return false;
+        }
+
+        // The end of a file ends its last line, even without a newline.
+        if (m_line_start < m_arena.size()) {
+            m_lines.append({ m_line_start, m_arena.size() - m_line_start });
+            m_line_start = m_arena.size();
+        }
+        return true;
+    }
+
+    bool finish(FILE* output_file)
+    {
+        Output output { output_file };
+        if (m_runs.is_empty()) {
+            sort_lines();
+            for (auto& line : m_lines)
+                output.write_line(view_of(line));
+            return true;
+        }
+        if (!m_lines.is_empty() && !spill())
+            return false;
+        return merge_runs(output);
+    }
+
+private:
+    struct Line {
+        size_t start;
+        size_t length;
+    };
+
+    StringView view_of(const Line& line) const { return { m_arena.data() + line.start, line.length }; }
+
+    void sort_lines()
+    {
+        LibThread::parallel_sort(m_lines, [this](auto& a, auto& b) {
+            return compare_lines(view_of(a), view_of(b)) < 0;
+        });
+    }
+
+    // Writes the lines read so far as a sorted run, and starts over with whatever partial line is left.
+    bool spill()
+    {
+        sort_lines();
+
+        char path[] = "/tmp/sort.XXXXXX";
+        int fd = mkstemp(path);
+        if (fd < 0) {
+            perror("mkstemp");
+            return false;
+        }
+        // Nobody else needs to see it, and this way it's gone however we exit.
+        unlink(path);
+        FILE* file = fdopen(fd, "w+");
+        if (!file) {
+            perror("fdopen");
+            close(fd);
+            return false;
+        }
+
+        Output output { file };
+        for (auto& line : m_lines)
+            output.write_line(view_of(line));
+        if (fflush(file) != 0) {
+            perror("write");
+            fclose(file);
+            return false;
+        }
+        m_runs.append(file);
+
+        size_t leftover = m_arena.size() - m_line_start;
+        memmove(m_arena.data(), m_arena.data() + m_line_start, leftover);
+        m_arena.resize(leftover);
+        m_line_start = 0;
+        m_lines.clear();
+        return true;
+    }
+
+    bool merge_runs(Output& output)
+    {
+        struct Run {
+            FILE* file { nullptr };
+            char* buffer { nullptr };
+            size_t buffer_size { 0 };
+            StringView line;
+            bool has_line { false };
+
+            void advance()
+            {
+                ssize_t length = getline(&buffer, &buffer_size, file);
+                has_line = length >= 0;
+                if (has_line)
+                    line = { buffer, (size_t)(length && buffer[length - 1] == '\n' ? length - 1 : length) };
+            }
+        };
+
+        Vector<Run> runs;
+        for (auto* file : m_runs) {
+            rewind(file);
+            Run run;
+            run.file = file;
+            run.advance();
+            runs.append(move(run));
+        }
+
+        // There are only as many runs as times the memory limit fits into the input, so a linear scan is fine.
+        for (;;) {
+            Run* smallest = nullptr;
+            for (auto& run : runs) {
+                // Earlier runs win ties, so lines with equal keys stay in input order.
+                if (run.has_line && (!smallest || compare_lines(run.line, smallest->line) < 0))
+                    smallest = &run;
+            }
+            if (!smallest)
+                break;
+            output.write_line(smallest->line);
+            smallest->advance();
+        }
+
+        for (auto& run : runs) {
+            free(run.buffer);
+            fclose(run.file);
+        }
+        m_runs.clear();
+        return true;
+    }
+
+    size_t m_memory_limit { 0 };
+    Vector<char> m_arena;
+    Vector<Line> m_lines;
+    size_t m_line_start { 0 };
+    Vector<FILE*> m_runs;
+};
+
+static Optional<KeySpec> parse_key(const StringView& spec)
+{
+    auto parts = spec.split_view(',');
+    if (parts.is_empty() || parts.size() > 2)
+        return {};
+    auto start = parts[0].to_uint();
+    if (!start.has_value() || start.value() == 0)
+        return {};
+    KeySpec key;
+    key.start_field = start.value();
+    if (parts.size() == 2) {
+        auto end = parts[1].to_uint();
+        if (!end.has_value() || end.value() < key.start_field)
+            return {};
+        key.end_field = end.value();
+    }
+    return key;
+}
 
 int main(int argc, char** argv)
 {
-    if (pledge("stdio", nullptr) > 0) {
+    if (pledge("stdio thread rpath wpath cpath", nullptr) < 0) {
         perror("pledge");
         return 1;
     }
 
-    UNUSED_PARAM(argc);
-    UNUSED_PARAM(argv);
+    const char* key = nullptr;
+    const char* separator = nullptr;
+    int memory_limit_in_mib = 64;
+    Vector<const char*> paths;
 
-    Vector<String> lines;
+    Core::ArgsParser args_parser;
+    args_parser.add_option(key, "Sort by fields F through G (or the end of the line)", "key", 'k', "F[,G]");
+    args_parser.add_option(separator, "Fields are separated by this character instead of by blanks", "field-separator", 't', "char");
+    args_parser.add_option(s_numeric, "Compare by numeric value", "numeric-sort", 'n');
+    args_parser.add_option(s_reverse, "Reverse the order", "reverse", 'r');
+    args_parser.add_option(s_unique, "Only output the first of lines with equal keys", "unique", 'u');
+    args_parser.add_option(memory_limit_in_mib, "Input to hold in memory before sorting to temporary files", "buffer-size", 'S', "MiB");
+    args_parser.add_positional_argument(paths, "Files to sort", "file", Core::ArgsParser::Required::No);
+    args_parser.parse(argc, argv);
 
-    for (;;) {
-        char buffer[BUFSIZ];
-        auto* str = fgets(buffer, sizeof(buffer), stdin);
-        if (!str)
-            break;
-        lines.append(buffer);
+    if (key) {
+        s_key = parse_key(key);
+        if (!s_key.has_value()) {
+            fprintf(stderr, "sort: Invalid key '%s'\n", key);
+            return 1;
+        }
+    }
+    if (separator) {
+        if (strlen(separator) != 1) {
+            fprintf(stderr, "sort: The separator must be a single character\n");
+            return 1;
+        }
+        s_separator = (unsigned char)separator[0];
+    }
+    if (memory_limit_in_mib <= 0) {
+        fprintf(stderr, "sort: Invalid buffer size\n");
+        return 1;
     }
 
-    quick_sort(lines, [](auto& a, auto& b) {
-        return strcmp(a.characters(), b.characters()) < 0;
-    });
+    Sorter sorter((size_t)memory_limit_in_mib * MB);
 
-    for (auto& line : lines) {
-        fputs(line.characters(), stdout);
+    if (paths.is_empty())
+        paths.append("-");
+    for (auto* path : paths) {
+        int fd = STDIN_FILENO;
+        if (strcmp(path, "-") != 0) {
+            fd = open(path, O_RDONLY);
+            if (fd < 0) {
+                perror(path);
+                return 1;
+            }
+        }
+        bool ok = sorter.read_from(fd);
+        if (fd != STDIN_FILENO)
+            close(fd);
+        if (!ok)
+            return 1;
     }
 
+    if (!sorter.finish(stdout))
+        return 1;
     return 0;
 }
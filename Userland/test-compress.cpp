@@ -24,18 +24,69 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <AK/StringBuilder.h>
 #include <LibCompress/Deflate.h>
 #include <LibCompress/Zlib.h>
 #include <LibCore/ArgsParser.h>
+#include <LibCore/ElapsedTimer.h>
+#include <LibCore/File.h>
+#include <stdio.h>
+#include <string.h>
+
+// Some text with plenty of repetition, some barely compressible noise and a long run,
+// which between them cover literals, matches and stored blocks.
+static Vector<ByteBuffer> make_test_corpus()
+{
+    Vector<ByteBuffer> corpus;
+
+    StringBuilder text;
+    for (size_t i = 0; i < 20000; ++i)
+        text.appendf("Line %zu: The quick brown fox jumps over the lazy dog %zu times.\n", i, (i * 7919) % 1000);
+    auto text_string = text.to_string();
+    corpus.append(ByteBuffer::copy(text_string.characters(), text_string.length()));
+
+    auto noise = ByteBuffer::create_uninitialized(512 * KB);
+    u32 state = 1;
+    for (size_t i = 0; i < noise.size(); ++i) {
+        state = state * 1103515245 + 12345;
+        noise[i] = state >> 16;
+    }
+    corpus.append(noise);
+
+    corpus.append(ByteBuffer::create_zeroed(1 * MB));
+    return corpus;
+}
+
+static ByteBuffer compress(StringView type, ReadonlyBytes data, int level)
+{
+    if (type == "zlib")
+        return Compress::ZlibCompressor::compress_all(data, level);
+    return Compress::DeflateCompressor::compress_all(data, level);
+}
+
+static Optional<ByteBuffer> decompress(StringView type, ReadonlyBytes data)
+{
+    if (type == "zlib")
+        return Compress::ZlibDecompressor::decompress_all(data);
+    return Compress::DeflateDecompressor::decompress_all(data);
+}
+
+static bool round_trips(StringView type, ReadonlyBytes data, int level)
+{
+    auto decompressed = decompress(type, compress(type, data, level).span());
+    return decompressed.has_value() && decompressed.value().size() == data.size() && !memcmp(decompressed.value().data(), data.data(), data.size());
+}
 
 auto main(int argc, char** argv) -> int
 {
     const char* mode = nullptr;
     const char* type = nullptr;
+    Vector<const char*> corpus_paths;
 
     Core::ArgsParser parser;
     parser.add_positional_argument(type, "Type of algorithm to apply (Only Zlib and DEFLATE is present at the moment)", "type", Core::ArgsParser::Required::No);
-    parser.add_positional_argument(mode, "Mode to operate in (compress|decompress; Only decompress is valid at the moment)", "mode", Core::ArgsParser::Required::No);
+    parser.add_positional_argument(mode, "Mode to operate in (compress|decompress|benchmark)", "mode", Core::ArgsParser::Required::No);
+    parser.add_positional_argument(corpus_paths, "Files to benchmark with instead of the built-in corpus", "files", Core::ArgsParser::Required::No);
     parser.parse(argc, argv);
 
     if (type == nullptr) {
@@ -61,17 +112,48 @@ auto main(int argc, char** argv) -> int
                 0xCB, 0x4A, 0x13, 0x00
             };
 
-            auto deflater = Compress::Deflate({ data_bytes, 4 * 7 });
-            auto deflated = deflater.decompress();
-            auto decompressed = String((const char*)deflated.data(), deflated.size());
+            auto deflated = Compress::DeflateDecompressor::decompress_all({ data_bytes, 4 * 7 });
+            if (!deflated.has_value() || StringView(deflated.value()) != "This is a simple text file :)") {
+                printf("Test FAILED");
+                return 1;
+            }
+
+            // Deflated bytes with a dynamic Huffman block for the string
+            // "The quick brown fox jumps over the lazy dog. " * 8 + "Pack my box with five dozen liquor jugs."
+            u8 dynamic_data_bytes[] = {
+                0xED, 0xCB, 0xC9, 0x01, 0x80, 0x20, 0x0C, 0x05, 0xD1, 0x56, 0x7E, 0x05, 0xD6, 0xE2, 0x81, 0x06,
+                0x50, 0x03, 0xC4, 0x85, 0x08, 0x08, 0x2E, 0xD5, 0x9B, 0x1A, 0x3C, 0x7B, 0x9E, 0x37, 0x26, 0x10,
+                0x52, 0xE5, 0x71, 0xC1, 0x90, 0xE5, 0x8C, 0x70, 0x72, 0x61, 0xAE, 0xDB, 0x5E, 0x20, 0x8D, 0x32,
+                0x0E, 0xCD, 0xAB, 0x7D, 0x6E, 0x4C, 0xE2, 0x3B, 0x98, 0x1F, 0x7F, 0xC5, 0xBD, 0x55, 0xB7, 0xDD,
+                0x18, 0x14, 0x9D, 0x7C, 0x04, 0x38, 0x6E, 0xA4, 0xE9, 0xA1, 0x88, 0x95, 0x53, 0x95, 0xAC, 0xAF,
+                0x2F, 0xDD, 0x0B
+            };
+
+            StringBuilder expected;
+            for (size_t i = 0; i < 8; ++i)
+                expected.append("The quick brown fox jumps over the lazy dog. ");
+            expected.append("Pack my box with five dozen liquor jugs.");
+
+            // Read the output back in small pieces to exercise the incremental interface.
+            Compress::DeflateDecompressor decompressor({ dynamic_data_bytes, sizeof(dynamic_data_bytes) });
+            StringBuilder streamed;
+            u8 chunk[7];
+            while (auto nread = decompressor.read({ chunk, sizeof(chunk) }))
+                streamed.append((const char*)chunk, nread);
+
+            if (!decompressor.is_finished() || streamed.to_string() != expected.to_string()) {
+                printf("Test FAILED");
+                return 1;
+            }
 
-            if (decompressed.equals_ignoring_case("This is a simple text file :)")) {
-                printf("Test PASSED");
-                return 0;
-            } else {
+            // Truncated input has to fail gracefully.
+            if (Compress::DeflateDecompressor::decompress_all({ dynamic_data_bytes, sizeof(dynamic_data_bytes) / 2 }).has_value()) {
                 printf("Test FAILED");
                 return 1;
             }
+
+            printf("Test PASSED");
+            return 0;
         }
 
         if (type_sv == "zlib") {
@@ -84,18 +166,96 @@ auto main(int argc, char** argv) -> int
                 0x65, 0x20, 0x3A, 0x29, 0x99, 0x5E, 0x09, 0xE8
             };
 
-            auto deflater = Compress::Zlib({ data_bytes, 8 * 5 });
-            auto deflated = deflater.decompress();
-            auto decompressed = String((const char*)deflated.data(), deflated.size());
+            auto deflated = Compress::ZlibDecompressor::decompress_all({ data_bytes, 8 * 5 });
+            if (!deflated.has_value() || StringView(deflated.value()) != "This is a simple text file :)") {
+                printf("Test FAILED");
+                return 1;
+            }
 
-            if (decompressed.equals_ignoring_case("This is a simple text file :)")) {
-                printf("Test PASSED");
-                return 0;
-            } else {
+            // A corrupted checksum has to be detected.
+            data_bytes[8 * 5 - 1] ^= 0xFF;
+            if (Compress::ZlibDecompressor::decompress_all({ data_bytes, 8 * 5 }).has_value()) {
                 printf("Test FAILED");
                 return 1;
             }
+
+            printf("Test PASSED");
+            return 0;
+        }
+    }
+
+    if (type_sv != "deflate" && type_sv != "zlib") {
+        printf("Unknown arguments passed to test!");
+        return 1;
+    }
+
+    if (mode_sv == "compress") {
+        for (auto& data : make_test_corpus()) {
+            for (int level = Compress::DeflateCompressor::min_level; level <= Compress::DeflateCompressor::max_level; ++level) {
+                if (!round_trips(type_sv, data.span(), level)) {
+                    printf("Test FAILED");
+                    return 1;
+                }
+            }
+        }
+
+        // Empty input still has to produce a valid stream.
+        if (!round_trips(type_sv, {}, Compress::DeflateCompressor::default_level)) {
+            printf("Test FAILED");
+            return 1;
+        }
+
+        printf("Test PASSED");
+        return 0;
+    }
+
+    if (mode_sv == "benchmark") {
+        Vector<ByteBuffer> corpus;
+        for (auto* path : corpus_paths) {
+            auto file_or_error = Core::File::open(path, Core::IODevice::ReadOnly);
+            if (file_or_error.is_error()) {
+                fprintf(stderr, "Couldn't open %s: %s\n", path, file_or_error.error().characters());
+                return 1;
+            }
+            corpus.append(file_or_error.value()->read_all());
+        }
+        if (corpus.is_empty())
+            corpus = make_test_corpus();
+
+        size_t total_size = 0;
+        for (auto& data : corpus)
+            total_size += data.size();
+        printf("Corpus: %zu files, %zu bytes\n", corpus.size(), total_size);
+
+        auto throughput = [&](int milliseconds) {
+            return (double)total_size / (1 * MB) / (max(milliseconds, 1) / 1000.0);
+        };
+
+        for (int level = Compress::DeflateCompressor::min_level; level <= Compress::DeflateCompressor::max_level; ++level) {
+            Vector<ByteBuffer> compressed;
+            size_t compressed_size = 0;
+            Core::ElapsedTimer timer;
+            timer.start();
+            for (auto& data : corpus) {
+                compressed.append(compress(type_sv, data.span(), level));
+                compressed_size += compressed.last().size();
+            }
+            auto compress_time = timer.elapsed();
+
+            timer.start();
+            for (auto& data : compressed) {
+                if (!decompress(type_sv, data.span()).has_value()) {
+                    printf("Decompression FAILED at level %d\n", level);
+                    return 1;
+                }
+            }
+            auto decompress_time = timer.elapsed();
+
+            printf("Level %d: %zu bytes (%.1f%%), compress %.1f MiB/s, decompress %.1f MiB/s\n",
+                level, compressed_size, 100.0 * compressed_size / max<size_t>(total_size, 1),
+                throughput(compress_time), throughput(decompress_time));
         }
+        return 0;
     }
 
     printf("Unknown arguments passed to test!");
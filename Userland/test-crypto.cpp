@@ -24,8 +24,10 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <AK/MappedFile.h>
 #include <AK/Random.h>
 #include <LibCore/ArgsParser.h>
+#include <LibCore/ElapsedTimer.h>
 #include <LibCore/EventLoop.h>
 #include <LibCore/File.h>
 #include <LibCrypto/Authentication/HMAC.h>
@@ -72,6 +74,9 @@ constexpr const char* DEFAULT_SERVER { "www.google.com" };
 // Cipher
 static int aes_cbc_tests();
 static int aes_ctr_tests();
+static int aes_gcm_tests();
+static int aes_benchmarks();
+static int hash_benchmarks();
 
 // Hash
 static int md5_tests();
@@ -147,6 +152,13 @@ static int run(Function<void(const char*, size_t)> fn)
             puts("File does not exist");
             return 1;
         }
+        // Hash the file's pages where they are, rather than reading it all into a buffer first.
+        MappedFile mapped_file(filename);
+        if (mapped_file.is_valid()) {
+            fn((const char*)mapped_file.data(), mapped_file.size());
+            g_loop.exec();
+            return 0;
+        }
         auto file = Core::File::open(filename, Core::IODevice::OpenMode::ReadOnly);
         if (file.is_error()) {
             printf("That's a weird file man...\n");
@@ -330,6 +342,7 @@ auto main(int argc, char** argv) -> int
         puts("\ttest -- Run every test suite");
         puts("\tbigint -- Run big integer test suite");
         puts("\tpk -- Run Public-key system tests");
+        puts("\tbench -- Measure the throughput of the AES modes and hash functions");
         return 0;
     }
 
@@ -408,6 +421,10 @@ auto main(int argc, char** argv) -> int
     if (mode_sv == "bigint") {
         return bigint_tests();
     }
+    if (mode_sv == "bench") {
+        aes_benchmarks();
+        return hash_benchmarks();
+    }
     if (mode_sv == "tls") {
         if (run_tests)
             return tls_tests();
@@ -417,10 +434,12 @@ auto main(int argc, char** argv) -> int
         encrypting = true;
         aes_cbc_tests();
         aes_ctr_tests();
+        aes_gcm_tests();
 
         encrypting = false;
         aes_cbc_tests();
         aes_ctr_tests();
+        aes_gcm_tests();
 
         md5_tests();
         sha1_tests();
@@ -511,6 +530,9 @@ static void aes_cbc_test_decrypt();
 static void aes_ctr_test_name();
 static void aes_ctr_test_encrypt();
 static void aes_ctr_test_decrypt();
+static void aes_gcm_test_name();
+static void aes_gcm_test_encrypt();
+static void aes_gcm_test_decrypt();
 
 static void md5_test_name();
 static void md5_test_hash();
@@ -956,6 +978,202 @@ static void aes_ctr_test_decrypt()
     // If encryption works, then decryption works, too.
 }
 
+static int aes_gcm_tests()
+{
+    aes_gcm_test_name();
+    if (encrypting) {
+        aes_gcm_test_encrypt();
+    } else {
+        aes_gcm_test_decrypt();
+    }
+
+    return g_some_test_failed ? 1 : 0;
+}
+
+static void aes_gcm_test_name()
+{
+    I_TEST((AES GCM class name));
+    Crypto::Cipher::AESCipher::GCMMode cipher("WellHelloFriends"_b, 128, Crypto::Cipher::Intent::Encryption);
+    if (cipher.class_name() != "AES_GCM")
+        FAIL(Invalid class name);
+    else
+        PASS;
+}
+
+// From "The Galois/Counter Mode of Operation (GCM)" (McGrew, Viega), Appendix B
+static u8 aes_gcm_test_key[] {
+    0xfe, 0xff, 0xe9, 0x92, 0x86, 0x65, 0x73, 0x1c, 0x6d, 0x6a, 0x8f, 0x94, 0x67, 0x30, 0x83, 0x08
+};
+static u8 aes_gcm_test_ivec[] {
+    0xca, 0xfe, 0xba, 0xbe, 0xfa, 0xce, 0xdb, 0xad, 0xde, 0xca, 0xf8, 0x88
+};
+static u8 aes_gcm_test_additional_data[] {
+    0xfe, 0xed, 0xfa, 0xce, 0xde, 0xad, 0xbe, 0xef, 0xfe, 0xed, 0xfa, 0xce, 0xde, 0xad, 0xbe, 0xef, 0xab, 0xad, 0xda, 0xd2
+};
+static u8 aes_gcm_test_plaintext[] {
+    0xd9, 0x31, 0x32, 0x25, 0xf8, 0x84, 0x06, 0xe5, 0xa5, 0x59, 0x09, 0xc5, 0xaf, 0xf5, 0x26, 0x9a,
+    0x86, 0xa7, 0xa9, 0x53, 0x15, 0x34, 0xf7, 0xda, 0x2e, 0x4c, 0x30, 0x3d, 0x8a, 0x31, 0x8a, 0x72,
+    0x1c, 0x3c, 0x0c, 0x95, 0x95, 0x68, 0x09, 0x53, 0x2f, 0xcf, 0x0e, 0x24, 0x49, 0xa6, 0xb5, 0x25,
+    0xb1, 0x6a, 0xed, 0xf5, 0xaa, 0x0d, 0xe6, 0x57, 0xba, 0x63, 0x7b, 0x39
+};
+static u8 aes_gcm_test_ciphertext[] {
+    0x42, 0x83, 0x1e, 0xc2, 0x21, 0x77, 0x74, 0x24, 0x4b, 0x72, 0x21, 0xb7, 0x84, 0xd0, 0xd4, 0x9c,
+    0xe3, 0xaa, 0x21, 0x2f, 0x2c, 0x02, 0xa4, 0xe0, 0x35, 0xc1, 0x7e, 0x23, 0x29, 0xac, 0xa1, 0x2e,
+    0x21, 0xd5, 0x14, 0xb2, 0x54, 0x66, 0x93, 0x1c, 0x7d, 0x8f, 0x6a, 0x5a, 0xac, 0x84, 0xaa, 0x05,
+    0x1b, 0xa3, 0x0b, 0x39, 0x6a, 0x0a, 0xac, 0x97, 0x3d, 0x58, 0xe0, 0x91
+};
+static u8 aes_gcm_test_tag[] {
+    0x5b, 0xc9, 0x4f, 0xbc, 0x32, 0x21, 0xa5, 0xdb, 0x94, 0xfa, 0xe9, 0x5a, 0xe7, 0x12, 0x1a, 0x47
+};
+
+static void aes_gcm_test_encrypt()
+{
+    {
+        I_TEST((AES GCM empty message with 128 bit key | Encrypt))
+        u8 key[16] {};
+        u8 ivec[12] {};
+        u8 tag_expected[] {
+            0x58, 0xe2, 0xfc, 0xce, 0xfa, 0x7e, 0x30, 0x61, 0x36, 0x7f, 0x1d, 0x57, 0xa4, 0xe7, 0x45, 0x5a
+        };
+        Crypto::Cipher::AESCipher::GCMMode cipher(AS_BB(key), 128, Crypto::Cipher::Intent::Encryption);
+        u8 tag[16];
+        cipher.encrypt({}, {}, { ivec, sizeof(ivec) }, {}, { tag, sizeof(tag) });
+        if (memcmp(tag, tag_expected, sizeof(tag)) != 0) {
+            FAIL(invalid tag);
+            print_buffer({ tag, sizeof(tag) }, -1);
+        } else
+            PASS;
+    }
+    {
+        I_TEST((AES GCM 60 octets with additional data and 128 bit key | Encrypt))
+        Crypto::Cipher::AESCipher::GCMMode cipher(AS_BB(aes_gcm_test_key), 128, Crypto::Cipher::Intent::Encryption);
+        u8 out[sizeof(aes_gcm_test_plaintext)];
+        u8 tag[16];
+        cipher.encrypt(AS_BB(aes_gcm_test_plaintext).span(), { out, sizeof(out) }, AS_BB(aes_gcm_test_ivec).span(), AS_BB(aes_gcm_test_additional_data).span(), { tag, sizeof(tag) });
+        if (memcmp(out, aes_gcm_test_ciphertext, sizeof(out)) != 0) {
+            FAIL(invalid data);
+            print_buffer({ out, sizeof(out) }, Crypto::Cipher::AESCipher::block_size());
+        } else if (memcmp(tag, aes_gcm_test_tag, sizeof(tag)) != 0) {
+            FAIL(invalid tag);
+            print_buffer({ tag, sizeof(tag) }, -1);
+        } else
+            PASS;
+    }
+}
+
+static void aes_gcm_test_decrypt()
+{
+    {
+        I_TEST((AES GCM 60 octets with additional data and 128 bit key | Decrypt))
+        Crypto::Cipher::AESCipher::GCMMode cipher(AS_BB(aes_gcm_test_key), 128, Crypto::Cipher::Intent::Decryption);
+        u8 out[sizeof(aes_gcm_test_ciphertext)];
+        auto consistency = cipher.decrypt(AS_BB(aes_gcm_test_ciphertext).span(), { out, sizeof(out) }, AS_BB(aes_gcm_test_ivec).span(), AS_BB(aes_gcm_test_additional_data).span(), AS_BB(aes_gcm_test_tag).span());
+        if (consistency != Crypto::PK::VerificationConsistency::Consistent) {
+            FAIL(tag mismatch);
+        } else if (memcmp(out, aes_gcm_test_plaintext, sizeof(out)) != 0) {
+            FAIL(invalid data);
+            print_buffer({ out, sizeof(out) }, Crypto::Cipher::AESCipher::block_size());
+        } else
+            PASS;
+    }
+    {
+        I_TEST((AES GCM forged tag | Decrypt))
+        Crypto::Cipher::AESCipher::GCMMode cipher(AS_BB(aes_gcm_test_key), 128, Crypto::Cipher::Intent::Decryption);
+        u8 tag[sizeof(aes_gcm_test_tag)];
+        memcpy(tag, aes_gcm_test_tag, sizeof(tag));
+        tag[15] ^= 1;
+        u8 out[sizeof(aes_gcm_test_ciphertext)];
+        auto consistency = cipher.decrypt(AS_BB(aes_gcm_test_ciphertext).span(), { out, sizeof(out) }, AS_BB(aes_gcm_test_ivec).span(), AS_BB(aes_gcm_test_additional_data).span(), { tag, sizeof(tag) });
+        if (consistency != Crypto::PK::VerificationConsistency::Inconsistent)
+            FAIL(forged tag accepted);
+        else
+            PASS;
+    }
+}
+
+static void aes_benchmark(const char* name, size_t key_bits, Function<void(const ReadonlyBytes&, Bytes&, const Bytes&)> process)
+{
+    constexpr size_t buffer_size = 64 * KB;
+    constexpr size_t total_size = 32 * MB;
+
+    auto input = ByteBuffer::create_uninitialized(buffer_size);
+    for (size_t i = 0; i < buffer_size; ++i)
+        input[i] = (u8)(i * 7 + 1);
+    auto output = ByteBuffer::create_uninitialized(buffer_size + Crypto::Cipher::AESCipher::block_size());
+    auto iv = ByteBuffer::create_zeroed(Crypto::Cipher::AESCipher::block_size());
+    auto iv_span = iv.span();
+
+    printf("Benchmarking %s with %zu bit key... ", name, key_bits);
+    fflush(stdout);
+
+    Core::ElapsedTimer timer;
+    timer.start();
+    for (size_t processed = 0; processed < total_size; processed += buffer_size) {
+        auto output_span = output.span();
+        process(input.span(), output_span, iv_span);
+    }
+    auto elapsed_ms = max(timer.elapsed(), 1);
+    printf("%zu MiB/s\n", (total_size / MB) * 1000 / elapsed_ms);
+}
+
+template<typename HashType>
+static void hash_benchmark()
+{
+    constexpr size_t buffer_size = 64 * KB;
+    constexpr size_t total_size = 64 * MB;
+
+    auto input = ByteBuffer::create_uninitialized(buffer_size);
+    for (size_t i = 0; i < buffer_size; ++i)
+        input[i] = (u8)(i * 7 + 1);
+
+    HashType hash;
+    printf("Benchmarking %s... ", hash.class_name().characters());
+    fflush(stdout);
+
+    Core::ElapsedTimer timer;
+    timer.start();
+    for (size_t processed = 0; processed < total_size; processed += buffer_size)
+        hash.update(input.data(), input.size());
+    (void)hash.digest();
+    auto elapsed_ms = max(timer.elapsed(), 1);
+    printf("%zu MiB/s\n", (total_size / MB) * 1000 / elapsed_ms);
+}
+
+static int hash_benchmarks()
+{
+    hash_benchmark<Crypto::Hash::SHA1>();
+    hash_benchmark<Crypto::Hash::SHA256>();
+    return 0;
+}
+
+static int aes_benchmarks()
+{
+    for (size_t key_bits : { 128, 256 }) {
+        auto key = ByteBuffer::create_zeroed(key_bits / 8);
+
+        Crypto::Cipher::AESCipher::CBCMode cbc_encrypt(key, key_bits, Crypto::Cipher::Intent::Encryption);
+        aes_benchmark("AES CBC encryption", key_bits, [&](auto& in, auto& out, auto& iv) {
+            cbc_encrypt.encrypt(in, out, iv);
+        });
+
+        Crypto::Cipher::AESCipher::CBCMode cbc_decrypt(key, key_bits, Crypto::Cipher::Intent::Decryption);
+        aes_benchmark("AES CBC decryption", key_bits, [&](auto& in, auto& out, auto& iv) {
+            cbc_decrypt.decrypt(in, out, iv);
+        });
+
+        Crypto::Cipher::AESCipher::CTRMode ctr(key, key_bits);
+        aes_benchmark("AES CTR", key_bits, [&](auto& in, auto& out, auto& iv) {
+            ctr.encrypt(in, out, iv);
+        });
+
+        Crypto::Cipher::AESCipher::GCMMode gcm(key, key_bits);
+        aes_benchmark("AES GCM", key_bits, [&](auto& in, auto& out, auto& iv) {
+            gcm.encrypt(in, out, iv.slice(0, gcm.IV_length()));
+        });
+    }
+    return 0;
+}
+
 static int md5_tests()
 {
     md5_test_name();
@@ -1219,6 +1437,25 @@ static void sha1_test_hash()
         } else
             PASS;
     }
+    {
+        I_TEST((SHA1 Hashing | Many blocks in uneven pieces));
+        u8 result[] {
+            0x29, 0x1e, 0x9a, 0x6c, 0x66, 0x99, 0x49, 0x49, 0xb5, 0x7b, 0xa5, 0xe6, 0x50, 0x36, 0x1e, 0x98, 0xfc, 0x36, 0xb1, 0xba
+        };
+        // 1000 times 'a', split so that updates both straddle and contain whole blocks.
+        auto message = ByteBuffer::create_uninitialized(1000);
+        __builtin_memset(message.data(), 'a', message.size());
+        auto hasher = Crypto::Hash::SHA1 {};
+        hasher.update(message.data(), 1);
+        hasher.update(message.data() + 1, 100);
+        hasher.update(message.data() + 101, 899);
+        auto digest = hasher.digest();
+        if (memcmp(result, digest.data, Crypto::Hash::SHA1::digest_size()) != 0) {
+            FAIL(Invalid hash);
+            print_buffer({ digest.data, Crypto::Hash::SHA1::digest_size() }, -1);
+        } else
+            PASS;
+    }
 }
 
 static int sha256_tests()
@@ -1265,6 +1502,25 @@ static void sha256_test_hash()
         } else
             PASS;
     }
+    {
+        I_TEST((SHA256 Hashing | Many blocks in uneven pieces));
+        u8 result[] {
+            0x41, 0xed, 0xec, 0xe4, 0x2d, 0x63, 0xe8, 0xd9, 0xbf, 0x51, 0x5a, 0x9b, 0xa6, 0x93, 0x2e, 0x1c, 0x20, 0xcb, 0xc9, 0xf5, 0xa5, 0xd1, 0x34, 0x64, 0x5a, 0xdb, 0x5d, 0xb1, 0xb9, 0x73, 0x7e, 0xa3
+        };
+        // 1000 times 'a', split so that updates both straddle and contain whole blocks.
+        auto message = ByteBuffer::create_uninitialized(1000);
+        __builtin_memset(message.data(), 'a', message.size());
+        auto hasher = Crypto::Hash::SHA256 {};
+        hasher.update(message.data(), 1);
+        hasher.update(message.data() + 1, 100);
+        hasher.update(message.data() + 101, 899);
+        auto digest = hasher.digest();
+        if (memcmp(result, digest.data, Crypto::Hash::SHA256::digest_size()) != 0) {
+            FAIL(Invalid hash);
+            print_buffer({ digest.data, Crypto::Hash::SHA256::digest_size() }, -1);
+        } else
+            PASS;
+    }
 }
 
 static void hmac_sha256_test_name()
@@ -1493,6 +1749,20 @@ static void bigint_test_number_theory()
             puts(exp.to_base10().characters());
         }
     }
+    {
+        I_TEST((Number Theory | Modular Power with odd modulus));
+        auto exp = Crypto::NumberTheory::ModularPower(
+            Crypto::UnsignedBigInteger::from_base10("7554874878408580797180059738953521512852100392797193099581722013791027731034201688405567044946148127384566833102437907822878899527522587955107535434122211620369295257608242219343260882387032351787315988479636183083553912751356100783355687887905032937670344343983922994005158006294861828684718095280757"),
+            Crypto::UnsignedBigInteger::from_base10("78128908410072099951076533982813550392212440565253652701200757605098526653479235915879217976097337723677742004488723685581554043643913875634019283318514395258069849258276037153883763345904571771660711782094073959836752751237753767437414231768035908832420053968274862956050711480444304747374866634698461127329"),
+            Crypto::UnsignedBigInteger::from_base10("144804638501420603356145217858691785425600301594490432876958570879299897081658375340175046987513119220516786898682399151004203154223146545303513295020026532487740682918576884349777885591475034128287331662961189397382477894803258173075977926737536667887712246817381486062783719368257405952732195681567296836789"));
+
+        if (exp == Crypto::UnsignedBigInteger::from_base10("65546918326863006088764605869401443833407379451175628113388567130129086633544609895745939031743201512715779252026729202447742612947890829639351259589712167615900721009550688891842874811072175434147624540003732102779798038981566226003212164545488734357529873273889781712112637090290580053721682844381981852664")) {
+            PASS;
+        } else {
+            FAIL(Invalid result);
+            puts(exp.to_base10().characters());
+        }
+    }
 }
 
 static void rsa_emsa_pss_test_create()
@@ -1843,6 +2113,17 @@ static void bigint_multiplication()
             FAIL(Incorrect Result);
         }
     }
+    {
+        I_TEST((BigInteger | Multiplications with big numbers 3));
+        Crypto::UnsignedBigInteger num1 = Crypto::UnsignedBigInteger::from_base10("19259932304945543453012489388346264123150630301251091913205397467512678793163298985438801581465287246796900599326981293599453696391059788395527585468958397236349829219593941445176347784966521254519991683569850153927568235123925073557654871730890816377150110202912955150756893165083983804766752720678945155244723918785411578647593326505474930569508125437069804910818063054116007160630006707231650809216182167119479261918661");
+        Crypto::UnsignedBigInteger num2 = Crypto::UnsignedBigInteger::from_base10("21665625055863586662920519165591634206373738759940465340895704426316960035517596394819413478685558137667266456626661895831456733242291772917590164978288123950699342943529213757665681344224286974911973421711130022724013452238500303128291204995389291813172907721698765661523928330191281928433337779902435613470033658579336665837042964800498662897111788460263648496473474791319396441259202382575");
+        Crypto::UnsignedBigInteger result = num1.multiplied_by(num2);
+        if (result == Crypto::UnsignedBigInteger::from_base10("417278471920264687313481630097139286351258936484690926568282236040882448530451428943087692970561675719068261360754294842524129886592330068771428018524319625701112264549245217721443066326723576304412794737770958960950699656549367129342461358198130894491738460271530494514951613966036718491907111235327816456338433434190873555726478102257386055404750328887676756083292000083606802884090305826350849793602316880807348144997249910071604740712211429318426129703643286758790166723345286957517973775648101080909410494972350186660041861943912410465086728810472580943795345083527314435064899167086022248615300554842880207756940915230844279014124260446992384135309434554199667954991739699886806620812904674784923803487335738906424433800833510529593298470361709245653594591401551126020518534518359967574004268120397053732075")) {
+            PASS;
+        } else {
+            FAIL(Incorrect Result);
+        }
+    }
 }
 static void bigint_division()
 {
@@ -102,9 +102,10 @@ private:
 
 class TestRunner {
 public:
-    TestRunner(String test_root, bool print_times)
+    TestRunner(String test_root, bool print_times, bool use_bytecode)
         : m_test_root(move(test_root))
         , m_print_times(print_times)
+        , m_use_bytecode(use_bytecode)
     {
     }
 
@@ -117,6 +118,7 @@ private:
 
     String m_test_root;
     bool m_print_times;
+    bool m_use_bytecode;
 
     double m_total_elapsed_time_in_ms { 0 };
     JSTestRunnerCounts m_counts;
@@ -173,7 +175,8 @@ static Vector<String> get_test_paths(const String& test_root)
     Vector<String> paths;
 
     iterate_directory_recursively(test_root, [&](const String& file_path) {
-        if (!file_path.ends_with("test-common.js"))
+        // The benchmarks are scripts for timing the interpreter, not tests.
+        if (!file_path.ends_with("test-common.js") && !file_path.contains("/benchmarks/"))
             paths.append(file_path);
     });
 
@@ -215,6 +218,7 @@ static Result<NonnullRefPtr<JS::Program>, ParserError> parse_file(const String&
     file->close();
 
     auto parser = JS::Parser(JS::Lexer(test_file_string));
+    parser.set_parse_function_bodies_lazily(true);
     auto program = parser.parse_program();
 
     if (parser.has_errors()) {
@@ -241,6 +245,7 @@ JSFileResult TestRunner::run_file_test(const String& test_path)
 {
     double start_time = get_time_in_ms();
     auto interpreter = JS::Interpreter::create<TestRunnerGlobalObject>();
+    interpreter->set_bytecode_enabled(m_use_bytecode);
 
     if (!m_test_program) {
         auto result = parse_file(String::format("%s/test-common.js", m_test_root.characters()));
@@ -531,20 +536,22 @@ void TestRunner::print_test_results() const
 int main(int argc, char** argv)
 {
     bool print_times = false;
+    bool use_bytecode = false;
 
     Core::ArgsParser args_parser;
     args_parser.add_option(print_times, "Show duration of each test", "show-time", 't');
+    args_parser.add_option(use_bytecode, "Run the tests as bytecode", "bytecode", 'b');
     args_parser.parse(argc, argv);
 
 #ifdef __serenity__
-    TestRunner("/home/anon/js-tests", print_times).run();
+    TestRunner("/home/anon/js-tests", print_times, use_bytecode).run();
 #else
     char* serenity_root = getenv("SERENITY_ROOT");
     if (!serenity_root) {
         printf("test-js requires the SERENITY_ROOT environment variable to be set");
         return 1;
     }
-    TestRunner(String::format("%s/Libraries/LibJS/Tests", serenity_root), print_times).run();
+    TestRunner(String::format("%s/Libraries/LibJS/Tests", serenity_root), print_times, use_bytecode).run();
 #endif
 
     return 0;
@@ -261,6 +261,7 @@ static Result<NonnullRefPtr<JS::Program>, ParserError> parse_file(const String&
     file->close();
 
     auto parser = JS::Parser(JS::Lexer(test_file_string));
+    parser.set_parse_function_bodies_lazily(true);
     auto program = parser.parse_program();
 
     if (parser.has_errors()) {
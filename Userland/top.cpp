@@ -31,6 +31,8 @@
 #include <AK/QuickSort.h>
 #include <AK/String.h>
 #include <AK/Vector.h>
+#include <LibCore/ArgsParser.h>
+#include <LibCore/File.h>
 #include <LibCore/ProcessStatisticsReader.h>
 #include <fcntl.h>
 #include <signal.h>
@@ -136,8 +138,84 @@ static Snapshot get_snapshot()
 static bool g_window_size_changed = true;
 static struct winsize g_window_size;
 
-int main(int, char**)
+struct SyscallData {
+    String name;
+    u32 call_count { 0 };
+    u64 total_ns { 0 };
+
+    u32 calls_since_prev { 0 };
+    u64 ns_since_prev { 0 };
+};
+
+static HashMap<String, SyscallData> get_syscall_snapshot()
+{
+    HashMap<String, SyscallData> map;
+    auto file = Core::File::construct("/proc/syscalls");
+    if (!file->open(Core::IODevice::ReadOnly)) {
+        fprintf(stderr, "Failed to open /proc/syscalls: %s\n", file->error_string());
+        return map;
+    }
+    auto json = JsonValue::from_string(file->read_all());
+    if (!json.has_value() || !json.value().is_array())
+        return map;
+    json.value().as_array().for_each([&](auto& value) {
+        auto& object = value.as_object();
+        SyscallData data;
+        data.name = object.get("name").to_string();
+        data.call_count = object.get("call_count").to_u32();
+        data.total_ns = object.get("total_ns").template to_number<u64>();
+        map.set(data.name, move(data));
+    });
+    return map;
+}
+
+static void print_syscalls(HashMap<String, SyscallData>& current, const HashMap<String, SyscallData>& prev)
+{
+    Vector<SyscallData*> syscalls;
+    for (auto& it : current) {
+        auto jt = prev.find(it.key);
+        it.value.calls_since_prev = it.value.call_count;
+        it.value.ns_since_prev = it.value.total_ns;
+        if (jt != prev.end()) {
+            it.value.calls_since_prev -= (*jt).value.call_count;
+            it.value.ns_since_prev -= (*jt).value.total_ns;
+        }
+        if (it.value.calls_since_prev)
+            syscalls.append(&it.value);
+    }
+
+    quick_sort(syscalls, [](auto* a, auto* b) {
+        return b->ns_since_prev < a->ns_since_prev;
+    });
+
+    printf("\033[47;30m%-20s  %8s  %10s  %10s  %10s\033[K\033[0m\n",
+        "SYSCALL",
+        "CALLS",
+        "TIME(us)",
+        "AVG(us)",
+        "TOTAL");
+    int row = 0;
+    for (auto* syscall : syscalls) {
+        u64 us_since_prev = syscall->ns_since_prev / 1000;
+        printf("%-20s  %8u  %10llu  %10llu  %10u\n",
+            syscall->name.characters(),
+            syscall->calls_since_prev,
+            us_since_prev,
+            us_since_prev / syscall->calls_since_prev,
+            syscall->call_count);
+        if (++row >= (g_window_size.ws_row - 2))
+            break;
+    }
+}
+
+int main(int argc, char** argv)
 {
+    bool show_syscalls = false;
+
+    Core::ArgsParser args_parser;
+    args_parser.add_option(show_syscalls, "Show the syscalls the system spends its time in, instead of the threads", "syscalls", 's');
+    args_parser.parse(argc, argv);
+
     if (pledge("stdio rpath tty sigaction ", nullptr) < 0) {
         perror("pledge");
         return 1;
@@ -148,6 +226,16 @@ int main(int, char**)
         return 1;
     }
 
+    if (unveil("/proc/all_binary", "r") < 0) {
+        perror("unveil");
+        return 1;
+    }
+
+    if (unveil("/proc/syscalls", "r") < 0) {
+        perror("unveil");
+        return 1;
+    }
+
     if (unveil("/etc/passwd", "r") < 0) {
         perror("unveil");
         return 1;
@@ -164,6 +252,24 @@ int main(int, char**)
         return 1;
     }
 
+    if (show_syscalls) {
+        auto prev_syscalls = get_syscall_snapshot();
+        for (;;) {
+            sleep(1);
+            if (g_window_size_changed) {
+                if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &g_window_size) < 0) {
+                    perror("ioctl(TIOCGWINSZ)");
+                    return 1;
+                }
+                g_window_size_changed = false;
+            }
+            auto current_syscalls = get_syscall_snapshot();
+            printf("\033[3J\033[H\033[2J");
+            print_syscalls(current_syscalls, prev_syscalls);
+            prev_syscalls = move(current_syscalls);
+        }
+    }
+
     Vector<ThreadData*> threads;
     auto prev = get_snapshot();
     usleep(10000);
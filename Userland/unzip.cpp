@@ -26,6 +26,7 @@
 
 #include <AK/MappedFile.h>
 #include <AK/NumberFormat.h>
+#include <LibCompress/Deflate.h>
 #include <LibCore/ArgsParser.h>
 #include <LibCore/File.h>
 #include <string.h>
@@ -100,8 +101,10 @@ static bool unpack_file_for_central_directory_index(off_t central_directory_inde
     if (!seek_and_read(buffer, file, local_file_header_index + LFHCompressionMethodOffset, 2))
         return false;
     auto compression_method = buffer[1] << 8 | buffer[0];
-    // FIXME: Remove once any decompression is supported.
-    ASSERT(compression_method == None);
+    if (compression_method != None && compression_method != Deflate) {
+        fprintf(stderr, "Unsupported compression method %d\n", compression_method);
+        return false;
+    }
 
     if (!seek_and_read(buffer, file, local_file_header_index + LFHCompressedSizeOffset, 4))
         return false;
@@ -134,14 +137,29 @@ static bool unpack_file_for_central_directory_index(off_t central_directory_inde
         }
 
         printf(" extracting: %s\n", file_name);
-        u8 raw_file_contents[compressed_file_size];
-        if (!seek_and_read(raw_file_contents, file, local_file_header_index + LFHFileNameBaseOffset + file_name_length + extra_field_length, compressed_file_size))
-            return false;
-
-        // FIXME: Try to uncompress data here. We're just ignoring it as no decompression methods are implemented yet.
-        if (!new_file->write(raw_file_contents, compressed_file_size)) {
-            fprintf(stderr, "Can't write file contents in %s: %s\n", file_name, new_file->error_string());
+        off_t file_contents_index = local_file_header_index + LFHFileNameBaseOffset + file_name_length + extra_field_length;
+        if ((size_t)(file_contents_index + compressed_file_size) > file.size())
             return false;
+        ReadonlyBytes raw_file_contents { (const u8*)file.data() + file_contents_index, (size_t)compressed_file_size };
+
+        if (compression_method == None) {
+            if (!new_file->write(raw_file_contents.data(), raw_file_contents.size())) {
+                fprintf(stderr, "Can't write file contents in %s: %s\n", file_name, new_file->error_string());
+                return false;
+            }
+        } else {
+            Compress::DeflateDecompressor decompressor { raw_file_contents };
+            u8 chunk[32 * KB];
+            while (auto nread = decompressor.read({ chunk, sizeof(chunk) })) {
+                if (!new_file->write(chunk, nread)) {
+                    fprintf(stderr, "Can't write file contents in %s: %s\n", file_name, new_file->error_string());
+                    return false;
+                }
+            }
+            if (decompressor.has_error()) {
+                fprintf(stderr, "Can't decompress file contents in %s\n", file_name);
+                return false;
+            }
         }
 
         if (!new_file->close()) {
@@ -24,12 +24,22 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <AK/ByteBuffer.h>
+#include <AK/MappedFile.h>
 #include <AK/String.h>
 #include <AK/Vector.h>
 #include <LibCore/ArgsParser.h>
-#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
 #include <stdio.h>
+#include <string.h>
 #include <sys/stat.h>
+#include <unistd.h>
+
+#if ARCH(I386) || ARCH(X86_64)
+#    include <cpuid.h>
+#    include <emmintrin.h>
+#endif
 
 struct Count {
     String name;
@@ -56,33 +66,144 @@ static void wc_out(Count& count)
     printf("%14s\n", count.name.characters());
 }
 
+static bool has_sse2()
+{
+#if ARCH(I386) || ARCH(X86_64)
+    static bool s_has_sse2 = [] {
+        unsigned eax, ebx, ecx, edx;
+        return __get_cpuid(1, &eax, &ebx, &ecx, &edx) && (edx & bit_SSE2);
+    }();
+    return s_has_sse2;
+#else
+    return false;
+#endif
+}
+
+static inline bool is_space(u8 ch)
+{
+    return ch == ' ' || (ch >= '\t' && ch <= '\r');
+}
+
+// Counts lines and words in a stream that may arrive in several pieces.
+class Counter {
+public:
+    explicit Counter(Count& count)
+        : m_count(count)
+    {
+    }
+
+    void feed(const u8* data, size_t size)
+    {
+        m_count.bytes += size;
+        size_t offset = 0;
+#if ARCH(I386) || ARCH(X86_64)
+        if (has_sse2())
+            offset = feed_sse2(data, size);
+#endif
+        for (; offset < size; ++offset) {
+            bool space = is_space(data[offset]);
+            if (!space && !m_in_word)
+                m_count.words++;
+            m_in_word = !space;
+            if (data[offset] == '\n')
+                m_count.lines++;
+        }
+    }
+
+private:
+#if ARCH(I386) || ARCH(X86_64)
+    // Classifies 16 bytes at a time. A word starts at every non-space byte that follows a space,
+    // so shifting the space mask by one lines each byte up with its predecessor.
+    [[gnu::target("sse2")]] size_t feed_sse2(const u8* data, size_t size)
+    {
+        const __m128i newline = _mm_set1_epi8('\n');
+        const __m128i blank = _mm_set1_epi8(' ');
+        const __m128i tab = _mm_set1_epi8('\t');
+        const __m128i control_space_range = _mm_set1_epi8('\r' - '\t');
+
+        size_t offset = 0;
+        for (; offset + 16 <= size; offset += 16) {
+            __m128i bytes = _mm_loadu_si128((const __m128i*)(data + offset));
+            // '\t' through '\r' are the other spaces: (byte - '\t') <= 4 as an unsigned byte.
+            __m128i from_tab = _mm_sub_epi8(bytes, tab);
+            __m128i is_control_space = _mm_cmpeq_epi8(_mm_min_epu8(from_tab, control_space_range), from_tab);
+            __m128i is_space = _mm_or_si128(is_control_space, _mm_cmpeq_epi8(bytes, blank));
+
+            unsigned space_bits = (unsigned)_mm_movemask_epi8(is_space);
+            unsigned previous_space_bits = ((space_bits << 1) | (m_in_word ? 0 : 1)) & 0xffff;
+            unsigned word_start_bits = ~space_bits & previous_space_bits & 0xffff;
+
+            m_count.words += __builtin_popcount(word_start_bits);
+            m_count.lines += __builtin_popcount((unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, newline)));
+            m_in_word = !(space_bits & 0x8000);
+        }
+        return offset;
+    }
+#endif
+
+    Count& m_count;
+    bool m_in_word { false };
+};
+
+static size_t io_buffer_size(int fd)
+{
+    // Read in large multiples of the file system's preferred block size.
+    constexpr size_t minimum_size = 64 * KB;
+    struct stat st;
+    if (fstat(fd, &st) < 0 || st.st_blksize <= 0)
+        return minimum_size;
+    size_t block_size = st.st_blksize;
+    return (minimum_size + block_size - 1) / block_size * block_size;
+}
+
+static bool count_fd(int fd, Counter& counter)
+{
+    auto buffer = ByteBuffer::create_uninitialized(io_buffer_size(fd));
+    for (;;) {
+        ssize_t nread = read(fd, buffer.data(), buffer.size());
+        if (nread < 0) {
+            if (errno == EINTR)
+                continue;
+            return false;
+        }
+        if (nread == 0)
+            return true;
+        counter.feed(buffer.data(), nread);
+    }
+}
+
 static Count get_count(const String& file_name)
 {
     Count count;
-    FILE* file_pointer = nullptr;
+    Counter counter(count);
+
     if (file_name == "-") {
         count.name = "";
-        file_pointer = stdin;
-    } else {
-        count.name = file_name;
-        if ((file_pointer = fopen(file_name.characters(), "r")) == NULL) {
-            fprintf(stderr, "wc: unable to open %s\n", file_name.characters());
-            count.exists = false;
+        if (!count_fd(STDIN_FILENO, counter))
+            perror("wc: read");
+        return count;
+    }
+
+    count.name = file_name;
+    struct stat st;
+    if (stat(file_name.characters(), &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+        MappedFile file(file_name);
+        if (file.is_valid()) {
+            counter.feed((const u8*)file.data(), file.size());
             return count;
         }
     }
-    bool start_a_new_word = true;
-    for (int ch = fgetc(file_pointer); ch != EOF; ch = fgetc(file_pointer)) {
-        count.bytes++;
-        if (isspace(ch)) {
-            start_a_new_word = true;
-        } else if (start_a_new_word) {
-            start_a_new_word = false;
-            count.words++;
-        }
-        if (ch == '\n')
-            count.lines++;
+
+    // Pipes, devices and anything we failed to map are read the old-fashioned way.
+    int fd = open(file_name.characters(), O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "wc: unable to open %s\n", file_name.characters());
+        count.exists = false;
+        return count;
     }
+    if (!count_fd(fd, counter))
+        fprintf(stderr, "wc: %s: %s\n", file_name.characters(), strerror(errno));
+    close(fd);
     return count;
 }
 